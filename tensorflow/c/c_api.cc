@@ -2447,6 +2447,85 @@ void TF_SessionPRun(TF_Session* session, const char* handle,
                 output_values, target_names, nullptr, status);
 }
 
+TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session, const TF_Buffer* run_options, const TF_Output* inputs,
+    int ninputs, const TF_Output* outputs, int noutputs,
+    const TF_Operation* const* target_opers, int ntargets, TF_Status* status) {
+  if (session->extend_before_run &&
+      !ExtendSessionGraphHelper(session, status)) {
+    return nullptr;
+  }
+
+  tensorflow::CallableOptions callable_options;
+  if (run_options != nullptr &&
+      !callable_options.mutable_run_options()->ParseFromArray(
+          run_options->data, run_options->length)) {
+    status->status = InvalidArgument("Unparseable RunOptions proto");
+    return nullptr;
+  }
+  for (int i = 0; i < ninputs; ++i) {
+    callable_options.add_feed(OutputName(inputs[i]));
+  }
+  for (int i = 0; i < noutputs; ++i) {
+    callable_options.add_fetch(OutputName(outputs[i]));
+  }
+  for (int i = 0; i < ntargets; ++i) {
+    callable_options.add_target(target_opers[i]->node.name());
+  }
+
+  Session::CallableHandle handle;
+  status->status = session->session->MakeCallable(callable_options, &handle);
+  if (!status->status.ok()) return nullptr;
+  return new TF_SessionCallable{handle, ninputs, noutputs};
+}
+
+void TF_SessionRunCallable(TF_Session* session, TF_SessionCallable* callable,
+                           TF_Tensor* const* input_values,
+                           TF_Tensor** output_values, TF_Buffer* run_metadata,
+                           TF_Status* status) {
+  TF_Run_Setup(callable->noutputs, output_values, status);
+  if (run_metadata != nullptr && run_metadata->data != nullptr) {
+    status->status =
+        InvalidArgument("Passing non-empty run_metadata is invalid.");
+    return;
+  }
+
+  std::vector<Tensor> feeds(callable->ninputs);
+  for (int i = 0; i < callable->ninputs; ++i) {
+    status->status = TF_TensorToTensorV1(input_values[i], &feeds[i]);
+    if (!status->status.ok()) return;
+  }
+
+  std::vector<Tensor> fetches;
+  RunMetadata run_metadata_proto;
+  status->status = session->session->RunCallable(
+      callable->handle, feeds, &fetches,
+      run_metadata != nullptr ? &run_metadata_proto : nullptr);
+  if (!status->status.ok()) return;
+  if (run_metadata != nullptr) {
+    status->status = MessageToBuffer(run_metadata_proto, run_metadata);
+    if (!status->status.ok()) return;
+  }
+
+  for (int i = 0; i < callable->noutputs; ++i) {
+    const Tensor& src = fetches[i];
+    if (!src.IsInitialized() || src.NumElements() == 0) {
+      output_values[i] =
+          EmptyTensor(static_cast<TF_DataType>(src.dtype()), src.shape());
+      continue;
+    }
+    output_values[i] = TF_TensorFromTensor(src, &status->status);
+    if (!status->status.ok()) return;
+  }
+}
+
+void TF_SessionReleaseCallable(TF_Session* session,
+                               TF_SessionCallable* callable,
+                               TF_Status* status) {
+  status->status = session->session->ReleaseCallable(callable->handle);
+  delete callable;
+}
+
 unsigned char TF_TryEvaluateConstant(TF_Graph* graph, TF_Output output,
                                      TF_Tensor** result, TF_Status* status) {
   mutex_lock l(graph->mu);
@@ -1324,6 +1324,52 @@ TF_CAPI_EXPORT extern void TF_SessionPRun(
 // Once called, no more calls to TF_SessionPRun should be made.
 TF_CAPI_EXPORT extern void TF_DeletePRunHandle(const char* handle);
 
+// A run of a session whose feeds, fetches and targets are resolved once, so
+// that running it skips the lookups of TF_SessionRun.
+typedef struct TF_SessionCallable TF_SessionCallable;
+
+// Prepares the run of the graph associated with the session that feeds
+// inputs[0,ninputs-1], fetches outputs[0,noutputs-1] and runs
+// target_opers[0,ntargets-1], with `run_options` (which may be NULL) applied
+// to every run.
+//
+// On success, returns a callable that must be released with
+// TF_SessionReleaseCallable. On failure, returns NULL.
+TF_CAPI_EXPORT extern TF_SessionCallable* TF_SessionMakeCallable(
+    TF_Session* session,
+    // RunOptions
+    const TF_Buffer* run_options,
+    // Input names
+    const TF_Output* inputs, int ninputs,
+    // Output names
+    const TF_Output* outputs, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // Output status
+    TF_Status*);
+
+// Runs `callable` with input_values[] for the inputs it was made with. The
+// input tensors are shared with the run, not copied, except for TF_RESOURCE
+// tensors.
+//
+// `run_metadata` and the ownership of `input_values` and `output_values` are
+// handled as in TF_SessionRun.
+TF_CAPI_EXPORT extern void TF_SessionRunCallable(
+    TF_Session* session, TF_SessionCallable* callable,
+    // Input tensors
+    TF_Tensor* const* input_values,
+    // Output tensors
+    TF_Tensor** output_values,
+    // RunMetadata
+    TF_Buffer* run_metadata,
+    // Output status
+    TF_Status*);
+
+// Releases a callable made by TF_SessionMakeCallable on `session`. Once
+// called, `callable` may no longer be used.
+TF_CAPI_EXPORT extern void TF_SessionReleaseCallable(
+    TF_Session* session, TF_SessionCallable* callable, TF_Status* status);
+
 // --------------------------------------------------------------------------
 // The deprecated session API.  Please switch to the above instead of
 // TF_ExtendGraph(). This deprecated API can be removed at any time without
@@ -137,6 +137,12 @@ struct TF_Session {
   std::atomic<bool> extend_before_run;
 };
 
+struct TF_SessionCallable {
+  tensorflow::Session::CallableHandle handle;
+  int ninputs;
+  int noutputs;
+};
+
 struct TF_ImportGraphDefOptions {
   tensorflow::ImportGraphDefOptions opts;
 
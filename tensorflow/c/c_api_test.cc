@@ -1182,6 +1182,52 @@ TEST(CAPI, SessionPRun) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionCallable) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  // Construct the graph: A + 2
+  TF_Operation* a = Placeholder(graph, s, "A");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* plus2 = Add(a, two, graph, s, "plus2");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* sess = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+
+  TF_Output feeds[] = {TF_Output{a, 0}};
+  TF_Output fetches[] = {TF_Output{plus2, 0}};
+  TF_SessionCallable* callable =
+      TF_SessionMakeCallable(sess, nullptr, feeds, TF_ARRAYSIZE(feeds),
+                             fetches, TF_ARRAYSIZE(fetches), nullptr, 0, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  ASSERT_NE(callable, nullptr);
+
+  // The same callable runs with different feeds.
+  for (int32 value : {1, 5}) {
+    TF_Tensor* feedValues[] = {Int32Tensor(value)};
+    TF_Tensor* fetchValues[1];
+    TF_SessionRunCallable(sess, callable, feedValues, fetchValues, nullptr, s);
+    ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+    EXPECT_EQ(value + 2, *(static_cast<int32*>(TF_TensorData(fetchValues[0]))));
+    TF_DeleteTensor(feedValues[0]);
+    TF_DeleteTensor(fetchValues[0]);
+  }
+
+  // Clean up.
+  TF_SessionReleaseCallable(sess, callable, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(sess, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI, ShapeInferenceError) {
   // TF_FinishOperation should fail if the shape of the added operation cannot
   // be inferred.
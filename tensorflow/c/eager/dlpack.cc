@@ -20,12 +20,16 @@ limitations under the License.
 #include "include/dlpack/dlpack.h"  // from @dlpack
 #include "tensorflow/c/eager/c_api.h"
 #include "tensorflow/c/eager/c_api_experimental.h"
+#include "tensorflow/c/eager/tfe_context_internal.h"
 #include "tensorflow/c/eager/tfe_tensorhandle_internal.h"
 #include "tensorflow/c/tf_status_internal.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/stream_executor.h"
 
 namespace tensorflow {
 
@@ -277,27 +281,48 @@ bool IsValidStrideCompactRowMajorData(int64_t* shape_arr, int64_t* stride_arr,
   }
   return valid;
 }
-}  // namespace
 
-void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
-  DLManagedTensor* dlMTensor = static_cast<DLManagedTensor*>(dlm_ptr);
-  if (dlMTensor->deleter != nullptr) {
-    dlMTensor->deleter(dlMTensor);
+// Returns the stream on which `device` computes, or nullptr if it has none.
+se::Stream* ComputeStream(Device* device) {
+  if (device == nullptr) {
+    return nullptr;
   }
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device->tensorflow_accelerator_device_info();
+  return device_info == nullptr ? nullptr : device_info->stream;
 }
 
-void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
+// Makes the consumer `stream` wait on the work enqueued on `device` so far,
+// without blocking the host when `device` has a compute stream.
+Status WaitOnConsumerStream(Device* device, intptr_t stream) {
+  if (stream == -1) {
+    return OkStatus();
+  }
+  se::Stream* compute_stream = ComputeStream(device);
+  if (compute_stream == nullptr) {
+    return device == nullptr ? OkStatus() : device->Sync();
+  }
+  se::Event event(compute_stream->parent());
+  if (!event.Init()) {
+    return errors::Internal("Failed to create an event for DLPack.");
+  }
+  compute_stream->ThenRecordEvent(&event);
+  return event.WaitForEventOnExternalStream(stream);
+}
+
+// Converts the tensor of `h`, whose device memory starts at `tf_dlm_data`, to
+// DLPack.
+void* HandleToDLPack(TFE_TensorHandle* h, void* tf_dlm_data,
+                     TF_Status* status) {
   auto tf_dlm_context = GetDlContext(h, status);
   if (!status->status.ok()) {
     return nullptr;
   }
 
-  auto* tf_dlm_data = TFE_TensorHandleDevicePointer(h, status);
+  const Tensor* tensor = GetTensorFromHandle(h, status);
   if (!status->status.ok()) {
     return nullptr;
   }
-
-  const Tensor* tensor = GetTensorFromHandle(h, status);
   TF_DataType data_type = static_cast<TF_DataType>(tensor->dtype());
 
   auto tf_dlm_type = GetDlDataType(data_type, status);
@@ -342,6 +367,58 @@ void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   return static_cast<void*>(dlm_tensor);
 }
 
+}  // namespace
+
+void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
+  DLManagedTensor* dlMTensor = static_cast<DLManagedTensor*>(dlm_ptr);
+  if (dlMTensor->deleter != nullptr) {
+    dlMTensor->deleter(dlMTensor);
+  }
+}
+
+void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
+  auto* tf_dlm_data = TFE_TensorHandleDevicePointer(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  return HandleToDLPack(h, tf_dlm_data, status);
+}
+
+void* TFE_HandleToDLPackOnStream(TFE_TensorHandle* h, intptr_t stream,
+                                 TF_Status* status) {
+  // Waits for the handle to be ready, which only means that the work
+  // producing it is enqueued on the device.
+  const Tensor* tensor = GetTensorFromHandle(h, status);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  tensorflow::TensorHandle* handle =
+      tensorflow::TensorHandleFromInterface(tensorflow::unwrap(h));
+  status->status = WaitOnConsumerStream(handle->device(), stream);
+  if (!status->status.ok()) {
+    return nullptr;
+  }
+  return HandleToDLPack(
+      h, const_cast<void*>(static_cast<const void*>(tensor->data())), status);
+}
+
+intptr_t TFE_DLPackConsumerStream(TFE_Context* ctx, const char* device_name,
+                                  TF_Status* status) {
+  tensorflow::EagerContext* context =
+      tensorflow::ContextFromInterface(tensorflow::unwrap(ctx));
+  tensorflow::Device* device;
+  status->status = context->FindDeviceFromName(device_name, &device);
+  if (!status->status.ok()) {
+    return -1;
+  }
+  se::Stream* compute_stream = ComputeStream(device);
+  if (compute_stream == nullptr) {
+    return -1;
+  }
+  return reinterpret_cast<intptr_t>(
+      compute_stream->platform_specific_handle().stream);
+}
+
 TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
                                        TFE_Context* ctx) {
   DLManagedTensor* dlmt = static_cast<DLManagedTensor*>(dlm);
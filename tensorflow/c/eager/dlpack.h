@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_C_EAGER_DLPACK_H_
 #define TENSORFLOW_C_EAGER_DLPACK_H_
 
+#include <cstdint>
+
 #include "tensorflow/c/eager/c_api.h"
 
 namespace tensorflow {
@@ -28,6 +30,21 @@ const char* const kDlTensorCapsuleName = "dltensor";
 TF_CAPI_EXPORT extern void* TFE_HandleToDLPack(TFE_TensorHandle* h,
                                                TF_Status* status);
 
+// Like TFE_HandleToDLPack, but instead of blocking the host until the device
+// of `h` is idle, makes the consumer `stream` wait on the work that produces
+// `h`. `stream` follows the `__dlpack__(stream=...)` protocol: -1 requests no
+// synchronization, any other value is the platform handle of the consumer
+// stream. Falls back to blocking the host if the device has no stream.
+TF_CAPI_EXPORT extern void* TFE_HandleToDLPackOnStream(TFE_TensorHandle* h,
+                                                       intptr_t stream,
+                                                       TF_Status* status);
+
+// Returns the platform handle of the stream that consumes the tensors of
+// `device_name`, to be passed to the `__dlpack__(stream=...)` of a producer,
+// or -1 if the device has no stream and needs no synchronization.
+TF_CAPI_EXPORT extern intptr_t TFE_DLPackConsumerStream(
+    TFE_Context* ctx, const char* device_name, TF_Status* status);
+
 // Converts DLPack (DLManagedTensor*) to eager tensor handle.
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm,
                                                              TF_Status* status,
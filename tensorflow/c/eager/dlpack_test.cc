@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/c/eager/dlpack.h"
 
+#include <cstdint>
 #include <vector>
 
 #include "absl/strings/str_join.h"
@@ -109,5 +110,44 @@ TEST(DLPack, HandleFromDLPackStrides) {
   TF_DeleteStatus(status);
 }
 
+TEST(DLPack, HandleToDLPackOnStream) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  // The CPU has no stream to synchronize on.
+  EXPECT_EQ(TFE_DLPackConsumerStream(
+                ctx, "/job:localhost/replica:0/task:0/device:CPU:0", status),
+            -1);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  std::vector<int64_t> shape = {4};
+  std::vector<float> data = {0, 1, 2, 3};
+  DLManagedTensor dlm_in = {};
+  DLTensor* dltensor_in = &dlm_in.dl_tensor;
+  dltensor_in->data = data.data();
+  dltensor_in->device = {kDLCPU, 0};
+  dltensor_in->ndim = 1;
+  dltensor_in->dtype = {kDLFloat, 32, 1};
+  dltensor_in->shape = shape.data();
+  TFE_TensorHandle* handle = TFE_HandleFromDLPack(&dlm_in, status, ctx);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  for (intptr_t stream : {intptr_t{-1}, intptr_t{1}}) {
+    auto* dlm_out = static_cast<DLManagedTensor*>(
+        TFE_HandleToDLPackOnStream(handle, stream, status));
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    EXPECT_EQ(dlm_out->dl_tensor.data, data.data());
+    EXPECT_EQ(dlm_out->dl_tensor.shape[0], 4);
+    TFE_CallDLManagedTensorDeleter(dlm_out);
+  }
+
+  TFE_DeleteTensorHandle(handle);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 }  // namespace
 }  // namespace tensorflow
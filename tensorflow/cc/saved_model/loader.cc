@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
@@ -63,8 +64,8 @@ auto* load_latency_by_stage = monitoring::Sampler<2>::New(
     {
         "/tensorflow/cc/saved_model/load_latency_by_stage",  // metric name
         "Distribution of wall time spent (in microseconds) in each stage "
-        "(restore graph from disk, run init graph op, etc) when loading the "
-        "model",
+        "(read meta graph, create session, restore graph from disk, run init "
+        "graph op) when loading the model",
         "model_path",
         "stage",
     },
@@ -266,6 +267,21 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
                  nullptr /* outputs */, &run_metadata, session);
 }
 
+// Resolves a relative constant folding cache directory against `export_dir`,
+// so that the folded constants can be stored next to the SavedModel.
+SessionOptions ResolveConstantFoldingCacheDir(
+    const SessionOptions& session_options, const string& export_dir) {
+  SessionOptions resolved = session_options;
+  RewriterConfig* rewrite_options =
+      resolved.config.mutable_graph_options()->mutable_rewrite_options();
+  const string& cache_dir = rewrite_options->constant_folding_cache_dir();
+  if (!cache_dir.empty() && !io::IsAbsolutePath(cache_dir)) {
+    rewrite_options->set_constant_folding_cache_dir(
+        io::JoinPath(export_dir, cache_dir));
+  }
+  return resolved;
+}
+
 }  // namespace
 
 SavedModelBundleInterface::~SavedModelBundleInterface() = default;
@@ -285,12 +301,20 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
+  const uint64 read_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
+  load_latency_by_stage->GetCell(export_dir, "read_meta_graph")
+      ->Add(GetLatencyMicroseconds(read_start_microseconds));
+
+  const uint64 create_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
-      session_options, bundle->meta_graph_def, &bundle->session));
+      ResolveConstantFoldingCacheDir(session_options, export_dir),
+      bundle->meta_graph_def, &bundle->session));
+  load_latency_by_stage->GetCell(export_dir, "create_session")
+      ->Add(GetLatencyMicroseconds(create_start_microseconds));
   TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
                                     export_dir, &bundle->session));
   return OkStatus();
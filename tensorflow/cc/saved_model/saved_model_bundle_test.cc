@@ -25,6 +25,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
@@ -32,6 +34,8 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+using monitoring::testing::CellReader;
+
 constexpr char kTestDataPbTxt[] =
     "cc/saved_model/testdata/half_plus_two_pbtxt/00000123";
 constexpr char kTestDataMainOp[] =
@@ -141,6 +145,24 @@ TEST_F(LoaderTest, TagMatch) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, LoadLatencyByStage) {
+  CellReader<monitoring::testing::Histogram> load_latency_by_stage(
+      "/tensorflow/cc/saved_model/load_latency_by_stage");
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  for (const char* stage :
+       {"read_meta_graph", "create_session", "restore_graph", "init_graph"}) {
+    EXPECT_EQ(load_latency_by_stage.Delta(export_dir, stage).num(), 1)
+        << stage;
+  }
+}
+
 TEST_F(LoaderTest, ReadMetaGraphFromSavedModel) {
   SavedModelBundle bundle;
   SessionOptions session_options;
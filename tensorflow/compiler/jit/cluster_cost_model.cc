@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_cost_model.h"
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the size of output `index` of `node`, with its unknown dimensions
+// replaced by `options.assumed_dynamic_dim_size`. Sets `*is_dynamic` if its
+// shape isn't fully known.
+int64_t OutputBytes(const Node* node, int index,
+                    const GraphShapeInfo& shape_info,
+                    const ClusterCostModelOptions& options, bool* is_dynamic) {
+  auto it = shape_info.find(node->name());
+  if (it == shape_info.end() ||
+      index >= static_cast<int>(it->second.size()) ||
+      it->second[index].shape.unknown_rank()) {
+    *is_dynamic = true;
+    return 0;
+  }
+  int64_t num_elements = 1;
+  for (const int64_t dim : it->second[index].shape.dim_sizes()) {
+    if (dim < 0) *is_dynamic = true;
+    num_elements *= dim < 0 ? options.assumed_dynamic_dim_size : dim;
+  }
+  return num_elements * DataTypeSize(BaseType(node->output_type(index)));
+}
+
+}  // namespace
+
+ClusterCostEstimate EstimateClusterCost(
+    absl::Span<const Node* const> nodes, const GraphShapeInfo& shape_info,
+    const ClusterCostModelOptions& options) {
+  absl::flat_hash_set<const Node*> in_cluster(nodes.begin(), nodes.end());
+  ClusterCostEstimate estimate;
+  int64_t tf_bytes = 0;
+  int64_t xla_bytes = 0;
+  int num_kernels = 0;
+
+  auto bytes_of = [&](const Node* node, int index) {
+    return OutputBytes(node, index, shape_info, options,
+                       &estimate.has_dynamic_shapes);
+  };
+
+  for (const Node* node : nodes) {
+    // TensorFlow computes constants once.
+    if (!node->IsConstant()) ++num_kernels;
+
+    for (const Edge* edge : node->in_edges()) {
+      if (edge->IsControlEdge()) continue;
+      const int64_t bytes = bytes_of(edge->src(), edge->src_output());
+      tf_bytes += bytes;
+      if (!in_cluster.contains(edge->src())) xla_bytes += bytes;
+    }
+
+    for (int i = 0; i < node->num_outputs(); ++i) {
+      const int64_t bytes = bytes_of(node, i);
+      tf_bytes += bytes;
+      for (const Edge* edge : node->out_edges()) {
+        if (!edge->IsControlEdge() && edge->src_output() == i &&
+            !in_cluster.contains(edge->dst())) {
+          xla_bytes += bytes;
+          break;
+        }
+      }
+    }
+  }
+
+  estimate.tf_usecs = num_kernels * options.tf_op_overhead_usecs +
+                      tf_bytes / options.memory_bandwidth_bytes_per_usec;
+  estimate.xla_usecs = options.xla_launch_overhead_usecs +
+                       xla_bytes / options.memory_bandwidth_bytes_per_usec;
+  if (estimate.has_dynamic_shapes) {
+    estimate.xla_usecs += nodes.size() * options.compile_usecs_per_node /
+                          options.executions_per_shape;
+  }
+  return estimate;
+}
+
+}  // namespace tensorflow
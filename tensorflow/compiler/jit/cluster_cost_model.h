@@ -0,0 +1,69 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_CLUSTER_COST_MODEL_H_
+#define TENSORFLOW_COMPILER_JIT_CLUSTER_COST_MODEL_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// A coarse model of whether compiling a cluster with XLA pays off, used by
+// MarkForCompilationPass under --tf_xla_cost_guided_clustering.
+//
+// Run op by op, each node of a cluster pays a kernel launch overhead and reads
+// and writes its tensors through memory. Compiled, the cluster pays a single
+// launch overhead, and only the tensors crossing the cluster boundary go
+// through memory; the rest are assumed to be fused. Both run the same
+// arithmetic, so it is left out.
+//
+// Tensors whose shapes aren't fully known make the cluster dynamic; their
+// unknown dimensions count as `assumed_dynamic_dim_size`, and tensors of
+// unknown rank as zero bytes. A dynamic cluster is recompiled for every shape
+// it sees, so its compilation time, proportional to its size, is charged
+// against it, amortized over `executions_per_shape` runs.
+struct ClusterCostModelOptions {
+  double tf_op_overhead_usecs = 2.0;
+  double xla_launch_overhead_usecs = 20.0;
+  double memory_bandwidth_bytes_per_usec = 10000.0;
+  double compile_usecs_per_node = 1000.0;
+  double executions_per_shape = 100.0;
+  int64_t assumed_dynamic_dim_size = 32;
+};
+
+struct ClusterCostEstimate {
+  // The estimated time of one execution of the cluster by TensorFlow.
+  double tf_usecs = 0.0;
+  // The estimated time of one execution of the compiled cluster, including
+  // the amortized recompilations if it is dynamic.
+  double xla_usecs = 0.0;
+  bool has_dynamic_shapes = false;
+
+  double benefit_usecs() const { return tf_usecs - xla_usecs; }
+};
+
+// Estimates the costs of the cluster made of `nodes`, with the shapes of
+// `shape_info` inferred for their graph.
+ClusterCostEstimate EstimateClusterCost(
+    absl::Span<const Node* const> nodes, const GraphShapeInfo& shape_info,
+    const ClusterCostModelOptions& options = ClusterCostModelOptions());
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_CLUSTER_COST_MODEL_H_
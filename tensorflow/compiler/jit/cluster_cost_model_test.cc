@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/cluster_cost_model.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Builds a chain of `num_ops` element-wise ops over a float tensor of
+// `shape`, and estimates the cost of clustering the chain.
+ClusterCostEstimate EstimateChainCost(const PartialTensorShape& shape,
+                                      int num_ops) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape(shape));
+  std::vector<string> names;
+  for (int i = 0; i < num_ops; ++i) {
+    names.push_back(absl::StrCat("neg", i));
+    x = ops::Neg(root.WithOpName(names.back()), x);
+  }
+  ops::Identity(root.WithOpName("out"), x);
+
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  TF_CHECK_OK(root.ToGraph(graph.get()));
+  GraphShapeInfo shape_info;
+  TF_CHECK_OK(InferShapes(graph.get(), /*arg_shapes=*/{},
+                          /*fnlib_def=*/nullptr, &shape_info));
+
+  std::vector<const Node*> nodes;
+  for (const Node* n : graph->op_nodes()) {
+    if (absl::c_linear_search(names, n->name())) nodes.push_back(n);
+  }
+  return EstimateClusterCost(nodes, shape_info);
+}
+
+TEST(ClusterCostModelTest, SmallMemoryBoundClusterIsNotProfitable) {
+  ClusterCostEstimate estimate =
+      EstimateChainCost(PartialTensorShape({16}), /*num_ops=*/2);
+  EXPECT_FALSE(estimate.has_dynamic_shapes);
+  EXPECT_LT(estimate.benefit_usecs(), 0);
+}
+
+TEST(ClusterCostModelTest, FusingLargeTensorsIsProfitable) {
+  ClusterCostEstimate estimate =
+      EstimateChainCost(PartialTensorShape({1024, 1024}), /*num_ops=*/4);
+  EXPECT_FALSE(estimate.has_dynamic_shapes);
+  EXPECT_GT(estimate.benefit_usecs(), 0);
+}
+
+TEST(ClusterCostModelTest, LargeDynamicClusterIsNotProfitable) {
+  ClusterCostEstimate estimate =
+      EstimateChainCost(PartialTensorShape({-1, 4}), /*num_ops=*/100);
+  EXPECT_TRUE(estimate.has_dynamic_shapes);
+  EXPECT_LT(estimate.benefit_usecs(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -123,10 +123,20 @@ StatusOr<Signature> Signature::Build(
         signature.args.push_back(arg.constant_value);
         break;
       case XlaCompiler::Argument::kParameter:
-      case XlaCompiler::Argument::kResource:
-        signature.args.push_back(
-            TensorTypeAndShape(arg.type, arg.DimensionSizesAsInlinedVector()));
+      case XlaCompiler::Argument::kResource: {
+        TensorTypeAndShape type_and_shape(arg.type,
+                                          arg.DimensionSizesAsInlinedVector());
+        const auto* xla_shape = std::get_if<xla::Shape>(&arg.shape);
+        if (xla_shape != nullptr && xla_shape->IsArray()) {
+          for (int dim = 0; dim < xla_shape->rank(); ++dim) {
+            if (xla_shape->is_dynamic_dimension(dim)) {
+              type_and_shape.second[dim] = -type_and_shape.second[dim];
+            }
+          }
+        }
+        signature.args.push_back(std::move(type_and_shape));
         break;
+      }
       default:
         return errors::InvalidArgument(
             "Unhandled argument kind in XlaCompilationCache: ",
@@ -31,7 +31,8 @@ struct DeviceCompilationClusterSignature {
 
   // List of args (either as a TensorTypeAndShape or as a Tensor value)
   // for compile-time constant arguments to the compilation, ordered by
-  // argument number. Tensors must be in host memory.
+  // argument number. Tensors must be in host memory. Bounded dynamic dimensions
+  // are stored as their negated bound, so that they don't match static ones.
   using TensorTypeAndShape =
       std::pair<DataType, absl::InlinedVector<int64_t, 4>>;
   absl::InlinedVector<std::variant<Tensor, TensorTypeAndShape>, 8> args;
@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_queue.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+DeviceCompilationQueue::DeviceCompilationQueue(int num_threads)
+    : threads_(std::make_unique<thread::ThreadPool>(
+          Env::Default(), "async_compiler_threads", num_threads)) {}
+
+DeviceCompilationQueue::~DeviceCompilationQueue() {
+  // The pool runs the remaining RunNext() calls before it is destroyed, i.e.
+  // all the pending compilations.
+  threads_.reset();
+}
+
+void DeviceCompilationQueue::Schedule(int64_t priority,
+                                      absl::AnyInvocable<void() &&> compile) {
+  {
+    mutex_lock lock(mu_);
+    pending_.push(PendingCompilation{priority, next_sequence_number_++,
+                                     Env::Default()->NowMicros(),
+                                     std::move(compile)});
+  }
+  threads_->Schedule([this] { RunNext(); });
+}
+
+int64_t DeviceCompilationQueue::NumPending() const {
+  mutex_lock lock(mu_);
+  return pending_.size();
+}
+
+void DeviceCompilationQueue::RunNext() {
+  absl::AnyInvocable<void() &&> compile;
+  {
+    mutex_lock lock(mu_);
+    // There are as many RunNext() calls as scheduled compilations.
+    CHECK(!pending_.empty());  // Crash OK
+    const PendingCompilation& next = pending_.top();
+    const uint64 queue_time_us =
+        Env::Default()->NowMicros() - next.schedule_time_us;
+    VLOG(2) << "Starting asynchronous compilation with priority "
+            << next.priority << " after " << queue_time_us << "us in queue.";
+    metrics::UpdateXlaCompileQueueTime(queue_time_us);
+    compile = std::move(next.compile);
+    pending_.pop();
+  }
+  std::move(compile)();
+}
+
+}  // namespace tensorflow
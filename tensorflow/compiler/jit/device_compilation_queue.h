@@ -0,0 +1,78 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_QUEUE_H_
+#define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_QUEUE_H_
+
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Runs asynchronous compilations on a bounded pool of threads. When all the
+// threads are busy, the pending compilations with the highest priority, e.g.
+// of the hottest clusters, run first; at equal priorities, they run in the
+// order they were scheduled.
+//
+// The destructor waits for all the scheduled compilations to finish.
+class DeviceCompilationQueue {
+ public:
+  explicit DeviceCompilationQueue(int num_threads);
+  ~DeviceCompilationQueue();
+
+  void Schedule(int64_t priority, absl::AnyInvocable<void() &&> compile);
+
+  // Returns the number of compilations waiting for a thread.
+  int64_t NumPending() const;
+
+ private:
+  struct PendingCompilation {
+    int64_t priority;
+    uint64 sequence_number;
+    uint64 schedule_time_us;
+    // Mutable so that it can be moved out of the priority queue's top().
+    mutable absl::AnyInvocable<void() &&> compile;
+
+    bool operator<(const PendingCompilation& other) const {
+      if (priority != other.priority) return priority < other.priority;
+      return sequence_number > other.sequence_number;
+    }
+  };
+
+  // Runs the pending compilation with the highest priority.
+  void RunNext();
+
+  mutable mutex mu_;
+  std::priority_queue<PendingCompilation> pending_ TF_GUARDED_BY(mu_);
+  uint64 next_sequence_number_ TF_GUARDED_BY(mu_) = 0;
+
+  // Each scheduled compilation schedules one RunNext() on `threads_`.
+  std::unique_ptr<thread::ThreadPool> threads_;
+
+  DeviceCompilationQueue(const DeviceCompilationQueue&) = delete;
+  void operator=(const DeviceCompilationQueue&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_QUEUE_H_
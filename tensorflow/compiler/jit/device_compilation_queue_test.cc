@@ -0,0 +1,57 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_queue.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(DeviceCompilationQueueTest, RunsHighestPriorityFirst) {
+  mutex mu;
+  std::vector<int> order;
+  Notification started;
+  Notification release;
+  {
+    auto queue = std::make_unique<DeviceCompilationQueue>(/*num_threads=*/1);
+    // Occupies the only thread until all the others are queued.
+    queue->Schedule(0, [&] {
+      started.Notify();
+      release.WaitForNotification();
+    });
+    started.WaitForNotification();
+
+    for (int priority : {1, 5, 3, 5}) {
+      queue->Schedule(priority, [&, priority] {
+        mutex_lock lock(mu);
+        order.push_back(priority);
+      });
+    }
+    EXPECT_EQ(queue->NumPending(), 4);
+    release.Notify();
+    // Destroying the queue waits for all the compilations.
+  }
+  EXPECT_THAT(order, testing::ElementsAre(5, 5, 3, 1));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_shape_bucketer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "xla/shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+DeviceCompilationShapeBucketer::DeviceCompilationShapeBucketer(
+    std::vector<int64_t> bucket_sizes)
+    : bucket_sizes_(std::move(bucket_sizes)) {}
+
+/*static*/ StatusOr<std::vector<int64_t>>
+DeviceCompilationShapeBucketer::ParseBucketSizes(
+    absl::string_view bucket_sizes) {
+  std::vector<int64_t> sizes;
+  for (absl::string_view size_str :
+       absl::StrSplit(bucket_sizes, ',', absl::SkipWhitespace())) {
+    int64_t size;
+    if (!absl::SimpleAtoi(size_str, &size) || size <= 0) {
+      return errors::InvalidArgument("Invalid shape bucket size: ", size_str);
+    }
+    if (!sizes.empty() && size <= sizes.back()) {
+      return errors::InvalidArgument("Shape bucket sizes must be ascending: ",
+                                     bucket_sizes);
+    }
+    sizes.push_back(size);
+  }
+  return sizes;
+}
+
+int64_t DeviceCompilationShapeBucketer::BucketSize(int64_t size) const {
+  if (bucket_sizes_.empty()) {
+    int64_t bucket = 1;
+    while (bucket < size) bucket <<= 1;
+    return bucket;
+  }
+  auto it = std::lower_bound(bucket_sizes_.begin(), bucket_sizes_.end(), size);
+  return it == bucket_sizes_.end() ? size : *it;
+}
+
+Status DeviceCompilationShapeBucketer::BucketArguments(
+    const NameAttrList& function, std::vector<XlaCompiler::Argument>& args) {
+  mutex_lock lock(mu_);
+  std::vector<ParameterDims>& params = clusters_[function.name()];
+  params.resize(std::max(params.size(), args.size()));
+
+  for (int i = 0; i < args.size(); ++i) {
+    XlaCompiler::Argument& arg = args[i];
+    if (arg.kind != XlaCompiler::Argument::kParameter ||
+        !std::holds_alternative<TensorShape>(arg.shape)) {
+      continue;
+    }
+    const TensorShape& shape = std::get<TensorShape>(arg.shape);
+    ParameterDims& dims = params[i];
+    if (dims.sizes.size() != static_cast<size_t>(shape.dims())) {
+      // Seen for the first time, or with another rank.
+      dims.sizes.assign(shape.dim_sizes().begin(), shape.dim_sizes().end());
+      dims.varying.assign(shape.dims(), false);
+      continue;
+    }
+
+    TensorShape bound = shape;
+    Tensor dynamism(DT_BOOL, TensorShape({shape.dims()}));
+    bool is_dynamic = false;
+    for (int d = 0; d < shape.dims(); ++d) {
+      const int64_t size = shape.dim_size(d);
+      dims.varying[d] = dims.varying[d] || size != dims.sizes[d];
+      // Sizes larger than the largest bucket are compiled as is.
+      dynamism.vec<bool>()(d) =
+          dims.varying[d] &&
+          (bucket_sizes_.empty() || size <= bucket_sizes_.back());
+      if (dynamism.vec<bool>()(d)) {
+        bound.set_dim(d, BucketSize(size));
+        is_dynamic = true;
+      }
+    }
+    if (!is_dynamic) continue;
+
+    xla::Shape xla_shape;
+    TF_RETURN_IF_ERROR(TensorShapeToXLAShape(arg.type, bound, &xla_shape));
+    for (int d = 0; d < shape.dims(); ++d) {
+      xla_shape.set_dynamic_dimension(d, dynamism.vec<bool>()(d));
+    }
+    arg.shape = xla_shape;
+    arg.value_dynamism = dynamism;
+  }
+  return OkStatus();
+}
+
+std::string DeviceCompilationShapeBucketer::DebugString() const {
+  tf_shared_lock lock(mu_);
+  return absl::StrCat("DeviceCompilationShapeBucketer {buckets=[",
+                      absl::StrJoin(bucket_sizes_, ","),
+                      "], num_clusters=", clusters_.size(), "}");
+}
+
+}  // namespace tensorflow
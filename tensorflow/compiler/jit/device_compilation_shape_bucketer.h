@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_SHAPE_BUCKETER_H_
+#define TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_SHAPE_BUCKETER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Bounds the number of shapes a cluster is compiled for by bucketing the
+// dimensions of its inputs.
+//
+// The dimensions of the parameters of a cluster that have been seen with
+// different sizes are turned into bounded dynamic dimensions, whose bound is
+// the bucket of their size. All the sizes of a bucket then share one
+// DeviceCompilationCache entry, whose executable is compiled with XLA's
+// dynamic padder: it masks the padded elements, and its outputs have the
+// dynamic sizes of the inputs. The launch context pads the inputs to the
+// bounded shapes at run time.
+class DeviceCompilationShapeBucketer : public ResourceBase {
+ public:
+  // `bucket_sizes` must be positive and ascending. If empty, sizes are
+  // rounded up to a power of two.
+  explicit DeviceCompilationShapeBucketer(std::vector<int64_t> bucket_sizes);
+  ~DeviceCompilationShapeBucketer() override = default;
+
+  // Parses the comma-separated bucket sizes of `--tf_xla_shape_buckets`.
+  static StatusOr<std::vector<int64_t>> ParseBucketSizes(
+      absl::string_view bucket_sizes);
+
+  // Returns the bucket of `size`, or `size` if it is larger than the largest
+  // bucket.
+  int64_t BucketSize(int64_t size) const;
+
+  // Records the shapes of the parameters in `args` for `function`, and
+  // rewrites the shapes of the parameters whose dimensions have been seen with
+  // different sizes to be bounded dynamic.
+  Status BucketArguments(const NameAttrList& function,
+                         std::vector<XlaCompiler::Argument>& args);
+
+  std::string DebugString() const override;
+
+ private:
+  // The dimensions of a parameter of a cluster.
+  struct ParameterDims {
+    // The sizes the parameter was first seen with.
+    absl::InlinedVector<int64_t, 4> sizes;
+    // Whether each dimension has been seen with a different size.
+    absl::InlinedVector<bool, 4> varying;
+  };
+
+  const std::vector<int64_t> bucket_sizes_;
+
+  mutable mutex mu_;
+  // Maps cluster names to the dimensions of their arguments, by index.
+  absl::flat_hash_map<std::string, std::vector<ParameterDims>> clusters_
+      TF_GUARDED_BY(mu_);
+
+  DeviceCompilationShapeBucketer(const DeviceCompilationShapeBucketer&) =
+      delete;
+  void operator=(const DeviceCompilationShapeBucketer&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_DEVICE_COMPILATION_SHAPE_BUCKETER_H_
@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/device_compilation_shape_bucketer.h"
+
+#include <variant>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "xla/shape.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<XlaCompiler::Argument> Parameters(const TensorShape& shape) {
+  XlaCompiler::Argument arg;
+  arg.kind = XlaCompiler::Argument::kParameter;
+  arg.type = DT_FLOAT;
+  arg.shape = shape;
+  return {arg};
+}
+
+TEST(DeviceCompilationShapeBucketerTest, ParseBucketSizes) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto sizes, DeviceCompilationShapeBucketer::ParseBucketSizes("8,16,64"));
+  EXPECT_THAT(sizes, testing::ElementsAre(8, 16, 64));
+  TF_ASSERT_OK_AND_ASSIGN(sizes,
+                          DeviceCompilationShapeBucketer::ParseBucketSizes(""));
+  EXPECT_TRUE(sizes.empty());
+  EXPECT_FALSE(DeviceCompilationShapeBucketer::ParseBucketSizes("16,8").ok());
+  EXPECT_FALSE(DeviceCompilationShapeBucketer::ParseBucketSizes("8,x").ok());
+}
+
+TEST(DeviceCompilationShapeBucketerTest, BucketSize) {
+  DeviceCompilationShapeBucketer* bucketer =
+      new DeviceCompilationShapeBucketer({8, 16});
+  core::ScopedUnref bucketer_ref(bucketer);
+  EXPECT_EQ(bucketer->BucketSize(3), 8);
+  EXPECT_EQ(bucketer->BucketSize(8), 8);
+  EXPECT_EQ(bucketer->BucketSize(9), 16);
+  EXPECT_EQ(bucketer->BucketSize(17), 17);
+
+  DeviceCompilationShapeBucketer* pow2_bucketer =
+      new DeviceCompilationShapeBucketer({});
+  core::ScopedUnref pow2_bucketer_ref(pow2_bucketer);
+  EXPECT_EQ(pow2_bucketer->BucketSize(1), 1);
+  EXPECT_EQ(pow2_bucketer->BucketSize(5), 8);
+  EXPECT_EQ(pow2_bucketer->BucketSize(1000), 1024);
+}
+
+TEST(DeviceCompilationShapeBucketerTest, BucketsVaryingDimensions) {
+  DeviceCompilationShapeBucketer* bucketer =
+      new DeviceCompilationShapeBucketer({8, 16});
+  core::ScopedUnref bucketer_ref(bucketer);
+  NameAttrList function;
+  function.set_name("cluster_0");
+
+  // The first shape is compiled as is.
+  auto args = Parameters(TensorShape({5, 3}));
+  TF_ASSERT_OK(bucketer->BucketArguments(function, args));
+  EXPECT_TRUE(std::holds_alternative<TensorShape>(args[0].shape));
+
+  // Then the dimension that varies is bucketed.
+  args = Parameters(TensorShape({6, 3}));
+  TF_ASSERT_OK(bucketer->BucketArguments(function, args));
+  ASSERT_TRUE(std::holds_alternative<xla::Shape>(args[0].shape));
+  const xla::Shape& shape = std::get<xla::Shape>(args[0].shape);
+  EXPECT_EQ(shape.dimensions(0), 8);
+  EXPECT_TRUE(shape.is_dynamic_dimension(0));
+  EXPECT_EQ(shape.dimensions(1), 3);
+  EXPECT_FALSE(shape.is_dynamic_dimension(1));
+  ASSERT_TRUE(args[0].value_dynamism.has_value());
+  EXPECT_TRUE(args[0].value_dynamism->vec<bool>()(0));
+  EXPECT_FALSE(args[0].value_dynamism->vec<bool>()(1));
+
+  // All the sizes of a bucket share a signature, which differs from the static
+  // one of the bound.
+  auto other_args = Parameters(TensorShape({7, 3}));
+  TF_ASSERT_OK(bucketer->BucketArguments(function, other_args));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto signature, DeviceCompilationClusterSignature::Build(function, args));
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto other_signature,
+      DeviceCompilationClusterSignature::Build(function, other_args));
+  EXPECT_EQ(signature, other_signature);
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto static_signature,
+      DeviceCompilationClusterSignature::Build(
+          function, Parameters(TensorShape({8, 3}))));
+  EXPECT_FALSE(signature == static_signature);
+
+  // Sizes larger than the largest bucket are not bucketed.
+  args = Parameters(TensorShape({20, 3}));
+  TF_ASSERT_OK(bucketer->BucketArguments(function, args));
+  EXPECT_TRUE(std::holds_alternative<TensorShape>(args[0].shape));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compilation_cache.h"
 #include "tensorflow/compiler/jit/device_compilation_cluster_signature.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/device_compilation_queue.h"
 #include "tensorflow/compiler/jit/device_compiler_client.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -165,8 +166,9 @@ class DeviceCompiler : public ResourceBase {
       compiler_client_;
   std::unique_ptr<DeviceCompilationCache<ExecutableType>> cache_;
 
-  // Pool of threads for asynchronous compilations.
-  std::unique_ptr<thread::ThreadPool> async_compiler_threads_;
+  // Pool of threads for asynchronous compilations, which runs the compilations
+  // of the most executed clusters first.
+  std::unique_ptr<DeviceCompilationQueue> async_compilation_queue_;
 
   mutex cluster_mutexes_mu_;
   absl::flat_hash_map<DeviceCompilationClusterSignature, std::unique_ptr<mutex>,
@@ -213,9 +215,8 @@ DeviceCompiler<ExecutableType, ClientType>::DeviceCompiler(
     : persistor_(std::move(persistor)),
       compiler_client_(std::move(compiler_client)) {
   cache_ = std::make_unique<DeviceCompilationCache<ExecutableType>>();
-  async_compiler_threads_ = std::make_unique<tensorflow::thread::ThreadPool>(
-      tensorflow::Env::Default(), "async_compiler_threads",
-      kNumAsyncDeviceCompilerThreads);
+  async_compilation_queue_ =
+      std::make_unique<DeviceCompilationQueue>(kNumAsyncDeviceCompilerThreads);
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -228,7 +229,7 @@ DeviceCompiler<ExecutableType, ClientType>::~DeviceCompiler() {
   // Without this, the pointer would be reset when the AsyncCompilationState
   // is destructed, which is dependent on the order of the members in the
   // DeviceCompiler class, which is error prone if the order changes.
-  async_compiler_threads_.reset();
+  async_compilation_queue_.reset();
   // TODO(b/110813685): Think about the program ownership model. Programs are
   // currently owned by the compilation cache which means we must wait for
   // program completion in the destructor. There are multiple compilation caches
@@ -363,14 +364,22 @@ Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
   // Don't move the above code into the thread function as it synchronously
   // updates the async compilation state!
 
-  // When the ThreadPool for the compilation cache is destroyed, it waits for
-  // compilations to have finished. This means that both 'entry' and 'this' will
-  // be alive for the duration of the compilation.
+  // The compilations of the hottest clusters, the ones that have run the most
+  // on the fallback path, are started first. A cluster is queued at most once
+  // per signature, since it stays kCompiling until it has been compiled.
+  int64_t priority = 0;
+  if (auto stats = profiler->GetCompileStats(function); stats.ok()) {
+    priority = stats->execution_count;
+  }
+
+  // When the DeviceCompilationQueue is destroyed, it waits for compilations to
+  // have finished. This means that both 'entry' and 'this' will be alive for
+  // the duration of the compilation.
   // !!Pay attention when additional variables must be captured by this lambda!!
   // All values are captured by value. Make sure that all pointer values (like
   // entry) do not get freed until the lambda has finished.
   const std::string& function_name = function.name();
-  async_compiler_threads_->Schedule([=] {
+  async_compilation_queue_->Schedule(priority, [=] {
     VLOG(2) << "Starting asynchronous compilation of cluster " << function_name
             << '.';
     // We don't need to lock mu, but do it anyway to satisfy thread safety
@@ -16,25 +16,52 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <algorithm>
 #include <optional>
 #include <string>
 
 #include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "xla/client/local_client.h"
+#include "xla/debug_options_flags.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/service/hlo.pb.h"
 #include "xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/public/version.h"
 #include "tsl/platform/statusor.h"
 
 namespace tensorflow {
 
+namespace device_executable_persistor_internal {
+// Returns a description of the devices `client` compiles for.
+inline std::string CompilationTarget(const xla::LocalClient* client) {
+  if (client == nullptr) return "";
+  const se::DeviceDescription& description =
+      client->backend().default_stream_executor()->GetDeviceDescription();
+  return absl::StrCat(client->platform()->Name(), ":", description.name(), ":",
+                      description.platform_version());
+}
+
+inline std::string CompilationTarget(const xla::PjRtClient* client) {
+  if (client == nullptr) return "";
+  std::string target = absl::StrCat(client->platform_name(), ":",
+                                    client->platform_version());
+  if (!client->devices().empty()) {
+    absl::StrAppend(&target, ":", client->devices().front()->device_kind());
+  }
+  return target;
+}
+}  // namespace device_executable_persistor_internal
+
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
@@ -74,6 +101,13 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If true, entries are keyed by their content: the HLO, the TF version, the
+    // XLA flags and the target devices, but not the cluster signature. This
+    // lets processes whose clusters are named differently, e.g. the replicas
+    // of a job sharing a remote `persistent_cache_directory`, load each
+    // other's entries.
+    bool content_addressed_keys = false;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -120,6 +154,12 @@ class DeviceExecutablePersistor {
       uint64 signature_hash, const xla::HloModuleProto& hlo_module,
       bool compiled_using_pjrt) const;
 
+  // Returns the cache key for `hlo_module` compiled by `client`, which is
+  // content-addressed if configured so.
+  XlaSerializedCacheKey BuildSerializedCacheKeyForClient(
+      uint64 signature_hash, const xla::HloModuleProto& hlo_module,
+      const DeviceCompilerClient<ExecutableType, ClientType>* client) const;
+
   // Serializes the signature and its corresponding entry to a proto message.
   StatusOr<XlaSerializedCacheEntry> SerializeEntry(
       uint64 signature_hash, const XlaCompiler::Options& options,
@@ -128,7 +168,8 @@ class DeviceExecutablePersistor {
       DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const;
 
   // Saves the cache entry in the file directory supplied during the
-  // construction of this class. Overwrites existing entries.
+  // construction of this class. Overwrites existing entries, unless keys are
+  // content-addressed.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
   // Tries to read a cache entry given a `key` by searching the file directory
@@ -157,6 +198,8 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const bool content_addressed_keys_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,7 +213,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      content_addressed_keys_(config.content_addressed_keys) {}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -181,6 +225,10 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.device_type(),
+      key.compiler_fingerprint() == 0
+          ? ""
+          : absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.compiler_fingerprint()),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "");
@@ -225,6 +273,28 @@ DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>::
   return BuildSerializedCacheKey(signature_hash, hlo_module, true);
 }
 
+template <typename ExecutableType, typename ClientType>
+XlaSerializedCacheKey
+DeviceExecutablePersistor<ExecutableType, ClientType>::
+    BuildSerializedCacheKeyForClient(
+        uint64 signature_hash, const xla::HloModuleProto& hlo_module,
+        const DeviceCompilerClient<ExecutableType, ClientType>* client) const {
+  XlaSerializedCacheKey key =
+      BuildSerializedCacheKey(signature_hash, hlo_module);
+  if (content_addressed_keys_) {
+    // The HLO already captures the shapes and constants of the signature.
+    key.set_signature_fingerprint(0);
+    std::string compiler = absl::StrCat(
+        TF_VERSION_STRING, ";",
+        DeterministicProtoHash64(xla::GetDebugOptionsFromFlags()), ";",
+        device_executable_persistor_internal::CompilationTarget(
+            client->client()));
+    // Zero means that the key is not content-addressed.
+    key.set_compiler_fingerprint(std::max<uint64>(1, Fingerprint64(compiler)));
+  }
+  return key;
+}
+
 template <typename ExecutableType, typename ClientType>
 StatusOr<std::optional<XlaSerializedCacheEntry>>
 DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
@@ -281,6 +351,15 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
   Env* env = Env::Default();
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
 
+  // A content-addressed entry that already exists was published by another
+  // process and holds the same executable.
+  if (content_addressed_keys_ &&
+      env->FileExists(GetFilePath(entry.key())).ok()) {
+    VLOG(1) << "Not overwriting existing cache entry "
+            << GetFilePath(entry.key());
+    return OkStatus();
+  }
+
   // The cache on the filesystem can be read while we're writing out the proto.
   // To prevent reads of partially-written files, we write the proto to a temp
   // file, then move it into place once we're done writing.  And we warn the
@@ -319,8 +398,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SerializeEntry(
   XlaSerializedCacheEntry serialized_entry;
   const xla::HloModuleProto& hlo_module =
       compilation_result.computation->proto();
-  *serialized_entry.mutable_key() =
-      BuildSerializedCacheKey(signature_hash, hlo_module);
+  *serialized_entry.mutable_key() = BuildSerializedCacheKeyForClient(
+      signature_hash, hlo_module, compiler_client);
   *serialized_entry.mutable_hlo_module() = hlo_module;
 
   // XLA compiler supports exporting executables as an AOT compilation result
@@ -358,8 +437,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
   const xla::HloModuleProto& hlo_module =
       compilation_result.computation->proto();
 
-  XlaSerializedCacheKey cache_key =
-      BuildSerializedCacheKey(signature_hash, hlo_module);
+  XlaSerializedCacheKey cache_key = BuildSerializedCacheKeyForClient(
+      signature_hash, hlo_module, compiler_client);
 
   std::optional<XlaSerializedCacheEntry> serialized_entry;
   {
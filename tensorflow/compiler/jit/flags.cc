@@ -108,6 +108,13 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_cost_guided_clustering",
+           &mark_for_compilation_flags->tf_xla_cost_guided_clustering,
+           "(experimental) If true, do not compile clusters that are "
+           "estimated to run slower under XLA than under TensorFlow, e.g. "
+           "small clusters of memory-bound operators or large clusters with "
+           "dynamic shapes. Ignored for operators explicitly marked for "
+           "compilation."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -167,6 +174,13 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_persistent_cache_read_only",
            &mark_for_compilation_flags->tf_xla_persistent_cache_read_only,
            "If true, the persistent cache will be read-only."),
+      Flag("tf_xla_persistent_cache_content_addressed",
+           &mark_for_compilation_flags
+                ->tf_xla_persistent_cache_content_addressed,
+           "If true, persistent cache entries are keyed by their HLO, the TF "
+           "version, the XLA flags and the target devices only, so that "
+           "processes sharing a (e.g. remote) cache directory reuse each "
+           "other's executables. Defaults to false."),
       Flag("tf_xla_disable_strict_signature_checks",
            &mark_for_compilation_flags->tf_xla_disable_strict_signature_checks,
            "If true, entires loaded into the XLA compile cache will not have "
@@ -230,6 +244,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
+  mark_for_compilation_flags->tf_xla_cost_guided_clustering = false;
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
@@ -242,6 +257,8 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_persistent_cache_directory = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_device_types = "";
   mark_for_compilation_flags->tf_xla_persistent_cache_read_only = false;
+  mark_for_compilation_flags->tf_xla_persistent_cache_content_addressed =
+      false;
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
@@ -263,6 +280,8 @@ void AllocateAndParseFlags() {
   ops_flags = new XlaOpsCommonFlags;
   ops_flags->tf_xla_always_defer_compilation = false;
   ops_flags->tf_xla_async_compilation = false;
+  ops_flags->tf_xla_enable_shape_bucketing = false;
+  ops_flags->tf_xla_shape_buckets = "";
   ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_on_demand_ = true;
   ops_flags->tf_xla_use_device_api.enabled_for_compile_and_run_ = true;
@@ -334,6 +353,18 @@ void AllocateAndParseFlags() {
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
             "is executed until the compilation has finished."),
+       Flag("tf_xla_enable_shape_bucketing",
+            &ops_flags->tf_xla_enable_shape_bucketing,
+            "If true, the dimensions of cluster inputs that have been seen "
+            "with different sizes are padded up to a bucket size, and the "
+            "cluster is compiled once per bucket with bounded dynamic shapes. "
+            "Only applies to clusters that are not run through the Device "
+            "API (PjRt)."),
+       Flag("tf_xla_shape_buckets", &ops_flags->tf_xla_shape_buckets,
+            "Comma-separated ascending bucket sizes for "
+            "--tf_xla_enable_shape_bucketing. Dimensions larger than the "
+            "largest bucket are not bucketed. If empty, dimensions are rounded "
+            "up to a power of two."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
@@ -62,6 +62,11 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If true, clusters whose estimated benefit from XLA compilation is negative
+  // (see cluster_cost_model.h) are not compiled. Ignored for operators
+  // explicitly marked for compilation.
+  bool tf_xla_cost_guided_clustering;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -104,6 +109,12 @@ struct MarkForCompilationPassFlags {
 
   bool tf_xla_persistent_cache_read_only;
 
+  // If true, persistent cache entries are keyed by their HLO, the TF version,
+  // the XLA flags and the target devices instead of the cluster signature, so
+  // that they can be shared by processes whose clusters have different names,
+  // e.g. replicas using a remote directory. Defaults to false.
+  bool tf_xla_persistent_cache_content_addressed;
+
   // If true, entries loaded into the XLA compile cache will not have their
   // signatures checked strictly. This should generally not be disabled except
   // for debugging. Defaults to false.
@@ -151,6 +162,14 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If true, the inputs of clusters run with xla::LocalExecutable are bucketed:
+  // the dimensions that have been seen with different sizes are compiled as
+  // bounded dynamic dimensions, whose bound is the next bucket size, so that
+  // varying shapes reuse the executables of a few buckets. Defaults to false.
+  bool tf_xla_enable_shape_bucketing;
+  // Comma-separated ascending bucket sizes for shape bucketing. If empty,
+  // dimensions are rounded up to a power of two.
+  std::string tf_xla_shape_buckets;
 
   class PjRtForSingleDeviceCompilationRollout {
    public:
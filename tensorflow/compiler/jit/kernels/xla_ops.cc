@@ -25,12 +25,14 @@ limitations under the License.
 #include <tuple>
 #include <utility>
 #include <variant>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
+#include "tensorflow/compiler/jit/device_compilation_shape_bucketer.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -53,6 +55,8 @@ limitations under the License.
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/service/gpu/gpu_executable_run_options.h"
 #include "xla/statusor.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -187,6 +191,17 @@ using PjRtExecutableClosure =
 using PjRtExecutableClosureStore =
     ExecutableClosureStore<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Records the time since `start_time_us` into the costs of the request the
+// step runs for, if any.
+void RecordXlaExecutableRequestCost(OpKernelContext* ctx,
+                                    uint64 start_time_us) {
+  RequestCost* request_cost = ctx->request_cost();
+  if (request_cost == nullptr) return;
+  request_cost->RecordCost(
+      {{kXlaExecutableCostName,
+        absl::Microseconds(Env::Default()->NowMicros() - start_time_us)}});
+}
+
 se::Stream* GetStream(OpKernelContext* ctx) {
   return ctx->op_device_context() ? ctx->op_device_context()->stream()
                                   : nullptr;
@@ -343,6 +358,7 @@ StatusOr<xla::ExecutionOutput> RunExecutable(
 
   auto elapsed = env->NowMicros() - start_time;
   VLOG(2) << "Elapsed time for Xla Executable Run: " << elapsed << "us";
+  RecordXlaExecutableRequestCost(ctx, start_time);
   return execution_output;
 }
 
@@ -417,9 +433,30 @@ Status CompileToLocalExecutable(
   XlaCompiler::CompileOptions compile_options =
       GenerateCompileOptions(has_ref_vars, may_alias_resource_update);
 
+  if (!GetXlaOpsCommonFlags()->tf_xla_enable_shape_bucketing) {
+    return xla_device_compiler->CompileIfNeeded(
+        options, function, args, compile_options, compile_mode, profiler,
+        compilation_result, executable);
+  }
+
+  DeviceCompilationShapeBucketer* shape_bucketer;
+  TF_RETURN_IF_ERROR(rm->LookupOrCreate<DeviceCompilationShapeBucketer>(
+      rm->default_container(), "device_compilation_shape_bucketer",
+      &shape_bucketer, [](DeviceCompilationShapeBucketer** shape_bucketer) {
+        TF_ASSIGN_OR_RETURN(std::vector<int64_t> bucket_sizes,
+                            DeviceCompilationShapeBucketer::ParseBucketSizes(
+                                GetXlaOpsCommonFlags()->tf_xla_shape_buckets));
+        *shape_bucketer =
+            new DeviceCompilationShapeBucketer(std::move(bucket_sizes));
+        return OkStatus();
+      }));
+  core::ScopedUnref shape_bucketer_ref(shape_bucketer);
+  // The bucketed inputs are padded by XlaComputationLaunchContext.
+  std::vector<XlaCompiler::Argument> bucketed_args = args;
+  TF_RETURN_IF_ERROR(shape_bucketer->BucketArguments(function, bucketed_args));
   return xla_device_compiler->CompileIfNeeded(
-      options, function, args, compile_options, compile_mode, profiler,
-      compilation_result, executable);
+      options, function, bucketed_args, compile_options, compile_mode,
+      profiler, compilation_result, executable);
 }
 
 Status GetUpdatedVariables(
@@ -558,11 +595,12 @@ void XlaLocalLaunchBase::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
             done);
         OP_REQUIRES_OK_ASYNC(ctx, LockVariables(absl::MakeSpan(variable_infos)),
                              done);
-        OP_REQUIRES_OK_ASYNC(
-            ctx,
+        const uint64 start_time_us = Env::Default()->NowMicros();
+        Status status =
             RunPjRtExecutable(inputs, variable_infos, *compilation_result,
-                              pjrt_client, pjrt_executable, ctx),
-            done);
+                              pjrt_client, pjrt_executable, ctx);
+        RecordXlaExecutableRequestCost(ctx, start_time_us);
+        OP_REQUIRES_OK_ASYNC(ctx, status, done);
       }
       VLOG(2) << "Done executing with PJRT.";
       done();
@@ -892,11 +930,13 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
                              closure.num_constant_args());
       OP_REQUIRES_OK(ctx, updated_variables.status());
       OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*updated_variables)));
-      OP_REQUIRES_OK(
-          ctx, RunPjRtExecutable(closure.num_constant_args(), inputs,
-                                 variable_snapshots, *updated_variables,
-                                 *closure.compilation_result(),
-                                 closure.client(), closure.executable(), ctx));
+      const uint64 start_time_us = Env::Default()->NowMicros();
+      Status status = RunPjRtExecutable(
+          closure.num_constant_args(), inputs, variable_snapshots,
+          *updated_variables, *closure.compilation_result(), closure.client(),
+          closure.executable(), ctx);
+      RecordXlaExecutableRequestCost(ctx, start_time_us);
+      OP_REQUIRES_OK(ctx, status);
     }
 
     OP_REQUIRES_OK(ctx, OkStatus());
@@ -34,12 +34,14 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/cluster_cost_model.h"
 #include "tensorflow/compiler/jit/compilability_check_util.h"
 #include "tensorflow/compiler/jit/deadness_analysis.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
@@ -112,6 +114,9 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If true, decluster clusters whose estimated benefit is negative.
+    bool cost_guided_clustering;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -306,6 +311,11 @@ class MarkForCompilationPassImpl {
   // This function removes "obviously bad" cases like these.
   Status DeclusterNodes();
 
+  // Declusters the clusters that the cost model predicts to run slower under
+  // XLA than under TensorFlow.  No-op unless
+  // debug_options_.cost_guided_clustering is set.
+  Status DeclusterUnprofitableClusters();
+
   // Manifests the clustering decisions into the TF graph by tagging nodes with
   // an `_XlaCluster` attribute.  Also some basic filter logic, like
   // tf_xla_min_cluster_size, are applied here.
@@ -925,6 +935,49 @@ Status MarkForCompilationPassImpl::DeclusterNodes() {
   return OkStatus();
 }
 
+Status MarkForCompilationPassImpl::DeclusterUnprofitableClusters() {
+  if (!debug_options_.cost_guided_clustering) {
+    return OkStatus();
+  }
+
+  GraphShapeInfo shape_info;
+  Status status =
+      InferShapes(graph_, /*arg_shapes=*/{}, flib_def_, &shape_info);
+  if (!status.ok()) {
+    VLOG(1) << "Not running cost guided clustering, shape inference failed: "
+            << status;
+    return OkStatus();
+  }
+
+  absl::flat_hash_map<Cluster*, std::vector<const Node*>> nodes_by_cluster;
+  for (Node* n : compilation_candidates_) {
+    Cluster* cluster = GetClusterForNode(n);
+    if (cluster != nullptr && !declustered_nodes_.contains(n)) {
+      nodes_by_cluster[cluster].push_back(n);
+    }
+  }
+
+  for (const auto& [cluster, nodes] : nodes_by_cluster) {
+    // The cost model can't see into functional control flow, and explicitly
+    // marked clusters are compiled regardless of their cost.
+    if (cluster->has_functional_control_flow() ||
+        cluster->is_xla_compile_attr_true()) {
+      continue;
+    }
+    ClusterCostEstimate estimate = EstimateClusterCost(nodes, shape_info);
+    if (estimate.benefit_usecs() >= 0) {
+      continue;
+    }
+    VLOG(2) << "Declustering " << cluster->DebugString(*graph_)
+            << ": estimated " << estimate.xla_usecs << "us under XLA vs "
+            << estimate.tf_usecs << "us under TF"
+            << (estimate.has_dynamic_shapes ? " with dynamic shapes" : "");
+    declustered_nodes_.insert(nodes.begin(), nodes.end());
+  }
+
+  return OkStatus();
+}
+
 // Tracks monotonic sequence numbers for graphs.
 class ClusterSequenceNumberGenerator {
  public:
@@ -1601,6 +1654,7 @@ Status MarkForCompilationPassImpl::Run() {
 
   TF_RETURN_IF_ERROR(RunEdgeContractionLoop());
   TF_RETURN_IF_ERROR(DeclusterNodes());
+  TF_RETURN_IF_ERROR(DeclusterUnprofitableClusters());
   TF_RETURN_IF_ERROR(CreateClusters());
   TF_RETURN_IF_ERROR(DumpDebugInfo());
 
@@ -1919,6 +1973,7 @@ Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.cost_guided_clustering = flags->tf_xla_cost_guided_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1927,7 +1982,7 @@ Status MarkForCompilationPass::Run(
 
 Status MarkForCompilationPass::RunForTest(
     const GraphOptimizationPassOptions& options, bool disable_deadness_analysis,
-    bool deterministic_cluster_names) {
+    bool deterministic_cluster_names, bool cost_guided_clustering) {
   MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
 
   MarkForCompilationPassImpl::DebugOptions debug_options;
@@ -1938,6 +1993,7 @@ Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.cost_guided_clustering = cost_guided_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
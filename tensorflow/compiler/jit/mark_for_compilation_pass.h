@@ -42,7 +42,8 @@ class MarkForCompilationPass : public GraphOptimizationPass {
  private:
   Status RunForTest(const GraphOptimizationPassOptions& options,
                     bool disable_deadness_analysis,
-                    bool deterministic_cluster_names);
+                    bool deterministic_cluster_names,
+                    bool cost_guided_clustering = false);
 
   friend class MarkForCompilationPassTestHelper;
 };
@@ -1859,6 +1859,31 @@ TEST(XlaCompilationTest, DeterministicClusterNames) {
   // clusters0/2 should differ from clusters1/3
 }
 
+TEST(XlaCompilationTest, CostGuidedClusteringDeclustersUnprofitableClusters) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output small = ops::Placeholder(root.WithOpName("small"), DT_FLOAT,
+                                  ops::Placeholder::Shape({16}));
+  Output large = ops::Placeholder(root.WithOpName("large"), DT_FLOAT,
+                                  ops::Placeholder::Shape({1024, 1024}));
+  for (int i = 0; i < 4; ++i) {
+    small = ops::Tanh(root.WithOpName(absl::StrCat("small_tanh", i)), small);
+    large = ops::Tanh(root.WithOpName(absl::StrCat("large_tanh", i)), large);
+  }
+
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(
+      &graph, MarkForCompilationPassTestHelper::Options()
+                  .WithCostGuidedClustering()));
+  auto clusters = GetClusters(*graph);
+
+  // Launching a cluster costs more than the four kernels on small tensors.
+  EXPECT_EQ(clusters["small_tanh0"], "");
+  EXPECT_NE(clusters["large_tanh0"], "");
+  EXPECT_EQ(clusters["large_tanh0"], clusters["large_tanh3"]);
+}
+
 TEST(XlaCompilationTest, ClusterSessionName) {
   Scope root = Scope::NewRootScope().ExitOnError();
   Output variable = ops::Variable(root.WithOpName("variable"),
@@ -68,7 +68,8 @@ namespace tensorflow {
   return mark_for_compilation_pass.RunForTest(
       opt_options,
       /*disable_deadness_analysis=*/options.disable_deadness_analysis,
-      /*deterministic_cluster_names=*/options.deterministic_cluster_names);
+      /*deterministic_cluster_names=*/options.deterministic_cluster_names,
+      /*cost_guided_clustering=*/options.cost_guided_clustering);
 }
 
 /*static*/ Status MarkForCompilationPassTestHelper::MarkForCompilation(
@@ -30,13 +30,15 @@ class MarkForCompilationPassTestHelper {
     bool disable_deadness_analysis;
     bool enable_cluster_scoping;
     bool deterministic_cluster_names;
+    bool cost_guided_clustering;
     std::string session_name;  // ConfigProto.Experimental.SessionMetadata.name
 
     Options()
         : enable_global_jit(true),
           disable_deadness_analysis(true),
           enable_cluster_scoping(true),
-          deterministic_cluster_names(false) {}
+          deterministic_cluster_names(false),
+          cost_guided_clustering(false) {}
 
     Options WithNoGlobalJit() {
       Options copy = *this;
@@ -62,6 +64,12 @@ class MarkForCompilationPassTestHelper {
       return copy;
     }
 
+    Options WithCostGuidedClustering() {
+      Options copy = *this;
+      copy.cost_guided_clustering = true;
+      return copy;
+    }
+
     Options WithSessionName(std::string name) {
       Options copy = *this;
       copy.session_name = std::move(name);
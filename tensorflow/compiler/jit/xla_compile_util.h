@@ -25,6 +25,10 @@ limitations under the License.
 namespace tensorflow {
 // The number of compiler threads to use for asynchronous device compilation.
 inline constexpr int64_t kNumAsyncDeviceCompilerThreads = 10;
+// The maximum number of asynchronous device compilations, including the ones
+// waiting for a compiler thread.
+inline constexpr int64_t kMaxNumOngoingAsyncDeviceCompilations =
+    10 * kNumAsyncDeviceCompilerThreads;
 
 enum class DeviceCompileMode {
   kLazy,
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <set>
@@ -35,7 +36,9 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/client/local_client.h"
+#include "xla/cpu_function_runtime.h"
 #include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_compiler.h"
 #include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/pjrt_stream_executor_client.h"
 #include "xla/pjrt/tracked_device_buffer.h"
@@ -143,6 +146,48 @@ static void PopulateExecutionInputBuffer(xla::ExecutionInput& execution_input,
   }
 }
 
+// Copies `tensor` into a new buffer for `device_shape`, the bounded dynamic
+// shape it was compiled with: XLA expects the elements in row-major order at
+// the start of the buffer, followed by the int32 size of each dimension.
+static StatusOr<se::OwningDeviceMemory> CopyToBoundedDynamicBuffer(
+    OpKernelContext* ctx, const Tensor& tensor, const xla::Shape& device_shape,
+    int device_ordinal, se::DeviceMemoryAllocator* allocator) {
+  const int64_t data_size = xla::ShapeUtil::ByteSizeOf(
+      xla::ShapeUtil::MakeStaticShape(device_shape));
+  const int64_t metadata_size = sizeof(int32_t) * device_shape.rank();
+  TF_RET_CHECK(tensor.dims() == device_shape.rank());
+  TF_RET_CHECK(tensor.TotalBytes() <= data_size);
+  TF_ASSIGN_OR_RETURN(
+      se::OwningDeviceMemory buffer,
+      allocator->Allocate(device_ordinal, data_size + metadata_size));
+
+  se::DeviceMemoryBase src = XlaTensor::DeviceMemoryFromTensor(tensor);
+  se::DeviceMemoryBase metadata =
+      buffer->GetByteSlice(data_size, metadata_size);
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  if (stream == nullptr) {
+    // Stream is not set for the host platform.
+    std::memcpy(buffer->opaque(), src.opaque(), tensor.TotalBytes());
+    int32_t* sizes = static_cast<int32_t*>(metadata.opaque());
+    for (int i = 0; i < tensor.dims(); ++i) {
+      sizes[i] = tensor.dim_size(i);
+    }
+  } else {
+    stream->ThenMemcpy(buffer.ptr(), src, tensor.TotalBytes());
+    for (int i = 0; i < tensor.dims(); ++i) {
+      se::DeviceMemoryBase size =
+          metadata.GetByteSlice(i * sizeof(int32_t), sizeof(int32_t));
+      stream->ThenMemset32(&size, static_cast<uint32_t>(tensor.dim_size(i)),
+                           sizeof(int32_t));
+    }
+    if (!stream->ok()) {
+      return errors::Internal("Failed to copy an input to its bounded shape.");
+    }
+  }
+  return std::move(buffer);
+}
+
 StatusOr<std::vector<xla::ExecutionInput>>
 XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
@@ -195,6 +240,15 @@ XlaComputationLaunchContext::PopulateInputs(
 
     arguments.emplace_back(device_shape, host_shape);
     xla::ExecutionInput& execution_input = arguments.back();
+    if (!is_resource_variable && device_shape.IsArray() &&
+        device_shape.is_dynamic()) {
+      // The input was bucketed by DeviceCompilationShapeBucketer.
+      TF_ASSIGN_OR_RETURN(
+          *execution_input.MutableBuffer(xla::ShapeIndex{}),
+          CopyToBoundedDynamicBuffer(ctx, *t, device_shape, device_ordinal_,
+                                     xla_allocator_));
+      continue;
+    }
     se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
     PopulateExecutionInputBuffer(execution_input, xla::ShapeIndex{}, dmem,
                                  donate_buffer, device_ordinal_,
@@ -605,6 +659,33 @@ XlaComputationLaunchContext::BuildXlaCompilerArguments(
 }
 
 // TODO(b/289002708) Create a unit test to cover use_pjrt_tensor_buffer=true.
+namespace {
+
+// Tensors allocated by the TF CPU allocator are always aligned enough for the
+// XLA CPU backend to read and write them in place.
+static_assert(Allocator::kAllocatorAlignment %
+                  xla::cpu_function_runtime::MinAlign() ==
+              0);
+
+// Returns a PjRtBuffer of the CPU client that aliases the data of `tensor`,
+// which is kept alive until the buffer is deleted. Tensors whose data is not
+// aligned enough, e.g. unaligned slices, are copied instead.
+StatusOr<std::unique_ptr<xla::PjRtBuffer>> HostTensorToAliasingPjRtBuffer(
+    const Tensor& tensor, xla::PjRtClient* pjrt_client,
+    xla::PjRtDevice* pjrt_device) {
+  xla::Shape shape;
+  TF_RETURN_IF_ERROR(
+      TensorShapeToXLAShape(tensor.dtype(), tensor.shape(), &shape));
+  return pjrt_client->BufferFromHostBuffer(
+      tensor.data(), shape.element_type(), shape.dimensions(),
+      /*byte_strides=*/std::nullopt,
+      xla::PjRtClient::HostBufferSemantics::kZeroCopy,
+      /*on_done_with_host_buffer=*/[tensor]() { /* frees tensor */ },
+      pjrt_device);
+}
+
+}  // namespace
+
 Status PreparePjRtExecutableArguments(
     int num_missing_prefix_ctx_inputs, const std::vector<int>& input_mapping,
     const std::vector<const Tensor*>& inputs,
@@ -644,6 +725,14 @@ Status PreparePjRtExecutableArguments(
           dynamic_cast<const PjRtTensorBuffer*>(DMAHelper::buffer(tensor));
       if (pjrt_tensor_buffer != nullptr) {
         args->push_back(pjrt_tensor_buffer->pjrt_buffer());
+      } else if (pjrt_client->platform_id() == xla::CpuId()) {
+        // The CPU client executes on host memory, so the tensor is aliased
+        // rather than copied.
+        TF_ASSIGN_OR_RETURN(
+            std::unique_ptr<xla::PjRtBuffer> pjrt_buffer,
+            HostTensorToAliasingPjRtBuffer(*tensor, pjrt_client, pjrt_device));
+        owned_args->push_back(std::move(pjrt_buffer));
+        args->push_back(owned_args->back().get());
       } else {
         // Creates a PjRtBuffer from DeviceMemoryBase. The newly created
         // PjRtBuffer needs to be persisted till XLA execution is completed.
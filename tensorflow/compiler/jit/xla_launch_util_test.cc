@@ -322,6 +322,31 @@ TEST_F(PjRtExecutionUtilTest, PreparePjRtExecutableArgumentsVariableInputs) {
       *literal2, xla::LiteralUtil::CreateR2<int32_t>({{3, 4}})));
 }
 
+TEST_F(PjRtExecutionUtilTest, PreparePjRtExecutableArgumentsAliasesHostInputs) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      xla::PjRtDevice * pjrt_device,
+      pjrt_client_->LookupAddressableDevice(device_->parsed_name().id));
+  std::vector<const Tensor*> inputs;
+  inputs.push_back(CreateHostTensor<int32_t>(TensorShape({1, 3}), {1, 2, 3}));
+  std::vector<int> input_mapping{0};
+
+  std::vector<xla::PjRtBuffer*> exec_args;
+  std::vector<std::unique_ptr<xla::PjRtBuffer>> owned_args;
+  absl::flat_hash_set<int> non_donatable_input_indices;
+  TF_EXPECT_OK(PreparePjRtExecutableArguments(
+      /*num_missing_prefix_ctx_inputs=*/0, input_mapping, inputs,
+      /*variable_snapshots=*/{}, pjrt_client_, pjrt_device,
+      /*use_pjrt_tensor_buffer=*/true, &exec_args, &owned_args,
+      &non_donatable_input_indices));
+
+  ASSERT_EQ(exec_args.size(), 1);
+  TF_ASSERT_OK_AND_ASSIGN(auto ref, exec_args[0]->AcquireExternalReference());
+  EXPECT_EQ(ref->OpaqueDeviceMemoryDataPointer(), inputs[0]->data());
+  std::shared_ptr<xla::Literal> literal = *exec_args[0]->ToLiteralSync();
+  EXPECT_TRUE(xla::LiteralTestUtil::Equal(
+      *literal, xla::LiteralUtil::CreateR2<int32_t>({{1, 2, 3}})));
+}
+
 TEST_F(PjRtExecutionUtilTest, PopulateCtxOutputs) {
   XlaOpRegistry::RegisterCompilationKernels();
   TF_EXPECT_OK(NodeDefBuilder("AddV2", "AddV2")
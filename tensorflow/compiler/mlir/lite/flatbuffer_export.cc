@@ -527,19 +527,38 @@ struct SignatureDefData {
   uint32_t subgraph_index;
 };
 
+// Returns the raw data of `attr` if it is already laid out as a TFLite buffer,
+// i.e. `attr` is a dense attribute of byte-sized integers or floats which isn't
+// a splat.
+std::optional<absl::string_view> GetRawBufferData(ElementsAttr attr) {
+  auto dense = attr.dyn_cast<mlir::DenseElementsAttr>();
+  if (!dense || dense.isSplat()) return std::nullopt;
+  mlir::Type element_type = dense.getElementType();
+  if (!element_type.isIntOrFloat() ||
+      element_type.getIntOrFloatBitWidth() % 8 != 0) {
+    return std::nullopt;
+  }
+  llvm::ArrayRef<char> raw_data = dense.getRawData();
+  if (raw_data.size() != dense.getNumElements() *
+                             (element_type.getIntOrFloatBitWidth() / 8)) {
+    return std::nullopt;
+  }
+  return absl::string_view(raw_data.data(), raw_data.size());
+}
+
 // Translates an MLIR module in TFLite dialect to TFLite FlatBuffer.
 class Translator {
  public:
-  // Translates the given MLIR module into TFLite FlatBuffer format and returns
-  // the serialized output. Returns std::nullopt on unsupported, invalid inputs
-  // or internal error.
-  static std::optional<std::string> Translate(
-      ModuleOp module, const toco::TocoFlags& toco_flags,
-      const std::unordered_set<std::string>& tags,
-      OpOrArgNameMapper* op_or_arg_name_mapper,
-      const std::map<std::string, std::string>& metadata,
-      bool serialize_stablehlo_ops,
-      std::optional<size_t> custom_option_alignment);
+  // Translates the given MLIR module into TFLite FlatBuffer format and writes
+  // the serialized output to `os`. Returns false on unsupported, invalid
+  // inputs or internal error, in which case nothing is written.
+  static bool Translate(ModuleOp module, const toco::TocoFlags& toco_flags,
+                        const std::unordered_set<std::string>& tags,
+                        OpOrArgNameMapper* op_or_arg_name_mapper,
+                        const std::map<std::string, std::string>& metadata,
+                        bool serialize_stablehlo_ops,
+                        std::optional<size_t> custom_option_alignment,
+                        llvm::raw_ostream& os);
 
  private:
   enum class OpType : char { kTfliteBuiltin, kSelectTf, kCustomOp };
@@ -584,7 +603,7 @@ class Translator {
         ->getOrLoadDialect<mlir::tf_executor::TensorFlowExecutorDialect>();
   }
 
-  std::optional<std::string> TranslateInternal();
+  bool TranslateInternal(llvm::raw_ostream& os);
 
   // Returns TFLite buffer populated with constant value if the operation is
   // TFLite constant operation. Otherwise, returns an empty buffer. Emits error
@@ -712,9 +731,14 @@ class Translator {
   // Check compatibility with GPU delegate and returns the compatibility.
   bool CheckGpuDelegateCompatibility(uint8_t* model_buffer_pointer);
 
-  // Append constant and custom op buffers at the end of the flatbuffer and
-  // calculate the offsets
-  void AppendBufferData(std::string& result);
+  // Calculates the offsets of the constant and custom op buffers appended
+  // after the flatbuffer of `model_size` bytes, and returns the total size.
+  uint64_t LayOutBufferData(uint64_t model_size);
+
+  // Writes the buffers laid out by LayOutBufferData, after the flatbuffer of
+  // `model_size` bytes.
+  void WriteBufferData(uint64_t model_size, uint64_t total_size,
+                       llvm::raw_ostream& os);
 
   // Update constant & custom op buffer offsets
   // Return false if fail to update offset
@@ -783,10 +807,28 @@ class Translator {
   absl::flat_hash_map<std::string, int> subgraph_index_map_;
   absl::flat_hash_set<OpType> enabled_op_types_;
 
+  // Data of a buffer appended after the flatbuffer. Dense constants are
+  // referenced in place since their attribute outlives the translation, only
+  // the converted ones are owned.
+  struct BufferData {
+    absl::string_view view;
+    std::vector<uint8_t> owned;
+
+    absl::string_view data() const {
+      return owned.empty()
+                 ? view
+                 : absl::string_view(reinterpret_cast<const char*>(
+                                         owned.data()),
+                                     owned.size());
+    }
+  };
+
   // Maps buffer data to corresponding buffer index
   // in the idx map, the value is a pair of offset and size
   absl::flat_hash_map<int, std::pair<uint64_t, uint64_t>> buffer_idx_map_;
-  absl::flat_hash_map<int, std::vector<uint8_t>> buffer_data_map_;
+  absl::flat_hash_map<int, BufferData> buffer_data_map_;
+  // Indices of the distinct buffers in buffer_data_map_, in file order.
+  std::vector<int> unique_buffer_indices_;
 
   // Maps custom options data to corresponding node
   // Key is set to be the list of input tensor indices and list of output tensor
@@ -918,7 +960,7 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
     auto packed_buffer = tflite::PackInt4ValuesDensely(data);
     if (use_buffer_offset_) {
-      buffer_data_map_[index] = packed_buffer;
+      buffer_data_map_[index].owned = std::move(packed_buffer);
       return tflite::CreateBuffer(builder_, 0, 1, 1);
     } else {
       if (IsModelBiggerThan2GB(packed_buffer.size())) {
@@ -931,6 +973,22 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     }
   }
 
+  // The raw data of dense numeric constants already has the layout of the
+  // buffer, which avoids materializing a copy of the largest constants.
+  if (std::optional<absl::string_view> raw_data = GetRawBufferData(attr)) {
+    if (use_buffer_offset_) {
+      buffer_data_map_[index].view = *raw_data;
+      return tflite::CreateBuffer(builder_, 0, 1, 1);
+    }
+    if (IsModelBiggerThan2GB(raw_data->size())) {
+      require_use_buffer_offset_ = true;
+      return empty_buffer_;
+    }
+    auto buffer_data = builder_.CreateVector(
+        reinterpret_cast<const uint8_t*>(raw_data->data()), raw_data->size());
+    return tflite::CreateBuffer(builder_, buffer_data);
+  }
+
   tensorflow::Tensor tensor;
   auto status = tensorflow::ConvertToTensor(attr, &tensor);
   if (!status.ok()) {
@@ -952,9 +1010,9 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
     char* tensor_buffer;
     int bytes = dynamic_buffer.WriteToBuffer(&tensor_buffer);
     if (use_buffer_offset_) {
-      std::vector<uint8_t> buffer_data(tensor_buffer, tensor_buffer + bytes);
+      buffer_data_map_[index].owned.assign(tensor_buffer,
+                                           tensor_buffer + bytes);
       free(tensor_buffer);
-      buffer_data_map_[index] = buffer_data;
       return tflite::CreateBuffer(builder_, 0, 1, 1);
     } else {
       if (IsModelBiggerThan2GB(bytes)) {
@@ -970,9 +1028,8 @@ std::optional<BufferOffset<tflite::Buffer>> Translator::BuildBuffer(
 
   absl::string_view tensor_data = tensor.tensor_data();
   if (use_buffer_offset_) {
-    std::vector<uint8_t> buffer_data(tensor_data.data(),
-                                     tensor_data.data() + tensor_data.size());
-    buffer_data_map_[index] = buffer_data;
+    buffer_data_map_[index].owned.assign(
+        tensor_data.data(), tensor_data.data() + tensor_data.size());
     return tflite::CreateBuffer(builder_, 0, 1, 1);
   } else {
     if (IsModelBiggerThan2GB(tensor_data.size())) {
@@ -2853,29 +2910,30 @@ bool UpdateEntryFunction(ModuleOp module) {
   return true;
 }
 
-std::optional<std::string> Translator::Translate(
-    ModuleOp module, const toco::TocoFlags& toco_flags,
-    const std::unordered_set<std::string>& tags,
-    OpOrArgNameMapper* op_or_arg_name_mapper,
-    const std::map<std::string, std::string>& metadata,
-    bool serialize_stablehlo_ops,
-    std::optional<size_t> custom_option_alignment) {
+bool Translator::Translate(ModuleOp module, const toco::TocoFlags& toco_flags,
+                           const std::unordered_set<std::string>& tags,
+                           OpOrArgNameMapper* op_or_arg_name_mapper,
+                           const std::map<std::string, std::string>& metadata,
+                           bool serialize_stablehlo_ops,
+                           std::optional<size_t> custom_option_alignment,
+                           llvm::raw_ostream& os) {
   OpOrArgLocNameMapper default_op_or_arg_name_mapper;
   if (!op_or_arg_name_mapper)
     op_or_arg_name_mapper = &default_op_or_arg_name_mapper;
-  if (!UpdateEntryFunction(module)) return std::nullopt;
-  if (!IsValidTFLiteMlirModule(module)) return std::nullopt;
+  if (!UpdateEntryFunction(module)) return false;
+  if (!IsValidTFLiteMlirModule(module)) return false;
   Translator translator(module, toco_flags, tags, op_or_arg_name_mapper,
                         metadata, custom_option_alignment);
   translator.convert_stablehlo_ = serialize_stablehlo_ops;
-  auto ret = translator.TranslateInternal();
+  // Nothing is written when the model is too big for a single flatbuffer.
+  auto ret = translator.TranslateInternal(os);
   if (translator.require_use_buffer_offset_) {
     auto new_toco_flags = toco_flags;
     new_toco_flags.set_use_buffer_offset(true);
     Translator new_translator(module, new_toco_flags, tags,
                               op_or_arg_name_mapper, metadata,
                               custom_option_alignment);
-    return new_translator.TranslateInternal();
+    return new_translator.TranslateInternal(os);
   }
   return ret;
 }
@@ -2906,7 +2964,7 @@ bool Translator::CheckGpuDelegateCompatibility(uint8_t* model_buffer_pointer) {
   return gpu_compatibile;
 }
 
-std::optional<std::string> Translator::TranslateInternal() {
+bool Translator::TranslateInternal(llvm::raw_ostream& os) {
   // A list of named regions in the module with main function being the first
   // in the list. The main function is required as the first subgraph in the
   // model is entry point for the model.
@@ -2965,7 +3023,7 @@ std::optional<std::string> Translator::TranslateInternal() {
   // index in the subgraph list.
   int subgraph_index = 0;
   for (const auto& it : llvm::enumerate(named_regions)) {
-    if (require_use_buffer_offset_ && !use_buffer_offset_) return std::nullopt;
+    if (require_use_buffer_offset_ && !use_buffer_offset_) return false;
     auto subgraph_or =
         BuildSubGraph(it.value().first, it.value().second, subgraph_index);
     if (!subgraph_or) {
@@ -3012,7 +3070,7 @@ std::optional<std::string> Translator::TranslateInternal() {
                     "https://www.tensorflow.org/lite/guide/ops_custom";
   }
 
-  if (require_use_buffer_offset_) return std::nullopt;
+  if (require_use_buffer_offset_) return false;
 
   if (first_failed_func != -1) {
     std::string failed_flex_ops_summary =
@@ -3077,7 +3135,7 @@ std::optional<std::string> Translator::TranslateInternal() {
   auto description = builder_.CreateString(model_description.data());
   VectorBufferOffset<int32_t> metadata_buffer = 0;  // Deprecated
   auto metadata = CreateMetadataVector();
-  if (!metadata) return std::nullopt;
+  if (!metadata) return false;
 
   std::vector<SignatureDefData> signature_defs_vec;
   subgraph_index = 0;
@@ -3107,77 +3165,104 @@ std::optional<std::string> Translator::TranslateInternal() {
   bool flatbuffer_limit_exceeded = builder_.GetSize() > flatbuffer_size_max;
   if (flatbuffer_limit_exceeded && require_use_buffer_offset_ == false) {
     require_use_buffer_offset_ = true;
-    return std::nullopt;
+    return false;
   }
   if (flatbuffer_limit_exceeded) {
     LOG(ERROR) << "Model structure size is bigger than 2gb";
-    return std::nullopt;
+    return false;
   }
   tflite::UpdateOpVersion(builder_.GetBufferPointer());
   tflite::UpdateMinimumRuntimeVersionForModel(builder_.GetBufferPointer());
   if (supported_backends_.find("GPU") != supported_backends_.end()) {
     if (!CheckGpuDelegateCompatibility(builder_.GetBufferPointer())) {
-      return std::nullopt;
+      return false;
     }
   }
 
-  auto result =
-      std::string(reinterpret_cast<const char*>(builder_.GetBufferPointer()),
-                  builder_.GetSize());
+  const uint64_t model_size = builder_.GetSize();
+  if (!use_buffer_offset_) {
+    os.write(reinterpret_cast<const char*>(builder_.GetBufferPointer()),
+             model_size);
+    return true;
+  }
 
-  // Return serialized string for the built FlatBuffer.
-  if (use_buffer_offset_) {
-    AppendBufferData(result);
-    auto mutable_model = tflite::GetMutableModel(result.data());
-    bool ret = UpdateBufferOffsets(mutable_model);
-    if (!ret) {
-      return std::nullopt;
-    }
-    return result;
+  // The offsets are patched into the flatbuffer before anything is written,
+  // so that the buffers can be streamed straight from the constants.
+  const uint64_t total_size = LayOutBufferData(model_size);
+  if (!UpdateBufferOffsets(
+          tflite::GetMutableModel(builder_.GetBufferPointer()))) {
+    return false;
   }
-  return result;
+  os.write(reinterpret_cast<const char*>(builder_.GetBufferPointer()),
+           model_size);
+  WriteBufferData(model_size, total_size, os);
+  return true;
 }
 
-void Translator::AppendBufferData(std::string& result) {
+uint64_t Translator::LayOutBufferData(uint64_t model_size) {
+  auto align_to = [](uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+  };
+  // Lay out the buffers in index order, so that the output is deterministic.
+  std::vector<int> indices;
+  indices.reserve(buffer_data_map_.size());
+  for (const auto& it : buffer_data_map_) indices.push_back(it.first);
+  absl::c_sort(indices);
+
   std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> hashcode_to_pos;
   // Pad to be 16 bytes aligned
-  while (result.size() % 16 != 0) result += '\0';
-  for (auto& it : buffer_data_map_) {
-    auto buffer = std::string(it.second.begin(), it.second.end());
-    int64_t index = it.first;
-    int64_t offset = result.size();
-    int64_t size = it.second.size();
+  uint64_t offset = align_to(model_size, 16);
+  for (int index : indices) {
+    absl::string_view buffer = buffer_data_map_[index].data();
     uint64_t hash = tsl::Fingerprint64(buffer);
     if (hashcode_to_pos.find(hash) == hashcode_to_pos.end()) {
-      hashcode_to_pos[hash] = std::make_pair(offset, size);
-      buffer_idx_map_[index] = std::make_pair(offset, size);
-      result += std::string(it.second.begin(), it.second.end());
+      hashcode_to_pos[hash] = std::make_pair(offset, buffer.size());
+      buffer_idx_map_[index] = std::make_pair(offset, buffer.size());
+      unique_buffer_indices_.push_back(index);
       // Pad to be 16 bytes aligned
-      while (result.size() % 16 != 0) result += '\0';
+      offset = align_to(offset + buffer.size(), 16);
     } else {
       // only update offset/index.
       buffer_idx_map_[index] = hashcode_to_pos[hash];
     }
   }
   // pad 16 bytes for the last buffer for XNNPack
-  result += "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0";
-  // pad to be 16 bytes aligned
-  while (result.size() % 16 != 0) result += '\0';
+  offset += 16;
 
   for (auto& it : custom_op_data_map_) {
-    while (result.size() % 16 != 0) result += '\0';
+    offset = align_to(offset, 16);
     if (custom_option_alignment_.has_value()) {
-      while (result.size() % custom_option_alignment_.value() != 0)
-        result += '\0';
+      offset = align_to(offset, custom_option_alignment_.value());
     }
-    auto buffer = std::string(it.second.begin(), it.second.end());
-    int64_t offset = result.size();
-    int64_t size = it.second.size();
-    custom_op_idx_map_[it.first] = std::make_pair(offset, size);
-    result += buffer;
+    custom_op_idx_map_[it.first] = std::make_pair(offset, it.second.size());
+    offset += it.second.size();
   }
   // pad to be 16 bytes aligned
-  while (result.size() % 16 != 0) result += '\0';
+  return align_to(offset, 16);
+}
+
+void Translator::WriteBufferData(uint64_t model_size, uint64_t total_size,
+                                 llvm::raw_ostream& os) {
+  uint64_t written = model_size;
+  auto pad_to = [&](uint64_t offset) {
+    os.write_zeros(offset - written);
+    written = offset;
+  };
+  for (int index : unique_buffer_indices_) {
+    pad_to(buffer_idx_map_[index].first);
+    absl::string_view buffer = buffer_data_map_[index].data();
+    os.write(buffer.data(), buffer.size());
+    written += buffer.size();
+    // The converted data isn't needed anymore.
+    buffer_data_map_[index] = BufferData();
+  }
+  for (auto& it : custom_op_data_map_) {
+    pad_to(custom_op_idx_map_[it.first].first);
+    os.write(reinterpret_cast<const char*>(it.second.data()),
+             it.second.size());
+    written += it.second.size();
+  }
+  pad_to(total_size);
 }
 
 bool Translator::UpdateBufferOffsets(tflite::Model* mutable_model) {
@@ -3382,13 +3467,25 @@ bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
                                        const FlatbufferExportOptions& options,
                                        std::string* serialized_flatbuffer,
                                        bool serialize_stablehlo_ops) {
-  auto maybe_translated = Translator::Translate(
+  std::string translated;
+  llvm::raw_string_ostream os(translated);
+  if (!MlirToFlatBufferTranslateFunction(module, options, os,
+                                         serialize_stablehlo_ops)) {
+    return false;
+  }
+  os.flush();
+  *serialized_flatbuffer = std::move(translated);
+  return true;
+}
+
+bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
+                                       const FlatbufferExportOptions& options,
+                                       llvm::raw_ostream& os,
+                                       bool serialize_stablehlo_ops) {
+  return Translator::Translate(
       module, options.toco_flags, options.saved_model_tags,
       options.op_or_arg_name_mapper, options.metadata, serialize_stablehlo_ops,
-      options.custom_option_alignment);
-  if (!maybe_translated) return false;
-  *serialized_flatbuffer = std::move(*maybe_translated);
-  return true;
+      options.custom_option_alignment, os);
 }
 
 }  // namespace tflite
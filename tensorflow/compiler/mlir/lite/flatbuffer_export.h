@@ -22,6 +22,7 @@ limitations under the License.
 #include <string>
 #include <unordered_set>
 
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/op_or_arg_name_mapper.h"
@@ -57,6 +58,17 @@ bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
                                        const FlatbufferExportOptions& options,
                                        std::string* serialized_flatbuffer,
                                        bool serialize_stablehlo_ops = false);
+
+// Same as above, but streams the serialized flatbuffer to `os`, e.g. an output
+// file. With `toco_flags.use_buffer_offset()`, or when the model is bigger than
+// 2GB, the constant buffers are written straight from the constants of
+// `module` instead of being buffered in memory.
+// Returns true on successful exporting, false otherwise, in which case nothing
+// is written to `os`.
+bool MlirToFlatBufferTranslateFunction(mlir::ModuleOp module,
+                                       const FlatbufferExportOptions& options,
+                                       llvm::raw_ostream& os,
+                                       bool serialize_stablehlo_ops = false);
 }  // namespace tflite
 
 #endif  // TENSORFLOW_COMPILER_MLIR_LITE_FLATBUFFER_EXPORT_H_
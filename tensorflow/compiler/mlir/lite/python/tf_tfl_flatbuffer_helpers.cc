@@ -269,6 +269,8 @@ Status PopulateQuantizationSpecs(
     quant_specs->weight_quantization = true;
     quant_specs->disable_per_channel =
         toco_flags.disable_per_channel_quantization();
+    quant_specs->fully_connected_weight_bit_width =
+        toco_flags.fully_connected_weight_bits();
     if (toco_flags.quantize_to_float16()) {
       quant_specs->inference_type = tensorflow::DT_HALF;
       quant_specs->inference_input_type = tensorflow::DT_HALF;
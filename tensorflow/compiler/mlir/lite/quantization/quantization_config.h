@@ -75,6 +75,13 @@ struct QuantizationSpecs {
   // in MLIR dynamic range quantizer with int8 weight data type.
   int64_t minimum_elements_for_weights = 1024;
 
+  // The bit width of the FullyConnected weights in MLIR dynamic range
+  // quantization, either 8 or 4. With 4, the weights whose shape is handled by
+  // the optimized 4-bit hybrid kernel of TFLite are quantized to int4, the
+  // others keep int8. Not applied with `weight_only_quantization`, since the
+  // Dequantize kernel doesn't support int4.
+  int64_t fully_connected_weight_bit_width = 8;
+
   // Calculate scales in float to keep quantized values the same with old TOCO
   // quantizer.
   bool legacy_float_scale = false;
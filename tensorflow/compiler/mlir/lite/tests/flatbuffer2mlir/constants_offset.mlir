@@ -142,6 +142,15 @@ func.func @sparse_qu8() -> tensor<3x2x!quant.uniform<u8<1:255>:f32, 1.0>> {
   func.return %0: tensor<3x2x!quant.uniform<u8<1:255>:f32, 1.0>>
 }
 
+func.func @duplicated_f32() -> (tensor<4xf32>, tensor<4xf32>) {
+  // CHECK-LABEL: @duplicated_f32
+  // CHECK: value = dense<[1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00]> : tensor<4xf32>
+  // CHECK: value = dense<[1.000000e+00, 2.000000e+00, 3.000000e+00, 4.000000e+00]> : tensor<4xf32>
+  %0 = "tfl.pseudo_const"() { value = dense<[1.0, 2.0, 3.0, 4.0]> : tensor<4xf32> } : () -> tensor<4xf32>
+  %1 = "tfl.pseudo_const"() { value = dense<[1.0, 2.0, 3.0, 4.0]> : tensor<4xf32> } : () -> tensor<4xf32>
+  func.return %0, %1 : tensor<4xf32>, tensor<4xf32>
+}
+
 // Identity function to make the exporter happy
 func.func @main(%arg0: tensor<4xi8>) -> tensor<4xi8> {
   func.return %arg0 : tensor<4xi8>
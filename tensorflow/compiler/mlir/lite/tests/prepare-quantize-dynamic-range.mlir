@@ -5,6 +5,7 @@
 // RUN: tf-opt %s -tfl-prepare-quantize-dynamic-range="min-elements-for-weights=4000 enable-custom-op-quantization=CustomTestOp=1-3,CustomTestOp3=3" | FileCheck --check-prefix=MinElement %s
 // RUN: tf-opt %s -tfl-prepare-quantize-dynamic-range="min-elements-for-weights=19" | FileCheck --check-prefix=LSTMOpQuantized %s
 // RUN: tf-opt %s -tfl-prepare-quantize-dynamic-range="min-elements-for-weights=21" | FileCheck --check-prefix=LSTMOpNotQuantized %s
+// RUN: tf-opt %s -tfl-prepare-quantize-dynamic-range="fully-connected-weight-bits=4" | FileCheck --check-prefix=Int4 %s
 
 // CHECK-LABEL: QuantizeConv2D
 // PerTensor-LABEL: QuantizeConv2D
@@ -119,6 +120,25 @@ func.func @QuantizeFullyConnected(%arg0: tensor<1x224x224x3xf32>) -> tensor<1x11
 // PerTensor-NOT: fused_activation_function = "NONE"
 // PerTensor-SAME: asymmetric_quantize_inputs = true
 // PerTensor: return %[[fc:.*]]
+
+// The input depth is too small for the 4-bit kernel.
+// Int4-LABEL: QuantizeFullyConnected
+// Int4: "tfl.quantize"(%{{.*}}) {qtype = tensor<512x12x!quant.uniform<i8<-127:127>:f32, 1.000000e+00>>}
+}
+
+// Int4-LABEL: QuantizeFullyConnectedTo4Bits
+func.func @QuantizeFullyConnectedTo4Bits(%arg0: tensor<1x32xf32>) -> tensor<1x64xf32> {
+  %w = arith.constant dense<7.0> : tensor<64x32xf32>
+  %b = arith.constant dense<0.0> : tensor<64xf32>
+  %fc = "tfl.fully_connected"(%arg0, %w, %b) {fused_activation_function = "NONE", keep_num_dims = false, weights_format = "DEFAULT"} : (tensor<1x32xf32>, tensor<64x32xf32>, tensor<64xf32>) -> tensor<1x64xf32>
+  func.return %fc : tensor<1x64xf32>
+
+// Int4-DAG: %[[w:.*]] = arith.constant dense<7.000000e+00> : tensor<64x32xf32>
+// Int4-DAG: %[[q_w:.*]] = "tfl.quantize"(%[[w]]) {qtype = tensor<64x32x!quant.uniform<i4<-7:7>:f32, 1.000000e+00>>}
+// Int4-DAG: %[[dq_w:.*]] = "tfl.dequantize"(%[[q_w]]) : (tensor<64x32x!quant.uniform<i4<-7:7>:f32, 1.000000e+00>>) -> tensor<64x32xf32>
+// Int4: %[[fc:.*]] = "tfl.fully_connected"(%arg0, %[[dq_w]], %{{.*}}) {
+// Int4-SAME: asymmetric_quantize_inputs = true
+// Int4: return %[[fc]]
 }
 
 // CHECK-LABEL: QuantizeBatchMatmulWithActConst
@@ -446,7 +446,9 @@ void AddPostVariableFreezingTFToTFLConversionPasses(
                    .RunAndRewriteDynamicRangeQuantizationPasses()) {
       AddDynamicRangeQuantizationPasses(pass_config, *pass_manager);
     }
-    pass_manager->addPass(mlir::createCanonicalizerPass());
+    // Nested, so that the functions are canonicalized in parallel.
+    pass_manager->addNestedPass<mlir::func::FuncOp>(
+        mlir::createCanonicalizerPass());
 
     if (pass_config.reduce_type_precision ||
         toco_flags.reduce_type_precision()) {
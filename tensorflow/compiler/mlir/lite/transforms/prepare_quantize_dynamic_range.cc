@@ -48,6 +48,12 @@ namespace {
 // asymmetrically quantized.
 constexpr char kAsymmetricQuantizeInputsAttr[] = "asymmetric_quantize_inputs";
 
+// The smallest number of output channels and input depth of the FullyConnected
+// weights handled by the optimized 4-bit kernel of TFLite, see
+// tensorflow/lite/kernels/internal/optimized/fully_connected_4bit.h.
+constexpr int64_t kMin4BitFullyConnectedChannels = 4;
+constexpr int64_t kMin4BitFullyConnectedDepth = 32;
+
 using QuantizationUnits = llvm::SetVector<std::pair<Operation*, int>>;
 
 // Applies prepare dynamic range quantization on the model in TFL dialect.
@@ -73,6 +79,8 @@ class PrepareDynamicRangeQuantizePass
     enable_dynamic_range_per_channel_quantization_ =
         !quant_specs_.disable_per_channel;
     min_elements_for_weights_ = quant_specs_.minimum_elements_for_weights;
+    fully_connected_weight_bits_ =
+        quant_specs_.fully_connected_weight_bit_width;
   }
 
   // The function might contain stats ops which are redundant for processing
@@ -81,6 +89,9 @@ class PrepareDynamicRangeQuantizePass
   // method preprocess the function to remove all stats ops.
   void removeAllStatsOp(func::FuncOp func);
 
+  // Emits a remark with the size of the weights quantized in `func`.
+  void reportQuantizedWeights(func::FuncOp func);
+
   void runOnOperation() override;
 
  private:
@@ -290,6 +301,9 @@ class PrepareDynamicRangeQuantizableOp
           << quant_specs_.minimum_elements_for_weights << " elements).";
       return false;
     }
+    if (isQuantizableAs4Bit(quantize_op, quantize_operand_num, attr)) {
+      bit_width = 4;
+    }
 
     if (op_with_per_axis_support) {
       quant_type = quant::GetUniformQuantizedPerAxisTypeForWeight(
@@ -306,6 +320,26 @@ class PrepareDynamicRangeQuantizableOp
     return insertQDQ(rewriter, op, quant_type, quant_op);
   }
 
+  // Whether the weights `attr` at `operand_index` of `op` are quantized to
+  // int4, i.e. they are FullyConnected weights that the optimized 4-bit hybrid
+  // kernel handles. Otherwise, the reference kernel would unpack the weights
+  // at every invocation.
+  bool isQuantizableAs4Bit(Operation* op, int operand_index,
+                           DenseFPElementsAttr attr) const {
+    if (quant_specs_.fully_connected_weight_bit_width != 4 ||
+        quant_specs_.weight_only_quantization ||
+        !quant_specs_.IsSignedInferenceType()) {
+      return false;
+    }
+    auto fc = llvm::dyn_cast<FullyConnectedOp>(op);
+    if (!fc || operand_index != 1 || fc.getWeightsFormat() != "DEFAULT") {
+      return false;
+    }
+    auto shape = attr.getType().getShape();
+    return shape.size() == 2 && shape[0] >= kMin4BitFullyConnectedChannels &&
+           shape[1] >= kMin4BitFullyConnectedDepth && shape[1] % 2 == 0;
+  }
+
   // Insert Quantize and Dequantize ops.
   bool insertQDQ(PatternRewriter& rewriter, arith::ConstantOp op,
                  QuantizedType quant_type,
@@ -474,6 +508,7 @@ void PrepareDynamicRangeQuantizePass::runOnOperation() {
   quant_specs_.disable_per_channel =
       !enable_dynamic_range_per_channel_quantization_;
   quant_specs_.minimum_elements_for_weights = min_elements_for_weights_;
+  quant_specs_.fully_connected_weight_bit_width = fully_connected_weight_bits_;
 
   if (!enable_custom_op_quantization_.empty()) {
     ParseCustomOpSpecs(enable_custom_op_quantization_,
@@ -490,6 +525,30 @@ void PrepareDynamicRangeQuantizePass::runOnOperation() {
   (void)applyPatternsAndFoldGreedily(func, std::move(patterns));
 
   ConvertMlirQuantOpsToTFLQuantOps(func);
+  if (quant_specs_.inference_type == tensorflow::DT_QINT8) {
+    reportQuantizedWeights(func);
+  }
+}
+
+void PrepareDynamicRangeQuantizePass::reportQuantizedWeights(
+    func::FuncOp func) {
+  int64_t num_weights = 0, num_4bit_weights = 0;
+  int64_t float_bytes = 0, quantized_bytes = 0;
+  func.walk([&](QuantizeOp q_op) {
+    if (!q_op.getInput().getDefiningOp<arith::ConstantOp>()) return;
+    auto type = q_op.getType().dyn_cast<ShapedType>();
+    auto qtype = quant::QuantizedType::getQuantizedElementType(type);
+    if (!type || !type.hasStaticShape() || !qtype) return;
+    const int bit_width = qtype.getStorageTypeIntegralWidth();
+    ++num_weights;
+    num_4bit_weights += bit_width == 4;
+    float_bytes += type.getNumElements() * sizeof(float);
+    quantized_bytes += (type.getNumElements() * bit_width + 7) / 8;
+  });
+  if (num_weights == 0) return;
+  func.emitRemark() << "Dynamic range quantization of " << num_weights
+                    << " weights (" << num_4bit_weights << " in 4 bits) from "
+                    << float_bytes << " to " << quantized_bytes << " bytes.";
 }
 
 }  // namespace
@@ -76,3 +76,19 @@ func.func @not_fuse_promise_return(%p: !mlrt.promise, %v: !tf_mlrt.tensor) -> (!
   tf_mlrt.promise %p, %v
   func.return %v : !tf_mlrt.tensor
 }
+
+// -----
+
+// CHECK-LABEL: @fuse_await_promise
+// CHECK-SAME: ([[p0:%.*]]: !mlrt.promise, [[p1:%.*]]: !mlrt.promise, [[f0:%.*]]: !mlrt.future, [[f1:%.*]]: !mlrt.future)
+func.func @fuse_await_promise(%p0: !mlrt.promise, %p1: !mlrt.promise, %f0: !mlrt.future, %f1: !mlrt.future) -> (!tf_mlrt.tensor) {
+  // CHECK-NEXT: [[t1:%.*]] = tf_mlrt.await [[f1]]
+  // CHECK-NEXT: tf_mlrt.promise_future [[p0]], [[f0]]
+  // CHECK-NEXT: tf_mlrt.promise [[p1]], [[t1]]
+  // CHECK-NEXT: return [[t1]]
+  %t0 = tf_mlrt.await %f0
+  %t1 = tf_mlrt.await %f1
+  tf_mlrt.promise %p0, %t0
+  tf_mlrt.promise %p1, %t1
+  func.return %t1 : !tf_mlrt.tensor
+}
@@ -91,7 +91,8 @@ CompileAndRegisterIfrtPrograms(absl::string_view model_name,
     auto executable = std::make_unique<IfrtServingExecutable>(
         model_name, entry_function_name.str(), *std::move(submodule),
         ifrt_model_context.GetClient(),
-        ifrt_model_context.GetShapeRepresentationFn());
+        ifrt_model_context.GetShapeRepresentationFn(),
+        ifrt_model_context.compilation_cache_dir());
 
     // Register the Ifrt program to `ServingExecutableRegistry` so that
     // the client TF program can invoke them via `IfrtCall` op.
@@ -35,7 +35,8 @@ class FuseMlrtOpPass
   llvm::StringRef getArgument() const final { return "tf-mlrt-fuse"; }
 
   llvm::StringRef getDescription() const final {
-    return "Fuse consecutive mlrt ops of the same kind into one.";
+    return "Fuse consecutive mlrt ops of the same kind, and common sequences "
+           "of mlrt ops, into one.";
   }
 
   void runOnOperation() override;
@@ -132,6 +133,31 @@ void FuseAwaitOps(mlir::OpBuilder& builder, mlir::Block& block) {
   }
 }
 
+// Fuses an await whose tensor is only set in a promise into a promise_future,
+// so that the function doesn't suspend for the tensor, and the tensor is
+// forwarded to the promise without going through a register.
+void FuseAwaitPromise(mlir::OpBuilder& builder, mlir::Block& block) {
+  llvm::SmallVector<tf_mlrt::AwaitOp> await_ops;
+  for (auto& op : block) {
+    if (auto await_op = llvm::dyn_cast<tf_mlrt::AwaitOp>(&op)) {
+      await_ops.push_back(await_op);
+    }
+  }
+
+  for (auto await_op : await_ops) {
+    if (!await_op.getResult().hasOneUse()) continue;
+    auto promise_op = llvm::dyn_cast<tf_mlrt::PromiseOp>(
+        *await_op.getResult().getUsers().begin());
+    if (!promise_op || promise_op->getBlock() != &block) continue;
+
+    builder.setInsertionPoint(promise_op);
+    builder.create<tf_mlrt::PromiseFutureOp>(
+        promise_op->getLoc(), promise_op.getPromise(), await_op.getFuture());
+    promise_op->erase();
+    await_op->erase();
+  }
+}
+
 void FusePromiseReturn(mlir::OpBuilder& builder, mlir::Block& block) {
   auto* terminator = block.getTerminator();
   auto return_op = llvm::dyn_cast<mlir::func::ReturnOp>(terminator);
@@ -154,6 +180,8 @@ void FuseMlrtOpPass::runOnOperation() {
 
   mlir::OpBuilder builder(func);
 
+  // Runs before FuseAwaitOps(), which would merge these awaits with others.
+  FuseAwaitPromise(builder, func.front());
   FuseAwaitOps<tf_mlrt::AwaitOp, tf_mlrt::AwaitAllOp, tf_mlrt::TFTensorType>(
       builder, func.front());
   FuseAwaitOps<mlrt::compiler::AwaitHandleOp, mlrt::compiler::AwaitAllHandleOp>(
@@ -55,11 +55,16 @@ string DebugString(const TrtPrecisionMode mode);
 // - `kRangeOptimal`: create the profiles for both `Range` and `Optimal`.
 // - `kImplicitBatchModeCompatible`: create the profiles that will produce the
 //   same GPU engines as the implicit_batch_mode would produce.
+// - `kClustered`: group the provided inputs into a few ranges of similar
+//   inputs, and create one profile for each range, optimized for its most
+//   frequent input. The ranges minimize the padding of the inputs to the max
+//   dims of their range, weighted by how often each input was provided.
 enum class ProfileStrategy {
   kRange,
   kOptimal,
   kRangeOptimal,
   kImplicitBatchModeCompatible,
+  kClustered,
 };
 
 string ProfileStrategyToName(const ProfileStrategy strategy);
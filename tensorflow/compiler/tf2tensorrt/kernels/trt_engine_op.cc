@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
@@ -42,10 +43,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/util/env_var.h"
@@ -132,6 +135,22 @@ class AsyncHelper : public core::RefCounted {
   AsyncOpKernel::DoneCallback done_;
 };
 
+// Returns the pool which builds the engines in the background while the native
+// segments run.
+thread::ThreadPool* AsyncEngineBuildThreadPool() {
+  static thread::ThreadPool* pool = [] {
+    int64_t num_threads;
+    Status status = ReadInt64FromEnvVar("TF_TRT_NUM_ASYNC_ENGINE_BUILD_THREADS",
+                                        /*default_val=*/1, &num_threads);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+    }
+    return new thread::ThreadPool(Env::Default(), "tf_trt_engine_build",
+                                  std::max<int64_t>(num_threads, 1));
+  }();
+  return pool;
+}
+
 }  // end anonymous namespace
 
 //  This OP can construct TRTEngine on the fly and if construction of engine
@@ -140,6 +159,8 @@ class TRTEngineOp : public AsyncOpKernel {
  public:
   explicit TRTEngineOp(OpKernelConstruction* context);
 
+  ~TRTEngineOp() override;
+
   void ComputeAsync(OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
@@ -188,13 +209,29 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& input_concrete_shapes,
       OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
 
-  // Builds and returns a cuda engine for the input shapes. If building the
-  // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // Builds and returns a cuda engine for the input shapes on the device named
+  // device_name. ctx is only needed to convert the resource inputs and may be
+  // null otherwise. If building the engine fails, the caller should enter a
+  // dummy entry into the cache_resource cache so we don't continually try to
+  // build the same failing engine.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
-      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
+      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx,
+      const string& device_name);
+
+  // Returns whether the engine for new input shapes is built on
+  // AsyncEngineBuildThreadPool() while the native segment runs.
+  bool CanBuildEngineAsync() const;
+
+  // Schedules building the engine for the input shapes on
+  // AsyncEngineBuildThreadPool(), unless an engine for compatible shapes is
+  // already being built. The engine is added to the cache of cache_res once
+  // built.
+  void BuildEngineAsync(const std::vector<TensorShape>& input_concrete_shapes,
+                        const string& device_name,
+                        TRTEngineCacheResource* cache_res)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
 
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
@@ -237,6 +274,10 @@ class TRTEngineOp : public AsyncOpKernel {
   // Whether to build TensorRT engines at runtime.
   bool allow_build_at_runtime_;
 
+  // Whether to build the TensorRT engines at runtime in the background, using
+  // the native segment until they are built.
+  bool async_engine_build_;
+
   // Whether to allow soft placement when the graph is executed with native
   // TensorFlow.
   bool allow_soft_placement_;
@@ -249,6 +290,13 @@ class TRTEngineOp : public AsyncOpKernel {
 
   int64 workspace_size_;
   mutex engine_mutex_;
+
+  // The input shapes of the engines being built on
+  // AsyncEngineBuildThreadPool(). The destructor waits for them to be built.
+  std::vector<std::vector<TensorShape>> async_engine_shapes_
+      TF_GUARDED_BY(engine_mutex_);
+  condition_variable async_engine_built_;
+
   FunctionLibraryRuntime::Handle native_execution_func_handle_;
 
   // The finalized calibrator for inference.
@@ -430,6 +478,9 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
                  context->GetAttr("use_calibration", &use_calibration_));
   OP_REQUIRES_OK(context,
                  context->GetAttr("input_shapes", &input_partial_shapes_));
+  OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_TRT_ASYNC_ENGINE_BUILD",
+                                              /*default_val=*/false,
+                                              &async_engine_build_));
   auto status =
       context->GetAttr("_allow_build_at_runtime", &allow_build_at_runtime_);
   if (status.code() == tensorflow::error::NOT_FOUND) {
@@ -552,6 +603,13 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
           << has_dynamic_shape_input_;
 }
 
+TRTEngineOp::~TRTEngineOp() {
+  mutex_lock lock(engine_mutex_);
+  while (!async_engine_shapes_.empty()) {
+    async_engine_built_.wait(lock);
+  }
+}
+
 // Copies input tensor ctx->input(i) (which is in device memory) to the host,
 // and place the resulting host tensor to the back of native_inputs.
 Status CopyToHostAsync(OpKernelContext* ctx, std::vector<Tensor>* native_inputs,
@@ -1091,7 +1149,6 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::BuildEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   TRT_ENSURE(cache_resource);
-  TRT_ENSURE(ctx);
   // Use concrete shapes for implicit batch mode and partial shapes for
   // explicit batch mode.
   bool use_concrete_shapes =
@@ -1107,9 +1164,8 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
 
   std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
-  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  DeviceNameUtils::ParseFullName(device_name, &full_parsed_name);
+  device_map.emplace(device_name, grappler::GetDeviceInfo(full_parsed_name));
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
@@ -1118,21 +1174,80 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
       conversion_input_shapes, &logger, cache_resource->allocator_.get(),
       calibrator, &engine, use_calibration, use_implicit_batch_, nullptr,
       &cache_resource->profiles_, name(), use_explicit_precision_, &cluster,
-      ctx->device()->name());
+      device_name);
   if (!status.ok()) {
     LOG_FIRST_FEW_WARNING_WITH_PREFIX
         << "Engine creation for " << name() << " failed. "
         << "The native segment will be used instead. "
         << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   std::make_unique<EngineContext>());
     return status;
   }
   return engine;
 }
 
+bool TRTEngineOp::CanBuildEngineAsync() const {
+  // The engines of explicit batch mode depend on the profiles of the cache
+  // resource, and resource inputs are converted from the OpKernelContext,
+  // which doesn't outlive the execution.
+  return async_engine_build_ && use_implicit_batch_ &&
+         !native_segment_absent_ && AllowEngineNativeSegmentExecution() &&
+         absl::c_all_of(input_mask_, [](bool is_input) { return is_input; });
+}
+
+void TRTEngineOp::BuildEngineAsync(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    const string& device_name, TRTEngineCacheResource* cache_res) {
+  for (const std::vector<TensorShape>& shapes : async_engine_shapes_) {
+    if (AreShapesCompatible(input_concrete_shapes, shapes)) {
+      return;
+    }
+  }
+  VLOG(1) << "Building a new TensorRT engine for " << name()
+          << " in the background, the native segment is used meanwhile.";
+  // The executions run with the CUDA device of the op as the current device,
+  // the engine must be built on the same device.
+  int cuda_device_id = 0;
+  cudaGetDevice(&cuda_device_id);
+  async_engine_shapes_.push_back(input_concrete_shapes);
+  cache_res->Ref();
+  AsyncEngineBuildThreadPool()->Schedule([this, input_concrete_shapes,
+                                          device_name, cuda_device_id,
+                                          cache_res]() {
+    core::ScopedUnref unref_cache_res(cache_res);
+    cudaSetDevice(cuda_device_id);
+    auto result = BuildEngine(input_concrete_shapes,
+                              input_concrete_shapes[0].dim_size(0),
+                              use_calibration_, calibrator_.get(), cache_res,
+                              /*ctx=*/nullptr, device_name);
+    mutex_lock lock(engine_mutex_);
+    std::unique_ptr<EngineContext> engine_context;
+    if (result.ok()) {
+      std::vector<ExecutionContext> exec_contexts;
+      Status status = cache_res->profiles_.CreateExecutionContexts(
+          result.value().get(), &exec_contexts);
+      if (status.ok()) {
+        engine_context = std::make_unique<EngineContext>(
+            std::move(result.value()), std::move(exec_contexts));
+      } else {
+        LOG_FIRST_FEW_WARNING_WITH_PREFIX
+            << "Creating the execution contexts of the engine for " << name()
+            << " failed: " << status;
+      }
+    }
+    // A failed engine is stored as an empty engine, so we don't try to build
+    // the same failing engine again.
+    if (engine_context == nullptr) {
+      engine_context = std::make_unique<EngineContext>();
+    }
+    cache_res->cache_.emplace(input_concrete_shapes, std::move(engine_context));
+    VLOG(1) << "Added new engine to cache of " << name()
+            << ". Cache size: " << cache_res->cache_.size();
+    async_engine_shapes_.erase(absl::c_find(async_engine_shapes_,
+                                            input_concrete_shapes));
+    async_engine_built_.notify_all();
+  });
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -1220,8 +1335,12 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       }
       auto result = BuildEngine(input_concrete_shapes, batch_size,
                                 /*use_calibration=*/false,
-                                /*calibrator=*/nullptr, cache_res, ctx);
+                                /*calibrator=*/nullptr, cache_res, ctx,
+                                ctx->device()->name());
       if (!result.ok()) {
+        // Store an empty engine in the cache for these input shapes so we
+        // don't try to build the same failing engine again.
+        cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
       static_engine = std::move(result.value());
@@ -1290,12 +1409,20 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    if (CanBuildEngineAsync()) {
+      BuildEngineAsync(input_concrete_shapes, ctx->device()->name(), cache_res);
+      return std::pair<EngineContext*, int>(&empty_context, 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result =
         BuildEngine(input_concrete_shapes, batch_size, use_calibration_,
-                    calibrator_.get(), cache_res, ctx);
+                    calibrator_.get(), cache_res, ctx, ctx->device()->name());
     if (!result.ok()) {
+      // Store an empty engine in the cache for these input shapes so we don't
+      // try to build the same failing engine again.
+      cache.emplace(input_concrete_shapes, std::make_unique<EngineContext>());
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
     TrtUniquePtrType<nvinfer1::ICudaEngine> engine = std::move(result.value());
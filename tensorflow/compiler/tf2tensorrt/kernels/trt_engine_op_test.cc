@@ -257,6 +257,30 @@ TEST_F(TRTEngineOpTestBase, DynamicEngines) {
   EXPECT_EQ(1, cache->count({TensorShape({10, 10})}));
 }
 
+TEST_F(TRTEngineOpTestBase, AsyncEngineBuild) {
+  setenv("TF_TRT_ASYNC_ENGINE_BUILD", "1", /*overwrite=*/1);
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT, /*max_cached_engines_count=*/4);
+  unsetenv("TF_TRT_ASYNC_ENGINE_BUILD");
+
+  // The first execution runs the native segment while the engine is built.
+  TensorShape input_shape({2, 2});
+  TRTEngineOpTestBase::AddSimpleInput<float>(input_shape);
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+
+  // Get the engine cache.
+  TRTEngineCacheResource* cache_resource = nullptr;
+  TF_ASSERT_OK(device_->resource_manager()->Lookup(
+      std::string(kTfTrtContainerName), std::string(kOpName), &cache_resource));
+  core::ScopedUnref sc(cache_resource);
+
+  // Destroying the op waits for the engine to be built.
+  kernel_.reset();
+  auto cache = &cache_resource->cache_;
+  EXPECT_EQ(1, cache->size());
+  ASSERT_EQ(1, cache->count({input_shape}));
+  EXPECT_NE(cache->at({input_shape})->GetCudaEngine(), nullptr);
+}
+
 TEST_F(TRTEngineOpTestBase, AllowBuildAtRuntime) {
   TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT, /*max_cached_engines_count=*/1,
                                       PartialTensorShape({-1, -1}),
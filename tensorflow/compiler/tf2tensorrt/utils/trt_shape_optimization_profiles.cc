@@ -16,7 +16,10 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <numeric>
 
 #include "absl/algorithm/container.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
@@ -125,6 +128,108 @@ Status TrtShapeOptimizationProfile::RangeStrategy(
   return OkStatus();
 }
 
+// Returns the number of elements of the input tensors of dimvec, leaving out
+// the shape values which follow them.
+int64_t NumInputElements(const std::vector<nvinfer1::Dims>& dimvec) {
+  int64_t num_elements = 0;
+  for (int i = 0; i < dimvec.size() / 2; i++) {
+    int64_t tensor_elements = 1;
+    for (int j = 0; j < dimvec[i].nbDims; j++) {
+      tensor_elements *= dimvec[i].d[j];
+    }
+    num_elements += tensor_elements;
+  }
+  return num_elements;
+}
+
+// The maximum number of profiles of the Clustered strategy.
+constexpr int kMaxClusteredProfiles = 4;
+
+Status TrtShapeOptimizationProfile::ClusteredStrategy(
+    const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes,
+    const std::vector<int64_t>& counts) {
+  if (collected_shapes.empty()) return OkStatus();
+
+  // The clusters are ranges of the shapes sorted by their number of elements.
+  const int n = collected_shapes.size();
+  std::vector<int> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::vector<int64_t> num_elements(n);
+  for (int i = 0; i < n; i++) {
+    num_elements[i] = NumInputElements(collected_shapes[i]);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return num_elements[a] < num_elements[b];
+  });
+
+  // padding[a][b] is the number of elements added by padding the shapes
+  // order[a..b] to their max dims, weighted by their counts.
+  std::vector<std::vector<int64_t>> padding(n, std::vector<int64_t>(n));
+  for (int a = 0; a < n; a++) {
+    std::vector<nvinfer1::Dims> max = collected_shapes[order[a]];
+    int64_t total_count = 0;
+    int64_t total_elements = 0;
+    for (int b = a; b < n; b++) {
+      TF_RETURN_IF_ERROR(
+          ShapeProfileBinaryOp(&max, collected_shapes[order[b]],
+                               [](int x, int y) { return std::max(x, y); }));
+      total_count += counts[order[b]];
+      total_elements += counts[order[b]] * num_elements[order[b]];
+      padding[a][b] = total_count * NumInputElements(max) - total_elements;
+    }
+  }
+
+  // cost[k][b] is the least padding of the shapes order[0..b] split into k + 1
+  // clusters, the last of which starts at order[start[k][b]].
+  const int num_profiles = std::min(n, kMaxClusteredProfiles);
+  std::vector<std::vector<int64_t>> cost(num_profiles,
+                                         std::vector<int64_t>(n));
+  std::vector<std::vector<int>> start(num_profiles, std::vector<int>(n));
+  for (int b = 0; b < n; b++) {
+    cost[0][b] = padding[0][b];
+  }
+  for (int k = 1; k < num_profiles; k++) {
+    for (int b = k; b < n; b++) {
+      cost[k][b] = std::numeric_limits<int64_t>::max();
+      for (int a = k; a <= b; a++) {
+        const int64_t c = cost[k - 1][a - 1] + padding[a][b];
+        if (c < cost[k][b]) {
+          cost[k][b] = c;
+          start[k][b] = a;
+        }
+      }
+    }
+  }
+
+  std::vector<OptimizationProfileConfig> profiles(num_profiles);
+  for (int k = num_profiles - 1, b = n - 1; k >= 0; b = start[k][b] - 1, k--) {
+    const int a = start[k][b];
+    std::vector<nvinfer1::Dims> min = collected_shapes[order[a]];
+    std::vector<nvinfer1::Dims> max = min;
+    int opt = order[a];
+    for (int i = a + 1; i <= b; i++) {
+      const std::vector<nvinfer1::Dims>& shape_vec =
+          collected_shapes[order[i]];
+      TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+          &min, shape_vec, [](int x, int y) { return std::min(x, y); }));
+      TF_RETURN_IF_ERROR(ShapeProfileBinaryOp(
+          &max, shape_vec, [](int x, int y) { return std::max(x, y); }));
+      if (counts[order[i]] > counts[opt]) {
+        opt = order[i];
+      }
+    }
+    VLOG(2) << "Initializing optimization profile config with min="
+            << DebugString(min)
+            << ", opt=" << DebugString(collected_shapes[opt])
+            << ", max=" << DebugString(max);
+    profiles[k] = OptimizationProfileConfig{min, collected_shapes[opt], max};
+  }
+  for (OptimizationProfileConfig& profConfig : profiles) {
+    profiles_.push_back(std::move(profConfig));
+  }
+  return OkStatus();
+}
+
 void TrtShapeOptimizationProfile::OptimalStrategy(
     const std::vector<std::vector<nvinfer1::Dims>>& collected_shapes) {
   for (auto& shape_vec : collected_shapes) {
@@ -240,10 +345,11 @@ void FixShapeValueProfile(OptimizationProfileConfig* prof,
   }
 }
 
-// Checks whether rhs is already contained in values.
-bool AlreadyCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
-                      const std::vector<nvinfer1::Dims>& rhs) {
-  for (auto& lhs : values) {
+// Returns the index of rhs in values, or -1 if rhs is not contained in values.
+int FindCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
+                  const std::vector<nvinfer1::Dims>& rhs) {
+  for (int k = 0; k < values.size(); k++) {
+    const std::vector<nvinfer1::Dims>& lhs = values[k];
     bool ret = lhs.size() == rhs.size();
     for (int i = 0; ret && i < lhs.size(); i++) {
       ret &= lhs[i].nbDims == rhs[i].nbDims;
@@ -251,9 +357,9 @@ bool AlreadyCollected(const std::vector<std::vector<nvinfer1::Dims>>& values,
         ret &= (lhs[i].d[j] == rhs[i].d[j]);
       }
     }
-    if (ret) return true;
+    if (ret) return k;
   }
-  return false;
+  return -1;
 }
 
 void TrtShapeOptimizationProfile::InitProfiles(
@@ -269,8 +375,10 @@ void TrtShapeOptimizationProfile::InitProfiles(
   // - Converts TensorShape -> nvinfer::Dims.
   // - Concatenates the shape values after the input shapes:
   //   dimvec = [dim0, dim1,..., shapeval0, shapval1, ...]
-  // - Ensures that the list is unique.
+  // - Ensures that the list is unique, counting how often each element was
+  //   collected.
   std::vector<std::vector<nvinfer1::Dims>> collected_shapes;
+  std::vector<int64_t> counts;
   for (int i = 0; i < input_shapes_.size(); i++) {
     auto shape_vec = input_shapes_[i];
     VLOG(2) << "Initprofiles, processing shape " << i;
@@ -287,8 +395,12 @@ void TrtShapeOptimizationProfile::InitProfiles(
       // that case consicutive elements in collected_shapes contain the user
       // defined values of min, opt and max, and it is valid the have min = opt
       // and opt = max.
-      if (!AlreadyCollected(collected_shapes, dimvec)) {
+      const int index = FindCollected(collected_shapes, dimvec);
+      if (index == -1) {
         collected_shapes.push_back(dimvec);
+        counts.push_back(1);
+      } else {
+        counts[index]++;
       }
     }
   }
@@ -312,6 +424,10 @@ void TrtShapeOptimizationProfile::InitProfiles(
       VLOG(1) << "Creating profiles with Optimal strategy";
       OptimalStrategy(collected_shapes);
       break;
+    case ProfileStrategy::kClustered:
+      VLOG(1) << "Creating profiles with Clustered strategy";
+      TF_CHECK_OK(ClusteredStrategy(collected_shapes, counts));
+      break;
   }
   // Define a mask that describe which input could be a shape tensor. Note
   // that here we can have false positives. The shape tensor mask will be
@@ -152,7 +152,8 @@ INSTANTIATE_TEST_CASE_P(
     OptProfilesTestInstantiation, TrtShapeOptimizationProfileTest,
     ::testing::Values(ProfileStrategy::kRange, ProfileStrategy::kOptimal,
                       ProfileStrategy::kRangeOptimal,
-                      ProfileStrategy::kImplicitBatchModeCompatible));
+                      ProfileStrategy::kImplicitBatchModeCompatible,
+                      ProfileStrategy::kClustered));
 
 TEST_P(TrtShapeOptimizationProfileTest, Static) {
   // Static mode does not depend on strategies, we test only once.
@@ -223,6 +224,7 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   switch (strategy_) {
     case (ProfileStrategy::kImplicitBatchModeCompatible):
     case (ProfileStrategy::kOptimal):
+    case (ProfileStrategy::kClustered):
       n_profiles_exp = input_profiles.size();
       break;
     case (ProfileStrategy::kRange):
@@ -242,7 +244,8 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   // Check if the profiles are assigned correctly.
   for (auto dimvec : input_profiles) {
     bool test_optimal_prof = strategy_ == ProfileStrategy::kOptimal ||
-                             strategy_ == ProfileStrategy::kRangeOptimal;
+                             strategy_ == ProfileStrategy::kRangeOptimal ||
+                             strategy_ == ProfileStrategy::kClustered;
     CheckProfile(dimvec, &profile, true, test_optimal_prof);
   }
   bool has_prof = (strategy_ == ProfileStrategy::kRange ||
@@ -250,6 +253,58 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST_P(TrtShapeOptimizationProfileTest, Clustered) {
+  if (strategy_ != ProfileStrategy::kClustered) return;
+
+  // Network with dynamic input shapes.
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile;
+  std::vector<bool> input_mask(2, true);
+  profile.SetInputMask(input_mask);
+
+  // Six distinct shapes, more than the four profiles of the strategy. The
+  // frequent 8x8 input is better kept in its own profile than the rare small
+  // inputs, which are padded the least when clustered together.
+  std::vector<std::pair<int, int>> sizes_and_counts{
+      {1, 1}, {2, 2}, {3, 1}, {8, 4}, {9, 1}, {16, 1}};
+  for (const auto& size_and_count : sizes_and_counts) {
+    const int size = size_and_count.first;
+    std::vector<TensorShape> shape_vec = DimVecToShapeVec(
+        {nvinfer1::Dims3(size, size, 10), nvinfer1::Dims3(size, size, 10)},
+        true);
+    for (int i = 0; i < size_and_count.second; i++) {
+      profile.AddShape(shape_vec);
+    }
+  }
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  profile.InitProfiles(input_partial_shapes, strategy_);
+
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  TF_CHECK_OK(profile.CreateExecutionContexts(engine.get(), &exec_contexts_));
+  EXPECT_EQ(exec_contexts_.size(), 4);
+
+  // The small inputs share a profile, optimized for the most frequent one.
+  for (int size : {1, 3}) {
+    CheckProfile({nvinfer1::Dims3(size, size, 10),
+                  nvinfer1::Dims3(size, size, 10)},
+                 &profile, true, false);
+  }
+  for (int size : {2, 8, 9, 16}) {
+    CheckProfile({nvinfer1::Dims3(size, size, 10),
+                  nvinfer1::Dims3(size, size, 10)},
+                 &profile, true, true);
+  }
+  CheckProfile({nvinfer1::Dims3(5, 5, 10), nvinfer1::Dims3(5, 5, 10)},
+               &profile, false, false);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -249,6 +249,9 @@ void BaseCollectiveExecutor::StartAbort(const Status& s) {
   LOG(ERROR) << "BaseCollectiveExecutor::StartAbort " << s;
   cem_->GetParamResolver()->StartAbort(status);
   remote_access_->StartAbort(status);
+  if (reduce_bucketer_ != nullptr) {
+    reduce_bucketer_->StartAbort(status);
+  }
   if (cem_->GetNcclCommunicator() != nullptr) {
     cem_->GetNcclCommunicator()->StartAbort(status);
   }
@@ -273,6 +276,28 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
                                           const CollectiveParams* col_params,
                                           const string& exec_key,
                                           StatusCallback done) {
+  if (reduce_bucketer_ != nullptr &&
+      reduce_bucketer_->Add(ctx, col_params, done)) {
+    return;
+  }
+  Tensor* output = ctx->mutable_output(0);
+  const Tensor* input =
+      (col_params->instance.type == REDUCTION_COLLECTIVE ||
+       col_params->instance.type == GATHER_COLLECTIVE ||
+       col_params->instance.type == PERMUTE_COLLECTIVE ||
+       col_params->instance.type == ALL_TO_ALL_COLLECTIVE ||
+       col_params->instance.type == REDUCE_SCATTER_COLLECTIVE ||
+       (col_params->instance.type == BROADCAST_COLLECTIVE &&
+        col_params->is_source))
+          ? &ctx->input(0)
+          : nullptr;
+  ExecuteCollective(ctx, col_params, exec_key, input, output, std::move(done));
+}
+
+void BaseCollectiveExecutor::ExecuteCollective(
+    OpKernelContext* ctx, const CollectiveParams* col_params,
+    const string& exec_key, const Tensor* input, Tensor* output,
+    StatusCallback done) {
   // See CompleteParamsAsync() how done() and the timeout callback interacts.
   const auto is_callback_called = std::make_shared<std::atomic<bool>>(false);
   auto done_safe = [this, done, ctx, is_callback_called](const Status& s) {
@@ -302,17 +327,6 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         });
   }
 
-  Tensor* output = ctx->mutable_output(0);
-  const Tensor* input =
-      (col_params->instance.type == REDUCTION_COLLECTIVE ||
-       col_params->instance.type == GATHER_COLLECTIVE ||
-       col_params->instance.type == PERMUTE_COLLECTIVE ||
-       col_params->instance.type == ALL_TO_ALL_COLLECTIVE ||
-       col_params->instance.type == REDUCE_SCATTER_COLLECTIVE ||
-       (col_params->instance.type == BROADCAST_COLLECTIVE &&
-        col_params->is_source))
-          ? &ctx->input(0)
-          : nullptr;
   CollectiveImplementationInterface* col_impl = nullptr;
   Status status = CreateCollective(*col_params, &col_impl);
   if (!status.ok()) {
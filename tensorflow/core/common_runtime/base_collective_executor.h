@@ -19,6 +19,7 @@ limitations under the License.
 #include <string>
 
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
+#include "tensorflow/core/common_runtime/collective_reduce_bucketer.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
@@ -103,7 +104,19 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
         step_id_(step_id),
         dev_mgr_(dev_mgr),
         remote_access_(remote_access),
-        work_queue_(std::move(work_queue)) {}
+        work_queue_(std::move(work_queue)) {
+    const CollectiveReduceBucketer::Options& bucket_options =
+        CollectiveReduceBucketer::OptionsFromEnv();
+    if (bucket_options.bucket_bytes > 0) {
+      reduce_bucketer_ = std::make_unique<CollectiveReduceBucketer>(
+          bucket_options, this,
+          [this](OpKernelContext* ctx, const CollectiveParams* col_params,
+                 const string& exec_key, const Tensor* input, Tensor* output,
+                 const StatusCallback& done) {
+            ExecuteCollective(ctx, col_params, exec_key, input, output, done);
+          });
+    }
+  }
 
   ~BaseCollectiveExecutor() override;
 
@@ -148,8 +161,16 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   std::unordered_map<int32, int32> launched_ TF_GUARDED_BY(launch_mu_);
   mutex status_mu_;
   Status status_ TF_GUARDED_BY(status_mu_);
+  // Fuses small reductions when TF_COLLECTIVE_REDUCE_BUCKET_BYTES is set.
+  std::unique_ptr<CollectiveReduceBucketer> reduce_bucketer_;
 
  private:
+  // Runs the collective of `input` into `output` with the kernel context
+  // `ctx`.
+  void ExecuteCollective(OpKernelContext* ctx,
+                         const CollectiveParams* col_params,
+                         const string& exec_key, const Tensor* input,
+                         Tensor* output, StatusCallback done);
   Status CreateCollective(const CollectiveParams& col_params,
                           CollectiveImplementationInterface** col_impl);
   // Check if all ops on which this collective depends on have launched.
@@ -699,6 +699,16 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // CPU reductions may opt into the hierarchical ring, which reduces within
+  // each task before running the ring across tasks.
+  if (cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->group.device_type == DEVICE_CPU &&
+      cp->instance.impl_details.communication_hint == "hierarchical_ring" &&
+      CollectiveRegistry::LookupParamResolverInstance("HierarchicalRingReduce",
+                                                      &col_impl)
+          .ok()) {
+    cp->instance.impl_details.collective_name = "HierarchicalRingReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
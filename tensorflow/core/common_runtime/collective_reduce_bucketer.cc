@@ -0,0 +1,313 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_reduce_bucketer.h"
+
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Reductions of the same bucket must run the same collective with the same
+// ops on the same group.
+string BucketKey(const CollectiveParams& col_params) {
+  return strings::StrCat(
+      col_params.group.group_key, ":",
+      DataTypeString(col_params.instance.data_type), ":",
+      col_params.instance.impl_details.collective_name, ":",
+      col_params.merge_op ? col_params.merge_op->type_string() : "", ":",
+      col_params.final_op ? col_params.final_op->type_string() : "");
+}
+
+}  // namespace
+
+/* static */
+const CollectiveReduceBucketer::Options&
+CollectiveReduceBucketer::OptionsFromEnv() {
+  static const Options* options = [] {
+    auto* options = new Options;
+    Status s = ReadInt64FromEnvVar("TF_COLLECTIVE_REDUCE_BUCKET_BYTES", 0,
+                                   &options->bucket_bytes);
+    if (!s.ok()) LOG(ERROR) << s;
+    s = ReadInt64FromEnvVar("TF_COLLECTIVE_REDUCE_BUCKET_WINDOW_MICROS", 100,
+                            &options->window_micros);
+    if (!s.ok()) LOG(ERROR) << s;
+    return options;
+  }();
+  return *options;
+}
+
+CollectiveReduceBucketer::CollectiveReduceBucketer(const Options& options,
+                                                   CollectiveExecutor* col_exec,
+                                                   RunFn run)
+    : options_(options), col_exec_(col_exec), run_(std::move(run)) {}
+
+CollectiveReduceBucketer::~CollectiveReduceBucketer() = default;
+
+bool CollectiveReduceBucketer::CanBucket(
+    OpKernelContext* ctx, const CollectiveParams* col_params) const {
+  if (options_.bucket_bytes <= 0) return false;
+  const CollInstanceParams& instance = col_params->instance;
+  if (instance.type != REDUCTION_COLLECTIVE ||
+      col_params->group.num_tasks != 1 ||
+      col_params->group.device_type != DEVICE_CPU ||
+      !instance.impl_details.dependencies.empty() ||
+      !DataTypeCanUseMemcpy(instance.data_type) ||
+      absl::StartsWith(instance.impl_details.collective_name, "Nccl")) {
+    return false;
+  }
+  if (col_params->default_rank < 0 ||
+      col_params->default_rank >= col_params->group.group_size ||
+      ctx->num_inputs() < 1 || ctx->num_outputs() < 1 ||
+      ctx->mutable_output(0) == nullptr) {
+    return false;
+  }
+  const int64_t bytes = ctx->input(0).TotalBytes();
+  return bytes > 0 && bytes < options_.bucket_bytes;
+}
+
+bool CollectiveReduceBucketer::Add(OpKernelContext* ctx,
+                                   const CollectiveParams* col_params,
+                                   const StatusCallback& done) {
+  if (!CanBucket(ctx, col_params)) return false;
+  const int rank = col_params->default_rank;
+  const Tensor& input = ctx->input(0);
+  std::shared_ptr<Bucket> bucket;
+  bool new_bucket = false;
+  Status status;
+  std::vector<int> ready;
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) return false;
+    const auto instance = std::make_pair(col_params->group.group_key,
+                                         col_params->instance.instance_key);
+    int member;
+    auto it = members_.find(instance);
+    if (it != members_.end()) {
+      bucket = it->second.first;
+      member = it->second.second;
+    } else {
+      const string key = BucketKey(*col_params);
+      std::shared_ptr<Bucket>& open = open_buckets_[key];
+      if (open == nullptr) {
+        open = std::make_shared<Bucket>();
+        open->id = next_bucket_id_++;
+        open->key = key;
+        open->group_key = col_params->group.group_key;
+        open->group_size = col_params->group.group_size;
+        open->contributions.resize(open->group_size);
+        open->num_contributed.assign(open->group_size, 0);
+        open->launched.assign(open->group_size, false);
+        new_bucket = true;
+      }
+      bucket = open;
+      member = bucket->instance_keys.size();
+      bucket->instance_keys.push_back(col_params->instance.instance_key);
+      bucket->num_elements.push_back(input.NumElements());
+      bucket->bytes += input.TotalBytes();
+      for (auto& contributions : bucket->contributions) {
+        contributions.emplace_back();
+      }
+      members_[instance] = {bucket, member};
+    }
+
+    Contribution& contribution = bucket->contributions[rank][member];
+    if (contribution.ctx != nullptr) {
+      // Leave the duplicate instance to the regular execution path.
+      return false;
+    }
+    if (bucket->num_elements[member] != input.NumElements()) {
+      status = errors::InvalidArgument(
+          "Collective reduction instance ", col_params->instance.instance_key,
+          " of group ", col_params->group.group_key, " has ",
+          input.NumElements(), " elements on ", ctx->device()->name(),
+          " but ", bucket->num_elements[member], " on another device");
+    } else {
+      contribution.ctx = ctx;
+      contribution.col_params = col_params;
+      contribution.done = done;
+      ++bucket->num_contributed[rank];
+      if (!bucket->closed && bucket->bytes >= options_.bucket_bytes) {
+        Close(bucket, &ready);
+      } else if (bucket->closed &&
+                 bucket->num_contributed[rank] ==
+                     bucket->instance_keys.size()) {
+        MarkLaunched(bucket, rank, &ready);
+      }
+    }
+  }
+  if (!status.ok()) {
+    col_exec_->StartAbort(status);
+    done(status);
+    return true;
+  }
+  if (new_bucket) CloseAfterWindow(bucket);
+  for (int r : ready) Launch(bucket, r);
+  return true;
+}
+
+void CollectiveReduceBucketer::Close(const std::shared_ptr<Bucket>& bucket,
+                                     std::vector<int>* ready) {
+  bucket->closed = true;
+  auto it = open_buckets_.find(bucket->key);
+  if (it != open_buckets_.end() && it->second == bucket) {
+    open_buckets_.erase(it);
+  }
+  for (int r = 0; r < bucket->group_size; ++r) {
+    if (!bucket->launched[r] &&
+        bucket->num_contributed[r] == bucket->instance_keys.size()) {
+      MarkLaunched(bucket, r, ready);
+    }
+  }
+}
+
+void CollectiveReduceBucketer::MarkLaunched(
+    const std::shared_ptr<Bucket>& bucket, int rank, std::vector<int>* ready) {
+  bucket->launched[rank] = true;
+  ready->push_back(rank);
+  if (++bucket->num_launched == bucket->group_size) {
+    // Every device issued all of the reductions of the bucket, so no further
+    // reduction can refer to them.
+    for (int32 instance_key : bucket->instance_keys) {
+      members_.erase(std::make_pair(bucket->group_key, instance_key));
+    }
+  }
+}
+
+void CollectiveReduceBucketer::CloseAfterWindow(
+    const std::shared_ptr<Bucket>& bucket) {
+  // The executor, and with it this object, must survive the timer.
+  col_exec_->Ref();
+  SchedNonBlockingClosureAfter(options_.window_micros, [this, bucket]() {
+    std::vector<int> ready;
+    {
+      mutex_lock l(mu_);
+      if (!bucket->closed && status_.ok()) Close(bucket, &ready);
+    }
+    for (int r : ready) Launch(bucket, r);
+    col_exec_->Unref();
+  });
+}
+
+void CollectiveReduceBucketer::Launch(const std::shared_ptr<Bucket>& bucket,
+                                      int rank) {
+  // The contributions of a launched rank are no longer modified.
+  const std::vector<Contribution>& members = bucket->contributions[rank];
+  OpKernelContext* ctx = members[0].ctx;
+  const CollectiveParams* col_params = members[0].col_params;
+  int64_t num_elements = 0;
+  for (int64_t n : bucket->num_elements) num_elements += n;
+
+  auto fused = std::make_shared<Tensor>();
+  Status s =
+      ctx->allocate_temp(col_params->instance.data_type,
+                         TensorShape({num_elements}), fused.get(),
+                         ctx->output_alloc_attr(0));
+  if (!s.ok()) {
+    col_exec_->StartAbort(s);
+    for (const Contribution& member : members) member.done(s);
+    return;
+  }
+  char* fused_data = static_cast<char*>(DMAHelper::base(fused.get()));
+  for (const Contribution& member : members) {
+    const Tensor& input = member.ctx->input(0);
+    memcpy(fused_data, DMAHelper::base(&input), input.TotalBytes());
+    fused_data += input.TotalBytes();
+  }
+
+  auto* fused_params = new CollectiveParams();
+  fused_params->name = strings::StrCat("CollectiveReduceBucket_", bucket->id);
+  fused_params->group = col_params->group;
+  fused_params->instance = col_params->instance;
+  fused_params->instance.shape = fused->shape();
+  fused_params->default_rank = col_params->default_rank;
+  fused_params->subdiv_rank = col_params->subdiv_rank;
+  fused_params->merge_op = col_params->merge_op;
+  fused_params->final_op = col_params->final_op;
+  const string exec_key = strings::StrCat(
+      "CollectiveReduceBucket:", col_params->group.group_key, ":", bucket->id);
+
+  const int64_t activity_id = profiler::TraceMe::ActivityStart([&]() {
+    return profiler::TraceMeEncode(
+        "CollectiveReduceBucket",
+        {{"bucket_id", bucket->id},
+         {"group_key", col_params->group.group_key},
+         {"device", ctx->device()->name()},
+         {"num_reductions", members.size()},
+         {"bytes", fused->TotalBytes()}});
+  });
+  run_(ctx, fused_params, exec_key, fused.get(), fused.get(),
+       [bucket, rank, fused, fused_params, activity_id](const Status& s) {
+         profiler::TraceMe::ActivityEnd(activity_id);
+         const std::vector<Contribution>& members = bucket->contributions[rank];
+         if (s.ok()) {
+           const char* fused_data =
+               static_cast<const char*>(DMAHelper::base(fused.get()));
+           for (const Contribution& member : members) {
+             Tensor* output = member.ctx->mutable_output(0);
+             memcpy(DMAHelper::base(output), fused_data, output->TotalBytes());
+             fused_data += output->TotalBytes();
+           }
+         }
+         fused_params->Unref();
+         for (const Contribution& member : members) member.done(s);
+       });
+}
+
+void CollectiveReduceBucketer::StartAbort(const Status& s) {
+  std::vector<StatusCallback> dones;
+  {
+    mutex_lock l(mu_);
+    if (!status_.ok()) return;
+    status_ = s;
+    absl::flat_hash_set<Bucket*> aborted;
+    for (auto& member : members_) {
+      Bucket* bucket = member.second.first.get();
+      if (!aborted.insert(bucket).second) continue;
+      // Ranks that launched the bucket are aborted by the executor.
+      bucket->closed = true;
+      for (int r = 0; r < bucket->group_size; ++r) {
+        if (bucket->launched[r]) continue;
+        bucket->launched[r] = true;
+        for (Contribution& contribution : bucket->contributions[r]) {
+          if (contribution.ctx != nullptr) {
+            dones.push_back(std::move(contribution.done));
+          }
+        }
+      }
+    }
+    members_.clear();
+    open_buckets_.clear();
+  }
+  for (const StatusCallback& done : dones) done(s);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,142 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_REDUCE_BUCKETER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_REDUCE_BUCKETER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Packs the small all-reduces issued to a CollectiveExecutor into fused
+// buffers, so that a bucket of reductions pays the collective latency once.
+//
+// A bucket is filled with reductions in the order in which their instances are
+// first seen on any device, and is launched once it holds `bucket_bytes` or
+// `window_micros` after its first reduction, whichever comes first.  Each
+// device then runs the fused reduction as soon as it has issued all of the
+// reductions of the bucket, while later reductions go to the next bucket.
+//
+// The bucket composition is decided here for all participants at once, so
+// only groups whose devices all belong to this task are bucketed.  All
+// devices of a group are expected to issue data-independent reductions, as
+// replicas of the same training step do.
+class CollectiveReduceBucketer {
+ public:
+  struct Options {
+    // Target size of a fused buffer.  Reductions of at least this many bytes
+    // are not bucketed.  0 disables bucketing.
+    int64_t bucket_bytes = 0;
+    // Time after which a bucket is launched even if it is not full.
+    int64_t window_micros = 0;
+  };
+
+  // Reads TF_COLLECTIVE_REDUCE_BUCKET_BYTES and
+  // TF_COLLECTIVE_REDUCE_BUCKET_WINDOW_MICROS (default 100) once.
+  static const Options& OptionsFromEnv();
+
+  // Runs the reduction `col_params` of `input` into `output` with the kernel
+  // context `ctx`.
+  using RunFn = std::function<void(
+      OpKernelContext* ctx, const CollectiveParams* col_params,
+      const string& exec_key, const Tensor* input, Tensor* output,
+      const StatusCallback& done)>;
+
+  // `col_exec` must outlive the reductions passed to Add() and is aborted if
+  // a fused buffer cannot be allocated.
+  CollectiveReduceBucketer(const Options& options, CollectiveExecutor* col_exec,
+                           RunFn run);
+  ~CollectiveReduceBucketer();
+
+  // Adds the reduction of `ctx->input(0)` into `ctx->mutable_output(0)`
+  // described by `col_params`, calling `done` once the reduction of its
+  // bucket completed.  Returns false, without calling `done`, if the
+  // reduction cannot be bucketed.
+  bool Add(OpKernelContext* ctx, const CollectiveParams* col_params,
+           const StatusCallback& done);
+
+  // Fails the reductions that have not been launched yet with `s` and stops
+  // bucketing new ones.
+  void StartAbort(const Status& s);
+
+ private:
+  struct Contribution {
+    OpKernelContext* ctx = nullptr;
+    const CollectiveParams* col_params = nullptr;
+    StatusCallback done;
+  };
+
+  struct Bucket {
+    int64_t id;
+    string key;
+    int32 group_key;
+    int group_size;
+    bool closed = false;
+    int64_t bytes = 0;
+    std::vector<int32> instance_keys;
+    std::vector<int64_t> num_elements;
+    // Indexed by the rank of the device and then by the member index.
+    std::vector<std::vector<Contribution>> contributions;
+    std::vector<int> num_contributed;
+    std::vector<bool> launched;
+    int num_launched = 0;
+  };
+
+  bool CanBucket(OpKernelContext* ctx, const CollectiveParams* col_params)
+      const;
+  // Closes `bucket` and appends the ranks ready to launch it to `ready`.
+  void Close(const std::shared_ptr<Bucket>& bucket, std::vector<int>* ready)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Marks `rank` as launching `bucket` and appends it to `ready`.
+  void MarkLaunched(const std::shared_ptr<Bucket>& bucket, int rank,
+                    std::vector<int>* ready) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void CloseAfterWindow(const std::shared_ptr<Bucket>& bucket);
+  // Packs the contributions of `rank` to `bucket` and runs the fused
+  // reduction.
+  void Launch(const std::shared_ptr<Bucket>& bucket, int rank);
+
+  const Options options_;
+  CollectiveExecutor* const col_exec_;  // Not owned.
+  const RunFn run_;
+
+  mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+  int64_t next_bucket_id_ TF_GUARDED_BY(mu_) = 0;
+  // Bucket being filled for each group, data type and reduction.
+  absl::flat_hash_map<string, std::shared_ptr<Bucket>> open_buckets_
+      TF_GUARDED_BY(mu_);
+  // (group_key, instance_key) -> bucket preparing the instance and the index
+  // of the instance in it.
+  absl::flat_hash_map<std::pair<int32, int32>,
+                      std::pair<std::shared_ptr<Bucket>, int>>
+      members_ TF_GUARDED_BY(mu_);
+
+  CollectiveReduceBucketer(const CollectiveReduceBucketer&) = delete;
+  void operator=(const CollectiveReduceBucketer&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_REDUCE_BUCKETER_H_
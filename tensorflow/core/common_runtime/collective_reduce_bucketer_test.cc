@@ -0,0 +1,215 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/collective_reduce_bucketer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/framework/device_factory.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kGroupSize = 2;
+
+// Owns the bucketer like BaseCollectiveExecutor does, so that pending bucket
+// timers keep it alive.
+class BucketingExecutor : public TestCollectiveExecutor {
+ public:
+  BucketingExecutor(const CollectiveReduceBucketer::Options& options,
+                    CollectiveReduceBucketer::RunFn run)
+      : TestCollectiveExecutor(nullptr),
+        bucketer_(options, this, std::move(run)) {}
+
+  void StartAbort(const Status& s) override { bucketer_.StartAbort(s); }
+
+  CollectiveReduceBucketer* bucketer() { return &bucketer_; }
+
+ private:
+  CollectiveReduceBucketer bucketer_;
+};
+
+// A reduction issued by one device, with its own kernel context.
+struct Reduction {
+  core::RefCountPtr<CollectiveParams> col_params;
+  Tensor input;
+  Tensor output;
+  gtl::InlinedVector<TensorValue, 4> inputs;
+  AllocatorAttributes output_attr;
+  OpKernelContext::Params params;
+  std::unique_ptr<OpKernelContext> ctx;
+  Notification done;
+  Status status;
+};
+
+class CollectiveReduceBucketerTest : public ::testing::Test {
+ protected:
+  CollectiveReduceBucketerTest()
+      : device_(DeviceFactory::NewDevice("CPU", SessionOptions(),
+                                         "/job:localhost/replica:0/task:0")) {
+    NodeDef node_def;
+    TF_CHECK_OK(NodeDefBuilder("identity", "Identity")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Finalize(&node_def));
+    Status status;
+    kernel_ = CreateOpKernel(DEVICE_CPU, device_.get(),
+                             device_->GetAllocator(AllocatorAttributes()),
+                             node_def, TF_GRAPH_DEF_VERSION, &status);
+    TF_CHECK_OK(status);
+  }
+
+  void Init(int64_t bucket_bytes, int64_t window_micros) {
+    CollectiveReduceBucketer::Options options;
+    options.bucket_bytes = bucket_bytes;
+    options.window_micros = window_micros;
+    executor_.reset(new BucketingExecutor(
+        options, [this](OpKernelContext* ctx,
+                        const CollectiveParams* col_params,
+                        const string& exec_key, const Tensor* input,
+                        Tensor* output, const StatusCallback& done) {
+          {
+            mutex_lock l(mu_);
+            fused_inputs_.push_back(*input);
+            exec_keys_.push_back(exec_key);
+          }
+          // Stands in for the reduction across devices.
+          output->flat<float>() = input->flat<float>() + 100.0f;
+          done(OkStatus());
+        }));
+  }
+
+  std::unique_ptr<Reduction> MakeReduction(int instance_key, int rank,
+                                           const std::vector<float>& values,
+                                           int num_tasks = 1) {
+    auto reduction = std::make_unique<Reduction>();
+    CollectiveParams* col_params = new CollectiveParams();
+    reduction->col_params.reset(col_params);
+    col_params->group.group_key = 1;
+    col_params->group.group_size = kGroupSize;
+    col_params->group.num_tasks = num_tasks;
+    col_params->group.device_type = DEVICE_CPU;
+    col_params->instance.type = REDUCTION_COLLECTIVE;
+    col_params->instance.data_type = DT_FLOAT;
+    col_params->instance.instance_key = instance_key;
+    col_params->instance.impl_details.collective_name = "RingReduce";
+    col_params->default_rank = rank;
+
+    reduction->input = test::AsTensor<float>(values);
+    reduction->output = Tensor(DT_FLOAT, reduction->input.shape());
+    reduction->inputs.push_back(TensorValue(&reduction->input));
+    reduction->params.device = device_.get();
+    reduction->params.op_kernel = kernel_.get();
+    reduction->params.inputs = reduction->inputs;
+    reduction->params.output_attr_array = &reduction->output_attr;
+    reduction->ctx = std::make_unique<OpKernelContext>(&reduction->params,
+                                                       /*num_outputs=*/1);
+    reduction->ctx->set_output(0, reduction->output);
+    return reduction;
+  }
+
+  bool Add(Reduction* reduction) {
+    return executor_->bucketer()->Add(
+        reduction->ctx.get(), reduction->col_params.get(),
+        [reduction](const Status& s) {
+          reduction->status = s;
+          reduction->done.Notify();
+        });
+  }
+
+  std::unique_ptr<Device> device_;
+  std::unique_ptr<OpKernel> kernel_;
+  core::RefCountPtr<BucketingExecutor> executor_;
+  mutex mu_;
+  std::vector<Tensor> fused_inputs_ TF_GUARDED_BY(mu_);
+  std::vector<string> exec_keys_ TF_GUARDED_BY(mu_);
+};
+
+TEST_F(CollectiveReduceBucketerTest, FusesFullBucket) {
+  Init(/*bucket_bytes=*/16, /*window_micros=*/60 * 1000 * 1000);
+  std::vector<std::unique_ptr<Reduction>> reductions;
+  for (int rank = 0; rank < kGroupSize; ++rank) {
+    reductions.push_back(MakeReduction(7, rank, {1, 2}));
+  }
+  for (int rank = 0; rank < kGroupSize; ++rank) {
+    reductions.push_back(MakeReduction(9, rank, {3, 4}));
+  }
+  for (auto& reduction : reductions) ASSERT_TRUE(Add(reduction.get()));
+
+  for (auto& reduction : reductions) {
+    reduction->done.WaitForNotification();
+    TF_EXPECT_OK(reduction->status);
+  }
+  mutex_lock l(mu_);
+  ASSERT_EQ(fused_inputs_.size(), kGroupSize);
+  for (const Tensor& fused : fused_inputs_) {
+    test::ExpectTensorEqual<float>(fused, test::AsTensor<float>({1, 2, 3, 4}));
+  }
+  EXPECT_EQ(exec_keys_[0], exec_keys_[1]);
+  test::ExpectTensorEqual<float>(*reductions[0]->ctx->mutable_output(0),
+                                 test::AsTensor<float>({101, 102}));
+  test::ExpectTensorEqual<float>(*reductions[3]->ctx->mutable_output(0),
+                                 test::AsTensor<float>({103, 104}));
+}
+
+TEST_F(CollectiveReduceBucketerTest, LaunchesAfterWindow) {
+  Init(/*bucket_bytes=*/1 << 20, /*window_micros=*/1000);
+  auto first = MakeReduction(7, /*rank=*/0, {1, 2, 3});
+  auto second = MakeReduction(7, /*rank=*/1, {1, 2, 3});
+  ASSERT_TRUE(Add(first.get()));
+  ASSERT_TRUE(Add(second.get()));
+  first->done.WaitForNotification();
+  second->done.WaitForNotification();
+  TF_EXPECT_OK(first->status);
+  TF_EXPECT_OK(second->status);
+  test::ExpectTensorEqual<float>(*second->ctx->mutable_output(0),
+                                 test::AsTensor<float>({101, 102, 103}));
+}
+
+TEST_F(CollectiveReduceBucketerTest, SkipsIneligibleReductions) {
+  Init(/*bucket_bytes=*/8, /*window_micros=*/1000);
+  auto large = MakeReduction(7, /*rank=*/0, {1, 2});
+  EXPECT_FALSE(Add(large.get()));
+  auto multi_task = MakeReduction(8, /*rank=*/0, {1}, /*num_tasks=*/2);
+  EXPECT_FALSE(Add(multi_task.get()));
+}
+
+TEST_F(CollectiveReduceBucketerTest, AbortFailsPendingReductions) {
+  Init(/*bucket_bytes=*/1 << 20, /*window_micros=*/60 * 1000 * 1000);
+  auto pending = MakeReduction(7, /*rank=*/0, {1, 2});
+  ASSERT_TRUE(Add(pending.get()));
+  executor_->StartAbort(errors::Aborted("test abort"));
+  pending->done.WaitForNotification();
+  EXPECT_TRUE(errors::IsAborted(pending->status));
+  auto after_abort = MakeReduction(8, /*rank=*/0, {1, 2});
+  EXPECT_FALSE(Add(after_abort.get()));
+}
+
+}  // namespace
+}  // namespace tensorflow
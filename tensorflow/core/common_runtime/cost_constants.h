@@ -23,6 +23,20 @@ inline constexpr char kTpuCostName[] = "tpu";
 inline constexpr char kGcuCostName[] = "gcu";
 inline constexpr char kNoOpCostName[] = "no_op";
 
+// Types of per-request cost attributed to the components that process a
+// request, as wall time. They may overlap: e.g. an XLA executable or an
+// iterator run within the kernels of an executor.
+//
+// Time spent in the synchronous kernels of the executors running the request.
+inline constexpr char kExecutorOpsCostName[] = "executor_ops";
+// Time the request waited in a batch queue, and processed its batches.
+inline constexpr char kBatchWaitCostName[] = "batch_wait";
+inline constexpr char kBatchProcessingCostName[] = "batch_processing";
+// Time spent getting elements from tf.data iterators.
+inline constexpr char kTfDataCostName[] = "tf_data";
+// Time spent running XLA executables, with or without PJRT.
+inline constexpr char kXlaExecutableCostName[] = "xla_executable";
+
 // Each type of per-request cost could have the following versions.
 //
 // A server may have costs that cannot be directly attributed to a specific
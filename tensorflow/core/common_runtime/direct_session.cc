@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <deque>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/common_runtime/constant_folding.h"
+#include "tensorflow/core/common_runtime/cost_util.h"
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_resolver_local.h"
@@ -68,9 +71,11 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/nccl/collective_communicator.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -160,6 +165,23 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Returns an error if `graph`, a partition of a callable whose steps may
+// overlap, has side effects.
+Status ValidatePipelinedPartition(const Graph& graph) {
+  for (const Node* node : graph.op_nodes()) {
+    if (!node->op_def().is_stateful() || node->IsSend() || node->IsRecv() ||
+        node->type_string() == "VarHandleOp" ||
+        node->type_string() == "ReadVariableOp") {
+      continue;
+    }
+    return errors::InvalidArgument(
+        "Callables with a positive max_pipelined_steps must not have side "
+        "effects, but node ",
+        node->name(), " runs the stateful op ", node->type_string(), ".");
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -365,6 +387,14 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.message();
   }
+  // Sharing is opt-in, as it fingerprints the GraphDef of every partition
+  // when the executors are created.
+  const Status share_status =
+      ReadBoolFromEnvVar("TF_DIRECT_SESSION_SHARE_PARTITION_EXECUTORS", false,
+                         &share_partition_executors_);
+  if (!share_status.ok()) {
+    LOG(ERROR) << share_status.message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   int devices_added = 0;
@@ -396,6 +426,18 @@ DirectSession::DirectSession(const SessionOptions& options,
 
 DirectSession::~DirectSession() {
   if (!closed_) Close().IgnoreError();
+  // The pipelined steps which have not started yet fail since the session is
+  // closed, and the running ones are cancelled.
+  std::vector<std::unique_ptr<CallablePipeline>> pipelines;
+  {
+    mutex_lock l(callables_lock_);
+    for (auto& it : callables_) {
+      if (it.second.pipeline != nullptr) {
+        pipelines.push_back(std::move(it.second.pipeline));
+      }
+    }
+  }
+  pipelines.clear();
   for (auto& it : partial_runs_) {
     it.second.reset(nullptr);
   }
@@ -630,7 +672,8 @@ Status DirectSession::RunInternal(
     VLOG(1) << "Using RunHandler to scheduler inter-op closures.";
     handler = GetOrCreateRunHandlerPool(options_)->Get(
         step_id, call_timeout,
-        run_options.experimental().run_handler_pool_options());
+        run_options.experimental().run_handler_pool_options(),
+        deadline.has_value() ? absl::ToUnixMicros(*deadline) : 0);
     if (!handler) {
       return errors::DeadlineExceeded(
           "Could not obtain RunHandler for request after waiting for ",
@@ -679,6 +722,12 @@ Status DirectSession::RunInternal(
   args.run_all_kernels_inline = pool == nullptr;
   args.start_time_usecs = start_time_usecs;
   args.deadline = deadline;
+  // Attributes the costs of the step to the rpc request it runs for, if any.
+  std::unique_ptr<RequestCostAccessor> request_cost_accessor =
+      CreateRequestCostAccessor();
+  if (request_cost_accessor) {
+    args.request_cost = request_cost_accessor->GetRequestCost();
+  }
 
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
@@ -1318,10 +1367,23 @@ Status DirectSession::CheckFetch(const NamedTensorList& feeds,
   return OkStatus();
 }
 
+/* static */
+string DirectSession::PartitionExecutorKey(const Device* device,
+                                           const Graph& graph) {
+  GraphDef graph_def;
+  graph.ToGraphDef(&graph_def);
+  string serialized;
+  SerializeToStringDeterministic(graph_def, &serialized);
+  const Fprint128 fingerprint = Fingerprint128(serialized);
+  return strings::StrCat(device->name(), ";",
+                         strings::FpToString(fingerprint.high64),
+                         strings::FpToString(fingerprint.low64));
+}
+
 Status DirectSession::CreateExecutors(
     const CallableOptions& callable_options,
     std::unique_ptr<ExecutorsAndKeys>* out_executors_and_keys,
-    std::unique_ptr<FunctionInfo>* out_func_info,
+    std::shared_ptr<FunctionInfo>* out_func_info,
     RunStateArgs* run_state_args) {
   BuildGraphOptions options;
   options.callable_options = callable_options;
@@ -1335,7 +1397,7 @@ Status DirectSession::CreateExecutors(
     options.collective_order = GraphCollectiveOrder::kAttrs;
   }
 
-  std::unique_ptr<FunctionInfo> func_info(new FunctionInfo);
+  std::shared_ptr<FunctionInfo> func_info(new FunctionInfo);
   std::unique_ptr<ExecutorsAndKeys> ek(new ExecutorsAndKeys);
 
   ek->callable_options = callable_options;
@@ -1443,11 +1505,54 @@ Status DirectSession::CreateExecutors(
                                          device->name(),
                                          partition_graph.get()));
 
+    if (callable_options.max_pipelined_steps() > 0) {
+      TF_RETURN_IF_ERROR(ValidatePipelinedPartition(*partition_graph));
+    }
+
     item->executor = nullptr;
     item->device = device;
-    auto executor_type = options_.config.experimental().executor_type();
-    TF_RETURN_IF_ERROR(
-        NewExecutor(executor_type, params, *partition_graph, &item->executor));
+
+    // Reuse the executor of an identical partition from another callable if
+    // there is one, which avoids rebuilding its ImmutableExecutorState and
+    // kernels.
+    string partition_key;
+    if (share_partition_executors_) {
+      partition_key = PartitionExecutorKey(device, *partition_graph);
+      mutex_lock l(executor_lock_);
+      auto it = partition_executors_.find(partition_key);
+      if (it != partition_executors_.end()) {
+        if (std::shared_ptr<SharedPartitionExecutor> shared =
+                it->second.lock()) {
+          item->flib = shared->flib;
+          item->executor = std::shared_ptr<Executor>(
+              shared, shared->executor.get());
+        }
+      }
+    }
+
+    if (item->executor == nullptr) {
+      auto shared = std::make_shared<SharedPartitionExecutor>();
+      shared->function_info = func_info;
+      shared->flib = lib;
+      auto executor_type = options_.config.experimental().executor_type();
+      TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, *partition_graph,
+                                     &shared->executor));
+      if (share_partition_executors_) {
+        mutex_lock l(executor_lock_);
+        // Another thread may have built the same partition concurrently, in
+        // which case we keep the executor that is already cached.
+        std::weak_ptr<SharedPartitionExecutor>& cached =
+            partition_executors_[partition_key];
+        if (std::shared_ptr<SharedPartitionExecutor> existing = cached.lock()) {
+          shared = std::move(existing);
+          item->flib = shared->flib;
+        } else {
+          cached = shared;
+        }
+      }
+      item->executor =
+          std::shared_ptr<Executor>(shared, shared->executor.get());
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
@@ -1583,7 +1688,7 @@ Status DirectSession::GetOrCreateExecutors(
       ->mutable_experimental()
       ->set_collective_graph_key(run_state_args->collective_graph_key);
   std::unique_ptr<ExecutorsAndKeys> ek;
-  std::unique_ptr<FunctionInfo> func_info;
+  std::shared_ptr<FunctionInfo> func_info;
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, run_state_args));
 
@@ -1699,6 +1804,8 @@ Status DirectSession::CreateGraphs(
   };
   popts.flib_def = flib_def->get();
   popts.control_flow_added = false;
+  // All the partitions of a step share one intra-process rendezvous.
+  popts.assign_rendezvous_slots = true;
 
   std::unordered_map<string, GraphDef> partitions;
   TF_RETURN_IF_ERROR(Partition(popts, &client_graph->graph, &partitions));
@@ -1875,20 +1982,92 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
                                    CallableHandle* out_handle) {
   TF_RETURN_IF_ERROR(CheckNotClosed());
   TF_RETURN_IF_ERROR(CheckGraphCreated("MakeCallable()"));
+  // Each step in flight takes a thread, and more steps than inter-op threads
+  // would not overlap any further.
+  const int max_pipelined_steps =
+      std::max(1, thread_pools_[0].first->NumThreads());
+  if (callable_options.max_pipelined_steps() > max_pipelined_steps) {
+    return errors::InvalidArgument(
+        "max_pipelined_steps must be at most the inter-op parallelism of the "
+        "session, ",
+        max_pipelined_steps, ", but got ",
+        callable_options.max_pipelined_steps());
+  }
 
   std::unique_ptr<ExecutorsAndKeys> ek;
-  std::unique_ptr<FunctionInfo> func_info;
+  std::shared_ptr<FunctionInfo> func_info;
   RunStateArgs run_state_args(callable_options.run_options().debug_options());
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, &run_state_args));
+  std::unique_ptr<CallablePipeline> pipeline;
+  if (callable_options.max_pipelined_steps() > 0) {
+    pipeline = std::make_unique<CallablePipeline>(
+        options_.env, callable_options.max_pipelined_steps());
+  }
   {
     mutex_lock l(callables_lock_);
     *out_handle = next_callable_handle_++;
-    callables_[*out_handle] = {std::move(ek), std::move(func_info)};
+    Callable& callable = callables_[*out_handle];
+    callable.executors_and_keys = std::move(ek);
+    callable.function_info = std::move(func_info);
+    callable.pipeline = std::move(pipeline);
   }
   return OkStatus();
 }
 
+// Runs the steps of a callable in the order they were scheduled, with at most
+// `max_in_flight` of them at once. Each running step takes a thread, which
+// only waits for it: the ops of the steps run on the inter-op thread pools as
+// for RunCallable().
+class DirectSession::CallablePipeline {
+ public:
+  CallablePipeline(Env* env, int max_in_flight)
+      : max_in_flight_(max_in_flight),
+        threads_(env, ThreadOptions(), "tf_pipelined_callable", max_in_flight,
+                 /*low_latency_hint=*/false) {}
+
+  // Waits for the queued and running steps.
+  ~CallablePipeline() = default;
+
+  void Schedule(std::function<void()> step) {
+    {
+      mutex_lock l(mu_);
+      queue_.push_back(std::move(step));
+      if (num_runners_ == max_in_flight_) return;
+      ++num_runners_;
+    }
+    threads_.Schedule([this]() { RunSteps(); });
+  }
+
+ private:
+  // Runs the steps at the front of the queue until it is empty. The queue,
+  // rather than `threads_`, orders the steps, since a thread pool starts its
+  // closures in no particular order.
+  void RunSteps() {
+    while (true) {
+      std::function<void()> step;
+      {
+        mutex_lock l(mu_);
+        if (queue_.empty()) {
+          --num_runners_;
+          return;
+        }
+        step = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      step();
+    }
+  }
+
+  const int max_in_flight_;
+  mutex mu_;
+  std::deque<std::function<void()>> queue_ TF_GUARDED_BY(mu_);
+  int num_runners_ TF_GUARDED_BY(mu_) = 0;
+  // Declared last, so that it is destroyed first, which waits for the
+  // runners to drain the queue.
+  thread::ThreadPool threads_;
+};
+
 class DirectSession::RunCallableCallFrame : public CallFrameInterface {
  public:
   RunCallableCallFrame(DirectSession* session,
@@ -2035,11 +2214,45 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   return OkStatus();
 }
 
+void DirectSession::RunCallableAsync(CallableHandle handle,
+                                     std::vector<Tensor> feed_tensors,
+                                     std::vector<Tensor>* fetch_tensors,
+                                     RunMetadata* run_metadata,
+                                     std::function<void(const Status&)> done) {
+  {
+    tf_shared_lock l(callables_lock_);
+    auto it = callables_.find(handle);
+    if (it != callables_.end() && it->second.pipeline != nullptr) {
+      // Scheduled under the lock, which keeps the pipeline alive.
+      it->second.pipeline->Schedule(
+          [this, handle, feed_tensors = std::move(feed_tensors), fetch_tensors,
+           run_metadata, done = std::move(done)]() {
+            done(
+                RunCallable(handle, feed_tensors, fetch_tensors, run_metadata));
+          });
+      return;
+    }
+  }
+  done(errors::InvalidArgument(
+      "RunCallableAsync() needs a callable created with a positive "
+      "max_pipelined_steps, but got handle ",
+      handle));
+}
+
 ::tensorflow::Status DirectSession::ReleaseCallable(CallableHandle handle) {
-  mutex_lock l(callables_lock_);
-  if (handle >= next_callable_handle_) {
-    return errors::InvalidArgument("No such callable handle: ", handle);
+  std::unique_ptr<CallablePipeline> pipeline;
+  {
+    mutex_lock l(callables_lock_);
+    if (handle >= next_callable_handle_) {
+      return errors::InvalidArgument("No such callable handle: ", handle);
+    }
+    auto it = callables_.find(handle);
+    if (it != callables_.end()) pipeline = std::move(it->second.pipeline);
   }
+  // Waits for the pipelined steps outside the lock, since the queued ones look
+  // up `handle` when they start.
+  pipeline.reset();
+  mutex_lock l(callables_lock_);
   callables_.erase(handle);
   return OkStatus();
 }
@@ -2059,6 +2272,8 @@ Status DirectSession::Finalize() {
 }
 
 DirectSession::Callable::~Callable() {
+  // The pipelined steps use the fields below.
+  pipeline.reset();
   // We must delete the fields in this order, because the destructor
   // of `executors_and_keys` will call into an object owned by
   // `function_info` (in particular, when deleting a kernel, it relies
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -131,6 +132,11 @@ class DirectSession : public Session {
       std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options) override;
 
+  void RunCallableAsync(CallableHandle handle, std::vector<Tensor> feed_tensors,
+                        std::vector<Tensor>* fetch_tensors,
+                        RunMetadata* run_metadata,
+                        std::function<void(const Status&)> done) override;
+
   ::tensorflow::Status ReleaseCallable(CallableHandle handle) override;
 
   ::tensorflow::Status Finalize() override;
@@ -147,7 +153,9 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph = nullptr;
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
-    std::unique_ptr<Executor> executor;
+    // May be shared with the partitions of other ExecutorsAndKeys that have
+    // an identical graph on the same device. See `SharedPartitionExecutor`.
+    std::shared_ptr<Executor> executor;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -194,6 +202,19 @@ class DirectSession : public Session {
     std::unique_ptr<ProcessFunctionLibraryRuntime> proc_flr;
   };
 
+  // An executor for one partition graph, which is shared by every
+  // ExecutorsAndKeys whose partition for the same device serializes to the
+  // same GraphDef. The kernels of `executor` were created using the function
+  // library runtime of `function_info`, so the FunctionInfo of the callable
+  // that built the executor is kept alive for as long as the executor is used.
+  // The fields are destroyed in reverse order, which deletes the kernels before
+  // the function library runtime.
+  struct SharedPartitionExecutor {
+    std::shared_ptr<FunctionInfo> function_info;
+    FunctionLibraryRuntime* flib = nullptr;  // not owned.
+    std::unique_ptr<Executor> executor;
+  };
+
   // For each live Run() call, the session maintains a RunState.
   // 'status' is the current status of the execution.
   struct RunState {
@@ -250,9 +271,13 @@ class DirectSession : public Session {
   ::tensorflow::Status CreateExecutors(
       const CallableOptions& callable_options,
       std::unique_ptr<ExecutorsAndKeys>* out_executors_and_keys,
-      std::unique_ptr<FunctionInfo>* out_func_info,
+      std::shared_ptr<FunctionInfo>* out_func_info,
       RunStateArgs* run_state_args);
 
+  // Returns a key that identifies `graph` when it is run on `device`. Two
+  // partitions with the same key can share a SharedPartitionExecutor.
+  static string PartitionExecutorKey(const Device* device, const Graph& graph);
+
   // Creates several graphs given the existing graph_def_ and the
   // input feeds and fetches, given 'devices'. The graphs share a common
   // function library 'flib_def'.
@@ -355,9 +380,15 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
-  std::vector<std::unique_ptr<FunctionInfo>> functions_
+  std::vector<std::shared_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
+  // If true, partitions with identical graphs share one executor, and hence
+  // its ImmutableExecutorState and kernels, across all callables and `Run()`
+  // signatures of this session. Set by the
+  // TF_DIRECT_SESSION_SHARE_PARTITION_EXECUTORS environment variable.
+  bool share_partition_executors_ = false;
+
   mutex executor_lock_;  // protects executors_
   // Holds mappings from signature to the executors that process
   // it. The reason for a level of indirection around mapped_type is
@@ -367,10 +398,20 @@ class DirectSession : public Session {
   std::unordered_map<string, std::shared_ptr<ExecutorsAndKeys>> executors_
       TF_GUARDED_BY(executor_lock_);
 
+  // Maps the result of `PartitionExecutorKey()` to the executor built for that
+  // partition. Entries do not keep the executor alive: once every
+  // ExecutorsAndKeys that uses it has been released, the executor is deleted.
+  std::unordered_map<string, std::weak_ptr<SharedPartitionExecutor>>
+      partition_executors_ TF_GUARDED_BY(executor_lock_);
+
   class RunCallableCallFrame;
+  class CallablePipeline;
   struct Callable {
     std::shared_ptr<ExecutorsAndKeys> executors_and_keys;
     std::shared_ptr<FunctionInfo> function_info;
+    // Runs the steps started by RunCallableAsync(), if
+    // `CallableOptions::max_pipelined_steps` is positive.
+    std::unique_ptr<CallablePipeline> pipeline;
     ~Callable();
   };
   mutex callables_lock_;
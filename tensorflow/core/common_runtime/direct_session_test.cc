@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <atomic>
+#include <cstdlib>
 #include <map>
 #include <memory>
 #include <random>
@@ -44,6 +46,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -610,6 +614,110 @@ TEST_F(DirectSessionMinusAXTest, TestConcurrency_Callable) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestRunCallableAsync) {
+  Initialize({1, 2, 3, 4});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.set_inter_op_parallelism_threads(4);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {y_neg_ + ":0"}, {});
+  Session::CallableHandle handle;
+  // More steps in flight than inter-op threads.
+  callable_options.set_max_pipelined_steps(5);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->MakeCallable(callable_options, &handle)));
+  callable_options.set_max_pipelined_steps(4);
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  constexpr int kNumSteps = 100;
+  std::vector<std::vector<Tensor>> outputs(kNumSteps);
+  std::vector<Status> statuses(kNumSteps);
+  BlockingCounter steps_done(kNumSteps);
+  for (int i = 0; i < kNumSteps; ++i) {
+    session->RunCallableAsync(handle, {}, &outputs[i], nullptr,
+                              [&statuses, &steps_done, i](const Status& s) {
+                                statuses[i] = s;
+                                steps_done.DecrementCount();
+                              });
+  }
+  steps_done.Wait();
+  for (int i = 0; i < kNumSteps; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    ASSERT_EQ(1, outputs[i].size());
+    EXPECT_FLOAT_EQ(-3.0, outputs[i][0].matrix<float>()(0, 0));
+  }
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+
+  // With one step in flight, the steps run in the order of the calls, even
+  // when `done` starts the next one from the pipeline's thread.
+  callable_options.set_max_pipelined_steps(1);
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter ordered_steps_done(kNumSteps);
+  Notification even_steps_queued;
+  std::function<void(int)> run_step = [&](int i) {
+    session->RunCallableAsync(handle, {}, &outputs[i], nullptr,
+                              [&, i](const Status& s) {
+                                TF_EXPECT_OK(s);
+                                {
+                                  mutex_lock l(mu);
+                                  order.push_back(i);
+                                }
+                                if (i == 0) {
+                                  even_steps_queued.WaitForNotification();
+                                }
+                                if (i % 2 == 0) run_step(i + 1);
+                                ordered_steps_done.DecrementCount();
+                              });
+  };
+  for (int i = 0; i < kNumSteps; i += 2) run_step(i);
+  even_steps_queued.Notify();
+  ordered_steps_done.Wait();
+  ASSERT_EQ(order.size(), kNumSteps);
+  // Steps 1, 3, ... are queued after all the even ones.
+  for (int i = 0; i < kNumSteps / 2; ++i) {
+    EXPECT_EQ(order[i], 2 * i);
+    EXPECT_EQ(order[kNumSteps / 2 + i], 2 * i + 1);
+  }
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+
+  // A callable created without max_pipelined_steps only runs synchronously.
+  TF_ASSERT_OK(session->MakeCallable(
+      MakeCallableOptions({}, {y_neg_ + ":0"}, {}), &handle));
+  Status status;
+  session->RunCallableAsync(handle, {}, &outputs[0], nullptr,
+                            [&status](const Status& s) { status = s; });
+  EXPECT_TRUE(errors::IsInvalidArgument(status));
+}
+
+TEST(DirectSessionTest, PipelinedCallableRejectsSideEffects) {
+  Graph g(OpRegistry::Global());
+  Node* var = test::graph::Var(&g, DT_FLOAT, TensorShape({10}));
+  var->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+  Tensor twenty(DT_FLOAT, TensorShape({10}));
+  test::FillFn<float>(&twenty, [](int) { return 20.0f; });
+  Node* assign =
+      test::graph::Assign(&g, var, test::graph::Constant(&g, twenty));
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {}, {assign->name()});
+  callable_options.set_max_pipelined_steps(2);
+  Session::CallableHandle handle;
+  Status s = session->MakeCallable(callable_options, &handle);
+  EXPECT_TRUE(errors::IsInvalidArgument(s));
+  EXPECT_TRUE(absl::StrContains(s.message(), "must not have side effects"))
+      << s;
+}
+
 TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   Initialize({1, 2, 3, 4});
 
@@ -1519,6 +1627,95 @@ TEST(DirectSessionTest, DarthKernel) {
   EXPECT_TRUE(errors::IsInternal(s));
 }
 
+REGISTER_OP("CountConstructions").Input("x: float").Output("y: float");
+
+// The CountConstructions kernel forwards its input and counts the number of
+// times it has been constructed.
+class CountConstructionsOp : public OpKernel {
+ public:
+  explicit CountConstructionsOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    num_constructed.fetch_add(1);
+  }
+  void Compute(OpKernelContext* ctx) override {
+    ctx->set_output(0, ctx->input(0));
+  }
+
+  static std::atomic<int> num_constructed;
+};
+std::atomic<int> CountConstructionsOp::num_constructed{0};
+REGISTER_KERNEL_BUILDER(Name("CountConstructions").Device(DEVICE_CPU),
+                        CountConstructionsOp);
+
+TEST(DirectSessionTest, CallablesDoNotShareExecutorsByDefault) {
+  Graph g(OpRegistry::Global());
+  Node* x = test::graph::Constant(&g, test::AsScalar<float>(1.0f));
+  Node* y = test::graph::Unary(&g, "CountConstructions", x);
+  GraphDef def;
+  g.ToGraphDef(&def);
+  auto sess = CreateSession();
+  TF_ASSERT_OK(sess->Create(def));
+
+  CountConstructionsOp::num_constructed = 0;
+  const CallableOptions callable_options =
+      MakeCallableOptions({x->name() + ":0"}, {y->name() + ":0"}, {});
+  Session::CallableHandle first;
+  TF_ASSERT_OK(sess->MakeCallable(callable_options, &first));
+  Session::CallableHandle second;
+  TF_ASSERT_OK(sess->MakeCallable(callable_options, &second));
+  EXPECT_EQ(2, CountConstructionsOp::num_constructed);
+  TF_ASSERT_OK(sess->ReleaseCallable(first));
+  TF_ASSERT_OK(sess->ReleaseCallable(second));
+}
+
+TEST(DirectSessionTest, IdenticalCallablesShareExecutors) {
+  Graph g(OpRegistry::Global());
+  // `x` is always fed, which prevents constant folding from constructing the
+  // kernel of `y`.
+  Node* x = test::graph::Constant(&g, test::AsScalar<float>(1.0f));
+  Node* y = test::graph::Unary(&g, "CountConstructions", x);
+  Node* z = test::graph::Unary(&g, "Identity", y);
+  GraphDef def;
+  g.ToGraphDef(&def);
+  setenv("TF_DIRECT_SESSION_SHARE_PARTITION_EXECUTORS", "true",
+         /*overwrite=*/1);
+  auto sess = CreateSession();
+  unsetenv("TF_DIRECT_SESSION_SHARE_PARTITION_EXECUTORS");
+  TF_ASSERT_OK(sess->Create(def));
+
+  CountConstructionsOp::num_constructed = 0;
+  const CallableOptions callable_options =
+      MakeCallableOptions({x->name() + ":0"}, {y->name() + ":0"}, {});
+  Session::CallableHandle first;
+  TF_ASSERT_OK(sess->MakeCallable(callable_options, &first));
+  Session::CallableHandle second;
+  TF_ASSERT_OK(sess->MakeCallable(callable_options, &second));
+  EXPECT_EQ(1, CountConstructionsOp::num_constructed);
+
+  // The second callable keeps the shared executor alive after the first one
+  // is released.
+  TF_ASSERT_OK(sess->ReleaseCallable(first));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(sess->RunCallable(
+      second, {test::AsScalar<float>(3.0f)}, &outputs, nullptr));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(3.0f, outputs[0].scalar<float>()());
+
+  // A callable with a different graph gets its own executor.
+  Session::CallableHandle third;
+  TF_ASSERT_OK(sess->MakeCallable(
+      MakeCallableOptions({x->name() + ":0"}, {z->name() + ":0"}, {}),
+      &third));
+  EXPECT_EQ(2, CountConstructionsOp::num_constructed);
+
+  // Once every user of an executor has been released, it is rebuilt.
+  TF_ASSERT_OK(sess->ReleaseCallable(second));
+  Session::CallableHandle fourth;
+  TF_ASSERT_OK(sess->MakeCallable(callable_options, &fourth));
+  EXPECT_EQ(3, CountConstructionsOp::num_constructed);
+  TF_ASSERT_OK(sess->ReleaseCallable(third));
+  TF_ASSERT_OK(sess->ReleaseCallable(fourth));
+}
+
 // Have the Darth op in the graph placed on GPU, but don't run it.
 TEST(DirectSessionTest, PlacePrunedGraph) {
   {
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/context.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <thread>
@@ -457,9 +458,11 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
     kernel_cache_.clear();
+    kernel_cache_generation_.fetch_add(1, std::memory_order_relaxed);
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
+    ClearThreadKernelCaches();
   }
   {
     mutex_lock dl(device_cache_mu_);
@@ -599,6 +602,9 @@ void EagerContext::WaitForAndCloseRemoteContexts() {
 }
 
 EagerContext::~EagerContext() {
+  // Runs the recorded ops while the context is still intact.
+  lazy_op_tracer_.reset();
+
   // TODO(iga): Add a separate API method to shutdown EagerContext so that we
   // don't send RPCs and block in destructor.
   WaitForAndCloseRemoteContexts();
@@ -718,6 +724,10 @@ bool EagerContext::RunEagerOpAsFunction() const {
   return run_eager_op_as_function_;
 }
 
+void EagerContext::SetLazyOpTracer(std::unique_ptr<LazyOpTracer> tracer) {
+  lazy_op_tracer_ = std::move(tracer);
+}
+
 void EagerContext::SetRunEagerOpAsFunction(bool enable) {
   run_eager_op_as_function_ = enable;
 }
@@ -1105,6 +1115,8 @@ Status EagerContext::RemoveFunction(const string& func) {
       for (auto& key : *registered_function->cached_kernel_keys) {
         kernel_cache_.erase(key);
       }
+      kernel_cache_generation_.fetch_add(1, std::memory_order_relaxed);
+      ClearThreadKernelCaches();
       registered_functions_.erase(func);
     }
     registered_function->Unref();
@@ -1184,16 +1196,116 @@ Status EagerContext::SyncExecutors() {
   return sg.as_summary_status();
 }
 
+struct EagerContext::ThreadKernelCache {
+  static constexpr int kNumEntries = 8;
+
+  ~ThreadKernelCache() { Detach(); }
+
+  void Attach(std::shared_ptr<ThreadKernelCacheRegistry> new_registry) {
+    Detach();
+    registry = std::move(new_registry);
+    mutex_lock l(registry->mu);
+    registry->caches.insert(this);
+  }
+
+  void Detach() {
+    if (registry == nullptr) return;
+    {
+      mutex_lock l(registry->mu);
+      registry->caches.erase(this);
+    }
+    Clear();
+    registry = nullptr;
+  }
+
+  core::RefCountPtr<KernelAndDevice> Find(const Fprint128& key) {
+    mutex_lock l(mu);
+    for (const Entry& entry : entries) {
+      if (entry.kernel != nullptr && entry.key == key) {
+        core::RefCountPtr<KernelAndDevice> new_ref(entry.kernel.get());
+        new_ref->Ref();
+        return new_ref;
+      }
+    }
+    return nullptr;
+  }
+
+  // Adds `kernel` unless kernels were removed from the context cache since
+  // `generation`, i.e. since `kernel` was looked up.
+  void Insert(const Fprint128& key, KernelAndDevice* kernel,
+              int64_t generation, const std::atomic<int64_t>& current) {
+    core::RefCountPtr<KernelAndDevice> evicted;
+    {
+      mutex_lock l(mu);
+      if (generation != current.load(std::memory_order_relaxed)) return;
+      Entry& entry = entries[next_entry];
+      next_entry = (next_entry + 1) % kNumEntries;
+      kernel->Ref();
+      evicted = std::move(entry.kernel);
+      entry.key = key;
+      entry.kernel.reset(kernel);
+    }
+  }
+
+  // Releases the kernels after `mu` is unlocked, since their destruction may
+  // be arbitrarily expensive.
+  void Clear() {
+    std::vector<core::RefCountPtr<KernelAndDevice>> kernels;
+    kernels.reserve(kNumEntries);
+    mutex_lock l(mu);
+    for (Entry& entry : entries) {
+      if (entry.kernel != nullptr) kernels.push_back(std::move(entry.kernel));
+    }
+  }
+
+  struct Entry {
+    Fprint128 key = {0, 0};
+    core::RefCountPtr<KernelAndDevice> kernel;
+  };
+
+  // Only accessed by the thread which owns the cache.
+  std::shared_ptr<ThreadKernelCacheRegistry> registry;
+  mutex mu;
+  Entry entries[kNumEntries] TF_GUARDED_BY(mu);
+  int next_entry TF_GUARDED_BY(mu) = 0;
+};
+
+EagerContext::ThreadKernelCache* EagerContext::GetThreadKernelCache() {
+  // Detaches itself from its registry when the thread exits.
+  static thread_local ThreadKernelCache thread_cache;
+  if (thread_cache.registry != thread_kernel_caches_) {
+    thread_cache.Attach(thread_kernel_caches_);
+  }
+  return &thread_cache;
+}
+
+void EagerContext::ClearThreadKernelCaches() {
+  mutex_lock l(thread_kernel_caches_->mu);
+  for (ThreadKernelCache* thread_cache : thread_kernel_caches_->caches) {
+    thread_cache->Clear();
+  }
+}
+
 core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
     Fprint128 cache_key) {
-  tf_shared_lock l(cache_mu_);
-  auto iter = kernel_cache_.find(cache_key);
-  if (iter == kernel_cache_.end()) {
-    return nullptr;
+  ThreadKernelCache* thread_cache = GetThreadKernelCache();
+  core::RefCountPtr<KernelAndDevice> kernel = thread_cache->Find(cache_key);
+  if (kernel != nullptr) return kernel;
+
+  int64_t generation;
+  {
+    tf_shared_lock l(cache_mu_);
+    auto iter = kernel_cache_.find(cache_key);
+    if (iter == kernel_cache_.end()) {
+      return nullptr;
+    }
+    kernel.reset(iter->second.get());
+    kernel->Ref();
+    generation = kernel_cache_generation_.load(std::memory_order_relaxed);
   }
-  core::RefCountPtr<KernelAndDevice> new_ref(iter->second.get());
-  new_ref->Ref();
-  return new_ref;
+  thread_cache->Insert(cache_key, kernel.get(), generation,
+                       kernel_cache_generation_);
+  return kernel;
 }
 
 Device* EagerContext::GetCachedDevice(Fprint128 device_cache_key) {
@@ -1897,7 +2009,6 @@ Status EagerContext::UpdateRemoteWorker(
         "initialized as a master context.");
   }
 
-  ClearCachesAndThreadExecutors();
   default_executor_.ClearError();
   {
     tensorflow::mutex_lock l(executor_map_mu_);
@@ -89,6 +89,27 @@ namespace eager {
 class RemoteMgr;
 }  // namespace eager
 
+class EagerOperation;
+class TensorHandle;
+
+// Records the ops run by EagerExecute() instead of running them, until they
+// are flushed. See LazyTrace in lazy_trace.h.
+class LazyOpTracer {
+ public:
+  virtual ~LazyOpTracer() = default;
+
+  // Whether `op` can be recorded instead of run.
+  virtual bool CanRecord(EagerOperation* op) = 0;
+
+  // Records `op`, whose outputs are returned as non-ready handles which become
+  // ready once the op is flushed.
+  virtual Status Record(EagerOperation* op, TensorHandle** retvals,
+                        int* num_retvals) = 0;
+
+  // Runs the recorded ops.
+  virtual void Flush() = 0;
+};
+
 class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
  public:
   static constexpr uint64 kInvalidContextId = 0;
@@ -156,6 +177,12 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   void SetRunEagerOpAsFunction(bool enable) override;
 
+  // While set, EagerExecute() lets `tracer` record the ops it can record, and
+  // flushes it before running any other op. The previous tracer, if any, is
+  // destroyed. Must not be called concurrently with the execution of ops.
+  void SetLazyOpTracer(std::unique_ptr<LazyOpTracer> tracer);
+  LazyOpTracer* lazy_op_tracer() const { return lazy_op_tracer_.get(); }
+
   bool JitCompileRewrite() const;
 
   void SetJitCompileRewrite(bool enable) override;
@@ -478,7 +505,8 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       std::function<void()> resource_deallocator);
 
   // Similar with InitializeRemoteWorker but will reuse existing context and
-  // increment context_view_id.
+  // increment context_view_id. Keeps the caches, which the caller clears if
+  // remote devices were removed or replaced.
   Status UpdateRemoteWorker(
       std::unique_ptr<eager::EagerClientCache> remote_eager_workers,
       const std::vector<string>& remote_contexts, uint64 context_id);
@@ -773,6 +801,26 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::unordered_map<Fprint128, core::RefCountPtr<KernelAndDevice>,
                      Fprint128Hasher>
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
+  // Incremented whenever kernels are removed from `kernel_cache_`, so that a
+  // kernel looked up before the removal isn't added to a thread kernel cache.
+  std::atomic<int64_t> kernel_cache_generation_{0};
+
+  // A few kernels recently looked up by a thread, which lets the dispatch of
+  // the same ops skip `cache_mu_` and the hash map lookup.
+  struct ThreadKernelCache;
+  // The thread kernel caches attached to this context, which must be cleared
+  // whenever kernels are removed from `kernel_cache_`. The caches hold a
+  // reference to the registry, so that they can detach themselves after the
+  // context is destroyed.
+  struct ThreadKernelCacheRegistry {
+    mutex mu;
+    absl::flat_hash_set<ThreadKernelCache*> caches TF_GUARDED_BY(mu);
+  };
+  const std::shared_ptr<ThreadKernelCacheRegistry> thread_kernel_caches_ =
+      std::make_shared<ThreadKernelCacheRegistry>();
+  // Returns the kernel cache of the current thread, attached to this context.
+  ThreadKernelCache* GetThreadKernelCache();
+  void ClearThreadKernelCaches();
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
 
@@ -895,6 +943,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   // to this context.
   std::function<void()> resource_deallocator_ = nullptr;
   bool run_eager_op_as_function_;
+  std::unique_ptr<LazyOpTracer> lazy_op_tracer_;
   bool jit_compile_rewrite_;
 };
 
@@ -389,8 +389,11 @@ Status UpdateRemoteContexts(EagerContext* context,
       request.mutable_server_def()->set_task_index(parsed_name.task);
       request.mutable_server_def()->mutable_default_session_config()->MergeFrom(
           server_def.default_session_config());
+      // The worker already knows the devices of the other existing workers,
+      // so only send the devices of the added (and replaced) ones.
+      request.set_cluster_device_attributes_delta(true);
       for (int i = 0; i < cluster_device_count; i++) {
-        if (filtered_device_mask[i]) {
+        if (added_or_removed_filtered_devices[i]) {
           const auto& da = base_request.cluster_device_attributes(i);
           *request.add_cluster_device_attributes() = da;
         }
@@ -512,10 +515,6 @@ Status UpdateContextWithServerDef(EagerContext* context,
                             &new_remote_device_mgr));
     remote_device_mgr = new_remote_device_mgr.get();
   } else {
-    // NOTE(b/143914772): Potential memory leak if rendezvous has pending
-    // tensors for removed / replaced workers.
-    context->ClearCachesAndDefaultExecutor();
-
     remote_device_mgr = context->GetOwnedRemoteDeviceMgr();
     if (remote_device_mgr == nullptr) {
       LOG_AND_RETURN_IF_ERROR(errors::InvalidArgument(
@@ -550,6 +549,13 @@ Status UpdateContextWithServerDef(EagerContext* context,
             existing_workers.end());
       }
     }
+    if (!removed_workers.empty()) {
+      // Cached kernels may run on the devices of the removed workers. When
+      // workers are only added, the caches remain valid and are kept.
+      // NOTE(b/143914772): Potential memory leak if rendezvous has pending
+      // tensors for removed / replaced workers.
+      context->ClearCachesAndDefaultExecutor();
+    }
     sg.Update(RemoveRemoteDevicesFromMgr(removed_workers, remote_device_mgr));
     sg.Update(AddRemoteDevicesToMgr(
         added_workers, server->master_env()->worker_cache, remote_device_mgr));
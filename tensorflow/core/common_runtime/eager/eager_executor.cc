@@ -17,8 +17,10 @@ limitations under the License.
 
 #include <forward_list>
 #include <functional>
+#include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -32,6 +34,13 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64_t GetLookaheadNodes() {
+  int64_t lookahead_nodes = 0;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_EXECUTOR_LOOKAHEAD_NODES", 0,
+                                  &lookahead_nodes));
+  return lookahead_nodes;
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
@@ -42,6 +51,13 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
                     : nullptr),
+      lookahead_nodes_(async ? GetLookaheadNodes() : 0),
+      lookahead_thread_(lookahead_nodes_ > 0
+                            ? tensorflow::Env::Default()->StartThread(
+                                  tensorflow::ThreadOptions(),
+                                  "eager_async_lookahead",
+                                  std::bind(&EagerExecutor::RunLookahead, this))
+                            : nullptr),
       last_eager_client_(nullptr),
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
@@ -57,6 +73,7 @@ EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   state_ = ExecutorState::kShutDown;
   nodes_pending_.notify_all();
+  lookahead_pending_.notify_all();
   for (const auto& cleanups_for_key : cleanups_) {
     for (const std::function<void()>& cleanup : cleanups_for_key.second) {
       cleanup();
@@ -85,6 +102,7 @@ Status EagerExecutor::ShutDown() {
       status = status_;
       if (has_thread) {
         nodes_pending_.notify_all();
+        lookahead_pending_.notify_all();
       }
     }
     if (!has_thread) {
@@ -160,11 +178,15 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
           nodes_pending_.notify_all();
+        } else if (lookahead_thread_ != nullptr &&
+                   static_cast<int64_t>(node_queue_.size()) <=
+                       lookahead_nodes_ + 1) {
+          lookahead_pending_.notify_all();
         }
         if (in_flight_nodes_limit_ == 0) {
           return OkStatus();
@@ -256,7 +278,8 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
+      if (lookahead_thread_ != nullptr) lookahead_pending_.notify_all();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,7 +313,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -372,6 +395,41 @@ void EagerExecutor::Run() {
   }
 }
 
+bool EagerExecutor::HasNodesToPrepareLocked() const {
+  if (!status_.ok() || node_queue_.size() < 2) return false;
+  const size_t end =
+      std::min<size_t>(node_queue_.size(), lookahead_nodes_ + 1);
+  return node_queue_[end - 1]->id >= next_id_to_prepare_;
+}
+
+void EagerExecutor::RunLookahead() {
+  while (true) {
+    std::vector<core::RefCountPtr<NodeItem>> items;
+    {
+      tensorflow::mutex_lock l(node_queue_mutex_);
+      while (!HasNodesToPrepareLocked()) {
+        if (state_ == ExecutorState::kShutDown) return;
+        lookahead_pending_.wait(l);
+      }
+      // Skip the front of the queue, which is about to run.
+      const size_t end =
+          std::min<size_t>(node_queue_.size(), lookahead_nodes_ + 1);
+      for (size_t i = 1; i < end; ++i) {
+        NodeItem* item = node_queue_[i].get();
+        if (item->id < next_id_to_prepare_) continue;
+        item->Ref();
+        items.emplace_back(item);
+      }
+      next_id_to_prepare_ = node_queue_[end - 1]->id + 1;
+    }
+    // The nodes may be destroyed here, when no lock is held, if they have
+    // finished running in the meantime.
+    for (const auto& item : items) {
+      item->node->PrepareAhead();
+    }
+  }
+}
+
 Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
                               bool from_queue) {
   DVLOG(3) << "Running Node: [id " << item->id << "] "
@@ -434,7 +492,8 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
+    if (lookahead_thread_ != nullptr) lookahead_pending_.notify_all();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
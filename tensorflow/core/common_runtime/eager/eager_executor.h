@@ -18,10 +18,10 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -61,6 +61,12 @@ class EagerNode {
   // EagerExecutor will abort the node immediately.
   virtual Status Prepare() { return OkStatus(); }
 
+  // Called by an async executor with lookahead (see EagerExecutor) while this
+  // node waits in the queue behind the running node, so that host-side work
+  // which doesn't depend on the outputs of pending nodes overlaps with their
+  // execution. It may run concurrently with Run() and Abort(), and at most once.
+  virtual void PrepareAhead() {}
+
   // Runs the computation corresponding to this node and blocks till the
   // execution is done.
   virtual Status Run() = 0;
@@ -113,6 +119,10 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): Support out-of-order execution and dispatching multiple
 // EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
+//
+// If TF_EAGER_EXECUTOR_LOOKAHEAD_NODES is set to K > 0, an async executor
+// calls EagerNode::PrepareAhead() on a second thread for the K nodes following
+// the running one.
 class EagerExecutor {
  public:
   explicit EagerExecutor(bool async, bool enable_streaming_enqueue = true,
@@ -210,6 +220,14 @@ class EagerExecutor {
   // `status_` is not ok.
   void Run();
 
+  // Calls PrepareAhead() on the nodes following the front of `node_queue_`
+  // until state_ is set to kShutDown.
+  void RunLookahead();
+  // Whether some of the first `lookahead_nodes_` nodes behind the front of
+  // `node_queue_` haven't been prepared yet.
+  bool HasNodesToPrepareLocked() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
@@ -228,11 +246,16 @@ class EagerExecutor {
   condition_variable nodes_pending_ TF_GUARDED_BY(node_queue_mutex_);
   // Used to signal that some EagerNodes are done.
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
+  // Used to signal the lookahead thread that the queue has changed.
+  condition_variable lookahead_pending_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
+  // The id of the last node passed to PrepareAhead(), plus one.
+  uint64 next_id_to_prepare_ TF_GUARDED_BY(node_queue_mutex_) = 0;
+
   // Ordered by NodeItem::id.
   std::map<uint64, core::RefCountPtr<NodeItem>, std::less<uint64>>
       unfinished_nodes_ TF_GUARDED_BY(node_queue_mutex_);
@@ -262,6 +285,12 @@ class EagerExecutor {
   // until state_ is set to kShuttingDown. It is `nullptr` in sync mode.
   const std::unique_ptr<Thread> thread_;
 
+  // The number of queued nodes which are prepared ahead of their execution.
+  const int64_t lookahead_nodes_;
+  // Thread which calls `RunLookahead` in async mode if `lookahead_nodes_` is
+  // positive, and `nullptr` otherwise.
+  const std::unique_ptr<Thread> lookahead_thread_;
+
   // Last device where remote function with remote inputs was executed.
   const eager::EagerClient* last_eager_client_;
 
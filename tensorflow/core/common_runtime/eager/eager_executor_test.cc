@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <stdlib.h>
+
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +105,28 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// Blocks in Run() until `release` is notified, and notifies `prepared` when it
+// is prepared ahead.
+class TestLookaheadNode : public EagerNode {
+ public:
+  TestLookaheadNode(Notification* release, Notification* prepared)
+      : release_(release), prepared_(prepared) {}
+
+  void PrepareAhead() override { prepared_->Notify(); }
+
+  Status Run() override {
+    if (release_ != nullptr) release_->WaitForNotification();
+    return OkStatus();
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "testLookaheadNode"; }
+
+ private:
+  Notification* release_;
+  Notification* prepared_;
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -281,5 +306,30 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+TEST(EagerExecutorTest, TestAsyncExecutorPreparesNodesAhead) {
+  // Outlives the executor, whose threads may still use them.
+  Notification release, prepared[3];
+  setenv("TF_EAGER_EXECUTOR_LOOKAHEAD_NODES", "1", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_EXECUTOR_LOOKAHEAD_NODES");
+
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestLookaheadNode>(&release, &prepared[0])));
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestLookaheadNode>(nullptr, &prepared[1])));
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestLookaheadNode>(nullptr, &prepared[2])));
+
+  // Only the node following the running one is prepared.
+  prepared[1].WaitForNotification();
+  EXPECT_FALSE(prepared[0].HasBeenNotified());
+  EXPECT_FALSE(prepared[2].HasBeenNotified());
+
+  release.Notify();
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -2111,11 +2111,20 @@ Status DoEagerExecute(EagerOperation* op, TensorHandle** retvals,
   std::unique_ptr<tensorflow::EagerOperation> out_op;
   TF_RETURN_IF_ERROR(EagerOpRewriteRegistry::Global()->RunRewrite(
       EagerOpRewriteRegistry::PRE_EXECUTION, op, &out_op));
+  if (out_op) {
+    op = out_op.get();
+  }
 
-  if (op->IsLocal()) {
-    if (out_op) {
-      op = out_op.get();
+  LazyOpTracer* lazy_op_tracer = op->EagerContext().lazy_op_tracer();
+  if (lazy_op_tracer != nullptr) {
+    if (op->IsLocal() && lazy_op_tracer->CanRecord(op)) {
+      return lazy_op_tracer->Record(op, retvals, num_retvals);
     }
+    // The recorded ops run before any other op, which may be stateful.
+    lazy_op_tracer->Flush();
+  }
+
+  if (op->IsLocal()) {
     TF_RETURN_IF_ERROR(MaybePackInputTensor(op));
     return EagerLocalExecute(op, retvals, num_retvals);
   }
@@ -2124,9 +2133,6 @@ Status DoEagerExecute(EagerOperation* op, TensorHandle** retvals,
   return errors::Unimplemented(
       "Eager's remote execution is not available on mobile devices.");
 #else   // !IS_MOBILE_PLATFORM
-  if (out_op) {
-    op = out_op.get();
-  }
   return EagerRemoteExecute(op, retvals, num_retvals);
 #endif  // !IS_MOBILE_PLATFORM
 }
@@ -2139,12 +2145,24 @@ Status EagerKernelExecute(
     GraphCollector* graph_collector, CancellationManager* cancellation_manager,
     absl::Span<TensorHandle*> retvals,
     const absl::optional<ManagedStackTrace>& stack_trace) {
+  ExecuteNodeArgs inputs(op_inputs.size());
+  TF_RETURN_IF_ERROR(inputs.Init(ctx, op_inputs, kernel));
+  return EagerKernelExecute(ctx, inputs, eager_func_params, kernel,
+                            graph_collector, cancellation_manager, retvals,
+                            stack_trace);
+}
+
+Status EagerKernelExecute(
+    EagerContext* ctx, const ExecuteNodeArgs& inputs,
+    const absl::optional<EagerFunctionParams>& eager_func_params,
+    const core::RefCountPtr<KernelAndDevice>& kernel,
+    GraphCollector* graph_collector, CancellationManager* cancellation_manager,
+    absl::Span<TensorHandle*> retvals,
+    const absl::optional<ManagedStackTrace>& stack_trace) {
   profiler::TraceMe activity("EagerKernelExecute",
                              profiler::TraceMeLevel::kInfo);
   std::vector<EagerKernelRet> outputs(1);
 
-  ExecuteNodeArgs inputs(op_inputs.size());
-  TF_RETURN_IF_ERROR(inputs.Init(ctx, op_inputs, kernel));
   // TODO(apassos) figure out how to record stats for ops which are a part of
   // functions.
   // TODO(b/111859745): When we support recovering from kernel/device errors, we
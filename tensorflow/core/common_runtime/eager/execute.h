@@ -27,6 +27,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class ExecuteNodeArgs;
+
 // Utility function that executes a fully constructed EagerOperation.
 // There are a few possible different combinations of how things can be
 // executed:
@@ -55,6 +57,15 @@ Status EagerKernelExecute(
     absl::Span<TensorHandle*> retvals,
     const absl::optional<ManagedStackTrace>& stack_trace = {});
 
+// Same as above, with the inputs already resolved by ExecuteNodeArgs::Init().
+Status EagerKernelExecute(
+    EagerContext* ctx, const ExecuteNodeArgs& inputs,
+    const absl::optional<EagerFunctionParams>& eager_func_params,
+    const core::RefCountPtr<KernelAndDevice>& kernel,
+    GraphCollector* graph_collector, CancellationManager* cancellation_manager,
+    absl::Span<TensorHandle*> retvals,
+    const absl::optional<ManagedStackTrace>& stack_trace = {});
+
 // Low-level utility to copy a tensor handle from one device to another. If
 // successful, result TensorHandle will be populated. If the caller requests for
 // the mirror flag, EagerCopyToDevice will attempt to add a mirror to the
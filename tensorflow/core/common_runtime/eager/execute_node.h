@@ -43,6 +43,8 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/distributed_runtime/eager/remote_mgr.h"
 #include "tensorflow/core/protobuf/remote_tensor_handle.pb.h"
@@ -190,7 +192,32 @@ class AsyncExecuteNode : public EagerNode {
     }
   }
 
+  // Resolves the inputs if they are all local tensors which are ready on the
+  // input devices of the kernel. Resolving them later, e.g. once mirrors are
+  // copied, is left to Run().
+  void PrepareAhead() override {
+    mutex_lock l(prepare_mu_);
+    if (started_) return;
+    for (int i = 0, end = inputs_.size(); i < end; ++i) {
+      const TensorHandle* h = inputs_[i];
+      if (h->Type() != TensorHandle::LOCAL || !h->IsReady() ||
+          h->device() != ctx_->CanonicalDevice(kernel_->InputDevice(i))) {
+        return;
+      }
+    }
+    auto inputs = std::make_unique<ExecuteNodeArgs>(inputs_.size());
+    if (inputs->Init(ctx_, inputs_, kernel_).ok()) {
+      prepared_inputs_ = std::move(inputs);
+    }
+  }
+
   Status Run() override {
+    std::unique_ptr<ExecuteNodeArgs> prepared_inputs;
+    {
+      mutex_lock l(prepare_mu_);
+      started_ = true;
+      prepared_inputs = std::move(prepared_inputs_);
+    }
     int i = 0;
     for (TensorHandle* h : inputs_) {
       if (h->RefCountIsOne()) {
@@ -202,9 +229,15 @@ class AsyncExecuteNode : public EagerNode {
       }
       ++i;
     }
-    Status status = EagerKernelExecute(
-        ctx_, inputs_, eager_func_params_, kernel_, graph_collector_,
-        cancellation_manager_, absl::MakeSpan(retvals_), stack_trace_);
+    Status status =
+        prepared_inputs != nullptr
+            ? EagerKernelExecute(ctx_, *prepared_inputs, eager_func_params_,
+                                 kernel_, graph_collector_,
+                                 cancellation_manager_,
+                                 absl::MakeSpan(retvals_), stack_trace_)
+            : EagerKernelExecute(ctx_, inputs_, eager_func_params_, kernel_,
+                                 graph_collector_, cancellation_manager_,
+                                 absl::MakeSpan(retvals_), stack_trace_);
     if (!status.ok()) {
       if (stack_trace_.has_value()) {
         errors::SetStackTrace(
@@ -242,6 +275,11 @@ class AsyncExecuteNode : public EagerNode {
   CancellationManager* const cancellation_manager_;
   std::optional<ManagedStackTrace> stack_trace_;
   absl::InlinedVector<TensorHandle*, 2> retvals_;
+
+  mutex prepare_mu_;
+  // Whether Run() has started, after which PrepareAhead() does nothing.
+  bool started_ TF_GUARDED_BY(prepare_mu_) = false;
+  std::unique_ptr<ExecuteNodeArgs> prepared_inputs_ TF_GUARDED_BY(prepare_mu_);
 };
 
 }  // namespace tensorflow
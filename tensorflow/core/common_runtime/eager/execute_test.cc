@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/execute.h"
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -23,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -410,5 +413,104 @@ TEST(ExecuteTest, MultipleNestedCompiledFunction) {
   ctx->Unref();
 }
 
+// Returns a function which multiplies its int64 input by `factor`.
+FunctionDef XTimes(const string& name, int64_t factor) {
+  return FunctionDefHelper::Define(
+      // Name
+      name,
+      // Args
+      {"x: int64"},
+      // Return values
+      {"y: int64"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"factor"},
+           "Const",
+           {},
+           {{"value", test::AsScalar<int64_t>(factor)}, {"dtype", DT_INT64}}},
+          {{"y"}, "Mul", {"x", "factor"}, {{"T", DT_INT64}}},
+      });
+}
+
+// Runs the function `name` on 3.
+int64_t RunOnThree(EagerContext* ctx, const string& name) {
+  auto op = std::make_unique<EagerOperation>(ctx);
+  TF_CHECK_OK(op->Reset(
+      /*op=*/name.c_str(),
+      /*raw_device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0"));
+  Tensor input_tensor = test::AsScalar<int64_t>(3);
+  auto input = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      ctx->CreateLocalHandleFromTFTensor(input_tensor,
+                                         ctx->HostCPUName().c_str()));
+  TF_CHECK_OK(op->AddInput(input.get()));
+
+  std::vector<TensorHandle*> retvals(1);
+  int num_retvals = retvals.size();
+  TF_CHECK_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+  const Tensor* output;
+  TF_CHECK_OK(retvals[0]->Tensor(&output));
+  const int64_t result = output->scalar<int64_t>()();
+  retvals[0]->Unref();
+  return result;
+}
+
+TEST(ExecuteTest, RedefinedFunctionMissesThreadKernelCache) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+
+  // The second run finds the kernel in the cache of this thread.
+  TF_ASSERT_OK(ctx->AddFunctionDef(XTimes("Scale", 2)));
+  EXPECT_EQ(RunOnThree(ctx, "Scale"), 6);
+  EXPECT_EQ(RunOnThree(ctx, "Scale"), 6);
+
+  TF_ASSERT_OK(ctx->RemoveFunction("Scale"));
+  TF_ASSERT_OK(ctx->AddFunctionDef(XTimes("Scale", 4)));
+  EXPECT_EQ(RunOnThree(ctx, "Scale"), 12);
+  EXPECT_EQ(RunOnThree(ctx, "Scale"), 12);
+
+  ctx->ClearCachesAndDefaultExecutor();
+  EXPECT_EQ(RunOnThree(ctx, "Scale"), 12);
+
+  ctx->Unref();
+}
+
+// Measures the dispatch overhead of a small op whose kernel is cached.
+void BM_EagerExecuteMul(::testing::benchmark::State& state) {
+  StaticDeviceMgr device_mgr(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto ctx = new EagerContext(
+      SessionOptions(),
+      tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+      false, &device_mgr, false, nullptr, nullptr);
+  Tensor input_tensor = test::AsScalar<int64_t>(3);
+  auto input = core::RefCountPtr<ImmediateExecutionTensorHandle>(
+      ctx->CreateLocalHandleFromTFTensor(input_tensor,
+                                         ctx->HostCPUName().c_str()));
+  auto op = std::make_unique<EagerOperation>(ctx);
+  std::vector<TensorHandle*> retvals(1);
+
+  for (auto s : state) {
+    TF_CHECK_OK(op->Reset(
+        /*op=*/"Mul",
+        /*raw_device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0"));
+    TF_CHECK_OK(op->AddInput(input.get()));
+    TF_CHECK_OK(op->AddInput(input.get()));
+    int num_retvals = retvals.size();
+    TF_CHECK_OK(EagerExecute(op.get(), retvals.data(), &num_retvals));
+    retvals[0]->Unref();
+  }
+
+  op.reset();
+  input.reset();
+  ctx->Unref();
+}
+BENCHMARK(BM_EagerExecuteMul);
+
 }  // namespace
 }  // namespace tensorflow
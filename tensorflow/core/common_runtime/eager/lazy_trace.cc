@@ -0,0 +1,282 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/lazy_trace.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kFunctionPrefix[] = "__lazy_trace_";
+
+// Ops whose outputs only depend on the elements of their inputs at the same
+// indices, modulo broadcasting.
+bool IsElementwiseOp(absl::string_view op) {
+  static const auto* const kOps = new absl::flat_hash_set<absl::string_view>({
+      "Abs",        "Add",          "AddV2",
+      "Cast",       "Ceil",         "Cos",
+      "Div",        "DivNoNan",     "Elu",
+      "Equal",      "Exp",          "Floor",
+      "FloorDiv",   "Greater",      "GreaterEqual",
+      "Less",       "LessEqual",    "Log",
+      "Log1p",      "LogicalAnd",   "LogicalNot",
+      "LogicalOr",  "Maximum",      "Minimum",
+      "Mul",        "Neg",          "NotEqual",
+      "Pow",        "RealDiv",      "Reciprocal",
+      "Relu",       "Relu6",        "Rsqrt",
+      "SelectV2",   "Selu",         "Sigmoid",
+      "Sign",       "Sin",          "Softplus",
+      "Sqrt",       "Square",       "SquaredDifference",
+      "Sub",        "Tanh",
+  });
+  return kOps->contains(op);
+}
+
+}  // namespace
+
+LazyTrace::LazyTrace(EagerContext* ctx, bool jit_compile, int max_ops)
+    : ctx_(ctx), jit_compile_(jit_compile), max_ops_(max_ops) {}
+
+LazyTrace::~LazyTrace() { Flush(); }
+
+Device* LazyTrace::InputDevice(EagerOperation* op) const {
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  if (!op->TensorHandleInputs(&inputs).ok() || inputs->empty()) {
+    return nullptr;
+  }
+  Device* device = nullptr;
+  for (TensorHandle* h : *inputs) {
+    if (h->Type() != TensorHandle::LOCAL) return nullptr;
+    Device* d = h->DeviceOrHostCPU(*ctx_);
+    if (device != nullptr && d != device) return nullptr;
+    device = d;
+  }
+  return device;
+}
+
+Status LazyTrace::BuildNodeDef(EagerOperation* op, const OpDef** op_def,
+                               NodeDef* ndef) const {
+  TF_RETURN_IF_ERROR(OpRegistry::Global()->LookUpOpDef(op->Name(), op_def));
+  ndef->set_op(op->Name());
+  op->Attrs().FillAttrValueMap(ndef->mutable_attr());
+  AddDefaultsToNodeDef(**op_def, ndef);
+  return OkStatus();
+}
+
+bool LazyTrace::CanRecord(EagerOperation* op) {
+  if (op->is_function() || op->Executor().Async() ||
+      !IsElementwiseOp(op->Name())) {
+    return false;
+  }
+  Device* device = InputDevice(op);
+  if (device == nullptr ||
+      (!op->DeviceName().empty() && op->DeviceName() != device->name())) {
+    return false;
+  }
+
+  const OpDef* op_def;
+  NodeDef ndef;
+  DataTypeVector output_types;
+  if (!BuildNodeDef(op, &op_def, &ndef).ok() || op_def->is_stateful() ||
+      !OutputTypesForNode(ndef, *op_def, &output_types).ok() ||
+      output_types.size() != 1 ||
+      !FindKernelDef(DeviceType(device->device_type()), ndef, nullptr, nullptr)
+           .ok()) {
+    return false;
+  }
+
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  TF_CHECK_OK(op->TensorHandleInputs(&inputs));
+  DataTypeVector dtypes = output_types;
+  for (TensorHandle* h : *inputs) dtypes.push_back(h->dtype);
+  // Such tensors are kept in host memory by the kernels of other devices.
+  if (device->device_type() != DEVICE_CPU) {
+    for (DataType dtype : dtypes) {
+      if (MTypeFromDType(dtype) == HOST_MEMORY) return false;
+    }
+  }
+
+  // The inputs which aren't ready are only computed by recorded ops.
+  mutex_lock l(mu_);
+  for (TensorHandle* h : *inputs) {
+    if (!h->IsReady() && !trace_.names.contains(h)) return false;
+  }
+  return true;
+}
+
+Status LazyTrace::Record(EagerOperation* op, TensorHandle** retvals,
+                         int* num_retvals) {
+  if (*num_retvals < 1) {
+    return errors::InvalidArgument(
+        "Expecting 1 outputs, but *num_retvals is ", *num_retvals);
+  }
+  Device* device = InputDevice(op);
+  const OpDef* op_def;
+  NodeDef ndef;
+  DataTypeVector output_types;
+  TF_RETURN_IF_ERROR(BuildNodeDef(op, &op_def, &ndef));
+  TF_RETURN_IF_ERROR(OutputTypesForNode(ndef, *op_def, &output_types));
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+
+  bool flush;
+  {
+    mutex_lock l(mu_);
+    flush = !trace_.nodes.empty() &&
+            (trace_.device != device ||
+             static_cast<int>(trace_.nodes.size()) >= max_ops_);
+  }
+  if (flush) Flush();
+
+  mutex_lock l(mu_);
+  trace_.device = device;
+  ndef.set_name(absl::StrCat("n", trace_.nodes.size()));
+  for (TensorHandle* h : *inputs) {
+    auto [it, inserted] = trace_.names.try_emplace(h);
+    if (inserted) {
+      it->second = absl::StrCat("arg", trace_.inputs.size());
+      h->Ref();
+      trace_.inputs.push_back(h);
+    }
+    ndef.add_input(it->second);
+  }
+
+  Device* output_device = ctx_->CanonicalDevice(device);
+  TensorHandle* output = TensorHandle::CreateEmptyLocalHandle(
+      output_device, device, /*resource_device=*/nullptr, output_types[0],
+      ctx_);
+  output->SetWaitCallback([this] { Flush(); });
+  output->Ref();
+  trace_.outputs.push_back(output);
+  trace_.names[output] =
+      absl::StrCat(ndef.name(), ":", op_def->output_arg(0).name(), ":0");
+  trace_.nodes.push_back(std::move(ndef));
+
+  retvals[0] = output;
+  *num_retvals = 1;
+  return OkStatus();
+}
+
+FunctionDef LazyTrace::ToFunctionDef(
+    const Trace& trace, const std::vector<int>& live_outputs) const {
+  FunctionDef fdef;
+  OpDef* signature = fdef.mutable_signature();
+  for (int i = 0, end = trace.inputs.size(); i < end; ++i) {
+    OpDef::ArgDef* arg = signature->add_input_arg();
+    arg->set_name(absl::StrCat("arg", i));
+    arg->set_type(trace.inputs[i]->dtype);
+  }
+  for (const NodeDef& node : trace.nodes) {
+    *fdef.add_node_def() = node;
+  }
+  for (int i = 0, end = live_outputs.size(); i < end; ++i) {
+    TensorHandle* output = trace.outputs[live_outputs[i]];
+    OpDef::ArgDef* arg = signature->add_output_arg();
+    arg->set_name(absl::StrCat("out", i));
+    arg->set_type(output->dtype);
+    (*fdef.mutable_ret())[arg->name()] = trace.names.at(output);
+  }
+  if (jit_compile_) {
+    (*fdef.mutable_attr())["_XlaMustCompile"].set_b(true);
+  }
+  // The same ops always get the same function.
+  signature->set_name(
+      absl::StrCat(kFunctionPrefix, absl::Hex(FunctionDefHash(fdef))));
+  return fdef;
+}
+
+Status LazyTrace::Run(const Trace& trace,
+                      const std::vector<int>& live_outputs) {
+  const FunctionDef fdef = ToFunctionDef(trace, live_outputs);
+  const std::string& name = fdef.signature().name();
+  if (ctx_->FindFunctionDef(name) == nullptr) {
+    TF_RETURN_IF_ERROR(ctx_->AddFunctionDef(fdef));
+  }
+
+  EagerOperation op(ctx_);
+  TF_RETURN_IF_ERROR(op.Reset(name.c_str(), trace.device->name().c_str()));
+  for (TensorHandle* h : trace.inputs) {
+    TF_RETURN_IF_ERROR(op.AddInput(h));
+  }
+  std::vector<TensorHandle*> retvals(live_outputs.size());
+  int num_retvals = retvals.size();
+  TF_RETURN_IF_ERROR(EagerExecute(&op, retvals.data(), &num_retvals));
+
+  Status status;
+  Device* output_device = ctx_->CanonicalDevice(trace.device);
+  for (int i = 0, end = retvals.size(); i < end; ++i) {
+    const Tensor* tensor = nullptr;
+    if (status.ok()) status = retvals[i]->Tensor(&tensor);
+    if (status.ok() && retvals[i]->DeviceOrHostCPU(*ctx_) != trace.device) {
+      status = errors::Internal("Output ", i, " of ", name, " is on ",
+                                retvals[i]->DeviceOrHostCPU(*ctx_)->name(),
+                                " instead of ", trace.device->name());
+    }
+    if (status.ok()) {
+      status = trace.outputs[live_outputs[i]]->SetTensor(Tensor(*tensor),
+                                                         output_device);
+    }
+    retvals[i]->Unref();
+  }
+  return status;
+}
+
+void LazyTrace::Flush() {
+  Trace trace;
+  {
+    mutex_lock l(mu_);
+    std::swap(trace, trace_);
+  }
+  if (trace.nodes.empty()) return;
+
+  // No output which is only referenced by the trace can be waited on.
+  std::vector<int> live_outputs;
+  for (int i = 0, end = trace.outputs.size(); i < end; ++i) {
+    if (!trace.outputs[i]->RefCountIsOne()) live_outputs.push_back(i);
+  }
+  if (!live_outputs.empty()) {
+    const Status status = Run(trace, live_outputs);
+    if (!status.ok()) {
+      VLOG(1) << "Failed to run " << trace.nodes.size()
+              << " recorded ops: " << status;
+      Device* output_device = ctx_->CanonicalDevice(trace.device);
+      for (int i : live_outputs) {
+        if (!trace.outputs[i]->IsReady()) {
+          trace.outputs[i]->Poison(status, output_device);
+        }
+      }
+    }
+  }
+
+  for (TensorHandle* h : trace.inputs) h->Unref();
+  for (TensorHandle* h : trace.outputs) h->Unref();
+}
+
+}  // namespace tensorflow
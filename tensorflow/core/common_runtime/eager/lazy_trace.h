@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_TRACE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_TRACE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Records chains of pure elementwise ops instead of running them one by one,
+// and runs them as a single function once one of their outputs is waited on,
+// another op is run, or `max_ops` ops are recorded.
+//
+// The functions are named after a fingerprint of their structure, so that the
+// traces of the same ops are only instantiated once, and hit the kernel cache
+// of the context afterwards. With `jit_compile`, the functions are compiled
+// with XLA, which fuses the elementwise ops.
+//
+// Install it with EagerContext::SetLazyOpTracer. Only ops run by synchronous
+// executors on local devices are recorded.
+class LazyTrace : public LazyOpTracer {
+ public:
+  LazyTrace(EagerContext* ctx, bool jit_compile, int max_ops = 64);
+  // Flushes the recorded ops.
+  ~LazyTrace() override;
+
+  bool CanRecord(EagerOperation* op) override;
+  Status Record(EagerOperation* op, TensorHandle** retvals,
+                int* num_retvals) override;
+  void Flush() override;
+
+ private:
+  struct Trace {
+    // The device of all the ops and of their inputs.
+    Device* device = nullptr;
+    std::vector<NodeDef> nodes;
+    // The inputs of the ops which aren't outputs of other recorded ops.
+    std::vector<TensorHandle*> inputs;
+    // The outputs of `nodes`.
+    std::vector<TensorHandle*> outputs;
+    // The names of `inputs` and `outputs` in the function.
+    absl::flat_hash_map<TensorHandle*, std::string> names;
+  };
+
+  // Returns the function running the ops of `trace` which compute the
+  // outputs indexed by `live_outputs`.
+  FunctionDef ToFunctionDef(const Trace& trace,
+                            const std::vector<int>& live_outputs) const;
+  // Runs the function of `trace` and sets the outputs indexed by
+  // `live_outputs`.
+  Status Run(const Trace& trace, const std::vector<int>& live_outputs);
+
+  // Returns the single device of the inputs of `op`, or nullptr.
+  Device* InputDevice(EagerOperation* op) const;
+  // Returns the node of `op`, without its name and inputs.
+  Status BuildNodeDef(EagerOperation* op, const OpDef** op_def,
+                      NodeDef* ndef) const;
+
+  EagerContext* const ctx_;
+  const bool jit_compile_;
+  const int max_ops_;
+
+  mutex mu_;
+  Trace trace_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_TRACE_H_
@@ -0,0 +1,135 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/lazy_trace.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpu[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class LazyTraceTest : public ::testing::Test {
+ protected:
+  LazyTraceTest()
+      : device_mgr_(DeviceFactory::NewDevice(
+            "CPU", {}, "/job:localhost/replica:0/task:0")),
+        ctx_(new EagerContext(
+            SessionOptions(),
+            tensorflow::ContextDevicePlacementPolicy::DEVICE_PLACEMENT_EXPLICIT,
+            false, &device_mgr_, false, nullptr, nullptr)) {
+    ctx_->SetLazyOpTracer(
+        std::make_unique<LazyTrace>(ctx_, /*jit_compile=*/false));
+  }
+
+  ~LazyTraceTest() override { ctx_->Unref(); }
+
+  TensorHandle* Scalar(int64_t value) {
+    return TensorHandle::CreateLocalHandle(test::AsScalar<int64_t>(value),
+                                           /*d=*/nullptr, /*op_device=*/nullptr,
+                                           ctx_);
+  }
+
+  // Runs the binary op `name` on `x` and `y`.
+  TensorHandle* Binary(const char* name, TensorHandle* x, TensorHandle* y) {
+    EagerOperation op(ctx_);
+    TF_CHECK_OK(op.Reset(name, kCpu));
+    TF_CHECK_OK(op.AddInput(x));
+    TF_CHECK_OK(op.AddInput(y));
+    TensorHandle* retval;
+    int num_retvals = 1;
+    TF_CHECK_OK(EagerExecute(&op, &retval, &num_retvals));
+    return retval;
+  }
+
+  int64_t Value(TensorHandle* h) {
+    const Tensor* t;
+    TF_CHECK_OK(h->Tensor(&t));
+    return t->scalar<int64_t>()();
+  }
+
+  int NumTraceFunctions() {
+    int count = 0;
+    for (const std::string& name : ctx_->FuncLibDef()->ListFunctionNames()) {
+      if (absl::StartsWith(name, "__lazy_trace_")) ++count;
+    }
+    return count;
+  }
+
+  StaticDeviceMgr device_mgr_;
+  EagerContext* ctx_;
+};
+
+TEST_F(LazyTraceTest, RunsRecordedOpsWhenWaitedOn) {
+  TensorHandle* x = Scalar(3);
+  TensorHandle* two = Scalar(2);
+  TensorHandle* one = Scalar(1);
+
+  for (int i = 0; i < 2; ++i) {
+    TensorHandle* y = Binary("Mul", x, two);
+    TensorHandle* z = Binary("AddV2", y, one);
+    EXPECT_FALSE(y->IsReady());
+    EXPECT_FALSE(z->IsReady());
+
+    EXPECT_EQ(Value(z), 7);
+    EXPECT_EQ(Value(y), 6);
+    y->Unref();
+    z->Unref();
+  }
+  // The second trace reuses the function of the first one.
+  EXPECT_EQ(NumTraceFunctions(), 1);
+
+  x->Unref();
+  two->Unref();
+  one->Unref();
+}
+
+TEST_F(LazyTraceTest, RunsRecordedOpsBeforeOtherOps) {
+  TensorHandle* x = Scalar(3);
+  TensorHandle* y = Binary("Mul", x, x);
+  EXPECT_FALSE(y->IsReady());
+
+  // Identity isn't recorded.
+  EagerOperation op(ctx_);
+  TF_ASSERT_OK(op.Reset("Identity", kCpu));
+  TF_ASSERT_OK(op.AddInput(x));
+  TensorHandle* identity;
+  int num_retvals = 1;
+  TF_ASSERT_OK(EagerExecute(&op, &identity, &num_retvals));
+  EXPECT_TRUE(y->IsReady());
+  EXPECT_EQ(Value(y), 9);
+
+  identity->Unref();
+  y->Unref();
+  x->Unref();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <queue>
@@ -53,6 +54,34 @@ limitations under the License.
 namespace tensorflow {
 
 namespace {
+// The memory of the handles recently deleted by a thread. It's trivially
+// destructible, so that it's still valid while the other thread locals are
+// destroyed, e.g. the ones holding handles.
+struct FreeHandles {
+  static constexpr int kCapacity = 64;
+  void* blocks[kCapacity];
+  // Negative once the thread has released the blocks, and exits.
+  int size;
+};
+thread_local FreeHandles free_handles;
+
+// Releases the blocks of `free_handles` when the thread exits.
+struct FreeHandlesReleaser {
+  ~FreeHandlesReleaser() {
+    for (int i = 0; i < free_handles.size; ++i) {
+      ::operator delete(free_handles.blocks[i]);
+    }
+    free_handles.size = -1;
+  }
+};
+
+#if defined(ADDRESS_SANITIZER)
+// Keeps the uses of deleted handles detectable.
+constexpr bool kReuseHandles = false;
+#else
+constexpr bool kReuseHandles = true;
+#endif
+
 int64_t GetRemoteDeviceIncarnation(Device* device) {
   if (device == nullptr || device->IsLocal()) return 0;
   return device->attributes().incarnation();
@@ -420,6 +449,26 @@ TensorHandle::TensorHandle(int64_t op_id, int32_t output_num,
 
 TensorHandle::~TensorHandle() { DVLOG(3) << "Deleting tensor handle " << this; }
 
+void* TensorHandle::operator new(size_t size) {
+  FreeHandles& free = free_handles;
+  if (kReuseHandles && size == sizeof(TensorHandle) && free.size > 0) {
+    return free.blocks[--free.size];
+  }
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  FreeHandles& free = free_handles;
+  if (kReuseHandles && size == sizeof(TensorHandle) && free.size >= 0 &&
+      free.size < FreeHandles::kCapacity) {
+    static thread_local FreeHandlesReleaser releaser;
+    (void)releaser;
+    free.blocks[free.size++] = ptr;
+    return;
+  }
+  ::operator delete(ptr);
+}
+
 void TensorHandle::Release() {
   DVLOG(3) << "Releasing tensor handle " << this;
   Unref();
@@ -987,6 +1036,13 @@ void TensorHandle::Poison(Status status, const Device* d) {
   }
 }
 
+void TensorHandle::SetWaitCallback(std::function<void()> callback) {
+  DCHECK(Type() == LOCAL && !IsReady())
+      << "SetWaitCallback can only be called on non-ready local handles: "
+      << this;
+  std::get<LocalTensorHandleData>(data_).SetWaitCallback(std::move(callback));
+}
+
 Status TensorHandle::CopyToDevice(const EagerContext& ctx,
                                   tensorflow::Device* d,
                                   tensorflow::Tensor* output) const {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <queue>
 #include <string>
@@ -74,6 +75,11 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
 #endif  // IS_MOBILE_PLATFORM
 
  public:
+  // Eager ops allocate a handle per output, so the memory of the handles
+  // deleted by a thread is reused by the next handles it creates.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   // TensorHandle with no assigned device
   static TensorHandle* CreateLocalHandle(const tensorflow::Tensor& t);
   static TensorHandle* CreateLocalHandle(tensorflow::Tensor&& t, Device* d,
@@ -169,6 +175,10 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // are set (data is ready).
   Status WaitUnknownDevice() const;
 
+  // Whether the tensor or the remote shape of this handle is set. Unlike most
+  // accessors, it doesn't block until the handle is ready.
+  bool IsReady() const;
+
   Device* DeviceOrHostCPU(const EagerContext& ctx) const;
 
   Status Shape(tensorflow::TensorShape* shape);
@@ -235,6 +245,11 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // tensor for a specific device.
   void Poison(Status status, const Device* d);
 
+  // Sets a callback run by the threads about to wait for this non-ready local
+  // handle, e.g. to run the recorded op which computes it. It must be set
+  // before the handle is shared.
+  void SetWaitCallback(std::function<void()> callback);
+
   // TODO(b/154282629): Consider moving it to EagerContext.
   // Copies to the tensor on the given device `d`, or to host iff `d` is null.
   Status CopyToDevice(const EagerContext& ctx, tensorflow::Device* d,
@@ -291,7 +306,6 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // Further, it can be in a non-ready state. It would become ready with a call
   // to either SetTensor or SetRemoteShape which replaces the underlying data
   // with a ready version of the tensor handle data.
-  bool IsReady() const;
   Status WaitReady(const char* caller) const;
 
   tensorflow::Device* device_;
@@ -111,6 +111,9 @@ void LocalTensorHandleData::BlockingControl::SetReady() {
 
 Status LocalTensorHandleData::BlockingControl::WaitReady(
     const char* caller) const {
+  if (wait_callback_ && !IsReady()) {
+    wait_callback_();
+  }
   tf_shared_lock l(mu_);
   if (!is_ready_) {
     profiler::TraceMe activity(
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_TENSOR_HANDLE_DATA_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_TENSOR_HANDLE_DATA_H_
 
+#include <functional>
 #include <utility>
 #include <variant>
 
@@ -60,6 +61,11 @@ class LocalTensorHandleData {
 
   Status SetTensor(tensorflow::Tensor&& t);
 
+  // See TensorHandle::SetWaitCallback.
+  void SetWaitCallback(std::function<void()> callback) {
+    std::get<BlockingControl>(ctrl_).SetWaitCallback(std::move(callback));
+  }
+
   string DebugString() const;
 
  private:
@@ -92,6 +98,9 @@ class LocalTensorHandleData {
       return is_ready_;
     }
     void SetReady();
+    void SetWaitCallback(std::function<void()> callback) {
+      wait_callback_ = std::move(callback);
+    }
     Status WaitReady(const char* caller) const;
     void Poison(Status status);
     Status IsPoisoned() const {
@@ -103,6 +112,8 @@ class LocalTensorHandleData {
     mutable mutex mu_;
     bool is_ready_ TF_GUARDED_BY(mu_);
     Status is_poisoned_ TF_GUARDED_BY(mu_);
+    // Only set before the handle is shared.
+    std::function<void()> wait_callback_;
   };
 
   std::variant<NonBlockingControl, BlockingControl> ctrl_;
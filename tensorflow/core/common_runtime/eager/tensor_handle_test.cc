@@ -544,6 +544,22 @@ TEST_F(RemoteTensorHandleTest, PoisonRemoteMirror) {
   context->Unref();
 }
 
+#if !defined(ADDRESS_SANITIZER)
+TEST(TensorHandle_LocalTest, ReusesMemoryOfDeletedHandles) {
+  Tensor t(DT_FLOAT, TensorShape({}));
+  TensorHandle* h = TensorHandle::CreateLocalHandle(t);
+  const void* address = h;
+  h->Unref();
+
+  h = TensorHandle::CreateLocalHandle(t);
+  EXPECT_EQ(h, address);
+  TensorHandle* other = TensorHandle::CreateLocalHandle(t);
+  EXPECT_NE(other, address);
+  other->Unref();
+  h->Unref();
+}
+#endif  // !ADDRESS_SANITIZER
+
 TEST(TensorHandle_LocalTest, TensorFromDeviceSameDevice) {
   std::vector<std::unique_ptr<Device>> devices;
   devices.emplace_back(
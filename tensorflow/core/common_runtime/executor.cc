@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -26,6 +27,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/activity_watcher/activity.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -34,8 +36,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +66,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -72,6 +77,8 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/backends/cpu/op_stats_recorder.h"
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/context_types.h"
@@ -79,6 +86,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/executor_cost_profile.pb.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -147,11 +155,23 @@ typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `num_work_stealing_workers` is positive, ready nodes are dispatched
+  // through a `WorkStealingReadyQueue` drained by at most that many worker
+  // closures per step, instead of one `runner` closure per expensive node.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        int num_work_stealing_workers = 0)
+      : immutable_state_(p),
+        num_work_stealing_workers_(num_work_stealing_workers) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(),
+                             immutable_state_.params().cost_profile);
+    return OkStatus();
+  }
+
+  Status ExportCostProfile(ExecutorCostProfile* profile) const override {
+    kernel_stats_.Export(immutable_state_.graph_view(), profile);
     return OkStatus();
   }
 
@@ -166,15 +186,42 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
+    // If `profile` is not null, the cost estimates of the nodes it names are
+    // initialized from it instead of `kInitialCostEstimateCycles`.
+    void Initialize(const GraphView& gview,
+                    const ExecutorCostProfile* profile) {
       is_expensive_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      gtl::FlatMap<StringPiece, uint64, StringPieceHasher> profiled_costs;
+      if (profile != nullptr) {
+        profiled_costs.reserve(profile->node_costs_size());
+        for (const auto& node_cost : profile->node_costs()) {
+          profiled_costs[node_cost.name()] = node_cost.cost_estimate_cycles();
+        }
+      }
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
+          if (is_expensive_[i] && !profiled_costs.empty()) {
+            auto it = profiled_costs.find(gview.node(i)->kernel->name());
+            if (it != profiled_costs.end()) cost_estimates_[i] = it->second;
+          }
+        }
+      }
+    }
+
+    // Appends the cost estimates of all nodes whose kernels are marked as
+    // expensive to `profile`. Estimates of other nodes are never updated.
+    void Export(const GraphView& gview, ExecutorCostProfile* profile) const {
+      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+        if (gview.node(i) && is_expensive_[i]) {
+          auto* node_cost = profile->add_node_costs();
+          node_cost->set_name(gview.node(i)->kernel->name());
+          node_cost->set_cost_estimate_cycles(
+              cost_estimates_[i].load(std::memory_order_relaxed));
         }
       }
     }
@@ -225,6 +272,7 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  const int num_work_stealing_workers_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +332,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                int num_work_stealing_workers = 0);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -298,6 +347,8 @@ class ExecutorState {
 
   struct AsyncState;
 
+  typedef WorkStealingReadyQueue<TaggedNode> WorkQueue;
+
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
 
@@ -340,6 +391,22 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Implements `ScheduleReady()` when `work_queue_` is set: inexpensive nodes
+  // and at most one expensive node are put into 'inline_ready', and the other
+  // nodes are pushed to `work_queue_`, waking up idle workers to steal them.
+  void ScheduleReadyWorkStealing(TaggedNodeSeq* ready,
+                                 TaggedNodeReadyQueue* inline_ready);
+
+  // Runs as `worker_id` of `work_queue_` until the queue is drained. Each
+  // running worker holds a reference on `num_outstanding_ops_`, which it
+  // releases when it exits.
+  void RunWorker(int worker_id);
+
+  // Returns true if 'inline_ready' is non-empty, or if a node could be taken
+  // from `work_queue_` by the worker running on the current thread.
+  bool HasReadyNode(TaggedNodeReadyQueue* inline_ready,
+                    int64_t* scheduled_nsec);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -380,6 +447,7 @@ class ExecutorState {
   // Step-local container.
   ScopedStepContainer* step_container_;
   StepStatsCollectorInterface* const stats_collector_;
+  RequestCost* const request_cost_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
 
@@ -400,11 +468,18 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Set iff the executor was created as "WORK_STEALING_EXECUTOR" and kernels
+  // are not all run inline.
+  std::unique_ptr<WorkQueue> work_queue_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // The time spent in synchronous kernels, recorded into request_cost_.
+  std::atomic<uint64> op_time_ns_{0};
+
   // Available via OpKernelContext to every OpKernel invocation.
   mutex num_deferred_ops_mu_;
   int64_t num_deferred_ops_ TF_GUARDED_BY(num_deferred_ops_mu_) = 0;
@@ -418,7 +493,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, int num_work_stealing_workers)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -433,6 +508,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
       stats_collector_(args.stats_collector),
+      request_cost_(args.request_cost),
       event_collector_(
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
       context_(ContextKind::kThread),
@@ -453,6 +529,9 @@ ExecutorState<PropagatorStateType>::ExecutorState(
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (num_work_stealing_workers > 0 && !run_all_kernels_inline_) {
+    work_queue_ = std::make_unique<WorkQueue>(num_work_stealing_workers);
+  }
 }
 
 template <class PropagatorStateType>
@@ -590,6 +669,12 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  // Aggregated op latencies are cheap enough to be recorded always, while a
+  // sampling profiler is running.
+  const bool record_op_stats = profiler::OpStatsRecorder::Active();
+  const bool record_op_cost = request_cost_ != nullptr;
+  const uint64 op_start_ns =
+      record_op_stats || record_op_cost ? EnvTime::NowNanos() : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -600,7 +685,23 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
               ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
         },
         profiler::GetTFTraceMeLevel(is_expensive));
+    profiler::PerfCounters::Values start_counters;
+    const bool read_counters =
+        profiler::PerfCounters::Active() &&
+        profiler::PerfCounters::IsCounted(op_kernel->type_string_view()) &&
+        profiler::PerfCounters::Read(&start_counters);
     device->Compute(op_kernel, &ctx);
+    profiler::PerfCounters::Values end_counters;
+    if (read_counters && profiler::PerfCounters::Read(&end_counters)) {
+      activity.AppendMetadata([&] {
+        const profiler::PerfCounters::Values counters =
+            profiler::PerfCounters::Delta(end_counters, start_counters);
+        return profiler::TraceMeEncode(
+            {{"cpu_cycles", counters.cycles},
+             {"cpu_instructions", counters.instructions},
+             {"llc_misses", counters.llc_misses}});
+      });
+    }
   } else if (kernel_stats_->HasExpensiveMarker(item)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
@@ -615,6 +716,17 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (TF_PREDICT_FALSE(record_op_stats || record_op_cost)) {
+    const uint64 op_duration_ns = EnvTime::NowNanos() - op_start_ns;
+    if (record_op_stats) {
+      profiler::OpStatsRecorder::Record(op_kernel->name_view(),
+                                        op_kernel->type_string_view(),
+                                        op_duration_ns);
+    }
+    if (record_op_cost) {
+      op_time_ns_.fetch_add(op_duration_ns, std::memory_order_relaxed);
+    }
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -774,6 +886,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->runner = &runner_;
   params->run_all_kernels_inline = run_all_kernels_inline_;
   params->stats_collector = stats_collector_;
+  params->request_cost = request_cost_;
   params->inc_num_deferred_ops_function = [this]() {
     mutex_lock lock(num_deferred_ops_mu_);
     num_deferred_ops_++;
@@ -804,7 +917,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   bool completed = false;
   int64_t last_iter_num = -1;
   std::unique_ptr<profiler::TraceMeConsumer> iteration_scope;
-  while (!inline_ready->empty()) {
+  while (HasReadyNode(inline_ready, &scheduled_nsec)) {
     TaggedNode tagged_node = inline_ready->front();
 
     int64_t current_iter_num = tagged_node.get_iter_num();
@@ -1278,7 +1391,9 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     scheduled_nsec = nodestats::NowInNsec();
   }
 
-  if (run_all_kernels_inline_) {
+  if (work_queue_ != nullptr) {
+    ScheduleReadyWorkStealing(ready, inline_ready);
+  } else if (run_all_kernels_inline_) {
     if (inline_ready == nullptr) {
       // Schedule all ready kernels from a single closure. This ensure that,
       // regardless of the `runner_` implementation, all kernels will run
@@ -1371,6 +1486,102 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ScheduleReadyWorkStealing(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
+  TaggedNodeSeq stealable_nodes;
+  if (inline_ready == nullptr) {
+    stealable_nodes = std::move(*ready);
+  } else {
+    for (auto& tagged_node : *ready) {
+      const NodeItem& item = *tagged_node.node_item;
+      if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item) ||
+          inline_ready->empty()) {
+        // Inline inexpensive nodes, and keep one expensive node on the
+        // current thread so that a chain of expensive nodes stays on it.
+        inline_ready->push_back(tagged_node);
+      } else {
+        stealable_nodes.push_back(tagged_node);
+      }
+    }
+  }
+  if (stealable_nodes.empty()) return;
+
+  // Hold a reference on `num_outstanding_ops_` while the nodes are pushed, so
+  // that the step cannot complete, and `this` be deleted, before the workers
+  // for them are woken up.
+  num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+
+  // Nodes made ready by a worker go to the back of its own deque. Nodes made
+  // ready elsewhere (e.g. by async kernel callbacks) are spread round-robin.
+  const int current_worker_id = work_queue_->CurrentWorkerId();
+  for (auto& tagged_node : stealable_nodes) {
+    work_queue_->Push(current_worker_id, tagged_node);
+  }
+  // The ids are claimed after the push: a worker releasing its id checks the
+  // queue only once, so if no id is free here, a running worker will observe
+  // the pushed nodes before it exits; see `RunWorker()`.
+  gtl::InlinedVector<int, 4> worker_ids;
+  int worker_id;
+  while (worker_ids.size() < stealable_nodes.size() &&
+         work_queue_->TryAcquireWorker(&worker_id)) {
+    worker_ids.push_back(worker_id);
+  }
+  if (!worker_ids.empty()) {
+    num_outstanding_ops_.fetch_add(worker_ids.size(),
+                                   std::memory_order_relaxed);
+  }
+  for (const int id : worker_ids) {
+    RunTask([this, id]() { RunWorker(id); },
+            /*sample_rate=*/worker_ids.size());
+  }
+  // This must be the last access to `this`.
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorker(int worker_id) {
+  profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat("ExecutorState::RunWorker#",
+                               "worker_id=", worker_id, "#");
+      },
+      profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+  {
+    typename WorkQueue::WorkerBinding binding(work_queue_.get(), worker_id);
+    TaggedNodeReadyQueue inline_ready;
+    while (true) {
+      ProcessInline(&inline_ready, /*scheduled_nsec=*/0);
+      // Nodes pushed after the worker id was released are observed either by
+      // their pusher, which then wakes up a new worker, or by the check below.
+      work_queue_->ReleaseWorker(worker_id);
+      if (work_queue_->Empty() || !work_queue_->TryAcquireWorker(&worker_id)) {
+        break;
+      }
+      binding.Rebind(work_queue_.get(), worker_id);
+    }
+  }
+  // Release the reference on `num_outstanding_ops_` held by this worker. This
+  // must be the last access to `this`.
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
+template <class PropagatorStateType>
+bool ExecutorState<PropagatorStateType>::HasReadyNode(
+    TaggedNodeReadyQueue* inline_ready, int64_t* scheduled_nsec) {
+  if (!inline_ready->empty()) return true;
+  if (work_queue_ == nullptr) return false;
+  const int worker_id = work_queue_->CurrentWorkerId();
+  if (worker_id < 0) return false;
+  std::optional<TaggedNode> tagged_node = work_queue_->Pop(worker_id);
+  if (!tagged_node.has_value()) return false;
+  if (stats_collector_) {
+    *scheduled_nsec = nodestats::NowInNsec();
+  }
+  inline_ready->push_back(*tagged_node);
+  return true;
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1403,6 +1614,12 @@ void ExecutorState<PropagatorStateType>::Finish() {
   CHECK(done_cb != nullptr);
   Device* device = immutable_state_.params().device;
 
+  if (request_cost_ != nullptr) {
+    request_cost_->RecordCost(
+        {{kExecutorOpsCostName,
+          absl::Nanoseconds(op_time_ns_.load(std::memory_order_relaxed))}});
+  }
+
   if (vlog_ && !status.ok() && VLOG_IS_ON(1)) {
     // Logs verbose information about the current state of active and pending
     // nodes in the propagator.
@@ -1509,15 +1726,19 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
+    // Determinism requires a single ordered ready queue, so work stealing is
+    // not used here.
     (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        num_work_stealing_workers_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_,
+                                              num_work_stealing_workers_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1571,6 +1792,29 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers "WORK_STEALING_EXECUTOR", which runs the same algorithm as the
+// default executor, but dispatches ready nodes through per-worker deques with
+// work stealing instead of scheduling one closure per expensive node.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING_EXECUTOR", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = std::make_unique<ExecutorImpl>(
+          params, /*num_work_stealing_workers=*/port::MaxParallelism());
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -37,6 +37,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class ExecutorCostProfile;
+class RequestCost;
 class StepStatsCollector;
 
 // Executor runs a graph computation.
@@ -99,6 +101,9 @@ class Executor {
     std::optional<int64_t> function_trace_id;
     RendezvousInterface* rendezvous = nullptr;
     StepStatsCollectorInterface* stats_collector = nullptr;
+    // If not null, the executor records the time spent in its kernels into
+    // it, and makes it available to them via OpKernelContext.
+    RequestCost* request_cost = nullptr;
     CallFrameInterface* call_frame = nullptr;
     CancellationManager* cancellation_manager = nullptr;
     SessionState* session_state = nullptr;
@@ -146,6 +151,15 @@ class Executor {
     return ret;
   }
 
+  // Exports the kernel cost estimates this executor has learned from the steps
+  // it has run so far into `*profile`. The profile can be passed as
+  // `LocalExecutorParams::cost_profile` when creating an executor for the same
+  // graph in another process.
+  virtual Status ExportCostProfile(ExecutorCostProfile* profile) const {
+    return errors::Unimplemented(
+        "This executor does not support exporting cost profiles.");
+  }
+
  private:
   virtual void RunAsyncInternal(const Args& args, DoneCallback done) = 0;
 };
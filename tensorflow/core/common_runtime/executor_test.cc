@@ -23,12 +23,16 @@ limitations under the License.
 #include "tensorflow/cc/ops/control_flow_ops_internal.h"
 #include "tensorflow/cc/ops/function_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/cc/ops/while_loop.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/local_rendezvous.h"
@@ -43,10 +47,12 @@ limitations under the License.
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/protobuf/executor_cost_profile.pb.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
@@ -91,16 +97,25 @@ class ExecutorTest : public ::testing::Test {
     params.delete_kernel = [](OpKernel* kernel) {
       DeleteNonCachedKernel(kernel);
     };
+    params.cost_profile = cost_profile_;
+    params.pool_control_flow_state = pool_control_flow_state_;
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type_.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type_, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
-  Status Run(Rendezvous* rendez) {
+  Status Run(Rendezvous* rendez, RequestCost* request_cost = nullptr) {
     Executor::Args args;
     args.rendezvous = rendez;
     args.stats_collector = &step_stats_collector_;
+    args.request_cost = request_cost;
     args.runner = runner_;
     return exec_->Run(args);
   }
@@ -112,6 +127,12 @@ class ExecutorTest : public ::testing::Test {
   StepStats step_stats_;
   Executor::Args::Runner runner_;
   Rendezvous* rendez_ = nullptr;
+  // If non-empty, `Create()` uses the executor registered under this type.
+  string executor_type_;
+  // If not null, `Create()` initializes the executor's cost estimates from it.
+  const ExecutorCostProfile* cost_profile_ = nullptr;
+  // Passed as `LocalExecutorParams::pool_control_flow_state` by `Create()`.
+  bool pool_control_flow_state_ = false;
 };
 
 // A float val -> Tensor<float>
@@ -186,6 +207,25 @@ TEST_F(ExecutorTest, SimpleAdd) {
   EXPECT_EQ(2.0, V(out));  // out = 1.0 + 1.0 = 2.0
 }
 
+TEST_F(ExecutorTest, RecordsRequestCost) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto tmp = test::graph::Add(g.get(), in0, in0);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));
+  RequestCost request_cost;
+  TF_ASSERT_OK(Run(rendez_, &request_cost));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(2.0, V(out));
+  EXPECT_TRUE(request_cost.GetCosts().contains(kExecutorOpsCostName));
+}
+
 TEST_F(ExecutorTest, SelfAdd) {
   // v0 <- a
   // v1 = v0 + v0
@@ -216,6 +256,49 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(out));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+TEST_F(ExecutorTest, ExportAndImportCostProfile) {
+  auto build_graph = []() {
+    auto g = std::make_unique<Graph>(OpRegistry::Global());
+    auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+    for (int i = 1; i <= 4; ++i) {
+      v = test::graph::Add(g.get(), v, v);
+    }
+    test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+    return g;
+  };
+  Create(build_graph());
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+
+  ExecutorCostProfile exported;
+  TF_ASSERT_OK(exec_->ExportCostProfile(&exported));
+  ASSERT_GT(exported.node_costs_size(), 0);
+
+  // A new executor for the same graph starts from the imported costs.
+  ExecutorCostProfile imported = exported;
+  for (auto& node_cost : *imported.mutable_node_costs()) {
+    node_cost.set_cost_estimate_cycles(42);
+  }
+  cost_profile_ = &imported;
+  rendez_->Unref();
+  Create(build_graph());
+  cost_profile_ = nullptr;
+
+  ExecutorCostProfile reexported;
+  TF_ASSERT_OK(exec_->ExportCostProfile(&reexported));
+  ASSERT_EQ(reexported.node_costs_size(), exported.node_costs_size());
+  for (int i = 0; i < reexported.node_costs_size(); ++i) {
+    EXPECT_EQ(reexported.node_costs(i).name(), exported.node_costs(i).name());
+    EXPECT_EQ(reexported.node_costs(i).cost_estimate_cycles(), 42);
+  }
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -266,6 +349,101 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, WorkStealingSelfAdd) {
+  executor_type_ = "WORK_STEALING_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  const int N = 10;
+  for (int i = 1; i <= N; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(1024.0, V(out));
+}
+
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  executor_type_ = "WORK_STEALING_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  // Run several steps so that later steps see the learned kernel costs.
+  for (int i = 0; i < 4; ++i) {
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, WorkStealingAsyncProducers) {
+  executor_type_ = "WORK_STEALING_EXECUTOR";
+  // Many more Recv nodes than workers, whose callbacks make their consumers
+  // ready on the sender threads, i.e. outside the workers, while the workers
+  // are running out of nodes and exiting.
+  constexpr int kNumRecvs = 1024;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  std::vector<Node*> values;
+  for (int i = 0; i < kNumRecvs; ++i) {
+    values.push_back(test::graph::Recv(g.get(), strings::StrCat("a", i),
+                                       "float", ALICE, 1, BOB));
+  }
+  while (values.size() > 1) {
+    std::vector<Node*> sums;
+    for (size_t i = 0; i < values.size(); i += 2) {
+      sums.push_back(test::graph::Add(g.get(), values[i], values[i + 1]));
+    }
+    values = std::move(sums);
+  }
+  test::graph::Send(g.get(), values[0], "b", BOB, 1, ALICE);
+  Create(std::move(g));
+
+  for (int step = 0; step < 4; ++step) {
+    Executor::Args args;
+    args.rendezvous = rendez_;
+    args.runner = runner_;
+    Notification done;
+    Status status;
+    exec_->RunAsync(args, [&done, &status](const Status& s) {
+      status = s;
+      done.Notify();
+    });
+    {
+      constexpr int kNumSenders = 4;
+      thread::ThreadPool senders(Env::Default(), "senders", kNumSenders);
+      for (int t = 0; t < kNumSenders; ++t) {
+        senders.Schedule([this, t]() {
+          for (int i = t; i < kNumRecvs; i += kNumSenders) {
+            TF_ASSERT_OK(rendez_->Send(
+                Key(ALICE, kIncarnation, BOB, strings::StrCat("a", i)),
+                Rendezvous::Args(), V(1.0), false));
+          }
+        });
+      }
+    }
+    done.WaitForNotification();
+    TF_ASSERT_OK(status);
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"),
+                               Rendezvous::Args(), &out, &is_dead));
+    EXPECT_EQ(static_cast<float>(kNumRecvs), V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -340,6 +518,89 @@ TEST_F(ExecutorTest, SimpleSwitchDead) {
   EXPECT_TRUE(is_dead);
 }
 
+TEST_F(ExecutorTest, WorkStealingSimpleSwitchDead) {
+  executor_type_ = "WORK_STEALING_EXECUTOR";
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(true));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_TRUE(is_dead);
+}
+
+// Builds nested while loops computing:
+//
+//     x = 0
+//     while (x < 50)
+//       for (j = 0; j < 5; ++j)
+//         x += 1;
+//
+// and sends the final value of `x` as "out".
+void BuildNestedWhileLoops(Graph* g) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  auto inner_cond = [](const Scope& s, const std::vector<Output>& inputs,
+                       Output* output) {
+    *output = ops::Less(s, inputs[1], 5);
+    return s.status();
+  };
+  auto inner_body = [](const Scope& s, const std::vector<Output>& inputs,
+                       std::vector<Output>* outputs) {
+    outputs->push_back(ops::Add(s, inputs[0], 1));
+    outputs->push_back(ops::Add(s, inputs[1], 1));
+    return s.status();
+  };
+  auto outer_cond = [](const Scope& s, const std::vector<Output>& inputs,
+                       Output* output) {
+    *output = ops::Less(s, inputs[0], 50);
+    return s.status();
+  };
+  auto outer_body = [&](const Scope& s, const std::vector<Output>& inputs,
+                        std::vector<Output>* outputs) {
+    auto j = ops::Const(s.WithControlDependencies(inputs[0]), 0);
+    std::vector<Output> inner_outputs;
+    TF_RETURN_IF_ERROR(ops::BuildWhileLoop(s, {inputs[0], j}, inner_cond,
+                                           inner_body, "inner",
+                                           &inner_outputs));
+    outputs->push_back(inner_outputs[0]);
+    return s.status();
+  };
+  std::vector<Output> outputs;
+  TF_CHECK_OK(ops::BuildWhileLoop(root, {ops::Const(root, 0)}, outer_cond,
+                                  outer_body, "outer", &outputs));
+  test::graph::Send(root.graph(), outputs[0].node(), "out", BOB, 1, ALICE);
+  TF_CHECK_OK(root.ToGraph(g));
+}
+
+TEST_F(ExecutorTest, NestedWhileLoops) {
+  for (bool pool_control_flow_state : {false, true}) {
+    pool_control_flow_state_ = pool_control_flow_state;
+    auto g = std::make_unique<Graph>(OpRegistry::Global());
+    BuildNestedWhileLoops(g.get());
+    if (rendez_ != nullptr) rendez_->Unref();
+    Create(std::move(g));
+    // Run several steps, since pooled state is kept for a single step only.
+    for (int i = 0; i < 3; ++i) {
+      TF_ASSERT_OK(Run(rendez_));
+      Rendezvous::Args args;
+      Tensor out = VI(-1);
+      bool is_dead = false;
+      TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "out"), args,
+                                 &out, &is_dead));
+      EXPECT_FALSE(is_dead);
+      EXPECT_EQ(50, out.scalar<int32>()());
+    }
+  }
+}
+
 TEST_F(ExecutorTest, Abort) {
   // e = a + b + c + d
   auto g = std::make_unique<Graph>(OpRegistry::Global());
@@ -443,7 +704,8 @@ TEST_F(ExecutorTest, NoInputTensors) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(::testing::benchmark::State& state) {
+static void ExecutorBenchmarkHelper(::testing::benchmark::State& state,
+                                    const char* executor_type) {
   const int width = state.range(0);
   const int depth = state.range(1);
 
@@ -477,12 +739,19 @@ static void BM_executor(::testing::benchmark::State& state) {
   }
 
   FixupSourceAndSinkEdges(g);
-  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
 
   state.SetLabel(strings::StrCat("Nodes = ", cur));
   state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
 }
 
+static void BM_executor(::testing::benchmark::State& state) {
+  ExecutorBenchmarkHelper(state, /*executor_type=*/"");
+}
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(32, 8192);
@@ -494,6 +763,14 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+static void BM_work_stealing_executor(::testing::benchmark::State& state) {
+  ExecutorBenchmarkHelper(state, "WORK_STEALING_EXECUTOR");
+}
+
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 1024);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
@@ -597,7 +874,8 @@ Status ReplaceEdgeWithSendRecv(Graph* g, const Edge* edge, const string& tensor,
 // `Switch`/`Merge`-style of control flow (if `lower` is true).
 static void BM_WhileLoopHelper(::testing::benchmark::State& state,
                                int loop_iters, int loop_vars, bool lower,
-                               bool transfer) {
+                               bool transfer,
+                               bool pool_control_flow_state = false) {
   std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
 
   // Add test functions for cond and body.
@@ -729,7 +1007,10 @@ static void BM_WhileLoopHelper(::testing::benchmark::State& state,
   options.config.set_inter_op_parallelism_threads(4);
   FixupSourceAndSinkEdges(graph.get());
   test::Benchmark("cpu", graph.release(), &options, nullptr, nullptr, "",
-                  /*old_benchmark_api=*/false)
+                  /*old_benchmark_api=*/false,
+                  [pool_control_flow_state](LocalExecutorParams* params) {
+                    params->pool_control_flow_state = pool_control_flow_state;
+                  })
       .Run(state);
 }
 
@@ -752,6 +1033,29 @@ BENCHMARK(BM_LoweredWhileLoop)
     ->ArgPair(100, 100)
     ->ArgPair(1000, 100);
 
+// Same as `BM_LoweredWhileLoop`, but reuses frame and iteration state across
+// loop iterations.
+static void BM_LoweredWhileLoopPooledState(
+    ::testing::benchmark::State& state) {
+  const int loop_iters = state.range(0);
+  const int loop_vars = state.range(1);
+
+  BM_WhileLoopHelper(state, loop_iters, loop_vars, /* lower= */ true,
+                     /* transfer= */ false,
+                     /* pool_control_flow_state= */ true);
+}
+BENCHMARK(BM_LoweredWhileLoopPooledState)
+    ->ArgPair(0, 1)
+    ->ArgPair(1, 1)
+    ->ArgPair(10, 1)
+    ->ArgPair(100, 1)
+    ->ArgPair(1000, 1)
+    ->ArgPair(0, 100)
+    ->ArgPair(1, 100)
+    ->ArgPair(10, 100)
+    ->ArgPair(100, 100)
+    ->ArgPair(1000, 100);
+
 static void BM_LoweredWhileLoopWithTransfer(
     ::testing::benchmark::State& state) {
   const int loop_iters = state.range(0);
@@ -0,0 +1,75 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_command_buffer_cache.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/statusor.h"
+
+namespace tensorflow {
+namespace gpu {
+
+GpuCommandBufferCache::GpuCommandBufferCache(se::StreamExecutor* executor,
+                                             int64_t capacity)
+    : executor_(executor), capacity_(capacity) {
+  DCHECK_GT(capacity_, 0);
+}
+
+Status GpuCommandBufferCache::Run(
+    uint64_t signature, se::Stream* stream,
+    absl::AnyInvocable<Status(se::Stream*)> function) {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(signature);
+  if (it != index_.end()) {
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return executor_->Submit(stream, entries_.front().second);
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      se::CommandBuffer command_buffer,
+      se::CommandBuffer::Trace(executor_, std::move(function),
+                               se::CommandBuffer::Mode::kPrimary));
+  ++num_captures_;
+  VLOG(1) << "Captured a command buffer for signature " << signature;
+
+  if (static_cast<int64_t>(entries_.size()) >= capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(signature, std::move(command_buffer));
+  index_[signature] = entries_.begin();
+  return executor_->Submit(stream, entries_.front().second);
+}
+
+uint64_t TensorsSignature(absl::Span<const Tensor* const> tensors) {
+  uint64_t signature = tensors.size();
+  for (const Tensor* tensor : tensors) {
+    signature = Hash64Combine(signature, tensor->dtype());
+    for (const int64_t dim : tensor->shape().dim_sizes()) {
+      signature = Hash64Combine(signature, dim);
+    }
+    signature = Hash64Combine(
+        signature, reinterpret_cast<uintptr_t>(tensor->data()));
+  }
+  return signature;
+}
+
+}  // namespace gpu
+}  // namespace tensorflow
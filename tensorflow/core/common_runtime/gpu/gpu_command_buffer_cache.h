@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COMMAND_BUFFER_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COMMAND_BUFFER_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/stream_executor/command_buffer.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace tensorflow {
+namespace gpu {
+
+// Captures the GPU work that a function enqueues on a stream into a command
+// buffer (a CUDA graph) the first time it runs, and replays the command buffer
+// instead of running the function afterwards. Replaying a sequence of small
+// kernels costs a single launch.
+//
+// The captured work is keyed by a signature that the caller derives from what
+// the kernels depend on: the shapes and device addresses of the tensors they
+// read and write, see TensorsSignature(). A new signature, e.g. after a shape
+// or allocation change, captures the work again. The function must only
+// enqueue work on the stream it is given, the same for every run with the same
+// signature, and must not synchronize with the host.
+class GpuCommandBufferCache {
+ public:
+  // Keeps the command buffers of at most `capacity` signatures, evicting the
+  // least recently used.
+  explicit GpuCommandBufferCache(se::StreamExecutor* executor,
+                                 int64_t capacity = 16);
+
+  // Enqueues on `stream` the work captured from `function` for `signature`,
+  // capturing it first if needed.
+  Status Run(uint64_t signature, se::Stream* stream,
+             absl::AnyInvocable<Status(se::Stream*)> function);
+
+  int64_t num_captures() const {
+    absl::MutexLock lock(&mu_);
+    return num_captures_;
+  }
+
+ private:
+  using Entry = std::pair<uint64_t, se::CommandBuffer>;
+
+  se::StreamExecutor* executor_;
+  const int64_t capacity_;
+
+  mutable absl::Mutex mu_;
+  // From the most to the least recently used.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64_t, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+  int64_t num_captures_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Returns a signature of the dtypes, shapes and device addresses of `tensors`.
+uint64_t TensorsSignature(absl::Span<const Tensor* const> tensors);
+
+}  // namespace gpu
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_COMMAND_BUFFER_CACHE_H_
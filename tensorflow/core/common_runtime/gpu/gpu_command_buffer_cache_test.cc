@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_command_buffer_cache.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "xla/stream_executor/gpu/gpu_init.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tsl/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace gpu {
+namespace {
+
+constexpr int kLength = 4;
+constexpr uint64_t kByteLength = kLength * sizeof(int32_t);
+
+class GpuCommandBufferCacheTest : public ::testing::Test {
+ protected:
+  GpuCommandBufferCacheTest()
+      : executor_(se::GPUMachineManager()->ExecutorForDevice(0).value()),
+        stream_(executor_) {
+    stream_.Init();
+  }
+
+  // Returns the elements of `memory`.
+  std::vector<int32_t> Read(const se::DeviceMemory<int32_t>& memory) {
+    std::vector<int32_t> result(kLength);
+    stream_.ThenMemcpy(result.data(), memory, kByteLength);
+    TF_CHECK_OK(stream_.BlockHostUntilDone());
+    return result;
+  }
+
+  se::StreamExecutor* executor_;
+  se::Stream stream_;
+};
+
+TEST_F(GpuCommandBufferCacheTest, ReplaysTheWorkOfTheSameSignature) {
+  GpuCommandBufferCache cache(executor_);
+  se::DeviceMemory<int32_t> memory =
+      executor_->AllocateArray<int32_t>(kLength, 0);
+  int num_runs = 0;
+  auto fill = [&](se::Stream* stream) {
+    ++num_runs;
+    stream->ThenMemset32(&memory, 7, kByteLength);
+    return OkStatus();
+  };
+
+  TF_ASSERT_OK(cache.Run(/*signature=*/1, &stream_, fill));
+  EXPECT_EQ(Read(memory), std::vector<int32_t>(kLength, 7));
+
+  stream_.ThenMemZero(&memory, kByteLength);
+  TF_ASSERT_OK(cache.Run(/*signature=*/1, &stream_, fill));
+  EXPECT_EQ(Read(memory), std::vector<int32_t>(kLength, 7));
+  EXPECT_EQ(num_runs, 1);
+  EXPECT_EQ(cache.num_captures(), 1);
+
+  // A new signature captures the work again.
+  TF_ASSERT_OK(cache.Run(/*signature=*/2, &stream_, fill));
+  EXPECT_EQ(num_runs, 2);
+  EXPECT_EQ(cache.num_captures(), 2);
+
+  executor_->Deallocate(&memory);
+}
+
+TEST_F(GpuCommandBufferCacheTest, EvictsTheLeastRecentlyUsedSignature) {
+  GpuCommandBufferCache cache(executor_, /*capacity=*/1);
+  auto nothing = [](se::Stream* stream) { return OkStatus(); };
+  TF_ASSERT_OK(cache.Run(/*signature=*/1, &stream_, nothing));
+  TF_ASSERT_OK(cache.Run(/*signature=*/2, &stream_, nothing));
+  TF_ASSERT_OK(cache.Run(/*signature=*/1, &stream_, nothing));
+  EXPECT_EQ(cache.num_captures(), 3);
+}
+
+TEST(TensorsSignatureTest, DependsOnShapesAndAddresses) {
+  Tensor a(DT_FLOAT, TensorShape({2, 3}));
+  Tensor b(DT_FLOAT, TensorShape({2, 3}));
+  Tensor c(DT_FLOAT, TensorShape({3, 2}));
+  Tensor a_alias = a;
+  EXPECT_EQ(TensorsSignature({&a}), TensorsSignature({&a_alias}));
+  EXPECT_NE(TensorsSignature({&a}), TensorsSignature({&b}));
+  EXPECT_NE(TensorsSignature({&a, &b}), TensorsSignature({&b, &a}));
+  EXPECT_NE(TensorsSignature({&c}), TensorsSignature({&a}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA
@@ -900,8 +900,12 @@ Status BaseGPUDevice::MaybeCopyTensorToGPU(
       safe_alloc_frontier = SafeAllocFrontier(safe_alloc_frontier);
       return safe_alloc_frontier;
     };
+    // Memory still pending on the compute stream is reused by
+    // making the copy wait on the compute stream.
+    bool reused_pending_memory = !timestamped_allocator_;
     if (timestamped_allocator_) {
       allocation_attr.freed_by_func = &freed_by_func;
+      allocation_attr.reused_pending_memory = &reused_pending_memory;
     }
     auto* copy = new Tensor(GetAllocator(alloc_attrs), from.dtype(),
                             from.shape(), allocation_attr);
@@ -927,7 +931,7 @@ Status BaseGPUDevice::MaybeCopyTensorToGPU(
     profiler::ScopedAnnotation annotation("MakeTensorFromProto");
     device_context_->CopyCPUTensorToDevice(
         &from, this, copy, std::move(wrapped_done),
-        !timestamped_allocator_ /*sync_dst_compute*/);
+        reused_pending_memory /*sync_dst_compute*/);
     return OkStatus();
   }
 }
@@ -19,7 +19,9 @@ limitations under the License.
 #include <cstring>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 
 // TODO(b/282059652): Merge google internal and open-source code path once TF
@@ -51,10 +53,13 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 // IMPLEMENTATION NOTE:
@@ -287,6 +292,148 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Size of the pinned staging buffer shared by coalesced CPU->GPU copies.
+constexpr int64_t kCoalescedCopyBatchBytes = 1 << 20;
+
+// Returns the size up to which copies from pageable memory are coalesced with
+// the other small copies on the same stream, instead of being issued on their
+// own. Read from TF_GPU_COALESCE_H2D_COPY_BYTES, 0 disables coalescing.
+int64_t CoalescedCopyThreshold() {
+  static const int64_t threshold = [] {
+    int64_t bytes;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GPU_COALESCE_H2D_COPY_BYTES",
+                                    /*default_val=*/0, &bytes));
+    return std::min(bytes, kCoalescedCopyBatchBytes);
+  }();
+  return threshold;
+}
+
+// Small CPU->GPU copies staged in one pinned buffer. They are issued together
+// on a host-to-device stream as a single memcpy into a device buffer, which is
+// then scattered to the destinations by device-to-device copies.
+struct CoalescedCopyBatch {
+  struct Copy {
+    int64_t offset;
+    DeviceMemoryBase dst;
+    StatusCallback done;
+  };
+
+  EventMgr* event_mgr;
+  Allocator* host_memory_allocator;
+  char* staging_buffer;
+  int64_t bytes = 0;
+  std::vector<Copy> copies;
+};
+
+class CoalescedCopies {
+ public:
+  static CoalescedCopies* Global() {
+    static CoalescedCopies* copies = new CoalescedCopies;
+    return copies;
+  }
+
+  // Stages the copy of cpu_tensor to dst on stream and takes *done. Returns
+  // false if the copy has to be issued on its own.
+  bool Enqueue(const Tensor& cpu_tensor, DeviceMemoryBase dst, Stream* stream,
+               EventMgr* event_mgr, Allocator* host_memory_allocator,
+               StatusCallback* done) {
+    const int64_t bytes = cpu_tensor.TotalBytes();
+    constexpr int64_t kAlignment = Allocator::kAllocatorAlignment;
+    const int64_t aligned_bytes =
+        (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    std::unique_ptr<CoalescedCopyBatch> full_batch;
+    bool staged = false;
+    {
+      mutex_lock l(mu_);
+      std::unique_ptr<CoalescedCopyBatch>& batch = pending_[stream];
+      if (batch != nullptr &&
+          (batch->bytes + aligned_bytes > kCoalescedCopyBatchBytes ||
+           batch->host_memory_allocator != host_memory_allocator)) {
+        full_batch = std::move(batch);
+      }
+      if (batch == nullptr) {
+        void* staging_buffer = host_memory_allocator->AllocateRaw(
+            Allocator::kAllocatorAlignment, kCoalescedCopyBatchBytes);
+        if (staging_buffer != nullptr) {
+          batch.reset(new CoalescedCopyBatch{
+              event_mgr, host_memory_allocator,
+              static_cast<char*>(staging_buffer)});
+          // All the copies enqueued until the closure runs join the batch.
+          Env::Default()->SchedClosure([this, stream]() { Flush(stream); });
+        }
+      }
+      if (batch != nullptr) {
+        std::memcpy(batch->staging_buffer + batch->bytes,
+                    GetBase(&cpu_tensor), bytes);
+        batch->copies.push_back({batch->bytes, dst, std::move(*done)});
+        batch->bytes += aligned_bytes;
+        staged = true;
+      }
+    }
+    if (full_batch != nullptr) Issue(stream, std::move(full_batch));
+    return staged;
+  }
+
+ private:
+  void Flush(Stream* stream) {
+    std::unique_ptr<CoalescedCopyBatch> batch;
+    {
+      mutex_lock l(mu_);
+      auto it = pending_.find(stream);
+      if (it == pending_.end() || it->second == nullptr) return;
+      batch = std::move(it->second);
+      pending_.erase(it);
+    }
+    Issue(stream, std::move(batch));
+  }
+
+  // Issues the copies of batch in order, the batches of a stream are issued
+  // one after the other.
+  void Issue(Stream* stream, std::unique_ptr<CoalescedCopyBatch> batch) {
+    mutex_lock l(issue_mu_);
+    // The device buffer of a stream is reused by its next batch, which the
+    // stream orders after the scatter of this one.
+    se::DeviceMemory<uint8>& device_buffer = device_buffers_[stream];
+    if (device_buffer.is_null()) {
+      device_buffer =
+          stream->parent()->AllocateArray<uint8>(kCoalescedCopyBatchBytes);
+    }
+    if (!device_buffer.is_null()) {
+      DeviceMemoryBase device_staging(device_buffer.opaque(), batch->bytes);
+      stream->ThenMemcpy(&device_staging, batch->staging_buffer, batch->bytes);
+    }
+    for (CoalescedCopyBatch::Copy& copy : batch->copies) {
+      if (device_buffer.is_null()) {
+        stream->ThenMemcpy(&copy.dst, batch->staging_buffer + copy.offset,
+                           copy.dst.size());
+      } else {
+        DeviceMemoryBase src(
+            static_cast<char*>(device_buffer.opaque()) + copy.offset,
+            copy.dst.size());
+        stream->ThenMemcpyD2D(&copy.dst, src, copy.dst.size());
+      }
+    }
+    EventMgr* event_mgr = batch->event_mgr;
+    event_mgr->ThenExecute(stream, [stream, batch = batch.release()]() {
+      batch->host_memory_allocator->DeallocateRaw(batch->staging_buffer);
+      if (!stream->ok()) {
+        LOG(FATAL) << "CPU->GPU Memcpy failed";
+      }
+      for (CoalescedCopyBatch::Copy& copy : batch->copies) {
+        copy.done(OkStatus());
+      }
+      delete batch;
+    });
+  }
+
+  mutex mu_;
+  absl::flat_hash_map<Stream*, std::unique_ptr<CoalescedCopyBatch>> pending_
+      TF_GUARDED_BY(mu_);
+  mutex issue_mu_;
+  absl::flat_hash_map<Stream*, se::DeviceMemory<uint8>> device_buffers_
+      TF_GUARDED_BY(issue_mu_);
+};
+
 }  // namespace
 
 void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
@@ -407,6 +554,15 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       }
     }
 
+    if (do_staging && total_bytes <= CoalescedCopyThreshold() &&
+        CoalescedCopies::Global()->Enqueue(*cpu_tensor, gpu_dst_ptr,
+                                           recv_host_to_device_stream,
+                                           dev_info->event_mgr,
+                                           host_memory_allocator, &done)) {
+      input_ref.Unref();
+      return;
+    }
+
     if (do_staging) {
       staging_buffer = host_memory_allocator->AllocateRaw(
           tensorflow::Allocator::kAllocatorAlignment, total_bytes);
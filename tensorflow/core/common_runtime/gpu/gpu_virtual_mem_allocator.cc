@@ -63,7 +63,8 @@ GpuVirtualMemAllocator::Create(
     const std::vector<Visitor>& alloc_visitors,
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids) {
+    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+    bool releasable_pages) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Create");
 
   std::vector<GpuDeviceHandle> access_gpu_handles;
@@ -107,7 +108,7 @@ GpuVirtualMemAllocator::Create(
 
   return std::unique_ptr<GpuVirtualMemAllocator>(new GpuVirtualMemAllocator(
       alloc_visitors, free_visitors, gpu_context, gpu_id,
-      std::move(access_gpu_handles), vmem, max_granularity));
+      std::move(access_gpu_handles), vmem, max_granularity, releasable_pages));
 }
 
 GpuVirtualMemAllocator::GpuVirtualMemAllocator(
@@ -115,13 +116,14 @@ GpuVirtualMemAllocator::GpuVirtualMemAllocator(
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id,
     const std::vector<GpuDeviceHandle> access_gpu_handles,
-    GpuDriver::VmemSpan vmem, size_t granularity)
+    GpuDriver::VmemSpan vmem, size_t granularity, bool releasable_pages)
     : SubAllocator(alloc_visitors, free_visitors),
       gpu_context_(gpu_context),
       gpu_id_(gpu_id),
       access_gpu_handles_(access_gpu_handles),
       vmem_(vmem),
-      granularity_(granularity) {}
+      granularity_(granularity),
+      releasable_pages_(releasable_pages) {}
 
 GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
   for (const auto mapping : mappings_) {
@@ -151,25 +153,36 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
-  }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
-    return nullptr;
+  // Create physical memory backing allocation, one handle per page if the
+  // pages have to be releasable.
+  const size_t handle_bytes = releasable_pages_ ? granularity_ : padded_bytes;
+  const size_t num_mappings = mappings_.size();
+  for (size_t offset = 0; offset < padded_bytes; offset += handle_bytes) {
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, handle_bytes);
+    auto status = maybe_handle.status();
+    if (status.ok()) {
+      // Map VAs for this physical memory.
+      status = GpuDriver::MapMemory(&gpu_context_, next_va + offset,
+                                    *maybe_handle, access_gpu_handles_);
+      if (!status.ok()) {
+        GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                       std::move(maybe_handle).value());
+      }
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      for (auto it = mappings_.begin() + num_mappings; it != mappings_.end();
+           ++it) {
+        GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
+        GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+      }
+      mappings_.erase(mappings_.begin() + num_mappings, mappings_.end());
+      return nullptr;
+    }
+    mappings_.push_back({next_va + offset, std::move(maybe_handle).value()});
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  next_alloc_offset_ += padded_bytes;
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
@@ -180,50 +193,82 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
 
   if (ptr == nullptr) return;
 
-  auto mapping_it =
-      std::lower_bound(mappings_.begin(), mappings_.end(), ptr,
-                       [](const Mapping& mapping, const void* ptr) {
-                         return reinterpret_cast<const void*>(mapping.va) < ptr;
-                       });
-  if (mapping_it == mappings_.end() ||
-      (reinterpret_cast<void*>(mapping_it->va) != ptr)) {
+  const GpuDevicePtr va = reinterpret_cast<GpuDevicePtr>(ptr);
+  auto [begin, end] = MappingsIn(ptr, num_bytes);
+  // Pages given back by ReleasePages leave holes in the range, otherwise the
+  // mappings must cover it exactly.
+  if (va < vmem_.base || va + num_bytes > vmem_.base + next_alloc_offset_ ||
+      (!releasable_pages_ && (begin == end || begin->va != va))) {
     LOG(ERROR) << "Could not find GPU vmem mapping for address at "
                << reinterpret_cast<uintptr_t>(ptr);
     return;
   }
-
-  int num_mappings_to_free = 0;
-  int total_bytes = 0;
-  for (auto it = mapping_it; it != mappings_.end() && total_bytes < num_bytes;
-       ++it) {
-    ++num_mappings_to_free;
+  size_t total_bytes = 0;
+  for (auto it = begin; it != end; ++it) {
     total_bytes += it->physical.bytes;
   }
-  if (total_bytes != num_bytes) {
+  if (releasable_pages_ ? total_bytes > num_bytes : total_bytes != num_bytes) {
     LOG(ERROR) << "Invalid size requested for freeing GPU vmem mapping. Got "
                << tsl::strings::HumanReadableNumBytes(num_bytes)
                << " but expected "
-               << tsl::strings::HumanReadableNumBytes(
-                      mapping_it->physical.bytes);
+               << tsl::strings::HumanReadableNumBytes(total_bytes);
     return;
   }
 
-  VLOG(1) << "Freeing " << num_mappings_to_free << " mappings for a total of "
+  VLOG(1) << "Freeing " << end - begin << " mappings for a total of "
           << total_bytes << " bytes";
-  for (auto it = mapping_it; it < mapping_it + num_mappings_to_free; ++it) {
+  for (auto it = begin; it != end; ++it) {
     GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
     GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
   }
 
   // Move back the next_alloc_offset_ if this free was at the end.
-  if (mapping_it + num_mappings_to_free == mappings_.end()) {
-    next_alloc_offset_ = mapping_it->va - vmem_.base;
+  if (va + num_bytes == vmem_.base + next_alloc_offset_) {
+    next_alloc_offset_ = va - vmem_.base;
   }
 
-  mappings_.erase(mapping_it, mapping_it + num_mappings_to_free);
+  mappings_.erase(begin, end);
   VisitFree(ptr, gpu_id_.value(), num_bytes);
 }
 
+bool GpuVirtualMemAllocator::ReleasePages(void* ptr, size_t num_bytes) {
+  tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::ReleasePages");
+
+  const GpuDevicePtr va = reinterpret_cast<GpuDevicePtr>(ptr);
+  if (!releasable_pages_ || num_bytes == 0 || va % granularity_ != 0 ||
+      num_bytes % granularity_ != 0) {
+    return false;
+  }
+  auto [begin, end] = MappingsIn(ptr, num_bytes);
+  if (static_cast<size_t>(end - begin) != num_bytes / granularity_) {
+    LOG(ERROR) << "Could not find the GPU vmem mappings of the pages at "
+               << reinterpret_cast<uintptr_t>(ptr);
+    return false;
+  }
+
+  VLOG(1) << "Releasing " << end - begin << " pages at " << ptr;
+  for (auto it = begin; it != end; ++it) {
+    GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
+    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+  }
+  mappings_.erase(begin, end);
+  return true;
+}
+
+std::pair<std::vector<GpuVirtualMemAllocator::Mapping>::iterator,
+          std::vector<GpuVirtualMemAllocator::Mapping>::iterator>
+GpuVirtualMemAllocator::MappingsIn(const void* ptr, size_t num_bytes) {
+  auto first_not_before = [this](const void* p) {
+    return std::lower_bound(
+        mappings_.begin(), mappings_.end(), p,
+        [](const Mapping& mapping, const void* p) {
+          return reinterpret_cast<const void*>(mapping.va) < p;
+        });
+  };
+  return {first_not_before(ptr),
+          first_not_before(static_cast<const char*>(ptr) + num_bytes)};
+}
+
 }  // namespace tensorflow
 
 #endif
@@ -19,6 +19,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "xla/stream_executor/stream_executor.h"
@@ -40,6 +41,11 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
+// If created with releasable_pages, each page of granularity bytes is backed
+// by its own physical memory handle, so that the BFC allocator can give back
+// the pages of its free chunks with ReleasePages and map the physical memory
+// again at the end of the range (see BFCAllocator::Defragment).
+//
 // This class is not thread-safe.
 class GpuVirtualMemAllocator : public tsl::SubAllocator {
  public:
@@ -48,7 +54,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       const std::vector<Visitor>& free_visitors,
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids);
+      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+      bool releasable_pages = false);
   ~GpuVirtualMemAllocator() override;
 
   // Allocates memory at least as large as requested by num_bytes. Will be
@@ -68,10 +75,20 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   //
   // In practice, since the BFC allocator coalesces adjacent AllocationRegions,
   // this free function should never be invoked.
+  //
+  // The range may contain pages which were already given back by ReleasePages.
   void Free(void* ptr, size_t num_bytes) override;
 
   bool SupportsCoalescing() const override { return true; }
 
+  size_t ReleasablePageSize() const override {
+    return releasable_pages_ ? granularity_ : 0;
+  }
+
+  // Unmaps the pages of [ptr, ptr + num_bytes) and releases their physical
+  // memory, while the virtual addresses stay reserved until they are freed.
+  bool ReleasePages(void* ptr, size_t num_bytes) override;
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -79,7 +96,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id,
       std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
-      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity,
+      bool releasable_pages);
 
   stream_executor::gpu::GpuContext& gpu_context_;
   tsl::PlatformDeviceId gpu_id_;
@@ -100,6 +118,9 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // Smallest allocation as determined by CUDA.
   const size_t granularity_;
 
+  // Whether every page is mapped on its own, see ReleasablePageSize.
+  const bool releasable_pages_;
+
   struct Mapping {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
@@ -107,6 +128,10 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // List of mappings, sorted by va.
   std::vector<Mapping> mappings_;
 
+  // Returns the mappings whose virtual addresses are in [ptr, ptr + num_bytes).
+  std::pair<std::vector<Mapping>::iterator, std::vector<Mapping>::iterator>
+  MappingsIn(const void* ptr, size_t num_bytes);
+
   GpuVirtualMemAllocator(const GpuVirtualMemAllocator&) = delete;
   void operator=(const GpuVirtualMemAllocator&) = delete;
 };
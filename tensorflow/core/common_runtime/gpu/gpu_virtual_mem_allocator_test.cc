@@ -176,6 +176,39 @@ TEST(GpuVirtualMemAllocatorTest, FreeRange) {
   ASSERT_EQ(re_alloc, first_alloc);
 }
 
+TEST(GpuVirtualMemAllocatorTest, ReleasePages) {
+  tsl::PlatformDeviceId gpu_id(0);
+  auto executor =
+      se::GPUMachineManager()->ExecutorForDevice(gpu_id.value()).value();
+  GpuContext* gpu_context = reinterpret_cast<GpuContext*>(
+      executor->platform_specific_handle().context);
+  auto allocator = GpuVirtualMemAllocator::Create(
+                       {}, {}, *gpu_context, gpu_id,
+                       /*virtual_address_space_size=*/4 * k2MiB, {},
+                       /*releasable_pages=*/true)
+                       .value();
+  ASSERT_EQ(allocator->ReleasablePageSize(), k2MiB);
+  size_t bytes_received;  // Ignored in this test.
+  void* first_alloc = allocator->Alloc(
+      /*alignment=*/0, /*num_bytes=*/3 * k2MiB, &bytes_received);
+  ASSERT_NE(first_alloc, nullptr);
+
+  // The middle page is released, the addresses stay reserved.
+  char* middle_page = reinterpret_cast<char*>(first_alloc) + k2MiB;
+  EXPECT_TRUE(allocator->ReleasePages(middle_page, k2MiB));
+  EXPECT_FALSE(allocator->ReleasePages(middle_page, k2MiB));
+  void* second_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_EQ(second_alloc, middle_page + 2 * k2MiB);
+
+  // Freeing the whole range skips the released page.
+  allocator->Free(second_alloc, k2MiB);
+  allocator->Free(first_alloc, 3 * k2MiB);
+  void* re_alloc = allocator->Alloc(
+      /*alignment=*/0, /*num_bytes=*/4 * k2MiB, &bytes_received);
+  ASSERT_EQ(re_alloc, first_alloc);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
@@ -52,7 +52,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -107,7 +109,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          num_threads(in.num_threads) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -162,6 +165,9 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // The number of threads which prepare the nodes, when not importing.
+    int num_threads = 1;
   };
 
   typedef gtl::ArraySlice<const NodeDef*> NodeDefSlice;
@@ -247,6 +253,12 @@ class GraphConstructor {
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
+  // Consumes all the NodeDefs, and adds their default attributes and
+  // validates them in parallel, into `prepared_node_defs_`.
+  void PrepareNodeDefs();
+  // Adds the default attributes of `node_def` and validates it, as configured
+  // by `opts_`, when not importing.
+  Status PrepareNodeDef(NodeDef* node_def);
   // Modifies node_def's inputs according to opts_.input_map.
   // input_already_exists is a pre-initialized vector of length
   // node_def->input_size(). This function will mark inputs that are remapped to
@@ -406,6 +418,11 @@ class GraphConstructor {
   };
   std::vector<EdgeInfo> back_edges_;
 
+  // The NodeDefs prepared by PrepareNodeDefs(), and the results of their
+  // preparation. Each NodeDef is moved out once it's converted.
+  std::vector<NodeDef> prepared_node_defs_;
+  std::vector<Status> prepared_statuses_;
+
   GraphConstructor(const GraphConstructor&) = delete;
   void operator=(const GraphConstructor&) = delete;
 };
@@ -863,6 +880,36 @@ Status GraphConstructor::ValidateShape(Node* node) {
   return OkStatus();
 }
 
+Status GraphConstructor::PrepareNodeDef(NodeDef* node_def) {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  }
+  return OkStatus();
+}
+
+void GraphConstructor::PrepareNodeDefs() {
+  const int num_nodes = node_def_count();
+  prepared_node_defs_.reserve(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    prepared_node_defs_.push_back(consume_node_def(i));
+  }
+  prepared_statuses_.resize(num_nodes);
+  thread::ThreadPool pool(Env::Default(), "graph_constructor",
+                          opts_.num_threads);
+  // A rough estimate of the cycles to validate a node.
+  constexpr int64_t kCostPerNode = 10000;
+  pool.ParallelFor(num_nodes, kCostPerNode, [this](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      prepared_statuses_[i] = PrepareNodeDef(&prepared_node_defs_[i]);
+    }
+  });
+}
+
 Status GraphConstructor::ModifyNodeDefForImport(NodeDef* node_def) {
   const OpDef* op_def;
   TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
@@ -1185,6 +1232,13 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The NodeDefs of an import are modified in topological order, e.g. to
+  // uniquify their names, so they are prepared sequentially.
+  const bool prepare_in_parallel = !opts_.importing && opts_.num_threads > 1;
+  if (prepare_in_parallel) {
+    PrepareNodeDefs();
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1201,7 +1255,9 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef node_def = prepare_in_parallel
+                           ? std::move(prepared_node_defs_[o])
+                           : consume_node_def(o);
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1297,16 +1353,10 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (prepare_in_parallel) {
+      TF_RETURN_IF_ERROR(prepared_statuses_[o]);
     } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
-      }
+      TF_RETURN_IF_ERROR(PrepareNodeDef(&node_def));
     }
 
     TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
@@ -1352,7 +1402,10 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        // The pending NodeDefs haven't been converted yet.
+        const NodeDef& node_def =
+            prepare_in_parallel ? prepared_node_defs_[i] : get_node_def(i);
+        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(node_def)
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
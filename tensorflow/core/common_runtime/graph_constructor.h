@@ -52,6 +52,12 @@ struct GraphConstructorOptions {
   // If true, GraphConstructor will add attributes with their default
   // value to the Node when they are missing from the NodeDef.
   bool add_default_attributes = true;
+
+  // If greater than 1, the op lookup, default attributes and validation of
+  // the nodes run on that many threads before the nodes are added to the
+  // graph in order. Errors are reported as if the nodes were processed
+  // sequentially.
+  int num_threads = 1;
 };
 extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      const GraphDef& gdef, Graph* g);
@@ -898,6 +898,38 @@ TEST_F(GraphConstructorTest, SimpleModel) {
   EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
 }
 
+TEST_F(GraphConstructorTest, ParallelConversion) {
+  string gdef_ascii =
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }";
+  for (int i = 0; i < 20; ++i) {
+    strings::StrAppend(&gdef_ascii, "node { name: 't", i,
+                       "' op: 'TestMul' input: [ 'W1', 'input:1' ] }");
+  }
+  GraphDef gdef;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(gdef_ascii, &gdef));
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  Graph sequential_graph(OpRegistry::Global());
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, gdef, &sequential_graph));
+
+  Graph parallel_graph(OpRegistry::Global());
+  opts.num_threads = 4;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, gdef, &parallel_graph));
+  EXPECT_EQ(sequential_graph.ToGraphDefDebug().DebugString(),
+            parallel_graph.ToGraphDefDebug().DebugString());
+
+  // The error is the one of the first invalid node in topological order.
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'a' op: 'Unknown1' input: [ 'c' ] }"
+      "node { name: 'b' op: 'Unknown2' }"
+      "node { name: 'c' op: 'TestParams' }",
+      &gdef));
+  Graph invalid_graph(OpRegistry::Global());
+  Status status = ConvertGraphDefToGraph(opts, gdef, &invalid_graph);
+  EXPECT_TRUE(absl::StrContains(status.message(), "Unknown2")) << status;
+}
+
 TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   ExpectOK(
       "node { name: 'W1' op: 'TestParams' }"
@@ -0,0 +1,349 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Collects the status of a fixed number of concurrent transfers.  The first
+// failed transfer invokes `on_error` so that the transfers still pending, here
+// and on the peers, get aborted instead of blocking forever.
+class TransferStatus {
+ public:
+  TransferStatus(int num_transfers, std::function<void(const Status&)> on_error)
+      : pending_(num_transfers), on_error_(std::move(on_error)) {}
+
+  StatusCallback Callback() {
+    return [this](const Status& s) {
+      bool first_error = false;
+      {
+        mutex_lock l(mu_);
+        first_error = status_.ok() && !s.ok();
+        status_.Update(s);
+      }
+      if (first_error) on_error_(s);
+      pending_.DecrementCount();
+    };
+  }
+
+  // Blocks until all transfers are done and returns the first error, if any.
+  Status Wait() {
+    pending_.Wait();
+    mutex_lock l(mu_);
+    return status_;
+  }
+
+ private:
+  BlockingCounter pending_;
+  const std::function<void(const Status&)> on_error_;
+  mutex mu_;
+  Status status_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce expects a reduction, got ",
+                            col_params->instance.type);
+  }
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  // Subdiv 0 holds the first device of every task, subdiv i+1 the devices of
+  // task i.  A device that does not participate in a subdiv has subdiv_rank
+  // -1 in it.
+  std::vector<std::vector<int>>& perms =
+      col_params->instance.impl_details.subdiv_permutations;
+  perms.clear();
+  perms.emplace_back();
+  col_params->subdiv_rank.assign(1, -1);
+  const std::vector<CollGroupMember>& members = col_params->group.members;
+  for (int di = 0; di < col_params->group.group_size; ++di) {
+    if (di == 0 || members[di].task != members[di - 1].task) {
+      perms[0].push_back(di);
+      perms.emplace_back();
+      col_params->subdiv_rank.push_back(-1);
+    }
+    if (di == col_params->default_rank) {
+      col_params->subdiv_rank.back() = perms.back().size();
+      if (perms.back().empty()) {
+        col_params->subdiv_rank[0] = perms[0].size() - 1;
+      }
+    }
+    perms.back().push_back(di);
+  }
+  if (perms[0].size() != col_params->group.num_tasks) {
+    return errors::Internal(
+        "HierarchicalRingReduce requires the devices of each task to be "
+        "adjacent in the group, found ",
+        perms[0].size(), " runs of devices for ", col_params->group.num_tasks,
+        " tasks");
+  }
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  const auto& perms = col_params_->instance.impl_details.subdiv_permutations;
+  if (perms.empty() || col_params_->subdiv_rank.size() != perms.size()) {
+    return errors::Internal(
+        "HierarchicalRingReduce collective params are not initialized");
+  }
+  for (int sdi = 1; sdi < perms.size(); ++sdi) {
+    if (col_params_->subdiv_rank[sdi] >= 0) {
+      task_idx_ = sdi - 1;
+      local_rank_ = col_params_->subdiv_rank[sdi];
+    }
+  }
+  if (task_idx_ < 0) {
+    return errors::Internal("Device ", col_ctx->device_name,
+                            " is not a member of any task subdiv");
+  }
+  leaders_ = &perms[0];
+  task_devices_ = &perms[task_idx_ + 1];
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  abort_ = [this](const Status& s) { StartAbort(s); };
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  Status s = CopyInputToOutput();
+  if (s.ok() && col_ctx_->output->NumElements() > 0) {
+    s = ReduceWithinTask();
+    if (s.ok() && local_rank_ == 0) s = ReduceAcrossTasks();
+    if (s.ok()) s = BroadcastWithinTask();
+  }
+  VLOG(2) << "HierarchicalRingReducer device=" << col_ctx_->device_name
+          << " task_idx=" << task_idx_ << " local_rank=" << local_rank_
+          << " status " << s;
+  if (!s.ok()) StartAbort(s);
+  done(s);
+}
+
+void HierarchicalRingReducer::StartAbort(const Status& s) {
+  {
+    mutex_lock l(abort_mu_);
+    if (abort_started_) return;
+    abort_started_ = true;
+  }
+  LOG(ERROR) << "Aborting HierarchicalRingReduce with " << s;
+  // A cancellation already cancels all of the pending transfers.
+  CancellationManager* cancel_mgr = col_ctx_->op_ctx->cancellation_manager();
+  if (cancel_mgr == nullptr ||
+      (!cancel_mgr->IsCancelled() && !cancel_mgr->IsCancelling())) {
+    col_ctx_->col_exec->StartAbort(s);
+  }
+}
+
+Status HierarchicalRingReducer::CopyInputToOutput() {
+  if ((col_ctx_->input == col_ctx_->output) ||
+      (DMAHelper::base(col_ctx_->input) == DMAHelper::base(col_ctx_->output))) {
+    return OkStatus();
+  }
+  Notification note;
+  Status status;
+  profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device, col_ctx_->device,
+      col_ctx_->op_ctx->input_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input, col_ctx_->output,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalRingReducer::ReduceWithinTask() {
+  const int num_local = task_devices_->size();
+  if (num_local == 1) return OkStatus();
+  profiler::TraceMe activity("ReduceWithinTask", profiler::TraceMeLevel::kInfo);
+  Tensor* output = col_ctx_->output;
+  if (local_rank_ != 0) {
+    const int self = (*task_devices_)[local_rank_];
+    TransferStatus transfer(1, abort_);
+    DispatchSend((*task_devices_)[0], BufKey("local_reduce", 0, self), output,
+                 transfer.Callback());
+    return transfer.Wait();
+  }
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  std::vector<Tensor> values;
+  values.reserve(num_local - 1);
+  TransferStatus transfer(num_local - 1, abort_);
+  for (int i = 1; i < num_local; ++i) {
+    const int peer = (*task_devices_)[i];
+    values.emplace_back(allocator, output->dtype(), output->shape());
+    DispatchRecv(peer, BufKey("local_reduce", 0, peer), &values.back(),
+                 transfer.Callback());
+  }
+  TF_RETURN_IF_ERROR(transfer.Wait());
+  for (Tensor& value : values) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, output, &value));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalRingReducer::ReduceAcrossTasks() {
+  profiler::TraceMe activity("ReduceAcrossTasks",
+                             profiler::TraceMeLevel::kInfo);
+  const int num_tasks = leaders_->size();
+  const int next = (*leaders_)[(task_idx_ + 1) % num_tasks];
+  const int prev = (*leaders_)[(task_idx_ + num_tasks - 1) % num_tasks];
+  const int prev_task = (task_idx_ + num_tasks - 1) % num_tasks;
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      col_ctx_->output, num_tasks,
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0))));
+  const Tensor group_size = ca->Scalar(col_params_->group.group_size);
+
+  // Pass 0 is a reduce-scatter after which this leader holds the reduced chunk
+  // task_idx_ + 1; pass 1 is an all-gather of the reduced chunks.
+  Status s;
+  for (int pass = 0; pass < 2 && s.ok(); ++pass) {
+    const string phase = pass == 0 ? "reduce_scatter" : "all_gather";
+    for (int step = 0; step < num_tasks - 1 && s.ok(); ++step) {
+      const int send_chunk = (task_idx_ + num_tasks + pass - step) % num_tasks;
+      const int recv_chunk =
+          (task_idx_ + num_tasks + pass - step - 1) % num_tasks;
+      Tensor send_value = ca->ChunkAlias(send_chunk);
+      Tensor recv_value =
+          pass == 0 ? ca->TempChunk(recv_chunk) : ca->ChunkAlias(recv_chunk);
+      TransferStatus transfer(2, abort_);
+      DispatchSend(next, BufKey(phase, step, task_idx_), &send_value,
+                   transfer.Callback());
+      DispatchRecv(prev, BufKey(phase, step, prev_task), &recv_value,
+                   transfer.Callback());
+      s = transfer.Wait();
+      if (s.ok() && pass == 0) {
+        Tensor chunk = ca->ChunkAlias(recv_chunk);
+        s = collective_util::ComputeBinOp(
+            col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+            col_params_->merge_op, &chunk, &recv_value);
+      }
+    }
+  }
+  ca->ConsumeFinalValue(col_ctx_->output);
+  if (s.ok() && col_params_->final_op) {
+    Tensor divisor = group_size;
+    s = collective_util::ComputeBinOp(col_ctx_->op_ctx, col_ctx_->op_params,
+                                      col_ctx_->device, col_params_->final_op,
+                                      col_ctx_->output, &divisor);
+  }
+  return s;
+}
+
+Status HierarchicalRingReducer::BroadcastWithinTask() {
+  const int num_local = task_devices_->size();
+  if (num_local == 1) return OkStatus();
+  profiler::TraceMe activity("BroadcastWithinTask",
+                             profiler::TraceMeLevel::kInfo);
+  if (local_rank_ != 0) {
+    const int self = (*task_devices_)[local_rank_];
+    TransferStatus transfer(1, abort_);
+    DispatchRecv((*task_devices_)[0], BufKey("local_broadcast", 0, self),
+                 col_ctx_->output, transfer.Callback());
+    return transfer.Wait();
+  }
+  TransferStatus transfer(num_local - 1, abort_);
+  for (int i = 1; i < num_local; ++i) {
+    const int peer = (*task_devices_)[i];
+    DispatchSend(peer, BufKey("local_broadcast", 0, peer), col_ctx_->output,
+                 transfer.Callback());
+  }
+  return transfer.Wait();
+}
+
+string HierarchicalRingReducer::BufKey(const string& phase, int step,
+                                       int src_rank) const {
+  return strings::StrCat("HierarchicalRingReduce(", col_ctx_->exec_key, "):",
+                         phase, ":", step, ":", src_rank);
+}
+
+void HierarchicalRingReducer::DispatchSend(int dst_idx, const string& key,
+                                           const Tensor* tensor,
+                                           const StatusCallback& done) {
+  VLOG(3) << "DispatchSend " << key << " from_device "
+          << col_ctx_->device_name << " to_device "
+          << col_params_->group.members[dst_idx].device.name();
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.members[dst_idx].device.name(),
+      col_params_->group.members[dst_idx].task, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor,
+      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+      done);
+}
+
+void HierarchicalRingReducer::DispatchRecv(int src_idx, const string& key,
+                                           Tensor* tensor,
+                                           const StatusCallback& done) {
+  VLOG(3) << "DispatchRecv " << key << " from_device "
+          << col_params_->group.members[src_idx].device.name()
+          << " to_device " << col_ctx_->device_name;
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.members[src_idx].device.name(),
+      col_params_->group.members[src_idx].task,
+      col_params_->group.members[src_idx].is_local, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), tensor,
+      col_ctx_->device_locality, 0 /*stream_index*/,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+// Topology-aware implementation of collective all-reduce for CPU devices.
+//
+// The devices of each task first reduce their values into the first device of
+// the task (the task leader) through local buffer handoffs.  The task leaders
+// then run a ring all-reduce among themselves, one chunk per task, and finally
+// each leader broadcasts the result to the other devices of its task.  Compared
+// to `RingReducer` over all devices, the bytes crossing task boundaries are
+// independent of the number of devices per task.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer() = default;
+  ~HierarchicalRingReducer() override = default;
+
+  // Establishes the subdiv permutations of the algorithm.  Subdiv 0 comprises
+  // the task leaders in task order and subdiv i+1 comprises the devices of
+  // task i.  Precondition: the devices of a task are adjacent in the group.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Runs the hierarchical all-reduce.  Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Copies the input into the output unless the reduction runs in place.
+  Status CopyInputToOutput();
+
+  // Reduces the values of the devices of this task into the task leader.
+  Status ReduceWithinTask();
+
+  // Runs a ring all-reduce among the task leaders and applies the final op.
+  Status ReduceAcrossTasks();
+
+  // Sends the value of the task leader to the other devices of this task.
+  Status BroadcastWithinTask();
+
+  // Sends `tensor` to the group member `dst_idx` under `key`.
+  void DispatchSend(int dst_idx, const string& key, const Tensor* tensor,
+                    const StatusCallback& done);
+
+  // Receives the tensor sent under `key` by the group member `src_idx`.
+  void DispatchRecv(int src_idx, const string& key, Tensor* tensor,
+                    const StatusCallback& done);
+
+  // Aborts the pending transfers of the collective executor, once.
+  void StartAbort(const Status& s);
+
+  string BufKey(const string& phase, int step, int src_rank) const;
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_ = nullptr;  // Not owned
+  // Group member indices of the task leaders and of the devices of this task.
+  const std::vector<int>* leaders_ = nullptr;
+  const std::vector<int>* task_devices_ = nullptr;
+  int task_idx_ = -1;
+  int local_rank_ = -1;
+  std::function<void(const Status&)> abort_;
+  mutex abort_mu_;
+  bool abort_started_ TF_GUARDED_BY(abort_mu_) = false;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
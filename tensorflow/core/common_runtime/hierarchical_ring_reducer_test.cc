@@ -0,0 +1,158 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node_def,
+      TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  struct DeviceInstance {
+    core::RefCountPtr<CollectiveParams> col_params;
+    Device* device = nullptr;
+    std::unique_ptr<OpKernel> merge_op;
+    std::unique_ptr<OpKernel> final_op;
+    Tensor tensor;
+    Status status;
+  };
+
+  // Runs the reduction on every device, using `fail_after` > 0 to make the
+  // `fail_after`-th transfer fail.
+  void RunReduce(int num_workers, int num_devices, int tensor_len,
+                 int fail_after, std::vector<DeviceInstance>* instances) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    const int group_size = num_workers * num_devices;
+    instances->resize(group_size);
+    for (int rank = 0; rank < group_size; ++rank) {
+      DeviceInstance& di = (*instances)[rank];
+      di.col_params = CreateCollectiveParams(
+          *test_env_, rank, "HierarchicalRingReduce", REDUCTION_COLLECTIVE,
+          DT_FLOAT, TensorShape({tensor_len}));
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+          di.col_params->group.members[rank].device.name(), &di.device));
+      di.merge_op = GetBinOp("Add", DT_FLOAT, di.device);
+      di.final_op = GetBinOp("Div", DT_FLOAT, di.device);
+      di.col_params->merge_op = di.merge_op.get();
+      di.col_params->final_op = di.final_op.get();
+      di.tensor = Tensor(DT_FLOAT, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        di.tensor.flat<float>()(i) = rank * 4 + i;
+      }
+    }
+    BlockingCounter counter(group_size);
+    for (DeviceInstance& di : *instances) {
+      SchedClosure([this, &di, &counter] {
+        di.status = RunCollective(test_env_.get(), di.col_params.get(),
+                                  di.device, &di.tensor, &di.tensor);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+
+  void RunTest(int num_workers, int num_devices, int tensor_len) {
+    std::vector<DeviceInstance> instances;
+    RunReduce(num_workers, num_devices, tensor_len, /*fail_after=*/0,
+              &instances);
+    // The mean of rank * 4 + i over all ranks.
+    const int group_size = num_workers * num_devices;
+    std::vector<float> expected(tensor_len);
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] = (group_size - 1) * 2 + i;
+    }
+    for (DeviceInstance& di : instances) {
+      TF_EXPECT_OK(di.status);
+      test::ExpectTensorEqual<float>(test::AsTensor<float>(expected),
+                                     di.tensor);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(HierarchicalRingReducerTest, SingleTask) { RunTest(1, 4, 1001); }
+
+TEST_F(HierarchicalRingReducerTest, OneDevicePerTask) { RunTest(3, 1, 1001); }
+
+TEST_F(HierarchicalRingReducerTest, MultiTask) {
+  RunTest(2, 4, 4096);
+  RunTest(4, 3, 1001);
+}
+
+TEST_F(HierarchicalRingReducerTest, FewerElementsThanTasks) {
+  RunTest(4, 2, 3);
+}
+
+TEST_F(HierarchicalRingReducerTest, SubdivPermutations) {
+  test_env_ = CreateCollectiveTestEnv(/*num_workers=*/3,
+                                      /*num_devices_per_worker=*/2, DEVICE_CPU);
+  auto col_params = CreateCollectiveParams(
+      *test_env_, /*rank=*/3, "HierarchicalRingReduce", REDUCTION_COLLECTIVE,
+      DT_FLOAT, TensorShape({8}));
+  HierarchicalRingReducer reducer;
+  TF_ASSERT_OK(reducer.InitializeCollectiveParams(col_params.get()));
+  EXPECT_EQ(col_params->instance.impl_details.subdiv_permutations,
+            std::vector<std::vector<int>>({{0, 2, 4}, {0, 1}, {2, 3}, {4, 5}}));
+  EXPECT_EQ(col_params->subdiv_rank, std::vector<int>({-1, -1, 1, -1}));
+}
+
+TEST_F(HierarchicalRingReducerTest, Failure) {
+  std::vector<DeviceInstance> instances;
+  RunReduce(/*num_workers=*/2, /*num_devices=*/2, /*tensor_len=*/128,
+            /*fail_after=*/3, &instances);
+  for (DeviceInstance& di : instances) {
+    EXPECT_NE(di.status.message().find("Deliberate failure"), string::npos)
+        << di.status;
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -48,7 +48,9 @@ namespace test {
 Benchmark::Benchmark(const string& device, Graph* g,
                      const SessionOptions* options, Graph* init,
                      Rendezvous* rendez, const char* executor_type,
-                     bool old_benchmark_api) {
+                     bool old_benchmark_api,
+                     const std::function<void(LocalExecutorParams*)>&
+                         customize_params) {
   auto cleanup = gtl::MakeCleanup([g, init]() {
     delete g;
     delete init;
@@ -108,6 +110,9 @@ Benchmark::Benchmark(const string& device, Graph* g,
   params.delete_kernel = [](OpKernel* kernel) {
     DeleteNonCachedKernel(kernel);
   };
+  if (customize_params) {
+    customize_params(&params);
+  }
 
   if (init) {
     std::unique_ptr<Executor> init_exec;
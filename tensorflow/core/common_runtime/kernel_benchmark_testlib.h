@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_BENCHMARK_TESTLIB_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_KERNEL_BENCHMARK_TESTLIB_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -48,10 +49,15 @@ class Benchmark {
   //   * In the new API, the timer starts automatically at the first
   //     iteration of the loop and stops after the last iteration.
   // TODO(vyng) Remove this once we have migrated all code to newer API.
+  //
+  // customize_params: If not null, called to adjust the parameters of the
+  //   executors before they are created.
   Benchmark(const string& device, Graph* g,
             const SessionOptions* options = nullptr, Graph* init = nullptr,
             Rendezvous* rendez = nullptr, const char* executor_type = "",
-            bool old_benchmark_api = false);
+            bool old_benchmark_api = false,
+            const std::function<void(LocalExecutorParams*)>&
+                customize_params = nullptr);
 
   Benchmark(const string& device, Graph* g, bool old_benchmark_api);
 
@@ -23,6 +23,7 @@ limitations under the License.
 
 namespace tensorflow {
 class Device;
+class ExecutorCostProfile;
 class StepStatsCollector;
 class SessionMetadata;
 class FunctionLibraryRuntime;
@@ -50,6 +51,30 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If not null, kernel cost estimates used to initialize the executor, e.g.
+  // obtained from `Executor::ExportCostProfile()` in a warm process running
+  // the same graph. Only needs to be alive during executor creation. Neither
+  // sessions nor the SavedModel loader set it: callers that create executors
+  // directly pass it themselves.
+  const ExecutorCostProfile* cost_profile = nullptr;
+
+  // If true, the bookkeeping state of finished while-loop frames and
+  // iterations (including their pending counts and input tensor arrays) is
+  // kept until the end of each step and reused for new frames and iterations,
+  // instead of being freed and reallocated. This removes most heap
+  // allocations from the control flow hot path, at the cost of holding the
+  // peak amount of that state for the whole step.
+  bool pool_control_flow_state = false;
+
+  // If true, the single-threaded executor records the allocations of a step
+  // of the graph on a CPU device, plans them in a single arena like TFLite's
+  // ArenaPlanner, and serves the allocations of the following steps from an
+  // arena preallocated at the start of each step. Suited to graphs with fixed
+  // shapes: graphs which allocate differently from step to step fall back to
+  // the device allocator. Kernels must not keep the allocator of their context
+  // beyond their step.
+  bool use_static_memory_arena = false;
 };
 
 }  // end namespace tensorflow
@@ -183,6 +183,45 @@ Status Placer::Run() {
   return Run(options);
 }
 
+Status Placer::Run(
+    const GraphOptimizationPassOptions& options,
+    const std::unordered_map<string, string>& previous_placement) {
+  if (devices_->devices().empty()) {
+    return errors::FailedPrecondition("No devices are registered");
+  }
+
+  std::vector<Node*> unassigned_nodes;
+  int num_reused = 0;
+  for (Node* node : graph_->op_nodes()) {
+    if (node->has_assigned_device_name()) {
+      continue;
+    }
+    unassigned_nodes.push_back(node);
+    auto it = previous_placement.find(node->name());
+    if (it != previous_placement.end() &&
+        devices_->FindDeviceByName(it->second) != nullptr) {
+      node->set_assigned_device_name(it->second);
+      ++num_reused;
+    }
+  }
+  if (num_reused == 0) {
+    return Run(options);
+  }
+
+  Status status = Run(options);
+  if (status.ok()) {
+    VLOG(1) << "Reused the previous placement of " << num_reused << " of "
+            << unassigned_nodes.size() << " nodes";
+    return status;
+  }
+  VLOG(1) << "Placing the graph from scratch, the previous placement doesn't "
+          << "apply: " << status;
+  for (Node* node : unassigned_nodes) {
+    node->set_assigned_device_name("");
+  }
+  return Run(options);
+}
+
 Status Placer::Run(const GraphOptimizationPassOptions& options) {
   if (devices_->devices().empty()) {
     return errors::FailedPrecondition("No devices are registered");
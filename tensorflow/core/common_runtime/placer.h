@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_PLACER_H_
 
 #include <string>
+#include <unordered_map>
 
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
@@ -89,6 +90,16 @@ class Placer {
   Status Run();
   Status Run(const GraphOptimizationPassOptions& options);
 
+  // Like Run(), but starts from "previous_placement", the node name to
+  // assigned device mapping of a graph placed before, which this graph is a
+  // slight modification of. The nodes that changed since must be left out of
+  // "previous_placement". The unassigned nodes found in "previous_placement"
+  // keep their previous device, so only the colocation groups of the other
+  // nodes have their devices chosen. If the previous devices violate a
+  // constraint of this graph, the graph is placed from scratch instead.
+  Status Run(const GraphOptimizationPassOptions& options,
+             const std::unordered_map<string, string>& previous_placement);
+
  private:
   // Returns true if the device type of 'candidate_device_name' is
   // found in 'devices'.
@@ -870,6 +870,51 @@ TEST_F(PlacerTest, TestAssignedDevicePreserved) {
             GetNodeByName(g, "in")->assigned_device_name());
 }
 
+// Test that the nodes of a previous placement keep their device, while the
+// other nodes are placed as usual.
+TEST_F(PlacerTest, TestPreviousPlacementReused) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* input = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    Node* relu_1 = ops::UnaryOp("TestRelu", input, b.opts().WithName("relu_1"));
+    ops::UnaryOp("TestRelu", relu_1, b.opts().WithName("relu_2"));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+
+  Placer placer(&g, "", &g.flib_def(), &devices_);
+  TF_EXPECT_OK(placer.Run(
+      GraphOptimizationPassOptions(),
+      {{"in", "/job:a/replica:0/task:0/device:FakeCPU:3"},
+       {"relu_1", "/job:a/replica:0/task:0/device:FakeGPU:2"}}));
+  EXPECT_EQ("/job:a/replica:0/task:0/device:FakeCPU:3",
+            GetNodeByName(g, "in")->assigned_device_name());
+  EXPECT_EQ("/job:a/replica:0/task:0/device:FakeGPU:2",
+            GetNodeByName(g, "relu_1")->assigned_device_name());
+  EXPECT_DEVICE_TYPE(g, "relu_2", "FakeGPU");
+}
+
+// Test that a previous placement which violates the constraints of the graph
+// is discarded.
+TEST_F(PlacerTest, TestInvalidPreviousPlacementDiscarded) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* input = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    ops::UnaryOp("TestRelu", input, b.opts().WithName("relu"));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+
+  // TestInput has no FakeGPU kernel.
+  Placer placer(&g, "", &g.flib_def(), &devices_);
+  TF_EXPECT_OK(placer.Run(
+      GraphOptimizationPassOptions(),
+      {{"in", "/job:a/replica:0/task:0/device:FakeGPU:0"},
+       {"relu", "/job:a/replica:0/task:0/device:FakeGPU:2"}}));
+  EXPECT_DEVICE_TYPE(g, "in", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g, "relu", "FakeGPU");
+}
+
 // Test that a graph with partial device specifications for CPU-only ops
 // will be relocated to CPU.
 TEST_F(PlacerTest, TestPartialSpecGpuToCpu) {
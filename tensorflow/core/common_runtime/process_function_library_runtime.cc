@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -419,6 +420,25 @@ Status FunctionRetsToTensors(const std::vector<FunctionRet>* function_rets,
   }
   return OkStatus();
 }
+
+// The maximum number of threads which instantiate the component functions of
+// a multi-device function, including the calling thread.
+constexpr int kMaxInstantiationThreads = 8;
+
+// The instantiations of the component functions of a multi-device function,
+// shared by the threads which run them.
+struct ComponentInstantiations {
+  std::vector<std::function<void()>> fns;
+  std::atomic<int> next{0};
+
+  // Runs the instantiations not claimed yet by another thread.
+  void Run() {
+    const int num_fns = fns.size();
+    for (int i = next++; i < num_fns; i = next++) {
+      fns[i]();
+    }
+  }
+};
 }  // namespace
 
 ProcessFunctionLibraryRuntime::AsyncAttributes::Summary
@@ -611,15 +631,13 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   const int num_subgraphs = subgraphs->size();
   gtl::InlinedVector<Status, 4> instantiate_status(num_subgraphs);
   BlockingCounter counter(static_cast<int>(num_subgraphs));
-  auto runner = [this, num_subgraphs](std::function<void()> fn) {
-    // NOTE: Only use thread pool to instantiate sub-function when there are
-    // more than 8 sub-functions. We want to avoid cost of switching thread when
-    // there are only a few sub-functions.
-    if (default_thread_pool_ != nullptr && num_subgraphs > 8) {
-      default_thread_pool_->Schedule(fn);
-    } else {
-      fn();
-    }
+  // Threads of the pool may start after all the instantiations are done, so
+  // they only share ownership of `instantiations`. The instantiations
+  // themselves only run before `counter` reaches zero.
+  auto instantiations = std::make_shared<ComponentInstantiations>();
+  instantiations->fns.reserve(num_subgraphs);
+  auto runner = [&instantiations](std::function<void()> fn) {
+    instantiations->fns.push_back(std::move(fn));
   };
 
   // Before instantiating component functions, determine synchronous execution.
@@ -741,6 +759,20 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     });
     i += 1;
   }
+  // The calling thread instantiates components too, so that a few components
+  // don't pay for switching threads, and with a bounded number of threads of
+  // the pool.
+  if (default_thread_pool_ != nullptr) {
+    const int num_helpers =
+        std::min({num_subgraphs, default_thread_pool_->NumThreads() + 1,
+                  kMaxInstantiationThreads}) -
+        1;
+    for (int j = 0; j < num_helpers; ++j) {
+      default_thread_pool_->Schedule(
+          [instantiations] { instantiations->Run(); });
+    }
+  }
+  instantiations->Run();
   counter.Wait();
   StatusGroup group;
   for (auto& status : instantiate_status) {
@@ -138,7 +138,8 @@ class ProcessFunctionLibraryRuntimeTest : public ::testing::Test {
   void Init(const std::vector<FunctionDef>& flib,
             const SessionMetadata* session_metadata = nullptr,
             const std::vector<OptimizedFunctionGraph>&
-                optimized_function_graphs = {}) {
+                optimized_function_graphs = {},
+            thread::ThreadPool* thread_pool = nullptr) {
     FunctionDefLibrary proto;
     for (const auto& fdef : flib) *(proto.add_function()) = fdef;
     lib_def_.reset(new FunctionLibraryDefinition(OpRegistry::Global(), proto));
@@ -149,8 +150,8 @@ class ProcessFunctionLibraryRuntimeTest : public ::testing::Test {
     cluster_flr_.reset(new TestClusterFLR(device_mgr_.get()));
     proc_flr_.reset(new ProcessFunctionLibraryRuntime(
         device_mgr_.get(), Env::Default(), /*config=*/nullptr,
-        TF_GRAPH_DEF_VERSION, lib_def_.get(), opts,
-        /*thread_pool=*/nullptr, cluster_flr_.get(), session_metadata,
+        TF_GRAPH_DEF_VERSION, lib_def_.get(), opts, thread_pool,
+        cluster_flr_.get(), session_metadata,
         Rendezvous::Factory{[this](const int64_t step_id,
                                    const DeviceMgr* device_mgr,
                                    tsl::core::RefCountPtr<Rendezvous>* r) {
@@ -754,6 +755,33 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_ErrorWhenNoInputDevices) {
                     "input_devices must have the same length");
 }
 
+TEST_F(ProcessFunctionLibraryRuntimeTest,
+       MultiDevice_InstantiatesComponentsInParallel) {
+  FunctionDef add_across_devices = FunctionDefHelper::Create(
+      "AddAcrossDevices", {"x: float"}, {"y: float"}, {},
+      {
+          {{"x0"}, "Identity", {"x"}, {{"T", DT_FLOAT}}, {}, "/device:CPU:0"},
+          {{"x1"}, "Identity", {"x"}, {{"T", DT_FLOAT}}, {}, "/device:CPU:1"},
+          {{"add"},
+           "Add",
+           {"x0:output:0", "x1:output:0"},
+           {{"T", DT_FLOAT}},
+           {},
+           "/device:CPU:0"},
+      },
+      {{"y", "add:z:0"}});
+  thread::ThreadPool thread_pool(Env::Default(), "instantiate", 2);
+  Init({add_across_devices}, /*session_metadata=*/nullptr,
+       /*optimized_function_graphs=*/{}, &thread_pool);
+
+  FunctionLibraryRuntime::Options opts;
+  Tensor y;
+  TF_ASSERT_OK(Run("AddAcrossDevices", opts, {},
+                   MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0"}),
+                   {test::AsTensor<float>({1, 2})}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4}));
+}
+
 TEST_F(ProcessFunctionLibraryRuntimeTest,
        MultiDevice_ErrorWhenTooManyInputDevices) {
   if (gpu_device_ == nullptr) {
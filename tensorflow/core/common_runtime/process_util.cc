@@ -22,10 +22,15 @@ limitations under the License.
 #endif  // defined(ENABLE_MKL) && defined(ENABLE_ONEDNN_OPENMP)
 #include <string.h>
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
@@ -90,6 +95,43 @@ thread::ThreadPool* ComputePool(const SessionOptions& options) {
   return compute_pool;
 }
 
+thread::ThreadPool* NUMAComputePool(const SessionOptions& options,
+                                    int numa_node) {
+  if (numa_node == port::kNUMANoAffinity || !port::NUMAEnabled() ||
+      numa_node >= port::NUMANumNodes()) {
+    return ComputePool(options);
+  }
+  static mutex& numa_pools_mu = *new mutex;
+  static auto& numa_pools TF_GUARDED_BY(numa_pools_mu) =
+      *new std::vector<thread::ThreadPool*>;
+
+  mutex_lock l(numa_pools_mu);
+  if (numa_node >= numa_pools.size()) {
+    numa_pools.resize(numa_node + 1, nullptr);
+  }
+  if (numa_pools[numa_node] == nullptr) {
+    int32_t inter_op_parallelism_threads =
+        options.config.inter_op_parallelism_threads();
+    if (inter_op_parallelism_threads <= 0) {
+      inter_op_parallelism_threads = GetEnvNumInterOpThreads();
+    }
+    if (inter_op_parallelism_threads <= 0) {
+      inter_op_parallelism_threads = port::MaxParallelism(numa_node);
+    }
+    ThreadOptions thread_opts;
+    thread_opts.numa_node = numa_node;
+    VLOG(1) << "NUMA node " << numa_node << " compute pool with "
+            << inter_op_parallelism_threads << " threads";
+    numa_pools[numa_node] = new thread::ThreadPool(
+        Env::Default(), thread_opts,
+        strings::StrCat("numa_", numa_node, "_Compute"),
+        inter_op_parallelism_threads,
+        !options.config.experimental().disable_thread_spinning(),
+        /*allocator=*/nullptr);
+  }
+  return numa_pools[numa_node];
+}
+
 int32 NumInterOpThreadsFromEnvironment() {
   int32_t num;
   const char* val = std::getenv("TF_NUM_INTEROP_THREADS");
@@ -31,6 +31,15 @@ namespace tensorflow {
 // using 'options'.  Caller does not take ownership over threadpool.
 thread::ThreadPool* ComputePool(const SessionOptions& options);
 
+// Returns a process-wide ThreadPool for scheduling compute operations on
+// NUMA node 'numa_node', whose threads are bound to that node. The pool has
+// 'options.config.inter_op_parallelism_threads()' threads if set, or else as
+// many threads as there are schedulable CPUs on the node.  Returns
+// ComputePool(options) if 'numa_node' is port::kNUMANoAffinity or NUMA is not
+// supported.  Caller does not take ownership over threadpool.
+thread::ThreadPool* NUMAComputePool(const SessionOptions& options,
+                                    int numa_node);
+
 // Returns the TF_NUM_INTEROP_THREADS environment value, or 0 if not specified.
 int32 NumInterOpThreadsFromEnvironment();
 
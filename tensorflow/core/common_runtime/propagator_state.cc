@@ -29,7 +29,9 @@ PropagatorState::PropagatorState(const ImmutableExecutorState& immutable_state,
                                  int64_t step_id, bool vlog)
     : immutable_state_(immutable_state),
       step_id_(step_id),
-      vlog_(vlog || VLOG_IS_ON(1)) {
+      vlog_(vlog || VLOG_IS_ON(1)),
+      pool_control_flow_state_(
+          immutable_state.params().pool_control_flow_state) {
   // We start the entire execution in iteration 0 of the root frame
   // so let us create the root frame and the state for iteration 0.
   // We assume root_frame_->frame_name.empty().
@@ -49,6 +51,11 @@ PropagatorState::~PropagatorState() {
   for (auto name_frame : outstanding_frames_) {
     delete name_frame.second;
   }
+  for (auto& info_frames : free_frames_) {
+    for (FrameState* frame : info_frames.second) {
+      delete frame;
+    }
+  }
 }
 
 void PropagatorState::ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
@@ -280,8 +287,7 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
     VLOG(2) << "Create frame: " << child_name << " id: " << child_id;
   }
 
-  FrameState* temp =
-      new FrameState(immutable_state_, frame_info.parallel_iterations);
+  FrameState* temp = NewFrame(frame_info);
   temp->frame_id = child_id;
   temp->parent_frame = frame;
   temp->parent_iter = iter_state;
@@ -290,8 +296,7 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
   // Initialize iteration 0.
   {
     mutex_lock l(temp->mu);
-    temp->SetIteration(0, new IterationState(0, temp->pending_counts,
-                                             temp->total_input_tensors));
+    temp->SetIteration(0, temp->NewIteration(0));
   }
 
   {
@@ -384,10 +389,32 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
   {
     mutex_lock executor_lock(mu_);
     outstanding_frames_.erase(frame->frame_id);
+    if (pool_control_flow_state_) {
+      // No other thread refers to a finished frame, so it can be reset and
+      // handed out again by `NewFrame()`.
+      frame->Reset();
+      free_frames_[frame->frame_info].push_back(frame);
+      return;
+    }
   }
   delete frame;
 }
 
+PropagatorState::FrameState* PropagatorState::NewFrame(
+    const ImmutableExecutorState::FrameInfo& frame_info) {
+  if (pool_control_flow_state_) {
+    mutex_lock executor_lock(mu_);
+    auto it = free_frames_.find(&frame_info);
+    if (it != free_frames_.end() && !it->second.empty()) {
+      FrameState* frame = it->second.back();
+      it->second.pop_back();
+      return frame;
+    }
+  }
+  return new FrameState(immutable_state_, frame_info.parallel_iterations,
+                        pool_control_flow_state_);
+}
+
 void PropagatorState::CleanupFramesIterations(FrameState* frame,
                                               IterationState* iter_state,
                                               TaggedNodeSeq* ready) {
@@ -753,8 +780,7 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter = NewIteration(iteration_count);
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   {
@@ -775,7 +801,7 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64_t curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    ReleaseIteration(iter_state);
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -800,12 +826,49 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
 
 void PropagatorState::FrameState::InitializeFrameInfo(
     const ImmutableExecutorState::FrameInfo& finfo) {
+  frame_info = &finfo;
   pending_counts = finfo.pending_counts.get();
   total_input_tensors = finfo.total_inputs;
   num_pending_inputs = finfo.input_count;
   nodes = finfo.nodes.get();
 }
 
+PropagatorState::IterationState* PropagatorState::FrameState::NewIteration(
+    int64_t iter_num) {
+  if (!free_iterations.empty()) {
+    IterationState* iter_state = free_iterations.back();
+    free_iterations.pop_back();
+    iter_state->Reset(iter_num, pending_counts);
+    return iter_state;
+  }
+  return new IterationState(iter_num, pending_counts, total_input_tensors);
+}
+
+void PropagatorState::FrameState::ReleaseIteration(IterationState* iter_state) {
+  if (pool_iterations) {
+    // Release the unconsumed inputs now, rather than when the state is
+    // reused, so that recycling does not extend the lifetime of tensors.
+    iter_state->ClearInputTensors(total_input_tensors);
+    free_iterations.push_back(iter_state);
+  } else {
+    delete iter_state;
+  }
+}
+
+void PropagatorState::FrameState::Reset() {
+  mutex_lock l(mu);
+  mutex_lock iter_lock(iter_mu);
+  DCHECK_EQ(num_outstanding_iterations, 0);
+  frame_id = 0;
+  parent_iter = nullptr;
+  parent_frame = nullptr;
+  iteration_count = 0;
+  num_outstanding_iterations = 1;
+  next_iter_roots.clear();
+  inv_values.clear();
+  dead_exits.clear();
+}
+
 void PropagatorState::FrameState::SetIteration(int64_t iter,
                                                IterationState* state)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
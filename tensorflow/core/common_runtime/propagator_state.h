@@ -135,8 +135,26 @@ class PropagatorState {
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64_t
-        iter_num;  // The index of this iteration in the enclosing loop.
+    // Reinitializes a recycled iteration state as iteration `iter_num`,
+    // reusing its input tensor and pending count storage.
+    // REQUIRES: `ClearInputTensors()` was called after its previous use.
+    void Reset(int64_t iter_num, const PendingCounts* pending_counts) {
+      this->iter_num = iter_num;
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.CopyFrom(*pending_counts);
+    }
+
+    // Releases any input tensors that were not consumed by the iteration.
+    void ClearInputTensors(int total_input_tensors) {
+      for (int i = 0; i < total_input_tensors; ++i) {
+        input_tensors[i].ClearVal();
+      }
+    }
+
+    // The index of this iteration in the enclosing loop. Only modified by
+    // `Reset()`, while the iteration state is not in use.
+    int64_t iter_num;
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -213,10 +231,13 @@ class PropagatorState {
   };
 
   struct FrameState {
+    // If `pool_iterations` is true, the states of finished iterations are
+    // kept in `free_iterations` and reused by later iterations of the frame.
     explicit FrameState(const ImmutableExecutorState& immutable_state,
-                        int parallel_iters)
+                        int parallel_iters, bool pool_iterations = false)
         : immutable_state(immutable_state),
           max_parallel_iterations(parallel_iters),
+          pool_iterations(pool_iterations),
           num_outstanding_iterations(1),
           iterations(parallel_iters + 1),
           iterations_raw(iterations.data()) {}
@@ -272,6 +293,9 @@ class PropagatorState {
     // The maximum allowed number of parallel iterations.
     const int max_parallel_iterations;
 
+    // Whether iteration states are recycled through `free_iterations`.
+    const bool pool_iterations;
+
     // The number of inputs this frame is still waiting.
     int num_pending_inputs = 0;
 
@@ -287,6 +311,11 @@ class PropagatorState {
     IterationState** const iterations_raw TF_GUARDED_BY(mu);
     IterationState* iterations_first TF_GUARDED_BY(mu);
 
+    // Finished iteration states available for reuse, if `pool_iterations`.
+    // At most `max_parallel_iterations + 1` states are live at once, which
+    // bounds the size of this list.
+    std::vector<IterationState*> free_iterations TF_GUARDED_BY(mu);
+
    public:
     // The NextIteration nodes to enter a new iteration. If the number of
     // outstanding iterations reaches the limit, we will defer the start of
@@ -308,6 +337,7 @@ class PropagatorState {
     std::vector<const NodeItem*> dead_exits TF_GUARDED_BY(iter_mu);
 
     // Static information specific to this frame.
+    const ImmutableExecutorState::FrameInfo* frame_info = nullptr;
     PendingCounts* pending_counts = nullptr;
     int total_input_tensors = 0;
     std::vector<const NodeItem*>* nodes = nullptr;
@@ -333,6 +363,19 @@ class PropagatorState {
 
     void SetIteration(int64_t iter, IterationState* state);
 
+    // Returns the state for a new iteration `iter_num`, recycling a finished
+    // iteration state if possible.
+    IterationState* NewIteration(int64_t iter_num)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+    // Destroys or, if `pool_iterations`, recycles a finished iteration state.
+    void ReleaseIteration(IterationState* iter_state)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+    // Prepares a finished frame for reuse as a new instance of the same loop.
+    // The iteration states of the frame are kept for reuse.
+    void Reset() TF_LOCKS_EXCLUDED(mu, iter_mu);
+
     // Adjust the outstanding op count by 'delta' and clean up the iterations in
     // the frame if no more ops are oustanding. Return true iff the execution of
     // the frame is done.
@@ -419,6 +462,9 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      for (IterationState* iter_state : free_iterations) {
+        delete iter_state;
+      }
     }
 
    private:
@@ -521,6 +567,11 @@ class PropagatorState {
   // Delete a frame. Called when the frame is done.
   void DeleteFrame(FrameState* frame, TaggedNodeSeq* ready);
 
+  // Returns a frame for a new instance of the loop described by `frame_info`,
+  // recycling a finished frame of the same loop when
+  // `pool_control_flow_state_` is true.
+  FrameState* NewFrame(const ImmutableExecutorState::FrameInfo& frame_info);
+
   // Cleanup frames and iterations starting from frame/iter. Called when
   // a child frame is done.
   void CleanupFramesIterations(FrameState* frame, IterationState* iter_state,
@@ -533,6 +584,11 @@ class PropagatorState {
   const int64_t step_id_;
   const bool vlog_;
 
+  // If true, the states of finished frames and iterations are kept until the
+  // end of the step and reused, instead of being freed and reallocated. See
+  // `LocalExecutorParams::pool_control_flow_state`.
+  const bool pool_control_flow_state_;
+
   mutex mu_;
 
   // The root frame in which the execution of this step is started.
@@ -546,6 +602,12 @@ class PropagatorState {
   absl::flat_hash_map<uint64, FrameState*> outstanding_frames_
       TF_GUARDED_BY(mu_);
 
+  // Finished frames available for reuse, keyed by the loop they belong to.
+  // Only used if `pool_control_flow_state_` is true.
+  absl::flat_hash_map<const ImmutableExecutorState::FrameInfo*,
+                      std::vector<FrameState*>>
+      free_frames_ TF_GUARDED_BY(mu_);
+
   PropagatorState(const PropagatorState&) = delete;
   void operator=(const PropagatorState&) = delete;
 };
@@ -29,10 +29,13 @@ namespace tensorflow {
 // session.
 class RenamedDevice : public Device {
  public:
+  // If `allocator` is not null, it serves the allocations of the device which
+  // do not need to be accessible from another device. It is not owned.
   static std::unique_ptr<Device> NewRenamedDevice(
       const string& new_base, Device* underlying, bool owns_underlying,
       bool isolate_session_state,
-      thread::ThreadPoolInterface* underlying_threadpool = nullptr);
+      thread::ThreadPoolInterface* underlying_threadpool = nullptr,
+      Allocator* allocator = nullptr);
 
   ~RenamedDevice() override;
 
@@ -56,6 +59,10 @@ class RenamedDevice : public Device {
   }
 
   Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (allocator_ != nullptr && !attr.gpu_compatible() &&
+        !attr.nic_compatible()) {
+      return allocator_;
+    }
     return underlying_device_->GetAllocator(attr);
   }
 
@@ -157,10 +164,12 @@ class RenamedDevice : public Device {
  private:
   RenamedDevice(Device* underlying, const DeviceAttributes& attributes,
                 bool owns_underlying, bool isolate_session_state,
-                thread::ThreadPoolInterface* underlying_threadpool);
+                thread::ThreadPoolInterface* underlying_threadpool,
+                Allocator* allocator);
   Device* const underlying_device_;
   const bool owns_underlying_device_;
   const bool isolate_session_state_;
+  Allocator* const allocator_;
 
   std::unique_ptr<thread::ThreadPool> underlying_threadpool_;
   // eigen_worker_threads_ is stored here so that we can pass the pointer
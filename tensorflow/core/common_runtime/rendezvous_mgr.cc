@@ -109,8 +109,10 @@ void SameWorkerRecvDone(const DeviceMgr* device_mgr,
          DeviceFactory::IsPluggableDevice(parsed.dst.type)) &&
         safe_alloc_frontier > 0) {
       // There's a timestamped allocator at work, so use it instead
-      // of sync_dst_compute.
+      // of sync_dst_compute, unless memory still pending on the compute
+      // stream has to be reused.
       aa.freed_by_func = &freed_by_func;
+      aa.reused_pending_memory = &sync_dst_compute;
       sync_dst_compute = false;
     }
     Tensor copy(out_allocator, in.dtype(), in.shape(), aa);
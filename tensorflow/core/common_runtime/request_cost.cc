@@ -39,6 +39,12 @@ absl::flat_hash_map<std::string, absl::Duration> RequestCost::GetCosts() const {
   return cost_map_;
 }
 
+absl::Duration RequestCost::GetCost(absl::string_view cost_type) const {
+  absl::MutexLock lock(&mutex_);
+  auto it = cost_map_.find(cost_type);
+  return it == cost_map_.end() ? absl::ZeroDuration() : it->second;
+}
+
 void RequestCost::RecordBatchMetrics(const BatchMetrics& batch_metrics) {
   absl::MutexLock lock(&mutex_);
   batch_metrics_.push_back(batch_metrics);
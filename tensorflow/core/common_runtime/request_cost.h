@@ -42,6 +42,10 @@ class RequestCost {
   // rpc request, when all the costs have been collected.
   absl::flat_hash_map<std::string, absl::Duration> GetCosts() const;
 
+  // Gets the cost of `cost_type`, e.g. one of the types in cost_constants.h,
+  // or zero if it wasn't recorded. It's thread-safe.
+  absl::Duration GetCost(absl::string_view cost_type) const;
+
   // Metrics of each batch that processes this rpc request.
   struct BatchMetrics {
     // Size of the batch.
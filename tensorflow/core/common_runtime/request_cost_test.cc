@@ -51,6 +51,17 @@ TEST(RequestCostTest, RecordCost) {
                                    Pair("cpu_v2", absl::Milliseconds(44))));
 }
 
+TEST(RequestCostTest, GetCost) {
+  RequestCost request_cost;
+
+  request_cost.RecordCost({{"executor_ops", absl::Milliseconds(1)},
+                           {"tf_data", absl::Milliseconds(2)}});
+  request_cost.RecordCost({{"executor_ops", absl::Milliseconds(10)}});
+  EXPECT_EQ(request_cost.GetCost("executor_ops"), absl::Milliseconds(11));
+  EXPECT_EQ(request_cost.GetCost("tf_data"), absl::Milliseconds(2));
+  EXPECT_EQ(request_cost.GetCost("xla_executable"), absl::ZeroDuration());
+}
+
 TEST(RequestCostTest, RecordBatchMetrics) {
   RequestCost request_cost;
 
@@ -15,18 +15,23 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/single_threaded_executor.h"
 
+#include <atomic>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/static_memory_arena.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -145,6 +150,8 @@ class SingleThreadedExecutorImpl : public Executor {
         nodes_with_kernels.push_back(n);
         KernelState& kernel_state = kernels_[kernel_index];
         kernel_state.kernel = kernel;
+        kernel_state.is_async = kernel->AsAsync() != nullptr;
+        has_async_kernels_ |= kernel_state.is_async;
         kernel_state.num_inputs = n->num_inputs();
         kernel_state.num_outputs = n->num_outputs();
         node_to_index_map[n] = kernel_index;
@@ -218,6 +225,17 @@ class SingleThreadedExecutorImpl : public Executor {
         }
       }
 
+      // Without asynchronous kernels, the kernels run in topological order
+      // and do not need to track their dependencies.
+      if (has_async_kernels_) {
+        for (const Edge* e : n->out_edges()) {
+          auto it = node_to_index_map.find(e->dst());
+          if (it != node_to_index_map.end()) {
+            kernel_state.successors.push_back(it->second);
+          }
+        }
+      }
+
       // Compute allocator attributes for each node output, and corresponding
       // node input.
       kernel_state.output_alloc_attrs.resize(kernel_state.num_outputs);
@@ -235,6 +253,15 @@ class SingleThreadedExecutorImpl : public Executor {
       }
     }
 
+    if (has_async_kernels_) {
+      initial_pending_counts_.resize(kernels_.size(), 0);
+      for (const KernelState& kernel_state : kernels_) {
+        for (size_t successor : kernel_state.successors) {
+          ++initial_pending_counts_[successor];
+        }
+      }
+    }
+
     if (!kernels_.empty()) {
       const KernelState& last_kernel_state = kernels_.back();
       total_num_inputs_ =
@@ -251,10 +278,73 @@ class SingleThreadedExecutorImpl : public Executor {
     } else {
       total_num_inputs_ = 0;
     }
+
+    if (params_.use_static_memory_arena) {
+      if (has_async_kernels_ || params_.device->device_type() != DEVICE_CPU) {
+        VLOG(1) << "Not using a static memory arena for a graph with "
+                   "asynchronous kernels or on a non-CPU device";
+      } else {
+        static_memory_allocator_ =
+            params_.device->GetAllocator(AllocatorAttributes());
+      }
+    }
     return OkStatus();
   }
 
   Status Run(const Args& args) override {
+    if (static_memory_allocator_ == nullptr) return RunInternal(args, nullptr);
+
+    StaticMemoryRecorder* recorder = nullptr;
+    StaticMemoryArena* arena = nullptr;
+    {
+      mutex_lock l(static_memory_mu_);
+      if (static_memory_plan_ != nullptr) {
+        arena = new StaticMemoryArena(static_memory_plan_,
+                                      static_memory_allocator_);
+      } else if (!recording_static_memory_ && num_static_memory_plans_ > 0) {
+        // Only one step records its allocations at a time, the concurrent
+        // steps use the device allocator.
+        recording_static_memory_ = true;
+        --num_static_memory_plans_;
+        recorder = new StaticMemoryRecorder(static_memory_allocator_);
+      }
+    }
+    Status s = RunInternal(
+        args, arena != nullptr ? static_cast<Allocator*>(arena) : recorder);
+
+    if (recorder != nullptr) {
+      std::vector<StaticMemoryLifetime> lifetimes =
+          recorder->GetLifetimesAndUnRef();
+      std::shared_ptr<const StaticMemoryPlan> plan;
+      if (s.ok()) {
+        plan = std::make_shared<const StaticMemoryPlan>(
+            PlanStaticMemory(lifetimes));
+        VLOG(1) << "Planned " << lifetimes.size()
+                << " allocations in a static memory arena of "
+                << plan->arena_size << " bytes";
+      }
+      mutex_lock l(static_memory_mu_);
+      recording_static_memory_ = false;
+      if (plan != nullptr) {
+        static_memory_plan_ = std::move(plan);
+      } else {
+        ++num_static_memory_plans_;
+      }
+    }
+    if (arena != nullptr && !arena->FollowedPlanAndUnRef()) {
+      mutex_lock l(static_memory_mu_);
+      VLOG(1) << "A step did not follow the static memory plan, "
+              << (num_static_memory_plans_ > 0 ? "planning again"
+                                               : "not planning anymore");
+      static_memory_plan_.reset();
+    }
+    return s;
+  }
+
+ private:
+  // Runs a step, with the allocations of the kernels which do not need to be
+  // accessible from another device served by `allocator` if it is not null.
+  Status RunInternal(const Args& args, Allocator* allocator) {
     // The inputs to each kernel are stored contiguously in `inputs`.
     //
     // We use `kernels_[i].input_start_index` and `kernels_[i].num_inputs` to
@@ -298,10 +388,11 @@ class SingleThreadedExecutorImpl : public Executor {
     // Override intra op thread pool if requested.
     Device* device = params_.device;
     std::unique_ptr<Device> user_device;
-    if (args.user_intra_op_threadpool != nullptr) {
+    if (args.user_intra_op_threadpool != nullptr || allocator != nullptr) {
       user_device = RenamedDevice::NewRenamedDevice(
           device->name(), device, /*owns_underlying=*/false,
-          /*isolate_session_state=*/false, args.user_intra_op_threadpool);
+          /*isolate_session_state=*/false, args.user_intra_op_threadpool,
+          allocator);
       device = user_device.get();
     }
 
@@ -404,87 +495,328 @@ class SingleThreadedExecutorImpl : public Executor {
       }
     }
 
+    if (has_async_kernels_) {
+      return RunWithAsyncKernels(args, &params, device, &inputs);
+    }
+
     // Execute the kernels one-at-a-time in topological order.
     for (size_t i = 0; i < kernels_.size(); ++i) {
       const KernelState& kernel_state = kernels_[i];
 
       // Prepare the per-kernel parameters.
-      const size_t input_start_index = kernel_state.input_start_index;
-      const size_t num_inputs = kernel_state.num_inputs;
-      const size_t num_outputs = kernel_state.num_outputs;
-
-      node_inputs.clear();
-      node_inputs.resize(num_inputs);
-      input_alloc_attrs.clear();
-      input_alloc_attrs.resize(num_inputs);
-      for (size_t j = 0; j < num_inputs; ++j) {
-        Entry& input = inputs[input_start_index + j];
-        switch (input.state) {
-          case Entry::State::HAS_CONST_TENSOR:
-            // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
-            // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
-            // accessors making dynamic checks that prevent using an immutable
-            // tensor as a mutable tensor.
-            node_inputs[j].tensor = const_cast<Tensor*>(input.const_tensor);
-            break;
-          case Entry::State::HAS_VALUE:
-            node_inputs[j].tensor = input.val.get();
-            break;
-          default:
-            DCHECK(false) << "Input did not have a valid value.";
-        }
-        input_alloc_attrs[j] = input_alloc_attrs_[input_start_index + j];
-      }
+      PrepareInputs(kernel_state, &inputs, &node_inputs, &input_alloc_attrs);
       params.inputs = node_inputs;
       params.input_alloc_attrs = input_alloc_attrs;
       params.op_kernel = kernel_state.kernel;
       params.output_attr_array = kernel_state.output_alloc_attrs.data();
-      OpKernelContext ctx(&params, num_outputs);
+      OpKernelContext ctx(&params, kernel_state.num_outputs);
 
       // Actually execute the kernel.
       device->Compute(kernel_state.kernel, &ctx);
       TF_RETURN_IF_ERROR(ctx.status());
 
-      // Free the inputs to the current kernel.
-      for (size_t j = 0; j < num_inputs; ++j) {
-        inputs[input_start_index + j].ClearVal();
+      ProcessOutputs(kernel_state, &ctx, &inputs);
+    }
+    return OkStatus();
+  }
+
+  struct KernelState;
+
+  // Holds the context of an asynchronous kernel, which must outlive the call
+  // to `ComputeAsync()`.
+  struct AsyncState {
+    AsyncState(const OpKernelContext::Params& p, size_t _kernel_index,
+               size_t num_outputs)
+        : saved_inputs(p.inputs.begin(), p.inputs.end()),
+          saved_input_alloc_attrs(p.input_alloc_attrs.begin(),
+                                  p.input_alloc_attrs.end()),
+          params(p),
+          kernel_index(_kernel_index),
+          // ParamsButClearingEigenGPUDevice does equivalent of
+          //   params.eigen_gpu_device = nullptr;
+          ctx(ParamsButClearingEigenGPUDevice(&params), num_outputs) {
+      params.inputs = saved_inputs;
+      params.input_alloc_attrs = saved_input_alloc_attrs;
+    }
+
+    TensorValueVec saved_inputs;
+    AllocatorAttributeVec saved_input_alloc_attrs;
+    OpKernelContext::Params params;
+    const size_t kernel_index;
+    OpKernelContext ctx;
+
+    // The next element of the `CompletionQueue` that holds this state.
+    AsyncState* next = nullptr;
+
+   private:
+    OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
+        OpKernelContext::Params* p) {
+      // Ensure OpKernelContext constructor will make a new eigen GPU device if
+      // necessary.
+      p->eigen_gpu_device = nullptr;  // Force allocation
+      return p;
+    }
+  };
+
+  // A multi-producer, single-consumer queue of completed asynchronous kernels.
+  // The done callbacks of the kernels push onto a lock-free stack, and the
+  // executor thread takes all completed kernels at once between synchronous
+  // kernels. A mutex is only taken when the executor thread has nothing left
+  // to run and must block for a completion.
+  class CompletionQueue {
+   public:
+    CompletionQueue() = default;
+
+    // Waits for the producers that are still inside `Push()` to return. This
+    // is typically immediate, because the consumer has already observed the
+    // pushed elements.
+    ~CompletionQueue() {
+      while (num_pending_pushes_.load(std::memory_order_acquire) != 0) {
       }
+    }
 
-      // Forward the outputs of the kernel to the inputs of subsequent kernels.
-      for (size_t j = 0; j < num_outputs; ++j) {
-        TensorValue val = ctx.release_output(j);
-        const size_t num_destinations = kernel_state.output_locations[j].size();
-        if (num_destinations > 0) {
-          // TODO(mrry): Consider flattening the `output_locations` vector
-          // to improve the cache-friendliness of this loop.
-          for (size_t k = 0; k < num_destinations - 1; ++k) {
-            // TODO(mrry): Validate that the types match the expected values or
-            // ensure that the necessary validation has already happened.
-            Entry& input = inputs[kernel_state.output_locations[j][k]];
-            input.state = Entry::State::HAS_VALUE;
-            if (val.tensor != nullptr) {
-              input.val.Init(*val.tensor);
-            } else {
-              input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
-            }
-          }
-          // Move `arg` to the last consumer to avoid the cost of copying it.
-          Entry& input =
-              inputs[kernel_state.output_locations[j][num_destinations - 1]];
+    // Must be called once before each asynchronous kernel is started.
+    void ExpectPush() {
+      num_pending_pushes_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Push(AsyncState* state) {
+      AsyncState* head = head_.load(std::memory_order_relaxed);
+      do {
+        state->next = head;
+      } while (!head_.compare_exchange_weak(head, state));
+      if (consumer_waiting_.load()) {
+        mutex_lock l(mu_);
+        cond_var_.notify_one();
+      }
+      // NOTE: This must be the last access to `this`.
+      num_pending_pushes_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Returns the completed kernels in completion order, or nullptr if there
+    // are none.
+    AsyncState* PopAll() {
+      if (head_.load(std::memory_order_relaxed) == nullptr) return nullptr;
+      return Reverse(head_.exchange(nullptr, std::memory_order_acquire));
+    }
+
+    // Like `PopAll()`, but blocks until at least one kernel completes.
+    AsyncState* WaitAndPopAll() {
+      AsyncState* head = head_.exchange(nullptr, std::memory_order_acquire);
+      if (head == nullptr) {
+        mutex_lock l(mu_);
+        consumer_waiting_.store(true);
+        while ((head = head_.exchange(nullptr)) == nullptr) {
+          cond_var_.wait(l);
+        }
+        consumer_waiting_.store(false);
+      }
+      return Reverse(head);
+    }
+
+   private:
+    static AsyncState* Reverse(AsyncState* head) {
+      AsyncState* reversed = nullptr;
+      while (head != nullptr) {
+        AsyncState* next = head->next;
+        head->next = reversed;
+        reversed = head;
+        head = next;
+      }
+      return reversed;
+    }
+
+    std::atomic<AsyncState*> head_{nullptr};
+    std::atomic<bool> consumer_waiting_{false};
+    std::atomic<int64_t> num_pending_pushes_{0};
+    mutex mu_;
+    condition_variable cond_var_;
+
+    CompletionQueue(const CompletionQueue&) = delete;
+    void operator=(const CompletionQueue&) = delete;
+  };
+
+  // Fills `node_inputs` and `input_alloc_attrs` with the inputs of the kernel
+  // described by `kernel_state`.
+  void PrepareInputs(const KernelState& kernel_state,
+                     std::vector<Entry>* inputs, TensorValueVec* node_inputs,
+                     AllocatorAttributeVec* input_alloc_attrs) const {
+    const size_t input_start_index = kernel_state.input_start_index;
+    const size_t num_inputs = kernel_state.num_inputs;
+
+    node_inputs->clear();
+    node_inputs->resize(num_inputs);
+    input_alloc_attrs->clear();
+    input_alloc_attrs->resize(num_inputs);
+    for (size_t j = 0; j < num_inputs; ++j) {
+      Entry& input = (*inputs)[input_start_index + j];
+      switch (input.state) {
+        case Entry::State::HAS_CONST_TENSOR:
+          // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
+          // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
+          // accessors making dynamic checks that prevent using an immutable
+          // tensor as a mutable tensor.
+          (*node_inputs)[j].tensor = const_cast<Tensor*>(input.const_tensor);
+          break;
+        case Entry::State::HAS_VALUE:
+          (*node_inputs)[j].tensor = input.val.get();
+          break;
+        default:
+          DCHECK(false) << "Input did not have a valid value.";
+      }
+      (*input_alloc_attrs)[j] = input_alloc_attrs_[input_start_index + j];
+    }
+  }
+
+  // Frees the inputs of the kernel described by `kernel_state`, and forwards
+  // its outputs in `ctx` to the inputs of subsequent kernels.
+  void ProcessOutputs(const KernelState& kernel_state, OpKernelContext* ctx,
+                      std::vector<Entry>* inputs) const {
+    // Free the inputs to the current kernel.
+    for (size_t j = 0; j < kernel_state.num_inputs; ++j) {
+      (*inputs)[kernel_state.input_start_index + j].ClearVal();
+    }
+
+    // Forward the outputs of the kernel to the inputs of subsequent kernels.
+    for (size_t j = 0; j < kernel_state.num_outputs; ++j) {
+      TensorValue val = ctx->release_output(j);
+      const size_t num_destinations = kernel_state.output_locations[j].size();
+      if (num_destinations > 0) {
+        // TODO(mrry): Consider flattening the `output_locations` vector
+        // to improve the cache-friendliness of this loop.
+        for (size_t k = 0; k < num_destinations - 1; ++k) {
+          // TODO(mrry): Validate that the types match the expected values or
+          // ensure that the necessary validation has already happened.
+          Entry& input = (*inputs)[kernel_state.output_locations[j][k]];
           input.state = Entry::State::HAS_VALUE;
           if (val.tensor != nullptr) {
-            input.val.Init(std::move(*val.tensor));
+            input.val.Init(*val.tensor);
           } else {
             input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
           }
         }
-        delete val.tensor;
+        // Move `arg` to the last consumer to avoid the cost of copying it.
+        Entry& input =
+            (*inputs)[kernel_state.output_locations[j][num_destinations - 1]];
+        input.state = Entry::State::HAS_VALUE;
+        if (val.tensor != nullptr) {
+          input.val.Init(std::move(*val.tensor));
+        } else {
+          input.val.Init(Tensor(kernel_state.kernel->output_type(j)));
+        }
       }
+      delete val.tensor;
     }
-    return OkStatus();
   }
 
- private:
+  // Executes the kernels of a graph that contains asynchronous kernels, in
+  // dependency order. Rather than blocking the calling thread until an
+  // asynchronous kernel is done, this starts the kernel as soon as it is ready
+  // and continues to execute the ready synchronous kernels, draining the
+  // completed asynchronous kernels between them.
+  Status RunWithAsyncKernels(const Args& args, OpKernelContext::Params* params,
+                             Device* device, std::vector<Entry>* inputs) {
+    std::vector<int> pending_counts(initial_pending_counts_);
+    // Asynchronous kernels are kept apart so that they are started before the
+    // ready synchronous kernels, which maximizes the overlap between them.
+    std::vector<size_t> ready_sync;
+    std::vector<size_t> ready_async;
+    auto mark_ready = [this, &ready_sync, &ready_async](size_t i) {
+      (kernels_[i].is_async ? ready_async : ready_sync).push_back(i);
+    };
+    // The ready kernels are popped from the back, so push the initially ready
+    // kernels in reverse to execute them in topological order.
+    for (size_t i = kernels_.size(); i > 0; --i) {
+      if (pending_counts[i - 1] == 0) mark_ready(i - 1);
+    }
+    auto propagate = [&pending_counts, &mark_ready](
+                         const KernelState& kernel_state) {
+      for (size_t successor : kernel_state.successors) {
+        if (--pending_counts[successor] == 0) mark_ready(successor);
+      }
+    };
+
+    CompletionQueue completion_queue;
+    size_t num_outstanding = 0;
+    Status status;
+    // Processes a list of completed kernels returned by `completion_queue`.
+    auto process_completed = [this, inputs, &num_outstanding, &status,
+                              &propagate](AsyncState* state) {
+      while (state != nullptr) {
+        AsyncState* next = state->next;
+        --num_outstanding;
+        if (status.ok()) {
+          status = state->ctx.status();
+          if (status.ok()) {
+            const KernelState& kernel_state = kernels_[state->kernel_index];
+            ProcessOutputs(kernel_state, &state->ctx, inputs);
+            propagate(kernel_state);
+          }
+        }
+        delete state;
+        state = next;
+      }
+    };
+
+    TensorValueVec node_inputs;
+    AllocatorAttributeVec input_alloc_attrs;
+    while (status.ok()) {
+      if (!ready_async.empty()) {
+        const size_t i = ready_async.back();
+        ready_async.pop_back();
+        const KernelState& kernel_state = kernels_[i];
+        PrepareInputs(kernel_state, inputs, &node_inputs, &input_alloc_attrs);
+        params->inputs = node_inputs;
+        params->input_alloc_attrs = input_alloc_attrs;
+        params->op_kernel = kernel_state.kernel;
+        params->output_attr_array = kernel_state.output_alloc_attrs.data();
+        AsyncState* state =
+            new AsyncState(*params, i, kernel_state.num_outputs);
+        ++num_outstanding;
+        completion_queue.ExpectPush();
+        device->ComputeAsync(
+            kernel_state.kernel->AsAsync(), &state->ctx,
+            [&completion_queue, state]() { completion_queue.Push(state); });
+      } else if (!ready_sync.empty()) {
+        const size_t i = ready_sync.back();
+        ready_sync.pop_back();
+        const KernelState& kernel_state = kernels_[i];
+        PrepareInputs(kernel_state, inputs, &node_inputs, &input_alloc_attrs);
+        params->inputs = node_inputs;
+        params->input_alloc_attrs = input_alloc_attrs;
+        params->op_kernel = kernel_state.kernel;
+        params->output_attr_array = kernel_state.output_alloc_attrs.data();
+        OpKernelContext ctx(params, kernel_state.num_outputs);
+        device->Compute(kernel_state.kernel, &ctx);
+        status = ctx.status();
+        if (status.ok()) {
+          ProcessOutputs(kernel_state, &ctx, inputs);
+          propagate(kernel_state);
+        }
+        if (num_outstanding > 0) {
+          process_completed(completion_queue.PopAll());
+        }
+      } else if (num_outstanding > 0) {
+        process_completed(completion_queue.WaitAndPopAll());
+      } else {
+        break;
+      }
+    }
+
+    if (num_outstanding > 0) {
+      // As in the default executor, abort the rendezvous so that pending
+      // receives fail fast, then wait for the outstanding kernels because
+      // they borrow state from this call.
+      if (args.rendezvous != nullptr) {
+        args.rendezvous->StartAbort(status);
+      }
+      while (num_outstanding > 0) {
+        process_completed(completion_queue.WaitAndPopAll());
+      }
+    }
+    return status;
+  }
+
   // Execute all operations in the calling thread when asynchronous execution
   // is requested. Callers may expect to perform expensive work in the calling
   // thread even when the execution itself is single-threaded.
@@ -498,6 +830,10 @@ class SingleThreadedExecutorImpl : public Executor {
 
   // All following members are read-only after Initialize().
 
+  // True if any kernel in `kernels_` is an AsyncOpKernel, in which case the
+  // kernels are executed using `RunWithAsyncKernels()`.
+  bool has_async_kernels_ = false;
+
   // The sum of the number of inputs for each node in the graph. This determines
   // the length of the flat `inputs` vector. See comment at the beginning of
   // `RunAsync()` for details.
@@ -527,9 +863,20 @@ class SingleThreadedExecutorImpl : public Executor {
     // Memory space information for each output of `kernel`.
     std::vector<AllocatorAttributes>
         output_alloc_attrs;  // Length = `num_outputs`.
+
+    // True if `kernel` is an AsyncOpKernel.
+    bool is_async;
+
+    // The index in `kernels_` of the destination of each data or control edge
+    // out of `kernel`. Only populated if `has_async_kernels_` is true.
+    std::vector<size_t> successors;
   };
   std::vector<KernelState> kernels_;
 
+  // For each kernel, the number of edges into it from other kernels in
+  // `kernels_`. Only populated if `has_async_kernels_` is true.
+  std::vector<int> initial_pending_counts_;
+
   // For the `i`th argument, `arg_output_locations_[i]` contains the locations
   // in the flat `inputs` vector to which that argument must be copied.
   std::vector<std::vector<size_t>>
@@ -567,6 +914,24 @@ class SingleThreadedExecutorImpl : public Executor {
   // `RunAsync()` for details.
   std::vector<AllocatorAttributes>
       input_alloc_attrs_;  // Length = `total_num_inputs_`.
+
+  // The device allocator whose allocations are served from a static memory
+  // arena, or null if `params_.use_static_memory_arena` is false or not
+  // supported for the graph.
+  Allocator* static_memory_allocator_ = nullptr;
+
+  // Graphs whose allocations change between steps, e.g. because their shapes
+  // do, stop being planned after a few plans.
+  static constexpr int kMaxStaticMemoryPlans = 3;
+
+  // Unlike the members above, the static memory planning state changes
+  // between steps.
+  mutex static_memory_mu_;
+  bool recording_static_memory_ TF_GUARDED_BY(static_memory_mu_) = false;
+  int num_static_memory_plans_ TF_GUARDED_BY(static_memory_mu_) =
+      kMaxStaticMemoryPlans;
+  std::shared_ptr<const StaticMemoryPlan> static_memory_plan_
+      TF_GUARDED_BY(static_memory_mu_);
 };
 
 class SingleThreadedExecutorRegistrar {
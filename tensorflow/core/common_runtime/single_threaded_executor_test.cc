@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
@@ -90,6 +91,7 @@ class ExecutorTest : public ::testing::Test {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
+    params.use_static_memory_arena = use_static_memory_arena_;
     params.create_kernel =
         [this, mock_fn = std::move(mock_fn), version](
             const std::shared_ptr<const NodeProperties>& props,
@@ -110,6 +112,8 @@ class ExecutorTest : public ::testing::Test {
     rendez_ = NewLocalRendezvous();
   }
 
+  bool use_static_memory_arena_ = false;
+
   Status Run(Rendezvous* rendez) {
     Executor::Args args;
     args.rendezvous = rendez;
@@ -181,6 +185,9 @@ Rendezvous::ParsedKey Key(const string& sender, const uint64 incarnation,
   return result;
 }
 
+#define ALICE "/job:j/replica:0/task:0/cpu:0"
+#define BOB "/job:j/replica:0/task:0/gpu:0"
+
 TEST_F(ExecutorTest, UserIntraOpThreadPool) {
   class DummyThreadPool : public thread::ThreadPoolInterface {
    public:
@@ -277,6 +284,91 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(retvals[0]));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+TEST_F(ExecutorTest, StaticMemoryArena) {
+  // The first step records the allocations of the intermediate values, and
+  // the following steps allocate them from the planned arena.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto v = test::graph::Arg(g.get(), 0, DT_FLOAT);
+  for (int i = 1; i <= 10; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Retval(g.get(), 0, v);
+  FixupSourceAndSinkEdges(g.get());
+  use_static_memory_arena_ = true;
+  Create(std::move(g));
+  std::vector<Tensor> retvals;
+  for (int step = 0; step < 3; ++step) {
+    FunctionCallFrame call_frame({DT_FLOAT}, {DT_FLOAT});
+    TF_ASSERT_OK(call_frame.SetArgs({V(step + 1.0)}));
+    TF_ASSERT_OK(Run(&call_frame));
+    TF_ASSERT_OK(call_frame.ConsumeRetvals(&retvals, false));
+    EXPECT_EQ(1024.0 * (step + 1), V(retvals[0]));
+  }
+}
+
+TEST_F(ExecutorTest, AsyncRecv) {
+  // c = a + b, where a and b are received asynchronously.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Recv(g.get(), "b", "float", ALICE, 1, BOB);
+  auto tmp = test::graph::Add(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, 1, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, 1, BOB, "b"), args, V(2.0), false));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out;
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, 1, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_FALSE(is_dead);
+  EXPECT_EQ(3.0, V(out));  // out = 1.0 + 2.0 = 3.0
+}
+
+TEST_F(ExecutorTest, AsyncRecvOverlapsSyncKernels) {
+  // The synchronous chain v1 = c + c, ..., v10 = v9 + v9 does not depend on
+  // the Recv of a, and runs while the executor waits for a.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto a = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto v = test::graph::Constant(g.get(), V(1.0));
+  const int N = 10;
+  for (int i = 1; i <= N; ++i) {
+    v = test::graph::Add(g.get(), v, v);
+  }
+  test::graph::Send(g.get(), test::graph::Add(g.get(), a, v), "b", BOB, 1,
+                    ALICE);
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  std::unique_ptr<Thread> sender(Env::Default()->StartThread(
+      ThreadOptions(), "sender", [this]() {
+        Env::Default()->SleepForMicroseconds(10000);
+        TF_CHECK_OK(rendez_->Send(Key(ALICE, 1, BOB, "a"), Rendezvous::Args(),
+                                  V(1.0), false));
+      }));
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out;
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(Key(BOB, 1, ALICE, "b"), Rendezvous::Args(),
+                             &out, &is_dead));
+  EXPECT_EQ(1025.0, V(out));  // out = 1.0 + 1024 * 1.0
+}
+
+TEST_F(ExecutorTest, OpErrorWithPendingAsyncRecv) {
+  // The Recv of a never completes on its own: the executor must abort the
+  // rendezvous when the independent CheckNumerics fails.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto a = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  test::graph::Send(g.get(), a, "b", BOB, 1, ALICE);
+  auto zero = test::graph::Constant(g.get(), V(0.0));
+  auto inf = test::graph::Unary(g.get(), "Reciprocal", zero);
+  test::graph::CheckNumerics(g.get(), inf, "message");
+  FixupSourceAndSinkEdges(g.get());
+  Create(std::move(g));
+  EXPECT_TRUE(absl::IsInvalidArgument(Run(rendez_)));
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -357,10 +449,11 @@ TEST_F(ExecutorTest, ControlDependenciesFromSpecialNodes) {
   EXPECT_EQ(3.0, V(retvals[0]));  // out = 1.0 + 2.0 = 3.0
 }
 
-void BM_executor(::testing::benchmark::State& state) {
-  const int width = state.range(0);
-  const int depth = state.range(1);
-
+// Builds a random graph of NoOps that is `width` wide and `depth` deep. Sets
+// `*num_nodes` to the number of nodes in the graph, and appends the nodes that
+// have no inputs to `*roots`.
+Graph* BuildRandomNoOpGraph(int width, int depth, uint64* num_nodes,
+                            std::vector<Node*>* roots) {
   Graph* g = new Graph(OpRegistry::Global());
   random::PhiloxRandom philox(1729, 17);
   random::SimplePhilox rand(&philox);
@@ -371,6 +464,7 @@ void BM_executor(::testing::benchmark::State& state) {
     ready_nodes.push_back(test::graph::NoOp(g, {}));
     ++cur;
   }
+  roots->insert(roots->end(), ready_nodes.begin(), ready_nodes.end());
   std::random_device random_device;
   std::mt19937 rng(random_device());
   for (int i = 0; i < depth; ++i) {
@@ -389,6 +483,17 @@ void BM_executor(::testing::benchmark::State& state) {
       ++cur;
     }
   }
+  *num_nodes = cur;
+  return g;
+}
+
+void BM_executor(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+
+  uint64 cur = 0;
+  std::vector<Node*> roots;
+  Graph* g = BuildRandomNoOpGraph(width, depth, &cur, &roots);
   FixupSourceAndSinkEdges(g);
   test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
                   "SINGLE_THREADED_EXECUTOR", /*old_benchmark_api=*/false)
@@ -408,6 +513,37 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+// Like BM_executor, but every node depends on an asynchronous Recv, which
+// makes the executor track the dependencies of the nodes at runtime. Comparing
+// the two measures the per-node cost of supporting asynchronous kernels.
+void BM_executor_with_async_input(::testing::benchmark::State& state) {
+  const int width = state.range(0);
+  const int depth = state.range(1);
+
+  uint64 cur = 0;
+  std::vector<Node*> roots;
+  Graph* g = BuildRandomNoOpGraph(width, depth, &cur, &roots);
+  Node* recv = test::graph::Recv(g, "a", "float", ALICE, 1, BOB);
+  for (Node* root : roots) {
+    g->AddControlEdge(recv, root);
+  }
+  Node* send = test::graph::Send(g, recv, "b", BOB, 1, ALICE);
+  cur += 2;
+  FixupSourceAndSinkEdges(g);
+  // Compute the keys before `g` is deleted by the Benchmark constructor.
+  const string recv_key = test::GetRendezvousKey(recv);
+  const string send_key = test::GetRendezvousKey(send);
+  test::Benchmark("cpu", g, nullptr, nullptr, nullptr,
+                  "SINGLE_THREADED_EXECUTOR", /*old_benchmark_api=*/false)
+      .RunWithRendezvousArgs({{recv_key, V(1.0)}}, {send_key}, state);
+  state.SetLabel(strings::StrCat("Nodes = ", cur));
+  state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_executor_with_async_input)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_executor_with_async_input)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_executor_with_async_input)->UseRealTime()->ArgPair(1024, 1024);
+
 void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
@@ -445,9 +581,6 @@ BENCHMARK(BM_const_identity)->UseRealTime()->ArgPair(100, 100);
 // TODO(mrry): Add support for Arg/Retval "function call convention" in
 // `test::Benchmark::RunWithArgs()`.
 #if 0
-#define ALICE "/job:j/replica:0/task:0/cpu:0"
-#define BOB "/job:j/replica:0/task:0/gpu:0"
-
 static void BM_FeedInputFetchOutput(::testing::benchmark::State& state) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
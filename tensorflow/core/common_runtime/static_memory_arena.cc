@@ -0,0 +1,236 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_arena.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Every buffer takes at least one aligned block, so that two buffers live at
+// the same time never have the same address.
+int64_t PaddedSize(int64_t size) {
+  constexpr int64_t kAlignment = Allocator::kAllocatorAlignment;
+  return std::max<int64_t>(1, (size + kAlignment - 1) / kAlignment) *
+         kAlignment;
+}
+
+bool LifetimesOverlap(const StaticMemoryLifetime& a,
+                      const StaticMemoryLifetime& b) {
+  return a.alloc_time < b.free_time && b.alloc_time < a.free_time;
+}
+
+}  // namespace
+
+StaticMemoryPlan PlanStaticMemory(
+    const std::vector<StaticMemoryLifetime>& lifetimes) {
+  StaticMemoryPlan plan;
+  plan.buffers.resize(lifetimes.size());
+  std::vector<int> order;
+  for (int i = 0; i < lifetimes.size(); ++i) {
+    plan.buffers[i].size = lifetimes[i].size;
+    if (lifetimes[i].free_time >= 0 &&
+        lifetimes[i].alignment <= Allocator::kAllocatorAlignment) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return lifetimes[a].size > lifetimes[b].size;
+  });
+
+  std::vector<int> placed;
+  std::vector<int> overlapping;
+  for (int i : order) {
+    overlapping.clear();
+    for (int j : placed) {
+      if (LifetimesOverlap(lifetimes[i], lifetimes[j])) {
+        overlapping.push_back(j);
+      }
+    }
+    std::sort(overlapping.begin(), overlapping.end(), [&](int a, int b) {
+      return plan.buffers[a].offset < plan.buffers[b].offset;
+    });
+    const int64_t size = PaddedSize(lifetimes[i].size);
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t end = 0;
+    for (int j : overlapping) {
+      const StaticMemoryPlan::Buffer& buffer = plan.buffers[j];
+      const int64_t gap = buffer.offset - end;
+      if (gap >= size && gap < best_gap) {
+        best_offset = end;
+        best_gap = gap;
+      }
+      end = std::max(end, buffer.offset + PaddedSize(buffer.size));
+    }
+    if (best_offset < 0) best_offset = end;
+    plan.buffers[i].offset = best_offset;
+    plan.arena_size = std::max(plan.arena_size, best_offset + size);
+    placed.push_back(i);
+  }
+
+  std::sort(placed.begin(), placed.end());
+  for (int a = 0; a < placed.size(); ++a) {
+    StaticMemoryPlan::Buffer& later = plan.buffers[placed[a]];
+    for (int b = 0; b < a; ++b) {
+      const StaticMemoryPlan::Buffer& earlier = plan.buffers[placed[b]];
+      if (earlier.offset < later.offset + PaddedSize(later.size) &&
+          later.offset < earlier.offset + PaddedSize(earlier.size)) {
+        later.reuses.push_back(placed[b]);
+      }
+    }
+  }
+  return plan;
+}
+
+StaticMemoryRecorder::StaticMemoryRecorder(Allocator* underlying)
+    : underlying_(underlying) {}
+
+void* StaticMemoryRecorder::AllocateRaw(size_t alignment, size_t num_bytes) {
+  void* ptr = underlying_->AllocateRaw(alignment, num_bytes);
+  mutex_lock lock(mu_);
+  StaticMemoryLifetime lifetime;
+  lifetime.size = num_bytes;
+  lifetime.alignment = alignment;
+  lifetime.alloc_time = time_++;
+  if (ptr != nullptr) {
+    ++ref_;
+    live_[ptr] = lifetimes_.size();
+  }
+  lifetimes_.push_back(lifetime);
+  return ptr;
+}
+
+void StaticMemoryRecorder::DeallocateRaw(void* ptr) {
+  bool should_delete;
+  {
+    mutex_lock lock(mu_);
+    auto it = live_.find(ptr);
+    if (it != live_.end()) {
+      lifetimes_[it->second].free_time = time_++;
+      live_.erase(it);
+    }
+    should_delete = UnRef();
+  }
+  underlying_->DeallocateRaw(ptr);
+  if (should_delete) delete this;
+}
+
+std::vector<StaticMemoryLifetime> StaticMemoryRecorder::GetLifetimesAndUnRef() {
+  std::vector<StaticMemoryLifetime> lifetimes;
+  bool should_delete;
+  {
+    mutex_lock lock(mu_);
+    lifetimes = lifetimes_;
+    should_delete = UnRef();
+  }
+  if (should_delete) delete this;
+  return lifetimes;
+}
+
+bool StaticMemoryRecorder::UnRef() {
+  CHECK_GE(ref_, 1);
+  --ref_;
+  return ref_ == 0;
+}
+
+StaticMemoryArena::StaticMemoryArena(
+    std::shared_ptr<const StaticMemoryPlan> plan, Allocator* underlying)
+    : plan_(std::move(plan)), underlying_(underlying) {
+  if (plan_->arena_size > 0) {
+    arena_ = static_cast<char*>(underlying_->AllocateRaw(
+        Allocator::kAllocatorAlignment, plan_->arena_size));
+  }
+  live_.resize(plan_->buffers.size());
+}
+
+StaticMemoryArena::~StaticMemoryArena() {
+  if (arena_ != nullptr) underlying_->DeallocateRaw(arena_);
+}
+
+void* StaticMemoryArena::AllocateRaw(size_t alignment, size_t num_bytes) {
+  {
+    mutex_lock lock(mu_);
+    const size_t i = next_++;
+    if (i >= plan_->buffers.size()) {
+      followed_plan_ = false;
+    } else if (plan_->buffers[i].offset >= 0 && arena_ != nullptr) {
+      const StaticMemoryPlan::Buffer& buffer = plan_->buffers[i];
+      bool ready = num_bytes <= buffer.size &&
+                   alignment <= Allocator::kAllocatorAlignment;
+      for (int j : buffer.reuses) ready &= !live_[j];
+      if (ready) {
+        void* ptr = arena_ + buffer.offset;
+        ++ref_;
+        live_[i] = true;
+        buffer_of_[ptr] = i;
+        return ptr;
+      }
+      followed_plan_ = false;
+    }
+  }
+  void* ptr = underlying_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    mutex_lock lock(mu_);
+    ++ref_;
+  }
+  return ptr;
+}
+
+void StaticMemoryArena::DeallocateRaw(void* ptr) {
+  const bool in_arena = arena_ != nullptr && ptr >= arena_ &&
+                        ptr < arena_ + plan_->arena_size;
+  bool should_delete;
+  {
+    mutex_lock lock(mu_);
+    if (in_arena) {
+      auto it = buffer_of_.find(ptr);
+      DCHECK(it != buffer_of_.end());
+      if (it != buffer_of_.end()) {
+        live_[it->second] = false;
+        buffer_of_.erase(it);
+      }
+    }
+    should_delete = UnRef();
+  }
+  if (!in_arena) underlying_->DeallocateRaw(ptr);
+  if (should_delete) delete this;
+}
+
+bool StaticMemoryArena::FollowedPlanAndUnRef() {
+  bool followed_plan;
+  bool should_delete;
+  {
+    mutex_lock lock(mu_);
+    followed_plan = followed_plan_;
+    should_delete = UnRef();
+  }
+  if (should_delete) delete this;
+  return followed_plan;
+}
+
+bool StaticMemoryArena::UnRef() {
+  CHECK_GE(ref_, 1);
+  --ref_;
+  return ref_ == 0;
+}
+
+}  // namespace tensorflow
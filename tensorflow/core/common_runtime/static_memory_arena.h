@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_ARENA_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_ARENA_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// The lifetime of the `i`th allocation of a step, in allocation and
+// deallocation events of the step. `free_time` is negative if the buffer was
+// not deallocated by the end of the step, e.g. because it is an output of the
+// step or is held by a resource.
+struct StaticMemoryLifetime {
+  int64_t size = 0;
+  size_t alignment = 0;
+  int64_t alloc_time = 0;
+  int64_t free_time = -1;
+};
+
+// Offsets of the buffers of a step in a single arena, such that buffers whose
+// lifetimes overlap do not share memory.
+struct StaticMemoryPlan {
+  struct Buffer {
+    int64_t size = 0;
+    // Negative if the allocation is not served from the arena.
+    int64_t offset = -1;
+    // The earlier buffers which share memory with this one, and must therefore
+    // have been deallocated before it is allocated.
+    std::vector<int> reuses;
+  };
+  std::vector<Buffer> buffers;
+  int64_t arena_size = 0;
+};
+
+// Places the buffers which are deallocated within the step like TFLite's
+// ArenaPlanner does: the largest first, each in the smallest gap between the
+// buffers already placed whose lifetimes overlap with it, aligned to
+// `Allocator::kAllocatorAlignment`.
+StaticMemoryPlan PlanStaticMemory(
+    const std::vector<StaticMemoryLifetime>& lifetimes);
+
+// Records the lifetimes of the allocations of a step made through it, which
+// are forwarded to `underlying`. The recorder is reference counted like the
+// TrackingAllocator, so that it outlives the buffers of the step which are
+// deallocated after the end of the step.
+class StaticMemoryRecorder : public Allocator {
+ public:
+  explicit StaticMemoryRecorder(Allocator* underlying);
+
+  std::string Name() override { return "static_memory_recorder"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return underlying_->GetMemoryType();
+  }
+
+  // Returns the lifetimes of the allocations made so far, in allocation order,
+  // and drops the reference of the step.
+  std::vector<StaticMemoryLifetime> GetLifetimesAndUnRef();
+
+ private:
+  ~StaticMemoryRecorder() override {}
+  bool UnRef() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const underlying_;
+  mutex mu_;
+  int ref_ TF_GUARDED_BY(mu_) = 1;
+  int64_t time_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<StaticMemoryLifetime> lifetimes_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<void*, int> live_ TF_GUARDED_BY(mu_);
+};
+
+// Serves the allocations of a step from a single buffer of `underlying`,
+// placed by a plan made from the allocations of an earlier step. The `i`th
+// allocation of the step is served at the planned offset of the `i`th buffer
+// if it fits and the buffers planned in the same memory before it have been
+// deallocated, and by `underlying` otherwise, so that a step which allocates
+// differently than the recorded one stays correct. Reference counted like
+// StaticMemoryRecorder.
+class StaticMemoryArena : public Allocator {
+ public:
+  StaticMemoryArena(std::shared_ptr<const StaticMemoryPlan> plan,
+                    Allocator* underlying);
+
+  std::string Name() override { return "static_memory_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return underlying_->GetMemoryType();
+  }
+
+  // Drops the reference of the step, and returns false if an allocation of the
+  // step did not fit in its planned buffer, in which case the plan should be
+  // made again.
+  bool FollowedPlanAndUnRef();
+
+ private:
+  ~StaticMemoryArena() override;
+  bool UnRef() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::shared_ptr<const StaticMemoryPlan> plan_;
+  Allocator* const underlying_;
+  char* arena_ = nullptr;
+  mutex mu_;
+  int ref_ TF_GUARDED_BY(mu_) = 1;
+  size_t next_ TF_GUARDED_BY(mu_) = 0;
+  bool followed_plan_ TF_GUARDED_BY(mu_) = true;
+  // Whether each planned buffer is allocated.
+  std::vector<bool> live_ TF_GUARDED_BY(mu_);
+  // The planned buffer of each allocated pointer in the arena.
+  absl::flat_hash_map<void*, int> buffer_of_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_ARENA_H_
@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_arena.h"
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+StaticMemoryLifetime Lifetime(int64_t size, int64_t alloc_time,
+                              int64_t free_time) {
+  StaticMemoryLifetime lifetime;
+  lifetime.size = size;
+  lifetime.alignment = Allocator::kAllocatorAlignment;
+  lifetime.alloc_time = alloc_time;
+  lifetime.free_time = free_time;
+  return lifetime;
+}
+
+TEST(StaticMemoryArenaTest, PlansDisjointLifetimesInSameMemory) {
+  // a and b are live together, c reuses the memory of a.
+  const StaticMemoryPlan plan = PlanStaticMemory(
+      {Lifetime(256, 0, 2), Lifetime(128, 1, 4), Lifetime(200, 3, 5)});
+  ASSERT_EQ(plan.buffers.size(), 3);
+  EXPECT_EQ(plan.buffers[0].offset, 0);
+  EXPECT_EQ(plan.buffers[1].offset, 256);
+  EXPECT_EQ(plan.buffers[2].offset, 0);
+  EXPECT_EQ(plan.arena_size, 384);
+  EXPECT_TRUE(plan.buffers[0].reuses.empty());
+  EXPECT_TRUE(plan.buffers[1].reuses.empty());
+  EXPECT_EQ(plan.buffers[2].reuses, std::vector<int>({0}));
+}
+
+TEST(StaticMemoryArenaTest, DoesNotPlanBuffersOutlivingTheStep) {
+  const StaticMemoryPlan plan =
+      PlanStaticMemory({Lifetime(64, 0, 1), Lifetime(64, 2, -1)});
+  EXPECT_EQ(plan.buffers[0].offset, 0);
+  EXPECT_EQ(plan.buffers[1].offset, -1);
+  EXPECT_EQ(plan.arena_size, 64);
+}
+
+// Calls `step` with a recorder, then with an arena planned from the recorded
+// allocations.
+void RecordAndReplay(const std::function<void(Allocator*)>& step,
+                     std::shared_ptr<const StaticMemoryPlan>* plan,
+                     bool* followed_plan) {
+  StaticMemoryRecorder* recorder = new StaticMemoryRecorder(cpu_allocator());
+  step(recorder);
+  *plan = std::make_shared<const StaticMemoryPlan>(
+      PlanStaticMemory(recorder->GetLifetimesAndUnRef()));
+  StaticMemoryArena* arena = new StaticMemoryArena(*plan, cpu_allocator());
+  step(arena);
+  *followed_plan = arena->FollowedPlanAndUnRef();
+}
+
+TEST(StaticMemoryArenaTest, ServesPlannedAllocationsFromArena) {
+  std::vector<void*> ptrs;
+  auto step = [&ptrs](Allocator* allocator) {
+    ptrs.clear();
+    void* a = allocator->AllocateRaw(64, 1024);
+    void* b = allocator->AllocateRaw(64, 512);
+    allocator->DeallocateRaw(a);
+    void* c = allocator->AllocateRaw(64, 1024);
+    allocator->DeallocateRaw(b);
+    allocator->DeallocateRaw(c);
+    ptrs = {a, b, c};
+  };
+  std::shared_ptr<const StaticMemoryPlan> plan;
+  bool followed_plan;
+  RecordAndReplay(step, &plan, &followed_plan);
+  EXPECT_TRUE(followed_plan);
+  EXPECT_EQ(plan->arena_size, 1536);
+  // a and c share the same buffer.
+  EXPECT_EQ(ptrs[0], ptrs[2]);
+  EXPECT_EQ(static_cast<char*>(ptrs[1]) - static_cast<char*>(ptrs[0]), 1024);
+}
+
+TEST(StaticMemoryArenaTest, FallsBackWhenStepDiffers) {
+  bool replay = false;
+  Allocator* replay_allocator = nullptr;
+  void* outlived = nullptr;
+  auto step = [&](Allocator* allocator) {
+    // The replayed step keeps `a` live while allocating `b`, which is planned
+    // in the memory of `a`, and keeps `b` live after the step.
+    void* a = allocator->AllocateRaw(64, 256);
+    if (!replay) allocator->DeallocateRaw(a);
+    void* b = allocator->AllocateRaw(64, 256);
+    if (replay) {
+      EXPECT_NE(a, b);
+      allocator->DeallocateRaw(a);
+      replay_allocator = allocator;
+      outlived = b;
+    } else {
+      allocator->DeallocateRaw(b);
+    }
+    replay = true;
+  };
+  std::shared_ptr<const StaticMemoryPlan> plan;
+  bool followed_plan;
+  RecordAndReplay(step, &plan, &followed_plan);
+  EXPECT_FALSE(followed_plan);
+  EXPECT_EQ(plan->buffers[1].reuses, std::vector<int>({0}));
+  // The arena stays alive until the buffers of the step are deallocated.
+  memset(outlived, 0, 256);
+  replay_allocator->DeallocateRaw(outlived);
+}
+
+}  // namespace
+}  // namespace tensorflow
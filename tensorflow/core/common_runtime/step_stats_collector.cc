@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 
+#include <atomic>
+#include <deque>
 #include <memory>
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
@@ -558,4 +560,142 @@ void StepStatsCollector::FinalizeInternal() {
     }
   }
 }
+
+namespace {
+std::atomic<uint64> next_buffered_collector_id{1};
+}  // namespace
+
+class BufferedStepStatsCollector::Record : public NodeExecStatsInterface {
+ public:
+  explicit Record(const NodeDef* node) : node_(node) {}
+
+  // The record stays in its ThreadBuffer.
+  void Done(const string& device) override { device_ = &device; }
+  void RecordExecutorStarted() override {
+    all_start_nanos_ = Env::Default()->NowNanos();
+  }
+  void RecordComputeStarted() override {
+    op_start_nanos_ = Env::Default()->NowNanos();
+  }
+  void RecordComputeEnded() override {
+    op_end_nanos_ = Env::Default()->NowNanos();
+  }
+  void RecordExecutorEnded() override {
+    all_end_nanos_ = Env::Default()->NowNanos();
+  }
+  bool TrackAllocations() const override { return false; }
+  void SetMemory(OpKernelContext* ctx) override {}
+  void SetOutput(int slot, const Tensor* tensor) override {}
+  void SetScheduled(int64_t nanos) override { scheduled_nanos_ = nanos; }
+
+  // Nullptr until Done().
+  const string* device() const { return device_; }
+
+  // Fills `stats` as NodeExecStatsWrapper would, but for the memory and the
+  // outputs.
+  void ToProto(uint32 thread_id, NodeExecStats* stats) const {
+    const int64_t all_start_micros =
+        all_start_nanos_ / EnvTime::kMicrosToNanos;
+    stats->set_node_name(node_->name());
+    stats->set_all_start_micros(all_start_micros);
+    stats->set_all_start_nanos(all_start_nanos_);
+    stats->set_op_start_rel_micros(op_start_nanos_ / EnvTime::kMicrosToNanos -
+                                   all_start_micros);
+    stats->set_op_start_rel_nanos(op_start_nanos_ - all_start_nanos_);
+    stats->set_op_end_rel_micros(op_end_nanos_ / EnvTime::kMicrosToNanos -
+                                 all_start_micros);
+    stats->set_op_end_rel_nanos(op_end_nanos_ - all_start_nanos_);
+    stats->set_all_end_rel_micros(all_end_nanos_ / EnvTime::kMicrosToNanos -
+                                  all_start_micros);
+    stats->set_all_end_rel_nanos(all_end_nanos_ - all_start_nanos_);
+    stats->set_scheduled_micros(scheduled_nanos_ / EnvTime::kMicrosToNanos);
+    stats->set_scheduled_nanos(scheduled_nanos_);
+    stats->set_thread_id(thread_id);
+    stats->set_timeline_label(
+        strings::StrCat(node_->name(), " = ", node_->op(), "(",
+                        absl::StrJoin(node_->input(), ", "), ")"));
+  }
+
+ private:
+  const NodeDef* const node_;  // Not owned.
+  const string* device_ = nullptr;  // Not owned.
+  int64_t scheduled_nanos_ = 0;
+  int64_t all_start_nanos_ = 0;
+  int64_t op_start_nanos_ = 0;
+  int64_t op_end_nanos_ = 0;
+  int64_t all_end_nanos_ = 0;
+};
+
+// Only its thread adds records, and a deque never moves them, so that they
+// may be done on other threads.
+struct BufferedStepStatsCollector::ThreadBuffer {
+  uint32 thread_id;
+  std::deque<Record> records;
+};
+
+BufferedStepStatsCollector::BufferedStepStatsCollector()
+    : id_(next_buffered_collector_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+BufferedStepStatsCollector::~BufferedStepStatsCollector() = default;
+
+BufferedStepStatsCollector::ThreadBuffer*
+BufferedStepStatsCollector::GetThreadBuffer() {
+  // The buffers of the last few collectors used by this thread, in case it
+  // runs several steps concurrently.
+  struct CacheEntry {
+    uint64 collector_id = 0;
+    ThreadBuffer* buffer = nullptr;
+  };
+  static constexpr int kCacheSize = 4;
+  thread_local CacheEntry cache[kCacheSize];
+  thread_local int next_cache_entry = 0;
+  for (const CacheEntry& entry : cache) {
+    if (entry.collector_id == id_) return entry.buffer;
+  }
+  auto buffer = std::make_unique<ThreadBuffer>();
+  buffer->thread_id = Env::Default()->GetCurrentThreadId();
+  CacheEntry& entry = cache[next_cache_entry];
+  next_cache_entry = (next_cache_entry + 1) % kCacheSize;
+  entry.collector_id = id_;
+  entry.buffer = buffer.get();
+  mutex_lock l(mu_);
+  buffers_.push_back(std::move(buffer));
+  return entry.buffer;
+}
+
+NodeExecStatsInterface* BufferedStepStatsCollector::CreateNodeExecStats(
+    const NodeDef* node) {
+  // Only collect statistics for non-transfer nodes.
+  if (IsSend(node) || IsRecv(node)) {
+    return nullptr;
+  }
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (buffer->records.size() >= kMaxRecordsPerThread) {
+    return nullptr;
+  }
+  buffer->records.emplace_back(node);
+  return &buffer->records.back();
+}
+
+void BufferedStepStatsCollector::Finalize(StepStats* step_stats) {
+  std::unordered_map<StringPiece, DeviceStepStats*, StringPieceHasher>
+      dev_stats_pb;
+  for (DeviceStepStats& dss : *step_stats->mutable_dev_stats()) {
+    dev_stats_pb.emplace(dss.device(), &dss);
+  }
+  mutex_lock l(mu_);
+  for (const auto& buffer : buffers_) {
+    for (const Record& record : buffer->records) {
+      if (record.device() == nullptr) continue;
+      DeviceStepStats*& dss = dev_stats_pb[*record.device()];
+      if (dss == nullptr) {
+        dss = step_stats->add_dev_stats();
+        dss->set_device(*record.device());
+      }
+      record.ToProto(buffer->thread_id, dss->add_node_stats());
+    }
+    buffer->records.clear();
+  }
+}
+
 }  // namespace tensorflow
@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+NodeDef MakeNode(const std::string& name, const std::string& op) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op(op);
+  return node;
+}
+
+void RecordNode(NodeExecStatsInterface* stats, const std::string& device) {
+  stats->SetScheduled(Env::Default()->NowNanos());
+  stats->RecordExecutorStarted();
+  stats->RecordComputeStarted();
+  stats->RecordComputeEnded();
+  stats->RecordExecutorEnded();
+  stats->Done(device);
+}
+
+TEST(BufferedStepStatsCollectorTest, CollectsNodesOfAllThreads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNodesPerThread = 100;
+  const std::string cpu = "/job:localhost/replica:0/task:0/device:CPU:0";
+  const std::string gpu = "/job:localhost/replica:0/task:0/device:GPU:0";
+  std::vector<NodeDef> nodes;
+  for (int i = 0; i < kNumThreads * kNodesPerThread; ++i) {
+    nodes.push_back(MakeNode(absl::StrCat("node_", i), "Identity"));
+  }
+  BufferedStepStatsCollector collector;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&, t]() {
+        for (int i = 0; i < kNodesPerThread; ++i) {
+          const int node = t * kNodesPerThread + i;
+          RecordNode(collector.CreateNodeExecStats(&nodes[node]),
+                     node % 2 == 0 ? cpu : gpu);
+        }
+      });
+    }
+  }
+
+  StepStats step_stats;
+  collector.Finalize(&step_stats);
+  ASSERT_EQ(step_stats.dev_stats_size(), 2);
+  int num_nodes = 0;
+  for (const DeviceStepStats& dss : step_stats.dev_stats()) {
+    EXPECT_TRUE(dss.device() == cpu || dss.device() == gpu);
+    for (const NodeExecStats& stats : dss.node_stats()) {
+      EXPECT_EQ(stats.timeline_label(),
+                absl::StrCat(stats.node_name(), " = Identity()"));
+      EXPECT_GT(stats.all_start_nanos(), 0);
+      EXPECT_GE(stats.op_start_rel_nanos(), 0);
+      EXPECT_GE(stats.op_end_rel_nanos(), stats.op_start_rel_nanos());
+      EXPECT_GE(stats.all_end_rel_nanos(), stats.op_end_rel_nanos());
+      ++num_nodes;
+    }
+  }
+  EXPECT_EQ(num_nodes, kNumThreads * kNodesPerThread);
+
+  // The records were cleared.
+  StepStats empty;
+  collector.Finalize(&empty);
+  EXPECT_EQ(empty.dev_stats_size(), 0);
+}
+
+TEST(BufferedStepStatsCollectorTest, SkipsTransfersAndUnfinishedNodes) {
+  const std::string device = "/job:localhost/replica:0/task:0/device:CPU:0";
+  const NodeDef send = MakeNode("send", "_Send");
+  const NodeDef unfinished = MakeNode("unfinished", "Identity");
+  const NodeDef done = MakeNode("done", "Identity");
+  BufferedStepStatsCollector collector;
+  EXPECT_EQ(collector.CreateNodeExecStats(&send), nullptr);
+  collector.CreateNodeExecStats(&unfinished)->RecordExecutorStarted();
+  // Done on another thread than the one which created the record.
+  NodeExecStatsInterface* stats = collector.CreateNodeExecStats(&done);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 1);
+    pool.Schedule([&]() { RecordNode(stats, device); });
+  }
+
+  StepStats step_stats;
+  collector.Finalize(&step_stats);
+  ASSERT_EQ(step_stats.dev_stats_size(), 1);
+  ASSERT_EQ(step_stats.dev_stats(0).node_stats_size(), 1);
+  EXPECT_EQ(step_stats.dev_stats(0).node_stats(0).node_name(), "done");
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -38,6 +38,12 @@ class ThreadPoolDeviceFactory : public DeviceFactory {
   Status CreateDevices(const SessionOptions& options, const string& name_prefix,
                        std::vector<std::unique_ptr<Device>>* devices) override {
     int num_numa_nodes = port::NUMANumNodes();
+    if (options.config.experimental().use_numa_affinity() &&
+        port::NUMAEnabled() && num_numa_nodes > 1) {
+      // Back each device with an allocator that places memory on its own
+      // NUMA node rather than one allocator shared by all nodes.
+      ProcessState::singleton()->EnableNUMA();
+    }
     int n = 1;
     auto iter = options.config.device_count().find("CPU");
     if (iter != options.config.device_count().end()) {
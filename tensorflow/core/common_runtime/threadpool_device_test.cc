@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/threadpool_device.h"
 
+#include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -68,5 +70,27 @@ TEST(ThreadPoolDeviceTest, CopyTensor) {
   device_context->Unref();
 }
 
+TEST(ThreadPoolDeviceTest, NUMAAffinityInterOpThreadPool) {
+  SessionOptions options;
+  ThreadPoolDevice default_device(options, "/device:CPU:0", Bytes(256),
+                                  DeviceLocality(), cpu_allocator());
+  EXPECT_EQ(default_device.tensorflow_device_thread_pool(), nullptr);
+
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  options.config.set_inter_op_parallelism_threads(2);
+  DeviceLocality locality;
+  locality.set_numa_node(port::NUMANumNodes() - 1);
+  ThreadPoolDevice numa_device(options, "/device:CPU:1", Bytes(256), locality,
+                               cpu_allocator());
+  if (!port::NUMAEnabled()) {
+    EXPECT_EQ(numa_device.tensorflow_device_thread_pool(), nullptr);
+    return;
+  }
+  thread::ThreadPool* pool = numa_device.tensorflow_device_thread_pool();
+  ASSERT_NE(pool, nullptr);
+  EXPECT_EQ(pool, NUMAComputePool(options, locality.numa_node()));
+  EXPECT_EQ(2, pool->NumThreads());
+}
+
 }  // namespace
 }  // namespace tensorflow
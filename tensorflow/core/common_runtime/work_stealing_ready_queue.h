@@ -0,0 +1,199 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// WorkStealingReadyQueue is an internal helper class for the
+// "WORK_STEALING_EXECUTOR" executor type. It holds one deque of ready items
+// per worker. A worker pushes and pops at the back of its own deque, which
+// keeps a chain of dependent nodes on the same thread, and steals from the
+// front of the other workers' deques once its own deque is empty.
+//
+// The queue also hands out worker ids, bounding the number of workers that
+// drain the queue concurrently to `num_workers`:
+//
+//    WorkStealingReadyQueue<Node> q(num_workers);
+//    int id;
+//    if (q.TryAcquireWorker(&id)) {
+//      runner([&q, id]() {
+//        WorkStealingReadyQueue<Node>::WorkerBinding binding(&q, id);
+//        while (std::optional<Node> n = q.Pop(id)) ...
+//        q.ReleaseWorker(id);
+//      });
+//    }
+//
+// A worker that has released its id must check `Empty()` before exiting: an
+// item pushed while all ids were taken is only guaranteed to be observed by
+// either the pusher (as a free id) or the releasing worker (as a non-empty
+// queue).
+template <typename T>
+class WorkStealingReadyQueue {
+ public:
+  explicit WorkStealingReadyQueue(int num_workers)
+      : shards_(num_workers > 0 ? num_workers : 1) {
+    free_worker_ids_.reserve(shards_.size());
+    for (int i = static_cast<int>(shards_.size()) - 1; i >= 0; --i) {
+      free_worker_ids_.push_back(i);
+    }
+  }
+
+  WorkStealingReadyQueue(const WorkStealingReadyQueue&) = delete;
+  void operator=(const WorkStealingReadyQueue&) = delete;
+
+  int num_workers() const { return static_cast<int>(shards_.size()); }
+
+  // Binds the calling thread to `worker_id` of `queue` for the lifetime of
+  // this object, so that `CurrentWorkerId()` can route pushes to the deque of
+  // the running worker. Bindings nest, e.g. when a kernel runs a nested
+  // executor inline on a worker thread.
+  class WorkerBinding {
+   public:
+    WorkerBinding(const WorkStealingReadyQueue* queue, int worker_id)
+        : saved_queue_(bound_queue_), saved_worker_id_(bound_worker_id_) {
+      Rebind(queue, worker_id);
+    }
+    ~WorkerBinding() {
+      bound_queue_ = saved_queue_;
+      bound_worker_id_ = saved_worker_id_;
+    }
+
+    void Rebind(const WorkStealingReadyQueue* queue, int worker_id) {
+      bound_queue_ = queue;
+      bound_worker_id_ = worker_id;
+    }
+
+   private:
+    const WorkStealingReadyQueue* const saved_queue_;
+    const int saved_worker_id_;
+
+    WorkerBinding(const WorkerBinding&) = delete;
+    void operator=(const WorkerBinding&) = delete;
+  };
+
+  // Returns the id of the worker of this queue that is running on the calling
+  // thread, or -1 if the calling thread is not one of its workers.
+  int CurrentWorkerId() const {
+    return bound_queue_ == this ? bound_worker_id_ : -1;
+  }
+
+  // Pushes `item` at the back of the deque owned by `worker_id`. If
+  // `worker_id` is negative, the deques are filled in round-robin order.
+  void Push(int worker_id, const T& item) {
+    if (worker_id < 0) {
+      worker_id = next_shard_.fetch_add(1, std::memory_order_relaxed) %
+                  shards_.size();
+    }
+    Shard& shard = shards_[worker_id];
+    mutex_lock l(shard.mu);
+    shard.items.push_back(item);
+    num_items_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Pops the most recently pushed item of the deque owned by `worker_id`, or
+  // failing that, steals the oldest item from another deque. Returns
+  // `std::nullopt` if no item was found.
+  std::optional<T> Pop(int worker_id) {
+    if (num_items_.load(std::memory_order_relaxed) == 0) return std::nullopt;
+    {
+      Shard& shard = shards_[worker_id];
+      mutex_lock l(shard.mu);
+      if (!shard.items.empty()) {
+        std::optional<T> item(shard.items.back());
+        shard.items.pop_back();
+        num_items_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    const int n = num_workers();
+    for (int i = 1; i < n; ++i) {
+      Shard& victim = shards_[(worker_id + i) % n];
+      mutex_lock l(victim.mu);
+      if (!victim.items.empty()) {
+        std::optional<T> item(victim.items.front());
+        victim.items.pop_front();
+        num_items_.fetch_sub(1, std::memory_order_relaxed);
+        return item;
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Returns true iff every deque is empty. Unlike `Pop()`, this inspects each
+  // deque under its lock.
+  bool Empty() {
+    for (Shard& shard : shards_) {
+      mutex_lock l(shard.mu);
+      if (!shard.items.empty()) return false;
+    }
+    return true;
+  }
+
+  // Claims an unused worker id. Returns false if `num_workers()` workers are
+  // already running.
+  bool TryAcquireWorker(int* worker_id) {
+    mutex_lock l(workers_mu_);
+    if (free_worker_ids_.empty()) return false;
+    *worker_id = free_worker_ids_.back();
+    free_worker_ids_.pop_back();
+    return true;
+  }
+
+  // Returns `worker_id`, previously obtained from `TryAcquireWorker()`.
+  void ReleaseWorker(int worker_id) {
+    mutex_lock l(workers_mu_);
+    DCHECK_LT(free_worker_ids_.size(), shards_.size());
+    free_worker_ids_.push_back(worker_id);
+  }
+
+ private:
+  // Align the shards at 64 bytes to avoid false-sharing between workers.
+  struct alignas(64) Shard {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  std::vector<Shard> shards_;
+  // A hint used to skip scanning the deques when the queue is empty.
+  std::atomic<int64_t> num_items_{0};
+  std::atomic<uint32_t> next_shard_{0};
+
+  mutex workers_mu_;
+  std::vector<int> free_worker_ids_ TF_GUARDED_BY(workers_mu_);
+
+  static thread_local const WorkStealingReadyQueue* bound_queue_;
+  static thread_local int bound_worker_id_;
+};
+
+template <typename T>
+thread_local const WorkStealingReadyQueue<T>*
+    WorkStealingReadyQueue<T>::bound_queue_ = nullptr;
+template <typename T>
+thread_local int WorkStealingReadyQueue<T>::bound_worker_id_ = -1;
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
@@ -0,0 +1,116 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
+
+#include <atomic>
+#include <optional>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingReadyQueue, OwnerPopsLifoAndThiefStealsFifo) {
+  WorkStealingReadyQueue<int> q(2);
+  EXPECT_TRUE(q.Empty());
+  q.Push(0, 1);
+  q.Push(0, 2);
+  q.Push(0, 3);
+  EXPECT_FALSE(q.Empty());
+
+  // The owner takes the most recently pushed item.
+  EXPECT_EQ(q.Pop(0), 3);
+  // Another worker steals the oldest item.
+  EXPECT_EQ(q.Pop(1), 1);
+  EXPECT_EQ(q.Pop(1), 2);
+  EXPECT_EQ(q.Pop(0), std::nullopt);
+  EXPECT_EQ(q.Pop(1), std::nullopt);
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingReadyQueue, PushWithoutWorkerIsRoundRobin) {
+  WorkStealingReadyQueue<int> q(2);
+  q.Push(-1, 1);
+  q.Push(-1, 2);
+  EXPECT_EQ(q.Pop(0), 1);
+  EXPECT_EQ(q.Pop(1), 2);
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(WorkStealingReadyQueue, AcquireAndReleaseWorkers) {
+  WorkStealingReadyQueue<int> q(2);
+  EXPECT_EQ(q.num_workers(), 2);
+  int a, b, c;
+  ASSERT_TRUE(q.TryAcquireWorker(&a));
+  ASSERT_TRUE(q.TryAcquireWorker(&b));
+  EXPECT_NE(a, b);
+  EXPECT_FALSE(q.TryAcquireWorker(&c));
+  q.ReleaseWorker(a);
+  ASSERT_TRUE(q.TryAcquireWorker(&c));
+  EXPECT_EQ(a, c);
+}
+
+TEST(WorkStealingReadyQueue, WorkerBinding) {
+  WorkStealingReadyQueue<int> q1(2);
+  WorkStealingReadyQueue<int> q2(2);
+  EXPECT_EQ(q1.CurrentWorkerId(), -1);
+  {
+    WorkStealingReadyQueue<int>::WorkerBinding outer(&q1, 1);
+    EXPECT_EQ(q1.CurrentWorkerId(), 1);
+    EXPECT_EQ(q2.CurrentWorkerId(), -1);
+    {
+      WorkStealingReadyQueue<int>::WorkerBinding inner(&q2, 0);
+      EXPECT_EQ(q1.CurrentWorkerId(), -1);
+      EXPECT_EQ(q2.CurrentWorkerId(), 0);
+    }
+    EXPECT_EQ(q1.CurrentWorkerId(), 1);
+  }
+  EXPECT_EQ(q1.CurrentWorkerId(), -1);
+}
+
+TEST(WorkStealingReadyQueue, ConcurrentWorkersDrainAllItems) {
+  const int kNumWorkers = 4;
+  const int kNumItems = 10000;
+  WorkStealingReadyQueue<int> q(kNumWorkers);
+  for (int i = 0; i < kNumItems; ++i) {
+    q.Push(i % kNumWorkers, i);
+  }
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> count{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumWorkers);
+    for (int w = 0; w < kNumWorkers; ++w) {
+      int id;
+      ASSERT_TRUE(q.TryAcquireWorker(&id));
+      pool.Schedule([&q, &sum, &count, id]() {
+        WorkStealingReadyQueue<int>::WorkerBinding binding(&q, id);
+        while (std::optional<int> item = q.Pop(q.CurrentWorkerId())) {
+          sum += *item;
+          ++count;
+        }
+        q.ReleaseWorker(id);
+      });
+    }
+  }
+  EXPECT_EQ(count, kNumItems);
+  EXPECT_EQ(sum, static_cast<int64_t>(kNumItems) * (kNumItems - 1) / 2);
+  EXPECT_TRUE(q.Empty());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -87,6 +87,7 @@ get_dataset_experiments() {
 constexpr char kMapAndBatchFusionOpt[] = "map_and_batch_fusion";
 constexpr char kNoopEliminationOpt[] = "noop_elimination";
 constexpr char kMapParallelizationOpt[] = "map_parallelization";
+constexpr char kMapVectorizationOpt[] = "map_vectorization";
 constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
@@ -176,6 +177,14 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kMapParallelizationOpt);
     }
   }
+  if (optimization_options.optional_map_vectorization_case() ==
+      OptimizationOptions::kMapVectorization) {
+    if (optimization_options.map_vectorization()) {
+      optimization_enabled->insert(kMapVectorizationOpt);
+    } else {
+      optimization_disabled->insert(kMapVectorizationOpt);
+    }
+  }
   if (optimization_options.optional_filter_parallelization_case() ==
       OptimizationOptions::kFilterParallelization) {
     if (optimization_options.filter_parallelization()) {
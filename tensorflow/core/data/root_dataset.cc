@@ -19,15 +19,19 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/rewrite_utils.h"
+#include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/model.pb.h"
 #include "tensorflow/core/platform/errors.h"
@@ -56,6 +60,7 @@ constexpr char kRamBudget[] = "ram_budget_megabytes";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
 constexpr char kWarmStart[] = "warm_start";
+constexpr char kTunedParameters[] = "tuned_parameters";
 
 // If value `x` matches `y`, returns default value `z`. Otherwise, return `x`.
 inline int64_t value_or_default(int64_t x, int64_t y, int64_t z) {
@@ -250,6 +255,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   Status SaveInternal(SerializationContext* ctx,
                       IteratorStateWriter* writer) override {
     TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+    if (model_) {
+      TF_RETURN_IF_ERROR(SaveTunedParameters(writer));
+    }
     return OkStatus();
   }
 
@@ -258,6 +266,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     IteratorContext iter_ctx(CreateParams(ctx));
     TF_RETURN_IF_ERROR(RestoreInput(&iter_ctx, reader, input_impl_));
     ctx->MergeCheckpoint(iter_ctx.checkpoint());
+    if (model_ && reader->Contains(prefix(), kTunedParameters)) {
+      TF_RETURN_IF_ERROR(RestoreTunedParameters(reader));
+    }
     return OkStatus();
   }
 
@@ -328,6 +339,70 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
     return params;
   }
 
+  // Returns the fingerprint of the input dataset graph, which identifies the
+  // pipeline the autotuned parameters apply to.
+  StatusOr<uint64_t> DatasetFingerprint() {
+    mutex_lock l(mu_);
+    if (!dataset_fingerprint_.has_value()) {
+      std::vector<std::pair<string, Tensor>> input_list;
+      SerializationContext::Params params;
+      params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+      params.is_graph_rewrite = true;
+      params.input_list = &input_list;
+      params.resource_mgr = nullptr;
+      GraphDef graph_def;
+      TF_RETURN_IF_ERROR(AsGraphDef(dataset()->input_,
+                                    SerializationContext(params), &graph_def));
+      uint64 hash = 0;
+      TF_RETURN_IF_ERROR(HashGraph(graph_def, &hash));
+      dataset_fingerprint_ = hash;
+    }
+    return *dataset_fingerprint_;
+  }
+
+  // Saves the current autotuned parameter values so that autotuning can be
+  // warm-started when the iterator is restored. Pipelines which can't be
+  // fingerprinted are checkpointed without them.
+  Status SaveTunedParameters(IteratorStateWriter* writer) {
+    StatusOr<uint64_t> fingerprint = DatasetFingerprint();
+    if (!fingerprint.ok()) {
+      VLOG(2) << "Not saving tuned parameters: failed to fingerprint the "
+                 "dataset: "
+              << fingerprint.status();
+      return OkStatus();
+    }
+    model::TunedParametersProto tuned_parameters;
+    tuned_parameters.set_dataset_fingerprint(*fingerprint);
+    model_->SaveTunedParameters(*ram_budget_manager_, &tuned_parameters);
+    return writer->WriteScalar(prefix(), kTunedParameters,
+                               tuned_parameters.SerializeAsString());
+  }
+
+  // Restores autotuned parameter values saved by `SaveTunedParameters`. The
+  // values are ignored if they were tuned for a different pipeline.
+  Status RestoreTunedParameters(IteratorStateReader* reader) {
+    tstring serialized;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(prefix(), kTunedParameters, &serialized));
+    model::TunedParametersProto tuned_parameters;
+    if (!tuned_parameters.ParseFromString(serialized)) {
+      return errors::DataLoss("Failed to parse the tuned parameters of ",
+                              prefix());
+    }
+    StatusOr<uint64_t> fingerprint = DatasetFingerprint();
+    if (!fingerprint.ok() ||
+        *fingerprint != tuned_parameters.dataset_fingerprint()) {
+      VLOG(2) << "Not restoring tuned parameters: the dataset fingerprint "
+                 "does not match the checkpoint.";
+      return OkStatus();
+    }
+    const int64_t num_restored =
+        model_->RestoreTunedParameters(tuned_parameters, *ram_budget_manager_);
+    VLOG(2) << "Restored " << num_restored << " tuned parameters for "
+            << prefix();
+    return OkStatus();
+  }
+
   Status EnsureModelThreadStarted(IteratorContext* ctx) {
     mutex_lock l(mu_);
     if (!model_thread_) {
@@ -370,6 +445,9 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
   // The end time of the previous `GetNextInternal` call.
   uint64_t end_time_usec_ TF_GUARDED_BY(mu_) = 0;
 
+  // Cached result of `DatasetFingerprint()`.
+  std::optional<uint64_t> dataset_fingerprint_ TF_GUARDED_BY(mu_);
+
   // Must be ordered last as its execution may depend on other members.
   std::unique_ptr<IteratorBase> input_impl_;
 };
@@ -29,7 +29,9 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/mutex.h"
+#include "tsl/platform/statusor.h"
 #include "tsl/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -206,6 +208,18 @@ tsl::Status MultipleIterationsAutoScaler::UnregisterIteration(
 
 tsl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
     int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_) {
+  TF_ASSIGN_OR_RETURN(
+      int64_t bound_optimal_number_of_workers,
+      GetBoundedOptimalNumberOfWorkers(current_number_of_workers));
+  metrics::RecordTFDataServiceOptimalNumberOfWorkers(
+      bound_optimal_number_of_workers);
+
+  return tsl::OkStatus();
+}
+
+tsl::StatusOr<int64_t>
+MultipleIterationsAutoScaler::GetBoundedOptimalNumberOfWorkers(
+    int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_) {
   if (current_number_of_workers <= 0)
     return absl::InvalidArgumentError(
         "The current number of workers must be positive");
@@ -214,7 +228,7 @@ tsl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
       GetOptimalNumberOfWorkers();
   if (!optimal_number_of_workers)
     return absl::UnavailableError(
-        "Cannot update the optimal number of workers metric because there are "
+        "Cannot estimate the optimal number of workers because there are "
         "no reported processing and target processing times for at least one "
         "iteration");
 
@@ -235,11 +249,7 @@ tsl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
       std::min(bound_optimal_number_of_workers, int64_t{100000});
   VLOG(3) << "Bound optimal number of workers: "
           << bound_optimal_number_of_workers;
-
-  metrics::RecordTFDataServiceOptimalNumberOfWorkers(
-      bound_optimal_number_of_workers);
-
-  return tsl::OkStatus();
+  return bound_optimal_number_of_workers;
 }
 
 std::optional<int64_t> MultipleIterationsAutoScaler::GetOptimalNumberOfWorkers()
@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
 #include "tsl/platform/thread_annotations.h"
 
 namespace tensorflow {
@@ -126,6 +127,14 @@ class MultipleIterationsAutoScaler {
   // iteration, or `current_number_of_workers` is not positive.
   tsl::Status UpdateOptimalNumberOfWorkersMetric(
       int64_t current_number_of_workers) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the estimated optimal number of workers, limited the same way as
+  // the metric reported by `UpdateOptimalNumberOfWorkersMetric`. Returns an
+  // error if there are no previously reported processing and target processing
+  // times for at least one iteration, or `current_number_of_workers` is not
+  // positive.
+  tsl::StatusOr<int64_t> GetBoundedOptimalNumberOfWorkers(
+      int64_t current_number_of_workers) const TF_LOCKS_EXCLUDED(mu_);
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
   // target processing times for at least one iteration, returns nullopt.
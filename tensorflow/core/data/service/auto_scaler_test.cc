@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/auto_scaler.h"
 
+#include <cstdint>
 #include <optional>
 
 #include "absl/time/time.h"
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
 
 namespace tensorflow {
 namespace data {
@@ -361,6 +363,42 @@ TEST(MultipleIterationsAutoScalerTest,
   EXPECT_THAT(status, StatusIs(absl::StatusCode::kUnavailable));
 }
 
+TEST(MultipleIterationsAutoScalerTest,
+     GetBoundedOptimalNumberOfWorkersInvalidCurrentWorkers) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetBoundedOptimalNumberOfWorkers(0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(MultipleIterationsAutoScalerTest,
+     GetBoundedOptimalNumberOfWorkersNoReportedTimes) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_THAT(auto_scaler.GetBoundedOptimalNumberOfWorkers(1),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
+TEST(MultipleIterationsAutoScalerTest, GetBoundedOptimalNumberOfWorkers) {
+  MultipleIterationsAutoScaler auto_scaler;
+
+  // Consumer 0 needs an element every microsecond, worker throughput is one
+  // element every 10 microseconds, so 10 workers are needed.
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Microseconds(1)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Microseconds(10)));
+  TF_ASSERT_OK_AND_ASSIGN(int64_t optimal_number_of_workers,
+                          auto_scaler.GetBoundedOptimalNumberOfWorkers(5));
+  EXPECT_EQ(optimal_number_of_workers, 10);
+  // Increases are limited to 4x the current number of workers.
+  TF_ASSERT_OK_AND_ASSIGN(optimal_number_of_workers,
+                          auto_scaler.GetBoundedOptimalNumberOfWorkers(2));
+  EXPECT_EQ(optimal_number_of_workers, 8);
+  // Decreases are not limited.
+  TF_ASSERT_OK_AND_ASSIGN(optimal_number_of_workers,
+                          auto_scaler.GetBoundedOptimalNumberOfWorkers(50));
+  EXPECT_EQ(optimal_number_of_workers, 10);
+}
+
 TEST(MultipleIterationsAutoScalerTest,
      UpdateOptimalNumberOfWorkersMetricWithReportedTimes) {
   MultipleIterationsAutoScaler auto_scaler;
@@ -27,6 +27,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/substitute.h"
@@ -479,6 +480,11 @@ void DataServiceClient::UpdateTasks(const ClientHeartbeatResponse& resp)
   if (iteration_finished_) {
     return;
   }
+  const absl::flat_hash_set<int64_t> draining_task_ids(
+      resp.draining_task_ids().begin(), resp.draining_task_ids().end());
+  for (const std::shared_ptr<Task>& task : tasks_) {
+    task->draining = draining_task_ids.contains(task->info.task_id());
+  }
 
   int index = 0;
   while (index < tasks_.size()) {
@@ -561,8 +567,11 @@ void DataServiceClient::UpdateBufferSize() TF_LOCKS_EXCLUDED(mu_) {
     // `tasks_` includes the local tasks, so we subtract one from the
     // configured local task buffer size.
     mutex_lock l(mu_);
+    // With adaptive windows, the buffer holds up to a window of elements per
+    // task, within the memory budget of the model.
     int64_t max_outstanding_requests = ctx_->UpdateMaxOutstandingRequests(
-        max_outstanding_requests_, tasks_.size());
+        max_outstanding_requests_,
+        UseAdaptiveTaskWindows() ? TotalTaskWindow() : tasks_.size());
     if (max_outstanding_requests > max_outstanding_requests_) {
       worker_thread_cv_.notify_all();
     }
@@ -575,8 +584,9 @@ void DataServiceClient::UpdateBufferSize() TF_LOCKS_EXCLUDED(mu_) {
 
 void DataServiceClient::UpdateWorkerThreads() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
-  const int64_t max_num_threads =
-      std::min<int64_t>(tasks_.size(), max_outstanding_requests_);
+  const int64_t max_num_threads = std::min<int64_t>(
+      UseAdaptiveTaskWindows() ? TotalTaskWindow() : tasks_.size(),
+      max_outstanding_requests_);
   while (num_running_worker_threads_ < max_num_threads && !cancelled_ &&
          status_.ok()) {
     num_running_worker_threads_++;
@@ -605,7 +615,7 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
     {
       mutex_lock l(mu_);
       if (task_to_process) {
-        task_to_process->in_use = false;
+        --task_to_process->num_outstanding_requests;
         --outstanding_requests_;
         task_to_process = nullptr;
         worker_thread_cv_.notify_one();
@@ -623,7 +633,7 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
         worker_thread_cv_.wait(l);
       }
       DCHECK(task_to_process != nullptr);
-      task_to_process->in_use = true;
+      ++task_to_process->num_outstanding_requests;
       ++outstanding_requests_;
       if (IsCoordinatedRead()) {
         // Reserve a spot in the results_ queue.
@@ -644,7 +654,7 @@ void DataServiceClient::RunWorkerThread(std::function<void()> done)
       mutex_lock l(mu_);
       VLOG(1) << "Failed to get element from worker "
               << task_to_process->info.worker_address() << ": " << s;
-      task_to_process->in_use = false;
+      --task_to_process->num_outstanding_requests;
       --outstanding_requests_;
       status_ = errors::CreateWithUpdatedMessage(
           s, absl::StrCat("Failed to get element from worker ",
@@ -670,6 +680,64 @@ bool DataServiceClient::ShouldProcessTask() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   return results_.size() + outstanding_requests_ < max_outstanding_requests_;
 }
 
+bool DataServiceClient::UseAdaptiveTaskWindows() const {
+  // Round-robin reads are served in rounds, one element per task.
+  return params_.max_outstanding_requests == model::kAutotune &&
+         !IsCoordinatedRead();
+}
+
+void DataServiceClient::UpdateTaskWindow(Task& task, int64_t latency_us,
+                                         size_t bytes)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!UseAdaptiveTaskWindows()) {
+    return;
+  }
+  if (bytes == 0) {
+    task.window = std::max<int64_t>(task.window / 2, 1);
+    return;
+  }
+  constexpr double kSmoothing = 0.2;
+  const double bytes_per_second =
+      bytes * 1.0e6 / std::max<int64_t>(latency_us, 1);
+  task.latency_us = task.latency_us == 0.0
+                        ? latency_us
+                        : (1 - kSmoothing) * task.latency_us +
+                              kSmoothing * latency_us;
+  task.bytes_per_second = task.bytes_per_second == 0.0
+                              ? bytes_per_second
+                              : (1 - kSmoothing) * task.bytes_per_second +
+                                    kSmoothing * bytes_per_second;
+
+  double total_bytes_per_second = 0.0;
+  int64_t num_measured_tasks = 0;
+  for (const std::shared_ptr<Task>& other : tasks_) {
+    if (other->bytes_per_second > 0.0) {
+      total_bytes_per_second += other->bytes_per_second;
+      ++num_measured_tasks;
+    }
+  }
+  const double average_bytes_per_second =
+      total_bytes_per_second / std::max<int64_t>(num_measured_tasks, 1);
+  constexpr int64_t kMaxTaskWindow = 16;
+  if (task.bytes_per_second >= average_bytes_per_second) {
+    task.window = std::min(task.window + 1, kMaxTaskWindow);
+  } else if (task.bytes_per_second < average_bytes_per_second / 2) {
+    task.window = std::max<int64_t>(task.window - 1, 1);
+  }
+  VLOG(4) << "Window of task " << task.info.task_id() << " is " << task.window
+          << " with latency " << task.latency_us << "us and "
+          << task.bytes_per_second << " bytes/s.";
+}
+
+int64_t DataServiceClient::TotalTaskWindow() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64_t total_window = 0;
+  for (const std::shared_ptr<Task>& task : tasks_) {
+    total_window += task->window;
+  }
+  return total_window;
+}
+
 // Searches for a task to process, visiting tasks in-order and giving every
 // task a chance to proceed.
 std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
@@ -681,21 +749,24 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
     if (IsCoordinatedRead() &&
-        (task->in_use ||
+        (task->num_outstanding_requests > 0 ||
          current_round_ >= round_robin_round_limit_.value_or(
                                std::numeric_limits<int64_t>::max()))) {
-      VLOG(4) << "No round robin task found. in_use: " << task->in_use
+      VLOG(4) << "No round robin task found. num_outstanding_requests: "
+              << task->num_outstanding_requests
               << ". current_round: " << current_round_
               << ". round_robin_round_limit: "
               << round_robin_round_limit_.value_or(-1);
       return nullptr;
     }
-    if (current_round_ < task->info.starting_round() || task->in_use ||
+    if (current_round_ < task->info.starting_round() ||
+        task->num_outstanding_requests >= task->window ||
         task->end_of_sequence || task->removed) {
       VLOG(3) << "Skipping task " << next_task_index_
               << ". starting round: " << task->info.starting_round()
               << ". current round: " << current_round_
-              << ". task->in_use: " << task->in_use
+              << ". num_outstanding_requests: "
+              << task->num_outstanding_requests << ". window: " << task->window
               << ". end_of_sequence: " << task->end_of_sequence
               << ". task->removed: " << task->removed;
       AdvanceTaskIndex();
@@ -731,12 +802,18 @@ Status DataServiceClient::TryGetElement(const Task& task,
   if (params_.cross_trainer_cache_options) {
     req.set_trainer_id(params_.cross_trainer_cache_options->trainer_id());
   }
-  return task.worker->GetElement(req, result);
+  std::shared_ptr<DataServiceWorkerClient> worker;
+  {
+    mutex_lock l(mu_);
+    worker = task.worker;
+  }
+  return worker->GetElement(req, result);
 }
 
 void DataServiceClient::ProcessGetElementResponse(
     bool enqueue_result, GetElementResult& get_element_result,
-    std::shared_ptr<Result> result, Task& task) TF_LOCKS_EXCLUDED(mu_) {
+    std::shared_ptr<Result> result, Task& task, int64_t latency_us)
+    TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   result->ready = true;
   result->end_of_sequence = get_element_result.end_of_sequence;
@@ -746,9 +823,16 @@ void DataServiceClient::ProcessGetElementResponse(
     result->element = std::move(get_element_result.components);
     result->element_index = get_element_result.element_index;
     result->task_id = task.info.task_id();
+    size_t bytes = 0;
+    for (const Tensor& component : result->element) {
+      bytes += component.TotalBytes();
+    }
+    UpdateTaskWindow(task, latency_us, std::max<size_t>(bytes, 1));
   } else if (get_element_result.skip) {
     task.skipped_previous_round = true;
-  } else {
+    UpdateTaskWindow(task, latency_us, /*bytes=*/0);
+  } else if (!task.end_of_sequence) {
+    // Other requests in flight for the task may also reach the end.
     task.end_of_sequence = true;
     finished_tasks_++;
   }
@@ -818,14 +902,31 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
                                      bool enqueue_result,
                                      std::shared_ptr<Result> result)
     TF_LOCKS_EXCLUDED(mu_) {
+  if (IsCoordinatedRead()) {
+    bool draining;
+    {
+      mutex_lock l(mu_);
+      draining = task->draining && !task->removed;
+    }
+    if (draining) {
+      TF_RETURN_IF_ERROR(MaybeRemoveTask(*task, deadline_micros, *result));
+      mutex_lock l(mu_);
+      if (result->skip) {
+        return OkStatus();
+      }
+    }
+  }
   GetElementResult get_element_result;
+  int64_t start_micros;
   while (true) {
+    start_micros = Env::Default()->NowMicros();
     Status s = TryGetElement(*task, get_element_result);
     if (s.ok()) {
       task->num_retries = 0;
       break;
     }
     if (!IsPreemptedError(s)) {
+      mutex_lock l(mu_);
       if (task->worker->GetDataTransferProtocol() == kGrpcTransferProtocol ||
           task->worker->GetDataTransferProtocol() == kLocalTransferProtocol) {
         return s;
@@ -837,7 +938,6 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
       metrics::RecordTFDataServiceDataTransferProtocolError(
           task->worker->GetDataTransferProtocol(),
           static_cast<error::Code>(s.raw_code()), std::string(s.message()));
-      mutex_lock l(mu_);
       TF_ASSIGN_OR_RETURN(std::unique_ptr<DataServiceWorkerClient> worker,
                           CreateGrpcWorkerClient(task->info));
       task->worker = std::move(worker);
@@ -874,10 +974,12 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
       // task before returning to this one.
       result->ready = true;
       result->skip = true;
+      UpdateTaskWindow(*task, /*latency_us=*/0, /*bytes=*/0);
       return OkStatus();
     }
   }
-  ProcessGetElementResponse(enqueue_result, get_element_result, result, *task);
+  ProcessGetElementResponse(enqueue_result, get_element_result, result, *task,
+                            Env::Default()->NowMicros() - start_micros);
   return OkStatus();
 }
 
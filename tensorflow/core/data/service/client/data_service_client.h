@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CLIENT_DATA_SERVICE_CLIENT_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CLIENT_DATA_SERVICE_CLIENT_H_
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -98,21 +100,34 @@ class DataServiceClient {
         : info(info), worker(std::move(worker)) {}
 
     const TaskInfo info;
-    // Client for fetching task elements from the tf.data service worker.
-    std::unique_ptr<DataServiceWorkerClient> worker;
+    // Client for fetching task elements from the tf.data service worker. It is
+    // shared with the requests in flight when it is replaced.
+    std::shared_ptr<DataServiceWorkerClient> worker
+        TF_GUARDED_BY(&DataServiceClient::mu_);
     // The next round to read from the task.
     int64_t round = 0;
     // Whether the task has been removed. The task will eventually be
     // deleted from `tasks_` on the next dispatcher heartbeat.
     bool removed = false;
+    // Whether the dispatcher is draining the task's worker. Consumers of
+    // round-robin iterations request removal of such tasks.
+    bool draining TF_GUARDED_BY(&DataServiceClient::mu_) = false;
     bool skipped_previous_round = false;
-    // Indicates whether a worker thread is currently processing the task.
-    bool in_use TF_GUARDED_BY(&DataServiceClient::mu_) = false;
+    // The number of requests in flight for the task, and how many there may
+    // be. The window is 1 unless it is adapted to the task's throughput, see
+    // `UpdateTaskWindow`.
+    int64_t num_outstanding_requests TF_GUARDED_BY(&DataServiceClient::mu_) =
+        0;
+    int64_t window TF_GUARDED_BY(&DataServiceClient::mu_) = 1;
+    // Moving averages of the latency of the task's requests and of the bytes
+    // it returns per second.
+    double latency_us TF_GUARDED_BY(&DataServiceClient::mu_) = 0.0;
+    double bytes_per_second TF_GUARDED_BY(&DataServiceClient::mu_) = 0.0;
     // Indicates whether the worker has returned end_of_sequence for the task.
     bool end_of_sequence TF_GUARDED_BY(&DataServiceClient::mu_) = false;
     // Number of retries. The more it is retried, the longer it should wait
     // before the next retry.
-    int64_t num_retries = 0;
+    std::atomic<int64_t> num_retries = 0;
   };
 
   struct Result {
@@ -177,7 +192,16 @@ class DataServiceClient {
   Status TryGetElement(const Task& task, GetElementResult& result);
   void ProcessGetElementResponse(bool enqueue_result,
                                  GetElementResult& get_element_result,
-                                 std::shared_ptr<Result> result, Task& task);
+                                 std::shared_ptr<Result> result, Task& task,
+                                 int64_t latency_us);
+  // Returns whether the tasks may have several requests in flight, with
+  // windows adapted to their throughput.
+  bool UseAdaptiveTaskWindows() const;
+  // Grows the window of a task which returned an element at least as fast as
+  // the average task, and shrinks it otherwise, e.g. if the task has no data.
+  void UpdateTaskWindow(Task& task, int64_t latency_us, size_t bytes);
+  // Returns the sum of the task windows.
+  int64_t TotalTaskWindow() const;
   Status GetElementTraced(Task* task, int64_t deadline_micros,
                           bool enqueue_result, std::shared_ptr<Result> result);
   Status MaybeRemoveTask(Task& task, int64_t deadline_micros, Result& result);
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -173,6 +174,29 @@ TEST(DataServiceClientTest, StaticSharding) {
   client.Cancel();
 }
 
+TEST(DataServiceClientTest, AdaptiveTaskWindows) {
+  TestCluster test_cluster(/*num_workers=*/3);
+  TF_ASSERT_OK(test_cluster.Initialize());
+  DatasetClient<int64_t> test_dataset(test_cluster);
+  TF_ASSERT_OK_AND_ASSIGN(std::string dataset_id,
+                          test_dataset.RegisterDataset(RangeDataset(10)));
+
+  DataServiceParams params = GetDataServiceParams(
+      dataset_id, test_cluster.DispatcherAddress(), ProcessingModeDef::OFF);
+  params.max_outstanding_requests = model::kAutotune;
+  DataServiceClient client(params);
+  TF_ASSERT_OK(client.Initialize());
+  // Each worker produces the full range.
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 3; ++i) {
+    const std::vector<int64_t> range = Range(10);
+    expected.insert(expected.end(), range.begin(), range.end());
+  }
+  EXPECT_THAT(GetResults<int64_t>(client),
+              IsOkAndHolds(UnorderedElementsAreArray(expected)));
+  client.Cancel();
+}
+
 TEST(DataServiceClientTest, RecordBufferEvents) {
   TestCluster test_cluster(/*num_workers=*/1);
   TF_ASSERT_OK(test_cluster.Initialize());
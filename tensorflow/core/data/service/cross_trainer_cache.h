@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
@@ -24,10 +25,14 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -74,6 +79,11 @@ namespace data {
 //   TF_ASSIGN_OR_RETURN(next, cache.Get("Trainer 2"));  // Returns 1
 //   TF_ASSIGN_OR_RETURN(next, cache.Get("Trainer 1"));  // Returns 2
 //   TF_ASSIGN_OR_RETURN(next, cache.Get("Trainer 2"));  // Returns 2
+//
+// A tiered cache additionally spills the elements evicted from memory to files
+// in a local directory, e.g. on an SSD, so that trainers lagging behind read
+// them from disk instead of skipping them. Elements which all the trainers have
+// already read are dropped instead of being spilled.
 
 // To use the cache, the user needs to define a `CachableSequence` to generate
 // an infinite sequence of data. It should implement a `GetNext` method to
@@ -89,6 +99,18 @@ class CachableSequence {
 
   // Returns the estimated size of the element in bytes.
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
+
+  // Serializes and deserializes an element spilled to disk by a tiered cache.
+  // The elements of sequences which don't implement them are only cached in
+  // memory.
+  virtual StatusOr<std::string> Serialize(const ElementType&) const {
+    return errors::Unimplemented(
+        "The cachable sequence doesn't support serialization.");
+  }
+  virtual StatusOr<ElementType> Deserialize(const std::string&) const {
+    return errors::Unimplemented(
+        "The cachable sequence doesn't support serialization.");
+  }
 };
 
 // Sliding-window cache shared across concurrent trainers.
@@ -101,7 +123,17 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
-  virtual ~CrossTrainerCache() = default;
+
+  // Creates a tiered `CrossTrainerCache`, which spills up to
+  // `max_spill_size_bytes` of elements evicted from memory to files in
+  // `spill_directory`. The files are deleted with the cache. The cache is only
+  // kept in memory if `max_spill_size_bytes` is 0.
+  // REQUIRES: `cachable_sequence` implements `Serialize` and `Deserialize`.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes, size_t max_spill_size_bytes,
+      const std::string& spill_directory,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+  virtual ~CrossTrainerCache();
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
 
@@ -147,14 +179,42 @@ class CrossTrainerCache {
 
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
+  // The freed elements which a trainer has yet to read are spilled to disk if
+  // the cache is tiered.
   void FreeSpace(size_t new_element_size_bytes);
 
+  // Returns the smallest element index which a trainer has yet to read.
+  size_t GetMinTrainerElementIndex();
+
+  // Writes `element`, which has index `element_index`, to the spill directory.
+  // Returns false if it fails or doesn't fit in `max_spill_size_bytes_`.
+  bool SpillElement(const ElementType& element, size_t element_index);
+
+  // Reads the spilled element with index `element_index`.
+  StatusOr<std::shared_ptr<const ElementType>> ReadSpilledElement(
+      size_t element_index);
+
+  // Returns the file to which the element with index `element_index` is
+  // spilled.
+  std::string GetSpillFilename(size_t element_index) const;
+
+  // Deletes the oldest spilled element, or all of them.
+  void DropSpilledElement();
+  void DropSpilledElements();
+
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
 
   // Maximum cache size in bytes.
   const size_t max_cache_size_bytes_;
 
+  // Maximum size of the spilled elements in bytes, 0 if the cache isn't
+  // tiered, and the directory they're written to. `spill_prefix_` makes the
+  // file names unique to this cache.
+  const size_t max_spill_size_bytes_ = 0;
+  const std::string spill_directory_;
+  const std::string spill_prefix_;
+
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
@@ -165,7 +225,12 @@ class CrossTrainerCache {
   // return this status.
   Status status_ TF_GUARDED_BY(mu_) = OkStatus();
 
-  // `cache_` stores the cached elements.
+  // `spilled_` stores the sizes of the spilled elements, which precede the
+  // elements of `cache_` stored in memory. The first spilled element, or the
+  // first element of `cache_` if there are none, has index
+  // `cache_start_index_`.
+  std::deque<size_t> spilled_ TF_GUARDED_BY(mu_);
+  size_t spilled_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   std::deque<std::shared_ptr<const ElementType>> cache_ TF_GUARDED_BY(mu_);
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
@@ -175,7 +240,8 @@ class CrossTrainerCache {
 
   // Maps trainer IDs to element indices. The indices are absolute indices
   // within the dataset. The actual index to use with `cache_` would be
-  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
+  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`, minus
+  // `spilled_.size()` for the elements in memory.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
 };
@@ -192,6 +258,32 @@ CrossTrainerCache<ElementType>::CrossTrainerCache(
           << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
 
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes, size_t max_spill_size_bytes,
+    const std::string& spill_directory,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    : max_cache_size_bytes_(max_cache_size_bytes),
+      max_spill_size_bytes_(max_spill_size_bytes),
+      spill_directory_(spill_directory),
+      spill_prefix_(absl::StrCat("cross_trainer_cache_", random::New64())),
+      cachable_sequence_(std::move(cachable_sequence)) {
+  DCHECK_GT(max_cache_size_bytes, 0)
+      << "CrossTrainerCache size must be greater than 0.";
+  DCHECK(max_spill_size_bytes == 0 || !spill_directory.empty())
+      << "Tiered CrossTrainerCache requires a spill directory.";
+  VLOG(2) << "Initialized tf.data service cross-trainer cache with "
+          << ByteSize::Bytes(max_cache_size_bytes) << " of memory and "
+          << ByteSize::Bytes(max_spill_size_bytes) << " of disk in "
+          << spill_directory << ".";
+}
+
+template <class ElementType>
+CrossTrainerCache<ElementType>::~CrossTrainerCache() {
+  mutex_lock l(mu_);
+  DropSpilledElements();
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
@@ -247,7 +339,8 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
 template <class ElementType>
 bool CrossTrainerCache<ElementType>::IsElementReady(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  return GetElementIndex(trainer_id) < cache_start_index_ + cache_.size();
+  return GetElementIndex(trainer_id) <
+         cache_start_index_ + spilled_.size() + cache_.size();
 }
 
 template <class ElementType>
@@ -261,8 +354,12 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
         element_index);
   }
 
-  std::shared_ptr<const ElementType> result =
-      cache_[element_index - cache_start_index_];
+  std::shared_ptr<const ElementType> result;
+  if (element_index < cache_start_index_ + spilled_.size()) {
+    TF_ASSIGN_OR_RETURN(result, ReadSpilledElement(element_index));
+  } else {
+    result = cache_[element_index - cache_start_index_ - spilled_.size()];
+  }
   trainer_to_element_index_map_[trainer_id] = element_index + 1;
   return result;
 }
@@ -300,20 +397,114 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
 template <class ElementType>
 void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t num_elements_discarded = 0;
+  size_t num_elements_discarded = 0, num_elements_spilled = 0;
+  const size_t min_trainer_element_index = GetMinTrainerElementIndex();
+  // The spilled elements which all the trainers have read are not needed.
+  while (!spilled_.empty() && cache_start_index_ < min_trainer_element_index) {
+    DropSpilledElement();
+    ++num_elements_discarded;
+  }
   while (!cache_.empty() &&
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
-    size_t free_bytes =
-        cachable_sequence_->GetElementSizeBytes(*cache_.front());
+    const size_t element_index = cache_start_index_ + spilled_.size();
+    std::shared_ptr<const ElementType> element = std::move(cache_.front());
     cache_.pop_front();
-    cache_size_bytes_ -= free_bytes;
+    cache_size_bytes_ -= cachable_sequence_->GetElementSizeBytes(*element);
+    if (max_spill_size_bytes_ > 0 &&
+        element_index >= min_trainer_element_index &&
+        SpillElement(*element, element_index)) {
+      ++num_elements_spilled;
+      continue;
+    }
+    // The cached elements must be contiguous, so the older spilled elements
+    // go too.
+    num_elements_discarded += spilled_.size() + 1;
+    DropSpilledElements();
     ++cache_start_index_;
-    ++num_elements_discarded;
   }
 
-  VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
+  VLOG(3) << "Freed " << num_elements_discarded << " element(s) and spilled "
+          << num_elements_spilled << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
-          << ByteSize::Bytes(cache_size_bytes_) << ".";
+          << ByteSize::Bytes(cache_size_bytes_)
+          << ". Disk usage: " << ByteSize::Bytes(spilled_size_bytes_) << ".";
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::GetMinTrainerElementIndex()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  size_t min_element_index = std::numeric_limits<size_t>::max();
+  for (const auto& [trainer_id, element_index] :
+       trainer_to_element_index_map_) {
+    min_element_index = std::min(min_element_index,
+                                 std::max(element_index, cache_start_index_));
+  }
+  return min_element_index;
+}
+
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::SpillElement(const ElementType& element,
+                                                  size_t element_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  StatusOr<std::string> serialized = cachable_sequence_->Serialize(element);
+  if (!serialized.ok() || serialized->size() > max_spill_size_bytes_) {
+    VLOG(3) << "Failed to spill tf.data service cross-trainer cache element "
+            << element_index << ": " << serialized.status();
+    return false;
+  }
+  while (spilled_size_bytes_ + serialized->size() > max_spill_size_bytes_) {
+    DropSpilledElement();
+  }
+  const std::string filename = GetSpillFilename(element_index);
+  Status s = WriteStringToFile(Env::Default(), filename, *serialized);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to spill tf.data service cross-trainer cache "
+                 << "element to " << filename << ": " << s;
+    return false;
+  }
+  spilled_.push_back(serialized->size());
+  spilled_size_bytes_ += serialized->size();
+  return true;
+}
+
+template <class ElementType>
+StatusOr<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ReadSpilledElement(size_t element_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(
+      Env::Default(), GetSpillFilename(element_index), &serialized));
+  TF_ASSIGN_OR_RETURN(ElementType element,
+                      cachable_sequence_->Deserialize(serialized));
+  return std::make_shared<const ElementType>(std::move(element));
+}
+
+template <class ElementType>
+std::string CrossTrainerCache<ElementType>::GetSpillFilename(
+    size_t element_index) const {
+  return io::JoinPath(spill_directory_,
+                      absl::StrCat(spill_prefix_, "_", element_index));
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::DropSpilledElement()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  Status s = Env::Default()->DeleteFile(GetSpillFilename(cache_start_index_));
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete a spilled tf.data service cross-trainer "
+                 << "cache element: " << s;
+  }
+  spilled_size_bytes_ -= spilled_.front();
+  spilled_.pop_front();
+  ++cache_start_index_;
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::DropSpilledElements()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  while (!spilled_.empty()) {
+    DropSpilledElement();
+  }
 }
 
 template <class ElementType>
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -61,6 +62,19 @@ class InfiniteRange : public CachableSequence<int64_t> {
   int64_t next_ = 0;
 };
 
+class SerializableRange : public InfiniteRange {
+ public:
+  StatusOr<std::string> Serialize(const int64_t& element) const override {
+    return std::string(reinterpret_cast<const char*>(&element),
+                       sizeof(element));
+  }
+  StatusOr<int64_t> Deserialize(const std::string& serialized) const override {
+    int64_t element;
+    std::memcpy(&element, serialized.data(), sizeof(element));
+    return element;
+  }
+};
+
 class TensorDataset : public CachableSequence<Tensor> {
  public:
   StatusOr<Tensor> GetNext() override { return Tensor("Test Tensor"); }
@@ -190,6 +204,24 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      /*max_spill_size_bytes=*/10 * sizeof(int64_t),
+      /*spill_directory=*/testing::TmpDir(),
+      std::make_unique<SerializableRange>());
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 15 to 19 are in memory, and 5 to 14 are on disk.
+  for (int i = 5; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
@@ -130,12 +130,15 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
                                              int64_t repetition,
                                              int64_t split_provider_index,
                                              Tensor& split,
-                                             bool& end_of_splits) {
+                                             bool& end_of_splits,
+                                             const std::vector<std::string>&
+                                                 locality_tags) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   GetSplitRequest req;
   req.set_iteration_id(iteration_id);
   req.set_repetition(repetition);
   req.set_split_provider_index(split_provider_index);
+  *req.mutable_locality_tags() = {locality_tags.begin(), locality_tags.end()};
   GetSplitResponse resp;
   grpc::ClientContext client_ctx;
   grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
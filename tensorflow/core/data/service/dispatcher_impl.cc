@@ -210,6 +210,10 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
 
 Status DataServiceDispatcherImpl::Start() {
   mutex_lock l(mu_);
+  if (!config_.worker_pool_resizer().empty()) {
+    TF_RETURN_IF_ERROR(WorkerPoolResizer::Build(
+        config_.worker_pool_resizer(), config_, &worker_pool_resizer_));
+  }
   if (config_.job_gc_timeout_ms() >= 0) {
     maintenance_thread_ = absl::WrapUnique(env_->StartThread(
         {}, "maintenance-thread", [&] { MaintenanceThread(); }));
@@ -265,6 +269,12 @@ Status DataServiceDispatcherImpl::Start() {
   // Initialize the journal writer in `Start` so that we fail fast in case it
   // can't be initialized.
   TF_RETURN_IF_ERROR(journal_writer_.value()->EnsureInitialized());
+  if (config_.journal_group_commit_window_ms() > 0) {
+    group_commit_journal_writer_ = std::make_unique<GroupCommitJournalWriter>(
+        env_, std::move(journal_writer_.value()),
+        absl::Milliseconds(config_.journal_group_commit_window_ms()));
+    journal_writer_.reset();
+  }
   TF_RETURN_IF_ERROR(RestoreSnapshots());
   started_ = true;
   return OkStatus();
@@ -539,12 +549,12 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
     // the previous repetitions as completed and advance to the requested
     // repetition.
     TF_RETURN_IF_ERROR(split_provider->Reset());
+    pending_splits_[iteration_id].erase(provider_index);
   }
   Tensor split;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
-  TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
-                                         provider_index, end_of_splits));
+  TF_RETURN_IF_ERROR(
+      GetNextSplit(*request, *split_provider, split, end_of_splits));
   response->set_end_of_splits(end_of_splits);
   if (end_of_splits) {
     // Reset the split provider to prepare for the next iteration.
@@ -557,6 +567,61 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   return OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetNextSplit(const GetSplitRequest& request,
+                                               SplitProvider& split_provider,
+                                               Tensor& split,
+                                               bool& end_of_splits)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(get_split_mu_) {
+  const int64_t iteration_id = request.iteration_id();
+  const int64_t provider_index = request.split_provider_index();
+  PendingSplits& pending = pending_splits_[iteration_id][provider_index];
+  const std::vector<std::string> locality_tags(request.locality_tags().begin(),
+                                               request.locality_tags().end());
+  if (!locality_tags.empty()) {
+    for (auto it = pending.splits.begin(); it != pending.splits.end(); ++it) {
+      if (IsLocalSplit(*it, locality_tags)) {
+        split = std::move(*it);
+        pending.splits.erase(it);
+        return OkStatus();
+      }
+    }
+    // Looks ahead for a local split. The journal can only restore the split
+    // providers' positions, so the pending splits are not fault tolerant.
+    constexpr size_t kMaxPendingSplits = 16;
+    while (!config_.fault_tolerant_mode() && !pending.end_of_splits &&
+           pending.splits.size() < kMaxPendingSplits) {
+      Tensor next;
+      TF_RETURN_IF_ERROR(split_provider.GetNext(&next, &pending.end_of_splits));
+      if (pending.end_of_splits) {
+        break;
+      }
+      TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, request.repetition(),
+                                             provider_index,
+                                             /*finished=*/false));
+      if (IsLocalSplit(next, locality_tags)) {
+        split = std::move(next);
+        return OkStatus();
+      }
+      pending.splits.push_back(std::move(next));
+    }
+  }
+
+  // Otherwise, the worker gets a remote split, oldest first.
+  if (!pending.splits.empty()) {
+    split = std::move(pending.splits.front());
+    pending.splits.pop_front();
+    return OkStatus();
+  }
+  if (pending.end_of_splits) {
+    end_of_splits = true;
+    pending.end_of_splits = false;
+  } else {
+    TF_RETURN_IF_ERROR(split_provider.GetNext(&split, &end_of_splits));
+  }
+  return RecordSplitProduced(iteration_id, request.repetition(), provider_index,
+                             end_of_splits);
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -917,6 +982,11 @@ Status DataServiceDispatcherImpl::CreateTasksForIteration(
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    // Statically sharded iterations need a task on every worker.
+    if (draining_workers_.contains(worker->address) &&
+        !IsStaticShard(iteration->job->processing_mode)) {
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1134,6 +1204,10 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_iteration_id(iteration->iteration_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
+    if (iteration->IsRoundRobin() &&
+        draining_workers_.contains(task->worker_address)) {
+      response->add_draining_task_ids(task->task_id);
+    }
   }
   response->set_iteration_finished(iteration->finished);
   response->set_deployment_mode(config_.deployment_mode());
@@ -1348,49 +1422,146 @@ Status DataServiceDispatcherImpl::ApplyWithoutJournaling(const Update& update)
 
 Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  if (journal_writer_.has_value()) {
+  if (group_commit_journal_writer_ != nullptr) {
+    // Queued while holding `mu_`, so that the journal order matches the order
+    // in which the updates are applied.
+    group_commit_journal_writer_->Append(update);
+  } else if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
   }
   return state_.Apply(update);
 }
 
+Status DataServiceDispatcherImpl::SyncJournal() TF_LOCKS_EXCLUDED(mu_) {
+  GroupCommitJournalWriter* writer;
+  {
+    tf_shared_lock l(mu_);
+    writer = group_commit_journal_writer_.get();
+  }
+  // The writer lives as long as the dispatcher once it is started.
+  return writer == nullptr ? OkStatus() : writer->Sync();
+}
+
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
-    }
+    std::optional<WorkerPoolResizeRequest> resize_request;
     {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
+      }
+      if (cancelled_) {
+        return;
+      }
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+      {
+        Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          LOG(WARNING) << "Error updating the optimal number of workers metric "
+                          "in tf.data service AutoScaler: "
+                       << s;
+        }
       }
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      resize_request = GetWorkerPoolResizeRequest();
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
     }
-    {
-      Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
+    // The resizer may talk to a cluster manager, so don't hold `mu_`.
+    if (resize_request.has_value()) {
+      Status s = worker_pool_resizer_->Resize(*resize_request);
       if (!s.ok()) {
-        LOG(WARNING) << "Error updating the optimal number of workers metric "
-                        "in tf.data service AutoScaler: "
-                     << s;
+        LOG(WARNING) << "Error resizing the tf.data service worker pool to "
+                     << resize_request->target_number_of_workers
+                     << " workers: " << s;
       }
     }
-    {
-      Status s = GcOldIterations();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+  }
+}
+
+std::optional<WorkerPoolResizeRequest>
+DataServiceDispatcherImpl::GetWorkerPoolResizeRequest()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  const int64_t current_number_of_workers =
+      latest_worker_heartbeats_time_.size();
+  if (worker_pool_resizer_ == nullptr || current_number_of_workers == 0) {
+    return std::nullopt;
+  }
+  StatusOr<int64_t> target_number_of_workers =
+      auto_scaler_.GetBoundedOptimalNumberOfWorkers(current_number_of_workers);
+  if (!target_number_of_workers.ok()) {
+    VLOG(1) << "Not resizing the tf.data service worker pool: "
+            << target_number_of_workers.status();
+    return std::nullopt;
+  }
+  const int64_t num_surplus_workers =
+      current_number_of_workers - *target_number_of_workers;
+  if (num_surplus_workers <= 0 && !draining_workers_.empty()) {
+    LOG(INFO) << "Cancelling the drain of " << draining_workers_.size()
+              << " tf.data service workers.";
+    draining_workers_.clear();
+  }
+  if (num_surplus_workers > static_cast<int64_t>(draining_workers_.size())) {
+    // Drain the workers with the least remaining work first.
+    std::vector<std::pair<int64_t, std::string>> candidates;
+    for (const auto& [worker_address, unused] :
+         latest_worker_heartbeats_time_) {
+      if (!draining_workers_.contains(worker_address)) {
+        candidates.push_back(
+            {NumTasksForUnfinishedIterations(worker_address), worker_address});
       }
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
+    std::sort(candidates.begin(), candidates.end());
+    for (int64_t i = 0;
+         static_cast<int64_t>(draining_workers_.size()) < num_surplus_workers &&
+         i < candidates.size();
+         ++i) {
+      LOG(INFO) << "Draining surplus tf.data service worker "
+                << candidates[i].second;
+      draining_workers_.insert(candidates[i].second);
+    }
+  }
+
+  WorkerPoolResizeRequest request;
+  request.current_number_of_workers = current_number_of_workers;
+  request.target_number_of_workers = *target_number_of_workers;
+  for (const std::string& worker_address : draining_workers_) {
+    if (NumTasksForUnfinishedIterations(worker_address) == 0) {
+      request.drained_workers.push_back(worker_address);
+    }
+  }
+  std::sort(request.drained_workers.begin(), request.drained_workers.end());
+  if (num_surplus_workers == 0) {
+    return std::nullopt;
+  }
+  return request;
+}
+
+int64_t DataServiceDispatcherImpl::NumTasksForUnfinishedIterations(
+    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> tasks;
+  if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+    return 0;
   }
+  return std::count_if(tasks.begin(), tasks.end(),
+                       [](const std::shared_ptr<const Task>& task) {
+                         return !task->iteration->finished;
+                       });
 }
 
 void DataServiceDispatcherImpl::RemoveClientFromAutoScaler(int64_t client_id)
@@ -1466,6 +1637,7 @@ void DataServiceDispatcherImpl::DetectMissingWorkers()
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
+      draining_workers_.erase(it->first);
 
       latest_worker_heartbeats_time_.erase(it++);
     } else {
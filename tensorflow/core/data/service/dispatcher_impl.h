@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_DISPATCHER_IMPL_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -32,9 +33,11 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/dispatcher_state.h"
 #include "tensorflow/core/data/service/export.pb.h"
+#include "tensorflow/core/data/service/journal.h"
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker_pool_resizer.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -131,6 +134,24 @@ namespace data {
 // 7. Consumer 1 heartbeats. Dispatcher sends consumer 1 the task list
 //    containing the new task, and tells it that it no longer needs to block.
 //
+// **Resizing the worker pool**
+//
+// If `DispatcherConfig.worker_pool_resizer` names a registered
+// `WorkerPoolResizer`, the maintenance thread passes it the AutoScaler's
+// estimate of the optimal number of workers. When the estimate is below the
+// number of live workers, the dispatcher picks the surplus workers and drains
+// them:
+//
+// - Round-robin tasks on draining workers are reported to consumers in their
+//   heartbeats. Consumers then request task removal, and the `TaskRemover`
+//   makes sure that all consumers drop the task in the same round.
+// - Other tasks are drained by their iterations finishing.
+// - Workers without tasks for unfinished iterations are reported to the
+//   resizer as drained, and can be shut down.
+//
+// If the estimate increases again before drained workers are shut down, the
+// drain is cancelled. Removed tasks are not restored.
+//
 class DataServiceDispatcherImpl {
  public:
   explicit DataServiceDispatcherImpl(
@@ -148,6 +169,11 @@ class DataServiceDispatcherImpl {
   // Returns the number of active iterations.
   size_t NumActiveIterations() TF_LOCKS_EXCLUDED(mu_);
 
+  // Blocks until the updates applied so far are synced to the journal. RPCs
+  // must call this before responding when `journal_group_commit_window_ms` is
+  // set, since updates are then synced outside of `mu_`.
+  Status SyncJournal() TF_LOCKS_EXCLUDED(mu_);
+
   // See dispatcher.proto for API documentation.
 
   /// Worker-facing API.
@@ -205,6 +231,12 @@ class DataServiceDispatcherImpl {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Makes split providers for the specified `dataset_id`, and stores them in
   // `split_providers`.
+  // Gets the next split of `split_provider` for `request`, preferring splits
+  // local to the requesting worker.
+  Status GetNextSplit(const GetSplitRequest& request,
+                      SplitProvider& split_provider, Tensor& split,
+                      bool& end_of_splits)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(get_split_mu_);
   Status MakeSplitProviders(
       const std::string& dataset_id,
       std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -334,6 +366,14 @@ class DataServiceDispatcherImpl {
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Updates `draining_workers_` from the AutoScaler's estimate and returns the
+  // request to send to `worker_pool_resizer_`, if any.
+  std::optional<WorkerPoolResizeRequest> GetWorkerPoolResizeRequest()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the number of tasks the worker has for unfinished iterations. A
+  // draining worker without such tasks is drained.
+  int64_t NumTasksForUnfinishedIterations(const std::string& worker_address)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
   bool ShouldGcIteration(const DispatcherState::Iteration& iteration,
                          int64_t now_us) const;
@@ -366,6 +406,17 @@ class DataServiceDispatcherImpl {
   // Mapping from iteration id to the split providers for the iteration.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
+  // Splits which a split provider produced while looking for a split local to
+  // a worker. They go to the next workers without local splits. If
+  // `end_of_splits` is true, the split provider has no more splits, and the
+  // end is reported once the pending splits are taken.
+  struct PendingSplits {
+    std::deque<Tensor> splits;
+    bool end_of_splits = false;
+  };
+  // Mapping from iteration id and split provider index to the pending splits.
+  absl::flat_hash_map<int64_t, absl::flat_hash_map<int64_t, PendingSplits>>
+      pending_splits_ TF_GUARDED_BY(get_split_mu_);
   // Mapping from round robin iteration id to the round the iteration is
   // currently on. This is based on the data provided by client heartbeats,
   // and may be stale.
@@ -391,11 +442,19 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Replaces `journal_writer_` if `journal_group_commit_window_ms` is set.
+  std::unique_ptr<GroupCommitJournalWriter> group_commit_journal_writer_
+      TF_GUARDED_BY(mu_);
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
   std::unique_ptr<Thread> maintenance_thread_;
   MultipleIterationsAutoScaler auto_scaler_;
+  // Acts on the estimate of `auto_scaler_`. Null unless
+  // `config_.worker_pool_resizer()` is set.
+  std::unique_ptr<WorkerPoolResizer> worker_pool_resizer_;
+  // Surplus workers which are being drained for `worker_pool_resizer_`.
+  absl::flat_hash_set<std::string> draining_workers_ TF_GUARDED_BY(mu_);
 
   DataServiceDispatcherImpl(const DataServiceDispatcherImpl&) = delete;
   void operator=(const DataServiceDispatcherImpl&) = delete;
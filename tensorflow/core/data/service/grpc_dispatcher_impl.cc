@@ -49,7 +49,11 @@ DispatcherStateExport GrpcDispatcherImpl::ExportState() const {
   grpc::Status GrpcDispatcherImpl::method(ServerContext* context,         \
                                           const method##Request* request, \
                                           method##Response* response) {   \
-    return ToGrpcStatus(impl_.method(request, response));                 \
+    Status s = impl_.method(request, response);                           \
+    if (s.ok()) {                                                         \
+      s = impl_.SyncJournal();                                            \
+    }                                                                     \
+    return ToGrpcStatus(s);                                               \
   }
 HANDLER(WorkerHeartbeat);
 HANDLER(WorkerUpdate);
@@ -18,10 +18,13 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -77,21 +80,105 @@ Status FileJournalWriter::EnsureInitialized() {
 }
 
 Status FileJournalWriter::Write(const Update& update) {
+  return WriteBatch(absl::MakeConstSpan(&update, 1));
+}
+
+Status FileJournalWriter::WriteBatch(absl::Span<const Update> updates) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
-  std::string s = update.SerializeAsString();
-  if (s.empty()) {
-    return errors::Internal("Failed to serialize update ", update.DebugString(),
-                            " to string");
+  for (const Update& update : updates) {
+    std::string s = update.SerializeAsString();
+    if (s.empty()) {
+      return errors::Internal("Failed to serialize update ",
+                              update.DebugString(), " to string");
+    }
+    TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
   }
-  TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
   TF_RETURN_IF_ERROR(writer_->Flush());
   TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
-    VLOG(4) << "Wrote journal entry: " << update.DebugString();
+    for (const Update& update : updates) {
+      VLOG(4) << "Wrote journal entry: " << update.DebugString();
+    }
   }
   return OkStatus();
 }
 
+GroupCommitJournalWriter::GroupCommitJournalWriter(
+    Env* env, std::unique_ptr<JournalWriter> writer,
+    absl::Duration commit_window)
+    : env_(env), writer_(std::move(writer)), commit_window_(commit_window) {
+  commit_thread_ = absl::WrapUnique(env_->StartThread(
+      {}, "tf_data_journal_commit", [this]() { CommitThread(); }));
+}
+
+GroupCommitJournalWriter::~GroupCommitJournalWriter() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+  }
+  cv_.notify_all();
+  // Joins the thread once the pending updates are written.
+  commit_thread_.reset();
+}
+
+void GroupCommitJournalWriter::Append(const Update& update) {
+  {
+    mutex_lock l(mu_);
+    pending_.push_back(update);
+    ++num_appended_;
+  }
+  cv_.notify_all();
+}
+
+Status GroupCommitJournalWriter::Sync() {
+  mutex_lock l(mu_);
+  const int64_t num_appended = num_appended_;
+  while (status_.ok() && num_committed_ < num_appended) {
+    cv_.wait(l);
+  }
+  return status_;
+}
+
+void GroupCommitJournalWriter::CommitThread() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && pending_.empty()) {
+        cv_.wait(l);
+      }
+      if (pending_.empty()) {
+        return;
+      }
+    }
+    // Lets the updates of concurrent requests join the commit.
+    if (commit_window_ > absl::ZeroDuration()) {
+      env_->SleepForMicroseconds(absl::ToInt64Microseconds(commit_window_));
+    }
+    std::vector<Update> updates;
+    int64_t num_appended;
+    {
+      mutex_lock l(mu_);
+      updates.swap(pending_);
+      num_appended = num_appended_;
+      if (!status_.ok()) {
+        continue;
+      }
+    }
+    Status s = writer_->WriteBatch(updates);
+    {
+      mutex_lock l(mu_);
+      if (s.ok()) {
+        num_committed_ = num_appended;
+      } else {
+        LOG(ERROR) << "Failed to write " << updates.size()
+                   << " journal entries: " << s;
+        status_ = s;
+      }
+    }
+    cv_.notify_all();
+  }
+}
+
 FileJournalReader::FileJournalReader(Env* env, StringPiece journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
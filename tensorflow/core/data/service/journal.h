@@ -15,14 +15,20 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_JOURNAL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -37,6 +43,8 @@ class JournalWriter {
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes the updates to the journal in order, and syncs them once.
+  virtual Status WriteBatch(absl::Span<const Update> updates) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -67,6 +75,7 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteBatch(absl::Span<const Update> updates) override;
   Status EnsureInitialized() override;
 
  private:
@@ -76,6 +85,48 @@ class FileJournalWriter : public JournalWriter {
   std::unique_ptr<io::RecordWriter> writer_;
 };
 
+// GroupCommitJournalWriter writes the updates appended by any number of threads
+// from a background thread, so that the updates appended within
+// `commit_window` of each other are written and synced together instead of
+// paying for one sync each.
+//
+// GroupCommitJournalWriter is thread-safe. The updates are written in the order
+// of the calls to `Append`.
+class GroupCommitJournalWriter {
+ public:
+  // The writer must already be initialized.
+  GroupCommitJournalWriter(Env* env, std::unique_ptr<JournalWriter> writer,
+                           absl::Duration commit_window);
+  // Writes the updates which are still pending.
+  ~GroupCommitJournalWriter();
+  GroupCommitJournalWriter(const GroupCommitJournalWriter&) = delete;
+  GroupCommitJournalWriter& operator=(const GroupCommitJournalWriter&) = delete;
+
+  // Queues `update` to be written after the previously appended updates.
+  void Append(const Update& update);
+  // Blocks until all the updates appended so far are written and synced.
+  // Returns the error of any failed write, after which the journal is no
+  // longer written.
+  Status Sync();
+
+ private:
+  void CommitThread();
+
+  Env* const env_;
+  const std::unique_ptr<JournalWriter> writer_;
+  const absl::Duration commit_window_;
+
+  mutex mu_;
+  condition_variable cv_;
+  std::vector<Update> pending_ TF_GUARDED_BY(mu_);
+  // Numbers of updates appended and committed since the construction.
+  int64_t num_appended_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_committed_ TF_GUARDED_BY(mu_) = 0;
+  Status status_ TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> commit_thread_;
+};
+
 // Interface for reading from a journal.
 class JournalReader {
  public:
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -115,6 +116,25 @@ TEST(Journal, AppendExistingJournal) {
   TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
 }
 
+TEST(Journal, GroupCommit) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  std::vector<Update> updates = {MakeCreateIterationUpdate(),
+                                 MakeRegisterDatasetUpdate(),
+                                 MakeFinishTaskUpdate()};
+  auto file_writer =
+      std::make_unique<FileJournalWriter>(Env::Default(), journal_dir);
+  TF_ASSERT_OK(file_writer->EnsureInitialized());
+  GroupCommitJournalWriter writer(Env::Default(), std::move(file_writer),
+                                  absl::Milliseconds(10));
+  for (const auto& update : updates) {
+    writer.Append(update);
+  }
+  TF_ASSERT_OK(writer.Sync());
+
+  TF_EXPECT_OK(CheckJournalContent(journal_dir, updates));
+}
+
 TEST(Journal, MissingFile) {
   std::string journal_dir;
   EXPECT_TRUE(NewJournalDir(journal_dir));
@@ -0,0 +1,593 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_transfer.h"
+
+#if !defined(_WIN32)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tsl/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64_t kDefaultBufferBytes = int64_t{256} << 20;
+// Blocks and the tensors within them are aligned to this many bytes, which
+// satisfies the Eigen alignment requirement for tensor buffers.
+constexpr int64_t kBlockAlignment = 64;
+
+constexpr uint32_t kBlockInUse = 1;
+constexpr uint32_t kBlockReleased = 2;
+
+// Header at the start of every block of the ring. The server marks a block in
+// use when it writes an element, the client marks it released when it no
+// longer references the element.
+struct BlockHeader {
+  std::atomic<uint32_t> state;
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Block headers are shared between processes.");
+static_assert(sizeof(BlockHeader) <= kBlockAlignment);
+
+int64_t AlignUp(int64_t n) {
+  return (n + kBlockAlignment - 1) / kBlockAlignment * kBlockAlignment;
+}
+
+// A mapping of a named POSIX shared memory object.
+class SharedMemoryRegion {
+ public:
+  // Creates and maps a new shared memory object, which is unlinked when the
+  // returned region is destroyed. Existing mappings stay valid.
+  static StatusOr<std::shared_ptr<SharedMemoryRegion>> Create(
+      const std::string& name, int64_t size) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+      return errors::Internal("Failed to create shared memory region ", name,
+                              ": ", strerror(errno));
+    }
+    auto close_fd = gtl::MakeCleanup([fd] { close(fd); });
+    if (ftruncate(fd, size) != 0) {
+      shm_unlink(name.c_str());
+      return errors::ResourceExhausted("Failed to size shared memory region ",
+                                       name, " to ", size,
+                                       " bytes: ", strerror(errno));
+    }
+    return Map(fd, name, size, /*owner=*/true);
+  }
+
+  // Maps an existing shared memory object.
+  static StatusOr<std::shared_ptr<SharedMemoryRegion>> Open(
+      const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+      return errors::FailedPrecondition("Failed to open shared memory region ",
+                                        name, ": ", strerror(errno));
+    }
+    auto close_fd = gtl::MakeCleanup([fd] { close(fd); });
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      return errors::Internal("Failed to stat shared memory region ", name,
+                              ": ", strerror(errno));
+    }
+    return Map(fd, name, st.st_size, /*owner=*/false);
+  }
+
+  ~SharedMemoryRegion() {
+    munmap(data_, size_);
+    if (owner_) {
+      shm_unlink(name_.c_str());
+    }
+  }
+
+  char* data() const { return data_; }
+  int64_t size() const { return size_; }
+  const std::string& name() const { return name_; }
+
+ private:
+  SharedMemoryRegion(std::string name, char* data, int64_t size, bool owner)
+      : name_(std::move(name)), data_(data), size_(size), owner_(owner) {}
+
+  static StatusOr<std::shared_ptr<SharedMemoryRegion>> Map(
+      int fd, const std::string& name, int64_t size, bool owner) {
+    void* data =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+      if (owner) shm_unlink(name.c_str());
+      return errors::Internal("Failed to map shared memory region ", name,
+                              ": ", strerror(errno));
+    }
+    return std::shared_ptr<SharedMemoryRegion>(new SharedMemoryRegion(
+        name, static_cast<char*>(data), size, owner));
+  }
+
+  const std::string name_;
+  char* const data_;
+  const int64_t size_;
+  const bool owner_;
+};
+
+BlockHeader* GetBlockHeader(const SharedMemoryRegion& region, int64_t offset) {
+  return reinterpret_cast<BlockHeader*>(region.data() + offset);
+}
+
+// Hands out blocks of a shared memory region in FIFO order. A block is reused
+// once it and all blocks allocated before it have been released, so a client
+// that holds on to an element only delays reuse and never blocks the server:
+// when the ring is full, elements are sent inline instead.
+class BlockRing {
+ public:
+  explicit BlockRing(std::shared_ptr<SharedMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  // Returns the offset of a new block of `size` bytes, with its header marked
+  // in use, or -1 if there is no room for it.
+  int64_t Allocate(int64_t size) {
+    Reclaim();
+    const int64_t capacity = region_->size();
+    size = AlignUp(size);
+    int64_t offset = -1;
+    if (blocks_.empty()) {
+      head_ = 0;
+      if (size <= capacity) offset = 0;
+    } else if (head_ > blocks_.front().offset) {
+      // The used space is [front, head_), try the end and then the start.
+      if (head_ + size <= capacity) {
+        offset = head_;
+      } else if (size <= blocks_.front().offset) {
+        offset = 0;
+      }
+    } else if (head_ + size <= blocks_.front().offset) {
+      // The used space wraps around, the free space is [head_, front).
+      offset = head_;
+    }
+    if (offset < 0) {
+      return -1;
+    }
+    new (GetBlockHeader(*region_, offset)) BlockHeader{{kBlockInUse}};
+    blocks_.push_back({offset, size});
+    head_ = offset + size;
+    return offset;
+  }
+
+ private:
+  struct Block {
+    int64_t offset;
+    int64_t size;
+  };
+
+  void Reclaim() {
+    while (!blocks_.empty() &&
+           GetBlockHeader(*region_, blocks_.front().offset)
+                   ->state.load(std::memory_order_acquire) == kBlockReleased) {
+      blocks_.pop_front();
+    }
+  }
+
+  const std::shared_ptr<SharedMemoryRegion> region_;
+  std::deque<Block> blocks_;
+  int64_t head_ = 0;
+};
+
+// Fills `resp` with the element's contents.  Like the grpc worker, sends a
+// single CompressedElement variant as is and serializes any other tensors.
+Status MoveElementToInlineResponse(std::vector<Tensor>&& element,
+                                   GetElementResponse& resp) {
+  if (element.size() != 1 || element[0].dtype() != DT_VARIANT ||
+      !TensorShapeUtils::IsScalar(element[0].shape())) {
+    for (const auto& component : element) {
+      component.AsProtoTensorContent(
+          resp.mutable_uncompressed()->add_components());
+    }
+    return OkStatus();
+  }
+  Variant& variant = element[0].scalar<Variant>()();
+  CompressedElement* compressed = variant.get<CompressedElement>();
+  if (compressed == nullptr) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a CompressedElement variant tensor, but "
+        "it produced ",
+        variant.TypeName());
+  }
+  *resp.mutable_compressed() = std::move(*compressed);
+  return OkStatus();
+}
+
+class ShmDataTransferServer : public DataTransferServer {
+ public:
+  explicit ShmDataTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)), service_(this) {}
+
+  ~ShmDataTransferServer() override {
+    if (server_) {
+      server_->Shutdown();
+    }
+  }
+
+  Status Start() override {
+    int64_t buffer_bytes;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_DATA_SHM_TRANSFER_BUFFER_BYTES",
+                                           kDefaultBufferBytes,
+                                           &buffer_bytes));
+    std::string name = absl::StrCat("/tf_data_shm_", getpid(), "_",
+                                    random::New64());
+    TF_ASSIGN_OR_RETURN(region_, SharedMemoryRegion::Create(
+                                     name, AlignUp(buffer_bytes)));
+    ring_ = std::make_unique<BlockRing>(region_);
+
+    // Only clients on this host can use the protocol, so only listen on the
+    // loopback interface.
+    ::grpc::ServerBuilder builder;
+    builder.AddListeningPort("localhost:0",
+                             ::grpc::InsecureServerCredentials(), &port_);
+    builder.SetMaxReceiveMessageSize(-1);
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    if (!server_) {
+      return errors::Internal("Could not start the shm transfer gRPC server");
+    }
+    VLOG(1) << "Started shm data transfer server on port " << port_
+            << " with region " << name;
+    return OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+  StatusOr<std::string> GetCompatibilityInfo() const override {
+    SharedMemoryTransferInfo info;
+    info.set_hostname(port::Hostname());
+    info.set_region_name(region_->name());
+    return info.SerializeAsString();
+  }
+
+ private:
+  class Service : public WorkerService::Service {
+   public:
+    explicit Service(ShmDataTransferServer* server) : server_(server) {}
+
+    ::grpc::Status GetElement(::grpc::ServerContext* context,
+                              const GetElementRequest* request,
+                              GetElementResponse* response) override {
+      return ToGrpcStatus(server_->GetElement(*request, *response));
+    }
+
+   private:
+    ShmDataTransferServer* const server_;
+  };
+
+  Status GetElement(const GetElementRequest& request,
+                    GetElementResponse& response) {
+    GetElementResult result;
+    TF_RETURN_IF_ERROR(get_element_(&request, &result));
+    response.set_element_index(result.element_index);
+    response.set_end_of_sequence(result.end_of_sequence);
+    response.set_skip_task(result.skip);
+    if (result.components.empty()) {
+      return OkStatus();
+    }
+    if (WriteToSharedMemory(result.components,
+                            *response.mutable_shared_memory())) {
+      return OkStatus();
+    }
+    response.clear_shared_memory();
+    return MoveElementToInlineResponse(std::move(result.components), response);
+  }
+
+  // Copies the components into a new block of the ring. Returns false if the
+  // components can't be placed in shared memory.
+  bool WriteToSharedMemory(const std::vector<Tensor>& components,
+                           SharedMemoryElement& element) {
+    int64_t block_size = kBlockAlignment;
+    for (const Tensor& component : components) {
+      if (!DataTypeCanUseMemcpy(component.dtype())) {
+        return false;
+      }
+      block_size += AlignUp(component.TotalBytes());
+    }
+    int64_t block_offset;
+    {
+      mutex_lock l(mu_);
+      block_offset = ring_->Allocate(block_size);
+    }
+    if (block_offset < 0) {
+      VLOG(2) << "Shared memory ring is full, sending element inline.";
+      return false;
+    }
+    element.set_region_name(region_->name());
+    element.set_block_offset(block_offset);
+    int64_t offset = block_offset + kBlockAlignment;
+    for (const Tensor& component : components) {
+      const StringPiece data = component.tensor_data();
+      std::memcpy(region_->data() + offset, data.data(), data.size());
+      SharedMemoryElement::Component* proto = element.add_components();
+      proto->set_dtype(component.dtype());
+      component.shape().AsProto(proto->mutable_shape());
+      proto->set_offset(offset);
+      proto->set_size(data.size());
+      offset += AlignUp(data.size());
+    }
+    return true;
+  }
+
+  const GetElementT get_element_;
+  Service service_;
+  std::unique_ptr<::grpc::Server> server_;
+  int port_ = 0;
+  std::shared_ptr<SharedMemoryRegion> region_;
+
+  mutex mu_;
+  std::unique_ptr<BlockRing> ring_ TF_GUARDED_BY(mu_);
+};
+
+// Marks a block of the ring released when the last tensor pointing into it is
+// destroyed.
+class BlockReference {
+ public:
+  BlockReference(std::shared_ptr<SharedMemoryRegion> region, int64_t offset)
+      : region_(std::move(region)), offset_(offset) {}
+
+  ~BlockReference() {
+    GetBlockHeader(*region_, offset_)
+        ->state.store(kBlockReleased, std::memory_order_release);
+  }
+
+ private:
+  const std::shared_ptr<SharedMemoryRegion> region_;
+  const int64_t offset_;
+};
+
+class ShmTensorBuffer : public TensorBuffer {
+ public:
+  ShmTensorBuffer(std::shared_ptr<BlockReference> block, void* data,
+                  size_t size)
+      : TensorBuffer(data), block_(std::move(block)), size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(size_));
+    proto->set_allocator_name("DataServiceSharedMemory");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+ private:
+  const std::shared_ptr<BlockReference> block_;
+  const size_t size_;
+};
+
+class ShmDataTransferClient : public DataTransferClient {
+ public:
+  explicit ShmDataTransferClient(const std::string& address) {
+    VLOG(2) << "Create ShmDataTransferClient for worker " << address << ".";
+    ::grpc::ChannelArguments args;
+    args.SetMaxReceiveMessageSize(-1);
+    auto channel = ::grpc::CreateCustomChannel(
+        address, ::grpc::InsecureChannelCredentials(), args);
+    stub_ = WorkerService::NewStub(channel);
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    VLOG(3) << "GetElement for task " << req.task_id() << " from shm worker "
+            << "server.";
+    ::grpc::ClientContext ctx;
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      active_contexts_.insert(&ctx);
+    }
+    auto cleanup = gtl::MakeCleanup([this, &ctx] {
+      mutex_lock l(mu_);
+      active_contexts_.erase(&ctx);
+    });
+    GetElementResponse resp;
+    int64_t start_time_us = env_->NowMicros();
+    ::grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    int64_t end_time_us = env_->NowMicros();
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    metrics::RecordTFDataServiceGetElementDuration(kShmTransferProtocol,
+                                                   end_time_us - start_time_us);
+    result.element_index = resp.element_index();
+    result.end_of_sequence = resp.end_of_sequence();
+    result.skip = resp.skip_task();
+    switch (resp.element_case()) {
+      case GetElementResponse::kSharedMemory:
+        return ReadFromSharedMemory(resp.shared_memory(), result);
+      case GetElementResponse::kCompressed: {
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(*resp.mutable_compressed());
+        result.components.push_back(tensor);
+        break;
+      }
+      case GetElementResponse::kUncompressed:
+        for (const auto& component : resp.uncompressed().components()) {
+          result.components.emplace_back();
+          if (!result.components.back().FromProto(component)) {
+            return errors::Internal("Failed to parse tensor.");
+          }
+        }
+        break;
+      case GetElementResponse::ELEMENT_NOT_SET:
+        break;
+    }
+    return OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel ShmDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+  Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    SharedMemoryTransferInfo info;
+    if (!info.ParseFromString(server_compatibility_info)) {
+      return errors::Internal(
+          "Failed to parse shm transfer compatibility info.");
+    }
+    if (info.hostname() != port::Hostname()) {
+      return errors::FailedPrecondition(
+          "The shm transfer is only supported for workers on the same host, "
+          "but the worker runs on ",
+          info.hostname(), " and the client on ", port::Hostname(), ".");
+    }
+    // Hosts may share a hostname without sharing memory, e.g. containers.
+    return SharedMemoryRegion::Open(info.region_name()).status();
+  }
+
+ private:
+  Status ReadFromSharedMemory(const SharedMemoryElement& element,
+                              GetElementResult& result) {
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<SharedMemoryRegion> region,
+                        GetRegion(element.region_name()));
+    auto in_region = [&region](int64_t offset, int64_t size) {
+      return offset >= 0 && size >= 0 && offset <= region->size() - size;
+    };
+    if (!in_region(element.block_offset(), kBlockAlignment)) {
+      return errors::Internal("Invalid shared memory block offset ",
+                              element.block_offset());
+    }
+    auto block = std::make_shared<BlockReference>(region,
+                                                  element.block_offset());
+    for (const SharedMemoryElement::Component& component :
+         element.components()) {
+      TF_ASSIGN_OR_RETURN(TensorShape shape,
+                          TensorShape::BuildTensorShape(component.shape()));
+      if (!DataTypeCanUseMemcpy(component.dtype()) ||
+          !in_region(component.offset(), component.size()) ||
+          shape.num_elements() * DataTypeSize(component.dtype()) !=
+          component.size()) {
+        return errors::Internal("Invalid shared memory element component ",
+                                component.ShortDebugString());
+      }
+      core::RefCountPtr<TensorBuffer> buf(
+          new ShmTensorBuffer(block, region->data() + component.offset(),
+                              component.size()));
+      result.components.emplace_back(component.dtype(), std::move(shape),
+                                     std::move(buf));
+    }
+    return OkStatus();
+  }
+
+  StatusOr<std::shared_ptr<SharedMemoryRegion>> GetRegion(
+      const std::string& name) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    auto it = regions_.find(name);
+    if (it != regions_.end()) {
+      return it->second;
+    }
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<SharedMemoryRegion> region,
+                        SharedMemoryRegion::Open(name));
+    regions_[name] = region;
+    return region;
+  }
+
+  mutex mu_;
+  std::unique_ptr<WorkerService::Stub> stub_;
+  // Set of all currently active clients contexts. Used to support
+  // cancellation.
+  absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
+      TF_GUARDED_BY(mu_);
+  // Indicates that the client has been cancelled, so no further requests should
+  // be accepted.
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Mapped regions, keyed by name. Tensors keep their region mapped after the
+  // client is destroyed.
+  absl::flat_hash_map<std::string, std::shared_ptr<SharedMemoryRegion>>
+      regions_ TF_GUARDED_BY(mu_);
+};
+
+class ShmTransferRegistrar {
+ public:
+  ShmTransferRegistrar() {
+    DataTransferServer::Register(
+        kShmTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* out) {
+          *out = std::make_shared<ShmDataTransferServer>(get_element);
+          return OkStatus();
+        });
+    DataTransferClient::Register(
+        kShmTransferProtocol, [](DataTransferClient::Config config,
+                                 std::unique_ptr<DataTransferClient>* out) {
+          *out = std::make_unique<ShmDataTransferClient>(config.address);
+          return OkStatus();
+        });
+  }
+};
+static ShmTransferRegistrar shm_transfer_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // !defined(_WIN32)
@@ -0,0 +1,42 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHM_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHM_TRANSFER_H_
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for clients running on the same host as the tf.data
+// service worker.
+//
+// The "shm" DataTransferServer listens for GetElement requests on a loopback
+// gRPC port, but writes the contents of element tensors into a shared memory
+// ring buffer instead of serializing them into the response. The client maps
+// the ring and returns tensors that point directly into it. A block of the
+// ring is reused once the client destroys all tensors referring to it.
+//
+// Elements with non-POD components, and elements that don't fit into the free
+// space of the ring, are sent inline as with the grpc protocol. The size of
+// the ring defaults to 256MiB and can be set with the environment variable
+// TF_DATA_SHM_TRANSFER_BUFFER_BYTES on the worker.
+//
+// The compatibility check fails for clients on a different host, or which
+// cannot open the ring, in which case the client falls back to grpc.
+constexpr const char kShmTransferProtocol[] = "shm";
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHM_TRANSFER_H_
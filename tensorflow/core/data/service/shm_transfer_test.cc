@@ -0,0 +1,172 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shm_transfer.h"
+
+#include <stdlib.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+Tensor MakeInt64Tensor(int64_t value) {
+  Tensor tensor(DT_INT64, TensorShape({256}));
+  tensor.flat<int64_t>().setConstant(value);
+  return tensor;
+}
+
+bool InSharedMemory(const Tensor& tensor) {
+  TensorDescription description;
+  tensor.FillDescription(&description);
+  return description.allocation_description().allocator_name() ==
+         "DataServiceSharedMemory";
+}
+
+class ShmTransferTest : public ::testing::Test {
+ protected:
+  // Starts a server producing `num_elements` elements from `make_element`
+  // and connects a client to it.
+  void Start(int64_t num_elements,
+             std::function<std::vector<Tensor>(int64_t)> make_element) {
+    TF_ASSERT_OK(DataTransferServer::Build(
+        kShmTransferProtocol,
+        [this, num_elements, make_element](const GetElementRequest* request,
+                                           GetElementResult* result) {
+          result->element_index = next_index_;
+          if (next_index_ == num_elements) {
+            result->end_of_sequence = true;
+            return OkStatus();
+          }
+          result->components = make_element(next_index_++);
+          return OkStatus();
+        },
+        &server_));
+    TF_ASSERT_OK(server_->Start());
+    TF_ASSERT_OK(DataTransferClient::Build(
+        kShmTransferProtocol,
+        {kShmTransferProtocol, absl::StrCat("localhost:", server_->Port())},
+        &client_));
+    TF_ASSERT_OK_AND_ASSIGN(std::string info,
+                            server_->GetCompatibilityInfo());
+    TF_ASSERT_OK(client_->CheckCompatibility(info));
+  }
+
+  GetElementResult GetElement() {
+    GetElementRequest request;
+    GetElementResult result;
+    TF_EXPECT_OK(client_->GetElement(request, result));
+    return result;
+  }
+
+  int64_t next_index_ = 0;
+  std::shared_ptr<DataTransferServer> server_;
+  std::unique_ptr<DataTransferClient> client_;
+};
+
+TEST_F(ShmTransferTest, TransfersElementsThroughSharedMemory) {
+  Start(/*num_elements=*/3, [](int64_t i) {
+    return std::vector<Tensor>{MakeInt64Tensor(i),
+                               test::AsTensor<float>({1.0f * i, 2.0f * i})};
+  });
+  for (int64_t i = 0; i < 3; ++i) {
+    GetElementResult result = GetElement();
+    EXPECT_EQ(result.element_index, i);
+    EXPECT_FALSE(result.end_of_sequence);
+    ASSERT_EQ(result.components.size(), 2);
+    EXPECT_TRUE(InSharedMemory(result.components[0]));
+    EXPECT_TRUE(InSharedMemory(result.components[1]));
+    test::ExpectEqual(result.components[0], MakeInt64Tensor(i));
+    test::ExpectEqual(result.components[1],
+                      test::AsTensor<float>({1.0f * i, 2.0f * i}));
+  }
+  EXPECT_TRUE(GetElement().end_of_sequence);
+}
+
+TEST_F(ShmTransferTest, SendsStringsInline) {
+  Start(/*num_elements=*/1, [](int64_t i) {
+    return std::vector<Tensor>{test::AsTensor<tstring>({"a", "b"})};
+  });
+  GetElementResult result = GetElement();
+  ASSERT_EQ(result.components.size(), 1);
+  EXPECT_FALSE(InSharedMemory(result.components[0]));
+  test::ExpectEqual(result.components[0], test::AsTensor<tstring>({"a", "b"}));
+}
+
+TEST_F(ShmTransferTest, ReusesBlocksOnceReleased) {
+  // Room for a single 2KiB element.
+  setenv("TF_DATA_SHM_TRANSFER_BUFFER_BYTES", "4096", /*overwrite=*/1);
+  Start(/*num_elements=*/3, [](int64_t i) {
+    return std::vector<Tensor>{MakeInt64Tensor(i)};
+  });
+  unsetenv("TF_DATA_SHM_TRANSFER_BUFFER_BYTES");
+
+  GetElementResult first = GetElement();
+  EXPECT_TRUE(InSharedMemory(first.components[0]));
+  // The ring is full while the first element is alive.
+  GetElementResult second = GetElement();
+  EXPECT_FALSE(InSharedMemory(second.components[0]));
+  test::ExpectEqual(second.components[0], MakeInt64Tensor(1));
+
+  test::ExpectEqual(first.components[0], MakeInt64Tensor(0));
+  first.components.clear();
+  GetElementResult third = GetElement();
+  EXPECT_TRUE(InSharedMemory(third.components[0]));
+  test::ExpectEqual(third.components[0], MakeInt64Tensor(2));
+}
+
+TEST_F(ShmTransferTest, IncompatibleWithRemoteWorkers) {
+  Start(/*num_elements=*/0, [](int64_t i) { return std::vector<Tensor>(); });
+  TF_ASSERT_OK_AND_ASSIGN(std::string serialized,
+                          server_->GetCompatibilityInfo());
+  SharedMemoryTransferInfo info;
+  ASSERT_TRUE(info.ParseFromString(serialized));
+
+  SharedMemoryTransferInfo other_host = info;
+  other_host.set_hostname(absl::StrCat("not-", port::Hostname()));
+  EXPECT_THAT(client_->CheckCompatibility(other_host.SerializeAsString()),
+              StatusIs(error::FAILED_PRECONDITION));
+
+  SharedMemoryTransferInfo missing_region = info;
+  missing_region.set_region_name("/tf_data_shm_does_not_exist");
+  EXPECT_THAT(client_->CheckCompatibility(missing_region.SerializeAsString()),
+              StatusIs(error::FAILED_PRECONDITION));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
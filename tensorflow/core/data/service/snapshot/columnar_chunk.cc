@@ -0,0 +1,336 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tensorflow/core/util/batch_util.h"
+#include "tsl/lib/io/compression.h"
+#include "tsl/lib/io/record_reader.h"
+#include "tsl/lib/io/record_writer.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/snappy.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::data::experimental::ColumnarSnapshotBlock;
+
+// Snappy compresses each column, so the records themselves are not compressed.
+// Other compression methods apply to the whole record.
+std::string RecordCompression(const std::string& compression) {
+  return compression == tsl::io::compression::kSnappy
+             ? tsl::io::compression::kNone
+             : compression;
+}
+
+// Returns the batched shape of `num_elements` elements of `element_shape`.
+TensorShape BatchedShape(const TensorShape& element_shape,
+                         int64_t num_elements) {
+  TensorShape shape({num_elements});
+  shape.AppendShape(element_shape);
+  return shape;
+}
+
+}  // namespace
+
+ColumnarChunkWriter::ColumnarChunkWriter(const std::string& filename,
+                                         const std::string& compression,
+                                         int64_t block_size_bytes)
+    : filename_(filename),
+      compression_(compression),
+      block_size_bytes_(block_size_bytes) {}
+
+ColumnarChunkWriter::~ColumnarChunkWriter() {
+  absl::Status s = Close();
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to close columnar snapshot chunk " << filename_
+               << ": " << s;
+  }
+}
+
+absl::Status ColumnarChunkWriter::Initialize(tsl::Env* env) {
+  TF_RETURN_IF_ERROR(env->NewAppendableFile(filename_, &dest_));
+  record_writer_ = std::make_unique<tsl::io::RecordWriter>(
+      dest_.get(), tsl::io::RecordWriterOptions::CreateRecordWriterOptions(
+                       RecordCompression(compression_)));
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkWriter::WriteTensors(
+    const std::vector<Tensor>& tensors) {
+  if (!FitsBlock(tensors)) {
+    TF_RETURN_IF_ERROR(WriteBlock());
+  }
+  for (const Tensor& tensor : tensors) {
+    block_bytes_ += tensor.TotalBytes();
+  }
+  block_.push_back(tensors);
+  if (block_bytes_ >= block_size_bytes_) {
+    TF_RETURN_IF_ERROR(WriteBlock());
+  }
+  return absl::OkStatus();
+}
+
+bool ColumnarChunkWriter::FitsBlock(const std::vector<Tensor>& tensors) const {
+  if (block_.empty()) {
+    return true;
+  }
+  const std::vector<Tensor>& first = block_.front();
+  if (first.size() != tensors.size()) {
+    return false;
+  }
+  for (int i = 0; i < tensors.size(); ++i) {
+    if (first[i].dtype() != tensors[i].dtype() ||
+        first[i].shape() != tensors[i].shape()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::Status ColumnarChunkWriter::WriteBlock() {
+  if (block_.empty()) {
+    return absl::OkStatus();
+  }
+  const int64_t num_elements = block_.size();
+  ColumnarSnapshotBlock block;
+  block.set_num_elements(num_elements);
+  for (int i = 0; i < block_.front().size(); ++i) {
+    const Tensor& first = block_.front()[i];
+    ColumnarSnapshotBlock::Column* column = block.add_columns();
+    column->set_dtype(first.dtype());
+    first.shape().AsProto(column->mutable_element_shape());
+
+    std::string data;
+    if (DataTypeCanUseMemcpy(first.dtype())) {
+      data.reserve(first.TotalBytes() * num_elements);
+      for (const std::vector<Tensor>& element : block_) {
+        absl::string_view bytes = element[i].tensor_data();
+        data.append(bytes.data(), bytes.size());
+      }
+    } else {
+      Tensor batched(first.dtype(), BatchedShape(first.shape(), num_elements));
+      for (int64_t j = 0; j < num_elements; ++j) {
+        TF_RETURN_IF_ERROR(
+            batch_util::CopyElementToSlice(block_[j][i], &batched, j));
+      }
+      TensorProto proto;
+      batched.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&data)) {
+        return absl::DataLossError(absl::StrCat(
+            "Failed to serialize column ", i, " of a tf.data snapshot block "
+            "in ", filename_, "."));
+      }
+    }
+
+    if (compression_ == tsl::io::compression::kSnappy) {
+      std::string compressed;
+      if (!tsl::port::Snappy_Compress(data.data(), data.size(), &compressed)) {
+        return absl::InternalError("Failed to compress using snappy.");
+      }
+      column->set_snappy_compressed(true);
+      data = std::move(compressed);
+    }
+    column->set_data(std::move(data));
+  }
+
+  block_.clear();
+  block_bytes_ = 0;
+  return record_writer_->WriteRecord(block.SerializeAsString());
+}
+
+absl::Status ColumnarChunkWriter::Sync() {
+  TF_RETURN_IF_ERROR(WriteBlock());
+  TF_RETURN_IF_ERROR(record_writer_->Flush());
+  return dest_->Flush();
+}
+
+absl::Status ColumnarChunkWriter::Close() {
+  if (record_writer_ != nullptr) {
+    TF_RETURN_IF_ERROR(Sync());
+    TF_RETURN_IF_ERROR(record_writer_->Close());
+    TF_RETURN_IF_ERROR(dest_->Close());
+    record_writer_ = nullptr;
+    dest_ = nullptr;
+  }
+  return absl::OkStatus();
+}
+
+ColumnarChunkReader::ColumnarChunkReader(
+    const std::string& filename, const std::string& compression,
+    const DataTypeVector& dtypes, std::optional<int64_t> output_buffer_size)
+    : filename_(filename),
+      compression_(compression),
+      dtypes_(dtypes),
+      output_buffer_size_(output_buffer_size) {}
+
+absl::Status ColumnarChunkReader::Initialize(tsl::Env* env) {
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
+  auto options = tsl::io::RecordReaderOptions::CreateRecordReaderOptions(
+      RecordCompression(compression_));
+#if !defined(IS_SLIM_BUILD)
+  if (output_buffer_size_.has_value()) {
+    options.zlib_options.output_buffer_size = *output_buffer_size_;
+  }
+#endif  // IS_SLIM_BUILD
+  record_reader_ =
+      std::make_unique<tsl::io::RecordReader>(file_.get(), options);
+  offset_ = 0;
+  bytes_read_ = 0;
+  columns_.clear();
+  num_elements_ = 0;
+  next_element_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::ReadTensors(
+    std::vector<Tensor>* read_tensors) {
+  while (next_element_ == num_elements_) {
+    TF_RETURN_IF_ERROR(ReadBlock());
+  }
+  read_tensors->clear();
+  read_tensors->reserve(columns_.size());
+  for (const Tensor& column : columns_) {
+    Tensor element = column.SubSlice(next_element_);
+    // Slices of a column are not aligned in general, and kernels may require
+    // aligned inputs.
+    read_tensors->push_back(element.IsAligned() ? std::move(element)
+                                                : tensor::DeepCopy(element));
+  }
+  ++next_element_;
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::SkipRecords(int64_t num_records) {
+  while (num_records > 0) {
+    if (next_element_ == num_elements_) {
+      TF_RETURN_IF_ERROR(ReadBlock());
+    }
+    const int64_t n = std::min(num_records, num_elements_ - next_element_);
+    next_element_ += n;
+    num_records -= n;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ColumnarChunkReader::ReadBlock() {
+  tstring record;
+  TF_RETURN_IF_ERROR(record_reader_->ReadRecord(&offset_, &record));
+  bytes_read_ += record.size();
+  ColumnarSnapshotBlock block;
+  if (!block.ParseFromArray(record.data(), record.size())) {
+    return absl::DataLossError(
+        absl::StrCat("Unable to parse a columnar tf.data snapshot block in ",
+                     filename_, ", record ", offset_, "."));
+  }
+  if (block.columns_size() != dtypes_.size()) {
+    return absl::DataLossError(absl::StrCat(
+        "A columnar tf.data snapshot block in ", filename_, " has ",
+        block.columns_size(), " columns, but the dataset has ", dtypes_.size(),
+        " components."));
+  }
+  std::vector<Tensor> columns;
+  columns.reserve(block.columns_size());
+  for (const ColumnarSnapshotBlock::Column& column : block.columns()) {
+    TF_ASSIGN_OR_RETURN(Tensor tensor,
+                        DecodeColumn(column, block.num_elements()));
+    columns.push_back(std::move(tensor));
+  }
+  columns_ = std::move(columns);
+  num_elements_ = block.num_elements();
+  next_element_ = 0;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Tensor> ColumnarChunkReader::DecodeColumn(
+    const ColumnarSnapshotBlock::Column& column, int64_t num_elements) const {
+  const std::string& data = column.data();
+  if (!DataTypeCanUseMemcpy(column.dtype())) {
+    std::string uncompressed;
+    const std::string* serialized = &data;
+    if (column.snappy_compressed()) {
+      size_t size = 0;
+      if (!tsl::port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                                   &size)) {
+        return absl::InternalError("Could not get snappy uncompressed length.");
+      }
+      uncompressed.resize(size);
+      if (!tsl::port::Snappy_Uncompress(data.data(), data.size(),
+                                        uncompressed.data())) {
+        return absl::InternalError("Failed to perform snappy decompression.");
+      }
+      serialized = &uncompressed;
+    }
+    TensorProto proto;
+    Tensor tensor;
+    if (!proto.ParseFromString(*serialized) || !tensor.FromProto(proto)) {
+      return absl::DataLossError(absl::StrCat(
+          "Unable to parse a column of a tf.data snapshot block in ", filename_,
+          ", record ", offset_, "."));
+    }
+    return tensor;
+  }
+
+  TensorShape element_shape;
+  TF_RETURN_IF_ERROR(
+      TensorShape::BuildTensorShape(column.element_shape(), &element_shape));
+  Tensor tensor(column.dtype(), BatchedShape(element_shape, num_elements));
+  char* buffer = const_cast<char*>(tensor.tensor_data().data());
+  size_t size = data.size();
+  if (column.snappy_compressed() &&
+      !tsl::port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                               &size)) {
+    return absl::InternalError("Could not get snappy uncompressed length.");
+  }
+  if (size != tensor.TotalBytes()) {
+    return absl::DataLossError(absl::StrCat(
+        "A column of a tf.data snapshot block in ", filename_, " has ", size,
+        " bytes, but ", tensor.TotalBytes(), " bytes are expected."));
+  }
+  if (column.snappy_compressed()) {
+    if (!tsl::port::Snappy_Uncompress(data.data(), data.size(), buffer)) {
+      return absl::InternalError("Failed to perform snappy decompression.");
+    }
+  } else if (size > 0) {
+    std::memcpy(buffer, data.data(), size);
+  }
+  return tensor;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/protobuf/snapshot.pb.h"
+#include "tsl/lib/io/record_reader.h"
+#include "tsl/lib/io/record_writer.h"
+#include "tsl/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+
+// Writes a distributed snapshot chunk in the columnar format. Elements are
+// buffered into blocks, and each block is written as one TFRecord holding a
+// `ColumnarSnapshotBlock`. Each component of the elements in a block is stored
+// contiguously, so readers decode a whole column at once.
+//
+// If `compression` is snappy, each column is compressed on its own. Otherwise,
+// the records are compressed as in `snapshot_util::TFRecordWriter`.
+class ColumnarChunkWriter : public snapshot_util::Writer {
+ public:
+  // A block is written when it holds at least this many bytes, or when the
+  // shape of an element differs from the other elements in the block.
+  static constexpr int64_t kDefaultBlockSizeBytes = 16 << 20;  // 16MB
+
+  ColumnarChunkWriter(const std::string& filename,
+                      const std::string& compression,
+                      int64_t block_size_bytes = kDefaultBlockSizeBytes);
+
+  absl::Status Initialize(tsl::Env* env) override;
+  absl::Status WriteTensors(const std::vector<Tensor>& tensors) override;
+  absl::Status Sync() override;
+  absl::Status Close() override;
+  ~ColumnarChunkWriter() override;
+
+ private:
+  // Whether `tensors` can be appended to the block being buffered.
+  bool FitsBlock(const std::vector<Tensor>& tensors) const;
+
+  // Writes the buffered elements as one block.
+  absl::Status WriteBlock();
+
+  const std::string filename_;
+  const std::string compression_;
+  const int64_t block_size_bytes_;
+
+  std::unique_ptr<tsl::WritableFile> dest_;
+  std::unique_ptr<tsl::io::RecordWriter> record_writer_;
+  std::vector<std::vector<Tensor>> block_;
+  int64_t block_bytes_ = 0;
+};
+
+// Reads a distributed snapshot chunk written by `ColumnarChunkWriter`. Each
+// block is decoded with one copy (or snappy decompression) per column, and the
+// elements are slices of the decoded columns.
+class ColumnarChunkReader : public snapshot_util::Reader {
+ public:
+  ColumnarChunkReader(const std::string& filename,
+                      const std::string& compression,
+                      const DataTypeVector& dtypes,
+                      std::optional<int64_t> output_buffer_size = std::nullopt);
+
+  absl::Status Initialize(tsl::Env* env) override;
+
+  // Reads the next element into `read_tensors`. Returns OutOfRange at the end
+  // of the file.
+  absl::Status ReadTensors(std::vector<Tensor>* read_tensors) override;
+
+  // Skips `num_records` elements without slicing them out of their blocks.
+  absl::Status SkipRecords(int64_t num_records) override;
+
+  // Returns the number of bytes read.
+  uint64_t BytesRead() const { return bytes_read_; }
+
+ private:
+  // Reads and decodes the next block.
+  absl::Status ReadBlock();
+
+  // Decodes `column` into a tensor holding the component of all elements.
+  absl::StatusOr<Tensor> DecodeColumn(
+      const experimental::ColumnarSnapshotBlock::Column& column,
+      int64_t num_elements) const;
+
+  const std::string filename_;
+  const std::string compression_;
+  const DataTypeVector dtypes_;
+  const std::optional<int64_t> output_buffer_size_;
+
+  std::unique_ptr<tsl::RandomAccessFile> file_;
+  std::unique_ptr<tsl::io::RecordReader> record_reader_;
+  uint64_t offset_ = 0;
+  uint64_t bytes_read_ = 0;
+
+  // The decoded columns of the current block, and the index of the next
+  // element to return from it.
+  std::vector<Tensor> columns_;
+  int64_t num_elements_ = 0;
+  int64_t next_element_ = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_COLUMNAR_CHUNK_H_
@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
+
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/compression.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tsl::testing::StatusIs;
+
+absl::StatusOr<std::string> TestFile() {
+  std::string filename;
+  if (!tsl::Env::Default()->LocalTempFilename(&filename)) {
+    return absl::FailedPreconditionError("Failed to create local temp file.");
+  }
+  return filename;
+}
+
+// Returns element `i`: an int64 vector of length `i % 3` and a string scalar.
+std::vector<Tensor> Element(int64_t i) {
+  Tensor vector(DT_INT64, TensorShape({i % 3}));
+  for (int64_t j = 0; j < i % 3; ++j) {
+    vector.vec<int64_t>()(j) = i + j;
+  }
+  return {vector, Tensor(tstring(absl::StrCat("element_", i)))};
+}
+
+absl::Status WriteElements(const std::string& filename,
+                           const std::string& compression,
+                           int64_t num_elements, int64_t block_size_bytes) {
+  ColumnarChunkWriter writer(filename, compression, block_size_bytes);
+  TF_RETURN_IF_ERROR(writer.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    TF_RETURN_IF_ERROR(writer.WriteTensors(Element(i)));
+  }
+  return writer.Close();
+}
+
+class ColumnarChunkTest
+    : public ::testing::TestWithParam<std::tuple<std::string, int64_t>> {
+ protected:
+  std::string Compression() const { return std::get<0>(GetParam()); }
+  int64_t BlockSizeBytes() const { return std::get<1>(GetParam()); }
+};
+
+TEST_P(ColumnarChunkTest, ReadWrite) {
+  const int64_t num_elements = 20;
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(
+      WriteElements(filename, Compression(), num_elements, BlockSizeBytes()));
+
+  ColumnarChunkReader reader(filename, Compression(),
+                             DataTypeVector{DT_INT64, DT_STRING});
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  for (int64_t i = 0; i < num_elements; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(reader.ReadTensors(&element));
+    std::vector<Tensor> expected = Element(i);
+    ASSERT_EQ(element.size(), expected.size());
+    test::ExpectEqual(element[0], expected[0]);
+    test::ExpectEqual(element[1], expected[1]);
+  }
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader.ReadTensors(&element),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  EXPECT_GT(reader.BytesRead(), 0);
+}
+
+TEST_P(ColumnarChunkTest, SkipRecords) {
+  const int64_t num_elements = 20;
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(
+      WriteElements(filename, Compression(), num_elements, BlockSizeBytes()));
+
+  ColumnarChunkReader reader(filename, Compression(),
+                             DataTypeVector{DT_INT64, DT_STRING});
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  std::vector<Tensor> element;
+  TF_ASSERT_OK(reader.ReadTensors(&element));
+  TF_ASSERT_OK(reader.SkipRecords(12));
+  TF_ASSERT_OK(reader.ReadTensors(&element));
+  test::ExpectEqual(element[1], Element(13)[1]);
+  EXPECT_THAT(reader.SkipRecords(10), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Compression, ColumnarChunkTest,
+    ::testing::Combine(::testing::Values(tsl::io::compression::kNone,
+                                         tsl::io::compression::kSnappy,
+                                         tsl::io::compression::kGzip),
+                       ::testing::Values(1, 64, 1 << 20)));
+
+TEST(ColumnarChunkReaderTest, WrongNumberOfComponents) {
+  TF_ASSERT_OK_AND_ASSIGN(std::string filename, TestFile());
+  TF_ASSERT_OK(WriteElements(filename, tsl::io::compression::kSnappy,
+                             /*num_elements=*/5, /*block_size_bytes=*/1024));
+
+  ColumnarChunkReader reader(filename, tsl::io::compression::kSnappy,
+                             DataTypeVector{DT_INT64});
+  TF_ASSERT_OK(reader.Initialize(tsl::Env::Default()));
+  std::vector<Tensor> element;
+  EXPECT_THAT(reader.ReadTensors(&element),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
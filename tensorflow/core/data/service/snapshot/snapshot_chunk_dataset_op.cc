@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -39,6 +40,7 @@ namespace {
 
 constexpr const char* const kChunkFile = "chunk_file";
 constexpr const char* const kCompression = "compression";
+constexpr const char* const kColumnar = "columnar";
 constexpr const char* const kStartIndex = "start_index";
 constexpr const char* const kOutputTypes = "output_types";
 constexpr const char* const kOutputShapes = "output_shapes";
@@ -66,16 +68,19 @@ class SnapshotChunkDatasetOp : public DatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   std::string compression_;
+  bool columnar_ = false;
 };
 
 class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(DatasetContext&& ctx, const std::string& chunk_file,
-          const std::string& compression, const DataTypeVector& dtypes,
+          const std::string& compression, bool columnar,
+          const DataTypeVector& dtypes,
           const std::vector<PartialTensorShape>& shapes)
       : DatasetBase(std::move(ctx)),
         chunk_file_(chunk_file),
         compression_(compression),
+        columnar_(columnar),
         dtypes_(dtypes),
         shapes_(shapes) {}
 
@@ -103,13 +108,15 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
 
     AttrValue compression;
     b->BuildAttrValue(compression_, &compression);
+    AttrValue columnar;
+    b->BuildAttrValue(columnar_, &columnar);
 
     return b->AddDataset(this,
                          /*inputs=*/
                          {std::make_pair(0, chunk_file)},
                          /*list_inputs=*/{},
                          /*attrs=*/
-                         {{kCompression, compression}},
+                         {{kCompression, compression}, {kColumnar, columnar}},
                          /*use_dataset_name=*/true, output);
   }
 
@@ -128,10 +135,18 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     ~Iterator() override { RecordBytesRead(); }
 
     absl::Status Initialize(IteratorContext* ctx) override {
-      reader_ = std::make_unique<snapshot_util::TFRecordReader>(
+      if (dataset()->columnar_) {
+        tfrecord_reader_ = nullptr;
+        columnar_reader_ = std::make_unique<ColumnarChunkReader>(
+            TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
+            dataset()->dtypes_, kTFRecordReaderOutputBufferSize);
+        return columnar_reader_->Initialize(ctx->env());
+      }
+      columnar_reader_ = nullptr;
+      tfrecord_reader_ = std::make_unique<snapshot_util::TFRecordReader>(
           TranslateFileName(dataset()->chunk_file_), dataset()->compression_,
           dataset()->dtypes_, kTFRecordReaderOutputBufferSize);
-      return reader_->Initialize(ctx->env());
+      return tfrecord_reader_->Initialize(ctx->env());
     }
 
    protected:
@@ -139,7 +154,7 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
       *end_of_sequence = false;
-      absl::Status status = reader_->ReadTensors(out_tensors);
+      absl::Status status = reader()->ReadTensors(out_tensors);
       if (absl::IsOutOfRange(status)) {
         *end_of_sequence = true;
         return absl::OkStatus();
@@ -169,27 +184,36 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
    private:
     // TODO(b/250921378): Optimize this to not parse every single element. We
     // may consider switching the data format to ArrayRecords so we can use the
-    // index to jump straight to the starting record.
+    // index to jump straight to the starting record. Columnar chunks skip
+    // elements without slicing them out of their blocks.
     absl::Status AdvanceToStartIndex(IteratorContext* ctx) {
-      for (int64_t i = 0; i < start_index_; ++i) {
-        std::vector<Tensor> unused;
-        TF_RETURN_IF_ERROR(reader_->ReadTensors(&unused));
-      }
-      return absl::OkStatus();
+      return reader()->SkipRecords(start_index_);
     }
 
     void RecordBytesRead() {
-      uint64_t bytes_read = reader_->BytesRead();
+      uint64_t bytes_read = columnar_reader_ != nullptr
+                                ? columnar_reader_->BytesRead()
+                                : tfrecord_reader_->BytesRead();
       metrics::GetTFDataBytesReadCounter(kSnapshotChunkDataset)
           ->IncrementBy(bytes_read);
     }
 
-    std::unique_ptr<snapshot_util::TFRecordReader> reader_;
+    snapshot_util::Reader* reader() const {
+      if (columnar_reader_ != nullptr) {
+        return columnar_reader_.get();
+      }
+      return tfrecord_reader_.get();
+    }
+
+    // Exactly one of the readers is set, depending on the chunk format.
+    std::unique_ptr<snapshot_util::TFRecordReader> tfrecord_reader_;
+    std::unique_ptr<ColumnarChunkReader> columnar_reader_;
     int64_t start_index_ = 0;
   };
 
   const tstring chunk_file_;
   const tstring compression_;
+  const bool columnar_;
   const DataTypeVector dtypes_;
   const std::vector<PartialTensorShape> shapes_;
 };
@@ -199,6 +223,9 @@ SnapshotChunkDatasetOp::SnapshotChunkDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kCompression, &compression_));
+  if (ctx->HasAttr(kColumnar)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kColumnar, &columnar_));
+  }
 }
 
 void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -207,8 +234,8 @@ void SnapshotChunkDatasetOp::MakeDataset(OpKernelContext* ctx,
   OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kChunkFile, &chunk_file));
 
   *output = new SnapshotChunkDatasetOp::Dataset(DatasetContext(ctx), chunk_file,
-                                                compression_, output_types_,
-                                                output_shapes_);
+                                                compression_, columnar_,
+                                                output_types_, output_shapes_);
   metrics::RecordTFDataServiceSnapshotOp(
       std::string(GetSnapshotPath(chunk_file)), kSnapshotChunkDataset);
 }
@@ -30,6 +30,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.h"
+#include "tensorflow/core/data/service/snapshot/columnar_chunk.h"
 #include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/snapshot/utils.h"
@@ -52,6 +53,22 @@ namespace {
 constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
 constexpr int64_t kUnknownNumElements = -1;
 
+// Creates the writer of a chunk, in the columnar format if requested by
+// `params`.
+absl::StatusOr<std::unique_ptr<snapshot_util::Writer>> CreateChunkWriter(
+    const std::string& filename, const SnapshotWriterParams& params) {
+  if (params.columnar_chunks) {
+    auto writer =
+        std::make_unique<ColumnarChunkWriter>(filename, params.compression);
+    TF_RETURN_IF_ERROR(writer->Initialize(params.env));
+    return writer;
+  }
+  auto writer = std::make_unique<snapshot_util::TFRecordWriter>(
+      filename, params.compression);
+  TF_RETURN_IF_ERROR(writer->Initialize(params.env));
+  return writer;
+}
+
 // Extracts the index from the `filename` of an uncommitted chunk. The chunk
 // file name is expected to be chunk_<chunk_index>.
 absl::StatusOr<int64_t> GetUncommittedChunkIndex(const std::string& filename) {
@@ -146,13 +163,14 @@ absl::Status SnapshotStreamWriter::WriteChunk() {
   std::string uncommitted_chunk_file_path =
       tsl::io::JoinPath(params_.UncommittedChunksDirectory(),
                         absl::StrCat("chunk_", chunk_index_));
-  snapshot_util::TFRecordWriter writer(
-      TranslateFileName(uncommitted_chunk_file_path), params_.compression);
-  TF_RETURN_IF_ERROR(writer.Initialize(params_.env));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<snapshot_util::Writer> writer,
+      CreateChunkWriter(TranslateFileName(uncommitted_chunk_file_path),
+                        params_));
   while (ShouldWriteRecord()) {
-    TF_RETURN_IF_ERROR(WriteRecord(writer));
+    TF_RETURN_IF_ERROR(WriteRecord(*writer));
   }
-  TF_RETURN_IF_ERROR(writer.Close());
+  TF_RETURN_IF_ERROR(writer->Close());
   chunk_file_to_num_elements_[absl::StrCat("chunk_", chunk_index_)] =
       chunk_num_elements_;
   if (ShouldCommit()) {
@@ -219,7 +237,7 @@ bool SnapshotStreamWriter::ShouldWriteRecord() const TF_LOCKS_EXCLUDED(mu_) {
 }
 
 absl::Status SnapshotStreamWriter::WriteRecord(
-    snapshot_util::TFRecordWriter& writer) {
+    snapshot_util::Writer& writer) {
   std::vector<Tensor> element;
   TF_RETURN_IF_ERROR(iterator_->GetNext(element, end_of_sequence_));
   if (end_of_sequence_) {
@@ -69,6 +69,10 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // If true, chunks are written in the columnar format of
+  // `ColumnarChunkWriter`.
+  bool columnar_chunks = false;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -176,7 +180,7 @@ class SnapshotStreamWriter {
   bool ShouldWriteRecord() const;
 
   // Writes the next record to the current chunk.
-  absl::Status WriteRecord(snapshot_util::TFRecordWriter& writer);
+  absl::Status WriteRecord(snapshot_util::Writer& writer);
 
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
@@ -20,6 +20,8 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/strings/match.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
@@ -45,7 +47,7 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
       [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         return dispatcher_->GetSplit(iteration_id_, repetition_,
                                      split_provider_index_, *split,
-                                     *end_of_splits);
+                                     *end_of_splits, locality_tags_);
       },
       "get next split",
       /*deadline_micros=*/Env::Default()->NowMicros() +
@@ -81,6 +83,20 @@ Status DataServiceSplitProvider::Restore(
       "Restore is not implemented for DataServiceSplitProvider");
 }
 
+bool IsLocalSplit(const Tensor& split,
+                  absl::Span<const std::string> locality_tags) {
+  if (split.dtype() != DT_STRING || split.NumElements() != 1) {
+    return false;
+  }
+  const tstring& value = split.flat<tstring>()(0);
+  for (const std::string& tag : locality_tags) {
+    if (absl::StartsWith(value, tag)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers) {
@@ -19,8 +19,10 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -37,12 +39,14 @@ class DataServiceSplitProvider : public SplitProvider {
  public:
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           std::vector<std::string> locality_tags = {})
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        locality_tags_(std::move(locality_tags)) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -57,12 +61,19 @@ class DataServiceSplitProvider : public SplitProvider {
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const std::vector<std::string> locality_tags_;
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
 };
 
+// Returns whether `split` is local to a worker with `locality_tags`, i.e. it is
+// a string starting with one of the tags. Splits of other types, e.g. the
+// indices of `range` datasets, are never local.
+bool IsLocalSplit(const Tensor& split,
+                  absl::Span<const std::string> locality_tags);
+
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
 Status CreateSplitProviders(
     const DatasetDef& dataset_def,
@@ -17,6 +17,7 @@ limitations under the License.
 #include <array>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <tuple>
 #include <vector>
 
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
@@ -44,6 +46,14 @@ std::vector<int64_t> GetCardinalities(
   return cardinalities;
 }
 
+TEST(SplitProviderTest, IsLocalSplit) {
+  const std::vector<std::string> tags = {"/ssd0/", "/ssd1/"};
+  EXPECT_TRUE(IsLocalSplit(Tensor("/ssd1/data-00001"), tags));
+  EXPECT_FALSE(IsLocalSplit(Tensor("/ssd2/data-00001"), tags));
+  EXPECT_FALSE(IsLocalSplit(Tensor("/ssd1/data-00001"), {}));
+  EXPECT_FALSE(IsLocalSplit(Tensor(int64_t{1}), tags));
+}
+
 TEST(SplitProviderTest, RangeCardinality) {
   DatasetDef range_dataset = testing::RangeDataset(10);
   std::vector<std::unique_ptr<SplitProvider>> split_providers;
@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -29,8 +30,10 @@ limitations under the License.
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
@@ -100,8 +103,11 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes,
+        std::max<int64_t>(worker_config.cross_trainer_cache_spill_size_bytes(),
+                          0),
+        worker_config.cross_trainer_cache_spill_directory());
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -174,12 +180,15 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
 }
 
 CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+                                     size_t max_cache_size_bytes,
+                                     size_t max_spill_size_bytes,
+                                     const std::string& spill_directory)
     : fcfs_task_runner_(std::move(iterator)),
-      cache_(max_cache_size_bytes,
+      cache_(max_cache_size_bytes, max_spill_size_bytes, spill_directory,
              std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
-            << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
+            << ByteSize::Bytes(max_cache_size_bytes) << " of memory and "
+            << ByteSize::Bytes(max_spill_size_bytes) << " of disk.";
 }
 
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
@@ -213,6 +222,41 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+StatusOr<std::string> CachingTaskRunner::GetElementResultSequence::Serialize(
+    const GetElementResult& element) const {
+  // The element index is stored as an extra scalar component.
+  UncompressedElement proto;
+  for (const Tensor& component : element.components) {
+    component.AsProtoTensorContent(proto.add_components());
+  }
+  Tensor(element.element_index).AsProtoTensorContent(proto.add_components());
+  return proto.SerializeAsString();
+}
+
+StatusOr<GetElementResult>
+CachingTaskRunner::GetElementResultSequence::Deserialize(
+    const std::string& serialized) const {
+  UncompressedElement proto;
+  if (!proto.ParseFromString(serialized) || proto.components_size() == 0) {
+    return errors::DataLoss(
+        "Failed to parse a spilled tf.data service cross-trainer cache "
+        "element.");
+  }
+  GetElementResult result;
+  for (const TensorProto& component : proto.components()) {
+    Tensor tensor;
+    if (!tensor.FromProto(component)) {
+      return errors::DataLoss(
+          "Failed to parse a spilled tf.data service cross-trainer cache "
+          "element.");
+    }
+    result.components.push_back(std::move(tensor));
+  }
+  result.element_index = result.components.back().scalar<int64_t>()();
+  result.components.pop_back();
+  return result;
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
@@ -150,6 +150,9 @@ class GrpcDataTransferClient : public DataTransferClient {
           }
         }
         break;
+      case GetElementResponse::kSharedMemory:
+        return errors::Internal(
+            "Received a shared memory element over the grpc transfer.");
       case GetElementResponse::ELEMENT_NOT_SET:
         break;
     }
@@ -0,0 +1,73 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_POOL_RESIZER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_WORKER_POOL_RESIZER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// A request from the dispatcher to resize the tf.data service worker pool.
+struct WorkerPoolResizeRequest {
+  // The number of workers currently heartbeating to the dispatcher, including
+  // workers which are being drained.
+  int64_t current_number_of_workers = 0;
+  // The number of workers estimated by the dispatcher's AutoScaler to be
+  // needed for the current workload.
+  int64_t target_number_of_workers = 0;
+  // Surplus workers which no longer serve any unfinished iteration, and can be
+  // shut down without losing data.
+  std::vector<std::string> drained_workers;
+};
+
+// Hook for acting on the dispatcher's estimate of the optimal number of
+// workers, e.g. by talking to a cluster manager. Resizers are registered by
+// name, and the dispatcher uses the one named by
+// `DispatcherConfig.worker_pool_resizer`.
+class WorkerPoolResizer {
+ public:
+  using FactoryT =
+      std::function<Status(const experimental::DispatcherConfig&,
+                           std::unique_ptr<WorkerPoolResizer>*)>;
+  virtual ~WorkerPoolResizer() = default;
+
+  // Asks for the worker pool to be resized. The dispatcher calls this
+  // periodically with the latest estimate for as long as it differs from the
+  // current number of workers, so implementations should be idempotent.
+  // Workers are started and stopped by the implementation; new workers join
+  // by registering with the dispatcher as usual.
+  virtual Status Resize(const WorkerPoolResizeRequest& request) = 0;
+
+  // Registers a WorkerPoolResizer factory under `name`.
+  static void Register(std::string name, FactoryT factory);
+
+  // Builds a WorkerPoolResizer from the factory registered under `name`.
+  static Status Build(std::string name,
+                      const experimental::DispatcherConfig& config,
+                      std::unique_ptr<WorkerPoolResizer>* out);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_WORKER_POOL_RESIZER_H_
@@ -0,0 +1,80 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_pool_resizer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::ElementsAre;
+
+class TestWorkerPoolResizer : public WorkerPoolResizer {
+ public:
+  explicit TestWorkerPoolResizer(std::vector<WorkerPoolResizeRequest>* requests)
+      : requests_(requests) {}
+
+  Status Resize(const WorkerPoolResizeRequest& request) override {
+    requests_->push_back(request);
+    return OkStatus();
+  }
+
+ private:
+  std::vector<WorkerPoolResizeRequest>* requests_;
+};
+
+TEST(WorkerPoolResizerTest, RegisterAndBuild) {
+  std::vector<WorkerPoolResizeRequest> requests;
+  WorkerPoolResizer::Register(
+      "test", [&requests](const experimental::DispatcherConfig& config,
+                          std::unique_ptr<WorkerPoolResizer>* out) {
+        *out = std::make_unique<TestWorkerPoolResizer>(&requests);
+        return OkStatus();
+      });
+
+  std::unique_ptr<WorkerPoolResizer> resizer;
+  TF_ASSERT_OK(WorkerPoolResizer::Build("test", {}, &resizer));
+  WorkerPoolResizeRequest request;
+  request.current_number_of_workers = 4;
+  request.target_number_of_workers = 2;
+  request.drained_workers = {"worker_0"};
+  TF_ASSERT_OK(resizer->Resize(request));
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0].current_number_of_workers, 4);
+  EXPECT_EQ(requests[0].target_number_of_workers, 2);
+  EXPECT_THAT(requests[0].drained_workers, ElementsAre("worker_0"));
+}
+
+TEST(WorkerPoolResizerTest, BuildUnregistered) {
+  std::unique_ptr<WorkerPoolResizer> resizer;
+  EXPECT_THAT(WorkerPoolResizer::Build("unregistered", {}, &resizer),
+              StatusIs(error::NOT_FOUND));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -262,7 +262,10 @@ void BaseRemoteRendezvous::SameWorkerRecvDone(
     return safe_alloc_frontier;
   };
   if (!sync_dst_compute) {
+    // Memory still pending on the compute stream is reused by making the copy
+    // wait on the compute stream.
     allocation_attr.freed_by_func = &freed_by_func;
+    allocation_attr.reused_pending_memory = &sync_dst_compute;
   }
   if (in.dtype() != DT_VARIANT) {
     // Variants are handled by CopyTensor::ViaDMA.
@@ -97,6 +97,10 @@ class MockCoordinationServiceAgent : public CoordinationServiceAgent {
   MOCK_METHOD(Status, InsertKeyValue,
               (std::string_view key, std::string_view value), (override));
   MOCK_METHOD(Status, DeleteKeyValue, (std::string_view key), (override));
+  MOCK_METHOD(Status, InsertKeyValues, (const std::vector<KeyValueEntry>& kvs),
+              (override));
+  MOCK_METHOD(StatusOr<std::vector<std::string>>, GetKeyValues,
+              (const std::vector<std::string>& keys), (override));
   MOCK_METHOD(Status, UpdateKeyValue,
               (std::string_view key, std::string_view value), (override));
   MOCK_METHOD(Status, StartWatchKey,
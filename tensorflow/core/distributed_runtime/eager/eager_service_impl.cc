@@ -455,7 +455,8 @@ Status EagerServiceImpl::UpdateContext(const UpdateContextRequest* request,
         " but received update request at view #", request->context_view_id(),
         ". View id should only be continuously incremented.");
   }
-  if (request->cluster_device_attributes_size() == 0) {
+  if (request->cluster_device_attributes_size() == 0 &&
+      !request->cluster_device_attributes_delta()) {
     // In this case, the client indicates that the updated `server_def` and
     // device info is irrelevant to this worker, since it is not connected to
     // the updated ones (likely due to device filter settings). The worker
@@ -469,14 +470,20 @@ Status EagerServiceImpl::UpdateContext(const UpdateContextRequest* request,
   auto session_name =
       tensorflow::strings::StrCat("eager_", request->context_id());
 
-  TF_RETURN_IF_ERROR(
-      env_->session_mgr->UpdateSession(session_name, request->server_def(),
-                                       request->cluster_device_attributes()));
-
   std::shared_ptr<WorkerSession> worker_session;
   TF_RETURN_IF_ERROR(env_->session_mgr->WorkerSessionForSession(
       session_name, &worker_session));
 
+  // Remote devices known before the update, by name and incarnation.
+  std::vector<std::pair<string, uint64>> prev_remote_devices;
+  for (const Device* d : worker_session->remote_device_mgr()->ListDevices()) {
+    prev_remote_devices.emplace_back(d->name(), d->attributes().incarnation());
+  }
+
+  TF_RETURN_IF_ERROR(
+      env_->session_mgr->UpdateSession(session_name, request->server_def(),
+                                       request->cluster_device_attributes()));
+
   const tensorflow::DeviceMgr* device_mgr = worker_session->device_mgr();
 
   std::vector<string> remote_workers;
@@ -496,7 +503,24 @@ Status EagerServiceImpl::UpdateContext(const UpdateContextRequest* request,
   TF_RETURN_IF_ERROR(worker_session->worker_cache()->GetEagerClientCache(
       &remote_eager_workers));
 
-  ctx->ClearCachesAndThreadExecutors();
+  // Cached kernels may only refer to devices that are removed or replaced.
+  bool remote_devices_removed = false;
+  for (const auto& name_and_incarnation : prev_remote_devices) {
+    Device* device;
+    if (!worker_session->remote_device_mgr()
+             ->LookupDevice(name_and_incarnation.first, &device)
+             .ok() ||
+        device->attributes().incarnation() != name_and_incarnation.second) {
+      remote_devices_removed = true;
+      break;
+    }
+  }
+  if (remote_devices_removed) {
+    ctx->ClearCachesAndThreadExecutors();
+  } else {
+    VLOG(1) << "Keeping the caches of " << ctx->HostCPU()->name()
+            << " as no remote device was removed";
+  }
   Status s = ctx->UpdateRemoteWorker(std::move(remote_eager_workers),
                                      remote_workers, request->context_id());
   if (!s.ok()) {
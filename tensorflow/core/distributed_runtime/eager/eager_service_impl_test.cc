@@ -1541,6 +1541,162 @@ TEST_F(EagerServiceImplTest, KeepAliveTest) {
       eager_service_impl.KeepAlive(&keep_alive_request, &keep_alive_response));
 }
 
+// A worker cache listing the tasks of the cluster it was created for.
+class ClusterWorkerCache : public FakeCache {
+ public:
+  explicit ClusterWorkerCache(const ServerDef& server_def) {
+    for (const JobDef& job : server_def.cluster().job()) {
+      for (const auto& task : job.tasks()) {
+        workers_.push_back(strings::StrCat("/job:", job.name(),
+                                           "/replica:0/task:", task.first));
+      }
+    }
+  }
+
+  void ListWorkers(std::vector<string>* workers) const override {
+    *workers = workers_;
+  }
+
+ private:
+  std::vector<string> workers_;
+};
+
+class EagerServiceImplUpdateContextTest : public EagerServiceImplTest {
+ public:
+  EagerServiceImplUpdateContextTest() {
+    session_mgr_ = std::make_unique<SessionMgr>(
+        &worker_env_, "/job:localhost/replica:0/task:0/device:CPU:0",
+        std::unique_ptr<WorkerCacheInterface>(new FakeCache),
+        [](const ServerDef& server_def, WorkerCacheInterface** worker_cache) {
+          *worker_cache = new ClusterWorkerCache(server_def);
+          return OkStatus();
+        },
+        /*coordination_handler=*/nullptr);
+    worker_env_.session_mgr = session_mgr_.get();
+  }
+
+ protected:
+  static ServerDef ClusterServerDef(int num_tasks) {
+    ServerDef server_def;
+    server_def.set_job_name("localhost");
+    server_def.set_task_index(0);
+    JobDef* job = server_def.mutable_cluster()->add_job();
+    job->set_name("localhost");
+    for (int i = 0; i < num_tasks; ++i) {
+      (*job->mutable_tasks())[i] = strings::StrCat("localhost:", i);
+    }
+    return server_def;
+  }
+
+  static DeviceAttributes CpuAttributes(int task, uint64 incarnation) {
+    DeviceAttributes attributes;
+    attributes.set_name(strings::StrCat("/job:localhost/replica:0/task:", task,
+                                        "/device:CPU:0"));
+    attributes.set_device_type("CPU");
+    attributes.set_incarnation(incarnation);
+    return attributes;
+  }
+
+  // Creates a context on task 0 of a cluster of two tasks, with a cached
+  // device, which shows whether an update clears the caches of the context.
+  void CreateContext(TestEagerServiceImpl* eager_service_impl) {
+    context_id_ = random::New64();
+    CreateContextRequest request;
+    *request.mutable_server_def() = ClusterServerDef(2);
+    *request.add_cluster_device_attributes() = CpuAttributes(0, 1);
+    *request.add_cluster_device_attributes() = CpuAttributes(1, 1);
+    request.set_context_id(context_id_);
+    CreateContextResponse response;
+    TF_ASSERT_OK(eager_service_impl->CreateContext(&request, &response));
+    TF_ASSERT_OK(eager_service_impl->GetEagerContext(context_id_, &ctx_));
+    ctx_->AddDeviceToCache(kDeviceCacheKey, ctx_->HostCPU());
+  }
+
+  Status UpdateContext(TestEagerServiceImpl* eager_service_impl,
+                       const ServerDef& server_def,
+                       const std::vector<DeviceAttributes>& delta) {
+    UpdateContextRequest request;
+    *request.mutable_server_def() = server_def;
+    for (const DeviceAttributes& attributes : delta) {
+      *request.add_cluster_device_attributes() = attributes;
+    }
+    request.set_cluster_device_attributes_delta(true);
+    request.set_context_id(context_id_);
+    request.set_context_view_id(ctx_->GetContextViewId() + 1);
+    UpdateContextResponse response;
+    return eager_service_impl->UpdateContext(&request, &response);
+  }
+
+  // The incarnation of the remote CPU of `task` known by the worker session,
+  // or 0 if there is none.
+  uint64 RemoteIncarnation(int task) {
+    std::shared_ptr<WorkerSession> worker_session;
+    TF_CHECK_OK(session_mgr_->WorkerSessionForSession(
+        strings::StrCat("eager_", context_id_), &worker_session));
+    Device* device;
+    if (!worker_session->remote_device_mgr()
+             ->LookupDevice(CpuAttributes(task, 0).name(), &device)
+             .ok()) {
+      return 0;
+    }
+    return device->attributes().incarnation();
+  }
+
+  bool CachesKept() {
+    return ctx_->GetCachedDevice(kDeviceCacheKey) != nullptr;
+  }
+
+  void CloseContext(TestEagerServiceImpl* eager_service_impl) {
+    CloseContextRequest request;
+    request.set_context_id(context_id_);
+    request.set_context_view_id(ctx_->GetContextViewId());
+    CloseContextResponse response;
+    TF_ASSERT_OK(eager_service_impl->CloseContext(&request, &response));
+  }
+
+  static constexpr Fprint128 kDeviceCacheKey = {1, 2};
+  uint64 context_id_;
+  EagerContext* ctx_ = nullptr;
+};
+
+TEST_F(EagerServiceImplUpdateContextTest, DeltaAddingWorkersKeepsCaches) {
+  TestEagerServiceImpl eager_service_impl(&worker_env_);
+  CreateContext(&eager_service_impl);
+  ASSERT_EQ(RemoteIncarnation(1), 1);
+
+  TF_ASSERT_OK(UpdateContext(&eager_service_impl, ClusterServerDef(3),
+                             {CpuAttributes(2, 1)}));
+  EXPECT_EQ(RemoteIncarnation(1), 1);
+  EXPECT_EQ(RemoteIncarnation(2), 1);
+  EXPECT_TRUE(CachesKept());
+  CloseContext(&eager_service_impl);
+}
+
+TEST_F(EagerServiceImplUpdateContextTest, DeltaWithoutDevicesRemovesWorkers) {
+  TestEagerServiceImpl eager_service_impl(&worker_env_);
+  CreateContext(&eager_service_impl);
+
+  // Unlike a request without devices nor delta, this is not a view-only
+  // update: task 1 has left the cluster.
+  TF_ASSERT_OK(UpdateContext(&eager_service_impl, ClusterServerDef(1), {}));
+  EXPECT_EQ(ctx_->GetContextViewId(), 1);
+  EXPECT_EQ(RemoteIncarnation(1), 0);
+  EXPECT_FALSE(CachesKept());
+  CloseContext(&eager_service_impl);
+}
+
+TEST_F(EagerServiceImplUpdateContextTest, DeltaReplacingWorkerClearsCaches) {
+  TestEagerServiceImpl eager_service_impl(&worker_env_);
+  CreateContext(&eager_service_impl);
+
+  // Task 1 restarted with a new incarnation.
+  TF_ASSERT_OK(UpdateContext(&eager_service_impl, ClusterServerDef(2),
+                             {CpuAttributes(1, 2)}));
+  EXPECT_EQ(RemoteIncarnation(1), 2);
+  EXPECT_FALSE(CachesKept());
+  CloseContext(&eager_service_impl);
+}
+
 }  // namespace
 }  // namespace eager
 }  // namespace tensorflow
@@ -0,0 +1,231 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/preemption/emergency_checkpoint.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCheckpointPrefix[] = "emergency-";
+constexpr char kCompleteSuffix[] = ".complete";
+
+std::string CompleteFilename(absl::string_view prefix) {
+  return absl::StrCat(prefix, kCompleteSuffix);
+}
+
+// Returns the indices of the tensors that each writer saves, balancing the
+// number of bytes written by each of them, largest tensors first.
+std::vector<std::vector<int>> PartitionForWriters(
+    const std::vector<std::pair<std::string, Tensor>>& tensors,
+    int num_writers) {
+  std::vector<int> order(tensors.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&tensors](int a, int b) {
+    return tensors[a].second.TotalBytes() > tensors[b].second.TotalBytes();
+  });
+  num_writers = std::max(
+      1, std::min(num_writers, static_cast<int>(tensors.size())));
+  std::vector<std::vector<int>> writer_tensors(num_writers);
+  std::vector<int64_t> writer_bytes(num_writers, 0);
+  for (int i : order) {
+    const int writer = std::min_element(writer_bytes.begin(),
+                                        writer_bytes.end()) -
+                       writer_bytes.begin();
+    writer_tensors[writer].push_back(i);
+    writer_bytes[writer] += tensors[i].second.TotalBytes();
+  }
+  return writer_tensors;
+}
+
+Status WriteBundle(Env* env, const std::string& prefix,
+                   const std::vector<std::pair<std::string, Tensor>>& tensors,
+                   const std::vector<int>& indices) {
+  BundleWriter writer(env, prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  for (int i : indices) {
+    TF_RETURN_IF_ERROR(writer.Add(tensors[i].first, tensors[i].second));
+  }
+  return writer.Finish();
+}
+
+}  // namespace
+
+Status WriteEmergencyCheckpoint(
+    Env* env, const EmergencyCheckpointOptions& options, int64_t step,
+    const std::vector<std::pair<std::string, Tensor>>& tensors,
+    std::string* prefix) {
+  const uint64_t start_micros = EnvTime::NowMicros();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(options.local_dir));
+  *prefix = io::JoinPath(options.local_dir, absl::StrCat(kCheckpointPrefix,
+                                                         step));
+  const std::vector<std::vector<int>> writer_tensors =
+      PartitionForWriters(tensors, options.num_writers);
+  if (writer_tensors.size() == 1) {
+    TF_RETURN_IF_ERROR(WriteBundle(env, *prefix, tensors, writer_tensors[0]));
+  } else {
+    std::vector<tstring> part_prefixes;
+    for (int i = 0; i < writer_tensors.size(); ++i) {
+      part_prefixes.push_back(absl::StrCat(*prefix, "_temp_part-", i, "-of-",
+                                           writer_tensors.size()));
+    }
+    std::vector<Status> statuses(writer_tensors.size());
+    {
+      thread::ThreadPool writer_pool(env, "emergency_checkpoint",
+                                     writer_tensors.size());
+      for (int i = 0; i < writer_tensors.size(); ++i) {
+        writer_pool.Schedule([&, i]() {
+          statuses[i] =
+              WriteBundle(env, part_prefixes[i], tensors, writer_tensors[i]);
+        });
+      }
+    }
+    for (const Status& status : statuses) {
+      TF_RETURN_IF_ERROR(status);
+    }
+    TF_RETURN_IF_ERROR(MergeBundles(env, part_prefixes, *prefix,
+                                    /*allow_missing_files=*/false));
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, CompleteFilename(*prefix), ""));
+  LOG(INFO) << "Wrote emergency checkpoint " << *prefix << " of "
+            << tensors.size() << " tensors in "
+            << (EnvTime::NowMicros() - start_micros) / 1000 << " ms.";
+  return OkStatus();
+}
+
+Status FindLatestEmergencyCheckpoint(Env* env, const std::string& local_dir,
+                                     std::string* prefix, int64_t* step) {
+  std::vector<std::string> children;
+  if (env->GetChildren(local_dir, &children).ok()) {
+    int64_t latest_step = -1;
+    for (const std::string& child : children) {
+      absl::string_view name = child;
+      int64_t child_step;
+      if (!absl::ConsumePrefix(&name, kCheckpointPrefix) ||
+          !absl::ConsumeSuffix(&name, kCompleteSuffix) ||
+          !absl::SimpleAtoi(name, &child_step)) {
+        continue;
+      }
+      latest_step = std::max(latest_step, child_step);
+    }
+    if (latest_step >= 0) {
+      *step = latest_step;
+      *prefix = io::JoinPath(local_dir,
+                             absl::StrCat(kCheckpointPrefix, latest_step));
+      return OkStatus();
+    }
+  }
+  return errors::NotFound("No complete emergency checkpoint in ", local_dir);
+}
+
+Status CopyEmergencyCheckpoint(Env* env, const std::string& prefix,
+                               const std::string& upload_dir,
+                               std::string* uploaded_prefix) {
+  TF_RETURN_IF_ERROR(env->FileExists(CompleteFilename(prefix)));
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(upload_dir));
+  *uploaded_prefix = io::JoinPath(upload_dir, io::Basename(prefix));
+  // The index and the data files.
+  std::vector<std::string> files;
+  TF_RETURN_IF_ERROR(
+      env->GetMatchingPaths(absl::StrCat(prefix, ".*"), &files));
+  for (const std::string& file : files) {
+    if (absl::EndsWith(file, kCompleteSuffix)) continue;
+    TF_RETURN_IF_ERROR(env->CopyFile(
+        file, io::JoinPath(upload_dir, io::Basename(file))));
+  }
+  return WriteStringToFile(env, CompleteFilename(*uploaded_prefix), "");
+}
+
+EmergencyCheckpointer::EmergencyCheckpointer(Env* env,
+                                             EmergencyCheckpointOptions options,
+                                             TensorsFn get_tensors)
+    : env_(env),
+      options_(std::move(options)),
+      get_tensors_(std::move(get_tensors)) {}
+
+EmergencyCheckpointer::~EmergencyCheckpointer() {
+  std::unique_ptr<Thread> upload_thread;
+  {
+    mutex_lock l(mu_);
+    upload_thread = std::move(upload_thread_);
+  }
+  // Joins the thread.
+  upload_thread.reset();
+}
+
+void EmergencyCheckpointer::RegisterWith(PreemptionSyncManager* sync_manager) {
+  sync_manager->AddSyncPointCallback([this](int step_counter) {
+    Status s = Save(step_counter);
+    if (!s.ok()) {
+      LOG(ERROR) << "Failed to write the emergency checkpoint of step "
+                 << step_counter << ": " << s;
+    }
+  });
+}
+
+Status EmergencyCheckpointer::Save(int64_t step) {
+  std::vector<std::pair<std::string, Tensor>> tensors;
+  Status s = get_tensors_(&tensors);
+  std::string prefix;
+  if (s.ok()) {
+    s = WriteEmergencyCheckpoint(env_, options_, step, tensors, &prefix);
+  }
+  mutex_lock l(mu_);
+  last_save_status_ = s;
+  return s;
+}
+
+Status EmergencyCheckpointer::last_save_status() const {
+  mutex_lock l(mu_);
+  return last_save_status_;
+}
+
+void EmergencyCheckpointer::StartUpload(UploadDoneFn done) {
+  mutex_lock l(mu_);
+  // Joins the previous upload.
+  upload_thread_.reset();
+  upload_thread_.reset(env_->StartThread(
+      ThreadOptions(), "emergency_checkpoint_upload",
+      [this, done = std::move(done)]() {
+        std::string prefix;
+        int64_t step;
+        std::string uploaded_prefix;
+        Status s = FindLatestEmergencyCheckpoint(env_, options_.local_dir,
+                                                 &prefix, &step);
+        if (s.ok()) {
+          s = CopyEmergencyCheckpoint(env_, prefix, options_.upload_dir,
+                                      &uploaded_prefix);
+        }
+        done(s, uploaded_prefix);
+      }));
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_PREEMPTION_EMERGENCY_CHECKPOINT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_PREEMPTION_EMERGENCY_CHECKPOINT_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/preemption/preemption_sync_manager.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Emergency checkpoints are tensor bundles which a task writes to fast local
+// storage once the tasks agree on a preemption sync point, so that they are
+// written within the preemption notice window. They are named
+// "<local_dir>/emergency-<step>", and the empty file
+// "<local_dir>/emergency-<step>.complete" is written last, so that the
+// checkpoints interrupted by the preemption are never read.
+struct EmergencyCheckpointOptions {
+  // The directory of the checkpoints of this task, e.g. on a local SSD.
+  std::string local_dir;
+  // The number of BundleWriters, which write their data files in parallel.
+  int num_writers = 8;
+  // The durable directory to which `EmergencyCheckpointer::StartUpload()`
+  // copies the latest checkpoint.
+  std::string upload_dir;
+};
+
+// Writes `tensors` as the emergency checkpoint of `step` and sets `*prefix`.
+Status WriteEmergencyCheckpoint(
+    Env* env, const EmergencyCheckpointOptions& options, int64_t step,
+    const std::vector<std::pair<std::string, Tensor>>& tensors,
+    std::string* prefix);
+
+// Sets `*prefix` and `*step` to those of the complete emergency checkpoint in
+// `local_dir` with the largest step. Returns NotFound if there is none.
+Status FindLatestEmergencyCheckpoint(Env* env, const std::string& local_dir,
+                                     std::string* prefix, int64_t* step);
+
+// Copies the complete emergency checkpoint `prefix` to `upload_dir`, its
+// ".complete" file last, and sets `*uploaded_prefix`.
+Status CopyEmergencyCheckpoint(Env* env, const std::string& prefix,
+                               const std::string& upload_dir,
+                               std::string* uploaded_prefix);
+
+// Writes an emergency checkpoint when the preemption sync point is reached,
+// and uploads it asynchronously once training resumes from it.
+//
+// Example:
+//   EmergencyCheckpointer checkpointer(env, options, get_variables);
+//   checkpointer.RegisterWith(sync_manager);
+//   // `sync_manager->ReachedSyncPoint()` now saves before returning true.
+//
+//   // After the restart, on the same host:
+//   checkpointer.StartUpload([](const Status& s, const std::string& prefix) {
+//     ...
+//   });
+class EmergencyCheckpointer {
+ public:
+  // Returns the named tensors to save, e.g. copies of the variables.
+  using TensorsFn = std::function<Status(
+      std::vector<std::pair<std::string, Tensor>>* tensors)>;
+  using UploadDoneFn =
+      std::function<void(const Status& s, const std::string& uploaded_prefix)>;
+
+  EmergencyCheckpointer(Env* env, EmergencyCheckpointOptions options,
+                        TensorsFn get_tensors);
+  // Waits for the pending upload, if any.
+  ~EmergencyCheckpointer();
+
+  // Makes `sync_manager` save an emergency checkpoint when its sync point is
+  // reached. This checkpointer must outlive the calls to
+  // `sync_manager->ReachedSyncPoint()`.
+  void RegisterWith(PreemptionSyncManager* sync_manager);
+
+  // Saves the emergency checkpoint of `step`.
+  Status Save(int64_t step);
+
+  // The status of the last save, e.g. the one triggered by the sync point.
+  Status last_save_status() const;
+
+  // Copies the latest emergency checkpoint in `options.local_dir` to
+  // `options.upload_dir` on a background thread, then calls `done`. At most
+  // one upload runs at a time.
+  void StartUpload(UploadDoneFn done);
+
+ private:
+  Env* const env_;
+  const EmergencyCheckpointOptions options_;
+  const TensorsFn get_tensors_;
+
+  mutable mutex mu_;
+  Status last_save_status_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> upload_thread_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_PREEMPTION_EMERGENCY_CHECKPOINT_H_
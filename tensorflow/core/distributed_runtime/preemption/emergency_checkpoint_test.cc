@@ -0,0 +1,141 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/preemption/emergency_checkpoint.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<std::pair<std::string, Tensor>> TestTensors() {
+  std::vector<std::pair<std::string, Tensor>> tensors;
+  for (int i = 0; i < 10; ++i) {
+    Tensor tensor(DT_FLOAT, TensorShape({i + 1}));
+    test::FillIota<float>(&tensor, i);
+    tensors.emplace_back(absl::StrCat("var_", i), tensor);
+  }
+  return tensors;
+}
+
+void ExpectBundleHasTensors(
+    const std::string& prefix,
+    const std::vector<std::pair<std::string, Tensor>>& tensors) {
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  for (const auto& [name, expected] : tensors) {
+    Tensor tensor;
+    TF_ASSERT_OK(reader.Lookup(name, &tensor));
+    test::ExpectTensorEqual<float>(tensor, expected);
+  }
+}
+
+EmergencyCheckpointOptions TestOptions(const std::string& name) {
+  EmergencyCheckpointOptions options;
+  options.local_dir = io::JoinPath(testing::TmpDir(), name, "local");
+  options.upload_dir = io::JoinPath(testing::TmpDir(), name, "upload");
+  options.num_writers = 4;
+  return options;
+}
+
+TEST(EmergencyCheckpointTest, WritesWithParallelWriters) {
+  const EmergencyCheckpointOptions options = TestOptions("parallel");
+  const auto tensors = TestTensors();
+  std::string prefix;
+  TF_ASSERT_OK(WriteEmergencyCheckpoint(Env::Default(), options, /*step=*/7,
+                                        tensors, &prefix));
+  ExpectBundleHasTensors(prefix, tensors);
+
+  std::string latest_prefix;
+  int64_t step;
+  TF_ASSERT_OK(FindLatestEmergencyCheckpoint(Env::Default(), options.local_dir,
+                                             &latest_prefix, &step));
+  EXPECT_EQ(latest_prefix, prefix);
+  EXPECT_EQ(step, 7);
+}
+
+TEST(EmergencyCheckpointTest, IgnoresIncompleteCheckpoints) {
+  const EmergencyCheckpointOptions options = TestOptions("incomplete");
+  std::string prefix;
+  TF_ASSERT_OK(WriteEmergencyCheckpoint(Env::Default(), options, /*step=*/7,
+                                        TestTensors(), &prefix));
+  TF_ASSERT_OK(WriteEmergencyCheckpoint(Env::Default(), options, /*step=*/9,
+                                        TestTensors(), &prefix));
+  // As if the preemption interrupted the save of step 9.
+  TF_ASSERT_OK(Env::Default()->DeleteFile(absl::StrCat(prefix, ".complete")));
+
+  std::string latest_prefix;
+  int64_t step;
+  TF_ASSERT_OK(FindLatestEmergencyCheckpoint(Env::Default(), options.local_dir,
+                                             &latest_prefix, &step));
+  EXPECT_EQ(step, 7);
+
+  EXPECT_TRUE(errors::IsNotFound(FindLatestEmergencyCheckpoint(
+      Env::Default(), io::JoinPath(testing::TmpDir(), "missing"),
+      &latest_prefix, &step)));
+}
+
+TEST(EmergencyCheckpointTest, SavesAndUploads) {
+  const EmergencyCheckpointOptions options = TestOptions("upload");
+  const auto tensors = TestTensors();
+  EmergencyCheckpointer checkpointer(
+      Env::Default(), options,
+      [&tensors](std::vector<std::pair<std::string, Tensor>>* out) {
+        *out = tensors;
+        return OkStatus();
+      });
+  TF_ASSERT_OK(checkpointer.Save(/*step=*/3));
+  TF_EXPECT_OK(checkpointer.last_save_status());
+
+  absl::Notification uploaded;
+  Status upload_status;
+  std::string uploaded_prefix;
+  checkpointer.StartUpload([&](const Status& s, const std::string& prefix) {
+    upload_status = s;
+    uploaded_prefix = prefix;
+    uploaded.Notify();
+  });
+  uploaded.WaitForNotification();
+  TF_ASSERT_OK(upload_status);
+  EXPECT_EQ(uploaded_prefix, io::JoinPath(options.upload_dir, "emergency-3"));
+  ExpectBundleHasTensors(uploaded_prefix, tensors);
+  TF_EXPECT_OK(
+      Env::Default()->FileExists(absl::StrCat(uploaded_prefix, ".complete")));
+}
+
+TEST(EmergencyCheckpointTest, RecordsSaveErrors) {
+  EmergencyCheckpointer checkpointer(
+      Env::Default(), TestOptions("error"),
+      [](std::vector<std::pair<std::string, Tensor>>* out) {
+        return errors::Unavailable("no variables");
+      });
+  EXPECT_TRUE(errors::IsUnavailable(checkpointer.Save(/*step=*/1)));
+  EXPECT_TRUE(errors::IsUnavailable(checkpointer.last_save_status()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -31,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -40,6 +42,22 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+
+auto* grpc_worker_rpc_latency = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc_worker_rpc_latency",
+     "Microseconds from issuing a worker RPC to a target until its completion.",
+     "target"},
+    // 10us to ~100s.
+    monitoring::Buckets::Exponential(10, 2, 24));
+
+auto* grpc_worker_received_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/grpc_worker_received_bytes",
+    "Bytes of tensors received from a target by RecvTensor and RecvBuf RPCs.",
+    "target");
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
@@ -66,8 +84,11 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        recvtensorbatch_(Method(GrpcWorkerMethod::kRecvTensorBatch)),
         logger_(logger),
-        target_(target) {}
+        target_(target),
+        rpc_latency_(grpc_worker_rpc_latency->GetCell(target)),
+        received_bytes_(grpc_worker_received_bytes->GetCell(target)) {}
 
   ~GrpcRemoteWorker() override {}
 
@@ -137,6 +158,10 @@ class GrpcRemoteWorker : public WorkerInterface {
 
     auto callback = [this, request, response, done, start_usec,
                      logging_active](Status s) {
+      if (s.ok()) {
+        received_bytes_->IncrementBy(
+            response->transport_options().value().size());
+      }
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64_t end_usec = Env::Default()->NowMicros();
@@ -206,6 +231,7 @@ class GrpcRemoteWorker : public WorkerInterface {
 
     auto callback = [this, request, response, done, start_usec,
                      logging_active](Status s) {
+      if (s.ok()) received_bytes_->IncrementBy(response->tensor().TotalBytes());
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64_t end_usec = Env::Default()->NowMicros();
@@ -258,6 +284,14 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void RecvTensorBatchAsync(CallOptions* call_opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    IssueRequest(request, response, recvtensorbatch_, std::move(done),
+                 call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -276,21 +310,34 @@ class GrpcRemoteWorker : public WorkerInterface {
                     StatusCallback done, CallOptions* call_opts = nullptr,
                     bool fail_fast = true) {
     new RPCState<protobuf::Message>(
-        &stub_, cq_, method, *request, response, std::move(done), call_opts,
-        callback_threadpool_, MaxRetries(), fail_fast, &target_);
+        &stub_, cq_, method, *request, response,
+        WithLatencyMetric(std::move(done)), call_opts, callback_threadpool_,
+        MaxRetries(), fail_fast, &target_);
   }
 
   void IssueRequest(const protobuf::Message* request, TensorResponse* response,
                     const ::grpc::string& method, StatusCallback done,
                     CallOptions* call_opts = nullptr) {
     new RPCState<TensorResponse>(
-        &stub_, cq_, method, *request, response, std::move(done), call_opts,
-        callback_threadpool_, MaxRetries(),
+        &stub_, cq_, method, *request, response,
+        WithLatencyMetric(std::move(done)), call_opts, callback_threadpool_,
+        MaxRetries(),
         /*fail_fast=*/true, &target_,
         // Use optimized proto parse function that avoids a copy.
         GrpcMaybeParseTensorResponse);
   }
 
+  // Wraps `done` to record the latency of the RPC in rpc_latency_.  The cell
+  // is captured rather than `this`, as done() can delete this worker object.
+  StatusCallback WithLatencyMetric(StatusCallback done) {
+    const uint64 start_micros = Env::Default()->NowMicros();
+    return [rpc_latency = rpc_latency_, start_micros,
+            done = std::move(done)](const Status& s) {
+      rpc_latency->Add(Env::Default()->NowMicros() - start_micros);
+      done(s);
+    };
+  }
+
   void IssueMarkRecvFinishedRequest(int64_t request_id) {
     VLOG(2) << "Send MarkRecvFinishedRequest for request " << request_id;
     MarkRecvFinishedRequest request;
@@ -333,11 +380,16 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string recvtensorbatch_;
 
   // Support for logging.
   WorkerCacheLogger* logger_;
   const string target_;
 
+  // Metrics of the target, shared by all the workers of the target.
+  monitoring::SamplerCell* const rpc_latency_;
+  monitoring::CounterCell* const received_bytes_;
+
   GrpcRemoteWorker(const GrpcRemoteWorker&) = delete;
   void operator=(const GrpcRemoteWorker&) = delete;
 };
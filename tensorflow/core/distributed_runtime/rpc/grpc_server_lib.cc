@@ -221,6 +221,12 @@ Status GrpcServer::Init(const GrpcServerOptions& opts) {
   }
   master_env_.experimental_num_shards = std::max(1, num_tasks);
   worker_env_.experimental_num_shards = master_env_.experimental_num_shards;
+  worker_env_.recv_tensor_batch_window_micros =
+      config.rpc_options().recv_tensor_batch_window_micros();
+  if (config.rpc_options().recv_tensor_batch_max_size() > 0) {
+    worker_env_.recv_tensor_batch_max_size =
+        config.rpc_options().recv_tensor_batch_max_size();
+  }
 
   worker_env_.rendezvous_mgr = opts.rendezvous_mgr_func == nullptr
                                    ? new RpcRendezvousMgr(&worker_env_)
@@ -420,6 +426,11 @@ Status GrpcServer::WorkerCacheFactory(const WorkerCacheFactoryOptions& options,
     return errors::InvalidArgument("Requested port ", requested_port,
                                    " differs from expected port ", bound_port_);
   }
+  if (options.rpc_options.channel_warm_up_timeout_in_ms() > 0) {
+    WarmUpGrpcChannels(channel_cache.get(), grpc_worker_env(), name_prefix,
+                       options.rpc_options.num_channels_per_target(),
+                       options.rpc_options.channel_warm_up_timeout_in_ms());
+  }
   *worker_cache = NewGrpcWorkerCacheWithLocalWorker(
       channel_cache, grpc_worker_env(), worker_impl(), name_prefix);
   return OkStatus();
@@ -135,7 +135,8 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 }
 
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result) {
+                              ::grpc::ByteBuffer* result,
+                              const CompressedTensorMetadata* compression) {
   const int kLargeTensorBytes = 1024;
   const int64_t kProtoBufLimitBytes = 1LL << 31;
 
@@ -153,6 +154,9 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
+  if (compression != nullptr) {
+    *response.mutable_compression() = *compression;
+  }
   if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
@@ -19,6 +19,7 @@ limitations under the License.
 #include "grpcpp/impl/codegen/byte_buffer.h"
 
 namespace tensorflow {
+class CompressedTensorMetadata;
 class Tensor;
 class RecvTensorResponse;
 
@@ -45,9 +46,14 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 //
 // "val" holds the tensor value to be encoded.
 //
+// If "compression" is not null, "val" is the compressed encoding of the
+// tensor it describes, and it is encoded as "RecvTensorResponse::compression".
+//
 // Discards original contents of *result.
-void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result);
+void EncodeTensorToByteBuffer(
+    bool is_dead, const Tensor& val, bool require_ack,
+    ::grpc::ByteBuffer* result,
+    const CompressedTensorMetadata* compression = nullptr);
 
 }  // namespace grpc
 }  // namespace tensorflow
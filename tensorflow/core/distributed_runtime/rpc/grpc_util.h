@@ -50,6 +50,10 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares the bytes if they lie within one slice of the buffer, which the
+  // returned TensorBuffer keeps alive.
+  TensorBuffer* ShareBytes(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
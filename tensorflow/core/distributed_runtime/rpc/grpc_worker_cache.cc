@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_cache.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+
 #include "tensorflow/core/distributed_runtime/rpc/coordination/grpc_coordination_client.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
@@ -22,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
 #include "tensorflow/core/distributed_runtime/worker_cache_partial.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/env_var.h"
@@ -30,6 +34,58 @@ namespace tensorflow {
 
 namespace {
 
+auto* grpc_channel_connect_latency = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/grpc_channel_connect_latency",
+     "Microseconds taken by a warmed up gRPC channel to a worker to connect.",
+     "target"},
+    // 100us to ~100s.
+    monitoring::Buckets::Exponential(100, 2, 20));
+
+// Follows the connectivity state of a channel being warmed up, on the
+// completion queue of a GrpcWorkerEnv.  Deletes itself once the channel is
+// connected or the deadline has passed.
+class ChannelWarmUpTag : public GrpcClientCQTag {
+ public:
+  ChannelWarmUpTag(const string& target, SharedGrpcChannelPtr channel,
+                   ::grpc::CompletionQueue* cq, int64_t timeout_in_ms)
+      : target_(target),
+        channel_(std::move(channel)),
+        cq_(cq),
+        timeout_in_ms_(timeout_in_ms),
+        start_micros_(Env::Default()->NowMicros()),
+        deadline_(std::chrono::system_clock::now() +
+                  std::chrono::milliseconds(timeout_in_ms)) {}
+
+  void Start() { OnCompleted(/*ok=*/true); }
+
+  // `ok` is false once the deadline has passed.
+  void OnCompleted(bool ok) override {
+    const grpc_connectivity_state state =
+        channel_->GetState(/*try_to_connect=*/true);
+    if (state == GRPC_CHANNEL_READY) {
+      const uint64 latency = Env::Default()->NowMicros() - start_micros_;
+      grpc_channel_connect_latency->GetCell(target_)->Add(latency);
+      VLOG(2) << "gRPC channel to " << target_ << " connected in " << latency
+              << "us";
+      delete this;
+    } else if (!ok) {
+      LOG(WARNING) << "gRPC channel to " << target_ << " not connected after "
+                   << timeout_in_ms_ << "ms of warm-up";
+      delete this;
+    } else {
+      channel_->NotifyOnStateChange(state, deadline_, cq_, this);
+    }
+  }
+
+ private:
+  const string target_;
+  const SharedGrpcChannelPtr channel_;
+  ::grpc::CompletionQueue* const cq_;  // Not owned.
+  const int64_t timeout_in_ms_;
+  const uint64 start_micros_;
+  const std::chrono::system_clock::time_point deadline_;
+};
+
 class GrpcWorkerCache : public WorkerCachePartial {
  public:
   explicit GrpcWorkerCache(std::shared_ptr<GrpcChannelCache> channel_cache,
@@ -180,4 +236,24 @@ WorkerCacheInterface* NewGrpcWorkerCacheWithLocalWorker(
   return new GrpcWorkerCache(cc, local_worker, local_target, worker_env);
 }
 
+void WarmUpGrpcChannels(GrpcChannelCache* cc, GrpcWorkerEnv* worker_env,
+                        const string& local_target, int num_channels_per_target,
+                        int64_t timeout_in_ms) {
+  std::vector<string> workers;
+  cc->ListWorkers(&workers);
+  size_t next_queue = 0;
+  for (const string& target : workers) {
+    if (target == local_target) continue;
+    // Successive lookups of a target return its channels in turn.
+    for (int i = 0; i < std::max(num_channels_per_target, 1); ++i) {
+      SharedGrpcChannelPtr channel = cc->FindWorkerChannel(target);
+      if (!channel) break;
+      ::grpc::CompletionQueue* cq = worker_env->GetCompletionQueue(
+          next_queue++ % worker_env->CompletionQueueSize());
+      (new ChannelWarmUpTag(target, std::move(channel), cq, timeout_in_ms))
+          ->Start();
+    }
+  }
+}
+
 }  // namespace tensorflow
@@ -72,5 +72,14 @@ WorkerCacheInterface* NewGrpcWorkerCacheWithLocalWorker(
     std::shared_ptr<GrpcChannelCache> cc, GrpcWorkerEnv* worker_env,
     WorkerInterface* local_worker, const string& local_target);
 
+// Starts connecting, without waiting for them, the `num_channels_per_target`
+// channels of `cc` to each worker other than `local_target`.  The time each
+// channel takes to connect is exported under
+// /tensorflow/core/grpc_channel_connect_latency.  Channels that are not
+// connected after `timeout_in_ms` are logged and keep connecting.
+void WarmUpGrpcChannels(GrpcChannelCache* cc, GrpcWorkerEnv* worker_env,
+                        const string& local_target, int num_channels_per_target,
+                        int64_t timeout_in_ms);
+
 }  // namespace tensorflow
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_CACHE_H_
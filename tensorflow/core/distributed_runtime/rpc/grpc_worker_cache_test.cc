@@ -86,4 +86,30 @@ TEST(GrpcWorkerCacheTest, DestructWorkerCacheInThreadPool) {
   n.WaitForNotification();
 }
 
+TEST(GrpcWorkerCacheTest, WarmUpUnreachableWorkers) {
+  GrpcChannelSpec spec;
+  TF_ASSERT_OK(
+      spec.AddHostPortsJob("worker", {{0, "a:0"}, {1, "b:1"}, {2, "c:2"}}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(2);
+  auto channel_cache = std::shared_ptr<GrpcChannelCache>(
+      NewGrpcChannelCache(spec, channel_func, rpc_options));
+  std::unique_ptr<GrpcWorkerEnv> grpc_worker_env(CreateGrpcWorkerEnv());
+
+  // The warm-up of the channels gives up after the timeout, so that the
+  // completion queues of the GrpcWorkerEnv can be drained on destruction.
+  WarmUpGrpcChannels(channel_cache.get(), grpc_worker_env.get(),
+                     "/job:worker/replica:0/task:0",
+                     rpc_options.num_channels_per_target(),
+                     /*timeout_in_ms=*/10);
+  std::unique_ptr<WorkerCacheInterface> worker_cache(
+      NewGrpcWorkerCache(channel_cache, grpc_worker_env.get()));
+  WorkerInterface* wi =
+      worker_cache->GetOrCreateWorker("/job:worker/replica:0/task:1");
+  EXPECT_NE(wi, nullptr);
+  worker_cache->ReleaseWorker("/job:worker/replica:0/task:1", wi);
+}
+
 }  // namespace tensorflow
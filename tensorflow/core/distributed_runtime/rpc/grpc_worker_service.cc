@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -148,6 +149,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -284,6 +286,25 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(3) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -427,6 +448,13 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
+  if (config.rpc_options().share_recv_tensor_responses()) {
+    shared_responses_ = std::make_unique<SharedTensorResponseCache>();
+  }
+  if (config.rpc_options().tensor_compression_rules_size() > 0) {
+    tensor_compression_rules_ =
+        std::make_unique<TensorCompressionRules>(config.rpc_options());
+  }
 }
 
 void GrpcWorker::EnableResponseCache() {
@@ -447,12 +475,50 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
-    if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+  // The tensor is compressed if the receiver accepts it, in which case it
+  // receives the tensor in host memory.
+  const TensorCompressionRules* compression_rules =
+      request->accept_compressed_tensor() ? tensor_compression_rules_.get()
+                                          : nullptr;
+  SharedTensorResponseCache* shared_responses = shared_responses_.get();
+  auto do_response = [response, done, cache_enabled, compression_rules,
+                      shared_responses, step_id,
+                      request](const Tensor& tensor, bool is_dead,
+                               const Status& status) {
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+    const TensorCompressionCodec codec =
+        compression_rules != nullptr && !is_dead
+            ? compression_rules->CodecFor(request->rendezvous_key(), tensor)
+            : RPCOptions::TensorCompressionRule::NONE;
+    auto encode = [&tensor, is_dead, cache_enabled,
+                   codec](::grpc::ByteBuffer* encoded) {
+      Tensor compressed;
+      CompressedTensorMetadata compression;
+      if (codec != RPCOptions::TensorCompressionRule::NONE &&
+          CompressTensor(codec, tensor, &compressed, &compression)) {
+        grpc::EncodeTensorToByteBuffer(is_dead, compressed, cache_enabled,
+                                       encoded, &compression);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       encoded);
+      }
+    };
+    if (shared_responses != nullptr &&
+        SharedTensorResponseCache::CanShare(tensor, is_dead)) {
+      // The workers receiving the same tensor value, e.g. a variable read on a
+      // parameter server, share its encoding.
+      shared_responses->EncodeTensor(
+          step_id, tensor, codec, cache_enabled, encode,
+          [response, done](const ::grpc::ByteBuffer& encoded) {
+            *response = encoded;
+            done(OkStatus());
+          });
+      return;
     }
+    encode(response);
     done(status);
   };
 
@@ -476,12 +542,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     }
   };
 
-  auto fail = [&rendezvous_done](const Status& status) {
-    rendezvous_done(Tensor(), false, status);
+  RecvLocalTensorAsync(opts, request, std::move(rendezvous_done));
+}
+
+void GrpcWorker::RecvLocalTensorAsync(CallOptions* opts,
+                                      const RecvTensorRequest* request,
+                                      RecvLocalTensorCallback done) {
+  const int64_t step_id = request->step_id();
+  auto fail = [&done](const Status& status) {
+    done(Tensor(), false, status);
   };
 
   Status s = recent_request_ids_.TrackUnique(
-      request_id, "RecvTensor (GrpcWorker)", *request);
+      request->request_id(), "RecvTensor (GrpcWorker)", *request);
   if (!s.ok()) {
     fail(s);
     return;
@@ -508,24 +581,28 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   // failures, and the client might not observe any errors or cancellations but
   // simply waits for the responses. Aborting the step would report an error to
   // the client, and avoid permanent hanging in distributed function execution.
-  opts->SetCancelCallback([this, step_id]() {
-    LOG(WARNING) << "RecvTensor cancelled for " << step_id;
-    AbortStep(step_id);
-  });
+  if (opts != nullptr) {
+    opts->SetCancelCallback([this, step_id]() {
+      LOG(WARNING) << "RecvTensor cancelled for " << step_id;
+      AbortStep(step_id);
+    });
+  }
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
+      [opts, done, src_dev, request](
           const Status& status, const Rendezvous::Args& send_args,
           const Rendezvous::Args& recv_args, const Tensor& val,
           const bool is_dead) {
-        opts->ClearCancelCallback();
+        if (opts != nullptr) {
+          opts->ClearCancelCallback();
+        }
         if (!status.ok()) {
-          return rendezvous_done(val, is_dead, status);
+          return done(val, is_dead, status);
         }
 
         const bool on_host = send_args.alloc_attrs.on_host();
         if (!src_dev->tensorflow_accelerator_device_info() || on_host) {
-          return rendezvous_done(val, is_dead, status);
+          return done(val, is_dead, status);
         }
 
         DeviceContext* send_dev_context = send_args.device_context;
@@ -542,10 +619,9 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
             << "send dev name: " << src_dev->name()
             << " gpu_info: " << src_dev->tensorflow_accelerator_device_info();
 
-        StatusCallback copy_ready = [rendezvous_done, copy,
-                                     is_dead](const Status& s) {
+        StatusCallback copy_ready = [done, copy, is_dead](const Status& s) {
           // The value is now ready to be returned on the wire.
-          rendezvous_done(*copy, is_dead, s);
+          done(*copy, is_dead, s);
           delete copy;
         };
 
@@ -554,6 +630,88 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  const int num_tensors = request->requests_size();
+  if (num_tensors == 0) {
+    done(OkStatus());
+    return;
+  }
+  const int64_t step_id = request->requests(0).step_id();
+  for (const RecvTensorRequest& tensor_request : request->requests()) {
+    if (tensor_request.step_id() != step_id) {
+      done(errors::InvalidArgument(
+          "The requests of a RecvTensorBatch RPC must have the same step_id, "
+          "got ",
+          step_id, " and ", tensor_request.step_id()));
+      return;
+    }
+  }
+  for (int i = 0; i < num_tensors; ++i) {
+    response->add_responses();
+  }
+
+  // As in GrpcRecvTensorAsync, cancelling the RPC while tensors are pending
+  // aborts the step.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "RecvTensorBatch cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  struct BatchState {
+    mutex mu;
+    int num_pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<BatchState>();
+  {
+    mutex_lock l(state->mu);
+    state->num_pending = num_tensors;
+  }
+  for (int i = 0; i < num_tensors; ++i) {
+    const RecvTensorRequest* tensor_request = &request->requests(i);
+    RecvTensorResponse* tensor_response = response->mutable_responses(i);
+    RecvLocalTensorAsync(
+        /*opts=*/nullptr, tensor_request,
+        [this, opts, state, tensor_request, tensor_response, done](
+            const Tensor& tensor, bool is_dead, const Status& status) {
+          if (status.ok()) {
+            FillRecvTensorResponse(*tensor_request, tensor, is_dead,
+                                   tensor_response);
+          }
+          Status batch_status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(status);
+            if (--state->num_pending > 0) return;
+            batch_status = state->status;
+          }
+          opts->ClearCancelCallback();
+          done(batch_status);
+        });
+  }
+}
+
+void GrpcWorker::FillRecvTensorResponse(const RecvTensorRequest& request,
+                                        const Tensor& tensor, bool is_dead,
+                                        RecvTensorResponse* response) {
+  response->set_is_dead(is_dead);
+  response->set_send_start_micros(env_->env->NowMicros());
+  Tensor compressed;
+  CompressedTensorMetadata compression;
+  if (tensor_compression_rules_ != nullptr &&
+      request.accept_compressed_tensor() && !is_dead &&
+      CompressTensor(
+          tensor_compression_rules_->CodecFor(request.rendezvous_key(), tensor),
+          tensor, &compressed, &compression)) {
+    compressed.AsProtoTensorContent(response->mutable_tensor());
+    response->mutable_compression()->Swap(&compression);
+  } else {
+    tensor.AsProtoTensorContent(response->mutable_tensor());
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -736,6 +894,9 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
     // a worker crashes before acking a request.
     response_cache_->CleanEntriesForStep(request->step_id());
   }
+  if (shared_responses_) {
+    shared_responses_->CleanEntriesForStep(request->step_id());
+  }
   Worker::CleanupGraphAsync(request, response, done);
 }
 
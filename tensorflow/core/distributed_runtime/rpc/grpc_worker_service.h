@@ -16,12 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_WORKER_SERVICE_H_
 
+#include <functional>
 #include <memory>
 #include <unordered_map>
 
 #include "grpcpp/server_builder.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 #include "tsl/distributed_runtime/rpc/async_service_interface.h"
@@ -40,6 +42,7 @@ class ConfigProto;
 struct WorkerEnv;
 class WorkerSession;
 class RpcResponseCache;
+class SharedTensorResponseCache;
 
 class GrpcWorker : public Worker {
  public:
@@ -51,6 +54,11 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -68,7 +76,25 @@ class GrpcWorker : public Worker {
   void RemoveCacheEntryForId(int64_t request_id);
 
  private:
+  using RecvLocalTensorCallback =
+      std::function<void(const Tensor&, bool is_dead, const Status&)>;
+
+  // Receives the tensor of `request` from the local rendezvous, copied to host
+  // memory if it is on an accelerator. If `opts` is not null, cancelling it
+  // before the tensor is produced aborts the step.
+  void RecvLocalTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
+                            RecvLocalTensorCallback done);
+
+  // Encodes `tensor` into `response`, compressing it if `request` allows it.
+  void FillRecvTensorResponse(const RecvTensorRequest& request,
+                              const Tensor& tensor, bool is_dead,
+                              RecvTensorResponse* response);
+
   std::unique_ptr<RpcResponseCache> response_cache_;
+  // Null unless RPCOptions.share_recv_tensor_responses is set.
+  std::unique_ptr<SharedTensorResponseCache> shared_responses_;
+  // Null if none of the tensors sent by GrpcRecvTensorAsync are compressed.
+  std::unique_ptr<TensorCompressionRules> tensor_compression_rules_;
   const int32 recv_buf_max_chunk_;
 };
 
@@ -15,12 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -36,6 +43,8 @@ namespace tensorflow {
 
 namespace {
 
+class RpcRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
   RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
@@ -47,8 +56,32 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
                            DoneCallback done) override;
 
  private:
+  // Recv calls to the same remote worker which wait to be sent as one
+  // RecvTensorBatch RPC, with the callbacks to run when they are done.
+  struct PendingBatch {
+    int64_t id;
+    std::vector<std::pair<RpcRecvTensorCall*, std::function<void()>>> calls;
+  };
+
   ~RpcRemoteRendezvous() override {}
 
+  // Adds `call` to the pending batch of its remote worker, which is sent when
+  // it is full or when the batching window has passed.
+  void AddToBatch(RpcRecvTensorCall* call, std::function<void()> recv_done);
+
+  // Sends the pending batch of `src_worker` if its id is `batch_id`.
+  void FlushBatch(const string& src_worker, int64_t batch_id);
+
+  void StartBatch(std::unique_ptr<PendingBatch> batch);
+
+  mutex batch_mu_;
+  int64_t next_batch_id_ TF_GUARDED_BY(batch_mu_) = 0;
+  absl::flat_hash_map<string, std::unique_ptr<PendingBatch>> pending_batches_
+      TF_GUARDED_BY(batch_mu_);
+  // Set when a remote worker does not implement RecvTensorBatch, after which
+  // the tensors of this step are received one RPC at a time.
+  std::atomic<bool> batching_unsupported_{false};
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -69,6 +102,11 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // Compressed tensors are decompressed on the host, so they are only
+    // accepted when the tensor is received into host memory.
+    req_.set_accept_compressed_tensor(
+        alloc_attrs.on_host() ||
+        dst_device->attributes().device_type() == DEVICE_CPU);
   }
 
   void Reset() {
@@ -83,6 +121,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     // opts_ appropriately.
     req_.Clear();
     resp_.Clear();
+    decompressed_tensor_ = Tensor();
     {
       mutex_lock l(mu_);
       status_ = OkStatus();
@@ -122,7 +161,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     wi_ = nullptr;
   }
 
-  const Tensor& tensor() const { return resp_.tensor(); }
+  const Tensor& tensor() const {
+    return resp_.metadata().has_compression() ? decompressed_tensor_
+                                              : resp_.tensor();
+  }
 
   bool is_dead() const { return resp_.metadata().is_dead(); }
 
@@ -142,10 +184,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
-      if (!s.ok()) {
-        mutex_lock l(mu_);
-        status_.Update(s);
-      }
+      FinishRecv(s);
       recv_done();
     };
     wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
@@ -167,6 +206,21 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Records the status `s` of receiving resp_, decompressing the tensor if
+  // needed.
+  void FinishRecv(const Status& s) {
+    Status status = s;
+    if (status.ok() && resp_.metadata().has_compression()) {
+      status = DecompressTensor(resp_.metadata().compression(), resp_.tensor(),
+                                dst_device_->GetAllocator(alloc_attrs_),
+                                &decompressed_tensor_);
+    }
+    if (!status.ok()) {
+      mutex_lock l(mu_);
+      status_.Update(status);
+    }
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -175,6 +229,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   CallOptions opts_;
   RecvTensorRequest req_;
   TensorResponse resp_;
+  // Holds the received tensor if the response is compressed.
+  Tensor decompressed_tensor_;
   Rendezvous::Args recv_args_;
   Rendezvous::DoneCallback done_;
 
@@ -289,7 +345,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, recv_args, worker_cache]() {
+  auto recv_done = [this, call, recv_args, worker_cache]() {
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -302,7 +358,142 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
-  });
+  };
+  if (env_->recv_tensor_batch_window_micros > 0 && !batching_unsupported_) {
+    AddToBatch(call, std::move(recv_done));
+  } else {
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::AddToBatch(RpcRecvTensorCall* call,
+                                     std::function<void()> recv_done) {
+  const string src_worker = call->src_worker_;
+  std::unique_ptr<PendingBatch> full_batch;
+  int64_t new_batch_id = -1;
+  {
+    mutex_lock l(batch_mu_);
+    std::unique_ptr<PendingBatch>& batch = pending_batches_[src_worker];
+    if (batch == nullptr) {
+      batch = std::make_unique<PendingBatch>();
+      batch->id = next_batch_id_++;
+      new_batch_id = batch->id;
+    }
+    batch->calls.emplace_back(call, std::move(recv_done));
+    if (static_cast<int>(batch->calls.size()) >=
+        env_->recv_tensor_batch_max_size) {
+      full_batch = std::move(batch);
+      pending_batches_.erase(src_worker);
+    }
+  }
+  if (full_batch != nullptr) {
+    StartBatch(std::move(full_batch));
+  } else if (new_batch_id >= 0) {
+    Ref();
+    env_->env->SchedClosureAfter(env_->recv_tensor_batch_window_micros,
+                                 [this, src_worker, new_batch_id]() {
+                                   FlushBatch(src_worker, new_batch_id);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     int64_t batch_id) {
+  std::unique_ptr<PendingBatch> batch;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    if (it == pending_batches_.end() || it->second->id != batch_id) {
+      // The batch was sent when it became full.
+      return;
+    }
+    batch = std::move(it->second);
+    pending_batches_.erase(it);
+  }
+  StartBatch(std::move(batch));
+}
+
+void RpcRemoteRendezvous::StartBatch(std::unique_ptr<PendingBatch> batch) {
+  struct BatchCall {
+    CallOptions opts;
+    RecvTensorBatchRequest request;
+    RecvTensorBatchResponse response;
+    std::vector<std::pair<RpcRecvTensorCall*, std::function<void()>>> calls;
+    Notification abort_checked;
+  };
+  auto* batch_call = new BatchCall;
+  for (auto& call : batch->calls) {
+    if (!call.first->status().ok()) {
+      // The call was aborted while waiting in the batch.
+      call.second();
+    } else {
+      batch_call->calls.push_back(std::move(call));
+    }
+  }
+  if (batch_call->calls.size() <= 1 || batching_unsupported_) {
+    for (auto& call : batch_call->calls) {
+      call.first->Start(std::move(call.second));
+    }
+    delete batch_call;
+    return;
+  }
+
+  for (auto& call : batch_call->calls) {
+    *batch_call->request.add_requests() = call.first->req_;
+    // Aborting any of the calls cancels the batch.
+    call.first->opts_.SetCancelCallback(
+        [batch_call]() { batch_call->opts.StartCancel(); });
+  }
+  WorkerInterface* wi = batch_call->calls[0].first->wi_;
+  wi->RecvTensorBatchAsync(
+      &batch_call->opts, &batch_call->request, &batch_call->response,
+      [this, batch_call](const Status& s) {
+        batch_call->abort_checked.WaitForNotification();
+        for (auto& call : batch_call->calls) {
+          call.first->opts_.ClearCancelCallback();
+        }
+        if (errors::IsUnimplemented(s)) {
+          VLOG(1) << "Remote worker does not support RecvTensorBatch, "
+                  << "receiving tensors one at a time: " << s;
+          batching_unsupported_ = true;
+          for (auto& call : batch_call->calls) {
+            call.first->Start(std::move(call.second));
+          }
+          delete batch_call;
+          return;
+        }
+        const int num_calls = batch_call->calls.size();
+        for (int i = 0; i < num_calls; ++i) {
+          RpcRecvTensorCall* call = batch_call->calls[i].first;
+          Status status = s;
+          if (status.ok() &&
+              batch_call->response.responses_size() != num_calls) {
+            status = errors::Internal(
+                "RecvTensorBatch returned ",
+                batch_call->response.responses_size(), " tensors, expected ",
+                num_calls);
+          }
+          if (status.ok()) {
+            call->resp_.InitAlloc(call->dst_device_, call->alloc_attrs_);
+            status = call->resp_.InitFrom(
+                batch_call->response.mutable_responses(i));
+          }
+          call->FinishRecv(status);
+          batch_call->calls[i].second();
+        }
+        delete batch_call;
+      });
+
+  // As in RpcRecvTensorCall::StartRTCall, calls aborted before their cancel
+  // callback was set must cancel the RPC.
+  for (auto& call : batch_call->calls) {
+    if (!call.first->status().ok()) {
+      batch_call->opts.StartCancel();
+      break;
+    }
+  }
+  batch_call->abort_checked.Notify();
 }
 
 }  // namespace
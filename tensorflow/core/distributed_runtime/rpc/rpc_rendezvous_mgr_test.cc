@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -66,6 +67,30 @@ class DummyWorker : public TestWorkerInterface {
       done(OkStatus());
     });
   }
+
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override {
+    {
+      mutex_lock l(mu_);
+      batch_sizes_.push_back(request->requests_size());
+    }
+    for (int i = 0; i < request->requests_size(); ++i) {
+      V("peach").AsProtoTensorContent(
+          response->add_responses()->mutable_tensor());
+    }
+    SchedClosure([done = std::move(done)]() { done(OkStatus()); });
+  }
+
+  std::vector<int> batch_sizes() {
+    mutex_lock l(mu_);
+    return batch_sizes_;
+  }
+
+ private:
+  mutex mu_;
+  std::vector<int> batch_sizes_ TF_GUARDED_BY(mu_);
 };
 
 // Fake cache implementation for WorkerEnv.
@@ -95,6 +120,9 @@ class DummyWorkerCache : public WorkerCacheInterface {
   void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
                               StatusCallback done) override {}
 
+ public:
+  DummyWorker* dummy_remote_worker() { return dummy_remote_worker_; }
+
  private:
   DummyWorker* dummy_remote_worker_ = nullptr;
 };
@@ -104,7 +132,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return OkStatus(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -342,4 +372,50 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvBatched) {
+  env.recv_tensor_batch_window_micros = 10 * 1000;
+  env.recv_tensor_batch_max_size = 4;
+  const int64_t step_id = 123;
+  const int num_requests = 10;
+  {
+    tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr_.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Rendezvous::Args args;
+    mutex mu;
+    Status status = OkStatus();
+    std::vector<string> values;
+    BlockingCounter counter(num_requests);
+    for (int i = 0; i < num_requests; ++i) {
+      const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+          FrameAndIter(0, 0)));
+      rendez->RecvAsync(
+          key, args,
+          [&mu, &status, &values, &counter](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            {
+              mutex_lock l(mu);
+              status.Update(s);
+              if (s.ok()) values.push_back(V(val));
+            }
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    EXPECT_EQ(values, std::vector<string>(num_requests, "peach"));
+  }
+  std::vector<int> batch_sizes = cache_->dummy_remote_worker()->batch_sizes();
+  int num_batched = 0;
+  for (int batch_size : batch_sizes) {
+    EXPECT_LE(batch_size, 4);
+    num_batched += batch_size;
+  }
+  EXPECT_EQ(num_batched, num_requests);
+  EXPECT_LT(static_cast<int>(batch_sizes.size()), num_requests);
+  rmgr_.Cleanup(step_id);
+}
+
 }  // namespace tensorflow
@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
 
+#include <utility>
+
 #include "absl/log/log.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
@@ -26,6 +30,11 @@ auto* tf_response_cache_hits = monitoring::Counter<0>::New(
     "/tensorflow/rpc/service/response_cache_hits",
     "Number of times the tensor response cache was used.");
 
+auto* tf_shared_tensor_response_hits = monitoring::Counter<0>::New(
+    "/tensorflow/rpc/service/shared_tensor_response_hits",
+    "Number of RecvTensor responses which reused the encoding of a tensor "
+    "sent by another request.");
+
 bool RpcResponseCache::QueueRequest(int64_t request_id, int64_t step_id,
                                     const FinishResponseCB& cb) {
   VLOG(1) << "RpcResponseCache Lookup " << request_id;
@@ -134,4 +143,85 @@ int64_t RpcResponseCache::size() {
   return response_cache_.size();
 }
 
+/* static */
+bool SharedTensorResponseCache::CanShare(const Tensor& tensor, bool is_dead) {
+  return !is_dead && tensor.IsInitialized() && tensor.TotalBytes() > 0 &&
+         !tensor.RefCountIsOne();
+}
+
+void SharedTensorResponseCache::EncodeTensor(int64_t step_id,
+                                             const Tensor& tensor, int codec,
+                                             bool require_ack,
+                                             const EncodeFn& encode,
+                                             const ResponseCB& cb) {
+  // The data pointer tells apart the slices of a buffer, and the shape the
+  // reshapes of a tensor.
+  const string key = strings::StrCat(
+      reinterpret_cast<uintptr_t>(DMAHelper::buffer(&tensor)), ":",
+      reinterpret_cast<uintptr_t>(tensor.tensor_data().data()), ":",
+      tensor.dtype(), ":", tensor.shape().DebugString(), ":", codec, ":",
+      require_ack);
+
+  std::shared_ptr<Entry> entry;
+  bool reuse = false;
+  {
+    mutex_lock m(mu_);
+    std::shared_ptr<Entry>& cached = entries_[key];
+    if (cached != nullptr) {
+      tf_shared_tensor_response_hits->GetCell()->IncrementBy(1);
+      if (!cached->encoded) {
+        VLOG(2) << "Waiting for the encoding of " << key;
+        cached->callbacks.push_back(cb);
+        return;
+      }
+      entry = cached;
+      reuse = true;
+    } else {
+      cached = std::make_shared<Entry>();
+      cached->step_id = step_id;
+      cached->tensor = tensor;
+      entry = cached;
+    }
+  }
+  if (reuse) {
+    VLOG(2) << "Reuse the encoding of " << key;
+    cb(entry->response);
+    return;
+  }
+
+  // The encoding runs outside the critical section, as it can be expensive.
+  encode(&entry->response);
+  std::vector<ResponseCB> callbacks;
+  {
+    mutex_lock m(mu_);
+    entry->encoded = true;
+    callbacks.swap(entry->callbacks);
+  }
+  cb(entry->response);
+  for (const ResponseCB& pending : callbacks) {
+    pending(entry->response);
+  }
+}
+
+void SharedTensorResponseCache::CleanEntriesForStep(int64_t step_id) {
+  std::vector<std::shared_ptr<Entry>> erased;
+  {
+    mutex_lock m(mu_);
+    for (auto it = entries_.begin(), last = entries_.end(); it != last;) {
+      if (it->second->step_id == step_id) {
+        erased.push_back(std::move(it->second));
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  // The tensors of the entries are released outside the critical section.
+}
+
+int64_t SharedTensorResponseCache::size() {
+  mutex_lock m(mu_);
+  return entries_.size();
+}
+
 }  // namespace tensorflow
@@ -15,10 +15,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RESPONSE_CACHE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RESPONSE_CACHE_H_
 
+#include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "grpcpp/impl/codegen/byte_buffer.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -92,6 +95,53 @@ class RpcResponseCache {
   gtl::FlatMap<int64_t, ResponseCacheEntry> response_cache_ TF_GUARDED_BY(mu_);
 };
 
+// Shares the encoded RecvTensor response of a tensor value between all the
+// requests that receive it, e.g. the workers of synchronous training reading
+// the same variable from a parameter server.
+//
+// Tensor values are identified by their buffer, so an entry keeps its tensor
+// alive until the step that created it is cleaned: the buffer can neither be
+// reused by another tensor nor, for resource variables, be updated in place in
+// the meantime, as their updates copy buffers that are still referenced.
+class SharedTensorResponseCache {
+ public:
+  using EncodeFn = std::function<void(::grpc::ByteBuffer* encoded)>;
+  using ResponseCB = std::function<void(const ::grpc::ByteBuffer& encoded)>;
+
+  // Returns true if the responses of `tensor` can be shared, i.e. if its buffer
+  // is also held by something other than the rendezvous of the step, such as a
+  // variable. Other tensors are only sent once.
+  static bool CanShare(const Tensor& tensor, bool is_dead);
+
+  // Invokes `cb` with the encoding of `tensor` with `codec`. If no encoding of
+  // the tensor is cached, runs `encode` and caches its result for step
+  // `step_id`. If another request is encoding the tensor, `cb` is invoked once
+  // it is done.
+  // Note ResponseCB is assumed to be thread-safe.
+  void EncodeTensor(int64_t step_id, const Tensor& tensor, int codec,
+                    bool require_ack, const EncodeFn& encode,
+                    const ResponseCB& cb);
+
+  // Erase cache entries created by the given step_id
+  void CleanEntriesForStep(int64_t step_id);
+
+  int64_t size();
+
+ private:
+  struct Entry {
+    int64_t step_id = -1;
+    Tensor tensor;
+    // Written by the request encoding the tensor before `encoded` is set, and
+    // read-only afterwards.
+    ::grpc::ByteBuffer response;
+    bool encoded = false;
+    std::vector<ResponseCB> callbacks;
+  };
+
+  mutex mu_;
+  gtl::FlatMap<string, std::shared_ptr<Entry>> entries_ TF_GUARDED_BY(mu_);
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RESPONSE_CACHE_H_
@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
+
+#include <vector>
+
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/slice.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+size_t ByteBufferSize(const ::grpc::ByteBuffer& buf) {
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  size_t size = 0;
+  for (const auto& s : slices) size += s.size();
+  return size;
+}
+
+TEST(SharedTensorResponseCacheTest, CanShare) {
+  Tensor owned = test::AsTensor<float>({1, 2, 3});
+  EXPECT_FALSE(SharedTensorResponseCache::CanShare(owned, false));
+  Tensor shared = owned;
+  EXPECT_TRUE(SharedTensorResponseCache::CanShare(owned, false));
+  EXPECT_FALSE(SharedTensorResponseCache::CanShare(owned, true));
+}
+
+TEST(SharedTensorResponseCacheTest, EncodesSharedTensorOnce) {
+  SharedTensorResponseCache cache;
+  Tensor variable = test::AsTensor<float>({1, 2, 3});
+  int num_encodes = 0;
+  auto encode = [&](::grpc::ByteBuffer* encoded) {
+    ++num_encodes;
+    grpc::EncodeTensorToByteBuffer(false, variable, false, encoded);
+  };
+
+  std::vector<size_t> sizes;
+  auto cb = [&sizes](const ::grpc::ByteBuffer& encoded) {
+    sizes.push_back(ByteBufferSize(encoded));
+  };
+  for (int64_t step_id : {1, 2, 3}) {
+    Tensor read = variable;
+    cache.EncodeTensor(step_id, read, /*codec=*/0, false, encode, cb);
+  }
+  EXPECT_EQ(num_encodes, 1);
+  ASSERT_EQ(sizes.size(), 3);
+  EXPECT_GT(sizes[0], 0);
+  EXPECT_EQ(sizes[1], sizes[0]);
+  EXPECT_EQ(sizes[2], sizes[0]);
+  EXPECT_EQ(cache.size(), 1);
+
+  // A different shape or codec of the same buffer is encoded again.
+  Tensor reshaped;
+  ASSERT_TRUE(reshaped.CopyFrom(variable, TensorShape({3, 1})));
+  cache.EncodeTensor(1, reshaped, /*codec=*/0, false, encode, cb);
+  cache.EncodeTensor(1, variable, /*codec=*/1, false, encode, cb);
+  EXPECT_EQ(num_encodes, 3);
+  EXPECT_EQ(cache.size(), 3);
+
+  // The entries belong to the step which encoded them.
+  cache.CleanEntriesForStep(2);
+  EXPECT_EQ(cache.size(), 3);
+  cache.CleanEntriesForStep(1);
+  EXPECT_EQ(cache.size(), 0);
+  cache.EncodeTensor(4, variable, /*codec=*/0, false, encode, cb);
+  EXPECT_EQ(num_encodes, 4);
+}
+
+TEST(SharedTensorResponseCacheTest, WaitsForPendingEncoding) {
+  SharedTensorResponseCache cache;
+  Tensor variable = test::AsTensor<int32>({7, 8});
+  int num_responses = 0;
+  auto cb = [&num_responses](const ::grpc::ByteBuffer& encoded) {
+    ++num_responses;
+  };
+  // A request arriving while the tensor is being encoded waits for the
+  // encoding instead of running its own.
+  auto encode = [&](::grpc::ByteBuffer* encoded) {
+    cache.EncodeTensor(1, variable, /*codec=*/0, false,
+                       [](::grpc::ByteBuffer*) { FAIL(); }, cb);
+    EXPECT_EQ(num_responses, 0);
+    grpc::EncodeTensorToByteBuffer(false, variable, false, encoded);
+  };
+  cache.EncodeTensor(1, variable, /*codec=*/0, false, encode, cb);
+  EXPECT_EQ(num_responses, 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
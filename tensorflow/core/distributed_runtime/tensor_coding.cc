@@ -109,6 +109,9 @@ Status TensorResponse::ParseFrom(Source* source) {
 
 // Define some helper routines for decoding protocol buffer wire format data
 namespace {
+// Tensor contents up to this size are always copied out of the received data.
+constexpr int kMinSharedTensorContentBytes = 1024;
+
 // We only need some of the wiretype values for this code
 enum WireType {
   WIRETYPE_VARINT = 0,
@@ -143,8 +146,35 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+bool TensorResponse::MaybeShareTensorContent(
+    Source* source, protobuf::io::CodedInputStream* input, DataType dtype,
+    const TensorShape& shape, int num_bytes) {
+  // The shared bytes are not allocated by allocator_, so the tensor can't
+  // honor allocation attributes such as being GPU or NIC compatible. Small
+  // tensors are cheaper to copy than to keep the received buffer alive for.
+  if (num_bytes <= kMinSharedTensorContentBytes ||
+      alloc_attrs_.gpu_compatible() || alloc_attrs_.nic_compatible()) {
+    return false;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return false;
+  }
+  TensorBuffer* buf =
+      source->ShareBytes(static_cast<const char*>(data), num_bytes);
+  if (buf == nullptr) {
+    return false;
+  }
+  tensor_ = Tensor(dtype, shape, buf);
+  buf->Unref();
+  return input->Skip(num_bytes);
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -195,12 +225,16 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
+        if (static_cast<size_t>(num_bytes) !=
+            shape.num_elements() * DataTypeSize(tensor_meta->dtype())) {
+          return false;
+        }
+        if (MaybeShareTensorContent(source, input, tensor_meta->dtype(), shape,
+                                    num_bytes)) {
+          break;
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
-        if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +267,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -265,6 +299,12 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kCompressionFieldNumber: {
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_compression()))
+          return false;
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -63,6 +63,15 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // If the `num_bytes` bytes at `data`, which were returned by the stream
+    // from the latest call to contents(), can back a Tensor without a copy,
+    // returns a TensorBuffer referencing them. The caller owns the one
+    // reference of the returned buffer. Returns nullptr otherwise, in which
+    // case the bytes are copied.
+    virtual TensorBuffer* ShareBytes(const char* data, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,8 +100,17 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+
+  // Returns a tensor of `dtype` and `shape` backed by the next `num_bytes`
+  // bytes of `input`, shared with `source`, if they are aligned and
+  // contiguous. Returns false and consumes nothing otherwise.
+  bool MaybeShareTensorContent(Source* source,
+                               protobuf::io::CodedInputStream* input,
+                               DataType dtype, const TensorShape& shape,
+                               int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
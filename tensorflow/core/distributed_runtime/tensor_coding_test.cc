@@ -15,13 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include <cstring>
+#include <optional>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -156,6 +162,76 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A TensorBuffer over memory it does not own.
+class UnownedBuffer : public TensorBuffer {
+ public:
+  UnownedBuffer(const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)), size_(size) {}
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {}
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+};
+
+// A source over an array, which shares the tensor contents it is asked to.
+class SharingArraySource : public TensorResponse::Source {
+ public:
+  SharingArraySource(const char* data, int size) : data_(data), size_(size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_.emplace(data_, size_);
+    return &*stream_;
+  }
+
+  TensorBuffer* ShareBytes(const char* data, size_t num_bytes) override {
+    return new UnownedBuffer(data, num_bytes);
+  }
+
+ private:
+  const char* const data_;
+  const int size_;
+  std::optional<protobuf::io::ArrayInputStream> stream_;
+};
+
+TEST(TensorResponseSharingTest, SharesAlignedTensorContent) {
+  Tensor src(DT_FLOAT, TensorShape({1024}));
+  for (int i = 0; i < src.NumElements(); ++i) {
+    src.flat<float>()(i) = i;
+  }
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  const size_t content_offset = encoded.find(string(src.tensor_data()));
+  ASSERT_NE(content_offset, string::npos);
+
+  for (int misalignment : {0, 1}) {
+    const size_t shift = (EIGEN_MAX_ALIGN_BYTES -
+                          content_offset % EIGEN_MAX_ALIGN_BYTES) %
+                             EIGEN_MAX_ALIGN_BYTES +
+                         misalignment;
+    char* buffer = static_cast<char*>(
+        port::AlignedMalloc(shift + encoded.size(), EIGEN_MAX_ALIGN_BYTES));
+    memcpy(buffer + shift, encoded.data(), encoded.size());
+    {
+      SharingArraySource source(buffer + shift, encoded.size());
+      TensorResponse response;
+      DummyDevice cpu_device(Env::Default());
+      response.InitAlloc(&cpu_device, AllocatorAttributes());
+      TF_ASSERT_OK(response.ParseFrom(&source));
+      test::ExpectTensorEqual<float>(response.tensor(), src);
+      // Misaligned contents are copied.
+      EXPECT_EQ(response.tensor().tensor_data().data() ==
+                    buffer + shift + content_offset,
+                misalignment == 0);
+    }
+    port::AlignedFree(buffer);
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
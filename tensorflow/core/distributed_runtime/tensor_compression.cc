@@ -0,0 +1,238 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "tensorflow/core/framework/bfloat16.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+
+namespace {
+
+using Rule = RPCOptions::TensorCompressionRule;
+
+auto* tensor_compression_input_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_compression/input_bytes",
+    "Bytes of the tensors compressed for RecvTensor responses.", "codec");
+
+auto* tensor_compression_output_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_compression/output_bytes",
+    "Bytes of the compressed tensors sent in RecvTensor responses. The "
+    "compression ratio is input_bytes / output_bytes.",
+    "codec");
+
+auto* tensor_compression_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_compression/compress_usecs",
+    "Microseconds spent compressing tensors for RecvTensor responses.",
+    "codec");
+
+auto* tensor_decompression_usecs = monitoring::Counter<1>::New(
+    "/tensorflow/rpc/tensor_compression/decompress_usecs",
+    "Microseconds spent decompressing tensors of RecvTensor responses.",
+    "codec");
+
+// Stores byte `j` of each of the `n` elements of `k` bytes in `src` at
+// `dst[j * n : (j + 1) * n]`.
+void ShuffleBytes(const char* src, int64_t n, int k, char* dst) {
+  for (int j = 0; j < k; ++j) {
+    for (int64_t i = 0; i < n; ++i) {
+      dst[j * n + i] = src[i * k + j];
+    }
+  }
+}
+
+// Inverse of ShuffleBytes.
+void UnshuffleBytes(const char* src, int64_t n, int k, char* dst) {
+  for (int j = 0; j < k; ++j) {
+    for (int64_t i = 0; i < n; ++i) {
+      dst[i * k + j] = src[j * n + i];
+    }
+  }
+}
+
+char* MutableTensorData(Tensor* t) {
+  return const_cast<char*>(t->tensor_data().data());
+}
+
+}  // namespace
+
+TensorCompressionRules::TensorCompressionRules(const RPCOptions& options) {
+  for (const Rule& rule : options.tensor_compression_rules()) {
+    auto key_pattern = std::make_unique<RE2>(rule.key_pattern(), RE2::Quiet);
+    if (!key_pattern->ok()) {
+      LOG(ERROR) << "Ignoring tensor compression rule with invalid key_pattern "
+                 << rule.key_pattern() << ": " << key_pattern->error();
+      continue;
+    }
+    rules_.push_back({std::move(key_pattern), rule.codec(), rule.min_bytes()});
+  }
+}
+
+TensorCompressionRules::~TensorCompressionRules() = default;
+
+TensorCompressionCodec TensorCompressionRules::CodecFor(
+    const std::string& key, const Tensor& val) const {
+  for (const CompiledRule& rule : rules_) {
+    if (RE2::FullMatch(key, *rule.key_pattern)) {
+      return val.TotalBytes() < rule.min_bytes ? Rule::NONE : rule.codec;
+    }
+  }
+  return Rule::NONE;
+}
+
+bool CompressTensor(TensorCompressionCodec codec, const Tensor& val,
+                    Tensor* compressed, CompressedTensorMetadata* metadata) {
+  if (!DataTypeCanUseMemcpy(val.dtype()) || val.NumElements() == 0) {
+    return false;
+  }
+  const uint64 start_us = Env::Default()->NowMicros();
+  Tensor result;
+  switch (codec) {
+    case Rule::SNAPPY:
+    case Rule::SHUFFLE_SNAPPY: {
+      StringPiece data = val.tensor_data();
+      const int element_bytes = DataTypeSize(val.dtype());
+      std::string shuffled;
+      if (codec == Rule::SHUFFLE_SNAPPY && element_bytes > 1) {
+        shuffled.resize(data.size());
+        ShuffleBytes(data.data(), val.NumElements(), element_bytes,
+                     &shuffled[0]);
+        data = shuffled;
+      }
+      std::string output;
+      if (!port::Snappy_Compress(data.data(), data.size(), &output) ||
+          output.size() >= data.size()) {
+        return false;
+      }
+      result = Tensor(DT_UINT8,
+                      TensorShape({static_cast<int64_t>(output.size())}));
+      memcpy(MutableTensorData(&result), output.data(), output.size());
+      break;
+    }
+    case Rule::CAST_BFLOAT16: {
+      if (val.dtype() != DT_FLOAT) return false;
+      result = Tensor(DT_BFLOAT16, val.shape());
+      RoundFloatToBFloat16(val.flat<float>().data(),
+                           result.flat<bfloat16>().data(), val.NumElements());
+      break;
+    }
+    case Rule::CAST_FLOAT16: {
+      if (val.dtype() != DT_FLOAT) return false;
+      result = Tensor(DT_HALF, val.shape());
+      result.flat<Eigen::half>() = val.flat<float>().cast<Eigen::half>();
+      break;
+    }
+    default:
+      return false;
+  }
+
+  const std::string& codec_name = Rule::Codec_Name(codec);
+  tensor_compression_input_bytes->GetCell(codec_name)
+      ->IncrementBy(val.TotalBytes());
+  tensor_compression_output_bytes->GetCell(codec_name)
+      ->IncrementBy(result.TotalBytes());
+  tensor_compression_usecs->GetCell(codec_name)
+      ->IncrementBy(Env::Default()->NowMicros() - start_us);
+
+  metadata->set_codec(codec);
+  metadata->set_dtype(val.dtype());
+  val.shape().AsProto(metadata->mutable_tensor_shape());
+  *compressed = std::move(result);
+  return true;
+}
+
+Status DecompressTensor(const CompressedTensorMetadata& metadata,
+                        const Tensor& compressed, Allocator* allocator,
+                        Tensor* val) {
+  const uint64 start_us = Env::Default()->NowMicros();
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(
+      TensorShape::BuildTensorShape(metadata.tensor_shape(), &shape));
+  if (!DataTypeCanUseMemcpy(metadata.dtype())) {
+    return errors::DataLoss("Cannot decompress a tensor of type ",
+                            DataTypeString(metadata.dtype()));
+  }
+  Tensor result(allocator, metadata.dtype(), shape);
+  if (!result.IsInitialized()) {
+    return errors::ResourceExhausted("Failed to allocate a tensor of shape ",
+                                     shape.DebugString(),
+                                     " to decompress a received tensor.");
+  }
+
+  switch (metadata.codec()) {
+    case Rule::SNAPPY:
+    case Rule::SHUFFLE_SNAPPY: {
+      StringPiece data = compressed.tensor_data();
+      size_t length;
+      if (compressed.dtype() != DT_UINT8 ||
+          !port::Snappy_GetUncompressedLength(data.data(), data.size(),
+                                              &length) ||
+          length != result.TotalBytes()) {
+        return errors::DataLoss("Received a corrupted compressed tensor.");
+      }
+      const int element_bytes = DataTypeSize(result.dtype());
+      if (metadata.codec() == Rule::SHUFFLE_SNAPPY && element_bytes > 1) {
+        std::string shuffled(length, '\0');
+        if (!port::Snappy_Uncompress(data.data(), data.size(), &shuffled[0])) {
+          return errors::DataLoss("Received a corrupted compressed tensor.");
+        }
+        UnshuffleBytes(shuffled.data(), result.NumElements(), element_bytes,
+                       MutableTensorData(&result));
+      } else if (!port::Snappy_Uncompress(data.data(), data.size(),
+                                          MutableTensorData(&result))) {
+        return errors::DataLoss("Received a corrupted compressed tensor.");
+      }
+      break;
+    }
+    case Rule::CAST_BFLOAT16: {
+      if (compressed.dtype() != DT_BFLOAT16 || result.dtype() != DT_FLOAT ||
+          compressed.NumElements() != result.NumElements()) {
+        return errors::DataLoss("Received a corrupted compressed tensor.");
+      }
+      BFloat16ToFloat(compressed.flat<bfloat16>().data(),
+                      result.flat<float>().data(), result.NumElements());
+      break;
+    }
+    case Rule::CAST_FLOAT16: {
+      if (compressed.dtype() != DT_HALF || result.dtype() != DT_FLOAT ||
+          compressed.NumElements() != result.NumElements()) {
+        return errors::DataLoss("Received a corrupted compressed tensor.");
+      }
+      result.flat<float>() = compressed.flat<Eigen::half>().cast<float>();
+      break;
+    }
+    default:
+      return errors::DataLoss("Unknown tensor compression codec ",
+                              metadata.codec());
+  }
+
+  tensor_decompression_usecs->GetCell(Rule::Codec_Name(metadata.codec()))
+      ->IncrementBy(Env::Default()->NowMicros() - start_us);
+  *val = std::move(result);
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,76 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "re2/re2.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/rpc_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+using TensorCompressionCodec = RPCOptions::TensorCompressionRule::Codec;
+
+// Selects the codec of the tensors sent in RecvTensor responses from
+// `RPCOptions.tensor_compression_rules`.
+class TensorCompressionRules {
+ public:
+  // Rules with an invalid `key_pattern` are logged and ignored.
+  explicit TensorCompressionRules(const RPCOptions& options);
+  ~TensorCompressionRules();
+
+  bool empty() const { return rules_.empty(); }
+
+  // Returns the codec of the first rule matching `key`, or NONE if `val` has
+  // fewer bytes than the rule allows to compress.
+  TensorCompressionCodec CodecFor(const std::string& key,
+                                  const Tensor& val) const;
+
+ private:
+  struct CompiledRule {
+    std::unique_ptr<RE2> key_pattern;
+    TensorCompressionCodec codec;
+    int64_t min_bytes;
+  };
+  std::vector<CompiledRule> rules_;
+
+  TensorCompressionRules(const TensorCompressionRules&) = delete;
+  void operator=(const TensorCompressionRules&) = delete;
+};
+
+// Encodes `val`, which must be in host memory, with `codec` into
+// `*compressed` and fills in `*metadata`. Returns false, leaving the outputs
+// untouched, if `codec` does not apply to the type of `val` or does not make
+// it smaller.
+bool CompressTensor(TensorCompressionCodec codec, const Tensor& val,
+                    Tensor* compressed, CompressedTensorMetadata* metadata);
+
+// Decodes the tensor described by `metadata` from `compressed` into `*val`,
+// allocating it with `allocator`.
+Status DecompressTensor(const CompressedTensorMetadata& metadata,
+                        const Tensor& compressed, Allocator* allocator,
+                        Tensor* val);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/rpc_options.pb.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace {
+
+using Rule = RPCOptions::TensorCompressionRule;
+
+// Returns a compressible float tensor of `n` elements.
+Tensor FloatTensor(int64_t n) {
+  Tensor t(DT_FLOAT, TensorShape({n / 4, 4}));
+  for (int64_t i = 0; i < n; ++i) {
+    t.flat<float>()(i) = 0.25f * (i % 16);
+  }
+  return t;
+}
+
+Tensor RoundTrip(Rule::Codec codec, const Tensor& val) {
+  Tensor compressed;
+  CompressedTensorMetadata metadata;
+  EXPECT_TRUE(CompressTensor(codec, val, &compressed, &metadata));
+  EXPECT_EQ(metadata.codec(), codec);
+  EXPECT_LT(compressed.TotalBytes(), val.TotalBytes());
+  Tensor result;
+  TF_EXPECT_OK(
+      DecompressTensor(metadata, compressed, cpu_allocator(), &result));
+  return result;
+}
+
+TEST(TensorCompressionTest, LosslessCodecs) {
+  for (Rule::Codec codec : {Rule::SNAPPY, Rule::SHUFFLE_SNAPPY}) {
+    Tensor val = FloatTensor(1024);
+    test::ExpectTensorEqual<float>(RoundTrip(codec, val), val);
+
+    Tensor ints(DT_INT64, TensorShape({512}));
+    ints.flat<int64_t>().setConstant(7);
+    test::ExpectTensorEqual<int64_t>(RoundTrip(codec, ints), ints);
+  }
+}
+
+TEST(TensorCompressionTest, CastCodecs) {
+  // The values are exactly representable in bfloat16 and float16.
+  for (Rule::Codec codec : {Rule::CAST_BFLOAT16, Rule::CAST_FLOAT16}) {
+    Tensor val = FloatTensor(64);
+    test::ExpectTensorEqual<float>(RoundTrip(codec, val), val);
+  }
+}
+
+TEST(TensorCompressionTest, SkipsIneligibleTensors) {
+  Tensor compressed;
+  CompressedTensorMetadata metadata;
+  Tensor ints(DT_INT32, TensorShape({16}));
+  ints.flat<int32>().setZero();
+  EXPECT_FALSE(CompressTensor(Rule::CAST_BFLOAT16, ints, &compressed,
+                              &metadata));
+  EXPECT_FALSE(CompressTensor(Rule::SNAPPY, Tensor(tstring("abc")),
+                              &compressed, &metadata));
+  EXPECT_FALSE(CompressTensor(Rule::NONE, FloatTensor(1024), &compressed,
+                              &metadata));
+  EXPECT_FALSE(metadata.has_tensor_shape());
+}
+
+TEST(TensorCompressionTest, CorruptedTensor) {
+  Tensor compressed;
+  CompressedTensorMetadata metadata;
+  ASSERT_TRUE(
+      CompressTensor(Rule::SNAPPY, FloatTensor(1024), &compressed, &metadata));
+  Tensor truncated = compressed.Slice(0, compressed.NumElements() / 2);
+  Tensor result;
+  EXPECT_TRUE(errors::IsDataLoss(
+      DecompressTensor(metadata, truncated, cpu_allocator(), &result)));
+}
+
+TEST(TensorCompressionRulesTest, FirstMatchingRule) {
+  RPCOptions options;
+  Rule* rule = options.add_tensor_compression_rules();
+  rule->set_key_pattern(".*;gradients/.*");
+  rule->set_codec(Rule::CAST_BFLOAT16);
+  rule->set_min_bytes(1024);
+  rule = options.add_tensor_compression_rules();
+  rule->set_key_pattern("(invalid");
+  rule->set_codec(Rule::SNAPPY);
+  rule = options.add_tensor_compression_rules();
+  rule->set_key_pattern(".*");
+  rule->set_codec(Rule::SHUFFLE_SNAPPY);
+
+  TensorCompressionRules rules(options);
+  EXPECT_FALSE(rules.empty());
+  EXPECT_EQ(rules.CodecFor("a;gradients/w", FloatTensor(1024)),
+            Rule::CAST_BFLOAT16);
+  EXPECT_EQ(rules.CodecFor("a;gradients/w", FloatTensor(16)), Rule::NONE);
+  EXPECT_EQ(rules.CodecFor("a;weights/w", FloatTensor(16)),
+            Rule::SHUFFLE_SNAPPY);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -55,6 +55,12 @@ struct WorkerEnv {
   // of tasks in this cluster. It is always greater than 1.
   int experimental_num_shards = 1;
 
+  // If positive, the RecvTensor RPCs of a step to the same remote worker which
+  // are issued within this many microseconds are sent as one RecvTensorBatch
+  // RPC of up to `recv_tensor_batch_max_size` tensors. See `RPCOptions`.
+  int64_t recv_tensor_batch_window_micros = 0;
+  int recv_tensor_batch_max_size = 64;
+
   // device_mgr manages local devices (cpu and gpu). The WorkerService
   // is the network interface for managed devices.
   //
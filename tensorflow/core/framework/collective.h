@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_COLLECTIVE_H_
 #define TENSORFLOW_CORE_FRAMEWORK_COLLECTIVE_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -156,6 +157,11 @@ struct CollectiveParams : public core::RefCounted {
   std::vector<int> subdiv_rank;
   OpKernel* merge_op = nullptr;  // reduction only
   OpKernel* final_op = nullptr;  // reduction only
+  // Reduction only. If set, the NCCL reduction calls it right after its
+  // kernel, with the stream of the kernel, so that it can consume the reduced
+  // output in place before the op completes. Other implementations ignore it,
+  // see `instance.impl_details.collective_name`.
+  std::function<Status(stream_executor::Stream* stream)> epilogue;
   string ToString() const;
   bool run_group_initialization = true;
   bool is_stateless = false;
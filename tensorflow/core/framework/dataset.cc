@@ -831,6 +831,12 @@ Status DatasetBase::Get(OpKernelContext* ctx, int64 index,
       "Random access is not implemented for this dataset.");
 }
 
+Status DatasetBase::Get(IteratorContext* ctx, int64 index,
+                        std::vector<Tensor>* out_tensors) const {
+  return errors::Unimplemented(
+      "Random access is not implemented for this dataset.");
+}
+
 StatusOr<DatasetBase*> DatasetBase::Finalize(
     OpKernelContext* ctx,
     std::function<StatusOr<core::RefCountPtr<DatasetBase>>()>
@@ -1304,6 +1304,11 @@ class DatasetBase : public core::RefCounted {
   virtual Status Get(OpKernelContext* ctx, int64 index,
                      std::vector<Tensor>* out_tensors) const;
 
+  // Return the element at a particular index for a randomly accessible dataset,
+  // on behalf of an iterator of a downstream dataset.
+  virtual Status Get(IteratorContext* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const;
+
   // Return a finalized version of the dataset.  The returned DatasetBase is
   // unowned and lives for as long as this dataset.
   virtual StatusOr<DatasetBase*> Finalize(
@@ -64,6 +64,7 @@ class OpKernel;
 class ProcessFunctionLibraryRuntime;
 class ResourceMgr;
 class Rendezvous;
+class RequestCost;
 class ScopedStepContainer;
 class StepStatsCollectorInterface;
 class Node;
@@ -907,6 +908,7 @@ class FunctionLibraryRuntime : public core::WeakRefCounted {
     CollectiveExecutor* collective_executor = nullptr;
     ScopedStepContainer* step_container = nullptr;
     StepStatsCollectorInterface* stats_collector = nullptr;
+    RequestCost* request_cost = nullptr;
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
 
     absl::optional<ManagedStackTrace> stack_trace = absl::nullopt;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -118,36 +119,92 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
   }
 }
 
+bool LocalRendezvous::ItemQueue::remove(Item* prev, Item* item) {
+  if (prev == nullptr) {
+    DCHECK_EQ(head, item);
+    head = item->next;
+  } else {
+    DCHECK_EQ(prev->next, item);
+    prev->next = item->next;
+  }
+  if (tail == item) {
+    tail = prev;
+  }
+  item->next = nullptr;
+  return head == nullptr;
+}
+
 LocalRendezvous::~LocalRendezvous() {
   // Before destroying this rendezvous instance, make sure all the done-callback
   // calls have finished and the tensors have been released from the queue.
   bool table_not_empty = false;
+  auto wait_for_pending_callbacks = [](Shard& shard) {
+    mutex_lock l(shard.mu);
+    while (shard.pending_callback_counter != 0) {
+      shard.pending_callback_cond_var.wait_for(l,
+                                               std::chrono::milliseconds(50));
+    }
+  };
   for (int i = 0; i < num_buckets_; ++i) {
     auto& bucket = table_buckets_[i];
-    {
-      mutex_lock l(bucket.mu);
-      while (bucket.pending_callback_counter != 0) {
-        bucket.pending_callback_cond_var.wait_for(
-            l, std::chrono::milliseconds(50));
-      }
-    }
+    wait_for_pending_callbacks(bucket);
     if (!bucket.table.empty()) {
       table_not_empty = true;
     }
   }
+  for (auto& chunk_ptr : slot_chunks_) {
+    SlotChunk* chunk = chunk_ptr.load(std::memory_order_acquire);
+    if (chunk == nullptr) continue;
+    for (Slot& slot : chunk->slots) {
+      wait_for_pending_callbacks(slot);
+      if (slot.queue.head != nullptr) {
+        table_not_empty = true;
+      }
+    }
+  }
   if (table_not_empty) {
     DoAbort(absl::CancelledError("LocalRendezvous deleted"));
   }
+  for (auto& chunk_ptr : slot_chunks_) {
+    delete chunk_ptr.load(std::memory_order_acquire);
+  }
 }
 
 namespace {
 uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
 }  // namespace
 
+LocalRendezvous::Slot* LocalRendezvous::FindSlot(
+    const Rendezvous::ParsedKey& key) {
+  const int64_t index = key.slot();
+  if (index < 0 || index >= kMaxSlotChunks * kSlotsPerChunk) return nullptr;
+  std::atomic<SlotChunk*>& chunk_ptr = slot_chunks_[index / kSlotsPerChunk];
+  SlotChunk* chunk = chunk_ptr.load(std::memory_order_acquire);
+  if (TF_PREDICT_FALSE(chunk == nullptr)) {
+    auto new_chunk = std::make_unique<SlotChunk>();
+    if (chunk_ptr.compare_exchange_strong(chunk, new_chunk.get(),
+                                          std::memory_order_acq_rel)) {
+      chunk = new_chunk.release();
+    }
+  }
+  Slot& slot = chunk->slots[index % kSlotsPerChunk];
+  // Like the table, this identifies keys by their hash. A hash of 0 cannot
+  // claim a slot.
+  uint64 owner = 0;
+  if (key.hash() != 0 &&
+      (slot.key_hash.compare_exchange_strong(owner, key.hash(),
+                                             std::memory_order_acq_rel) ||
+       owner == key.hash())) {
+    return &slot;
+  }
+  return nullptr;
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  Slot* slot = FindSlot(key);
+  uint64 key_hash = slot != nullptr ? key.hash() : KeyHash(key.FullKey());
   DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
   if (is_dead) {
@@ -162,12 +219,22 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   TF_RETURN_IF_ERROR(status());
 
-  int bucket_index = key_hash % num_buckets_;
-  auto& bucket = table_buckets_[bucket_index];
-  bucket.mu.lock();
+  TableBucket* bucket = nullptr;
+  Shard* shard = slot;
+  if (slot == nullptr) {
+    bucket = &table_buckets_[key_hash % num_buckets_];
+    shard = bucket;
+  }
+  shard->mu.lock();
 
-  auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
-  ItemQueue* queue = &it->second;
+  Table::iterator it;
+  ItemQueue* queue;
+  if (slot != nullptr) {
+    queue = &slot->queue;
+  } else {
+    it = bucket->table.insert({key_hash, ItemQueue()}).first;
+    queue = &it->second;
+  }
   if (queue->head == nullptr || queue->head->type == Item::kSend) {
     // There is no waiter for this message. Append the message
     // into the queue. The waiter will pick it up when arrives.
@@ -190,7 +257,7 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         /*level=*/1);
     queue->push_back(new Item(std::move(rc_owner), send_args, val, is_dead,
                               std::move(activity_scope)));
-    bucket.mu.unlock();
+    shard->mu.unlock();
     return OkStatus();
   }
 
@@ -199,23 +266,21 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
   Item* item = queue->head;
 
   // Delete the queue when the last element has been consumed.
-  if (item->next == nullptr) {
+  if (queue->remove(/*prev=*/nullptr, item)) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    bucket.table.erase(it);
-  } else {
-    queue->head = item->next;
+    if (bucket != nullptr) bucket->table.erase(it);
   }
-  bucket.pending_callback_counter++;
+  shard->pending_callback_counter++;
   // Invoke the done-callback, without holding the lock.
-  bucket.mu.unlock();
+  shard->mu.unlock();
 
   DCHECK_EQ(item->type, Item::kRecv);
   (*item->recv_state.waiter)(OkStatus(), send_args, item->args, val, is_dead);
   {
-    mutex_lock l(bucket.mu);
-    bucket.pending_callback_counter--;
-    if (bucket.pending_callback_counter == 0) {
-      bucket.pending_callback_cond_var.notify_all();
+    mutex_lock l(shard->mu);
+    shard->pending_callback_counter--;
+    if (shard->pending_callback_counter == 0) {
+      shard->pending_callback_cond_var.notify_all();
     }
   }
   // Delete the item at last since it may unref and destruct the rendezvous.
@@ -226,7 +291,8 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                                 const Rendezvous::Args& recv_args,
                                 Rendezvous::DoneCallback done) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  Slot* slot = FindSlot(key);
+  uint64 key_hash = slot != nullptr ? key.hash() : KeyHash(key.FullKey());
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
   tsl::core::RefCountPtr<Rendezvous> rc_keep_alive;
 
@@ -237,12 +303,22 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     return;
   }
 
-  int bucket_index = key_hash % num_buckets_;
-  auto& bucket = table_buckets_[bucket_index];
-  bucket.mu.lock();
+  TableBucket* bucket = nullptr;
+  Shard* shard = slot;
+  if (slot == nullptr) {
+    bucket = &table_buckets_[key_hash % num_buckets_];
+    shard = bucket;
+  }
+  shard->mu.lock();
 
-  auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
-  ItemQueue* queue = &it->second;
+  Table::iterator it;
+  ItemQueue* queue;
+  if (slot != nullptr) {
+    queue = &slot->queue;
+  } else {
+    it = bucket->table.insert({key_hash, ItemQueue()}).first;
+    queue = &it->second;
+  }
   if (queue->head == nullptr || queue->head->type == Item::kRecv) {
     // There is no message to pick up.
     // Only recv-related fields need to be filled.
@@ -251,13 +327,19 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     bool already_cancelled = false;
     if (cm != nullptr) {
       token = cm->get_cancellation_token();
-      already_cancelled = !cm->RegisterCallback(token, [this, token, key_hash,
-                                                        &bucket] {
+      already_cancelled = !cm->RegisterCallback(token, [token, key_hash, bucket,
+                                                        slot, shard] {
         Item* item = nullptr;
         {
-          mutex_lock l(bucket.mu);
-          auto it = bucket.table.insert({key_hash, ItemQueue()}).first;
-          ItemQueue* queue = &it->second;
+          mutex_lock l(shard->mu);
+          Table::iterator it;
+          ItemQueue* queue;
+          if (slot != nullptr) {
+            queue = &slot->queue;
+          } else {
+            it = bucket->table.insert({key_hash, ItemQueue()}).first;
+            queue = &it->second;
+          }
           // Find an item in the queue with a cancellation token that matches
           // `token`, and remove it.
           if (queue->head != nullptr && queue->head->type == Item::kRecv) {
@@ -265,22 +347,10 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                  prev = curr, curr = curr->next) {
               if (curr->recv_state.cancellation_token == token) {
                 item = curr;
-                if (queue->head->next == nullptr) {
-                  // We have a single-element queue, so we can erase it from
+                if (queue->remove(prev, curr) && bucket != nullptr) {
+                  // We had a single-element queue, so we can erase it from
                   // the table.
-                  bucket.table.erase(it);
-                } else {
-                  // Remove the current item from the queue.
-                  if (curr == queue->head) {
-                    DCHECK_EQ(prev, nullptr);
-                    queue->head = curr->next;
-                  } else {
-                    DCHECK_NE(prev, nullptr);
-                    prev->next = curr->next;
-                  }
-                  if (queue->tail == curr) {
-                    queue->tail = prev;
-                  }
+                  bucket->table.erase(it);
                 }
                 break;
               }
@@ -298,7 +368,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
       });
     }
     if (already_cancelled) {
-      bucket.mu.unlock();
+      shard->mu.unlock();
       done(StatusGroup::MakeDerived(
                errors::Cancelled("RecvAsync is cancelled.")),
            Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
@@ -346,7 +416,7 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                                 token, std::move(activity_scope)));
     }
 
-    bucket.mu.unlock();
+    shard->mu.unlock();
     return;
   }
 
@@ -356,24 +426,22 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
   Item* item = queue->head;
 
   // Delete the queue when the last element has been consumed.
-  if (item->next == nullptr) {
+  if (queue->remove(/*prev=*/nullptr, item)) {
     DVLOG(2) << "Clean up Send/Recv queue (key:" << key.FullKey() << "). ";
-    bucket.table.erase(it);
-  } else {
-    queue->head = item->next;
+    if (bucket != nullptr) bucket->table.erase(it);
   }
-  bucket.pending_callback_counter++;
+  shard->pending_callback_counter++;
   // Invoke the done-callback, without holding the lock.
-  bucket.mu.unlock();
+  shard->mu.unlock();
 
   DCHECK_EQ(item->type, Item::kSend);
   done(OkStatus(), item->args, recv_args, *item->send_state.value,
        item->send_state.is_dead);
   {
-    mutex_lock l(bucket.mu);
-    bucket.pending_callback_counter--;
-    if (bucket.pending_callback_counter == 0) {
-      bucket.pending_callback_cond_var.notify_all();
+    mutex_lock l(shard->mu);
+    shard->pending_callback_counter--;
+    if (shard->pending_callback_counter == 0) {
+      shard->pending_callback_cond_var.notify_all();
     }
   }
   // Delete the item at last since it may unref and destruct the rendezvous.
@@ -405,6 +473,24 @@ void LocalRendezvous::DoAbort(const Status& status) {
 
   // Keeps one Item to make sure the current rendezvous won't be destructed.
   std::unique_ptr<Item> to_delete;
+  auto abort_items = [&](Item* item, uint64 key_hash) {
+    while (item != nullptr) {
+      switch (item->type) {
+        case Item::kRecv:
+          (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                     Rendezvous::Args(), Tensor(), false);
+          LOG(INFO) << "Local rendezvous recv item cancelled. Key hash: "
+                    << key_hash;
+          break;
+        case Item::kSend:
+          LOG(INFO) << "Local rendezvous send item cancelled. Key hash: "
+                    << key_hash;
+          break;
+      }
+      to_delete.reset(item);
+      item = item->next;
+    }
+  };
   for (int i = 0; i < num_buckets_; ++i) {
     auto& bucket = table_buckets_[i];
     Table table;
@@ -413,23 +499,19 @@ void LocalRendezvous::DoAbort(const Status& status) {
       bucket.table.swap(table);
     }
     for (auto& p : table) {
-      Item* item = p.second.head;
-      while (item != nullptr) {
-        switch (item->type) {
-          case Item::kRecv:
-            (*item->recv_state.waiter)(status, Rendezvous::Args(),
-                                       Rendezvous::Args(), Tensor(), false);
-            LOG(INFO) << "Local rendezvous recv item cancelled. Key hash: "
-                      << p.first;
-            break;
-          case Item::kSend:
-            LOG(INFO) << "Local rendezvous send item cancelled. Key hash: "
-                      << p.first;
-            break;
-        }
-        to_delete.reset(item);
-        item = item->next;
+      abort_items(p.second.head, p.first);
+    }
+  }
+  for (auto& chunk_ptr : slot_chunks_) {
+    SlotChunk* chunk = chunk_ptr.load(std::memory_order_acquire);
+    if (chunk == nullptr) continue;
+    for (Slot& slot : chunk->slots) {
+      ItemQueue queue;
+      {
+        mutex_lock l(slot.mu);
+        std::swap(queue, slot.queue);
       }
+      abort_items(queue.head, slot.key_hash.load(std::memory_order_relaxed));
     }
   }
 }
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -77,6 +78,9 @@ class LocalRendezvous {
   //   [item.type == kRecv]* meaning each item is a waiter.
   struct ItemQueue {
     void push_back(Item* item);
+    // Removes `item`, which follows `prev` in the queue (nullptr if `item` is
+    // the head). Returns true if the queue is then empty.
+    bool remove(Item* prev, Item* item);
 
     Item* head = nullptr;
     Item* tail = nullptr;
@@ -89,17 +93,42 @@ class LocalRendezvous {
   // nullptr otherwise.
   Rendezvous* rc_owner_;
 
-  struct TableBucket {
+  // Lock of the queues of a table bucket or a slot.
+  struct Shard {
     mutex mu;
-    Table table TF_GUARDED_BY(mu);
 
     // Track the number of pening callbacks using a counter.
     int pending_callback_counter TF_GUARDED_BY(mu) = 0;
     condition_variable pending_callback_cond_var TF_GUARDED_BY(mu);
   };
 
+  struct TableBucket : Shard {
+    Table table TF_GUARDED_BY(mu);
+  };
+
+  // Keys with a slot (see Rendezvous::ParsedKey::slot()) skip the table: each
+  // slot holds the queue of one key, so that the two ends of an edge only
+  // contend with each other. A slot belongs to the first key that uses it;
+  // other keys with the same slot, e.g. from another graph sharing the
+  // rendezvous, use the table.
+  struct Slot : Shard {
+    // Hash of the owning key, or 0 while the slot is unused.
+    std::atomic<uint64> key_hash{0};
+    ItemQueue queue TF_GUARDED_BY(mu);
+  };
+  static constexpr int kSlotsPerChunk = 64;
+  static constexpr int kMaxSlotChunks = 128;
+  struct SlotChunk {
+    Slot slots[kSlotsPerChunk];
+  };
+
+  // Returns the slot owned by `key`, or nullptr if `key` uses the table.
+  Slot* FindSlot(const Rendezvous::ParsedKey& key);
+
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
+  // Slot chunks are allocated on first use, without locking.
+  std::atomic<SlotChunk*> slot_chunks_[kMaxSlotChunks] = {};
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
 
@@ -368,6 +368,12 @@ auto* graph_optimization_cache_load_count = tsl::monitoring::Counter<1>::New(
     "source"  // graph optimization source
 );
 
+auto* grappler_cache_count = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler_cache_count",
+    "The number of lookups in the cache of graphs optimized by Grappler.",
+    "result"  // hit, disk_hit or miss
+);
+
 auto* xla_compilations = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilations",
     "The number of XLA compilations used to collect "
@@ -377,6 +383,13 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_compile_queue_time_usecs = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/xla_compile_queue_time_usecs",
+     "The time XLA asynchronous compilations wait for a compile thread in "
+     "microseconds."},
+    // Power of 2 with bucket count 20 (> 17 minutes)
+    {tsl::monitoring::Buckets::Exponential(1000, 2, 20)});
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -812,6 +825,14 @@ int64_t GetFunctionGraphOptimizationCacheLoadCount(
   return graph_optimization_cache_load_count->GetCell(mapped_source)->value();
 }
 
+void IncrementGrapplerCacheCount(const std::string& result) {
+  grappler_cache_count->GetCell(result)->IncrementBy(1);
+}
+
+int64_t GetGrapplerCacheCount(const std::string& result) {
+  return grappler_cache_count->GetCell(result)->value();
+}
+
 void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs) {
   if (distribution_time_usecs > 0) {
     tpu_variable_distribution_time_usecs->GetCell()->IncrementBy(
@@ -829,6 +850,12 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void UpdateXlaCompileQueueTime(const uint64 queue_time_usecs) {
+  static auto* xla_compile_queue_time_usecs_cell =
+      xla_compile_queue_time_usecs->GetCell();
+  xla_compile_queue_time_usecs_cell->Add(queue_time_usecs);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
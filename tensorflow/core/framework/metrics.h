@@ -304,6 +304,13 @@ void IncrementFunctionGraphOptimizationCacheLoadCount(
 int64_t GetFunctionGraphOptimizationCacheLoadCount(
     GraphOptimizationSource source);
 
+// Increments the number of lookups in the cache of graphs optimized by the
+// Grappler MetaOptimizer. `result` is "hit", "disk_hit" or "miss".
+void IncrementGrapplerCacheCount(const std::string& result);
+
+// Gets the number of lookups in the Grappler cache with the given `result`.
+int64_t GetGrapplerCacheCount(const std::string& result);
+
 // Records the activity of the first phase of the mlir bridge using the
 // tf_metadata.tf_mlir_bridge_first_phase_count metric.
 // device_type: tpu, cpu, gpu, etc.
@@ -463,6 +470,10 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Updates the metrics stored about the time XLA asynchronous compilations wait
+// for a compile thread.
+void UpdateXlaCompileQueueTime(const uint64 queue_time_usecs);
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <queue>
+#include <utility>
 
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -1620,6 +1621,17 @@ Node::ModelParameters Node::CollectNodeTunableParameters() const {
   return parameters;
 }
 
+Node::ModelParameters Node::CollectNodeStateParameters() const {
+  tf_shared_lock l(mu_);
+  Node::ModelParameters parameters;
+  for (auto& pair : parameters_) {
+    if (pair.second->state != nullptr && pair.second->state->tunable) {
+      parameters.push_back(std::make_pair(name(), pair.second));
+    }
+  }
+  return parameters;
+}
+
 string Node::DebugString() const {
   absl::flat_hash_map<string, string> debug_strings;
   tf_shared_lock l(mu_);
@@ -2433,6 +2445,22 @@ void Model::MaybeSyncStateValuesToValues(Model::ModelParameters* parameters) {
   }
 }
 
+void Model::ApplyWarmStartValues(Model::ModelParameters* parameters) {
+  tf_shared_lock l(mu_);
+  if (warm_start_values_.empty()) {
+    return;
+  }
+  for (auto& pair : *parameters) {
+    auto& parameter = pair.second;
+    auto it = warm_start_values_.find(parameter->state.get());
+    if (it == warm_start_values_.end() || it->second.first.expired()) {
+      continue;
+    }
+    parameter->value = std::min(std::max(parameter->value, it->second.second),
+                                parameter->max);
+  }
+}
+
 bool Model::DownsizeBuffers(std::shared_ptr<Node> snapshot) {
   Node::NodeVector nodes =
       snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
@@ -2544,6 +2572,11 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
       mutex_lock l(mu_);
       optimization_period_ms_ =
           std::min(optimization_period_ms_ << 1, kOptimizationPeriodMaxMs);
+      // Once the optimization period has settled, the restored parameter
+      // values no longer reflect a better starting point than the minimum.
+      if (optimization_period_ms_ == kOptimizationPeriodMaxMs) {
+        warm_start_values_.clear();
+      }
     }
     current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     last_optimization_ms = current_time_ms;
@@ -2571,10 +2604,12 @@ void Model::OptimizeGradientDescent(
   CollectParameters(snapshot, parameters, &parallelism_parameters,
                     &buffer_size_parameters);
 
-  // Initialize the parameter values to minimal before tuning.
+  // Initialize the parameter values to minimal before tuning, or to the values
+  // restored from a checkpoint.
   for (auto& pair : parameters) {
     pair.second->value = pair.second->min;
   }
+  ApplyWarmStartValues(&parameters);
 
   // Optimization is stopped once the `OutputTime` improvement is smaller than
   // this value.
@@ -2648,13 +2683,15 @@ void Model::OptimizeHillClimbHelper(
            "every "
            "10 minutes).";
   }
-  // Initialize the parameter values to minimal before tuning.
+  // Initialize the parameter values to minimal before tuning, or to the values
+  // restored from a checkpoint.
   for (auto& pair : parameters) {
     if (skip_buffer_sizes && (pair.second->name == kBufferSize)) {
       continue;
     }
     pair.second->value = pair.second->min;
   }
+  ApplyWarmStartValues(&parameters);
   Parameter* best_parameter = nullptr;
   while (!cancellation_manager->IsCancelled()) {
     const double output_time =
@@ -2711,6 +2748,93 @@ void Model::OptimizeHillClimbHelper(
     UpdateStateValues(&parameters);
   }
 }
+void Model::SaveTunedParameters(const RamBudgetManager& ram_budget_manager,
+                                TunedParametersProto* proto) {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  proto->set_model_ram_bytes(ram_budget_manager.ModelAllocatedBytes());
+  if (!output) {
+    return;
+  }
+  Node::NodeVector nodes = output->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(output);
+  for (const auto& node : nodes) {
+    for (const auto& [node_name, parameter] :
+         node->CollectNodeStateParameters()) {
+      double value;
+      {
+        mutex_lock l(*parameter->state->mu);
+        value = parameter->state->value;
+      }
+      if (value == kAutotune) {
+        continue;
+      }
+      auto* parameter_proto = proto->add_parameters();
+      parameter_proto->set_node_name(node_name);
+      parameter_proto->set_name(parameter->name);
+      parameter_proto->set_value(value);
+    }
+  }
+}
+
+int64_t Model::RestoreTunedParameters(const TunedParametersProto& proto,
+                                      RamBudgetManager& ram_budget_manager) {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  if (!output || proto.parameters().empty()) {
+    return 0;
+  }
+  absl::flat_hash_map<std::pair<string, string>, double> saved_values;
+  for (const auto& parameter_proto : proto.parameters()) {
+    saved_values[{parameter_proto.node_name(), parameter_proto.name()}] =
+        parameter_proto.value();
+  }
+  // Buffer sizes determine the memory used by the model, so they are only
+  // restored if the RAM they were tuned with is still available.
+  const bool restore_buffer_sizes =
+      proto.model_ram_bytes() == 0 ||
+      ram_budget_manager.RequestModelAllocation(proto.model_ram_bytes());
+  if (!restore_buffer_sizes) {
+    VLOG(2) << "Not restoring tuned buffer sizes: unable to allocate "
+            << proto.model_ram_bytes() << " bytes of model RAM.";
+  }
+
+  Node::NodeVector nodes = output->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(output);
+  int64_t num_restored = 0;
+  mutex_lock l(mu_);
+  for (const auto& node : nodes) {
+    for (const auto& [node_name, parameter] :
+         node->CollectNodeStateParameters()) {
+      if (!restore_buffer_sizes && parameter->name == kBufferSize) {
+        continue;
+      }
+      auto it = saved_values.find({node_name, parameter->name});
+      if (it == saved_values.end()) {
+        continue;
+      }
+      const double value =
+          std::min(std::max(it->second, parameter->min), parameter->max);
+      VLOG(2) << "Restoring tunable parameter " << node_name
+              << ":: " << parameter->name << " to " << value;
+      {
+        mutex_lock state_lock(*parameter->state->mu);
+        parameter->state->value = value;
+        parameter->state->cond_var->notify_all();
+      }
+      warm_start_values_[parameter->state.get()] = {parameter->state, value};
+      ++num_restored;
+    }
+  }
+  return num_restored;
+}
+
 void Model::RecordIteratorGapTime(uint64_t duration_usec) {
   mutex_lock l(gap_mu_);
   // Drop duration if it is too large.
@@ -175,7 +175,7 @@ class RamBudgetManager {
   // Returns whether the request succeeded.
   bool RequestModelAllocation(int64_t total_bytes) {
     mutex_lock l(mu_);
-    if (total_bytes > budget_ - legacy_prefetch_allocated_) {
+    if (total_bytes > budget_ - NonModelAllocatedBytesLocked()) {
       return false;
     }
     model_allocated_ = total_bytes;
@@ -195,7 +195,7 @@ class RamBudgetManager {
     // memory.
     if (delta_elements > 0) {
       int64_t max_delta_elements = static_cast<int64_t>(
-          (budget_ - legacy_prefetch_allocated_ - model_allocated_) /
+          (budget_ - NonModelAllocatedBytesLocked() - model_allocated_) /
           element_size);
       if (max_delta_elements < 0) {
         return 0;
@@ -218,17 +218,55 @@ class RamBudgetManager {
   // request. If not, no bytes are allocated.
   bool RequestLegacyPrefetchBytes(int64_t delta_bytes) {
     mutex_lock l(mu_);
-    if (delta_bytes > budget_ - legacy_prefetch_allocated_ - model_allocated_) {
+    if (delta_bytes >
+        budget_ - NonModelAllocatedBytesLocked() - model_allocated_) {
       return false;
     }
     legacy_prefetch_allocated_ += delta_bytes;
     return true;
   }
 
+  // Requests `delta_bytes` additional bytes for elements held in memory by
+  // dataset caches. `delta_bytes` can be negative to release bytes.
+  //
+  // Returns whether there were enough bytes left in the budget to serve the
+  // request. If not, no bytes are allocated.
+  bool RequestCacheBytes(int64_t delta_bytes) {
+    mutex_lock l(mu_);
+    if (delta_bytes >
+        budget_ - NonModelAllocatedBytesLocked() - model_allocated_) {
+      return false;
+    }
+    cache_allocated_ += delta_bytes;
+    return true;
+  }
+
+  // Requests `delta_bytes` additional bytes for elements read ahead of the
+  // consumer, e.g. by deterministic interleaves. `delta_bytes` can be negative
+  // to release bytes.
+  //
+  // Returns whether there were enough bytes left in the budget to serve the
+  // request. If not, no bytes are allocated.
+  bool RequestReadAheadBytes(int64_t delta_bytes) {
+    mutex_lock l(mu_);
+    if (delta_bytes >
+        budget_ - NonModelAllocatedBytesLocked() - model_allocated_) {
+      return false;
+    }
+    read_ahead_allocated_ += delta_bytes;
+    return true;
+  }
+
+  // The number of bytes currently allocated to the model.
+  int64_t ModelAllocatedBytes() const {
+    tf_shared_lock l(mu_);
+    return model_allocated_;
+  }
+
   // The total number of bytes that the model could potentially use.
   int64_t AvailableModelRam() const {
     tf_shared_lock l(mu_);
-    return budget_ - legacy_prefetch_allocated_;
+    return budget_ - NonModelAllocatedBytesLocked();
   }
 
   void UpdateBudget(int64_t budget) {
@@ -241,14 +279,26 @@ class RamBudgetManager {
     mutex_lock l(mu_);
     return absl::StrCat("RamBudgetManager: budget_: ", budget_,
                         " prefetch allocated: ", legacy_prefetch_allocated_,
+                        " cache allocated: ", cache_allocated_,
+                        " read-ahead allocated: ", read_ahead_allocated_,
                         " model allocated: ", model_allocated_);
   }
 
  private:
+  // The number of bytes allocated outside of the model.
+  int64_t NonModelAllocatedBytesLocked() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return legacy_prefetch_allocated_ + cache_allocated_ +
+           read_ahead_allocated_;
+  }
+
   mutable mutex mu_;
   int64_t budget_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by legacy prefetch autotuner.
   int64_t legacy_prefetch_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // Number of bytes allocated by dataset caches.
+  int64_t cache_allocated_ TF_GUARDED_BY(mu_) = 0;
+  // Number of bytes allocated for elements read ahead of the consumer.
+  int64_t read_ahead_allocated_ TF_GUARDED_BY(mu_) = 0;
   // Number of bytes allocated by the model.
   int64_t model_allocated_ TF_GUARDED_BY(mu_) = 0;
 };
@@ -557,6 +607,11 @@ class Node {
   // Collects tunable parameters in this node.
   ModelParameters CollectNodeTunableParameters() const TF_LOCKS_EXCLUDED(mu_);
 
+  // Collects the parameters of this node with tunable state. Unlike
+  // `CollectNodeTunableParameters`, this includes parameters of nodes which
+  // have not produced any elements or have autotuning disabled.
+  ModelParameters CollectNodeStateParameters() const TF_LOCKS_EXCLUDED(mu_);
+
   // Returns a human-readable representation of this node.
   string DebugString() const TF_LOCKS_EXCLUDED(mu_);
 
@@ -1002,6 +1057,21 @@ class Model {
   static Status Load(const string& fname, std::unique_ptr<Model>* model,
                      OptimizationParams* optimization_params);
 
+  // Collects the current values of the tunable parameters of this model and
+  // the number of bytes allocated to it by `ram_budget_manager`.
+  void SaveTunedParameters(const RamBudgetManager& ram_budget_manager,
+                           TunedParametersProto* proto) TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the tunable parameters of this model to the values in `proto`, which
+  // are then also used as the starting point of hill climb and gradient
+  // descent optimizations until the optimization period reaches its maximum.
+  // Values for nodes or parameters that don't exist are ignored. Buffer sizes
+  // are only restored if `ram_budget_manager` can allocate the saved amount of
+  // model RAM. Returns the number of restored parameters.
+  int64_t RestoreTunedParameters(const TunedParametersProto& proto,
+                                 RamBudgetManager& ram_budget_manager)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Records gap time between consecutive `GetNext()` calls.
   void RecordIteratorGapTime(uint64_t duration_usec);
 
@@ -1041,6 +1111,9 @@ class Model {
   // increase mutex contention with `GetNext()`.
   void MaybeSyncStateValuesToValues(ModelParameters* parameters);
 
+  // Raises the values of `parameters` to their warm-start values, if any.
+  void ApplyWarmStartValues(ModelParameters* parameters) TF_LOCKS_EXCLUDED(mu_);
+
   // Downsizes buffers that are too large for all nodes rooted at `snapshot`.
   // Returns true if any buffer is downsized.
   bool DownsizeBuffers(std::shared_ptr<Node> snapshot);
@@ -1165,6 +1238,11 @@ class Model {
   // Determines the time the optimization loop should wait between
   // running optimizations.
   int64_t optimization_period_ms_ TF_GUARDED_BY(mu_);
+  // Parameter values restored by `RestoreTunedParameters`, keyed by parameter
+  // state. Cleared once the optimization period reaches its maximum.
+  absl::flat_hash_map<const SharedState*,
+                      std::pair<std::weak_ptr<SharedState>, double>>
+      warm_start_values_ TF_GUARDED_BY(mu_);
 
   // Gauge cell that can be used to collect the state of the model.
   monitoring::GaugeCell<std::function<std::string()>>* model_gauge_cell_ =
@@ -3505,6 +3505,94 @@ TEST_F(ModelTimingTest, SelfTime) {
   EXPECT_DOUBLE_EQ(910, node_2->ComputeSelfTime());
 }
 
+// Builds a two-node pipeline with a tunable `parallelism` parameter on the
+// output node and a tunable `buffer_size` parameter on its input.
+void AddTunableNodes(Model& model, double parallelism, double buffer_size,
+                     std::shared_ptr<Node>* output,
+                     std::shared_ptr<Node>* input) {
+  *output = model::MakeAsyncKnownRatioNode(
+      {1, "Iterator::Root::ParallelMap", nullptr}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(parallelism, std::make_shared<mutex>(),
+                                        std::make_shared<condition_variable>()),
+          /*min=*/1, /*max=*/8)});
+  *input = model::MakeAsyncKnownRatioNode(
+      {2, "Iterator::Root::ParallelMap::Prefetch", *output}, 1,
+      {model::MakeParameter(
+          "buffer_size",
+          std::make_shared<SharedState>(buffer_size, std::make_shared<mutex>(),
+                                        std::make_shared<condition_variable>()),
+          /*min=*/0, /*max=*/16)});
+  model.AddNode([output](model::Node::Args args) { return *output; },
+                (*output)->name(), nullptr, output);
+  model.AddNode([input](model::Node::Args args) { return *input; },
+                (*input)->name(), *output, input);
+}
+
+TEST(ModelTest, SaveAndRestoreTunedParameters) {
+  Model model;
+  std::shared_ptr<Node> output, input;
+  AddTunableNodes(model, /*parallelism=*/4, /*buffer_size=*/10, &output,
+                  &input);
+  RamBudgetManager ram_budget_manager(100);
+  ASSERT_TRUE(ram_budget_manager.RequestModelAllocation(50));
+  TunedParametersProto proto;
+  model.SaveTunedParameters(ram_budget_manager, &proto);
+  EXPECT_EQ(proto.parameters_size(), 2);
+  EXPECT_EQ(proto.model_ram_bytes(), 50);
+
+  Model restored_model;
+  std::shared_ptr<Node> restored_output, restored_input;
+  AddTunableNodes(restored_model, model::kAutotune, model::kAutotune,
+                  &restored_output, &restored_input);
+  RamBudgetManager restored_ram_budget_manager(100);
+  EXPECT_EQ(restored_model.RestoreTunedParameters(
+                proto, restored_ram_budget_manager),
+            2);
+  EXPECT_EQ(restored_output->parameter_value("parallelism"), 4);
+  EXPECT_EQ(restored_input->parameter_value("buffer_size"), 10);
+  EXPECT_EQ(restored_ram_budget_manager.ModelAllocatedBytes(), 50);
+}
+
+TEST(ModelTest, RestoreTunedParametersClampsValues) {
+  Model model;
+  std::shared_ptr<Node> output, input;
+  AddTunableNodes(model, model::kAutotune, model::kAutotune, &output, &input);
+  TunedParametersProto proto;
+  auto* parameter = proto.add_parameters();
+  parameter->set_node_name(output->name());
+  parameter->set_name("parallelism");
+  parameter->set_value(100);
+  parameter = proto.add_parameters();
+  parameter->set_node_name("Iterator::Root::Unknown");
+  parameter->set_name("parallelism");
+  parameter->set_value(2);
+  RamBudgetManager ram_budget_manager(100);
+  EXPECT_EQ(model.RestoreTunedParameters(proto, ram_budget_manager), 1);
+  EXPECT_EQ(output->parameter_value("parallelism"), 8);
+}
+
+TEST(ModelTest, RestoreTunedParametersSkipsBufferSizesOverRamBudget) {
+  Model model;
+  std::shared_ptr<Node> output, input;
+  AddTunableNodes(model, model::kAutotune, model::kAutotune, &output, &input);
+  TunedParametersProto proto;
+  auto* parameter = proto.add_parameters();
+  parameter->set_node_name(output->name());
+  parameter->set_name("parallelism");
+  parameter->set_value(3);
+  parameter = proto.add_parameters();
+  parameter->set_node_name(input->name());
+  parameter->set_name("buffer_size");
+  parameter->set_value(12);
+  proto.set_model_ram_bytes(200);
+  RamBudgetManager ram_budget_manager(100);
+  EXPECT_EQ(model.RestoreTunedParameters(proto, ram_budget_manager), 1);
+  EXPECT_EQ(output->parameter_value("parallelism"), 3);
+  EXPECT_EQ(input->parameter_value("buffer_size"), model::kAutotune);
+}
+
 TEST(RamBudgetManagerTest, Ctor) {
   RamBudgetManager rbm(10);
   EXPECT_EQ(rbm.AvailableModelRam(), 10);
@@ -3526,6 +3614,34 @@ TEST(RamBudgetManagerTest, RequestAllocations) {
   EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(2));
 }
 
+TEST(RamBudgetManagerTest, RequestCacheBytes) {
+  RamBudgetManager rbm(10);
+  EXPECT_TRUE(rbm.RequestCacheBytes(4));
+  EXPECT_EQ(rbm.AvailableModelRam(), 6);
+  // Over budget 7 > 10 - 4
+  EXPECT_FALSE(rbm.RequestModelAllocation(7));
+  EXPECT_TRUE(rbm.RequestModelAllocation(5));
+  // Over budget 2 > 10 - 4 - 5
+  EXPECT_FALSE(rbm.RequestCacheBytes(2));
+  EXPECT_FALSE(rbm.RequestLegacyPrefetchBytes(2));
+  // Releasing cache bytes makes room for prefetch bytes
+  EXPECT_TRUE(rbm.RequestCacheBytes(-4));
+  EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(5));
+}
+
+TEST(RamBudgetManagerTest, RequestReadAheadBytes) {
+  RamBudgetManager rbm(10);
+  EXPECT_TRUE(rbm.RequestReadAheadBytes(3));
+  EXPECT_TRUE(rbm.RequestCacheBytes(3));
+  EXPECT_EQ(rbm.AvailableModelRam(), 4);
+  // Over budget 5 > 10 - 3 - 3
+  EXPECT_FALSE(rbm.RequestModelAllocation(5));
+  EXPECT_FALSE(rbm.RequestReadAheadBytes(5));
+  // Releasing read-ahead bytes makes room for the model
+  EXPECT_TRUE(rbm.RequestReadAheadBytes(-3));
+  EXPECT_TRUE(rbm.RequestModelAllocation(7));
+}
+
 TEST(RamBudgetManagerTest, RequestAllocationsWithBudgetAdjustment) {
   RamBudgetManager rbm(10);
   // Over budget
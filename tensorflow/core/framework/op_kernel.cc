@@ -15,15 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>  // NOLINT
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/match.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
@@ -46,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -1150,10 +1154,30 @@ struct KernelRegistration {
 // This maps from 'op_type' + DeviceType to the set of KernelDefs and
 // factory functions for instantiating the OpKernel that matches the
 // KernelDef.
+// The registration found for the given values of the constrained attrs.
+struct KernelMatch {
+  std::vector<AttrValue> constraint_values;
+  const KernelRegistration* reg;
+  bool was_attr_mismatch;
+};
+
+// The registrations found for the nodes of a key, by the fingerprint of the
+// values of the attrs constrained by the key's registrations.
+struct KernelMatches {
+  std::vector<string> constraint_names;
+  std::unordered_multimap<uint64, KernelMatch> matches;
+};
+
 struct KernelRegistry {
   mutex mu;
   std::unordered_multimap<string, KernelRegistration> registry
       TF_GUARDED_BY(mu);
+
+  // Memoizes the registrations found for a key, since the identical nodes of
+  // many function instantiations would match them again. Acquired after `mu`,
+  // and cleared whenever `registry` changes.
+  mutex memo_mu;
+  absl::flat_hash_map<string, KernelMatches> memo TF_GUARDED_BY(memo_mu);
 };
 
 #if defined(_WIN32)
@@ -1265,6 +1289,10 @@ void SetupOrDisableJit(KernelRegistry* registry) {
       absl::NullSafeStringView(getenv(kDisableJitKernelsEnvVar)), "1");
 
   mutex_lock l(registry->mu);
+  {
+    mutex_lock memo_lock(registry->memo_mu);
+    registry->memo.clear();
+  }
   std::unordered_multimap<string, KernelRegistration>& all_kernels =
       registry->registry;
   auto it = all_kernels.begin();
@@ -1344,6 +1372,10 @@ void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
   auto global_registry =
       reinterpret_cast<KernelRegistry*>(GlobalKernelRegistry());
   mutex_lock l(global_registry->mu);
+  {
+    mutex_lock memo_lock(global_registry->memo_mu);
+    global_registry->memo.clear();
+  }
   global_registry->registry.emplace(
       key,
       KernelRegistration(*kernel_def, kernel_class_name, std::move(factory)));
@@ -1375,6 +1407,55 @@ const string& GetKernelLabelAttr(const AttrSlice& node_attrs) {
     return attr_value->s();
 }
 
+// Sets `values` to the values in `attrs` of the constrained attrs of
+// `matches`, and returns their fingerprint. Returns nullopt if an attr is
+// missing, for which matching reports an error.
+std::optional<uint64> GetConstraintValues(
+    const KernelMatches& matches, AttrSlice attrs,
+    std::vector<const AttrValue*>* values) {
+  values->clear();
+  uint64 fingerprint = 0;
+  for (const string& name : matches.constraint_names) {
+    const AttrValue* value = attrs.FindByString(name);
+    if (value == nullptr) return std::nullopt;
+    values->push_back(value);
+    fingerprint = Hash64Combine(fingerprint, FastAttrValueHash(*value));
+  }
+  return fingerprint;
+}
+
+// Returns the memoized match of the nodes of `key` with the constraint
+// values `values`, or nullptr.
+const KernelMatch* FindMemoizedMatch(
+    const KernelMatches& matches, uint64 fingerprint,
+    const std::vector<const AttrValue*>& values) {
+  auto range = matches.matches.equal_range(fingerprint);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    const std::vector<AttrValue>& memoized = iter->second.constraint_values;
+    bool equal = true;
+    for (int i = 0, end = values.size(); equal && i < end; ++i) {
+      equal = AreAttrValuesEqual(memoized[i], *values[i]);
+    }
+    if (equal) return &iter->second;
+  }
+  return nullptr;
+}
+
+// Adds the constrained attrs of the registrations of `key` to `names`.
+void AddConstraintNames(const KernelRegistry& registry, const string& key,
+                        std::vector<string>* names)
+    TF_SHARED_LOCKS_REQUIRED(registry.mu) {
+  auto regs = registry.registry.equal_range(key);
+  for (auto iter = regs.first; iter != regs.second; ++iter) {
+    for (const auto& constraint : iter->second.def.constraint()) {
+      if (std::find(names->begin(), names->end(), constraint.name()) ==
+          names->end()) {
+        names->push_back(constraint.name());
+      }
+    }
+  }
+}
+
 // TODO(irving): Replace with const Node& version below.
 Status FindKernelRegistration(
     const DeviceType& device_type, StringPiece node_name,
@@ -1390,6 +1471,26 @@ Status FindKernelRegistration(
   const string key = Key(node_op, device_type, label);
   auto typed_registry = GlobalKernelRegistryTyped();
   tf_shared_lock lock(typed_registry->mu);
+  std::vector<const AttrValue*> constraint_values;
+  {
+    tf_shared_lock memo_lock(typed_registry->memo_mu);
+    auto memo = typed_registry->memo.find(key);
+    if (memo != typed_registry->memo.end()) {
+      std::optional<uint64> fingerprint =
+          GetConstraintValues(memo->second, node_attrs, &constraint_values);
+      const KernelMatch* match =
+          fingerprint.has_value()
+              ? FindMemoizedMatch(memo->second, *fingerprint,
+                                  constraint_values)
+              : nullptr;
+      if (match != nullptr) {
+        *reg = match->reg;
+        *was_attr_mismatch = match->was_attr_mismatch;
+        return OkStatus();
+      }
+    }
+  }
+
   auto regs = typed_registry->registry.equal_range(key);
   for (auto iter = regs.first; iter != regs.second; ++iter) {
     // If there is a kernel registered for the op and device_type,
@@ -1452,6 +1553,24 @@ Status FindKernelRegistration(
     }
   }
 
+  mutex_lock memo_lock(typed_registry->memo_mu);
+  auto [memo, inserted] = typed_registry->memo.try_emplace(key);
+  KernelMatches& matches = memo->second;
+  if (inserted) {
+    AddConstraintNames(*typed_registry, key, &matches.constraint_names);
+    AddConstraintNames(*typed_registry, Key(node_op, DEVICE_DEFAULT, label),
+                       &matches.constraint_names);
+  }
+  std::optional<uint64> fingerprint =
+      GetConstraintValues(matches, node_attrs, &constraint_values);
+  if (fingerprint.has_value() &&
+      FindMemoizedMatch(matches, *fingerprint, constraint_values) == nullptr) {
+    KernelMatch match{{}, *reg, *was_attr_mismatch};
+    for (const AttrValue* value : constraint_values) {
+      match.constraint_values.push_back(*value);
+    }
+    matches.matches.emplace(*fingerprint, std::move(match));
+  }
   return OkStatus();
 }
 
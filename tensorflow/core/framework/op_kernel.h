@@ -89,6 +89,7 @@ class FunctionLibraryRuntime;
 class OpKernelConstruction;  // declared below
 class OpKernelContext;       // declared below,
 class OpRegistryInterface;
+class RequestCost;
 class ResourceMgr;
 class ScopedStepContainer;
 class CollectiveExecutor;
@@ -670,6 +671,8 @@ class OpKernelContext {
     FunctionLibraryRuntime* function_library = nullptr;
     std::function<void(std::function<void()>)>* runner = nullptr;
     StepStatsCollectorInterface* stats_collector = nullptr;
+    // The costs of the request this step runs for, if any.
+    RequestCost* request_cost = nullptr;
     GraphCollector* graph_collector = nullptr;
     bool run_all_kernels_inline = false;
     const std::string* executor_type = nullptr;
@@ -1113,6 +1116,10 @@ class OpKernelContext {
     return params_->stats_collector;
   }
 
+  // The costs of the request this step runs for, or nullptr. Kernels that know
+  // which component their time belongs to (e.g. tf.data or XLA) record it here.
+  RequestCost* request_cost() const { return params_->request_cost; }
+
   // Shared resources accessible to this kernel.
   ResourceMgr* resource_manager() const { return params_->resource_manager; }
 
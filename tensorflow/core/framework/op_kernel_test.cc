@@ -711,6 +711,31 @@ TEST_F(OpKernelBuilderTest, BuilderTypeListAttr) {
                 error::INVALID_ARGUMENT);
 }
 
+REGISTER_OP("BuildLater").Attr("T: type");
+REGISTER_KERNEL_BUILDER(
+    Name("BuildLater").Device(DEVICE_CPU).TypeConstraint<float>("T"),
+    DummyKernel);
+
+TEST_F(OpKernelBuilderTest, KernelRegisteredAfterLookup) {
+  ExpectSuccess("BuildLater", DEVICE_CPU, {"T|type|DT_FLOAT"});
+  ExpectSuccess("BuildLater", DEVICE_CPU, {"T|type|DT_FLOAT"});
+  ExpectFailure("BuildLater", DEVICE_CPU, {"T|type|DT_INT32"},
+                error::NOT_FOUND);
+
+  // The registrations found for a node aren't remembered across a new
+  // registration.
+  kernel_factory::OpKernelRegistrar registrar(
+      KernelDefBuilder("BuildLater")
+          .Device(DEVICE_CPU)
+          .TypeConstraint<int32>("T")
+          .Build(),
+      "DummyKernel", [](OpKernelConstruction* context) -> OpKernel* {
+        return new DummyKernel(context);
+      });
+  ExpectSuccess("BuildLater", DEVICE_CPU, {"T|type|DT_INT32"});
+  ExpectSuccess("BuildLater", DEVICE_CPU, {"T|type|DT_FLOAT"});
+}
+
 REGISTER_OP("DuplicateKernel");
 REGISTER_KERNEL_BUILDER(Name("DuplicateKernel").Device(DEVICE_CPU),
                         DummyKernel);
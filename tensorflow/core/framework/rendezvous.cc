@@ -47,9 +47,16 @@ Rendezvous::ParsedKey& Rendezvous::ParsedKey::operator=(const ParsedKey& b) {
   dst = b.dst;
   edge_name = StringPiece(buf_.data() + (b.edge_name.data() - b_base),
                           b.edge_name.size());
+  slot_ = b.slot_;
+  hash_ = b.hash_;
   return *this;
 }
 
+void Rendezvous::ParsedKey::set_slot(int64_t slot) {
+  slot_ = slot;
+  hash_ = Hash64(buf_.data(), buf_.size());
+}
+
 /*  static */
 string Rendezvous::CreateKey(const string& src_device, uint64 src_incarnation,
                              const string& dst_device, const string& name,
@@ -109,6 +116,7 @@ Status Rendezvous::ParseKey(StringPiece key, ParsedKey* out) {
     out->src_device = StringPiece(parts[0].data(), parts[0].size());
     out->dst_device = StringPiece(parts[2].data(), parts[2].size());
     out->edge_name = StringPiece(parts[3].data(), parts[3].size());
+    out->slot_ = -1;
     return OkStatus();
   }
   return errors::InvalidArgument("Invalid  rendezvous key: ", key);
@@ -71,11 +71,22 @@ class RendezvousInterface {
     ParsedKey& operator=(const ParsedKey& b);
     StringPiece FullKey() const { return buf_; }
 
+    // Dense index of the Send/Recv pair of this key in its partitioned graph
+    // (see PartitionOptions::assign_rendezvous_slots), or -1. LocalRendezvous
+    // matches keys with a slot without hashing them.
+    int64_t slot() const { return slot_; }
+    // Hash of FullKey(). Only valid if slot() >= 0.
+    uint64 hash() const { return hash_; }
+    // Assigns `slot` to the parsed key and precomputes its hash.
+    void set_slot(int64_t slot);
+
    private:
     friend class Rendezvous;
     friend class SendOp;
     friend class RecvOp;
     std::string buf_;
+    int64_t slot_ = -1;
+    uint64 hash_ = 0;
   };
 
   // The caller is a tensor producer and it sends a message (a tensor
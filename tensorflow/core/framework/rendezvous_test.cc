@@ -394,6 +394,73 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
   EXPECT_TRUE(absl::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+Rendezvous::ParsedKey MakeSlotKey(const string& name, int64_t slot) {
+  Rendezvous::ParsedKey k = MakeKey(name);
+  k.set_slot(slot);
+  return k;
+}
+
+TEST_F(LocalRendezvousTest, SlotSendRecv) {
+  Rendezvous::Args args;
+  // "bar" reuses the slot owned by "foo", and falls back to the table.
+  const Rendezvous::ParsedKey foo = MakeSlotKey("foo", 3);
+  const Rendezvous::ParsedKey bar = MakeSlotKey("bar", 3);
+  // Out of range slots also use the table.
+  const Rendezvous::ParsedKey baz = MakeSlotKey("baz", int64_t{1} << 40);
+  TF_ASSERT_OK(rendez_->Send(foo, args, V("foo0"), false));
+  TF_ASSERT_OK(rendez_->Send(bar, args, V("bar"), false));
+  TF_ASSERT_OK(rendez_->Send(foo, args, V("foo1"), false));
+  TF_ASSERT_OK(rendez_->Send(baz, args, V("baz"), false));
+
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(bar, args, &val, &is_dead));
+  EXPECT_EQ("bar", V(val));
+  TF_ASSERT_OK(rendez_->Recv(foo, args, &val, &is_dead));
+  EXPECT_EQ("foo0", V(val));
+  TF_ASSERT_OK(rendez_->Recv(foo, args, &val, &is_dead));
+  EXPECT_EQ("foo1", V(val));
+  TF_ASSERT_OK(rendez_->Recv(baz, args, &val, &is_dead));
+  EXPECT_EQ("baz", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotRecvSend) {
+  const Rendezvous::ParsedKey foo = MakeSlotKey("foo", 130);
+  SchedClosure([this, &foo]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    Rendezvous::Args args;
+    TF_CHECK_OK(rendez_->Send(foo, args, V("hello"), false));
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Recv(foo, args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousTest, SlotCancelAndAbort) {
+  const Rendezvous::ParsedKey foo = MakeSlotKey("foo", 0);
+  CancellationManager cm;
+  Rendezvous::Args args;
+  args.cancellation_manager = &cm;
+  SchedClosure([&cm]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    cm.StartCancel();
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  EXPECT_TRUE(absl::IsCancelled(rendez_->Recv(foo, args, &val, &is_dead)));
+
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    rendez_->StartAbort(errors::Aborted(""));
+    rendez_->Unref();
+  });
+  EXPECT_TRUE(absl::IsAborted(
+      rendez_->Recv(foo, Rendezvous::Args(), &val, &is_dead)));
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 
 #include <atomic>
+#include <vector>
 
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -138,53 +139,52 @@ ResourceMgr::~ResourceMgr() { Clear(); }
 void ResourceMgr::Clear() {
   // We do the deallocation outside of the lock to avoid a potential deadlock
   // in case any of the destructors access the resource manager.
-  absl::flat_hash_map<string, Container*> tmp_containers;
+  std::vector<Container*> tmp_containers;
   {
     mutex_lock l(mu_);
-    tmp_containers = std::move(containers_);
-    containers_.clear();  // reinitialize after move.
+    containers_.clear();
   }
-  for (const auto& p : tmp_containers) {
-    delete p.second;
+  for (Shard& shard : shards_) {
+    mutex_lock l(shard.mu);
+    for (const auto& p : shard.containers) {
+      tmp_containers.push_back(p.second);
+    }
+    shard.containers.clear();
+  }
+  for (Container* container : tmp_containers) {
+    delete container;
   }
 }
 
 string ResourceMgr::DebugString() const {
-  mutex_lock l(mu_);
-  struct Line {
-    const string* container;
-    const string type;
-    const string* resource;
-    const string detail;
-  };
-  std::vector<Line> lines;
-  for (const auto& p : containers_) {
-    const string& container = p.first;
-    for (const auto& q : *p.second) {
-      const Key& key = q.first;
-      const char* type = DebugTypeName(key.first);
-      const core::RefCountPtr<ResourceBase> resource = q.second.GetResource();
-      Line l{&container, port::Demangle(type), q.second.name.get(),
-             resource ? resource->DebugString() : "<nullptr>"};
-      lines.push_back(l);
-    }
-  }
   std::vector<string> text;
-  text.reserve(lines.size());
-  for (const Line& line : lines) {
-    text.push_back(strings::Printf(
-        "%-20s | %-40s | %-40s | %-s", line.container->c_str(),
-        line.type.c_str(), line.resource->c_str(), line.detail.c_str()));
+  for (const Shard& shard : shards_) {
+    mutex_lock shard_lock(shard.mu);
+    mutex_lock l(mu_);
+    for (const auto& p : shard.containers) {
+      const string& container = p.first;
+      for (const auto& q : *p.second) {
+        const Key& key = q.first;
+        const string type = port::Demangle(DebugTypeName(key.first));
+        const core::RefCountPtr<ResourceBase> resource =
+            q.second.GetResource();
+        const string detail =
+            resource ? resource->DebugString() : "<nullptr>";
+        text.push_back(strings::Printf(
+            "%-20s | %-40s | %-40s | %-s", container.c_str(), type.c_str(),
+            q.second.name->c_str(), detail.c_str()));
+      }
+    }
   }
   std::sort(text.begin(), text.end());
   return absl::StrJoin(text, "\n");
 }
 
-Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
-                             const string& name, ResourceBase* resource,
-                             bool owns_resource) {
-  Container* container = [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    Container** ptr = &containers_[container_name];
+Status ResourceMgr::DoCreate(Shard& shard, const string& container_name,
+                             TypeIndex type, const string& name,
+                             ResourceBase* resource, bool owns_resource) {
+  Container* container = [&]() TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    Container** ptr = &shard.containers[container_name];
     if (*ptr == nullptr) {
       *ptr = new Container;
     }
@@ -200,8 +200,8 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
   if (owns_resource) {
     resource_and_name.resource = core::RefCountPtr<ResourceBase>(resource);
   } else {
-    auto cleanup_fn = [this, container, type, borrowed_name]() {
-      mutex_lock l(mu_);
+    auto cleanup_fn = [&shard, container, type, borrowed_name]() {
+      mutex_lock l(shard.mu);
       auto iter = container->find({type.hash_code(), borrowed_name});
       if (iter != container->end()) {
         container->erase(iter);
@@ -216,6 +216,8 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
 
   auto st = container->insert(std::move(key_and_value));
   if (st.second) {
+    mutex_lock l(mu_);
+    containers_.insert(container_name);
     TF_RETURN_IF_ERROR(InsertDebugTypeName(type.hash_code(), type.name()));
     return OkStatus();
   }
@@ -225,31 +227,30 @@ Status ResourceMgr::DoCreate(const string& container_name, TypeIndex type,
 
 Status ResourceMgr::Lookup(const ResourceHandle& handle,
                            ResourceBase** resource) const {
-  tf_shared_lock l(mu_);
-  return DoLookup(handle.container(), handle.hash_code(),
+  const Shard& shard = GetShard(handle.name());
+  tf_shared_lock l(shard.mu);
+  return DoLookup(shard, handle.container(), handle.hash_code(),
                   /*type_name=*/"ResourceBase", handle.name(), resource);
 }
 
-Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
-                             const string& name,
+Status ResourceMgr::DoLookup(const Shard& shard, const string& container,
+                             TypeIndex type, const string& name,
                              ResourceBase** resource) const {
-  return DoLookup(container, type.hash_code(), type.name(), name, resource);
+  return DoLookup(shard, container, type.hash_code(), type.name(), name,
+                  resource);
 }
 
-Status ResourceMgr::DoLookup(const string& container, uint64 type_hash_code,
-                             const string& type_name,
+Status ResourceMgr::DoLookup(const Shard& shard, const string& container,
+                             uint64 type_hash_code, const string& type_name,
                              const string& resource_name,
                              ResourceBase** resource) const {
-  const Container* b = gtl::FindPtrOrNull(containers_, container);
+  const Container* b = gtl::FindPtrOrNull(shard.containers, container);
   if (b == nullptr) {
-    return errors::NotFound("Container ", container,
-                            " does not exist. (Could not find resource: ",
-                            container, "/", resource_name, ")");
+    return MissingResourceError(container, resource_name, type_name);
   }
   auto iter = b->find({type_hash_code, resource_name});
   if (iter == b->end()) {
-    return errors::NotFound("Resource ", container, "/", resource_name, "/",
-                            type_name, " does not exist.");
+    return MissingResourceError(container, resource_name, type_name);
   }
   ResourceBase* ptr = iter->second.GetResource().release();
   if (ptr == nullptr) {
@@ -260,20 +261,37 @@ Status ResourceMgr::DoLookup(const string& container, uint64 type_hash_code,
   return OkStatus();
 }
 
+Status ResourceMgr::MissingResourceError(const string& container,
+                                         const string& resource_name,
+                                         const string& type_name) const {
+  bool container_exists;
+  {
+    tf_shared_lock l(mu_);
+    container_exists = containers_.contains(container);
+  }
+  if (!container_exists) {
+    return errors::NotFound("Container ", container,
+                            " does not exist. (Could not find resource: ",
+                            container, "/", resource_name, ")");
+  }
+  return errors::NotFound("Resource ", container, "/", resource_name, "/",
+                          type_name, " does not exist.");
+}
+
 Status ResourceMgr::PopResourceAndName(const string& container,
                                        uint64 type_hash_code,
                                        const string& resource_name,
                                        const string& type_name,
                                        ResourceAndName& resource_and_name) {
-  mutex_lock l(mu_);
-  Container* b = gtl::FindPtrOrNull(containers_, container);
+  Shard& shard = GetShard(resource_name);
+  mutex_lock l(shard.mu);
+  Container* b = gtl::FindPtrOrNull(shard.containers, container);
   if (b == nullptr) {
-    return errors::NotFound("Container ", container, " does not exist.");
+    return MissingResourceError(container, resource_name, type_name);
   }
   auto iter = b->find({type_hash_code, resource_name});
   if (iter == b->end()) {
-    return errors::NotFound("Resource ", container, "/", resource_name, "/",
-                            type_name, " does not exist.");
+    return MissingResourceError(container, resource_name, type_name);
   }
   std::swap(resource_and_name, iter->second);
   b->erase(iter);
@@ -311,24 +329,30 @@ Status ResourceMgr::Delete(const ResourceHandle& handle) {
 Status ResourceMgr::Cleanup(const string& container) {
   {
     tf_shared_lock l(mu_);
-    if (!gtl::FindOrNull(containers_, container)) {
+    if (!containers_.contains(container)) {
       // Nothing to cleanup.
       return OkStatus();
     }
   }
-  Container* b = nullptr;
   {
     mutex_lock l(mu_);
-    auto iter = containers_.find(container);
-    if (iter == containers_.end()) {
+    if (containers_.erase(container) == 0) {
       // Nothing to cleanup, it's OK (concurrent cleanup).
       return OkStatus();
     }
-    b = iter->second;
-    containers_.erase(iter);
   }
-  CHECK(b != nullptr);
-  delete b;
+  std::vector<Container*> parts;
+  for (Shard& shard : shards_) {
+    mutex_lock l(shard.mu);
+    auto iter = shard.containers.find(container);
+    if (iter != shard.containers.end()) {
+      parts.push_back(iter->second);
+      shard.containers.erase(iter);
+    }
+  }
+  for (Container* b : parts) {
+    delete b;
+  }
   return OkStatus();
 }
 
@@ -250,6 +250,33 @@ TEST(ResourceMgrTest, CreateOrLookupRaceCondition) {
   EXPECT_EQ(1, atomic_int);
 }
 
+TEST(ResourceMgrTest, ContainerOfManyResources) {
+  // Enough resources to be spread across the shards of the manager.
+  constexpr int kNumResources = 100;
+  ResourceMgr rm;
+  for (int i = 0; i < kNumResources; ++i) {
+    TF_CHECK_OK(rm.Create("foo", strings::StrCat("r", i),
+                          new Resource(strings::StrCat(i))));
+  }
+  TF_CHECK_OK(rm.Create("bar", "r0", new Resource("bar")));
+  for (int i = 0; i < kNumResources; ++i) {
+    EXPECT_EQ(strings::StrCat("R/", i),
+              Find<Resource>(rm, "foo", strings::StrCat("r", i)));
+  }
+  EXPECT_EQ(kNumResources + 1,
+            static_cast<int>(str_util::Split(rm.DebugString(), "\n").size()));
+
+  TF_CHECK_OK(rm.Delete<Resource>("foo", "r1"));
+  HasError(FindErr<Resource>(rm, "foo", "r1"), error::NOT_FOUND,
+           "Resource foo/r1");
+  TF_CHECK_OK(rm.Cleanup("foo"));
+  for (int i = 0; i < kNumResources; ++i) {
+    HasError(FindErr<Resource>(rm, "foo", strings::StrCat("r", i)),
+             error::NOT_FOUND, "Container foo");
+  }
+  EXPECT_EQ("R/bar", Find<Resource>(rm, "bar", "r0"));
+}
+
 Status ComputePolicy(const string& attr_container,
                      const string& attr_shared_name,
                      bool use_node_name_as_default, string* result) {
@@ -25,6 +25,7 @@ limitations under the License.
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -43,6 +44,27 @@ static constexpr int32_t kMaxConcurrentHandlers = 128;
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+auto* run_handler_deadline_requests = monitoring::Counter<0>::New(
+    "/tensorflow/core/run_handler/deadline_requests",
+    "The number of RunHandlerPool requests that have a deadline.");
+
+auto* run_handler_deadline_misses = monitoring::Counter<1>::New(
+    "/tensorflow/core/run_handler/deadline_misses",
+    "The number of RunHandlerPool requests that missed their deadline, by "
+    "stage: 'acquire' if the deadline passed before the request obtained a "
+    "handler, 'run' if it passed while the request held the handler.",
+    "stage");
+
+// Returns true if a request with `priority` and `deadline_us` must be
+// scheduled before a request with `other_priority` and `other_deadline_us`.
+// A deadline of 0 means that the request has no deadline.
+bool SchedulesBefore(int64_t priority, uint64 deadline_us,
+                     int64_t other_priority, uint64 other_deadline_us) {
+  if (priority != other_priority) return priority > other_priority;
+  if (deadline_us == 0) return false;
+  return other_deadline_us == 0 || deadline_us < other_deadline_us;
+}
+
 }  // namespace
 
 namespace internal {
@@ -739,15 +761,25 @@ class RunHandler::Impl {
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
-  void Reset(int64_t step_id,
-             const RunOptions::Experimental::RunHandlerPoolOptions& options);
-
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
   internal::ThreadWorkSource* tws() { return &tws_; }
 
   int64_t priority() { return options_.priority(); }
 
+  // The absolute deadline of the request in microseconds, or 0 if none.
+  uint64 deadline_us() const { return deadline_us_; }
+
+  void Reset(int64_t step_id,
+             const RunOptions::Experimental::RunHandlerPoolOptions& options,
+             uint64 deadline_us);
+
+  // Set if the deadline had already passed when the handler was obtained.
+  bool deadline_missed_on_acquire() const {
+    return deadline_missed_on_acquire_;
+  }
+  void set_deadline_missed_on_acquire() { deadline_missed_on_acquire_ = true; }
+
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
    public:
@@ -768,6 +800,8 @@ class RunHandler::Impl {
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
   RunOptions::Experimental::RunHandlerPoolOptions options_;
+  uint64 deadline_us_ = 0;
+  bool deadline_missed_on_acquire_ = false;
 };
 
 // Contains shared state across all run handlers present in the pool. Also
@@ -831,8 +865,8 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<RunHandler> Get(
       int64_t step_id, int64_t timeout_in_ms,
-      const RunOptions::Experimental::RunHandlerPoolOptions& options)
-      TF_LOCKS_EXCLUDED(mu_) {
+      const RunOptions::Experimental::RunHandlerPoolOptions& options,
+      uint64 deadline_us) TF_LOCKS_EXCLUDED(mu_) {
     thread_local std::unique_ptr<
         Eigen::MaxSizeVector<internal::ThreadWorkSource*>>
         thread_work_sources =
@@ -844,9 +878,24 @@ class RunHandlerPool::Impl {
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    const int64_t priority = options.priority();
+    if (deadline_us != 0) {
+      run_handler_deadline_requests->GetCell()->IncrementBy(1);
+    }
     {
       mutex_lock l(mu_);
-      if (!has_free_handler()) {
+      // Requests wait in priority and deadline order, and a new request may
+      // only take a free handler if no other request is waiting for one.
+      if (!has_free_handler() || !pending_gets_.empty()) {
+        PendingGet pending_get(this, priority, deadline_us);
+        auto pending_it = pending_gets_.cbegin();
+        while (pending_it != pending_gets_.cend() &&
+               !SchedulesBefore(priority, deadline_us, (*pending_it)->priority,
+                                (*pending_it)->deadline_us)) {
+          ++pending_it;
+        }
+        pending_it = pending_gets_.insert(pending_it, &pending_get);
+
         profiler::TraceMe activity(
             [&] {
               return strings::StrCat("WaitingForHandler#step_id=", step_id,
@@ -857,28 +906,39 @@ class RunHandlerPool::Impl {
             strings::StrCat("RunHandlerPool::Impl::Get waiting for a handler "
                             "with timeout in millisecond",
                             timeout_in_ms));
+        bool acquired = true;
         if (timeout_in_ms == 0) {
-          mu_.Await(Condition(this, &Impl::has_free_handler));
-        } else if (!mu_.AwaitWithDeadline(
-                       Condition(this, &Impl::has_free_handler),
-                       EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000)) {
+          mu_.Await(Condition(&pending_get, &PendingGet::CanProceed));
+        } else {
+          acquired = mu_.AwaitWithDeadline(
+              Condition(&pending_get, &PendingGet::CanProceed),
+              EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000);
+        }
+        pending_gets_.erase(pending_it);
+        if (!acquired) {
           return nullptr;
         }
       }
-      // Remove the last entry from free_handlers_ and add to the end of
-      // sorted_active_handlers_.
+      // Remove the last entry from free_handlers_ and insert it into
+      // sorted_active_handlers_ after the requests that are scheduled before
+      // it.
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id, options);
+      handler_impl->Reset(step_id, options, deadline_us);
       free_handlers_.pop_back();
+      if (deadline_us != 0 && EnvTime::NowMicros() > deadline_us) {
+        run_handler_deadline_misses->GetCell("acquire")->IncrementBy(1);
+        handler_impl->set_deadline_missed_on_acquire();
+      }
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+        if (!new_handler_inserted &&
+            (it == sorted_active_handlers_.cend() ||
+             SchedulesBefore(priority, deadline_us, (*it)->priority(),
+                             (*it)->deadline_us()))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -903,6 +963,10 @@ class RunHandlerPool::Impl {
     uint64 now = tensorflow::EnvTime::NowMicros();
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
+    if (handler->deadline_us() != 0 && now > handler->deadline_us() &&
+        !handler->deadline_missed_on_acquire()) {
+      run_handler_deadline_misses->GetCell("run")->IncrementBy(1);
+    }
 
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
@@ -934,7 +998,34 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<uint64> GetActiveHandlerDeadlinesForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<uint64> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->deadline_us());
+    }
+    return ret;
+  }
+
  private:
+  // A Get() call that is blocked until a handler is free.
+  struct PendingGet {
+    PendingGet(Impl* pool_impl, int64_t priority, uint64 deadline_us)
+        : pool_impl(pool_impl), priority(priority), deadline_us(deadline_us) {}
+
+    // Returns true if this call is next in line and a handler is free.
+    // Evaluated by `Await()` with `pool_impl->mu_` held.
+    bool CanProceed() TF_NO_THREAD_SAFETY_ANALYSIS {
+      return pool_impl->has_free_handler() &&
+             pool_impl->pending_gets_.front() == this;
+    }
+
+    Impl* const pool_impl;
+    const int64_t priority;
+    const uint64 deadline_us;
+  };
+
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
       const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
@@ -953,13 +1044,15 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, then deadline, then start time.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
   std::list<RunHandler::Impl*> sorted_active_handlers_ TF_GUARDED_BY(mu_);
   std::vector<RunHandler::Impl*> free_handlers_ TF_GUARDED_BY(mu_);
+  // Get() calls waiting for a free handler, in the order in which they will
+  // obtain one.
+  std::list<PendingGet*> pending_gets_ TF_GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ TF_GUARDED_BY(mu_);
 
   // Histogram of elapsed runtime of every handler (in ms).
@@ -1059,7 +1152,8 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_.reset(new ThreadPoolInterfaceWrapper(this));
-  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
+  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions(),
+        /*deadline_us=*/0);
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -1076,10 +1170,13 @@ void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
 
 void RunHandler::Impl::Reset(
     int64_t step_id,
-    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
+    const RunOptions::Experimental::RunHandlerPoolOptions& options,
+    uint64 deadline_us) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
   options_ = options;
+  deadline_us_ = deadline_us;
+  deadline_missed_on_acquire_ = false;
   tws_.SetTracemeId(step_id);
 }
 
@@ -1095,7 +1192,14 @@ RunHandlerPool::~RunHandlerPool() {}
 std::unique_ptr<RunHandler> RunHandlerPool::Get(
     int64_t step_id, int64_t timeout_in_ms,
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
-  return impl_->Get(step_id, timeout_in_ms, options);
+  return impl_->Get(step_id, timeout_in_ms, options, /*deadline_us=*/0);
+}
+
+std::unique_ptr<RunHandler> RunHandlerPool::Get(
+    int64_t step_id, int64_t timeout_in_ms,
+    const RunOptions::Experimental::RunHandlerPoolOptions& options,
+    uint64 deadline_us) {
+  return impl_->Get(step_id, timeout_in_ms, options, deadline_us);
 }
 
 std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
@@ -1103,6 +1207,11 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<uint64> RunHandlerPool::GetActiveHandlerDeadlinesForTesting()
+    const {
+  return impl_->GetActiveHandlerDeadlinesForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
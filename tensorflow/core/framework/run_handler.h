@@ -68,10 +68,29 @@ class RunHandlerPool {
       const RunOptions::Experimental::RunHandlerPoolOptions& options =
           RunOptions::Experimental::RunHandlerPoolOptions());
 
+  // Same as above, but the request also has an absolute deadline
+  // `deadline_us`, in microseconds since the Unix epoch (see
+  // EnvTime::NowMicros()), or 0 if it has no deadline.
+  //
+  // Requests are ordered by decreasing priority, then by earliest deadline,
+  // with requests without a deadline last, then by arrival. This order is used
+  // both for stealing inter-op work from the active handlers, and for handing
+  // out handlers to the requests that are blocked waiting for one. Requests
+  // that miss their deadline are counted by the
+  // "/tensorflow/core/run_handler/deadline_misses" metric.
+  std::unique_ptr<RunHandler> Get(
+      int64_t step_id, int64_t timeout_in_ms,
+      const RunOptions::Experimental::RunHandlerPoolOptions& options,
+      uint64 deadline_us);
+
   // Get the priorities for active handlers. The return result is with the same
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the deadlines for active handlers. The return result is with the same
+  // order of the active handler list.
+  std::vector<uint64> GetActiveHandlerDeadlinesForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -82,7 +101,7 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority and deadline of the request, then time of the Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -113,6 +113,73 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options =
+      RunOptions::Experimental::RunHandlerPoolOptions();
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options,
+                            /*deadline_us=*/0);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options,
+                            /*deadline_us=*/300);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options,
+                            /*deadline_us=*/100);
+  options.set_priority(2);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options,
+                            /*deadline_us=*/500);
+
+  // The active requests should be ordered by priority, then by earliest
+  // deadline, with requests without a deadline last.
+  EXPECT_EQ(pool->GetActiveHandlerPrioritiesForTesting(),
+            std::vector<int64_t>({2, 1, 1, 1}));
+  EXPECT_EQ(pool->GetActiveHandlerDeadlinesForTesting(),
+            std::vector<uint64>({500, 100, 300, 0}));
+
+  // Requests with equal priority and deadline are ordered by arrival.
+  options.set_priority(1);
+  auto handler5 = pool->Get(/*step_id=*/5, /*timeout_in_ms=*/0, options,
+                            /*deadline_us=*/100);
+  EXPECT_EQ(pool->GetActiveHandlerDeadlinesForTesting(),
+            std::vector<uint64>({500, 100, 100, 300, 0}));
+}
+
+TEST(RunHandlerUtilTest, WaitingRequestsOrderedByPriority) {
+  std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(1, 1));
+
+  // Get all the handlers in the pool.
+  std::vector<std::unique_ptr<RunHandler>> blocking_handles;
+  const int32_t kMaxConcurrentHandlers = 128;  // Copied from run_handler.cc.
+  blocking_handles.reserve(kMaxConcurrentHandlers);
+  for (int i = 0; i < kMaxConcurrentHandlers; ++i) {
+    blocking_handles.push_back(pool->Get(i));
+  }
+
+  // Two requests wait for a handler, the low priority one first. Once a
+  // handler is released, the high priority request must obtain it first.
+  mutex mu;
+  std::vector<int64_t> acquired_priorities;
+  auto get_handler = [&pool, &mu, &acquired_priorities](int64_t priority) {
+    RunOptions::Experimental::RunHandlerPoolOptions options;
+    options.set_priority(priority);
+    auto handler = pool->Get(priority, /*timeout_in_ms=*/0, options,
+                             /*deadline_us=*/0);
+    mutex_lock l(mu);
+    acquired_priorities.push_back(priority);
+  };
+  {
+    thread::ThreadPool tp(Env::Default(), "test", 2);
+    tp.Schedule([&get_handler]() { get_handler(1); });
+    Env::Default()->SleepForMicroseconds(10000);
+    tp.Schedule([&get_handler]() { get_handler(2); });
+    Env::Default()->SleepForMicroseconds(10000);
+    blocking_handles[0].reset();
+  }
+  EXPECT_EQ(acquired_priorities, std::vector<int64_t>({2, 1}));
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -62,6 +62,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -159,6 +160,53 @@ class Buffer : public BufferBase {
   void operator=(const Buffer&) = delete;
 };
 
+// A buffer of at most kMaxBytes bytes, stored in the same aligned allocation
+// as the buffer itself. Small tensors, e.g. scalars and shape vectors, are
+// created and destroyed with a single heap allocation instead of two.
+class InlineBuffer : public TensorBuffer {
+ public:
+  static constexpr size_t kMaxBytes = 64;
+
+  // The data is uninitialized, so only element types which can use memcpy
+  // are stored inline.
+  static InlineBuffer* Create(size_t size) {
+    DCHECK_LE(size, kMaxBytes);
+    void* block = port::AlignedMalloc(kHeaderBytes + size,
+                                      Allocator::kAllocatorAlignment);
+    return new (block)
+        InlineBuffer(static_cast<char*>(block) + kHeaderBytes, size);
+  }
+
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("InlineBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+ private:
+  // The offset of the data, which keeps it aligned like allocated tensors.
+  static constexpr size_t kHeaderBytes =
+      (sizeof(TensorBuffer) + sizeof(size_t) + Allocator::kAllocatorAlignment -
+       1) /
+      Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+
+  InlineBuffer(void* data, size_t size) : TensorBuffer(data), size_(size) {}
+  ~InlineBuffer() override = default;
+
+  const size_t size_;
+};
+
 void LogUnexpectedSize(int64_t actual, int64_t expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -964,11 +1012,48 @@ int Tensor::RefCount() const {
   CASES_WITH_DEFAULT(TYPE_ENUM, STMTS, LOG(FATAL) << "Type not set"; \
                      , LOG(FATAL) << "Unexpected type: " << TYPE_ENUM;)
 
+// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
+// the default CPU allocator for NUMA zone 0. Accessing that currently involves
+// acquiring a lock, which guards initialization of the per-NUMA zone
+// allocators, and becomes highly contended.
+//
+// Note also that it would be better if all Tensor allocations required the user
+// to specify an allocator, for purposes of accounting, etc. However, the
+// default allocator is widely used throughout the codebase and in client code.
+static Allocator* get_default_cpu_allocator() {
+  static Allocator* default_cpu_allocator =
+      cpu_allocator(tsl::port::kNUMANoAffinity);
+  return default_cpu_allocator;
+}
+
+// Returns whether the data of a new tensor is stored inline in its buffer
+// rather than by `a`. The default CPU allocator doesn't need to see small
+// tensors unless their allocations are tracked or logged.
+static bool UseInlineBuffer(Allocator* a, DataType type, int64_t num_elements,
+                            size_t* bytes) {
+  if (num_elements <= 0 || a != get_default_cpu_allocator() ||
+      !DataTypeCanUseMemcpy(type) || MemoryLoggingEnabled() ||
+      a->TracksAllocationSizes()) {
+    return false;
+  }
+  const int element_size = DataTypeSize(type);
+  if (element_size <= 0 ||
+      num_elements > static_cast<int64_t>(InlineBuffer::kMaxBytes /
+                                          element_size)) {
+    return false;
+  }
+  *bytes = num_elements * element_size;
+  return true;
+}
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  size_t inline_bytes;
+  if (UseInlineBuffer(a, type, shape_.num_elements(), &inline_bytes)) {
+    buf_ = InlineBuffer::Create(inline_bytes);
+  } else if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
@@ -1002,20 +1087,6 @@ Status Tensor::BuildTensor(DataType type, const TensorShape& shape,
   return OkStatus();
 }
 
-// NOTE(mrry): The default allocator for a Tensor (when none is specified) is
-// the default CPU allocator for NUMA zone 0. Accessing that currently involves
-// acquiring a lock, which guards initialization of the per-NUMA zone
-// allocators, and becomes highly contended.
-//
-// Note also that it would be better if all Tensor allocations required the user
-// to specify an allocator, for purposes of accounting, etc. However, the
-// default allocator is widely used throughout the codebase and in client code.
-static Allocator* get_default_cpu_allocator() {
-  static Allocator* default_cpu_allocator =
-      cpu_allocator(tsl::port::kNUMANoAffinity);
-  return default_cpu_allocator;
-}
-
 Tensor::Tensor(DataType type, const TensorShape& shape)
     : Tensor(get_default_cpu_allocator(), type, shape) {}
 
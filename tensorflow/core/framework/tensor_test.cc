@@ -1894,6 +1894,35 @@ void BM_Assign(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Assign);
 
+TEST(Tensor, SmallTensorsStoreTheirDataInline) {
+  Tensor small(DT_INT64, TensorShape({8}));
+  EXPECT_TRUE(small.IsAligned());
+  small.flat<int64_t>().setConstant(7);
+  EXPECT_EQ(small.flat<int64_t>()(7), 7);
+  TensorDescription description;
+  small.FillDescription(&description);
+  EXPECT_EQ(description.allocation_description().allocator_name(),
+            "InlineBuffer");
+  EXPECT_EQ(description.allocation_description().requested_bytes(),
+            8 * sizeof(int64_t));
+
+  Tensor copy = small;
+  EXPECT_TRUE(copy.SharesBufferWith(small));
+  Tensor slice = small.Slice(2, 4);
+  EXPECT_EQ(slice.flat<int64_t>()(1), 7);
+
+  // Larger tensors, the ones of other allocators, and the ones which need
+  // their elements constructed use the allocator.
+  Tensor large(DT_INT64, TensorShape({9}));
+  large.FillDescription(&description);
+  EXPECT_NE(description.allocation_description().allocator_name(),
+            "InlineBuffer");
+  Tensor strings(DT_STRING, TensorShape({1}));
+  strings.FillDescription(&description);
+  EXPECT_NE(description.allocation_description().allocator_name(),
+            "InlineBuffer");
+}
+
 // Ensure tensor_data() works on empty tensors
 TEST(Tensor, EmptyTensorData) {
   Tensor empty;
@@ -1910,6 +1939,16 @@ void BM_CreateAndDestroyWithBuf(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_CreateAndDestroyWithBuf);
 
+// Benchmark create and destroy a shape vector, with the default allocator.
+void BM_CreateAndDestroySmallWithDefaultAllocator(
+    ::testing::benchmark::State& state) {
+  TensorShape shape({4});
+  for (auto s : state) {
+    Tensor a(DT_INT64, shape);
+  }
+}
+BENCHMARK(BM_CreateAndDestroySmallWithDefaultAllocator);
+
 // Benchmark create+copy a tensor, with an allocated buffer.
 void BM_CreateAndCopyCtrWithBuf(::testing::benchmark::State& state) {
   TensorShape shape({10, 20});
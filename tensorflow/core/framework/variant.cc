@@ -77,7 +77,9 @@ void EncodeVariantList(const Variant* variant_array, int64_t n,
                        std::unique_ptr<port::StringListEncoder> e) {
   for (int i = 0; i < n; ++i) {
     string s;
-    variant_array[i].Encode(&s);
+    if (!EncodeUnaryVariantBinary(variant_array[i], &s)) {
+      variant_array[i].Encode(&s);
+    }
     e->Append(s);
   }
   e->Finalize();
@@ -89,12 +91,17 @@ bool DecodeVariantList(std::unique_ptr<port::StringListDecoder> d,
   if (!d->ReadSizes(&sizes)) return false;
 
   for (int i = 0; i < n; ++i) {
+    StringPiece data(d->Data(sizes[i]), sizes[i]);
+    if (IsUnaryVariantBinaryEncoding(data)) {
+      if (!DecodeUnaryVariantBinary(data, &variant_array[i])) return false;
+      continue;
+    }
     if (variant_array[i].is_empty()) {
       variant_array[i] = VariantTensorDataProto();
     }
     // TODO(ebrevdo): Replace with StringPiece?  Any way to make this a
     // zero-copy operation that keeps a reference to the data in d?
-    string str(d->Data(sizes[i]), sizes[i]);
+    string str(data);
     if (!variant_array[i].Decode(std::move(str))) return false;
     if (!DecodeUnaryVariant(&variant_array[i])) {
       LOG(ERROR) << "Could not decode variant with type_name: \""
@@ -20,9 +20,11 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/type_index.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -111,6 +113,107 @@ bool DecodeUnaryVariant(Variant* variant) {
   return true;
 }
 
+UnaryVariantOpRegistry::VariantBinaryEncodeFn*
+UnaryVariantOpRegistry::GetBinaryEncodeFn(const TypeIndex& type_index,
+                                          StringPiece* type_name) {
+  auto found = binary_encode_fns.find(type_index);
+  if (found == binary_encode_fns.end()) return nullptr;
+  *type_name = found->second.type_name;
+  return &found->second.encode_fn;
+}
+
+UnaryVariantOpRegistry::VariantBinaryDecodeFn*
+UnaryVariantOpRegistry::GetBinaryDecodeFn(StringPiece type_name) {
+  auto found = binary_decode_fns.find(type_name);
+  if (found == binary_decode_fns.end()) return nullptr;
+  return &found->second;
+}
+
+void UnaryVariantOpRegistry::RegisterBinaryEncodeFns(
+    const TypeIndex& type_index, const string& type_name,
+    const VariantBinaryEncodeFn& encode_fn,
+    const VariantBinaryDecodeFn& decode_fn) {
+  CHECK(!type_name.empty()) << "Need a valid name for UnaryVariantBinaryEncode";
+  StringPiece existing_type_name;
+  CHECK(GetBinaryEncodeFn(type_index, &existing_type_name) == nullptr &&
+        GetBinaryDecodeFn(type_name) == nullptr)
+      << "Unary VariantBinaryEncodeFn for type_name: " << type_name
+      << " already registered";
+  StringPiece persistent_type_name = GetPersistentStringPiece(type_name);
+  binary_encode_fns.insert(std::pair<TypeIndex, BinaryEncoder>(
+      type_index, BinaryEncoder{persistent_type_name, encode_fn}));
+  binary_decode_fns.insert(std::pair<StringPiece, VariantBinaryDecodeFn>(
+      persistent_type_name, decode_fn));
+}
+
+namespace {
+
+// The binary encoding of a Variant is
+//   <kBinaryEncodingTag><varint32 type_name size><type_name><payload>
+// and it never parses as a VariantTensorDataProto, since protobuf field
+// tags can't be 0.
+constexpr char kBinaryEncodingTag = '\0';
+
+// Off by default, since binaries from before the binary encoding can't read
+// it: it may only be enabled once every reader of the encoded tensors (e.g.
+// GraphDef constants, or tensors sent to other workers) decodes it.
+bool BinaryEncodingEnabled() {
+  static const bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_VARIANT_BINARY_ENCODING",
+                                   /*default_val=*/false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+}  // namespace
+
+bool EncodeUnaryVariantBinary(const Variant& variant, string* buf) {
+  CHECK_NOTNULL(buf);
+  if (variant.is_empty() || !BinaryEncodingEnabled()) return false;
+  StringPiece type_name;
+  UnaryVariantOpRegistry::VariantBinaryEncodeFn* encode_fn =
+      UnaryVariantOpRegistry::Global()->GetBinaryEncodeFn(variant.TypeId(),
+                                                          &type_name);
+  if (encode_fn == nullptr) return false;
+  buf->clear();
+  buf->push_back(kBinaryEncodingTag);
+  core::PutVarint32(buf, type_name.size());
+  buf->append(type_name.data(), type_name.size());
+  if (!(*encode_fn)(variant, buf)) {
+    buf->clear();
+    return false;
+  }
+  return true;
+}
+
+bool IsUnaryVariantBinaryEncoding(StringPiece buf) {
+  return !buf.empty() && buf[0] == kBinaryEncodingTag;
+}
+
+bool DecodeUnaryVariantBinary(StringPiece buf, Variant* variant) {
+  CHECK_NOTNULL(variant);
+  if (!IsUnaryVariantBinaryEncoding(buf)) return false;
+  buf.remove_prefix(1);
+  uint32 type_name_size;
+  if (!core::GetVarint32(&buf, &type_name_size) ||
+      buf.size() < type_name_size) {
+    return false;
+  }
+  StringPiece type_name = buf.substr(0, type_name_size);
+  buf.remove_prefix(type_name_size);
+  UnaryVariantOpRegistry::VariantBinaryDecodeFn* decode_fn =
+      UnaryVariantOpRegistry::Global()->GetBinaryDecodeFn(type_name);
+  if (decode_fn == nullptr) {
+    LOG(ERROR) << "Could not decode variant with type_name: \"" << type_name
+               << "\".  Perhaps you forgot to register a binary decoder via "
+                  "REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS?";
+    return false;
+  }
+  return (*decode_fn)(buf, variant);
+}
+
 // Add some basic registrations for use by others, e.g., for testing.
 
 #define REGISTER_VARIANT_DECODE_TYPE(T) \
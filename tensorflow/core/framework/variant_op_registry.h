@@ -106,6 +106,28 @@ class UnaryVariantOpRegistry {
   // Returns nullptr if no decode function was found for the given TypeName.
   VariantDecodeFn* GetDecodeFn(StringPiece type_name);
 
+  // Appends the flat binary encoding of a Variant to the string.  Returns
+  // false if the value has none, e.g. because it holds string tensors.
+  typedef std::function<bool(const Variant&, std::string*)>
+      VariantBinaryEncodeFn;
+  // Decodes the flat binary encoding of a Variant from the StringPiece.
+  typedef std::function<bool(StringPiece, Variant*)> VariantBinaryDecodeFn;
+
+  // Add the binary encode and decode functions of a type to the registry.
+  void RegisterBinaryEncodeFns(const TypeIndex& type_index,
+                               const std::string& type_name,
+                               const VariantBinaryEncodeFn& encode_fn,
+                               const VariantBinaryDecodeFn& decode_fn);
+
+  // Returns nullptr if no binary encode function was found for the given
+  // type.  Otherwise sets *type_name to the TypeName it was registered with.
+  VariantBinaryEncodeFn* GetBinaryEncodeFn(const TypeIndex& type_index,
+                                           StringPiece* type_name);
+
+  // Returns nullptr if no binary decode function was found for the given
+  // TypeName.
+  VariantBinaryDecodeFn* GetBinaryDecodeFn(StringPiece type_name);
+
   // Add a copy-to-GPU function to the registry.
   void RegisterDeviceCopyFn(const VariantDeviceCopyDirection direction,
                             const TypeIndex& type_index,
@@ -196,6 +218,14 @@ class UnaryVariantOpRegistry {
 
   gtl::FlatMap<StringPiece, VariantDecodeFn, StringPieceHasher> decode_fns;
 
+  struct BinaryEncoder {
+    StringPiece type_name;
+    VariantBinaryEncodeFn encode_fn;
+  };
+  gtl::FlatMap<TypeIndex, BinaryEncoder, TypeIndexHash> binary_encode_fns;
+  gtl::FlatMap<StringPiece, VariantBinaryDecodeFn, StringPieceHasher>
+      binary_decode_fns;
+
   // Map std::pair<Direction, type_name> to function.
   struct PairHash {
     template <typename Direction>
@@ -284,6 +314,30 @@ inline bool operator==(const UnaryVariantOpRegistry::FuncTuple<Op>& lhs,
 //
 bool DecodeUnaryVariant(Variant* variant);
 
+// Encodes the Variant with the flat binary encoding registered for its type
+// via REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS, which EncodeVariantList
+// prefers over the per element VariantTensorDataProto.  Returns false if there
+// is none, if the value can't use it, or unless the environment variable
+// TF_VARIANT_BINARY_ENCODING is true.  It is false by default, since older
+// binaries can't decode the binary encoding; DecodeVariantList accepts both.
+//
+// REQUIRES:
+//   buf is not null.
+//
+bool EncodeUnaryVariantBinary(const Variant& variant, std::string* buf);
+
+// Returns true if `buf` was written by EncodeUnaryVariantBinary, rather than
+// being a serialized VariantTensorDataProto.
+bool IsUnaryVariantBinaryEncoding(StringPiece buf);
+
+// Decodes a Variant written by EncodeUnaryVariantBinary.  Returns false if
+// its type has no registered binary decode function, or if decoding fails.
+//
+// REQUIRES:
+//   variant is not null.
+//
+bool DecodeUnaryVariantBinary(StringPiece buf, Variant* variant);
+
 // Copies a variant between CPU<->GPU, or between GPU<->GPU.
 // The variant 'from' must have a registered DeviceCopyFn for the
 // given direction.  The returned variant 'to' will have
@@ -382,6 +436,32 @@ class UnaryVariantDecodeRegistration {
   }
 };
 
+template <typename T>
+class UnaryVariantBinaryEncodeRegistration {
+ public:
+  typedef std::function<bool(const T& t, std::string* buf)> LocalEncodeFn;
+  typedef std::function<bool(StringPiece buf, T* t)> LocalDecodeFn;
+  UnaryVariantBinaryEncodeRegistration(const std::string& type_name,
+                                       const LocalEncodeFn& encode_fn,
+                                       const LocalDecodeFn& decode_fn) {
+    UnaryVariantOpRegistry::Global()->RegisterBinaryEncodeFns(
+        TypeIndex::Make<T>(), type_name,
+        [encode_fn](const Variant& v, std::string* buf) -> bool {
+          const T* t = v.get<T>();
+          return t != nullptr && encode_fn(*t, buf);
+        },
+        [decode_fn](StringPiece buf, Variant* v) -> bool {
+          DCHECK_NE(v, nullptr);
+          T decoded;
+          if (!decode_fn(buf, &decoded)) {
+            return false;
+          }
+          *v = std::move(decoded);
+          return true;
+        });
+  }
+};
+
 template <typename T>
 class UnaryVariantDeviceCopyRegistration {
  public:
@@ -494,6 +574,33 @@ class UnaryVariantBinaryOpRegistration {
       UnaryVariantDecodeRegistration<T>                                \
           register_unary_variant_op_decoder_fn_##ctr(type_name)
 
+// Register the flat binary encode and decode functions of the given type,
+// with signatures:
+//
+//   bool encode_fn(const T& t, std::string* buf);  // Appends to buf.
+//   bool decode_fn(StringPiece buf, T* t);
+//
+// The type must also have a regular decode function registered under the
+// same type_name, which decodes the VariantTensorDataProto written whenever
+// encode_fn returns false.
+#define REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS(T, type_name,         \
+                                                       encode_fn, decode_fn) \
+  REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS_UNIQ_HELPER(                \
+      __COUNTER__, T, type_name, encode_fn, decode_fn)
+
+#define REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS_UNIQ_HELPER( \
+    ctr, T, type_name, encode_fn, decode_fn)                        \
+  REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS_UNIQ(ctr, T, type_name, \
+                                                      encode_fn, decode_fn)
+
+#define REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS_UNIQ(           \
+    ctr, T, type_name, encode_fn, decode_fn)                           \
+  static ::tensorflow::variant_op_registry_fn_registration::           \
+      UnaryVariantBinaryEncodeRegistration<T>                          \
+          register_unary_variant_op_binary_encoder_fn_##ctr(type_name, \
+                                                            encode_fn, \
+                                                            decode_fn)
+
 // ****** NOTE ******
 // FOR INTERNAL USE ONLY.  IF YOU USE THIS WE MAY BREAK YOUR CODE.
 // ****** NOTE ******
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include "tensorflow/core/lib/strings/str_util.h"
 
@@ -26,6 +28,8 @@ limitations under the License.
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +106,20 @@ REGISTER_UNARY_VARIANT_BINARY_OP_FUNCTION(ADD_VARIANT_BINARY_OP, DEVICE_CPU,
 REGISTER_UNARY_VARIANT_BINARY_OP_FUNCTION(ADD_VARIANT_BINARY_OP, DEVICE_GPU,
                                           VariantValue, VariantValue::GPUAddFn);
 
+REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS(
+    VariantValue, "TEST VariantValue",
+    [](const VariantValue& v, string* buf) {
+      if (v.early_exit) return false;
+      buf->append(reinterpret_cast<const char*>(&v.value), sizeof(v.value));
+      return true;
+    },
+    [](StringPiece buf, VariantValue* v) {
+      if (buf.size() != sizeof(v->value)) return false;
+      v->early_exit = false;
+      std::memcpy(&v->value, buf.data(), sizeof(v->value));
+      return true;
+    });
+
 }  // namespace
 
 TEST(VariantOpDecodeRegistryTest, TestBasic) {
@@ -151,6 +169,69 @@ TEST(VariantOpDecodeRegistryTest, TestDuplicate) {
                "fjfjfj already registered");
 }
 
+// The binary encoding is off by default. Enables it before its value is first
+// read.
+const bool kBinaryEncodingEnabled =
+    setenv("TF_VARIANT_BINARY_ENCODING", "true", /*overwrite=*/1) == 0;
+
+TEST(VariantOpBinaryEncodeRegistryTest, TestBasic) {
+  ASSERT_TRUE(kBinaryEncodingEnabled);
+  Variant v = VariantValue{false /* early_exit */, 7};
+  string buf;
+  ASSERT_TRUE(EncodeUnaryVariantBinary(v, &buf));
+  EXPECT_TRUE(IsUnaryVariantBinaryEncoding(buf));
+  Variant decoded;
+  ASSERT_TRUE(DecodeUnaryVariantBinary(buf, &decoded));
+  ASSERT_NE(decoded.get<VariantValue>(), nullptr);
+  EXPECT_EQ(decoded.get<VariantValue>()->value, 7);
+
+  // Values the encode function rejects, and types without one.
+  EXPECT_FALSE(
+      EncodeUnaryVariantBinary(VariantValue{true /* early_exit */}, &buf));
+  EXPECT_FALSE(EncodeUnaryVariantBinary(Variant(3.0f), &buf));
+  EXPECT_FALSE(EncodeUnaryVariantBinary(Variant(), &buf));
+
+  VariantTensorDataProto proto;
+  proto.set_type_name("TEST VariantValue");
+  EXPECT_FALSE(IsUnaryVariantBinaryEncoding(proto.SerializeAsString()));
+  EXPECT_FALSE(IsUnaryVariantBinaryEncoding(""));
+}
+
+TEST(VariantOpBinaryEncodeRegistryTest, TestTensorRoundTrip) {
+  ASSERT_TRUE(kBinaryEncodingEnabled);
+  // Binary encoded, proto encoded, and empty elements.
+  Tensor t(DT_VARIANT, TensorShape({4}));
+  t.flat<Variant>()(0) = VariantValue{false /* early_exit */, 1};
+  t.flat<Variant>()(1) = VariantValue{true /* early_exit */, 2};
+  t.flat<Variant>()(2) = 3.0f;
+  TensorProto proto;
+  t.AsProtoTensorContent(&proto);
+
+  Tensor decoded;
+  ASSERT_TRUE(decoded.FromProto(proto));
+  ASSERT_EQ(decoded.NumElements(), 4);
+  const auto flat = decoded.flat<Variant>();
+  ASSERT_NE(flat(0).get<VariantValue>(), nullptr);
+  EXPECT_EQ(flat(0).get<VariantValue>()->value, 1);
+  ASSERT_NE(flat(1).get<VariantValue>(), nullptr);
+  EXPECT_EQ(flat(1).get<VariantValue>()->value, 2);
+  ASSERT_NE(flat(2).get<float>(), nullptr);
+  EXPECT_EQ(*flat(2).get<float>(), 3.0f);
+  EXPECT_TRUE(flat(3).is_empty());
+}
+
+TEST(VariantOpBinaryEncodeRegistryTest, TestDuplicate) {
+  UnaryVariantOpRegistry registry;
+  UnaryVariantOpRegistry::VariantBinaryEncodeFn encode_fn;
+  UnaryVariantOpRegistry::VariantBinaryDecodeFn decode_fn;
+  class FjFjFj {};
+  const auto kTypeIndex = TypeIndex::Make<FjFjFj>();
+  registry.RegisterBinaryEncodeFns(kTypeIndex, "fjfjfj", encode_fn, decode_fn);
+  EXPECT_DEATH(registry.RegisterBinaryEncodeFns(kTypeIndex, "fjfjfj",
+                                                encode_fn, decode_fn),
+               "fjfjfj already registered");
+}
+
 TEST(VariantOpCopyToGPURegistryTest, TestBasic) {
   // No registered copy fn for GPU<->GPU.
   EXPECT_EQ(UnaryVariantOpRegistry::Global()->GetDeviceCopyFn(
@@ -1003,6 +1003,7 @@ Status Partition(const PartitionOptions& opts, Graph* g,
 
   int32_t num_data = 0;
   int32_t num_control = 0;
+  int64_t next_rendezvous_slot = 0;
   for (const Node* dst : g->op_nodes()) {
     dstp = opts.node_to_loc(dst);
     GraphDef* dst_graph = &(*partitions)[dstp];
@@ -1159,6 +1160,15 @@ Status Partition(const PartitionOptions& opts, Graph* g,
                               tensor_name_attr, &status);
       if (!status.ok()) return status;
 
+      if (opts.assign_rendezvous_slots &&
+          DeviceNameUtils::IsSameAddressSpace(
+              edge->src()->assigned_device_name(),
+              edge->dst()->assigned_device_name())) {
+        AddNodeAttr("_rendezvous_slot", next_rendezvous_slot, send);
+        AddNodeAttr("_rendezvous_slot", next_rendezvous_slot, real_recv);
+        ++next_rendezvous_slot;
+      }
+
       // Fix up the control flow edge.
       // NOTE(yuanbyu): 'real_recv' must be the real recv node.
       if (src_graph == dst_graph) {
@@ -80,6 +80,12 @@ struct PartitionOptions {
   // Optional customized function to compute the "tensor_name" attr value of
   // Send/Recv ops inserted during partitioning.
   std::function<string(const Edge*)> get_tensor_name_attr = nullptr;
+
+  // If true, each Send/Recv pair between devices of the same address space
+  // gets a dense "_rendezvous_slot" attr, with which LocalRendezvous matches
+  // the pair by index instead of by hashing its key. Only set this when the
+  // partitions run with an intra-process rendezvous.
+  bool assign_rendezvous_slots = false;
 };
 
 // Partition "input" graph into a set of graphs, one per location.
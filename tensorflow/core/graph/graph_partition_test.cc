@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -83,7 +86,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               bool assign_rendezvous_slots = false) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -103,6 +107,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.assign_rendezvous_slots = assign_rendezvous_slots;
   Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -563,6 +568,38 @@ TEST_F(GraphPartitionTest, SetIncarnation) {
   }
 }
 
+TEST_F(GraphPartitionTest, AssignRendezvousSlots) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  auto a2 = FloatInput(in_.WithOpName("A2"));
+  auto b1 = FloatInput(in_.WithOpName("B1"));
+  Combine(in_.WithOpName("B2"), a1, b1);
+  Combine(in_.WithOpName("B3"), a2, a1);
+
+  Partition(ToGraphDef(), &partitions_, /*assign_rendezvous_slots=*/true);
+  EXPECT_EQ(2, partitions_.size());
+
+  // Slots by tensor name, one per Send/Recv pair.
+  std::map<string, std::vector<int64_t>> slots;
+  for (const auto& kv : partitions_) {
+    for (const NodeDef& ndef : kv.second.node()) {
+      if (ndef.op() != "_Send" && ndef.op() != "_Recv") continue;
+      string tensor_name;
+      TF_ASSERT_OK(GetNodeAttr(ndef, "tensor_name", &tensor_name));
+      int64_t slot;
+      TF_ASSERT_OK(GetNodeAttr(ndef, "_rendezvous_slot", &slot));
+      slots[tensor_name].push_back(slot);
+    }
+  }
+  ASSERT_EQ(slots.size(), 2);
+  std::set<int64_t> distinct_slots;
+  for (const auto& [tensor_name, pair_slots] : slots) {
+    ASSERT_EQ(pair_slots.size(), 2) << tensor_name;
+    EXPECT_EQ(pair_slots[0], pair_slots[1]) << tensor_name;
+    distinct_slots.insert(pair_slots[0]);
+  }
+  EXPECT_THAT(distinct_slots, ::testing::ElementsAre(0, 1));
+}
+
 TEST_F(GraphPartitionTest, GraphDebugInfo) {
   GraphDef graph_def;
   Output a1 = FloatInput(in_.WithOpName("A1"));
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -37,7 +38,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -2514,10 +2517,270 @@ Status GraphProperties::UpdateEnqueue(
   return OkStatus();
 }
 
+namespace {
+
+uint64 NodeFingerprint(const NodeDef& node) {
+  string serialized;
+  SerializeToStringDeterministic(node, &serialized);
+  return Fingerprint64(serialized);
+}
+
+int64_t MinSymbolicDim(
+    const absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>&
+        properties) {
+  int64_t min_dim = -1;
+  for (const auto& node_properties : properties) {
+    for (const OpInfo::TensorProperties& tensor : node_properties.second) {
+      for (const auto& dim : tensor.shape().dim()) {
+        min_dim = std::min(min_dim, dim.size());
+      }
+    }
+  }
+  return min_dim;
+}
+
+}  // namespace
+
 Status GraphProperties::InferStatically(bool assume_valid_feeds,
                                         bool aggressive_shape_inference,
                                         bool include_input_tensor_values,
                                         bool include_output_tensor_values) {
+  GraphPropertiesCache* cache = item_.properties_cache.get();
+  if (cache == nullptr) {
+    return InferStaticallyFromScratch(
+        assume_valid_feeds, aggressive_shape_inference,
+        include_input_tensor_values, include_output_tensor_values);
+  }
+
+  string key = strings::StrCat(assume_valid_feeds, aggressive_shape_inference,
+                               include_input_tensor_values,
+                               include_output_tensor_values);
+  for (const auto& feed : item_.feed) {
+    strings::StrAppend(&key, ";", feed.first);
+  }
+  string serialized;
+  SerializeToStringDeterministic(item_.graph.library(), &serialized);
+  strings::StrAppend(&key, ";", Fingerprint64(serialized));
+  SerializeToStringDeterministic(item_.graph.versions(), &serialized);
+  strings::StrAppend(&key, ";", Fingerprint64(serialized));
+
+  absl::flat_hash_map<string, uint64> node_fingerprints;
+  node_fingerprints.reserve(item_.graph.node_size());
+  for (const NodeDef& node : item_.graph.node()) {
+    node_fingerprints[node.name()] = NodeFingerprint(node);
+  }
+
+  mutex_lock l(cache->mu_);
+  if (cache->key_ != key ||
+      !InferStaticallyIncrementally(
+          cache, node_fingerprints, assume_valid_feeds,
+          aggressive_shape_inference, include_input_tensor_values,
+          include_output_tensor_values)) {
+    cache->key_.clear();
+    Clear();
+    incompatible_shape_nodes_.clear();
+    TF_RETURN_IF_ERROR(InferStaticallyFromScratch(
+        assume_valid_feeds, aggressive_shape_inference,
+        include_input_tensor_values, include_output_tensor_values));
+  }
+  cache->key_ = std::move(key);
+  cache->node_fingerprints_ = std::move(node_fingerprints);
+  cache->input_properties_ = input_properties_;
+  cache->output_properties_ = output_properties_;
+  cache->incompatible_shape_nodes_ = incompatible_shape_nodes_;
+  cache->min_symbolic_dim_ = std::min(MinSymbolicDim(input_properties_),
+                                      MinSymbolicDim(output_properties_));
+  return OkStatus();
+}
+
+bool GraphProperties::InferStaticallyIncrementally(
+    GraphPropertiesCache* cache,
+    const absl::flat_hash_map<string, uint64>& node_fingerprints,
+    bool assume_valid_feeds, bool aggressive_shape_inference,
+    bool include_input_tensor_values, bool include_output_tensor_values) {
+  const GraphDef& graph = item_.graph;
+  absl::flat_hash_map<string, const NodeDef*> nodes;
+  absl::flat_hash_map<string, std::vector<const NodeDef*>> fanouts;
+  std::vector<const NodeDef*> modified;
+  for (const NodeDef& node : graph.node()) {
+    nodes[node.name()] = &node;
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) break;
+      fanouts[NodeName(input)].push_back(&node);
+    }
+    auto it = cache->node_fingerprints_.find(node.name());
+    if (it == cache->node_fingerprints_.end() ||
+        it->second != node_fingerprints.at(node.name())) {
+      modified.push_back(&node);
+    }
+  }
+
+  // Re-infer the modified nodes and their transitive fanout. The shapes of
+  // resources and variants are carried by handle data which the cached
+  // properties don't have, so their producers are re-inferred too.
+  absl::flat_hash_set<const NodeDef*> to_infer;
+  while (!modified.empty()) {
+    const NodeDef* node = modified.back();
+    modified.pop_back();
+    if (!to_infer.insert(node).second) continue;
+    for (const NodeDef* fanout : fanouts[node->name()]) {
+      modified.push_back(fanout);
+    }
+  }
+  std::vector<const NodeDef*> to_visit(to_infer.begin(), to_infer.end());
+  while (!to_visit.empty()) {
+    const NodeDef* node = to_visit.back();
+    to_visit.pop_back();
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) break;
+      const TensorId tensor = ParseTensorName(input);
+      auto fanin = nodes.find(tensor.node());
+      if (fanin == nodes.end()) return false;
+      if (to_infer.contains(fanin->second)) continue;
+      auto it = cache->output_properties_.find(tensor.node());
+      if (it == cache->output_properties_.end() ||
+          tensor.index() >= static_cast<int>(it->second.size())) {
+        return false;
+      }
+      const DataType dtype = it->second[tensor.index()].dtype();
+      if (dtype == DT_RESOURCE || dtype == DT_VARIANT) {
+        to_infer.insert(fanin->second);
+        to_visit.push_back(fanin->second);
+      }
+    }
+  }
+
+  // Loops and queues propagate shapes backwards, and the properties of fed
+  // nodes depend on the whole graph: infer them from scratch. It's also faster
+  // to do so when most of the graph changed.
+  absl::flat_hash_set<string> fed_nodes;
+  for (const auto& feed : item_.feed) {
+    fed_nodes.insert(NodeName(feed.first));
+  }
+  if (to_infer.size() * 2 > graph.node_size()) return false;
+  for (const NodeDef* node : to_infer) {
+    if (IsControlFlow(*node) || IsQueue(*node) || IsEnqueue(*node) ||
+        IsDequeue(*node) || fed_nodes.contains(node->name())) {
+      return false;
+    }
+  }
+  VLOG(2) << "Inferring the shapes of " << to_infer.size() << " out of "
+          << graph.node_size() << " nodes";
+
+  // Replace the inputs of the subgraph with placeholders, or constants if
+  // their value is known, carrying the cached properties.
+  GrapplerItem subgraph;
+  *subgraph.graph.mutable_versions() = graph.versions();
+  *subgraph.graph.mutable_library() = graph.library();
+  absl::flat_hash_map<string, string> boundary_nodes;
+  for (const NodeDef& node : graph.node()) {
+    if (!to_infer.contains(&node)) continue;
+    NodeDef* copy = subgraph.graph.add_node();
+    copy->set_name(node.name());
+    copy->set_op(node.op());
+    copy->set_device(node.device());
+    *copy->mutable_attr() = node.attr();
+    for (const string& input : node.input()) {
+      const TensorId tensor = ParseTensorName(input);
+      auto fanin = nodes.find(tensor.node());
+      if (fanin != nodes.end() && to_infer.contains(fanin->second)) {
+        copy->add_input(input);
+        continue;
+      }
+      if (IsControlInput(input)) continue;
+      const string tensor_name =
+          strings::StrCat(tensor.node(), "_", tensor.index());
+      auto it = boundary_nodes.find(tensor_name);
+      if (it == boundary_nodes.end()) {
+        const OpInfo::TensorProperties& properties =
+            cache->output_properties_.at(tensor.node())[tensor.index()];
+        NodeDef* boundary = subgraph.graph.add_node();
+        boundary->set_name(
+            AddPrefixToNodeName(tensor_name, "GraphPropertiesCache"));
+        (*boundary->mutable_attr())["dtype"].set_type(properties.dtype());
+        if (properties.has_value()) {
+          boundary->set_op("Const");
+          *(*boundary->mutable_attr())["value"].mutable_tensor() =
+              properties.value();
+        } else {
+          boundary->set_op("Placeholder");
+          TensorShapeProto* shape =
+              (*boundary->mutable_attr())["shape"].mutable_shape();
+          *shape = properties.shape();
+          for (auto& dim : *shape->mutable_dim()) {
+            dim.set_size(std::max<int64_t>(dim.size(), -1));
+          }
+        }
+        it = boundary_nodes.emplace(tensor_name, boundary->name()).first;
+      }
+      copy->add_input(it->second);
+    }
+  }
+
+  GraphProperties properties(subgraph);
+  Status s = to_infer.empty()
+                 ? OkStatus()
+                 : properties.InferStaticallyFromScratch(
+                       assume_valid_feeds, aggressive_shape_inference,
+                       include_input_tensor_values,
+                       include_output_tensor_values);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer the shapes of the modified nodes: "
+            << s.message();
+    return false;
+  }
+
+  // The symbolic dimensions of the subgraph are numbered independently of the
+  // cached ones: renumber them below the cached ones so that they are not
+  // mistakenly considered equal.
+  int64_t next_symbolic_dim = cache->min_symbolic_dim_;
+  absl::flat_hash_map<int64_t, int64_t> symbolic_dims;
+  auto renumber = [&](std::vector<OpInfo::TensorProperties>* tensors) {
+    for (OpInfo::TensorProperties& tensor : *tensors) {
+      for (auto& dim : *tensor.mutable_shape()->mutable_dim()) {
+        if (dim.size() >= -1) continue;
+        auto it = symbolic_dims.try_emplace(dim.size(), 0);
+        if (it.second) it.first->second = --next_symbolic_dim;
+        dim.set_size(it.first->second);
+      }
+    }
+  };
+  for (const NodeDef& node : graph.node()) {
+    const string& name = node.name();
+    if (to_infer.contains(&node)) {
+      if (properties.input_properties_.contains(name)) {
+        auto& inputs = input_properties_[name];
+        inputs = std::move(properties.input_properties_[name]);
+        renumber(&inputs);
+      }
+      if (properties.output_properties_.contains(name)) {
+        auto& outputs = output_properties_[name];
+        outputs = std::move(properties.output_properties_[name]);
+        renumber(&outputs);
+      }
+      if (properties.incompatible_shape_nodes_.count(name) > 0) {
+        incompatible_shape_nodes_.insert(name);
+      }
+      continue;
+    }
+    auto inputs = cache->input_properties_.find(name);
+    if (inputs != cache->input_properties_.end()) {
+      input_properties_[name] = inputs->second;
+    }
+    auto outputs = cache->output_properties_.find(name);
+    if (outputs != cache->output_properties_.end()) {
+      output_properties_[name] = outputs->second;
+    }
+    if (cache->incompatible_shape_nodes_.count(name) > 0) {
+      incompatible_shape_nodes_.insert(name);
+    }
+  }
+  return true;
+}
+
+Status GraphProperties::InferStaticallyFromScratch(
+    bool assume_valid_feeds, bool aggressive_shape_inference,
+    bool include_input_tensor_values, bool include_output_tensor_values) {
   FunctionLibraryDefinition function_library(OpRegistry::Global(),
                                              item_.graph.library());
   absl::flat_hash_map<string, absl::flat_hash_set<int>> fed_ports;
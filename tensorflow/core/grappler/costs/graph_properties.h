@@ -25,6 +25,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -72,6 +74,33 @@ ABSL_CONST_INIT const char kOutputShapes[] = "_output_shape_vector";
 class SymbolicShapeRefiner;
 class TopoQueue;
 
+// Properties statically inferred for a previous version of the graph of a
+// GrapplerItem. When the item has a cache, GraphProperties::InferStatically
+// only re-infers the nodes which were modified since the previous inference
+// and their fanout, and reuses the cached properties of the other nodes. The
+// cache is shared by the copies of the item, so the optimizers run by the
+// MetaOptimizer on one graph reuse the shapes inferred by each other.
+class GraphPropertiesCache {
+ public:
+  GraphPropertiesCache() = default;
+
+ private:
+  friend class GraphProperties;
+
+  mutex mu_;
+  // The inference options, feeds and function library the properties were
+  // inferred with.
+  string key_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, uint64> node_fingerprints_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+      input_properties_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, std::vector<OpInfo::TensorProperties>>
+      output_properties_ TF_GUARDED_BY(mu_);
+  std::unordered_set<string> incompatible_shape_nodes_ TF_GUARDED_BY(mu_);
+  // Lowest symbolic dimension in the cached properties.
+  int64_t min_symbolic_dim_ TF_GUARDED_BY(mu_) = -1;
+};
+
 // Infer OpInfo::TensorProperties for graph nodes inputs/outputs.
 //
 // Typical use case, is to infer tensor properties from a graph, before doing
@@ -159,6 +188,23 @@ class GraphProperties {
   }
 
  private:
+  // Infers the properties of all the nodes of the graph.
+  Status InferStaticallyFromScratch(bool assume_valid_feeds,
+                                    bool aggressive_shape_inference,
+                                    bool include_input_tensor_values,
+                                    bool include_output_tensor_values);
+
+  // Infers the properties of the nodes whose fingerprint differs from the one
+  // in `cache` and of their fanout, on a subgraph whose inputs have the cached
+  // properties, and copies the cached properties of the other nodes. Returns
+  // false, without inferring anything, if it's not possible or not worth it.
+  bool InferStaticallyIncrementally(
+      GraphPropertiesCache* cache,
+      const absl::flat_hash_map<string, uint64>& node_fingerprints,
+      bool assume_valid_feeds, bool aggressive_shape_inference,
+      bool include_input_tensor_values, bool include_output_tensor_values)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(cache->mu_);
+
   // Relaxes shapes <shapes_and_types>, determined from an EnqueueV2 node, into
   // <*queue_shapes_and_types>.
   static Status RelaxEnqueueShapesAndMergeTypes(
@@ -233,6 +233,67 @@ TEST_F(GraphPropertiesTest, Clear) {
   EXPECT_FALSE(properties.has_properties());
 }
 
+TEST_F(GraphPropertiesTest, ReusesCachedProperties) {
+  auto build_graph = [](bool add_reshape, int rows, GraphDef* graph) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+    Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                                ops::Placeholder::Shape({-1, 8}));
+    Output u = ops::Placeholder(s.WithOpName("u"), DT_FLOAT,
+                                ops::Placeholder::Shape({-1}));
+    Output c = ops::Const(s.WithOpName("c"), 1.0f, {rows, 8});
+    Output y = ops::Add(s.WithOpName("y"), x, c);
+    for (int i = 0; i < 4; ++i) {
+      y = ops::Square(s.WithOpName(strings::StrCat("y", i)), y);
+    }
+    Output v = ops::Square(s.WithOpName("v"), u);
+    if (add_reshape) {
+      Output shape = ops::Const(s.WithOpName("shape"), {-1, 4}, {2});
+      ops::Reshape(s.WithOpName("w"), y, shape);
+    }
+    TF_CHECK_OK(s.ToGraphDef(graph));
+  };
+
+  GrapplerItem item;
+  item.properties_cache = std::make_shared<GraphPropertiesCache>();
+  build_graph(/*add_reshape=*/false, 1, &item.graph);
+  {
+    GraphProperties properties(item);
+    TF_ASSERT_OK(properties.InferStatically(false));
+    EXPECT_EQ("float: [-1,8]",
+              PropToString(properties.GetOutputProperties("y3")[0]));
+  }
+
+  // Only the new nodes are inferred, from the cached shape of y3.
+  GrapplerItem copy = item;
+  build_graph(/*add_reshape=*/true, 1, &copy.graph);
+  {
+    GraphProperties properties(copy);
+    TF_ASSERT_OK(properties.InferStatically(false));
+    EXPECT_EQ("float: [-1,8]",
+              PropToString(properties.GetOutputProperties("y3")[0]));
+    const auto& w = properties.GetOutputProperties("w");
+    ASSERT_EQ(1, w.size());
+    EXPECT_EQ("float: [-1,4]", PropToString(w[0]));
+    // The symbolic dimension inferred for the new node is distinct from the
+    // cached ones.
+    const int64_t w_dim = w[0].shape().dim(0).size();
+    EXPECT_LT(w_dim, -1);
+    EXPECT_NE(w_dim,
+              properties.GetOutputProperties("v")[0].shape().dim(0).size());
+  }
+
+  // The fanout of a modified node is re-inferred.
+  build_graph(/*add_reshape=*/true, 2, &item.graph);
+  {
+    GraphProperties properties(item);
+    TF_ASSERT_OK(properties.InferStatically(false));
+    EXPECT_EQ("float: [2,8]",
+              PropToString(properties.GetOutputProperties("y3")[0]));
+    EXPECT_EQ("float: [4,4]",
+              PropToString(properties.GetOutputProperties("w")[0]));
+  }
+}
+
 TEST_F(GraphPropertiesTest, DynamicProperties) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false,
                                           cluster_->GetDeviceNames());
@@ -32,6 +32,8 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
+class GraphPropertiesCache;
+
 // A TensorFlow model to optimize.
 // Models are represented by the combination of a graph, one of more fetch
 // nodes, and potentially a set of nodes to feed.
@@ -71,6 +73,11 @@ struct GrapplerItem {
   // ensure that the optimized metagraph can still be loaded.
   std::vector<string> keep_ops;
 
+  // Properties inferred for a previous version of the graph, shared by the
+  // copies of this item, which GraphProperties::InferStatically reuses for the
+  // unmodified nodes. Null unless set by the caller, e.g. the MetaOptimizer.
+  std::shared_ptr<GraphPropertiesCache> properties_cache;
+
   // Return the set of node evaluated during a regular train/inference step.
   std::vector<const NodeDef*> MainOpsFanin() const;
   // Return the set of node run to populate the queues (if any).
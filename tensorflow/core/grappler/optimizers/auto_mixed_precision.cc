@@ -37,12 +37,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/mutable_graph_view.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision_lists.h"
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision_profile.h"
 #include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -1038,7 +1040,8 @@ class AutoMixedPrecisionImpl {
   AutoMixedPrecisionImpl(Cluster* cluster,
                          const std::unordered_set<string>& nodes_to_preserve,
                          GraphDef* graph, string id,
-                         AutoMixedPrecisionMode mode)
+                         AutoMixedPrecisionMode mode,
+                         const OpPerformanceList* measured_costs = nullptr)
       : devices_(GetDevices(cluster)),
         virtual_placer_(devices_),
         nodes_to_preserve_(nodes_to_preserve),
@@ -1053,7 +1056,8 @@ class AutoMixedPrecisionImpl {
         target_dtype_((mode_ == AutoMixedPrecisionMode::CUDA ||
                        mode_ == AutoMixedPrecisionMode::CPU)
                           ? DT_HALF
-                          : DT_BFLOAT16) {}
+                          : DT_BFLOAT16),
+        measured_costs_(measured_costs) {}
 
   Status Optimize();
 
@@ -1147,6 +1151,7 @@ class AutoMixedPrecisionImpl {
   gtl::FlatSet<string> f16_clearlist_;
   absl::flat_hash_set<const NodeDef*> should_process_nodes_;
   DataType target_dtype_;  // Either DT_HALF or DT_BFLOAT16
+  const OpPerformanceList* measured_costs_;
 };
 
 NodeDef AutoMixedPrecisionImpl::BuildCastNode(
@@ -1409,6 +1414,13 @@ Status AutoMixedPrecisionImpl::Optimize() {
   }
 
   f16_clearlist_ = mp_lists->ClearList();
+  if (measured_costs_ != nullptr &&
+      measured_costs_->op_performance_size() > 0) {
+    AutoMixedPrecisionProfile profile(*measured_costs_, target_dtype_);
+    profile.AdjustLists(
+        &f16_allowlist_, &f16_denylist_,
+        treat_infer_as_deny_ ? &f16_denylist_ : &f16_inferlist_);
+  }
   TF_RETURN_IF_ERROR(ValidateLists(f16_allowlist_, f16_denylist_,
                                    f16_inferlist_, f16_clearlist_));
 
@@ -2310,9 +2322,21 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
                  << " graph optimizer configured for BFloat16 on CPUs";
   }
 
+  if (!measured_costs_loaded_ && !measured_costs_path_.empty()) {
+    Status s = ReadTextOrBinaryProto(Env::Default(), measured_costs_path_,
+                                     &measured_costs_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to read the measured costs from "
+                   << measured_costs_path_
+                   << ", using the default lists: " << s;
+      measured_costs_.Clear();
+    }
+    measured_costs_loaded_ = true;
+  }
+
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id, mode_);
+                                   item.id, mode_, &measured_costs_);
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
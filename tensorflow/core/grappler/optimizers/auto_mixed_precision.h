@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_H_
 
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -34,10 +35,14 @@ class AutoMixedPrecision : public GraphOptimizer {
  public:
   // If 'mode' is CUDA, converts nodes to float16 on Nvidia GPUs. If BF16,
   // converts nodes to bfloat16 on CPUs in order to take advantage of oneDNN
-  // performance improvements with bfloat16.
+  // performance improvements with bfloat16. When `measured_costs_path` names
+  // an OpPerformanceList of the ops timed in both precisions, the lists are
+  // adjusted to the ops measured faster or slower in the target type, see
+  // AutoMixedPrecisionProfile.
   explicit AutoMixedPrecision(
-      AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
-      : mode_(mode) {}
+      AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA,
+      const string& measured_costs_path = "")
+      : mode_(mode), measured_costs_path_(measured_costs_path) {}
 
   ~AutoMixedPrecision() override {}
 
@@ -62,6 +67,10 @@ class AutoMixedPrecision : public GraphOptimizer {
 
  private:
   const AutoMixedPrecisionMode mode_;
+  const string measured_costs_path_;
+  // Read from `measured_costs_path_` on first use.
+  bool measured_costs_loaded_ = false;
+  OpPerformanceList measured_costs_;
 };
 
 }  // end namespace grappler
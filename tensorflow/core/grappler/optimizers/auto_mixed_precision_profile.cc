@@ -0,0 +1,162 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision_profile.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+bool HasTensorOfType(const OpInfo& op_info, DataType dtype) {
+  for (const auto& input : op_info.inputs()) {
+    if (input.dtype() == dtype) return true;
+  }
+  for (const auto& output : op_info.outputs()) {
+    if (output.dtype() == dtype) return true;
+  }
+  return false;
+}
+
+// The key of an op measurement, independent of its precision.
+std::string ShapeKey(const OpInfo& op_info) {
+  std::string key = absl::StrCat(op_info.op(), "@", op_info.device().type());
+  for (const auto& input : op_info.inputs()) {
+    absl::StrAppend(&key, ";", PartialTensorShape::DebugString(input.shape()));
+  }
+  return key;
+}
+
+std::string CastKey(const OpInfo::TensorProperties& tensor,
+                    const std::string& device_type) {
+  return absl::StrCat(device_type, ";",
+                      PartialTensorShape::DebugString(tensor.shape()));
+}
+
+}  // namespace
+
+AutoMixedPrecisionProfile::AutoMixedPrecisionProfile(
+    const OpPerformanceList& measured_costs, DataType target_dtype)
+    : target_dtype_(target_dtype) {
+  struct Measurements {
+    int64_t total_ns[2] = {0, 0};
+    int count[2] = {0, 0};
+    const OpInfo* float32_op = nullptr;
+  };
+  absl::flat_hash_map<std::string, std::pair<int64_t, int>> cast_totals;
+  absl::flat_hash_map<std::string, Measurements> measurements;
+  for (const OpPerformance& perf : measured_costs.op_performance()) {
+    if (perf.compute_cost() <= 0) continue;
+    const OpInfo& op_info = perf.op();
+    if (op_info.op() == "Cast") {
+      if (op_info.inputs_size() != 1) continue;
+      auto& total =
+          cast_totals[CastKey(op_info.inputs(0), op_info.device().type())];
+      total.first += perf.compute_cost();
+      ++total.second;
+      continue;
+    }
+    int precision;
+    if (HasTensorOfType(op_info, target_dtype_)) {
+      precision = 1;
+    } else if (HasTensorOfType(op_info, DT_FLOAT)) {
+      precision = 0;
+    } else {
+      continue;
+    }
+    Measurements& m = measurements[ShapeKey(op_info)];
+    m.total_ns[precision] += perf.compute_cost();
+    ++m.count[precision];
+    if (precision == 0 && m.float32_op == nullptr) m.float32_op = &op_info;
+  }
+  for (const auto& total : cast_totals) {
+    cast_time_ns_[total.first] = total.second.first / total.second.second;
+  }
+
+  for (const auto& it : measurements) {
+    const Measurements& m = it.second;
+    if (m.count[0] == 0 || m.count[1] == 0) continue;
+    const OpInfo& op_info = *m.float32_op;
+    OpTimes& times = op_times_[op_info.op()];
+    times.float32_ns += m.total_ns[0] / m.count[0];
+    times.target_ns += m.total_ns[1] / m.count[1];
+    for (const auto& input : op_info.inputs()) {
+      if (input.dtype() == DT_FLOAT) {
+        times.cast_ns += CastTime(input, op_info.device());
+      }
+    }
+    for (const auto& output : op_info.outputs()) {
+      if (output.dtype() == DT_FLOAT) {
+        times.cast_ns += CastTime(output, op_info.device());
+      }
+    }
+    ++times.num_shapes;
+  }
+}
+
+int64_t AutoMixedPrecisionProfile::CastTime(
+    const OpInfo::TensorProperties& tensor,
+    const DeviceProperties& device) const {
+  auto it = cast_time_ns_.find(CastKey(tensor, device.type()));
+  if (it != cast_time_ns_.end()) return it->second;
+
+  OpContext op_context;
+  op_context.op_info.set_op("Cast");
+  *op_context.op_info.add_inputs() = tensor;
+  OpInfo::TensorProperties* output = op_context.op_info.add_outputs();
+  *output = tensor;
+  output->set_dtype(target_dtype_);
+  *op_context.op_info.mutable_device() = device;
+  return estimator_.PredictCosts(op_context).execution_time.count();
+}
+
+void AutoMixedPrecisionProfile::AdjustLists(gtl::FlatSet<string>* allow,
+                                            gtl::FlatSet<string>* deny,
+                                            gtl::FlatSet<string>* infer) const {
+  for (const auto& it : op_times_) {
+    const std::string& op = it.first;
+    const OpTimes& times = it.second;
+    VLOG(2) << op << " takes " << times.target_ns << " ns plus "
+            << times.cast_ns << " ns of casts in "
+            << DataTypeString(target_dtype_) << " instead of "
+            << times.float32_ns << " ns over " << times.num_shapes
+            << " measured shapes";
+    if (allow->count(op) && !times.IsFaster()) {
+      VLOG(1) << "Moving " << op << " from the allow list to the "
+              << (infer == deny ? "deny" : "infer")
+              << " list, it is measured slower in "
+              << DataTypeString(target_dtype_);
+      allow->erase(op);
+      infer->insert(op);
+    } else if (infer != deny && deny->count(op) && times.IsFaster()) {
+      VLOG(1) << "Moving " << op << " from the deny list to the infer list, "
+              << "it is measured faster in " << DataTypeString(target_dtype_);
+      deny->erase(op);
+      infer->insert(op);
+    }
+  }
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,79 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_PROFILE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_PROFILE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Measured execution times of ops in float32 and in the target type of
+// AutoMixedPrecision, e.g. the OpPerformanceList produced by
+// CostGraphToOpPerformanceData from the cost graphs of a run in each
+// precision. An op is compared on the input shapes and device types measured
+// in both precisions, and converting it is charged the casts of its float32
+// inputs and outputs: measured Cast entries of the same shape when there are
+// some, and predicted by the OpLevelCostEstimator otherwise.
+class AutoMixedPrecisionProfile {
+ public:
+  struct OpTimes {
+    int64_t float32_ns = 0;
+    int64_t target_ns = 0;
+    int64_t cast_ns = 0;
+    int num_shapes = 0;
+
+    bool IsFaster() const { return target_ns + cast_ns < float32_ns; }
+  };
+
+  AutoMixedPrecisionProfile(const OpPerformanceList& measured_costs,
+                            DataType target_dtype);
+
+  // Moves the ops of `allow` which are measured slower in the target type to
+  // `infer`, and the ops of `deny` which are measured faster to `infer`, where
+  // they are only converted next to other converted ops. `infer` may be the
+  // same set as `deny`, in which case only the allow list is adjusted.
+  void AdjustLists(gtl::FlatSet<string>* allow, gtl::FlatSet<string>* deny,
+                   gtl::FlatSet<string>* infer) const;
+
+  // Times summed over the shapes measured in both precisions, by op type.
+  const absl::flat_hash_map<std::string, OpTimes>& op_times() const {
+    return op_times_;
+  }
+
+ private:
+  int64_t CastTime(const OpInfo::TensorProperties& tensor,
+                   const DeviceProperties& device) const;
+
+  const DataType target_dtype_;
+  OpLevelCostEstimator estimator_;
+  // Mean measured time of the casts, by device type and shape.
+  absl::flat_hash_map<std::string, int64_t> cast_time_ns_;
+  absl::flat_hash_map<std::string, OpTimes> op_times_;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_MIXED_PRECISION_PROFILE_H_
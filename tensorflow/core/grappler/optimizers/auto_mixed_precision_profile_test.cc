@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_mixed_precision_profile.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void AddMeasurement(const string& op, int num_inputs, DataType dtype,
+                    int64_t compute_cost, OpPerformanceList* list) {
+  OpPerformance* perf = list->add_op_performance();
+  OpInfo* op_info = perf->mutable_op();
+  op_info->set_op(op);
+  op_info->mutable_device()->set_type("GPU");
+  OpInfo::TensorProperties tensor;
+  tensor.set_dtype(dtype);
+  TensorShape({32, 32}).AsProto(tensor.mutable_shape());
+  for (int i = 0; i < num_inputs; ++i) *op_info->add_inputs() = tensor;
+  *op_info->add_outputs() = tensor;
+  perf->set_compute_cost(compute_cost);
+}
+
+OpPerformanceList MakeMeasurements() {
+  OpPerformanceList list;
+  // Each cast of a 32x32 tensor takes 50ns.
+  AddMeasurement("Cast", 1, DT_FLOAT, 50, &list);
+  // 400ns + 3 casts beat 1000ns.
+  AddMeasurement("MatMul", 2, DT_FLOAT, 1000, &list);
+  AddMeasurement("MatMul", 2, DT_HALF, 400, &list);
+  // 100ns + 3 casts lose to 200ns.
+  AddMeasurement("Conv2D", 2, DT_FLOAT, 200, &list);
+  AddMeasurement("Conv2D", 2, DT_HALF, 100, &list);
+  // 50ns + 2 casts beat 300ns.
+  AddMeasurement("Exp", 1, DT_FLOAT, 300, &list);
+  AddMeasurement("Exp", 1, DT_HALF, 50, &list);
+  // Only measured in float32.
+  AddMeasurement("Tanh", 1, DT_FLOAT, 300, &list);
+  return list;
+}
+
+TEST(AutoMixedPrecisionProfileTest, ChargesCasts) {
+  AutoMixedPrecisionProfile profile(MakeMeasurements(), DT_HALF);
+  const auto& op_times = profile.op_times();
+  ASSERT_EQ(op_times.count("MatMul"), 1);
+  EXPECT_EQ(op_times.at("MatMul").float32_ns, 1000);
+  EXPECT_EQ(op_times.at("MatMul").target_ns, 400);
+  EXPECT_EQ(op_times.at("MatMul").cast_ns, 150);
+  EXPECT_TRUE(op_times.at("MatMul").IsFaster());
+  ASSERT_EQ(op_times.count("Conv2D"), 1);
+  EXPECT_FALSE(op_times.at("Conv2D").IsFaster());
+  ASSERT_EQ(op_times.count("Exp"), 1);
+  EXPECT_EQ(op_times.at("Exp").cast_ns, 100);
+  EXPECT_TRUE(op_times.at("Exp").IsFaster());
+  EXPECT_EQ(op_times.count("Tanh"), 0);
+  EXPECT_EQ(op_times.count("Cast"), 0);
+}
+
+TEST(AutoMixedPrecisionProfileTest, AdjustsLists) {
+  AutoMixedPrecisionProfile profile(MakeMeasurements(), DT_HALF);
+  gtl::FlatSet<string> allow = {"MatMul", "Conv2D"};
+  gtl::FlatSet<string> deny = {"Exp", "Tanh"};
+  gtl::FlatSet<string> infer = {"Add"};
+  profile.AdjustLists(&allow, &deny, &infer);
+  EXPECT_EQ(allow, gtl::FlatSet<string>({"MatMul"}));
+  EXPECT_EQ(deny, gtl::FlatSet<string>({"Tanh"}));
+  EXPECT_EQ(infer, gtl::FlatSet<string>({"Add", "Conv2D", "Exp"}));
+}
+
+TEST(AutoMixedPrecisionProfileTest, KeepsDenyListWhenInferIsDeny) {
+  AutoMixedPrecisionProfile profile(MakeMeasurements(), DT_HALF);
+  gtl::FlatSet<string> allow = {"MatMul", "Conv2D"};
+  gtl::FlatSet<string> deny = {"Exp", "Tanh", "Add"};
+  profile.AdjustLists(&allow, &deny, &deny);
+  EXPECT_EQ(allow, gtl::FlatSet<string>({"MatMul"}));
+  EXPECT_EQ(deny, gtl::FlatSet<string>({"Add", "Conv2D", "Exp", "Tanh"}));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
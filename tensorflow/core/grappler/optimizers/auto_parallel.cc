@@ -15,18 +15,30 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/grappler/utils/transitive_fanin.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -264,8 +276,155 @@ void AutoParallel::BuildGraph(GraphDef* graph) {
   LOG(INFO) << "Parallelized graph size: " << graph->node_size();
 }
 
+std::vector<int> PartitionIntoStages(const std::vector<int64_t>& costs,
+                                     int num_stages) {
+  std::vector<int> stages(costs.size(), 0);
+  if (costs.empty() || num_stages < 2) {
+    return stages;
+  }
+  // Greedily packs the nodes into stages costing at most max_cost, and returns
+  // the number of stages used.
+  auto pack = [&costs, &stages](int64_t max_cost) {
+    int stage = 0;
+    int64_t stage_cost = 0;
+    for (int i = 0; i < costs.size(); i++) {
+      if (stage_cost > 0 && stage_cost + costs[i] > max_cost) {
+        stage++;
+        stage_cost = 0;
+      }
+      stage_cost += costs[i];
+      stages[i] = stage;
+    }
+    return stage + 1;
+  };
+  // Search for the lowest cost of the most expensive stage.
+  int64_t low = *std::max_element(costs.begin(), costs.end());
+  int64_t high = std::accumulate(costs.begin(), costs.end(), int64_t{0});
+  while (low < high) {
+    const int64_t mid = low + (high - low) / 2;
+    if (pack(mid) <= num_stages) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  pack(low);
+  return stages;
+}
+
+Status AutoParallel::BuildPipeline(Cluster* cluster, const GrapplerItem& item,
+                                   GraphDef* output) {
+  if (item.fetch.empty()) {
+    return Status(absl::StatusCode::kInvalidArgument,
+                  "No fetch nodes provided.");
+  }
+
+  std::unordered_map<string, DeviceProperties> cpus;
+  if (cluster != nullptr) {
+    for (const auto& device : cluster->GetDevices()) {
+      if (device.second.type() == "CPU") {
+        cpus.insert(device);
+      }
+    }
+  } else {
+    for (const auto& device : item.devices()) {
+      DeviceNameUtils::ParsedName parsed_name;
+      if (DeviceNameUtils::ParseFullName(device, &parsed_name) &&
+          parsed_name.type == "CPU") {
+        cpus.emplace(device, GetLocalCPUInfo());
+      }
+    }
+  }
+  std::vector<string> devices;
+  for (const auto& cpu : cpus) {
+    devices.push_back(cpu.first);
+  }
+  std::sort(devices.begin(), devices.end());
+  const int num_stages =
+      std::min<int>(num_pipeline_stages_, static_cast<int>(devices.size()));
+  if (num_stages < 2) {
+    return Status(absl::StatusCode::kAborted,
+                  "Not enough CPU devices to pipeline the graph.");
+  }
+
+  GraphProperties properties(item);
+  TF_RETURN_IF_ERROR(properties.InferStatically(/*assume_valid_feeds=*/false));
+  std::vector<const NodeDef*> fanin_nodes;
+  TF_RETURN_IF_ERROR(ComputeTransitiveFanin(item.graph, item.fetch,
+                                            &fanin_nodes));
+  std::unordered_set<const NodeDef*> fanin(fanin_nodes.begin(),
+                                           fanin_nodes.end());
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(item.graph, &topo_order));
+
+  // Stateful nodes, resources and control flow stay where they are: they may
+  // be shared with other steps or have to be colocated.
+  auto uses_resources =
+      [](const std::vector<OpInfo::TensorProperties>& tensors) {
+        return std::any_of(tensors.begin(), tensors.end(),
+                           [](const OpInfo::TensorProperties& tensor) {
+                             return tensor.dtype() == DT_RESOURCE;
+                           });
+      };
+  OpLevelCostEstimator estimator;
+  std::vector<const NodeDef*> pipelined_nodes;
+  std::vector<int64_t> costs;
+  for (const NodeDef* node : topo_order) {
+    if (fanin.find(node) == fanin.end() || !IsFreeOfSideEffect(*node) ||
+        IsControlFlow(*node) ||
+        uses_resources(properties.GetInputProperties(node->name())) ||
+        uses_resources(properties.GetOutputProperties(node->name()))) {
+      continue;
+    }
+    DeviceNameUtils::ParsedName parsed_name;
+    if (!node->device().empty() &&
+        (!DeviceNameUtils::ParseFullName(node->device(), &parsed_name) ||
+         (parsed_name.has_type && parsed_name.type != "CPU"))) {
+      continue;
+    }
+    OpContext op_context;
+    op_context.name = node->name();
+    op_context.device_name = node->device();
+    op_context.op_info = BuildOpInfoWithoutDevice(
+        *node, {}, properties.GetInputProperties(node->name()));
+    for (const auto& output : properties.GetOutputProperties(node->name())) {
+      *op_context.op_info.add_outputs() = output;
+    }
+    *op_context.op_info.mutable_device() = cpus[devices[0]];
+    const Costs node_costs = estimator.PredictCosts(op_context);
+    pipelined_nodes.push_back(node);
+    costs.push_back(std::max<int64_t>(1, node_costs.execution_time.count()));
+  }
+
+  const std::vector<int> stages = PartitionIntoStages(costs, num_stages);
+  std::unordered_map<string, int> node_stages;
+  std::vector<int64_t> stage_costs(num_stages, 0);
+  for (int i = 0; i < pipelined_nodes.size(); i++) {
+    node_stages[pipelined_nodes[i]->name()] = stages[i];
+    stage_costs[stages[i]] += costs[i];
+  }
+  for (int i = 0; i < num_stages; i++) {
+    VLOG(1) << "Pipeline stage " << i << " on " << devices[i]
+            << ": estimated cost = " << stage_costs[i] << "ns";
+  }
+
+  *output = item.graph;
+  for (NodeDef& node : *output->mutable_node()) {
+    auto it = node_stages.find(node.name());
+    if (it != node_stages.end()) {
+      node.set_device(devices[it->second]);
+    }
+  }
+  LOG(INFO) << "Pipelined " << pipelined_nodes.size() << " nodes over "
+            << num_stages << " CPU devices";
+  return OkStatus();
+}
+
 Status AutoParallel::Optimize(Cluster* cluster, const GrapplerItem& item,
                               GraphDef* output) {
+  if (num_pipeline_stages_ >= 2) {
+    return BuildPipeline(cluster, item, output);
+  }
   TF_RETURN_IF_ERROR(Initialize(item));
   BuildGraph(output);
   return OkStatus();
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_PARALLEL_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_PARALLEL_H_
 
+#include <vector>
+
 #include "tensorflow/core/framework/variable.pb.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -23,11 +25,22 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-// Automatically parallelize a graph by splitting in the batch dimension.
+// Splits a sequence of nodes with the given estimated costs into at most
+// `num_stages` contiguous stages, minimizing the cost of the most expensive
+// stage. Returns the stage of each node.
+std::vector<int> PartitionIntoStages(const std::vector<int64_t>& costs,
+                                     int num_stages);
+
+// Automatically parallelize a graph by splitting in the batch dimension, or,
+// if num_pipeline_stages is greater than 1, by pipelining the nodes computing
+// the fetches over that many CPU devices. The nodes are split into stages of
+// balanced estimated cost in topological order, so that each stage only feeds
+// the following ones, and each stage is placed on its own CPU device.
 class AutoParallel : public GraphOptimizer {
  public:
-  AutoParallel(int num_replicas) : num_replicas_(num_replicas) {
-    CHECK(num_replicas_ >= 2);
+  AutoParallel(int num_replicas, int num_pipeline_stages = 0)
+      : num_replicas_(num_replicas), num_pipeline_stages_(num_pipeline_stages) {
+    CHECK(num_replicas_ >= 2 || num_pipeline_stages_ >= 2);
   }
   ~AutoParallel() override {}
 
@@ -46,8 +59,11 @@ class AutoParallel : public GraphOptimizer {
   std::set<string> shared_nodes_;
   const GrapplerItem* item_;
   int num_replicas_;
+  int num_pipeline_stages_;
   int num_gpus_;
   Status Initialize(const GrapplerItem& item);
+  Status BuildPipeline(Cluster* cluster, const GrapplerItem& item,
+                       GraphDef* output);
   NodeDef* AddNodeDivConst();
   NodeDef* AddNodeDiv(const string& name, const string& input_a,
                       const string& input_b);
@@ -150,6 +150,58 @@ TEST_F(AutoParallelTest, SimpleParallelNoDequeue) {
   TF_EXPECT_OK(status);
 }
 
+TEST_F(AutoParallelTest, PartitionIntoStages) {
+  EXPECT_EQ(std::vector<int>({0, 1, 1, 1, 1, 2}),
+            PartitionIntoStages({4, 1, 1, 1, 1, 4}, 3));
+  EXPECT_EQ(std::vector<int>({0, 0, 1, 1}),
+            PartitionIntoStages({1, 1, 1, 1}, 2));
+  EXPECT_EQ(std::vector<int>({0, 0, 0}), PartitionIntoStages({1, 2, 3}, 1));
+}
+
+TEST_F(AutoParallelTest, Pipeline) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {64, 64});
+  Output m1 = ops::MatMul(s.WithOpName("m1"), a, a);
+  Output m2 = ops::MatMul(s.WithOpName("m2"), m1, a);
+  Output m3 = ops::MatMul(s.WithOpName("m3"), m2, a);
+  Output m4 = ops::MatMul(s.WithOpName("m4"), m3, a);
+
+  GrapplerItem item;
+  item.fetch.push_back("m4");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  const string cpu0 = "/job:localhost/replica:0/task:0/device:CPU:0";
+  const string cpu1 = "/job:localhost/replica:0/task:0/device:CPU:1";
+  TF_ASSERT_OK(item.AddDevice(cpu0));
+  TF_ASSERT_OK(item.AddDevice(cpu1));
+
+  AutoParallel parallel(/*num_replicas=*/0, /*num_pipeline_stages=*/4);
+  GraphDef output;
+  TF_EXPECT_OK(parallel.Optimize(nullptr, item, &output));
+  ASSERT_EQ(5, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "m3" || node.name() == "m4") {
+      EXPECT_EQ(cpu1, node.device());
+    } else {
+      EXPECT_EQ(cpu0, node.device());
+    }
+  }
+}
+
+TEST_F(AutoParallelTest, PipelineNeedsTwoDevices) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {64, 64});
+  Output m = ops::MatMul(s.WithOpName("m"), a, a);
+
+  GrapplerItem item;
+  item.fetch.push_back("m");
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  TF_ASSERT_OK(item.AddDevice("/job:localhost/replica:0/task:0/device:CPU:0"));
+
+  AutoParallel parallel(/*num_replicas=*/0, /*num_pipeline_stages=*/2);
+  GraphDef output;
+  EXPECT_TRUE(absl::IsAborted(parallel.Optimize(nullptr, item, &output)));
+}
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
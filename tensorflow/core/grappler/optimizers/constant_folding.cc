@@ -193,21 +193,26 @@ float QuantizedTypeMaxAsFloat(DataType data_type) {
 ConstantFolding::ConstantFolding(RewriterConfig::Toggle opt_level,
                                  DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_emulation)
+                                 bool fold_quantization_emulation,
+                                 const string& cache_dir)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
       disable_compressed_tensor_optimization_(
           disable_compressed_tensor_optimization),
       fold_quantization_emulation_(fold_quantization_emulation) {
   resource_mgr_.reset(new ResourceMgr());
+  if (!cache_dir.empty()) {
+    cache_ = std::make_unique<ConstantFoldingCache>(cache_dir, Env::Default());
+  }
 }
 
 ConstantFolding::ConstantFolding(DeviceBase* cpu_device,
                                  bool disable_compressed_tensor_optimization,
-                                 bool fold_quantization_ops)
+                                 bool fold_quantization_ops,
+                                 const string& cache_dir)
     : ConstantFolding(RewriterConfig::ON, cpu_device,
                       disable_compressed_tensor_optimization,
-                      fold_quantization_ops) {}
+                      fold_quantization_ops, cache_dir) {}
 
 // static
 string ConstantFolding::AddControlDependency(const string& input_name,
@@ -1037,10 +1042,13 @@ bool ConstantFolding::IsFoldableUncached(
         if (num_bytes < 0) {  // Overflown
           return false;
         }
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
-          // Do not fold nodes if the in-memory size of output is too large.
-          // Notice that this is not exactly the same check used in
-          // CreateNodeDef() where the actual encoded size is checked.
+        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize &&
+            !(CanCacheFoldedNode(node) &&
+              ConstantFoldingCache::CanStore(output_prop.dtype()))) {
+          // Do not fold nodes if the in-memory size of output is too large,
+          // unless it can be stored in the cache. Notice that this is not
+          // exactly the same check used in CreateNodeDef() where the actual
+          // encoded size is checked.
           return false;
         }
       }
@@ -1334,6 +1342,60 @@ Status ConstantFolding::CreateNodeDef(const string& name,
   return OkStatus();
 }
 
+namespace {
+
+// Creates an ImmutableConst node mapping the result stored in `entry`.
+void CreateImmutableConstNodeDef(const string& name,
+                                 const ConstantFoldingCache::Entry& entry,
+                                 NodeDef* node) {
+  node->set_name(name);
+  node->set_op("ImmutableConst");
+  AttrValue attr_type;
+  attr_type.set_type(entry.dtype);
+  node->mutable_attr()->insert({"dtype", attr_type});
+  AttrValue attr_shape;
+  entry.shape.AsProto(attr_shape.mutable_shape());
+  node->mutable_attr()->insert({"shape", attr_shape});
+  AttrValue attr_region;
+  attr_region.set_s(entry.path);
+  node->mutable_attr()->insert({"memory_region_name", attr_region});
+}
+
+}  // namespace
+
+bool ConstantFolding::CanCacheFoldedNode(const NodeDef& node) const {
+  // ImmutableConst only has a CPU kernel.
+  return cache_ != nullptr && (node.device().empty() || NodeIsOnCpu(&node));
+}
+
+Status ConstantFolding::CreateNodeDefsFromCache(
+    const NodeDef& node,
+    const std::vector<ConstantFoldingCache::Entry>& entries,
+    size_t original_size, std::vector<NodeDef>* outputs) const {
+  outputs->resize(entries.size());
+  for (size_t i = 0; i < entries.size(); i++) {
+    string node_name = OptimizedNodeName(node, "-folded");
+    if (entries.size() > 1) {
+      node_name = strings::StrCat(node_name, "-", i);
+    }
+    const ConstantFoldingCache::Entry& entry = entries[i];
+    if (entry.shape.num_elements() * DataTypeSize(entry.dtype) <=
+        kMaxConstantSize) {
+      Tensor value;
+      TF_RETURN_IF_ERROR(cache_->Read(entry, &value));
+      NodeDef constant;
+      if (CreateNodeDef(node_name, TensorValue(&value), &constant,
+                        original_size)
+              .ok()) {
+        outputs->at(i) = std::move(constant);
+        continue;
+      }
+    }
+    CreateImmutableConstNodeDef(node_name, entry, &outputs->at(i));
+  }
+  return OkStatus();
+}
+
 Status ConstantFolding::EvaluateNode(const NodeDef& node,
                                      const TensorVector& inputs,
                                      TensorVector* output) const {
@@ -1395,12 +1457,24 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     total_inputs_size += value->TotalBytes();
   }
 
+  string cache_key;
+  if (CanCacheFoldedNode(node)) {
+    cache_key = ConstantFoldingCache::Key(node, inputs);
+    std::vector<ConstantFoldingCache::Entry> entries;
+    if (!cache_key.empty() && cache_->Lookup(cache_key, &entries)) {
+      VLOG(2) << "Found folded results of " << node.name() << " in cache";
+      return CreateNodeDefsFromCache(node, entries, total_inputs_size,
+                                     outputs);
+    }
+  }
+
   TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
   if (output_tensors.empty()) {
     return Status(absl::StatusCode::kInvalidArgument,
                   "Expected at least one output.");
   }
 
+  std::vector<ConstantFoldingCache::Entry> cached;
   outputs->resize(output_tensors.size());
   for (size_t i = 0; i < output_tensors.size(); i++) {
     string node_name = OptimizedNodeName(node, "-folded");
@@ -1410,6 +1484,24 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     if (output_tensors[i].tensor) {
       Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
                                total_inputs_size);
+      if (!s.ok() && !cache_key.empty()) {
+        // Store the results in the cache and map them instead.
+        if (cached.empty()) {
+          Status cache_status =
+              cache_->Insert(cache_key, output_tensors, &cached);
+          if (!cache_status.ok()) {
+            VLOG(1) << "Failed to cache folded results of " << node.name()
+                    << ": " << cache_status;
+            cached.clear();
+            cache_key.clear();
+          }
+        }
+        if (!cached.empty()) {
+          outputs->at(i) = NodeDef();
+          CreateImmutableConstNodeDef(node_name, cached[i], &outputs->at(i));
+          s = OkStatus();
+        }
+      }
       if (!s.ok()) {
         *result_too_large = true;
         return s;
@@ -1568,7 +1660,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
     if (const_nodes.size() == 1) {
-      node->set_op("Const");
+      node->set_op(const_node->op());
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
       // does nothing.
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
@@ -45,12 +46,17 @@ class ConstantFolding : public GraphOptimizer {
   static string AddControlDependency(const string& input_name, GraphDef* graph,
                                      NodeMap* node_map);
 
+  // If `cache_dir` is not empty, the results of folding which are larger than
+  // kMaxConstantSize are stored in a ConstantFoldingCache in this directory,
+  // and the folded nodes are replaced with ImmutableConst nodes mapping them.
   explicit ConstantFolding(DeviceBase* cpu_device,
                            bool disable_compressed_tensor_optimization = false,
-                           bool fold_quantization_emulation = true);
+                           bool fold_quantization_emulation = true,
+                           const string& cache_dir = "");
   ConstantFolding(RewriterConfig::Toggle opt_level, DeviceBase* cpu_device,
                   bool disable_compressed_tensor_optimization = false,
-                  bool fold_quantization_emulation = true);
+                  bool fold_quantization_emulation = true,
+                  const string& cache_dir = "");
 
   ~ConstantFolding() override {}
 
@@ -95,6 +101,15 @@ class ConstantFolding : public GraphOptimizer {
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
+  // Returns whether the results of folding `node` may be stored in cache_
+  // instead of being inlined in the graph.
+  bool CanCacheFoldedNode(const NodeDef& node) const;
+  // Creates the nodes of the results of `node` stored in cache_.
+  Status CreateNodeDefsFromCache(
+      const NodeDef& node,
+      const std::vector<ConstantFoldingCache::Entry>& entries,
+      size_t original_size, std::vector<NodeDef>* outputs) const;
+
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
   Status FoldNode(NodeDef* node, GraphDef* output_graph,
                   bool* result_too_large);
@@ -340,6 +355,7 @@ class ConstantFolding : public GraphOptimizer {
   bool graph_contains_assign_or_inplace_op_;
   bool disable_compressed_tensor_optimization_;
   bool fold_quantization_emulation_;
+  std::unique_ptr<ConstantFoldingCache> cache_;
 };
 
 }  // end namespace grappler
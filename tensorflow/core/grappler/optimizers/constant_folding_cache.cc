@@ -0,0 +1,149 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
+
+#include <cstring>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Writes `data` to `path` through a temporary file, so that readers never see
+// a partially written file.
+Status WriteAtomically(Env* env, const string& path, StringPiece data) {
+  string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return errors::Unavailable("Failed to create a temporary file for ",
+                               path);
+  }
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, data));
+  return env->RenameFile(tmp_path, path);
+}
+
+}  // namespace
+
+ConstantFoldingCache::ConstantFoldingCache(const string& dir, Env* env)
+    : dir_(dir), env_(env) {}
+
+/* static */
+string ConstantFoldingCache::Key(
+    const NodeDef& node, const gtl::InlinedVector<TensorValue, 4>& inputs) {
+  // The name, inputs and device of the node do not change its results.
+  NodeDef op;
+  op.set_op(node.op());
+  *op.mutable_attr() = node.attr();
+  string serialized;
+  if (!SerializeToStringDeterministic(op, &serialized)) return "";
+  uint64 fingerprint = Fingerprint64(serialized);
+  for (const TensorValue& input : inputs) {
+    if (input.tensor == nullptr || !CanStore(input->dtype())) return "";
+    fingerprint = FingerprintCat64(fingerprint, input->dtype());
+    fingerprint = FingerprintCat64(
+        fingerprint, Fingerprint64(input->shape().DebugString()));
+    fingerprint =
+        FingerprintCat64(fingerprint, Fingerprint64(input->tensor_data()));
+  }
+  return absl::StrCat(absl::Hex(fingerprint, absl::kZeroPad16));
+}
+
+string ConstantFoldingCache::MetadataPath(const string& key) const {
+  return io::JoinPath(dir_, absl::StrCat(key, ".meta"));
+}
+
+string ConstantFoldingCache::DataPath(const string& key, int output) const {
+  return io::JoinPath(dir_, absl::StrCat(key, "_", output, ".tensor"));
+}
+
+bool ConstantFoldingCache::Lookup(const string& key,
+                                  std::vector<Entry>* entries) const {
+  const string metadata_path = MetadataPath(key);
+  if (!env_->FileExists(metadata_path).ok()) return false;
+  AttrValue metadata;
+  if (!ReadBinaryProto(env_, metadata_path, &metadata).ok()) return false;
+  entries->clear();
+  for (int i = 0; i < metadata.list().tensor_size(); ++i) {
+    const TensorProto& proto = metadata.list().tensor(i);
+    Entry entry;
+    entry.dtype = proto.dtype();
+    if (!CanStore(entry.dtype) ||
+        !TensorShape::BuildTensorShape(proto.tensor_shape(), &entry.shape)
+             .ok()) {
+      return false;
+    }
+    entry.path = DataPath(key, i);
+    // Check that the data is complete, since it may be mapped as is.
+    uint64 size;
+    if (!env_->GetFileSize(entry.path, &size).ok() ||
+        size != entry.shape.num_elements() * DataTypeSize(entry.dtype)) {
+      return false;
+    }
+    entries->push_back(std::move(entry));
+  }
+  return !entries->empty();
+}
+
+Status ConstantFoldingCache::Read(const Entry& entry, Tensor* tensor) const {
+  string data;
+  TF_RETURN_IF_ERROR(ReadFileToString(env_, entry.path, &data));
+  *tensor = Tensor(entry.dtype, entry.shape);
+  if (data.size() != tensor->TotalBytes()) {
+    return errors::DataLoss("Unexpected size of ", entry.path, ": ",
+                            data.size(), " instead of ", tensor->TotalBytes());
+  }
+  std::memcpy(const_cast<char*>(tensor->tensor_data().data()), data.data(),
+              data.size());
+  return OkStatus();
+}
+
+Status ConstantFoldingCache::Insert(
+    const string& key, const gtl::InlinedVector<TensorValue, 4>& outputs,
+    std::vector<Entry>* entries) const {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(dir_));
+  AttrValue metadata;
+  entries->clear();
+  for (int i = 0; i < outputs.size(); ++i) {
+    const TensorValue& output = outputs[i];
+    if (output.tensor == nullptr || !CanStore(output->dtype())) {
+      return errors::InvalidArgument("Can't store output ", i, " of ", key);
+    }
+    Entry entry;
+    entry.dtype = output->dtype();
+    entry.shape = output->shape();
+    entry.path = DataPath(key, i);
+    TF_RETURN_IF_ERROR(
+        WriteAtomically(env_, entry.path, output->tensor_data()));
+    TensorProto* proto = metadata.mutable_list()->add_tensor();
+    proto->set_dtype(entry.dtype);
+    entry.shape.AsProto(proto->mutable_tensor_shape());
+    entries->push_back(std::move(entry));
+  }
+  // The metadata is written last, so that an entry is only found once all of
+  // its data is.
+  return WriteAtomically(env_, MetadataPath(key),
+                         metadata.SerializeAsString());
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
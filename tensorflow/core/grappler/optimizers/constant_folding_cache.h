@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A persistent cache of the results of constant folding, keyed by a
+// fingerprint of the folded node and of the values of its inputs, which can be
+// shared by the sessions loading the same model, e.g. from a directory next to
+// its SavedModel.
+//
+// Each result is stored as the raw bytes of the tensor, which an ImmutableConst
+// node can map into memory at runtime. Constant folding therefore does not need
+// to inline results larger than kMaxConstantSize in the GraphDef, and does not
+// evaluate them again when the model is loaded again.
+class ConstantFoldingCache {
+ public:
+  struct Entry {
+    DataType dtype = DT_INVALID;
+    TensorShape shape;
+    // The file holding the raw bytes of the tensor.
+    string path;
+  };
+
+  ConstantFoldingCache(const string& dir, Env* env);
+
+  // Returns whether results of type `dtype` can be stored.
+  static bool CanStore(DataType dtype) { return DataTypeCanUseMemcpy(dtype); }
+
+  // Returns the key of the results of `node` evaluated on `inputs`, or an empty
+  // string if the inputs cannot be fingerprinted.
+  static string Key(const NodeDef& node,
+                    const gtl::InlinedVector<TensorValue, 4>& inputs);
+
+  // Returns true and the stored results if there are some under `key`.
+  bool Lookup(const string& key, std::vector<Entry>* entries) const;
+
+  // Reads the value of a stored result.
+  Status Read(const Entry& entry, Tensor* tensor) const;
+
+  // Stores `outputs` under `key`, and returns the entries describing them. The
+  // entry is written atomically, so concurrent sessions never read a partially
+  // written one.
+  Status Insert(const string& key,
+                const gtl::InlinedVector<TensorValue, 4>& outputs,
+                std::vector<Entry>* entries) const;
+
+ private:
+  string MetadataPath(const string& key) const;
+  string DataPath(const string& key, int output) const;
+
+  const string dir_;
+  Env* const env_;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
@@ -31,9 +31,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/tensor_coding.h"
+#include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -3240,6 +3242,56 @@ TEST_F(ConstantFoldingTest, LargeConstant) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, LargeConstantCached) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  // Folding the diag node results in a 1MB constant.
+  Output mat_diag =
+      ops::Const(scope.WithOpName("mat_diag"), 3.14f, TensorShape({512}));
+  Output mat = ops::Diag(scope.WithOpName("mat"), mat_diag);
+  Output out = ops::Identity(scope.WithOpName("out"), mat);
+
+  GrapplerItem item;
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+  item.fetch.push_back("out");
+
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "constant_folding_cache");
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+
+  // The second optimizer finds the results stored by the first one.
+  string memory_region_name;
+  for (int i = 0; i < 2; ++i) {
+    ConstantFolding optimizer(/*cpu_device=*/nullptr,
+                              /*disable_compressed_tensor_optimization=*/false,
+                              /*fold_quantization_emulation=*/true, cache_dir);
+    GraphDef output;
+    Status status = optimizer.Optimize(/*cluster=*/nullptr, item, &output);
+    TF_EXPECT_OK(status);
+
+    // The diag node is replaced with a constant mapped from the cache, so the
+    // output stays small.
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      if (node.name() == "mat") {
+        EXPECT_EQ(node.op(), "ImmutableConst");
+        EXPECT_EQ(node.input_size(), 0);
+        const string& region = node.attr().at("memory_region_name").s();
+        EXPECT_TRUE(absl::StartsWith(region, cache_dir));
+        if (i == 0) memory_region_name = region;
+        EXPECT_EQ(region, memory_region_name);
+        ++found;
+      }
+    }
+    EXPECT_EQ(found, 1);
+    EXPECT_LT(output.ByteSizeLong(), 1000);
+
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  }
+}
+
 TEST_F(ConstantFoldingTest, SwitchIdenticalInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output x = ops::Placeholder(s.WithOpName("x"), DT_BOOL,
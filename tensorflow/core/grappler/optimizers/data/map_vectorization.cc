@@ -0,0 +1,309 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMap[] = "ParallelMapDataset";
+constexpr char kParallelMapV2[] = "ParallelMapDatasetV2";
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+// Functions with more nodes than this are expected to spend enough time in
+// their ops for the per-invocation overhead saved by the rewrite not to matter.
+constexpr int kMaxFunctionNodes = 32;
+
+// Batches smaller than this don't amortize the per-invocation overhead.
+constexpr int64_t kMinBatchSize = 2;
+
+// Ops which apply to each scalar of their input independently.
+constexpr std::array<const char*, 20> kUnaryElementwiseOps = {
+    "Abs",   "Cast",    "Ceil",     "Exp",  "Expm1",      "Floor", "Identity",
+    "Log",   "Log1p",   "Neg",      "Relu", "Reciprocal", "Round", "Rsqrt",
+    "Sigmoid", "Sign",  "Softplus", "Sqrt", "Square",     "Tanh"};
+
+// Element-wise ops which broadcast their two inputs.
+constexpr std::array<const char*, 10> kBinaryElementwiseOps = {
+    "Add", "AddV2", "Div",     "Maximum",           "Minimum",
+    "Mul", "Pow",   "RealDiv", "SquaredDifference", "Sub"};
+
+bool IsParallelMap(const NodeDef& node) {
+  return node.op() == kParallelMap || node.op() == kParallelMapV2;
+}
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || IsParallelMap(node);
+}
+
+int NumOtherArguments(const NodeDef& map_node) {
+  return IsParallelMap(map_node) ? map_node.input_size() - 2
+                                 : map_node.input_size() - 1;
+}
+
+// The rank of a value computed by a function, and whether it varies with the
+// input element, in which case it gains a leading dimension once the function
+// is applied to a batch.
+struct ValueInfo {
+  bool batched = false;
+  // -1 if unknown.
+  int rank = -1;
+};
+
+// Returns whether applying `function` to a batch of elements with the given
+// per-element `arg_ranks` produces the batch of the results of applying it to
+// each element.
+bool IsVectorizable(const FunctionDef& function,
+                    const std::vector<int>& arg_ranks) {
+  if (function.node_def_size() > kMaxFunctionNodes ||
+      function.signature().input_arg_size() !=
+          static_cast<int>(arg_ranks.size())) {
+    return false;
+  }
+  const absl::flat_hash_set<string> unary_ops(kUnaryElementwiseOps.begin(),
+                                              kUnaryElementwiseOps.end());
+  const absl::flat_hash_set<string> binary_ops(kBinaryElementwiseOps.begin(),
+                                               kBinaryElementwiseOps.end());
+  absl::flat_hash_map<string, ValueInfo> values;
+  for (int i = 0; i < arg_ranks.size(); ++i) {
+    values[function.signature().input_arg(i).name()] = {/*batched=*/true,
+                                                        arg_ranks[i]};
+  }
+  auto lookup = [&values](const string& input) -> const ValueInfo* {
+    std::vector<string> parts = absl::StrSplit(input, ':');
+    auto it = values.find(parts[0]);
+    return it == values.end() ? nullptr : &it->second;
+  };
+
+  // Function nodes are not necessarily topologically sorted, so keep visiting
+  // nodes until all of them are resolved.
+  std::vector<const NodeDef*> pending;
+  for (const NodeDef& node : function.node_def()) {
+    pending.push_back(&node);
+  }
+  while (!pending.empty()) {
+    std::vector<const NodeDef*> unresolved;
+    for (const NodeDef* node : pending) {
+      std::vector<const ValueInfo*> inputs;
+      bool ready = true;
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) return false;
+        const ValueInfo* info = lookup(input);
+        if (info == nullptr) {
+          ready = false;
+          break;
+        }
+        inputs.push_back(info);
+      }
+      if (!ready) {
+        unresolved.push_back(node);
+        continue;
+      }
+      ValueInfo result;
+      if (node->op() == "Const") {
+        if (!node->attr().contains("value")) return false;
+        result.rank =
+            node->attr().at("value").tensor().tensor_shape().dim_size();
+      } else if (unary_ops.contains(node->op()) && inputs.size() == 1) {
+        result = *inputs[0];
+      } else if (binary_ops.contains(node->op()) && inputs.size() == 2) {
+        const ValueInfo& x = *inputs[0];
+        const ValueInfo& y = *inputs[1];
+        if (x.batched && y.batched) {
+          // Broadcasting two batched values of different ranks would align
+          // the batch dimension of one with an element dimension of the other.
+          if (x.rank < 0 || x.rank != y.rank) return false;
+        } else if (x.batched != y.batched) {
+          // An unbatched operand broadcasts along the trailing dimensions of
+          // the batched one, as long as it doesn't reach the batch dimension.
+          const ValueInfo& batched = x.batched ? x : y;
+          const ValueInfo& unbatched = x.batched ? y : x;
+          if (unbatched.rank < 0 ||
+              (unbatched.rank > 0 &&
+               (batched.rank < 0 || unbatched.rank > batched.rank))) {
+            return false;
+          }
+        }
+        result.batched = x.batched || y.batched;
+        result.rank =
+            (x.rank < 0 || y.rank < 0) ? -1 : std::max(x.rank, y.rank);
+      } else {
+        return false;
+      }
+      values[node->name()] = result;
+    }
+    if (unresolved.size() == pending.size()) return false;
+    pending = std::move(unresolved);
+  }
+
+  // Values which don't depend on the input element would not be batched.
+  for (const auto& ret : function.ret()) {
+    const ValueInfo* info = lookup(ret.second);
+    if (info == nullptr || !info->batched) return false;
+  }
+  return true;
+}
+
+// Returns whether the batch size of `batch_node` is large enough for the
+// rewrite to pay off.
+bool IsWorthVectorizing(const NodeDef& batch_node,
+                        const MutableGraphView& graph) {
+  NodeDef* batch_size_node = graph_utils::GetInputNode(batch_node, graph, 1);
+  int64_t batch_size;
+  if (batch_size_node == nullptr ||
+      !graph_utils::GetScalarConstNodeValue(*batch_size_node, &batch_size)
+           .ok()) {
+    return false;
+  }
+  return batch_size >= kMinBatchSize;
+}
+
+NodeDef MakeBatchNode(const NodeDef& batch_node, const NodeDef& map_node,
+                      const NodeDef& input_node, MutableGraphView* graph) {
+  NodeDef new_batch = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_batch);
+  new_batch.set_input(0, map_node.input(0));
+
+  // The new batch node batches the input of the map instead of its output.
+  (*new_batch.mutable_attr())[kOutputTypes] =
+      input_node.attr().at(kOutputTypes);
+  int64_t batch_dim = -1;
+  const auto& batch_shapes = batch_node.attr().at(kOutputShapes).list();
+  if (batch_shapes.shape_size() > 0 && !batch_shapes.shape(0).unknown_rank() &&
+      batch_shapes.shape(0).dim_size() > 0) {
+    batch_dim = batch_shapes.shape(0).dim(0).size();
+  }
+  AttrValue output_shapes;
+  for (const auto& shape : input_node.attr().at(kOutputShapes).list().shape()) {
+    TensorShapeProto* batched_shape =
+        output_shapes.mutable_list()->add_shape();
+    if (shape.unknown_rank()) {
+      batched_shape->set_unknown_rank(true);
+      continue;
+    }
+    batched_shape->add_dim()->set_size(batch_dim);
+    for (const auto& dim : shape.dim()) {
+      *batched_shape->add_dim() = dim;
+    }
+  }
+  (*new_batch.mutable_attr())[kOutputShapes] = output_shapes;
+  return new_batch;
+}
+
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch_node, MutableGraphView* graph) {
+  NodeDef new_map = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(), &new_map);
+  new_map.set_input(0, new_batch_node.name());
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map);
+  return new_map;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kBatchDataset && node.op() != kBatchDatasetV2) {
+      continue;
+    }
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMap(*map_node) ||
+        nodes_to_delete.contains(map_node->name())) {
+      continue;
+    }
+    // Captured inputs are not batched, and their rank is unknown.
+    if (NumOtherArguments(*map_node) != 0) continue;
+    // The map can't be moved if something else consumes its output.
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+        1) {
+      continue;
+    }
+    NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    if (input_node == nullptr ||
+        !input_node->attr().contains(kOutputShapes) ||
+        !input_node->attr().contains(kOutputTypes) ||
+        !batch_node.attr().contains(kOutputShapes)) {
+      continue;
+    }
+    if (!IsWorthVectorizing(batch_node, graph)) continue;
+
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (function == nullptr ||
+        function_utils::IsFunctionStateful(function_library, *function)) {
+      continue;
+    }
+    std::vector<int> arg_ranks;
+    for (const auto& shape :
+         input_node->attr().at(kOutputShapes).list().shape()) {
+      arg_ranks.push_back(shape.unknown_rank() ? -1 : shape.dim_size());
+    }
+    if (!IsVectorizable(*function, arg_ranks)) continue;
+
+    NodeDef* new_batch = graph.AddNode(
+        MakeBatchNode(batch_node, *map_node, *input_node, &graph));
+    NodeDef* new_map = graph.AddNode(
+        MakeMapNode(*map_node, batch_node, *new_batch, &graph));
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(batch_node.name(), new_map->name()));
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -15,12 +15,20 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer.h"
 
+#include <algorithm>
+#include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
@@ -28,8 +36,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer.h"
 #include "tensorflow/core/grappler/optimizers/generic_layout_optimizer_transposer_factory.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -38,8 +48,11 @@ namespace {
 
 constexpr char kNHWC[] = "NHWC";
 constexpr char kNCHW[] = "NCHW";
+constexpr char kOpTranspose[] = "Transpose";
 constexpr float kGPURatioThreshold = 0.5;
 constexpr float kConvGPUExpectedDtypeThreshold = 0.5;
+// Maximum depth of nested function calls whose bodies are specialized.
+constexpr int kMaxFunctionSpecializationDepth = 4;
 
 struct MutableNodeViewFormatter {
   void operator()(std::string* out, utils::MutableNodeView* node_view) const {
@@ -437,6 +450,410 @@ Status EraseCancellableNodesAroundPad(TransposeContext* context) {
   return mutation->Apply();
 }
 
+Status ConvertLayout(TransposeContext* context, const Cluster* cluster,
+                     bool is_aggressive, int depth);
+
+// Returns true iff `node` is a Transpose added by the layout optimizer with the
+// constant permutation `permutation`.
+bool IsAddedTransposeWithPermutation(const TransposeContext& context,
+                                     const utils::MutableNodeView& node,
+                                     absl::Span<const int> permutation) {
+  if (node.node_index() < context.num_nodes) {
+    return false;
+  }
+  Tensor tensor;
+  if (!GetValueAttrFromConstInputNode(node, IsTranspose, 1, &tensor) ||
+      tensor.NumElements() != permutation.size()) {
+    return false;
+  }
+  const auto& tensor_data = tensor.unaligned_flat<int32>();
+  for (int i = 0, end = permutation.size(); i < end; ++i) {
+    if (tensor_data(i) != permutation[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the attributes holding the functions called by `node`, and the index
+// of the input of `node` passed to the first argument of the functions, if
+// `node` is a function call or a functional control flow node.
+bool GetCalledFunctions(const NodeDef& node, std::vector<string>* func_attrs,
+                        int* input_offset) {
+  *input_offset = 0;
+  if (IsPartitionedCall(node) || IsStatefulPartitionedCall(node)) {
+    *func_attrs = {"f"};
+  } else if (IsIf(node)) {
+    *func_attrs = {"then_branch", "else_branch"};
+    *input_offset = 1;
+  } else if (IsWhile(node)) {
+    *func_attrs = {"body"};
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// A function body converted to the destination format, with the arguments and
+// results through which the destination format can cross the function
+// boundary.
+struct ConvertedFunctionBody {
+  GrapplerFunctionItem item;
+  TransposeContext context;
+  // Node index of the arguments only consumed by Transposes to the destination
+  // format, by argument index.
+  absl::flat_hash_map<int, int> args;
+  // Node index of the results only produced by Transposes from the destination
+  // format, by result index.
+  absl::flat_hash_map<int, int> rets;
+};
+
+// Returns the indices which are keys of all the maps, in increasing order.
+std::vector<int> CommonIndices(
+    const std::vector<const absl::flat_hash_map<int, int>*>& maps) {
+  std::vector<int> indices;
+  if (maps.empty()) return indices;
+  for (const auto& it : *maps.front()) {
+    bool common = true;
+    for (const auto* map : maps) common &= map->contains(it.first);
+    if (common) indices.push_back(it.first);
+  }
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+// Returns true iff the `index`th argument of `func` has no data fanouts.
+bool IsArgumentUnused(const FunctionDef& func, int index) {
+  if (index >= func.signature().input_arg_size()) return false;
+  const string& arg_name = func.signature().input_arg(index).name();
+  for (const NodeDef& node : func.node_def()) {
+    for (const string& input : node.input()) {
+      if (!IsControlInput(input) && ParseTensorName(input).node() == arg_name) {
+        return false;
+      }
+    }
+  }
+  for (const auto& ret : func.ret()) {
+    if (ParseTensorName(ret.second).node() == arg_name) return false;
+  }
+  return true;
+}
+
+// Converts the layout of the tensors passed to and returned from function calls
+// and functional control flow. The called functions are specialized for the
+// destination format: their bodies are converted like the graph, and the
+// Transposes next to their arguments and results are moved to the caller, so
+// that they cancel out with the Transposes of the caller or of other calls.
+class FunctionBoundaryTransposer : public Transposer {
+ public:
+  FunctionBoundaryTransposer(const Cluster* cluster, bool is_aggressive,
+                             int depth)
+      : cluster_(cluster), is_aggressive_(is_aggressive), depth_(depth) {}
+
+  Status TransposeNode(TransposeContext* context,
+                       utils::MutableNodeView* node) override;
+
+ private:
+  Status ConvertFunctionBody(TransposeContext* context,
+                             const utils::MutableNodeView& node,
+                             const NameAttrList& func, int input_offset,
+                             std::unique_ptr<ConvertedFunctionBody>* body);
+  Status SpecializeFunction(TransposeContext* context,
+                            const std::vector<int>& args,
+                            const std::vector<int>& rets,
+                            ConvertedFunctionBody* body, NameAttrList* func);
+
+  const Cluster* cluster_;
+  const bool is_aggressive_;
+  const int depth_;
+};
+
+Status FunctionBoundaryTransposer::ConvertFunctionBody(
+    TransposeContext* context, const utils::MutableNodeView& node,
+    const NameAttrList& func, int input_offset,
+    std::unique_ptr<ConvertedFunctionBody>* body) {
+  const FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                       context->graph.library());
+  const FunctionDef* func_def = flib.Find(func.name());
+  if (func_def == nullptr) {
+    return OkStatus();
+  }
+  auto converted = std::make_unique<ConvertedFunctionBody>();
+  TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
+      *func_def, AttrSlice(&func.attr()), flib,
+      context->graph.versions().producer(), &converted->item));
+
+  // The nodes of the body run on the device of the caller unless placed
+  // elsewhere, and the shapes of the arguments are the shapes of the inputs.
+  const string& device = GetDeviceName(*node.node());
+  DeviceNameUtils::ParsedName parsed_device;
+  if (!DeviceNameUtils::ParseFullName(device, &parsed_device) ||
+      !parsed_device.has_type) {
+    return OkStatus();
+  }
+  const DeviceType device_type(parsed_device.type);
+  const auto& input_properties =
+      context->graph_properties->GetInputProperties(node.GetName());
+  for (NodeDef& body_node : *converted->item.graph.mutable_node()) {
+    if (body_node.device().empty() &&
+        KernelDefAvailable(device_type, body_node)) {
+      body_node.set_device(device);
+    }
+    const auto index = body_node.attr().find("index");
+    if (!IsArg(body_node) || index == body_node.attr().end()) continue;
+    const int port = index->second.i() + input_offset;
+    if (port < input_properties.size()) {
+      AttrValue output_shape;
+      *output_shape.mutable_list()->add_shape() =
+          input_properties[port].shape();
+      (*body_node.mutable_attr())[kAttrOutputShape] = output_shape;
+    }
+  }
+
+  TransposeContext* body_context = &converted->context;
+  body_context->enforced_layout = context->enforced_layout;
+  TF_RETURN_IF_ERROR(TransposeContext::InitializeTransposeContext(
+      is_aggressive_, converted->item, cluster_, body_context));
+  body_context->AssignDeviceAndDataFormats(
+      context->target_device, context->src_format, context->dst_format);
+  TF_RETURN_IF_ERROR(
+      ConvertLayout(body_context, cluster_, is_aggressive_, depth_ + 1));
+
+  utils::MutableGraphView* graph_view = body_context->graph_view.get();
+  for (int i = 0; i < graph_view->NumNodes(); ++i) {
+    auto* body_node = graph_view->GetNode(i);
+    const auto* index = body_node->GetAttr("index");
+    if (index == nullptr) continue;
+    if (IsArg(*body_node->node())) {
+      const auto& fanouts = body_node->GetRegularFanout(0);
+      bool only_transposed = !fanouts.empty();
+      for (const auto& fanout : fanouts) {
+        const auto* transpose = fanout.node_view();
+        only_transposed &= fanout.index() == 0 &&
+                           transpose->NumControlledFanouts() == 0 &&
+                           IsAddedTransposeWithPermutation(
+                               *body_context, *transpose,
+                               body_context->src_to_dst);
+      }
+      if (only_transposed) converted->args[index->i()] = i;
+    } else if (IsRetval(*body_node->node()) &&
+               body_node->NumRegularFanins() == 1) {
+      const auto* transpose = body_node->GetRegularFanin(0).node_view();
+      if (IsAddedTransposeWithPermutation(*body_context, *transpose,
+                                          body_context->dst_to_src) &&
+          transpose->NumRegularFanouts() == 1 &&
+          transpose->NumControlledFanouts() == 0) {
+        converted->rets[index->i()] = i;
+      }
+    }
+  }
+  *body = std::move(converted);
+  return OkStatus();
+}
+
+Status FunctionBoundaryTransposer::SpecializeFunction(
+    TransposeContext* context, const std::vector<int>& args,
+    const std::vector<int>& rets, ConvertedFunctionBody* body,
+    NameAttrList* func) {
+  TransposeContext* body_context = &body->context;
+  utils::MutableGraphView* graph_view = body_context->graph_view.get();
+  utils::Mutation* mutation = graph_view->GetMutationBuilder();
+  const auto remove_transpose = [mutation](utils::MutableNodeView* transpose) {
+    mutation->RemoveNode(transpose);
+    mutation->RemoveNode(transpose->GetRegularFanin(1).node_view());
+  };
+  for (int index : args) {
+    auto* arg = graph_view->GetNode(body->args.at(index));
+    for (const auto& fanout : arg->GetRegularFanout(0)) {
+      auto* transpose = fanout.node_view();
+      for (const auto& transpose_fanout : transpose->GetRegularFanout(0)) {
+        mutation->AddOrUpdateRegularFanin(transpose_fanout.node_view(),
+                                          transpose_fanout.index(),
+                                          {arg->GetName(), 0});
+      }
+      remove_transpose(transpose);
+    }
+    const auto* output_shape = arg->GetAttr(kAttrOutputShape);
+    if (output_shape != nullptr && output_shape->list().shape_size() == 1 &&
+        !output_shape->list().shape(0).unknown_rank()) {
+      AttrValue permuted = *output_shape;
+      TF_RETURN_IF_ERROR(PermuteSingle(
+          absl::StrCat("output shape of ", arg->GetName()),
+          body_context->src_to_dst,
+          permuted.mutable_list()->mutable_shape(0)->mutable_dim()));
+      mutation->AddOrUpdateNodeAttr(arg, kAttrOutputShape, permuted);
+    }
+  }
+  for (int index : rets) {
+    auto* ret = graph_view->GetNode(body->rets.at(index));
+    auto* transpose = ret->GetRegularFanin(0).node_view();
+    const auto& transpose_fanin = transpose->GetRegularFanin(0);
+    mutation->AddOrUpdateRegularFanin(
+        ret, 0,
+        {transpose_fanin.node_view()->GetName(), transpose_fanin.index()});
+    remove_transpose(transpose);
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  // Add the specialized function, and the functions specialized for its body,
+  // to the library of the graph.
+  const FunctionLibraryDefinition body_flib(OpRegistry::Global(),
+                                            body_context->graph.library());
+  FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                 context->graph.library());
+  for (const FunctionDef& func_def : body_context->graph.library().function()) {
+    if (flib.Find(func_def.signature().name()) == nullptr) {
+      TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      *context->graph.mutable_library()->add_function() = func_def;
+    }
+  }
+  const string name_prefix =
+      absl::StrCat(func->name(), "_", context->dst_format);
+  body->item.id = name_prefix;
+  body->item.SwapFunctionBody(std::move(body_context->graph));
+  FunctionDef specialized;
+  TF_RETURN_IF_ERROR(MakeFunctionDef(body->item, body_flib, &specialized));
+  // The shapes of the arguments recorded by the function no longer hold.
+  for (int index : args) {
+    auto arg_attr = specialized.mutable_arg_attr()->find(index);
+    if (arg_attr != specialized.mutable_arg_attr()->end()) {
+      arg_attr->second.mutable_attr()->erase(kAttrOutputShape);
+    }
+  }
+  // Calls of the same function are specialized in the same way, unless their
+  // inputs have different shapes, and then share the specialized function.
+  string name = name_prefix;
+  for (int i = 1;; ++i) {
+    specialized.mutable_signature()->set_name(name);
+    const FunctionDef* existing = flib.Find(name);
+    if (existing == nullptr) {
+      *context->graph.mutable_library()->add_function() =
+          std::move(specialized);
+      break;
+    }
+    if (FunctionDefsEqual(*existing, specialized)) {
+      break;
+    }
+    name = absl::StrCat(name_prefix, "_", i);
+  }
+  func->set_name(name);
+  func->clear_attr();
+  return OkStatus();
+}
+
+Status FunctionBoundaryTransposer::TransposeNode(TransposeContext* context,
+                                                utils::MutableNodeView* node) {
+  std::vector<string> func_attrs;
+  int input_offset;
+  if (!GetCalledFunctions(*node->node(), &func_attrs, &input_offset) ||
+      !ShouldProcess(*context, *node)) {
+    return OkStatus();
+  }
+  std::vector<NameAttrList> funcs;
+  std::vector<std::unique_ptr<ConvertedFunctionBody>> bodies;
+  for (const string& func_attr : func_attrs) {
+    const auto* attr = node->GetAttr(func_attr);
+    if (attr == nullptr || !attr->has_func()) {
+      return OkStatus();
+    }
+    funcs.push_back(attr->func());
+    bodies.emplace_back();
+    TF_RETURN_IF_ERROR(ConvertFunctionBody(context, *node, funcs.back(),
+                                           input_offset, &bodies.back()));
+    if (bodies.back() == nullptr) {
+      return OkStatus();
+    }
+  }
+
+  // All the branches of an If must agree on the format of their arguments and
+  // results, and the body of a While must return its loop variables in the
+  // format it takes them.
+  std::vector<const absl::flat_hash_map<int, int>*> args_maps;
+  std::vector<const absl::flat_hash_map<int, int>*> rets_maps;
+  for (const auto& body : bodies) {
+    args_maps.push_back(&body->args);
+    rets_maps.push_back(&body->rets);
+  }
+  std::vector<int> args;
+  std::vector<int> rets;
+  if (IsWhile(*node->node())) {
+    args_maps.push_back(&bodies.front()->rets);
+    args = CommonIndices(args_maps);
+    // The condition is not specialized, so it must not read the loop
+    // variables whose format changes.
+    const auto* cond = node->GetAttr("cond");
+    const FunctionDef* cond_def =
+        cond == nullptr ? nullptr
+                        : FunctionLibraryDefinition(OpRegistry::Global(),
+                                                    context->graph.library())
+                              .Find(cond->func().name());
+    if (cond_def == nullptr) {
+      return OkStatus();
+    }
+    args.erase(std::remove_if(args.begin(), args.end(),
+                              [cond_def](int index) {
+                                return !IsArgumentUnused(*cond_def, index);
+                              }),
+               args.end());
+    rets = args;
+  } else {
+    args = CommonIndices(args_maps);
+    rets = CommonIndices(rets_maps);
+  }
+  if (args.empty() && rets.empty()) {
+    return OkStatus();
+  }
+
+  VLOG(3) << "GenericLayoutOptimizer: specializing functions called by '"
+          << node->GetName() << "' with op '" << node->GetOp()
+          << "' for data format '" << context->dst_format << "'";
+  utils::Mutation* mutation = context->graph_view->GetMutationBuilder();
+  for (int i = 0; i < funcs.size(); ++i) {
+    TF_RETURN_IF_ERROR(
+        SpecializeFunction(context, args, rets, bodies[i].get(), &funcs[i]));
+    AttrValue func_attr;
+    *func_attr.mutable_func() = funcs[i];
+    mutation->AddOrUpdateNodeAttr(node, func_attrs[i], func_attr);
+  }
+  // Functional control flow records the shapes of its results.
+  const auto* output_shapes = node->GetAttr("output_shapes");
+  if (output_shapes != nullptr) {
+    AttrValue permuted = *output_shapes;
+    for (int index : rets) {
+      if (index >= permuted.list().shape_size()) continue;
+      auto* shape = permuted.mutable_list()->mutable_shape(index);
+      if (shape->unknown_rank()) continue;
+      TF_RETURN_IF_ERROR(PermuteSingle(
+          absl::StrCat("output shapes of ", node->GetName()),
+          context->src_to_dst, shape->mutable_dim()));
+    }
+    mutation->AddOrUpdateNodeAttr(node, "output_shapes", permuted);
+  }
+  std::vector<int> input_ports;
+  for (int index : args) input_ports.push_back(index + input_offset);
+  TF_RETURN_IF_ERROR(
+      UpdateFaninEdgesWithOp(context, input_ports, node, kOpTranspose));
+  TF_RETURN_IF_ERROR(
+      UpdateFanoutEdgesWithOp(context, rets, node, kOpTranspose));
+  return mutation->Apply();
+}
+
+Status ExpandFunctionBoundaries(TransposeContext* context,
+                                const Cluster* cluster, bool is_aggressive,
+                                int depth) {
+  if (depth >= kMaxFunctionSpecializationDepth ||
+      context->graph.library().function_size() == 0) {
+    return OkStatus();
+  }
+  FunctionBoundaryTransposer transposer(cluster, is_aggressive, depth);
+  const int num_nodes = context->num_nodes;
+  for (int i = 0; i < num_nodes; ++i) {
+    TF_RETURN_IF_ERROR(
+        transposer.TransposeNode(context, context->graph_view->GetNode(i)));
+  }
+  return OkStatus();
+}
+
 Status EraseOutputShapeAttrs(TransposeContext* context) {
   utils::MutableGraphView* graph_view = context->graph_view.get();
   utils::Mutation* mutation = graph_view->GetMutationBuilder();
@@ -452,6 +869,26 @@ Status EraseOutputShapeAttrs(TransposeContext* context) {
   return OkStatus();
 }
 
+// Converts the graph of `context`, or the body of a function called `depth`
+// calls deep, to the destination format.
+Status ConvertLayout(TransposeContext* context, const Cluster* cluster,
+                     bool is_aggressive, int depth) {
+  TransposerFactory transposer_factory;
+  TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(context, &transposer_factory));
+  TF_RETURN_IF_ERROR(
+      ExpandFunctionBoundaries(context, cluster, is_aggressive, depth));
+  if (context->graph.node_size() > context->num_nodes || is_aggressive) {
+    TF_RETURN_IF_ERROR(ExpandLayoutAgnosticOp(context, &transposer_factory));
+    TF_RETURN_IF_ERROR(EraseCancellableNodes(context));
+    TF_RETURN_IF_ERROR(EraseCancellableNodesAroundPad(context));
+    // TODO(lyandy): Remove sorting once other optimizers are migrated to using
+    // `utils::GraphView`.
+    TF_RETURN_IF_ERROR(
+        context->graph_view->SortTopologically(/*ignore_cycles=*/false, {}));
+  }
+  return EraseOutputShapeAttrs(context);
+}
+
 }  // namespace
 
 // When there is a GPU, the computation graph is converted to NCHW format.
@@ -507,18 +944,8 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
     }
   }
 
-  TransposerFactory transposer_factory;
-  TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(&context, &transposer_factory));
-  if (context.graph.node_size() > context.num_nodes || is_aggressive) {
-    TF_RETURN_IF_ERROR(ExpandLayoutAgnosticOp(&context, &transposer_factory));
-    TF_RETURN_IF_ERROR(EraseCancellableNodes(&context));
-    TF_RETURN_IF_ERROR(EraseCancellableNodesAroundPad(&context));
-    // TODO(lyandy): Remove sorting once other optimizers are migrated to using
-    // `utils::GraphView`.
-    TF_RETURN_IF_ERROR(
-        context.graph_view->SortTopologically(/*ignore_cycles=*/false, {}));
-  }
-  TF_RETURN_IF_ERROR(EraseOutputShapeAttrs(&context));
+  TF_RETURN_IF_ERROR(
+      ConvertLayout(&context, cluster, is_aggressive, /*depth=*/0));
 
   *output = context.graph;
   return OkStatus();
@@ -24,7 +24,9 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-// Optimize the data layout for convolutional models.
+// Optimize the data layout for convolutional models. Layouts are propagated
+// through function calls and functional control flow, whose functions are
+// specialized for the converted data format.
 class GenericLayoutOptimizer : public GraphOptimizer {
  public:
   explicit GenericLayoutOptimizer(string enforced_layout = "")
@@ -45,7 +47,9 @@ class GenericLayoutOptimizer : public GraphOptimizer {
 
   string name() const override { return "layout"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  // The functions called by the graph are specialized for the converted data
+  // format.
+  bool UsesFunctionLibrary() const override { return true; }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* output) override;
@@ -775,6 +775,97 @@ TEST_F(GenericLayoutOptimizerTest, OptimizeSimpleConv3DGraph_CPU) {
 #endif
 }
 
+TEST_F(GenericLayoutOptimizerTest, CancelTransposesAcrossFunctionCalls) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // Two calls of a function with a Conv2D node, which only run in the
+  // destination format without transposes between them.
+  const string device = "/device:" DEVICE ":0";
+  FunctionDef conv_func = FDH::Create(
+      "Conv", {"x: float", "filter: float"}, {"y: float"}, {},
+      {{{"conv"},
+        "Conv2D",
+        {"x", "filter"},
+        {{"T", DT_FLOAT},
+         {"strides", std::vector<int32>{1, 1, 1, 1}},
+         {"padding", "SAME"},
+         {"data_format", SRC_DATA_FORMAT}}}},
+      {{"y", "conv:output:0"}});
+  const auto call_attrs = [](absl::string_view func) {
+    return std::vector<std::pair<string, FDH::AttrValueWrapper>>{
+        {"Tin", DataTypeSlice{DT_FLOAT, DT_FLOAT}},
+        {"Tout", DataTypeSlice{DT_FLOAT}},
+        {"f", FDH::FunctionRef(string(func), {})}};
+  };
+  const Tensor input = GenerateRandomTensor<DT_FLOAT>(DIMS(8, 5, 5, 3));
+  const Tensor filter = GenerateRandomTensor<DT_FLOAT>({3, 3, 3, 3});
+
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("input", "Const", {}, {{"dtype", DT_FLOAT}, {"value", input}},
+            device),
+       NDef("filter", "Const", {}, {{"dtype", DT_FLOAT}, {"value", filter}},
+            device),
+       NDef("call_1", "PartitionedCall", {"input", "filter"},
+            call_attrs("Conv"), device),
+       NDef("call_2", "PartitionedCall", {"call_1", "filter"},
+            call_attrs("Conv"), device),
+       NDef("output", "Identity", {"call_2"}, {{"T", DT_FLOAT}}, device)},
+      {conv_func});
+  item.fetch = {"output"};
+
+  GenericLayoutOptimizer optimizer(REWRITER_CONFIG);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+
+  // Both calls share the specialized function.
+  auto* call_1 = graph_view.GetNode("call_1");
+  ASSERT_NE(call_1, nullptr);
+  const string& specialized = call_1->GetAttr("f")->func().name();
+  EXPECT_EQ(specialized, "Conv_" DST_DATA_FORMAT);
+  auto* call_2 = graph_view.GetNode("call_2");
+  ASSERT_NE(call_2, nullptr);
+  EXPECT_EQ(call_2->GetAttr("f")->func().name(), specialized);
+
+  // The input is transposed once before the first call, the result once after
+  // the second call, and not in between.
+  ASSERT_EQ(call_1->NumRegularFanins(), 2);
+  const auto* input_transpose = call_1->GetRegularFanin(0).node_view();
+  EXPECT_EQ(input_transpose->GetOp(), "Transpose");
+  VerifyRegularFaninMatch(input_transpose, 0, "input", 0);
+  VerifyRegularFaninMatch(call_1, 1, "filter", 0);
+  ASSERT_EQ(call_2->NumRegularFanins(), 2);
+  VerifyRegularFaninMatch(call_2, 0, "call_1", 0);
+  auto* output_node = graph_view.GetNode("output");
+  ASSERT_NE(output_node, nullptr);
+  ASSERT_EQ(output_node->NumRegularFanins(), 1);
+  const auto* output_transpose = output_node->GetRegularFanin(0).node_view();
+  EXPECT_EQ(output_transpose->GetOp(), "Transpose");
+  VerifyRegularFaninMatch(output_transpose, 0, "call_2", 0);
+
+  // The specialized function runs the Conv2D node in the destination format
+  // without transposes.
+  const FunctionDef* func = nullptr;
+  for (const FunctionDef& library_func : output.library().function()) {
+    if (library_func.signature().name() == specialized) func = &library_func;
+  }
+  ASSERT_NE(func, nullptr);
+  int num_conv = 0;
+  for (const NodeDef& node : func->node_def()) {
+    EXPECT_NE(node.op(), "Transpose");
+    if (node.op() == "Conv2D") {
+      EXPECT_EQ(node.attr().at("data_format").s(), DST_DATA_FORMAT);
+      ++num_conv;
+    }
+  }
+  EXPECT_EQ(num_conv, 1);
+}
+
 // TODO(yanzha): Add more complex Graph for test.
 
 }  // namespace grappler
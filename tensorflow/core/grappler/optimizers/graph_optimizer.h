@@ -65,6 +65,10 @@ class GraphOptimizer {
     return Optimize(cluster, item, optimized_graph);
   }
 
+  // Returns a summary of the decisions taken by the last call to Optimize,
+  // which is reported along with the optimizer results, or an empty string.
+  virtual string GetResultSummary() const { return ""; }
+
   // Set deadline in microseconds since epoch. A value of zero means no
   // deadline.
   void set_deadline_usec(uint64 deadline_usec) {
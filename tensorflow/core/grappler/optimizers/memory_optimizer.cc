@@ -16,12 +16,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <map>
 #include <queue>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op.h"
@@ -35,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
 #include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/rematerialization_planner.h"
 #include "tensorflow/core/grappler/optimizers/static_schedule.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
@@ -1146,6 +1149,216 @@ static bool IdentifySwappingCandidates(
   return updated_graph;
 }
 
+// Plans, for each device whose estimated peak memory is over the budget, the
+// tensors live at the peak to recompute or swap out which add the least time
+// to the step, and applies the plans: recomputed nodes are copied like in the
+// recomputation pass, and swapped tensors are annotated for the swapping pass.
+bool RematerializationPass(Cluster* cluster, int64_t peak_memory_budget,
+                           GrapplerItem* item,
+                           std::vector<RematerializationPlan>* plans) {
+  // The topological numbering is needed to recompute nodes, and must be
+  // computed before collecting NodeDef pointers.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+  GraphMemory memory(*item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.message();
+    return false;
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
+  std::unordered_map<string, Costs::NanoSeconds> op_run_times;
+  {
+    VirtualCluster vcluster(cluster->GetDevices());
+    if (!vcluster.Provision().ok()) {
+      return false;
+    }
+    if (!vcluster.Initialize(*item).ok()) {
+      return false;
+    }
+    RunMetadata metadata;
+    s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
+    if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+      return false;
+    }
+    for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+      for (const auto& node_stats : dev_stats.node_stats()) {
+        op_completion_times.emplace(
+            node_stats.node_name(),
+            Costs::NanoSeconds(1) +
+                Costs::MicroSeconds(node_stats.all_start_micros() +
+                                    node_stats.op_end_rel_micros()));
+        op_run_times.emplace(
+            node_stats.node_name(),
+            Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                                node_stats.op_start_rel_micros()));
+      }
+    }
+  }
+
+  // Fed nodes can't be recomputed, since the recomputed node would not take on
+  // the fed value, and the preserved ones must be kept as they are.
+  std::unordered_set<string> nodes_to_keep = item->NodesToPreserve();
+  for (const auto& feed : item->feed) {
+    nodes_to_keep.insert(NodeName(feed.first));
+  }
+
+  MutableGraphView graph(&item->graph);
+  std::unordered_map<string, std::vector<MutableGraphView::InputPort>>
+      late_uses;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    const int64_t budget =
+        peak_memory_budget > 0 ? peak_memory_budget : prop.memory_size();
+    if (budget <= 0) {
+      VLOG(1) << "Peak memory budget unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+
+    Costs::Duration peak_time = -1;
+    std::unordered_set<string> live_tensors;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+      live_tensors.insert(
+          strings::StrCat(live_tensor.node, ":", live_tensor.output_id));
+    }
+
+    std::vector<RematerializationCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      if (nodes_to_keep.find(live_tensor.node) != nodes_to_keep.end()) {
+        continue;
+      }
+      MutableGraphView::OutputPort port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (port.node == nullptr) {
+        continue;
+      }
+
+      // Only the uses after the peak read the rematerialized tensor.
+      std::vector<MutableGraphView::InputPort> uses_left;
+      Costs::Duration earliest_use(Costs::Duration::infinity());
+      bool valid = true;
+      for (MutableGraphView::InputPort input : graph.GetFanout(port)) {
+        auto it = op_completion_times.find(input.node->name());
+        if (it == op_completion_times.end()) {
+          valid = false;
+          break;
+        }
+        if (it->second <= peak_time) {
+          continue;
+        }
+        uses_left.push_back(input);
+        earliest_use = std::min(earliest_use, it->second);
+      }
+      if (!valid || uses_left.empty()) {
+        continue;
+      }
+
+      RematerializationCandidate candidate;
+      candidate.node = live_tensor.node;
+      candidate.output_id = live_tensor.output_id;
+      candidate.bytes = live_tensor.memory_used;
+      candidate.time_to_next_use_ns = (earliest_use - peak_time).count();
+
+      candidate.can_swap = prop.type() == "GPU" && IsSwappable(graph, port);
+      for (const MutableGraphView::InputPort& input : uses_left) {
+        candidate.can_swap &= IsSwappable(input);
+      }
+      // Let's assume we're going to swap over PCIe running at 16 GBps.
+      candidate.swap_time_ns = candidate.bytes / 16;
+
+      // The recomputed node reads the same inputs, which must still be in
+      // memory at the time of the late uses.
+      const NodeDef& producer = *port.node;
+      auto run_time = op_run_times.find(producer.name());
+      candidate.can_recompute = run_time != op_run_times.end() &&
+                                IsFreeOfSideEffect(producer) &&
+                                !IsPersistent(producer) &&
+                                !IsControlFlow(producer);
+      // The late uses are rewired by node name, so they must read the first
+      // output.
+      for (const MutableGraphView::InputPort& input : uses_left) {
+        candidate.can_recompute &=
+            input.node->input(input.port_id) == producer.name();
+      }
+      for (const string& input : producer.input()) {
+        if (!candidate.can_recompute || IsControlInput(input)) break;
+        const TensorId tensor = ParseTensorName(input);
+        const string tensor_name =
+            strings::StrCat(tensor.node(), ":", tensor.index());
+        const NodeDef* fanin = graph.GetNode(tensor.node());
+        if (live_tensors.find(tensor_name) != live_tensors.end()) {
+          candidate.recompute_inputs.push_back(tensor_name);
+        } else if (fanin == nullptr || !IsPersistent(*fanin)) {
+          candidate.can_recompute = false;
+        }
+      }
+      if (candidate.can_recompute) {
+        candidate.recompute_time_ns = run_time->second.count();
+      }
+
+      if (candidate.can_swap || candidate.can_recompute) {
+        late_uses[strings::StrCat(candidate.node, ":", candidate.output_id)] =
+            std::move(uses_left);
+        candidates.push_back(std::move(candidate));
+      }
+    }
+
+    plans->push_back(PlanRematerialization(name, mem_usage.used_memory, budget,
+                                           candidates));
+    VLOG(1) << plans->back().ToString();
+  }
+
+  // Recompute each node once for all its rematerialized outputs.
+  std::map<string, std::unordered_set<NodeDef*>> nodes_to_recompute;
+  bool updated_graph = false;
+  for (const RematerializationPlan& plan : *plans) {
+    for (const RematerializationPlan::Decision& decision : plan.decisions) {
+      const std::vector<MutableGraphView::InputPort>& uses = late_uses.at(
+          strings::StrCat(decision.node, ":", decision.output_id));
+      for (const MutableGraphView::InputPort& input : uses) {
+        if (decision.action == RematerializationPlan::Action::kRecompute) {
+          nodes_to_recompute[decision.node].insert(input.node);
+          continue;
+        }
+        AttrValue& swap_to_host =
+            (*input.node->mutable_attr())["_swap_to_host"];
+        if (swap_to_host.value_case() == AttrValue::kI) {
+          const int64_t input_id = swap_to_host.i();
+          swap_to_host.mutable_list()->add_i(input_id);
+        }
+        swap_to_host.mutable_list()->add_i(input.port_id);
+      }
+      updated_graph = true;
+    }
+  }
+  if (!nodes_to_recompute.empty()) {
+    NodeMap node_map(&item->graph);
+    std::unordered_map<const NodeDef*, int> topological_numbering;
+    for (int node_number = 0; node_number < item->graph.node().size();
+         ++node_number) {
+      topological_numbering[item->graph.mutable_node(node_number)] =
+          item->graph.node().size() - node_number - 1;
+    }
+    for (const auto& recompute : nodes_to_recompute) {
+      RecomputeSubgraph({node_map.GetNode(recompute.first)}, recompute.second,
+                        node_map, topological_numbering, &item->graph);
+    }
+  }
+  return updated_graph;
+}
+
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
                   Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
                   GrapplerItem* item, std::unordered_set<string>* skip_list) {
@@ -1380,6 +1593,7 @@ Status FindAssignNodesToRelax(const GraphDef& graph,
 
 Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                  GraphDef* optimized_graph) {
+  result_summary_.clear();
   std::set<int> nodes_to_relax;
   TF_RETURN_IF_ERROR(FindAssignNodesToRelax(item.graph, &nodes_to_relax));
 
@@ -1407,6 +1621,15 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   // infer the memory usage, so skip optimization if there are no fetches.
   std::unique_ptr<GraphMemory> memory;
   if (!item.fetch.empty() && cluster != nullptr) {
+    if (optimization_level_ == RewriterConfig::BUDGETED_REMATERIALIZATION) {
+      std::vector<RematerializationPlan> plans;
+      RematerializationPass(cluster, peak_memory_budget_, &optimized_item,
+                            &plans);
+      result_summary_ = absl::StrJoin(
+          plans, " | ", [](string* out, const RematerializationPlan& plan) {
+            absl::StrAppend(out, plan.ToString());
+          });
+    }
     bool updated_graph = true;
     for (int i = 0; i < 25 && updated_graph; ++i) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1426,7 +1649,9 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ ==
+               RewriterConfig::BUDGETED_REMATERIALIZATION) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
@@ -49,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/implementation_selector.h"
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
@@ -61,9 +63,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
 
@@ -97,6 +103,18 @@ string PrintSizesBeforeAfter(const GraphDef& before, const GraphDef& after) {
                          NumEdges(after) - NumEdges(before), ")");
 }
 
+// Returns the number of threads optimizing the functions of a library, which is
+// set by TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS. Clusters other than the
+// virtual one may run graphs, so their functions are optimized sequentially.
+int NumFunctionOptimizationThreads(const Cluster* cluster) {
+  if (cluster != nullptr && cluster->type() != "virtual") return 1;
+  int64_t num_threads;
+  Status s = ReadInt64FromEnvVar("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS", 1,
+                                 &num_threads);
+  if (!s.ok()) LOG(ERROR) << s;
+  return std::min<int64_t>(num_threads, port::MaxParallelism());
+}
+
 int NumIterations(const RewriterConfig& cfg) {
   return cfg.meta_optimizer_iterations() == RewriterConfig::DEFAULT_NUM_ITERS
              ? kDefaultNumberOfIterations
@@ -218,28 +236,38 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
          new ConstantFolding(
              cpu_device_,
              cfg_.experimental_disable_compressed_tensor_optimization(),
-             !cfg_.experimental_disable_folding_quantization_emulation()));
+             !cfg_.experimental_disable_folding_quantization_emulation(),
+             cfg_.constant_folding_cache_dir()));
   MK_OPT("shape", "shape_optimization", new ShapeOptimizer());
   MK_OPT("remap", "remapping",
          new Remapper(cfg_.remapping(), cfg_.cpu_layout_conversion(),
-                      xla_auto_clustering_on_));
+                      xla_auto_clustering_on_, cfg_.remapping_cost_guard(),
+                      cfg_.remapping_measured_costs_path()));
   MK_OPT("layout", "layout_optimizer",
          new GenericLayoutOptimizer(
              /*optimization level*/ cfg_.layout_optimizer(),
              /*CPU layout conversion*/ cfg_.cpu_layout_conversion()));
   MK_OPT("auto_mixed_precision", "auto_mixed_precision",
-         new AutoMixedPrecision(AutoMixedPrecisionMode::CUDA));
+         new AutoMixedPrecision(
+             AutoMixedPrecisionMode::CUDA,
+             cfg_.auto_mixed_precision_measured_costs_path()));
 #ifdef INTEL_MKL
   if (IsMKLEnabled()) {
     MK_OPT("auto_mixed_precision_mkl", "auto_mixed_precision_mkl",
-           new AutoMixedPrecision(AutoMixedPrecisionMode::BF16));
+           new AutoMixedPrecision(
+               AutoMixedPrecisionMode::BF16,
+               cfg_.auto_mixed_precision_measured_costs_path()));
     MK_OPT("auto_mixed_precision_onednn_bfloat16",
            "auto_mixed_precision_onednn_bfloat16",
-           new AutoMixedPrecision(AutoMixedPrecisionMode::BF16));
+           new AutoMixedPrecision(
+               AutoMixedPrecisionMode::BF16,
+               cfg_.auto_mixed_precision_measured_costs_path()));
   }
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
-         new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
+         new AutoMixedPrecision(
+             AutoMixedPrecisionMode::CPU,
+             cfg_.auto_mixed_precision_measured_costs_path()));
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -247,7 +275,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("arithmetic", "arithmetic_optimization",
          new ArithmeticOptimizer(cfg_.arithmetic_optimization()));
   MK_OPT("autoparallel", "auto_parallel",
-         new AutoParallel(cfg_.auto_parallel().num_replicas()));
+         new AutoParallel(cfg_.auto_parallel().num_replicas(),
+                          cfg_.auto_parallel().num_pipeline_stages()));
   MK_OPT("loop", "loop_optimization",
          new LoopOptimizer(cfg_.loop_optimization(), cpu_device_));
   MK_OPT("dependency", "dependency_optimization",
@@ -361,7 +390,8 @@ Status MetaOptimizer::InitializeOptimizers(
       optimizers->push_back(std::make_unique<ConstantFolding>(
           cfg_.constant_folding(), cpu_device_,
           cfg_.experimental_disable_compressed_tensor_optimization(),
-          !cfg_.experimental_disable_folding_quantization_emulation()));
+          !cfg_.experimental_disable_folding_quantization_emulation(),
+          cfg_.constant_folding_cache_dir()));
     }
   }
   if (BOTH_NOT_OFF(shape_optimization)) {
@@ -374,8 +404,9 @@ Status MetaOptimizer::InitializeOptimizers(
   if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision()) &&
       AutoMixedPrecisionEnabled(
           plugin_configs.toggle_config["auto_mixed_precision"])) {
-    optimizers->push_back(
-        std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::CUDA));
+    optimizers->push_back(std::make_unique<AutoMixedPrecision>(
+        AutoMixedPrecisionMode::CUDA,
+        cfg_.auto_mixed_precision_measured_costs_path()));
   }
 #ifdef INTEL_MKL
   if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_onednn_bfloat16()) &&
@@ -383,8 +414,9 @@ Status MetaOptimizer::InitializeOptimizers(
           plugin_configs
               .toggle_config["auto_mixed_precision_onednn_bfloat16"]) &&
       IsMKLEnabled()) {
-    optimizers->push_back(
-        std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::BF16));
+    optimizers->push_back(std::make_unique<AutoMixedPrecision>(
+        AutoMixedPrecisionMode::BF16,
+        cfg_.auto_mixed_precision_measured_costs_path()));
   }
   if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_mkl()) &&
       AutoMixedPrecisionEnabled(
@@ -393,15 +425,17 @@ Status MetaOptimizer::InitializeOptimizers(
     LOG_FIRST_N(WARNING, 1)
         << "NOTE: auto_mixed_precision_mkl is deprecated."
            " Please use auto_mixed_precision_onednn_bfloat16 instead";
-    optimizers->push_back(
-        std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::BF16));
+    optimizers->push_back(std::make_unique<AutoMixedPrecision>(
+        AutoMixedPrecisionMode::BF16,
+        cfg_.auto_mixed_precision_measured_costs_path()));
   }
 #endif
   if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu()) &&
       AutoMixedPrecisionEnabled(
           plugin_configs.toggle_config["auto_mixed_precision_cpu"])) {
-    optimizers->push_back(
-        std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
+    optimizers->push_back(std::make_unique<AutoMixedPrecision>(
+        AutoMixedPrecisionMode::CPU,
+        cfg_.auto_mixed_precision_measured_costs_path()));
   }
   if (BOTH_ARE_ON(pin_to_host_optimization))
     optimizers->push_back(std::make_unique<PinToHostOptimizer>());
@@ -444,7 +478,8 @@ Status MetaOptimizer::InitializeOptimizers(
     if (enable_grappler_pass) {
       optimizers->push_back(std::make_unique<Remapper>(
           cfg_.remapping(), cfg_.cpu_layout_conversion(),
-          xla_auto_clustering_on_));
+          xla_auto_clustering_on_, cfg_.remapping_cost_guard(),
+          cfg_.remapping_measured_costs_path()));
     }
   }
   if (BOTH_NOT_OFF(loop_optimization)) {
@@ -469,18 +504,21 @@ Status MetaOptimizer::InitializeOptimizers(
                              xla_auto_clustering_on_) &&
       PLUGIN_NOT_OFF(memory_optimization)) {
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
+      optimizers->push_back(std::make_unique<MemoryOptimizer>(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          cfg_.memory_optimization(), "gradients/",
+          cfg_.memory_optimizer_peak_memory_budget()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_peak_memory_budget()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
-    optimizers->push_back(
-        std::make_unique<AutoParallel>(cfg_.auto_parallel().num_replicas()));
+    optimizers->push_back(std::make_unique<AutoParallel>(
+        cfg_.auto_parallel().num_replicas(),
+        cfg_.auto_parallel().num_pipeline_stages()));
   }
 
 #ifndef ENABLE_MKL
@@ -798,6 +836,9 @@ Status MetaOptimizer::OptimizeGraph(
   *optimized_graph = std::move(item.graph);
 
   GraphOptimizationResult optimization_result(item.id);
+  if (cfg_.incremental_shape_inference() == RewriterConfig::ON) {
+    item.properties_cache = std::make_shared<GraphPropertiesCache>();
+  }
 #ifndef ENABLE_MKL
   GraphOptimizer* sa_optimizer = nullptr;
 #endif
@@ -883,7 +924,10 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -964,6 +1008,8 @@ Status MetaOptimizer::RunOptimizer(
     message = strings::StrCat(
         PrintSizesBeforeAfter(optimized_item->graph, *optimized_graph),
         ", time = ", duration_ms, "ms.");
+    const string summary = optimizer->GetResultSummary();
+    if (!summary.empty()) strings::StrAppend(&message, " ", summary);
     VLOG(1) << optimizer->name() << ": " << message;
   }
 
@@ -1050,7 +1096,10 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       {kGrapplerCategory, "*"});
 
   VLOG(1) << "Starting optimization for grappler item: " << item.id;
-  optimization_results_.clear();
+  {
+    mutex_lock l(results_mu_);
+    optimization_results_.clear();
+  }
 
   // Constructs a FunctionLibraryDefinition with functions that are reachable
   // from the nodes of the graph.
@@ -1159,11 +1208,82 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Optimize function body graph.
+  const auto optimize_function = [&](const GrapplerFunctionItem& func_item,
+                                     GraphDef* optimized_func_graph) -> Status {
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      GrapplerFunctionItem func_item_stub = func_item;
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item_stub.graph.release_library());
+      *func_item_stub.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      return implementation_selector.Optimize(cluster, func_item_stub,
+                                              optimized_func_graph);
+    }
+    GrapplerFunctionItem func_item_copy = func_item;
+    return OptimizeGraph(cluster, std::move(func_item_copy),
+                         optimized_func_graph);
+  };
+
+  // Replaces a function with its optimized body.
+  const auto replace_function = [&](const string& func_name,
+                                    GrapplerFunctionItem* func_item,
+                                    GraphDef&& optimized_func_graph) -> Status {
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. Add them to the library.
+    for (const FunctionDef& func_def :
+         optimized_func_graph.library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef.
+    FunctionDef optimized_func;
+    func_item->SwapFunctionBody(std::move(optimized_func_graph));
+    TF_RETURN_IF_ERROR(MakeFunctionDef(*func_item, flib, &optimized_func));
+
+    // Replace optimized function with a new FunctionDef.
+    return flib.ReplaceFunction(func_name, optimized_func);
+  };
+
+  // With several threads, the functions of a pass are all made from the
+  // library at the start of the pass and optimized concurrently, so a function
+  // does not see the optimized bodies of the functions it calls. The optimized
+  // functions are added back to the library in library order, which keeps the
+  // result independent of the number of threads.
+  const int num_threads = NumFunctionOptimizationThreads(cluster);
+  std::unique_ptr<thread::ThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "grappler_function_optimization", num_threads);
+  }
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    // The functions of this pass, when they are optimized concurrently.
+    std::vector<string> func_names;
+    std::vector<GrapplerFunctionItem> func_items;
+
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1221,53 +1341,36 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
           false;
 
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
-      }
-
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
-        }
+      if (thread_pool != nullptr) {
+        func_names.push_back(func_name);
+        func_items.push_back(std::move(func_item));
+        continue;
       }
 
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
+      GraphDef optimized_func_graph;
+      TF_RETURN_IF_ERROR(optimize_function(func_item, &optimized_func_graph));
+      TF_RETURN_IF_ERROR(replace_function(func_name, &func_item,
+                                          std::move(optimized_func_graph)));
+    }
 
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
+    if (!func_items.empty()) {
+      std::vector<GraphDef> optimized_func_graphs(func_items.size());
+      std::vector<Status> statuses(func_items.size());
+      BlockingCounter counter(func_items.size());
+      for (int i = 0; i < func_items.size(); ++i) {
+        thread_pool->Schedule([&, i]() {
+          statuses[i] =
+              optimize_function(func_items[i], &optimized_func_graphs[i]);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+      for (int i = 0; i < func_items.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        TF_RETURN_IF_ERROR(
+            replace_function(func_names[i], &func_items[i],
+                             std::move(optimized_func_graphs[i])));
+      }
     }
 
     // If optimized at least one function, update the graph library.
@@ -1315,6 +1418,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
 }
 
 string MetaOptimizer::GetResultString() const {
+  tf_shared_lock l(results_mu_);
   std::string result_string;
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
     absl::StrAppend(&result_string,
@@ -1364,11 +1468,24 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph) {
+  // Identical items, e.g. retraced functions, reuse the graph optimized first.
+  MetaOptimizerCache* cache = MetaOptimizerCache::Global();
+  std::string cache_key;
+  if (cache != nullptr) {
+    cache_key = MetaOptimizerCache::Key(item, cfg, cluster);
+    if (cache->Lookup(cache_key, optimized_graph)) {
+      VLOG(1) << "Reusing the cached optimization of grappler item " << item.id;
+      return OkStatus();
+    }
+  }
+
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  TF_RETURN_IF_ERROR(optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                   optimized_graph));
+  if (cache != nullptr) cache->Insert(cache_key, *optimized_graph);
+  return OkStatus();
 }
 
 Status OptimizeGraph(
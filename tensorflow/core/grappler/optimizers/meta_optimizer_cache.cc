@@ -0,0 +1,219 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+void AppendSorted(const std::string& field, std::vector<std::string> values,
+                  std::string* out) {
+  std::sort(values.begin(), values.end());
+  for (const std::string& value : values) {
+    absl::StrAppend(out, field, "=", value, ";");
+  }
+}
+
+}  // namespace
+
+MetaOptimizerCache::MetaOptimizerCache(int64_t capacity, const std::string& dir,
+                                       Env* env)
+    : capacity_(capacity), dir_(dir), env_(env) {}
+
+/* static */
+MetaOptimizerCache* MetaOptimizerCache::Global() {
+  static MetaOptimizerCache* cache = []() -> MetaOptimizerCache* {
+    int64_t capacity;
+    Status s = ReadInt64FromEnvVar("TF_GRAPPLER_CACHE_CAPACITY", 0, &capacity);
+    if (!s.ok()) LOG(ERROR) << s;
+    std::string dir;
+    s = ReadStringFromEnvVar("TF_GRAPPLER_CACHE_DIR", "", &dir);
+    if (!s.ok()) LOG(ERROR) << s;
+    if (capacity <= 0 && dir.empty()) return nullptr;
+    if (!dir.empty()) {
+      s = Env::Default()->RecursivelyCreateDir(dir);
+      if (!s.ok() && !errors::IsAlreadyExists(s)) {
+        LOG(ERROR) << "Not using the Grappler cache directory " << dir << ": "
+                   << s;
+        if (capacity <= 0) return nullptr;
+        dir.clear();
+      }
+    }
+    VLOG(1) << "Caching Grappler results: capacity=" << capacity
+            << " dir=" << dir;
+    return new MetaOptimizerCache(capacity, dir, Env::Default());
+  }();
+  return cache;
+}
+
+/* static */
+std::string MetaOptimizerCache::Key(const GrapplerItem& item,
+                                    const ConfigProto& cfg,
+                                    const Cluster* cluster) {
+  // Graphs are large and fingerprinted on their own, everything else is small.
+  std::string serialized;
+  SerializeToStringDeterministic(item.graph, &serialized);
+  const Fprint128 graph_fingerprint = Fingerprint128(serialized);
+
+  std::string config;
+  // Graphs cached on disk may be produced by another build.
+  absl::StrAppend(&config, "version=", TF_VERSION_STRING, ":",
+                  TF_GRAPH_DEF_VERSION, ";");
+  for (const auto& feed : item.feed) {
+    absl::StrAppend(&config, "feed=", feed.first, ":",
+                    DataTypeString(feed.second.dtype()), ":",
+                    feed.second.shape().DebugString(), ";");
+  }
+  AppendSorted("fetch", item.fetch, &config);
+  AppendSorted("init_op", item.init_ops, &config);
+  AppendSorted("keep_op", item.keep_ops, &config);
+  absl::StrAppend(&config, "save=", item.save_op, ":", item.restore_op, ":",
+                  item.save_restore_loc_tensor, ";");
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    serialized.clear();
+    SerializeToStringDeterministic(queue_runner, &serialized);
+    absl::StrAppend(&config, "queue_runner=", serialized, ";");
+  }
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  absl::StrAppend(&config, "options=",
+                  options.allow_non_differentiable_rewrites, ":",
+                  options.allow_pruning_stateful_and_dataset_ops, ":",
+                  options.optimize_function_library, ":",
+                  options.is_eager_mode, ":",
+                  options.intra_op_parallelism_threads, ";");
+  AppendSorted("device",
+               std::vector<std::string>(item.devices().begin(),
+                                        item.devices().end()),
+               &config);
+  serialized.clear();
+  SerializeToStringDeterministic(cfg, &serialized);
+  absl::StrAppend(&config, "config=", serialized, ";");
+  if (cluster != nullptr) {
+    std::vector<std::string> devices;
+    for (const auto& device : cluster->GetDevices()) {
+      serialized.clear();
+      SerializeToStringDeterministic(device.second, &serialized);
+      devices.push_back(absl::StrCat(device.first, ":", serialized));
+    }
+    absl::StrAppend(&config, "cluster=", cluster->type(), ";");
+    AppendSorted("cluster_device", std::move(devices), &config);
+  }
+
+  const Fprint128 fingerprint =
+      FingerprintCat128(graph_fingerprint, Fingerprint128(config));
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+std::string MetaOptimizerCache::FileName(const std::string& key) const {
+  return io::JoinPath(dir_, absl::StrCat("grappler_", key, ".pb"));
+}
+
+void MetaOptimizerCache::AddToMemory(const std::string& key,
+                                     const GraphDef& optimized_graph) {
+  if (entries_.contains(key)) return;
+  lru_.emplace_front(key, optimized_graph);
+  entries_[key] = lru_.begin();
+  while (lru_.size() > static_cast<size_t>(capacity_)) {
+    entries_.erase(lru_.back().first);
+    lru_.pop_back();
+  }
+}
+
+bool MetaOptimizerCache::Lookup(const std::string& key,
+                                GraphDef* optimized_graph) {
+  if (capacity_ > 0) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second);
+      *optimized_graph = it->second->second;
+      metrics::IncrementGrapplerCacheCount("hit");
+      return true;
+    }
+  }
+  if (!dir_.empty()) {
+    const std::string file_name = FileName(key);
+    if (env_->FileExists(file_name).ok()) {
+      GraphDef graph;
+      Status s = ReadBinaryProto(env_, file_name, &graph);
+      if (s.ok()) {
+        VLOG(2) << "Read the optimized graph " << key << " from " << file_name;
+        if (capacity_ > 0) {
+          mutex_lock l(mu_);
+          AddToMemory(key, graph);
+        }
+        *optimized_graph = std::move(graph);
+        metrics::IncrementGrapplerCacheCount("disk_hit");
+        return true;
+      }
+      LOG(WARNING) << "Failed to read the optimized graph from " << file_name
+                   << ": " << s;
+    }
+  }
+  metrics::IncrementGrapplerCacheCount("miss");
+  return false;
+}
+
+void MetaOptimizerCache::Insert(const std::string& key,
+                                const GraphDef& optimized_graph) {
+  if (capacity_ > 0) {
+    mutex_lock l(mu_);
+    AddToMemory(key, optimized_graph);
+  }
+  if (!dir_.empty()) {
+    // Concurrent writers of the same key write the same graph, and the rename
+    // makes readers see either none or all of it.
+    const std::string file_name = FileName(key);
+    const std::string tmp_name =
+        absl::StrCat(file_name, ".tmp", env_->NowMicros(), "_",
+                     env_->GetCurrentThreadId());
+    Status s = WriteBinaryProto(env_, tmp_name, optimized_graph);
+    if (s.ok()) s = env_->RenameFile(tmp_name, file_name);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write the optimized graph to " << file_name
+                   << ": " << s;
+      env_->DeleteFile(tmp_name).IgnoreError();
+    }
+  }
+}
+
+int64_t MetaOptimizerCache::size() {
+  mutex_lock l(mu_);
+  return lru_.size();
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
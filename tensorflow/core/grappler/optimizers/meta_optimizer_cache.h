@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <list>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Caches the graphs optimized by the MetaOptimizer, so that identical items,
+// e.g. the functions of tf.function retraces or the per-replica copies of a
+// function, are only optimized once per process. Items are identified by the
+// fingerprint of their graph, fetch and preserved nodes, optimization options
+// and devices, together with the ConfigProto and the devices of the cluster.
+//
+// Entries are kept in memory, evicting the least recently used ones, and
+// optionally in a directory shared by the processes of a job.
+class MetaOptimizerCache {
+ public:
+  // `capacity` is the maximum number of graphs kept in memory. If `dir` is not
+  // empty, graphs are also written to and read from files in it.
+  MetaOptimizerCache(int64_t capacity, const std::string& dir, Env* env);
+
+  // Returns the cache configured by the TF_GRAPPLER_CACHE_CAPACITY and
+  // TF_GRAPPLER_CACHE_DIR environment variables, or null if both are unset.
+  static MetaOptimizerCache* Global();
+
+  // Returns the key identifying the optimization of `item` with `cfg` on
+  // `cluster`, which may be null.
+  static std::string Key(const GrapplerItem& item, const ConfigProto& cfg,
+                         const Cluster* cluster);
+
+  // Returns true and sets `*optimized_graph` if the graph of `key` is cached.
+  bool Lookup(const std::string& key, GraphDef* optimized_graph);
+
+  void Insert(const std::string& key, const GraphDef& optimized_graph);
+
+  int64_t size();
+
+ private:
+  using LruList = std::list<std::pair<std::string, GraphDef>>;
+
+  std::string FileName(const std::string& key) const;
+
+  void AddToMemory(const std::string& key, const GraphDef& optimized_graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64_t capacity_;
+  const std::string dir_;
+  Env* const env_;
+
+  mutex mu_;
+  // Most recently used first.
+  LruList lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, LruList::iterator> entries_
+      TF_GUARDED_BY(mu_);
+
+  MetaOptimizerCache(const MetaOptimizerCache&) = delete;
+  void operator=(const MetaOptimizerCache&) = delete;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
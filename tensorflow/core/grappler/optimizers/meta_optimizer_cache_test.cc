@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+GrapplerItem MakeItem(const string& id) {
+  GrapplerItem item;
+  item.id = id;
+  item.graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("y", "Identity", {"x"}, {{"T", DT_FLOAT}})},
+      {});
+  item.fetch = {"y"};
+  return item;
+}
+
+GraphDef Optimized() {
+  return test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}})}, {});
+}
+
+TEST(MetaOptimizerCacheTest, KeyIgnoresItemId) {
+  ConfigProto cfg;
+  const string key = MetaOptimizerCache::Key(MakeItem("f1"), cfg, nullptr);
+  EXPECT_EQ(key, MetaOptimizerCache::Key(MakeItem("f2"), cfg, nullptr));
+
+  GrapplerItem other_fetch = MakeItem("f1");
+  other_fetch.fetch = {"x"};
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_fetch, cfg, nullptr));
+
+  GrapplerItem other_device = MakeItem("f1");
+  TF_ASSERT_OK(other_device.AddDevice("/job:a/replica:0/task:0/device:CPU:0"));
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_device, cfg, nullptr));
+
+  ConfigProto other_cfg;
+  other_cfg.mutable_graph_options()->mutable_rewrite_options()->set_remapping(
+      RewriterConfig::OFF);
+  EXPECT_NE(key, MetaOptimizerCache::Key(MakeItem("f1"), other_cfg, nullptr));
+}
+
+TEST(MetaOptimizerCacheTest, EvictsLeastRecentlyUsed) {
+  MetaOptimizerCache cache(/*capacity=*/2, /*dir=*/"", Env::Default());
+  const int64_t hits = metrics::GetGrapplerCacheCount("hit");
+  const int64_t misses = metrics::GetGrapplerCacheCount("miss");
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("a", &graph));
+  cache.Insert("a", Optimized());
+  cache.Insert("b", Optimized());
+  EXPECT_TRUE(cache.Lookup("a", &graph));
+  EXPECT_EQ(graph.node_size(), 1);
+  cache.Insert("c", Optimized());
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup("a", &graph));
+  EXPECT_FALSE(cache.Lookup("b", &graph));
+  EXPECT_TRUE(cache.Lookup("c", &graph));
+  EXPECT_EQ(metrics::GetGrapplerCacheCount("hit") - hits, 3);
+  EXPECT_EQ(metrics::GetGrapplerCacheCount("miss") - misses, 2);
+}
+
+TEST(MetaOptimizerCacheTest, ReadsGraphsFromDirectory) {
+  const string dir = io::JoinPath(testing::TmpDir(), "meta_optimizer_cache");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(dir));
+  {
+    MetaOptimizerCache writer(/*capacity=*/0, dir, Env::Default());
+    writer.Insert("a", Optimized());
+    EXPECT_EQ(writer.size(), 0);
+  }
+  const int64_t disk_hits = metrics::GetGrapplerCacheCount("disk_hit");
+  MetaOptimizerCache reader(/*capacity=*/1, dir, Env::Default());
+  GraphDef graph;
+  EXPECT_FALSE(reader.Lookup("b", &graph));
+  ASSERT_TRUE(reader.Lookup("a", &graph));
+  EXPECT_EQ(graph.node_size(), 1);
+  EXPECT_EQ(reader.size(), 1);
+  EXPECT_EQ(metrics::GetGrapplerCacheCount("disk_hit") - disk_hits, 1);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
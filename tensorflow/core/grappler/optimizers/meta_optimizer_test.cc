@@ -16,6 +16,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
 #include <atomic>
+#include <cstdlib>
+#include <string>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/substitute.h"
@@ -32,8 +35,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
 namespace tensorflow {
@@ -1412,6 +1417,84 @@ INSTANTIATE_TEST_SUITE_P(
       return test_name;
     });
 
+// A graph calling `num_functions` non-inlined functions, each of which holds a
+// chain of `num_ops` arithmetic ops.
+GrapplerItem LargeFunctionLibraryItem(int num_functions, int num_ops) {
+  using test::function::NDef;
+  std::vector<FunctionDef> functions;
+  std::vector<NodeDef> nodes = {
+      NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  for (int f = 0; f < num_functions; ++f) {
+    std::vector<FunctionDefHelper::Node> body;
+    string input = "x";
+    for (int i = 0; i < num_ops; ++i) {
+      const string square = strings::StrCat("square_", i);
+      const string add = strings::StrCat("add_", i);
+      body.push_back({{square}, "Mul", {input, input}, {{"T", DT_FLOAT}}});
+      body.push_back({{add}, "Add", {square + ":z:0", "x"}, {{"T", DT_FLOAT}}});
+      input = add + ":z:0";
+    }
+    FunctionDef func = FunctionDefHelper::Create(
+        strings::StrCat("Layer_", f), {"x:float"}, {"z:float"}, {}, body,
+        /*ret_def=*/{{"z", input}});
+    (*func.mutable_attr())["_noinline"].set_b(true);
+    functions.push_back(func);
+
+    const string call = strings::StrCat("call_", f);
+    nodes.push_back(NDef(call, strings::StrCat("Layer_", f), {"x"}, {},
+                         kDevice));
+    nodes.push_back(NDef(strings::StrCat("out_", f), "Identity",
+                         {call + ":0"}, {{"T", DT_FLOAT}}, kDevice));
+  }
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(nodes, functions);
+  for (int f = 0; f < num_functions; ++f) {
+    item.fetch.push_back(strings::StrCat("out_", f));
+  }
+  return item;
+}
+
+GraphDef OptimizeWithThreads(const GrapplerItem& item, int num_threads) {
+  setenv("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS",
+         strings::StrCat(num_threads).c_str(), /*overwrite=*/1);
+  ConfigProto config_proto;
+  config_proto.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_min_graph_nodes(-1);
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_CHECK_OK(optimizer.Optimize(nullptr, item, &output));
+  unsetenv("TF_GRAPPLER_FUNCTION_OPTIMIZATION_THREADS");
+  return output;
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  const GrapplerItem item =
+      LargeFunctionLibraryItem(/*num_functions=*/16, /*num_ops=*/4);
+  const GraphDef sequential = OptimizeWithThreads(item, 1);
+  EXPECT_EQ(sequential.library().function_size(), 16);
+  // The optimized library does not depend on the number of threads.
+  for (int num_threads : {2, 4}) {
+    const GraphDef parallel = OptimizeWithThreads(item, num_threads);
+    EXPECT_EQ(sequential.DebugString(), parallel.DebugString());
+  }
+}
+
+void BM_OptimizeFunctionLibrary(::testing::benchmark::State& state) {
+  const int num_functions = state.range(0);
+  const int num_threads = state.range(1);
+  const GrapplerItem item =
+      LargeFunctionLibraryItem(num_functions, /*num_ops=*/32);
+  for (auto s : state) {
+    OptimizeWithThreads(item, num_threads);
+  }
+}
+BENCHMARK(BM_OptimizeFunctionLibrary)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(256, 16);
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
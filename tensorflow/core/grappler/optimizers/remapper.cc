@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -32,12 +33,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
+#include "tensorflow/core/grappler/optimizers/remapper_cost_model.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/graph_view.h"
 #include "tensorflow/core/grappler/utils/pattern_utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/util/env_var.h"
@@ -64,6 +67,8 @@ namespace grappler {
 //
 // MatMul + ... -> _FusedMatMul:
 //   (1) MatMul + BiasAdd + <Activation>
+//   (2) MatMul + Add + <Activation>, with a vector as the other input of Add.
+//       Outside of oneDNN builds, only with the cost guard.
 //
 // DepthwiseConv2dNative + ... -> _FusedDepthwiseConv2dNative:
 //   (1) DepthwiseConv2dNative + BiasAdd + <Activation>
@@ -82,6 +87,9 @@ namespace grappler {
 //
 // _FusedConv2D/_FusedConv3D + <Activation> -> _FusedConv2D/_FusedConv3D
 // Supported Activations: LeakyRelu, Mish
+//
+// With the cost guard, the contraction fusions and the MatMul + BiasAdd + Gelu
+// fusion are only applied if the RemapperCostModel predicts them to be faster.
 
 namespace {
 
@@ -92,6 +100,10 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedGatherSparseSegmentReduce[] =
+    "_FusedGatherSparseSegmentReduce";
+constexpr char kDecodeAndResizeJpeg[] = "_DecodeAndResizeJpeg";
+constexpr char kFusedDequantizeQuantize[] = "_FusedDequantizeQuantize";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -123,6 +135,8 @@ struct RemapperContext {
   bool inferred_graph_properties;
   RewriterConfig::CpuLayout cpu_layout_conversion;
   bool xla_auto_clustering_on;
+  // Set if fusions are guarded by their cost.
+  std::unique_ptr<RemapperCostModel> cost_model;
 };
 
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
@@ -167,6 +181,41 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Gather of the rows of an embedding table that are reduced by a
+// SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN.
+struct GatherSparseSegmentReduce {
+  GatherSparseSegmentReduce() = default;
+  GatherSparseSegmentReduce(int gather, int sparse_segment_reduce)
+      : gather(gather), sparse_segment_reduce(sparse_segment_reduce) {}
+
+  int gather = kMissingIndex;
+  int sparse_segment_reduce = kMissingIndex;
+};
+
+// Dequantize, optionally followed by an elementwise activation, feeding a
+// QuantizeV2, which requantizes the 8-bit input.
+struct DequantizeQuantize {
+  DequantizeQuantize() = default;
+  DequantizeQuantize(int dequantize, int activation, int quantize)
+      : dequantize(dequantize), activation(activation), quantize(quantize) {}
+
+  int dequantize = kMissingIndex;
+  int activation = kMissingIndex;
+  int quantize = kMissingIndex;
+};
+
+// DecodeJpeg or DecodeAndCropJpeg followed by an ExpandDims and a
+// ResizeBilinear, as in tf.image.resize(tf.io.decode_jpeg(contents), size).
+struct DecodeAndResizeJpeg {
+  DecodeAndResizeJpeg() = default;
+  DecodeAndResizeJpeg(int decode, int expand_dims, int resize)
+      : decode(decode), expand_dims(expand_dims), resize(resize) {}
+
+  int decode = kMissingIndex;
+  int expand_dims = kMissingIndex;
+  int resize = kMissingIndex;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -385,6 +434,15 @@ bool BlasLtMatmulEnabled() {
   return is_enabled;
 }
 
+// Decoding a JPEG image with a scaled IDCT before resizing it does not give the
+// same pixels as resizing the full resolution image, so the fusion is opt-in.
+bool DecodeAndResizeJpegFusionEnabled() {
+  bool is_enabled = false;
+  TF_CHECK_OK(tensorflow::ReadBoolFromEnvVar(
+      "TF_FUSE_DECODE_AND_RESIZE_JPEG", /*default_val=*/false, &is_enabled));
+  return is_enabled;
+}
+
 bool IsGpuCompatibleDataFormat(const RemapperContext& ctx,
                                const NodeDef* conv2d) {
   DCHECK(IsConv2D(*conv2d)) << "Expected Conv2D op";
@@ -621,6 +679,48 @@ bool IsDeviceCompatible(const RemapperContext& ctx, Pattern& matched,
          IsGpuCompatible(ctx, matched, cluster);
 }
 
+// Returns the op of the node replacing a fusion into `contraction`.
+string FusedContractionOp(const NodeDef& contraction) {
+  if (IsConv2D(contraction)) return kFusedConv2D;
+  if (IsDepthwiseConv2dNative(contraction)) return kFusedDepthwiseConv2dNative;
+  if (IsConv3D(contraction)) return kFusedConv3D;
+  return kFusedMatMul;
+}
+
+// Returns false if replacing the nodes at `node_indices`, a contraction
+// followed by the ops fused into it, with a `fused_op` node applying
+// `fused_ops` is predicted to be slower. Always true without the cost guard.
+bool IsProfitableFusion(const RemapperContext& ctx,
+                        const std::vector<int>& node_indices,
+                        const string& fused_op,
+                        const std::vector<string>& fused_ops) {
+  if (ctx.cost_model == nullptr) return true;
+  std::vector<const NodeDef*> nodes;
+  nodes.reserve(node_indices.size());
+  for (int index : node_indices) {
+    nodes.push_back(ctx.graph_view.GetNode(index)->node());
+  }
+  return ctx.cost_model->IsProfitableFusion(nodes, fused_op, fused_ops);
+}
+
+bool IsProfitableFusion(const RemapperContext& ctx,
+                        const ContractionWithBiasAdd& matched) {
+  const GraphDef* graph = ctx.graph_view.graph();
+  const NodeDef& contraction = graph->node(matched.contraction);
+  return IsProfitableFusion(ctx, {matched.contraction, matched.bias_add},
+                            FusedContractionOp(contraction), {"BiasAdd"});
+}
+
+bool IsProfitableFusion(const RemapperContext& ctx,
+                        const ContractionWithBiasAddAndActivation& matched) {
+  const GraphDef* graph = ctx.graph_view.graph();
+  const NodeDef& contraction = graph->node(matched.contraction);
+  const NodeDef& activation = graph->node(matched.activation);
+  return IsProfitableFusion(
+      ctx, {matched.contraction, matched.bias_add, matched.activation},
+      FusedContractionOp(contraction), {"BiasAdd", activation.op()});
+}
+
 // Returns the generic op name for an _Mkl activation op
 std::string GetActivationName(std::string s) {
   if (s == kMklFusedMish) {
@@ -656,12 +756,47 @@ bool IsConvOrMatMul(const NodeDef& node) {
          IsConv3D(node);
 }
 
+// Returns true if one input to Add is a 2-D MatMul, and the other input is a
+// vector of the size of its columns, which _FusedMatMul adds as a BiasAdd.
+bool IsMatMulWithBiasVectorAdd(const RemapperContext& ctx,
+                               const utils::MutableNodeView& node_view,
+                               int& bias_port) {
+  const auto* node_def = node_view.node();
+  if (!IsAdd(*node_def) || node_view.NumRegularFanins() != 2) return false;
+
+  const auto& props = ctx.graph_properties.GetInputProperties(node_def->name());
+  if (props.size() < 2) return false;
+
+  for (int port : {1, 0}) {
+    const auto* contraction_node_def =
+        node_view.GetRegularFanin(1 - port).node_view()->node();
+    if (!IsMatMul(*contraction_node_def)) continue;
+
+    const TensorShapeProto& output_shape = props[1 - port].shape();
+    const TensorShapeProto& bias_shape = props[port].shape();
+    if (output_shape.unknown_rank() || output_shape.dim_size() != 2 ||
+        bias_shape.unknown_rank() || bias_shape.dim_size() != 1 ||
+        !IsKnown(output_shape.dim(1)) ||
+        output_shape.dim(1).size() != bias_shape.dim(0).size())
+      continue;
+
+    bias_port = port;
+    return true;
+  }
+  return false;
+}
+
 // Returns true if one input to Add is Conv2D/3D or DepthwiseConv2dNative or
 // MatMul, and the other input is semantically equivalent to BiasAdd.
 bool IsBiasSemanticAdd(const RemapperContext& ctx,
                        const utils::MutableNodeView& node_view,
                        int& bias_port) {
-  if (!IsMKLEnabled()) return false;
+  // Without oneDNN, only the MatMul fusion is supported, and only applied if
+  // it is cheaper.
+  if (!IsMKLEnabled()) {
+    return ctx.cost_model != nullptr &&
+           IsMatMulWithBiasVectorAdd(ctx, node_view, bias_port);
+  }
 
   const auto* node_def = node_view.node();
   if (!NodeIsOnCpu(node_def)) return false;
@@ -2075,12 +2210,21 @@ bool IsCommonNormPattern(RemapperContext* ctx, int node_index,
 // Keras LayerNormalization api uses multiple TensorFlow ops. Current fusion
 // pattern is only for the case, when LayerNormalization uses FusedBatcNormV3.
 // We further restrict it to only 2D or 3D tensor inputs to keras
-// LayerNormalization api.
-bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
-                      std::map<string, int>* matched_nodes_map,
-                      std::set<int>* remove_node_indices,
-                      std::vector<string>* input_node_names, float* epsilon) {
-  if (!IsMKLEnabled()) return false;
+// LayerNormalization api. The ops are fused into _MklLayerNorm with oneDNN,
+// and into _FusedLayerNorm on the CPU otherwise.
+bool FindLayerNorm(RemapperContext* ctx, int node_index,
+                   std::map<string, int>* matched_nodes_map,
+                   std::set<int>* remove_node_indices,
+                   std::vector<string>* input_node_names, float* epsilon) {
+  if (!IsMKLEnabled()) {
+    const NodeDef* node_def = ctx->graph_view.GetNode(node_index)->node();
+    if (!NodeIsOnCpu(node_def)) return false;
+    if (!(HasDataType(node_def, DT_FLOAT) ||
+          HasDataType(node_def, DT_BFLOAT16) ||
+          HasDataType(node_def, DT_HALF))) {
+      return false;
+    }
+  }
 
   // The following pattern will be searched in the graph with additional
   // contraints. Here * means any type of op.
@@ -2260,6 +2404,39 @@ bool FindMklLayerNorm(RemapperContext* ctx, int node_index,
         if (static_cast<int64>(rank - 1) != mean_axis_tensor.flat<int64>()(0))
           return false;
       }
+      // The variance must be reduced along the same axis as the mean, and
+      // the constant added to it is the epsilon of the fused op.
+      NodeDef* variance_axis_node =
+          ctx->graph_view.GetNode(matched_nodes_map->at("r_indices0"))->node();
+      Tensor variance_axis_tensor;
+      if (!variance_axis_tensor.FromProto(
+              variance_axis_node->attr().at("value").tensor()) ||
+          variance_axis_tensor.tensor_data() !=
+              mean_axis_tensor.tensor_data() ||
+          variance_axis_tensor.dtype() != dtype) {
+        return false;
+      }
+      NodeDef* epsilon_node =
+          ctx->graph_view.GetNode(matched_nodes_map->at("epsilon"))->node();
+      Tensor epsilon_tensor;
+      if (!epsilon_tensor.FromProto(
+              epsilon_node->attr().at("value").tensor()) ||
+          epsilon_tensor.NumElements() != 1) {
+        return false;
+      }
+      switch (epsilon_tensor.dtype()) {
+        case DT_FLOAT:
+          *epsilon = epsilon_tensor.flat<float>()(0);
+          break;
+        case DT_BFLOAT16:
+          *epsilon = static_cast<float>(epsilon_tensor.flat<bfloat16>()(0));
+          break;
+        case DT_HALF:
+          *epsilon = static_cast<float>(epsilon_tensor.flat<Eigen::half>()(0));
+          break;
+        default:
+          return false;
+      }
       auto* gamma_node =
           ctx->graph_view.GetNode(matched_nodes_map->at("gamma"))->node();
       auto* beta_node =
@@ -2675,6 +2852,219 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool IsSparseSegmentReduction(const NodeDef& node) {
+  const auto& op = node.op();
+  return op == "SparseSegmentSum" || op == "SparseSegmentMean" ||
+         op == "SparseSegmentSqrtN";
+}
+
+bool FindGatherSparseSegmentReduce(const RemapperContext& ctx, int node_index,
+                                   GatherSparseSegmentReduce* matched) {
+  // Root of the pattern must be a SparseSegment{Sum,Mean,SqrtN} on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsSparseSegmentReduction(*node_def) || !NodeIsOnCpu(node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 3) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE)) {
+    return false;
+  }
+
+  // Its data must be the rows of a table gathered along the first dimension,
+  // which are not used anywhere else. ResourceGather is not fused since the
+  // fused kernel would need to read the whole variable.
+  const auto* gather_node_view = node_view->GetRegularFanin(0).node_view();
+  const auto* gather_node_def = gather_node_view->node();
+  if ((gather_node_def->op() != "Gather" &&
+       gather_node_def->op() != "GatherV2") ||
+      !NodeIsOnCpu(gather_node_def) ||
+      HasControlFaninOrFanout(*gather_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+      IsInPreserveSet(ctx, gather_node_def)) {
+    return false;
+  }
+  if (!HasDataType(gather_node_def, DT_INT32, "Tindices") &&
+      !HasDataType(gather_node_def, DT_INT64, "Tindices")) {
+    return false;
+  }
+  if (gather_node_def->op() == "GatherV2") {
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      return false;
+    }
+    if (gather_node_view->NumRegularFanins() != 3) return false;
+    const auto* axis_node_def =
+        gather_node_view->GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node_def) ||
+        !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      return false;
+    }
+    const int64_t axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64_t>()(0);
+    if (axis_value != 0) return false;
+  }
+
+  // The fused kernel only gathers along a vector of indices.
+  if (!ctx.graph_properties.HasInputProperties(gather_node_def->name())) {
+    return false;
+  }
+  const auto& props =
+      ctx.graph_properties.GetInputProperties(gather_node_def->name());
+  if (props.size() < 2 || props[1].shape().unknown_rank() ||
+      props[1].shape().dim_size() != 1) {
+    return false;
+  }
+
+  const GatherSparseSegmentReduce pattern{gather_node_view->node_index(),
+                                          node_index};
+  *matched = pattern;
+  return true;
+}
+
+// Returns true if the node is a Dequantize or a QuantizeV2, on CPU, of 8-bit
+// values with per-tensor ranges, in a mode that _FusedDequantizeQuantize
+// supports.
+bool IsPerTensor8BitQuantization(const NodeDef& node) {
+  if (!NodeIsOnCpu(&node)) return false;
+  if (!HasDataType(&node, DT_QINT8) && !HasDataType(&node, DT_QUINT8)) {
+    return false;
+  }
+  int axis = -1;
+  if (TryGetNodeAttr(node, "axis", &axis) && axis != -1) return false;
+  string mode = "MIN_COMBINED";
+  TryGetNodeAttr(node, "mode", &mode);
+  return mode == "MIN_COMBINED" || mode == "SCALED";
+}
+
+bool IsRequantizationActivation(const NodeDef& node) {
+  return node.op() == "Identity" || IsRelu(node) || IsRelu6(node) ||
+         IsLeakyRelu(node) || IsSigmoid(node) || IsTanh(node);
+}
+
+bool FindDequantizeQuantize(const RemapperContext& ctx, int node_index,
+                            DequantizeQuantize* matched) {
+  // Root of the pattern must be a QuantizeV2 with per-tensor ranges.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (node_def->op() != "QuantizeV2" ||
+      !IsPerTensor8BitQuantization(*node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 3) {
+    return false;
+  }
+
+  // Its input must be the float output of a Dequantize, possibly through an
+  // elementwise activation, used nowhere else.
+  auto is_inner_node = [&](const utils::MutableNodeView& view) {
+    return NodeIsOnCpu(view.node()) && !HasControlFaninOrFanout(view) &&
+           HasAtMostOneFanoutAtPort0(view) &&
+           !IsInPreserveSet(ctx, view.node());
+  };
+  const auto* fanin_view = node_view->GetRegularFanin(0).node_view();
+  int activation = kMissingIndex;
+  if (IsRequantizationActivation(*fanin_view->node())) {
+    if (!is_inner_node(*fanin_view) ||
+        !HasDataType(fanin_view->node(), DT_FLOAT)) {
+      return false;
+    }
+    activation = fanin_view->node_index();
+    fanin_view = fanin_view->GetRegularFanin(0).node_view();
+  }
+  const auto* dequantize_def = fanin_view->node();
+  if (dequantize_def->op() != "Dequantize" ||
+      !IsPerTensor8BitQuantization(*dequantize_def) ||
+      !HasDataType(dequantize_def, DT_FLOAT, "dtype") ||
+      !is_inner_node(*fanin_view) || fanin_view->NumRegularFanins() != 3) {
+    return false;
+  }
+
+  const DequantizeQuantize pattern{fanin_view->node_index(), activation,
+                                   node_index};
+  *matched = pattern;
+  return true;
+}
+
+bool FindDecodeAndResizeJpeg(const RemapperContext& ctx, int node_index,
+                             DecodeAndResizeJpeg* matched) {
+  // Root of the pattern must be a ResizeBilinear of uint8 images on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (node_def->op() != "ResizeBilinear" || !NodeIsOnCpu(node_def) ||
+      !HasDataType(node_def, DT_UINT8) || HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  bool align_corners = false;
+  if (TryGetNodeAttr(*node_def, "align_corners", &align_corners) &&
+      align_corners) {
+    return false;
+  }
+
+  // Its images must be a single decoded image, expanded along axis 0.
+  const auto* expand_dims_node_view = node_view->GetRegularFanin(0).node_view();
+  const auto* expand_dims_node_def = expand_dims_node_view->node();
+  if (expand_dims_node_def->op() != "ExpandDims" ||
+      HasControlFaninOrFanout(*expand_dims_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*expand_dims_node_view) ||
+      IsInPreserveSet(ctx, expand_dims_node_def) ||
+      expand_dims_node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  const auto* axis_node_def =
+      expand_dims_node_view->GetRegularFanin(1).node_view()->node();
+  Tensor axis;
+  if (!IsConstant(*axis_node_def) ||
+      !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+      axis.NumElements() != 1) {
+    return false;
+  }
+  const int64_t axis_value = axis.dtype() == DT_INT32
+                                 ? axis.flat<int32>()(0)
+                                 : axis.flat<int64_t>()(0);
+  if (axis_value != 0) return false;
+
+  // The decoding must have the default behavior on corrupted images, and must
+  // not already be scaled.
+  const auto* decode_node_view =
+      expand_dims_node_view->GetRegularFanin(0).node_view();
+  const auto* decode_node_def = decode_node_view->node();
+  if ((decode_node_def->op() != "DecodeJpeg" &&
+       decode_node_def->op() != "DecodeAndCropJpeg") ||
+      !NodeIsOnCpu(decode_node_def) ||
+      HasControlFaninOrFanout(*decode_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*decode_node_view) ||
+      IsInPreserveSet(ctx, decode_node_def)) {
+    return false;
+  }
+  int channels = 0;
+  int ratio = 1;
+  bool try_recover_truncated = false;
+  float acceptable_fraction = 1;
+  if (!TryGetNodeAttr(*decode_node_def, "channels", &channels) ||
+      (channels != 1 && channels != 3) ||
+      (TryGetNodeAttr(*decode_node_def, "ratio", &ratio) && ratio != 1) ||
+      (TryGetNodeAttr(*decode_node_def, "try_recover_truncated",
+                      &try_recover_truncated) &&
+       try_recover_truncated) ||
+      (TryGetNodeAttr(*decode_node_def, "acceptable_fraction",
+                      &acceptable_fraction) &&
+       acceptable_fraction != 1)) {
+    return false;
+  }
+
+  const DecodeAndResizeJpeg pattern{decode_node_view->node_index(),
+                                    expand_dims_node_view->node_index(),
+                                    node_index};
+  *matched = pattern;
+  return true;
+}
+
 // clang-format off
 // HardSwish pattern
 //                        input     Const (value: 3)
@@ -3813,19 +4203,34 @@ Status AddFusedMatMulBiasAddAndGelu(
   return OkStatus();
 }
 
-Status AddMklLayerNorm(RemapperContext* ctx,
-                       const std::map<string, int>& matched_nodes_map,
-                       const std::set<int>& remove_node_indices,
-                       const std::vector<string>& input_node_names,
-                       std::vector<bool>* invalidated_nodes,
-                       std::vector<bool>* nodes_to_delete,
-                       const float epsilon) {
+bool IsProfitableMatMulBiasAddAndGelu(
+    const RemapperContext& ctx, const std::map<string, int>& matched_nodes_map,
+    const std::set<int>& remove_node_indices, bool is_gelu_approximate) {
+  // The MatMul goes first, followed by the nodes of the BiasAdd and the Gelu.
+  const int matmul = matched_nodes_map.at("matmul");
+  std::vector<int> node_indices = {matmul};
+  for (int index : remove_node_indices) {
+    if (index != matmul) node_indices.push_back(index);
+  }
+  const int output = matched_nodes_map.at("output");
+  if (remove_node_indices.count(output) == 0) node_indices.push_back(output);
+  return IsProfitableFusion(
+      ctx, node_indices, kFusedMatMul,
+      {"BiasAdd", is_gelu_approximate ? "GeluApproximate" : "GeluExact"});
+}
+
+Status AddLayerNorm(RemapperContext* ctx,
+                    const std::map<string, int>& matched_nodes_map,
+                    const std::set<int>& remove_node_indices,
+                    const std::vector<string>& input_node_names,
+                    std::vector<bool>* invalidated_nodes,
+                    std::vector<bool>* nodes_to_delete, const float epsilon) {
   auto* output_node =
       ctx->graph_view.GetNode(matched_nodes_map.at("output"))->node();
 
   NodeDef fused_node;
   fused_node.set_name(output_node->name());
-  fused_node.set_op("_MklLayerNorm");
+  fused_node.set_op(IsMKLEnabled() ? "_MklLayerNorm" : "_FusedLayerNorm");
   fused_node.set_device(output_node->device());
   for (const auto& name : input_node_names) fused_node.add_input(name);
   auto* attr = fused_node.mutable_attr();
@@ -4289,6 +4694,178 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddGatherSparseSegmentReduceNode(
+    RemapperContext* ctx, const GatherSparseSegmentReduce& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& sparse_segment_reduce =
+      graph->node(matched.sparse_segment_reduce);
+  VLOG(2) << "Fuse " << gather.op() << " with " << sparse_segment_reduce.op()
+          << ": gather=" << gather.name()
+          << " sparse_segment_reduce=" << sparse_segment_reduce.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(sparse_segment_reduce.name());
+  fused_op.set_device(sparse_segment_reduce.device());
+  fused_op.set_op(kFusedGatherSparseSegmentReduce);
+  fused_op.add_input(gather.input(0));                 // 0: params
+  fused_op.add_input(gather.input(1));                 // 1: gather_indices
+  fused_op.add_input(sparse_segment_reduce.input(1));  // 2: indices
+  fused_op.add_input(sparse_segment_reduce.input(2));  // 3: segment_ids
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr = sparse_segment_reduce.attr();
+  (*attr)["T"] = src_attr.at("T");
+  (*attr)["Tindices"] = gather.attr().at("Tindices");
+  (*attr)["Tidx"] = src_attr.at("Tidx");
+  (*attr)["Tsegmentids"] = src_attr.at("Tsegmentids");
+  SetAttrValue(0, &(*attr)["num_weights"]);
+  const string& op = sparse_segment_reduce.op();
+  SetAttrValue(op == "SparseSegmentMean"    ? "mean"
+               : op == "SparseSegmentSqrtN" ? "sqrtn"
+                                            : "sum",
+               &(*attr)["combiner"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.sparse_segment_reduce] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+
+  return OkStatus();
+}
+
+Status AddDequantizeQuantizeNode(RemapperContext* ctx,
+                                 const DequantizeQuantize& matched,
+                                 std::vector<bool>* invalidated_nodes,
+                                 std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& dequantize = graph->node(matched.dequantize);
+  const NodeDef& quantize = graph->node(matched.quantize);
+  VLOG(2) << "Fuse Dequantize with QuantizeV2: dequantize="
+          << dequantize.name() << " quantize=" << quantize.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(quantize.name());
+  fused_op.set_device(quantize.device());
+  fused_op.set_op(kFusedDequantizeQuantize);
+  fused_op.add_input(dequantize.input(0));  // 0: input
+  fused_op.add_input(dequantize.input(1));  // 1: input_min
+  fused_op.add_input(dequantize.input(2));  // 2: input_max
+  fused_op.add_input(quantize.input(1));    // 3: min_range
+  fused_op.add_input(quantize.input(2));    // 4: max_range
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr = quantize.attr();
+  (*attr)["Tinput"] = dequantize.attr().at("T");
+  (*attr)["T"] = src_attr.at("T");
+  for (const char* name :
+       {"mode", "round_mode", "narrow_range", "ensure_minimum_range"}) {
+    if (src_attr.count(name) > 0) (*attr)[name] = src_attr.at(name);
+  }
+  if (dequantize.attr().count("mode") > 0) {
+    (*attr)["input_mode"] = dequantize.attr().at("mode");
+  }
+  if (dequantize.attr().count("narrow_range") > 0) {
+    (*attr)["input_narrow_range"] = dequantize.attr().at("narrow_range");
+  }
+  if (matched.activation != kMissingIndex) {
+    const NodeDef& activation = graph->node(matched.activation);
+    SetAttrValue(activation.op(), &(*attr)["activation"]);
+    if (IsLeakyRelu(activation)) {
+      (*attr)["leakyrelu_alpha"] = activation.attr().at("alpha");
+    }
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.quantize] = true;
+  (*nodes_to_delete)[matched.dequantize] = true;
+  if (matched.activation != kMissingIndex) {
+    (*nodes_to_delete)[matched.activation] = true;
+  }
+
+  return OkStatus();
+}
+
+Status AddDecodeAndResizeJpegNode(RemapperContext* ctx,
+                                  const DecodeAndResizeJpeg& matched,
+                                  std::vector<bool>* invalidated_nodes,
+                                  std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& decode = graph->node(matched.decode);
+  const NodeDef& expand_dims = graph->node(matched.expand_dims);
+  const NodeDef& resize = graph->node(matched.resize);
+  VLOG(2) << "Fuse " << decode.op() << " with ResizeBilinear: decode="
+          << decode.name() << " resize=" << resize.name();
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+
+  // The ExpandDims now turns the scalar contents into a batch of one image.
+  auto* expand_dims_node_view = ctx->graph_view.GetNode(matched.expand_dims);
+  mutation->AddOrUpdateRegularFanin(expand_dims_node_view, 0,
+                                    ParseTensorName(decode.input(0)));
+  AttrValue string_type;
+  string_type.set_type(DT_STRING);
+  mutation->AddOrUpdateNodeAttr(expand_dims_node_view, "T", string_type);
+
+  string crop_window;
+  if (decode.op() == "DecodeAndCropJpeg") {
+    crop_window = decode.input(1);
+  } else {
+    NodeDef no_crop_window;
+    crop_window = AddPrefixToNodeName("CropWindow", resize.name());
+    no_crop_window.set_name(crop_window);
+    no_crop_window.set_op("Const");
+    no_crop_window.set_device(resize.device());
+    (*no_crop_window.mutable_attr())["dtype"].set_type(DT_INT32);
+    Tensor(DT_INT32, {0}).AsProtoTensorContent(
+        (*no_crop_window.mutable_attr())["value"].mutable_tensor());
+    mutation->AddNode(std::move(no_crop_window), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  NodeDef fused_op;
+  fused_op.set_name(resize.name());
+  fused_op.set_device(resize.device());
+  fused_op.set_op(kDecodeAndResizeJpeg);
+  fused_op.add_input(expand_dims.name());  // 0: contents
+  fused_op.add_input(crop_window);         // 1: crop_window
+  fused_op.add_input(resize.input(1));     // 2: size
+
+  auto* attr = fused_op.mutable_attr();
+  auto& src_attr = decode.attr();
+  (*attr)["channels"] = src_attr.at("channels");
+  if (src_attr.count("fancy_upscaling")) {
+    (*attr)["fancy_upscaling"] = src_attr.at("fancy_upscaling");
+  }
+  if (src_attr.count("dct_method")) {
+    (*attr)["dct_method"] = src_attr.at("dct_method");
+  }
+  bool half_pixel_centers = false;
+  TryGetNodeAttr(resize, "half_pixel_centers", &half_pixel_centers);
+  SetAttrValue(half_pixel_centers, &(*attr)["half_pixel_centers"]);
+
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.resize] = true;
+  (*invalidated_nodes)[matched.expand_dims] = true;
+  (*nodes_to_delete)[matched.decode] = true;
+
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4724,6 +5301,16 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return false;
   };
 
+  // Candidate for a Gather + SparseSegment{Sum,Mean,SqrtN} fusion, which
+  // needs the shape of the gathered indices.
+  const auto is_gather_sparse_segment_reduce_candidate = [&]() -> bool {
+    if (!IsSparseSegmentReduction(*node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    const auto& fanin_0 = node_view->GetRegularFanin(0);
+    const auto& fanin_0_op = fanin_0.node_view()->node()->op();
+    return fanin_0_op == "Gather" || fanin_0_op == "GatherV2";
+  };
+
   // Candidate for a FusedMatmul fusion (MatMul + BiasAdd + GeluExact).
   const auto is_matmul_gelu_exact_fusion_candidate = [&]() -> bool {
     if (!RuntimeFusionEnabled(cluster)) return false;
@@ -4772,7 +5359,8 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() ||
+         is_gather_sparse_segment_reduce_candidate();
 }
 }  // namespace
 
@@ -4788,6 +5376,29 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   TF_RETURN_IF_ERROR(
       ctx.graph_view.SortTopologically(/*ignore_cycles=*/false, {}));
 
+  // The cost model needs the shapes of all the candidates.
+  if (cost_guard_) {
+    if (!measured_costs_loaded_ && !measured_costs_path_.empty()) {
+      Status s = ReadTextOrBinaryProto(Env::Default(), measured_costs_path_,
+                                       &measured_costs_);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to read the measured costs from "
+                     << measured_costs_path_ << ", predicting all costs: " << s;
+        measured_costs_.Clear();
+      }
+    }
+    measured_costs_loaded_ = true;
+    const bool assume_valid_feeds = opt_level_ == RewriterConfig::AGGRESSIVE;
+    TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
+        assume_valid_feeds,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/true,
+        /*include_output_tensor_values=*/false));
+    ctx.inferred_graph_properties = true;
+    ctx.cost_model = std::make_unique<RemapperCostModel>(
+        cluster, &ctx.graph_properties, measured_costs_);
+  }
+
   const int num_nodes = item.graph.node_size();
   // Skip nodes that were invalidated by a remapper, e.g. do not process BiasAdd
   // and Activation nodes that were fused into a Conv2D node.
@@ -4798,6 +5409,7 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   // not perform rewrite if the graph will be differentiated later.
   bool allow_non_differentiable_rewrites =
       item.optimization_options().allow_non_differentiable_rewrites;
+  const bool fuse_decode_and_resize_jpeg = DecodeAndResizeJpegFusionEnabled();
 
   for (int i = num_nodes - 1; i >= 0; --i) {
     // Check if node was invalidated by one of the previous remaps.
@@ -4982,19 +5594,6 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
         }
       }
 
-      // Remap smaller ops from layernorm python api into _MklLayerNorm
-      matched_nodes_map.clear();
-      remove_node_indices.clear();
-      input_node_names.clear();
-      float epsilon = 0.001;
-      if (FindMklLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
-                           &input_node_names, &epsilon)) {
-        TF_RETURN_IF_ERROR(AddMklLayerNorm(
-            &ctx, matched_nodes_map, remove_node_indices, input_node_names,
-            &invalidated_nodes, &nodes_to_delete, epsilon));
-        continue;
-      }
-
       // Remap ops that make up instancenorm followed by Relu or LeakyRelu
       // into _MklFusedInstanceNorm
       matched_nodes_map.clear();
@@ -5023,18 +5622,38 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     std::set<int> remove_node_indices;
     bool is_gelu_approximate = false;
     if (FindMatMulBiasAddAndGelu(&ctx, i, cluster, &matched_nodes_map,
-                                 &remove_node_indices, &is_gelu_approximate)) {
+                                 &remove_node_indices, &is_gelu_approximate) &&
+        IsProfitableMatMulBiasAddAndGelu(ctx, matched_nodes_map,
+                                         remove_node_indices,
+                                         is_gelu_approximate)) {
       TF_RETURN_IF_ERROR(AddFusedMatMulBiasAddAndGelu(
           &ctx, matched_nodes_map, remove_node_indices, &invalidated_nodes,
           &nodes_to_delete, is_gelu_approximate));
       continue;
     }
 
+    // Remap smaller ops from layernorm python api into _MklLayerNorm or
+    // _FusedLayerNorm. The latter has no gradient.
+    matched_nodes_map.clear();
+    remove_node_indices.clear();
+    std::vector<string> input_node_names;
+    float epsilon = 0.001;
+    if ((IsMKLEnabled() || allow_non_differentiable_rewrites) &&
+        FindLayerNorm(&ctx, i, &matched_nodes_map, &remove_node_indices,
+                      &input_node_names, &epsilon)) {
+      TF_RETURN_IF_ERROR(AddLayerNorm(&ctx, matched_nodes_map,
+                                      remove_node_indices, input_node_names,
+                                      &invalidated_nodes, &nodes_to_delete,
+                                      epsilon));
+      continue;
+    }
+
     // Remap {Conv2D,DepthwiseConv2D,MatMul}+BiasAdd into the
     // _Fused{Conv2D,DepthwiseConv2dNative,MatMul}
     ContractionWithBiasAdd contract_with_bias;
     if (allow_non_differentiable_rewrites &&
-        FindContractionWithBias(ctx, i, &contract_with_bias)) {
+        FindContractionWithBias(ctx, i, &contract_with_bias) &&
+        IsProfitableFusion(ctx, contract_with_bias)) {
       TF_RETURN_IF_ERROR(AddFusedContractionNode(
           &ctx, contract_with_bias, &invalidated_nodes, &nodes_to_delete));
       continue;
@@ -5045,7 +5664,8 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     ContractionWithBiasAddAndActivation contract_with_bias_and_activation;
     if (allow_non_differentiable_rewrites &&
         FindContractionWithBiasAndActivation(
-            ctx, cluster, i, &contract_with_bias_and_activation)) {
+            ctx, cluster, i, &contract_with_bias_and_activation) &&
+        IsProfitableFusion(ctx, contract_with_bias_and_activation)) {
       TF_RETURN_IF_ERROR(
           AddFusedContractionNode(&ctx, contract_with_bias_and_activation,
                                   &invalidated_nodes, &nodes_to_delete));
@@ -5117,6 +5737,33 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    GatherSparseSegmentReduce gather_sparse_segment_reduce;
+    if (allow_non_differentiable_rewrites &&
+        FindGatherSparseSegmentReduce(ctx, i, &gather_sparse_segment_reduce)) {
+      TF_RETURN_IF_ERROR(AddGatherSparseSegmentReduceNode(
+          &ctx, gather_sparse_segment_reduce, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap Dequantize+<Activation>+QuantizeV2 into the
+    // _FusedDequantizeQuantize.
+    DequantizeQuantize dequantize_quantize;
+    if (allow_non_differentiable_rewrites &&
+        FindDequantizeQuantize(ctx, i, &dequantize_quantize)) {
+      TF_RETURN_IF_ERROR(AddDequantizeQuantizeNode(
+          &ctx, dequantize_quantize, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    DecodeAndResizeJpeg decode_and_resize_jpeg;
+    if (fuse_decode_and_resize_jpeg &&
+        FindDecodeAndResizeJpeg(ctx, i, &decode_and_resize_jpeg)) {
+      TF_RETURN_IF_ERROR(AddDecodeAndResizeJpegNode(
+          &ctx, decode_and_resize_jpeg, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
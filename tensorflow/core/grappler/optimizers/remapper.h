@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_H_
 
+#include <string>
+
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
@@ -24,15 +27,24 @@ namespace grappler {
 
 // Optimize TF computations by remapping subgraphs/nodes onto other subgraphs or
 // nodes to decrease the amount of operations needed to perform a computation.
+//
+// With `cost_guard` ON, fusions are only applied if the RemapperCostModel
+// predicts them to be faster, using the costs measured on the target found in
+// the OpPerformanceList at `measured_costs_path` when there is one.
 class Remapper : public GraphOptimizer {
  public:
   explicit Remapper(RewriterConfig::Toggle opt_level,
                     RewriterConfig::CpuLayout cpu_layout_conversion =
                         RewriterConfig::NO_CONVERSION_ON_CPU,
-                    bool xla_auto_clustering_on = false)
+                    bool xla_auto_clustering_on = false,
+                    RewriterConfig::Toggle cost_guard = RewriterConfig::OFF,
+                    const std::string& measured_costs_path = "")
       : opt_level_(opt_level),
         cpu_layout_conversion_(cpu_layout_conversion),
-        xla_auto_clustering_on_(xla_auto_clustering_on) {}
+        xla_auto_clustering_on_(xla_auto_clustering_on),
+        cost_guard_(cost_guard == RewriterConfig::ON ||
+                    cost_guard == RewriterConfig::AGGRESSIVE),
+        measured_costs_path_(measured_costs_path) {}
 
   ~Remapper() override {}
 
@@ -47,6 +59,11 @@ class Remapper : public GraphOptimizer {
   RewriterConfig::Toggle opt_level_;
   RewriterConfig::CpuLayout cpu_layout_conversion_;
   bool xla_auto_clustering_on_;
+  bool cost_guard_;
+  std::string measured_costs_path_;
+  // Read from `measured_costs_path_` on first use.
+  bool measured_costs_loaded_ = false;
+  OpPerformanceList measured_costs_;
 };
 
 }  // end namespace grappler
@@ -0,0 +1,180 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/remapper_cost_model.h"
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+std::vector<std::string> GetFusedOps(
+    const google::protobuf::Map<std::string, AttrValue>& attr) {
+  std::vector<std::string> fused_ops;
+  auto it = attr.find("fused_ops");
+  if (it != attr.end()) {
+    for (const auto& op : it->second.list().s()) fused_ops.push_back(op);
+  }
+  return fused_ops;
+}
+
+}  // namespace
+
+RemapperCostModel::RemapperCostModel(const Cluster* cluster,
+                                     const GraphProperties* properties,
+                                     const OpPerformanceList& measured_costs)
+    : cluster_(cluster), properties_(properties) {
+  absl::flat_hash_map<std::string, std::pair<int64_t, int64_t>> totals;
+  for (const OpPerformance& perf : measured_costs.op_performance()) {
+    if (perf.compute_cost() <= 0) continue;
+    const OpInfo& op_info = perf.op();
+    const std::string key = Key(
+        op_info.op(), GetFusedOps(op_info.attr()),
+        {op_info.inputs().begin(), op_info.inputs().end()},
+        op_info.device().type());
+    auto& total = totals[key];
+    total.first += perf.compute_cost();
+    ++total.second;
+  }
+  for (const auto& total : totals) {
+    measured_time_ns_[total.first] = total.second.first / total.second.second;
+  }
+}
+
+/* static */
+std::string RemapperCostModel::Key(
+    const std::string& op, const std::vector<std::string>& fused_ops,
+    const std::vector<OpInfo::TensorProperties>& inputs,
+    const std::string& device_type) {
+  std::string key =
+      absl::StrCat(op, "[", absl::StrJoin(fused_ops, ","), "]@", device_type);
+  for (const auto& input : inputs) {
+    absl::StrAppend(&key, ";", DataTypeString(input.dtype()),
+                    PartialTensorShape::DebugString(input.shape()));
+  }
+  return key;
+}
+
+DeviceProperties RemapperCostModel::GetDevice(const NodeDef& node) const {
+  if (cluster_ != nullptr) {
+    const auto& devices = cluster_->GetDevices();
+    auto it = devices.find(node.device());
+    if (it != devices.end()) return it->second;
+  }
+  DeviceProperties device = GetDeviceInfo(node.device());
+  if (device.type() == "UNKNOWN") return GetLocalCPUInfo();
+  return device;
+}
+
+RemapperCostModel::NodeCost RemapperCostModel::GetNodeCost(
+    const NodeDef& node) const {
+  NodeCost cost;
+  if (!properties_->HasInputProperties(node.name())) return cost;
+  const auto& inputs = properties_->GetInputProperties(node.name());
+  const DeviceProperties device = GetDevice(node);
+
+  auto it = measured_time_ns_.find(
+      Key(node.op(), GetFusedOps(node.attr()), inputs, device.type()));
+  if (it != measured_time_ns_.end()) {
+    cost.execution_time_ns = it->second;
+    cost.compute_time_ns = it->second;
+    cost.known = true;
+    cost.measured = true;
+    return cost;
+  }
+
+  OpContext op_context;
+  op_context.name = node.name();
+  op_context.device_name = node.device();
+  op_context.op_info = BuildOpInfoWithoutDevice(node, {}, inputs);
+  for (const auto& output : properties_->GetOutputProperties(node.name())) {
+    *op_context.op_info.add_outputs() = output;
+  }
+  *op_context.op_info.mutable_device() = device;
+  const Costs costs = estimator_.PredictCosts(op_context);
+  cost.execution_time_ns = costs.execution_time.count();
+  cost.compute_time_ns = costs.compute_time.count();
+  cost.known = !costs.inaccurate && costs.num_ops_with_unknown_shapes == 0;
+  return cost;
+}
+
+bool RemapperCostModel::IsProfitableFusion(
+    const std::vector<const NodeDef*>& nodes, const std::string& fused_op,
+    const std::vector<std::string>& fused_ops) const {
+  if (nodes.empty()) return true;
+
+  int64_t unfused_ns = 0;
+  int64_t fused_ns = 0;
+  bool measured = false;
+  for (int i = 0; i < nodes.size(); ++i) {
+    const NodeCost cost = GetNodeCost(*nodes[i]);
+    if (!cost.known) {
+      VLOG(2) << "Fusing " << nodes[i]->name() << " into " << fused_op
+              << " without knowing its cost";
+      return true;
+    }
+    unfused_ns += cost.execution_time_ns;
+    fused_ns += i == 0 ? cost.execution_time_ns : cost.compute_time_ns;
+    measured |= cost.measured;
+  }
+
+  // The fused node reads the inputs of the subgraph which are not produced in
+  // it, in the order of the nodes.
+  absl::flat_hash_set<std::string> names;
+  for (const NodeDef* node : nodes) names.insert(node->name());
+  std::vector<OpInfo::TensorProperties> fused_inputs;
+  for (const NodeDef* node : nodes) {
+    if (!properties_->HasInputProperties(node->name())) return true;
+    const auto& inputs = properties_->GetInputProperties(node->name());
+    for (int i = 0; i < node->input_size() && i < inputs.size(); ++i) {
+      if (IsControlInput(node->input(i))) break;
+      if (names.contains(NodeName(node->input(i)))) continue;
+      fused_inputs.push_back(inputs[i]);
+    }
+  }
+  const DeviceProperties device = GetDevice(*nodes[0]);
+  auto it = measured_time_ns_.find(
+      Key(fused_op, fused_ops, fused_inputs, device.type()));
+  if (it != measured_time_ns_.end()) {
+    fused_ns = it->second;
+    measured = true;
+  }
+
+  VLOG(2) << "Fusing " << nodes[0]->name() << " into " << fused_op << "["
+          << absl::StrJoin(fused_ops, ",") << "] takes " << fused_ns
+          << " ns instead of " << unfused_ns << " ns"
+          << (measured ? " (measured)" : " (predicted)");
+  return fused_ns <= unfused_ns;
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_COST_MODEL_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_COST_MODEL_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Decides whether the Remapper should replace a matched subgraph with a fused
+// kernel. The costs of the subgraph nodes and of the fused node are taken from
+// `measured_costs` when it has an entry for the same op, fused ops, input
+// types and shapes and device type, e.g. the OpPerformanceList produced by
+// CostGraphToOpPerformanceData from the cost graph of a profiled run, and are
+// predicted by the OpLevelCostEstimator otherwise.
+//
+// The analytical cost of a fused node is the cost of its contraction plus the
+// compute time of the fused ops, whose inputs and outputs no longer go through
+// memory. It is never higher than the cost of the subgraph, so fusions are only
+// rejected when measurements show that the fused kernel is slower on the
+// target.
+class RemapperCostModel {
+ public:
+  // `cluster` may be null. `properties` must have been inferred statically and
+  // outlive the cost model.
+  RemapperCostModel(const Cluster* cluster, const GraphProperties* properties,
+                    const OpPerformanceList& measured_costs);
+
+  // Returns false if replacing `nodes`, a contraction followed by the ops
+  // fused into it, with a `fused_op` node applying `fused_ops` is predicted to
+  // be slower. Fusions whose cost cannot be predicted are accepted.
+  bool IsProfitableFusion(const std::vector<const NodeDef*>& nodes,
+                          const std::string& fused_op,
+                          const std::vector<std::string>& fused_ops) const;
+
+ private:
+  struct NodeCost {
+    int64_t execution_time_ns = 0;
+    int64_t compute_time_ns = 0;
+    bool known = false;
+    bool measured = false;
+  };
+
+  static std::string Key(const std::string& op,
+                         const std::vector<std::string>& fused_ops,
+                         const std::vector<OpInfo::TensorProperties>& inputs,
+                         const std::string& device_type);
+
+  DeviceProperties GetDevice(const NodeDef& node) const;
+  NodeCost GetNodeCost(const NodeDef& node) const;
+
+  const Cluster* cluster_;
+  const GraphProperties* properties_;
+  OpLevelCostEstimator estimator_;
+  // Mean measured execution time in nanoseconds, by Key().
+  absl::flat_hash_map<std::string, int64_t> measured_time_ns_;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMAPPER_COST_MODEL_H_
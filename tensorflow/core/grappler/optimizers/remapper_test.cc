@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/util.h"
 
@@ -1489,6 +1491,102 @@ TEST_F(RemapperTest, FuseMatmulWithAdd) {
   test::ExpectClose(tensors[0], tensors_expected[0], 1e-6);
 }
 
+class RemapperFuseMatMulWithAddUnderCostGuard : public RemapperTest {
+ protected:
+  void SetUp() override {
+    RemapperTest::SetUp();
+    if (IsMKLEnabled()) GTEST_SKIP() << "oneDNN fuses Add without the guard.";
+
+    using ::tensorflow::ops::Placeholder;
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto lhs = Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                           ops::Placeholder::Shape({8, 32}));
+    auto rhs = Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                           ops::Placeholder::Shape({32, 64}));
+    auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs);
+    auto bias = ops::Const(s.WithOpName("bias"), 1.0f, {64});
+    auto add = ops::AddV2(s.WithOpName("add"), matmul, bias);
+    auto relu = ops::Relu(s.WithOpName("relu"), add);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), relu);
+
+    item_.fetch = {"fetch"};
+    item_.feed = {{"lhs", GenerateTensorWithSetRandom<DT_FLOAT>({8, 32})},
+                  {"rhs", GenerateTensorWithSetRandom<DT_FLOAT>({32, 64})}};
+    TF_ASSERT_OK(s.ToGraphDef(&item_.graph));
+    for (int i = 0; i < item_.graph.node_size(); ++i) {
+      item_.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+  }
+
+  const NodeDef* FindRelu(const GraphDef& graph) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == "relu") return &node;
+    }
+    return nullptr;
+  }
+
+  GrapplerItem item_;
+};
+
+TEST_F(RemapperFuseMatMulWithAddUnderCostGuard, Fuses) {
+  GraphDef output;
+  Remapper unguarded(RewriterConfig::ON);
+  TF_ASSERT_OK(unguarded.Optimize(nullptr, item_, &output));
+  ASSERT_NE(FindRelu(output), nullptr);
+  EXPECT_EQ(FindRelu(output)->op(), "Relu");
+
+  Remapper guarded(RewriterConfig::ON, RewriterConfig::NO_CONVERSION_ON_CPU,
+                   /*xla_auto_clustering_on=*/false, RewriterConfig::ON);
+  TF_ASSERT_OK(guarded.Optimize(nullptr, item_, &output));
+  const NodeDef* fused = FindRelu(output);
+  ASSERT_NE(fused, nullptr);
+  EXPECT_EQ(fused->op(), "_FusedMatMul");
+  ASSERT_EQ(fused->input_size(), 3);
+  EXPECT_EQ(fused->input(0), "lhs");
+  EXPECT_EQ(fused->input(1), "rhs");
+  EXPECT_EQ(fused->input(2), "bias");
+  const auto fused_ops = fused->attr().at("fused_ops").list().s();
+  ASSERT_EQ(fused_ops.size(), 2);
+  EXPECT_EQ(fused_ops[0], "BiasAdd");
+  EXPECT_EQ(fused_ops[1], "Relu");
+
+  auto tensors_expected = EvaluateNodes(item_.graph, item_.fetch, item_.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item_.fetch, item_.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectClose(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperFuseMatMulWithAddUnderCostGuard, SkipsSlowerMeasuredFusion) {
+  // The fused kernel was measured to be slower than the unfused ops.
+  OpPerformanceList measured_costs;
+  OpPerformance* perf = measured_costs.add_op_performance();
+  perf->mutable_op()->set_op("_FusedMatMul");
+  AttrValue fused_ops;
+  fused_ops.mutable_list()->add_s("BiasAdd");
+  fused_ops.mutable_list()->add_s("Relu");
+  (*perf->mutable_op()->mutable_attr())["fused_ops"] = fused_ops;
+  for (const auto& dims : std::vector<std::vector<int64_t>>{
+           {8, 32}, {32, 64}, {64}}) {
+    OpInfo::TensorProperties* input = perf->mutable_op()->add_inputs();
+    input->set_dtype(DT_FLOAT);
+    TensorShape(dims).AsProto(input->mutable_shape());
+  }
+  perf->mutable_op()->mutable_device()->set_type("CPU");
+  perf->set_compute_cost(1000000000);
+  const string path =
+      io::JoinPath(testing::TmpDir(), "remapper_measured_costs.pbtxt");
+  TF_ASSERT_OK(WriteTextProto(Env::Default(), path, measured_costs));
+
+  Remapper guarded(RewriterConfig::ON, RewriterConfig::NO_CONVERSION_ON_CPU,
+                   /*xla_auto_clustering_on=*/false, RewriterConfig::ON, path);
+  GraphDef output;
+  TF_ASSERT_OK(guarded.Optimize(nullptr, item_, &output));
+  ASSERT_NE(FindRelu(output), nullptr);
+  EXPECT_EQ(FindRelu(output)->op(), "Relu");
+}
+
 class RemapperFuseSoftplusTanhMul : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -1565,8 +1663,7 @@ TEST_F(RemapperFuseSoftplusTanhMul, BF16) {
 }
 #endif
 
-TEST_F(RemapperTest, FuseMklLayerNorm) {
-  if (!IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to MKL.";
+TEST_F(RemapperTest, FuseLayerNorm) {
   using ::tensorflow::ops::Placeholder;
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
 
@@ -1612,7 +1709,8 @@ TEST_F(RemapperTest, FuseMklLayerNorm) {
   int found = 0;
   for (const NodeDef& node : output.node()) {
     if (node.name() == "add_2") {
-      EXPECT_EQ(node.op(), "_MklLayerNorm");
+      EXPECT_EQ(node.op(),
+                IsMKLEnabled() ? "_MklLayerNorm" : "_FusedLayerNorm");
       ASSERT_GE(node.input_size(), 3);
       EXPECT_EQ(node.input(0), "b_add");
       EXPECT_EQ(node.input(1), "g_const");
@@ -1628,11 +1726,10 @@ TEST_F(RemapperTest, FuseMklLayerNorm) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
 }
 
-class FuseMklLayerNormPattern : public RemapperTest {
+class FuseLayerNormPattern : public RemapperTest {
  public:
   template <DataType DTYPE>
   void RunTest() {
-    if (!IsMKLEnabled()) GTEST_SKIP() << "Test only applicable to MKL.";
     using ::tensorflow::ops::Placeholder;
     tensorflow::Scope s = tensorflow::Scope::NewRootScope();
 
@@ -1678,7 +1775,8 @@ class FuseMklLayerNormPattern : public RemapperTest {
     int found = 0;
     for (const NodeDef& node : output.node()) {
       if (node.name() == "add_2") {
-        EXPECT_EQ(node.op(), "_MklLayerNorm");
+        EXPECT_EQ(node.op(),
+                  IsMKLEnabled() ? "_MklLayerNorm" : "_FusedLayerNorm");
         ASSERT_GE(node.input_size(), 3);
         EXPECT_EQ(node.input(0), "b_add");
         EXPECT_EQ(node.input(1), "g_const");
@@ -1696,7 +1794,7 @@ class FuseMklLayerNormPattern : public RemapperTest {
   }
 };
 
-TEST_F(FuseMklLayerNormPattern, F32) { RunTest<DT_FLOAT>(); }
+TEST_F(FuseLayerNormPattern, F32) { RunTest<DT_FLOAT>(); }
 
 class RemapperTensorToHashBucketTest : public RemapperTest {
  public:
@@ -1766,6 +1864,239 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+class RemapperFuseGatherSparseSegmentReduceTest : public RemapperTest {
+ public:
+  void RunTest(const string& combiner) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto params_shape = ops::Placeholder::Shape({10, 4});
+    auto params = Placeholder(s.WithOpName("params"), DT_FLOAT, params_shape);
+    auto gather_indices =
+        ops::Const(s.WithOpName("gather_indices"), {7, 2, 5, 2}, {4});
+    auto axis = ops::Const(s.WithOpName("axis"), 0);
+    auto gather =
+        ops::GatherV2(s.WithOpName("gather"), params, gather_indices, axis);
+    auto indices = ops::Const(s.WithOpName("indices"), {0, 1, 2, 3, 1}, {5});
+    auto segment_ids =
+        ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 3, 3}, {5});
+    Output reduce;
+    if (combiner == "mean") {
+      reduce = ops::SparseSegmentMean(s.WithOpName("reduce"), gather, indices,
+                                      segment_ids);
+    } else if (combiner == "sqrtn") {
+      reduce = ops::SparseSegmentSqrtN(s.WithOpName("reduce"), gather, indices,
+                                       segment_ids);
+    } else {
+      reduce = ops::SparseSegmentSum(s.WithOpName("reduce"), gather, indices,
+                                     segment_ids);
+    }
+    auto fetch = ops::Identity(s.WithOpName("fetch"), reduce);
+
+    auto params_t = GenerateRandomTensor<DT_FLOAT>({10, 4});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"params", params_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "gather");
+      if (node.name() == "reduce") {
+        EXPECT_EQ(node.op(), "_FusedGatherSparseSegmentReduce");
+        ASSERT_EQ(node.input_size(), 4);
+        EXPECT_EQ(node.input(0), "params");
+        EXPECT_EQ(node.input(1), "gather_indices");
+        EXPECT_EQ(node.input(2), "indices");
+        EXPECT_EQ(node.input(3), "segment_ids");
+        EXPECT_EQ(node.attr().at("combiner").s(), combiner);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+  }
+};
+
+TEST_F(RemapperFuseGatherSparseSegmentReduceTest, Sum) { RunTest("sum"); }
+
+TEST_F(RemapperFuseGatherSparseSegmentReduceTest, Mean) { RunTest("mean"); }
+
+TEST_F(RemapperFuseGatherSparseSegmentReduceTest, SqrtN) { RunTest("sqrtn"); }
+
+class RemapperFuseDecodeAndResizeJpegTest : public RemapperTest {
+ protected:
+  void SetUp() override {
+    setenv("TF_FUSE_DECODE_AND_RESIZE_JPEG", "1", 1 /* replace */);
+  }
+
+  void TearDown() override { unsetenv("TF_FUSE_DECODE_AND_RESIZE_JPEG"); }
+
+  // Encodes a `size` x `size` image, decodes it, and resizes it to
+  // `out_size` x `out_size`.
+  void RunTest(int size, int out_size) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    Tensor image_t(DT_UINT8, TensorShape({size, size, 3}));
+    auto image_values = image_t.flat<uint8>();
+    for (int i = 0; i < image_values.size(); ++i) {
+      image_values(i) = static_cast<uint8>(i * 7 % 256);
+    }
+    auto image = ops::Const(s.WithOpName("image"), Input::Initializer(image_t));
+    auto contents = ops::EncodeJpeg(s.WithOpName("contents"), image);
+    auto decode = ops::DecodeJpeg(s.WithOpName("decode"), contents,
+                                  ops::DecodeJpeg::Channels(3));
+    auto axis = ops::Const(s.WithOpName("axis"), 0);
+    auto expand_dims =
+        ops::ExpandDims(s.WithOpName("expand_dims"), decode, axis);
+    auto out_size_t = ops::Const(s.WithOpName("size"), {out_size, out_size});
+    auto resize = ops::ResizeBilinear(
+        s.WithOpName("resize"), expand_dims, out_size_t,
+        ops::ResizeBilinear::HalfPixelCenters(true));
+    auto fetch = ops::Identity(s.WithOpName("fetch"), resize);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "decode");
+      if (node.name() == "resize") {
+        EXPECT_EQ(node.op(), "_DecodeAndResizeJpeg");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "expand_dims");
+        EXPECT_EQ(node.input(2), "size");
+        EXPECT_TRUE(node.attr().at("half_pixel_centers").b());
+        found++;
+      }
+      if (node.name() == "expand_dims") {
+        EXPECT_EQ(node.input(0), "contents");
+        EXPECT_EQ(node.attr().at("T").type(), DT_STRING);
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 1);
+    ASSERT_EQ(tensors[0].shape(), tensors_expected[0].shape());
+    if (size == out_size) {
+      // The image is decoded at full resolution and is not resized.
+      test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+    }
+  }
+};
+
+TEST_F(RemapperFuseDecodeAndResizeJpegTest, SameSize) { RunTest(16, 16); }
+
+TEST_F(RemapperFuseDecodeAndResizeJpegTest, ScaledDecode) { RunTest(64, 12); }
+
+class RemapperFuseDequantizeQuantizeTest : public RemapperTest {
+ public:
+  void RunTest(const string& activation) {
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    Tensor input_t(DT_QUINT8, TensorShape({4, 64}));
+    auto input_values = input_t.flat<quint8>();
+    for (int i = 0; i < input_values.size(); ++i) {
+      input_values(i) = static_cast<uint8>(i * 7 % 256);
+    }
+    auto input = ops::Const(s.WithOpName("input"), Input::Initializer(input_t));
+    // The input steps are 1/16, so that the dequantized values are exact.
+    auto input_min = ops::Const(s.WithOpName("input_min"), -8.0f);
+    auto input_max = ops::Const(s.WithOpName("input_max"), 7.9375f);
+    auto dequantize = ops::Dequantize(s.WithOpName("dequantize"), input,
+                                      input_min, input_max);
+    Output activated = dequantize;
+    if (activation == "Relu") {
+      activated = ops::Relu(s.WithOpName("activation"), dequantize);
+    }
+    auto min_range = ops::Const(s.WithOpName("min_range"), -1.0f);
+    auto max_range = ops::Const(s.WithOpName("max_range"), 4.0f);
+    auto quantize = ops::QuantizeV2(s.WithOpName("quantize"), activated,
+                                    min_range, max_range, DT_QINT8);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), quantize.output);
+    auto fetch_min = ops::Identity(s.WithOpName("fetch_min"),
+                                   quantize.output_min);
+    auto fetch_max = ops::Identity(s.WithOpName("fetch_max"),
+                                   quantize.output_max);
+
+    GrapplerItem item;
+    item.fetch = {"fetch", "fetch_min", "fetch_max"};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "dequantize");
+      EXPECT_NE(node.name(), "activation");
+      if (node.name() == "quantize") {
+        EXPECT_EQ(node.op(), "_FusedDequantizeQuantize");
+        ASSERT_EQ(node.input_size(), 5);
+        EXPECT_EQ(node.input(0), "input");
+        EXPECT_EQ(node.input(1), "input_min");
+        EXPECT_EQ(node.input(2), "input_max");
+        EXPECT_EQ(node.input(3), "min_range");
+        EXPECT_EQ(node.input(4), "max_range");
+        EXPECT_EQ(node.attr().at("Tinput").type(), DT_QUINT8);
+        EXPECT_EQ(node.attr().at("T").type(), DT_QINT8);
+        const string expected_activation =
+            activation.empty() ? "Identity" : activation;
+        EXPECT_EQ(node.attr().at("activation").s(), expected_activation);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    ASSERT_EQ(tensors_expected.size(), 3);
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 3);
+    test::ExpectTensorEqual<qint8>(tensors[0], tensors_expected[0]);
+    test::ExpectTensorEqual<float>(tensors[1], tensors_expected[1]);
+    test::ExpectTensorEqual<float>(tensors[2], tensors_expected[2]);
+  }
+};
+
+TEST_F(RemapperFuseDequantizeQuantizeTest, Requantize) { RunTest(""); }
+
+TEST_F(RemapperFuseDequantizeQuantizeTest, Relu) { RunTest("Relu"); }
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/rematerialization_planner.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+std::string TensorName(const std::string& node, int output_id) {
+  return absl::StrCat(node, ":", output_id);
+}
+
+}  // namespace
+
+std::string RematerializationPlan::ToString() const {
+  std::string out = absl::StrCat(
+      "rematerialization on ", device, ": peak ", peak_bytes, " bytes, budget ",
+      budget_bytes, " bytes, saved ", saved_bytes, " bytes",
+      FitsBudget() ? "" : " (over budget)", ", added ", added_time_ns, "ns");
+  for (const Decision& decision : decisions) {
+    absl::StrAppend(&out, "; ",
+                    decision.action == Action::kRecompute ? "recompute "
+                                                          : "swap ",
+                    decision.node, ":", decision.output_id, " (",
+                    decision.bytes, " bytes, ", decision.added_time_ns, "ns)");
+  }
+  return out;
+}
+
+RematerializationPlan PlanRematerialization(
+    const std::string& device, int64_t peak_bytes, int64_t budget_bytes,
+    const std::vector<RematerializationCandidate>& candidates) {
+  RematerializationPlan plan;
+  plan.device = device;
+  plan.peak_bytes = peak_bytes;
+  plan.budget_bytes = budget_bytes;
+  if (plan.FitsBudget()) return plan;
+
+  // Take the cheapest way to rematerialize each candidate.
+  std::vector<RematerializationPlan::Decision> options;
+  absl::flat_hash_map<std::string, const RematerializationCandidate*>
+      candidates_by_tensor;
+  for (const RematerializationCandidate& candidate : candidates) {
+    candidates_by_tensor[TensorName(candidate.node, candidate.output_id)] =
+        &candidate;
+    if (candidate.bytes <= 0) continue;
+    RematerializationPlan::Decision decision;
+    decision.node = candidate.node;
+    decision.output_id = candidate.output_id;
+    decision.bytes = candidate.bytes;
+    if (candidate.can_swap) {
+      decision.action = RematerializationPlan::Action::kSwap;
+      decision.added_time_ns = std::max<int64_t>(
+          0, 2 * candidate.swap_time_ns - candidate.time_to_next_use_ns);
+    }
+    if (candidate.can_recompute &&
+        (!candidate.can_swap ||
+         candidate.recompute_time_ns < decision.added_time_ns)) {
+      decision.action = RematerializationPlan::Action::kRecompute;
+      decision.added_time_ns = candidate.recompute_time_ns;
+    }
+    if (candidate.can_swap || candidate.can_recompute) {
+      options.push_back(decision);
+    }
+  }
+
+  // Greedily take the candidates which add the least time per saved byte,
+  // preferring the larger ones for the same cost.
+  std::sort(options.begin(), options.end(),
+            [](const RematerializationPlan::Decision& a,
+               const RematerializationPlan::Decision& b) {
+              const double cost_a = static_cast<double>(a.added_time_ns) *
+                                    static_cast<double>(b.bytes);
+              const double cost_b = static_cast<double>(b.added_time_ns) *
+                                    static_cast<double>(a.bytes);
+              if (cost_a != cost_b) return cost_a < cost_b;
+              if (a.bytes != b.bytes) return a.bytes > b.bytes;
+              return std::make_pair(a.node, a.output_id) <
+                     std::make_pair(b.node, b.output_id);
+            });
+  // The inputs of the recomputations must stay in memory.
+  absl::flat_hash_set<std::string> rematerialized;
+  absl::flat_hash_set<std::string> pinned;
+  for (const auto& option : options) {
+    if (plan.FitsBudget()) break;
+    const std::string tensor = TensorName(option.node, option.output_id);
+    if (pinned.contains(tensor)) continue;
+    const std::vector<std::string>& inputs =
+        candidates_by_tensor.at(tensor)->recompute_inputs;
+    if (option.action == RematerializationPlan::Action::kRecompute) {
+      if (std::any_of(inputs.begin(), inputs.end(),
+                      [&](const std::string& input) {
+                        return rematerialized.contains(input);
+                      })) {
+        continue;
+      }
+      pinned.insert(inputs.begin(), inputs.end());
+    }
+    rematerialized.insert(tensor);
+    plan.decisions.push_back(option);
+    plan.saved_bytes += option.bytes;
+  }
+
+  // A large candidate taken last can make some of the cheaper ones unneeded:
+  // drop the most expensive decisions the plan fits without.
+  if (plan.FitsBudget()) {
+    for (int i = plan.decisions.size() - 1; i >= 0; --i) {
+      const int64_t bytes = plan.decisions[i].bytes;
+      if (plan.peak_bytes - (plan.saved_bytes - bytes) <= budget_bytes) {
+        plan.saved_bytes -= bytes;
+        plan.decisions.erase(plan.decisions.begin() + i);
+      }
+    }
+  }
+  for (const auto& decision : plan.decisions) {
+    plan.added_time_ns += decision.added_time_ns;
+  }
+  return plan;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
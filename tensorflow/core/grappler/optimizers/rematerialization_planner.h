@@ -0,0 +1,84 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMATERIALIZATION_PLANNER_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMATERIALIZATION_PLANNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tensorflow {
+namespace grappler {
+
+// A tensor live at the memory peak of a device which is only read again after
+// the peak, and can therefore be dropped during the peak and rematerialized,
+// either by recomputing it or by swapping it to host memory and back.
+struct RematerializationCandidate {
+  std::string node;
+  int output_id = 0;
+  int64_t bytes = 0;
+
+  // Recomputing the tensor runs `node` again, from `recompute_inputs` tensors,
+  // "node:output_id", which are live at the peak anyway and must therefore not
+  // be rematerialized themselves.
+  bool can_recompute = false;
+  int64_t recompute_time_ns = 0;
+  std::vector<std::string> recompute_inputs;
+
+  // Swapping the tensor copies it out and back in, which adds no computation,
+  // and only delays the step if the copies take longer than the time between
+  // the peak and the next use of the tensor.
+  bool can_swap = false;
+  int64_t swap_time_ns = 0;
+  int64_t time_to_next_use_ns = 0;
+};
+
+struct RematerializationPlan {
+  enum class Action { kRecompute, kSwap };
+
+  struct Decision {
+    std::string node;
+    int output_id = 0;
+    int64_t bytes = 0;
+    Action action = Action::kRecompute;
+    int64_t added_time_ns = 0;
+  };
+
+  std::string device;
+  int64_t peak_bytes = 0;
+  int64_t budget_bytes = 0;
+  std::vector<Decision> decisions;
+  int64_t saved_bytes = 0;
+  // Time added to the step by the recomputations and the exposed copies.
+  int64_t added_time_ns = 0;
+
+  bool FitsBudget() const { return peak_bytes - saved_bytes <= budget_bytes; }
+
+  std::string ToString() const;
+};
+
+// Returns the cheapest decisions, in time added to the step per byte saved,
+// for rematerializing `candidates` until the peak memory of `device` fits
+// under `budget_bytes`. Decisions are taken greedily, so the plan may not fit
+// the budget if the candidates cannot save enough memory.
+RematerializationPlan PlanRematerialization(
+    const std::string& device, int64_t peak_bytes, int64_t budget_bytes,
+    const std::vector<RematerializationCandidate>& candidates);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_REMATERIALIZATION_PLANNER_H_
@@ -0,0 +1,105 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/rematerialization_planner.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+RematerializationCandidate Recompute(const std::string& node, int64_t bytes,
+                                     int64_t time_ns) {
+  RematerializationCandidate candidate;
+  candidate.node = node;
+  candidate.bytes = bytes;
+  candidate.can_recompute = true;
+  candidate.recompute_time_ns = time_ns;
+  return candidate;
+}
+
+TEST(RematerializationPlannerTest, FitsWithoutDecisions) {
+  RematerializationPlan plan =
+      PlanRematerialization("gpu:0", 100, 200, {Recompute("a", 50, 1)});
+  EXPECT_TRUE(plan.FitsBudget());
+  EXPECT_TRUE(plan.decisions.empty());
+}
+
+TEST(RematerializationPlannerTest, TakesCheapestPerByte) {
+  RematerializationPlan plan = PlanRematerialization(
+      "gpu:0", 1000, 800,
+      {Recompute("a", 100, 1000), Recompute("b", 200, 100),
+       Recompute("c", 100, 50)});
+  EXPECT_TRUE(plan.FitsBudget());
+  ASSERT_EQ(plan.decisions.size(), 1);
+  EXPECT_EQ(plan.decisions[0].node, "b");
+  EXPECT_EQ(plan.saved_bytes, 200);
+  EXPECT_EQ(plan.added_time_ns, 100);
+}
+
+TEST(RematerializationPlannerTest, DropsUnneededDecisions) {
+  // "c" is the cheapest per byte, but "b" alone is enough once taken.
+  RematerializationPlan plan = PlanRematerialization(
+      "gpu:0", 1000, 700,
+      {Recompute("b", 300, 150), Recompute("c", 100, 10)});
+  EXPECT_TRUE(plan.FitsBudget());
+  ASSERT_EQ(plan.decisions.size(), 1);
+  EXPECT_EQ(plan.decisions[0].node, "b");
+}
+
+TEST(RematerializationPlannerTest, SwapsWhenCopiesAreHidden) {
+  RematerializationCandidate hidden = Recompute("a", 1600, 500);
+  hidden.can_swap = true;
+  hidden.swap_time_ns = 100;
+  hidden.time_to_next_use_ns = 1000;
+  RematerializationCandidate exposed = Recompute("b", 1600, 50);
+  exposed.can_swap = true;
+  exposed.swap_time_ns = 100;
+  exposed.time_to_next_use_ns = 0;
+  RematerializationPlan plan =
+      PlanRematerialization("gpu:0", 4000, 800, {hidden, exposed});
+  EXPECT_TRUE(plan.FitsBudget());
+  ASSERT_EQ(plan.decisions.size(), 2);
+  EXPECT_EQ(plan.decisions[0].node, "a");
+  EXPECT_EQ(plan.decisions[0].action, RematerializationPlan::Action::kSwap);
+  EXPECT_EQ(plan.decisions[0].added_time_ns, 0);
+  EXPECT_EQ(plan.decisions[1].node, "b");
+  EXPECT_EQ(plan.decisions[1].action,
+            RematerializationPlan::Action::kRecompute);
+  EXPECT_EQ(plan.added_time_ns, 50);
+}
+
+TEST(RematerializationPlannerTest, KeepsRecomputeInputs) {
+  RematerializationCandidate b = Recompute("b", 100, 10);
+  b.recompute_inputs = {"a:0"};
+  RematerializationPlan plan = PlanRematerialization(
+      "gpu:0", 1000, 700, {Recompute("a", 200, 10), b});
+  EXPECT_FALSE(plan.FitsBudget());
+  ASSERT_EQ(plan.decisions.size(), 1);
+  EXPECT_EQ(plan.decisions[0].node, "a");
+  EXPECT_EQ(plan.saved_bytes, 200);
+  EXPECT_EQ(plan.ToString(),
+            "rematerialization on gpu:0: peak 1000 bytes, budget 700 bytes, "
+            "saved 200 bytes (over budget), added 10ns; recompute a:0 (200 "
+            "bytes, 10ns)");
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -524,7 +524,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
     sa_builder.Attr("id", sa_id);
     sa_builder.Attr("shapes", input_shapes);
     sa_builder.Attr("shape", sa_shape);
-    sa_builder.Attr("expected_call_count", static_cast<int64_t>(ops.size()));
+    sa_builder.Attr("expected_call_count", static_cast<int64_t>(inputs.size()));
     NodeDef* sa_node = graph->add_node();
     LOG_WARNING_AND_RETURN_IF_ERROR(sa_builder.Finalize(sa_node));
     node_map->AddNode(sa_name, sa_node);
@@ -889,22 +889,239 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Returns true if `shape` has a known rank and no unknown dimensions.
+bool IsFullyDefined(const TensorShapeProto& shape) {
+  return !shape.unknown_rank() && TensorShape::IsValid(shape);
+}
+
+// Rewrites a ConcatV2 whose values are laid out contiguously along the concat
+// axis so that its producers write their outputs directly into consecutive
+// fields of a single ScopedAllocator backing tensor.  The ConcatV2 is then
+// replaced in place by a _ScopedAllocatorConcat that outputs the backing
+// tensor reshaped to the concat output shape, which removes the copy done by
+// the concat and the separate lifetimes of its inputs.
+//
+// The rewrite only applies when all dimensions before the concat axis are 1
+// and every value but the last occupies a multiple of kAllocatorAlignment
+// bytes, so that the fields of the backing tensor are packed without padding.
+// Concats that don't qualify are left unchanged.
+class ConcatRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~ConcatRewriter() override {}
+
+  bool RewritesSingleNodes() const override { return true; }
+
+  // Returns true if `concat` can be rewritten, in which case *inputs,
+  // *input_shapes, *dtype and *output_shape are populated.  Nothing is
+  // modified by this function.
+  bool CanRewrite(ScopedAllocatorOptimizer* sa_opti, NodeDef* concat,
+                  int num_values, std::vector<InputDesc>* inputs,
+                  std::vector<TensorShape>* input_shapes, DataType* dtype,
+                  TensorShape* output_shape) {
+    NodeMap* node_map = sa_opti->node_map();
+    if (concat->device().empty() ||
+        HasNodeAttr(*concat, kScopedAllocatorAttrName)) {
+      return false;
+    }
+    if (!GetNodeAttr(AttrSlice(*concat), "T", dtype).ok() ||
+        !DataTypeCanUseMemcpy(*dtype) ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return false;
+    }
+
+    if (!graph_properties_->HasOutputProperties(concat->name()) ||
+        !graph_properties_->HasInputProperties(concat->name())) {
+      return false;
+    }
+    const auto& output_props =
+        graph_properties_->GetOutputProperties(concat->name());
+    const auto& input_props =
+        graph_properties_->GetInputProperties(concat->name());
+    if (output_props.size() != 1 || input_props.size() != static_cast<size_t>(num_values) + 1 ||
+        !IsFullyDefined(output_props[0].shape())) {
+      return false;
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+
+    // The axis must be a constant.
+    const NodeDef* axis_node = node_map->GetNode(concat->input(num_values));
+    if (axis_node == nullptr || !IsConstant(*axis_node)) {
+      return false;
+    }
+    Tensor axis_tensor;
+    if (!HasNodeAttr(*axis_node, "value") ||
+        !axis_tensor.FromProto(axis_node->attr().at("value").tensor()) ||
+        axis_tensor.NumElements() != 1 ||
+        (axis_tensor.dtype() != DT_INT32 && axis_tensor.dtype() != DT_INT64)) {
+      return false;
+    }
+    int64_t axis = axis_tensor.dtype() == DT_INT32
+                       ? axis_tensor.flat<int32>()(0)
+                       : axis_tensor.flat<int64_t>()(0);
+    const int rank = output_shape->dims();
+    if (axis < 0) axis += rank;
+    if (axis < 0 || axis >= rank) {
+      return false;
+    }
+    // With leading dimensions of size 1 each value is a contiguous slice of
+    // the output.
+    for (int d = 0; d < axis; ++d) {
+      if (output_shape->dim_size(d) != 1) {
+        return false;
+      }
+    }
+
+    absl::flat_hash_set<const NodeDef*> producers;
+    for (int i = 0; i < num_values; ++i) {
+      const string& input_name = concat->input(i);
+      if (IsControlInput(input_name)) {
+        return false;
+      }
+      int output_slot = 0;
+      ParseNodeName(input_name, &output_slot);
+      NodeDef* producer = node_map->GetNode(input_name);
+      if (producer == nullptr || producer->device() != concat->device() ||
+          !producers.insert(producer).second) {
+        return false;
+      }
+      // These ops either don't allocate their outputs or produce tensors that
+      // must outlive the step.
+      if (IsConstant(*producer) || IsArg(*producer) ||
+          IsPlaceholder(*producer) || IsVariable(*producer) ||
+          IsMerge(*producer) || IsSwitch(*producer) ||
+          ModifiesFrameInfo(*producer) ||
+          HasNodeAttr(*producer, kScopedAllocatorAttrName) ||
+          sa_opti->nodes_to_preserve().count(producer->name()) > 0) {
+        return false;
+      }
+      // The ScopedAllocator node is delayed by a control edge from one of the
+      // data inputs of the producers, which also keeps it in their frame.
+      bool has_data_input = false;
+      for (const string& producer_input : producer->input()) {
+        has_data_input |= !IsControlInput(producer_input);
+      }
+      if (!has_data_input) {
+        return false;
+      }
+      // The value must be consumed by the concat only, otherwise other
+      // consumers would observe the backing tensor through the field.
+      int num_consumers = 0;
+      for (const NodeDef* output : node_map->GetOutputs(producer->name())) {
+        for (const string& output_input : output->input()) {
+          int position = 0;
+          if (ParseNodeName(output_input, &position) == producer->name() &&
+              position == output_slot) {
+            ++num_consumers;
+          }
+        }
+      }
+      if (num_consumers != 1) {
+        return false;
+      }
+      const auto& shape = input_props[i].shape();
+      if (input_props[i].dtype() != *dtype || !IsFullyDefined(shape)) {
+        return false;
+      }
+      TensorShape input_shape(shape);
+      const int64_t num_bytes =
+          input_shape.num_elements() * DataTypeSize(*dtype);
+      if (num_bytes == 0 ||
+          (i + 1 < num_values &&
+           num_bytes % Allocator::kAllocatorAlignment != 0)) {
+        return false;
+      }
+      input_shapes->push_back(input_shape);
+      inputs->emplace_back(producer, output_slot, concat);
+    }
+    return true;
+  }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    CHECK_EQ(ops.size(), 1);
+    NodeDef* concat = ops[0];
+    NodeMap* node_map = sa_opti->node_map();
+    int num_values = 0;
+    if (!GetNodeAttr(AttrSlice(*concat), "N", &num_values).ok() ||
+        num_values < 2 || concat->input_size() <= num_values) {
+      return OkStatus();
+    }
+
+    DataType dtype;
+    std::vector<TensorShape> input_shapes;
+    std::vector<InputDesc> inputs;
+    TensorShape output_shape;
+    if (!CanRewrite(sa_opti, concat, num_values, &inputs, &input_shapes,
+                    &dtype, &output_shape)) {
+      VLOG(1) << "ScopedAllocatorOptimizer skipping " << concat->name();
+      return OkStatus();
+    }
+    VLOG(1) << "ConcatRewriter::Rewrite " << concat->name();
+
+    std::vector<ScopedAllocator::Field> sa_fields;
+    int64_t num_bytes = ScopedAllocatorMgr::PopulateFields(
+        0 /*scope_id*/, input_shapes, dtype, &sa_fields);
+    TensorShape sa_shape({num_bytes / DataTypeSize(dtype)});
+    int sa_id = sa_opti->NewScopedAllocatorId(input_shapes.size());
+    string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        sa_opti, graph, node_map, ops, concat->device(), dtype, sa_id, sa_name,
+        input_shapes, inputs, sa_shape));
+
+    // Replace the concat in place so that its consumers and fetches of its
+    // output are unaffected.  The axis becomes a control input.
+    std::vector<string> value_inputs(concat->input().begin(),
+                                     concat->input().begin() + num_values);
+    string axis_name = NodeName(concat->input(num_values));
+    std::vector<string> control_inputs(
+        concat->input().begin() + num_values + 1, concat->input().end());
+    concat->clear_input();
+    concat->add_input(sa_name);
+    node_map->AddOutput(sa_name, concat->name());
+    for (const string& input : value_inputs) {
+      concat->add_input(input);
+    }
+    concat->add_input(AsControlDependency(axis_name));
+    for (const string& input : control_inputs) {
+      concat->add_input(input);
+    }
+    concat->set_op("_ScopedAllocatorConcat");
+    concat->clear_attr();
+    AddNodeAttr("shape", output_shape, concat);
+    AddNodeAttr("T", dtype, concat);
+    AddNodeAttr("reshape", true, concat);
+    AddNodeAttr("sa_name", sa_name, concat);
+    AddNodeAttr("id", sa_id, concat);
+    AddNodeAttr("N", num_values, concat);
+
+    *applied = true;
+    return OkStatus();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* concat_rewriter = new ConcatRewriter();
+  to_delete_.push_back(concat_rewriter);
+  auto rewriter_for = [r, concat_rewriter](const string& op_name) {
+    return op_name == "ConcatV2" ? concat_rewriter : r;
+  };
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
-    for (const auto& op_name : {"CollectiveReduce"}) {
+    for (const auto& op_name : {"CollectiveReduce", "ConcatV2"}) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = rewriter_for(op_name);
     }
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = rewriter_for(op_name);
     }
   }
 }
@@ -1110,6 +1327,22 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesSingleNodes()) {
+          std::vector<NodeDef*> nodes = it.second;
+          status = OrderNodeSet(&nodes);
+          for (NodeDef* node : nodes) {
+            if (!status.ok()) {
+              break;
+            }
+            bool applied = false;
+            status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                       {node}, &applied);
+          }
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -76,6 +76,12 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
     return repeated_outputs_;
   }
 
+  // Nodes of the item being optimized that must not be removed or renamed,
+  // typically fetch nodes.
+  const std::unordered_set<string>& nodes_to_preserve() const {
+    return nodes_to_preserve_;
+  }
+
   // Appends values to the attr value under name in node_def, if present.
   // If not present does an assignment.
   static void ExtendNodeAttr(StringPiece name, const std::vector<int32>& values,
@@ -93,6 +99,10 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // If true, Rewrite is called separately for every instance of the op
+    // rather than for groups of logically parallel instances.
+    virtual bool RewritesSingleNodes() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
@@ -279,11 +279,43 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     }
   }
 
+  // Constructs the following graph.
+  //
+  // a and b are Const ops of shape [2, n].  s1 is an Add op, s2 is a Sub op,
+  // and concat is a ConcatV2 along `axis`.
+  /*
+        a    b
+        |\  /|
+        | \/ |
+        | /\ |
+        |/  \|
+        s1   s2
+         \   /
+         concat
+  */
+  void BuildConcatGraph(GraphDef* graph_def, int n, int axis) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    std::vector<float> a_values, b_values;
+    for (int i = 0; i < 2 * n; ++i) {
+      a_values.push_back(i);
+      b_values.push_back(2 * i);
+    }
+    Output a = ops::Const<float>(s.WithOpName("a"), a_values, {2, n});
+    Output b = ops::Const<float>(s.WithOpName("b"), b_values, {2, n});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Sub(s.WithOpName("s2"), a, b);
+    Output concat = ops::Concat(s.WithOpName("concat"), {s1, s2}, axis);
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   // Invokes ScopedAllocatorOptimizer on `graph_def`, then executes it and
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const string& enable_op = "Abs") {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +329,7 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    rwcfg->mutable_scoped_allocator_opts()->add_enable_op(enable_op);
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -596,6 +628,69 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewriteOnly) {
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*n=*/16, /*axis=*/0);
+  item.fetch = {"concat"};
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  // The concat keeps its name and reads the backing tensor that s1 and s2
+  // write into.
+  NodeMap node_map(&optimized_graph);
+  NodeDef* concat = nullptr;
+  GetNode(&node_map, "concat", &concat);
+  EXPECT_EQ(concat->op(), "_ScopedAllocatorConcat");
+  ASSERT_EQ(concat->input_size(), 4);
+  EXPECT_EQ(concat->input(1), "s1");
+  EXPECT_EQ(concat->input(2), "s2");
+  EXPECT_TRUE(IsControlInput(concat->input(3)));
+  NodeDef* sa_node = ValidateSAControlInput(&optimized_graph, &node_map, "s1");
+  EXPECT_EQ(sa_node, ValidateSAControlInput(&optimized_graph, &node_map, "s2"));
+  EXPECT_EQ(NodeName(concat->input(0)), sa_node->name());
+
+  TensorShape shape;
+  TF_ASSERT_OK(GetNodeAttr(AttrSlice(*concat), "shape", &shape));
+  EXPECT_EQ(shape, TensorShape({4, 16}));
+  bool reshape = false;
+  TF_ASSERT_OK(GetNodeAttr(AttrSlice(*concat), "reshape", &reshape));
+  EXPECT_TRUE(reshape);
+  int64_t expected_call_count = 0;
+  TF_ASSERT_OK(GetNodeAttr(AttrSlice(*sa_node), "expected_call_count",
+                           &expected_call_count));
+  EXPECT_EQ(expected_call_count, 2);
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*n=*/16, /*axis=*/0);
+  std::vector<Tensor> expected = EvaluateNodes(graph_def, {"concat"});
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"concat:0"}, &outputs,
+               /*enable_op=*/"ConcatV2");
+  test::ExpectTensorEqual<float>(expected[0], outputs[0]);
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatWithPaddingNotRewritten) {
+  // Values of 6 floats would need padding between the fields of the backing
+  // tensor, so the concat is left alone.
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*n=*/3, /*axis=*/0);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+  for (const NodeDef& node : optimized_graph.node()) {
+    EXPECT_NE(node.op(), "_ScopedAllocator");
+    EXPECT_NE(node.op(), "_ScopedAllocatorConcat");
+  }
+}
 #endif  // ENABLE_MKL
 
 }  // namespace
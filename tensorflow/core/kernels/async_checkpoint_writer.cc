@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace checkpoint {
+
+const absl::string_view kAsyncCheckpointWriterResourceName =
+    "async_checkpoint_writer";
+
+namespace {
+
+void RecordStallDuration(int64_t stall_micros) {
+  static auto* cell = monitoring::Sampler<0>::New(
+      {"/tensorflow/core/checkpoint/write/async_save_stall_durations",
+       "Distribution of the time in microseconds that SaveV2 waited for "
+       "earlier asynchronous saves to finish."},
+      // Scale of 1000, power of 1.5 with bucket count 41 (~41 hours).
+      monitoring::Buckets::Exponential(1000, 1.5, 41));
+  cell->GetCell()->Add(stall_micros);
+}
+
+}  // namespace
+
+AsyncCheckpointWriter::AsyncCheckpointWriter(int max_pending_saves)
+    : max_pending_saves_(max_pending_saves),
+      writer_thread_(std::make_unique<thread::ThreadPool>(
+          Env::Default(), "async_checkpoint_writer", 1)) {
+  DCHECK_GT(max_pending_saves_, 0);
+}
+
+AsyncCheckpointWriter::~AsyncCheckpointWriter() {
+  Status status = WaitForAll();
+  if (!status.ok()) {
+    LOG(ERROR) << "Asynchronous checkpoint save failed: " << status;
+  }
+}
+
+void AsyncCheckpointWriter::Schedule(absl::string_view prefix,
+                                     std::function<Status()> write) {
+  const std::string prefix_string(prefix);
+  {
+    mutex_lock l(mu_);
+    if (num_pending_saves_ >= max_pending_saves_) {
+      const uint64 start_micros = Env::Default()->NowMicros();
+      while (num_pending_saves_ >= max_pending_saves_) {
+        save_done_.wait(l);
+      }
+      RecordStallDuration(Env::Default()->NowMicros() - start_micros);
+    }
+    ++num_pending_saves_;
+    ++pending_saves_[prefix_string];
+  }
+  writer_thread_->Schedule([this, prefix_string, write = std::move(write)]() {
+    const Status status = write();
+    mutex_lock l(mu_);
+    if (!status.ok()) {
+      LOG(ERROR) << "Asynchronous save of " << prefix_string
+                 << " failed: " << status;
+      errors_[prefix_string].Update(status);
+    }
+    if (--pending_saves_[prefix_string] == 0) {
+      pending_saves_.erase(prefix_string);
+    }
+    --num_pending_saves_;
+    save_done_.notify_all();
+  });
+}
+
+Status AsyncCheckpointWriter::WaitForPrefix(absl::string_view prefix) {
+  const std::string prefix_string(prefix);
+  mutex_lock l(mu_);
+  while (pending_saves_.contains(prefix_string)) {
+    save_done_.wait(l);
+  }
+  auto it = errors_.find(prefix_string);
+  if (it == errors_.end()) return OkStatus();
+  const Status status = std::move(it->second);
+  errors_.erase(it);
+  return status;
+}
+
+Status AsyncCheckpointWriter::WaitForAll() {
+  mutex_lock l(mu_);
+  while (num_pending_saves_ > 0) {
+    save_done_.wait(l);
+  }
+  Status status;
+  for (const auto& [prefix, error] : errors_) {
+    status.Update(error);
+  }
+  errors_.clear();
+  return status;
+}
+
+}  // namespace checkpoint
+}  // namespace tensorflow
@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+#define TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/base/attributes.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/resource_base.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace checkpoint {
+
+ABSL_CONST_INIT extern const absl::string_view
+    kAsyncCheckpointWriterResourceName;
+
+// Writes checkpoint bundles on a background thread, so that SaveV2 can return
+// as soon as it has handed over the tensors to save.
+//
+// The tensors are kept by reference rather than copied. Resource variables
+// copy their buffer before updating it in place while it is shared, so the
+// saved values are those of the step that ran SaveV2 even as training goes on.
+//
+// The saves run one at a time, in the order they are scheduled. At most
+// `max_pending_saves` are pending: scheduling another one blocks until the
+// oldest finishes, and the blocked time is exported as
+// /tensorflow/core/checkpoint/write/async_save_stall_durations.
+//
+// This object is thread-safe.
+class AsyncCheckpointWriter : public ResourceBase {
+ public:
+  // REQUIRES: max_pending_saves > 0
+  explicit AsyncCheckpointWriter(int max_pending_saves);
+
+  // Waits for the pending saves.
+  ~AsyncCheckpointWriter() override;
+
+  AsyncCheckpointWriter(const AsyncCheckpointWriter&) = delete;
+  AsyncCheckpointWriter& operator=(const AsyncCheckpointWriter&) = delete;
+
+  std::string DebugString() const override { return "AsyncCheckpointWriter"; }
+
+  // Schedules `write`, which writes the bundle at `prefix`, blocking while
+  // there are already `max_pending_saves` pending saves.
+  void Schedule(absl::string_view prefix, std::function<Status()> write)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Waits for the pending saves of the bundle at `prefix`. Returns the error
+  // of the first of them that failed since the last wait for `prefix`.
+  Status WaitForPrefix(absl::string_view prefix) TF_LOCKS_EXCLUDED(mu_);
+
+  // Waits for all the pending saves. Returns the first error since the last
+  // wait, if any.
+  Status WaitForAll() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const int max_pending_saves_;
+
+  mutex mu_;
+  condition_variable save_done_;
+  int num_pending_saves_ TF_GUARDED_BY(mu_) = 0;
+  // The number of pending saves of each prefix.
+  absl::flat_hash_map<std::string, int> pending_saves_ TF_GUARDED_BY(mu_);
+  // The first error of each prefix that hasn't been waited for.
+  absl::flat_hash_map<std::string, Status> errors_ TF_GUARDED_BY(mu_);
+
+  // A single thread, so that the saves run in order.
+  std::unique_ptr<thread::ThreadPool> writer_thread_;
+};
+
+}  // namespace checkpoint
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_ASYNC_CHECKPOINT_WRITER_H_
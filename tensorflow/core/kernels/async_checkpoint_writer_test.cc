@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace checkpoint {
+namespace {
+
+using monitoring::testing::CellReader;
+
+TEST(AsyncCheckpointWriterTest, RunsSavesInOrder) {
+  auto writer = std::make_unique<AsyncCheckpointWriter>(2);
+  mutex mu;
+  std::vector<int> saves;
+  for (int i = 0; i < 5; ++i) {
+    writer->Schedule("/tmp/ckpt", [&, i]() {
+      mutex_lock l(mu);
+      saves.push_back(i);
+      return OkStatus();
+    });
+  }
+  TF_EXPECT_OK(writer->WaitForPrefix("/tmp/ckpt"));
+  mutex_lock l(mu);
+  EXPECT_EQ(saves, std::vector<int>({0, 1, 2, 3, 4}));
+}
+
+TEST(AsyncCheckpointWriterTest, WaitsForPrefix) {
+  AsyncCheckpointWriter writer(2);
+  Notification start_save;
+  bool saved = false;
+  writer.Schedule("/tmp/ckpt-1", [&]() {
+    start_save.WaitForNotification();
+    saved = true;
+    return OkStatus();
+  });
+  // There is nothing to wait for another prefix.
+  TF_EXPECT_OK(writer.WaitForPrefix("/tmp/ckpt-2"));
+
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      {}, "notifier", [&]() { start_save.Notify(); }));
+  TF_EXPECT_OK(writer.WaitForPrefix("/tmp/ckpt-1"));
+  EXPECT_TRUE(saved);
+}
+
+TEST(AsyncCheckpointWriterTest, ReportsErrorsOnce) {
+  AsyncCheckpointWriter writer(1);
+  writer.Schedule("/tmp/ckpt-1",
+                  []() { return errors::DataLoss("Failed to write"); });
+  writer.Schedule("/tmp/ckpt-2", []() { return OkStatus(); });
+  TF_EXPECT_OK(writer.WaitForPrefix("/tmp/ckpt-2"));
+  EXPECT_TRUE(errors::IsDataLoss(writer.WaitForPrefix("/tmp/ckpt-1")));
+  TF_EXPECT_OK(writer.WaitForPrefix("/tmp/ckpt-1"));
+
+  writer.Schedule("/tmp/ckpt-3",
+                  []() { return errors::DataLoss("Failed to write"); });
+  EXPECT_TRUE(errors::IsDataLoss(writer.WaitForAll()));
+  TF_EXPECT_OK(writer.WaitForAll());
+}
+
+TEST(AsyncCheckpointWriterTest, BoundsPendingSaves) {
+  CellReader<monitoring::testing::Histogram> stall_durations(
+      "/tensorflow/core/checkpoint/write/async_save_stall_durations");
+  AsyncCheckpointWriter writer(1);
+  Notification start_save;
+  writer.Schedule("/tmp/ckpt-1", [&]() {
+    start_save.WaitForNotification();
+    return OkStatus();
+  });
+  std::unique_ptr<Thread> thread(
+      Env::Default()->StartThread({}, "notifier", [&]() {
+        Env::Default()->SleepForMicroseconds(10000);
+        start_save.Notify();
+      }));
+  // Blocks until the first save is done.
+  writer.Schedule("/tmp/ckpt-2", []() { return OkStatus(); });
+  EXPECT_TRUE(start_save.HasBeenNotified());
+  TF_EXPECT_OK(writer.WaitForAll());
+  EXPECT_EQ(stall_durations.Delta().num(), 1);
+}
+
+}  // namespace
+}  // namespace checkpoint
+}  // namespace tensorflow
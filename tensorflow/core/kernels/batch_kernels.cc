@@ -60,6 +60,8 @@ constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
 constexpr char kFullBatchSchedulingBoostMicros[] =
     "_full_batch_scheduling_boost_micros";
+constexpr char kRaggedBatchingAttr[] = "_ragged_batching";
+constexpr char kLengthBucketBoundariesAttr[] = "_length_bucket_boundaries";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -304,6 +306,15 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     has_attribute_enable_large_batch_splitting_ = true;
   }
 
+  if (c->HasAttr(kRaggedBatchingAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kRaggedBatchingAttr, &ragged_batching_));
+  }
+  if (c->HasAttr(kLengthBucketBoundariesAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kLengthBucketBoundariesAttr,
+                                 &length_bucket_boundaries_));
+  }
+  OP_REQUIRES_OK(c, ValidateRaggedBatching());
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -410,6 +421,9 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      if (ragged_batching_) {
+        new_resource->enable_ragged_batching();
+      }
       *r = new_resource.release();
       return OkStatus();
     };
@@ -427,6 +441,9 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      if (ragged_batching_) {
+        new_resource->enable_ragged_batching();
+      }
       *r = new_resource.release();
       return OkStatus();
     };
@@ -442,13 +459,14 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       -> StatusOr<std::unique_ptr<serving::BatchResourceBase::BatchTask>> {
     return {std::make_unique<BatchResource::BatchTask>(handle)};
   };
+  const string batcher_queue_name = GetBatcherQueueName(c);
   Status status;
   if (serving::ShouldWarmupAllBatchSizes(c)) {
-    status = br->RegisterWarmupInputs(guid, c, batcher_queue_,
+    status = br->RegisterWarmupInputs(guid, c, batcher_queue_name,
                                       create_batch_task_fn, done);
   } else {
-    status =
-        br->RegisterInput(guid, c, batcher_queue_, create_batch_task_fn, done);
+    status = br->RegisterInput(guid, c, batcher_queue_name,
+                               create_batch_task_fn, done);
   }
   br->Unref();
   OP_REQUIRES_OK_ASYNC(c, status, done);
@@ -492,6 +510,10 @@ Status BatchFunctionKernel::InstantiateFunction(
       opts.input_devices.push_back(cpu_device->name());
     }
   }
+  if (ragged_batching_) {
+    // The row splits of the inputs.
+    opts.input_devices.push_back(cpu_device->name());
+  }
   OpInputList captured_tensors;
   TF_RETURN_IF_ERROR(c->input_list("captured_tensors", &captured_tensors));
   for (const Tensor& t : captured_tensors) {
@@ -556,6 +578,41 @@ Status BatchFunctionKernel::ValidateAllowedBatchSizes() const {
   return OkStatus();
 }
 
+Status BatchFunctionKernel::ValidateRaggedBatching() const {
+  for (size_t i = 0; i < length_bucket_boundaries_.size(); ++i) {
+    if (length_bucket_boundaries_[i] <= 0 ||
+        (i > 0 &&
+         length_bucket_boundaries_[i] <= length_bucket_boundaries_[i - 1])) {
+      return errors::InvalidArgument(
+          kLengthBucketBoundariesAttr,
+          " entries must be positive and monotonically increasing");
+    }
+  }
+  if (ragged_batching_ && !allowed_batch_sizes_.empty()) {
+    return errors::InvalidArgument(
+        "allowed_batch_sizes must be empty with ", kRaggedBatchingAttr,
+        ", since ragged batches are not padded");
+  }
+  return OkStatus();
+}
+
+string BatchFunctionKernel::GetBatcherQueueName(OpKernelContext* c) const {
+  if (length_bucket_boundaries_.empty() || c->num_inputs() == 0) {
+    return batcher_queue_;
+  }
+  const Tensor& input = c->input(0);
+  const int length_dim = ragged_batching_ ? 0 : 1;
+  if (input.dims() <= length_dim) {
+    return batcher_queue_;
+  }
+  const int64_t length = input.dim_size(length_dim);
+  const int bucket =
+      std::lower_bound(length_bucket_boundaries_.begin(),
+                       length_bucket_boundaries_.end() - 1, length) -
+      length_bucket_boundaries_.begin();
+  return absl::StrCat(batcher_queue_, "/length_bucket_", bucket);
+}
+
 // Initialize vars by reading from op-kernel-construction.
 // Vars
 // - enable_adaptive_batch_threads_
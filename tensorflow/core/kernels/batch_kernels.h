@@ -62,6 +62,20 @@ absl::string_view GetModelName(OpKernelContext* ctx);
 // and then splits function output as op output.
 //
 // User defined function is named by attribute `f` and defined in the graph.
+//
+// With the private attribute `_ragged_batching`, the inputs of the invocations
+// are concatenated along the 0-th dimension as they are, and the function gets
+// their 1-D int64 row splits after them, so that inputs of different lengths,
+// e.g. sequences, don't need to be padded to each other. The batch sizes then
+// count the rows of the concatenated inputs, which are neither split nor
+// padded, and the outputs are split along the same rows.
+//
+// With the private attribute `_length_bucket_boundaries`, invocations are
+// batched in separate queues by the length of their first input, i.e. its
+// 0-th dimension with ragged batching, or else its 1st dimension, so that
+// batches form from invocations of similar lengths. An invocation of length
+// l goes to the queue of the first boundary that is at least l, or to the
+// last queue if there is none.
 class BatchFunctionKernel : public AsyncOpKernel {
  public:
   explicit BatchFunctionKernel(OpKernelConstruction* c);
@@ -79,6 +93,12 @@ class BatchFunctionKernel : public AsyncOpKernel {
   // to `max_batch_size_`.
   Status ValidateAllowedBatchSizes() const;
 
+  // Validates the ragged batching and length bucketing attributes.
+  Status ValidateRaggedBatching() const;
+
+  // Returns the name of the batcher queue that the inputs of `c` go to.
+  string GetBatcherQueueName(OpKernelContext* c) const;
+
   // Creates the function handle if it isn't initialized yet; and re-use it
   // afterwards.
   Status GetOrCreateFunctionHandle(OpKernelContext* c,
@@ -114,6 +134,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_ = false;
   bool has_attribute_enable_large_batch_splitting_ = false;
   bool enable_adaptive_batch_threads_ = false;
+  bool ragged_batching_ = false;
+  std::vector<int32> length_bucket_boundaries_;
 
   mutex mu_;
 
@@ -274,6 +274,137 @@ TEST_P(BatchFunctionKernelParallelWarmupTest, ParallelWarmupAutoBatch) {
   }
 }
 
+class BatchFunctionKernelRaggedTestState : public OpsTestBase {
+ public:
+  // Init test fixture with a batch kernel instance, batching whole int64
+  // tensors in the resource `shared_name`.
+  Status Init(const string& shared_name, bool ragged_batching,
+              const std::vector<int32>& length_bucket_boundaries) {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+
+    // Override the per-test/per-op device with a global device so that it can
+    // be shared between ops.
+    device_ = cpu_device;
+
+    NameAttrList f;
+    f.set_name("BatchFunctionKernelRaggedTestStateFunc");
+    FunctionDef func;
+    if (ragged_batching) {
+      // Checks that the row splits of a single invocation are passed.
+      func = FunctionDefHelper::Create(
+          // function_name
+          f.name(),
+          // in_def
+          {"x:int64", "splits:int64"},
+          // out_def
+          {"o:int64"},
+          // attr_def
+          {},
+          // node_def
+          {{{"s"},
+            "EnsureShape",
+            {"splits"},
+            {{"T", DataType::DT_INT64}, {"shape", TensorShape({2})}}},
+           {{"o"}, "Identity", {"x", "^s"}, {{"T", DataType::DT_INT64}}}},
+          // ret_def
+          {{"o", "o:output"}});
+    } else {
+      func = FunctionDefHelper::Create(
+          // function_name
+          f.name(),
+          // in_def
+          {"x:int64"},
+          // out_def
+          {"o:int64"},
+          // attr_def
+          {},
+          // node_def
+          {{{"o"}, "Identity", {"x"}, {{"T", DataType::DT_INT64}}}},
+          // ret_def
+          {{"o", "o:output"}});
+    }
+    TF_RETURN_IF_ERROR(flib_def_->AddFunctionDef(func));
+
+    pflr_ = std::make_unique<ProcessFunctionLibraryRuntime>(
+        device_mgr_.get(), Env::Default(), /*config=*/nullptr,
+        TF_GRAPH_DEF_VERSION, flib_def_.get(), OptimizerOptions(),
+        /*thread_pool=*/nullptr, /*parent=*/nullptr,
+        /*session_metadata=*/nullptr,
+        Rendezvous::Factory{[](const int64_t, const DeviceMgr *device_mgr,
+                               tsl::core::RefCountPtr<Rendezvous> *r) {
+          *r = tsl::core::RefCountPtr<Rendezvous>(
+              new IntraProcessRendezvous(device_mgr));
+          return OkStatus();
+        }});
+
+    std::vector<NodeDefBuilder::NodeOut> inputs(
+        {NodeDefBuilder::NodeOut({"n1", 0, DataType::DT_INT64})});
+    TF_CHECK_OK(NodeDefBuilder("BatchTPUInput", "BatchFunction")
+                    .Attr("shared_name", shared_name)
+                    .Attr("max_batch_size", 16)
+                    .Attr("num_batch_threads", 8)
+                    .Attr("batch_timeout_micros", 100000)
+                    .Attr("max_enqueued_batches", 10)
+                    .Attr("_ragged_batching", ragged_batching)
+                    .Attr("_length_bucket_boundaries", length_bucket_boundaries)
+                    .Attr("Tin", {DataType::DT_INT64})
+                    .Input(inputs)
+                    .Attr("Tcaptured", std::vector<DataType>{})
+                    .Input(std::vector<NodeDefBuilder::NodeOut>{})
+                    .Attr("Tout", std::vector<DataType>{DT_INT64})
+                    .Attr("f", f)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelRaggedTest, RaggedBatchingPassesRowSplits) {
+  BatchFunctionKernelRaggedTestState test;
+  TF_ASSERT_OK(test.Init("ragged_batching", /*ragged_batching=*/true,
+                         /*length_bucket_boundaries=*/{}));
+  test.AddInputFromList<int64_t>(TensorShape({3}), {1, 2, 3});
+  TF_ASSERT_OK(test.RunOpKernel());
+  test::ExpectTensorEqual<int64_t>(*test.GetOutput(0),
+                                   test::AsTensor<int64_t>({1, 2, 3}));
+}
+
+TEST(BatchFunctionKernelRaggedTest, RejectsUnorderedLengthBuckets) {
+  BatchFunctionKernelRaggedTestState test;
+  Status status = test.Init("unordered_length_buckets",
+                            /*ragged_batching=*/false,
+                            /*length_bucket_boundaries=*/{4, 2});
+  EXPECT_FALSE(status.ok());
+  EXPECT_TRUE(absl::StrContains(status.message(), "monotonically increasing"));
+}
+
+TEST(BatchFunctionKernelRaggedTest, LengthBucketsBatchSimilarLengths) {
+  // Without buckets, inputs of different lengths could be batched together,
+  // and fail to be concatenated.
+  const std::vector<std::vector<int64_t>> values = {
+      {1, 2}, {3, 4, 5, 6}, {7, 8}, {9, 10, 11, 12}};
+  tsl::BlockingCounter blocking_counter(values.size());
+  for (const std::vector<int64_t> &value : values) {
+    Env::Default()->SchedClosure([&]() {
+      BatchFunctionKernelRaggedTestState test;
+      TF_CHECK_OK(test.Init("length_buckets", /*ragged_batching=*/false,
+                            /*length_bucket_boundaries=*/{2, 4}));
+      const TensorShape shape({1, static_cast<int64_t>(value.size())});
+      test.AddInputFromArray<int64_t>(shape, value);
+      TF_CHECK_OK(test.RunOpKernel());
+      test::ExpectTensorEqual<int64_t>(*test.GetOutput(0),
+                                       test::AsTensor<int64_t>(value, shape));
+      blocking_counter.DecrementCount();
+    });
+  }
+  blocking_counter.Wait();
+}
+
 INSTANTIATE_TEST_SUITE_P(BatchFunctionKernelParallelWarmupTestSuite,
                          BatchFunctionKernelParallelWarmupTest,
                          ::testing::Bool());
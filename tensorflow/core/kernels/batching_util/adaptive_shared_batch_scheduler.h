@@ -21,6 +21,7 @@ limitations under the License.
 #include <functional>
 #include <memory>
 #include <random>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -30,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
@@ -74,6 +77,21 @@ class ASBSQueue;
 // CPU utilization - If the batch processing is cpu dominated, you can reap
 //   latency gains when underutilized by increasing the processing rate, but
 //   back the rate off when the load increases to avoid overload.
+//
+// When several models share the batch threads (e.g. one GPU), a busy model
+// can starve the others of in flight batches.  With
+// `Options::fair_share_scheduling`, batches are instead picked by start-time
+// fair queuing across the queues: each queue is charged the size of the
+// batches it gets scheduled divided by its `QueueOptions::weight`, and the
+// next batch comes from the queue with the least charge, so that busy queues
+// share the processing in proportion to their weights.  Queues with fewer in
+// flight batches than their `QueueOptions::min_in_flight_batches` are served
+// first.
+//
+// Queues with a `QueueOptions::metrics_label` export their number of enqueued
+// tasks as the gauge /tensorflow/serving/batching/adaptive/queue_backlog, and
+// the time their batches wait between creation and scheduling as the sampler
+// /tensorflow/serving/batching/adaptive/queue_wait_micros.
 
 template <typename TaskType>
 class AdaptiveSharedBatchScheduler
@@ -132,6 +150,12 @@ class AdaptiveSharedBatchScheduler
     // full_batch_scheduling_boost_micros==zero) for backward compatibility of
     // API.
     bool fifo_scheduling = false;
+
+    // If true, schedule batches by weighted fair queuing across the queues,
+    // as described above, rather than by age.  Within a queue, batches are
+    // still picked by age and `full_batch_scheduling_boost_micros`.  Can't be
+    // combined with `fifo_scheduling`.
+    bool fair_share_scheduling = false;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -171,6 +195,20 @@ class AdaptiveSharedBatchScheduler
 
     // If true, the padding will not be appended.
     bool disable_padding = false;
+
+    // With `Options::fair_share_scheduling`, the share of the processing that
+    // this queue gets when all queues are busy, relative to the weights of
+    // the other queues.  Must be positive.
+    double weight = 1.0;
+    // With `Options::fair_share_scheduling`, the queue's batches are picked
+    // before those of other queues while it has fewer batches in flight.  The
+    // guarantees of all queues should not add up to more than
+    // `Options::min_in_flight_batches_limit`, or they may not all be met.
+    int min_in_flight_batches = 0;
+
+    // The label of the queue's backlog and wait time metrics.  Nothing is
+    // exported if empty.
+    string metrics_label;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -191,9 +229,27 @@ class AdaptiveSharedBatchScheduler
 
   explicit AdaptiveSharedBatchScheduler(const Options& options);
 
+  // The fair share accounting of a queue. Shared with its in flight batches,
+  // which may finish after the queue is deleted.
+  struct QueueShare {
+    double weight = 1.0;
+    int min_in_flight_batches = 0;
+    string metrics_label;
+    // Number of batches of the queue being processed, including express ones.
+    int64_t in_flight_batches = 0;
+    // The virtual time at which the queue's next batch starts, i.e. the sizes
+    // of its scheduled batches divided by its weight, since it was last idle.
+    double virtual_time = 0;
+  };
+
   // Tracks processing latency and adjusts in_flight_batches_limit to minimize.
   void CallbackWrapper(const internal::ASBSBatch<TaskType>* batch,
-                       BatchProcessor callback, bool is_express);
+                       BatchProcessor callback,
+                       std::shared_ptr<QueueShare> share, bool is_express);
+
+  // Releases batch from its queue and runs it on a batch thread.
+  void ScheduleBatch(const internal::ASBSBatch<TaskType>* batch,
+                     bool is_express) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Schedules batch if in_flight_batches_limit_ is not met.
   void MaybeScheduleNextBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -237,6 +293,16 @@ class AdaptiveSharedBatchScheduler
   std::unordered_map<const internal::ASBSQueue<TaskType>*, BatchProcessor>
       queues_and_callbacks_ TF_GUARDED_BY(mu_);
 
+  // Fair share accounting of the queues added by AddQueue.
+  std::unordered_map<const internal::ASBSQueue<TaskType>*,
+                     std::shared_ptr<QueueShare>>
+      queue_shares_ TF_GUARDED_BY(mu_);
+
+  // The start virtual time of the last batch scheduled by fair queuing.
+  // Queues that were idle resume from it rather than from their own virtual
+  // time, so that they don't get to catch up.
+  double virtual_time_ TF_GUARDED_BY(mu_) = 0;
+
   mutex mu_;
 
   // Responsible for running the batch processing callbacks.
@@ -292,6 +358,28 @@ class AdaptiveSharedBatchScheduler
 // Implementation details follow. API users need not read.
 
 namespace internal {
+// Records the number of tasks enqueued in the queue labeled `label`.
+inline void RecordASBSQueueBacklog(const string& label, int64_t num_tasks) {
+  static auto* cell = monitoring::Gauge<int64_t, 1>::New(
+      "/tensorflow/serving/batching/adaptive/queue_backlog",
+      "Tracks the number of tasks enqueued in an adaptive shared batch "
+      "scheduler queue.",
+      "queue_label");
+  cell->GetCell(label)->Set(num_tasks);
+}
+
+// Records the time a batch of the queue labeled `label` waited between its
+// creation and its scheduling.
+inline void RecordASBSQueueWaitTime(const string& label, int64_t wait_micros) {
+  static auto* cell = monitoring::Sampler<1>::New(
+      {"/tensorflow/serving/batching/adaptive/queue_wait_micros",
+       "Tracks the time batches of an adaptive shared batch scheduler queue "
+       "wait to be scheduled, in microseconds.",
+       "queue_label"},
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(label)->Add(static_cast<double>(wait_micros));
+}
+
 // Consolidates tasks into batches, passing them off to the
 // AdaptiveSharedBatchScheduler for processing.
 template <typename TaskType>
@@ -423,6 +511,10 @@ Status AdaptiveSharedBatchScheduler<TaskType>::Create(
         "greater than or equal to 1; was ",
         options.batches_to_average_over);
   }
+  if (options.fair_share_scheduling && options.fifo_scheduling) {
+    return errors::InvalidArgument(
+        "fair_share_scheduling can't be combined with fifo_scheduling");
+  }
   scheduler->reset(new AdaptiveSharedBatchScheduler<TaskType>(options));
   return OkStatus();
 }
@@ -467,11 +559,26 @@ Status AdaptiveSharedBatchScheduler<TaskType>::AddQueue(
           options.max_batch_size);
     }
   }
+  if (!(options.weight > 0)) {
+    return errors::InvalidArgument("weight must be positive; was ",
+                                   options.weight);
+  }
+  if (options.min_in_flight_batches < 0) {
+    return errors::InvalidArgument(
+        "min_in_flight_batches can't be negative; was ",
+        options.min_in_flight_batches);
+  }
   internal::ASBSQueue<TaskType>* asbs_queue_raw;
   queue->reset(asbs_queue_raw = new internal::ASBSQueue<TaskType>(
                    this->shared_from_this(), options));
+  auto share = std::make_shared<QueueShare>();
+  share->weight = options.weight;
+  share->min_in_flight_batches = options.min_in_flight_batches;
+  share->metrics_label = options.metrics_label;
   mutex_lock l(mu_);
   queues_and_callbacks_[asbs_queue_raw] = process_batch_callback;
+  share->virtual_time = virtual_time_;
+  queue_shares_[asbs_queue_raw] = std::move(share);
   return OkStatus();
 }
 
@@ -507,6 +614,37 @@ void AdaptiveSharedBatchScheduler<TaskType>::RemoveQueue(
     const internal::ASBSQueue<TaskType>* queue) {
   mutex_lock l(mu_);
   queues_and_callbacks_.erase(queue);
+  queue_shares_.erase(queue);
+}
+
+template <typename TaskType>
+void AdaptiveSharedBatchScheduler<TaskType>::ScheduleBatch(
+    const internal::ASBSBatch<TaskType>* batch, bool is_express) {
+  const std::shared_ptr<QueueShare>& share = queue_shares_[batch->queue()];
+  if (options_.fair_share_scheduling) {
+    // Batches picked by fair queuing start at the queue's virtual time.
+    if (!is_express) {
+      share->virtual_time = std::max(share->virtual_time, virtual_time_);
+      virtual_time_ = share->virtual_time;
+    }
+    share->virtual_time += batch->size() / share->weight;
+  }
+  share->in_flight_batches++;
+  if (!share->metrics_label.empty()) {
+    internal::RecordASBSQueueWaitTime(
+        share->metrics_label,
+        GetEnv()->NowMicros() - batch->creation_time_micros());
+  }
+  // Queue may destroy itself after ReleaseBatch is called.
+  batch->queue()->ReleaseBatch(batch);
+  batch_thread_pool_->Schedule(std::bind(
+      &AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper, this, batch,
+      queues_and_callbacks_[batch->queue()], share, is_express));
+  if (is_express) {
+    in_flight_express_batches_++;
+  } else {
+    in_flight_batches_++;
+  }
 }
 
 template <typename TaskType>
@@ -516,12 +654,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatchFIFO() {
     return;
   }
   fifo_batches_.pop_front();
-  // Queue may destroy itself after ReleaseBatch is called.
-  batch->queue()->ReleaseBatch(batch);
-  batch_thread_pool_->Schedule(std::bind(
-      &AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper, this, batch,
-      queues_and_callbacks_[batch->queue()], false /* is express */));
-  in_flight_batches_++;
+  ScheduleBatch(batch, false /* is express */);
 }
 
 template <typename TaskType>
@@ -537,11 +670,7 @@ void AdaptiveSharedBatchScheduler<
     if ((*it)->IsClosed()) {
       const internal::ASBSBatch<TaskType>* batch = *it;
       fifo_batches_.pop_front();
-      batch->queue()->ReleaseBatch(batch);
-      batch_thread_pool_->Schedule(
-          std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper,
-                    this, batch, queues_and_callbacks_[batch->queue()], true));
-      in_flight_express_batches_++;
+      ScheduleBatch(batch, true /* is express */);
       available_threads--;
     } else {
       // Batches are FIFO, so stop iteration after finding the first non-closed
@@ -570,6 +699,10 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
 
   auto best_it = batches_.end();
   double best_score = (std::numeric_limits<double>::max)();
+  // With fair share scheduling, batches are first compared by whether their
+  // queue is below its guarantee, then by the start time of their queue.
+  bool best_guaranteed = false;
+  double best_start_time = 0;
   int64_t now_micros = GetEnv()->NowMicros();
   for (auto it = batches_.begin(); it != batches_.end(); it++) {
     if ((*it)->schedulable_time_micros() > now_micros) continue;
@@ -577,8 +710,27 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
         (*it)->creation_time_micros() -
         options_.full_batch_scheduling_boost_micros * (*it)->size() /
             static_cast<double>((*it)->queue()->max_task_size());
-    if (best_it == batches_.end() || score < best_score) {
+    bool guaranteed = false;
+    double start_time = 0;
+    if (options_.fair_share_scheduling) {
+      const QueueShare& share = *queue_shares_[(*it)->queue()];
+      guaranteed = share.in_flight_batches < share.min_in_flight_batches;
+      start_time = std::max(share.virtual_time, virtual_time_);
+    }
+    bool better;
+    if (best_it == batches_.end()) {
+      better = true;
+    } else if (guaranteed != best_guaranteed) {
+      better = guaranteed;
+    } else if (start_time != best_start_time) {
+      better = start_time < best_start_time;
+    } else {
+      better = score < best_score;
+    }
+    if (better) {
       best_score = score;
+      best_guaranteed = guaranteed;
+      best_start_time = start_time;
       best_it = it;
     }
   }
@@ -586,12 +738,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::MaybeScheduleNextBatch() {
   if (best_it == batches_.end()) return;
   const internal::ASBSBatch<TaskType>* batch = *best_it;
   batches_.erase(best_it);
-  // Queue may destroy itself after ReleaseBatch is called.
-  batch->queue()->ReleaseBatch(batch);
-  batch_thread_pool_->Schedule(
-      std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper, this,
-                batch, queues_and_callbacks_[batch->queue()], false));
-  in_flight_batches_++;
+  ScheduleBatch(batch, false /* is express */);
 }
 
 template <typename TaskType>
@@ -616,11 +763,7 @@ void AdaptiveSharedBatchScheduler<
     if ((*it)->IsClosed()) {
       const internal::ASBSBatch<TaskType>* batch = *it;
       it = batches_.erase(it);
-      batch->queue()->ReleaseBatch(batch);
-      batch_thread_pool_->Schedule(
-          std::bind(&AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper,
-                    this, batch, queues_and_callbacks_[batch->queue()], true));
-      in_flight_express_batches_++;
+      ScheduleBatch(batch, true /* is express */);
       available_threads--;
     } else {
       ++it;
@@ -632,7 +775,7 @@ template <typename TaskType>
 void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
     const internal::ASBSBatch<TaskType>* batch,
     AdaptiveSharedBatchScheduler<TaskType>::BatchProcessor callback,
-    bool is_express) {
+    std::shared_ptr<QueueShare> share, bool is_express) {
   profiler::TraceMeConsumer trace_me(
       [&] {
         return profiler::TraceMeEncode(
@@ -646,6 +789,7 @@ void AdaptiveSharedBatchScheduler<TaskType>::CallbackWrapper(
       const_cast<internal::ASBSBatch<TaskType>*>(batch)));
   int64_t end_time = GetEnv()->NowMicros();
   mutex_lock l(mu_);
+  share->in_flight_batches--;
   if (is_express) {
     in_flight_express_batches_--;
     MaybeScheduleClosedBatchesLocked();
@@ -802,6 +946,9 @@ Status ASBSQueue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
           this->current_batch_->traceme_context_id());
       current_batch_->AddTask(std::move(task));
       num_enqueued_tasks_++;
+      if (!options_.metrics_label.empty()) {
+        RecordASBSQueueBacklog(options_.metrics_label, num_enqueued_tasks_);
+      }
       // If current_batch_ is now full, allow it to be processed immediately.
       bool reached_max_tasks =
           (options_.max_tasks_per_batch.has_value() &&
@@ -830,6 +977,9 @@ void ASBSQueue<TaskType>::ReleaseBatch(const ASBSBatch<TaskType>* batch) {
   mutex_lock l(mu_);
   num_enqueued_batches_--;
   num_enqueued_tasks_ -= batch->num_tasks();
+  if (!options_.metrics_label.empty()) {
+    RecordASBSQueueBacklog(options_.metrics_label, num_enqueued_tasks_);
+  }
   if (batch == current_batch_) {
     current_batch_->Close();
     current_batch_ = nullptr;
@@ -19,6 +19,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/lib/monitoring/test_utils.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -96,6 +98,24 @@ TEST(AdaptiveSharedBatchSchedulerTest, BadOptions) {
   options.min_in_flight_batches_limit = 2;
   options.num_batch_threads = 3;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = Scheduler::Options();
+  options.fair_share_scheduling = true;
+  options.fifo_scheduling = true;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, BadQueueOptions) {
+  using Scheduler = AdaptiveSharedBatchScheduler<FakeTask>;
+  std::shared_ptr<Scheduler> scheduler;
+  TF_ASSERT_OK(Scheduler::Create({}, &scheduler));
+  auto queue_callback = [](std::unique_ptr<Batch<FakeTask>> batch) {};
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  Scheduler::QueueOptions queue_options;
+  queue_options.weight = 0;
+  EXPECT_FALSE(scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
+  queue_options = Scheduler::QueueOptions();
+  queue_options.min_in_flight_batches = -1;
+  EXPECT_FALSE(scheduler->AddQueue(queue_options, queue_callback, &queue).ok());
 }
 
 TEST(AdaptiveSharedBatchSchedulerTest, InFlightBatchesLimit) {
@@ -517,6 +537,126 @@ TEST(AdaptiveSharedBatchSchedulerTest, MaxTasksPerBatch) {
     if (processed_batches == 3) break;
   }
 }
+
+// Runs a blocking batch of the first queue, then enqueues `num_batches` full
+// batches in each queue, in order, and returns the queues of the processed
+// batches, by index.
+std::vector<int> ProcessFairShareBatches(
+    const std::vector<AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions>&
+        queue_options,
+    int num_batches) {
+  AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+  options.initial_in_flight_batches_limit = 1;
+  options.num_batch_threads = 1;
+  options.batches_to_average_over = 1000;
+  options.fair_share_scheduling = true;
+  mutex mu;
+  std::vector<int> processed_queues;
+  Notification finish_processing;
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_CHECK_OK(
+      AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  std::vector<std::unique_ptr<BatchScheduler<FakeTask>>> queues(
+      queue_options.size());
+  for (int i = 0; i < queue_options.size(); ++i) {
+    auto queue_callback = [i, &mu, &processed_queues, &finish_processing](
+                              std::unique_ptr<Batch<FakeTask>> batch) {
+      finish_processing.WaitForNotification();
+      mutex_lock l(mu);
+      processed_queues.push_back(i);
+    };
+    TF_CHECK_OK(
+        scheduler->AddQueue(queue_options[i], queue_callback, &queues[i]));
+  }
+
+  // First batch immediately processed.
+  TF_CHECK_OK(ScheduleTask(queue_options[0].max_batch_size, queues[0].get()));
+  while (queues[0]->NumEnqueuedTasks() > 0) {
+  }
+  for (int i = 0; i < queues.size(); ++i) {
+    for (int j = 0; j < num_batches; ++j) {
+      TF_CHECK_OK(
+          ScheduleTask(queue_options[i].max_batch_size, queues[i].get()));
+    }
+  }
+  finish_processing.Notify();
+  while (true) {
+    mutex_lock l(mu);
+    if (processed_queues.size() == 1 + num_batches * queues.size()) break;
+  }
+  return processed_queues;
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, FairShareWeights) {
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 8;
+  queue_options.weight = 4;
+  std::vector<AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions>
+      all_queue_options = {queue_options, queue_options};
+  all_queue_options[1].weight = 1;
+  // Batches of the first queue advance its virtual time by 2, and those of
+  // the second by 8. Ties go to the oldest batch.
+  EXPECT_EQ(ProcessFairShareBatches(all_queue_options, 4),
+            std::vector<int>({0, 1, 0, 0, 0, 0, 1, 1, 1}));
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, FairShareMinInFlightBatches) {
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 8;
+  std::vector<AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions>
+      all_queue_options = {queue_options, queue_options};
+  // Without a guarantee, the second queue, which is behind the first one,
+  // would go first.
+  EXPECT_EQ(ProcessFairShareBatches(all_queue_options, 2),
+            std::vector<int>({0, 1, 0, 1, 0}));
+  all_queue_options[0].min_in_flight_batches = 1;
+  EXPECT_EQ(ProcessFairShareBatches(all_queue_options, 2),
+            std::vector<int>({0, 0, 0, 1, 1}));
+}
+
+TEST(AdaptiveSharedBatchSchedulerTest, QueueMetrics) {
+  monitoring::testing::CellReader<int64_t> backlog(
+      "/tensorflow/serving/batching/adaptive/queue_backlog");
+  monitoring::testing::CellReader<monitoring::testing::Histogram> wait_time(
+      "/tensorflow/serving/batching/adaptive/queue_wait_micros");
+  AdaptiveSharedBatchScheduler<FakeTask>::Options options;
+  options.initial_in_flight_batches_limit = 1;
+  options.num_batch_threads = 1;
+  options.batches_to_average_over = 1000;
+  mutex mu;
+  int processed_batches = 0;
+  Notification finish_processing;
+  auto queue_callback = [&mu, &processed_batches, &finish_processing](
+                            std::unique_ptr<Batch<FakeTask>> batch) {
+    finish_processing.WaitForNotification();
+    mutex_lock l(mu);
+    processed_batches++;
+  };
+  std::shared_ptr<AdaptiveSharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(
+      AdaptiveSharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  AdaptiveSharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 10;
+  queue_options.metrics_label = "queue_metrics_test";
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+
+  // First batch immediately processed.
+  TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+  while (queue->NumEnqueuedTasks() > 0) {
+  }
+  EXPECT_EQ(backlog.Read("queue_metrics_test"), 0);
+  TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+  TF_ASSERT_OK(ScheduleTask(5, queue.get()));
+  EXPECT_EQ(backlog.Read("queue_metrics_test"), 2);
+  finish_processing.Notify();
+  while (true) {
+    mutex_lock l(mu);
+    if (processed_batches == 3) break;
+  }
+  EXPECT_EQ(backlog.Read("queue_metrics_test"), 0);
+  EXPECT_EQ(wait_time.Delta("queue_metrics_test").num(), 3);
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
@@ -260,6 +260,22 @@ const string& GetModelName(OpKernelContext* ctx) {
 
 }  // namespace
 
+/*static*/ Status BatchResourceBase::SplitIntoSlicesIfAligned(
+    const Tensor& tensor, const std::vector<int64_t>& sizes,
+    std::vector<Tensor>* result) {
+  int64_t start = 0;
+  for (const int64_t size : sizes) {
+    Tensor slice = tensor.Slice(start, start + size);
+    if (!slice.IsAligned()) {
+      result->clear();
+      return tensor::Split(tensor, sizes, result);
+    }
+    result->push_back(std::move(slice));
+    start += size;
+  }
+  return OkStatus();
+}
+
 std::unique_ptr<BatchResourceBase::BatchTask>
 BatchResourceBase::BatchTask::CreateSplitTask(
     int split_index, AsyncOpKernel::DoneCallback done_callback) {
@@ -548,6 +564,15 @@ BatchResourceBase::GetAdaptiveBatcherQueueOptions(
   return batcher_queue_options;
 }
 
+void BatchResourceBase::enable_ragged_batching() {
+  ragged_batching_ = true;
+  batcher_queue_options_.enable_large_batch_splitting = false;
+  batcher_queue_options_.split_input_task_func = nullptr;
+  batcher_queue_options_.disable_padding = true;
+  adaptive_batcher_queue_options_.split_input_task_func = nullptr;
+  adaptive_batcher_queue_options_.disable_padding = true;
+}
+
 /*static*/ Status BatchResourceBase::ValidateBatch(const BatchT& batch) {
   for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
     const BatchResourceBase::BatchTask& task = batch.task(task_idx);
@@ -650,6 +675,13 @@ Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    // A batch of a single task without padding, e.g. a full batch split from
+    // a large task, is its input as is.
+    if (to_concatenate.size() == 1) {
+      concatenated_tensors->push_back(std::move(to_concatenate[0]));
+      continue;
+    }
+
     Tensor concatenated_tensor;
     Status concat_status =
         Concat(context, to_concatenate, &concatenated_tensor);
@@ -796,8 +828,10 @@ Status BatchResourceBase::SplitOutputTensors(
           "the 0th dimension sizes of the input tensors");
     }
 
+    // The outputs of the tasks are views of the batched output when possible,
+    // so that the batch is not copied again on its way back.
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
+    const Status split_status = SplitIntoSlicesIfAligned(
         output_tensor, task_sizes_plus_optional_padding, &split_tensor);
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
@@ -853,10 +887,22 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   Status status;
   bool cleanup_done = false;
   int64_t processed_size = batch->size();
+  // When the batch started processing, or 0 before.
+  uint64 processing_start_time = 0;
   auto cleanup_fn = [&](const Status& status) {
     if (cleanup_done) {
       return;
     }
+    if (processing_start_time > 0) {
+      // Each request waits for the whole batch.
+      const absl::Duration processing_time =
+          absl::Nanoseconds(EnvTime::NowNanos() - processing_start_time);
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        RequestCost* request_cost = batch->task(i).request_cost;
+        if (!request_cost) continue;
+        request_cost->RecordCost({{kBatchProcessingCostName, processing_time}});
+      }
+    }
     SplitBatchCostsAndRecordMetrics(model_name, batch_cost_measurements,
                                     processed_size, *batch);
     // Clear the measurements before unblocking the batch task, as measurements
@@ -892,6 +938,21 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   std::vector<Tensor> combined_outputs;
   std::vector<Tensor> args(concatenated_tensors.begin(),
                            concatenated_tensors.end());
+  if (ragged_batching_) {
+    // Warmup batches are made of padding only, as a single row.
+    const bool just_for_warmup = last_task.forced_warmup_batch_size > 0;
+    const int num_rows = just_for_warmup ? 1 : batch->num_tasks();
+    Tensor row_splits(DT_INT64, TensorShape({num_rows + 1}));
+    auto row_splits_flat = row_splits.vec<int64_t>();
+    row_splits_flat(0) = 0;
+    for (int i = 0; i < num_rows; ++i) {
+      const int64_t row_size =
+          just_for_warmup ? concatenated_tensors[0].dim_size(0)
+                          : batch->task(i).size();
+      row_splits_flat(i + 1) = row_splits_flat(i) + row_size;
+    }
+    args.push_back(std::move(row_splits));
+  }
   const auto& captured_inputs =
       batch->task(batch->num_tasks() - 1).captured_inputs;
   args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
@@ -904,7 +965,14 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
     RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
+    RequestCost* request_cost = batch->task(i).request_cost;
+    if (request_cost) {
+      request_cost->RecordCost(
+          {{kBatchWaitCostName,
+            absl::Nanoseconds(current_time - batch->task(i).start_time)}});
+    }
   }
+  processing_start_time = current_time;
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
@@ -160,6 +160,13 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Makes the batch function get the 1-D int64 row splits of the tasks along
+  // the 0-th dimension of the batched inputs, after the batched inputs. The
+  // tasks are then neither split nor padded, so that tasks of different
+  // lengths are batched as they are. Must be called before any input is
+  // registered.
+  void enable_ragged_batching();
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -244,6 +251,19 @@ class BatchResourceBase : public ResourceBase {
           batch_cost_measurements,
       int64_t processed_size, BatchT& batch);
 
+  // Splits `tensor` along the 0th dimension like `tensor::Split`, but returns
+  // slices of its buffer instead of copies when all of them are aligned, as
+  // kernels that read them require.
+  static Status SplitIntoSlicesIfAligned(const Tensor& tensor,
+                                         const std::vector<int64_t>& sizes,
+                                         std::vector<Tensor>* result);
+
+ protected:
+  // Concatenates the inputs of the tasks in `batch`, padded up to the allowed
+  // batch size, into one tensor per input. Protected for testing.
+  Status ConcatInputTensors(const BatchT& batch, OpKernelContext* context,
+                            std::vector<Tensor>* concatenated_tensors) const;
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
@@ -260,9 +280,6 @@ class BatchResourceBase : public ResourceBase {
   // returns 'batch_size'.
   int RoundToLowestAllowedBatchSize(int batch_size) const;
 
-  Status ConcatInputTensors(const BatchT& batch, OpKernelContext* context,
-                            std::vector<Tensor>* concatenated_tensors) const;
-
   Status SplitOutputTensors(const std::vector<Tensor>& combined_outputs,
                             BatchT* batch) const;
 
@@ -288,6 +305,8 @@ class BatchResourceBase : public ResourceBase {
 
   SessionMetadata session_metadata_;
 
+  bool ragged_batching_ = false;
+
   absl::Mutex outstanding_batch_mu_;
   int num_outstanding_batched_items_ TF_GUARDED_BY(outstanding_batch_mu_) = 0;
 
@@ -26,9 +26,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
 
 namespace tensorflow {
 namespace serving {
@@ -241,6 +247,103 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
 }
 
+TEST(SplitIntoSlicesIfAlignedTest, AlignedSlicesShareTheBuffer) {
+  // Rows of 256 bytes, so that all slices are aligned.
+  Tensor tensor(DT_FLOAT, TensorShape({8, 64}));
+  test::FillIota<float>(&tensor, 0);
+
+  std::vector<Tensor> slices;
+  TF_ASSERT_OK(
+      BatchResourceBase::SplitIntoSlicesIfAligned(tensor, {2, 6}, &slices));
+  ASSERT_EQ(slices.size(), 2);
+  EXPECT_TRUE(slices[0].SharesBufferWith(tensor));
+  EXPECT_TRUE(slices[1].SharesBufferWith(tensor));
+  EXPECT_EQ(slices[0].data(), tensor.data());
+  test::ExpectTensorEqual<float>(slices[0], tensor.Slice(0, 2));
+  test::ExpectTensorEqual<float>(slices[1], tensor.Slice(2, 8));
+}
+
+TEST(SplitIntoSlicesIfAlignedTest, UnalignedSlicesAreCopied) {
+  // Rows of 4 bytes, so that the second slice is not aligned.
+  Tensor tensor(DT_FLOAT, TensorShape({32, 1}));
+  test::FillIota<float>(&tensor, 0);
+  if (tensor.Slice(1, 32).IsAligned()) {
+    GTEST_SKIP() << "All slices are aligned in this build.";
+  }
+
+  std::vector<Tensor> slices;
+  TF_ASSERT_OK(
+      BatchResourceBase::SplitIntoSlicesIfAligned(tensor, {1, 31}, &slices));
+  ASSERT_EQ(slices.size(), 2);
+  EXPECT_FALSE(slices[0].SharesBufferWith(tensor));
+  EXPECT_FALSE(slices[1].SharesBufferWith(tensor));
+  EXPECT_TRUE(slices[1].IsAligned());
+  test::ExpectTensorEqual<float>(slices[0], tensor.Slice(0, 1));
+  test::ExpectTensorEqual<float>(slices[1], tensor.Slice(1, 32));
+}
+
+class TestBatchResource : public BatchResourceBase {
+ public:
+  explicit TestBatchResource(std::vector<int32> allowed_batch_sizes)
+      : BatchResourceBase(/*has_process_batch_function=*/true,
+                          std::shared_ptr<BatcherT>(), BatcherT::QueueOptions(),
+                          std::move(allowed_batch_sizes)) {}
+
+  string DebugString() const override { return "TestBatchResource"; }
+
+  using BatchResourceBase::ConcatInputTensors;
+
+ private:
+  void ProcessFuncBatchImpl(
+      const BatchResourceBase::BatchTask& last_task,
+      absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
+      std::function<void(const Status&)> done) const override {
+    done(OkStatus());
+  }
+};
+
+class ConcatInputTensorsTest : public OpsTestBase {
+ protected:
+  // Returns the context of a kernel which ran, for the batching metrics.
+  OpKernelContext* MakeContext() {
+    TF_CHECK_OK(NodeDefBuilder("batch", "NoOp").Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    TF_CHECK_OK(RunOpKernel());
+    return context_.get();
+  }
+};
+
+TEST_F(ConcatInputTensorsTest, PassesSingleTaskThrough) {
+  core::RefCountPtr<TestBatchResource> resource(
+      new TestBatchResource(/*allowed_batch_sizes=*/{4, 8}));
+  BatchResourceBase::BatchT batch;
+  batch.AddTask(MakeBatchTask(/*task_size=*/4, nullptr));
+  batch.Close();
+
+  std::vector<Tensor> concatenated_tensors;
+  TF_ASSERT_OK(resource->ConcatInputTensors(batch, MakeContext(),
+                                            &concatenated_tensors));
+  ASSERT_EQ(concatenated_tensors.size(), 1);
+  EXPECT_EQ(concatenated_tensors[0].shape(), TensorShape({4, 1}));
+  EXPECT_EQ(concatenated_tensors[0].data(), batch.task(0).inputs[0].data());
+}
+
+TEST_F(ConcatInputTensorsTest, CopiesSingleTaskWithPadding) {
+  core::RefCountPtr<TestBatchResource> resource(
+      new TestBatchResource(/*allowed_batch_sizes=*/{4, 8}));
+  BatchResourceBase::BatchT batch;
+  batch.AddTask(MakeBatchTask(/*task_size=*/3, nullptr));
+  batch.Close();
+
+  std::vector<Tensor> concatenated_tensors;
+  TF_ASSERT_OK(resource->ConcatInputTensors(batch, MakeContext(),
+                                            &concatenated_tensors));
+  ASSERT_EQ(concatenated_tensors.size(), 1);
+  EXPECT_EQ(concatenated_tensors[0].shape(), TensorShape({4, 1}));
+  EXPECT_FALSE(
+      concatenated_tensors[0].SharesBufferWith(batch.task(0).inputs[0]));
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/latency_slo_batch_policy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "tensorflow/core/lib/monitoring/gauge.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+void RecordOperatingPoint(const string& label, int64_t batch_size_limit,
+                          int64_t batch_timeout_micros,
+                          int64_t p99_processing_micros) {
+  static auto* batch_size_limit_cell = monitoring::Gauge<int64_t, 1>::New(
+      "/tensorflow/serving/batching/latency_slo/batch_size_limit",
+      "Tracks the batch size picked to meet the target latency.",
+      "queue_label");
+  static auto* batch_timeout_cell = monitoring::Gauge<int64_t, 1>::New(
+      "/tensorflow/serving/batching/latency_slo/batch_timeout_micros",
+      "Tracks the batch timeout picked to meet the target latency.",
+      "queue_label");
+  static auto* p99_processing_cell = monitoring::Gauge<int64_t, 1>::New(
+      "/tensorflow/serving/batching/latency_slo/p99_processing_micros",
+      "Tracks the estimated 99th percentile processing time of the batches "
+      "of the picked size.",
+      "queue_label");
+  batch_size_limit_cell->GetCell(label)->Set(batch_size_limit);
+  batch_timeout_cell->GetCell(label)->Set(batch_timeout_micros);
+  p99_processing_cell->GetCell(label)->Set(p99_processing_micros);
+}
+
+}  // namespace
+
+LatencySloBatchPolicy::LatencySloBatchPolicy(const Options& options)
+    : options_(options),
+      max_timeout_micros_(options.max_batch_timeout_micros > 0
+                              ? std::min(options.max_batch_timeout_micros,
+                                         options.target_latency_micros)
+                              : options.target_latency_micros),
+      batch_size_limit_(options.max_batch_size),
+      batch_timeout_micros_(max_timeout_micros_) {
+  for (const int32 allowed_size : options_.allowed_batch_sizes) {
+    if (allowed_size <= 0) continue;
+    const size_t size = allowed_size;
+    if (size <= options_.max_batch_size &&
+        (buckets_.empty() || size > buckets_.back().batch_size)) {
+      buckets_.push_back({size});
+    }
+  }
+  if (buckets_.empty()) {
+    for (size_t size = 1; size < options_.max_batch_size; size *= 2) {
+      buckets_.push_back({size});
+    }
+    buckets_.push_back({options_.max_batch_size});
+  }
+}
+
+void LatencySloBatchPolicy::RecordBatch(size_t batch_size,
+                                        int64_t processing_micros) {
+  mutex_lock l(mu_);
+  auto it = std::lower_bound(buckets_.begin(), buckets_.end(), batch_size,
+                             [](const Bucket& bucket, size_t size) {
+                               return bucket.batch_size < size;
+                             });
+  Bucket& bucket = it == buckets_.end() ? buckets_.back() : *it;
+  if (bucket.samples.size() < kWindowSize) {
+    bucket.samples.push_back(processing_micros);
+  } else {
+    bucket.samples[bucket.next] = processing_micros;
+    bucket.next = (bucket.next + 1) % kWindowSize;
+  }
+
+  const size_t n = bucket.samples.size();
+  bucket.mean_micros =
+      std::accumulate(bucket.samples.begin(), bucket.samples.end(), 0.0) / n;
+  std::vector<int64_t> sorted = bucket.samples;
+  const size_t p99_index = static_cast<size_t>(std::ceil(0.99 * n)) - 1;
+  std::nth_element(sorted.begin(), sorted.begin() + p99_index, sorted.end());
+  bucket.p99_micros = sorted[p99_index];
+
+  UpdateOperatingPoint();
+}
+
+void LatencySloBatchPolicy::UpdateOperatingPoint() {
+  const int64_t target = options_.target_latency_micros;
+  // The largest bucket so far with enough samples.
+  const Bucket* measured = nullptr;
+  bool found = false;
+  double best_throughput = 0;
+  size_t best_size = buckets_.front().batch_size;
+  int64_t best_p99_micros = target;
+  for (const Bucket& bucket : buckets_) {
+    double mean_micros;
+    int64_t p99_micros;
+    if (bucket.samples.size() >= kMinSamples) {
+      measured = &bucket;
+      mean_micros = bucket.mean_micros;
+      p99_micros = bucket.p99_micros;
+    } else if (measured != nullptr) {
+      const double scale =
+          static_cast<double>(bucket.batch_size) / measured->batch_size;
+      mean_micros = measured->mean_micros * scale;
+      p99_micros =
+          static_cast<int64_t>(std::ceil(measured->p99_micros * scale));
+    } else {
+      continue;
+    }
+    if (p99_micros >= target) continue;
+    const double throughput = bucket.batch_size / std::max(mean_micros, 1.0);
+    // The estimates of larger buckets may only differ by rounding.
+    if (!found || throughput >= best_throughput * (1 - 1e-9)) {
+      found = true;
+      best_throughput = std::max(best_throughput, throughput);
+      best_size = bucket.batch_size;
+      best_p99_micros = p99_micros;
+    }
+  }
+  // Without estimates, the options are kept. If no bucket meets the target,
+  // the smallest batches are processed without waiting.
+  if (measured == nullptr) return;
+
+  const int64_t timeout_micros =
+      std::min(max_timeout_micros_,
+               std::max<int64_t>(0, target - best_p99_micros));
+  batch_size_limit_ = best_size;
+  batch_timeout_micros_ = timeout_micros;
+  if (!options_.metrics_label.empty()) {
+    RecordOperatingPoint(options_.metrics_label, best_size, timeout_micros,
+                         best_p99_micros);
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
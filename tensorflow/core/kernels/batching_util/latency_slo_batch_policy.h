@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_LATENCY_SLO_BATCH_POLICY_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_LATENCY_SLO_BATCH_POLICY_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Picks the size at which a batching queue closes its batches, and how long
+// it waits for a batch to fill, so that tasks meet a target 99th percentile
+// latency while the batches are as efficient as possible.
+//
+// The processing time of the batches is recorded by size bucket: the allowed
+// batch sizes if there are any, or else the powers of two up to the maximum
+// batch size, and the maximum batch size. After each batch, the policy picks
+// the bucket with the highest estimated throughput, i.e. bucket size divided
+// by mean processing time, among those whose 99th percentile processing time
+// is below the target, preferring larger buckets on ties. Buckets without
+// enough samples are estimated from the largest smaller bucket that has them,
+// as if the processing time grew linearly with the batch size, which lets
+// the policy try larger batches when the measured ones are well within the
+// target. The timeout is then what is left of the target after the 99th
+// percentile processing time of that bucket, up to the maximum timeout.
+//
+// The time tasks wait for a batch thread after their batch is closed is not
+// measured, so the target should leave room for it when the batch threads
+// are shared by busy queues.
+//
+// The chosen operating point is exported as the gauges
+// /tensorflow/serving/batching/latency_slo/batch_size_limit and
+// /tensorflow/serving/batching/latency_slo/batch_timeout_micros, and the
+// estimated processing time as
+// /tensorflow/serving/batching/latency_slo/p99_processing_micros, labeled
+// with `Options::metrics_label`.
+//
+// This object is thread-safe.
+class LatencySloBatchPolicy {
+ public:
+  struct Options {
+    // The target 99th percentile latency of the tasks, in microseconds. Must
+    // be positive.
+    int64_t target_latency_micros = 0;
+
+    // The largest batch size that the policy may choose. Must be positive.
+    size_t max_batch_size = 0;
+
+    // The longest timeout that the policy may choose, in microseconds, or 0
+    // to only bound it by `target_latency_micros`.
+    int64_t max_batch_timeout_micros = 0;
+
+    // If non-empty, the batch sizes that the policy may choose, in
+    // increasing order. Sizes above `max_batch_size` are ignored.
+    std::vector<int32> allowed_batch_sizes;
+
+    // The label of the exported metrics. Nothing is exported if empty.
+    string metrics_label;
+  };
+
+  explicit LatencySloBatchPolicy(const Options& options);
+
+  // Records that a batch of `batch_size` tasks took `processing_micros` to
+  // process, and updates the operating point.
+  void RecordBatch(size_t batch_size, int64_t processing_micros)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // The size at which batches should be closed. Until batches have been
+  // recorded, this is `Options::max_batch_size`.
+  size_t batch_size_limit() const { return batch_size_limit_.load(); }
+
+  // How long batches should wait to fill, in microseconds. Until batches
+  // have been recorded, this is the maximum timeout.
+  int64_t batch_timeout_micros() const {
+    return batch_timeout_micros_.load();
+  }
+
+  // The number of samples of each bucket that the estimates are taken from.
+  static constexpr int kWindowSize = 128;
+  // Buckets with fewer samples are estimated from smaller ones.
+  static constexpr int kMinSamples = 8;
+
+ private:
+  struct Bucket {
+    size_t batch_size;
+    // The last processing times, kWindowSize at most, with the oldest at
+    // `next` once the window is full.
+    std::vector<int64_t> samples;
+    int next = 0;
+    // The estimates of the samples.
+    double mean_micros = 0;
+    int64_t p99_micros = 0;
+  };
+
+  // Recomputes the operating point from the estimates of the buckets.
+  void UpdateOperatingPoint() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+  // The longest timeout that may be chosen.
+  const int64_t max_timeout_micros_;
+
+  mutex mu_;
+  // In increasing batch size order.
+  std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+
+  std::atomic<size_t> batch_size_limit_;
+  std::atomic<int64_t> batch_timeout_micros_;
+
+  LatencySloBatchPolicy(const LatencySloBatchPolicy&) = delete;
+  void operator=(const LatencySloBatchPolicy&) = delete;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_LATENCY_SLO_BATCH_POLICY_H_
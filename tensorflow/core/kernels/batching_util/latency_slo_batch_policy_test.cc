@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/latency_slo_batch_policy.h"
+
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using monitoring::testing::CellReader;
+
+LatencySloBatchPolicy::Options CreateOptions(
+    int64_t target_latency_micros, size_t max_batch_size,
+    int64_t max_batch_timeout_micros = 0) {
+  LatencySloBatchPolicy::Options options;
+  options.target_latency_micros = target_latency_micros;
+  options.max_batch_size = max_batch_size;
+  options.max_batch_timeout_micros = max_batch_timeout_micros;
+  return options;
+}
+
+// Records enough batches of `batch_size` for the policy to use them.
+void RecordBatches(LatencySloBatchPolicy* policy, size_t batch_size,
+                   int64_t processing_micros) {
+  for (int i = 0; i < LatencySloBatchPolicy::kMinSamples; ++i) {
+    policy->RecordBatch(batch_size, processing_micros);
+  }
+}
+
+TEST(LatencySloBatchPolicyTest, UsesOptionsUntilMeasured) {
+  LatencySloBatchPolicy policy(CreateOptions(1000, 64, 300));
+  EXPECT_EQ(policy.batch_size_limit(), 64);
+  EXPECT_EQ(policy.batch_timeout_micros(), 300);
+
+  // Not enough samples yet.
+  policy.RecordBatch(8, 100);
+  EXPECT_EQ(policy.batch_size_limit(), 64);
+  EXPECT_EQ(policy.batch_timeout_micros(), 300);
+
+  LatencySloBatchPolicy unbounded_timeout_policy(CreateOptions(1000, 64));
+  EXPECT_EQ(unbounded_timeout_policy.batch_timeout_micros(), 1000);
+}
+
+TEST(LatencySloBatchPolicyTest, PicksLargestBatchesWithinTarget) {
+  LatencySloBatchPolicy policy(CreateOptions(1000, 64));
+  // Bigger batches are more efficient, but take longer.
+  for (size_t batch_size : {1, 2, 4, 8, 16, 32}) {
+    RecordBatches(&policy, batch_size, 100 + 20 * batch_size);
+  }
+  // Batches of 64 are estimated to take 2 * 740 micros, over the target.
+  EXPECT_EQ(policy.batch_size_limit(), 32);
+  EXPECT_EQ(policy.batch_timeout_micros(), 1000 - 740);
+}
+
+TEST(LatencySloBatchPolicyTest, PrefersMoreEfficientBatches) {
+  LatencySloBatchPolicy policy(CreateOptions(1000, 64));
+  RecordBatches(&policy, 8, 100);
+  // Batches of 16 are measured to take more than twice as long as batches of
+  // 8, so are less efficient.
+  RecordBatches(&policy, 16, 300);
+  // Batches of 32 and 64 are estimated from those of 16.
+  EXPECT_EQ(policy.batch_size_limit(), 8);
+  EXPECT_EQ(policy.batch_timeout_micros(), 900);
+}
+
+TEST(LatencySloBatchPolicyTest, TriesLargerBatches) {
+  LatencySloBatchPolicy policy(CreateOptions(10000, 64, 5000));
+  RecordBatches(&policy, 8, 100);
+  // Batches of 64 are estimated to take 800 micros.
+  EXPECT_EQ(policy.batch_size_limit(), 64);
+  EXPECT_EQ(policy.batch_timeout_micros(), 5000);
+
+  // They turn out to take longer.
+  RecordBatches(&policy, 64, 12000);
+  EXPECT_EQ(policy.batch_size_limit(), 32);
+  EXPECT_EQ(policy.batch_timeout_micros(), 5000);
+}
+
+TEST(LatencySloBatchPolicyTest, UsesTailLatency) {
+  LatencySloBatchPolicy policy(CreateOptions(1000, 16));
+  RecordBatches(&policy, 4, 100);
+  RecordBatches(&policy, 16, 200);
+  EXPECT_EQ(policy.batch_size_limit(), 16);
+
+  // A slow batch is enough to miss the target over the window.
+  policy.RecordBatch(16, 5000);
+  EXPECT_EQ(policy.batch_size_limit(), 8);
+  EXPECT_EQ(policy.batch_timeout_micros(), 1000 - 200);
+}
+
+TEST(LatencySloBatchPolicyTest, DoesNotWaitWhenTargetIsMissed) {
+  LatencySloBatchPolicy policy(CreateOptions(1000, 16, 500));
+  RecordBatches(&policy, 4, 2000);
+  EXPECT_EQ(policy.batch_size_limit(), 1);
+  EXPECT_EQ(policy.batch_timeout_micros(), 0);
+}
+
+TEST(LatencySloBatchPolicyTest, PicksAllowedBatchSizes) {
+  LatencySloBatchPolicy::Options options = CreateOptions(1000, 32);
+  options.allowed_batch_sizes = {4, 12, 32};
+  LatencySloBatchPolicy policy(options);
+  // Batches are recorded as the allowed size they are padded to.
+  RecordBatches(&policy, 3, 100);
+  // Batches of 12 and 32 are estimated to take 300 and 800 micros.
+  EXPECT_EQ(policy.batch_size_limit(), 32);
+  EXPECT_EQ(policy.batch_timeout_micros(), 200);
+
+  RecordBatches(&policy, 30, 1500);
+  EXPECT_EQ(policy.batch_size_limit(), 12);
+  EXPECT_EQ(policy.batch_timeout_micros(), 700);
+}
+
+TEST(LatencySloBatchPolicyTest, ExportsOperatingPoint) {
+  CellReader<int64_t> batch_size_limit(
+      "/tensorflow/serving/batching/latency_slo/batch_size_limit");
+  CellReader<int64_t> batch_timeout_micros(
+      "/tensorflow/serving/batching/latency_slo/batch_timeout_micros");
+  CellReader<int64_t> p99_processing_micros(
+      "/tensorflow/serving/batching/latency_slo/p99_processing_micros");
+  LatencySloBatchPolicy::Options options = CreateOptions(1000, 16);
+  options.metrics_label = "model";
+  LatencySloBatchPolicy policy(options);
+  RecordBatches(&policy, 16, 400);
+  EXPECT_EQ(batch_size_limit.Read("model"), 16);
+  EXPECT_EQ(batch_timeout_micros.Read("model"), 600);
+  EXPECT_EQ(p99_processing_micros.Read("model"), 400);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
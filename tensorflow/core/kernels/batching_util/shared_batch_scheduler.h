@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "absl/types/variant.h"
 #include "tensorflow/core/kernels/batching_util/batch_input_task.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/latency_slo_batch_policy.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -223,6 +225,23 @@ class SharedBatchScheduler
     // If true, the padding will not be appended.
     bool disable_padding = false;
 
+    // If positive, the 99th percentile latency, in microseconds, that the
+    // tasks of the queue should meet. The queue then measures how long its
+    // batches take to process, and picks the size at which it closes them,
+    // up to the maximum batch size, and the batch timeout, up to
+    // `batch_timeout_micros` if it is positive, that give the best throughput
+    // within that latency. Batches are closed at the largest of
+    // `allowed_batch_sizes` that fits, if there are any. See
+    // LatencySloBatchPolicy for the details and the exported metrics.
+    //
+    // Closing batches below the maximum size also lowers the scheduling
+    // capacity of the queue, which is counted in batches.
+    int64_t target_latency_micros = 0;
+
+    // The label of the metrics exported for `target_latency_micros`. No
+    // metrics are exported if empty.
+    string latency_slo_metrics_label;
+
     // If true, queue implementation would split high priority and low priority
     // inputs into two sub queues.
     bool enable_priority_queue = false;
@@ -370,6 +389,20 @@ class Queue {
   // size that's provided by caller of batch scheduler.
   size_t max_execution_batch_size() const { return max_execution_batch_size_; }
 
+  // Returns the size at which batches are closed, which is
+  // max_execution_batch_size() unless a target latency is set.
+  size_t batch_size_limit() const {
+    if (latency_slo_policy_ == nullptr) return max_execution_batch_size_;
+    return std::min(latency_slo_policy_->batch_size_limit(),
+                    max_execution_batch_size_);
+  }
+
+  // Returns how long the open batch waits to fill, in microseconds.
+  int64_t batch_timeout_micros() const {
+    if (latency_slo_policy_ == nullptr) return options_.batch_timeout_micros;
+    return latency_slo_policy_->batch_timeout_micros();
+  }
+
   // Called by a thread that is ready to process a batch, to request one from
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
@@ -416,6 +449,11 @@ class Queue {
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Closes the open batch if it is not empty and has reached
+  // batch_size_limit(), which a target latency can make smaller than the size
+  // of the batch.
+  void CloseOpenBatchIfFull() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Split `input task` into `output_tasks` according to 'task_sizes'.
   Status SplitInputBatchIntoSubtasks(
       std::unique_ptr<TaskType>* input_task,
@@ -465,6 +503,10 @@ class Queue {
   // `GetMaxExecutionBatchSize` for more details on what it means.
   const size_t max_execution_batch_size_;
 
+  // Picks batch_size_limit() and batch_timeout_micros() if
+  // `QueueOptions.target_latency_micros` is set, and is null otherwise.
+  std::unique_ptr<LatencySloBatchPolicy> latency_slo_policy_;
+
   // A callback invoked to processes a batch of work units. Always invoked
   // from a batch thread.
   ProcessBatchCallback process_batch_callback_;
@@ -634,6 +676,11 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.target_latency_micros < 0) {
+    return errors::InvalidArgument(
+        "target_latency_micros must be non-negative; was ",
+        options.target_latency_micros);
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -813,6 +860,16 @@ Queue<TaskType>::Queue(
   // the same traceme_context_id_counter_.
   traceme_context_id_counter_ = (absl::GetCurrentTimeNanos() & 0xFFFFFFFF)
                                 << 32;
+  if (options_.target_latency_micros > 0) {
+    LatencySloBatchPolicy::Options policy_options;
+    policy_options.target_latency_micros = options_.target_latency_micros;
+    policy_options.max_batch_size = max_execution_batch_size_;
+    policy_options.max_batch_timeout_micros = options_.batch_timeout_micros;
+    policy_options.allowed_batch_sizes = options_.allowed_batch_sizes;
+    policy_options.metrics_label = options_.latency_slo_metrics_label;
+    latency_slo_policy_ =
+        std::make_unique<LatencySloBatchPolicy>(policy_options);
+  }
   // Create an initial, open batch.
   if (options_.enable_lazy_split) {
     task_handle_batches_.emplace_back(
@@ -855,8 +912,6 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
         "ScheduleWithLazySplit",
         {{"batching_input_task_size", (*task)->size()}});
   });
-  // The max size to be enqueued.
-  const int max_execution_batch_size = options_.max_execution_batch_size;
 
   bool notify_of_schedulable_batch = false;
   {
@@ -865,6 +920,10 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     DCHECK(!closed_);
 
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    CloseOpenBatchIfFull();
+
+    // The max size to be enqueued.
+    const int max_execution_batch_size = batch_size_limit();
 
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
@@ -877,8 +936,9 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     input_batch->ToTaskHandles(&task_handles);
 
     for (int i = 0; i < task_handles.size(); ++i) {
-      if (task_handle_batches_.back()->size() + task_handles[i]->size() >
-          options_.max_execution_batch_size) {
+      if (!task_handle_batches_.back()->empty() &&
+          task_handle_batches_.back()->size() + task_handles[i]->size() >
+              max_execution_batch_size) {
         StartNewBatch();
       }
       if (task_handle_batches_.back()->empty()) {
@@ -936,11 +996,13 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
     // Add test coverage when when concurrent incoming batches arrives and
     // use up all queue capacity.
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    CloseOpenBatchIfFull();
 
     std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
 
+    const int64_t execution_batch_size_limit = batch_size_limit();
     const int64_t open_batch_remaining_slot =
-        max_execution_batch_size() - batches.back()->size();
+        execution_batch_size_limit - batches.back()->size();
 
     const int64_t input_task_size = (*task)->size();
 
@@ -955,8 +1017,9 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
     }
 
     for (int i = 0; i < output_tasks.size(); ++i) {
-      if (batches.back()->size() + output_tasks[i]->size() >
-          max_execution_batch_size()) {
+      if (!batches.back()->empty() &&
+          batches.back()->size() + output_tasks[i]->size() >
+              execution_batch_size_limit) {
         StartNewBatch();
       }
       if (batches.back()->empty()) {
@@ -1015,9 +1078,9 @@ size_t Queue<TaskType>::SchedulingCapacityInternal() const {
   const int64 num_new_batches_schedulable =
       static_cast<int64_t>(options_.max_enqueued_batches) -
       this->num_enqueued_batches();
-  const int64 execution_batch_size_limit = max_execution_batch_size();
-  const int64 open_batch_capacity =
-      execution_batch_size_limit - this->tail_batch_task_size();
+  const int64 execution_batch_size_limit = batch_size_limit();
+  const int64 open_batch_capacity = std::max<int64_t>(
+      0, execution_batch_size_limit - this->tail_batch_task_size());
   // Note the returned value is guaranteed to be not negative, since
   // enqueue operation could only happen if queue has enough capacity.
   return (num_new_batches_schedulable * execution_batch_size_limit) +
@@ -1039,7 +1102,8 @@ Status Queue<TaskType>::ValidateBatchTaskQueueCapacity(TaskType* task) const {
           " (num_enqueued_batches=", num_enqueued_batches(),
           ", max_enqueued_batches=", options_.max_enqueued_batches,
           ", open_batch_size=", tail_batch_task_size(),
-          ", max_execution_batch_size=", max_execution_batch_size(), ")");
+          ", max_execution_batch_size=", max_execution_batch_size(),
+          ", batch_size_limit=", batch_size_limit(), ")");
     }
     return OkStatus();
   }
@@ -1053,7 +1117,7 @@ Status Queue<TaskType>::ValidateBatchTaskQueueCapacity(TaskType* task) const {
   //
   // We need to revisit/remove this check after we fix model configs.
   const std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
-  if (batches.back()->size() + task->size() > options_.input_batch_size_limit) {
+  if (batches.back()->size() + task->size() > batch_size_limit()) {
     if (batches.size() >= options_.max_enqueued_batches) {
       return errors::Unavailable(
           "The batch scheduling queue to which this task was submitted is "
@@ -1136,7 +1200,13 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const size_t batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
+  if (latency_slo_policy_ != nullptr) {
+    latency_slo_policy_->RecordBatch(batch_size,
+                                     env_->NowMicros() - start_time_micros);
+  }
 
   {
     mutex_lock l(mu_);
@@ -1194,15 +1264,23 @@ void Queue<TaskType>::StartNewBatch() {
   batches.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
 
+template <typename TaskType>
+void Queue<TaskType>::CloseOpenBatchIfFull() {
+  const size_t open_batch_size = tail_batch_task_size();
+  if (open_batch_size > 0 && open_batch_size >= batch_size_limit()) {
+    StartNewBatch();
+  }
+}
+
 template <typename TaskType>
 Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
     std::unique_ptr<TaskType>* input_task,
     std::vector<std::unique_ptr<TaskType>>* output_tasks) {
   const int open_batch_remaining_slot =
-      max_execution_batch_size() - this->tail_batch_task_size();
+      batch_size_limit() - this->tail_batch_task_size();
   return options_.split_input_task_func(
-      std::move(input_task), open_batch_remaining_slot,
-      max_execution_batch_size(), std::move(output_tasks));
+      std::move(input_task), open_batch_remaining_slot, batch_size_limit(),
+      std::move(output_tasks));
 }
 
 template <typename TaskType>
@@ -1211,9 +1289,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= batch_size_limit() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
 }
 
 template <typename TaskType>
@@ -1226,9 +1304,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= batch_size_limit() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
 }
 
 template <typename TaskType>
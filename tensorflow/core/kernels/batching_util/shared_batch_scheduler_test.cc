@@ -794,6 +794,103 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+TEST_P(SharedBatchSchedulerTest, ObeysTargetLatency) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  // Batches take 40 microseconds per task to process.
+  mutex mu;
+  std::vector<size_t> batch_sizes;
+  auto callback = [&env, &mu,
+                   &batch_sizes](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    env.AdvanceByMicroseconds(40 * batch->size());
+    mutex_lock l(mu);
+    batch_sizes.push_back(batch->size());
+  };
+  auto wait_for_batches = [&mu, &batch_sizes](size_t num_batches) {
+    for (;;) {
+      {
+        mutex_lock l(mu);
+        if (batch_sizes.size() >= num_batches) return;
+      }
+      Env::Default()->SleepForMicroseconds(100);
+    }
+  };
+
+  {
+    auto scheduler = CreateSharedBatchScheduler(/*num_batch_threads=*/1, &env);
+    const size_t input_batch_size_limit = 16;
+    const size_t batch_timeout_micros = 1000 * 1000;
+    const size_t max_enqueued_batches = 2;
+    QueueOptions queue_options =
+        CreateQueueOptions(input_batch_size_limit, input_batch_size_limit,
+                           batch_timeout_micros, max_enqueued_batches);
+    queue_options.target_latency_micros = 500;
+    auto queue = CreateQueue(scheduler, queue_options, callback);
+    // The queue waits until the capacity reflects the new batch size limit,
+    // which is only updated after the batches are processed.
+    auto wait_for_batch_size_limit = [&queue](size_t batch_size_limit) {
+      while (queue->SchedulingCapacity() !=
+             max_enqueued_batches * batch_size_limit) {
+        Env::Default()->SleepForMicroseconds(100);
+      }
+    };
+
+    // Full batches take 640 microseconds, over the target.
+    for (int i = 0; i < LatencySloBatchPolicy::kMinSamples; ++i) {
+      for (size_t j = 0; j < input_batch_size_limit; ++j) {
+        TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      }
+      wait_for_batches(i + 1);
+    }
+    wait_for_batch_size_limit(1);
+
+    // Batches of a single task take 40 microseconds, so the queue tries
+    // batches of 8, which should take 320.
+    for (int i = 0; i < LatencySloBatchPolicy::kMinSamples; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+      wait_for_batches(LatencySloBatchPolicy::kMinSamples + i + 1);
+    }
+    wait_for_batch_size_limit(8);
+
+    for (int j = 0; j < 8; ++j) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    wait_for_batches(2 * LatencySloBatchPolicy::kMinSamples + 1);
+
+    std::vector<size_t> expected_batch_sizes(
+        LatencySloBatchPolicy::kMinSamples, input_batch_size_limit);
+    expected_batch_sizes.resize(2 * LatencySloBatchPolicy::kMinSamples, 1);
+    expected_batch_sizes.push_back(8);
+    {
+      mutex_lock l(mu);
+      EXPECT_EQ(batch_sizes, expected_batch_sizes);
+    }
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, InvalidTargetLatency) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+
+  auto scheduler = CreateSharedBatchScheduler(2);
+
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/100 * 1000, /*max_enqueued_batches=*/2);
+  queue_options.target_latency_micros = -1;
+  std::unique_ptr<Queue> queue;
+  EXPECT_THAT(scheduler->AddQueue(queue_options, callback, &queue),
+              testing::StatusIs(
+                  error::INVALID_ARGUMENT,
+                  "target_latency_micros must be non-negative; was -1"));
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
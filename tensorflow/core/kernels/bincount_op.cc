@@ -15,7 +15,10 @@ limitations under the License.
 
 // See docs in ../ops/math_ops.cc.
 
+#include <algorithm>
 #include <atomic>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/platform/errors.h"
 #define EIGEN_USE_THREADS
@@ -30,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -38,6 +42,177 @@ using thread::ThreadPool;
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Inputs with fewer values are counted by a single thread.
+constexpr int64_t kMinParallelBincountSize = 8192;
+// Weighted inputs with at least this many bins per value are counted by
+// sorting the values.
+constexpr int64_t kMinBinsPerSortedValue = 16;
+// The kPartitioned strategy splits the bins in up to this many ranges per
+// thread, of at least 2^kMinPartitionBinsLog2 bins each, and the values in
+// up to this many chunks per thread, of at least kMinChunkSize values each.
+constexpr int64_t kPartitionsPerThread = 4;
+constexpr int kMinPartitionBinsLog2 = 10;
+constexpr int64_t kChunksPerThread = 4;
+constexpr int64_t kMinChunkSize = 4096;
+
+enum class BincountStrategy {
+  // Counts in the output, in a single thread.
+  kSerial,
+  // Counts in a histogram per thread, and sums the histograms.
+  kPrivatized,
+  // Groups the values by ranges of bins, and counts each range in a single
+  // thread, directly in its part of the output.
+  kPartitioned,
+  // Sorts the values, and writes each bin that has values once.
+  kSorted,
+};
+
+// Picks how BincountFunctor counts `arr_size` values in `num_bins` bins with
+// `num_threads` threads. The histograms of kPrivatized take num_threads *
+// num_bins values, which are zeroed and then summed, so they are only used
+// when that is cheaper than the two extra passes over the values of
+// kPartitioned. A weighted input much smaller than the output is counted
+// with kSorted, which writes the output in order and sums the weights of
+// each bin in the order of the values, instead of updating random bins.
+BincountStrategy ChooseBincountStrategy(int64_t arr_size, int64_t num_bins,
+                                        int64_t num_threads, bool weighted) {
+  if (num_threads == 1 || arr_size < kMinParallelBincountSize) {
+    return BincountStrategy::kSerial;
+  }
+  if (weighted && arr_size * kMinBinsPerSortedValue <= num_bins) {
+    return BincountStrategy::kSorted;
+  }
+  if (num_threads * num_bins <= arr_size) {
+    return BincountStrategy::kPrivatized;
+  }
+  return BincountStrategy::kPartitioned;
+}
+
+// Counts the `arr_size` values of `arr` in the `num_bins` bins of `output`,
+// which does not need to be zeroed. `weights` is null for unweighted counts,
+// and ignored for binary ones. The values are first grouped by ranges of a
+// power of two bins, keeping their order, and each range is then counted by
+// a single thread, so that the threads write to disjoint parts of the output.
+template <typename Tidx, typename T, bool binary_output>
+void PartitionedBincount(const DeviceBase::CpuWorkerThreads& worker_threads,
+                         const Tidx* arr, int64_t arr_size, const T* weights,
+                         Tidx num_bins, T* output) {
+  const int64_t num_threads = worker_threads.num_threads;
+  int shift = kMinPartitionBinsLog2;
+  while ((static_cast<int64_t>(num_bins) >> shift) >=
+         kPartitionsPerThread * num_threads) {
+    ++shift;
+  }
+  const int64_t num_parts =
+      Eigen::divup<int64_t>(num_bins, int64_t{1} << shift);
+  const int64_t num_chunks =
+      std::max<int64_t>(1, std::min(kChunksPerThread * num_threads,
+                                    Eigen::divup(arr_size, kMinChunkSize)));
+  const int64_t chunk_size = Eigen::divup(arr_size, num_chunks);
+
+  // The number of values of each chunk in each range, and then the position
+  // of the first of them in the grouped values.
+  std::vector<int64_t> offsets(num_chunks * num_parts, 0);
+  auto count = [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; ++c) {
+      int64_t* chunk_offsets = offsets.data() + c * num_parts;
+      const int64_t limit = std::min(arr_size, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < limit; ++i) {
+        const Tidx value = arr[i];
+        if (value < num_bins) {
+          ++chunk_offsets[static_cast<int64_t>(value) >> shift];
+        }
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+        chunk_size * 2 * sizeof(Tidx), count);
+
+  std::vector<int64_t> part_begin(num_parts + 1);
+  int64_t total = 0;
+  for (int64_t p = 0; p < num_parts; ++p) {
+    part_begin[p] = total;
+    for (int64_t c = 0; c < num_chunks; ++c) {
+      const int64_t n = offsets[c * num_parts + p];
+      offsets[c * num_parts + p] = total;
+      total += n;
+    }
+  }
+  part_begin[num_parts] = total;
+
+  const bool grouped_weights_needed = !binary_output && weights != nullptr;
+  std::vector<Tidx> grouped_values(total);
+  std::vector<T> grouped_weights(grouped_weights_needed ? total : 0);
+  auto group = [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; ++c) {
+      int64_t* chunk_offsets = offsets.data() + c * num_parts;
+      const int64_t limit = std::min(arr_size, (c + 1) * chunk_size);
+      for (int64_t i = c * chunk_size; i < limit; ++i) {
+        const Tidx value = arr[i];
+        if (value < num_bins) {
+          const int64_t j =
+              chunk_offsets[static_cast<int64_t>(value) >> shift]++;
+          grouped_values[j] = value;
+          if (grouped_weights_needed) grouped_weights[j] = weights[i];
+        }
+      }
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+        chunk_size * 4 * (sizeof(Tidx) + sizeof(T)), group);
+
+  auto accumulate = [&](int64_t begin, int64_t end) {
+    for (int64_t p = begin; p < end; ++p) {
+      const int64_t bin_begin = p << shift;
+      const int64_t bin_end =
+          std::min<int64_t>(num_bins, (p + 1) << shift);
+      std::fill(output + bin_begin, output + bin_end, T(0));
+      for (int64_t j = part_begin[p]; j < part_begin[p + 1]; ++j) {
+        const Tidx value = grouped_values[j];
+        if (binary_output) {
+          output[value] = T(1);
+        } else if (grouped_weights_needed) {
+          output[value] += grouped_weights[j];
+        } else {
+          // Complex numbers don't support "++".
+          output[value] += T(1);
+        }
+      }
+    }
+  };
+  const int64_t cost_per_part =
+      (int64_t{1} << shift) * sizeof(T) +
+      Eigen::divup(total, num_parts) * 4 * (sizeof(Tidx) + sizeof(T));
+  Shard(worker_threads.num_threads, worker_threads.workers, num_parts,
+        cost_per_part, accumulate);
+}
+
+// Sums the `weights` of the `arr_size` values of `arr` in the `num_bins` bins
+// of `output`, which must be zeroed. The weights of each bin are summed in
+// the order of the values, like in the serial loop.
+template <typename Tidx, typename T>
+void SortedBincount(const Tidx* arr, int64_t arr_size, const T* weights,
+                    Tidx num_bins, T* output) {
+  std::vector<std::pair<Tidx, int64_t>> entries;
+  entries.reserve(arr_size);
+  for (int64_t i = 0; i < arr_size; ++i) {
+    if (arr[i] < num_bins) entries.emplace_back(arr[i], i);
+  }
+  std::sort(entries.begin(), entries.end());
+  for (size_t j = 0; j < entries.size();) {
+    const Tidx value = entries[j].first;
+    T sum = T(0);
+    for (; j < entries.size() && entries[j].first == value; ++j) {
+      sum += weights[entries[j].second];
+    }
+    output[value] = sum;
+  }
+}
+
+}  // namespace
+
 namespace functor {
 
 template <typename Tidx, typename T>
@@ -56,11 +231,30 @@ struct BincountFunctor<CPUDevice, Tidx, T, true> {
       return errors::InvalidArgument("Input arr must be non-negative!");
     }
 
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    ThreadPool* thread_pool = worker_threads.workers;
+    const int64_t num_threads = thread_pool->NumThreads() + 1;
+    const BincountStrategy strategy = ChooseBincountStrategy(
+        arr.size(), num_bins, num_threads, /*weighted=*/false);
+    if (strategy == BincountStrategy::kSerial) {
+      output.setZero();
+      for (int64_t i = 0; i < arr.size(); i++) {
+        const Tidx value = arr(i);
+        if (value < num_bins) {
+          output(value) = T(1);
+        }
+      }
+      return OkStatus();
+    }
+    if (strategy == BincountStrategy::kPartitioned) {
+      PartitionedBincount<Tidx, T, true>(worker_threads, arr.data(),
+                                         arr.size(), nullptr, num_bins,
+                                         output.data());
+      return OkStatus();
+    }
     // Allocate partial output bin sums for each worker thread. Worker ids in
     // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
-    ThreadPool* thread_pool =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
-    const int64_t num_threads = thread_pool->NumThreads() + 1;
     Tensor partial_bins_t;
     TF_RETURN_IF_ERROR(context->allocate_temp(
         DT_BOOL, TensorShape({num_threads, num_bins}), &partial_bins_t));
@@ -101,10 +295,9 @@ struct BincountFunctor<CPUDevice, Tidx, T, false> {
       return errors::InvalidArgument("Input arr must be non-negative!");
     }
 
-    // Allocate partial output bin sums for each worker thread. Worker ids in
-    // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
-    ThreadPool* thread_pool =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    ThreadPool* thread_pool = worker_threads.workers;
     const int64_t num_threads = thread_pool->NumThreads() + 1;
     const Tidx* arr_data = arr.data();
     const std::ptrdiff_t arr_size = arr.size();
@@ -113,7 +306,9 @@ struct BincountFunctor<CPUDevice, Tidx, T, false> {
       return errors::InvalidArgument(
           "Input indices and weights must have the same size.");
     }
-    if (num_threads == 1) {
+    const BincountStrategy strategy = ChooseBincountStrategy(
+        arr_size, num_bins, num_threads, weights.size() > 0);
+    if (strategy == BincountStrategy::kSerial) {
       output.setZero();
       T* output_data = output.data();
       if (weights.size()) {
@@ -132,7 +327,16 @@ struct BincountFunctor<CPUDevice, Tidx, T, false> {
           }
         }
       }
+    } else if (strategy == BincountStrategy::kSorted) {
+      output.device(context->eigen_cpu_device()) = output.constant(T(0));
+      SortedBincount(arr_data, arr_size, weight_data, num_bins, output.data());
+    } else if (strategy == BincountStrategy::kPartitioned) {
+      PartitionedBincount<Tidx, T, false>(
+          worker_threads, arr_data, arr_size,
+          weights.size() ? weight_data : nullptr, num_bins, output.data());
     } else {
+      // Allocate partial output bin sums for each worker thread. Worker ids in
+      // ParallelForWithWorkerId range from 0 to NumThreads() inclusive.
       Tensor partial_bins_t;
       TF_RETURN_IF_ERROR(context->allocate_temp(
           DataTypeToEnum<T>::value, TensorShape({num_threads, num_bins}),
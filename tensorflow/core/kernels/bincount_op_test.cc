@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <random>
+
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
@@ -76,4 +78,55 @@ BM_BincountDev(128, 1000, gpu);
 BM_BincountDev(128, 2000, gpu);
 BM_BincountDev(128, 5000, gpu);
 
+// DenseBincount of `arr_size` values uniformly distributed in `nbins` bins,
+// which covers the privatized histograms for small `nbins`, the partitioned
+// bins for large ones, and the sort for weighted inputs much smaller than
+// `nbins`.
+static Graph* DenseBincount(int arr_size, int nbins, bool weighted) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int32> dist(0, nbins - 1);
+  Tensor arr(DT_INT32, TensorShape({arr_size}));
+  auto arr_flat = arr.flat<int32>();
+  for (int i = 0; i < arr_size; ++i) {
+    arr_flat(i) = dist(gen);
+  }
+
+  Tensor size(DT_INT32, TensorShape({}));
+  size.scalar<int32>()() = nbins;
+
+  Tensor weights(DT_FLOAT, TensorShape({weighted ? arr_size : 0}));
+  weights.flat<float>().setRandom();
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "DenseBincount")
+                  .Input(test::graph::Constant(g, arr))
+                  .Input(test::graph::Constant(g, size))
+                  .Input(test::graph::Constant(g, weights))
+                  .Attr("T", DT_FLOAT)
+                  .Attr("Tidx", DT_INT32)
+                  .Finalize(g, &node));
+  return g;
+}
+
+#define BM_DenseBincountDev(K, NBINS, WEIGHTED, type)                       \
+  static void BM_DenseBincount##_##type##_##K##_##NBINS##_##WEIGHTED(       \
+      ::testing::benchmark::State& state) {                                 \
+    test::Benchmark(#type, DenseBincount(K * 1024, NBINS, WEIGHTED),        \
+                    /*old_benchmark_api=*/false)                            \
+        .Run(state);                                                        \
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * K *  \
+                            1024);                                          \
+  }                                                                         \
+  BENCHMARK(BM_DenseBincount##_##type##_##K##_##NBINS##_##WEIGHTED);
+
+BM_DenseBincountDev(1024, 1000, false, cpu);
+BM_DenseBincountDev(1024, 1000, true, cpu);
+BM_DenseBincountDev(1024, 1048576, false, cpu);
+BM_DenseBincountDev(1024, 1048576, true, cpu);
+BM_DenseBincountDev(128, 4194304, false, cpu);
+BM_DenseBincountDev(128, 4194304, true, cpu);
+BM_DenseBincountDev(16, 4194304, true, cpu);
+
 }  // end namespace tensorflow
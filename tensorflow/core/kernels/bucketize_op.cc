@@ -16,33 +16,64 @@ limitations under the License.
 // See docs in ../ops/math_ops.cc.
 
 #include "tensorflow/core/kernels/bucketize_op.h"
+
+#include <type_traits>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/sorted_search.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 using CPUDevice = Eigen::ThreadPoolDevice;
 using GPUDevice = Eigen::GpuDevice;
 
+namespace {
+
+// The number of boundaries from which they are searched in Eytzinger order.
+// Fewer of them fit in the L1 cache, where the sorted order is as fast.
+constexpr int kMinEytzingerBoundaries = 1024;
+
+}  // namespace
+
 namespace functor {
 
 template <typename T>
 struct BucketizeFunctor<CPUDevice, T> {
-  // PRECONDITION: boundaries_vector must be sorted.
-  static Status Compute(OpKernelContext* context,
-                        const typename TTypes<T, 1>::ConstTensor& input,
-                        const std::vector<float>& boundaries_vector,
-                        typename TTypes<int32, 1>::Tensor& output) {
+  // PRECONDITION: boundaries_vector must be sorted, and eytzinger_boundaries
+  // must be empty or hold the same boundaries.
+  static Status Compute(
+      OpKernelContext* context, const typename TTypes<T, 1>::ConstTensor& input,
+      const std::vector<float>& boundaries_vector,
+      const sorted_search::EytzingerArray<float>& eytzinger_boundaries,
+      typename TTypes<int32, 1>::Tensor& output) {
     const int N = input.size();
-    for (int i = 0; i < N; i++) {
-      auto first_bigger_it = std::upper_bound(
-          boundaries_vector.begin(), boundaries_vector.end(), input(i));
-      output(i) = first_bigger_it - boundaries_vector.begin();
-    }
+    const int num_boundaries = boundaries_vector.size();
+    const float* boundaries = boundaries_vector.data();
+    auto work = [&](int64_t begin, int64_t end) {
+      if (eytzinger_boundaries.size() > 0) {
+        for (int64_t i = begin; i < end; i++) {
+          output(i) = eytzinger_boundaries.UpperBound(input(i));
+        }
+      } else {
+        for (int64_t i = begin; i < end; i++) {
+          output(i) =
+              sorted_search::UpperBound(boundaries, num_boundaries, input(i));
+        }
+      }
+    };
+    // A few cycles per comparison.
+    const int64_t cost_per_element = 5 * (Log2Ceiling(num_boundaries) + 1);
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, N,
+          cost_per_element, work);
 
     return OkStatus();
   }
@@ -57,6 +88,10 @@ class BucketizeOp : public OpKernel {
     OP_REQUIRES_OK(context, context->GetAttr("boundaries", &boundaries_));
     OP_REQUIRES(context, std::is_sorted(boundaries_.begin(), boundaries_.end()),
                 errors::InvalidArgument("Expected sorted boundaries"));
+    if (std::is_same<Device, CPUDevice>::value &&
+        boundaries_.size() >= kMinEytzingerBoundaries) {
+      eytzinger_boundaries_ = sorted_search::EytzingerArray<float>(boundaries_);
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -67,7 +102,12 @@ class BucketizeOp : public OpKernel {
     OP_REQUIRES_OK(context, context->allocate_output(0, input_tensor.shape(),
                                                      &output_tensor));
     auto output = output_tensor->template flat<int32>();
-    if (input.size() > 0) {
+    if (input.size() == 0) return;
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      OP_REQUIRES_OK(context, functor::BucketizeFunctor<Device, T>::Compute(
+                                  context, input, boundaries_,
+                                  eytzinger_boundaries_, output));
+    } else {
       OP_REQUIRES_OK(context, functor::BucketizeFunctor<Device, T>::Compute(
                                   context, input, boundaries_, output));
     }
@@ -75,6 +115,8 @@ class BucketizeOp : public OpKernel {
 
  private:
   std::vector<float> boundaries_;
+  // The boundaries in Eytzinger order if there are many of them, on CPU.
+  sorted_search::EytzingerArray<float> eytzinger_boundaries_;
 };
 
 #define REGISTER_KERNEL(T)                                         \
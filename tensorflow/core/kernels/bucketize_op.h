@@ -27,6 +27,8 @@ limitations under the License.
 namespace tensorflow {
 namespace functor {
 
+// The CPU specialization also takes the boundaries in Eytzinger order, see
+// bucketize_op.cc.
 template <typename Device, typename T>
 struct BucketizeFunctor {
   static Status Compute(OpKernelContext* context,
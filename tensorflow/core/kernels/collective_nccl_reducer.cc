@@ -24,6 +24,11 @@ limitations under the License.
 namespace tensorflow {
 
 void NcclReducer::Run(StatusCallback done) {
+  if (col_params_->epilogue && col_params_->final_op) {
+    done(errors::Internal("NcclReducer runs the epilogue of ",
+                          col_params_->name, " before its final_op"));
+    return;
+  }
   Tensor group_size;
   std::unique_ptr<Notification> group_size_ready;
   Status group_size_status;
@@ -279,6 +279,36 @@ class NcclReducerTest : public NcclTestBase {
   void RunCollectiveOnDevice(DeviceInstance* di) override { di->RunReduce(); }
 };
 
+// Reduces without final_op, with an epilogue which counts its calls.
+class NcclReducerEpilogueTest : public NcclReducerTest {
+ protected:
+  void InitExpected(std::vector<float>* expected, const int tensor_length,
+                    const int current_rank, const int num_ranks) override {
+    expected->resize(tensor_length);
+    for (int i = 0; i < tensor_length; ++i) {
+      float expected_sum = 0.0;
+      for (int rank = 0; rank < num_ranks; ++rank) {
+        float value = pow(10, rank) * i;
+        expected_sum += value;
+      }
+      (*expected)[i] = expected_sum;
+    }
+  }
+
+  void InitDevice(DeviceInstance* di) override {
+    di->col_params_->merge_op = di->merge_op_.get();
+    di->col_params_->epilogue = [this](se::Stream* stream) {
+      if (stream == nullptr) {
+        return errors::Internal("Epilogue called without a stream");
+      }
+      ++num_epilogues_;
+      return OkStatus();
+    };
+  }
+
+  std::atomic<int> num_epilogues_{0};
+};
+
 class NcclReduceScattererTest : public NcclTestBase {
  protected:
   NcclReduceScattererTest()
@@ -432,6 +462,12 @@ TEST_F(NcclReducerTest, Test8Dev1048576Len) {
   RunTest(/*num_ranks=*/8, /*tensor_length=*/1048576);
 }
 
+TEST_F(NcclReducerEpilogueTest, Test2Dev16Len) {
+  RunTest(/*num_ranks=*/2, /*tensor_length=*/16);
+  if (test_env_->device_mgr->NumDevices() >= 2) {
+    EXPECT_EQ(num_epilogues_, 2);
+  }
+}
 TEST_F(NcclBroadcasterTest, Test2Dev16LenSrc0) {
   RunTest(/*num_ranks=*/2, /*tensor_length=*/16);
 }
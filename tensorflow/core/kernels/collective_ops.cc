@@ -12,8 +12,10 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <numeric>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -40,6 +42,13 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/collective_ops_fused_apply.h"
+#include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 namespace tensorflow {
 
 namespace {
@@ -1496,5 +1505,198 @@ REGISTER_KERNEL_BUILDER(Name("CollectiveReduceScatterV2")
                             .HostMemory("instance_key"),
                         CollectiveReduceScatterV2OpKernel);
 
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+using GPUDevice = Eigen::GpuDevice;
+
+// Sums the gradient of a variable across the group and applies it to the
+// variable. With NCCL, the update is a single kernel enqueued on the NCCL
+// stream right after the reduction, which reads the reduced gradient once and
+// in place. With the other implementations, it is enqueued on the compute
+// stream once the reduction is done.
+template <typename T>
+class CollectiveReduceApplyOpKernel : public CollectiveOpV2Kernel {
+ public:
+  explicit CollectiveReduceApplyOpKernel(OpKernelConstruction* c)
+      : CollectiveOpV2Kernel(c) {
+    string optimizer_name;
+    OP_REQUIRES_OK(c, c->GetAttr("optimizer", &optimizer_name));
+    int expected_num_slots;
+    int expected_num_hyperparams;
+    if (optimizer_name == "GradientDescent") {
+      optimizer_ = FusedOptimizer::kGradientDescent;
+      expected_num_slots = 0;
+      expected_num_hyperparams = 1;
+    } else if (optimizer_name == "Momentum") {
+      optimizer_ = FusedOptimizer::kMomentum;
+      expected_num_slots = 1;
+      expected_num_hyperparams = 2;
+    } else {
+      optimizer_ = FusedOptimizer::kAdam;
+      expected_num_slots = 2;
+      expected_num_hyperparams = 6;
+    }
+    OP_REQUIRES_OK(c, c->GetAttr("num_slots", &num_slots_));
+    OP_REQUIRES_OK(c, c->GetAttr("num_hyperparams", &num_hyperparams_));
+    OP_REQUIRES(c,
+                num_slots_ == expected_num_slots &&
+                    num_hyperparams_ == expected_num_hyperparams,
+                errors::InvalidArgument(
+                    optimizer_name, " takes ", expected_num_slots,
+                    " slots and ", expected_num_hyperparams,
+                    " hyperparameters, got ", num_slots_, " and ",
+                    num_hyperparams_));
+    string final_op_name;
+    OP_REQUIRES_OK(c, c->GetAttr("final_op", &final_op_name));
+    average_ = final_op_name == "Div";
+    OP_REQUIRES_OK(c, c->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(c, c->GetAttr("use_nesterov", &use_nesterov_));
+    // The merge_op takes two inputs. `final_op` is folded into the update.
+    NodeDef sub_node;
+    sub_node.add_input(c->def().input(0));
+    sub_node.add_input(c->def().input(0));
+    sub_node.set_device(c->def().device());
+    SetAttrValue(data_type_, &(*sub_node.mutable_attr())["T"]);
+    merge_op_ = BuildOpKernel(c, "Add", &sub_node);
+    name_ = strings::StrCat(c->def().name(), ": ReduceApply(", optimizer_name,
+                            ",", final_op_name, ")");
+    VLOG(2) << "CollectiveReduceApply " << this << " name " << name_
+            << " communication_hint " << communication_hint_;
+  }
+
+  void ComputeAsync(OpKernelContext* c, DoneCallback done) override {
+    auto col_params = new CollectiveParams();
+    auto done_with_cleanup = [col_params, done = std::move(done)]() {
+      done();
+      col_params->Unref();
+    };
+    OP_REQUIRES_OK_ASYNC(
+        c,
+        FillCollectiveParams(col_params, c, REDUCTION_COLLECTIVE,
+                             /*group_size*/ c->input(1),
+                             /*group_key*/ c->input(2),
+                             /*instance_key*/ c->input(3)),
+        done_with_cleanup);
+    col_params->instance.shape = c->input(0).shape();
+    col_params->merge_op = merge_op_.get();
+    // Allocate the output tensor, trying to reuse the input.
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK_ASYNC(c,
+                         c->forward_input_or_allocate_output(
+                             {0}, 0, col_params->instance.shape, &output),
+                         done_with_cleanup);
+    se::Stream* compute_stream = c->op_device_context()->stream();
+    col_params->epilogue = [this, c, col_params,
+                            compute_stream](se::Stream* stream) {
+      return Apply(c, col_params->group.group_size, compute_stream, stream);
+    };
+    Run(c, col_params,
+        [this, c, col_params, compute_stream,
+         done = std::move(done_with_cleanup)]() {
+          if (c->status().ok() &&
+              col_params->instance.impl_details.collective_name !=
+                  "NcclReduce") {
+            Status s = Apply(c, col_params->group.group_size, compute_stream,
+                             compute_stream);
+            if (!s.ok()) c->SetStatus(s);
+          }
+          done();
+        });
+  }
+
+ private:
+  static constexpr int kVarInput = 4;
+
+  // Enqueues the update of the variables from the reduced gradient in output 0
+  // on `stream`.
+  Status Apply(OpKernelContext* c, int group_size, se::Stream* compute_stream,
+               se::Stream* stream) {
+    std::vector<int> var_inputs(1 + num_slots_);
+    std::iota(var_inputs.begin(), var_inputs.end(), kVarInput);
+    auto locks = MaybeLockVariableInputMutexesInOrder<GPUDevice, T>(
+        c, use_exclusive_lock_, /*sparse=*/false, var_inputs);
+    std::vector<Tensor> vars(var_inputs.size());
+    for (int i = 0; i < var_inputs.size(); ++i) {
+      TF_RETURN_IF_ERROR(GetInputTensorFromVariable<GPUDevice, T>(
+          c, var_inputs[i], use_exclusive_lock_, /*sparse=*/false, &vars[i]));
+      if (!vars[i].IsInitialized()) {
+        return errors::FailedPrecondition(
+            "Attempting to use uninitialized variables: ",
+            requested_input(var_inputs[i]));
+      }
+    }
+    const Tensor& grad = *c->mutable_output(0);
+    for (int i = 0; i < vars.size(); ++i) {
+      if (!vars[i].shape().IsSameSize(grad.shape())) {
+        return errors::InvalidArgument(
+            "var and grad do not have the same shape",
+            vars[i].shape().DebugString(), " ", grad.shape().DebugString());
+      }
+    }
+    const int first_hyperparam = kVarInput + 1 + num_slots_;
+    std::vector<const T*> hyperparams(num_hyperparams_);
+    for (int i = 0; i < num_hyperparams_; ++i) {
+      const Tensor& hyperparam = c->input(first_hyperparam + i);
+      if (!TensorShapeUtils::IsScalar(hyperparam.shape())) {
+        return errors::InvalidArgument(
+            "hyperparameters must be scalars: ",
+            hyperparam.shape().DebugString());
+      }
+      hyperparams[i] = hyperparam.scalar<T>().data();
+    }
+
+    FusedApplyArgs<T> args;
+    args.size = grad.NumElements();
+    args.grad = grad.flat<T>().data();
+    if (average_) args.grad_scale = T(1) / static_cast<T>(group_size);
+    args.var = vars[0].flat<T>().data();
+    args.use_nesterov = use_nesterov_;
+    switch (optimizer_) {
+      case FusedOptimizer::kGradientDescent:
+        args.lr = hyperparams[0];
+        break;
+      case FusedOptimizer::kMomentum:
+        args.accum = vars[1].flat<T>().data();
+        args.lr = hyperparams[0];
+        args.momentum = hyperparams[1];
+        break;
+      case FusedOptimizer::kAdam:
+        args.m = vars[1].flat<T>().data();
+        args.v = vars[2].flat<T>().data();
+        args.beta1_power = hyperparams[0];
+        args.beta2_power = hyperparams[1];
+        args.lr = hyperparams[2];
+        args.beta1 = hyperparams[3];
+        args.beta2 = hyperparams[4];
+        args.epsilon = hyperparams[5];
+        break;
+    }
+    // The copy of a variable in copy-on-read mode by GetInputTensorFromVariable
+    // is enqueued on the compute stream.
+    if (stream != compute_stream) stream->ThenWaitFor(compute_stream);
+    return LaunchFusedApply<T>(optimizer_, args, stream);
+  }
+
+  FusedOptimizer optimizer_;
+  int num_slots_;
+  int num_hyperparams_;
+  bool average_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+  std::unique_ptr<OpKernel> merge_op_;
+};
+
+#define REGISTER_GPU_KERNEL(T)                                  \
+  REGISTER_KERNEL_BUILDER(Name("_CollectiveReduceApply")        \
+                              .Device(DEVICE_GPU)               \
+                              .TypeConstraint<T>("T")           \
+                              .HostMemory("group_size")         \
+                              .HostMemory("group_key")          \
+                              .HostMemory("instance_key"),      \
+                          CollectiveReduceApplyOpKernel<T>);
+REGISTER_GPU_KERNEL(float);
+REGISTER_GPU_KERNEL(double);
+#undef REGISTER_GPU_KERNEL
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace
 }  // namespace tensorflow
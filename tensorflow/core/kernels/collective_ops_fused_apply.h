@@ -0,0 +1,66 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_COLLECTIVE_OPS_FUSED_APPLY_H_
+#define TENSORFLOW_CORE_KERNELS_COLLECTIVE_OPS_FUSED_APPLY_H_
+
+#include <cstdint>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+enum class FusedOptimizer {
+  kGradientDescent,
+  kMomentum,
+  kAdam,
+};
+
+// The operands of an optimizer update which reads the gradient of the
+// variable once, e.g. right after it is reduced. All the pointers are in
+// device memory, and the hyperparameters are scalars. The updates are those of
+// training_ops.h.
+template <typename T>
+struct FusedApplyArgs {
+  int64_t size = 0;
+  // The gradient is `grad_scale * grad`.
+  const T* grad = nullptr;
+  T grad_scale = T(1);
+  T* var = nullptr;
+  // Momentum only.
+  T* accum = nullptr;
+  const T* momentum = nullptr;
+  // Adam only.
+  T* m = nullptr;
+  T* v = nullptr;
+  const T* beta1_power = nullptr;
+  const T* beta2_power = nullptr;
+  const T* beta1 = nullptr;
+  const T* beta2 = nullptr;
+  const T* epsilon = nullptr;
+  const T* lr = nullptr;
+  bool use_nesterov = false;
+};
+
+// Enqueues the update of `args.var` by `optimizer` on `stream`, in one kernel.
+template <typename T>
+Status LaunchFusedApply(FusedOptimizer optimizer, const FusedApplyArgs<T>& args,
+                        stream_executor::Stream* stream);
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_COLLECTIVE_OPS_FUSED_APPLY_H_
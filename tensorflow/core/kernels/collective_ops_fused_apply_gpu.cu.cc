@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+
+#include "tensorflow/core/kernels/collective_ops_fused_apply.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr int kThreadsPerBlock = 256;
+constexpr int kMaxBlocks = 4096;
+
+template <typename T, FusedOptimizer optimizer>
+__global__ __launch_bounds__(kThreadsPerBlock) void FusedApplyKernel(
+    FusedApplyArgs<T> args) {
+  const T lr = *args.lr;
+  T momentum;
+  T mul_factor;
+  T one_minus_beta1;
+  T one_minus_beta2;
+  if (optimizer == FusedOptimizer::kMomentum) {
+    momentum = *args.momentum;
+  } else if (optimizer == FusedOptimizer::kAdam) {
+    mul_factor = lr *
+                 Eigen::numext::sqrt(static_cast<T>(1.0) - *args.beta2_power) /
+                 (static_cast<T>(1.0) - *args.beta1_power);
+    one_minus_beta1 = static_cast<T>(1.0) - *args.beta1;
+    one_minus_beta2 = static_cast<T>(1.0) - *args.beta2;
+  }
+  GPU_1D_KERNEL_LOOP(i, args.size) {
+    const T g = args.grad_scale * args.grad[i];
+    switch (optimizer) {
+      case FusedOptimizer::kGradientDescent:
+        args.var[i] = args.var[i] - lr * g;
+        break;
+      case FusedOptimizer::kMomentum: {
+        const T accum = args.accum[i] * momentum + g;
+        if (args.use_nesterov) {
+          args.var[i] = args.var[i] - (g * lr + accum * momentum * lr);
+        } else {
+          args.var[i] = args.var[i] - lr * accum;
+        }
+        args.accum[i] = accum;
+        break;
+      }
+      case FusedOptimizer::kAdam: {
+        const T m = args.m[i] + one_minus_beta1 * (g - args.m[i]);
+        const T v = args.v[i] + one_minus_beta2 * (g * g - args.v[i]);
+        const T update = args.use_nesterov
+                             ? m * (*args.beta1) + one_minus_beta1 * g
+                             : m;
+        args.var[i] =
+            args.var[i] -
+            mul_factor * update / (*args.epsilon + Eigen::numext::sqrt(v));
+        args.m[i] = m;
+        args.v[i] = v;
+        break;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+template <typename T>
+Status LaunchFusedApply(FusedOptimizer optimizer, const FusedApplyArgs<T>& args,
+                        se::Stream* stream) {
+  if (args.size == 0) {
+    return OkStatus();
+  }
+  const int num_blocks = static_cast<int>(std::min<int64_t>(
+      (args.size + kThreadsPerBlock - 1) / kThreadsPerBlock, kMaxBlocks));
+  gpuStream_t gpu_stream =
+      reinterpret_cast<gpuStream_t>(stream->platform_specific_handle().stream);
+  switch (optimizer) {
+    case FusedOptimizer::kGradientDescent:
+      return GpuLaunchKernel(
+          FusedApplyKernel<T, FusedOptimizer::kGradientDescent>, num_blocks,
+          kThreadsPerBlock, 0, gpu_stream, args);
+    case FusedOptimizer::kMomentum:
+      return GpuLaunchKernel(FusedApplyKernel<T, FusedOptimizer::kMomentum>,
+                             num_blocks, kThreadsPerBlock, 0, gpu_stream, args);
+    case FusedOptimizer::kAdam:
+      return GpuLaunchKernel(FusedApplyKernel<T, FusedOptimizer::kAdam>,
+                             num_blocks, kThreadsPerBlock, 0, gpu_stream, args);
+  }
+  return errors::Internal("Unexpected optimizer ",
+                          static_cast<int>(optimizer));
+}
+
+template Status LaunchFusedApply<float>(FusedOptimizer optimizer,
+                                        const FusedApplyArgs<float>& args,
+                                        se::Stream* stream);
+template Status LaunchFusedApply<double>(FusedOptimizer optimizer,
+                                         const FusedApplyArgs<double>& args,
+                                         se::Stream* stream);
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -17,10 +17,19 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/concat_lib_cpu.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/kernels/concat_lib.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -95,6 +104,108 @@ int64_t EstimateBytesPerElement<tstring>(
          ((num_samples > 0) ? (num_bytes_in_samples / num_samples) : 0);
 }
 
+// Outputs of at least this many bytes are copied by ConcatLargeCPU.
+constexpr int64_t kMinStripedConcatBytes = 4 << 20;
+
+// Copies `n` bytes like memcpy, but with non-temporal stores, which do not
+// evict the working set of the other ops from the caches to hold an output
+// that is too large to stay there anyway. The caller must issue a store fence
+// before another thread reads `dst`.
+inline void StreamingCopy(char* dst, const char* src, size_t n) {
+#ifdef __SSE2__
+  const size_t head =
+      std::min<size_t>(n, -reinterpret_cast<uintptr_t>(dst) & 15);
+  std::memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  n -= head;
+  for (; n >= 64; n -= 64, dst += 64, src += 64) {
+    const __m128i* s = reinterpret_cast<const __m128i*>(src);
+    __m128i* d = reinterpret_cast<__m128i*>(dst);
+    const __m128i v0 = _mm_loadu_si128(s);
+    const __m128i v1 = _mm_loadu_si128(s + 1);
+    const __m128i v2 = _mm_loadu_si128(s + 2);
+    const __m128i v3 = _mm_loadu_si128(s + 3);
+    _mm_stream_si128(d, v0);
+    _mm_stream_si128(d + 1, v1);
+    _mm_stream_si128(d + 2, v2);
+    _mm_stream_si128(d + 3, v3);
+  }
+#endif
+  std::memcpy(dst, src, n);
+}
+
+// Concatenates large outputs of types that can be copied with memcpy. The
+// output is split into one stripe of the same number of bytes per thread,
+// instead of sharding its elements with a uniform cost, and each stripe copies
+// the parts of the rows of the inputs it covers. When the output has a single
+// row, every input is contiguous in it, and a stripe copies each input it
+// overlaps with a single memcpy.
+template <typename T>
+void ConcatLargeCPU(
+    DeviceBase* d,
+    const std::vector<std::unique_ptr<typename TTypes<T, 2>::ConstMatrix>>&
+        inputs,
+    typename TTypes<T, 2>::Matrix* output) {
+  const int64_t num_inputs = inputs.size();
+  std::vector<int64_t> sizes;
+  sizes.reserve(num_inputs);
+  int64_t row_size = 0;
+  for (const auto& input : inputs) {
+    sizes.push_back(input->dimension(1));
+    row_size += sizes.back();
+  }
+  const int64_t total = output->size();
+  const int64_t total_bytes = total * sizeof(T);
+  const bool streaming = total_bytes > Eigen::l3CacheSize();
+
+  const DeviceBase::CpuWorkerThreads* worker_threads =
+      d->tensorflow_cpu_worker_threads();
+  const int64_t num_stripes = std::max(1, worker_threads->num_threads);
+  // Stripes start at multiples of 64 bytes of the output, so that two threads
+  // never write to the same cache line.
+  const int64_t kAlignment = std::max<int64_t>(1, 64 / sizeof(T));
+  const int64_t stripe_size =
+      Eigen::divup(Eigen::divup(total, num_stripes), kAlignment) * kAlignment;
+
+  auto copy_stripes = [&](int64_t first, int64_t last) {
+    for (int64_t stripe = first; stripe < last; ++stripe) {
+      const int64_t start = std::min(total, stripe * stripe_size);
+      const int64_t end = std::min(total, start + stripe_size);
+      int64_t row = start / row_size;
+      int64_t col = start - row * row_size;
+      int64_t pos = start;
+      while (pos < end) {
+        int64_t input_col = col;
+        for (int64_t j = 0; j < num_inputs && pos < end; ++j) {
+          if (input_col >= sizes[j]) {
+            input_col -= sizes[j];
+            continue;
+          }
+          const int64_t n = std::min(sizes[j] - input_col, end - pos);
+          char* dst = reinterpret_cast<char*>(output->data() + pos);
+          const char* src =
+              reinterpret_cast<const char*>(&(*inputs[j])(row, input_col));
+          if (streaming) {
+            StreamingCopy(dst, src, n * sizeof(T));
+          } else {
+            std::memcpy(dst, src, n * sizeof(T));
+          }
+          pos += n;
+          input_col = 0;
+        }
+        ++row;
+        col = 0;
+      }
+    }
+#ifdef __SSE2__
+    if (streaming) _mm_sfence();
+#endif
+  };
+  Shard(worker_threads->num_threads, worker_threads->workers, num_stripes,
+        stripe_size * sizeof(T), copy_stripes);
+}
+
 }  // namespace
 
 template <typename T>
@@ -103,6 +214,12 @@ void ConcatCPU(
     const std::vector<std::unique_ptr<typename TTypes<T, 2>::ConstMatrix>>&
         inputs,
     typename TTypes<T, 2>::Matrix* output) {
+  if (DataTypeCanUseMemcpy(DataTypeToEnum<T>::v()) &&
+      output->size() * static_cast<int64_t>(sizeof(T)) >=
+          kMinStripedConcatBytes) {
+    ConcatLargeCPU<T>(d, inputs, output);
+    return;
+  }
   int64_t cost_per_unit = EstimateBytesPerElement<T>(inputs);
   ConcatCPUImpl<T>(d, inputs, cost_per_unit, MemCpyCopier<T>(), output);
 }
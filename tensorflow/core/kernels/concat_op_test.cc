@@ -192,6 +192,53 @@ void BM_ConcatManyDim1bfloat16(::testing::benchmark::State& state) {
 
 BENCHMARK(BM_ConcatManyDim1bfloat16)->UseRealTime()->Arg(18)->Arg(34)->Arg(60);
 
+// Concatenates 4 float inputs of shape {dim1, dim2} along dimension 1, into
+// outputs that are large enough to be copied in stripes by bytes.
+static void ConcatLargeHelper(::testing::benchmark::State& state, int dim1,
+                              int dim2) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kNumInputs = 4;
+  Tensor concat_dim(DT_INT32, TensorShape({}));
+  concat_dim.scalar<int32>()() = 1;
+  std::vector<NodeBuilder::NodeOut> inputs;
+  inputs.reserve(kNumInputs);
+  for (int i = 0; i < kNumInputs; ++i) {
+    Tensor in(DT_FLOAT, TensorShape({dim1, dim2}));
+    in.flat<float>().setRandom();
+    inputs.push_back(test::graph::Constant(g, in));
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "ConcatV2")
+                  .Input(inputs)
+                  .Input(test::graph::Constant(g, concat_dim))
+                  .Attr("N", kNumInputs)
+                  .Attr("T", DT_FLOAT)
+                  .Finalize(g, &node));
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * dim1 *
+                          dim2 * kNumInputs * sizeof(float));
+}
+
+void BM_ConcatLargeDim1Float(::testing::benchmark::State& state) {
+  const int dim1 = state.range(0);
+  const int dim2 = state.range(1);
+
+  ConcatLargeHelper(state, dim1, dim2);
+}
+
+// A single row, few wide rows, and many narrow rows, with outputs from 16 MiB,
+// which fit in the last level cache of some servers, to 256 MiB.
+BENCHMARK(BM_ConcatLargeDim1Float)
+    ->UseRealTime()
+    ->ArgPair(1, 1 << 20)
+    ->ArgPair(1, 1 << 24)
+    ->ArgPair(64, 1 << 14)
+    ->ArgPair(64, 1 << 18)
+    ->ArgPair(1 << 16, 16)
+    ->ArgPair(1 << 20, 16);
+
 void MemcpyAlternativeHelper(::testing::benchmark::State& state, int dim2) {
   const int kDim1 = 100;
   std::vector<float> data1(kDim1 * dim2, 1.0f);
@@ -128,24 +128,12 @@ class BatchDatasetOp::Dataset : public DatasetBase {
 
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
-    const int64 cardinality = Cardinality();
-    if (index < 0 || index >= cardinality) {
-      return errors::OutOfRange("Index out of range [0, ", cardinality,
-                                "):", index);
-    }
-    int batch_start_index = batch_size_ * index;
-    std::vector<std::vector<Tensor>> batch_elements;
-    int input_cardinality = input_->Cardinality();
-    for (int i = batch_start_index;
-         i < batch_start_index + batch_size_ && i < input_cardinality; ++i) {
-      std::vector<Tensor> batch_element_tuple;
-      TF_RETURN_IF_ERROR(input_->Get(ctx, i, &batch_element_tuple));
-      batch_elements.emplace_back(std::move(batch_element_tuple));
-    }
-    TF_RETURN_IF_ERROR(CopyBatch(CopyBatchParams(ctx), batch_elements,
-                                 parallel_copy_,
-                                 /*allocation_callback=*/nullptr, out_tensors));
-    return OkStatus();
+    return GetInternal(ctx, index, out_tensors);
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return GetInternal(ctx, index, out_tensors);
   }
 
  protected:
@@ -167,6 +155,29 @@ class BatchDatasetOp::Dataset : public DatasetBase {
   }
 
  private:
+  template <typename ContextT>
+  Status GetInternal(ContextT* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const {
+    const int64 cardinality = Cardinality();
+    if (index < 0 || index >= cardinality) {
+      return errors::OutOfRange("Index out of range [0, ", cardinality,
+                                "):", index);
+    }
+    int batch_start_index = batch_size_ * index;
+    std::vector<std::vector<Tensor>> batch_elements;
+    int input_cardinality = input_->Cardinality();
+    for (int i = batch_start_index;
+         i < batch_start_index + batch_size_ && i < input_cardinality; ++i) {
+      std::vector<Tensor> batch_element_tuple;
+      TF_RETURN_IF_ERROR(input_->Get(ctx, i, &batch_element_tuple));
+      batch_elements.emplace_back(std::move(batch_element_tuple));
+    }
+    TF_RETURN_IF_ERROR(CopyBatch(CopyBatchParams(ctx), batch_elements,
+                                 parallel_copy_,
+                                 /*allocation_callback=*/nullptr, out_tensors));
+    return OkStatus();
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -50,6 +51,7 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kHybrid;
 
 namespace {
 
@@ -135,13 +137,146 @@ class PartialCache {
   std::vector<std::vector<Tensor>> cache_;
 };
 
+// The in-memory tier of a hybrid file cache. It holds the leading elements of
+// the cache file that fit in the RAM budget of the iterator which read or wrote
+// the file first, so that later passes only need to read the remaining
+// elements from the file.
+class MemoryTier {
+ public:
+  MemoryTier() = default;
+
+  ~MemoryTier() {
+    if (ram_budget_manager_ != nullptr) {
+      ram_budget_manager_->RequestCacheBytes(-bytes_);
+    }
+  }
+
+  // Marks the tier as completed with `elements`, which take up `bytes` bytes
+  // allocated from `ram_budget_manager`. Returns false, in which case the
+  // allocation remains with the caller, if the tier was already completed.
+  bool Complete(std::vector<std::vector<Tensor>>&& elements, int64_t bytes,
+                std::shared_ptr<model::RamBudgetManager> ram_budget_manager) {
+    mutex_lock l(mu_);
+    if (completed_) {
+      return false;
+    }
+    elements_ = std::move(elements);
+    bytes_ = bytes;
+    ram_budget_manager_ = std::move(ram_budget_manager);
+    completed_ = true;
+    return true;
+  }
+
+  // Returns whether the tier is completed.
+  bool IsCompleted() {
+    tf_shared_lock l(mu_);
+    return completed_;
+  }
+
+  // Returns the number of elements in the tier.
+  size_t size() {
+    tf_shared_lock l(mu_);
+    return elements_.size();
+  }
+
+  // Returns the element at the given index.
+  const std::vector<Tensor>& at(size_t index) {
+    tf_shared_lock l(mu_);
+    DCHECK_LT(index, elements_.size());
+    return elements_[index];
+  }
+
+ private:
+  mutex mu_;
+  bool completed_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::vector<Tensor>> elements_ TF_GUARDED_BY(mu_);
+  int64_t bytes_ TF_GUARDED_BY(mu_) = 0;
+  std::shared_ptr<model::RamBudgetManager> ram_budget_manager_
+      TF_GUARDED_BY(mu_);
+};
+
+// Collects the elements of a pass over a file cache into a `MemoryTier`, for as
+// long as the RAM budget allows. A builder constructed with a null tier or RAM
+// budget manager does nothing.
+class MemoryTierBuilder {
+ public:
+  MemoryTierBuilder() = default;
+  MemoryTierBuilder(MemoryTier* tier,
+                    std::shared_ptr<model::RamBudgetManager> ram_budget_manager)
+      : tier_(ram_budget_manager != nullptr ? tier : nullptr),
+        ram_budget_manager_(std::move(ram_budget_manager)) {}
+  MemoryTierBuilder(MemoryTierBuilder&& other) { *this = std::move(other); }
+  MemoryTierBuilder& operator=(MemoryTierBuilder&& other) {
+    Release();
+    tier_ = std::exchange(other.tier_, nullptr);
+    ram_budget_manager_ = std::move(other.ram_budget_manager_);
+    elements_ = std::move(other.elements_);
+    bytes_ = std::exchange(other.bytes_, 0);
+    exhausted_ = other.exhausted_;
+    return *this;
+  }
+
+  ~MemoryTierBuilder() { Release(); }
+
+  // Adds the next element of the pass. Once an element doesn't fit in the RAM
+  // budget, no further elements are added.
+  void Add(const std::vector<Tensor>& element) {
+    if (tier_ == nullptr || exhausted_) {
+      return;
+    }
+    int64_t bytes = 0;
+    for (const Tensor& t : element) {
+      bytes += t.TotalBytes();
+    }
+    if (!ram_budget_manager_->RequestCacheBytes(bytes)) {
+      VLOG(2) << "Keeping " << elements_.size()
+              << " elements of the cache in memory, as the next element does "
+                 "not fit in the RAM budget.";
+      exhausted_ = true;
+      return;
+    }
+    bytes_ += bytes;
+    elements_.push_back(element);
+  }
+
+  // Completes the tier with the elements added so far. Must be called only
+  // once the pass has reached the end of the cache.
+  void Finish() {
+    if (tier_ == nullptr) {
+      return;
+    }
+    if (tier_->Complete(std::move(elements_), bytes_, ram_budget_manager_)) {
+      bytes_ = 0;
+    }
+    Release();
+  }
+
+ private:
+  void Release() {
+    if (bytes_ > 0) {
+      ram_budget_manager_->RequestCacheBytes(-bytes_);
+    }
+    tier_ = nullptr;
+    elements_.clear();
+    bytes_ = 0;
+  }
+
+  MemoryTier* tier_ = nullptr;  // Not owned.
+  std::shared_ptr<model::RamBudgetManager> ram_budget_manager_;
+  std::vector<std::vector<Tensor>> elements_;
+  int64_t bytes_ = 0;
+  bool exhausted_ = false;
+};
+
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, Env* env, bool hybrid)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        hybrid_(hybrid),
+        memory_tier_(hybrid ? std::make_unique<MemoryTier>() : nullptr),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -193,6 +328,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  protected:
   const DatasetBase* const input_;
   const tstring filename_;
+  const bool hybrid_;
 
  private:
   static size_t StringPaddingSize(size_t num_tensors) {
@@ -318,6 +454,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        memory_tier_builder_ = MemoryTierBuilder(
+            dataset()->memory_tier_.get(), ctx->ram_budget_manager());
         return dataset()->input_->MakeIterator(ctx, this, prefix(),
                                                &input_impl_);
       }
@@ -362,6 +501,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           string key = dataset()->FormatName(cur_index_, tensor_index++);
           TF_RETURN_IF_ERROR(writer_->Add(key, t));
         }
+        memory_tier_builder_.Add(*out_tensors);
         if (*end_of_sequence) {
           TF_RETURN_IF_ERROR(Finish());
         }
@@ -426,6 +566,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           }
         }
 
+        // The elements written before the checkpoint are not available in
+        // memory, so the memory tier is instead populated by a later pass
+        // which reads the cache file from the start.
+        memory_tier_builder_ = MemoryTierBuilder();
         if (reader->Contains(prefix(), kIterationCompleted)) {
           iteration_completed_ = true;
           return OkStatus();
@@ -515,6 +659,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         iteration_completed_ = true;
         // Flush the current bundle.
         TF_RETURN_IF_ERROR(writer_->Finish());
+        memory_tier_builder_.Finish();
         // Merge all the bundles.
         // Currently there are `shard_id_ + 1` bundles, one for each
         // checkpoint. Each bundle has prefix <filename>_<id> where `id` is an
@@ -553,6 +698,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       string lockfile_ TF_GUARDED_BY(mu_);
       bool lockfile_created_ TF_GUARDED_BY(mu_);
       bool iteration_completed_ TF_GUARDED_BY(mu_);
+      MemoryTierBuilder memory_tier_builder_ TF_GUARDED_BY(mu_);
     };  // FileWriterIterator
 
     class FileReaderIterator : public DatasetIterator<FileDatasetBase> {
@@ -561,15 +707,42 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
             reader_(dataset()->env_, dataset()->filename_),
-            iterator_restored_(false) {}
+            iterator_restored_(false),
+            seek_pending_(false) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        MemoryTier* memory_tier = dataset()->memory_tier_.get();
+        if (memory_tier != nullptr && !memory_tier->IsCompleted()) {
+          memory_tier_builder_ =
+              MemoryTierBuilder(memory_tier, ctx->ram_budget_manager());
+        }
+        return OkStatus();
+      }
 
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
         mutex_lock l(mu_);
         *end_of_sequence = false;
+        MemoryTier* memory_tier = dataset()->memory_tier_.get();
+        if (memory_tier != nullptr && memory_tier->IsCompleted() &&
+            cur_index_ < memory_tier->size()) {
+          *out_tensors = memory_tier->at(cur_index_);
+          cur_index_++;
+          // The next element read from the file is not the one `reader_` is
+          // pointing at.
+          seek_pending_ = true;
+          return OkStatus();
+        }
+        if (seek_pending_) {
+          reader_.Seek(dataset()->FormatName(cur_index_, 0));
+          iterator_restored_ = true;
+          seek_pending_ = false;
+        }
         TF_RETURN_IF_ERROR(reader_.status());
         if (!reader_.Valid()) {
+          memory_tier_builder_.Finish();
           *end_of_sequence = true;
           return OkStatus();
         }
@@ -587,6 +760,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           }
           if (!reader_.Valid()) {
             out_tensors->clear();
+            memory_tier_builder_.Finish();
             *end_of_sequence = true;
             return OkStatus();
           }
@@ -595,6 +769,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
           TF_RETURN_IF_ERROR(reader_.status());
         }
+        memory_tier_builder_.Add(*out_tensors);
         cur_index_++;
         return OkStatus();
       }
@@ -634,6 +809,12 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         reader_.Seek(dataset()->FormatName(cur_index_, 0));
         iterator_restored_ = true;
+        seek_pending_ = false;
+        // The memory tier must hold a prefix of the cache, so it can only be
+        // populated by a pass which starts at the first element.
+        if (cur_index_ > 0) {
+          memory_tier_builder_ = MemoryTierBuilder();
+        }
         return OkStatus();
       }
 
@@ -642,6 +823,11 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       size_t cur_index_ TF_GUARDED_BY(mu_);
       BundleReader reader_ TF_GUARDED_BY(mu_);
       bool iterator_restored_ TF_GUARDED_BY(mu_);
+      // Whether `reader_` needs to be moved to `cur_index_` because the
+      // previous elements were read from the memory tier.
+      bool seek_pending_ TF_GUARDED_BY(mu_);
+      // Populates the memory tier of a hybrid cache if it is not completed.
+      MemoryTierBuilder memory_tier_builder_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
     Status InitializeIterator(IteratorContext* ctx)
@@ -675,6 +861,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
     std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
   };  // FileIterator
 
+  // Only set for hybrid caches.
+  const std::unique_ptr<MemoryTier> memory_tier_;
   Env* const env_;
   const size_t num_tensors_;
   const size_t tensor_index_padding_size_;
@@ -695,7 +883,10 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph));
     Node* filename = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename));
-    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename}, output));
+    AttrValue hybrid;
+    b->BuildAttrValue(hybrid_, &hybrid);
+    TF_RETURN_IF_ERROR(b->AddDataset(this, {input_graph, filename},
+                                     {{kHybrid, hybrid}}, output));
     return OkStatus();
   }
 };
@@ -703,9 +894,9 @@ class CacheDatasetOp::FileDataset : public CacheDatasetOp::FileDatasetBase {
 class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
  public:
   explicit FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
-                         string filename, Env* env,
+                         string filename, Env* env, bool hybrid,
                          const Tensor& resource_handle)
-      : FileDatasetBase(ctx, input, filename, env),
+      : FileDatasetBase(ctx, input, filename, env, hybrid),
         resource_handle_(resource_handle) {}
 
  protected:
@@ -718,8 +909,11 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
-    TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+    AttrValue hybrid;
+    b->BuildAttrValue(hybrid_, &hybrid);
+    TF_RETURN_IF_ERROR(
+        b->AddDataset(this, {input_node, filename_node, resource_handle_node},
+                      {{kHybrid, hybrid}}, output));
     return OkStatus();
   }
 
@@ -1114,7 +1308,11 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (ctx->HasAttr(kHybrid)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kHybrid, &hybrid_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1163,10 +1361,10 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
   } else {
     if (op_version_ == 2) {
-      *output =
-          new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
+      *output = new FileDatasetV2(ctx, input, filename, ctx->env(), hybrid_,
+                                  ctx->input(2));
     } else {
-      *output = new FileDataset(ctx, input, filename, ctx->env());
+      *output = new FileDataset(ctx, input, filename, ctx->env(), hybrid_);
     }
   }
 }
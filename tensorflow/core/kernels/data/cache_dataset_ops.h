@@ -30,6 +30,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kHybrid = "hybrid";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -44,6 +45,7 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class MemoryDatasetV2;
 
   const int op_version_;
+  bool hybrid_ = false;
 };
 
 }  // namespace data
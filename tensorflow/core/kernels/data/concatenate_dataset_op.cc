@@ -116,14 +116,12 @@ class ConcatenateDatasetOp::Dataset : public DatasetBase {
 
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
-    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
-    if (index < input_cardinality_) {
-      TF_RETURN_IF_ERROR(input_->Get(ctx, index, out_tensors));
-    } else {
-      TF_RETURN_IF_ERROR(
-          to_concatenate_->Get(ctx, index - input_cardinality_, out_tensors));
-    }
-    return OkStatus();
+    return GetInternal(ctx, index, out_tensors);
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return GetInternal(ctx, index, out_tensors);
   }
 
  protected:
@@ -141,6 +139,19 @@ class ConcatenateDatasetOp::Dataset : public DatasetBase {
   }
 
  private:
+  template <typename ContextT>
+  Status GetInternal(ContextT* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    if (index < input_cardinality_) {
+      TF_RETURN_IF_ERROR(input_->Get(ctx, index, out_tensors));
+    } else {
+      TF_RETURN_IF_ERROR(
+          to_concatenate_->Get(ctx, index - input_cardinality_, out_tensors));
+    }
+    return OkStatus();
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
@@ -12,14 +12,21 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/data/text_chunk_reader.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -33,6 +40,9 @@ class CSVDatasetOp : public DatasetOpKernel {
         op_version_(ctx->def().op() == "CSVDatasetV2" ? 2 : 1) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+    OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar(kParallelTextChunkBytesEnvVar,
+                                            /*default_val=*/0,
+                                            &parallel_chunk_bytes_));
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
@@ -157,7 +167,8 @@ class CSVDatasetOp : public DatasetOpKernel {
                           output_types_, output_shapes_,
                           std::move(record_defaults), std::move(select_cols),
                           std::move(exclude_cols), use_quote_delim, delim[0],
-                          std::move(na_value), op_version_);
+                          std::move(na_value), op_version_,
+                          parallel_chunk_bytes_);
   }
 
  private:
@@ -169,7 +180,8 @@ class CSVDatasetOp : public DatasetOpKernel {
             const std::vector<PartialTensorShape>& output_shapes,
             std::vector<Tensor> record_defaults,
             std::vector<int64_t> select_cols, std::vector<int64_t> exclude_cols,
-            bool use_quote_delim, char delim, string na_value, int op_version)
+            bool use_quote_delim, char delim, string na_value, int op_version,
+            int64_t parallel_chunk_bytes)
         : DatasetBase(DatasetContext(ctx)),
           filenames_(std::move(filenames)),
           header_(header),
@@ -184,7 +196,8 @@ class CSVDatasetOp : public DatasetOpKernel {
           op_version_(op_version),
           use_compression_(!compression_type.empty()),
           compression_type_(std::move(compression_type)),
-          options_(options) {}
+          options_(options),
+          parallel_chunk_bytes_(parallel_chunk_bytes) {}
 
     std::unique_ptr<IteratorBase> MakeIteratorInternal(
         const string& prefix) const override {
@@ -288,8 +301,11 @@ class CSVDatasetOp : public DatasetOpKernel {
           // We are currently processing a file, so try to read the next record
           if (input_stream_) {
             Status s =
-                ReadRecord(ctx, out_tensors, select_all,
-                           dataset()->select_cols_, dataset()->exclude_cols_);
+                parallel_reader_
+                    ? GetNextParallelRecordLocked(out_tensors)
+                    : ReadRecord(ctx, out_tensors, select_all,
+                                 dataset()->select_cols_,
+                                 dataset()->exclude_cols_);
             if (s.ok()) {
               // Validate output
               if (out_tensors->size() != dataset()->out_type_.size()) {
@@ -317,6 +333,8 @@ class CSVDatasetOp : public DatasetOpKernel {
             return OkStatus();
           }
           TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+          TF_RETURN_IF_ERROR(
+              MaybeStartParallelReadLocked(ctx->env(), OffsetLocked()));
         } while (true);
       }
 
@@ -334,7 +352,16 @@ class CSVDatasetOp : public DatasetOpKernel {
         // `input_stream_` is empty if
         // 1. GetNext has not been called even once.
         // 2. All files have been read and the iterator has been exhausted.
-        if (input_stream_ && num_buffer_reads_ > 0) {
+        if (parallel_reader_) {
+          // Saves the offset of the next record as the equivalent position of
+          // a sequential read.
+          const int64_t offset = parallel_reader_->Tell();
+          const int64_t buffer_size = dataset()->options_.input_buffer_size;
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("pos"), offset % buffer_size));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("num_buffer_reads"),
+                                                 offset / buffer_size + 1));
+        } else if (input_stream_ && num_buffer_reads_ > 0) {
           TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("pos"), pos_));
           // If num_buffer_reads_ == 0, the buffer hasn't been filled even once.
           TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("num_buffer_reads"),
@@ -360,6 +387,13 @@ class CSVDatasetOp : public DatasetOpKernel {
                                                 &num_buffer_reads));
 
           TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+          TF_RETURN_IF_ERROR(MaybeStartParallelReadLocked(
+              ctx->env(),
+              (num_buffer_reads - 1) * dataset()->options_.input_buffer_size +
+                  pos));
+          if (parallel_reader_) {
+            return OkStatus();
+          }
 
           num_buffer_reads_ = size_t(num_buffer_reads - 1);
 
@@ -384,6 +418,88 @@ class CSVDatasetOp : public DatasetOpKernel {
       }
 
      private:
+      // A record parsed by `parallel_reader_`, and the status of its parsing.
+      struct ParsedRecord {
+        std::vector<Tensor> tensors;
+        Status status;
+      };
+
+      // Returns the next record of `parallel_reader_`.
+      Status GetNextParallelRecordLocked(std::vector<Tensor>* out_tensors)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        ParsedRecord record;
+        TF_RETURN_IF_ERROR(parallel_reader_->GetNext(&record));
+        *out_tensors = std::move(record.tensors);
+        return record.status;
+      }
+
+      // Returns the offset in `input_stream_` of the next character to parse.
+      int64_t OffsetLocked() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+        if (num_buffer_reads_ == 0) return 0;
+        return (num_buffer_reads_ - 1) * dataset()->options_.input_buffer_size +
+               pos_;
+      }
+
+      // Parses the rest of the file at `current_file_index_` from `offset` in
+      // parallel chunks, if parallel parsing is enabled and the file is
+      // uncompressed and spans several chunks. The records are then read from
+      // `parallel_reader_` instead of `input_stream_`.
+      Status MaybeStartParallelReadLocked(Env* env, int64_t offset)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int64_t chunk_bytes = dataset()->parallel_chunk_bytes_;
+        if (chunk_bytes <= 0 || dataset()->use_compression_) {
+          return OkStatus();
+        }
+        uint64 file_size;
+        TF_RETURN_IF_ERROR(env->GetFileSize(
+            dataset()->filenames_[current_file_index_], &file_size));
+        if (static_cast<int64_t>(file_size) - offset < 2 * chunk_bytes) {
+          return OkStatus();
+        }
+        std::vector<int64_t> boundaries;
+        TF_RETURN_IF_ERROR(FindTextChunkBoundaries(
+            file_.get(), offset, file_size, chunk_bytes,
+            dataset()->use_quote_delim_, &boundaries));
+        RandomAccessFile* file = file_.get();
+        parallel_reader_ = std::make_unique<TextChunkReader<ParsedRecord>>(
+            std::move(boundaries),
+            [this, file](int64_t start, int64_t end,
+                         std::vector<ParsedRecord>* records,
+                         std::vector<int64_t>* record_ends) {
+              return ParseChunk(file, start, end, records, record_ends);
+            });
+        return OkStatus();
+      }
+
+      // Parses the records of the bytes [start, end) of `file` with a parser
+      // of its own, so that several chunks can be parsed concurrently.
+      Status ParseChunk(RandomAccessFile* file, int64_t start, int64_t end,
+                        std::vector<ParsedRecord>* records,
+                        std::vector<int64_t>* record_ends) const {
+        Iterator parser(Params{dataset(), prefix()});
+        mutex_lock l(parser.mu_);
+        parser.random_access_input_stream_ =
+            std::make_shared<io::RandomAccessInputStream>(file, false);
+        TF_RETURN_IF_ERROR(parser.random_access_input_stream_->Seek(start));
+        parser.input_stream_ = parser.random_access_input_stream_;
+        parser.buffer_.clear();
+        parser.pos_ = 0;
+        parser.num_buffer_reads_ = 0;
+        const bool select_all =
+            dataset()->select_cols_.empty() && dataset()->exclude_cols_.empty();
+        while (start + parser.OffsetLocked() < end) {
+          ParsedRecord record;
+          Status s = parser.ReadRecord(/*ctx=*/nullptr, &record.tensors,
+                                       select_all, dataset()->select_cols_,
+                                       dataset()->exclude_cols_);
+          if (errors::IsOutOfRange(s)) break;
+          record.status = s;
+          records->push_back(std::move(record));
+          record_ends->push_back(start + parser.OffsetLocked());
+        }
+        return OkStatus();
+      }
+
       // Reads an entire CSV row from the input stream, either from the
       // existing buffer or by filling the buffer as needed. Converts extracted
       // fields to output tensors as we go.
@@ -711,7 +827,9 @@ class CSVDatasetOp : public DatasetOpKernel {
                                          " fields but have more in record");
         }
         const DataType& dtype = dataset()->out_type_[output_idx];
-        out_tensors->emplace_back(ctx->allocator({}), dtype, TensorShape({}));
+        // The records parsed by `parallel_reader_` have no `ctx`.
+        out_tensors->emplace_back(ctx ? ctx->allocator({}) : cpu_allocator(),
+                                  dtype, TensorShape({}));
         Tensor& component = out_tensors->back();
         if ((field.empty() || field == dataset()->na_value_) &&
             dataset()->record_defaults_[output_idx].NumElements() != 1) {
@@ -888,6 +1006,7 @@ class CSVDatasetOp : public DatasetOpKernel {
 
       // Resets all reader streams.
       void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        parallel_reader_.reset();
         input_stream_.reset();
         file_.reset();
       }
@@ -904,7 +1023,10 @@ class CSVDatasetOp : public DatasetOpKernel {
       size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
       std::unique_ptr<RandomAccessFile> file_
           TF_GUARDED_BY(mu_);  // must outlive input_stream_
-    };                         // class Iterator
+      // Parses the records of `file_` in parallel, if set.
+      std::unique_ptr<TextChunkReader<ParsedRecord>> parallel_reader_
+          TF_GUARDED_BY(mu_);
+    };  // class Iterator
 
     const std::vector<string> filenames_;
     const bool header_;
@@ -920,12 +1042,16 @@ class CSVDatasetOp : public DatasetOpKernel {
     const bool use_compression_;
     const tstring compression_type_;
     const io::ZlibCompressionOptions options_;
+    const int64_t parallel_chunk_bytes_;
   };  // class Dataset
 
   const int op_version_;
 
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
+  // The size of the chunks in which large uncompressed files are parsed in
+  // parallel, or 0 to parse them sequentially.
+  int64_t parallel_chunk_bytes_;
 };  // class CSVDatasetOp
 
 REGISTER_KERNEL_BUILDER(Name("CSVDataset").Device(DEVICE_CPU), CSVDatasetOp);
@@ -24,8 +24,10 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/activity_watcher/activity.h"
 #include "tensorflow/core/activity_watcher/activity_utils.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/finalization_utils.h"
 #include "tensorflow/core/data/metric_utils.h"
@@ -74,6 +76,16 @@ bool SymbolicCheckpointEnabled(const Options& options) {
          options.symbolic_checkpoint();
 }
 
+// Records the time since `start_time_ns` into the costs of the request the
+// step runs for, if any.
+void RecordTfDataRequestCost(OpKernelContext* ctx, uint64 start_time_ns) {
+  RequestCost* request_cost = ctx->request_cost();
+  if (request_cost == nullptr) return;
+  request_cost->RecordCost(
+      {{kTfDataCostName,
+        absl::Nanoseconds(EnvTime::NowNanos() - start_time_ns)}});
+}
+
 }  // namespace
 
 /* static */ constexpr const char* const
@@ -891,7 +903,10 @@ Status IteratorGetNextOp::DoCompute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
   bool end_of_sequence = false;
 
-  TF_RETURN_IF_ERROR(iterator->GetNext(ctx, &components, &end_of_sequence));
+  const uint64 start_time_ns = EnvTime::NowNanos();
+  Status s = iterator->GetNext(ctx, &components, &end_of_sequence);
+  RecordTfDataRequestCost(ctx, start_time_ns);
+  TF_RETURN_IF_ERROR(s);
   if (end_of_sequence) {
     return errors::OutOfRange("End of sequence");
   }
@@ -932,7 +947,10 @@ Status IteratorGetNextAsOptionalOp::DoCompute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
   bool end_of_sequence = false;
 
-  TF_RETURN_IF_ERROR(iterator->GetNext(ctx, &components, &end_of_sequence));
+  const uint64 start_time_ns = EnvTime::NowNanos();
+  Status s = iterator->GetNext(ctx, &components, &end_of_sequence);
+  RecordTfDataRequestCost(ctx, start_time_ns);
+  TF_RETURN_IF_ERROR(s);
 
   if (end_of_sequence) {
     return WriteOptionalNoneToOutput(ctx, 0);
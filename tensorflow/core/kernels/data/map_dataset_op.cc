@@ -104,6 +104,20 @@ class MapDatasetOp::Dataset : public DatasetBase {
     return instantiated_captured_func_->RunInstantiated(args, out_tensors);
   }
 
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    std::vector<Tensor> args;
+    TF_RETURN_IF_ERROR(input_->Get(ctx, index, &args));
+    // The function is instantiated against the function library of the
+    // calling iterator, so it can't be shared with `Get(OpKernelContext*)`.
+    // Repeated instantiations hit the iterator's function handle cache.
+    std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func;
+    TF_RETURN_IF_ERROR(captured_func_->Instantiate(
+        InstantiateCapturedFunctionParams(ctx), &instantiated_captured_func));
+    return instantiated_captured_func->RunInstantiated(args, out_tensors);
+  }
+
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
                             DatasetGraphDefBuilder* b,
@@ -12,25 +12,32 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include "tensorflow/core/kernels/data/multi_device_iterator_ops.h"
+
 #include <atomic>
 #include <cstdint>
+#include <cstring>
 #include <deque>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/metric_utils.h"
 #include "tensorflow/core/data/root_dataset.h"
 #include "tensorflow/core/data/unbounded_thread_pool.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 #include "tensorflow/core/kernels/ops_util.h"
@@ -43,6 +50,47 @@ limitations under the License.
 
 namespace tensorflow {
 namespace data {
+
+std::vector<Allocator*> GetPinnedHostAllocators(
+    const DeviceMgr* device_mgr, const std::vector<string>& devices) {
+  std::vector<Allocator*> allocators(devices.size(), nullptr);
+  if (device_mgr == nullptr) {
+    return allocators;
+  }
+  AllocatorAttributes attrs;
+  attrs.set_on_host(true);
+  attrs.set_gpu_compatible(true);
+  for (int i = 0; i < devices.size(); ++i) {
+    Device* device;
+    if (!device_mgr->LookupDevice(devices[i], &device).ok()) {
+      continue;
+    }
+    Allocator* allocator = device->GetAllocator(attrs);
+    if (allocator != nullptr &&
+        allocator->GetMemoryType() == AllocatorMemoryType::kHostPinned) {
+      allocators[i] = allocator;
+    }
+  }
+  return allocators;
+}
+
+void StageInPinnedMemory(Allocator* allocator, std::vector<Tensor>* element) {
+  for (Tensor& component : *element) {
+    if (!DataTypeCanUseMemcpy(component.dtype()) ||
+        component.TotalBytes() == 0 ||
+        component.GetMemoryType() == AllocatorMemoryType::kHostPinned) {
+      continue;
+    }
+    Tensor pinned(allocator, component.dtype(), component.shape());
+    if (!pinned.IsInitialized()) {
+      // Fall back to the pageable tensor if pinned memory is exhausted.
+      continue;
+    }
+    std::memcpy(pinned.data(), component.data(), component.TotalBytes());
+    component = std::move(pinned);
+  }
+}
+
 namespace {
 
 const char kAnonymousMultiDeviceIterator[] = "AnonymousMultiDeviceIterator";
@@ -91,7 +139,9 @@ class MultiDeviceIterator : public ResourceBase {
         flib_def_(std::move(flib_def)),
         flr_(flr),
         pflr_(std::move(pflr)),
-        function_handle_cache_(std::move(function_handle_cache)) {
+        function_handle_cache_(std::move(function_handle_cache)),
+        pinned_host_allocators_(GetPinnedHostAllocators(
+            flr ? flr->device_mgr() : nullptr, devices)) {
     DCHECK(flr_ != nullptr);
     VLOG(2) << "Creating multi-device iterator.";
   }
@@ -168,6 +218,12 @@ class MultiDeviceIterator : public ResourceBase {
 
   IteratorMetricsCollector& metrics_collector() { return metrics_collector_; }
 
+  // Returns the pinned host allocator of the device for `shard_num`, or nullptr
+  // if elements for that shard should not be staged in pinned memory.
+  Allocator* pinned_host_allocator(int shard_num) const {
+    return pinned_host_allocators_[shard_num];
+  }
+
  private:
   // A private class that uses a background thread to keep a per device buffer
   // full.
@@ -372,6 +428,12 @@ class MultiDeviceIterator : public ResourceBase {
         if (elem.status.ok() && elem.end_of_sequence) {
           end_of_iterator = true;
         }
+        Allocator* pinned_allocator =
+            parent_->pinned_host_allocator(shard_to_fetch);
+        if (elem.status.ok() && !elem.end_of_sequence &&
+            pinned_allocator != nullptr) {
+          StageInPinnedMemory(pinned_allocator, &elem.value);
+        }
 
         std::shared_ptr<HostBuffer::CallbackContainer> callback_container;
         {
@@ -465,6 +527,8 @@ class MultiDeviceIterator : public ResourceBase {
   FunctionLibraryRuntime* const flr_ = nullptr;  // not owned.
   const std::unique_ptr<ProcessFunctionLibraryRuntime> pflr_;
   const std::unique_ptr<FunctionHandleCache> function_handle_cache_;
+  // Indexed by shard; see `pinned_host_allocator()`.
+  const std::vector<Allocator*> pinned_host_allocators_;
   ResourceMgr resource_mgr_;
   CancellationManager cancellation_manager_;
 
@@ -0,0 +1,43 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_MULTI_DEVICE_ITERATOR_OPS_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_MULTI_DEVICE_ITERATOR_OPS_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Returns, for each of `devices`, the allocator for pinned host memory that
+// the device uses to stage host-to-device copies, or nullptr if the device is
+// not in `device_mgr` or has no such allocator. `device_mgr` may be null.
+std::vector<Allocator*> GetPinnedHostAllocators(
+    const DeviceMgr* device_mgr, const std::vector<string>& devices);
+
+// Moves the components of `element` which live in pageable host memory into
+// buffers from `allocator`, so that copying them to the device does not need a
+// synchronous staging copy on the host-to-device path. Components which cannot
+// be copied with memcpy, or for which the allocation fails, are left as is.
+void StageInPinnedMemory(Allocator* allocator, std::vector<Tensor>* element);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_MULTI_DEVICE_ITERATOR_OPS_H_
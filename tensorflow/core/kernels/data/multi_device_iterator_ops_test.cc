@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/multi_device_iterator_ops.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kPinnedDevice[] = "/job:localhost/replica:0/task:0/device:GPU:0";
+constexpr char kPageableDevice[] =
+    "/job:localhost/replica:0/task:0/device:CPU:0";
+
+// Hands out host memory which it reports as pinned, or nothing once
+// `set_exhausted` was called.
+class FakePinnedAllocator : public Allocator {
+ public:
+  std::string Name() override { return "fake_pinned"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    if (exhausted_) {
+      return nullptr;
+    }
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPinned;
+  }
+
+  void set_exhausted() { exhausted_ = true; }
+
+ private:
+  bool exhausted_ = false;
+};
+
+// A device which uses `pinned_allocator`, if any, for gpu compatible host
+// memory.
+class FakeDevice : public Device {
+ public:
+  FakeDevice(const char* name, Allocator* pinned_allocator)
+      : Device(nullptr, Attributes(name)),
+        pinned_allocator_(pinned_allocator) {}
+
+  Status Sync() override { return OkStatus(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attrs) override {
+    if (attrs.on_host() && attrs.gpu_compatible() &&
+        pinned_allocator_ != nullptr) {
+      return pinned_allocator_;
+    }
+    return cpu_allocator();
+  }
+
+ private:
+  static DeviceAttributes Attributes(const char* name) {
+    DeviceAttributes attributes;
+    attributes.set_name(name);
+    attributes.set_device_type("FakeDevice");
+    return attributes;
+  }
+
+  Allocator* const pinned_allocator_;
+};
+
+class PinnedStagingTest : public ::testing::Test {
+ protected:
+  PinnedStagingTest() {
+    std::vector<std::unique_ptr<Device>> devices;
+    devices.push_back(
+        std::make_unique<FakeDevice>(kPinnedDevice, &pinned_allocator_));
+    devices.push_back(std::make_unique<FakeDevice>(kPageableDevice, nullptr));
+    device_mgr_ = std::make_unique<StaticDeviceMgr>(std::move(devices));
+  }
+
+  FakePinnedAllocator pinned_allocator_;
+  std::unique_ptr<DeviceMgr> device_mgr_;
+};
+
+TEST_F(PinnedStagingTest, GetPinnedHostAllocators) {
+  EXPECT_EQ(GetPinnedHostAllocators(
+                device_mgr_.get(),
+                {kPinnedDevice, kPageableDevice,
+                 "/job:worker/replica:0/task:1/device:GPU:0"}),
+            std::vector<Allocator*>({&pinned_allocator_, nullptr, nullptr}));
+  EXPECT_EQ(GetPinnedHostAllocators(/*device_mgr=*/nullptr, {kPinnedDevice}),
+            std::vector<Allocator*>({nullptr}));
+}
+
+TEST_F(PinnedStagingTest, StagesMemcpyableComponents) {
+  Tensor numbers = test::AsTensor<float>({1.0, 2.0, 3.0});
+  Tensor strings = test::AsTensor<tstring>({"a", "b"});
+  Tensor empty(DT_INT64, TensorShape({0}));
+  std::vector<Tensor> element = {numbers, strings, empty};
+
+  StageInPinnedMemory(&pinned_allocator_, &element);
+
+  ASSERT_EQ(element.size(), 3);
+  EXPECT_EQ(element[0].GetMemoryType(), AllocatorMemoryType::kHostPinned);
+  EXPECT_NE(element[0].data(), numbers.data());
+  test::ExpectTensorEqual<float>(element[0], numbers);
+  EXPECT_EQ(element[1].data(), strings.data());
+  EXPECT_EQ(element[2].NumElements(), 0);
+
+  // Staging an element again does not copy it.
+  const void* pinned_data = element[0].data();
+  StageInPinnedMemory(&pinned_allocator_, &element);
+  EXPECT_EQ(element[0].data(), pinned_data);
+}
+
+TEST_F(PinnedStagingTest, KeepsPageableComponentsIfAllocationFails) {
+  Tensor numbers = test::AsTensor<int32>({1, 2, 3});
+  std::vector<Tensor> element = {numbers};
+  pinned_allocator_.set_exhausted();
+
+  StageInPinnedMemory(&pinned_allocator_, &element);
+
+  ASSERT_EQ(element.size(), 1);
+  EXPECT_EQ(element[0].data(), numbers.data());
+  test::ExpectTensorEqual<int32>(element[0], numbers);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -76,6 +76,11 @@ class OptionsDatasetOp::Dataset : public DatasetBase {
     return input_->Get(ctx, index, out_tensors);
   }
 
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return input_->Get(ctx, index, out_tensors);
+  }
+
   string DebugString() const override {
     return name_utils::DatasetDebugString(kDatasetType);
   }
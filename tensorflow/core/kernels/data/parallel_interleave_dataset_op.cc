@@ -82,6 +82,8 @@ namespace data {
 /* static */ constexpr const char* const
     ParallelInterleaveDatasetOp::kDeterministic;
 /* static */ constexpr const char* const ParallelInterleaveDatasetOp::kSloppy;
+/* static */ constexpr const char* const
+    ParallelInterleaveDatasetOp::kReadAheadBytes;
 
 namespace {
 
@@ -201,7 +203,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::unique_ptr<CapturedFunction> captured_func, int64_t cycle_length,
           int64_t block_length, int64_t buffer_output_elements,
           int64_t prefetch_input_elements, int64_t num_parallel_calls,
-          DeterminismPolicy deterministic, const DataTypeVector& output_types,
+          DeterminismPolicy deterministic, int64_t read_ahead_bytes,
+          const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
@@ -215,6 +218,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             prefetch_input_elements, cycle_length_)),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
+        read_ahead_bytes_(read_ahead_bytes),
         output_types_(output_types),
         output_shapes_(output_shapes),
         op_version_(op_version),
@@ -349,6 +353,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       b->BuildAttrValue(deterministic_.String(), &deterministic_attr);
       attrs.emplace_back(kDeterministic, deterministic_attr);
     }
+    if (op_version_ >= 4) {
+      AttrValue read_ahead_bytes_attr;
+      b->BuildAttrValue(read_ahead_bytes_, &read_ahead_bytes_attr);
+      attrs.emplace_back(kReadAheadBytes, read_ahead_bytes_attr);
+    }
 
     TF_RETURN_IF_ERROR(b->AddDataset(this, inputs, list_inputs, attrs, output));
     return OkStatus();
@@ -630,10 +639,22 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       explicit Result(IteratorContext* ctx)
           : checkpoint(MemoryCheckpoint{ctx->id_registry()}) {}
 
+      ~Result() {
+        if (ram_budget_manager) {
+          ram_budget_manager->RequestReadAheadBytes(-read_ahead_bytes);
+        }
+      }
+
       Status status;
       int64_t id = -1;
       std::vector<Tensor> return_values;
       MemoryCheckpoint checkpoint;
+      // The size of the result if it was read ahead, i.e. buffered beyond
+      // `buffer_output_elements_`, and 0 otherwise.
+      int64_t read_ahead_bytes = 0;
+      // Set if `read_ahead_bytes` are reserved from the RAM budget, which
+      // are released when the result is destroyed.
+      std::shared_ptr<model::RamBudgetManager> ram_budget_manager;
     };
 
     // The interleave transformation repeatedly inputs elements, applies the
@@ -668,6 +689,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // Whether we tried to initialize the element, but the input iterator
       // was exhausted so we could produce no inputs.
       bool no_input TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = false;
+      // The total size of the buffered results which were read ahead.
+      int64_t read_ahead_bytes TF_GUARDED_BY(
+          &ParallelInterleaveIterator::mu_) = 0;
+      // Whether the RAM budget refused the last read-ahead result. Reading
+      // ahead resumes once a result of the element is consumed.
+      bool read_ahead_refused TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) =
+          false;
       // Condition variable for communicating between current worker threads
       // and GetNext.
       condition_variable cond_var;
@@ -801,6 +829,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           // We found a result.
           std::swap(*result, element->results.front());
           element->results.pop_front();
+          element->read_ahead_bytes -= (*result)->read_ahead_bytes;
+          element->read_ahead_refused = false;
           if (!element->active) {
             elements_to_process_.push_back(cycle_index_);
             current_workers_cond_var_.notify_one();
@@ -1002,6 +1032,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               element->active = false;
               break;
             }
+            if (element->results.size() >=
+                dataset()->buffer_output_elements_) {
+              // The element is reading ahead, which is done one result at a
+              // time so that the elements other workers wait for come first.
+              element->active = false;
+              elements_to_process_.push_back(element_index);
+              current_workers_cond_var_.notify_one();
+              break;
+            }
           }
         }
       }
@@ -1107,9 +1146,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         RecordBufferEnqueue(ctx, result->return_values);
         mutex_lock l(*mu_);
+        if (element->results.size() >= dataset()->buffer_output_elements_) {
+          ReserveReadAheadBytes(ctx, *element, *result);
+        }
         element->results.push_back(std::move(result));
         NotifyElementUpdate(*element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= dataset()->buffer_output_elements_) {
           break;
         }
       }
@@ -1203,7 +1245,36 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             (element->results.size() < dataset()->buffer_output_elements_ ||
+              CanReadAhead(*element));
+    }
+
+    // Whether `element` may buffer results beyond `buffer_output_elements_`.
+    // Only elements of the current cycle read ahead, so that a slow element
+    // only delays its own slot while the others keep fetching.
+    bool CanReadAhead(const Element& element) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return deterministic_ && element.cycle_index != -1 &&
+             element.read_ahead_bytes < dataset()->read_ahead_bytes_ &&
+             !element.read_ahead_refused;
+    }
+
+    // Accounts for `result` being read ahead by `element`, reserving its size
+    // from the RAM budget of the iterator if there is one.
+    void ReserveReadAheadBytes(IteratorContext* ctx, Element& element,
+                               Result& result)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      result.read_ahead_bytes = GetTotalBytes(result.return_values);
+      element.read_ahead_bytes += result.read_ahead_bytes;
+      const std::shared_ptr<model::RamBudgetManager>& ram_budget_manager =
+          ctx->ram_budget_manager();
+      if (!ram_budget_manager) {
+        return;
+      }
+      if (ram_budget_manager->RequestReadAheadBytes(result.read_ahead_bytes)) {
+        result.ram_budget_manager = ram_budget_manager;
+      } else {
+        element.read_ahead_refused = true;
+      }
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1747,6 +1818,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64_t prefetch_input_elements_;
   const int64_t num_parallel_calls_;
   const DeterminismPolicy deterministic_;
+  // In deterministic mode, the number of bytes that each element of the
+  // current cycle may buffer beyond `buffer_output_elements_`. 0 disables
+  // reading ahead.
+  const int64_t read_ahead_bytes_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
   const int op_version_;
@@ -1777,6 +1852,13 @@ ParallelInterleaveDatasetOp::ParallelInterleaveDatasetOp(
     OP_REQUIRES_OK(
         ctx, DeterminismPolicy::FromString(deterministic, &deterministic_));
   }
+  if (ctx->HasAttr(kReadAheadBytes)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kReadAheadBytes, &read_ahead_bytes_));
+    OP_REQUIRES(ctx, read_ahead_bytes_ >= 0,
+                errors::InvalidArgument("`read_ahead_bytes` must be >= 0 but "
+                                        "is ",
+                                        read_ahead_bytes_));
+  }
 }
 
 void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -1843,7 +1925,8 @@ void ParallelInterleaveDatasetOp::MakeDataset(OpKernelContext* ctx,
   *output = new Dataset(
       ctx, input, std::move(captured_func), cycle_length, block_length,
       buffer_output_elements, prefetch_input_elements, num_parallel_calls,
-      deterministic_, output_types_, output_shapes_, op_version_);
+      deterministic_, read_ahead_bytes_, output_types_, output_shapes_,
+      op_version_);
 }
 
 namespace {
@@ -54,6 +54,7 @@ namespace data {
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputShapes;
 /* static */ constexpr const char* const
     ShuffleDatasetOpBase::kReshuffleEachIteration;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kIndexShuffle;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
 
@@ -75,12 +76,32 @@ constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kSlicesReachedEndOfSequence[] = "slices_reached_end_of_sequence";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kNextIndex[] = "next_index";
 constexpr char kShuffleDatasetV1[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
 constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
+namespace {
+
+// Fills `indices` with a uniformly random permutation of
+// [0, `indices->size()`), using the given seeds.
+void ShuffleIndices(int64_t seed, int64_t seed2,
+                    std::vector<std::int64_t>* indices) {
+  std::iota(indices->begin(), indices->end(), 0);
+  random::PhiloxRandom parent_generator = random::PhiloxRandom(seed, seed2);
+  random::SingleSampleAdapter<random::PhiloxRandom> generator =
+      random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator);
+  const int64_t size = indices->size();
+  for (int64_t i = 0; i < size; ++i) {
+    int64_t offset = generator() % (size - i);
+    std::swap((*indices)[i + offset], (*indices)[i]);
+  }
+}
+
+}  // namespace
+
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx) {}
 
@@ -90,12 +111,13 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
-                     int64_t count)
+                     int64_t count, bool index_shuffle = false)
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        index_shuffle_(index_shuffle),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
@@ -160,27 +182,21 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (index_shuffle_) {
+      return std::make_unique<IndexShuffleIterator>(
+          IndexShuffleIterator::Params{
+              this, name_utils::IteratorPrefix(op_type(), prefix)},
+          seed_generator_.get());
+    }
     return std::make_unique<Iterator>(
         Iterator::Params{this, name_utils::IteratorPrefix(op_type(), prefix)},
         seed_generator_.get());
   }
 
   void InitializeRandomAccessIndices() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 cardinality = Cardinality();
-    shuffled_indices_ = std::vector<std::int64_t>(cardinality);
-    std::iota(shuffled_indices_.begin(), shuffled_indices_.end(), 0);
-    int64_t shuffled_index = 0;
-    random::PhiloxRandom parent_generator =
-        random::PhiloxRandom(seed_generator_->seed(), seed_generator_->seed2());
-    random::SingleSampleAdapter<random::PhiloxRandom> generator =
-        random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator);
-
-    while (shuffled_index < cardinality) {
-      int64_t offset = generator() % (cardinality - shuffled_index);
-      std::swap(shuffled_indices_[shuffled_index + offset],
-                shuffled_indices_[shuffled_index]);
-      shuffled_index += 1;
-    }
+    shuffled_indices_ = std::vector<std::int64_t>(Cardinality());
+    ShuffleIndices(seed_generator_->seed(), seed_generator_->seed2(),
+                   &shuffled_indices_);
   }
 
  protected:
@@ -581,6 +597,135 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
   };
 
+  // Produces the elements of a randomly accessible input in random order by
+  // shuffling their indices and fetching each element with `Get()`, instead
+  // of buffering elements. Each epoch is a uniformly random permutation of the
+  // whole input regardless of `buffer_size`, and the only state kept is one
+  // index per input element.
+  class IndexShuffleIterator : public DatasetIterator<ShuffleDatasetBase> {
+   public:
+    explicit IndexShuffleIterator(const Params& params,
+                                  SeedGenerator* seed_generator)
+        : DatasetIterator<ShuffleDatasetBase>(params),
+          seed_generator_(seed_generator) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(InitializeIndices());
+      seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      ShuffleIndices(seed_, seed2_, &indices_);
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (next_index_ == indices_.size()) {
+        if (indices_.empty() ||
+            (dataset()->count_ != -1 && epoch_ + 1 >= dataset()->count_)) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        epoch_++;
+        next_index_ = 0;
+        seed_generator_->GenerateSeeds(&seed_, &seed2_);
+        ShuffleIndices(seed_, seed2_, &indices_);
+      }
+      Status s =
+          dataset()->input_->Get(ctx, indices_[next_index_], out_tensors);
+      if (errors::IsUnimplemented(s)) {
+        return errors::Unimplemented(
+            "Index shuffling requires an input dataset which supports random "
+            "access, but ",
+            dataset()->input_->DebugString(), " does not.");
+      }
+      TF_RETURN_IF_ERROR(s);
+      next_index_++;
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kEpochNumRandomSamples,
+                              seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed, seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed2, seed2_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kEpoch, epoch_));
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNextIndex, next_index_));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kEpochNumRandomSamples,
+                                            &num_random_samples));
+      seed_generator_->set_num_random_samples(num_random_samples);
+      seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed, &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed2, &seed2_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kEpoch, &epoch_));
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNextIndex, &next_index_));
+      // The permutation is a function of the seeds, so it is recomputed
+      // rather than checkpointed.
+      TF_RETURN_IF_ERROR(InitializeIndices());
+      ShuffleIndices(seed_, seed2_, &indices_);
+      if (next_index_ < 0 || next_index_ > indices_.size()) {
+        return errors::FailedPrecondition(
+            "Failed to restore the index shuffle iterator: the checkpointed "
+            "position ",
+            next_index_, " is out of range for an input of ", indices_.size(),
+            " elements.");
+      }
+      return OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return this->dataset()->traceme_metadata_;
+    }
+
+   private:
+    Status InitializeIndices() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t cardinality = dataset()->input_->Cardinality();
+      if (cardinality == kInfiniteCardinality ||
+          cardinality == kUnknownCardinality) {
+        return errors::FailedPrecondition(
+            "Index shuffling requires an input dataset with a known, finite "
+            "cardinality, but ",
+            dataset()->input_->DebugString(), " has ",
+            cardinality == kInfiniteCardinality ? "infinite" : "unknown",
+            " cardinality.");
+      }
+      indices_.resize(cardinality);
+      return OkStatus();
+    }
+
+    mutex mu_;
+    SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    // The order in which the input elements are produced in this epoch.
+    std::vector<std::int64_t> indices_ TF_GUARDED_BY(mu_);
+    // The position in `indices_` of the next element to produce.
+    int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+    int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+  };
+
   const DatasetBase* const input_;
   const int64_t buffer_size_;
   const std::shared_ptr<SeedGenerator> seed_generator_;
@@ -588,6 +733,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  // Whether iterators shuffle element indices instead of elements.
+  const bool index_shuffle_;
   const TraceMeMetadata traceme_metadata_;
   mutable mutex mu_;
   mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
@@ -601,8 +748,9 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
           int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-          ResourceHandle&& resource_handle)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+          ResourceHandle&& resource_handle, bool index_shuffle)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           index_shuffle),
         manager_(manager),
         resource_handle_(std::move(resource_handle)),
         resource_mgr_(ctx->resource_manager()),
@@ -635,11 +783,13 @@ class ShuffleDatasetOp::Dataset : public ShuffleDatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2_node));
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue index_shuffle;
+    b->BuildAttrValue(index_shuffle_, &index_shuffle);
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
         {input_graph_node, buffer_size_node, seed_node, seed2_node},  // Inputs
-        {std::make_pair(kReshuffleEachIteration,
-                        reshuffle_each_iteration)},  // Attrs
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration),
+         std::make_pair(kIndexShuffle, index_shuffle)},  // Attrs
         output));
     return OkStatus();
   }
@@ -713,8 +863,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            bool index_shuffle)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           index_shuffle),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -753,12 +905,15 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue index_shuffle;
+    b->BuildAttrValue(index_shuffle_, &index_shuffle);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kIndexShuffle, index_shuffle)},  // Attrs
                       output));
     return OkStatus();
   }
@@ -785,6 +940,9 @@ ShuffleDatasetOp::ShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kIndexShuffle)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kIndexShuffle, &index_shuffle_));
+  }
 }
 
 void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -836,9 +994,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, index_shuffle_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
@@ -900,7 +1058,7 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     // Ownership of manager is transferred onto `Dataset`.
     *output = new ShuffleDatasetOp::Dataset(ctx, input, buffer_size, count,
                                             std::move(seeds), manager,
-                                            std::move(handle));
+                                            std::move(handle), index_shuffle_);
   }
 }
 
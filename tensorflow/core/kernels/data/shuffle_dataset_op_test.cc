@@ -33,14 +33,15 @@ class ShuffleDatasetParams : public DatasetParams {
                        bool reshuffle_each_iteration,
                        DataTypeVector output_dtypes,
                        std::vector<PartialTensorShape> output_shapes,
-                       string node_name)
+                       string node_name, bool index_shuffle = false)
       : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
                       std::move(node_name)),
         buffer_size_(buffer_size),
         seed_(seed),
         seed2_(seed2),
         count_(count),
-        reshuffle_each_iteration_(reshuffle_each_iteration) {
+        reshuffle_each_iteration_(reshuffle_each_iteration),
+        index_shuffle_(index_shuffle) {
     input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
     iterator_prefix_ =
         name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
@@ -78,6 +79,9 @@ class ShuffleDatasetParams : public DatasetParams {
     attr_vector->emplace_back("reshuffle_each_iteration",
                               reshuffle_each_iteration_);
     attr_vector->emplace_back("metadata", "");
+    if (count_ == 1) {
+      attr_vector->emplace_back("index_shuffle", index_shuffle_);
+    }
     return OkStatus();
   }
 
@@ -96,6 +100,7 @@ class ShuffleDatasetParams : public DatasetParams {
   int64_t seed2_;
   int64_t count_;
   bool reshuffle_each_iteration_;
+  bool index_shuffle_;
 };
 
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
@@ -221,6 +226,21 @@ ShuffleDatasetParams ShuffleDatasetParamsWithUnknownCardinality() {
                               /*node_name=*/kShuffleNodeName);
 }
 
+// Shuffles indices instead of elements. The buffer size is ignored.
+ShuffleDatasetParams ShuffleDatasetParamsWithIndexShuffle(
+    bool reshuffle_each_iteration) {
+  return ShuffleDatasetParams(RangeDatasetParams(0, 10, 1),
+                              /*buffer_size=*/1,
+                              /*seed=*/1,
+                              /*seed2=*/2,
+                              /*count=*/1,
+                              reshuffle_each_iteration,
+                              /*output_dtypes=*/{DT_INT64},
+                              /*output_shapes=*/{PartialTensorShape({})},
+                              /*node_name=*/kShuffleNodeName,
+                              /*index_shuffle=*/true);
+}
+
 ShuffleDatasetParams ShuffleDatasetParamsWithInvalidBufferSize() {
   return ShuffleDatasetParams(RangeDatasetParams(0, 0, 1),
                               /*buffer_size=*/-1,
@@ -583,6 +603,70 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, IndexShuffle) {
+  TF_ASSERT_OK(Initialize(
+      ShuffleDatasetParamsWithIndexShuffle(/*reshuffle_each_iteration=*/true)));
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_EXPECT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  std::vector<Tensor> range =
+      CreateTensors<int64_t>(TensorShape({}), {{0}, {1}, {2}, {3}, {4}, {5},
+                                               {6}, {7}, {8}, {9}});
+  // Every element is produced once, and the order is not limited by the
+  // buffer size of 1.
+  TF_EXPECT_OK(ExpectEqual(out_tensors, range, /*compare_order=*/false));
+  EXPECT_FALSE(ExpectEqual(out_tensors, range, /*compare_order=*/true).ok());
+}
+
+TEST_F(ShuffleDatasetOpTest, IndexShuffleSaveAndRestore) {
+  auto dataset_params =
+      ShuffleDatasetParamsWithIndexShuffle(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_EXPECT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    expected_outputs.insert(expected_outputs.end(), next.begin(), next.end());
+  }
+
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  std::vector<Tensor> out_tensors;
+  end_of_sequence = false;
+  for (int i = 0; i < 4; ++i) {
+    std::vector<Tensor> next;
+    TF_EXPECT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  VariantTensorDataWriter writer;
+  TF_EXPECT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  TF_EXPECT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                               dataset_params.iterator_prefix(), *dataset_,
+                               &iterator_));
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_EXPECT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/true));
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
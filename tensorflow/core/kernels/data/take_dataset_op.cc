@@ -90,6 +90,12 @@ Status TakeDataset::Get(OpKernelContext* ctx, int64 index,
   return input_->Get(ctx, index, out_tensors);
 }
 
+Status TakeDataset::Get(IteratorContext* ctx, int64 index,
+                        std::vector<Tensor>* out_tensors) const {
+  TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+  return input_->Get(ctx, index, out_tensors);
+}
+
 class TakeDataset::EmptyIterator : public DatasetIterator<TakeDataset> {
  public:
   explicit EmptyIterator(const Params& params)
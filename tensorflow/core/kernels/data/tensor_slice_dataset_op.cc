@@ -96,13 +96,12 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
 
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
-    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
-    out_tensors->clear();
-    out_tensors->reserve(tensors_.size());
-    for (int i = 0; i < tensors_.size(); ++i) {
-      out_tensors->push_back(MaybeCopySubSlice(tensors_[i], index));
-    }
-    return OkStatus();
+    return GetInternal(ctx, index, out_tensors);
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return GetInternal(ctx, index, out_tensors);
   }
 
  protected:
@@ -142,6 +141,18 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
   }
 
  private:
+  template <typename ContextT>
+  Status GetInternal(ContextT* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    out_tensors->clear();
+    out_tensors->reserve(tensors_.size());
+    for (int i = 0; i < tensors_.size(); ++i) {
+      out_tensors->push_back(MaybeCopySubSlice(tensors_[i], index));
+    }
+    return OkStatus();
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
@@ -0,0 +1,144 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/text_chunk_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// The size of the reads which scan the file for line breaks.
+constexpr int64_t kScanBlockBytes = 1 << 20;
+
+// Reads the bytes [offset, min(offset + kScanBlockBytes, end)) of `file`.
+Status ReadScanBlock(RandomAccessFile* file, int64_t offset, int64_t end,
+                     std::string* scratch, StringPiece* block) {
+  const int64_t n = std::min(kScanBlockBytes, end - offset);
+  scratch->resize(n);
+  Status s = file->Read(offset, n, block, &(*scratch)[0]);
+  if (errors::IsOutOfRange(s) && !block->empty()) {
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(s);
+  if (block->empty()) {
+    return errors::OutOfRange("Unexpected end of file at offset ", offset);
+  }
+  return OkStatus();
+}
+
+// Returns the line breaks which end a chunk, by seeking to the targeted end of
+// each chunk and searching the next line break from there.
+Status FindLineBreakBoundaries(RandomAccessFile* file, int64_t end,
+                               int64_t chunk_bytes,
+                               std::vector<int64_t>* boundaries) {
+  std::string scratch;
+  int64_t offset = boundaries->back() + chunk_bytes;
+  while (offset < end) {
+    StringPiece block;
+    TF_RETURN_IF_ERROR(ReadScanBlock(file, offset, end, &scratch, &block));
+    const char* line_break =
+        static_cast<const char*>(memchr(block.data(), '\n', block.size()));
+    if (line_break == nullptr) {
+      offset += block.size();
+      continue;
+    }
+    boundaries->push_back(offset + (line_break - block.data()) + 1);
+    offset = boundaries->back() + chunk_bytes;
+  }
+  return OkStatus();
+}
+
+// Returns the line breaks which end a chunk outside of a quoted field, by
+// tracking the parity of the double quotes from the start of the range. The
+// escaped quotes of a quoted field come in pairs and keep the parity.
+Status FindQuotedLineBreakBoundaries(RandomAccessFile* file, int64_t end,
+                                     int64_t chunk_bytes,
+                                     std::vector<int64_t>* boundaries) {
+  std::string scratch;
+  int64_t target = boundaries->back() + chunk_bytes;
+  bool in_quotes = false;
+  for (int64_t offset = boundaries->back(); offset < end;) {
+    StringPiece block;
+    TF_RETURN_IF_ERROR(ReadScanBlock(file, offset, end, &scratch, &block));
+    const char* p = block.data();
+    const char* limit = block.data() + block.size();
+    while (p < limit) {
+      // Only the quotes matter before the targeted end of the chunk.
+      const char* skip_to =
+          target - offset > p - block.data()
+              ? std::min(limit, block.data() + (target - offset))
+              : p;
+      in_quotes ^= (std::count(p, skip_to, '"') & 1) != 0;
+      p = skip_to;
+      if (p == limit) break;
+      const char* line_break =
+          static_cast<const char*>(memchr(p, '\n', limit - p));
+      const char* field_end = line_break == nullptr ? limit : line_break;
+      in_quotes ^= (std::count(p, field_end, '"') & 1) != 0;
+      p = field_end;
+      if (line_break == nullptr) break;
+      ++p;
+      if (!in_quotes) {
+        boundaries->push_back(offset + (p - block.data()));
+        target = boundaries->back() + chunk_bytes;
+      }
+    }
+    offset += block.size();
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status FindTextChunkBoundaries(RandomAccessFile* file, int64_t start,
+                               int64_t end, int64_t chunk_bytes,
+                               bool use_quote_delim,
+                               std::vector<int64_t>* boundaries) {
+  if (chunk_bytes <= 0) {
+    return errors::InvalidArgument("`chunk_bytes` must be > 0 but got ",
+                                   chunk_bytes);
+  }
+  boundaries->clear();
+  boundaries->push_back(start);
+  if (use_quote_delim) {
+    TF_RETURN_IF_ERROR(
+        FindQuotedLineBreakBoundaries(file, end, chunk_bytes, boundaries));
+  } else {
+    TF_RETURN_IF_ERROR(
+        FindLineBreakBoundaries(file, end, chunk_bytes, boundaries));
+  }
+  if (boundaries->back() < end) {
+    boundaries->push_back(end);
+  }
+  return OkStatus();
+}
+
+thread::ThreadPool* TextChunkThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "tf_data_text_chunks", port::MaxParallelism());
+  return pool;
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,174 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_TEXT_CHUNK_READER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_TEXT_CHUNK_READER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+
+// Environment variable holding the size in bytes of the chunks in which
+// `TextLineDataset` and `CsvDataset` split large uncompressed files to parse
+// them in parallel. Parallel parsing is disabled by default (0), because it
+// buffers the records of several chunks per open file.
+constexpr char kParallelTextChunkBytesEnvVar[] =
+    "TF_DATA_PARALLEL_TEXT_CHUNK_BYTES";
+
+// Splits the bytes [start, end) of `file` in chunks of about `chunk_bytes`,
+// each of which ends after a '\n' line break. `boundaries` holds `start`, the
+// end of each chunk but the last, and `end`. If `use_quote_delim`, the line
+// breaks inside double-quoted CSV fields are skipped: the file is scanned from
+// `start`, which must not be inside a quoted field, and a line break only ends
+// a chunk after an even number of double quotes.
+Status FindTextChunkBoundaries(RandomAccessFile* file, int64_t start,
+                               int64_t end, int64_t chunk_bytes,
+                               bool use_quote_delim,
+                               std::vector<int64_t>* boundaries);
+
+// Returns the thread pool which parses the chunks of all the open files.
+thread::ThreadPool* TextChunkThreadPool();
+
+// Parses the chunks of a file on `TextChunkThreadPool()`, a bounded number of
+// chunks ahead of the consumer, and returns their records in file order.
+template <typename Record>
+class TextChunkReader {
+ public:
+  // Parses the records of the bytes [start, end) of the file, and the offsets
+  // in the file at which they end. Must be thread-safe.
+  using ParseFn =
+      std::function<Status(int64_t start, int64_t end,
+                           std::vector<Record>* records,
+                           std::vector<int64_t>* record_ends)>;
+
+  // `boundaries` are the boundaries of the chunks, as returned by
+  // `FindTextChunkBoundaries`. The state used by `parse` must outlive the
+  // reader.
+  TextChunkReader(std::vector<int64_t> boundaries, ParseFn parse)
+      : boundaries_(std::move(boundaries)),
+        parse_(std::move(parse)),
+        max_chunks_in_flight_(TextChunkThreadPool()->NumThreads()),
+        offset_(boundaries_.front()) {
+    mutex_lock l(mu_);
+    ScheduleChunksLocked();
+  }
+
+  // Waits for the chunks being parsed.
+  ~TextChunkReader() {
+    mutex_lock l(mu_);
+    while (num_chunks_in_flight_ > 0) {
+      cond_var_.wait(l);
+    }
+  }
+
+  TextChunkReader(const TextChunkReader&) = delete;
+  TextChunkReader& operator=(const TextChunkReader&) = delete;
+
+  // Returns the next record of the file, or `OutOfRange` at the end of the
+  // file. A chunk which fails to be parsed returns its error after the records
+  // parsed before the failure.
+  Status GetNext(Record* record) {
+    mutex_lock l(mu_);
+    while (!chunks_.empty()) {
+      Chunk& chunk = *chunks_.front();
+      while (!chunk.done) {
+        cond_var_.wait(l);
+      }
+      if (next_record_ < chunk.records.size()) {
+        *record = std::move(chunk.records[next_record_]);
+        offset_ = chunk.record_ends[next_record_];
+        ++next_record_;
+        return OkStatus();
+      }
+      TF_RETURN_IF_ERROR(chunk.status);
+      offset_ = chunk.end;
+      chunks_.pop_front();
+      next_record_ = 0;
+      ScheduleChunksLocked();
+    }
+    return errors::OutOfRange("End of file");
+  }
+
+  // Returns the offset in the file of the next record.
+  int64_t Tell() {
+    mutex_lock l(mu_);
+    return offset_;
+  }
+
+ private:
+  struct Chunk {
+    explicit Chunk(int64_t end) : end(end) {}
+
+    const int64_t end;
+    bool done = false;
+    Status status;
+    std::vector<Record> records;
+    std::vector<int64_t> record_ends;
+  };
+
+  void ScheduleChunksLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (next_chunk_ + 1 < boundaries_.size() &&
+           chunks_.size() < max_chunks_in_flight_) {
+      const int64_t start = boundaries_[next_chunk_];
+      auto chunk = std::make_shared<Chunk>(boundaries_[next_chunk_ + 1]);
+      ++next_chunk_;
+      chunks_.push_back(chunk);
+      ++num_chunks_in_flight_;
+      TextChunkThreadPool()->Schedule([this, start, chunk]() {
+        std::vector<Record> records;
+        std::vector<int64_t> record_ends;
+        Status s = parse_(start, chunk->end, &records, &record_ends);
+        mutex_lock l(mu_);
+        chunk->status = s;
+        chunk->records = std::move(records);
+        chunk->record_ends = std::move(record_ends);
+        chunk->done = true;
+        --num_chunks_in_flight_;
+        cond_var_.notify_all();
+      });
+    }
+  }
+
+  const std::vector<int64_t> boundaries_;
+  const ParseFn parse_;
+  const size_t max_chunks_in_flight_;
+  mutex mu_;
+  condition_variable cond_var_;
+  // The chunks being parsed or consumed, in file order.
+  std::deque<std::shared_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
+  // The index of the next chunk to schedule.
+  size_t next_chunk_ TF_GUARDED_BY(mu_) = 0;
+  // The index of the next record of `chunks_.front()`.
+  size_t next_record_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_chunks_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  int64_t offset_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_TEXT_CHUNK_READER_H_
@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/text_chunk_reader.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<int64_t> FindBoundaries(const std::string& contents,
+                                    int64_t chunk_bytes,
+                                    bool use_quote_delim) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "text_chunk_reader_test");
+  TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, contents));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  std::vector<int64_t> boundaries;
+  TF_CHECK_OK(FindTextChunkBoundaries(file.get(), /*start=*/0,
+                                      contents.size(), chunk_bytes,
+                                      use_quote_delim, &boundaries));
+  return boundaries;
+}
+
+TEST(FindTextChunkBoundariesTest, ChunksEndAfterLineBreaks) {
+  EXPECT_EQ(FindBoundaries("aaaa\nbb\ncccccc\nd\n", /*chunk_bytes=*/3,
+                           /*use_quote_delim=*/false),
+            std::vector<int64_t>({0, 5, 15, 17}));
+  EXPECT_EQ(FindBoundaries("aaaa\nbb", /*chunk_bytes=*/100,
+                           /*use_quote_delim=*/false),
+            std::vector<int64_t>({0, 7}));
+}
+
+TEST(FindTextChunkBoundariesTest, SkipsLineBreaksInQuotedFields) {
+  const std::string contents = "a,\"x\ny\"\nb,\"\"\"\"\nc\n";
+  EXPECT_EQ(FindBoundaries(contents, /*chunk_bytes=*/1,
+                           /*use_quote_delim=*/false),
+            std::vector<int64_t>({0, 5, 8, 15, 17}));
+  EXPECT_EQ(FindBoundaries(contents, /*chunk_bytes=*/1,
+                           /*use_quote_delim=*/true),
+            std::vector<int64_t>({0, 8, 15, 17}));
+}
+
+// Parses two records per chunk, which hold their start offset.
+Status ParseHalves(int64_t start, int64_t end, std::vector<int64_t>* records,
+                   std::vector<int64_t>* record_ends) {
+  const int64_t middle = (start + end) / 2;
+  records->push_back(start);
+  record_ends->push_back(middle);
+  records->push_back(middle);
+  record_ends->push_back(end);
+  return OkStatus();
+}
+
+TEST(TextChunkReaderTest, ReturnsRecordsInOrder) {
+  std::vector<int64_t> boundaries;
+  for (int64_t offset = 0; offset <= 1000; offset += 10) {
+    boundaries.push_back(offset);
+  }
+  TextChunkReader<int64_t> reader(boundaries, ParseHalves);
+  for (int64_t expected = 0; expected < 1000; expected += 5) {
+    EXPECT_EQ(reader.Tell(), expected);
+    int64_t record;
+    TF_ASSERT_OK(reader.GetNext(&record));
+    EXPECT_EQ(record, expected);
+  }
+  EXPECT_EQ(reader.Tell(), 1000);
+  int64_t record;
+  EXPECT_TRUE(errors::IsOutOfRange(reader.GetNext(&record)));
+}
+
+TEST(TextChunkReaderTest, ReturnsChunkErrorAfterItsRecords) {
+  TextChunkReader<int64_t> reader(
+      {0, 10, 20}, [](int64_t start, int64_t end, std::vector<int64_t>* records,
+                      std::vector<int64_t>* record_ends) {
+        records->push_back(start);
+        record_ends->push_back(start + 1);
+        return start == 0 ? OkStatus() : errors::DataLoss("Corrupted chunk");
+      });
+  int64_t record;
+  TF_ASSERT_OK(reader.GetNext(&record));
+  EXPECT_EQ(record, 0);
+  TF_ASSERT_OK(reader.GetNext(&record));
+  EXPECT_EQ(record, 10);
+  EXPECT_TRUE(errors::IsDataLoss(reader.GetNext(&record)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,16 +14,22 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/text_line_dataset_op.h"
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/text_chunk_reader.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -38,16 +44,63 @@ constexpr char kGZIP[] = "GZIP";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
 
+namespace {
+
+// Parses the lines of the bytes [start, end) of `file` like
+// `BufferedInputStream::ReadLine`: the '\n' and '\r' characters are dropped,
+// and a last line without line break is only returned if it is not empty.
+Status ParseLines(RandomAccessFile* file, int64_t start, int64_t end,
+                  std::vector<tstring>* lines,
+                  std::vector<int64_t>* line_ends) {
+  std::string scratch(end - start, '\0');
+  StringPiece data;
+  Status s = file->Read(start, end - start, &data, &scratch[0]);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    return s;
+  }
+  if (data.size() != end - start) {
+    return errors::DataLoss("Read ", data.size(), " bytes instead of ",
+                            end - start, " at offset ", start);
+  }
+  const char* p = data.data();
+  const char* limit = data.data() + data.size();
+  while (p < limit) {
+    const char* line_break =
+        static_cast<const char*>(memchr(p, '\n', limit - p));
+    const char* line_end = line_break == nullptr ? limit : line_break;
+    tstring line;
+    if (memchr(p, '\r', line_end - p) == nullptr) {
+      line.assign(p, line_end - p);
+    } else {
+      std::string stripped(p, line_end);
+      stripped.erase(std::remove(stripped.begin(), stripped.end(), '\r'),
+                     stripped.end());
+      line = stripped;
+    }
+    p = line_break == nullptr ? limit : line_break + 1;
+    if (line_break == nullptr && line.empty()) {
+      break;
+    }
+    lines->push_back(std::move(line));
+    line_ends->push_back(start + (p - data.data()));
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
 class TextLineDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, std::vector<string> filenames,
           const string& compression_type,
-          const io::ZlibCompressionOptions& options)
+          const io::ZlibCompressionOptions& options,
+          int64_t parallel_chunk_bytes)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         use_compression_(!compression_type.empty()),
-        options_(options) {}
+        options_(options),
+        parallel_chunk_bytes_(parallel_chunk_bytes) {}
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
@@ -109,7 +162,10 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
         if (buffered_input_stream_) {
           Tensor line_contents(tstring{});
           tstring& line_contents_str = line_contents.scalar<tstring>()();
-          Status s = buffered_input_stream_->ReadLine(&line_contents_str);
+          Status s =
+              parallel_reader_
+                  ? parallel_reader_->GetNext(&line_contents_str)
+                  : buffered_input_stream_->ReadLine(&line_contents_str);
 
           if (s.ok()) {
             // Produce the line as output.
@@ -137,6 +193,8 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
         }
 
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
+        TF_RETURN_IF_ERROR(
+            MaybeStartParallelReadLocked(ctx->env(), /*offset=*/0));
       } while (true);
     }
 
@@ -155,8 +213,10 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       // 1. GetNext has not been called even once.
       // 2. All files have been read and iterator has been exhausted.
       if (buffered_input_stream_) {
-        TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentPos,
-                                               buffered_input_stream_->Tell()));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), kCurrentPos,
+            parallel_reader_ ? parallel_reader_->Tell()
+                             : buffered_input_stream_->Tell()));
       }
       return OkStatus();
     }
@@ -177,7 +237,11 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
             reader->ReadScalar(prefix(), kCurrentPos, &current_pos));
 
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(buffered_input_stream_->Seek(current_pos));
+        TF_RETURN_IF_ERROR(
+            MaybeStartParallelReadLocked(ctx->env(), current_pos));
+        if (!parallel_reader_) {
+          TF_RETURN_IF_ERROR(buffered_input_stream_->Seek(current_pos));
+        }
       }
       return OkStatus();
     }
@@ -212,8 +276,41 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
       return OkStatus();
     }
 
+    // Parses the rest of the file at `current_file_index_` from `offset` in
+    // parallel chunks, if parallel parsing is enabled and the file is
+    // uncompressed and spans several chunks. The lines are then read from
+    // `parallel_reader_` instead of `buffered_input_stream_`.
+    Status MaybeStartParallelReadLocked(Env* env, int64_t offset)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t chunk_bytes = dataset()->parallel_chunk_bytes_;
+      if (chunk_bytes <= 0 || dataset()->use_compression_) {
+        return OkStatus();
+      }
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env->GetFileSize(
+          TranslateFileName(dataset()->filenames_[current_file_index_]),
+          &file_size));
+      if (static_cast<int64_t>(file_size) - offset < 2 * chunk_bytes) {
+        return OkStatus();
+      }
+      std::vector<int64_t> boundaries;
+      TF_RETURN_IF_ERROR(FindTextChunkBoundaries(file_.get(), offset,
+                                                 file_size, chunk_bytes,
+                                                 /*use_quote_delim=*/false,
+                                                 &boundaries));
+      RandomAccessFile* file = file_.get();
+      parallel_reader_ = std::make_unique<TextChunkReader<tstring>>(
+          std::move(boundaries),
+          [file](int64_t start, int64_t end, std::vector<tstring>* lines,
+                 std::vector<int64_t>* line_ends) {
+            return ParseLines(file, start, end, lines, line_ends);
+          });
+      return OkStatus();
+    }
+
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      parallel_reader_.reset();
       input_stream_.reset();
       zlib_input_stream_.reset();
       buffered_input_stream_.reset();
@@ -229,16 +326,24 @@ class TextLineDatasetOp::Dataset : public DatasetBase {
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<RandomAccessFile> file_
         TF_GUARDED_BY(mu_);  // must outlive input_stream_
+    // Parses the lines of `file_` in parallel, if set.
+    std::unique_ptr<TextChunkReader<tstring>> parallel_reader_
+        TF_GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
   const bool use_compression_;
   const io::ZlibCompressionOptions options_;
+  const int64_t parallel_chunk_bytes_;
 };
 
 TextLineDatasetOp::TextLineDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar(kParallelTextChunkBytesEnvVar,
+                                          /*default_val=*/0,
+                                          &parallel_chunk_bytes_));
+}
 
 void TextLineDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -283,7 +388,7 @@ void TextLineDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        zlib_compression_options);
+                        zlib_compression_options, parallel_chunk_bytes_);
 }
 
 namespace {
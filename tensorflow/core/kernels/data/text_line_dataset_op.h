@@ -34,6 +34,10 @@ class TextLineDatasetOp : public DatasetOpKernel {
 
  private:
   class Dataset;
+
+  // The size of the chunks in which large uncompressed files are parsed in
+  // parallel, or 0 to parse them sequentially.
+  int64_t parallel_chunk_bytes_;
 };
 
 }  // namespace data
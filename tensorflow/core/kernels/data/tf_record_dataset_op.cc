@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -45,6 +46,10 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// The number of `buffer_size` blocks to read asynchronously ahead of the
+// records being parsed. Reading ahead is disabled by default, because it keeps
+// that many buffers alive per open file.
+constexpr char kReadAheadBlocksEnvVar[] = "TF_DATA_TFRECORD_READ_AHEAD_BLOCKS";
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -58,7 +63,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
-                   std::vector<int64_t> byte_offsets, int op_version)
+                   std::vector<int64_t> byte_offsets,
+                   int64_t num_read_ahead_blocks, int op_version)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
@@ -68,6 +74,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         op_version_(op_version) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      options_.num_read_ahead_blocks = num_read_ahead_blocks;
     }
   }
 
@@ -296,7 +303,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kTFRecordDataset ? 1 : 2) {
+  OP_REQUIRES_OK(ctx, ReadInt64FromEnvVar(kReadAheadBlocksEnvVar,
+                                          /*default_val=*/0,
+                                          &num_read_ahead_blocks_));
+}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -361,7 +372,8 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
   }
 
   *output = new Dataset(ctx, std::move(filenames), compression_type,
-                        buffer_size, std::move(byte_offsets), op_version_);
+                        buffer_size, std::move(byte_offsets),
+                        num_read_ahead_blocks_, op_version_);
 }
 
 namespace {
@@ -36,6 +36,7 @@ class TFRecordDatasetOp : public DatasetOpKernel {
  private:
   class Dataset;
   int op_version_;
+  int64_t num_read_ahead_blocks_ = 0;
 };
 
 }  // namespace data
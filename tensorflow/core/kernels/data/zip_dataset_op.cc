@@ -116,15 +116,12 @@ class ZipDatasetOp::Dataset : public DatasetBase {
 
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
-    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
-    out_tensors->reserve(output_dtypes().size());
-    for (int i = 0; i < inputs_.size(); ++i) {
-      std::vector<Tensor> input_tensors;
-      TF_RETURN_IF_ERROR(inputs_[i]->Get(ctx, index, &input_tensors));
-      out_tensors->insert(out_tensors->end(), input_tensors.begin(),
-                          input_tensors.end());
-    }
-    return OkStatus();
+    return GetInternal(ctx, index, out_tensors);
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    return GetInternal(ctx, index, out_tensors);
   }
 
  protected:
@@ -144,6 +141,20 @@ class ZipDatasetOp::Dataset : public DatasetBase {
   }
 
  private:
+  template <typename ContextT>
+  Status GetInternal(ContextT* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    out_tensors->reserve(output_dtypes().size());
+    for (int i = 0; i < inputs_.size(); ++i) {
+      std::vector<Tensor> input_tensors;
+      TF_RETURN_IF_ERROR(inputs_[i]->Get(ctx, index, &input_tensors));
+      out_tensors->insert(out_tensors->end(), input_tensors.begin(),
+                          input_tensors.end());
+    }
+    return OkStatus();
+  }
+
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
@@ -149,11 +149,8 @@ class DequantizeOp : public OpKernel {
       }
     }
     if (need_cast_) {
-      S* out_ptr = output->flat<S>().data();
-      float* in_ptr = float_output.flat<float>().data();
-      for (int64_t i = 0; i < float_output.NumElements(); ++i) {
-        out_ptr[i] = static_cast<S>(in_ptr[i]);
-      }
+      output->flat<S>().device(ctx->eigen_device<Device>()) =
+          float_output.flat<float>().template cast<S>();
     }
   }
 
@@ -174,7 +171,7 @@ class DequantizeOp : public OpKernel {
            std::numeric_limits<T>::min());
 
       const auto& input_tensor = input.flat<T>();
-      output->flat<float>() =
+      output->flat<float>().device(ctx->template eigen_device<Device>()) =
           ((input_tensor.template cast<float>() + half_range) * scale_factor) +
           min_range;
 
@@ -197,7 +194,7 @@ class DequantizeOp : public OpKernel {
               : std::max(min_range / min_output_value,
                          max_range / std::numeric_limits<T>::max());
       const auto& input_tensor = input.flat<T>();
-      output->flat<float>() =
+      output->flat<float>().device(ctx->template eigen_device<Device>()) =
           input_tensor.template cast<int>().template cast<float>() *
           scale_factor;
     }
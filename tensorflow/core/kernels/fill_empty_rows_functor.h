@@ -16,6 +16,9 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_FILL_EMPTY_ROWS_OP_H_
 #define TENSORFLOW_CORE_KERNELS_FILL_EMPTY_ROWS_OP_H_
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -111,96 +114,141 @@ struct FillEmptyRows<CPUDevice, T, Tindex, RaggedOperands> {
 
     bool rows_are_ordered = true;
     Tindex last_indices_row = 0;
-    std::vector<Tindex> csr_offset(dense_rows, 0);
+    Tindex num_nonempty_rows = 0;
     for (int i = 0; i < N; ++i) {
       const Tindex row = vec_or_matrix(indices, i, 0);
       if (row < 0 || row >= dense_rows) {
         return errors::InvalidArgument("indices(", i, ", 0) is invalid: ", row,
                                        " >= ", dense_rows);
       }
-      ++csr_offset[row];
+      num_nonempty_rows += (i == 0 || row != last_indices_row);
       rows_are_ordered = rows_are_ordered & (row >= last_indices_row);
       last_indices_row = row;
     }
-    bool all_rows_full = true;
-    for (int row = 0; row < dense_rows; ++row) {
-      // csr_offset here describes the number of elements in this dense row
-      bool row_empty = (csr_offset[row] == 0);
-      if (empty_row_indicator) {
-        empty_row_indicator[row] = row_empty;
-      }
-      all_rows_full = all_rows_full & !row_empty;
-      // In filled version, each row has at least one element.
-      csr_offset[row] = std::max(csr_offset[row], Tindex{1});
-      // Update csr_offset to represent the number of elements up to and
-      // including dense_row + 1:
-      //  csr_offset(0) == #{elements of row 0}
-      //  csr_offset(1) == #{elements of row 1} + #{elements of row 0}
-      //  ..
-      //  csr_offset(i) == starting index for elements in row i + 1.
-      if (row > 0) {
-        csr_offset[row] += csr_offset[row - 1];
-      }
-    }
 
-    if (all_rows_full && rows_are_ordered) {
+    if (rows_are_ordered && num_nonempty_rows == dense_rows) {
       context->set_output(kOutputIndicesOutput, indices_t);
       context->set_output(kOutputValuesOutput, values_t);
+      if (empty_row_indicator) {
+        std::fill_n(empty_row_indicator, dense_rows, false);
+      }
       if (reverse_index_map) {
         for (Tindex i = 0; i < N; ++i) {
           reverse_index_map[i] = i;
         }
       }
+      return OkStatus();
+    }
+
+    std::vector<Tindex> csr_offset;
+    Tindex N_full;
+    if (rows_are_ordered) {
+      N_full = N + dense_rows - num_nonempty_rows;
     } else {
-      Tensor* output_indices_t;
-      const Tindex N_full = csr_offset[dense_rows - 1];
-      TensorShape output_indices_shape;
-      if constexpr (RaggedOperands) {
-        TF_RETURN_IF_ERROR(
-            TensorShape::BuildTensorShape({N_full}, &output_indices_shape));
-      } else {
-        TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(
-            {N_full, rank}, &output_indices_shape));
+      csr_offset.resize(dense_rows, 0);
+      for (int i = 0; i < N; ++i) {
+        ++csr_offset[vec_or_matrix(indices, i, 0)];
       }
-      TF_RETURN_IF_ERROR(context->allocate_output(
-          kOutputIndicesOutput, output_indices_shape, &output_indices_t));
-      auto output_indices = output_indices_t->tensor<Tindex, IndicesRank>();
-
-      Tensor* output_values_t;
-      TF_RETURN_IF_ERROR(context->allocate_output(
-          kOutputValuesOutput, TensorShape({N_full}), &output_values_t));
-      auto output_values = output_values_t->vec<T>();
+      for (int row = 0; row < dense_rows; ++row) {
+        // csr_offset here describes the number of elements in this dense row
+        bool row_empty = (csr_offset[row] == 0);
+        if (empty_row_indicator) {
+          empty_row_indicator[row] = row_empty;
+        }
+        // In filled version, each row has at least one element.
+        csr_offset[row] = std::max(csr_offset[row], Tindex{1});
+        // Update csr_offset to represent the number of elements up to and
+        // including dense_row + 1:
+        //  csr_offset(0) == #{elements of row 0}
+        //  csr_offset(1) == #{elements of row 1} + #{elements of row 0}
+        //  ..
+        //  csr_offset(i) == starting index for elements in row i + 1.
+        if (row > 0) {
+          csr_offset[row] += csr_offset[row - 1];
+        }
+      }
+      N_full = csr_offset[dense_rows - 1];
+    }
 
-      std::vector<Tindex> filled_count(dense_rows, 0);
+    Tensor* output_indices_t;
+    TensorShape output_indices_shape;
+    if constexpr (RaggedOperands) {
+      TF_RETURN_IF_ERROR(
+          TensorShape::BuildTensorShape({N_full}, &output_indices_shape));
+    } else {
+      TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape({N_full, rank},
+                                                       &output_indices_shape));
+    }
+    TF_RETURN_IF_ERROR(context->allocate_output(
+        kOutputIndicesOutput, output_indices_shape, &output_indices_t));
+    auto output_indices = output_indices_t->tensor<Tindex, IndicesRank>();
+
+    Tensor* output_values_t;
+    TF_RETURN_IF_ERROR(context->allocate_output(
+        kOutputValuesOutput, TensorShape({N_full}), &output_values_t));
+    auto output_values = output_values_t->vec<T>();
+
+    auto fill_empty_row = [&](Tindex row, Tindex output_i) {
+      vec_or_matrix(output_indices, output_i, 0) = row;
+      for (Tindex col = 1; col < rank; ++col) {
+        vec_or_matrix(output_indices, output_i, col) = 0;
+      }
+      output_values(output_i) = default_value;
+    };
 
-      // Fill in values for rows that are not missing
+    if (rows_are_ordered) {
+      // The output is the input with an entry inserted for each empty row,
+      // which is written in a single pass.
+      Tindex output_i = 0;
+      // The first row not written to the output yet.
+      Tindex next_row = 0;
+      auto fill_empty_rows = [&](Tindex end_row) {
+        for (; next_row < end_row; ++next_row) {
+          fill_empty_row(next_row, output_i++);
+          if (empty_row_indicator) empty_row_indicator[next_row] = true;
+        }
+      };
       for (Tindex i = 0; i < N; ++i) {
         const Tindex row = vec_or_matrix(indices, i, 0);
-        Tindex& offset = filled_count[row];
-        const Tindex output_i = ((row == 0) ? 0 : csr_offset[row - 1]) + offset;
-        offset++;  // Increment the filled count for this row.
+        if (row >= next_row) {
+          fill_empty_rows(row);
+          if (empty_row_indicator) empty_row_indicator[row] = false;
+          next_row = row + 1;
+        }
         std::copy_n(&vec_or_matrix(indices, i, 0), rank,
                     &vec_or_matrix(output_indices, output_i, 0));
         output_values(output_i) = values(i);
-        // We'll need this reverse index map to backprop correctly.
         if (reverse_index_map) {
           reverse_index_map[i] = output_i;
         }
+        ++output_i;
       }
+      fill_empty_rows(dense_rows);
+      return OkStatus();
+    }
 
-      // Fill in values for rows that are missing
-      for (Tindex row = 0; row < dense_rows; ++row) {
-        const Tindex row_count = filled_count[row];
-        if (row_count == 0) {  // We haven't filled this row
-          const Tindex starting_index = (row == 0) ? 0 : csr_offset[row - 1];
-          // Remaining index values were set to zero already.
-          // Just need to set the row index in the right location.
-          vec_or_matrix(output_indices, starting_index, 0) = row;
-          for (Tindex col = 1; col < rank; ++col) {
-            vec_or_matrix(output_indices, starting_index, col) = 0;
-          }
-          output_values(starting_index) = default_value;
-        }
+    std::vector<Tindex> filled_count(dense_rows, 0);
+
+    // Fill in values for rows that are not missing
+    for (Tindex i = 0; i < N; ++i) {
+      const Tindex row = vec_or_matrix(indices, i, 0);
+      Tindex& offset = filled_count[row];
+      const Tindex output_i = ((row == 0) ? 0 : csr_offset[row - 1]) + offset;
+      offset++;  // Increment the filled count for this row.
+      std::copy_n(&vec_or_matrix(indices, i, 0), rank,
+                  &vec_or_matrix(output_indices, output_i, 0));
+      output_values(output_i) = values(i);
+      // We'll need this reverse index map to backprop correctly.
+      if (reverse_index_map) {
+        reverse_index_map[i] = output_i;
+      }
+    }
+
+    // Fill in values for rows that are missing
+    for (Tindex row = 0; row < dense_rows; ++row) {
+      const Tindex row_count = filled_count[row];
+      if (row_count == 0) {  // We haven't filled this row
+        fill_empty_row(row, (row == 0) ? 0 : csr_offset[row - 1]);
       }
     }
 
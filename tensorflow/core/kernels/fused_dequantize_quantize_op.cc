@@ -0,0 +1,248 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements _FusedDequantizeQuantize, which the remapper creates from a
+// Dequantize, optionally followed by an elementwise activation, feeding a
+// QuantizeV2. The float values of the chain are only computed for the 256
+// possible inputs, and the input is then mapped to the output through that
+// table, instead of converting every element to float and back.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Activation { kIdentity, kRelu, kRelu6, kLeakyRelu, kSigmoid, kTanh };
+
+}  // namespace
+
+template <typename Tinput, typename T>
+class FusedDequantizeQuantizeOp : public OpKernel {
+ public:
+  explicit FusedDequantizeQuantizeOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    string input_mode;
+    OP_REQUIRES_OK(context, context->GetAttr("input_mode", &input_mode));
+    input_scaled_ = input_mode == "SCALED";
+    OP_REQUIRES_OK(context, context->GetAttr("input_narrow_range",
+                                             &input_narrow_range_));
+    string mode;
+    OP_REQUIRES_OK(context, context->GetAttr("mode", &mode));
+    scaled_ = mode == "SCALED";
+    string round_mode;
+    OP_REQUIRES_OK(context, context->GetAttr("round_mode", &round_mode));
+    half_to_even_ = round_mode == "HALF_TO_EVEN";
+    OP_REQUIRES(context, scaled_ || !half_to_even_,
+                errors::InvalidArgument("Round mode 'HALF_TO_EVEN' only "
+                                        "supported for mode 'SCALED', but "
+                                        "mode is '",
+                                        mode, "'."));
+    OP_REQUIRES_OK(context, context->GetAttr("narrow_range", &narrow_range_));
+    OP_REQUIRES_OK(context, context->GetAttr("ensure_minimum_range",
+                                             &ensure_minimum_range_));
+    string activation;
+    OP_REQUIRES_OK(context, context->GetAttr("activation", &activation));
+    if (activation == "Relu") {
+      activation_ = Activation::kRelu;
+    } else if (activation == "Relu6") {
+      activation_ = Activation::kRelu6;
+    } else if (activation == "LeakyRelu") {
+      activation_ = Activation::kLeakyRelu;
+    } else if (activation == "Sigmoid") {
+      activation_ = Activation::kSigmoid;
+    } else if (activation == "Tanh") {
+      activation_ = Activation::kTanh;
+    } else {
+      activation_ = Activation::kIdentity;
+    }
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("leakyrelu_alpha", &leakyrelu_alpha_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    for (int i = 1; i < 5; ++i) {
+      OP_REQUIRES(context, context->input(i).NumElements() == 1,
+                  errors::InvalidArgument(
+                      "Expected a single float element in input ", i,
+                      ", got ", context->input(i).NumElements(), " elements"));
+    }
+    const float input_min = context->input(1).flat<float>()(0);
+    const float input_max = context->input(2).flat<float>()(0);
+    const float requested_min = context->input(3).flat<float>()(0);
+    const float requested_max = context->input(4).flat<float>()(0);
+    OP_REQUIRES(context, !(requested_max < requested_min),
+                errors::InvalidArgument(
+                    "input_max_range must be larger than input_min_range."));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, input.shape(), &output));
+    Tensor* output_min = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(1, {}, &output_min));
+    Tensor* output_max = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(2, {}, &output_max));
+
+    // The range of the output, computed like in QuantizeV2.
+    float min_range = std::min(0.0f, requested_min);
+    const float epsilon =
+        std::max(1.0f, std::max(fabsf(requested_min), fabsf(requested_max))) *
+        ensure_minimum_range_;
+    float max_range =
+        std::max(0.0f, std::max(requested_max, min_range + epsilon));
+    float scale_factor;
+    if (scaled_) {
+      const int min_output_value = kOutputLowest + (narrow_range_ ? 1 : 0);
+      const float scale_factor_from_min_side =
+          (min_output_value * min_range > 0)
+              ? min_output_value / min_range
+              : std::numeric_limits<float>::max();
+      const float scale_factor_from_max_side =
+          (kOutputHighest * max_range > 0) ? kOutputHighest / max_range
+                                           : std::numeric_limits<float>::max();
+      scale_factor =
+          std::min(scale_factor_from_min_side, scale_factor_from_max_side);
+      min_range = min_output_value / scale_factor;
+      max_range = kOutputHighest / scale_factor;
+    } else {
+      scale_factor = (static_cast<double>(kOutputHighest) -
+                      static_cast<double>(kOutputLowest)) /
+                     (max_range - min_range);
+    }
+    output_min->scalar<float>()() = min_range;
+    output_max->scalar<float>()() = max_range;
+
+    std::array<T, 256> table;
+    for (int q = kInputLowest; q <= kInputHighest; ++q) {
+      const float x = Activate(Dequantize(q, input_min, input_max));
+      table[q - kInputLowest] =
+          Quantize(x, min_range, max_range, scale_factor);
+    }
+
+    const Tinput* in = input.flat<Tinput>().data();
+    T* out = output->flat<T>().data();
+    auto lookup = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        out[i] = table[static_cast<int>(in[i]) - kInputLowest];
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          input.NumElements(), 2, lookup);
+  }
+
+ private:
+  static constexpr int kInputLowest = std::numeric_limits<Tinput>::min();
+  static constexpr int kInputHighest = std::numeric_limits<Tinput>::max();
+  static constexpr int kOutputLowest = std::numeric_limits<T>::min();
+  static constexpr int kOutputHighest = std::numeric_limits<T>::max();
+
+  // Like DequantizeOp::DequantizeTensor.
+  float Dequantize(int q, float min_range, float max_range) const {
+    if (input_scaled_) {
+      const int min_output_value = kInputLowest + (input_narrow_range_ ? 1 : 0);
+      const float scale_factor =
+          kInputLowest == 0
+              ? (max_range / kInputHighest)
+              : std::max(min_range / min_output_value,
+                         max_range / kInputHighest);
+      return static_cast<float>(q) * scale_factor;
+    }
+    const float half_range =
+        kInputLowest == 0
+            ? 0.0f
+            : (static_cast<float>(kInputHighest) - kInputLowest + 1) / 2.0f;
+    const float scale_factor =
+        (max_range - min_range) /
+        (static_cast<float>(kInputHighest) - kInputLowest);
+    return ((static_cast<float>(q) + half_range) * scale_factor) + min_range;
+  }
+
+  float Activate(float x) const {
+    switch (activation_) {
+      case Activation::kRelu:
+        return std::max(x, 0.0f);
+      case Activation::kRelu6:
+        return std::min(std::max(x, 0.0f), 6.0f);
+      case Activation::kLeakyRelu:
+        return x > 0.0f ? x : x * leakyrelu_alpha_;
+      case Activation::kSigmoid:
+        return 1.0f / (1.0f + std::exp(-x));
+      case Activation::kTanh:
+        return std::tanh(x);
+      case Activation::kIdentity:
+        return x;
+    }
+    return x;
+  }
+
+  // Like QuantizeV2Op::QuantizeSlice.
+  T Quantize(float x, float min_range, float max_range,
+             float scale_factor) const {
+    const float clamped = std::max(std::min(x, max_range), min_range);
+    if (scaled_) {
+      const float scaled = clamped * scale_factor;
+      return static_cast<T>(half_to_even_ ? std::nearbyint(scaled)
+                                          : std::round(scaled));
+    }
+    if (kOutputLowest < 0) {
+      const float half_range =
+          (static_cast<double>(kOutputHighest) - kOutputLowest + 1) / 2.0f;
+      return static_cast<T>(
+          std::round((clamped - min_range) * scale_factor - half_range));
+    }
+    return static_cast<T>((clamped - min_range) * scale_factor + 0.5f);
+  }
+
+  bool input_scaled_;
+  bool input_narrow_range_;
+  bool scaled_;
+  bool half_to_even_;
+  bool narrow_range_;
+  float ensure_minimum_range_;
+  Activation activation_;
+  float leakyrelu_alpha_;
+};
+
+#define REGISTER_CPU_KERNEL(input_type, output_type)                \
+  REGISTER_KERNEL_BUILDER(Name("_FusedDequantizeQuantize")          \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<input_type>("Tinput") \
+                              .TypeConstraint<output_type>("T"),    \
+                          FusedDequantizeQuantizeOp<input_type, output_type>);
+
+REGISTER_CPU_KERNEL(qint8, qint8);
+REGISTER_CPU_KERNEL(qint8, quint8);
+REGISTER_CPU_KERNEL(quint8, qint8);
+REGISTER_CPU_KERNEL(quint8, quint8);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedDequantizeQuantizeOpTest : public OpsTestBase {
+ protected:
+  void Init(DataType input_type, DataType output_type, const string& mode,
+            const string& activation) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "_FusedDequantizeQuantize")
+                     .Input(FakeInput(input_type))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("input_mode", mode)
+                     .Attr("mode", mode)
+                     .Attr("activation", activation)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddRanges(float input_min, float input_max, float min_range,
+                 float max_range) {
+    AddInputFromArray<float>(TensorShape({}), {input_min});
+    AddInputFromArray<float>(TensorShape({}), {input_max});
+    AddInputFromArray<float>(TensorShape({}), {min_range});
+    AddInputFromArray<float>(TensorShape({}), {max_range});
+  }
+
+  void ExpectRanges(float min_range, float max_range) {
+    test::ExpectTensorEqual<float>(test::AsScalar<float>(min_range),
+                                   *GetOutput(1));
+    test::ExpectTensorEqual<float>(test::AsScalar<float>(max_range),
+                                   *GetOutput(2));
+  }
+};
+
+TEST_F(FusedDequantizeQuantizeOpTest, MinCombinedRelu) {
+  Init(DT_QINT8, DT_QUINT8, "MIN_COMBINED", "Relu");
+  // Both ranges map each quantized value to the float of the same value.
+  AddInputFromArray<qint8>(TensorShape({5}), {-128, -3, 0, 5, 127});
+  AddRanges(-128.0f, 127.0f, 0.0f, 255.0f);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<quint8>(
+      test::AsTensor<quint8>({0, 0, 0, 5, 127}, TensorShape({5})),
+      *GetOutput(0));
+  ExpectRanges(0.0f, 255.0f);
+}
+
+TEST_F(FusedDequantizeQuantizeOpTest, MinCombinedRelu6) {
+  Init(DT_QUINT8, DT_QUINT8, "MIN_COMBINED", "Relu6");
+  // The input steps are 0.1, and the output steps 0.05.
+  AddInputFromArray<quint8>(TensorShape({5}), {0, 10, 30, 60, 255});
+  AddRanges(0.0f, 25.5f, 0.0f, 12.75f);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<quint8>(
+      test::AsTensor<quint8>({0, 20, 60, 120, 120}, TensorShape({5})),
+      *GetOutput(0));
+  ExpectRanges(0.0f, 12.75f);
+}
+
+TEST_F(FusedDequantizeQuantizeOpTest, ScaledIdentity) {
+  Init(DT_QINT8, DT_QINT8, "SCALED", "Identity");
+  // The input steps are 1, and the output steps 0.5, down to -64.
+  AddInputFromArray<qint8>(TensorShape({5}), {-100, -3, 0, 5, 100});
+  AddRanges(-127.0f, 127.0f, -63.5f, 63.5f);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<qint8>(
+      test::AsTensor<qint8>({-128, -6, 0, 10, 127}, TensorShape({5})),
+      *GetOutput(0));
+  ExpectRanges(-64.0f, 63.5f);
+}
+
+TEST_F(FusedDequantizeQuantizeOpTest, InvalidRange) {
+  Init(DT_QUINT8, DT_QUINT8, "MIN_COMBINED", "Identity");
+  AddInputFromArray<quint8>(TensorShape({1}), {0});
+  AddRanges(0.0f, 1.0f, 1.0f, 0.0f);
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "must be larger")) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,221 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements _FusedGatherSparseSegmentReduce, which the remapper creates from
+// a Gather of the embedding table feeding a SparseSegmentSum, SparseSegmentMean
+// or SparseSegmentSqrtN. The gathered rows are accumulated directly into the
+// output, instead of being copied to an intermediate tensor first.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// The number of ids ahead of the current one whose rows are prefetched, which
+// hides the latency of the random accesses to a large embedding table.
+constexpr int64_t kPrefetchDistance = 4;
+
+}  // namespace
+
+template <typename T, typename Tindices, typename Tidx, typename Tsegmentids>
+class FusedGatherSparseSegmentReduceOp : public OpKernel {
+ public:
+  explicit FusedGatherSparseSegmentReduceOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_weights", &num_weights_));
+    OP_REQUIRES(context, num_weights_ <= 1,
+                errors::InvalidArgument(
+                    "Expected at most one weights input, got ", num_weights_));
+    string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    is_mean_ = combiner == "mean";
+    is_sqrtn_ = combiner == "sqrtn";
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& params = context->input(0);
+    const Tensor& gather_indices = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(params.shape()),
+                errors::InvalidArgument("params must be at least 1-D, got ",
+                                        params.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(gather_indices.shape()),
+                errors::InvalidArgument("gather_indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+                errors::InvalidArgument("segment_ids should be a vector."));
+
+    const int64_t num_indices = indices.NumElements();
+    OP_REQUIRES(context, num_indices == segment_ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids and indices should have same size."));
+    const T* weights = nullptr;
+    if (num_weights_ > 0) {
+      const Tensor& weights_t = context->input(4);
+      OP_REQUIRES(context,
+                  TensorShapeUtils::IsVector(weights_t.shape()) &&
+                      weights_t.NumElements() == num_indices,
+                  errors::InvalidArgument(
+                      "weights should be a vector of the size of indices, got ",
+                      weights_t.shape().DebugString()));
+      weights = weights_t.flat<T>().data();
+    }
+
+    const auto params_flat = params.flat_outer_dims<T>();
+    const int64_t num_params = params_flat.dimension(0);
+    const int64_t num_col = params_flat.dimension(1);
+    const auto gather_vec = gather_indices.vec<Tindices>();
+    const int64_t num_gather_indices = gather_vec.size();
+    const auto indices_vec = indices.vec<Tidx>();
+    const auto segment_vec = segment_ids.vec<Tsegmentids>();
+
+    // Validate all the ids up front, so that the sharded accumulation below
+    // cannot fail, and remember where each segment starts.
+    std::vector<int64_t> segment_starts;
+    Tsegmentids last_segment_id = -1;
+    for (int64_t i = 0; i < num_indices; ++i) {
+      const Tidx index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_gather_indices),
+                  errors::InvalidArgument("indices[", i, "] = ", index,
+                                          " is not in [0, ", num_gather_indices,
+                                          ")"));
+      const Tindices row = internal::SubtleMustCopy(gather_vec(index));
+      OP_REQUIRES(context, FastBoundsCheck(row, num_params),
+                  errors::InvalidArgument("gather_indices[", index, "] = ", row,
+                                          " is not in [0, ", num_params, ")"));
+      const Tsegmentids segment_id = internal::SubtleMustCopy(segment_vec(i));
+      OP_REQUIRES(context, segment_id >= last_segment_id && segment_id >= 0,
+                  errors::InvalidArgument("segment ids are not increasing"));
+      if (segment_id != last_segment_id) segment_starts.push_back(i);
+      last_segment_id = segment_id;
+    }
+    const int64_t num_segments = segment_starts.size();
+    segment_starts.push_back(num_indices);
+
+    TensorShape output_shape = params.shape();
+    OP_REQUIRES_OK(context,
+                   output_shape.SetDimWithStatus(0, last_segment_id + 1));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    // Segments without any id are zero, like in SparseSegmentReduction.
+    auto output_flat = output->flat_outer_dims<T>();
+    output_flat.device(context->eigen_device<CPUDevice>()) =
+        output_flat.constant(T(0));
+    if (num_col == 0) return;
+
+    typedef Eigen::Array<T, Eigen::Dynamic, 1> Row;
+    const T* params_data = params_flat.data();
+    T* output_data = output_flat.data();
+    auto row_of = [&](int64_t i) {
+      const int64_t row = gather_vec(static_cast<int64_t>(indices_vec(i)));
+      return params_data + num_col * row;
+    };
+    auto reduce = [&](int64_t begin, int64_t end) {
+      for (int64_t s = begin; s < end; ++s) {
+        const int64_t start = segment_starts[s];
+        const int64_t limit = segment_starts[s + 1];
+        const int64_t segment_id = segment_vec(start);
+        Eigen::Map<Row> out(output_data + num_col * segment_id, num_col);
+        T total = T(0);
+        for (int64_t i = start; i < limit; ++i) {
+          if (i + kPrefetchDistance < limit) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                reinterpret_cast<const char*>(row_of(i + kPrefetchDistance)));
+          }
+          Eigen::Map<const Row> row(row_of(i), num_col);
+          if (weights != nullptr) {
+            const T weight = weights[i];
+            out += weight * row;
+            total += is_sqrtn_ ? weight * weight : weight;
+          } else {
+            out += row;
+            total += T(1);
+          }
+        }
+        if (is_sqrtn_) total = std::sqrt(total);
+        // Like embedding_lookup_sparse, segments whose weights sum to zero
+        // are left unscaled instead of becoming NaN.
+        if ((is_mean_ || is_sqrtn_) && total != T(0)) out /= total;
+      }
+    };
+
+    const int64_t cost_per_segment =
+        (num_indices / num_segments) * num_col *
+        (Eigen::TensorOpCost::AddCost<T>() + Eigen::TensorOpCost::MulCost<T>());
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce);
+  }
+
+ private:
+  int num_weights_;
+  bool is_mean_;
+  bool is_sqrtn_;
+};
+
+#define REGISTER_CPU_KERNEL(type, index_type, idx_type, segment_ids_type) \
+  REGISTER_KERNEL_BUILDER(                                                \
+      Name("_FusedGatherSparseSegmentReduce")                             \
+          .Device(DEVICE_CPU)                                             \
+          .TypeConstraint<type>("T")                                      \
+          .TypeConstraint<index_type>("Tindices")                         \
+          .TypeConstraint<idx_type>("Tidx")                               \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),               \
+      FusedGatherSparseSegmentReduceOp<type, index_type, idx_type,        \
+                                       segment_ids_type>);
+
+#define REGISTER_CPU_KERNEL_SEGMENT_IDS(type, index_type, idx_type) \
+  REGISTER_CPU_KERNEL(type, index_type, idx_type, int32);           \
+  REGISTER_CPU_KERNEL(type, index_type, idx_type, int64_t);
+
+#define REGISTER_CPU_KERNEL_IDX(type, index_type)            \
+  REGISTER_CPU_KERNEL_SEGMENT_IDS(type, index_type, int32); \
+  REGISTER_CPU_KERNEL_SEGMENT_IDS(type, index_type, int64_t);
+
+#define REGISTER_CPU_KERNELS(type)       \
+  REGISTER_CPU_KERNEL_IDX(type, int32); \
+  REGISTER_CPU_KERNEL_IDX(type, int64_t);
+
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_CPU_KERNEL_IDX
+#undef REGISTER_CPU_KERNEL_SEGMENT_IDS
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedGatherSparseSegmentReduceOpTest : public OpsTestBase {
+ protected:
+  void Init(const string& combiner, int num_weights) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "_FusedGatherSparseSegmentReduce")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(num_weights, DT_FLOAT))
+                     .Attr("combiner", combiner)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    // Row r of the table is {r, 10 r}.
+    AddInputFromArray<float>(TensorShape({4, 2}), {0, 0, 1, 10, 2, 20, 3, 30});
+    AddInputFromArray<int32>(TensorShape({3}), {3, 1, 0});
+  }
+
+  // Ids 0 and 1 are in segment 0, ids 2 and 3 in segment 2, so that the rows
+  // 3 and 1 are reduced into segment 0, 0 and 3 into segment 2.
+  void AddIds() {
+    AddInputFromArray<int32>(TensorShape({4}), {0, 1, 2, 0});
+    AddInputFromArray<int32>(TensorShape({4}), {0, 0, 2, 2});
+  }
+};
+
+TEST_F(FusedGatherSparseSegmentReduceOpTest, Sum) {
+  Init("sum", 0);
+  AddIds();
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {4, 40, 0, 0, 3, 30});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedGatherSparseSegmentReduceOpTest, Mean) {
+  Init("mean", 0);
+  AddIds();
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {2, 20, 0, 0, 1.5, 15});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedGatherSparseSegmentReduceOpTest, WeightedSqrtN) {
+  Init("sqrtn", 1);
+  AddIds();
+  AddInputFromArray<float>(TensorShape({4}), {1, 2, 3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  // Segment 0 is (1 * {3, 30} + 2 * {1, 10}) / sqrt(1 + 4), segment 2 is
+  // (3 * {0, 0} + 4 * {3, 30}) / sqrt(9 + 16).
+  const float sqrt5 = std::sqrt(5.0f);
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected, {sqrt5, 10 * sqrt5, 0, 0, 2.4, 24});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedGatherSparseSegmentReduceOpTest, UnsortedSegmentIds) {
+  Init("sum", 0);
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(
+      absl::StrContains(s.ToString(), "segment ids are not increasing"))
+      << s;
+}
+
+TEST_F(FusedGatherSparseSegmentReduceOpTest, GatherIndexOutOfRange) {
+  Init("sum", 0);
+  AddInputFromArray<int32>(TensorShape({1}), {3});
+  AddInputFromArray<int32>(TensorShape({1}), {0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "indices[0] = 3")) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,157 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements _FusedLayerNorm, which the remapper creates from the ops the
+// Keras LayerNormalization layer and its hand-written variants lower to. Each
+// row is read once to compute its mean and variance, and once more, from the
+// cache, to write the normalized, scaled and offset values.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The rows are processed in blocks of this many values, which are converted
+// to float in a buffer that stays in the L1 cache.
+constexpr int64_t kBlockSize = 256;
+
+typedef Eigen::Array<float, Eigen::Dynamic, 1> FloatArray;
+
+}  // namespace
+
+template <typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(x.shape()),
+                errors::InvalidArgument("x must be at least 1-D, got ",
+                                        x.shape().DebugString()));
+    const int64_t depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(scale.shape()) &&
+                    scale.NumElements() == depth,
+                errors::InvalidArgument(
+                    "scale must be a vector of the size of the last "
+                    "dimension of x, got ",
+                    scale.shape().DebugString(), " for x of shape ",
+                    x.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(offset.shape()) &&
+                    offset.NumElements() == depth,
+                errors::InvalidArgument(
+                    "offset must be a vector of the size of the last "
+                    "dimension of x, got ",
+                    offset.shape().DebugString(), " for x of shape ",
+                    x.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    const FloatArray scale_f =
+        Eigen::Map<const Array>(scale.flat<T>().data(), depth)
+            .template cast<float>();
+    const FloatArray offset_f =
+        Eigen::Map<const Array>(offset.flat<T>().data(), depth)
+            .template cast<float>();
+    const T* x_data = x.flat<T>().data();
+    T* y_data = y->flat<T>().data();
+    const float epsilon = epsilon_;
+
+    auto normalize = [&](int64_t begin, int64_t end) {
+      Eigen::Array<float, kBlockSize, 1> block;
+      for (int64_t row = begin; row < end; ++row) {
+        const T* in = x_data + row * depth;
+        T* out = y_data + row * depth;
+        // The mean and the sum of the squared differences from it of each
+        // block are merged into the ones of the previous blocks with the
+        // formulas of Chan et al., which, unlike the sums of the values and
+        // of their squares, do not lose the variance of values far from 0.
+        float mean = 0.0f;
+        float m2 = 0.0f;
+        for (int64_t c = 0; c < depth; c += kBlockSize) {
+          const int64_t n = std::min(kBlockSize, depth - c);
+          auto values = block.head(n);
+          values = Eigen::Map<const Array>(in + c, n).template cast<float>();
+          const float block_mean = values.mean();
+          const float block_m2 = (values - block_mean).square().sum();
+          const float delta = block_mean - mean;
+          const float weight = static_cast<float>(n) / (c + n);
+          mean += delta * weight;
+          m2 += block_m2 + delta * delta * c * weight;
+        }
+        const float inv_stddev = 1.0f / std::sqrt(m2 / depth + epsilon);
+        for (int64_t c = 0; c < depth; c += kBlockSize) {
+          const int64_t n = std::min(kBlockSize, depth - c);
+          auto values = block.head(n);
+          values = Eigen::Map<const Array>(in + c, n).template cast<float>();
+          Eigen::Map<Array>(out + c, n) =
+              ((values - mean) * inv_stddev * scale_f.segment(c, n) +
+               offset_f.segment(c, n))
+                  .template cast<T>();
+        }
+      }
+    };
+
+    const int64_t num_rows = x.NumElements() / depth;
+    const int64_t cost_per_row =
+        depth * (2 * sizeof(T) + 8 * Eigen::TensorOpCost::AddCost<float>());
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, normalize);
+  }
+
+ private:
+  typedef Eigen::Array<T, Eigen::Dynamic, 1> Array;
+
+  float epsilon_;
+};
+
+#define REGISTER_CPU_KERNEL(type)                                          \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<type>("T"), \
+      FusedLayerNormOp<type>);
+
+TF_CALL_half(REGISTER_CPU_KERNEL);
+TF_CALL_bfloat16(REGISTER_CPU_KERNEL);
+TF_CALL_float(REGISTER_CPU_KERNEL);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/ops_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  void Init(DataType dtype, float epsilon) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "_FusedLayerNorm")
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Attr("epsilon", epsilon)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  // Returns the layer norm of each row of `x`, computed in double.
+  static std::vector<float> Expected(const std::vector<float>& x, int depth,
+                                     const std::vector<float>& scale,
+                                     const std::vector<float>& offset,
+                                     float epsilon) {
+    std::vector<float> y(x.size());
+    for (int row = 0; row * depth < x.size(); ++row) {
+      double mean = 0, variance = 0;
+      for (int c = 0; c < depth; ++c) mean += x[row * depth + c];
+      mean /= depth;
+      for (int c = 0; c < depth; ++c) {
+        variance += std::pow(x[row * depth + c] - mean, 2);
+      }
+      variance /= depth;
+      for (int c = 0; c < depth; ++c) {
+        y[row * depth + c] = (x[row * depth + c] - mean) /
+                                 std::sqrt(variance + epsilon) * scale[c] +
+                             offset[c];
+      }
+    }
+    return y;
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, Small) {
+  Init(DT_FLOAT, 0.001);
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, -2, 0, 8});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 0.5});
+  AddInputFromArray<float>(TensorShape({3}), {0, 1, -1});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(
+      &expected, Expected({1, 2, 3, -2, 0, 8}, 3, {1, 2, 0.5}, {0, 1, -1},
+                          0.001));
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+// Rows longer than a block, whose values are far from 0.
+TEST_F(FusedLayerNormOpTest, LongRows) {
+  const int depth = 1000;
+  Init(DT_FLOAT, 1e-5);
+  std::vector<float> x(3 * depth), scale(depth), offset(depth);
+  for (int i = 0; i < x.size(); ++i) x[i] = 1000 + (i * 7919 % 101) * 0.01f;
+  for (int c = 0; c < depth; ++c) {
+    scale[c] = 1 + c % 3;
+    offset[c] = c % 5;
+  }
+  AddInputFromArray<float>(TensorShape({3, depth}), x);
+  AddInputFromArray<float>(TensorShape({depth}), scale);
+  AddInputFromArray<float>(TensorShape({depth}), offset);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3, depth}));
+  test::FillValues<float>(&expected,
+                          Expected(x, depth, scale, offset, 1e-5));
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 2e-3);
+}
+
+TEST_F(FusedLayerNormOpTest, Bfloat16) {
+  Init(DT_BFLOAT16, 0.001);
+  AddInputFromList<bfloat16>(TensorShape({1, 4}), {1, 2, 3, 4});
+  AddInputFromList<bfloat16>(TensorShape({4}), {1, 1, 1, 1});
+  AddInputFromList<bfloat16>(TensorShape({4}), {0, 0, 0, 0});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({1, 4}));
+  test::FillValues<float>(
+      &expected, Expected({1, 2, 3, 4}, 4, {1, 1, 1, 1}, {0, 0, 0, 0}, 0.001));
+  Tensor output(DT_FLOAT, TensorShape({1, 4}));
+  output.flat<float>() = GetOutput(0)->flat<bfloat16>().cast<float>();
+  test::ExpectTensorNear<float>(expected, output, 1e-2);
+}
+
+TEST_F(FusedLayerNormOpTest, WrongScaleSize) {
+  Init(DT_FLOAT, 0.001);
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2}), {1, 1});
+  AddInputFromArray<float>(TensorShape({3}), {0, 0, 0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "scale must be a vector")) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
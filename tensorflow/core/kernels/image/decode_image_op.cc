@@ -15,11 +15,13 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #define EIGEN_USE_THREADS
 
@@ -42,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/work_sharder.h"
 #include "tsl/util/byte_swap_array.h"
 
 namespace tensorflow {
@@ -75,6 +78,23 @@ FileFormat ClassifyFileFormat(StringPiece data) {
   return kUnknownFormat;
 }
 
+// Reads the `dct_method` attr of the JPEG decoding ops.
+Status GetDctMethod(OpKernelConstruction* context, J_DCT_METHOD* dct_method) {
+  string dct_method_name;
+  TF_RETURN_IF_ERROR(context->GetAttr("dct_method", &dct_method_name));
+  // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
+  // image quality for speed.
+  if (dct_method_name.empty() || dct_method_name == "INTEGER_FAST") {
+    *dct_method = JDCT_IFAST;
+  } else if (dct_method_name == "INTEGER_ACCURATE") {
+    *dct_method = JDCT_ISLOW;
+  } else {
+    return errors::InvalidArgument(
+        "dct_method must be one of {'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}");
+  }
+  return OkStatus();
+}
+
 // Decode an image. Supported image formats are JPEG, PNG, GIF and BMP. This is
 // a newer version of `DecodeImageOp` for enabling image data parsing to take
 // place in kernels only, reducing security vulnerabilities and redundancy.
@@ -114,21 +134,7 @@ class DecodeImageV2Op : public OpKernel {
       OP_REQUIRES_OK(context,
                      context->GetAttr("acceptable_fraction",
                                       &flags_.min_acceptable_fraction));
-      string dct_method;
-      OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
-      OP_REQUIRES(
-          context,
-          (dct_method.empty() || dct_method == "INTEGER_FAST" ||
-           dct_method == "INTEGER_ACCURATE"),
-          errors::InvalidArgument("dct_method must be one of "
-                                  "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
-      // The TensorFlow-chosen default for JPEG decoding is IFAST, sacrificing
-      // image quality for speed.
-      if (dct_method.empty() || dct_method == "INTEGER_FAST") {
-        flags_.dct_method = JDCT_IFAST;
-      } else if (dct_method == "INTEGER_ACCURATE") {
-        flags_.dct_method = JDCT_ISLOW;
-      }
+      OP_REQUIRES_OK(context, GetDctMethod(context, &flags_.dct_method));
     } else {
       flags_ = jpeg::UncompressFlags();
       flags_.dct_method = JDCT_IFAST;
@@ -749,5 +755,219 @@ void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
   }
 }
 
+// Resizes the `in_height` x `in_width` image `input` into the `out_height` x
+// `out_width` image `output`, like ResizeBilinear with align_corners false.
+void ResizeBilinearImage(const uint8* input, int in_height, int in_width,
+                         int channels, int out_height, int out_width,
+                         bool half_pixel_centers, float* output) {
+  struct Interpolation {
+    int64_t lower;
+    int64_t upper;
+    float lerp;
+  };
+  auto compute_weights = [half_pixel_centers](int out_size, int in_size) {
+    const float scale = static_cast<float>(in_size) / out_size;
+    std::vector<Interpolation> weights(out_size);
+    for (int i = 0; i < out_size; ++i) {
+      const float in =
+          half_pixel_centers ? (i + 0.5f) * scale - 0.5f : i * scale;
+      const float in_f = std::floor(in);
+      weights[i].lower = std::max(static_cast<int64_t>(in_f), int64_t{0});
+      weights[i].upper =
+          std::min(static_cast<int64_t>(std::ceil(in)), int64_t{in_size - 1});
+      weights[i].lerp = in - in_f;
+    }
+    return weights;
+  };
+  const std::vector<Interpolation> ys = compute_weights(out_height, in_height);
+  const std::vector<Interpolation> xs = compute_weights(out_width, in_width);
+  const int64_t in_row_size = static_cast<int64_t>(in_width) * channels;
+  for (int y = 0; y < out_height; ++y) {
+    const uint8* top = input + ys[y].lower * in_row_size;
+    const uint8* bottom = input + ys[y].upper * in_row_size;
+    const float y_lerp = ys[y].lerp;
+    for (int x = 0; x < out_width; ++x) {
+      const int64_t left = xs[x].lower * channels;
+      const int64_t right = xs[x].upper * channels;
+      const float x_lerp = xs[x].lerp;
+      for (int c = 0; c < channels; ++c) {
+        const float top_left = top[left + c];
+        const float top_right = top[right + c];
+        const float bottom_left = bottom[left + c];
+        const float bottom_right = bottom[right + c];
+        const float top_value = top_left + (top_right - top_left) * x_lerp;
+        const float bottom_value =
+            bottom_left + (bottom_right - bottom_left) * x_lerp;
+        *output++ = top_value + (bottom_value - top_value) * y_lerp;
+      }
+    }
+  }
+}
+
+// Decodes a batch of JPEG images and resizes them with bilinear interpolation.
+// Each image is decoded with the libjpeg scaled IDCT that gives the smallest
+// image that is still at least as large as the output, and is cropped during
+// decoding. The images are decoded in parallel.
+class DecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &flags_.components));
+    OP_REQUIRES(context, flags_.components == 1 || flags_.components == 3,
+                errors::InvalidArgument("`channels` must be 1 or 3 but got ",
+                                        flags_.components));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context, GetDctMethod(context, &flags_.dct_method));
+    OP_REQUIRES_OK(context, context->GetAttr("half_pixel_centers",
+                                             &half_pixel_centers_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    const Tensor& crop_window = context->input(1);
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsVector(contents.shape()),
+        errors::InvalidArgument("`contents` must be a vector but got shape ",
+                                contents.shape().DebugString()));
+    const int64_t batch_size = contents.NumElements();
+    const bool crop = crop_window.NumElements() > 0;
+    OP_REQUIRES(
+        context,
+        !crop || (crop_window.dims() == 1 && crop_window.dim_size(0) == 4) ||
+            (crop_window.dims() == 2 && crop_window.dim_size(0) == batch_size &&
+             crop_window.dim_size(1) == 4),
+        errors::InvalidArgument(
+            "`crop_window` must be empty, of shape [4] or of shape [",
+            batch_size, ", 4] but got shape ",
+            crop_window.shape().DebugString()));
+    OP_REQUIRES(context, size.dims() == 1 && size.NumElements() == 2,
+                errors::InvalidArgument("`size` must be 1-D with two elements "
+                                        "but got shape ",
+                                        size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("`size` must be positive but got ",
+                                        out_height, "x", out_width));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, out_height, out_width,
+                                    flags_.components}),
+                       &output));
+    const auto contents_vec = contents.vec<tstring>();
+    const int32* crop_windows =
+        crop ? crop_window.flat<int32>().data() : nullptr;
+    const bool same_crop_window = crop_window.dims() == 1;
+    const int64_t image_size =
+        static_cast<int64_t>(out_height) * out_width * flags_.components;
+    float* output_data = output->flat<float>().data();
+    std::vector<Status> statuses(batch_size);
+    auto decode = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const int32* image_crop_window = nullptr;
+        if (crop) {
+          image_crop_window = crop_windows + (same_crop_window ? 0 : 4 * i);
+        }
+        statuses[i] = DecodeAndResize(contents_vec(i), image_crop_window,
+                                      out_height, out_width,
+                                      output_data + i * image_size);
+      }
+    };
+    // Decoding dominates, and each image is large enough to be decoded by a
+    // different thread.
+    const int64_t cost_per_image = 1000 * image_size;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_image, decode);
+    for (const Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  Status DecodeAndResize(StringPiece contents, const int32* crop_window,
+                         int out_height, int out_width, float* output) const {
+    int height = 0;
+    int width = 0;
+    if (!jpeg::GetImageInfo(contents.data(), contents.size(), &width, &height,
+                            nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, size ",
+                                     contents.size());
+    }
+    int crop_y = 0;
+    int crop_x = 0;
+    int crop_height = height;
+    int crop_width = width;
+    if (crop_window != nullptr) {
+      crop_y = crop_window[0];
+      crop_x = crop_window[1];
+      crop_height = crop_window[2];
+      crop_width = crop_window[3];
+      if (crop_height <= 0 || crop_width <= 0 || crop_y < 0 || crop_x < 0 ||
+          crop_y > height - crop_height || crop_x > width - crop_width) {
+        return errors::InvalidArgument(
+            "Invalid crop window: y=", crop_y, ", x=", crop_x,
+            ", h=", crop_height, ", w=", crop_width, " for an image of ",
+            height, "x", width);
+      }
+    }
+
+    // The largest IDCT scaling that keeps at least the output size.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = 8;
+    while (flags.ratio > 1 &&
+           (crop_height < static_cast<int64_t>(out_height) * flags.ratio ||
+            crop_width < static_cast<int64_t>(out_width) * flags.ratio)) {
+      flags.ratio /= 2;
+    }
+    // libjpeg crops images in the coordinates of the scaled image, whose size
+    // is rounded up.
+    const int ratio = flags.ratio;
+    const int scaled_height = (height + ratio - 1) / ratio;
+    const int scaled_width = (width + ratio - 1) / ratio;
+    const int y_begin = crop_y / ratio;
+    const int x_begin = crop_x / ratio;
+    const int y_end =
+        std::min((crop_y + crop_height + ratio - 1) / ratio, scaled_height);
+    const int x_end =
+        std::min((crop_x + crop_width + ratio - 1) / ratio, scaled_width);
+    if (y_begin > 0 || x_begin > 0 || y_end < scaled_height ||
+        x_end < scaled_width) {
+      flags.crop = true;
+      flags.crop_y = y_begin;
+      flags.crop_x = x_begin;
+      flags.crop_height = y_end - y_begin;
+      flags.crop_width = x_end - x_begin;
+    }
+
+    int decoded_width = 0;
+    int decoded_height = 0;
+    int decoded_channels = 0;
+    std::unique_ptr<uint8[]> decoded(jpeg::Uncompress(
+        contents.data(), contents.size(), flags, &decoded_width,
+        &decoded_height, &decoded_channels, /*nwarn=*/nullptr));
+    if (decoded == nullptr) {
+      return errors::InvalidArgument(
+          "jpeg::Uncompress failed. Invalid JPEG data or crop window.");
+    }
+    ResizeBilinearImage(decoded.get(), decoded_height, decoded_width,
+                        decoded_channels, out_height, out_width,
+                        half_pixel_centers_, output);
+    return OkStatus();
+  }
+
+  jpeg::UncompressFlags flags_;
+  bool half_pixel_centers_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("_DecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegOp);
+
 }  // namespace
 }  // namespace tensorflow
@@ -722,6 +722,10 @@ REGISTER_LIST_COPY(VariantDeviceCopyDirection::DEVICE_TO_HOST);
 REGISTER_LIST_COPY(VariantDeviceCopyDirection::DEVICE_TO_DEVICE);
 
 REGISTER_UNARY_VARIANT_DECODE_FUNCTION(TensorList, TensorList::kTypeName);
+REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS(
+    TensorList, TensorList::kTypeName,
+    [](const TensorList& list, string* buf) { return list.EncodeBinary(buf); },
+    [](StringPiece buf, TensorList* list) { return list->DecodeBinary(buf); });
 
 #if !defined(PLUGGABLE_DEVICE_SUPPORTED_MACOS)
 #define REGISTER_TENSOR_LIST_OPS_DEFAULT(T)                                \
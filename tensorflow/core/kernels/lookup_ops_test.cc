@@ -15,16 +15,21 @@ limitations under the License.
 
 // Tests kernels of lookup ops.
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -100,5 +105,123 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+class MutableDenseHashTableTest : public OpsTestBase {
+ protected:
+  // Creates an empty table from int64 keys to float values.
+  void CreateTable() {
+    TF_ASSERT_OK(NodeDefBuilder("table", "AnonymousMutableDenseHashTable")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_INT64))
+                     .Attr("key_dtype", DT_INT64)
+                     .Attr("value_dtype", DT_FLOAT)
+                     .Attr("initial_num_buckets", 1024)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<int64_t>(TensorShape({}), {-1});
+    AddInputFromArray<int64_t>(TensorShape({}), {-2});
+    TF_ASSERT_OK(RunOpKernel());
+    // The handle holds a reference to the table.
+    handle_ = GetOutput(0)->scalar<ResourceHandle>()();
+    auto table_or = handle_.GetResource<lookup::LookupInterface>();
+    TF_ASSERT_OK(table_or.status());
+    table_ = table_or.value();
+  }
+
+  // Inserts the keys [0, num_keys) mapped to twice their value.
+  void InsertKeys(int64_t num_keys) {
+    Tensor keys(DT_INT64, TensorShape({num_keys}));
+    Tensor values(DT_FLOAT, TensorShape({num_keys}));
+    for (int64_t i = 0; i < num_keys; ++i) {
+      keys.vec<int64_t>()(i) = i;
+      values.vec<float>()(i) = 2 * i;
+    }
+    TF_ASSERT_OK(table_->Insert(context_.get(), keys, values));
+  }
+
+  ResourceHandle handle_;
+  lookup::LookupInterface* table_ = nullptr;
+};
+
+TEST_F(MutableDenseHashTableTest, FindLargeBatch) {
+  CreateTable();
+  constexpr int64_t kNumKeys = 100000;
+  InsertKeys(kNumKeys);
+  EXPECT_EQ(table_->size(), kNumKeys);
+
+  // Look up every other key of twice the range, which is large enough to be
+  // sharded.
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  Tensor expected(DT_FLOAT, TensorShape({kNumKeys}));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    keys.vec<int64_t>()(i) = 2 * i;
+    expected.vec<float>()(i) = 2 * i < kNumKeys ? 4 * i : -1;
+  }
+  Tensor values(DT_FLOAT, TensorShape({kNumKeys}));
+  Tensor default_value = test::AsScalar<float>(-1);
+  TF_ASSERT_OK(table_->Find(context_.get(), keys, &values, default_value));
+  test::ExpectTensorEqual<float>(expected, values);
+
+  // An invalid key anywhere in the batch fails the lookup.
+  keys.vec<int64_t>()(kNumKeys - 1) = -1;
+  Status s = table_->Find(context_.get(), keys, &values, default_value);
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "empty_key")) << s;
+}
+
+class MutableDenseHashTableBM : public MutableDenseHashTableTest {
+ public:
+  void TestBody() override {}
+
+  void Init(int64_t num_keys) {
+    CreateTable();
+    InsertKeys(num_keys);
+  }
+
+  lookup::LookupInterface* table() { return table_; }
+  OpKernelContext* context() { return context_.get(); }
+};
+
+// Looks up batches of random keys of a table of 2^20 keys from several threads,
+// while the first thread also inserts keys if `insert` is set, like an online
+// learning model being served.
+void BM_MutableDenseHashTableFind(::testing::benchmark::State& state) {
+  constexpr int64_t kNumKeys = 1 << 20;
+  const int64_t batch_size = state.range(0);
+  const bool insert = state.range(1);
+  static MutableDenseHashTableBM* bm = [] {
+    auto* bm = new MutableDenseHashTableBM;
+    bm->Init(kNumKeys);
+    return bm;
+  }();
+
+  random::PhiloxRandom philox(301, state.thread_index());
+  random::SimplePhilox rnd(&philox);
+  Tensor keys(DT_INT64, TensorShape({batch_size}));
+  Tensor inserted_values(DT_FLOAT, TensorShape({batch_size}));
+  for (int64_t i = 0; i < batch_size; ++i) {
+    keys.vec<int64_t>()(i) = rnd.Uniform64(kNumKeys);
+    inserted_values.vec<float>()(i) = i;
+  }
+  Tensor values(DT_FLOAT, TensorShape({batch_size}));
+  Tensor default_value = test::AsScalar<float>(-1);
+  for (auto s : state) {
+    if (insert && state.thread_index() == 0) {
+      TF_CHECK_OK(bm->table()->Insert(bm->context(), keys, inserted_values));
+    }
+    TF_CHECK_OK(
+        bm->table()->Find(bm->context(), keys, &values, default_value));
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+BENCHMARK(BM_MutableDenseHashTableFind)
+    ->UseRealTime()
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->ArgPair(64, false)
+    ->ArgPair(4096, false)
+    ->ArgPair(64, true)
+    ->ArgPair(4096, true);
+
 }  // namespace
 }  // namespace tensorflow
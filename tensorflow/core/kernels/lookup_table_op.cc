@@ -24,9 +24,12 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/kernels/memory_mapped_hash_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -417,6 +420,14 @@ inline uint64 HashScalar(const T& key) {
 
 inline uint64 HashScalar(const tstring& key) { return Hash64(key); }
 
+// The number of keys ahead of the current one of a batch whose home buckets are
+// prefetched, which hides the latency of the random accesses to a large table.
+constexpr int64_t kPrefetchDistance = 8;
+
+// The approximate cost in cycles of looking up one key of a large table, which
+// is dominated by the cache misses of its probes.
+constexpr int64_t kFindCostPerKey = 500;
+
 // If the given shape is a scalar return {1} instead. Otherwise leave it alone.
 TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   if (shape.dims() == 0) {
@@ -511,6 +522,8 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto key_matrix = key.shaped<K, 2>({num_elements, key_size});
     auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
     const auto default_flat = default_value.flat<V>();
+    // Hash the keys before taking the lock, so that writers wait less.
+    const std::vector<uint64> key_hashes = HashKeys(key);
 
     tf_shared_lock l(mu_);
     const auto key_buckets_matrix = key_buckets_.template matrix<K>();
@@ -519,48 +532,73 @@ class MutableDenseHashTable final : public LookupInterface {
         empty_key_.template shaped<K, 2>({1, key_size});
     const auto deleted_key_matrix =
         deleted_key_.template shaped<K, 2>({1, key_size});
-    const int64_t bit_mask = num_buckets_ - 1;
-    // TODO(andreasst): parallelize using work_sharder
-    for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
-      }
-      int64_t bucket_index = key_hash & bit_mask;
-      int64_t num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
-          }
-          break;
+    const int64_t num_buckets = num_buckets_;
+    const int64_t bit_mask = num_buckets - 1;
+    // Looks up the keys in [begin, end), which only reads the buckets and can
+    // therefore run on several threads under the shared lock.
+    auto find_range = [&](int64_t begin, int64_t end) -> Status {
+      for (int64_t i = begin; i < end; ++i) {
+        if (i + kPrefetchDistance < end) {
+          PrefetchBucket(key_buckets_matrix.data(), value_buckets_matrix.data(),
+                         key_hashes[i + kPrefetchDistance] & bit_mask);
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
-          }
-          break;
+        const uint64 key_hash = key_hashes[i];
+        if (empty_key_hash_ == key_hash &&
+            IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the empty_key as a table key is not allowed");
         }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
+        if (deleted_key_hash_ == key_hash &&
+            IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
+          return errors::InvalidArgument(
+              "Using the deleted_key as a table key is not allowed");
+        }
+        int64_t bucket_index = key_hash & bit_mask;
+        int64_t num_probes = 0;
+        while (true) {
+          if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+            for (int64_t j = 0; j < value_size; ++j) {
+              // TODO(andreasst): check if we can get rid of SubtleMustCopy
+              // here and elsewhere in this file.
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(
+                  value_buckets_matrix(bucket_index, j));
+            }
+            break;
+          }
+          if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix,
+                         0)) {
+            for (int64_t j = 0; j < value_size; ++j) {
+              value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
+            }
+            break;
+          }
+          ++num_probes;
+          bucket_index =
+              (bucket_index + num_probes) & bit_mask;  // quadratic probing
+          if (num_probes >= num_buckets) {
+            return errors::Internal(
+                "Internal error in MutableDenseHashTable lookup");
+          }
         }
       }
-    }
-    return OkStatus();
+      return OkStatus();
+    };
+    const DeviceBase::CpuWorkerThreads* worker_threads =
+        ctx != nullptr ? ctx->device()->tensorflow_cpu_worker_threads()
+                       : nullptr;
+    if (worker_threads == nullptr) return find_range(0, num_elements);
+    mutex status_mu;
+    Status status;
+    Shard(worker_threads->num_threads, worker_threads->workers, num_elements,
+          /*cost_per_unit=*/kFindCostPerKey + key_size + value_size,
+          [&](int64_t begin, int64_t end) {
+            Status s = find_range(begin, end);
+            if (!s.ok()) {
+              mutex_lock status_lock(status_mu);
+              status.Update(s);
+            }
+          });
+    return status;
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& key,
@@ -573,6 +611,7 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
+    const std::vector<uint64> key_hashes = HashKeys(key);
     mutex_lock l(mu_);
     // For simplicity we assume that all keys in the input result in inserts
     // rather than updates. That means we may grow the table even though we
@@ -586,7 +625,7 @@ class MutableDenseHashTable final : public LookupInterface {
       } while (pending_num_entries > new_num_buckets * max_load_factor_);
       TF_RETURN_IF_ERROR(Rebucket(ctx, new_num_buckets));
     }
-    return DoInsert(ctx, key, value, false);
+    return DoInsert(ctx, key, key_hashes, value, false);
   }
 
   Status Remove(OpKernelContext* ctx, const Tensor& key) override
@@ -598,8 +637,9 @@ class MutableDenseHashTable final : public LookupInterface {
                                      expected_shape.DebugString(), " got ",
                                      key.shape().DebugString());
     }
+    const std::vector<uint64> key_hashes = HashKeys(key);
     mutex_lock l(mu_);
-    return DoRemove(ctx, key);
+    return DoRemove(ctx, key, key_hashes);
   }
 
   Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
@@ -673,7 +713,8 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
  private:
-  Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
+  Status DoInsert(OpKernelContext* ctx, const Tensor& key,
+                  const std::vector<uint64>& key_hashes, const Tensor& value,
                   bool ignore_empty_and_deleted_key)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     const int64_t num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
@@ -690,7 +731,11 @@ class MutableDenseHashTable final : public LookupInterface {
         deleted_key_.template shaped<K, 2>({1, key_size});
     const int64_t bit_mask = num_buckets_ - 1;
     for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
+      if (i + kPrefetchDistance < num_elements) {
+        PrefetchBucket(key_buckets_matrix.data(), value_buckets_matrix.data(),
+                       key_hashes[i + kPrefetchDistance] & bit_mask);
+      }
+      const uint64 key_hash = key_hashes[i];
       if (empty_key_hash_ == key_hash &&
           IsEqualKey(empty_key_tensor, 0, key_matrix, i)) {
         if (ignore_empty_and_deleted_key) {
@@ -743,7 +788,8 @@ class MutableDenseHashTable final : public LookupInterface {
     return OkStatus();
   }
 
-  Status DoRemove(OpKernelContext* ctx, const Tensor& key)
+  Status DoRemove(OpKernelContext* ctx, const Tensor& key,
+                  const std::vector<uint64>& key_hashes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     const int64_t num_elements = key.dim_size(0);
     const int64_t key_size = key_shape_.num_elements();
@@ -757,7 +803,7 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_flat = deleted_key_.template flat<K>();
     const int64_t bit_mask = num_buckets_ - 1;
     for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
+      const uint64 key_hash = key_hashes[i];
       if (empty_key_hash_ == key_hash &&
           IsEqualKey(empty_key_tensor, 0, key_matrix, i)) {
         return errors::InvalidArgument(
@@ -837,7 +883,8 @@ class MutableDenseHashTable final : public LookupInterface {
     Tensor old_key_buckets = key_buckets_;
     Tensor old_value_buckets = value_buckets_;
     TF_RETURN_IF_ERROR(AllocateBuckets(ctx, num_new_buckets));
-    return DoInsert(ctx, old_key_buckets, old_value_buckets, true);
+    return DoInsert(ctx, old_key_buckets, HashKeys(old_key_buckets),
+                    old_value_buckets, true);
   }
 
   uint64 HashKey(typename TTypes<K>::ConstMatrix key, int64_t index) const {
@@ -851,6 +898,29 @@ class MutableDenseHashTable final : public LookupInterface {
     return result;
   }
 
+  // Returns the hashes of a batch of keys, which are of shape
+  // [batch_size] + key_shape_.
+  std::vector<uint64> HashKeys(const Tensor& keys) const {
+    const int64_t num_keys = (keys.dims() == 0) ? 1 : keys.dim_size(0);
+    const auto key_matrix =
+        keys.shaped<K, 2>({num_keys, key_shape_.num_elements()});
+    std::vector<uint64> key_hashes(num_keys);
+    for (int64_t i = 0; i < num_keys; ++i) {
+      key_hashes[i] = HashKey(key_matrix, i);
+    }
+    return key_hashes;
+  }
+
+  // Prefetches the key and the value of a bucket, so that the probes of a
+  // batch of keys overlap their cache misses.
+  void PrefetchBucket(const K* key_buckets, const V* value_buckets,
+                      int64_t bucket_index) const {
+    port::prefetch<port::PREFETCH_HINT_T0>(reinterpret_cast<const char*>(
+        key_buckets + bucket_index * key_shape_.num_elements()));
+    port::prefetch<port::PREFETCH_HINT_T0>(reinterpret_cast<const char*>(
+        value_buckets + bucket_index * value_shape_.num_elements()));
+  }
+
   // Use a template to allow this function to be used both with Matrix and
   // ConstMatrix types.
   template <typename MT2>
@@ -1118,6 +1188,24 @@ REGISTER_KERNEL(tstring, tstring);
 
 #undef REGISTER_KERNEL
 
+// Register the MemoryMappedHashTable op with the key and value types of its
+// files.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                                \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("MemoryMappedHashTable")                                            \
+          .Device(DEVICE_CPU)                                                  \
+          .TypeConstraint<key_dtype>("key_dtype")                              \
+          .TypeConstraint<value_dtype>("value_dtype"),                         \
+      LookupTableOp<lookup::MemoryMappedHashTable<key_dtype, value_dtype>,     \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int64_t, int64_t);
+REGISTER_KERNEL(int64_t, tstring);
+REGISTER_KERNEL(tstring, int64_t);
+REGISTER_KERNEL(tstring, tstring);
+
+#undef REGISTER_KERNEL
+
 // Register the MutableHashTable op.
 #define REGISTER_KERNEL(key_dtype, value_dtype)                                \
   REGISTER_KERNEL_BUILDER(                                                     \
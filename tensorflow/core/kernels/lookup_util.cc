@@ -15,7 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/lookup_util.h"
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
 #include "tensorflow/core/framework/function_handle_cache.h"
 #include "tensorflow/core/framework/lookup_interface.h"
 #include "tensorflow/core/framework/op_requires.h"
@@ -24,7 +33,11 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -37,6 +50,11 @@ static const int kInputBufferSize = 1 * 1024 * 1024; /* bytes */
 static const int kLineNumber = -1;
 static const int kWholeLine = -2;
 
+// Size of the chunks in which `TextFileChunkIterator` reads and parses a file.
+static const int64_t kChunkBytes = 16 * 1024 * 1024;
+// Size of the reads which search the line break ending a chunk.
+static const int64_t kScanBytes = 64 * 1024;
+
 Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
                              int64_t* num_lines) {
   std::unique_ptr<RandomAccessFile> file;
@@ -57,6 +75,82 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   return OkStatus();
 }
 
+// Splits `line` at each `delimiter` like `str_util::Split`, keeping the empty
+// tokens, but without copying them.
+void SplitLine(StringPiece line, char delimiter,
+               std::vector<StringPiece>* tokens) {
+  tokens->clear();
+  const char* p = line.data();
+  const char* limit = line.data() + line.size();
+  while (true) {
+    const char* next =
+        static_cast<const char*>(memchr(p, delimiter, limit - p));
+    if (next == nullptr) {
+      tokens->emplace_back(p, limit - p);
+      return;
+    }
+    tokens->emplace_back(p, next - p);
+    p = next + 1;
+  }
+}
+
+// Sets element `i` of `tensor` from the line `line_id` of a text file, as
+// specified by `index`: the line number for kLineNumber, the whole `line` for
+// kWholeLine, or `tokens[index]` otherwise. The value is transformed to the
+// data type of `tensor`.
+Status SetTextFileValue(StringPiece line,
+                        const std::vector<StringPiece>& tokens, int64_t index,
+                        int64_t line_id, int64_t offset, int64_t i,
+                        Tensor* tensor) {
+  if (index == kLineNumber) {
+    tensor->flat<int64_t>()(i) = line_id + offset;
+    return OkStatus();
+  }
+  const StringPiece token = (index == kWholeLine) ? line : tokens[index];
+  const DataType& dtype = tensor->dtype();
+  switch (dtype) {
+    case DT_INT32: {
+      int32_t value;
+      if (!strings::safe_strto32(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ", line_id,
+                                       " is not a valid int32.");
+      }
+      tensor->flat<int32>()(i) = value + offset;
+    } break;
+    case DT_INT64: {
+      int64_t value;
+      if (!strings::safe_strto64(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ", line_id,
+                                       " is not a valid int64.");
+      }
+      tensor->flat<int64_t>()(i) = value;
+    } break;
+    case DT_FLOAT: {
+      float value;
+      if (!strings::safe_strtof(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ", line_id,
+                                       " is not a valid float.");
+      }
+      tensor->flat<float>()(i) = value;
+    } break;
+    case DT_DOUBLE: {
+      double value;
+      if (!strings::safe_strtod(token, &value)) {
+        return errors::InvalidArgument("Field ", token, " in line ", line_id,
+                                       " is not a valid double.");
+      }
+      tensor->flat<double>()(i) = value;
+    } break;
+    case DT_STRING:
+      tensor->flat<tstring>()(i).assign(token.data(), token.size());
+      break;
+    default:
+      return errors::InvalidArgument("Data type ", DataTypeString(dtype),
+                                     " not supported.");
+  }
+  return OkStatus();
+}
+
 // Iterator that reads a text file. Each iteration process one line, it parses
 // the line and populates the keys and values tensors used for initialization
 // with a single key and corresponding value.
@@ -137,9 +231,9 @@ class TextFileLineIterator
       return;
     }
 
-    std::vector<string> tokens;
+    std::vector<StringPiece> tokens;
     if (!ignore_split_) {
-      tokens = str_util::Split(line, delimiter_);
+      SplitLine(line, delimiter_, &tokens);
       const auto expected_size =
           static_cast<size_t>(std::max(key_index_, value_index_) + 1);
       if (tokens.size() < expected_size) {
@@ -152,12 +246,14 @@ class TextFileLineIterator
       }
     }
 
-    status_ = SetValue(line, tokens, key_index_, &key_);
+    status_ = SetTextFileValue(line, tokens, key_index_, next_id_, offset_,
+                               /*i=*/0, &key_);
     if (!status_.ok()) {
       valid_ = false;
       return;
     }
-    status_ = SetValue(line, tokens, value_index_, &value_);
+    status_ = SetTextFileValue(line, tokens, value_index_, next_id_, offset_,
+                               /*i=*/0, &value_);
     if (!status_.ok()) {
       valid_ = false;
       return;
@@ -204,66 +300,294 @@ class TextFileLineIterator
   std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
   std::unique_ptr<io::InputBuffer> input_buffer_;
 
-  // Set the corresponding value from line or tokens based on 'index' into the
-  // tensor 't'. The value is transformed to the given data type 'dtype'.
-  Status SetValue(const string& line, const std::vector<string>& tokens,
-                  int64_t index, Tensor* tensor) {
-    if (index == kLineNumber) {
-      tensor->flat<int64_t>()(0) = next_id_ + offset_;
-      return OkStatus();
+  TextFileLineIterator(const TextFileLineIterator&) = delete;
+  void operator=(const TextFileLineIterator&) = delete;
+};
+
+// Iterator that reads a large text file like `TextFileLineIterator`, but in
+// chunks of about kChunkBytes. The lines of each chunk are counted, and then
+// parsed, on a thread pool, a bounded number of chunks ahead of the table.
+// Each iteration produces the keys and values of all the lines of a chunk, so
+// that the table inserts them in bulk, after reserving `total_size()`.
+class TextFileChunkIterator
+    : public InitializableLookupTable::InitTableIterator {
+ public:
+  TextFileChunkIterator()
+      : valid_(false), status_(errors::FailedPrecondition("Not initialized")) {}
+
+  ~TextFileChunkIterator() override {
+    // Waits for the chunks being parsed.
+    pool_.reset();
+  }
+
+  // Initialize iterator. The arguments are the ones of
+  // `TextFileLineIterator::Init`, and the size of the file.
+  Status Init(const string& filename, int64_t vocab_size, char delimiter,
+              DataType key_dtype, int64_t key_index, DataType value_dtype,
+              int64_t value_index, int64_t offset, Env* env,
+              int64_t file_size) {
+    filename_ = filename;
+    vocab_size_ = vocab_size;
+    delimiter_ = delimiter;
+    key_dtype_ = key_dtype;
+    value_dtype_ = value_dtype;
+    key_index_ = key_index;
+    value_index_ = value_index;
+    offset_ = offset;
+    ignore_split_ = std::max(key_index_, value_index_) < 0;
+
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
+    TF_RETURN_IF_ERROR(FindChunkBoundaries(file_size));
+    const int64_t num_chunks = boundaries_.size() - 1;
+    pool_ = std::make_unique<thread::ThreadPool>(
+        env, "init_table_from_text_file",
+        std::min<int64_t>(port::MaxParallelism(), num_chunks));
+    TF_RETURN_IF_ERROR(CountLines());
+    num_lines_ = vocab_size_ == -1 ? total_lines_
+                                   : std::min(total_lines_, vocab_size_);
+    valid_ = true;
+    {
+      mutex_lock l(mu_);
+      ScheduleChunksLocked();
     }
-    const string& token = (index == kWholeLine) ? line : tokens[index];
-    const DataType& dtype = tensor->dtype();
-    switch (dtype) {
-      case DT_INT32: {
-        int32_t value;
-        if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int32.");
-        }
-        tensor->flat<int32>()(0) = value + offset_;
-      } break;
-      case DT_INT64: {
-        int64_t value;
-        if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid int64.");
+    Next();
+    return status_;
+  }
+
+  void Next() override {
+    if (!valid_) return;
+
+    mutex_lock l(mu_);
+    if (chunks_.empty()) {
+      if (vocab_size_ != -1 && total_lines_ < vocab_size_) {
+        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
+                                          ": expected ", vocab_size_,
+                                          " but got ", total_lines_);
+      } else {
+        if (vocab_size_ != -1 && total_lines_ > vocab_size_) {
+          LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                       << vocab_size_ << " records.";
         }
-        tensor->flat<int64_t>()(0) = value;
-      } break;
-      case DT_FLOAT: {
-        float value;
-        if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid float.");
+        status_ = errors::OutOfRange("Finished reading ", num_lines_,
+                                     " of lines from ", filename_);
+      }
+      valid_ = false;
+      return;
+    }
+    Chunk& chunk = *chunks_.front();
+    while (!chunk.done) {
+      cond_var_.wait(l);
+    }
+    status_ = chunk.status;
+    if (!status_.ok()) {
+      valid_ = false;
+      return;
+    }
+    key_ = std::move(chunk.keys);
+    value_ = std::move(chunk.values);
+    chunks_.pop_front();
+    ScheduleChunksLocked();
+  }
+
+  bool Valid() const override { return valid_; }
+
+  const Tensor& keys() const override { return key_; }
+
+  const Tensor& values() const override { return value_; }
+
+  Status status() const override { return status_; }
+
+  int64_t total_size() const override {
+    return vocab_size_ == -1 ? total_lines_ : vocab_size_;
+  }
+
+ private:
+  struct Chunk {
+    int64_t index;
+    bool done = false;
+    Status status;
+    Tensor keys;
+    Tensor values;
+  };
+
+  // Splits the file in chunks which end after a line break, except the last.
+  Status FindChunkBoundaries(int64_t file_size) {
+    boundaries_ = {0};
+    std::string scratch(kScanBytes, '\0');
+    int64_t offset = kChunkBytes;
+    while (offset < file_size) {
+      StringPiece block;
+      Status s = file_->Read(offset, std::min(kScanBytes, file_size - offset),
+                             &block, &scratch[0]);
+      if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+      if (block.empty()) break;
+      const char* line_break =
+          static_cast<const char*>(memchr(block.data(), '\n', block.size()));
+      if (line_break == nullptr) {
+        offset += block.size();
+        continue;
+      }
+      boundaries_.push_back(offset + (line_break - block.data()) + 1);
+      offset = boundaries_.back() + kChunkBytes;
+    }
+    if (boundaries_.back() < file_size) {
+      boundaries_.push_back(file_size);
+    }
+    return OkStatus();
+  }
+
+  // Reads the bytes of chunk `index`.
+  Status ReadChunk(int64_t index, std::string* data) const {
+    const int64_t start = boundaries_[index];
+    const int64_t size = boundaries_[index + 1] - start;
+    data->resize(size);
+    StringPiece result;
+    Status s = file_->Read(start, size, &result, &(*data)[0]);
+    if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+    if (result.size() != size) {
+      return errors::DataLoss("Read ", result.size(), " bytes instead of ",
+                              size, " at offset ", start, " of ", filename_);
+    }
+    if (result.data() != data->data()) {
+      data->assign(result.data(), result.size());
+    }
+    return OkStatus();
+  }
+
+  // Counts the lines of all the chunks in parallel, as `InputBuffer::ReadLine`
+  // returns them: a last line without line break only counts if it is not
+  // empty once its '\r' is dropped.
+  Status CountLines() {
+    const int64_t num_chunks = boundaries_.size() - 1;
+    std::vector<int64_t> chunk_lines(num_chunks, 0);
+    std::vector<Status> statuses(num_chunks);
+    BlockingCounter counter(num_chunks);
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      pool_->Schedule([this, i, &chunk_lines, &statuses, &counter]() {
+        std::string data;
+        statuses[i] = ReadChunk(i, &data);
+        if (statuses[i].ok()) {
+          chunk_lines[i] = std::count(data.begin(), data.end(), '\n');
+          StringPiece last_line(data);
+          last_line.remove_prefix(data.rfind('\n') + 1);
+          absl::ConsumeSuffix(&last_line, "\r");
+          if (!last_line.empty()) ++chunk_lines[i];
         }
-        tensor->flat<float>()(0) = value;
-      } break;
-      case DT_DOUBLE: {
-        double value;
-        if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
-                                         " is not a valid double.");
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    chunk_first_lines_.resize(num_chunks);
+    total_lines_ = 0;
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      TF_RETURN_IF_ERROR(statuses[i]);
+      chunk_first_lines_[i] = total_lines_;
+      total_lines_ += chunk_lines[i];
+    }
+    return OkStatus();
+  }
+
+  // Parses the lines of chunk `index` which are before `num_lines_`.
+  Status ParseChunk(int64_t index, Tensor* keys, Tensor* values) const {
+    std::string data;
+    TF_RETURN_IF_ERROR(ReadChunk(index, &data));
+    const int64_t first_line = chunk_first_lines_[index];
+    const int64_t next_first_line =
+        index + 1 < static_cast<int64_t>(chunk_first_lines_.size())
+            ? chunk_first_lines_[index + 1]
+            : total_lines_;
+    const int64_t num_lines =
+        std::min(num_lines_, next_first_line) - first_line;
+    *keys = Tensor(key_dtype_, TensorShape({num_lines}));
+    *values = Tensor(value_dtype_, TensorShape({num_lines}));
+    const auto expected_size =
+        static_cast<size_t>(std::max(key_index_, value_index_) + 1);
+    const char* p = data.data();
+    const char* limit = data.data() + data.size();
+    std::vector<StringPiece> tokens;
+    for (int64_t i = 0; i < num_lines; ++i) {
+      const int64_t line_id = first_line + i;
+      const char* line_break =
+          static_cast<const char*>(memchr(p, '\n', limit - p));
+      StringPiece line(p, (line_break == nullptr ? limit : line_break) - p);
+      absl::ConsumeSuffix(&line, "\r");
+      p = line_break == nullptr ? limit : line_break + 1;
+      if (line.empty()) {
+        return errors::InvalidArgument(
+            "Invalid content in ", filename_, ": empty line found at position ",
+            boundaries_[index] + (p - data.data()), ".");
+      }
+      if (!ignore_split_) {
+        SplitLine(line, delimiter_, &tokens);
+        if (tokens.size() < expected_size) {
+          return errors::InvalidArgument(
+              "Invalid number of columns in ", filename_, " line ", line_id,
+              " (", line, ") : expected at least ", expected_size, " got ",
+              tokens.size());
         }
-        tensor->flat<double>()(0) = value;
-      } break;
-      case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
-        break;
-      default:
-        valid_ = false;
-        return errors::InvalidArgument("Data type ", DataTypeString(dtype),
-                                       " not supported.");
+      }
+      TF_RETURN_IF_ERROR(SetTextFileValue(line, tokens, key_index_, line_id,
+                                          offset_, i, keys));
+      TF_RETURN_IF_ERROR(SetTextFileValue(line, tokens, value_index_, line_id,
+                                          offset_, i, values));
     }
     return OkStatus();
   }
 
-  TextFileLineIterator(const TextFileLineIterator&) = delete;
-  void operator=(const TextFileLineIterator&) = delete;
+  // Schedules the parsing of the next chunks which have lines to read, up to
+  // two chunks per thread ahead of the table.
+  void ScheduleChunksLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (next_chunk_ < chunk_first_lines_.size() &&
+           chunk_first_lines_[next_chunk_] < num_lines_ &&
+           chunks_.size() < 2 * pool_->NumThreads()) {
+      auto chunk = std::make_shared<Chunk>();
+      chunk->index = next_chunk_++;
+      chunks_.push_back(chunk);
+      pool_->Schedule([this, chunk]() {
+        Tensor keys;
+        Tensor values;
+        Status s = ParseChunk(chunk->index, &keys, &values);
+        mutex_lock l(mu_);
+        chunk->status = s;
+        chunk->keys = std::move(keys);
+        chunk->values = std::move(values);
+        chunk->done = true;
+        cond_var_.notify_all();
+      });
+    }
+  }
+
+  Tensor key_;
+  Tensor value_;
+  bool valid_;  // true if the iterator points to an existing range.
+  DataType key_dtype_;
+  DataType value_dtype_;
+  int64_t key_index_;
+  int64_t value_index_;
+  int64_t offset_;
+  int64_t vocab_size_;
+  string filename_;
+  char delimiter_;
+  Status status_;
+  bool ignore_split_;
+  std::unique_ptr<RandomAccessFile> file_;
+  // The offsets of the chunks in the file, and of its end.
+  std::vector<int64_t> boundaries_;
+  // The number of the first line of each chunk.
+  std::vector<int64_t> chunk_first_lines_;
+  int64_t total_lines_ = 0;
+  // The number of lines to read, which is less than `total_lines_` if the
+  // file is truncated to `vocab_size_` lines.
+  int64_t num_lines_ = 0;
+  mutex mu_;
+  condition_variable cond_var_;
+  // The chunks being parsed or to be returned, in file order.
+  std::deque<std::shared_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
+  size_t next_chunk_ TF_GUARDED_BY(mu_) = 0;
+  std::unique_ptr<thread::ThreadPool> pool_;
+
+  TextFileChunkIterator(const TextFileChunkIterator&) = delete;
+  void operator=(const TextFileChunkIterator&) = delete;
 };
 
 Status GetTableHandle(StringPiece input_name, OpKernelContext* ctx,
@@ -401,15 +725,28 @@ Status InitializeTableFromTextFile(
         DataTypeString(table->value_dtype()));
   }
 
-  TextFileLineIterator iter;
-  TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
-                               key_index, value_dtype, value_index, offset,
-                               env));
+  std::unique_ptr<InitializableLookupTable::InitTableIterator> iter;
+  uint64 file_size;
+  if (env->GetFileSize(filename, &file_size).ok() &&
+      file_size >= 2 * kChunkBytes) {
+    // Large files are parsed in parallel chunks.
+    auto chunk_iter = std::make_unique<TextFileChunkIterator>();
+    TF_RETURN_IF_ERROR(chunk_iter->Init(filename, vocab_size, delimiter,
+                                        key_dtype, key_index, value_dtype,
+                                        value_index, offset, env, file_size));
+    iter = std::move(chunk_iter);
+  } else {
+    auto line_iter = std::make_unique<TextFileLineIterator>();
+    TF_RETURN_IF_ERROR(line_iter->Init(filename, vocab_size, delimiter,
+                                       key_dtype, key_index, value_dtype,
+                                       value_index, offset, env));
+    iter = std::move(line_iter);
+  }
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
   // time.
-  Status s = table->Initialize(iter, std::move(serializer));
+  Status s = table->Initialize(*iter, std::move(serializer));
   if (absl::IsFailedPrecondition(s) && table->is_initialized()) {
     LOG(INFO) << "Table trying to initialize from file " << filename
               << " is already initialized.";
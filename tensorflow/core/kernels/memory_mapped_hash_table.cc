@@ -0,0 +1,333 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/memory_mapped_hash_table.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/hash.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[] = "TFMMHT01";
+constexpr int64_t kHeaderBytes = 64;
+constexpr int kGroupSize = 16;
+constexpr uint8_t kEmpty = 0x80;
+constexpr uint64_t kHashSeed = 0x6d6d6874;
+// Bound on the number of groups, so that the size of the file can't overflow.
+constexpr uint64_t kMaxGroups = uint64_t{1} << 40;
+
+struct Header {
+  char magic[8];
+  uint32_t key_dtype;
+  uint32_t value_dtype;
+  uint64_t num_entries;
+  uint64_t num_groups;
+  uint64_t strings_size;
+};
+static_assert(sizeof(Header) <= kHeaderBytes, "Header is too large");
+
+uint64_t HashKey(int64_t key) {
+  return Hash64(reinterpret_cast<const char*>(&key), sizeof(key), kHashSeed);
+}
+
+uint64_t HashKey(StringPiece key) {
+  return Hash64(key.data(), key.size(), kHashSeed);
+}
+
+// Returns a mask of the bytes of the 16 bytes `group` which are `byte`.
+uint32_t MatchByte(const uint8_t* group, uint8_t byte) {
+#if defined(__SSE2__)
+  const __m128i control =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return _mm_movemask_epi8(
+      _mm_cmpeq_epi8(control, _mm_set1_epi8(static_cast<char>(byte))));
+#else
+  uint32_t mask = 0;
+  for (int i = 0; i < kGroupSize; ++i) {
+    mask |= static_cast<uint32_t>(group[i] == byte) << i;
+  }
+  return mask;
+#endif
+}
+
+bool IsSupportedDtype(DataType dtype) {
+  return dtype == DT_INT64 || dtype == DT_STRING;
+}
+
+// Builds the words of the keys or values of a table, adding the strings to the
+// string pool.
+Status ToWords(const Tensor& tensor, std::vector<uint64_t>* words,
+               std::string* strings) {
+  const int64_t n = tensor.NumElements();
+  words->resize(n);
+  if (tensor.dtype() == DT_INT64) {
+    const auto flat = tensor.flat<int64_t>();
+    for (int64_t i = 0; i < n; ++i) {
+      (*words)[i] = static_cast<uint64_t>(flat(i));
+    }
+    return OkStatus();
+  }
+  const auto flat = tensor.flat<tstring>();
+  for (int64_t i = 0; i < n; ++i) {
+    if (flat(i).size() > UINT32_MAX) {
+      return errors::InvalidArgument("String ", i, " is too long");
+    }
+    (*words)[i] = strings->size();
+    const uint32_t length = flat(i).size();
+    strings->append(reinterpret_cast<const char*>(&length), sizeof(length));
+    strings->append(flat(i).data(), flat(i).size());
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status MemoryMappedHashTableFile::Open(
+    Env* env, const string& filename, DataType key_dtype, DataType value_dtype,
+    std::unique_ptr<MemoryMappedHashTableFile>* file) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "MemoryMappedHashTable requires a little endian platform");
+  }
+  std::unique_ptr<MemoryMappedHashTableFile> table(
+      new MemoryMappedHashTableFile());
+  TF_RETURN_IF_ERROR(
+      env->NewReadOnlyMemoryRegionFromFile(filename, &table->region_));
+  const uint64_t length = table->region_->length();
+  if (length < kHeaderBytes) {
+    return errors::DataLoss("MemoryMappedHashTable file ", filename,
+                            " is too short");
+  }
+  const char* data = static_cast<const char*>(table->region_->data());
+  Header header;
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, kMagic, sizeof(header.magic)) != 0) {
+    return errors::DataLoss(filename, " is not a MemoryMappedHashTable file");
+  }
+  if (static_cast<DataType>(header.key_dtype) != key_dtype ||
+      static_cast<DataType>(header.value_dtype) != value_dtype) {
+    return errors::InvalidArgument(
+        "MemoryMappedHashTable file ", filename, " holds ",
+        DataTypeString(static_cast<DataType>(header.key_dtype)), " keys and ",
+        DataTypeString(static_cast<DataType>(header.value_dtype)),
+        " values, but the table expects ", DataTypeString(key_dtype),
+        " keys and ", DataTypeString(value_dtype), " values");
+  }
+  const uint64_t num_groups = header.num_groups;
+  if (num_groups == 0 || num_groups > kMaxGroups ||
+      !absl::has_single_bit(num_groups) ||
+      header.num_entries > num_groups * kGroupSize) {
+    return errors::DataLoss("MemoryMappedHashTable file ", filename,
+                            " has an invalid header");
+  }
+  const uint64_t num_slots = num_groups * kGroupSize;
+  const uint64_t slots_offset = kHeaderBytes + num_slots;
+  const uint64_t strings_offset =
+      slots_offset + num_slots * 2 * sizeof(uint64_t);
+  if (strings_offset > length ||
+      length - strings_offset != header.strings_size) {
+    return errors::DataLoss("MemoryMappedHashTable file ", filename, " has ",
+                            length, " bytes, which doesn't match its header");
+  }
+  table->num_entries_ = header.num_entries;
+  table->num_slots_ = num_slots;
+  table->control_ = reinterpret_cast<const uint8_t*>(data + kHeaderBytes);
+  table->slots_ = reinterpret_cast<const uint64_t*>(data + slots_offset);
+  table->strings_ = data + strings_offset;
+  table->strings_size_ = header.strings_size;
+  *file = std::move(table);
+  return OkStatus();
+}
+
+Status MemoryMappedHashTableFile::Write(Env* env, const string& filename,
+                                        const Tensor& keys,
+                                        const Tensor& values) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "MemoryMappedHashTable requires a little endian platform");
+  }
+  if (!IsSupportedDtype(keys.dtype()) || !IsSupportedDtype(values.dtype())) {
+    return errors::InvalidArgument(
+        "MemoryMappedHashTable supports int64 and string keys and values, got ",
+        DataTypeString(keys.dtype()), " keys and ",
+        DataTypeString(values.dtype()), " values");
+  }
+  if (keys.dims() != 1 || !keys.shape().IsSameSize(values.shape())) {
+    return errors::InvalidArgument(
+        "Expected vectors of keys and values of the same size, got shapes ",
+        keys.shape().DebugString(), " and ", values.shape().DebugString());
+  }
+
+  const int64_t num_entries = keys.NumElements();
+  std::vector<uint64_t> key_words;
+  std::vector<uint64_t> value_words;
+  std::string strings;
+  TF_RETURN_IF_ERROR(ToWords(keys, &key_words, &strings));
+  TF_RETURN_IF_ERROR(ToWords(values, &value_words, &strings));
+
+  // Keeps at least 1/8 of the slots empty, so that the searches are short.
+  uint64_t num_groups = 1;
+  while (num_groups * kGroupSize * 7 < static_cast<uint64_t>(num_entries) * 8) {
+    num_groups *= 2;
+  }
+  const uint64_t num_slots = num_groups * kGroupSize;
+  std::vector<uint8_t> control(num_slots, kEmpty);
+  std::vector<uint64_t> slots(num_slots * 2, 0);
+  // The index of the key of each slot, to find the duplicate keys.
+  std::vector<int64_t> slot_keys(num_slots, -1);
+  const bool string_keys = keys.dtype() == DT_STRING;
+  for (int64_t i = 0; i < num_entries; ++i) {
+    const uint64_t hash =
+        string_keys ? HashKey(StringPiece(keys.flat<tstring>()(i)))
+                    : HashKey(keys.flat<int64_t>()(i));
+    const uint8_t h2 = hash & 0x7f;
+    // Takes the first empty slot from the group of the key, which is where
+    // `FindSlot` searches it.
+    uint64_t slot = ((hash >> 7) & (num_groups - 1)) * kGroupSize;
+    while (control[slot] != kEmpty) {
+      if (control[slot] == h2 &&
+          (string_keys ? keys.flat<tstring>()(slot_keys[slot]) ==
+                             keys.flat<tstring>()(i)
+                       : slots[2 * slot] == key_words[i])) {
+        return errors::InvalidArgument("Duplicate key at index ", i);
+      }
+      slot = (slot + 1) & (num_slots - 1);
+    }
+    control[slot] = h2;
+    slots[2 * slot] = key_words[i];
+    slots[2 * slot + 1] = value_words[i];
+    slot_keys[slot] = i;
+  }
+
+  Header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(header.magic));
+  header.key_dtype = keys.dtype();
+  header.value_dtype = values.dtype();
+  header.num_entries = num_entries;
+  header.num_groups = num_groups;
+  header.strings_size = strings.size();
+  std::string header_bytes(kHeaderBytes, '\0');
+  memcpy(&header_bytes[0], &header, sizeof(header));
+
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  TF_RETURN_IF_ERROR(file->Append(header_bytes));
+  TF_RETURN_IF_ERROR(file->Append(StringPiece(
+      reinterpret_cast<const char*>(control.data()), control.size())));
+  TF_RETURN_IF_ERROR(file->Append(
+      StringPiece(reinterpret_cast<const char*>(slots.data()),
+                  slots.size() * sizeof(uint64_t))));
+  TF_RETURN_IF_ERROR(file->Append(strings));
+  return file->Close();
+}
+
+template <typename Matches>
+int64_t MemoryMappedHashTableFile::FindSlot(uint64_t hash,
+                                            const Matches& matches) const {
+  const uint8_t h2 = hash & 0x7f;
+  const int64_t num_groups = num_slots_ / kGroupSize;
+  int64_t group = (hash >> 7) & (num_groups - 1);
+  // The entries of a group may start in the previous groups, so the search
+  // continues until a group has an empty slot.
+  for (int64_t i = 0; i < num_groups; ++i) {
+    const uint8_t* control = control_ + group * kGroupSize;
+    for (uint32_t mask = MatchByte(control, h2); mask != 0;
+         mask &= mask - 1) {
+      const int64_t slot = group * kGroupSize + absl::countr_zero(mask);
+      if (matches(slots_[2 * slot])) return slot;
+    }
+    if (MatchByte(control, kEmpty) != 0) return -1;
+    group = (group + 1) & (num_groups - 1);
+  }
+  return -1;
+}
+
+int64_t MemoryMappedHashTableFile::Find(int64_t key) const {
+  const uint64_t word = static_cast<uint64_t>(key);
+  return FindSlot(HashKey(key), [word](uint64_t slot_key) {
+    return slot_key == word;
+  });
+}
+
+int64_t MemoryMappedHashTableFile::Find(StringPiece key) const {
+  return FindSlot(HashKey(key), [this, key](uint64_t slot_key) {
+    StringPiece s;
+    return GetString(slot_key, &s).ok() && s == key;
+  });
+}
+
+bool MemoryMappedHashTableFile::IsFull(int64_t slot) const {
+  return control_[slot] != kEmpty;
+}
+
+Status MemoryMappedHashTableFile::GetString(uint64_t offset,
+                                            StringPiece* s) const {
+  uint32_t length;
+  if (offset > strings_size_ || strings_size_ - offset < sizeof(length)) {
+    return errors::DataLoss("Invalid string offset ", offset,
+                            " in MemoryMappedHashTable file");
+  }
+  memcpy(&length, strings_ + offset, sizeof(length));
+  if (strings_size_ - offset - sizeof(length) < length) {
+    return errors::DataLoss("Invalid string length ", length,
+                            " in MemoryMappedHashTable file");
+  }
+  *s = StringPiece(strings_ + offset + sizeof(length), length);
+  return OkStatus();
+}
+
+Status MemoryMappedHashTableFile::GetKey(int64_t slot, int64_t* key) const {
+  *key = static_cast<int64_t>(slots_[2 * slot]);
+  return OkStatus();
+}
+
+Status MemoryMappedHashTableFile::GetKey(int64_t slot, tstring* key) const {
+  StringPiece s;
+  TF_RETURN_IF_ERROR(GetString(slots_[2 * slot], &s));
+  key->assign(s.data(), s.size());
+  return OkStatus();
+}
+
+Status MemoryMappedHashTableFile::GetValue(int64_t slot,
+                                           int64_t* value) const {
+  *value = static_cast<int64_t>(slots_[2 * slot + 1]);
+  return OkStatus();
+}
+
+Status MemoryMappedHashTableFile::GetValue(int64_t slot,
+                                           tstring* value) const {
+  StringPiece s;
+  TF_RETURN_IF_ERROR(GetString(slots_[2 * slot + 1], &s));
+  value->assign(s.data(), s.size());
+  return OkStatus();
+}
+
+}  // namespace lookup
+}  // namespace tensorflow
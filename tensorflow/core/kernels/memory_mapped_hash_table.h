@@ -0,0 +1,216 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MEMORY_MAPPED_HASH_TABLE_H_
+#define TENSORFLOW_CORE_KERNELS_MEMORY_MAPPED_HASH_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "tensorflow/core/framework/lookup_interface.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A read-only hash table of int64 or string keys and values, in a file built
+// offline by `Write`. The file is memory mapped instead of being loaded, so
+// opening a table doesn't populate it, and the processes which open the same
+// file share its memory through the page cache.
+//
+// The file holds, in little endian:
+// * A 64 bytes header: the magic "TFMMHT01", the key and value dtypes (uint32),
+//   the number of entries, the number of groups of 16 slots and the size of
+//   the string pool (uint64).
+// * One control byte per slot: 0x80 if the slot is empty, or the low 7 bits of
+//   the hash of its key.
+// * Two uint64 words per slot, its key and its value: an int64, or the offset
+//   in the string pool of a uint32 length followed by the bytes of a string.
+// * The string pool.
+//
+// Like a Swiss table, a key is searched in consecutive groups of 16 slots from
+// the group given by its hash, comparing the 16 control bytes of a group to the
+// low 7 bits of the hash at once with SSE2, until a group has an empty slot.
+class MemoryMappedHashTableFile {
+ public:
+  // Maps `filename`, which must hold a table of `key_dtype` keys and
+  // `value_dtype` values.
+  static Status Open(Env* env, const string& filename, DataType key_dtype,
+                     DataType value_dtype,
+                     std::unique_ptr<MemoryMappedHashTableFile>* file);
+
+  // Writes the table of the `keys` and `values` vectors to `filename`. The keys
+  // must be unique.
+  static Status Write(Env* env, const string& filename, const Tensor& keys,
+                      const Tensor& values);
+
+  // Returns the number of entries.
+  int64_t size() const { return num_entries_; }
+
+  // Returns the slot of `key`, or -1 if the table doesn't hold it.
+  int64_t Find(int64_t key) const;
+  int64_t Find(StringPiece key) const;
+
+  // The total number of slots, and whether `slot` holds an entry.
+  int64_t num_slots() const { return num_slots_; }
+  bool IsFull(int64_t slot) const;
+
+  // Returns the key and value of the entry at `slot`. Fails with `DataLoss` if
+  // a string is out of the bounds of the file.
+  Status GetKey(int64_t slot, int64_t* key) const;
+  Status GetKey(int64_t slot, tstring* key) const;
+  Status GetValue(int64_t slot, int64_t* value) const;
+  Status GetValue(int64_t slot, tstring* value) const;
+
+ private:
+  MemoryMappedHashTableFile() = default;
+
+  // Returns the slot of the key of hash `hash` for which `matches` is true.
+  template <typename Matches>
+  int64_t FindSlot(uint64_t hash, const Matches& matches) const;
+
+  // Returns the string at `offset` in the string pool.
+  Status GetString(uint64_t offset, StringPiece* s) const;
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  int64_t num_entries_ = 0;
+  int64_t num_slots_ = 0;
+  const uint8_t* control_ = nullptr;
+  const uint64_t* slots_ = nullptr;
+  const char* strings_ = nullptr;
+  uint64_t strings_size_ = 0;
+};
+
+// Lookup table backed by a `MemoryMappedHashTableFile`, which the op that
+// creates the table gives by its scalar "filename" input. The table is
+// read-only: it is initialized as soon as it is created, and can't be
+// modified.
+template <class K, class V>
+class MemoryMappedHashTable : public LookupInterface {
+ public:
+  MemoryMappedHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    const Tensor* filename;
+    OP_REQUIRES_OK(ctx, ctx->input("filename", &filename));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsScalar(filename->shape()),
+        errors::InvalidArgument("filename should be a single string, but got ",
+                                filename->shape().DebugString()));
+    filename_ = filename->scalar<tstring>()();
+    OP_REQUIRES_OK(ctx, MemoryMappedHashTableFile::Open(
+                            ctx->env(), filename_, key_dtype(), value_dtype(),
+                            &file_));
+  }
+
+  size_t size() const override { return file_->size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& keys, Tensor* values,
+              const Tensor& default_value) override {
+    const auto key_values = keys.flat<K>();
+    auto value_values = values->flat<V>();
+    const auto default_flat = default_value.flat<V>();
+    const bool is_full_size_default =
+        default_flat.size() == value_values.size();
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const int64_t slot = file_->Find(key_values(i));
+      if (slot < 0) {
+        value_values(i) = is_full_size_default ? default_flat(i)
+                                               : default_flat(0);
+      } else {
+        TF_RETURN_IF_ERROR(file_->GetValue(slot, &value_values(i)));
+      }
+    }
+    return OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    return errors::Unimplemented("MemoryMappedHashTable is read-only");
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("MemoryMappedHashTable is read-only");
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    return errors::Unimplemented("MemoryMappedHashTable is read-only");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    const int64_t size = file_->size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    int64_t i = 0;
+    for (int64_t slot = 0; slot < file_->num_slots() && i < size; ++slot) {
+      if (!file_->IsFull(slot)) continue;
+      TF_RETURN_IF_ERROR(file_->GetKey(slot, &keys_data(i)));
+      TF_RETURN_IF_ERROR(file_->GetValue(slot, &values_data(i)));
+      ++i;
+    }
+    if (i != size) {
+      return errors::DataLoss("MemoryMappedHashTable file ", filename_,
+                              " holds ", i, " entries instead of ", size);
+    }
+    return OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  // The entries are in the page cache, not in the memory of the table.
+  int64_t MemoryUsed() const override { return sizeof(*this); }
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
+    Tensor filename(DT_STRING, TensorShape({}));
+    filename.scalar<tstring>()() = filename_;
+    Node* filename_node = ops::SourceOp(
+        "Const", builder->opts()
+                     .WithAttr("dtype", DT_STRING)
+                     .WithAttr("value", filename));
+    *out = ops::UnaryOp("MemoryMappedHashTable", filename_node,
+                        builder->opts()
+                            .WithAttr("key_dtype", key_dtype())
+                            .WithAttr("value_dtype", value_dtype()));
+    return OkStatus();
+  }
+
+ private:
+  string filename_;
+  std::unique_ptr<MemoryMappedHashTableFile> file_;
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MEMORY_MAPPED_HASH_TABLE_H_
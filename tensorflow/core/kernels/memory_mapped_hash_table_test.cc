@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/memory_mapped_hash_table.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+std::string TableFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(MemoryMappedHashTableFileTest, FindsInt64Keys) {
+  const std::string filename = TableFilename("int64_table");
+  constexpr int64_t kNumKeys = 1000;
+  Tensor keys(DT_INT64, TensorShape({kNumKeys}));
+  Tensor values(DT_INT64, TensorShape({kNumKeys}));
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    keys.flat<int64_t>()(i) = i * 7;
+    values.flat<int64_t>()(i) = -i;
+  }
+  TF_ASSERT_OK(
+      MemoryMappedHashTableFile::Write(Env::Default(), filename, keys, values));
+
+  std::unique_ptr<MemoryMappedHashTableFile> file;
+  TF_ASSERT_OK(MemoryMappedHashTableFile::Open(Env::Default(), filename,
+                                               DT_INT64, DT_INT64, &file));
+  EXPECT_EQ(file->size(), kNumKeys);
+  for (int64_t i = 0; i < kNumKeys; ++i) {
+    const int64_t slot = file->Find(i * 7);
+    ASSERT_GE(slot, 0);
+    int64_t key;
+    int64_t value;
+    TF_ASSERT_OK(file->GetKey(slot, &key));
+    TF_ASSERT_OK(file->GetValue(slot, &value));
+    EXPECT_EQ(key, i * 7);
+    EXPECT_EQ(value, -i);
+    EXPECT_EQ(file->Find(i * 7 + 1), -1);
+  }
+}
+
+TEST(MemoryMappedHashTableFileTest, FindsStringKeys) {
+  const std::string filename = TableFilename("string_table");
+  Tensor keys = test::AsTensor<tstring>({"brain", "salad", "", "surgery"});
+  Tensor values = test::AsTensor<tstring>({"0", "11", "222", ""});
+  TF_ASSERT_OK(
+      MemoryMappedHashTableFile::Write(Env::Default(), filename, keys, values));
+
+  std::unique_ptr<MemoryMappedHashTableFile> file;
+  TF_ASSERT_OK(MemoryMappedHashTableFile::Open(Env::Default(), filename,
+                                               DT_STRING, DT_STRING, &file));
+  EXPECT_EQ(file->size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    const int64_t slot = file->Find(StringPiece(keys.flat<tstring>()(i)));
+    ASSERT_GE(slot, 0);
+    tstring value;
+    TF_ASSERT_OK(file->GetValue(slot, &value));
+    EXPECT_EQ(value, values.flat<tstring>()(i));
+  }
+  EXPECT_EQ(file->Find(StringPiece("sale")), -1);
+}
+
+TEST(MemoryMappedHashTableFileTest, WriteRejectsDuplicateKeys) {
+  Tensor keys = test::AsTensor<int64_t>({1, 2, 1});
+  Tensor values = test::AsTensor<int64_t>({10, 20, 30});
+  EXPECT_TRUE(errors::IsInvalidArgument(MemoryMappedHashTableFile::Write(
+      Env::Default(), TableFilename("duplicate_table"), keys, values)));
+}
+
+TEST(MemoryMappedHashTableFileTest, OpenRejectsOtherTypes) {
+  const std::string filename = TableFilename("typed_table");
+  Tensor keys = test::AsTensor<int64_t>({1, 2});
+  Tensor values = test::AsTensor<tstring>({"a", "b"});
+  TF_ASSERT_OK(
+      MemoryMappedHashTableFile::Write(Env::Default(), filename, keys, values));
+
+  std::unique_ptr<MemoryMappedHashTableFile> file;
+  EXPECT_TRUE(errors::IsInvalidArgument(MemoryMappedHashTableFile::Open(
+      Env::Default(), filename, DT_INT64, DT_INT64, &file)));
+  TF_EXPECT_OK(MemoryMappedHashTableFile::Open(Env::Default(), filename,
+                                               DT_INT64, DT_STRING, &file));
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
@@ -158,6 +158,28 @@ TEST_F(RaggedGatherOpTest, RaggedGather_2DIndices) {
       test::AsTensor<float>({.4, .5, .6, .7, .1, .2, .3, .8, .9}), 0.1);
 }
 
+TEST_F(RaggedGatherOpTest, RaggedGather_ConsecutiveIndicesStrings) {
+  // indices = [1, 2, 0, 1]
+  // params = [[a, b], [c], [d, e, f]]
+  // params.shape = [3, None]
+  BuildRaggedGatherGraph<tstring, int32>(
+      TensorShape({4}),                // indices.shape
+      {1, 2, 0, 1},                    // indices
+      {{0, 2, 3, 6}},                  // params_nested_splits
+      TensorShape({6}),                // params_dense_values.shape
+      {"a", "b", "c", "d", "e", "f"}  // params_dense_values
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Expected: [[c], [d, e, f], [a, b], [c]]
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0),
+                                   test::AsTensor<int64_t>({0, 1, 4, 6, 7}));
+  test::ExpectTensorEqual<tstring>(
+      *GetOutput(1),
+      test::AsTensor<tstring>({"c", "d", "e", "f", "a", "b", "c"}));
+}
+
 TEST_F(RaggedGatherOpTest, RaggedGather_ScalarIndices) {
   // indices = 2
   // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
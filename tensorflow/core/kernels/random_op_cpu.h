@@ -72,6 +72,56 @@ struct FillPhiloxRandom {
   }
 };
 
+// Converts a group of four numbers of the Philox generator to the samples of
+// a distribution that takes exactly one group for each output group, like
+// calling the distribution does. Supported for the float and double uniform
+// and normal distributions, so that FillPhiloxRandomTask can generate the
+// groups of many outputs at once with PhiloxRandom::Fill.
+template <class Distribution>
+struct PhiloxGroupConverter {
+  static constexpr bool kSupported = false;
+};
+
+template <>
+struct PhiloxGroupConverter<random::UniformDistribution<PhiloxRandom, float>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType& sample, float* result) {
+    for (int i = 0; i < 4; ++i) {
+      result[i] = random::Uint32ToFloat(sample[i]);
+    }
+  }
+};
+
+template <>
+struct PhiloxGroupConverter<random::UniformDistribution<PhiloxRandom, double>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType& sample, double* result) {
+    for (int i = 0; i < 2; ++i) {
+      result[i] = random::Uint64ToDouble(sample[2 * i], sample[2 * i + 1]);
+    }
+  }
+};
+
+template <>
+struct PhiloxGroupConverter<random::NormalDistribution<PhiloxRandom, float>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType& sample, float* result) {
+    for (int i = 0; i < 4; i += 2) {
+      random::BoxMullerFloat(sample[i], sample[i + 1], &result[i],
+                             &result[i + 1]);
+    }
+  }
+};
+
+template <>
+struct PhiloxGroupConverter<random::NormalDistribution<PhiloxRandom, double>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType& sample, double* result) {
+    random::BoxMullerDouble(sample[0], sample[1], sample[2], sample[3],
+                            &result[0], &result[1]);
+  }
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -90,10 +140,28 @@ struct FillPhiloxRandomTask<Distribution, false> {
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
-      std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
-      offset += kGroupSize;
+    if constexpr (PhiloxGroupConverter<Distribution>::kSupported) {
+      // Generates the numbers of kGroupBatchSize groups at once, which is
+      // vectorized, before converting them.
+      constexpr int64_t kGroupBatchSize = 64;
+      PhiloxRandom::ResultType samples[kGroupBatchSize];
+      for (int64_t index = start_group; index < limit_group_full;
+           index += kGroupBatchSize) {
+        const int64_t batch_size =
+            std::min(kGroupBatchSize, limit_group_full - index);
+        gen.Fill(samples, batch_size);
+        for (int64_t i = 0; i < batch_size; ++i) {
+          PhiloxGroupConverter<Distribution>::Convert(samples[i],
+                                                      data + offset);
+          offset += kGroupSize;
+        }
+      }
+    } else {
+      for (int64_t index = start_group; index < limit_group_full; ++index) {
+        auto samples = dist(&gen);
+        std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+        offset += kGroupSize;
+      }
     }
 
     // If there are any remaining elements that need to be filled, process them
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/reduction_ops.h"
+#include "tensorflow/core/kernels/reduction_ops_cpu.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -193,6 +194,10 @@ class ReductionOp : public OpKernel {
         // 3)), [0]). Eigen sometimes crashes in this case, so we do it
         // manually.
         Functor::FillIdentity(d, tmp_out.flat<T>(), reducer);
+      } else if (functor::ReduceMiddleAxis<Device, T, Reducer>(
+                     ctx, helper.data_reshape(), helper.reduce_first_axis(),
+                     data, &tmp_out)) {
+        // Reduced the non-innermost axis of a 2-D or 3-D tensor on the CPU.
       } else if ((helper.ndims() == 1) && helper.reduce_first_axis()) {
         // Reduce to a scalar.
         Functor::Reduce(ctx, helper.out<T, 0>(&tmp_out), helper.in<T, 1>(data),
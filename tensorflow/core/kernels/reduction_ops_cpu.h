@@ -0,0 +1,262 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_CPU_H_
+#define TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_CPU_H_
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/reduction_ops.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The reducers for which ReduceMiddleAxis has a CPU kernel. Accumulator is
+// the Eigen reducer combining the values, and kIsMean tells whether the result
+// is divided by the number of reduced values.
+template <typename Reducer>
+struct MiddleAxisReducerTraits {
+  static constexpr bool kSupported = false;
+};
+
+template <typename T>
+struct MiddleAxisReducerTraits<Eigen::internal::SumReducer<T>> {
+  static constexpr bool kSupported =
+      std::is_same<T, float>::value || std::is_same<T, double>::value;
+  static constexpr bool kIsMean = false;
+  typedef Eigen::internal::SumReducer<T> Accumulator;
+};
+
+template <typename T>
+struct MiddleAxisReducerTraits<MeanReducer<T>> {
+  static constexpr bool kSupported =
+      std::is_same<T, float>::value || std::is_same<T, double>::value;
+  static constexpr bool kIsMean = true;
+  typedef Eigen::internal::SumReducer<T> Accumulator;
+};
+
+template <typename T>
+struct MiddleAxisReducerTraits<
+    Eigen::internal::MaxReducer<T, Eigen::PropagateNaN>> {
+  static constexpr bool kSupported =
+      std::is_same<T, float>::value || std::is_same<T, double>::value;
+  static constexpr bool kIsMean = false;
+  typedef Eigen::internal::MaxReducer<T, Eigen::PropagateNaN> Accumulator;
+};
+
+template <typename T>
+struct MiddleAxisReducerTraits<
+    Eigen::internal::MinReducer<T, Eigen::PropagateNaN>> {
+  static constexpr bool kSupported =
+      std::is_same<T, float>::value || std::is_same<T, double>::value;
+  static constexpr bool kIsMean = false;
+  typedef Eigen::internal::MinReducer<T, Eigen::PropagateNaN> Accumulator;
+};
+
+namespace middle_axis {
+
+// The rows of a column tile are accumulated in registers by blocks of this
+// many rows, and the results of the blocks are combined pairwise, so that the
+// rounding error of a float sum grows with the logarithm of the number of
+// rows instead of linearly.
+constexpr int64_t kBlockRows = 128;
+// Enough levels of pairwise combination for any number of rows.
+constexpr int kMaxLevels = 64;
+// The number of packets of adjacent columns accumulated together.
+constexpr int kTilePackets = 4;
+// Splitting the reduced axis between threads adds a pass over the partial
+// results, which is only worth it with at least this many rows per thread.
+constexpr int64_t kMinRowsPerSplit = 4 * kBlockRows;
+// Smaller inputs are reduced by Eigen.
+constexpr int64_t kMinElements = 16384;
+
+// Reduces `rows` rows of kNumPackets packets of adjacent columns, the first
+// one at `in` and the next ones `stride` elements apart, into `out`.
+template <typename Packet, int kNumPackets, typename T, typename Accumulator>
+void ReduceColumns(const Accumulator& accumulator, const T* in, int64_t stride,
+                   int64_t rows, T* out) {
+  constexpr int kPacketSize = Eigen::internal::unpacket_traits<Packet>::size;
+  Packet levels[kMaxLevels][kNumPackets];
+  int64_t num_blocks = 0;
+  for (int64_t begin = 0; begin < rows; begin += kBlockRows) {
+    const int64_t end = std::min(rows, begin + kBlockRows);
+    Packet acc[kNumPackets];
+    for (int p = 0; p < kNumPackets; ++p) {
+      acc[p] = accumulator.template initializePacket<Packet>();
+    }
+    for (int64_t r = begin; r < end; ++r) {
+      const T* row = in + r * stride;
+      for (int p = 0; p < kNumPackets; ++p) {
+        accumulator.reducePacket(
+            Eigen::internal::ploadu<Packet>(row + p * kPacketSize), &acc[p]);
+      }
+    }
+    // Like in a binary counter, the block is combined with the results of
+    // the previous blocks covering as many rows as it does so far.
+    int level = 0;
+    for (int64_t n = num_blocks; n & 1; n >>= 1, ++level) {
+      for (int p = 0; p < kNumPackets; ++p) {
+        accumulator.reducePacket(levels[level][p], &acc[p]);
+      }
+    }
+    for (int p = 0; p < kNumPackets; ++p) levels[level][p] = acc[p];
+    ++num_blocks;
+  }
+  Packet acc[kNumPackets];
+  for (int p = 0; p < kNumPackets; ++p) {
+    acc[p] = accumulator.template initializePacket<Packet>();
+  }
+  for (int level = 0; num_blocks != 0; num_blocks >>= 1, ++level) {
+    if ((num_blocks & 1) == 0) continue;
+    for (int p = 0; p < kNumPackets; ++p) {
+      accumulator.reducePacket(levels[level][p], &acc[p]);
+    }
+  }
+  for (int p = 0; p < kNumPackets; ++p) {
+    Eigen::internal::pstoreu(out + p * kPacketSize, acc[p]);
+  }
+}
+
+}  // namespace middle_axis
+
+// Reduces the middle axis of `data` reshaped to [outer, reduce, inner] into
+// `out`, holding outer * inner values, which covers the reductions of the
+// non-innermost axes that Eigen's generic reducer is slow for. `data_reshape`
+// and `reduce_first_axis` come from the ReductionHelper of the op. Returns
+// false, without touching `out`, if the reduction is not of that form, or if
+// there is no specialized kernel for the device or reducer.
+//
+// The inner axis is split in tiles of adjacent columns, and each tile
+// accumulates the reduced rows in SIMD registers. When there are fewer tiles
+// than threads, the reduced axis is also split between the threads, and their
+// partial results are combined at the end.
+template <typename Device, typename T, typename Reducer>
+bool ReduceMiddleAxis(OpKernelContext* ctx, const TensorShape& data_reshape,
+                      bool reduce_first_axis, const Tensor& data, Tensor* out) {
+  if constexpr (!std::is_same<Device, Eigen::ThreadPoolDevice>::value ||
+                !MiddleAxisReducerTraits<Reducer>::kSupported) {
+    return false;
+  } else {
+    typedef MiddleAxisReducerTraits<Reducer> Traits;
+    typedef typename Eigen::internal::packet_traits<T>::type Packet;
+    constexpr int64_t kPacketSize =
+        Eigen::internal::unpacket_traits<Packet>::size;
+    constexpr int64_t kTileSize = middle_axis::kTilePackets * kPacketSize;
+
+    int64_t outer, reduce, inner;
+    if (data_reshape.dims() == 2 && reduce_first_axis) {
+      outer = 1;
+      reduce = data_reshape.dim_size(0);
+      inner = data_reshape.dim_size(1);
+    } else if (data_reshape.dims() == 3 && !reduce_first_axis) {
+      outer = data_reshape.dim_size(0);
+      reduce = data_reshape.dim_size(1);
+      inner = data_reshape.dim_size(2);
+    } else {
+      return false;
+    }
+    if (inner < kPacketSize || data.NumElements() < middle_axis::kMinElements) {
+      return false;
+    }
+
+    const typename Traits::Accumulator accumulator;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_tiles = Eigen::divup(inner, kTileSize);
+    int64_t num_splits = 1;
+    if (outer * num_tiles < worker_threads.num_threads) {
+      num_splits = std::min<int64_t>(
+          Eigen::divup<int64_t>(worker_threads.num_threads, outer * num_tiles),
+          std::max<int64_t>(1, reduce / middle_axis::kMinRowsPerSplit));
+    }
+    const int64_t rows_per_split = Eigen::divup(reduce, num_splits);
+    const int64_t out_size = outer * inner;
+    std::vector<T> partials(num_splits > 1 ? num_splits * out_size : 0);
+
+    const T* in = data.flat<T>().data();
+    T* out_data = out->flat<T>().data();
+    auto reduce_tiles = [&](int64_t begin, int64_t end) {
+      for (int64_t unit = begin; unit < end; ++unit) {
+        const int64_t split = unit % num_splits;
+        const int64_t tile = (unit / num_splits) % num_tiles;
+        const int64_t o = unit / (num_splits * num_tiles);
+        const int64_t row_begin = std::min(reduce, split * rows_per_split);
+        const int64_t rows =
+            std::min(reduce, row_begin + rows_per_split) - row_begin;
+        const int64_t col_end = std::min(inner, (tile + 1) * kTileSize);
+        const T* src = in + (o * reduce + row_begin) * inner;
+        T* dst = (num_splits > 1 ? partials.data() + split * out_size
+                                 : out_data) +
+                 o * inner;
+        int64_t c = tile * kTileSize;
+        if (c + kTileSize <= col_end) {
+          middle_axis::ReduceColumns<Packet, middle_axis::kTilePackets>(
+              accumulator, src + c, inner, rows, dst + c);
+          c += kTileSize;
+        }
+        for (; c + kPacketSize <= col_end; c += kPacketSize) {
+          middle_axis::ReduceColumns<Packet, 1>(accumulator, src + c, inner,
+                                                rows, dst + c);
+        }
+        for (; c < col_end; ++c) {
+          middle_axis::ReduceColumns<T, 1>(accumulator, src + c, inner, rows,
+                                           dst + c);
+        }
+      }
+    };
+    const int64_t cost_per_unit =
+        rows_per_split * kTileSize *
+        (Eigen::TensorOpCost::AddCost<T>() + sizeof(T));
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          outer * num_tiles * num_splits, cost_per_unit, reduce_tiles);
+
+    auto out_flat = out->flat<T>();
+    if (num_splits > 1) {
+      auto combine_splits = [&](int64_t begin, int64_t end) {
+        std::copy(partials.data() + begin, partials.data() + end,
+                  out_data + begin);
+        for (int64_t split = 1; split < num_splits; ++split) {
+          const T* partial = partials.data() + split * out_size;
+          for (int64_t i = begin; i < end; ++i) {
+            accumulator.reduce(partial[i], &out_data[i]);
+          }
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers, out_size,
+            num_splits * (Eigen::TensorOpCost::AddCost<T>() + sizeof(T)),
+            combine_splits);
+    }
+    if (Traits::kIsMean) {
+      out_flat.device(ctx->eigen_device<Device>()) =
+          out_flat / static_cast<T>(reduce);
+    }
+    return true;
+  }
+}
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_CPU_H_
@@ -248,6 +248,33 @@ static void BM_Bool2DToScalarGPU(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Bool2DToScalarGPU)->RangePair(2048, 8192, 2048, 8192);
 
+static void BM_Sum2DColumnReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoColReduce(state, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DColumnReduceCPU)
+    ->ArgPair(1 << 20, 128)
+    ->ArgPair(1 << 16, 1024)
+    ->ArgPair(1024, 1 << 16);
+
+static void BM_Max2DColumnReduceCPU(::testing::benchmark::State& state) {
+  const int num_x = state.range(0);
+  const int num_y = state.range(1);
+
+  DoColReduce(state, "cpu", "Max", num_x, num_y);
+}
+BENCHMARK(BM_Max2DColumnReduceCPU)->ArgPair(1 << 20, 128);
+
+static void BM_Mean3DYReduceCPU(::testing::benchmark::State& state) {
+  const int num_y = state.range(0);
+  const int num_z = state.range(1);
+
+  Do3DYReduce(state, "cpu", "Mean", num_y, num_z);
+}
+BENCHMARK(BM_Mean3DYReduceCPU)->RangePair(64, 4096, 64, 4096);
+
 static void BM_Mean2DToScalarCPUBF16(::testing::benchmark::State& state) {
   const int num_x = state.range(0);
   const int num_y = state.range(1);
@@ -173,6 +173,9 @@ void DoRoll(const OpKernelContext* context, const int64_t num_elements,
   auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
   // 15 - experimentally determined with float and bool types
   const int cost_per_element = 15 * sizeof(T);  // rough estimate
+  // The estimate is then replaced by the measured cost, per element type.
+  static const char kCallSite[] = "DoRoll";
+  ScopedAdaptiveSharding adaptive_sharding(kCallSite);
   Shard(worker_threads->num_threads, worker_threads->workers, num_elements,
         cost_per_element, std::move(work));
 }
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -355,10 +357,54 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
   DataType dtype;
+  // The approximate size of the restored tensor, for splitting the reads.
+  int64_t estimated_bytes = 0;
 
   ::tensorflow::Status status;
 };
 
+// The number of data file reads that RestoreTensorsV2 issues concurrently.
+int64_t RestoreIoDepth() {
+  static const int64_t io_depth = [] {
+    int64_t value;
+    Status s = ReadInt64FromEnvVar("TF_RESTORE_IO_DEPTH",
+                                   /*default_val=*/8, &value);
+    if (!s.ok() || value < 1) {
+      LOG(WARNING) << "Ignoring invalid TF_RESTORE_IO_DEPTH: " << s;
+      value = 8;
+    }
+    return value;
+  }();
+  return io_depth;
+}
+
+// Small tensors are only read on separate readers in ranges of at least this
+// many bytes, so that the reads stay large enough to be sequential.
+constexpr int64_t kMinConcurrentReadBytes = 64 << 20;
+
+// Splits `ops`, sorted for sequential access, into at most `max_ranges`
+// contiguous ranges of about the same number of bytes.
+std::vector<std::vector<RestoreOp*>> SplitIntoReadRanges(
+    const std::vector<RestoreOp*>& ops, int64_t max_ranges) {
+  int64_t total_bytes = 0;
+  for (const RestoreOp* op : ops) total_bytes += op->estimated_bytes;
+  const int64_t num_ranges = std::max<int64_t>(
+      1, std::min(max_ranges, total_bytes / kMinConcurrentReadBytes));
+  const int64_t range_bytes = total_bytes / num_ranges;
+
+  std::vector<std::vector<RestoreOp*>> ranges(1);
+  int64_t bytes = 0;
+  for (RestoreOp* op : ops) {
+    if (bytes >= range_bytes && ranges.size() < num_ranges) {
+      ranges.emplace_back();
+      bytes = 0;
+    }
+    ranges.back().push_back(op);
+    bytes += op->estimated_bytes;
+  }
+  return ranges;
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
@@ -384,7 +430,7 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       restore_ops, [](const RestoreOp& op) { return op.tensor_name; }));
 
   std::vector<string> mismatched_errors;
-  for (const RestoreOp& restore_op : restore_ops) {
+  for (RestoreOp& restore_op : restore_ops) {
     TensorShape restored_full_shape;
     DataType original_dtype;
     TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
@@ -396,6 +442,10 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
           DataTypeString(original_dtype));
       mismatched_errors.emplace_back(error_msg);
     }
+    restore_op.estimated_bytes =
+        restored_full_shape.num_elements() *
+        (DataTypeCanUseMemcpy(original_dtype) ? DataTypeSize(original_dtype)
+                                              : sizeof(tstring));
   }
   if (!mismatched_errors.empty()) {
     const string error_msg = absl::StrJoin(mismatched_errors, "\n");
@@ -412,21 +462,40 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     }
   }
 
+  // The small tensors are read in contiguous ranges of the data files, the
+  // first one on the op thread and the others on their own readers, so that
+  // up to `RestoreIoDepth()` reads are in flight when there is enough to read.
+  std::vector<std::vector<RestoreOp*>> read_ranges =
+      SplitIntoReadRanges(direct_restore_ops, RestoreIoDepth());
+  std::vector<Status> read_range_statuses(read_ranges.size());
+
   {
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
+    if (!pool_restore_ops.empty() || read_ranges.size() > 1) {
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors", RestoreIoDepth()));
       for (auto* op : pool_restore_ops) {
         reader_pool->Schedule([op]() { op->run_with_new_reader(); });
       }
+      for (int i = 1; i < read_ranges.size(); ++i) {
+        reader_pool->Schedule([&prefix_string, range = &read_ranges[i],
+                               status = &read_range_statuses[i]]() {
+          BundleReader reader(Env::Default(), prefix_string);
+          *status = reader.status();
+          for (auto* op : *range) {
+            if (!status->ok()) return;
+            *status = op->run(&reader);
+          }
+        });
+      }
     }
 
-    // Read small tensors from the op thread
-    for (auto* op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
+    // Read the first range of small tensors from the op thread.
+    for (auto* op : read_ranges[0]) {
+      read_range_statuses[0] = op->run(&default_reader);
+      if (!read_range_statuses[0].ok()) break;
     }
   }
 
@@ -434,6 +503,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto* op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
+  for (const Status& status : read_range_statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
 
   for (const RestoreOp& restore_op : restore_ops) {
     if (restore_op.dtype != context->mutable_output(restore_op.idx)->dtype()) {
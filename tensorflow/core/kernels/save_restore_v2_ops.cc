@@ -15,24 +15,34 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <algorithm>
 #include <cstddef>
 #include <limits>
+#include <memory>
+#include <numeric>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"  // IWYU pragma: keep
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -90,12 +100,193 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Adds "tensor" to "writer" under "tensor_name", as the slice described by
+// "shape_and_slice" if it is not empty.
+Status SaveTensor(BundleWriter* writer, const string& tensor_name,
+                  const string& shape_and_slice, const Tensor& tensor) {
+  VLOG(2) << "Starting save of " << tensor_name;
+
+  if (!shape_and_slice.empty()) {
+    TensorShape shape;
+    TensorSlice slice(tensor.dims());
+    TensorShape slice_shape;
+
+    TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_and_slice, &shape,
+                                                      &slice, &slice_shape));
+    if (!slice_shape.IsSameSize(tensor.shape())) {
+      return errors::InvalidArgument(
+          "Slice in shape_and_slice specification does not match the shape of "
+          "the tensor to  save: ",
+          shape_and_slice, ", tensor: ", tensor.shape().DebugString());
+    }
+
+    TF_RETURN_IF_ERROR(writer->AddSlice(tensor_name, shape, slice, tensor));
+  } else {
+    TF_RETURN_IF_ERROR(writer->Add(tensor_name, tensor));
+  }
+
+  if (VLOG_IS_ON(5)) {
+    if (tensor.dtype() == DT_FLOAT) {
+      const float* t_data = tensor.flat<float>().data();
+      float min = std::numeric_limits<float>::infinity();
+      float max = -std::numeric_limits<float>::infinity();
+      double avg = 0.0;
+      for (int i = 0; i < tensor.NumElements(); ++i) {
+        if (t_data[i] < min) min = t_data[i];
+        if (t_data[i] > max) max = t_data[i];
+        avg += t_data[i];
+      }
+      VLOG(5) << " min " << min << " max " << max << " avg "
+              << avg / tensor.NumElements() << " total elts "
+              << tensor.NumElements();
+    }
+  }
+
+  VLOG(2) << "Done save of " << tensor_name;
+  return OkStatus();
+}
+
+// Each of the parallel writers of SaveV2 writes at least this many bytes, so
+// that small checkpoints keep a single data file.
+constexpr int64_t kMinBytesPerWriter = 16 << 20;
+
+// The tensors that a SaveV2 op writes to the bundle at `prefix`.
+struct SaveRequest {
+  string prefix;
+  std::vector<string> tensor_names;
+  std::vector<string> shape_and_slices;
+  std::vector<Tensor> tensors;
+};
+
+// Returns the indices of the tensors that each of up to `max_writers` writers
+// saves, balancing the number of bytes written by each of them.
+std::vector<std::vector<int>> PartitionForWriters(const SaveRequest& request,
+                                                  int64_t max_writers) {
+  const int num_tensors = static_cast<int>(request.tensors.size());
+  // The tensors of each name, with their total size.
+  absl::flat_hash_map<absl::string_view, int> name_indices;
+  std::vector<std::pair<int64_t, std::vector<int>>> names;
+  int64_t total_bytes = 0;
+  for (int i = 0; i < num_tensors; ++i) {
+    const int64_t bytes = request.tensors[i].TotalBytes();
+    auto it = name_indices.emplace(request.tensor_names[i], names.size()).first;
+    if (it->second == static_cast<int>(names.size())) names.emplace_back();
+    names[it->second].first += bytes;
+    names[it->second].second.push_back(i);
+    total_bytes += bytes;
+  }
+
+  const int64_t num_writers = std::max<int64_t>(
+      1, std::min<int64_t>({max_writers, total_bytes / kMinBytesPerWriter,
+                            static_cast<int64_t>(names.size())}));
+  if (num_writers == 1) {
+    std::vector<int> all_tensors(num_tensors);
+    std::iota(all_tensors.begin(), all_tensors.end(), 0);
+    return {std::move(all_tensors)};
+  }
+
+  // Assigns the largest remaining tensors to the least loaded writer.
+  std::sort(names.begin(), names.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+  std::vector<std::vector<int>> writer_tensors(num_writers);
+  std::vector<int64_t> writer_bytes(num_writers, 0);
+  for (auto& [bytes, tensors] : names) {
+    const int writer =
+        std::min_element(writer_bytes.begin(), writer_bytes.end()) -
+        writer_bytes.begin();
+    writer_bytes[writer] += bytes;
+    writer_tensors[writer].insert(writer_tensors[writer].end(),
+                                  tensors.begin(), tensors.end());
+  }
+  return writer_tensors;
+}
+
+// Writes the tensors of `request` with up to `max_writers` parallel writers.
+Status WriteBundles(const SaveRequest& request, int64_t max_writers) {
+  const std::vector<std::vector<int>> writer_tensors =
+      PartitionForWriters(request, max_writers);
+  auto write_bundle = [&request](const string& bundle_prefix,
+                                 const std::vector<int>& tensors) {
+    BundleWriter writer(Env::Default(), bundle_prefix);
+    TF_RETURN_IF_ERROR(writer.status());
+    VLOG(1) << "BundleWriter, prefix_string: " << bundle_prefix;
+    for (int i : tensors) {
+      TF_RETURN_IF_ERROR(SaveTensor(&writer, request.tensor_names[i],
+                                    request.shape_and_slices[i],
+                                    request.tensors[i]));
+    }
+    TF_RETURN_IF_ERROR(writer.Finish());
+    VLOG(1) << "Done BundleWriter, prefix_string: " << bundle_prefix;
+    return OkStatus();
+  };
+
+  if (writer_tensors.size() == 1) {
+    return write_bundle(request.prefix, writer_tensors[0]);
+  }
+  std::vector<tstring> part_prefixes;
+  for (int i = 0; i < writer_tensors.size(); ++i) {
+    part_prefixes.push_back(strings::StrCat(request.prefix, "_temp_part-", i,
+                                            "-of-", writer_tensors.size()));
+  }
+  std::vector<Status> statuses(writer_tensors.size());
+  {
+    thread::ThreadPool writer_pool(Env::Default(), "save_tensors",
+                                   writer_tensors.size());
+    for (int i = 0; i < writer_tensors.size(); ++i) {
+      writer_pool.Schedule([&, i]() {
+        statuses[i] = write_bundle(part_prefixes[i], writer_tensors[i]);
+      });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return MergeBundles(Env::Default(), part_prefixes, request.prefix,
+                      /*allow_missing_files=*/false);
+}
+
+// Waits for the asynchronous saves of the bundle at `prefix`, if any.
+Status WaitForAsyncSaves(OpKernelContext* context, absl::string_view prefix) {
+  ResourceMgr* resource_manager = context->resource_manager();
+  if (resource_manager == nullptr) return OkStatus();
+  checkpoint::AsyncCheckpointWriter* async_writer;
+  Status status = resource_manager->Lookup<checkpoint::AsyncCheckpointWriter>(
+      resource_manager->default_container(),
+      std::string(checkpoint::kAsyncCheckpointWriterResourceName),
+      &async_writer);
+  if (errors::IsNotFound(status)) return OkStatus();
+  TF_RETURN_IF_ERROR(status);
+  status = async_writer->WaitForPrefix(prefix);
+  async_writer->Unref();
+  return status;
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
+//
+// When the environment variable TF_SAVE_V2_NUM_WRITERS is greater than 1, the
+// tensors are spread over up to that many BundleWriters, which write and
+// checksum their own data files in parallel, and the bundles are then merged
+// under the requested prefix.  All the slices of a tensor go to the same
+// writer.
+//
+// When the environment variable TF_SAVE_V2_MAX_PENDING_ASYNC_SAVES is
+// positive, the bundle is written by the AsyncCheckpointWriter of the
+// resource manager after the op returns, with at most that many saves
+// pending.  MergeV2Checkpoints and RestoreV2 wait for the pending saves of
+// their prefixes, and report their errors.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_SAVE_V2_NUM_WRITERS",
+                                                /*default_val=*/1,
+                                                &num_writers_));
+    OP_REQUIRES_OK(context,
+                   ReadInt64FromEnvVar("TF_SAVE_V2_MAX_PENDING_ASYNC_SAVES",
+                                       /*default_val=*/0,
+                                       &max_pending_async_saves_));
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -111,59 +302,42 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
+    auto request = std::make_shared<SaveRequest>();
+    request->prefix = prefix_string;
+    request->tensor_names.reserve(num_tensors);
+    request->shape_and_slices.reserve(num_tensors);
+    request->tensors.reserve(num_tensors);
     for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
-
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
-      }
-
-      VLOG(2) << "Done save of " << tensor_name;
+      request->tensor_names.push_back(tensor_names_flat(i));
+      request->shape_and_slices.push_back(shape_and_slices_flat(i));
+      request->tensors.push_back(context->input(i + kFixedInputs));
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
 
     ResourceMgr* resource_manager = context->resource_manager();
+    if (max_pending_async_saves_ > 0 && resource_manager != nullptr) {
+      checkpoint::AsyncCheckpointWriter* async_writer;
+      OP_REQUIRES_OK(
+          context,
+          resource_manager->LookupOrCreate<checkpoint::AsyncCheckpointWriter>(
+              resource_manager->default_container(),
+              std::string(checkpoint::kAsyncCheckpointWriterResourceName),
+              &async_writer,
+              [this](checkpoint::AsyncCheckpointWriter** out) {
+                *out = new checkpoint::AsyncCheckpointWriter(
+                    max_pending_async_saves_);
+                return OkStatus();
+              }));
+      // The tensors are shared with the variables, which copy them on
+      // their next update.
+      async_writer->Schedule(prefix_string,
+                             [request, num_writers = num_writers_]() {
+                               return WriteBundles(*request, num_writers);
+                             });
+      async_writer->Unref();
+    } else {
+      OP_REQUIRES_OK(context, WriteBundles(*request, num_writers_));
+    }
+
     if (resource_manager != nullptr) {
       checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
       OP_REQUIRES_OK(
@@ -182,6 +356,10 @@ class SaveV2 : public OpKernel {
       checkpoint_callback_manager->Unref();
     }
   }
+
+ private:
+  int64_t num_writers_;
+  int64_t max_pending_async_saves_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -205,6 +383,7 @@ class RestoreV2 : public OpKernel {
     if (!context->status().ok()) return;
 
     const string& prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(context, WaitForAsyncSaves(context, prefix_string));
 
     VLOG(2) << "Started Restore at prefix: " << prefix_string;
     // Intention: we plan to use the RestoreV2 op as a backward-compatible
@@ -287,6 +466,9 @@ class MergeV2Checkpoints : public OpKernel {
         gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
     Env* env = Env::Default();
     const string& merged_prefix = destination_prefix.scalar<tstring>()();
+    for (const tstring& input_prefix : input_prefixes) {
+      OP_REQUIRES_OK(context, WaitForAsyncSaves(context, input_prefix));
+    }
     OP_REQUIRES_OK(context,
                    tensorflow::MergeBundles(env, input_prefixes, merged_prefix,
                                             allow_missing_files_));
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <stdlib.h>
+
 #include <complex>
 #include <string>
 
@@ -22,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/async_checkpoint_writer.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -29,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -340,5 +344,84 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+TEST_F(SaveV2OpTest, ParallelWriters) {
+  setenv("TF_SAVE_V2_NUM_WRITERS", "4", /*overwrite=*/1);
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_FLOAT, DT_FLOAT, DT_INT32}))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  unsetenv("TF_SAVE_V2_NUM_WRITERS");
+
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_parallel");
+  const string tensornames[] = {"tensor_large_0", "tensor_large_1",
+                                "tensor_small"};
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({3}), [&tensornames](int x) -> tstring {
+    return tensornames[x];
+  });
+  AddInput<tstring>(TensorShape({3}), [](int x) -> tstring { return ""; });
+  // The two large tensors are enough for two writers.
+  AddInput<float>(TensorShape({4 << 20}),
+                  [](int x) -> float { return static_cast<float>(x); });
+  AddInput<float>(TensorShape({4 << 20}),
+                  [](int x) -> float { return static_cast<float>(-x); });
+  AddInput<int32>(TensorShape({10}), [](int x) -> int32 { return x + 1; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  // Each writer wrote its own data file.
+  TF_EXPECT_OK(Env::Default()->FileExists(DataFilename(prefix, 0, 2)));
+  TF_EXPECT_OK(Env::Default()->FileExists(DataFilename(prefix, 1, 2)));
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_large_0", &val));
+  EXPECT_EQ(12345.0f, val.flat<float>()(12345));
+  TF_ASSERT_OK(reader.Lookup("tensor_large_1", &val));
+  EXPECT_EQ(-12345.0f, val.flat<float>()(12345));
+  TF_ASSERT_OK(reader.Lookup("tensor_small", &val));
+  EXPECT_EQ(10, val.flat<int32>()(9));
+}
+
+TEST_F(SaveV2OpTest, AsyncSave) {
+  setenv("TF_SAVE_V2_MAX_PENDING_ASYNC_SAVES", "1", /*overwrite=*/1);
+  TF_ASSERT_OK(NodeDefBuilder("myop", "SaveV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Input(FakeInput({DT_INT32}))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  unsetenv("TF_SAVE_V2_MAX_PENDING_ASYNC_SAVES");
+
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_async");
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInput<tstring>(TensorShape({1}),
+                    [](int x) -> tstring { return "tensor_int"; });
+  AddInput<tstring>(TensorShape({1}), [](int x) -> tstring { return ""; });
+  AddInput<int32>(TensorShape({10}), [](int x) -> int32 { return x + 1; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  ResourceMgr* rm = device_->resource_manager();
+  checkpoint::AsyncCheckpointWriter* async_writer;
+  TF_ASSERT_OK(rm->Lookup<checkpoint::AsyncCheckpointWriter>(
+      rm->default_container(),
+      std::string(checkpoint::kAsyncCheckpointWriterResourceName),
+      &async_writer));
+  TF_EXPECT_OK(async_writer->WaitForPrefix(prefix));
+  async_writer->Unref();
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("tensor_int", &val));
+  EXPECT_EQ(10, val.flat<int32>()(9));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -122,7 +122,14 @@ class ScopedAllocatorConcatOp : public OpKernel {
                                         shape_.num_elements()));
     Tensor output(dtype_);
     if (reshape_) {
-      CHECK(output.CopyFrom(backing_tensor, shape_));
+      // The last field may be followed by alignment padding which is not part
+      // of the reshaped output.
+      if (backing_tensor.NumElements() > shape_.num_elements()) {
+        CHECK(output.CopyFrom(backing_tensor.Slice(0, shape_.num_elements()),
+                              shape_));
+      } else {
+        CHECK(output.CopyFrom(backing_tensor, shape_));
+      }
     } else {
       CHECK(output.CopyFrom(backing_tensor, backing_tensor.shape()));
     }
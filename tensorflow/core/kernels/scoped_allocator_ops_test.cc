@@ -184,10 +184,11 @@ class ScopedAllocatorConcatOpTest : public OpsTestBase {
     const Tensor& output = *(output_list[0]);
     CHECK_EQ(DMAHelper::base(&input), DMAHelper::base(&output));
     CHECK_EQ(input.dtype(), output.dtype());
-    CHECK_EQ(input.NumElements(), output.NumElements());
     if (reshape_) {
+      CHECK_EQ(shape_.num_elements(), output.NumElements());
       CHECK_EQ(shape_, output.shape());
     } else {
+      CHECK_EQ(input.NumElements(), output.NumElements());
       TensorShape expected_shape({input.NumElements()});
       CHECK_EQ(expected_shape, output.shape());
     }
@@ -226,6 +227,15 @@ TEST_F(ScopedAllocatorConcatOpTest, Reshape) {
   ExecOp(DT_DOUBLE, 120, {{2, 4}, {2, 4}});
 }
 
+TEST_F(ScopedAllocatorConcatOpTest, ReshapeWithTrailingPadding) {
+  MakeOp({2, 12}, DT_FLOAT, true, "test", 120, 2);
+
+  // The first field is exactly kAllocatorAlignment bytes, so the fields are
+  // contiguous.  The last field is padded, and the padding is dropped from the
+  // reshaped output.
+  ExecOp(DT_FLOAT, 120, {{16}, {8}});
+}
+
 TEST_F(ScopedAllocatorConcatOpTest, NoReshapeAttr) {
   BuildNodeDef({3, 4, 4}, DT_HALF, "test", 120, 3);
   TF_EXPECT_OK(InitOp());
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/fill_functor.h"
+#include "tensorflow/core/kernels/sorted_search.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/threadpool.h"
@@ -45,10 +46,8 @@ struct UpperBoundFunctor<CPUDevice, T, OutType> {
         const T* sorted_inputs_ptr = sorted_inputs.data() + b * num_inputs;
         OutType* output_ptr = output->data() + b * num_values;
         for (int i = first; i < last; ++i) {
-          output_ptr[i] = std::upper_bound(sorted_inputs_ptr,
-                                           sorted_inputs_ptr + num_inputs,
-                                           values(i + b * num_values)) -
-                          sorted_inputs_ptr;
+          output_ptr[i] = sorted_search::UpperBound(
+              sorted_inputs_ptr, num_inputs, values(i + b * num_values));
         }
       }
     };
@@ -74,10 +73,8 @@ struct LowerBoundFunctor<CPUDevice, T, OutType> {
         const T* sorted_inputs_ptr = sorted_inputs.data() + b * num_inputs;
         OutType* output_ptr = output->data() + b * num_values;
         for (int i = first; i < last; ++i) {
-          output_ptr[i] = std::lower_bound(sorted_inputs_ptr,
-                                           sorted_inputs_ptr + num_inputs,
-                                           values(i + b * num_values)) -
-                          sorted_inputs_ptr;
+          output_ptr[i] = sorted_search::LowerBound(
+              sorted_inputs_ptr, num_inputs, values(i + b * num_values));
         }
       }
     };
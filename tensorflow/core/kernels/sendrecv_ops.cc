@@ -77,6 +77,10 @@ SendOp::SendOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  int64_t rendezvous_slot;
+  if (ctx->GetAttr("_rendezvous_slot", &rendezvous_slot).ok()) {
+    parsed_key_.set_slot(rendezvous_slot);
+  }
 }
 
 void SendOp::Compute(OpKernelContext* ctx) {
@@ -158,6 +162,10 @@ RecvOp::RecvOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
   if (!ctx->GetAttr("_hostmem_sendrecv", &hostmem_sendrecv_).ok()) {
     hostmem_sendrecv_ = false;
   }
+  int64_t rendezvous_slot;
+  if (ctx->GetAttr("_rendezvous_slot", &rendezvous_slot).ok()) {
+    parsed_key_.set_slot(rendezvous_slot);
+  }
 }
 
 string RecvOp::TraceString(const OpKernelContext& ctx, bool verbose) const {
@@ -18,6 +18,10 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -30,18 +34,96 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from SoftmaxEigenImpl.
+// Partial specialization for a CPUDevice, which computes each row in two
+// passes over memory and with one exponential per logit, instead of the
+// separate passes of SoftmaxEigenImpl for the maximum, the exponentials, their
+// sum and the normalization.
+//
+// The first pass goes over the row by blocks. It computes the exponentials of
+// the logits of each block minus the maximum of the block, and adds their sum
+// to the one of the previous blocks, rescaled to the running maximum of the
+// row as in "Online normalizer calculation for softmax" (Milakov and
+// Gimelshein, 2018). Softmax stores the exponentials in the output, and the
+// second pass rescales each block to the maximum and sum of the row. LogSoftmax
+// only needs the sum, and the second pass writes the shifted logits.
 namespace functor {
-template <typename Device, typename T>
-struct SoftmaxFunctorBase {
-  void operator()(const Device& d, typename TTypes<T>::ConstMatrix logits,
+template <typename T>
+struct SoftmaxFunctor<CPUDevice, T> {
+  void operator()(const CPUDevice& d, typename TTypes<T>::ConstMatrix logits,
                   typename TTypes<T>::Matrix softmax, const bool log) {
-    SoftmaxEigenImpl<Device, T>::Compute(d, logits, softmax, log);
+    // Half precision logits are computed in float.
+    typedef typename std::conditional<std::is_same<T, double>::value, double,
+                                      float>::type Acc;
+    typedef Eigen::Array<T, Eigen::Dynamic, 1> Array;
+    constexpr Eigen::Index kBlockSize = 256;
+
+    const Eigen::Index batch_size = logits.dimension(0);
+    const Eigen::Index num_classes = logits.dimension(1);
+    const Eigen::Index num_blocks = Eigen::divup(num_classes, kBlockSize);
+    const T* in_data = logits.data();
+    T* out_data = softmax.data();
+
+    // exp(a - b), which is 1 instead of NaN when both are -inf.
+    auto rescale = [](Acc a, Acc b) {
+      return a == b ? Acc(1) : Eigen::numext::exp(a - b);
+    };
+    auto compute_rows = [&](Eigen::Index begin, Eigen::Index end) {
+      Eigen::Array<Acc, kBlockSize, 1> block;
+      std::vector<Acc> block_max(num_blocks);
+      for (Eigen::Index row = begin; row < end; ++row) {
+        const T* in = in_data + row * num_classes;
+        T* out = out_data + row * num_classes;
+        Acc row_max = -Eigen::NumTraits<Acc>::infinity();
+        Acc sum = 0;
+        for (Eigen::Index b = 0; b < num_blocks; ++b) {
+          const Eigen::Index c = b * kBlockSize;
+          const Eigen::Index n = std::min(kBlockSize, num_classes - c);
+          auto values = block.head(n);
+          values = Eigen::Map<const Array>(in + c, n).template cast<Acc>();
+          const Acc m = values.maxCoeff();
+          block_max[b] = m;
+          // A block of -inf logits does not contribute to the sum.
+          if (m == -Eigen::NumTraits<Acc>::infinity()) {
+            if (!log) Eigen::Map<Array>(out + c, n).setZero();
+            continue;
+          }
+          values = (values - m).exp();
+          if (!log) Eigen::Map<Array>(out + c, n) = values.template cast<T>();
+          const Acc new_max = std::max(row_max, m);
+          sum = sum * rescale(row_max, new_max) +
+                values.sum() * rescale(m, new_max);
+          row_max = new_max;
+        }
+        if (log) {
+          const Acc shift = row_max + Eigen::numext::log(sum);
+          for (Eigen::Index c = 0; c < num_classes; c += kBlockSize) {
+            const Eigen::Index n = std::min(kBlockSize, num_classes - c);
+            Eigen::Map<Array>(out + c, n) =
+                (Eigen::Map<const Array>(in + c, n).template cast<Acc>() -
+                 shift)
+                    .template cast<T>();
+          }
+        } else {
+          const Acc inverse_sum = Acc(1) / sum;
+          for (Eigen::Index b = 0; b < num_blocks; ++b) {
+            const Eigen::Index c = b * kBlockSize;
+            const Eigen::Index n = std::min(kBlockSize, num_classes - c);
+            const Acc factor = rescale(block_max[b], row_max) * inverse_sum;
+            Eigen::Map<Array> out_block(out + c, n);
+            out_block =
+                (out_block.template cast<Acc>() * factor).template cast<T>();
+          }
+        }
+      }
+    };
+    const Eigen::TensorOpCost cost(
+        num_classes * sizeof(T), num_classes * sizeof(T),
+        num_classes * (Eigen::internal::functor_traits<
+                           Eigen::internal::scalar_exp_op<Acc>>::Cost +
+                       4 * Eigen::TensorOpCost::AddCost<Acc>()));
+    d.parallelFor(batch_size, cost, compute_rows);
   }
 };
-template <typename T>
-struct SoftmaxFunctor<CPUDevice, T> : SoftmaxFunctorBase<CPUDevice, T> {};
 
 }  // namespace functor
 
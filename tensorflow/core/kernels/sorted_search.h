@@ -0,0 +1,114 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_SORTED_SEARCH_H_
+#define TENSORFLOW_CORE_KERNELS_SORTED_SEARCH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "tensorflow/core/platform/prefetch.h"
+
+namespace tensorflow {
+namespace sorted_search {
+
+// Returns the same index as std::upper_bound(sorted, sorted + size, value).
+// The number of iterations only depends on `size`, and the comparison result
+// selects the next position instead of a branch, so that searching for random
+// values does not mispredict, and the searches of consecutive values overlap.
+template <typename S, typename V>
+inline int64_t UpperBound(const S* sorted, int64_t size, const V& value) {
+  if (size == 0) return 0;
+  const S* base = sorted;
+  while (size > 1) {
+    const int64_t half = size / 2;
+    base = (value < base[half]) ? base : base + half;
+    size -= half;
+  }
+  return (base - sorted) + !(value < *base);
+}
+
+// Returns the same index as std::lower_bound(sorted, sorted + size, value),
+// like UpperBound.
+template <typename S, typename V>
+inline int64_t LowerBound(const S* sorted, int64_t size, const V& value) {
+  if (size == 0) return 0;
+  const S* base = sorted;
+  while (size > 1) {
+    const int64_t half = size / 2;
+    base = (base[half] < value) ? base + half : base;
+    size -= half;
+  }
+  return (base - sorted) + (*base < value);
+}
+
+// A copy of a sorted array in Eytzinger (breadth-first) order, where the
+// children of the element k are 2k and 2k + 1. The elements compared by the
+// first levels of a search are contiguous, and the 16 descendants of an
+// element four levels down share a cache line, which can be prefetched. This
+// is faster than UpperBound on sorted arrays that do not fit in the L1 cache.
+template <typename S>
+class EytzingerArray {
+ public:
+  EytzingerArray() = default;
+
+  explicit EytzingerArray(const std::vector<S>& sorted)
+      : size_(sorted.size()), elements_(size_ + 1), ranks_(size_ + 1) {
+    int64_t next = 0;
+    Build(sorted, 1, &next);
+    // Searches past the last element end at 0.
+    ranks_[0] = size_;
+  }
+
+  int64_t size() const { return size_; }
+
+  // Returns the same index as std::upper_bound on the sorted array.
+  template <typename V>
+  inline int64_t UpperBound(const V& value) const {
+    const S* elements = elements_.data();
+    uint64_t k = 1;
+    while (k <= size_) {
+      port::prefetch<port::PREFETCH_HINT_T0>(reinterpret_cast<const char*>(
+          elements + std::min<uint64_t>(16 * k, size_)));
+      k = 2 * k + !(value < elements[k]);
+    }
+    // Going right in the tree means that the element is not bigger than
+    // `value`, so the first bigger one is where the search last went left.
+    k >>= absl::countr_one(k) + 1;
+    return ranks_[k];
+  }
+
+ private:
+  void Build(const std::vector<S>& sorted, uint64_t k, int64_t* next) {
+    if (k > size_) return;
+    Build(sorted, 2 * k, next);
+    elements_[k] = sorted[*next];
+    ranks_[k] = (*next)++;
+    Build(sorted, 2 * k + 1, next);
+  }
+
+  uint64_t size_ = 0;
+  // Element 0 is unused.
+  std::vector<S> elements_;
+  // The index in the sorted array of each element.
+  std::vector<int64_t> ranks_;
+};
+
+}  // namespace sorted_search
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_SORTED_SEARCH_H_
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/fingerprint.h"
@@ -270,6 +271,30 @@ StringPiece KeyedDenseTensorColumn<StringPiece>::Feature(
   return tensor_.matrix<tstring>()(batch, n);
 }
 
+// The hashes of the features of every column in one row. They are computed
+// once for all the crosses of the row, rather than once per cross.
+class RowFeatureHashes {
+ public:
+  void Compute(
+      const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
+      const int64_t batch_index, bool strong_hash) {
+    hashes_.resize(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+      const int64_t count = columns[i]->FeatureCount(batch_index);
+      hashes_[i].resize(count);
+      for (int64_t n = 0; n < count; ++n) {
+        hashes_[i][n] = columns[i]->Feature(batch_index, n, strong_hash);
+      }
+    }
+  }
+
+  // Returns the hash of the nth feature of column i.
+  uint64 Get(size_t i, int n) const { return hashes_[i][n]; }
+
+ private:
+  std::vector<gtl::InlinedVector<uint64, 4>> hashes_;
+};
+
 // Updates Output tensors with sparse crosses.
 template <typename OutType>
 class OutputUpdater {
@@ -329,20 +354,20 @@ class StringCrosser {
 // Generates the sparse crosses as nested hash to avoid string manipulations.
 class HashCrosser {
  public:
-  HashCrosser(
-      const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
-      const int64_t num_buckets, const uint64 hash_key,
-      const tstring k_feature_separator_unused)
-      : columns_(columns), num_buckets_(num_buckets), hash_key_(hash_key) {}
-
-  int64_t Generate(const int64_t batch_index,
-                   const std::vector<int>& permutation,
-                   bool unused_strong_hash) const {
+  HashCrosser(const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>&
+                  columns_unused,
+              const int64_t num_buckets, const uint64 hash_key,
+              const tstring k_feature_separator_unused)
+      : num_buckets_(num_buckets), hash_key_(hash_key) {}
+
+  // Returns the cross of the features of a row given by their hashes.
+  int64_t Generate(const RowFeatureHashes& hashes,
+                   const std::vector<int>& permutation) const {
     // Do the fingerprint concatenation on uint64.
     uint64 hashed_output = hash_key_;
     for (size_t i = 0; i < permutation.size(); ++i) {
-      uint64 hash_i = columns_[i]->Feature(batch_index, permutation[i], false);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
+      hashed_output =
+          FingerprintCat64(hashed_output, hashes.Get(i, permutation[i]));
     }
     // The return value is int64 based on the number of buckets.
     if (num_buckets_ > 0) {
@@ -354,7 +379,6 @@ class HashCrosser {
   }
 
  private:
-  const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
   const int64_t num_buckets_;
   const uint64 hash_key_;
 };
@@ -362,22 +386,20 @@ class HashCrosser {
 // Generates the sparse crosses as nested hash to avoid string manipulations.
 class HashCrosserV2 {
  public:
-  HashCrosserV2(
-      const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns,
-      const int64_t num_buckets, const uint64 hash_key_unused,
-      const tstring k_feature_separator_unused)
-      : columns_(columns), num_buckets_(num_buckets) {}
-
-  int64_t Generate(const int64_t batch_index,
-                   const std::vector<int>& permutation,
-                   bool strong_hash) const {
+  HashCrosserV2(const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>&
+                    columns_unused,
+                const int64_t num_buckets, const uint64 hash_key_unused,
+                const tstring k_feature_separator_unused)
+      : num_buckets_(num_buckets) {}
+
+  // Returns the cross of the features of a row given by their hashes.
+  int64_t Generate(const RowFeatureHashes& hashes,
+                   const std::vector<int>& permutation) const {
     // Do the fingerprint concatenation on uint64.
-    uint64 hashed_output =
-        columns_[0]->Feature(batch_index, permutation[0], strong_hash);
+    uint64 hashed_output = hashes.Get(0, permutation[0]);
     for (size_t i = 1; i < permutation.size(); ++i) {
-      uint64 hash_i =
-          columns_[i]->Feature(batch_index, permutation[i], strong_hash);
-      hashed_output = FingerprintCat64(hashed_output, hash_i);
+      hashed_output =
+          FingerprintCat64(hashed_output, hashes.Get(i, permutation[i]));
     }
     // The return value is int64 based on the number of buckets.
     if (num_buckets_ > 0) {
@@ -389,7 +411,6 @@ class HashCrosserV2 {
   }
 
  private:
-  const std::vector<std::unique_ptr<ColumnInterface<int64_t>>>& columns_;
   const int64_t num_buckets_;
 };
 
@@ -786,14 +807,30 @@ class SparseCrossOp : public OpKernel {
     typename CrossTraits<HASHED_OUTPUT, InternalType>::Updater updater(
         output_start_indices, indices_out, values_out);
     auto do_work = [&columns, crosser, updater](int64_t begin, int64_t end) {
-      for (int b = begin; b < end; b++) {
-        ProductIterator<InternalType> product_iterator(columns, b);
-        int64_t cross_count = 0;
-        while (product_iterator.HasNext()) {
-          const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, false));
-          cross_count++;
+      if constexpr (HASHED_OUTPUT) {
+        RowFeatureHashes hashes;
+        for (int b = begin; b < end; b++) {
+          ProductIterator<InternalType> product_iterator(columns, b);
+          if (!product_iterator.HasNext()) continue;
+          hashes.Compute(columns, b, /*strong_hash=*/false);
+          int64_t cross_count = 0;
+          while (product_iterator.HasNext()) {
+            const auto permutation = product_iterator.Next();
+            updater.Update(b, cross_count,
+                           crosser.Generate(hashes, permutation));
+            cross_count++;
+          }
+        }
+      } else {
+        for (int b = begin; b < end; b++) {
+          ProductIterator<InternalType> product_iterator(columns, b);
+          int64_t cross_count = 0;
+          while (product_iterator.HasNext()) {
+            const auto permutation = product_iterator.Next();
+            updater.Update(b, cross_count,
+                           crosser.Generate(b, permutation, false));
+            cross_count++;
+          }
         }
       }
     };
@@ -937,13 +974,15 @@ class SparseCrossHashedOp : public OpKernel {
                                    values_out);
     auto do_work = [&columns, crosser, updater, strong_hash](int64_t begin,
                                                              int64_t end) {
+      RowFeatureHashes hashes;
       for (int b = begin; b < end; b++) {
         ProductIterator<int64_t> product_iterator(columns, b);
+        if (!product_iterator.HasNext()) continue;
+        hashes.Compute(columns, b, strong_hash);
         int64_t cross_count = 0;
         while (product_iterator.HasNext()) {
           const auto permutation = product_iterator.Next();
-          updater.Update(b, cross_count,
-                         crosser.Generate(b, permutation, strong_hash));
+          updater.Update(b, cross_count, crosser.Generate(hashes, permutation));
           cross_count++;
         }
       }
@@ -18,9 +18,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/sparse_reorder_op.h"
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -30,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/sparse_utils.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -39,6 +43,184 @@ using CPUDevice = Eigen::ThreadPoolDevice;
 using GPUDevice = Eigen::GpuDevice;
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+namespace {
+
+// Inputs with at least this many entries, whose indices are all within the
+// dense shape, are sorted with a parallel radix sort of their row-major
+// linearized indices, instead of with std::sort and a comparator of the
+// index rows.
+constexpr int64_t kMinRadixSortEntries = 1 << 14;
+// The number of bits of the keys sorted by each pass of the radix sort.
+constexpr int kRadixBits = 8;
+constexpr int kRadixSize = 1 << kRadixBits;
+
+// Computes the row-major linear index of each row of `indices` in a dense
+// tensor of shape `shape` into `keys`, and the number of significant bits of
+// the largest possible one into `num_bits`. Returns false if an index is not
+// within the shape, or if the number of elements of the shape overflows.
+bool LinearizeIndices(const DeviceBase::CpuWorkerThreads& worker_threads,
+                      const Tensor& indices, gtl::ArraySlice<int64_t> shape,
+                      std::vector<uint64_t>* keys, int* num_bits) {
+  const int dims = shape.size();
+  std::vector<uint64_t> strides(dims);
+  uint64_t num_elements = 1;
+  for (int d = dims - 1; d >= 0; --d) {
+    if (shape[d] <= 0 ||
+        num_elements > std::numeric_limits<int64_t>::max() / shape[d]) {
+      return false;
+    }
+    strides[d] = num_elements;
+    num_elements *= shape[d];
+  }
+  *num_bits = 0;
+  while (*num_bits < 64 && ((num_elements - 1) >> *num_bits) != 0) {
+    ++*num_bits;
+  }
+
+  const auto ix = indices.matrix<int64_t>();
+  const int64_t num_entries = ix.dimension(0);
+  keys->resize(num_entries);
+  std::atomic<bool> in_shape(true);
+  auto linearize = [&](int64_t begin, int64_t end) {
+    bool valid = true;
+    for (int64_t i = begin; i < end; ++i) {
+      uint64_t key = 0;
+      for (int d = 0; d < dims; ++d) {
+        const int64_t index = ix(i, d);
+        valid &= index >= 0 && index < shape[d];
+        key += static_cast<uint64_t>(index) * strides[d];
+      }
+      (*keys)[i] = key;
+    }
+    if (!valid) in_shape = false;
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_entries,
+        2 * dims, linearize);
+  return in_shape;
+}
+
+// Sorts `keys`, whose bits past the `num_bits` low ones are zero, and permutes
+// `positions` in the same way, with a stable LSD radix sort. The keys are split
+// in chunks, and each pass counts the digits of the chunks in parallel, then
+// moves the keys of each chunk in parallel after those of the same digit in
+// the previous chunks.
+void RadixSort(const DeviceBase::CpuWorkerThreads& worker_threads,
+               int num_bits, std::vector<uint64_t>* keys,
+               std::vector<int64_t>* positions) {
+  const int64_t n = keys->size();
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(worker_threads.num_threads,
+                           n / (kMinRadixSortEntries / 4)));
+  const int64_t chunk_size = Eigen::divup(n, num_chunks);
+  std::vector<uint64_t> keys_out(n);
+  std::vector<int64_t> positions_out(n);
+  std::vector<int64_t> offsets(num_chunks * kRadixSize);
+
+  for (int shift = 0; shift < num_bits; shift += kRadixBits) {
+    const uint64_t* keys_in = keys->data();
+    std::fill(offsets.begin(), offsets.end(), 0);
+    auto count = [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        int64_t* counts = offsets.data() + c * kRadixSize;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size);
+             ++i) {
+          ++counts[(keys_in[i] >> shift) & (kRadixSize - 1)];
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+          2 * chunk_size, count);
+
+    int64_t total = 0;
+    bool single_digit = false;
+    for (int digit = 0; digit < kRadixSize; ++digit) {
+      const int64_t digit_begin = total;
+      for (int64_t c = 0; c < num_chunks; ++c) {
+        int64_t& offset = offsets[c * kRadixSize + digit];
+        const int64_t count = offset;
+        offset = total;
+        total += count;
+      }
+      single_digit |= total - digit_begin == n;
+    }
+    // All the keys have the same digit, so the pass would not move them.
+    if (single_digit) continue;
+
+    const int64_t* positions_in = positions->data();
+    auto scatter = [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        int64_t* chunk_offsets = offsets.data() + c * kRadixSize;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size);
+             ++i) {
+          const int64_t out =
+              chunk_offsets[(keys_in[i] >> shift) & (kRadixSize - 1)]++;
+          keys_out[out] = keys_in[i];
+          positions_out[out] = positions_in[i];
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+          4 * chunk_size, scatter);
+    keys->swap(keys_out);
+    positions->swap(positions_out);
+  }
+}
+
+// Reorders large inputs whose indices are all within the dense shape with
+// RadixSort, or forwards them if they are already ordered. Sets `reordered` to
+// false, without setting any output, for the other inputs.
+template <typename T>
+Status RadixSortReorder(OpKernelContext* context, const Tensor& input_ind,
+                        const Tensor& input_val,
+                        gtl::ArraySlice<int64_t> input_shape,
+                        bool* reordered) {
+  *reordered = false;
+  const int64_t num_entries = input_ind.dim_size(0);
+  if (num_entries < kMinRadixSortEntries) return OkStatus();
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  std::vector<uint64_t> keys;
+  int num_bits;
+  if (!LinearizeIndices(worker_threads, input_ind, input_shape, &keys,
+                        &num_bits)) {
+    return OkStatus();
+  }
+  *reordered = true;
+  if (std::is_sorted(keys.begin(), keys.end())) {
+    context->set_output(0, input_ind);
+    context->set_output(1, input_val);
+    return OkStatus();
+  }
+
+  std::vector<int64_t> positions(num_entries);
+  std::iota(positions.begin(), positions.end(), 0);
+  RadixSort(worker_threads, num_bits, &keys, &positions);
+
+  Tensor* output_ind = nullptr;
+  Tensor* output_val = nullptr;
+  TF_RETURN_IF_ERROR(
+      context->allocate_output(0, input_ind.shape(), &output_ind));
+  TF_RETURN_IF_ERROR(
+      context->allocate_output(1, input_val.shape(), &output_val));
+  const auto ix = input_ind.matrix<int64_t>();
+  const auto vals = input_val.vec<T>();
+  auto out_ix = output_ind->matrix<int64_t>();
+  auto out_vals = output_val->vec<T>();
+  const int dims = input_ind.dim_size(1);
+  auto gather = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const int64_t position = positions[i];
+      for (int d = 0; d < dims; ++d) out_ix(i, d) = ix(position, d);
+      out_vals(i) = vals(position);
+    }
+  };
+  Shard(worker_threads.num_threads, worker_threads.workers, num_entries,
+        (dims + 1) * 8, gather);
+  return OkStatus();
+}
+
+}  // namespace
+
 namespace functor {
 
 template <typename T>
@@ -47,6 +229,10 @@ struct SparseReorderFunctor<CPUDevice, T> {
                   const Tensor& input_val, const Tensor& input_shape_in) {
     gtl::ArraySlice<int64_t> input_shape(input_shape_in.vec<int64_t>().data(),
                                          input_shape_in.NumElements());
+    bool reordered;
+    OP_REQUIRES_OK(context, RadixSortReorder<T>(context, input_ind, input_val,
+                                                input_shape, &reordered));
+    if (reordered) return;
 
     gtl::InlinedVector<int64_t, 8> std_order(input_shape.size());
     std::iota(std_order.begin(), std_order.end(), 0);
@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -321,6 +323,91 @@ Status SparseTensorDenseMatMulImpl(
   }
   return OkStatus();
 }
+
+// Products with at least this many multiply-adds are computed by
+// SparseTensorDenseMatMulByRows when there are several worker threads.
+constexpr int64_t kMinParallelMatMulCost = 1 << 17;
+
+// The number of nonzeros ahead of the current one whose rows of b are
+// prefetched. On wide and very sparse products, every nonzero reads a
+// different row of b, which is rarely in the cache.
+constexpr int64_t kPrefetchDistance = 8;
+
+// Computes the product like SparseTensorDenseMatMulImpl when b is not
+// adjoint, with multiple threads. The nonzeros are first sorted by output row
+// with a counting sort, so that each shard of output rows is computed by one
+// thread, which accumulates the rows of b directly into its rows of `out`.
+template <typename T, typename Tindices, bool ADJ_A>
+Status SparseTensorDenseMatMulByRows(
+    const DeviceBase::CpuWorkerThreads& worker_threads,
+    typename TTypes<T>::Matrix out,
+    typename TTypes<Tindices>::ConstMatrix a_indices,
+    typename TTypes<T>::ConstVec a_values, typename TTypes<T>::ConstMatrix b) {
+  const int64_t nnz = a_values.size();
+  const int64_t num_rows = out.dimension(0);
+  const int64_t rhs_right = b.dimension(1);
+  const int64_t lhs_right = b.dimension(0);
+  const int lhs_index_a = ADJ_A ? 1 : 0;
+  const int rhs_index_a = ADJ_A ? 0 : 1;
+
+  // row_starts[m + 1] counts the nonzeros of row m, and then becomes the end
+  // of the nonzeros of row m in the sorted ones.
+  std::vector<int64_t> row_starts(num_rows + 1, 0);
+  std::vector<int64_t> rows(nnz);
+  std::vector<int64_t> cols(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, lhs_right)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, lhs_right);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    rows[i] = m;
+    cols[i] = k;
+    ++row_starts[m + 1];
+  }
+  for (int64_t m = 0; m < num_rows; ++m) {
+    row_starts[m + 1] += row_starts[m];
+  }
+  std::vector<int64_t> sorted_cols(nnz);
+  std::vector<T> sorted_values(nnz);
+  {
+    std::vector<int64_t> row_ends(row_starts.begin(), row_starts.end() - 1);
+    for (int64_t i = 0; i < nnz; ++i) {
+      const int64_t j = row_ends[rows[i]]++;
+      sorted_cols[j] = cols[i];
+      sorted_values[j] = ADJ_A ? MaybeConj(a_values(i)) : a_values(i);
+    }
+  }
+
+  typedef Eigen::Array<T, Eigen::Dynamic, 1> Row;
+  const T* b_data = b.data();
+  T* out_data = out.data();
+  auto b_row = [&](int64_t j) { return b_data + rhs_right * sorted_cols[j]; };
+  auto multiply_rows = [&](int64_t begin, int64_t end) {
+    for (int64_t m = begin; m < end; ++m) {
+      Eigen::Map<Row> out_row(out_data + rhs_right * m, rhs_right);
+      out_row.setZero();
+      const int64_t limit = row_starts[m + 1];
+      for (int64_t j = row_starts[m]; j < limit; ++j) {
+        if (j + kPrefetchDistance < limit) {
+          port::prefetch<port::PREFETCH_HINT_T0>(
+              reinterpret_cast<const char*>(b_row(j + kPrefetchDistance)));
+        }
+        out_row +=
+            sorted_values[j] * Eigen::Map<const Row>(b_row(j), rhs_right);
+      }
+    }
+  };
+  const int64_t cost_per_row =
+      std::max<int64_t>(1, nnz / num_rows) * rhs_right *
+      (Eigen::TensorOpCost::AddCost<T>() + Eigen::TensorOpCost::MulCost<T>());
+  Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+        cost_per_row, multiply_rows);
+  return OkStatus();
+}
 }  // namespace
 
 template <typename T, typename Tindices, bool ADJ_A, bool ADJ_B>
@@ -330,6 +417,14 @@ struct SparseTensorDenseMatMulFunctor<CPUDevice, T, Tindices, ADJ_A, ADJ_B> {
                         typename TTypes<T>::ConstVec a_values,
                         typename TTypes<T>::ConstMatrix b) {
     using Tsum = typename SumType<T>::type;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    if (std::is_same<T, Tsum>::value && !ADJ_B &&
+        worker_threads.num_threads > 1 && out.dimension(0) > 1 &&
+        a_values.size() * out.dimension(1) >= kMinParallelMatMulCost) {
+      return SparseTensorDenseMatMulByRows<T, Tindices, ADJ_A>(
+          worker_threads, out, a_indices, a_values, b);
+    }
     Tensor temp_out_t;
     if (!std::is_same<T, Tsum>::value) {
       TF_RETURN_IF_ERROR(ctx->allocate_temp(
@@ -120,4 +120,8 @@ BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, false, true);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, false);
 BM_SparseTensorDenseMatmul(16384, 4096, 4096, 4096, true, true);
 
+// Wide and very sparse, as in the embeddings of wide and deep models.
+BM_SparseTensorDenseMatmul(65536, 1024, 1048576, 64, false, false);
+BM_SparseTensorDenseMatmul(65536, 1024, 1048576, 64, true, false);
+
 }  // end namespace tensorflow
@@ -14,8 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/tensor_list.h"
 
+#include <cstring>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
 #include "tensorflow/core/lib/core/coding.h"
 
@@ -96,6 +101,118 @@ bool TensorList::Decode(const VariantTensorData& data) {
   return true;
 }
 
+bool TensorList::EncodeBinary(string* buf) const {
+  // Format:
+  // <element_dtype><max_num_elements><element_shape_proto size>
+  // <element_shape_proto><num_tensors>, then for each tensor <dtype>, and
+  // <rank><dims> unless its dtype is DT_INVALID, then the data of the tensors.
+  core::PutVarint64(buf, static_cast<uint64>(element_dtype));
+  core::PutVarint64(buf, static_cast<uint64>(max_num_elements));
+  TensorShapeProto element_shape_proto;
+  element_shape.AsProto(&element_shape_proto);
+  const string element_shape_str = element_shape_proto.SerializeAsString();
+  core::PutVarint32(buf, element_shape_str.size());
+  buf->append(element_shape_str);
+  core::PutVarint64(buf, tensors().size());
+  size_t data_size = 0;
+  for (const Tensor& t : tensors()) {
+    core::PutVarint64(buf, static_cast<uint64>(t.dtype()));
+    if (t.dtype() == DT_INVALID) continue;
+    if (!DataTypeCanUseMemcpy(t.dtype())) return false;
+    core::PutVarint32(buf, t.dims());
+    for (int64_t dim : t.shape().dim_sizes()) {
+      core::PutVarint64(buf, static_cast<uint64>(dim));
+    }
+    data_size += t.TotalBytes();
+  }
+  buf->reserve(buf->size() + data_size);
+  for (const Tensor& t : tensors()) {
+    if (t.dtype() == DT_INVALID) continue;
+    const StringPiece data = t.tensor_data();
+    buf->append(data.data(), data.size());
+  }
+  return true;
+}
+
+bool TensorList::DecodeBinary(StringPiece buf) {
+  uint64 scratch;
+  if (!core::GetVarint64(&buf, &scratch)) return false;
+  element_dtype = static_cast<DataType>(scratch);
+  if (!core::GetVarint64(&buf, &scratch)) return false;
+  max_num_elements = static_cast<int>(scratch);
+  uint32 element_shape_size;
+  if (!core::GetVarint32(&buf, &element_shape_size) ||
+      buf.size() < element_shape_size) {
+    return false;
+  }
+  TensorShapeProto element_shape_proto;
+  if (!element_shape_proto.ParseFromArray(buf.data(), element_shape_size)) {
+    return false;
+  }
+  buf.remove_prefix(element_shape_size);
+  element_shape = PartialTensorShape(element_shape_proto);
+  uint64 num_tensors;
+  if (!core::GetVarint64(&buf, &num_tensors)) return false;
+  // Each tensor takes at least one byte.
+  if (num_tensors > buf.size()) return false;
+  // All the headers are read before any tensor is allocated, so that the
+  // shapes read off the wire can't allocate more than `buf` holds.
+  std::vector<std::pair<DataType, TensorShape>> headers;
+  headers.reserve(num_tensors);
+  uint64 data_size = 0;
+  std::vector<int64_t> dims;
+  for (uint64 i = 0; i < num_tensors; ++i) {
+    if (!core::GetVarint64(&buf, &scratch)) return false;
+    const DataType dtype = static_cast<DataType>(scratch);
+    if (dtype == DT_INVALID) {
+      headers.emplace_back(DT_INVALID, TensorShape());
+      continue;
+    }
+    if (!DataType_IsValid(dtype) || !DataTypeCanUseMemcpy(dtype)) return false;
+    uint32 rank;
+    if (!core::GetVarint32(&buf, &rank) ||
+        rank > TensorShape::MaxDimensions()) {
+      return false;
+    }
+    dims.resize(rank);
+    for (uint32 d = 0; d < rank; ++d) {
+      if (!core::GetVarint64(&buf, &scratch)) return false;
+      dims[d] = static_cast<int64_t>(scratch);
+    }
+    TensorShape shape;
+    if (!TensorShape::BuildTensorShape(dims, &shape).ok()) return false;
+    // `data_size` <= `buf.size()`, which only shrinks, so this can't overflow.
+    const uint64 element_size = DataTypeSize(dtype);
+    if (element_size > 0 &&
+        static_cast<uint64>(shape.num_elements()) >
+            (buf.size() - data_size) / element_size) {
+      return false;
+    }
+    data_size += shape.num_elements() * element_size;
+    headers.emplace_back(dtype, std::move(shape));
+  }
+  if (data_size != buf.size()) return false;
+  tensors().clear();
+  tensors().reserve(num_tensors);
+  for (const auto& [dtype, shape] : headers) {
+    if (dtype == DT_INVALID) {
+      tensors().emplace_back(DT_INVALID);
+    } else {
+      tensors().emplace_back(dtype, shape);
+    }
+  }
+  for (Tensor& t : tensors()) {
+    if (t.dtype() == DT_INVALID) continue;
+    const size_t size = t.TotalBytes();
+    if (buf.size() < size) return false;
+    if (size > 0) {
+      std::memcpy(t.data(), buf.data(), size);
+    }
+    buf.remove_prefix(size);
+  }
+  return buf.empty();
+}
+
 const char TensorList::kTypeName[] = "tensorflow::TensorList";
 
 }  // namespace tensorflow
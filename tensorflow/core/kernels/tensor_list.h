@@ -111,6 +111,14 @@ class TensorList {
 
   bool Decode(const VariantTensorData& data);
 
+  // The flat binary encoding of REGISTER_UNARY_VARIANT_BINARY_ENCODE_FUNCTIONS:
+  // the element dtype and shapes, then the data of every tensor, each copied
+  // with one memcpy. EncodeBinary returns false, leaving `buf` unspecified,
+  // if a tensor's dtype can't be memcpy-ed, e.g. DT_STRING.
+  bool EncodeBinary(string* buf) const;
+
+  bool DecodeBinary(StringPiece buf);
+
   // TODO(apassos) fill this out
   string DebugString() const { return "TensorList"; }
 
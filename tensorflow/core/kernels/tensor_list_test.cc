@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/tensor_list.h"
+
+#include <string>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TensorList TestList() {
+  TensorList list;
+  list.element_dtype = DT_FLOAT;
+  list.element_shape = PartialTensorShape({-1});
+  list.max_num_elements = 10;
+  list.tensors().push_back(test::AsTensor<float>({1, 2, 3}));
+  list.tensors().emplace_back(DT_INVALID);
+  list.tensors().push_back(test::AsTensor<float>({4}));
+  return list;
+}
+
+// The header of a list holding one float tensor of `num_elements`.
+std::string ListHeader(int64_t num_elements) {
+  std::string buf;
+  core::PutVarint64(&buf, DT_FLOAT);
+  core::PutVarint64(&buf, /*max_num_elements=*/1);
+  const std::string element_shape =
+      PartialTensorShape({-1}).AsProto().SerializeAsString();
+  core::PutVarint32(&buf, element_shape.size());
+  buf.append(element_shape);
+  core::PutVarint64(&buf, /*num_tensors=*/1);
+  core::PutVarint64(&buf, DT_FLOAT);
+  core::PutVarint32(&buf, /*rank=*/1);
+  core::PutVarint64(&buf, num_elements);
+  return buf;
+}
+
+TEST(TensorListTest, BinaryRoundTrip) {
+  std::string buf;
+  ASSERT_TRUE(TestList().EncodeBinary(&buf));
+  TensorList decoded;
+  ASSERT_TRUE(decoded.DecodeBinary(buf));
+  EXPECT_EQ(decoded.element_dtype, DT_FLOAT);
+  EXPECT_EQ(decoded.max_num_elements, 10);
+  EXPECT_TRUE(decoded.element_shape.IsIdenticalTo(PartialTensorShape({-1})));
+  ASSERT_EQ(decoded.tensors().size(), 3);
+  test::ExpectTensorEqual<float>(decoded.tensors()[0],
+                                 test::AsTensor<float>({1, 2, 3}));
+  EXPECT_EQ(decoded.tensors()[1].dtype(), DT_INVALID);
+  test::ExpectTensorEqual<float>(decoded.tensors()[2],
+                                 test::AsTensor<float>({4}));
+}
+
+TEST(TensorListTest, BinaryDecodeRejectsTruncatedData) {
+  std::string buf;
+  ASSERT_TRUE(TestList().EncodeBinary(&buf));
+  for (size_t size = 0; size < buf.size(); ++size) {
+    TensorList decoded;
+    EXPECT_FALSE(decoded.DecodeBinary(StringPiece(buf.data(), size)))
+        << "size " << size;
+  }
+}
+
+TEST(TensorListTest, BinaryDecodeRejectsOversizedShapes) {
+  TensorList decoded;
+  // Claims 2^40 floats, which would be allocated before the data is read.
+  EXPECT_FALSE(decoded.DecodeBinary(ListHeader(int64_t{1} << 40) + "data"));
+  std::string fits = ListHeader(1);
+  fits.append(sizeof(float), '\0');
+  EXPECT_TRUE(decoded.DecodeBinary(fits));
+  EXPECT_FALSE(decoded.DecodeBinary(fits + "x"));
+}
+
+}  // namespace
+}  // namespace tensorflow
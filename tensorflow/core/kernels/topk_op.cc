@@ -127,6 +127,67 @@ class TopK : public OpKernel {
   bool sorted_;
 };
 
+namespace {
+
+// Rows of at least this many columns are searched by buffered selection rather
+// than with a TopN heap, and are split across the worker threads when there
+// are fewer rows than threads.
+constexpr int64_t kMinSelectTopKCols = 1 << 14;
+
+// Orders the indices of larger values first, and lower indices first among
+// equal values.
+template <typename T, typename Tidx>
+struct StableGreater {
+  bool operator()(const Tidx a, const Tidx b) const {
+    if (data[b] < data[a]) {
+      return true;
+    } else if (data[b] > data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+
+  const T* data;
+};
+
+// Sets `candidates` to the indices of the (at most) k best elements of
+// data[begin, end), in no particular order.
+//
+// The candidates are buffered in up to 2k entries, which are cut back to the k
+// best with std::nth_element whenever the buffer is full. Every other element
+// is only compared to the worst kept candidate, so that the selection takes
+// linear time rather than the N log(k) of a heap.
+template <typename T, typename Tidx>
+void SelectTopK(const T* data, int64_t begin, int64_t end, int k,
+                std::vector<Tidx>* candidates) {
+  const StableGreater<T, Tidx> comp{data};
+  const size_t capacity = 2 * static_cast<size_t>(k);
+  auto shrink = [&]() {
+    std::nth_element(candidates->begin(), candidates->begin() + (k - 1),
+                     candidates->end(), comp);
+    candidates->resize(k);
+  };
+  candidates->clear();
+  candidates->reserve(capacity);
+  int64_t c = begin;
+  for (; c < end && candidates->size() < capacity; ++c) {
+    candidates->push_back(c);
+  }
+  while (c < end) {
+    shrink();
+    // The candidates all have lower indices, so elements which are not larger
+    // than the worst of them cannot be among the k best.
+    const T threshold = data[candidates->back()];
+    for (; c < end && candidates->size() < capacity; ++c) {
+      if (data[c] > threshold) candidates->push_back(c);
+    }
+  }
+  if (candidates->size() > k) shrink();
+}
+
+}  // namespace
+
 namespace functor {
 
 template <typename T, typename Tidx>
@@ -161,6 +222,12 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return OkStatus();
     }
 
+    if (num_cols >= kMinSelectTopKCols && k < num_cols) {
+      SelectTopKRows(context, sorted, k, input, num_rows, num_cols, values,
+                     indices);
+      return OkStatus();
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -253,6 +320,70 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
 
     return OkStatus();
   }
+
+ private:
+  // Finds the top k of large rows with SelectTopK, on segments of the rows if
+  // there are too few rows to keep the worker threads busy. The top k of a row
+  // are the top k of the candidates of its segments.
+  static void SelectTopKRows(OpKernelContext* context, bool sorted, int k,
+                             const typename TTypes<T, 2>::ConstTensor& input,
+                             const int64_t num_rows, const int64_t num_cols,
+                             typename TTypes<T, 2>::Tensor values,
+                             typename TTypes<Tidx, 2>::Tensor indices) {
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_segments = std::max<int64_t>(
+        1, std::min<int64_t>(
+               (worker_threads.num_threads + num_rows - 1) / num_rows,
+               num_cols / kMinSelectTopKCols));
+    const int64_t segment_size = (num_cols + num_segments - 1) / num_segments;
+    const double cmp_cost = Eigen::TensorOpCost::AddCost<T>();
+
+    std::vector<std::vector<Tidx>> candidates(num_rows * num_segments);
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * num_segments,
+          static_cast<int64_t>(2 * cmp_cost * segment_size),
+          [&](int64_t start, int64_t limit) {
+            for (int64_t i = start; i < limit; ++i) {
+              const int64_t b = i / num_segments;
+              const int64_t begin = (i % num_segments) * segment_size;
+              SelectTopK(&input(b, 0), begin,
+                         std::min(num_cols, begin + segment_size), k,
+                         &candidates[i]);
+            }
+          });
+
+    const double merge_cost =
+        cmp_cost * num_segments * k *
+        Eigen::numext::log2(static_cast<float>(k + 1));
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          static_cast<int64_t>(merge_cost), [&](int64_t start, int64_t limit) {
+            std::vector<Tidx> merged;
+            for (int64_t b = start; b < limit; ++b) {
+              const StableGreater<T, Tidx> comp{&input(b, 0)};
+              merged.clear();
+              for (int64_t i = 0; i < num_segments; ++i) {
+                const auto& segment = candidates[b * num_segments + i];
+                merged.insert(merged.end(), segment.begin(), segment.end());
+              }
+              if (merged.size() > k) {
+                std::nth_element(merged.begin(), merged.begin() + (k - 1),
+                                 merged.end(), comp);
+                merged.resize(k);
+              }
+              if (sorted) {
+                std::sort(merged.begin(), merged.end(), comp);
+              } else {
+                // Equal values must still appear in the order of their indices.
+                std::sort(merged.begin(), merged.end());
+              }
+              for (int i = 0; i < k; ++i) {
+                indices(b, i) = merged[i];
+                values(b, i) = input(b, merged[i]);
+              }
+            }
+          });
+  }
 };
 
 }  // namespace functor
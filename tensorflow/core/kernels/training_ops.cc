@@ -17,7 +17,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -40,6 +42,55 @@ inline T sgn(const T x) {
   T one(1);
   return (x == zero ? zero : (x < zero ? -one : one));
 }
+
+// The positions of a batch of sparse updates, grouped by the row they update.
+// The groups update different rows, so they can be applied in parallel, while
+// the updates of a duplicated row are still applied one after the other in the
+// order of their positions, like in a sequential loop.
+template <typename Tindex>
+struct RowGroups {
+  // The row updated by each group.
+  std::vector<Tindex> rows;
+  // The positions of group g are positions[starts[g]] to
+  // positions[starts[g + 1] - 1].
+  std::vector<Tindex> starts;
+  std::vector<Tindex> positions;
+
+  Tindex size() const { return rows.size(); }
+};
+
+template <typename Tindex>
+Status GroupIndicesByRow(typename TTypes<Tindex>::ConstVec indices,
+                         Tindex first_dim_size, RowGroups<Tindex>* groups) {
+  const Tindex N = static_cast<Tindex>(indices.dimension(0));
+  absl::flat_hash_map<Tindex, Tindex> group_of_row;
+  group_of_row.reserve(N);
+  std::vector<Tindex> group_of_position(N);
+  for (Tindex i = 0; i < N; ++i) {
+    const Tindex index = internal::SubtleMustCopy(indices(i));
+    if (!FastBoundsCheck(index, first_dim_size)) {
+      return errors::InvalidArgument(strings::StrCat(
+          "Index ", index, " at offset ", i, " in indices is out of range"));
+    }
+    auto inserted = group_of_row.try_emplace(index, groups->size());
+    if (inserted.second) groups->rows.push_back(index);
+    group_of_position[i] = inserted.first->second;
+  }
+
+  groups->starts.assign(groups->size() + 1, 0);
+  for (Tindex i = 0; i < N; ++i) {
+    ++groups->starts[group_of_position[i] + 1];
+  }
+  for (Tindex g = 0; g < groups->size(); ++g) {
+    groups->starts[g + 1] += groups->starts[g];
+  }
+  std::vector<Tindex> next(groups->starts.begin(), groups->starts.end() - 1);
+  groups->positions.resize(N);
+  for (Tindex i = 0; i < N; ++i) {
+    groups->positions[next[group_of_position[i]]++] = i;
+  }
+  return OkStatus();
+}
 }  // namespace
 
 namespace functor {
@@ -182,33 +233,34 @@ struct SparseApplyAdagrad<CPUDevice, T, Tindex, has_epsilon> {
     const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
 
     if (inner_dim > 1) {
-      for (Tindex i = 0; i < N; ++i) {
-        const Tindex index = internal::SubtleMustCopy(indices(i));
-        if (!FastBoundsCheck(index, first_dim_size)) {
-          return errors::InvalidArgument(
-              strings::StrCat("Index ", index, " at offset ", i,
-                              " in indices is out of range"));
-        }
-      }
-
-      const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
-        for (Tindex i = start_idx; i < end_idx; ++i) {
-          const Tindex index = internal::SubtleMustCopy(indices(i));
+      // Duplicated indices update their row in the same shard, so that the
+      // shards never update the same row concurrently.
+      RowGroups<Tindex> groups;
+      TF_RETURN_IF_ERROR(
+          GroupIndicesByRow<Tindex>(indices, first_dim_size, &groups));
+
+      const auto shard = [&](Tindex start_group, Tindex end_group) -> void {
+        for (Tindex group = start_group; group < end_group; ++group) {
+          const Tindex index = groups.rows[group];
           auto a = accum.template chip<0>(index);
-          auto g = grad.template chip<0>(i);
           auto v = var.template chip<0>(index);
-          if (update_slots) {
-            a += g.square();
-          }
-          if (has_epsilon) {
-            v -= g.constant(lr_scalar) * g / (a.sqrt() + a.constant(epsilon()));
-          } else {
-            v -= g.constant(lr_scalar) * g * a.rsqrt();
+          for (Tindex j = groups.starts[group]; j < groups.starts[group + 1];
+               ++j) {
+            auto g = grad.template chip<0>(groups.positions[j]);
+            if (update_slots) {
+              a += g.square();
+            }
+            if (has_epsilon) {
+              v -= g.constant(lr_scalar) * g /
+                   (a.sqrt() + a.constant(epsilon()));
+            } else {
+              v -= g.constant(lr_scalar) * g * a.rsqrt();
+            }
           }
         }
       };
 
-      d.parallelFor(N, cost, shard);
+      d.parallelFor(groups.size(), cost, shard);
     } else {
       for (Tindex i = 0; i < N; ++i) {
         const Tindex index = internal::SubtleMustCopy(indices(i));
@@ -611,38 +663,51 @@ struct SparseApplyFtrl<CPUDevice, T, Tindex, has_l2_shrinkage> {
       if (inner_dim > 1) {
         const Tindex first_dim_size =
             static_cast<Tindex>(var_flat.dimension(0));
-
-        for (Tindex i = 0; i < N; i++) {
-          const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-          if (!FastBoundsCheck(index, first_dim_size)) {
-            return errors::InvalidArgument(
-                strings::StrCat("Index ", index, " at offset ", i,
-                                " in indices is out of range"));
+        // The rows are updated in parallel, with the updates of a duplicated
+        // row applied in order by a single shard.
+        RowGroups<Tindex> groups;
+        TF_RETURN_IF_ERROR(
+            GroupIndicesByRow<Tindex>(indices_vec, first_dim_size, &groups));
+
+        const auto shard = [&](Tindex start_group, Tindex end_group) -> void {
+          for (Tindex group = start_group; group < end_group; ++group) {
+            const Tindex index = groups.rows[group];
+            auto accum = accum_flat.template chip<0>(index);
+            auto linear = linear_flat.template chip<0>(index);
+            auto var = var_flat.template chip<0>(index);
+            for (Tindex j = groups.starts[group]; j < groups.starts[group + 1];
+                 ++j) {
+              auto grad = grad_flat.template chip<0>(groups.positions[j]);
+              if (has_l2_shrinkage) {
+                auto grad_with_shrinkage =
+                    grad + static_cast<T>(2) * l2_shrinkage_scalar * var;
+                ComputeFtrl(/*grad=*/grad,
+                            /*grad_maybe_with_shrinkage=*/grad_with_shrinkage,
+                            /*accum=*/accum, /*linear=*/linear, /*var=*/var,
+                            /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
+                            /*multiply_linear_by_lr=*/multiply_linear_by_lr,
+                            /*lr_power_scalar=*/lr_power_scalar,
+                            /*lr_scalar=*/lr_scalar);
+              } else {
+                ComputeFtrl(/*grad=*/grad, /*grad_maybe_with_shrinkage=*/grad,
+                            /*accum=*/accum, /*linear=*/linear, /*var=*/var,
+                            /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
+                            /*multiply_linear_by_lr=*/multiply_linear_by_lr,
+                            /*lr_power_scalar=*/lr_power_scalar,
+                            /*lr_scalar=*/lr_scalar);
+              }
+            }
           }
-          auto accum = accum_flat.template chip<0>(index);
-          auto linear = linear_flat.template chip<0>(index);
-          auto grad = grad_flat.template chip<0>(i);
-          auto var = var_flat.template chip<0>(index);
-
-          if (has_l2_shrinkage) {
-            auto grad_with_shrinkage =
-                grad + static_cast<T>(2) * l2_shrinkage_scalar * var;
-            ComputeFtrl(/*grad=*/grad,
-                        /*grad_maybe_with_shrinkage=*/grad_with_shrinkage,
-                        /*accum=*/accum, /*linear=*/linear, /*var=*/var,
-                        /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
-                        /*multiply_linear_by_lr=*/multiply_linear_by_lr,
-                        /*lr_power_scalar=*/lr_power_scalar,
-                        /*lr_scalar=*/lr_scalar);
-          } else {
-            ComputeFtrl(/*grad=*/grad, /*grad_maybe_with_shrinkage=*/grad,
-                        /*accum=*/accum, /*linear=*/linear, /*var=*/var,
-                        /*l1_scalar=*/l1_scalar, /*l2_scalar=*/l2_scalar,
-                        /*multiply_linear_by_lr=*/multiply_linear_by_lr,
-                        /*lr_power_scalar=*/lr_power_scalar,
-                        /*lr_scalar=*/lr_scalar);
-          }
-        }
+        };
+
+        // ComputeFtrl reads the three slots and the gradient, writes the
+        // three slots, and takes a few pows and divisions per element.
+        const Eigen::TensorOpCost cost(
+            inner_dim * sizeof(T) * 4, inner_dim * sizeof(T) * 3,
+            inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 8 +
+                         Eigen::TensorOpCost::MulCost<T>() * 8 +
+                         Eigen::TensorOpCost::DivCost<T>() * 2));
+        d.parallelFor(groups.size(), cost, shard);
       } else {
         const Tindex first_dim_size = accum_flat.size();
 
@@ -16,6 +16,9 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <complex>
+#include <functional>
+#include <memory>
+#include <type_traits>
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -25,6 +28,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include "xla/pjrt/transpose.h"
+#endif  // !defined(IS_MOBILE_PLATFORM)
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
@@ -68,12 +77,65 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+#if !defined(IS_MOBILE_PLATFORM)
+
+// The number of transpose plans kept. Building a plan is expensive, but the
+// shapes and permutations transposed by a model are few and repeat each step.
+constexpr int kTransposePlanCacheCapacity = 64;
+
+// Transposes `in` into `out` with the blocked transpose of XLA, whose plan is
+// cached by shape, permutation and element size. Returns false if there is no
+// plan for the transpose, e.g. for an unsupported element size.
+bool TransposeUsingPlan(const CPUDevice& device, const Tensor& in,
+                        const gtl::ArraySlice<int32> perm, size_t elem_size,
+                        Tensor* out) {
+  static mutex* mu = new mutex;
+  static xla::TransposePlanCache* cache =
+      new xla::TransposePlanCache(kTransposePlanCacheCapacity);
+
+  gtl::InlinedVector<int64_t, 8> dims;
+  for (const auto& dim : in.shape()) dims.push_back(dim.size);
+  const gtl::InlinedVector<int64_t, 8> permutation(perm.begin(), perm.end());
+  xla::TransposePlan::Options options;
+  options.elem_size_in_bytes = elem_size;
+  options.dims = dims;
+  options.permutation = permutation;
+  options.num_threads = device.numThreads();
+  std::shared_ptr<xla::TransposePlan> plan;
+  {
+    mutex_lock l(*mu);
+    auto plan_or = cache->GetOrCreate(options);
+    if (!plan_or.ok()) return false;
+    plan = *std::move(plan_or);
+  }
+  plan->Execute(in.tensor_data().data(),
+                const_cast<char*>(out->tensor_data().data()),
+                [&device](std::function<void()> work) {
+                  device.enqueueNoNotification(std::move(work));
+                });
+  return true;
+}
+
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+#if !defined(IS_MOBILE_PLATFORM)
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      if (TransposeUsingPlan(d, in, perm, sizeof(T), out)) {
+        // The plan only moves bytes, so the result is conjugated in place.
+        if constexpr (conjugate) {
+          auto out_flat = out->flat<T>();
+          out_flat.device(d) = out_flat.conjugate();
+        }
+        return;
+      }
+    }
+#endif  // !defined(IS_MOBILE_PLATFORM)
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
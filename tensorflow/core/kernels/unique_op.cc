@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +71,13 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Inputs of single elements with at least this many elements are uniquified on
+// all the worker threads, by partitioning the elements by hash.
+constexpr int64_t kMinShardedUniqueSize = 1 << 16;
+
+// The largest number of partitions of a sharded unique.
+constexpr int kMaxUniquePartitions = 64;
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -143,7 +153,15 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    const DeviceBase::CpuWorkerThreads* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        new_sizes[1] >= kMinShardedUniqueSize && worker_threads != nullptr &&
+        worker_threads->num_threads > 1) {
+      OP_REQUIRES_OK(context, ShardedUnique(context, input, axis,
+                                            *worker_threads, idx_vec,
+                                            &uniq_size));
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -237,6 +255,115 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  using MapType = typename UniqueOpHashMap<T, TIndex>::map_type;
+
+  // Uniquifies a large input of single elements, with the same output as the
+  // sequential implementation:
+  //
+  // 1. Each chunk of the input lists its elements by partition, where the
+  //    partition of an element is given by its hash.
+  // 2. Each partition maps its elements, visited in input order, to their first
+  //    occurrence, with a hash map of its own.
+  // 3. A prefix sum over the chunks of their numbers of first occurrences gives
+  //    the position of each first occurrence in the output.
+  Status ShardedUnique(OpKernelContext* context, const Tensor& input,
+                       int64_t axis,
+                       const DeviceBase::CpuWorkerThreads& worker_threads,
+                       typename TTypes<TIndex>::Vec idx_vec,
+                       int64_t* uniq_size) {
+    auto Tin = input.flat<T>();
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    const int num_partitions =
+        std::min(worker_threads.num_threads, kMaxUniquePartitions);
+    const int64_t num_chunks = num_partitions;
+    const int64_t chunk_size = (N + num_chunks - 1) / num_chunks;
+    // Runs `fn(chunk, begin, end)` on each chunk [begin, end) of the input.
+    auto for_each_chunk = [&](int64_t cost_per_element, const auto& fn) {
+      Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+            cost_per_element * chunk_size, [&](int64_t begin, int64_t end) {
+              for (int64_t c = begin; c < end; ++c) {
+                fn(c, c * chunk_size, std::min(N, (c + 1) * chunk_size));
+              }
+            });
+    };
+
+    const typename MapType::hasher hasher;
+    // The elements of each partition in each chunk, in input order.
+    std::vector<std::vector<TIndex>> partition_elements(num_chunks *
+                                                        num_partitions);
+    auto elements_of = [&](int64_t c, int64_t p) -> std::vector<TIndex>& {
+      return partition_elements[c * num_partitions + p];
+    };
+    for_each_chunk(/*cost_per_element=*/20, [&](int64_t c, int64_t begin,
+                                                int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        // The hash maps use the low bits of the same hash, so the partition
+        // is taken from the high bits of a multiplicative hash of it.
+        const uint64 h = static_cast<uint64>(
+            hasher(static_cast<typename MapType::key_type>(Tin(i))));
+        const int p = ((h * 0x9E3779B97F4A7C15ULL) >> 32) % num_partitions;
+        elements_of(c, p).push_back(i);
+      }
+    });
+
+    std::vector<TIndex> first(N);
+    Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+          /*cost_per_unit=*/100 * chunk_size, [&](int64_t begin, int64_t end) {
+            for (int64_t p = begin; p < end; ++p) {
+              int64_t num_elements = 0;
+              for (int64_t c = 0; c < num_chunks; ++c) {
+                num_elements += elements_of(c, p).size();
+              }
+              MapType uniq;
+              uniq.reserve(2 * num_elements);
+              for (int64_t c = 0; c < num_chunks; ++c) {
+                for (TIndex i : elements_of(c, p)) {
+                  auto it = uniq.emplace(Tin(i), i);
+                  first[i] = it.first->second;
+                }
+              }
+            }
+          });
+
+    std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+    for_each_chunk(/*cost_per_element=*/1, [&](int64_t c, int64_t begin,
+                                               int64_t end) {
+      int64_t num_first = 0;
+      for (int64_t i = begin; i < end; ++i) num_first += first[i] == i;
+      chunk_offsets[c + 1] = num_first;
+    });
+    for (int64_t c = 0; c < num_chunks; ++c) {
+      chunk_offsets[c + 1] += chunk_offsets[c];
+    }
+    *uniq_size = chunk_offsets[num_chunks];
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+
+    for_each_chunk(/*cost_per_element=*/2, [&](int64_t c, int64_t begin,
+                                               int64_t end) {
+      TIndex j = chunk_offsets[c];
+      for (int64_t i = begin; i < end; ++i) {
+        if (first[i] == i) {
+          Tout(j) = Tin(i);
+          idx_vec(i) = j++;
+        }
+      }
+    });
+    // The first occurrences all have their index now.
+    for_each_chunk(/*cost_per_element=*/2, [&](int64_t c, int64_t begin,
+                                               int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        if (first[i] != i) idx_vec(i) = idx_vec(first[i]);
+      }
+    });
+    return OkStatus();
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
@@ -15,11 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -111,6 +116,46 @@ void BM_Unique_INT32_Repeat(::testing::benchmark::State& state) {
                           sizeof(int32));
 }
 
+class UniqueOpTest : public OpsTestBase {};
+
+// Large inputs are uniquified on several threads, with the same output as
+// sequentially.
+TEST_F(UniqueOpTest, LargeInputMatchesSequentialOrder) {
+  TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                   .Input(FakeInput(DT_INT64))
+                   .Attr("out_idx", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  constexpr int kNumElements = 1 << 18;
+  std::vector<int64_t> input(kNumElements);
+  for (int i = 0; i < kNumElements; ++i) {
+    input[i] = (static_cast<int64_t>(i) * 7919) % 10007 - 5000;
+  }
+  AddInputFromArray<int64_t>(TensorShape({kNumElements}), input);
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::unordered_map<int64_t, int32> index_of;
+  std::vector<int64_t> expected_y;
+  std::vector<int32> expected_idx;
+  std::vector<int32> expected_count;
+  for (int64_t x : input) {
+    auto it = index_of.emplace(x, expected_y.size());
+    if (it.second) {
+      expected_y.push_back(x);
+      expected_count.push_back(0);
+    }
+    expected_idx.push_back(it.first->second);
+    ++expected_count[it.first->second];
+  }
+  const int64_t num_unique = expected_y.size();
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0), test::AsTensor<int64_t>(expected_y, {num_unique}));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(1), test::AsTensor<int32>(expected_idx, {kNumElements}));
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(2), test::AsTensor<int32>(expected_count, {num_unique}));
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
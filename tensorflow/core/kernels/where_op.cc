@@ -23,8 +23,16 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/where_op.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "absl/numeric/bits.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -36,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -66,7 +75,19 @@ int64_t CountAccumulator(const T* begin, const T* end) {
 
 template <>
 int64_t CountAccumulator<bool>(const bool* begin, const bool* end) {
-  return std::accumulate(begin, end, 0LL);
+  int64_t count = 0;
+#if defined(__SSE2__)
+  // Counts 16 values at a time from the mask of the zero bytes among them.
+  const __m128i zero = _mm_setzero_si128();
+  for (; end - begin >= 16; begin += 16) {
+    const __m128i values =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    const uint32_t zeros =
+        static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(values, zero)));
+    count += 16 - absl::popcount(zeros);
+  }
+#endif
+  return std::accumulate(begin, end, count);
 }
 
 }  // namespace
@@ -97,6 +118,18 @@ struct Where<CPUDevice, DIMS, T, TIndex> {
       OpKernelContext* ctx, const CPUDevice& d,
       typename TTypes<T, DIMS>::ConstTensor input,
       typename TTypes<int64_t>::Matrix output, TIndex* found_true) {
+    *found_true += ComputeRange(input, output, 0, input.size(), *found_true,
+                                output.dimension(0));
+    return OkStatus();
+  }
+
+  // Copies the indices of the true values among the elements [begin, end) of
+  // input into the rows [first_row, end_row) of output, and returns their
+  // number. The values past end_row are counted but not written.
+  static TIndex ComputeRange(typename TTypes<T, DIMS>::ConstTensor input,
+                             typename TTypes<int64_t>::Matrix output,
+                             Eigen::DenseIndex begin, Eigen::DenseIndex end,
+                             TIndex first_row, TIndex end_row) {
     Eigen::DSizes<Eigen::DenseIndex, DIMS> dims = input.dimensions();
     Eigen::DSizes<TIndex, DIMS> strides;
 
@@ -109,16 +142,16 @@ struct Where<CPUDevice, DIMS, T, TIndex> {
       strides[i] = strides[i + 1] * dims[i + 1];
     }
 
-    Eigen::DenseIndex output_size = output.dimension(0);
-    for (Eigen::DenseIndex n = 0; n < input.size(); ++n) {
+    TIndex row = first_row;
+    for (Eigen::DenseIndex n = begin; n < end; ++n) {
       if (input.data()[n] != T(0)) {
-        if (FastBoundsCheck(*found_true, output_size)) {
-          WriteIndexRowMajor(output, strides, *found_true, n);
+        if (row < end_row) {
+          WriteIndexRowMajor(output, strides, row, n);
         }
-        ++*found_true;
+        ++row;
       }
     }
-    return OkStatus();
+    return row - first_row;
   }
 };
 
@@ -139,6 +172,15 @@ class WhereCPUOp : public OpKernel {
                               "creating costly copies from device."));
 
     const int input_dims = input.dims();
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64_t num_blocks =
+        std::min<int64_t>(kBlocksPerThread * worker_threads.num_threads,
+                          input.NumElements() / kMinElementsPerBlock);
+    if (num_blocks > 1) {
+      ComputeInBlocks(context, input, num_blocks);
+      return;
+    }
 
     int64_t num_true;
     TTypes<int64_t>::UnalignedScalar num_true_t(&num_true);
@@ -151,9 +193,6 @@ class WhereCPUOp : public OpKernel {
     Tensor* output = nullptr;
     OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
 
-    // TODO(ebrevdo): Replace single-threaded copy with a multithreaded block
-    // copy by getting block counts above instead of a global NumTrue, then
-    // having each block filled in separate threads below.
     int64_t found_true = 0;
 
 #define HANDLE_DIM(NDIM)                                                      \
@@ -181,16 +220,115 @@ class WhereCPUOp : public OpKernel {
     }
 #undef HANDLE_DIM
 
-    OP_REQUIRES(
-        context, found_true == num_true_t(),
-        errors::InvalidArgument(
-            "WhereOp: Race condition between counting the number of true "
-            "elements and writing them.  When counting, saw ",
-            num_true_t(), " elements; but when writing their indices, saw ",
-            found_true, " elements."));
+    OP_REQUIRES(context, found_true == num_true_t(),
+                RaceConditionError(num_true_t(), found_true));
   }
 
  private:
+  // Inputs are split in blocks of at least this many elements...
+  static constexpr int64_t kMinElementsPerBlock = 32768;
+  // ... and in at most this many blocks per thread, so that the blocks with
+  // many true values do not delay the others too much.
+  static constexpr int64_t kBlocksPerThread = 4;
+
+  static Status RaceConditionError(int64_t num_true, int64_t found_true) {
+    return errors::InvalidArgument(
+        "WhereOp: Race condition between counting the number of true "
+        "elements and writing them.  When counting, saw ",
+        num_true, " elements; but when writing their indices, saw ",
+        found_true, " elements.");
+  }
+
+  // Counts the true values of each block of the input in parallel, and then
+  // writes their indices in parallel, each block from the row given by the
+  // exclusive prefix sum of the counts.
+  void ComputeInBlocks(OpKernelContext* context, const Tensor& input,
+                       int64_t num_blocks) {
+    const int input_dims = input.dims();
+    const int64_t num_elements = input.NumElements();
+    const int64_t block_size = Eigen::divup(num_elements, num_blocks);
+    const T* data = input.flat<T>().data();
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+
+    // The rows of the output of each block, from block_rows[b] to
+    // block_rows[b + 1].
+    std::vector<int64_t> block_rows(num_blocks + 1, 0);
+    auto count = [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; ++b) {
+        block_rows[b + 1] = functor::CountAccumulator<T>(
+            data + b * block_size,
+            data + std::min(num_elements, (b + 1) * block_size));
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          block_size * Eigen::TensorOpCost::AddCost<T>(), count);
+    std::partial_sum(block_rows.begin(), block_rows.end(), block_rows.begin());
+    const int64_t num_true = block_rows[num_blocks];
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                0, TensorShape({num_true, input_dims}),
+                                &output));
+
+    std::vector<int64_t> found_true(num_blocks);
+    switch (input_dims) {
+#define HANDLE_DIM(NDIM)                                                     \
+  case NDIM:                                                                 \
+    WriteBlocks<NDIM>(worker_threads, input, block_size, block_rows, output, \
+                      &found_true);                                          \
+    break;
+
+      HANDLE_DIM(1);
+      HANDLE_DIM(2);
+      HANDLE_DIM(3);
+      HANDLE_DIM(4);
+      HANDLE_DIM(5);
+      HANDLE_DIM(6);
+      HANDLE_DIM(7);
+      HANDLE_DIM(8);
+#undef HANDLE_DIM
+
+      default:
+        OP_REQUIRES(context, false,
+                    errors::InvalidArgument(
+                        "WhereOp : Unhandled input dimensions: ", input_dims));
+    }
+
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      if (found_true[b] != block_rows[b + 1] - block_rows[b]) {
+        context->SetStatus(RaceConditionError(
+            num_true, std::accumulate(found_true.begin(), found_true.end(),
+                                      int64_t{0})));
+        return;
+      }
+    }
+  }
+
+  template <int NDIM>
+  static void WriteBlocks(
+      const DeviceBase::CpuWorkerThreads& worker_threads, const Tensor& input,
+      int64_t block_size, const std::vector<int64_t>& block_rows,
+      Tensor* output, std::vector<int64_t>* found_true) {
+    const int64_t num_blocks = found_true->size();
+    const int64_t num_elements = input.NumElements();
+    auto write = [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; ++b) {
+        (*found_true)[b] =
+            functor::Where<CPUDevice, NDIM, T, int64_t>::ComputeRange(
+                input.tensor<T, NDIM>(), output->matrix<int64_t>(),
+                b * block_size, std::min(num_elements, (b + 1) * block_size),
+                block_rows[b], block_rows[b + 1]);
+      }
+    };
+    const int64_t cost_per_block =
+        block_size * Eigen::TensorOpCost::AddCost<T>() +
+        (block_rows[num_blocks] / num_blocks) * NDIM *
+            (Eigen::TensorOpCost::DivCost<int64_t>() + sizeof(int64_t));
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, write);
+  }
+
   WhereCPUOp(const WhereCPUOp&) = delete;
   void operator=(const WhereCPUOp&) = delete;
 };
@@ -371,6 +371,48 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
+TEST(ThreadPool, Stats) {
+  constexpr int kNumTasks = 100;
+  ThreadPool::Options options;
+  options.collect_stats = true;
+  {
+    ThreadPool pool(Env::Default(), ThreadOptions(), "stats_test", kNumThreads,
+                    options);
+    absl::BlockingCounter counter(2 * kNumTasks);
+    for (int i = 0; i < kNumTasks; ++i) {
+      // Each task schedules another from a worker thread, which is stealable.
+      pool.Schedule([&]() {
+        pool.Schedule([&]() { counter.DecrementCount(); });
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+
+    absl::optional<ThreadPool::Stats> stats = pool.GetStats();
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->tasks_scheduled, 2 * kNumTasks);
+    EXPECT_GE(stats->stealable_tasks, kNumTasks);
+    EXPECT_LE(stats->stolen_tasks, stats->stealable_tasks);
+    int64_t num_latencies = 0;
+    for (int64_t count : stats->wakeup_latency_us) num_latencies += count;
+    EXPECT_EQ(num_latencies, stats->tasks_executed);
+
+    bool found = false;
+    ThreadPool::ForEachPoolStats(
+        [&](const std::string& name, const ThreadPool::Stats&) {
+          if (name == "stats_test") found = true;
+        });
+    EXPECT_TRUE(found);
+  }
+
+  ThreadPool pool(Env::Default(), "no_stats_test", kNumThreads);
+  EXPECT_FALSE(pool.GetStats().has_value());
+  ThreadPool::ForEachPoolStats(
+      [](const std::string& name, const ThreadPool::Stats&) {
+        EXPECT_NE(name, "no_stats_test");
+      });
+}
+
 static void BM_Sequential(::testing::benchmark::State& state) {
   for (auto s : state) {
     state.PauseTiming();
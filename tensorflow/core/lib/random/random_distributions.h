@@ -26,12 +26,15 @@ namespace tensorflow {
 namespace random {
 // NOLINTBEGIN(misc-unused-using-decls)
 using tsl::random::BoxMullerDouble;
+using tsl::random::BoxMullerFloat;
 using tsl::random::NormalDistribution;
 using tsl::random::SignedAdd;
 using tsl::random::SingleSampleAdapter;
 using tsl::random::TruncatedNormalDistribution;
 using tsl::random::Uint16ToGfloat16;
 using tsl::random::Uint16ToHalf;
+using tsl::random::Uint32ToFloat;
+using tsl::random::Uint64ToDouble;
 using tsl::random::UniformDistribution;
 using tsl::random::UniformFullIntDistribution;
 // NOLINTEND(misc-unused-using-decls)
@@ -144,6 +144,7 @@ void NcclCommunicator::Enqueue(std::shared_ptr<CollectiveContext> col_ctx,
         participant->done_callback(s);
         return;
       }
+      participant->epilogue = col_params->epilogue;
       nccl_manager_.AddToAllReduce(std::move(participant), context,
                                    reduction_op);
       break;
@@ -903,13 +903,19 @@ void NcclManager::LoopKernelLaunches(NcclStream* nccl_stream) {
       }
     }
 
+    Status epilogue_status;
+    if (nccl_result == ncclSuccess && p->epilogue) {
+      profiler::TraceMe traceme("NcclEpilogue");
+      epilogue_status = p->epilogue(comm_stream);
+    }
+
     // Run the done_callback when the nccl kernel finishes running.
-    auto done_callback = [collective, p_idx, nccl_result]() {
+    auto done_callback = [collective, p_idx, nccl_result, epilogue_status]() {
       VLOG(2) << "done Nccl kernel collective_key "
               << collective->collective_key << " participant " << p_idx
               << " ncclResult " << nccl_result;
       if (nccl_result == ncclSuccess) {
-        collective->participants[p_idx]->done_callback(OkStatus());
+        collective->participants[p_idx]->done_callback(epilogue_status);
       } else {
         // Propagate the error, but note that if other members of the collective
         // did launch their kernels, then they are hanging.
@@ -132,6 +132,12 @@ class NcclManager {
 
     // True if this is the root of the collective, e.g. source of broadcast.
     bool root;
+
+    // If set, called on the communication thread right after the NCCL kernel
+    // has been enqueued, to enqueue more work on the communication stream,
+    // e.g. kernels which consume `output` in place. `done_callback` gets its
+    // error, if any, and is not called until that work completes.
+    std::function<Status(se::Stream* stream)> epilogue;
   };
 
   // Data that provides context for the collective operation, including the
@@ -284,4 +284,33 @@ REGISTER_OP("CollectiveAllToAllV3")
     .SetIsDistributedCommunication()
     .SetShapeFn(shape_inference::UnchangedShape);
 
+// Sums `input`, the gradient of `var`, across the group into `data` and applies
+// it to `var` with `optimizer`, which takes `slots` and `hyperparams` in the
+// order of the ResourceApply* ops: nothing and `lr` for 'GradientDescent',
+// `accum` and `lr, momentum` for 'Momentum', `m, v` and
+// `beta1_power, beta2_power, lr, beta1, beta2, epsilon` for 'Adam'. With
+// final_op 'Div', the update uses the mean gradient, but `data` is the sum.
+// With NCCL, the update runs on the NCCL stream right after the reduction.
+REGISTER_OP("_CollectiveReduceApply")
+    .Input("input: T")
+    .Output("data: T")
+    .Attr("T: {float, float64}")
+    .Input("group_size: int32")
+    .Input("group_key: int32")
+    .Input("instance_key: int32")
+    .Input("var: resource")
+    .Input("slots: num_slots * resource")
+    .Input("hyperparams: num_hyperparams * T")
+    .Attr("optimizer: {'GradientDescent', 'Momentum', 'Adam'}")
+    .Attr("num_slots: int >= 0")
+    .Attr("num_hyperparams: int >= 1")
+    .Attr("final_op: {'Id', 'Div'}")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .Attr("communication_hint: string = 'auto'")
+    .Attr("timeout_seconds: float = 0")
+    .SetIsStateful()
+    .SetIsDistributedCommunication()
+    .SetShapeFn(shape_inference::UnchangedShape);
+
 }  // namespace tensorflow
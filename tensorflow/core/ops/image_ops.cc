@@ -526,6 +526,40 @@ REGISTER_OP("DecodeAndCropJpeg")
       return OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("_DecodeAndResizeJpeg")
+    .Input("contents: string")
+    .Input("crop_window: int32")
+    .Input("size: int32")
+    .Output("resized_images: float")
+    .Attr("channels: int = 3")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Attr("half_pixel_centers: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      ShapeHandle crop_window;
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(1), 2, &crop_window));
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      return SetOutputToSizedImage(c, c->Dim(contents, 0),
+                                   2 /* size_input_idx */,
+                                   c->MakeDim(channels));
+    })
+    .Doc(R"doc(
+Decodes a batch of JPEG images, optionally crops them, and resizes them to
+`size` with bilinear interpolation. Each image is decoded with the smallest
+scaled IDCT of libjpeg (1/2, 1/4 or 1/8) that still yields at least `size`
+pixels in its crop window, so that large images are never decoded at full
+resolution. `crop_window` is `[0]` to decode whole images, `[4]` to crop all
+images to the same `[y, x, height, width]` window, or `[batch, 4]`. `channels`
+must be 1 or 3.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
@@ -1210,6 +1210,32 @@ Status SparseSegmentReductionShapeFn(InferenceContext* c) {
   return OkStatus();
 }
 
+Status FusedGatherSparseSegmentReduceShapeFn(InferenceContext* c) {
+  ShapeHandle params_shape;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &params_shape));
+
+  ShapeHandle unused;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+
+  ShapeHandle indices_shape;
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+
+  // indices, segment_ids and the weights, if any, should merge cleanly.
+  TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(3), &indices_shape));
+  for (int i = 4; i < c->num_inputs(); ++i) {
+    TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(i), &indices_shape));
+  }
+
+  ShapeHandle subshape;
+  TF_RETURN_IF_ERROR(c->Subshape(params_shape, 1, &subshape));
+
+  ShapeHandle out;
+  TF_RETURN_IF_ERROR(
+      c->Concatenate(c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+  c->set_output(0, out);
+  return OkStatus();
+}
+
 Status SparseSegmentReductionGradShapeFnImpl(InferenceContext* c,
                                              bool outputs_unique_indices) {
   ShapeHandle data_shape;
@@ -1569,6 +1595,31 @@ REGISTER_OP("SparseSegmentSqrtNGradV2")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradV2ShapeFn);
 
+REGISTER_OP("_FusedGatherSparseSegmentReduce")
+    .Input("params: T")
+    .Input("gather_indices: Tindices")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("weights: num_weights * T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("Tindices: {int32, int64} = DT_INT32")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("num_weights: int >= 0 = 0")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn(FusedGatherSparseSegmentReduceShapeFn)
+    .Doc(R"doc(
+Computes SparseSegmentSum, SparseSegmentMean or SparseSegmentSqrtN, depending
+on `combiner`, of `Gather(params, gather_indices)` without materializing the
+gathered rows. If `num_weights` is 1, each row is scaled by the matching entry
+of `weights`, and the mean and sqrtn combiners divide by the sum, respectively
+the square root of the sum of squares, of the weights of the segment.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -2119,6 +2170,51 @@ REGISTER_OP("Requantize")
       return OkStatus();
     });
 
+REGISTER_OP("_FusedDequantizeQuantize")
+    .Input("input: Tinput")
+    .Input("input_min: float")
+    .Input("input_max: float")
+    .Input("min_range: float")
+    .Input("max_range: float")
+    .Output("output: T")
+    .Output("output_min: float")
+    .Output("output_max: float")
+    .Attr("Tinput: {qint8, quint8}")
+    .Attr("T: {qint8, quint8}")
+    .Attr("input_mode: {'MIN_COMBINED', 'SCALED'} = 'MIN_COMBINED'")
+    .Attr("input_narrow_range: bool = false")
+    .Attr("mode: {'MIN_COMBINED', 'SCALED'} = 'MIN_COMBINED'")
+    .Attr(
+        "round_mode: {'HALF_AWAY_FROM_ZERO', 'HALF_TO_EVEN'} = "
+        "'HALF_AWAY_FROM_ZERO'")
+    .Attr("narrow_range: bool = false")
+    .Attr("ensure_minimum_range: float = 0.01")
+    .Attr(
+        "activation: {'Identity', 'Relu', 'Relu6', 'LeakyRelu', 'Sigmoid', "
+        "'Tanh'} = 'Identity'")
+    .Attr("leakyrelu_alpha: float = 0.2")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::UnchangedShape(c));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
+      c->set_output(1, c->Scalar());
+      c->set_output(2, c->Scalar());
+      return OkStatus();
+    })
+    .Doc(R"doc(
+Computes QuantizeV2(activation(Dequantize(input, input_min, input_max)),
+min_range, max_range) for per-tensor ranges. The attributes prefixed with
+`input_` are the ones of the Dequantize, the others the ones of the QuantizeV2.
+There are only 256 possible input values, so the output of each of them is
+computed once, and the input is mapped to the output through that table.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("RequantizationRange")
     .Input("input: Tinput")
     .Input("input_min: float")
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -92,6 +93,56 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const string input = CreateTestFile(env_, filename, 10);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  char scratch[4];
+  Status status;
+  StringPiece result;
+  Notification done;
+  f->ReadAsync(8, 4, scratch, [&](const Status& s, StringPiece r) {
+    status = s;
+    result = r;
+    done.Notify();
+  });
+  done.WaitForNotification();
+  // Reading past EOF gives an OUT_OF_RANGE error, as for Read().
+  EXPECT_EQ(error::OUT_OF_RANGE, status.code());
+  EXPECT_EQ(input.substr(8), result);
+}
+
+TEST_F(DefaultEnvTest, ReadV) {
+  const string filename = io::JoinPath(BaseDir(), "read_v");
+  const string input = CreateTestFile(env_, filename, 10);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  char scratch[3][5];
+  std::vector<RandomAccessFile::ReadRequest> requests(3);
+  const size_t offsets[] = {0, 5, 8};
+  for (int i = 0; i < 3; ++i) {
+    requests[i].offset = offsets[i];
+    requests[i].n = 4;
+    requests[i].scratch = scratch[i];
+  }
+  // The status of the first read that failed is returned.
+  EXPECT_EQ(error::OUT_OF_RANGE, f->ReadV(&requests).code());
+  TF_EXPECT_OK(requests[0].status);
+  EXPECT_EQ(input.substr(0, 4), requests[0].result);
+  TF_EXPECT_OK(requests[1].status);
+  EXPECT_EQ(input.substr(5, 4), requests[1].result);
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[2].status.code());
+  EXPECT_EQ(input.substr(8), requests[2].result);
+
+  requests.resize(2);
+  TF_EXPECT_OK(f->ReadV(&requests));
+  std::vector<RandomAccessFile::ReadRequest> no_requests;
+  TF_EXPECT_OK(f->ReadV(&no_requests));
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
@@ -15,9 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/multi_xplanes_to_op_stats.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/convert/op_stats_combiner.h"
 #include "tensorflow/core/profiler/convert/preprocess_single_host_xplane.h"
 #include "tensorflow/core/profiler/convert/repository.h"
@@ -29,37 +39,119 @@ limitations under the License.
 namespace tensorflow {
 namespace profiler {
 
-Status ConvertMultiXSpacesToCombinedOpStats(
-    const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
-    OpStats* combined_op_stats) {
-  // Read multiple XSpaces and convert to multiple OpStats.
-  // TODO(profiler): Change the combiner to convert and combine one OpStats at a
-  // time, to reduce peak memory usage.
-  std::vector<OpStats> all_op_stats;
-  all_op_stats.reserve(session_snapshot.XSpaceSize());
-  for (int i = 0; i < session_snapshot.XSpaceSize(); i++) {
-    TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
-                        session_snapshot.GetXSpace(i));
-    PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
-                               /*derived_timeline=*/false);
-    all_op_stats.push_back(ConvertXSpaceToOpStats(*xspace, options));
+namespace {
+
+// Converts the XSpaces of a session in parallel, and combines their OpStats in
+// the order of the hosts as soon as they are converted.
+class MultiXSpacesConverter {
+ public:
+  MultiXSpacesConverter(const SessionSnapshot& session_snapshot,
+                        const OpStatsOptions& options,
+                        const MultiXSpacesConversionOptions& conversion_options,
+                        OpStats* combined_op_stats)
+      : session_snapshot_(session_snapshot),
+        options_(options),
+        conversion_options_(conversion_options),
+        converted_(session_snapshot.XSpaceSize()),
+        combiner_(combined_op_stats) {}
+
+  Status Run() {
+    const int64_t max_bytes =
+        std::max<int64_t>(conversion_options_.max_bytes_in_flight, 1);
+    {
+      thread::ThreadPool pool(Env::Default(), "convert_xspaces",
+                              std::max(conversion_options_.max_parallelism, 1));
+      for (size_t i = 0; i < session_snapshot_.XSpaceSize(); ++i) {
+        // An XSpace of unknown size is converted alone.
+        StatusOr<uint64_t> size = session_snapshot_.GetXSpaceByteSize(i);
+        const int64_t bytes =
+            size.ok() ? std::min<uint64_t>(*size, max_bytes) : max_bytes;
+        mutex_lock l(mu_);
+        while (status_.ok() && bytes_in_flight_ > 0 &&
+               bytes_in_flight_ + bytes > max_bytes) {
+          cv_.wait(l);
+        }
+        if (!status_.ok()) break;
+        bytes_in_flight_ += bytes;
+        pool.Schedule([this, i, bytes]() { Convert(i, bytes); });
+      }
+    }
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    // Do not limit the maximum number of steps during the merge of OpStats.
+    combiner_.Finalize(kuint32max);
+    return OkStatus();
   }
 
-  // Combine OpStats.
-  std::vector<OpStatsInfo> all_op_stats_info;
-  all_op_stats_info.reserve(all_op_stats.size());
-  for (int i = 0; i < all_op_stats.size(); i++) {
-    all_op_stats_info.emplace_back(
-        &all_op_stats[i],
-        ParseHardwareType(all_op_stats[i].run_environment().device_type()), i);
+ private:
+  void Convert(size_t index, int64_t bytes) {
+    Status status;
+    OpStats op_stats;
+    {
+      StatusOr<std::unique_ptr<XSpace>> xspace =
+          session_snapshot_.GetXSpace(index);
+      if (xspace.ok()) {
+        PreprocessSingleHostXSpace(xspace->get(), /*step_grouping=*/true,
+                                   /*derived_timeline=*/false);
+        op_stats = ConvertXSpaceToOpStats(**xspace, options_);
+      } else {
+        status = xspace.status();
+      }
+    }
+    mutex_lock l(mu_);
+    bytes_in_flight_ -= bytes;
+    status_.Update(status);
+    if (status.ok()) {
+      converted_[index] = std::move(op_stats);
+      CombineConverted();
+    }
+    cv_.notify_all();
   }
 
-  // Do not limit the maximum number of steps during the merge of OpStats.
-  StepIntersection step_intersection =
-      ComputeStepIntersectionToMergeOpStats(all_op_stats_info, kuint32max);
-  CombineAllOpStats(all_op_stats_info, step_intersection, combined_op_stats);
+  // Combines the converted OpStats that follow the combined ones.
+  void CombineConverted() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (num_combined_ < converted_.size() &&
+           converted_[num_combined_].has_value()) {
+      OpStats& op_stats = *converted_[num_combined_];
+      const HardwareType hardware_type =
+          ParseHardwareType(op_stats.run_environment().device_type());
+      combiner_.Add(std::move(op_stats), hardware_type, num_combined_);
+      converted_[num_combined_].reset();
+      ++num_combined_;
+    }
+  }
+
+  const SessionSnapshot& session_snapshot_;
+  const OpStatsOptions& options_;
+  const MultiXSpacesConversionOptions& conversion_options_;
+
+  mutex mu_;
+  condition_variable cv_;
+  Status status_ TF_GUARDED_BY(mu_);
+  int64_t bytes_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // The OpStats converted but not combined yet, by host.
+  std::vector<std::optional<OpStats>> converted_ TF_GUARDED_BY(mu_);
+  size_t num_combined_ TF_GUARDED_BY(mu_) = 0;
+  OpStatsStreamCombiner combiner_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
 
-  return OkStatus();
+Status ConvertMultiXSpacesToCombinedOpStats(
+    const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
+    const MultiXSpacesConversionOptions& conversion_options,
+    OpStats* combined_op_stats) {
+  MultiXSpacesConverter converter(session_snapshot, options,
+                                  conversion_options, combined_op_stats);
+  return converter.Run();
+}
+
+Status ConvertMultiXSpacesToCombinedOpStats(
+    const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
+    OpStats* combined_op_stats) {
+  return ConvertMultiXSpacesToCombinedOpStats(
+      session_snapshot, options, MultiXSpacesConversionOptions(),
+      combined_op_stats);
 }
 
 }  // namespace profiler
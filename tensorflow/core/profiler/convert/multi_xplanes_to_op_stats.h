@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_CONVERT_MULTI_XPLANES_TO_OP_STATS_H_
 #define TENSORFLOW_CORE_PROFILER_CONVERT_MULTI_XPLANES_TO_OP_STATS_H_
 
+#include <cstdint>
+
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/profiler/convert/repository.h"
 #include "tensorflow/core/profiler/convert/xplane_to_op_stats.h"
@@ -24,10 +26,29 @@ limitations under the License.
 namespace tensorflow {
 namespace profiler {
 
+// How ConvertMultiXSpacesToCombinedOpStats bounds its memory use.
+struct MultiXSpacesConversionOptions {
+  // The number of XSpaces converted in parallel.
+  int max_parallelism = 4;
+  // The total serialized size of the XSpaces being converted at a time. One
+  // XSpace is converted at least, however large it is.
+  int64_t max_bytes_in_flight = int64_t{4} << 30;
+};
+
 // Converts and combines multiple XSpace protos into a single OpStats
 // <combined_op_stats>.
+// The XSpaces are read and converted in parallel, within the limits of
+// <conversion_options>, and each OpStats is combined as soon as the ones of the
+// previous hosts are, so neither all the XSpaces nor all the OpStats are in
+// memory at once.
 // Return the first error status during conversion, or return OkStatus() if
 // there is no error.
+Status ConvertMultiXSpacesToCombinedOpStats(
+    const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
+    const MultiXSpacesConversionOptions& conversion_options,
+    OpStats* combined_op_stats);
+
+// As above, with the default MultiXSpacesConversionOptions.
 Status ConvertMultiXSpacesToCombinedOpStats(
     const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
     OpStats* combined_op_stats);
@@ -33,6 +33,14 @@ void CombinePrecisionStats(const PrecisionStats& src, PrecisionStats* dst) {
   dst->set_compute_32bit_ps(src.compute_32bit_ps() + dst->compute_32bit_ps());
 }
 
+void CombineCpuCounters(const OpMetrics::CpuCounters& src,
+                        OpMetrics::CpuCounters* dst) {
+  dst->set_occurrences(src.occurrences() + dst->occurrences());
+  dst->set_cycles(src.cycles() + dst->cycles());
+  dst->set_instructions(src.instructions() + dst->instructions());
+  dst->set_llc_misses(src.llc_misses() + dst->llc_misses());
+}
+
 }  // namespace
 
 void CopyOpMetricsMetadata(const OpMetrics& src, OpMetrics* dst) {
@@ -80,6 +88,9 @@ void CombineOpMetrics(const OpMetrics& src, OpMetrics* dst,
   CombineMemoryAccessedBreakdown(src.memory_accessed_breakdown(),
                                  dst->mutable_memory_accessed_breakdown());
   dst->set_dma_stall_ps(src.dma_stall_ps() + dst->dma_stall_ps());
+  if (src.has_cpu_counters()) {
+    CombineCpuCounters(src.cpu_counters(), dst->mutable_cpu_counters());
+  }
 }
 
 void CombineMemoryAccessedBreakdown(
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -151,14 +152,11 @@ void CombineDiagnostics(const Diagnostics& src, Diagnostics* dst) {
   dst->mutable_errors()->MergeFrom(src.errors());
 }
 
-// Combine the src OpStats into the dst OpStats.
-void CombineOpStats(
-    bool no_accelerator_in_system, int src_host_id, HardwareType hardware_type,
-    const StepIntersection& step_intersection, const OpStats& src, OpStats* dst,
+// Combines everything of the src OpStats but its step_db into the dst OpStats.
+void CombineOpStatsExceptStepDb(
+    int src_host_id, const OpStats& src, OpStats* dst,
     OpMetricsDbCombiner* host_op_metrics_db_combiner,
-    OpMetricsDbCombiner* device_op_metrics_db_combiner,
-    OpMetricsDbCombiner* hlo_metrics_db_complete_steps_only_combiner,
-    std::vector<OpMetricsDbCombiner>* hlo_metrics_db_per_step_combiners) {
+    OpMetricsDbCombiner* device_op_metrics_db_combiner) {
   // Combine host_metrics_db.
   // Host OpMetricsDb does not need to update the number of cores a certain op
   // occurs.
@@ -167,14 +165,6 @@ void CombineOpStats(
   // Combine device_metrics_db.
   device_op_metrics_db_combiner->Combine(src.device_op_metrics_db());
 
-  // Combine step_db.
-  if (!IsCoordinator(no_accelerator_in_system, hardware_type)) {
-    CombineStepDatabase(src_host_id, step_intersection, src.step_db(),
-                        dst->mutable_step_db(),
-                        hlo_metrics_db_complete_steps_only_combiner,
-                        hlo_metrics_db_per_step_combiners);
-  }
-
   // Combine run environment info.
   CombineRunEnvironment(src.run_environment(), dst->mutable_run_environment());
 
@@ -202,6 +192,66 @@ void CombineOpStats(
           src.performance_counter_result().matrix_unit_utilization_percent());
 }
 
+// Combine the src OpStats into the dst OpStats.
+void CombineOpStats(
+    bool no_accelerator_in_system, int src_host_id, HardwareType hardware_type,
+    const StepIntersection& step_intersection, const OpStats& src, OpStats* dst,
+    OpMetricsDbCombiner* host_op_metrics_db_combiner,
+    OpMetricsDbCombiner* device_op_metrics_db_combiner,
+    OpMetricsDbCombiner* hlo_metrics_db_complete_steps_only_combiner,
+    std::vector<OpMetricsDbCombiner>* hlo_metrics_db_per_step_combiners) {
+  // Combine step_db.
+  if (!IsCoordinator(no_accelerator_in_system, hardware_type)) {
+    CombineStepDatabase(src_host_id, step_intersection, src.step_db(),
+                        dst->mutable_step_db(),
+                        hlo_metrics_db_complete_steps_only_combiner,
+                        hlo_metrics_db_per_step_combiners);
+  }
+
+  CombineOpStatsExceptStepDb(src_host_id, src, dst,
+                             host_op_metrics_db_combiner,
+                             device_op_metrics_db_combiner);
+}
+
+// Initializes the fields of the combined step_db that depend on the steps in
+// <step_intersection>, and returns the combiners of their OpMetricsDbs.
+std::vector<OpMetricsDbCombiner> InitializeCombinedStepDb(
+    const StepIntersection& step_intersection,
+    StepDatabaseResult* combined_step_db) {
+  for (uint32 dst_step_num : step_intersection.DstStepNumbers()) {
+    combined_step_db->add_step_sequence()->set_step_num(dst_step_num);
+  }
+  // Record the number of steps that are dropped.
+  combined_step_db->set_num_steps_dropped(step_intersection.StepsDropped());
+
+  combined_step_db->set_empty_intersect(step_intersection.EmptyIntersect());
+
+  std::vector<OpMetricsDbCombiner> hlo_metrics_db_per_step_combiners;
+  hlo_metrics_db_per_step_combiners.reserve(
+      combined_step_db->step_sequence_size());
+  for (PerCoreStepInfo& step_info :
+       *combined_step_db->mutable_step_sequence()) {
+    hlo_metrics_db_per_step_combiners.emplace_back(
+        step_info.mutable_hlo_metrics_db());
+  }
+  return hlo_metrics_db_per_step_combiners;
+}
+
+// Finishes the fields combined from <num_hosts> hosts.
+void FinalizeCombinedOpStats(size_t num_hosts, OpStats* combined_op_stats) {
+  // Sorts all the kernel reports that have been merged by CombineTfOpStats and
+  // keeps only the top kernel reports with long kernel duration.
+  SortAndKeepTopKDurationKernelReportsInDb(
+      combined_op_stats->mutable_kernel_stats_db());
+
+  // Process performance counter results.
+  combined_op_stats->mutable_performance_counter_result()
+      ->set_matrix_unit_utilization_percent(
+          combined_op_stats->performance_counter_result()
+              .matrix_unit_utilization_percent() /
+          num_hosts);
+}
+
 }  // namespace
 
 bool IsCoordinator(bool no_accelerator_in_system, HardwareType hardware_type) {
@@ -252,32 +302,17 @@ void CombineAllOpStats(const std::vector<OpStatsInfo>& all_op_stats_info,
     return;
   }
 
-  StepDatabaseResult* combined_step_db = combined_op_stats->mutable_step_db();
   // Initialize the StepDatabaseResult field that depends on the number of
-  // steps.
-  for (uint32 dst_step_num : step_intersection.DstStepNumbers()) {
-    combined_step_db->add_step_sequence()->set_step_num(dst_step_num);
-  }
-  // Record the number of steps that are dropped.
-  combined_step_db->set_num_steps_dropped(step_intersection.StepsDropped());
-
-  combined_step_db->set_empty_intersect(step_intersection.EmptyIntersect());
-
-  // Initialize all the OpMetricsDbCombiners.
+  // steps, and all the OpMetricsDbCombiners.
+  std::vector<OpMetricsDbCombiner> hlo_metrics_db_per_step_combiners =
+      InitializeCombinedStepDb(step_intersection,
+                               combined_op_stats->mutable_step_db());
   OpMetricsDbCombiner host_op_metrics_db_combiner(
       combined_op_stats->mutable_host_op_metrics_db());
   OpMetricsDbCombiner device_op_metrics_db_combiner(
       combined_op_stats->mutable_device_op_metrics_db());
   OpMetricsDbCombiner hlo_metrics_db_complete_steps_only_combiner(
       combined_op_stats->mutable_hlo_metrics_db_complete_steps_only());
-  std::vector<OpMetricsDbCombiner> hlo_metrics_db_per_step_combiners;
-  hlo_metrics_db_per_step_combiners.reserve(
-      combined_step_db->step_sequence_size());
-  for (PerCoreStepInfo& step_info :
-       *combined_step_db->mutable_step_sequence()) {
-    hlo_metrics_db_per_step_combiners.emplace_back(
-        step_info.mutable_hlo_metrics_db());
-  }
 
   bool no_accelerator_in_system = NoAcceleratorInSystem(all_op_stats_info);
 
@@ -290,17 +325,82 @@ void CombineAllOpStats(const std::vector<OpStatsInfo>& all_op_stats_info,
                    &hlo_metrics_db_per_step_combiners);
   }
 
-  // Sorts all the kernel reports that have been merged by CombineTfOpStats and
-  // keeps only the top kernel reports with long kernel duration.
+  FinalizeCombinedOpStats(all_op_stats_info.size(), combined_op_stats);
+}
+
+OpStatsStreamCombiner::OpStatsStreamCombiner(OpStats* combined_op_stats)
+    : combined_op_stats_(combined_op_stats),
+      host_op_metrics_db_combiner_(
+          combined_op_stats->mutable_host_op_metrics_db()),
+      device_op_metrics_db_combiner_(
+          combined_op_stats->mutable_device_op_metrics_db()) {}
+
+void OpStatsStreamCombiner::Add(OpStats op_stats, HardwareType hardware_type,
+                                int src_host_id) {
+  if (host_step_dbs_.empty() && !first_op_stats_.has_value()) {
+    first_op_stats_ = std::move(op_stats);
+    first_hardware_type_ = hardware_type;
+    first_src_host_id_ = src_host_id;
+    return;
+  }
+  if (first_op_stats_.has_value()) {
+    CombineExceptStepDb(*std::move(first_op_stats_), first_hardware_type_,
+                        first_src_host_id_);
+    first_op_stats_.reset();
+  }
+  CombineExceptStepDb(std::move(op_stats), hardware_type, src_host_id);
+}
+
+void OpStatsStreamCombiner::CombineExceptStepDb(OpStats op_stats,
+                                                HardwareType hardware_type,
+                                                int src_host_id) {
+  CombineOpStatsExceptStepDb(src_host_id, op_stats, combined_op_stats_,
+                             &host_op_metrics_db_combiner_,
+                             &device_op_metrics_db_combiner_);
+  // Keeps the merged kernel reports bounded; the top ones of all the hosts are
+  // among the top ones of each prefix of them.
   SortAndKeepTopKDurationKernelReportsInDb(
-      combined_op_stats->mutable_kernel_stats_db());
+      combined_op_stats_->mutable_kernel_stats_db());
+  host_step_dbs_.push_back(
+      {hardware_type, src_host_id, std::move(*op_stats.mutable_step_db())});
+}
 
-  // Process performance counter results.
-  combined_op_stats->mutable_performance_counter_result()
-      ->set_matrix_unit_utilization_percent(
-          combined_op_stats->performance_counter_result()
-              .matrix_unit_utilization_percent() /
-          all_op_stats_info.size());
+void OpStatsStreamCombiner::Finalize(uint32 max_step_per_host) {
+  // A shortcut code path for a single OpStats. There is no need to merge.
+  if (first_op_stats_.has_value()) {
+    *combined_op_stats_ = *std::move(first_op_stats_);
+    first_op_stats_.reset();
+    return;
+  }
+  if (host_step_dbs_.empty()) return;
+
+  bool no_accelerator_in_system = true;
+  for (const HostStepDb& host : host_step_dbs_) {
+    if (HasDevice(host.hardware_type)) no_accelerator_in_system = false;
+  }
+  absl::flat_hash_map<uint32, const StepDatabaseResult*> per_host_step_db;
+  for (const HostStepDb& host : host_step_dbs_) {
+    if (IsCoordinator(no_accelerator_in_system, host.hardware_type)) continue;
+    // Includes only workers in per_host_step_db.
+    per_host_step_db[host.src_host_id] = &host.step_db;
+  }
+  StepIntersection step_intersection(max_step_per_host, per_host_step_db);
+
+  std::vector<OpMetricsDbCombiner> hlo_metrics_db_per_step_combiners =
+      InitializeCombinedStepDb(step_intersection,
+                               combined_op_stats_->mutable_step_db());
+  OpMetricsDbCombiner hlo_metrics_db_complete_steps_only_combiner(
+      combined_op_stats_->mutable_hlo_metrics_db_complete_steps_only());
+  for (const HostStepDb& host : host_step_dbs_) {
+    if (IsCoordinator(no_accelerator_in_system, host.hardware_type)) continue;
+    CombineStepDatabase(host.src_host_id, step_intersection, host.step_db,
+                        combined_op_stats_->mutable_step_db(),
+                        &hlo_metrics_db_complete_steps_only_combiner,
+                        &hlo_metrics_db_per_step_combiners);
+  }
+
+  FinalizeCombinedOpStats(host_step_dbs_.size(), combined_op_stats_);
+  host_step_dbs_.clear();
 }
 
 }  // namespace profiler
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_CONVERT_OP_STATS_COMBINER_H_
 #define TENSORFLOW_CORE_PROFILER_CONVERT_OP_STATS_COMBINER_H_
 
+#include <optional>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
 #include "tensorflow/core/profiler/protobuf/hardware_types.pb.h"
 #include "tensorflow/core/profiler/protobuf/op_stats.pb.h"
+#include "tensorflow/core/profiler/protobuf/steps_db.pb.h"
 #include "tensorflow/core/profiler/utils/step_intersection.h"
 
 namespace tensorflow {
@@ -80,6 +82,46 @@ void CombineAllOpStats(const std::vector<OpStatsInfo>& all_op_stats_info,
                        const StepIntersection& step_intersection,
                        OpStats* combined_op_stats);
 
+// Combines OpStats one host at a time, as they are converted, unlike
+// CombineAllOpStats which needs the OpStats of all the hosts at once. Only the
+// step databases of the hosts are kept until Finalize(), which combines them
+// once the step intersection of all the hosts is known.
+//
+// The result is the same as CombineAllOpStats with the hosts in the order
+// they were added.
+class OpStatsStreamCombiner {
+ public:
+  // <combined_op_stats> must be empty and outlive the combiner.
+  explicit OpStatsStreamCombiner(OpStats* combined_op_stats);
+
+  // Combines <op_stats> of host <src_host_id>, but for its step database.
+  void Add(OpStats op_stats, HardwareType hardware_type, int src_host_id);
+
+  // Combines the step databases of the hosts, using at most
+  // <max_step_per_host> steps of their intersection.
+  void Finalize(uint32 max_step_per_host);
+
+ private:
+  struct HostStepDb {
+    HardwareType hardware_type;
+    int src_host_id;
+    StepDatabaseResult step_db;
+  };
+
+  void CombineExceptStepDb(OpStats op_stats, HardwareType hardware_type,
+                           int src_host_id);
+
+  OpStats* const combined_op_stats_;
+  OpMetricsDbCombiner host_op_metrics_db_combiner_;
+  OpMetricsDbCombiner device_op_metrics_db_combiner_;
+  std::vector<HostStepDb> host_step_dbs_;
+  // A single OpStats is the combined one as is, so the first one is only
+  // combined once there is another.
+  std::optional<OpStats> first_op_stats_;
+  HardwareType first_hardware_type_ = HardwareType::UNKNOWN_HARDWARE;
+  int first_src_host_id_ = 0;
+};
+
 }  // namespace profiler
 }  // namespace tensorflow
 
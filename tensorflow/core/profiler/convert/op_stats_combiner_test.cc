@@ -80,6 +80,39 @@ TEST(CombineAllOpStatsTest, CombineRunEnvironmentWithUnknownDevice) {
   EXPECT_EQ("TPU", dst_op_stats.run_environment().device_type());
 }
 
+TEST(OpStatsStreamCombinerTest, MatchesCombineAllOpStats) {
+  OpStats op_stats_1, op_stats_2;
+  op_stats_1.mutable_run_environment()
+      ->mutable_host_independent_job_info()
+      ->set_profile_duration_ms(100);
+  op_stats_1.mutable_run_environment()->set_device_type("TPU");
+  op_stats_1.mutable_host_op_metrics_db()->set_total_op_time_ps(10);
+  op_stats_2.mutable_run_environment()
+      ->mutable_host_independent_job_info()
+      ->set_profile_duration_ms(0);
+  op_stats_2.mutable_run_environment()->set_device_type("TPU");
+  op_stats_2.mutable_host_op_metrics_db()->set_total_op_time_ps(20);
+
+  OpStats expected_op_stats;
+  OpStatsInfo op_stats_info_1(&op_stats_1, TPU, 0),
+      op_stats_info_2(&op_stats_2, TPU, 1);
+  std::vector<OpStatsInfo> all_op_stats_info = {op_stats_info_1,
+                                                op_stats_info_2};
+  StepIntersection step_intersection =
+      ComputeStepIntersectionToMergeOpStats(all_op_stats_info, kuint32max);
+  CombineAllOpStats(all_op_stats_info, step_intersection, &expected_op_stats);
+
+  OpStats streamed_op_stats;
+  OpStatsStreamCombiner combiner(&streamed_op_stats);
+  combiner.Add(op_stats_1, TPU, 0);
+  combiner.Add(op_stats_2, TPU, 1);
+  combiner.Finalize(kuint32max);
+
+  EXPECT_EQ(streamed_op_stats.SerializeAsString(),
+            expected_op_stats.SerializeAsString());
+  EXPECT_EQ(30, streamed_op_stats.host_op_metrics_db().total_op_time_ps());
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -103,6 +103,22 @@ StatusOr<std::unique_ptr<XSpace>> SessionSnapshot::GetXSpace(
   return xspace_from_file;
 }
 
+StatusOr<uint64_t> SessionSnapshot::GetXSpaceByteSize(size_t index) const {
+  if (index >= xspace_paths_.size()) {
+    return errors::InvalidArgument("Can not get the ", index,
+                                   "th XSpace. The total number of XSpace is ",
+                                   xspace_paths_.size());
+  }
+  if (xspaces_.has_value()) {
+    const std::unique_ptr<XSpace>& xspace = xspaces_->at(index);
+    return xspace == nullptr ? 0 : xspace->ByteSizeLong();
+  }
+  uint64_t size;
+  TF_RETURN_IF_ERROR(
+      tensorflow::Env::Default()->GetFileSize(xspace_paths_.at(index), &size));
+  return size;
+}
+
 StatusOr<std::unique_ptr<XSpace>> SessionSnapshot::GetXSpaceByName(
     absl::string_view name) const {
   if (auto it = hostname_map_.find(name); it != hostname_map_.end()) {
@@ -66,6 +66,10 @@ class SessionSnapshot {
   // The caller of this function will take ownership of the XSpace.
   StatusOr<std::unique_ptr<XSpace>> GetXSpace(size_t index) const;
 
+  // Gets the serialized size of the XSpace proto, without reading it.
+  // Returns 0 for a pre-loaded XSpace that was already taken.
+  StatusOr<uint64_t> GetXSpaceByteSize(size_t index) const;
+
   // Gets XSpace proto.
   // The caller of this function will take ownership of the XSpace.
   StatusOr<std::unique_ptr<XSpace>> GetXSpaceByName(
@@ -67,6 +67,9 @@ struct TfActivity {
   tsl::profiler::TfOp tf_op;
   // Whether it is eagerly executed.
   bool is_eager;
+  // The hardware performance counters of the op, if they were collected. Only
+  // set on kTfOpEnd.
+  std::optional<OpMetrics::CpuCounters> cpu_counters;
 };
 
 // TF Op metrics stored as element in OpStack.
@@ -79,6 +82,23 @@ struct TfOpInfo {
   uint64 children_duration_ps = 0;
 };
 
+// Returns the hardware performance counters attached to a TF op event.
+std::optional<OpMetrics::CpuCounters> GetCpuCounters(
+    const XEventVisitor& event) {
+  std::optional<XStatVisitor> cycles = event.GetStat(StatType::kCpuCycles);
+  if (!cycles.has_value()) return std::nullopt;
+  OpMetrics::CpuCounters cpu_counters;
+  cpu_counters.set_cycles(cycles->IntOrUintValue());
+  if (std::optional<XStatVisitor> stat =
+          event.GetStat(StatType::kCpuInstructions)) {
+    cpu_counters.set_instructions(stat->IntOrUintValue());
+  }
+  if (std::optional<XStatVisitor> stat = event.GetStat(StatType::kLlcMisses)) {
+    cpu_counters.set_llc_misses(stat->IntOrUintValue());
+  }
+  return cpu_counters;
+}
+
 // Processes a TF-activity on particular core.
 void ProcessOneTfActivity(const TfActivity& activity,
                           OpStack<TfOpInfo>* tf_op_stack,
@@ -103,7 +123,9 @@ void ProcessOneTfActivity(const TfActivity& activity,
           info->start_timestamp_ps, activity.timestamp_ps);
       tf_metrics_data->tf_metrics_db_builder.EnterOp(
           activity.tf_op.name, activity.tf_op.type, activity.is_eager,
-          tf_op_span.duration_ps(), info->children_duration_ps);
+          tf_op_span.duration_ps(), info->children_duration_ps,
+          activity.cpu_counters.has_value() ? &*activity.cpu_counters
+                                            : nullptr);
       TfOpInfo* parent_info = tf_op_stack->Top();
       if (parent_info != nullptr) {
         parent_info->children_duration_ps += tf_op_span.duration_ps();
@@ -151,10 +173,10 @@ void CollectTfActivities(
         is_eager = stat->IntValue();
       }
       tsl::profiler::Timespan span = event.GetTimespan();
-      tf_activities->push_back(
-          {span.begin_ps(), tf_op_id, kTfOpBegin, *tf_op, is_eager});
-      tf_activities->push_back(
-          {span.end_ps(), tf_op_id, kTfOpEnd, *tf_op, is_eager});
+      tf_activities->push_back({span.begin_ps(), tf_op_id, kTfOpBegin, *tf_op,
+                                is_eager, std::nullopt});
+      tf_activities->push_back({span.end_ps(), tf_op_id, kTfOpEnd, *tf_op,
+                                is_eager, GetCpuCounters(event)});
     }
   });
 }
@@ -134,6 +134,41 @@ TEST(ConvertXPlaneToOpMetricsDb, HostOpMetricsDb) {
   EXPECT_EQ(NanoToPico(kTfOp2DurationNs), op_2.time_ps());
 }
 
+TEST(ConvertXPlaneToOpMetricsDb, HostOpCpuCounters) {
+  static constexpr char kTfOp[] = "MatMul";
+  XSpace xspace;
+  XPlane* xplane = GetOrCreateHostXPlane(&xspace);
+  XPlaneBuilder host_plane(xplane);
+  XLineBuilder thread = host_plane.GetOrCreateLine(/*line_id=*/10);
+  AddTensorFlowOpEvent(absl::StrCat(kTfOp, ":", kTfOp),
+                       /*start_timestamp_ns=*/0, /*duration_ns=*/1000,
+                       /*on_device=*/false, /*kernel_name=*/"", &host_plane,
+                       &thread);
+  XEventBuilder event = thread.AddEvent(
+      *host_plane.GetOrCreateEventMetadata(absl::StrCat(kTfOp, ":", kTfOp)));
+  event.SetTimestampNs(2000);
+  event.SetDurationNs(1000);
+  event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                         GetStatTypeStr(StatType::kCpuCycles)),
+                     uint64{3000});
+  event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                         GetStatTypeStr(StatType::kCpuInstructions)),
+                     uint64{6000});
+  event.AddStatValue(*host_plane.GetOrCreateStatMetadata(
+                         GetStatTypeStr(StatType::kLlcMisses)),
+                     uint64{10});
+
+  OpMetricsDb op_metrics = ConvertHostThreadsXPlaneToOpMetricsDb(*xplane);
+  const OpMetrics& op = op_metrics.metrics_db().at(0);
+  EXPECT_EQ(kTfOp, op.name());
+  EXPECT_EQ(2, op.occurrences());
+  // Only the second occurrence has counters.
+  EXPECT_EQ(1, op.cpu_counters().occurrences());
+  EXPECT_EQ(3000, op.cpu_counters().cycles());
+  EXPECT_EQ(6000, op.cpu_counters().instructions());
+  EXPECT_EQ(10, op.cpu_counters().llc_misses());
+}
+
 TEST(ConvertXPlaneToOpMetricsDb, DeviceOpMetricsDb) {
   // TfOp1 has kernel1 and kernel2; TfOp2 has kernel3.
   static constexpr char kTfOp1[] = "TfOp1";
@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/utils/op_stats_sampler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/utils/math_utils.h"
+#include "tensorflow/core/profiler/utils/op_metrics_db_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Counters don't go back between the collections of one Start(), but a delta
+// is clamped at 0 rather than wrapped around regardless.
+uint64 Delta(uint64 value, uint64 previous) {
+  return value > previous ? value - previous : 0;
+}
+
+}  // namespace
+
+OpStatsRecorder::Totals SubtractOpStats(
+    const OpStatsRecorder::Totals& totals,
+    const OpStatsRecorder::Totals& previous) {
+  OpStatsRecorder::Totals delta;
+  for (const auto& name_and_stats : totals.ops) {
+    OpStatsRecorder::OpStats stats = name_and_stats.second;
+    auto it = previous.ops.find(name_and_stats.first);
+    if (it != previous.ops.end()) {
+      const OpStatsRecorder::OpStats& previous_stats = it->second;
+      stats.count = Delta(stats.count, previous_stats.count);
+      stats.total_ns = Delta(stats.total_ns, previous_stats.total_ns);
+      for (int i = 0; i < OpStatsRecorder::kNumBuckets; ++i) {
+        stats.buckets[i] = Delta(stats.buckets[i], previous_stats.buckets[i]);
+      }
+    }
+    if (stats.count == 0) continue;
+    delta.ops.emplace(name_and_stats.first, std::move(stats));
+  }
+  delta.num_dropped = Delta(totals.num_dropped, previous.num_dropped);
+  return delta;
+}
+
+OpMetricsDb ConvertOpStatsToOpMetricsDb(const OpStatsRecorder::Totals& stats) {
+  OpMetricsDb db;
+  uint64 total_op_time_ps = 0;
+  for (const auto& name_and_stats : stats.ops) {
+    const OpStatsRecorder::OpStats& op_stats = name_and_stats.second;
+    OpMetrics* metrics = db.add_metrics_db();
+    metrics->set_name(op_stats.name);
+    metrics->set_category(op_stats.type);
+    metrics->set_occurrences(op_stats.count);
+    metrics->set_time_ps(NanoToPico(op_stats.total_ns));
+    // Ops run by the executors don't nest.
+    metrics->set_self_time_ps(metrics->time_ps());
+    const auto lowest_bucket =
+        std::find_if(op_stats.buckets.begin(), op_stats.buckets.end(),
+                     [](uint64 count) { return count > 0; });
+    const int bucket = lowest_bucket - op_stats.buckets.begin();
+    if (bucket > 0 && bucket < OpStatsRecorder::kNumBuckets) {
+      metrics->set_min_time_ps(NanoToPico(uint64{1} << bucket));
+    }
+    total_op_time_ps += metrics->time_ps();
+  }
+  db.set_total_op_time_ps(total_op_time_ps);
+  return db;
+}
+
+/*static*/ Status OpStatsSampler::Create(
+    Env* env, const Options& options, ExportFn export_fn, TraceFn trace_fn,
+    std::unique_ptr<OpStatsSampler>* sampler) {
+  if (options.export_interval_micros <= 0) {
+    return errors::InvalidArgument("export_interval_micros must be positive");
+  }
+  if (options.trace_every_n_intervals > 0 && trace_fn == nullptr) {
+    return errors::InvalidArgument("Sampled traces need a TraceFn");
+  }
+  if (!OpStatsRecorder::Start()) {
+    return errors::AlreadyExists("Another OpStatsSampler is running");
+  }
+  sampler->reset(new OpStatsSampler(env, options, std::move(export_fn),
+                                    std::move(trace_fn)));
+  return OkStatus();
+}
+
+OpStatsSampler::OpStatsSampler(Env* env, const Options& options,
+                               ExportFn export_fn, TraceFn trace_fn)
+    : env_(env),
+      options_(options),
+      export_fn_(std::move(export_fn)),
+      trace_fn_(std::move(trace_fn)),
+      interval_start_ns_(env->NowNanos()) {
+  thread_.reset(env_->StartThread(ThreadOptions(), "op_stats_sampler",
+                                  [this]() { SamplerLoop(); }));
+}
+
+OpStatsSampler::~OpStatsSampler() {
+  {
+    mutex_lock l(mu_);
+    stop_ = true;
+    cv_.notify_all();
+  }
+  // Joins the thread, which exports the last interval first.
+  thread_.reset();
+  OpStatsRecorder::Stop();
+}
+
+bool OpStatsSampler::WaitUntil(uint64 deadline_micros) {
+  mutex_lock l(mu_);
+  while (!stop_) {
+    const uint64 now_micros = env_->NowMicros();
+    if (now_micros >= deadline_micros) return true;
+    cv_.wait_for(l, std::chrono::microseconds(deadline_micros - now_micros));
+  }
+  return false;
+}
+
+void OpStatsSampler::SamplerLoop() {
+  uint64 next_export_micros =
+      env_->NowMicros() + options_.export_interval_micros;
+  for (int64_t interval = 1;; ++interval) {
+    if (options_.trace_every_n_intervals > 0 &&
+        interval % options_.trace_every_n_intervals == 0) {
+      Trace();
+    }
+    const bool running = WaitUntil(next_export_micros);
+    Export();
+    if (!running) return;
+    next_export_micros += options_.export_interval_micros;
+  }
+}
+
+void OpStatsSampler::Trace() {
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(options_.profile_options);
+  Status status = session->Status();
+  if (!status.ok()) {
+    VLOG(1) << "Skipped a sampled trace: " << status;
+    return;
+  }
+  WaitUntil(env_->NowMicros() + options_.trace_duration_micros);
+  XSpace space;
+  status = session->CollectData(&space);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to collect a sampled trace: " << status;
+    return;
+  }
+  trace_fn_(std::move(space));
+}
+
+void OpStatsSampler::Export() {
+  OpStatsRecorder::Totals totals = OpStatsRecorder::Collect();
+  SampledOpStats sampled;
+  sampled.start_time_ns = interval_start_ns_;
+  sampled.end_time_ns = env_->NowNanos();
+  sampled.op_stats = SubtractOpStats(totals, previous_totals_);
+  sampled.op_metrics_db = ConvertOpStatsToOpMetricsDb(sampled.op_stats);
+  SetTotalTimePs(sampled.op_metrics_db,
+                 NanoToPico(sampled.end_time_ns - sampled.start_time_ns));
+  previous_totals_ = std::move(totals);
+  interval_start_ns_ = sampled.end_time_ns;
+  export_fn_(std::move(sampled));
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_UTILS_OP_STATS_SAMPLER_H_
+#define TENSORFLOW_CORE_PROFILER_UTILS_OP_STATS_SAMPLER_H_
+
+#include <functional>
+#include <memory>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/backends/cpu/op_stats_recorder.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// The op stats of one export interval of an OpStatsSampler.
+struct SampledOpStats {
+  // When the interval started and ended, in ns since the Unix epoch.
+  uint64 start_time_ns = 0;
+  uint64 end_time_ns = 0;
+  // One OpMetrics per TF op that ran in the interval.
+  OpMetricsDb op_metrics_db;
+  // The latency histograms of the interval, by op name.
+  OpStatsRecorder::Totals op_stats;
+};
+
+// Returns `totals` minus `previous`, both collected since the same Start().
+OpStatsRecorder::Totals SubtractOpStats(
+    const OpStatsRecorder::Totals& totals,
+    const OpStatsRecorder::Totals& previous);
+
+// Converts aggregated op stats to an OpMetricsDb. The minimum time of an op is
+// the lower bound of the lowest bucket of its histogram.
+OpMetricsDb ConvertOpStatsToOpMetricsDb(const OpStatsRecorder::Totals& stats);
+
+// A continuous, low-overhead profiler for production serving.
+//
+// While it exists, OpStatsRecorder aggregates the latencies of all the ops
+// the executors run synchronously, and the sampler exports them every
+// `export_interval_micros` as an OpMetricsDb delta. Additionally, one in
+// `trace_every_n_intervals` intervals starts with a ProfilerSession of
+// `trace_duration_micros` at full TraceMe detail. The trace is skipped if
+// another profiler (e.g. an on-demand capture) is running.
+//
+// Only one sampler can exist at a time.
+class OpStatsSampler {
+ public:
+  struct Options {
+    int64_t export_interval_micros = 60 * 1000 * 1000;
+    // 0 disables tracing.
+    int64_t trace_every_n_intervals = 0;
+    int64_t trace_duration_micros = 100 * 1000;
+    tensorflow::ProfileOptions profile_options =
+        ProfilerSession::DefaultOptions();
+  };
+
+  // Called from the thread of the sampler.
+  using ExportFn = std::function<void(SampledOpStats)>;
+  using TraceFn = std::function<void(XSpace)>;
+
+  // Starts a sampler. `trace_fn` may be null if tracing is disabled.
+  static Status Create(Env* env, const Options& options, ExportFn export_fn,
+                       TraceFn trace_fn,
+                       std::unique_ptr<OpStatsSampler>* sampler);
+
+  // Exports the last interval and stops recording op stats.
+  ~OpStatsSampler();
+
+ private:
+  OpStatsSampler(Env* env, const Options& options, ExportFn export_fn,
+                 TraceFn trace_fn);
+
+  // The loop of the thread of the sampler.
+  void SamplerLoop();
+
+  // Waits until `deadline_micros` or until the sampler is destroyed. Returns
+  // false in the latter case.
+  bool WaitUntil(uint64 deadline_micros) TF_LOCKS_EXCLUDED(mu_);
+
+  // Traces at full detail for trace_duration_micros.
+  void Trace();
+
+  // Exports the op stats collected since the last export.
+  void Export();
+
+  Env* const env_;
+  const Options options_;
+  const ExportFn export_fn_;
+  const TraceFn trace_fn_;
+
+  // Only used by the thread of the sampler.
+  OpStatsRecorder::Totals previous_totals_;
+  uint64 interval_start_ns_ = 0;
+
+  mutex mu_;
+  condition_variable cv_;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+
+  // Declared last, so that it starts after the other members are initialized.
+  std::unique_ptr<Thread> thread_;
+
+  OpStatsSampler(const OpStatsSampler&) = delete;
+  void operator=(const OpStatsSampler&) = delete;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_UTILS_OP_STATS_SAMPLER_H_
@@ -0,0 +1,101 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/utils/op_stats_sampler.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+OpStatsRecorder::OpStats MakeOpStats(uint64 count, uint64 duration_ns) {
+  OpStatsRecorder::OpStats stats;
+  stats.name = "matmul";
+  stats.type = "MatMul";
+  stats.count = count;
+  stats.total_ns = count * duration_ns;
+  stats.buckets[OpStatsRecorder::BucketOf(duration_ns)] = count;
+  return stats;
+}
+
+TEST(OpStatsSamplerTest, SubtractAndConvert) {
+  OpStatsRecorder::Totals previous;
+  previous.ops["matmul"] = MakeOpStats(2, 1000);
+  OpStatsRecorder::Totals totals;
+  totals.ops["matmul"] = MakeOpStats(5, 1000);
+  totals.num_dropped = 3;
+
+  OpStatsRecorder::Totals delta = SubtractOpStats(totals, previous);
+  ASSERT_EQ(delta.ops.size(), 1);
+  EXPECT_EQ(delta.ops["matmul"].count, 3);
+  EXPECT_EQ(delta.ops["matmul"].total_ns, 3000);
+  EXPECT_EQ(delta.num_dropped, 3);
+  // Ops that didn't run in the interval are left out.
+  EXPECT_TRUE(SubtractOpStats(totals, totals).ops.empty());
+
+  OpMetricsDb db = ConvertOpStatsToOpMetricsDb(delta);
+  ASSERT_EQ(db.metrics_db_size(), 1);
+  const OpMetrics& metrics = db.metrics_db(0);
+  EXPECT_EQ(metrics.name(), "matmul");
+  EXPECT_EQ(metrics.category(), "MatMul");
+  EXPECT_EQ(metrics.occurrences(), 3);
+  EXPECT_EQ(metrics.time_ps(), 3000 * 1000);
+  EXPECT_EQ(metrics.self_time_ps(), 3000 * 1000);
+  EXPECT_EQ(metrics.min_time_ps(), 512 * 1000);
+  EXPECT_EQ(db.total_op_time_ps(), 3000 * 1000);
+}
+
+TEST(OpStatsSamplerTest, ExportsOnDestruction) {
+  std::vector<SampledOpStats> exported;
+  OpStatsSampler::Options options;
+  options.export_interval_micros = 3600LL * 1000 * 1000;
+  std::unique_ptr<OpStatsSampler> sampler;
+  TF_ASSERT_OK(OpStatsSampler::Create(
+      Env::Default(), options,
+      [&exported](SampledOpStats stats) {
+        exported.push_back(std::move(stats));
+      },
+      nullptr, &sampler));
+  EXPECT_TRUE(OpStatsRecorder::Active());
+
+  // Only one sampler at a time.
+  std::unique_ptr<OpStatsSampler> other;
+  EXPECT_TRUE(errors::IsAlreadyExists(OpStatsSampler::Create(
+      Env::Default(), options, [](SampledOpStats) {}, nullptr, &other)));
+
+  OpStatsRecorder::Record("matmul", "MatMul", 1000);
+  OpStatsRecorder::Record("matmul", "MatMul", 3000);
+  sampler.reset();
+  EXPECT_FALSE(OpStatsRecorder::Active());
+
+  ASSERT_EQ(exported.size(), 1);
+  const OpMetricsDb& db = exported[0].op_metrics_db;
+  ASSERT_EQ(db.metrics_db_size(), 1);
+  EXPECT_EQ(db.metrics_db(0).occurrences(), 2);
+  EXPECT_EQ(db.metrics_db(0).time_ps(), 4000 * 1000);
+  EXPECT_GE(db.total_time_ps(), db.total_op_time_ps());
+  EXPECT_LE(exported[0].start_time_ns, exported[0].end_time_ns);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
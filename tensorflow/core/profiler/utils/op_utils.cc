@@ -40,9 +40,10 @@ double GetCappedPerf(double perf, uint64 time, double rate_limit) {
 
 }  // namespace
 
-void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
-                                     absl::string_view category, bool is_eager,
-                                     uint64 time_ps, uint64 children_time_ps) {
+void HostOpMetricsDbBuilder::EnterOp(
+    absl::string_view name, absl::string_view category, bool is_eager,
+    uint64 time_ps, uint64 children_time_ps,
+    const OpMetrics::CpuCounters* cpu_counters) {
   uint64 self_time_ps = time_ps - children_time_ps;
   DCHECK_GE(time_ps, self_time_ps);
   OpMetrics* op_metrics = LookupOrInsertNewOpMetrics(/*hlo_module_id=*/0, name);
@@ -53,6 +54,14 @@ void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
   op_metrics->set_occurrences(op_metrics->occurrences() + 1);
   op_metrics->set_time_ps(op_metrics->time_ps() + time_ps);
   op_metrics->set_self_time_ps(op_metrics->self_time_ps() + self_time_ps);
+  if (cpu_counters != nullptr) {
+    OpMetrics::CpuCounters* total = op_metrics->mutable_cpu_counters();
+    total->set_occurrences(total->occurrences() + 1);
+    total->set_cycles(total->cycles() + cpu_counters->cycles());
+    total->set_instructions(total->instructions() +
+                            cpu_counters->instructions());
+    total->set_llc_misses(total->llc_misses() + cpu_counters->llc_misses());
+  }
   db()->set_total_op_time_ps(db()->total_op_time_ps() + self_time_ps);
 }
 
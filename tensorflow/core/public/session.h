@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PUBLIC_SESSION_H_
 #define TENSORFLOW_CORE_PUBLIC_SESSION_H_
 
+#include <functional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -272,6 +273,25 @@ class Session {
         "RunCallable with threadpool is not supported for this session.");
   }
 
+  /// \brief Starts an invocation of the subgraph named by `handle`, which
+  /// must have been created with a positive
+  /// `CallableOptions::max_pipelined_steps`, and calls `done` with its status
+  /// once it has finished, possibly from another thread.
+  ///
+  /// Up to `max_pipelined_steps` invocations run at once, whose steps may
+  /// overlap. The invocations start in the order of the calls.
+  /// `fetch_tensors` and `run_metadata` must stay alive until `done` is
+  /// called, which must not release `handle`.
+  /// NOTE: This API is still experimental and may change.
+  virtual void RunCallableAsync(CallableHandle handle,
+                                std::vector<Tensor> feed_tensors,
+                                std::vector<Tensor>* fetch_tensors,
+                                RunMetadata* run_metadata,
+                                std::function<void(const Status&)> done) {
+    done(absl::UnimplementedError(
+        "RunCallableAsync is not supported for this session."));
+  }
+
   /// \brief Releases resources associated with the given `handle` in this
   /// session.
   /// NOTE: This API is still experimental and may change.
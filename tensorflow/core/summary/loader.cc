@@ -15,7 +15,9 @@ limitations under the License.
 #include <iostream>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/summary/schema.h"
+#include "tensorflow/core/summary/summary_column_writer.h"
 #include "tensorflow/core/summary/summary_db_writer.h"
 #include "tensorflow/core/lib/db/sqlite.h"
 #include "tensorflow/core/lib/io/record_reader.h"
@@ -53,7 +55,9 @@ int main(int argc, char* argv[]) {
   string user_name;
   std::vector<Flag> flag_list = {
       Flag("db", &path, "Path of SQLite DB file"),
-      Flag("events", &events, "TensorFlow record proto event log file"),
+      Flag("events", &events,
+           "TensorFlow record proto event log file, or summary column "
+           "segment file"),
       Flag("experiment_name", &experiment_name, "The DB experiment_name value"),
       Flag("run_name", &run_name, "The DB run_name value"),
       Flag("user_name", &user_name, "The DB user_name value"),
@@ -88,6 +92,19 @@ int main(int argc, char* argv[]) {
                                     env, &db_writer));
   core::ScopedUnref unref(db_writer);
 
+  if (absl::EndsWith(events, kSummaryColumnSegmentSuffix)) {
+    LOG(INFO) << "Loading summary column segment: " << events;
+    uint64 start = env->NowMicros();
+    std::vector<std::unique_ptr<Event>> segment_events;
+    TF_CHECK_OK(ReadSummaryColumnSegment(env, events, &segment_events));
+    for (std::unique_ptr<Event>& event : segment_events) {
+      TF_CHECK_OK(db_writer->WriteEvent(std::move(event)));
+    }
+    LOG(INFO) << "Loaded " << AddCommas(segment_events.size()) << " values in "
+              << AddCommas(env->NowMicros() - start) << " us";
+    return 0;
+  }
+
   LOG(INFO) << "Loading TF event log: " << events;
   std::unique_ptr<RandomAccessFile> file;
   TF_CHECK_OK(env->NewRandomAccessFile(events, &file));
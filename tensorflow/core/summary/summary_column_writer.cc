@@ -0,0 +1,577 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/summary/summary_column_writer.h"
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/casts.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/summary/summary_converter.h"
+#include "tensorflow/core/summary/summary_file_writer.h"
+
+namespace tensorflow {
+namespace {
+
+// The first record of every segment.
+constexpr char kSegmentMagic[] = "tensorflow.summary_columns.1";
+
+// The kinds of chunks in a segment.
+enum ColumnKind : uint32 { kScalars = 1, kHistograms = 2 };
+
+// The values of one tag, column by column.
+struct Column {
+  std::vector<int64_t> steps;
+  std::vector<double> wall_times;
+  // The values of scalars, or the serialized HistogramProtos of histograms.
+  std::vector<float> values;
+  std::vector<string> histograms;
+
+  size_t size() const { return steps.size(); }
+
+  void clear() {
+    steps.clear();
+    wall_times.clear();
+    values.clear();
+    histograms.clear();
+  }
+
+  void Append(Column&& other) {
+    steps.insert(steps.end(), other.steps.begin(), other.steps.end());
+    wall_times.insert(wall_times.end(), other.wall_times.begin(),
+                      other.wall_times.end());
+    values.insert(values.end(), other.values.begin(), other.values.end());
+    for (string& histogram : other.histograms) {
+      histograms.push_back(std::move(histogram));
+    }
+  }
+};
+
+// A chunk is the kind, the tag and the number of values, followed by the
+// columns: zigzag-encoded step deltas as varints, wall times as fixed64
+// doubles, then either the scalars as fixed32 floats or the histograms as
+// length-prefixed HistogramProtos.
+void EncodeChunk(uint32 kind, const string& tag, const Column& column,
+                 string* out) {
+  out->clear();
+  core::PutVarint32(out, kind);
+  core::PutVarint64(out, tag.size());
+  out->append(tag);
+  core::PutVarint64(out, column.size());
+  uint64 prev_step = 0;
+  for (const int64_t step : column.steps) {
+    const int64_t delta = static_cast<int64_t>(step - prev_step);
+    core::PutVarint64(out, (static_cast<uint64>(delta) << 1) ^
+                               static_cast<uint64>(delta >> 63));
+    prev_step = step;
+  }
+  for (const double wall_time : column.wall_times) {
+    core::PutFixed64(out, absl::bit_cast<uint64>(wall_time));
+  }
+  if (kind == kScalars) {
+    for (const float value : column.values) {
+      core::PutFixed32(out, absl::bit_cast<uint32>(value));
+    }
+  } else {
+    for (const string& histogram : column.histograms) {
+      core::PutVarint64(out, histogram.size());
+      out->append(histogram);
+    }
+  }
+}
+
+Status DecodeChunk(StringPiece input, uint32* kind, string* tag,
+                   Column* column) {
+  const Status corrupted = errors::DataLoss("Corrupted summary column chunk");
+  uint64 tag_size;
+  uint64 count;
+  if (!core::GetVarint32(&input, kind) ||
+      (*kind != kScalars && *kind != kHistograms) ||
+      !core::GetVarint64(&input, &tag_size) || tag_size > input.size()) {
+    return corrupted;
+  }
+  tag->assign(input.data(), tag_size);
+  input.remove_prefix(tag_size);
+  // Each value takes a byte at least.
+  if (!core::GetVarint64(&input, &count) || count > input.size()) {
+    return corrupted;
+  }
+  column->clear();
+  column->steps.reserve(count);
+  uint64 step = 0;
+  for (uint64 i = 0; i < count; ++i) {
+    uint64 zigzag;
+    if (!core::GetVarint64(&input, &zigzag)) return corrupted;
+    step += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+    column->steps.push_back(static_cast<int64_t>(step));
+  }
+  if (input.size() / sizeof(uint64) < count) return corrupted;
+  column->wall_times.reserve(count);
+  for (uint64 i = 0; i < count; ++i) {
+    column->wall_times.push_back(absl::bit_cast<double>(
+        core::DecodeFixed64(input.data() + i * sizeof(uint64))));
+  }
+  input.remove_prefix(count * sizeof(uint64));
+  if (*kind == kScalars) {
+    if (input.size() / sizeof(uint32) < count) return corrupted;
+    column->values.reserve(count);
+    for (uint64 i = 0; i < count; ++i) {
+      column->values.push_back(absl::bit_cast<float>(
+          core::DecodeFixed32(input.data() + i * sizeof(uint32))));
+    }
+    input.remove_prefix(count * sizeof(uint32));
+  } else {
+    column->histograms.reserve(count);
+    for (uint64 i = 0; i < count; ++i) {
+      uint64 size;
+      if (!core::GetVarint64(&input, &size) || size > input.size()) {
+        return corrupted;
+      }
+      column->histograms.emplace_back(input.data(), size);
+      input.remove_prefix(size);
+    }
+  }
+  return input.empty() ? OkStatus() : corrupted;
+}
+
+using ChunkCallback =
+    std::function<Status(uint32 kind, string tag, Column column)>;
+
+Status ReadSegmentChunks(Env* env, const string& filename,
+                         const ChunkCallback& callback) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get());
+  uint64 offset = 0;
+  tstring record;
+  Status status = reader.ReadRecord(&offset, &record);
+  if (!status.ok() || record != kSegmentMagic) {
+    return errors::DataLoss(filename, " is not a summary column segment");
+  }
+  for (;;) {
+    const uint64 chunk_offset = offset;
+    status = reader.ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(status)) return OkStatus();
+    TF_RETURN_IF_ERROR(status);
+    uint32 kind;
+    string tag;
+    Column column;
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(DecodeChunk(record, &kind, &tag, &column),
+                                    "In ", filename, " at offset ",
+                                    chunk_offset);
+    TF_RETURN_IF_ERROR(callback(kind, std::move(tag), std::move(column)));
+  }
+}
+
+// Whether the values of `event` can be stored in columns.
+bool IsColumnarEvent(const Event& event) {
+  if (event.what_case() != Event::kSummary) return false;
+  for (const Summary::Value& value : event.summary().value()) {
+    if (value.has_metadata() ||
+        (value.value_case() != Summary::Value::kSimpleValue &&
+         value.value_case() != Summary::Value::kHisto)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class SummaryColumnWriter : public SummaryWriterInterface {
+ public:
+  SummaryColumnWriter(const SummaryColumnWriterOptions& options, Env* env)
+      : SummaryWriterInterface(), options_(options), env_(env) {}
+
+  Status Initialize(const string& logdir, const string& filename_suffix) {
+    const Status is_dir = env_->IsDirectory(logdir);
+    if (!is_dir.ok()) {
+      if (is_dir.code() != tensorflow::error::NOT_FOUND) {
+        return is_dir;
+      }
+      TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
+    }
+    // Embed PID plus a unique counter in the filenames, as SummaryFileWriter
+    // does, to help prevent filename collisions between and within processes.
+    int32_t pid = env_->GetProcessId();
+    static std::atomic<int64_t> file_id_counter(0);
+    string sep = absl::StartsWith(filename_suffix, ".") ? "" : ".";
+    mutex_lock ml(mu_);
+    logdir_ = logdir;
+    filename_suffix_ = filename_suffix;
+    segment_prefix_ = io::JoinPath(
+        logdir, absl::StrCat("columns.", pid, ".", file_id_counter.fetch_add(1),
+                             sep, filename_suffix));
+    last_flush_ = env_->NowMicros();
+    is_initialized_ = true;
+    return OkStatus();
+  }
+
+  ~SummaryColumnWriter() override {
+    mutex_lock ml(mu_);
+    if (is_initialized_) {
+      Status status = InternalFlush();
+      status.Update(CloseSegment());
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to write summary segment: " << status;
+      }
+    }
+    if (fallback_writer_ != nullptr) fallback_writer_->Unref();
+  }
+
+  Status Flush() override {
+    SummaryWriterInterface* fallback_writer;
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
+      TF_RETURN_IF_ERROR(InternalFlush());
+      if (segment_file_ != nullptr) {
+        TF_RETURN_WITH_CONTEXT_IF_ERROR(segment_file_->Sync(),
+                                        "Could not sync summary segment.");
+      }
+      fallback_writer = fallback_writer_;
+    }
+    if (fallback_writer != nullptr) {
+      TF_RETURN_IF_ERROR(fallback_writer->Flush());
+    }
+    return OkStatus();
+  }
+
+  Status WriteScalar(int64_t global_step, Tensor t,
+                     const string& tag) override {
+    float value;
+    TF_RETURN_IF_ERROR(GetTensorAsScalarValue(t, &value));
+    mutex_lock ml(mu_);
+    AppendScalar(global_step, GetWallTime(), tag, value);
+    return MaybeFlush();
+  }
+
+  Status WriteHistogram(int64_t global_step, Tensor t,
+                        const string& tag) override {
+    Summary summary;
+    TF_RETURN_IF_ERROR(AddTensorAsHistogramToSummary(t, tag, &summary));
+    mutex_lock ml(mu_);
+    AppendHistogram(global_step, GetWallTime(), tag,
+                    summary.value(0).histo().SerializeAsString());
+    return MaybeFlush();
+  }
+
+  Status WriteEvent(std::unique_ptr<Event> event) override {
+    if (IsColumnarEvent(*event)) {
+      mutex_lock ml(mu_);
+      for (const Summary::Value& value : event->summary().value()) {
+        if (value.value_case() == Summary::Value::kSimpleValue) {
+          AppendScalar(event->step(), event->wall_time(), value.tag(),
+                       value.simple_value());
+        } else {
+          AppendHistogram(event->step(), event->wall_time(), value.tag(),
+                          value.histo().SerializeAsString());
+        }
+      }
+      return MaybeFlush();
+    }
+    SummaryWriterInterface* fallback_writer;
+    TF_RETURN_IF_ERROR(GetFallbackWriter(&fallback_writer));
+    return fallback_writer->WriteEvent(std::move(event));
+  }
+
+  Status WriteTensor(int64_t global_step, Tensor t, const string& tag,
+                     const string& serialized_metadata) override {
+    SummaryWriterInterface* fallback_writer;
+    TF_RETURN_IF_ERROR(GetFallbackWriter(&fallback_writer));
+    return fallback_writer->WriteTensor(global_step, std::move(t), tag,
+                                        serialized_metadata);
+  }
+
+  Status WriteImage(int64_t global_step, Tensor t, const string& tag,
+                    int max_images, Tensor bad_color) override {
+    SummaryWriterInterface* fallback_writer;
+    TF_RETURN_IF_ERROR(GetFallbackWriter(&fallback_writer));
+    return fallback_writer->WriteImage(global_step, std::move(t), tag,
+                                       max_images, std::move(bad_color));
+  }
+
+  Status WriteAudio(int64_t global_step, Tensor t, const string& tag,
+                    int max_outputs, float sample_rate) override {
+    SummaryWriterInterface* fallback_writer;
+    TF_RETURN_IF_ERROR(GetFallbackWriter(&fallback_writer));
+    return fallback_writer->WriteAudio(global_step, std::move(t), tag,
+                                       max_outputs, sample_rate);
+  }
+
+  Status WriteGraph(int64_t global_step,
+                    std::unique_ptr<GraphDef> graph) override {
+    SummaryWriterInterface* fallback_writer;
+    TF_RETURN_IF_ERROR(GetFallbackWriter(&fallback_writer));
+    return fallback_writer->WriteGraph(global_step, std::move(graph));
+  }
+
+  string DebugString() const override { return "SummaryColumnWriter"; }
+
+ private:
+  struct Segment {
+    int64_t sequence;
+    int level;
+    string path;
+  };
+
+  double GetWallTime() {
+    return static_cast<double>(env_->NowMicros()) / 1.0e6;
+  }
+
+  void AppendScalar(int64_t step, double wall_time, const string& tag,
+                    float value) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Column& column = scalars_[tag];
+    column.steps.push_back(step);
+    column.wall_times.push_back(wall_time);
+    column.values.push_back(value);
+    ++num_buffered_values_;
+  }
+
+  void AppendHistogram(int64_t step, double wall_time, const string& tag,
+                       string histogram) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Column& column = histograms_[tag];
+    column.steps.push_back(step);
+    column.wall_times.push_back(wall_time);
+    column.histograms.push_back(std::move(histogram));
+    ++num_buffered_values_;
+  }
+
+  Status MaybeFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (num_buffered_values_ >= options_.max_buffered_values ||
+        env_->NowMicros() - last_flush_ > 1000 * options_.flush_millis) {
+      return InternalFlush();
+    }
+    return OkStatus();
+  }
+
+  Status GetFallbackWriter(SummaryWriterInterface** writer)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock ml(mu_);
+    if (!is_initialized_) {
+      return errors::FailedPrecondition("Class was not properly initialized.");
+    }
+    if (fallback_writer_ == nullptr) {
+      TF_RETURN_IF_ERROR(CreateSummaryFileWriter(
+          kFallbackMaxQueue, options_.flush_millis, logdir_, filename_suffix_,
+          env_, &fallback_writer_));
+    }
+    *writer = fallback_writer_;
+    return OkStatus();
+  }
+
+  string SegmentPath(int64_t sequence, int level) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return absl::StrCat(
+        segment_prefix_, ".",
+        strings::Printf("%010lld", static_cast<long long>(sequence)), ".",
+        level, kSummaryColumnSegmentSuffix);
+  }
+
+  // Appends the buffered values to the current segment.
+  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    last_flush_ = env_->NowMicros();
+    if (num_buffered_values_ == 0) return OkStatus();
+    if (segment_writer_ == nullptr) {
+      const string path = SegmentPath(next_sequence_, 0);
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          env_->NewWritableFile(path, &segment_file_),
+          "Creating summary segment ", path);
+      segment_writer_ = std::make_unique<io::RecordWriter>(segment_file_.get());
+      segment_ = {next_sequence_++, 0, path};
+      TF_RETURN_IF_ERROR(segment_writer_->WriteRecord(kSegmentMagic));
+    }
+    TF_RETURN_IF_ERROR(WriteChunks(kScalars, &scalars_));
+    TF_RETURN_IF_ERROR(WriteChunks(kHistograms, &histograms_));
+    num_buffered_values_ = 0;
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(segment_writer_->Flush(),
+                                    "Could not flush summary segment.");
+    int64_t segment_bytes;
+    TF_RETURN_IF_ERROR(segment_file_->Tell(&segment_bytes));
+    if (segment_bytes >= options_.max_segment_bytes) {
+      TF_RETURN_IF_ERROR(CloseSegment());
+      TF_RETURN_IF_ERROR(MaybeCompact());
+    }
+    return OkStatus();
+  }
+
+  Status WriteChunks(uint32 kind, absl::flat_hash_map<string, Column>* columns)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (auto& tag_and_column : *columns) {
+      Column& column = tag_and_column.second;
+      if (column.size() == 0) continue;
+      EncodeChunk(kind, tag_and_column.first, column, &chunk_);
+      TF_RETURN_IF_ERROR(segment_writer_->WriteRecord(chunk_));
+      column.clear();
+    }
+    return OkStatus();
+  }
+
+  Status CloseSegment() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (segment_writer_ == nullptr) return OkStatus();
+    Status status = segment_writer_->Close();
+    status.Update(segment_file_->Close());
+    segment_writer_.reset();
+    segment_file_.reset();
+    closed_segments_.push_back(segment_);
+    return status;
+  }
+
+  // Compacts the trailing closed segments of the same level while there are
+  // compaction_segments of them.
+  Status MaybeCompact() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (options_.compaction_segments < 2) return OkStatus();
+    while (!closed_segments_.empty()) {
+      const int level = closed_segments_.back().level;
+      size_t first = closed_segments_.size();
+      while (first > 0 && closed_segments_[first - 1].level == level) {
+        --first;
+      }
+      if (closed_segments_.size() - first <
+          static_cast<size_t>(options_.compaction_segments)) {
+        break;
+      }
+      TF_RETURN_IF_ERROR(CompactSegments(first));
+    }
+    return OkStatus();
+  }
+
+  // Replaces the closed segments from `first` on with one segment of the
+  // next level, which has one chunk per tag.
+  Status CompactSegments(size_t first) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    std::map<std::pair<uint32, string>, Column> merged;
+    for (size_t i = first; i < closed_segments_.size(); ++i) {
+      TF_RETURN_IF_ERROR(ReadSegmentChunks(
+          env_, closed_segments_[i].path,
+          [&merged](uint32 kind, string tag, Column column) {
+            merged[{kind, std::move(tag)}].Append(std::move(column));
+            return OkStatus();
+          }));
+    }
+    const Segment& last = closed_segments_.back();
+    const Segment output = {last.sequence, last.level + 1,
+                            SegmentPath(last.sequence, last.level + 1)};
+    // Written under another name first, so that readers only see complete
+    // segments.
+    const string temporary_path = absl::StrCat(output.path, ".tmp");
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_RETURN_IF_ERROR(env_->NewWritableFile(temporary_path, &file));
+      io::RecordWriter writer(file.get());
+      TF_RETURN_IF_ERROR(writer.WriteRecord(kSegmentMagic));
+      for (const auto& key_and_column : merged) {
+        EncodeChunk(key_and_column.first.first, key_and_column.first.second,
+                    key_and_column.second, &chunk_);
+        TF_RETURN_IF_ERROR(writer.WriteRecord(chunk_));
+      }
+      TF_RETURN_IF_ERROR(writer.Close());
+      TF_RETURN_IF_ERROR(file->Close());
+    }
+    TF_RETURN_IF_ERROR(env_->RenameFile(temporary_path, output.path));
+    for (size_t i = first; i < closed_segments_.size(); ++i) {
+      TF_RETURN_IF_ERROR(env_->DeleteFile(closed_segments_[i].path));
+    }
+    closed_segments_.resize(first);
+    closed_segments_.push_back(output);
+    VLOG(1) << "Compacted summary segments into " << output.path;
+    return OkStatus();
+  }
+
+  // The queue size of the SummaryFileWriter of the other summaries.
+  static constexpr int kFallbackMaxQueue = 10;
+
+  const SummaryColumnWriterOptions options_;
+  Env* const env_;
+  mutex mu_;
+  bool is_initialized_ TF_GUARDED_BY(mu_) = false;
+  string logdir_ TF_GUARDED_BY(mu_);
+  string filename_suffix_ TF_GUARDED_BY(mu_);
+  string segment_prefix_ TF_GUARDED_BY(mu_);
+  uint64 last_flush_ TF_GUARDED_BY(mu_) = 0;
+
+  // The values buffered since the last flush, by tag.
+  absl::flat_hash_map<string, Column> scalars_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, Column> histograms_ TF_GUARDED_BY(mu_);
+  int num_buffered_values_ TF_GUARDED_BY(mu_) = 0;
+  // A buffer for encoding chunks.
+  string chunk_ TF_GUARDED_BY(mu_);
+
+  // The segment being appended to, if any, and the closed ones of this
+  // writer in the order of their values.
+  std::unique_ptr<WritableFile> segment_file_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<io::RecordWriter> segment_writer_ TF_GUARDED_BY(mu_);
+  Segment segment_ TF_GUARDED_BY(mu_);
+  std::vector<Segment> closed_segments_ TF_GUARDED_BY(mu_);
+  int64_t next_sequence_ TF_GUARDED_BY(mu_) = 0;
+
+  // Writes the summaries that aren't scalars or histograms, created on first
+  // use.
+  SummaryWriterInterface* fallback_writer_ TF_GUARDED_BY(mu_) = nullptr;
+};
+
+}  // namespace
+
+Status CreateSummaryColumnWriter(const SummaryColumnWriterOptions& options,
+                                 const string& logdir,
+                                 const string& filename_suffix, Env* env,
+                                 SummaryWriterInterface** result) {
+  SummaryColumnWriter* w = new SummaryColumnWriter(options, env);
+  const Status s = w->Initialize(logdir, filename_suffix);
+  if (!s.ok()) {
+    w->Unref();
+    *result = nullptr;
+    return s;
+  }
+  *result = w;
+  return OkStatus();
+}
+
+Status ReadSummaryColumnSegment(Env* env, const string& filename,
+                                std::vector<std::unique_ptr<Event>>* events) {
+  return ReadSegmentChunks(
+      env, filename, [events](uint32 kind, string tag, Column column) {
+        for (size_t i = 0; i < column.size(); ++i) {
+          auto event = std::make_unique<Event>();
+          event->set_step(column.steps[i]);
+          event->set_wall_time(column.wall_times[i]);
+          Summary::Value* value = event->mutable_summary()->add_value();
+          value->set_tag(tag);
+          if (kind == kScalars) {
+            value->set_simple_value(column.values[i]);
+          } else if (!value->mutable_histo()->ParseFromString(
+                         column.histograms[i])) {
+            return errors::DataLoss("Corrupted histogram of ", tag);
+          }
+          events->push_back(std::move(event));
+        }
+        return OkStatus();
+      });
+}
+
+}  // namespace tensorflow
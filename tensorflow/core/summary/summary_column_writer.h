@@ -0,0 +1,78 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_SUMMARY_SUMMARY_COLUMN_WRITER_H_
+#define TENSORFLOW_CORE_SUMMARY_SUMMARY_COLUMN_WRITER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/kernels/summary_interface.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/event.pb.h"
+
+namespace tensorflow {
+
+/// The suffix of the segment files of SummaryColumnWriter.
+constexpr char kSummaryColumnSegmentSuffix[] = ".tfcol";
+
+struct SummaryColumnWriterOptions {
+  /// The buffered values are appended to the current segment at least every
+  /// flush_millis milliseconds, or once max_buffered_values are buffered.
+  int flush_millis = 10000;
+  int max_buffered_values = 1 << 16;
+  /// A segment is closed, and a new one started, once it is this large.
+  int64_t max_segment_bytes = 64 << 20;
+  /// Once this many closed segments of the same level follow each other, they
+  /// are compacted into one segment of the next level.
+  int compaction_segments = 8;
+};
+
+/// \brief Creates SummaryWriterInterface which writes scalars and histograms
+/// into append-only columnar segment files.
+///
+/// Each value is appended to in-memory columns of steps, wall times and
+/// values per tag, so writing a scalar costs O(1). When the columns are
+/// flushed, they are appended to the current segment as one chunk per tag,
+/// in records files that suit file systems like GCS. Closed segments are
+/// compacted into larger ones with one chunk per tag, like the levels of
+/// a log-structured merge tree, so the number of segments grows
+/// logarithmically with the number of flushes. A reader that lists the
+/// directory while a compaction renames its output into place may see the
+/// values of the compacted segments twice.
+///
+/// Other summaries (tensors, images, audio, graphs and other events) are
+/// written by a SummaryFileWriter to an events file in the same directory.
+///
+/// Segments are read back as tf.Event protos with ReadSummaryColumnSegment(),
+/// e.g. by the summary loader. The caller owns a reference to result if the
+/// returned status is ok. The Env object must not be destroyed until after
+/// the returned writer.
+Status CreateSummaryColumnWriter(const SummaryColumnWriterOptions& options,
+                                 const string& logdir,
+                                 const string& filename_suffix, Env* env,
+                                 SummaryWriterInterface** result);
+
+/// \brief Reads the scalars and histograms of a segment file as the tf.Event
+/// protos SummaryFileWriter would have written for them.
+///
+/// The events of each tag are in the order they were written.
+Status ReadSummaryColumnSegment(Env* env, const string& filename,
+                                std::vector<std::unique_ptr<Event>>* events);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_COLUMN_WRITER_H_
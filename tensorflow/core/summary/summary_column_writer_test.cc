@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/summary/summary_column_writer.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/event.pb.h"
+
+namespace tensorflow {
+namespace {
+
+class SummaryColumnWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    logdir_ = io::JoinPath(
+        testing::TmpDir(),
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+  }
+
+  std::vector<string> ListFiles(const string& suffix) {
+    std::vector<string> children;
+    TF_CHECK_OK(Env::Default()->GetChildren(logdir_, &children));
+    std::vector<string> files;
+    for (const string& child : children) {
+      if (absl::EndsWith(child, suffix)) {
+        files.push_back(io::JoinPath(logdir_, child));
+      }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+  }
+
+  std::vector<std::unique_ptr<Event>> ReadSegments() {
+    std::vector<std::unique_ptr<Event>> events;
+    for (const string& segment : ListFiles(kSummaryColumnSegmentSuffix)) {
+      TF_CHECK_OK(ReadSummaryColumnSegment(Env::Default(), segment, &events));
+    }
+    return events;
+  }
+
+  string logdir_;
+};
+
+TEST_F(SummaryColumnWriterTest, ScalarsAndHistograms) {
+  SummaryWriterInterface* writer;
+  TF_ASSERT_OK(CreateSummaryColumnWriter(SummaryColumnWriterOptions(), logdir_,
+                                         ".scalars", Env::Default(), &writer));
+  core::ScopedUnref unref(writer);
+
+  Tensor scalar(DT_FLOAT, TensorShape({}));
+  scalar.scalar<float>()() = 2.5f;
+  TF_ASSERT_OK(writer->WriteScalar(7, scalar, "loss"));
+  Tensor histogram(DT_DOUBLE, TensorShape({3}));
+  histogram.vec<double>()(0) = 1;
+  histogram.vec<double>()(1) = 2;
+  histogram.vec<double>()(2) = 3;
+  TF_ASSERT_OK(writer->WriteHistogram(-3, histogram, "weights"));
+  auto event = std::make_unique<Event>();
+  event->set_step(9);
+  event->set_wall_time(123.5);
+  event->mutable_summary()->add_value()->set_tag("loss");
+  event->mutable_summary()->mutable_value(0)->set_simple_value(-1.0f);
+  TF_ASSERT_OK(writer->WriteEvent(std::move(event)));
+  TF_ASSERT_OK(writer->Flush());
+
+  std::vector<std::unique_ptr<Event>> events = ReadSegments();
+  ASSERT_EQ(events.size(), 3);
+  std::vector<const Event*> losses;
+  const Event* weights = nullptr;
+  for (const auto& e : events) {
+    ASSERT_EQ(e->summary().value_size(), 1);
+    if (e->summary().value(0).tag() == "loss") {
+      losses.push_back(e.get());
+    } else {
+      weights = e.get();
+    }
+  }
+  ASSERT_EQ(losses.size(), 2);
+  EXPECT_EQ(losses[0]->step(), 7);
+  EXPECT_EQ(losses[0]->summary().value(0).simple_value(), 2.5f);
+  EXPECT_EQ(losses[1]->step(), 9);
+  EXPECT_EQ(losses[1]->wall_time(), 123.5);
+  EXPECT_EQ(losses[1]->summary().value(0).simple_value(), -1.0f);
+  ASSERT_NE(weights, nullptr);
+  EXPECT_EQ(weights->step(), -3);
+  EXPECT_EQ(weights->summary().value(0).tag(), "weights");
+  EXPECT_EQ(weights->summary().value(0).histo().num(), 3);
+  EXPECT_EQ(weights->summary().value(0).histo().sum(), 6);
+
+  // No events file was written.
+  EXPECT_TRUE(ListFiles(".scalars").empty());
+}
+
+TEST_F(SummaryColumnWriterTest, CompactsSegments) {
+  constexpr int kNumSteps = 20;
+  SummaryColumnWriterOptions options;
+  options.max_segment_bytes = 1;
+  options.compaction_segments = 2;
+  SummaryWriterInterface* writer;
+  TF_ASSERT_OK(CreateSummaryColumnWriter(options, logdir_, "", Env::Default(),
+                                         &writer));
+  Tensor scalar(DT_FLOAT, TensorShape({}));
+  for (int step = 0; step < kNumSteps; ++step) {
+    scalar.scalar<float>()() = step * 0.5f;
+    TF_ASSERT_OK(writer->WriteScalar(step, scalar, "loss"));
+    // Each flush closes a segment, which may be compacted.
+    TF_ASSERT_OK(writer->Flush());
+  }
+  writer->Unref();
+
+  // Binary counting: one segment per set bit of the number of flushes.
+  EXPECT_LE(ListFiles(kSummaryColumnSegmentSuffix).size(), 2);
+  EXPECT_TRUE(ListFiles(".tmp").empty());
+  std::vector<std::unique_ptr<Event>> events = ReadSegments();
+  ASSERT_EQ(events.size(), kNumSteps);
+  for (int step = 0; step < kNumSteps; ++step) {
+    EXPECT_EQ(events[step]->step(), step);
+    EXPECT_EQ(events[step]->summary().value(0).simple_value(), step * 0.5f);
+  }
+}
+
+TEST_F(SummaryColumnWriterTest, WritesOtherSummariesToEventsFile) {
+  SummaryWriterInterface* writer;
+  TF_ASSERT_OK(CreateSummaryColumnWriter(SummaryColumnWriterOptions(), logdir_,
+                                         ".other", Env::Default(), &writer));
+  core::ScopedUnref unref(writer);
+
+  Tensor tensor(DT_INT32, TensorShape({2}));
+  tensor.vec<int32>()(0) = 1;
+  tensor.vec<int32>()(1) = 2;
+  TF_ASSERT_OK(writer->WriteTensor(1, tensor, "ids", ""));
+  TF_ASSERT_OK(writer->Flush());
+
+  EXPECT_TRUE(ReadSegments().empty());
+  EXPECT_EQ(ListFiles(".other").size(), 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
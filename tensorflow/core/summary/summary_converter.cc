@@ -209,11 +209,15 @@ Status AddTensorAsScalarToSummary(const Tensor& t, const string& tag,
   Summary::Value* v = s->add_value();
   v->set_tag(tag);
   float value;
-  TF_RETURN_IF_ERROR(TensorValueAt<float>(t, 0, &value));
+  TF_RETURN_IF_ERROR(GetTensorAsScalarValue(t, &value));
   v->set_simple_value(value);
   return OkStatus();
 }
 
+Status GetTensorAsScalarValue(const Tensor& t, float* value) {
+  return TensorValueAt<float>(t, 0, value);
+}
+
 Status AddTensorAsHistogramToSummary(const Tensor& t, const string& tag,
                                      Summary* s) {
   Summary::Value* v = s->add_value();
@@ -24,6 +24,8 @@ namespace tensorflow {
 // TODO(jart): Delete these methods in favor of new Python implementation.
 Status AddTensorAsScalarToSummary(const Tensor& t, const string& tag,
                                   Summary* s);
+// Returns the value AddTensorAsScalarToSummary() would add for `t`.
+Status GetTensorAsScalarValue(const Tensor& t, float* value);
 Status AddTensorAsHistogramToSummary(const Tensor& t, const string& tag,
                                      Summary* s);
 Status AddTensorAsImageToSummary(const Tensor& tensor, const string& tag,
@@ -51,21 +51,34 @@ uint64_t CostRecorder::GetCost(int64_t op_key) const {
   return r;
 }
 
-Status CostRecorder::WriteToFile() const {
+void CostRecorder::RecordCosts(const OpCostMapProto& op_cost_map) {
+  mutex_lock l(op_cost_map_mutex_);
+  for (const auto& [op_key, op_cost] : op_cost_map.op_cost_map()) {
+    op_cost_map_[op_key].first += op_cost;
+    op_cost_map_[op_key].second += 1;
+  }
+}
+
+OpCostMapProto CostRecorder::ToProto() const {
   OpCostMapProto op_cost_map_proto;
-  {
-    tf_shared_lock l(op_cost_map_mutex_);
-    for (const auto& [op_key, op_cost] : op_cost_map_) {
-      const uint64_t avg_op_cost = op_cost.first / op_cost.second;
-      (*op_cost_map_proto.mutable_op_cost_map())[op_key] = avg_op_cost;
-    }
+  tf_shared_lock l(op_cost_map_mutex_);
+  for (const auto& [op_key, op_cost] : op_cost_map_) {
+    const uint64_t avg_op_cost = op_cost.first / op_cost.second;
+    (*op_cost_map_proto.mutable_op_cost_map())[op_key] = avg_op_cost;
   }
+  return op_cost_map_proto;
+}
 
+Status CostRecorder::WriteToFile() const {
   std::string measured_cost_path;
   TF_RETURN_IF_ERROR(ReadStringFromEnvVar(MesuredCostPathEnvVarName(), "",
                                           &measured_cost_path));
-  return tensorflow::WriteTextProto(tensorflow::Env::Default(),
-                                    measured_cost_path, op_cost_map_proto);
+  return WriteToFile(measured_cost_path);
+}
+
+Status CostRecorder::WriteToFile(const std::string& path) const {
+  return tensorflow::WriteTextProto(tensorflow::Env::Default(), path,
+                                    ToProto());
 }
 
 size_t CostRecorder::size() const {
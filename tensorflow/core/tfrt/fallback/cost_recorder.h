@@ -18,12 +18,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_COST_RECORDER_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_COST_RECORDER_H_
 
+#include <string>
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/tfrt/fallback/op_cost_map.pb.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
@@ -42,11 +44,21 @@ class CostRecorder {
   // otherwise adding op costs would cause overflow.
   uint64_t GetCost(int64_t op_key) const;
 
+  // Records each cost in `op_cost_map` as one execution, e.g. to start from
+  // the costs measured by a previous process.
+  void RecordCosts(const OpCostMapProto& op_cost_map);
+
+  // Returns the average execution duration of each op.
+  OpCostMapProto ToProto() const;
+
   // Writes the op cost map (in format of `OpCostMapProto`) to a file specified
   // by the env var name `MesuredCostPathEnvVarName()`.
   // TODO(b/263837451): Fix the op_key unstableness during serialization.
   Status WriteToFile() const;
 
+  // Writes the op cost map (in format of `OpCostMapProto`) to `path`.
+  Status WriteToFile(const std::string& path) const;
+
   size_t size() const;
 
   static const char* MesuredCostPathEnvVarName() {
@@ -98,6 +98,19 @@ TEST(CostRecorderTest, ProtoRecordsTest) {
             kTestAvgCost);
 }
 
+TEST(CostRecorderTest, RecordCostsTest) {
+  OpCostMapProto op_cost_map_proto;
+  (*op_cost_map_proto.mutable_op_cost_map())[kTestOpKey] = kTestCost;
+
+  // The recorded costs are averaged with the new measurements.
+  CostRecorder recorder;
+  recorder.RecordCosts(op_cost_map_proto);
+  recorder.RecordCost(kTestOpKey, 2 * kTestCost);
+
+  EXPECT_EQ(recorder.GetCost(kTestOpKey), kTestAvgCost);
+  EXPECT_EQ(recorder.ToProto().op_cost_map().at(kTestOpKey), kTestAvgCost);
+}
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
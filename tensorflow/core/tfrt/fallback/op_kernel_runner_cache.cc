@@ -20,9 +20,48 @@ limitations under the License.
 #include <utility>
 
 #include "absl/base/casts.h"
+#include "absl/hash/hash.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
+namespace {
+
+constexpr size_t kInitialCapacity = 64;
+
+}  // namespace
+
+OpKernelRunnerCache::Table::Table(size_t capacity)
+    : slots(new std::atomic<const Entry*>[capacity]), mask(capacity - 1) {
+  DCHECK_EQ(capacity & mask, 0);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+OpKernelRunnerCache::OpKernelRunnerCache() {
+  tables_.push_back(std::make_unique<Table>(kInitialCapacity));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+/*static*/ OpKernelRunner* OpKernelRunnerCache::Find(const Table& table,
+                                                     const OpLocationKey& key) {
+  for (size_t i = absl::HashOf(key) & table.mask;; i = (i + 1) & table.mask) {
+    // Pairs with the release store in Insert(), so that the entry is visible.
+    const Entry* entry = table.slots[i].load(std::memory_order_acquire);
+    if (entry == nullptr) return nullptr;
+    if (entry->key == key) return entry->runner.get();
+  }
+}
+
+/*static*/ void OpKernelRunnerCache::Insert(Table& table, const Entry* entry) {
+  for (size_t i = absl::HashOf(entry->key) & table.mask;;
+       i = (i + 1) & table.mask) {
+    if (table.slots[i].load(std::memory_order_relaxed) == nullptr) {
+      table.slots[i].store(entry, std::memory_order_release);
+      return;
+    }
+  }
+}
 
 StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
@@ -32,21 +71,19 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     const tensorflow::ProcessFunctionLibraryRuntime&
         process_function_library_runtime) {
   OpLocationKey key(loc);
-  {
-    tf_shared_lock lock(mu_);
-    auto it = map_.find(key);
-    if (it != map_.end()) {
-      DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-      return it->second.get();
-    }
+  if (OpKernelRunner* runner =
+          Find(*table_.load(std::memory_order_acquire), key)) {
+    DCHECK_EQ(runner->op_kernel()->def().op(), op_name);
+    return runner;
   }
 
   mutex_lock lock(mu_);
 
-  auto it = map_.find(key);
-  if (it != map_.end()) {
-    DCHECK_EQ(it->second->op_kernel()->def().op(), op_name);
-    return it->second.get();
+  // The table can only change under `mu_`, so this lookup is authoritative.
+  Table* table = table_.load(std::memory_order_relaxed);
+  if (OpKernelRunner* runner = Find(*table, key)) {
+    DCHECK_EQ(runner->op_kernel()->def().op(), op_name);
+    return runner;
   }
 
   VLOG(1) << "KernelFallbackExecuteCompat creating op " << op_name
@@ -60,13 +97,22 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
                        op_name, node_name, device_name, num_args, attr_builder,
                        device_manager, process_function_library_runtime));
 
-  auto runner_uptr = std::make_unique<OpKernelRunner>(std::move(runner));
-
-  auto* runner_ptr = runner_uptr.get();
-  auto r = map_.emplace(key, std::move(runner_uptr)).second;
-  DCHECK(r);
+  entries_.push_back(std::make_unique<Entry>(
+      Entry{key, std::make_unique<OpKernelRunner>(std::move(runner))}));
+  const Entry* entry = entries_.back().get();
+
+  if (2 * entries_.size() > table->mask + 1) {
+    // Publishes a larger table with all the entries. Lookups that loaded the
+    // old one still find the entries that were in it.
+    tables_.push_back(std::make_unique<Table>(2 * (table->mask + 1)));
+    table = tables_.back().get();
+    for (const auto& e : entries_) Insert(*table, e.get());
+    table_.store(table, std::memory_order_release);
+  } else {
+    Insert(*table, entry);
+  }
 
-  return runner_ptr;
+  return entry->runner.get();
 }
 
 }  // namespace tfrt_stub
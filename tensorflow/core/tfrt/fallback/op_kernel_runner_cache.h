@@ -15,8 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
@@ -47,9 +50,14 @@ class OpLocationKey {
 };
 
 // OpKernelRunnerCache is similar to OpKernelRunnerTable but thread-safe.
+//
+// Looking up an existing runner doesn't lock: the runners are published in an
+// open-addressing table of atomic pointers, which is only written (under
+// `mu_`) when a runner is created. A table that is outgrown is kept until the
+// cache is destroyed, since concurrent lookups may still be probing it.
 class OpKernelRunnerCache {
  public:
-  OpKernelRunnerCache() = default;
+  OpKernelRunnerCache();
 
   StatusOr<OpKernelRunner*> GetOrCreate(
       tfrt::Location loc, absl::string_view op_name,
@@ -60,9 +68,31 @@ class OpKernelRunnerCache {
           process_function_library_runtime);
 
  private:
+  struct Entry {
+    OpLocationKey key;
+    std::unique_ptr<OpKernelRunner> runner;
+  };
+
+  struct Table {
+    explicit Table(size_t capacity);
+
+    // The capacity is a power of 2, and at most half the slots are used, so
+    // that probes end at an empty slot.
+    std::unique_ptr<std::atomic<const Entry*>[]> slots;
+    size_t mask;
+  };
+
+  // Returns the runner of `key` in `table`, or nullptr if there is none.
+  static OpKernelRunner* Find(const Table& table, const OpLocationKey& key);
+
+  // Publishes `entry`, whose key must not be in `table` yet.
+  static void Insert(Table& table, const Entry* entry);
+
+  std::atomic<Table*> table_;
+
   mutable mutex mu_;
-  absl::flat_hash_map<OpLocationKey, std::unique_ptr<OpKernelRunner>> map_
-      TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Table>> tables_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Entry>> entries_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tfrt_stub
@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -25,7 +26,10 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
@@ -122,6 +126,87 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+StatusOr<OpKernelRunner*> GetOrCreateTestOp(OpKernelRunnerCache& cache,
+                                            const FallbackState& fallback_state,
+                                            int64_t loc_data) {
+  return cache.GetOrCreate(
+      tfrt::Location(/*handler=*/nullptr, loc_data),
+      /*op_name=*/"TestOp",
+      /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+      /*num_args=*/1,
+      /*attr_builder=*/[](tensorflow::AttrValueMap*) { return OkStatus(); },
+      fallback_state.device_manager(),
+      fallback_state.process_function_library_runtime());
+}
+
+TEST(OpKernelRunnerTest, OpKernelRunnerCacheConcurrentGrowth) {
+  // More locations than the initial table holds, created by several threads.
+  constexpr int kNumLocations = 1000;
+  constexpr int kNumThreads = 8;
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  OpKernelRunnerCache cache;
+  std::vector<std::vector<OpKernelRunner*>> runners(
+      kNumThreads, std::vector<OpKernelRunner*>(kNumLocations));
+  {
+    thread::ThreadPool pool(Env::Default(), "cache", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&, t]() {
+        for (int i = 0; i < kNumLocations; ++i) {
+          const int loc_data = (i + t * kNumLocations / kNumThreads) %
+                               kNumLocations;
+          runners[t][loc_data] =
+              GetOrCreateTestOp(cache, *fallback_state, loc_data).value();
+        }
+      });
+    }
+  }
+
+  for (int i = 0; i < kNumLocations; ++i) {
+    ASSERT_TRUE(runners[0][i]);
+    EXPECT_EQ(runners[0][i]->op_kernel()->name(),
+              absl::StrCat("TestOp_", i, "_0"));
+    for (int t = 1; t < kNumThreads; ++t) {
+      EXPECT_EQ(runners[t][i], runners[0][i]);
+    }
+  }
+}
+
+// Looks up the runners of 256 locations from several threads, like the
+// fallback ops of a model being served.
+void BM_OpKernelRunnerCacheLookup(::testing::benchmark::State& state) {
+  constexpr int kNumLocations = 256;
+  static auto* fallback_state = []() {
+    tensorflow::SessionOptions session_options;
+    tensorflow::FunctionDefLibrary fdef_lib;
+    return FallbackState::Create(session_options, fdef_lib).value().release();
+  }();
+  static auto* cache = []() {
+    auto* cache = new OpKernelRunnerCache;
+    for (int i = 0; i < kNumLocations; ++i) {
+      TF_CHECK_OK(GetOrCreateTestOp(*cache, *fallback_state, i).status());
+    }
+    return cache;
+  }();
+
+  int i = state.thread_index();
+  for (auto s : state) {
+    auto runner = GetOrCreateTestOp(*cache, *fallback_state, i);
+    tensorflow::testing::DoNotOptimize(runner);
+    i = (i + 1) % kNumLocations;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_OpKernelRunnerCacheLookup)
+    ->UseRealTime()
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16);
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
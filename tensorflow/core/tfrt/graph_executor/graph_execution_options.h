@@ -96,6 +96,20 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // If true, recompilations with updated costs run on a background thread,
+    // and requests keep running the current executable until the new one is
+    // swapped in. Otherwise, the request that triggers a recompilation waits
+    // for it.
+    bool recompile_in_background = false;
+
+    // If non-empty, the op costs of each loaded client graph are written to a
+    // file in this directory on each recompilation, and read back when the
+    // graph is loaded again (e.g. after a restart), so that the first cost
+    // measurements of the new process are averaged with the persisted ones.
+    // The files are keyed by the model name and version and the client graph
+    // name; they must be discarded if the graph or compile options change.
+    std::string cost_profile_dir;
   };
 
   CostAnalysisOptions cost_analysis_options;
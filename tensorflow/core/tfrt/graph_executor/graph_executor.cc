@@ -57,9 +57,14 @@ limitations under the License.
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -68,10 +73,12 @@ limitations under the License.
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_utils.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
+#include "tensorflow/core/tfrt/fallback/op_cost_map.pb.h"
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/export_mlir.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/graph_executor/sync_resource_state.h"
+#include "tensorflow/core/tfrt/graph_executor/warmup_request.pb.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/bytecode.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/executable.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
@@ -468,6 +475,12 @@ GraphExecutor::GraphExecutor(
       kernel_registry_(std::move(kernel_registry)),
       resource_context_(std::move(resource_context)) {
   DCHECK(resource_context_);
+  if (options_.cost_analysis_options.version !=
+          Options::CostAnalysisOptions::kDisabled &&
+      options_.cost_analysis_options.recompile_in_background) {
+    cost_update_thread_pool_ = std::make_unique<tensorflow::thread::ThreadPool>(
+        tensorflow::Env::Default(), "tfrt_cost_update", /*num_threads=*/1);
+  }
   SetSessionCreatedMetric();
 }
 
@@ -618,13 +631,25 @@ tensorflow::Status GraphExecutor::Run(
       cost_recorder));
 
   if (do_recompilation) {
-    TF_RETURN_IF_ERROR(
-        loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
-    tensorflow::mutex_lock l(num_recompilations_mu_);
-    num_recompilations_ += 1;
-  }
-  if (cost_recorder != nullptr) {
-    loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
+    if (cost_update_thread_pool_ != nullptr) {
+      // No more costs are recorded for this graph until the recompilation is
+      // done, so `cost_recorder` stays unchanged.
+      cost_update_thread_pool_->Schedule(
+          [this, &loaded_client_graph, cost_recorder, now]() {
+            Status status = RecompileWithUpdatedCost(loaded_client_graph,
+                                                     *cost_recorder, now);
+            if (!status.ok()) {
+              LOG(ERROR) << "TFRT failed to recompile loaded client graph "
+                         << loaded_client_graph.name()
+                         << " with updated op costs: " << status;
+            }
+          });
+    } else {
+      TF_RETURN_IF_ERROR(
+          RecompileWithUpdatedCost(loaded_client_graph, *cost_recorder, now));
+    }
+  } else if (cost_recorder != nullptr) {
+    loaded_client_graph.UpdateCostAnalysisData(now, /*do_recompilation=*/false);
   }
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
@@ -906,17 +931,24 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
                 absl::StrJoin(target_tensor_names,
                               kTensorNameJoiningDelimiter));
 
-  tensorflow::mutex_lock l(loaded_client_graphs_mu_);
-
-  // Cache hit; return immediately.
-  const auto iter = loaded_client_graphs_.find(joined_name);
-  if (iter != loaded_client_graphs_.end()) return {*iter->second};
+  {
+    tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+    while (true) {
+      // Cache hit; return immediately.
+      const auto iter = loaded_client_graphs_.find(joined_name);
+      if (iter != loaded_client_graphs_.end()) return {*iter->second};
+      if (!loading_client_graphs_.contains(joined_name)) break;
+      // Another request is loading the same client graph.
+      loaded_client_graphs_cv_.wait(l);
+    }
 
-  if (run_options.disable_compilation) {
-    return tensorflow::errors::InvalidArgument(
-        absl::StrCat("GraphExecutor: compilation is disabled in execution but "
-                     "the compiled graph is not found for ",
-                     joined_name));
+    if (run_options.disable_compilation) {
+      return tensorflow::errors::InvalidArgument(absl::StrCat(
+          "GraphExecutor: compilation is disabled in execution but "
+          "the compiled graph is not found for ",
+          joined_name));
+    }
+    loading_client_graphs_.insert(joined_name);
   }
 
   // Cache miss; populate a `ClientGraph` and load it.
@@ -936,15 +968,99 @@ GraphExecutor::GetOrCreateLoadedClientGraph(
       std::move(input_nodes),
       {output_tensor_names.begin(), output_tensor_names.end()},
       {target_tensor_names.begin(), target_tensor_names.end()}};
-  TF_ASSIGN_OR_RETURN(auto loaded_client_graph,
-                      LoadClientGraph(client_graph, work_queue, inputs));
+  // Load outside of the lock, so that other client graphs can be loaded or
+  // run meanwhile.
+  auto loaded_client_graph =
+      LoadClientGraph(client_graph, work_queue, inputs);
+
+  tensorflow::mutex_lock l(loaded_client_graphs_mu_);
+  loading_client_graphs_.erase(joined_name);
+  loaded_client_graphs_cv_.notify_all();
+  // On failure, the next request for this client graph loads it again.
+  TF_RETURN_IF_ERROR(loaded_client_graph.status());
 
   // Store the new loaded client graph in cache and return.
-  auto* loaded_client_graph_ptr = loaded_client_graph.get();
-  loaded_client_graphs_[joined_name] = std::move(loaded_client_graph);
+  auto* loaded_client_graph_ptr = loaded_client_graph->get();
+  loaded_client_graphs_[joined_name] = *std::move(loaded_client_graph);
   return {*loaded_client_graph_ptr};
 }
 
+tensorflow::Status GraphExecutor::Warmup(
+    absl::Span<const WarmupRequest> requests, int num_threads) {
+  if (requests.empty()) return OkStatus();
+  LOG(INFO) << "TFRT warming up with " << requests.size() << " requests";
+  const auto warmup_start_time = absl::Now();
+
+  std::vector<std::vector<std::pair<std::string, tensorflow::Tensor>>> inputs(
+      requests.size());
+  for (int i = 0; i < requests.size(); ++i) {
+    for (const auto& feed : requests[i].feeds()) {
+      tensorflow::Tensor tensor;
+      if (!tensor.FromProto(feed.tensor())) {
+        return tensorflow::errors::InvalidArgument(
+            "Invalid tensor of feed ", feed.name(), " in warm-up request ", i);
+      }
+      inputs[i].push_back({feed.name(), std::move(tensor)});
+    }
+  }
+
+  std::vector<tensorflow::Status> statuses(requests.size());
+  {
+    // The pool joins its threads when it is destroyed.
+    tensorflow::thread::ThreadPool pool(
+        tensorflow::Env::Default(), "tfrt_warmup",
+        std::max<int>(1, std::min<int>(num_threads, requests.size())));
+    for (int i = 0; i < requests.size(); ++i) {
+      pool.Schedule([this, &requests, &inputs, &statuses, i]() {
+        const WarmupRequest& request = requests[i];
+        const std::vector<std::string> output_tensor_names(
+            request.fetch_tensor_names().begin(),
+            request.fetch_tensor_names().end());
+        const std::vector<std::string> target_node_names(
+            request.target_node_names().begin(),
+            request.target_node_names().end());
+        std::vector<tensorflow::Tensor> outputs;
+        statuses[i] = Run(RunOptions(), inputs[i], output_tensor_names,
+                          target_node_names, &outputs);
+      });
+    }
+  }
+
+  for (int i = 0; i < statuses.size(); ++i) {
+    if (!statuses[i].ok()) {
+      return tensorflow::errors::CreateWithUpdatedMessage(
+          statuses[i], absl::StrCat("Warm-up request ", i,
+                                    " failed: ", statuses[i].message()));
+    }
+  }
+  LOG(INFO) << "TFRT finished warming up. Took "
+            << absl::ToInt64Milliseconds(absl::Now() - warmup_start_time)
+            << " ms.";
+  return OkStatus();
+}
+
+StatusOr<std::vector<WarmupRequest>> ReadWarmupRequests(
+    const std::string& path) {
+  std::unique_ptr<tensorflow::RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(
+      tensorflow::Env::Default()->NewRandomAccessFile(path, &file));
+  tensorflow::io::SequentialRecordReader reader(file.get());
+
+  std::vector<WarmupRequest> requests;
+  tensorflow::tstring record;
+  while (true) {
+    tensorflow::Status status = reader.ReadRecord(&record);
+    if (absl::IsOutOfRange(status)) break;
+    TF_RETURN_IF_ERROR(status);
+    WarmupRequest& request = requests.emplace_back();
+    if (!request.ParseFromString(record)) {
+      return tensorflow::errors::DataLoss("Failed to parse warm-up request ",
+                                          requests.size() - 1, " in ", path);
+    }
+  }
+  return requests;
+}
+
 tensorflow::Status GraphExecutor::RunWithSyncInterpreter(
     const std::string& graph_name, absl::Span<mlrt::Value> input_values,
     absl::Span<const std::string> input_names,
@@ -990,6 +1106,18 @@ tensorflow::Status GraphExecutor::RunWithSyncInterpreter(
   return execution_context.status();
 }
 
+tensorflow::Status GraphExecutor::RecompileWithUpdatedCost(
+    LoadedClientGraph& loaded_client_graph, const CostRecorder& cost_recorder,
+    absl::Time now) {
+  TF_RETURN_IF_ERROR(loaded_client_graph.UpdateCost(cost_recorder, runtime()));
+  {
+    tensorflow::mutex_lock l(num_recompilations_mu_);
+    num_recompilations_ += 1;
+  }
+  loaded_client_graph.UpdateCostAnalysisData(now, /*do_recompilation=*/true);
+  return OkStatus();
+}
+
 CostRecorder* GraphExecutor::LoadedClientGraph::MaybeGetCostRecorder(
     absl::Time now, bool* do_recompilation) {
   *do_recompilation = false;
@@ -1017,6 +1145,16 @@ Status GraphExecutor::LoadedClientGraph::UpdateCost(
     const CostRecorder& cost_recorder, const Runtime& runtime) {
   LOG(INFO) << "TFRT updating op costs of loaded client graph (" << this << ") "
             << name_;
+  const std::string cost_profile_path = CostProfilePath();
+  if (!cost_profile_path.empty()) {
+    // The costs are only used by the next process, so a failure to persist
+    // them doesn't fail the update.
+    Status status = cost_recorder.WriteToFile(cost_profile_path);
+    if (!status.ok()) {
+      LOG(WARNING) << "TFRT failed to persist op costs of loaded client graph "
+                   << name_ << " to " << cost_profile_path << ": " << status;
+    }
+  }
   std::shared_ptr<ExecutableContext> new_executable_context = nullptr;
   if (executable_context()->IsForMlrt()) {
     auto tf_mlir_with_op_keys = ::mlir::OwningOpRef<mlir::ModuleOp>(
@@ -1104,6 +1242,19 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
     cost_analysis_data_.is_available = true;
     cost_analysis_data_.num_cost_updates = options.updates_per_interval - 1;
     cost_analysis_data_.cost_recorder = std::make_unique<CostRecorder>();
+    const std::string cost_profile_path = CostProfilePath();
+    if (!cost_profile_path.empty() &&
+        tensorflow::Env::Default()->FileExists(cost_profile_path).ok()) {
+      OpCostMapProto op_cost_map;
+      Status status = tensorflow::ReadTextProto(
+          tensorflow::Env::Default(), cost_profile_path, &op_cost_map);
+      if (status.ok()) {
+        cost_analysis_data_.cost_recorder->RecordCosts(op_cost_map);
+      } else {
+        LOG(WARNING) << "TFRT ignored persisted op costs of loaded client "
+                     << "graph " << name_ << ": " << status;
+      }
+    }
     if (executable_context_->IsForMlrt()) {
       cost_analysis_data_.tf_mlir_with_op_keys =
           std::move(tf_mlir_with_op_keys);
@@ -1113,6 +1264,18 @@ GraphExecutor::LoadedClientGraph::LoadedClientGraph(
   }
 }
 
+std::string GraphExecutor::LoadedClientGraph::CostProfilePath() const {
+  const auto& options = graph_executor_->options();
+  if (options.cost_analysis_options.cost_profile_dir.empty()) return "";
+  // Graph names join tensor names, which aren't valid file names.
+  const uint64_t fingerprint = tensorflow::Fingerprint64(
+      absl::StrCat(options.model_metadata.name(), "/",
+                   options.model_metadata.version(), "/", name_));
+  return tensorflow::io::JoinPath(
+      options.cost_analysis_options.cost_profile_dir,
+      absl::StrCat(absl::Hex(fingerprint, absl::kZeroPad16), ".pbtxt"));
+}
+
 void GraphExecutor::LoadedClientGraph::UpdateCostAnalysisData(
     absl::Time now, bool do_recompilation) {
   tensorflow::mutex_lock lock(cost_analysis_data_.mu);
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_compat_request_state.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
@@ -48,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/graph_executor/executable_context.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/graph_executor/sync_resource_state.h"
+#include "tensorflow/core/tfrt/graph_executor/warmup_request.pb.h"
 #include "tensorflow/core/tfrt/mlrt/bytecode/function.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/value.h"
@@ -140,6 +143,14 @@ tensorflow::Status RunMlrtFunction(
     std::vector<tensorflow::Tensor>* outputs,
     SyncResourceState* sync_resource_state);
 
+// The file of recorded warm-up requests in the assets.extra directory of a
+// SavedModel: a TFRecord file of serialized `WarmupRequest`s.
+inline constexpr char kWarmupRequestsFileName[] = "tfrt_warmup_requests";
+
+// Reads the warm-up requests in the TFRecord file `path`.
+StatusOr<std::vector<WarmupRequest>> ReadWarmupRequests(
+    const std::string& path);
+
 // Loads (if not yet) and runs a subgraph in a graph as per each request.
 class GraphExecutor {
  public:
@@ -164,7 +175,7 @@ class GraphExecutor {
     // then recompiles using updated costs occurs.
     CostRecorder* MaybeGetCostRecorder(absl::Time now, bool* do_recompilation);
     // Updates the op cost values in this `LoadedClientGraph` with records from
-    // `cost_recorder`.
+    // `cost_recorder`, and persists them if `cost_profile_dir` is set.
     Status UpdateCost(const CostRecorder& cost_recorder,
                       const Runtime& runtime);
     // Updates `cost_analysis_data_` to make it accurate for the next execution.
@@ -194,6 +205,10 @@ class GraphExecutor {
     }
 
    private:
+    // Returns the file of the persisted op costs of this graph, or an empty
+    // string if they aren't persisted.
+    std::string CostProfilePath() const;
+
     std::string name_;
     SymbolUids symbol_uids_;
     GraphExecutor* graph_executor_ = nullptr;
@@ -284,6 +299,12 @@ class GraphExecutor {
   // Extends the current graph by `graph`.
   tensorflow::Status Extend(const GraphDef& graph);
 
+  // Runs each of `requests` once, on up to `num_threads` threads, so that
+  // their client graphs are compiled and initialized before serving. Returns
+  // the error of the first failed request, if any.
+  tensorflow::Status Warmup(absl::Span<const WarmupRequest> requests,
+                            int num_threads);
+
   tensorflow::tfrt_stub::TfrtGraphExecutionState& graph_execution_state()
       const {
     return *graph_execution_state_;
@@ -335,6 +356,12 @@ class GraphExecutor {
 
   tensorflow::Status InitBytecode(LoadedClientGraph* loaded_graph);
 
+  // Recompiles `loaded_client_graph` with the costs of `cost_recorder` and
+  // starts the next cost measurement cycle.
+  tensorflow::Status RecompileWithUpdatedCost(
+      LoadedClientGraph& loaded_client_graph, const CostRecorder& cost_recorder,
+      absl::Time now);
+
   // Returns a `LoadedClientGraph` given input/output tensor info. If there is
   // no existing one yet, creates one first.
   StatusOr<std::reference_wrapper<GraphExecutor::LoadedClientGraph>>
@@ -364,6 +391,12 @@ class GraphExecutor {
   absl::flat_hash_map<std::string /*joined_name*/,
                       std::unique_ptr<LoadedClientGraph>>
       loaded_client_graphs_ TF_GUARDED_BY(loaded_client_graphs_mu_);
+  // The joined names of the client graphs being loaded. Different client
+  // graphs are loaded concurrently; requests for one being loaded wait on
+  // `loaded_client_graphs_cv_`.
+  absl::flat_hash_set<std::string> loading_client_graphs_
+      TF_GUARDED_BY(loaded_client_graphs_mu_);
+  tensorflow::condition_variable loaded_client_graphs_cv_;
 
   std::unique_ptr<mlrt::KernelRegistry> kernel_registry_;
 
@@ -374,6 +407,10 @@ class GraphExecutor {
   absl::Duration simulated_duration_ = absl::ZeroDuration();
   tensorflow::mutex num_recompilations_mu_;
   int num_recompilations_ TF_GUARDED_BY(num_recompilations_mu_) = 0;
+
+  // Runs the recompilations if `recompile_in_background` is set. Declared
+  // last, so that the pending ones finish before the rest is destroyed.
+  std::unique_ptr<tensorflow::thread::ThreadPool> cost_update_thread_pool_;
 };
 
 void RegisterMlirDialect(mlir::DialectRegistry& registry);
@@ -24,6 +24,7 @@ limitations under the License.
 #include "learning/brain/experimental/tfrt/native_lowering/kernels/sync_fallback_kernels.h"
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
@@ -31,8 +32,13 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/tfrt/fallback/op_cost_map.pb.h"
+#include "tensorflow/core/tfrt/graph_executor/warmup_request.pb.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/context.h"
 #include "tensorflow/core/tfrt/mlrt/interpreter/value.h"
 #include "tensorflow/core/tfrt/mlrt/kernel/kernel.h"
@@ -215,6 +221,64 @@ TEST_P(GraphExecutorTest, OnlineCostAnalysisEveryTime) {
   }
 }
 
+TEST_P(GraphExecutorTest, OnlineCostAnalysisPersistsCostsInBackground) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  const std::string cost_profile_dir = tensorflow::io::JoinPath(
+      ::testing::TempDir(), absl::StrCat("cost_profile_", GetParam()));
+  TF_ASSERT_OK(tensorflow::Env::Default()->RecursivelyCreateDir(
+      cost_profile_dir));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  options.cost_analysis_options.version =
+      GraphExecutionOptions::CostAnalysisOptions::kOnce;
+  options.cost_analysis_options.recompile_in_background = true;
+  options.cost_analysis_options.cost_profile_dir = cost_profile_dir;
+  options.enable_mlrt = GetParam();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()));
+  auto resource_context = std::make_unique<tfrt::ResourceContext>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor_base,
+      GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                            std::move(resource_context), graph_def,
+                            GetKernelRegistry()));
+  auto graph_executor = std::unique_ptr<GraphExecutorForTestingCostAnalysis>(
+      static_cast<GraphExecutorForTestingCostAnalysis*>(
+          graph_executor_base.release()));
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({2}));
+
+  // Destroying the executor waits for the recompilation.
+  graph_executor.reset();
+
+  std::vector<std::string> children;
+  TF_ASSERT_OK(
+      tensorflow::Env::Default()->GetChildren(cost_profile_dir, &children));
+  ASSERT_EQ(children.size(), 1);
+  OpCostMapProto op_cost_map;
+  TF_ASSERT_OK(tensorflow::ReadTextProto(
+      tensorflow::Env::Default(),
+      tensorflow::io::JoinPath(cost_profile_dir, children[0]), &op_cost_map));
+  EXPECT_GT(op_cost_map.op_cost_map_size(), 0);
+}
+
 TEST_P(GraphExecutorTest, OnlineCostAnalysisDisabled) {
   GraphDef graph_def;
   TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
@@ -490,6 +554,67 @@ TEST_F(GraphExecutorTest, Extend) {
               ::testing::ElementsAreArray({2}));
 }
 
+TEST_F(GraphExecutorTest, Warmup) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()));
+  auto resource_context = std::make_unique<tfrt::ResourceContext>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor,
+      GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                            std::move(resource_context), graph_def,
+                            GetKernelRegistry()));
+
+  // Records two signatures, with input 'x' set to [[1, 1, 1]].
+  const tensorflow::Tensor input =
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1});
+  WarmupRequest rank_request;
+  WarmupRequest::Feed* feed = rank_request.add_feeds();
+  feed->set_name("input");
+  input.AsProtoTensorContent(feed->mutable_tensor());
+  rank_request.add_fetch_tensor_names("rank");
+  WarmupRequest input_request = rank_request;
+  input_request.set_fetch_tensor_names(0, "input");
+
+  const std::string path =
+      tensorflow::io::JoinPath(::testing::TempDir(), kWarmupRequestsFileName);
+  {
+    std::unique_ptr<tensorflow::WritableFile> file;
+    TF_ASSERT_OK(tensorflow::Env::Default()->NewWritableFile(path, &file));
+    tensorflow::io::RecordWriter writer(file.get());
+    TF_ASSERT_OK(writer.WriteRecord(rank_request.SerializeAsString()));
+    TF_ASSERT_OK(writer.WriteRecord(input_request.SerializeAsString()));
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+  }
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<WarmupRequest> requests,
+                          ReadWarmupRequests(path));
+  ASSERT_EQ(requests.size(), 2);
+
+  TF_ASSERT_OK(graph_executor->Warmup(requests, /*num_threads=*/2));
+
+  // Both client graphs are compiled.
+  GraphExecutor::RunOptions run_options;
+  run_options.disable_compilation = true;
+  std::vector<tensorflow::Tensor> outputs;
+  TF_ASSERT_OK(graph_executor->Run(run_options, {{"input", input}},
+                                   /*output_tensor_names=*/{"rank"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({2}));
+  TF_ASSERT_OK(graph_executor->Run(run_options, {{"input", input}},
+                                   /*output_tensor_names=*/{"input"},
+                                   /*target_tensor_names=*/{}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+}
+
 TEST_F(GraphExecutorTest, DisableCompilation) {
   GraphDef graph_def;
   TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
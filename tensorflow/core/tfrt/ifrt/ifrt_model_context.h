@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_MODEL_CONTEXT_H_
 
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -61,10 +62,20 @@ class IfrtModelContext {
     return shape_representation_fn_;
   }
 
+  // The directory of the persistent compilation cache of the IFRT programs.
+  // Empty disables it.
+  void set_compilation_cache_dir(absl::string_view compilation_cache_dir) {
+    compilation_cache_dir_ = std::string(compilation_cache_dir);
+  }
+  absl::string_view compilation_cache_dir() const {
+    return compilation_cache_dir_;
+  }
+
  private:
   std::shared_ptr<xla::ifrt::Client> client_;
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_ =
       tensorflow::IdentityShapeRepresentationFn();
+  std::string compilation_cache_dir_;
 
   std::vector<ServingExecutableRegistry::Handle> handles_;
 };
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -27,11 +28,14 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tfrt/transforms/ifrt/tf2hlo.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
+#include "xla/debug_options_flags.h"
 #include "xla/hlo/ir/hlo_sharding.h"
 #include "xla/pjrt/pjrt_executable.h"
 #include "xla/python/ifrt/array.h"
@@ -49,13 +53,19 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/protobuf/tpu/compile_metadata.pb.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_compilation_cache.pb.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_tensor_utils.h"
 #include "tensorflow/core/tfrt/ifrt/sharding_utils.h"
 #include "tsl/concurrency/ref_count.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/threadpool.h"
 
@@ -101,6 +111,24 @@ absl::StatusOr<xla::DeviceAssignment> GetXlaDeviceAssignment(
   }
 }
 
+xla::CompileOptions CreateXlaCompileOptions(
+    const tensorflow::tpu::TPUCompileMetadataProto& compile_metadata,
+    const xla::DeviceAssignment& device_assignment) {
+  xla::CompileOptions xla_compile_options;
+  // TODO(b/304839793): populate xla_compile_options.argument_layouts.
+  // TODO(b/316071625): per model config in TFRT + IFRT.
+  xla_compile_options.executable_build_options.set_num_replicas(
+      compile_metadata.num_replicas());
+  xla_compile_options.executable_build_options.set_num_partitions(
+      compile_metadata.num_cores_per_replica());
+
+  xla_compile_options.executable_build_options.set_use_spmd_partitioning(true);
+  xla_compile_options.parameter_is_tupled_arguments = false;
+  xla_compile_options.executable_build_options.set_device_assignment(
+      device_assignment);
+  return xla_compile_options;
+}
+
 absl::StatusOr<std::vector<xla::ifrt::Device*>> GetAssignedDevices(
     const xla::ifrt::Client& ifrt_client,
     const tensorflow::tpu::TPUCompileMetadataProto& compile_metadata) {
@@ -149,6 +177,26 @@ CreateArrayFromHostTensorForSingleDevice(xla::ifrt::Client& ifrt_client,
 
 }  // namespace
 
+IfrtServingExecutable::IfrtServingExecutable(
+    absl::string_view model_name, absl::string_view signature_name,
+    mlir::OwningOpRef<mlir::ModuleOp> module,
+    std::shared_ptr<xla::ifrt::Client> client,
+    tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
+    absl::string_view compilation_cache_dir)
+    : model_name_(std::string(model_name)),
+      signature_name_(std::string(signature_name)),
+      compilation_cache_dir_(std::string(compilation_cache_dir)),
+      module_(std::move(module)),
+      ifrt_client_(std::move(client)),
+      shape_representation_fn_(std::move(shape_representation_fn)) {
+  if (!compilation_cache_dir_.empty()) {
+    std::string program;
+    llvm::raw_string_ostream os(program);
+    module_->print(os);
+    program_fingerprint_ = tsl::Fingerprint64(os.str());
+  }
+}
+
 absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
 IfrtServingExecutable::ConvertTensorToArray(
     const tensorflow::Tensor& tensor, const xla::ifrt::DeviceList& device_list,
@@ -226,16 +274,8 @@ IfrtServingExecutable::CreateExecutableSynchronously(
 
   VLOG(2) << "Device assignment :" << da.ToString();
 
-  xla::CompileOptions xla_compile_options;
-  // TODO(b/304839793): populate xla_compile_options.argument_layouts.
-  // TODO(b/316071625): per model config in TFRT + IFRT.
-  xla_compile_options.executable_build_options.set_num_replicas(num_replicas);
-  xla_compile_options.executable_build_options.set_num_partitions(
-      num_partitions);
-
-  xla_compile_options.executable_build_options.set_use_spmd_partitioning(true);
-  xla_compile_options.parameter_is_tupled_arguments = false;
-  xla_compile_options.executable_build_options.set_device_assignment(da);
+  xla::CompileOptions xla_compile_options =
+      CreateXlaCompileOptions(tf2hlo_result.compile_metadata, da);
 
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<xla::ifrt::LoadedExecutable> ifrt_executable,
@@ -252,6 +292,100 @@ IfrtServingExecutable::CreateExecutableSynchronously(
   return executable_bundle;
 }
 
+std::string IfrtServingExecutable::CompilationCacheKey(
+    absl::Span<const tensorflow::Tensor> inputs) const {
+  // The platform version identifies the compiler of the backend, and the XLA
+  // flags its options.
+  std::string key = absl::StrCat(
+      "program:", program_fingerprint_, ";tf:", TF_VERSION_STRING,
+      ";xla_flags:", DeterministicProtoHash64(xla::GetDebugOptionsFromFlags()),
+      ";platform:", ifrt_client_->platform_name(), ":",
+      ifrt_client_->platform_version(),
+      ";devices:", ifrt_client_->device_count());
+  if (!ifrt_client_->devices().empty()) {
+    absl::StrAppend(&key, ":", ifrt_client_->devices()[0]->device_kind());
+  }
+  absl::StrAppend(&key, ";inputs:");
+  for (const auto& tensor : inputs) {
+    absl::StrAppend(&key, DataTypeString(tensor.dtype()),
+                    tensor.shape().DebugString(), ",");
+  }
+  return key;
+}
+
+std::string IfrtServingExecutable::CompilationCachePath(
+    absl::string_view key) const {
+  return tsl::io::JoinPath(
+      compilation_cache_dir_,
+      absl::StrCat(absl::Hex(tsl::Fingerprint64(key), absl::kZeroPad16),
+                   ".ifrt_executable"));
+}
+
+absl::StatusOr<IfrtServingExecutable::CachedExecutableBundle>
+IfrtServingExecutable::LoadPersistedExecutable(absl::string_view key) {
+  const std::string path = CompilationCachePath(key);
+  tsl::Env* env = tsl::Env::Default();
+  if (!env->FileExists(path).ok()) {
+    return absl::NotFoundError(absl::StrCat("No cached executable at ", path));
+  }
+  std::string contents;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(env, path, &contents));
+  CompilationCacheEntryProto entry;
+  if (!entry.ParseFromString(contents)) {
+    return absl::DataLossError(
+        absl::StrCat("Failed to parse the cached executable at ", path));
+  }
+  if (entry.key() != key) {
+    return absl::NotFoundError(
+        absl::StrCat("The cached executable at ", path, " has another key"));
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      xla::DeviceAssignment da,
+      GetXlaDeviceAssignment(*ifrt_client_, entry.compile_metadata()));
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<xla::ifrt::LoadedExecutable> ifrt_executable,
+      ifrt_client_->GetDefaultCompiler()->DeserializeLoadedExecutable(
+          entry.serialized_executable(),
+          std::make_unique<xla::ifrt::XlaDeserializeExecutableOptions>(
+              CreateXlaCompileOptions(entry.compile_metadata(), da))));
+
+  CachedExecutableBundle executable_bundle;
+  executable_bundle.ifrt_executable = std::move(ifrt_executable);
+  executable_bundle.compile_metadata =
+      std::move(*entry.mutable_compile_metadata());
+  return executable_bundle;
+}
+
+absl::Status IfrtServingExecutable::PersistExecutable(
+    absl::string_view key, const CachedExecutableBundle& executable_bundle) {
+  tsl::Env* env = tsl::Env::Default();
+  const std::string path = CompilationCachePath(key);
+  // The key addresses the content of the executable, so an existing entry,
+  // e.g. published by another server sharing the directory, is kept.
+  if (env->FileExists(path).ok()) {
+    return absl::OkStatus();
+  }
+
+  CompilationCacheEntryProto entry;
+  entry.set_key(std::string(key));
+  TF_ASSIGN_OR_RETURN(*entry.mutable_serialized_executable(),
+                      executable_bundle.ifrt_executable->Serialize());
+  *entry.mutable_compile_metadata() = executable_bundle.compile_metadata;
+
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(compilation_cache_dir_));
+  // Written to a temporary file that is renamed, so that other servers sharing
+  // the directory never read a partial entry.
+  std::string temp_path = path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return absl::InternalError(
+        absl::StrCat("Failed to create a temporary file name for ", path));
+  }
+  TF_RETURN_IF_ERROR(
+      tsl::WriteStringToFile(env, temp_path, entry.SerializeAsString()));
+  return env->RenameFile(temp_path, path);
+}
+
 xla::ifrt::Future<absl::StatusOr<IfrtServingExecutable::CachedExecutableBundle>>
 IfrtServingExecutable::LookUpOrCreateExecutable(
     absl::Span<const tensorflow::Tensor> inputs) {
@@ -280,11 +414,41 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
     executable_bundles_.emplace(key, future);
   }
 
+  absl::StatusOr<CachedExecutableBundle> executable_bundle;
+  std::string cache_key;
+  if (!compilation_cache_dir_.empty()) {
+    cache_key = CompilationCacheKey(inputs);
+    executable_bundle = LoadPersistedExecutable(cache_key);
+    if (executable_bundle.ok()) {
+      LOG(INFO) << "Loaded executable from the persistent compilation cache";
+      promise.Set(std::move(executable_bundle));
+      return future;
+    }
+    if (!absl::IsNotFound(executable_bundle.status())) {
+      LOG(WARNING) << "Failed to load executable from the persistent "
+                      "compilation cache: "
+                   << executable_bundle.status();
+    }
+  }
+
   LOG(INFO) << "Cache missed. Building executable";
-  absl::StatusOr<CachedExecutableBundle> executable_bundle =
-      CreateExecutableSynchronously(inputs);
+  executable_bundle = CreateExecutableSynchronously(inputs);
 
+  // The waiting requests can run while the executable is written.
+  std::optional<CachedExecutableBundle> executable_bundle_to_persist;
+  if (!cache_key.empty() && executable_bundle.ok()) {
+    executable_bundle_to_persist = *executable_bundle;
+  }
   promise.Set(std::move(executable_bundle));
+  if (executable_bundle_to_persist.has_value()) {
+    absl::Status status =
+        PersistExecutable(cache_key, *executable_bundle_to_persist);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write executable to the persistent "
+                      "compilation cache: "
+                   << status;
+    }
+  }
   return future;
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -49,16 +50,17 @@ namespace ifrt_serving {
 
 class IfrtServingExecutable {
  public:
+  // If `compilation_cache_dir` is not empty, the executables are also cached
+  // there, keyed by the fingerprint of `module`, the input dtypes and shapes,
+  // the platform and devices of `client`, and the TensorFlow version, so that
+  // they are reused across model versions and restarts. The directory may be
+  // on a shared filesystem.
   IfrtServingExecutable(
       absl::string_view model_name, absl::string_view signature_name,
       mlir::OwningOpRef<mlir::ModuleOp> module,
       std::shared_ptr<xla::ifrt::Client> client,
-      tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn)
-      : model_name_(std::string(model_name)),
-        signature_name_(std::string(signature_name)),
-        module_(std::move(module)),
-        ifrt_client_(std::move(client)),
-        shape_representation_fn_(std::move(shape_representation_fn)) {}
+      tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
+      absl::string_view compilation_cache_dir = "");
 
   // Movable but not copyable.
   IfrtServingExecutable(IfrtServingExecutable&& other) = default;
@@ -104,6 +106,9 @@ class IfrtServingExecutable {
 
   std::string model_name_;
   std::string signature_name_;
+  std::string compilation_cache_dir_;
+  // The fingerprint of the printed `module_`.
+  uint64_t program_fingerprint_ = 0;
 
   std::unique_ptr<mlir::MLIRContext> context_;
   mlir::OwningOpRef<mlir::ModuleOp> module_;
@@ -127,6 +132,19 @@ class IfrtServingExecutable {
   absl::StatusOr<IfrtServingExecutable::CachedExecutableBundle>
   CreateExecutableSynchronously(absl::Span<const tensorflow::Tensor> inputs);
 
+  // Returns the key of `inputs` in the persistent compilation cache.
+  std::string CompilationCacheKey(
+      absl::Span<const tensorflow::Tensor> inputs) const;
+  std::string CompilationCachePath(absl::string_view key) const;
+
+  // Loads the executable of `key` from the persistent compilation cache.
+  // Returns NotFound on a miss.
+  absl::StatusOr<CachedExecutableBundle> LoadPersistedExecutable(
+      absl::string_view key);
+  // Writes `executable_bundle` to the persistent compilation cache.
+  absl::Status PersistExecutable(
+      absl::string_view key, const CachedExecutableBundle& executable_bundle);
+
   absl::StatusOr<std::unique_ptr<xla::ifrt::Sharding>> CreateSharding(
       int num_devices, const xla::ifrt::Shape& arg_xla_shape,
       const xla::ifrt::Shape& sharded_shapes);
@@ -41,8 +41,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/platform/test.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
 #include "tsl/platform/statusor.h"
 
 namespace tensorflow {
@@ -150,6 +153,54 @@ TEST(IfrtServingExecutableTest, MultipleShapes) {
   EXPECT_THAT(outputs2, ElementsAre(TensorEq(expected_out2)));
 }
 
+TEST(IfrtServingExecutableTest, PersistentCompilationCache) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  const std::string compilation_cache_dir =
+      tsl::io::JoinPath(::testing::TempDir(), "ifrt_compilation_cache");
+  auto x = tensorflow::test::AsTensor<int32_t>({1, 2, 3},
+                                               tensorflow::TensorShape({1, 3}));
+  auto y = tensorflow::test::AsTensor<int32_t>({1, 2, 3},
+                                               tensorflow::TensorShape({3, 1}));
+  std::vector<tensorflow::Tensor> inputs{x, y};
+  const auto expected_out = tensorflow::test::AsTensor<int32_t>(
+      {14}, tensorflow::TensorShape({1, 1}));
+
+  // The second executable, e.g. of the next model version, loads the
+  // executable compiled by the first one.
+  for (int i = 0; i < 2; ++i) {
+    mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+        mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+    ASSERT_TRUE(mlir_module);
+
+    IfrtServingExecutable executable(
+        "test", "main", std::move(mlir_module), client,
+        tensorflow::IdentityShapeRepresentationFn(), compilation_cache_dir);
+    TF_ASSERT_OK_AND_ASSIGN(auto result,
+                            executable.Execute(absl::MakeSpan(inputs)));
+    EXPECT_THAT(result, ElementsAre(TensorEq(expected_out)));
+
+    std::vector<std::string> children;
+    TF_ASSERT_OK(
+        tsl::Env::Default()->GetChildren(compilation_cache_dir, &children));
+    EXPECT_EQ(children.size(), 1);
+  }
+}
+
 TEST(IfrtServingExecutableTest, Spmd) {
   // Create test input module
   constexpr absl::string_view kDataDirectory =
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_tensor.h"
+#include "tensorflow/core/tfrt/runtime/work_stealing_concurrent_work_queue.h"
 #include "tfrt/cpu/core_runtime/cpu_op_handler.h"  // from @tf_runtime
 #include "tfrt/core_runtime/core_runtime.h"  // from @tf_runtime
 #include "tfrt/host_context/concurrent_work_queue.h"  // from @tf_runtime
@@ -65,6 +66,11 @@ std::unique_ptr<Runtime> Runtime::Create(int num_inter_op_threads,
           num_intra_op_threads, num_inter_op_threads)));
 }
 
+std::unique_ptr<Runtime> Runtime::Create(
+    const WorkStealingWorkQueueOptions& options) {
+  return Runtime::Create(WorkStealingWorkQueue::Create(options));
+}
+
 Runtime::Runtime(std::unique_ptr<tfrt::CoreRuntime> core_runtime,
                  WorkQueueInterface* work_queue)
     : core_runtime_(std::move(core_runtime)), work_queue_(work_queue) {
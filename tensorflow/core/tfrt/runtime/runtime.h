@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/tfrt/graph_executor/graph_execution_options.h"
 #include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
+#include "tensorflow/core/tfrt/runtime/work_stealing_concurrent_work_queue.h"
 #include "tsl/platform/errors.h"
 #include "tfrt/core_runtime/core_runtime.h"  // from @tf_runtime
 #include "tfrt/host_context/resource_context.h"  // from @tf_runtime
@@ -128,6 +129,12 @@ class Runtime {
   static std::unique_ptr<Runtime> Create(
       std::unique_ptr<WorkQueueInterface> work_queue);
 
+  // Creates a runtime instance whose work queue is a WorkStealingWorkQueue,
+  // which places the tasks of each request on one NUMA node. Returns null
+  // upon creation error.
+  static std::unique_ptr<Runtime> Create(
+      const WorkStealingWorkQueueOptions& options);
+
   ~Runtime();
   Runtime(Runtime&&) = default;
   Runtime& operator=(Runtime&&) = default;
@@ -0,0 +1,351 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/runtime/work_stealing_concurrent_work_queue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/tfrt/utils/thread_pool.h"
+#include "tfrt/host_context/async_value.h"  // from @tf_runtime
+#include "tfrt/host_context/task_function.h"  // from @tf_runtime
+#include "tfrt/support/forward_decls.h"  // from @tf_runtime
+#include "tfrt/support/latch.h"  // from @tf_runtime
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+// The scheduler and the index of the worker running on this thread, if any.
+thread_local const void* current_scheduler = nullptr;
+thread_local int current_worker = -1;
+
+}  // namespace
+
+class WorkStealingWorkQueue::Scheduler {
+ public:
+  explicit Scheduler(const WorkStealingWorkQueueOptions& options);
+  ~Scheduler();
+
+  int num_threads() const { return workers_.size(); }
+
+  thread::ThreadPoolInterface* intra_op_threadpool() {
+    return &intra_op_threadpool_;
+  }
+
+  // Returns the core group of the next request.
+  int NextCoreGroup() {
+    return next_core_group_.fetch_add(1, std::memory_order_relaxed) %
+           num_core_groups_;
+  }
+
+  // Queues `task` to a worker of `core_group`, or to any worker if it is -1.
+  void Schedule(tfrt::TaskFunction task, int core_group);
+
+  std::optional<tfrt::TaskFunction> ScheduleBlocking(tfrt::TaskFunction task,
+                                                     bool allow_queuing);
+
+  void Quiesce() TF_LOCKS_EXCLUDED(mu_);
+
+  bool IsInWorkerThread() const { return current_scheduler == this; }
+
+ private:
+  struct Worker {
+    int core_group = 0;
+    int numa_node = port::kNUMANoAffinity;
+    // The other workers, in the order they are stolen from.
+    std::vector<int> victims;
+    // Round-robin counter of the tasks queued to the group of the worker.
+    // Only used in the first worker of each group.
+    std::atomic<uint32_t> next_in_group{0};
+
+    mutex mu;
+    std::deque<tfrt::TaskFunction> tasks TF_GUARDED_BY(mu);
+
+    std::unique_ptr<Thread> thread;
+  };
+
+  void WorkerLoop(int worker) TF_LOCKS_EXCLUDED(mu_);
+
+  // Pops the last task of `worker`, or else steals the first task of one of
+  // its victims.
+  std::optional<tfrt::TaskFunction> Pop(int worker);
+
+  void FinishTask() TF_LOCKS_EXCLUDED(mu_);
+
+  int num_core_groups_ = 1;
+  int threads_per_group_ = 1;
+  const int num_blocking_threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<uint32_t> next_core_group_{0};
+
+  // The number of tasks in the deques of the workers.
+  std::atomic<int64_t> num_queued_{0};
+  // The number of added tasks that haven't finished running.
+  std::atomic<int64_t> num_pending_{0};
+  // The number of blocking tasks that haven't finished running.
+  std::atomic<int> num_blocking_{0};
+  // The number of workers waiting for tasks.
+  std::atomic<int> num_idle_{0};
+
+  mutex mu_;
+  condition_variable work_cv_;
+  condition_variable quiesce_cv_;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+
+  TfThreadPool intra_op_threadpool_;
+  thread::ThreadPool blocking_threadpool_;
+};
+
+WorkStealingWorkQueue::Scheduler::Scheduler(
+    const WorkStealingWorkQueueOptions& options)
+    : num_blocking_threads_(std::max(options.num_blocking_threads, 1)),
+      intra_op_threadpool_("work_stealing_intra",
+                           options.num_intra_op_threads > 0
+                               ? options.num_intra_op_threads
+                               : port::MaxParallelism()),
+      blocking_threadpool_(Env::Default(), "work_stealing_blocking",
+                           num_blocking_threads_) {
+  const int num_numa_nodes = port::NUMAEnabled() ? port::NUMANumNodes() : 1;
+  num_core_groups_ = options.num_core_groups > 0 ? options.num_core_groups
+                                                 : num_numa_nodes;
+  const int num_threads = options.num_threads > 0 ? options.num_threads
+                                                  : port::MaxParallelism();
+  threads_per_group_ = std::max(num_threads / num_core_groups_, 1);
+
+  for (int group = 0; group < num_core_groups_; ++group) {
+    for (int i = 0; i < threads_per_group_; ++i) {
+      auto worker = std::make_unique<Worker>();
+      worker->core_group = group;
+      if (num_numa_nodes > 1) worker->numa_node = group % num_numa_nodes;
+      workers_.push_back(std::move(worker));
+    }
+  }
+
+  // Steals from the own group first, then from the own NUMA node, and then
+  // from the other nodes. Every worker starts with a different victim of each
+  // tier, so that the stealing is spread.
+  for (int w = 0; w < workers_.size(); ++w) {
+    Worker& worker = *workers_[w];
+    std::vector<int> same_node, other_nodes;
+    for (int i = 1; i < workers_.size(); ++i) {
+      const int victim = (w + i) % workers_.size();
+      if (workers_[victim]->core_group == worker.core_group) {
+        worker.victims.push_back(victim);
+      } else if (workers_[victim]->numa_node == worker.numa_node) {
+        same_node.push_back(victim);
+      } else {
+        other_nodes.push_back(victim);
+      }
+    }
+    worker.victims.insert(worker.victims.end(), same_node.begin(),
+                          same_node.end());
+    worker.victims.insert(worker.victims.end(), other_nodes.begin(),
+                          other_nodes.end());
+  }
+
+  for (int w = 0; w < workers_.size(); ++w) {
+    workers_[w]->thread.reset(Env::Default()->StartThread(
+        ThreadOptions(), absl::StrCat("work_stealing_", w),
+        [this, w]() { WorkerLoop(w); }));
+  }
+}
+
+WorkStealingWorkQueue::Scheduler::~Scheduler() {
+  {
+    mutex_lock lock(mu_);
+    stop_ = true;
+    work_cv_.notify_all();
+  }
+  // Joins the workers, which run the remaining tasks first.
+  for (auto& worker : workers_) worker->thread.reset();
+}
+
+void WorkStealingWorkQueue::Scheduler::Schedule(tfrt::TaskFunction task,
+                                                int core_group) {
+  num_pending_.fetch_add(1);
+  int w;
+  if (IsInWorkerThread() &&
+      (core_group < 0 || workers_[current_worker]->core_group == core_group)) {
+    w = current_worker;
+  } else {
+    if (core_group < 0) core_group = NextCoreGroup();
+    const int first = core_group * threads_per_group_;
+    w = first + workers_[first]->next_in_group.fetch_add(
+                    1, std::memory_order_relaxed) %
+                    threads_per_group_;
+  }
+  {
+    Worker& worker = *workers_[w];
+    mutex_lock lock(worker.mu);
+    worker.tasks.push_back(std::move(task));
+  }
+  // Pairs with the check of num_queued_ by the idle workers, so that either a
+  // worker sees the task or this thread sees the idle worker.
+  num_queued_.fetch_add(1);
+  if (num_idle_.load() > 0) {
+    mutex_lock lock(mu_);
+    work_cv_.notify_one();
+  }
+}
+
+std::optional<tfrt::TaskFunction>
+WorkStealingWorkQueue::Scheduler::ScheduleBlocking(tfrt::TaskFunction task,
+                                                   bool allow_queuing) {
+  if (num_blocking_.fetch_add(1) >= num_blocking_threads_ && !allow_queuing) {
+    num_blocking_.fetch_sub(1);
+    return {std::move(task)};
+  }
+  num_pending_.fetch_add(1);
+  auto* copy = new tfrt::TaskFunction(std::move(task));
+  blocking_threadpool_.Schedule([this, copy] {
+    (*copy)();
+    delete copy;
+    num_blocking_.fetch_sub(1);
+    FinishTask();
+  });
+  return std::nullopt;
+}
+
+void WorkStealingWorkQueue::Scheduler::Quiesce() {
+  mutex_lock lock(mu_);
+  while (num_pending_.load() > 0) quiesce_cv_.wait(lock);
+}
+
+std::optional<tfrt::TaskFunction> WorkStealingWorkQueue::Scheduler::Pop(
+    int worker) {
+  {
+    Worker& self = *workers_[worker];
+    mutex_lock lock(self.mu);
+    if (!self.tasks.empty()) {
+      tfrt::TaskFunction task = std::move(self.tasks.back());
+      self.tasks.pop_back();
+      num_queued_.fetch_sub(1);
+      return {std::move(task)};
+    }
+  }
+  for (const int victim : workers_[worker]->victims) {
+    Worker& other = *workers_[victim];
+    mutex_lock lock(other.mu);
+    if (!other.tasks.empty()) {
+      tfrt::TaskFunction task = std::move(other.tasks.front());
+      other.tasks.pop_front();
+      num_queued_.fetch_sub(1);
+      return {std::move(task)};
+    }
+  }
+  return std::nullopt;
+}
+
+void WorkStealingWorkQueue::Scheduler::FinishTask() {
+  if (num_pending_.fetch_sub(1) == 1) {
+    mutex_lock lock(mu_);
+    quiesce_cv_.notify_all();
+  }
+}
+
+void WorkStealingWorkQueue::Scheduler::WorkerLoop(int worker) {
+  if (workers_[worker]->numa_node != port::kNUMANoAffinity) {
+    port::NUMASetThreadNodeAffinity(workers_[worker]->numa_node);
+  }
+  current_scheduler = this;
+  current_worker = worker;
+  while (true) {
+    if (std::optional<tfrt::TaskFunction> task = Pop(worker)) {
+      (*task)();
+      task.reset();
+      FinishTask();
+      continue;
+    }
+    mutex_lock lock(mu_);
+    num_idle_.fetch_add(1);
+    while (!stop_ && num_queued_.load() == 0) work_cv_.wait(lock);
+    num_idle_.fetch_sub(1);
+    if (stop_ && num_queued_.load() == 0) break;
+  }
+  current_scheduler = nullptr;
+  current_worker = -1;
+}
+
+std::unique_ptr<WorkStealingWorkQueue> WorkStealingWorkQueue::Create(
+    const WorkStealingWorkQueueOptions& options) {
+  // We don't use std::make_unique here because the constructor is private.
+  return std::unique_ptr<WorkStealingWorkQueue>(new WorkStealingWorkQueue(
+      /*id=*/0, std::make_shared<Scheduler>(options), /*core_group=*/-1));
+}
+
+WorkStealingWorkQueue::WorkStealingWorkQueue(
+    int64_t id, std::shared_ptr<Scheduler> scheduler, int core_group)
+    : WorkQueueInterface(id, scheduler->intra_op_threadpool()),
+      scheduler_(std::move(scheduler)),
+      core_group_(core_group) {}
+
+WorkStealingWorkQueue::~WorkStealingWorkQueue() = default;
+
+StatusOr<std::unique_ptr<WorkQueueInterface>>
+WorkStealingWorkQueue::InitializeRequest(int64_t request_id) const {
+  return {std::unique_ptr<WorkQueueInterface>(new WorkStealingWorkQueue(
+      request_id, scheduler_, scheduler_->NextCoreGroup()))};
+}
+
+int WorkStealingWorkQueue::GetParallelismLevel() const {
+  return scheduler_->num_threads();
+}
+
+void WorkStealingWorkQueue::AddTask(tfrt::TaskFunction work) {
+  scheduler_->Schedule(
+      tensorflow::tfrt_stub::WrapWork(id(), "inter", std::move(work)),
+      core_group_);
+}
+
+std::optional<tfrt::TaskFunction> WorkStealingWorkQueue::AddBlockingTask(
+    tfrt::TaskFunction work, bool allow_queuing) {
+  return scheduler_->ScheduleBlocking(std::move(work), allow_queuing);
+}
+
+void WorkStealingWorkQueue::Quiesce() { scheduler_->Quiesce(); }
+
+void WorkStealingWorkQueue::Await(
+    tfrt::ArrayRef<tfrt::RCReference<tfrt::AsyncValue>> values) {
+  // We are done when values_remaining drops to zero.
+  tfrt::latch values_remaining(values.size());
+
+  // As each value becomes available, we decrement the count.
+  for (auto& value : values) {
+    value->AndThen([&values_remaining]() { values_remaining.count_down(); });
+  }
+
+  // Wait until all values are resolved.
+  values_remaining.wait();
+}
+
+bool WorkStealingWorkQueue::IsInWorkerThread() const {
+  return scheduler_->IsInWorkerThread();
+}
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_TFRT_RUNTIME_WORK_STEALING_CONCURRENT_WORK_QUEUE_H_
+#define TENSORFLOW_CORE_TFRT_RUNTIME_WORK_STEALING_CONCURRENT_WORK_QUEUE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
+#include "tfrt/host_context/async_value.h"  // from @tf_runtime
+#include "tfrt/host_context/task_function.h"  // from @tf_runtime
+#include "tfrt/support/forward_decls.h"  // from @tf_runtime
+
+namespace tensorflow {
+namespace tfrt_stub {
+
+struct WorkStealingWorkQueueOptions {
+  // The number of threads running non-blocking tasks. 0 means one per core.
+  int num_threads = 0;
+  // The number of core groups the threads are split into. Each group is
+  // placed on one NUMA node, round-robin. 0 means one group per NUMA node.
+  int num_core_groups = 0;
+  // The number of threads running blocking tasks.
+  int num_blocking_threads = 16;
+  // The number of intra-op threads. 0 means one per core.
+  int num_intra_op_threads = 0;
+};
+
+// A work queue for the TFRT runtime that keeps the tasks of a request close
+// together.
+//
+// The non-blocking threads are split into core groups, each pinned to a NUMA
+// node. The per-request queues returned by InitializeRequest() are assigned
+// to a core group round-robin, and all the tasks of a request are queued to
+// the threads of its group; a task added from a thread of the group is queued
+// to that thread. An idle thread steals from the other threads of its group
+// first, then from the rest of its NUMA node, and then from the other nodes.
+//
+// Blocking tasks run on a separate thread pool, so that they never hold up
+// a non-blocking thread.
+class WorkStealingWorkQueue : public WorkQueueInterface {
+ public:
+  // The threads shared by a work queue and its per-request queues.
+  class Scheduler;
+
+  static std::unique_ptr<WorkStealingWorkQueue> Create(
+      const WorkStealingWorkQueueOptions& options);
+
+  ~WorkStealingWorkQueue() override;
+
+  // Returns a queue whose tasks run on the core group of the request.
+  StatusOr<std::unique_ptr<WorkQueueInterface>> InitializeRequest(
+      int64_t request_id) const override;
+
+  int GetParallelismLevel() const override;
+  std::string name() const override { return "WorkStealingWorkQueue"; }
+
+  void AddTask(tfrt::TaskFunction work) override;
+
+  // Returns `work` if `allow_queuing` is false and all the blocking threads
+  // are busy.
+  std::optional<tfrt::TaskFunction> AddBlockingTask(
+      tfrt::TaskFunction work, bool allow_queuing) override;
+
+  // Blocks until all the tasks, including the ones of the per-request queues,
+  // have run.
+  void Quiesce() override;
+
+  void Await(
+      tfrt::ArrayRef<::tfrt::RCReference<::tfrt::AsyncValue>> values) override;
+
+  bool IsInWorkerThread() const override;
+
+  // The core group the tasks of this queue run on, or -1 if any.
+  int core_group() const { return core_group_; }
+
+ private:
+  WorkStealingWorkQueue(int64_t id, std::shared_ptr<Scheduler> scheduler,
+                        int core_group);
+
+  std::shared_ptr<Scheduler> scheduler_;
+  int core_group_ = -1;
+};
+
+}  // namespace tfrt_stub
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_TFRT_RUNTIME_WORK_STEALING_CONCURRENT_WORK_QUEUE_H_
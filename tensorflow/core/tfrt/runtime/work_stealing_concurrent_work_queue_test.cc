@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/tfrt/runtime/work_stealing_concurrent_work_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <gtest/gtest.h>
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tfrt/host_context/task_function.h"  // from @tf_runtime
+#include "tfrt/support/latch.h"  // from @tf_runtime
+
+namespace tensorflow {
+namespace tfrt_stub {
+namespace {
+
+class WorkStealingWorkQueueTest : public ::testing::Test {
+ protected:
+  WorkStealingWorkQueueTest()
+      : work_queue_(WorkStealingWorkQueue::Create([] {
+          WorkStealingWorkQueueOptions options;
+          options.num_threads = 4;
+          options.num_core_groups = 2;
+          options.num_blocking_threads = 1;
+          options.num_intra_op_threads = 2;
+          return options;
+        }())) {}
+  std::unique_ptr<WorkStealingWorkQueue> work_queue_;
+};
+
+TEST_F(WorkStealingWorkQueueTest, GetParallelismLevelOk) {
+  EXPECT_EQ(work_queue_->GetParallelismLevel(), 4);
+  EXPECT_EQ(work_queue_->name(), "WorkStealingWorkQueue");
+}
+
+TEST_F(WorkStealingWorkQueueTest, InitializeRequestAssignsCoreGroups) {
+  auto first = work_queue_->InitializeRequest(/*request_id=*/1);
+  TF_ASSERT_OK(first.status());
+  auto second = work_queue_->InitializeRequest(/*request_id=*/2);
+  TF_ASSERT_OK(second.status());
+  auto* first_queue = static_cast<WorkStealingWorkQueue*>(first->get());
+  auto* second_queue = static_cast<WorkStealingWorkQueue*>(second->get());
+  EXPECT_NE(first_queue->core_group(), second_queue->core_group());
+  EXPECT_EQ(first_queue->id(), 1);
+  EXPECT_NE(first_queue->GetIntraOpThreadPool(), nullptr);
+}
+
+TEST_F(WorkStealingWorkQueueTest, RunningNestedTasks) {
+  constexpr int kNumTasks = 100;
+  auto request_queue = work_queue_->InitializeRequest(/*request_id=*/1);
+  TF_ASSERT_OK(request_queue.status());
+  WorkQueueInterface* queue = request_queue->get();
+  EXPECT_FALSE(queue->IsInWorkerThread());
+
+  tfrt::latch latch(2 * kNumTasks);
+  std::atomic<int> num_in_worker_thread{0};
+  for (int i = 0; i < kNumTasks; ++i) {
+    queue->AddTask(tfrt::TaskFunction([&, queue] {
+      if (queue->IsInWorkerThread()) ++num_in_worker_thread;
+      // Queued to the current thread, but may be stolen.
+      queue->AddTask(tfrt::TaskFunction([&] { latch.count_down(); }));
+      latch.count_down();
+    }));
+  }
+  latch.wait();
+  EXPECT_EQ(num_in_worker_thread, kNumTasks);
+}
+
+TEST_F(WorkStealingWorkQueueTest, RunningBlockingTask) {
+  tfrt::latch started(1);
+  tfrt::latch release(1);
+  EXPECT_FALSE(work_queue_
+                   ->AddBlockingTask(tfrt::TaskFunction([&] {
+                                       started.count_down();
+                                       release.wait();
+                                     }),
+                                     /*allow_queuing=*/false)
+                   .has_value());
+  started.wait();
+
+  // The only blocking thread is busy.
+  int n = 0;
+  std::optional<tfrt::TaskFunction> rejected = work_queue_->AddBlockingTask(
+      tfrt::TaskFunction([&n] { ++n; }), /*allow_queuing=*/false);
+  ASSERT_TRUE(rejected.has_value());
+  EXPECT_FALSE(work_queue_
+                   ->AddBlockingTask(std::move(*rejected),
+                                     /*allow_queuing=*/true)
+                   .has_value());
+
+  release.count_down();
+  work_queue_->Quiesce();
+  EXPECT_EQ(n, 1);
+}
+
+TEST_F(WorkStealingWorkQueueTest, QuiesceWaitsForAllTasks) {
+  constexpr int kNumTasks = 1000;
+  int n = 0;
+  mutex m;
+  for (int i = 0; i < kNumTasks; ++i) {
+    work_queue_->AddTask(tfrt::TaskFunction([&n, &m] {
+      mutex_lock lock(m);
+      ++n;
+    }));
+  }
+  work_queue_->Quiesce();
+  mutex_lock lock(m);
+  EXPECT_EQ(n, kNumTasks);
+}
+
+}  // namespace
+}  // namespace tfrt_stub
+}  // namespace tensorflow
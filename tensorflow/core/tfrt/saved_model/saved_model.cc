@@ -681,14 +681,30 @@ SavedModelImpl::LoadSavedModel(Options options,
               << persistent_cache_directory << ", and set it to read-only.";
   }
 
+  const bool enable_warmup = options.enable_warmup;
+  const int warmup_num_threads = options.warmup_num_threads;
+
   // Finally, create the saved model.
-  return {std::make_unique<SavedModelImpl>(
+  auto saved_model = std::make_unique<SavedModelImpl>(
       std::move(options), std::move(symbol_uids), std::move(meta_graph_def),
       std::move(bef), std::move(bef_file), std::move(bytecode),
       std::move(loaded_executable),
       std::move(initializers_and_signatures.signature_map),
       std::move(runner_table), std::move(resource_array),
-      std::move(graph_executor))};
+      std::move(graph_executor));
+
+  if (enable_warmup) {
+    const std::string warmup_requests_path = tensorflow::io::JoinPath(
+        saved_model_dir, "assets.extra", kWarmupRequestsFileName);
+    if (tensorflow::Env::Default()->FileExists(warmup_requests_path).ok()) {
+      TF_ASSIGN_OR_RETURN(std::vector<WarmupRequest> warmup_requests,
+                          ReadWarmupRequests(warmup_requests_path));
+      TF_RETURN_IF_ERROR(saved_model->graph_executor().Warmup(
+          warmup_requests, warmup_num_threads));
+    }
+  }
+
+  return {std::move(saved_model)};
 }
 
 SavedModelImpl::SavedModelImpl(
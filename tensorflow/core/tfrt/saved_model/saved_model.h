@@ -110,6 +110,15 @@ class SavedModel {
     // True if and only if SavedModel is being loaded to generate AOT results.
     bool aot_generation = false;
 
+    // If true, the requests recorded in
+    // `<saved_model_dir>/assets.extra/tfrt_warmup_requests` (see
+    // `WarmupRequest`), if any, are run before LoadSavedModel() returns, so
+    // that the model is only ready once their client graphs are compiled.
+    bool enable_warmup = false;
+
+    // The number of threads that run the warm-up requests.
+    int warmup_num_threads = 4;
+
     GraphExecutionOptions graph_execution_options;
   };
 
@@ -0,0 +1,223 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_record_writer.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The ring needs two slots at least, to tell a full slot from an empty one of
+// the next lap.
+uint64 RingSize(int64_t capacity) {
+  uint64 size = 2;
+  while (size < static_cast<uint64>(capacity)) size <<= 1;
+  return size;
+}
+
+// How long a producer waits for room before checking the ring again, in case
+// it missed the wake-up of the background thread.
+constexpr int64_t kProducerWaitMicros = 1000;
+
+}  // namespace
+
+AsyncRecordWriter::AsyncRecordWriter(Env* env, WritableFile* file,
+                                     io::RecordWriter* writer,
+                                     const Options& options)
+    : env_(env),
+      file_(file),
+      writer_(writer),
+      options_(options),
+      slots_(new Slot[RingSize(options.capacity)]),
+      mask_(RingSize(options.capacity) - 1) {
+  DCHECK_GT(options.capacity, 0);
+  for (uint64 i = 0; i <= mask_; ++i) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  thread_.reset(env_->StartThread(ThreadOptions(), "async_record_writer",
+                                  [this]() { WriterLoop(); }));
+}
+
+AsyncRecordWriter::~AsyncRecordWriter() {
+  {
+    mutex_lock l(mu_);
+    stop_ = true;
+    work_cv_.notify_all();
+  }
+  // Joins the background thread, which writes out the ring first.
+  thread_.reset();
+}
+
+bool AsyncRecordWriter::TryPush(std::string* record) {
+  uint64 position = enqueue_position_.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = slots_[position & mask_];
+    const uint64 sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence == position) {
+      if (enqueue_position_.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed)) {
+        slot.record = std::move(*record);
+        // Sequentially consistent, so that it orders with writer_waiting_.
+        slot.sequence.store(position + 1);
+        return true;
+      }
+    } else if (sequence < position) {
+      // The slot still holds the record of the previous lap.
+      return false;
+    } else {
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool AsyncRecordWriter::TryPop(std::string* record) {
+  Slot& slot = slots_[dequeue_position_ & mask_];
+  if (slot.sequence.load() != dequeue_position_ + 1) return false;
+  *record = std::move(slot.record);
+  slot.record.clear();
+  slot.sequence.store(dequeue_position_ + mask_ + 1,
+                      std::memory_order_release);
+  ++dequeue_position_;
+  return true;
+}
+
+bool AsyncRecordWriter::Write(std::string record) {
+  if (TryPush(&record)) {
+    WakeUpWriter();
+    return true;
+  }
+  if (options_.full_policy == FullPolicy::kDrop) {
+    num_dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  num_producers_waiting_.fetch_add(1);
+  {
+    mutex_lock l(mu_);
+    while (!TryPush(&record)) {
+      work_cv_.notify_one();
+      done_cv_.wait_for(l, std::chrono::microseconds(kProducerWaitMicros));
+    }
+  }
+  num_producers_waiting_.fetch_sub(1);
+  WakeUpWriter();
+  return true;
+}
+
+void AsyncRecordWriter::WakeUpWriter() {
+  if (writer_waiting_.load()) {
+    mutex_lock l(mu_);
+    work_cv_.notify_one();
+  }
+}
+
+Status AsyncRecordWriter::Flush() {
+  mutex_lock l(mu_);
+  const int64_t request = ++flushes_requested_;
+  work_cv_.notify_one();
+  while (flushes_done_ < request) {
+    done_cv_.wait(l);
+  }
+  Status status = status_;
+  status_ = OkStatus();
+  return status;
+}
+
+int64_t AsyncRecordWriter::DrainRing(Status* status) {
+  int64_t num_written = 0;
+  std::string record;
+  while (TryPop(&record)) {
+    Status write_status = writer_->WriteRecord(record);
+    if (status->ok()) *status = write_status;
+    ++num_written;
+    // Lets producers that wait for room go on while a large batch is written.
+    if ((num_written & mask_) == 0 && num_producers_waiting_.load() > 0) {
+      mutex_lock l(mu_);
+      done_cv_.notify_all();
+    }
+  }
+  return num_written;
+}
+
+void AsyncRecordWriter::WriterLoop() {
+  uint64 last_flush_micros = env_->NowMicros();
+  bool unflushed = false;
+  for (;;) {
+    int64_t flushes_requested;
+    bool stop;
+    {
+      mutex_lock l(mu_);
+      flushes_requested = flushes_requested_;
+      stop = stop_;
+    }
+    // Records pushed before a flush was requested are in the ring by now.
+    Status status;
+    unflushed = DrainRing(&status) > 0 || unflushed;
+    const uint64 now_micros = env_->NowMicros();
+    bool flush_requested;
+    {
+      mutex_lock l(mu_);
+      flush_requested = flushes_requested > flushes_done_;
+    }
+    if (flush_requested || stop) {
+      Status flush_status = writer_->Flush();
+      if (flush_status.ok()) flush_status = file_->Sync();
+      status.Update(flush_status);
+      unflushed = false;
+      last_flush_micros = now_micros;
+    } else if (unflushed &&
+               now_micros - last_flush_micros >=
+                   static_cast<uint64>(options_.flush_interval_micros)) {
+      status.Update(writer_->Flush());
+      unflushed = false;
+      last_flush_micros = now_micros;
+    }
+
+    mutex_lock l(mu_);
+    if (!status.ok()) {
+      LOG(WARNING) << "Asynchronous record write failed: " << status;
+      status_.Update(status);
+    }
+    if (flushes_requested > flushes_done_) {
+      flushes_done_ = flushes_requested;
+    }
+    done_cv_.notify_all();
+    if (stop) return;
+    if (flushes_requested_ > flushes_done_ || stop_) continue;
+
+    writer_waiting_.store(true);
+    // A producer that pushed before seeing writer_waiting_ doesn't wake us.
+    if (slots_[dequeue_position_ & mask_].sequence.load() ==
+        dequeue_position_ + 1) {
+      writer_waiting_.store(false);
+      continue;
+    }
+    int64_t wait_micros = options_.flush_interval_micros;
+    if (unflushed) {
+      wait_micros -= std::min<int64_t>(wait_micros,
+                                       env_->NowMicros() - last_flush_micros);
+    }
+    work_cv_.wait_for(l, std::chrono::microseconds(std::max<int64_t>(
+                             wait_micros, kProducerWaitMicros)));
+    writer_waiting_.store(false);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
+#define TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Writes records to an io::RecordWriter from a background thread, so that
+// the threads producing them don't wait for file I/O.
+//
+// Producers push records into a bounded lock-free ring. The background thread
+// drains all the records in the ring at each wake-up, writes them out in one
+// batch, and flushes the writer at least every `flush_interval_micros` while
+// records are written. When the ring is full, Write() either waits for room
+// or drops the record, as configured.
+//
+// Write() and Flush() may be called from any number of threads.
+class AsyncRecordWriter {
+ public:
+  enum class FullPolicy {
+    // Write() waits until the background thread makes room in the ring.
+    kBlock,
+    // Write() drops the record and counts it in num_dropped().
+    kDrop,
+  };
+
+  struct Options {
+    // The number of records the ring holds, rounded up to a power of two
+    // (and to 2 at least).
+    // Writers that take these options write synchronously if it is 0.
+    int64_t capacity = 0;
+    FullPolicy full_policy = FullPolicy::kBlock;
+    // How often the background thread flushes the writer while records are
+    // written to it.
+    int64_t flush_interval_micros = 1000 * 1000;
+  };
+
+  // Writes to `writer`, which writes to `file`. Neither is owned, and both
+  // must outlive this object. `options.capacity` must be positive.
+  AsyncRecordWriter(Env* env, WritableFile* file, io::RecordWriter* writer,
+                    const Options& options);
+
+  // Writes out the records in the ring and flushes the writer.
+  ~AsyncRecordWriter();
+
+  // Queues `record` to be written. Returns false if it was dropped.
+  bool Write(std::string record);
+
+  // Waits until the records written so far are written out, then flushes the
+  // writer and syncs the file. Returns the first error of the background
+  // thread since the last call, if any.
+  Status Flush();
+
+  // The number of records dropped because the ring was full.
+  int64_t num_dropped() const { return num_dropped_.load(); }
+
+ private:
+  struct Slot {
+    // The position of the slot in the ring, offset by one once its record is
+    // published (after Vyukov's bounded queue).
+    std::atomic<uint64> sequence;
+    std::string record;
+  };
+
+  // Pushes `record` into the ring; returns false if the ring is full.
+  bool TryPush(std::string* record);
+  // Pops a record from the ring; returns false if the ring is empty. Only
+  // called by the background thread.
+  bool TryPop(std::string* record);
+
+  // Wakes up the background thread if it is waiting for records.
+  void WakeUpWriter() TF_LOCKS_EXCLUDED(mu_);
+
+  // The loop of the background thread.
+  void WriterLoop() TF_LOCKS_EXCLUDED(mu_);
+
+  // Writes out the records in the ring and returns how many there were.
+  // Updates `status` with the first write error.
+  int64_t DrainRing(Status* status);
+
+  Env* const env_;
+  WritableFile* const file_;        // not owned
+  io::RecordWriter* const writer_;  // not owned
+  const Options options_;
+
+  std::unique_ptr<Slot[]> slots_;
+  const uint64 mask_;
+  std::atomic<uint64> enqueue_position_{0};
+  uint64 dequeue_position_ = 0;  // Only used by the background thread.
+
+  std::atomic<bool> writer_waiting_{false};
+  std::atomic<int64_t> num_producers_waiting_{0};
+  std::atomic<int64_t> num_dropped_{0};
+
+  mutex mu_;
+  condition_variable work_cv_;
+  condition_variable done_cv_;
+  bool stop_ TF_GUARDED_BY(mu_) = false;
+  int64_t flushes_requested_ TF_GUARDED_BY(mu_) = 0;
+  int64_t flushes_done_ TF_GUARDED_BY(mu_) = 0;
+  Status status_ TF_GUARDED_BY(mu_);
+
+  // Declared last, so that it starts after the other members are initialized.
+  std::unique_ptr<Thread> thread_;
+
+  AsyncRecordWriter(const AsyncRecordWriter&) = delete;
+  void operator=(const AsyncRecordWriter&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_ASYNC_RECORD_WRITER_H_
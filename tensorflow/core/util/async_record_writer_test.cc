@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/async_record_writer.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace {
+
+std::vector<string> ReadRecords(const string& filename) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get());
+  std::vector<string> records;
+  uint64 offset = 0;
+  tstring record;
+  while (reader.ReadRecord(&offset, &record).ok()) {
+    records.emplace_back(record);
+  }
+  return records;
+}
+
+class AsyncRecordWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    filename_ = io::JoinPath(
+        testing::TmpDir(),
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    TF_ASSERT_OK(Env::Default()->NewWritableFile(filename_, &file_));
+    writer_ = std::make_unique<io::RecordWriter>(file_.get());
+  }
+
+  string filename_;
+  std::unique_ptr<WritableFile> file_;
+  std::unique_ptr<io::RecordWriter> writer_;
+};
+
+TEST_F(AsyncRecordWriterTest, WritesInOrder) {
+  AsyncRecordWriter::Options options;
+  options.capacity = 3;
+  AsyncRecordWriter async_writer(Env::Default(), file_.get(), writer_.get(),
+                                 options);
+  std::vector<string> expected;
+  for (int i = 0; i < 100; ++i) {
+    expected.push_back(strings::StrCat("record ", i));
+    EXPECT_TRUE(async_writer.Write(expected.back()));
+  }
+  TF_EXPECT_OK(async_writer.Flush());
+  EXPECT_EQ(ReadRecords(filename_), expected);
+
+  // Records written after a flush are written out by the next one.
+  EXPECT_TRUE(async_writer.Write("last"));
+  expected.push_back("last");
+  TF_EXPECT_OK(async_writer.Flush());
+  EXPECT_EQ(ReadRecords(filename_), expected);
+  EXPECT_EQ(async_writer.num_dropped(), 0);
+}
+
+TEST_F(AsyncRecordWriterTest, BlocksManyProducers) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumRecordsPerThread = 500;
+  AsyncRecordWriter::Options options;
+  options.capacity = 8;
+  {
+    AsyncRecordWriter async_writer(Env::Default(), file_.get(), writer_.get(),
+                                   options);
+    thread::ThreadPool pool(Env::Default(), "producers", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&async_writer, t]() {
+        for (int i = 0; i < kNumRecordsPerThread; ++i) {
+          EXPECT_TRUE(async_writer.Write(strings::StrCat(t, ":", i)));
+        }
+      });
+    }
+  }
+  const std::vector<string> records = ReadRecords(filename_);
+  EXPECT_EQ(records.size(), kNumThreads * kNumRecordsPerThread);
+  EXPECT_EQ(std::set<string>(records.begin(), records.end()).size(),
+            records.size());
+}
+
+TEST_F(AsyncRecordWriterTest, DropsWhenFull) {
+  constexpr int kNumRecords = 10000;
+  AsyncRecordWriter::Options options;
+  options.capacity = 1;
+  options.full_policy = AsyncRecordWriter::FullPolicy::kDrop;
+  AsyncRecordWriter async_writer(Env::Default(), file_.get(), writer_.get(),
+                                 options);
+  int num_written = 0;
+  for (int i = 0; i < kNumRecords; ++i) {
+    if (async_writer.Write(strings::StrCat(i))) ++num_written;
+  }
+  TF_EXPECT_OK(async_writer.Flush());
+  EXPECT_GT(num_written, 0);
+  EXPECT_EQ(num_written + async_writer.num_dropped(), kNumRecords);
+  EXPECT_EQ(ReadRecords(filename_).size(), num_written);
+}
+
+TEST_F(AsyncRecordWriterTest, FlushesPeriodically) {
+  AsyncRecordWriter::Options options;
+  options.capacity = 4;
+  options.flush_interval_micros = 1000;
+  AsyncRecordWriter async_writer(Env::Default(), file_.get(), writer_.get(),
+                                 options);
+  EXPECT_TRUE(async_writer.Write("record"));
+  // The record reaches the file without an explicit flush.
+  for (int i = 0; i < 1000 && ReadRecords(filename_).empty(); ++i) {
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+  }
+  EXPECT_EQ(ReadRecords(filename_), std::vector<string>({"record"}));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -38,11 +38,13 @@ void MaybeSetDebugEventTimestamp(DebugEvent* debug_event, Env* env) {
 }
 }  // namespace
 
-SingleDebugEventFileWriter::SingleDebugEventFileWriter(const string& file_path)
+SingleDebugEventFileWriter::SingleDebugEventFileWriter(
+    const string& file_path, const AsyncRecordWriter::Options& async_options)
     : env_(Env::Default()),
       file_path_(file_path),
       num_outstanding_events_(0),
-      writer_mu_() {}
+      writer_mu_(),
+      async_options_(async_options) {}
 
 Status SingleDebugEventFileWriter::Init() {
   if (record_writer_ != nullptr) {
@@ -63,6 +65,10 @@ Status SingleDebugEventFileWriter::Init() {
     return errors::Unknown("Could not create record writer at path: ",
                            file_path_);
   }
+  if (async_options_.capacity > 0) {
+    async_writer_ = std::make_unique<AsyncRecordWriter>(
+        env_, writable_file_.get(), record_writer_.get(), async_options_);
+  }
   num_outstanding_events_.store(0);
   VLOG(1) << "Successfully opened debug events file: " << file_path_;
   return OkStatus();
@@ -77,6 +83,10 @@ void SingleDebugEventFileWriter::WriteSerializedDebugEvent(
     }
   }
   num_outstanding_events_.fetch_add(1);
+  if (async_writer_ != nullptr) {
+    async_writer_->Write(string(debug_event_str));
+    return;
+  }
   {
     mutex_lock l(writer_mu_);
     record_writer_->WriteRecord(debug_event_str).IgnoreError();
@@ -92,6 +102,15 @@ Status SingleDebugEventFileWriter::Flush() {
     return errors::Unknown("Unexpected NULL file for path: ", file_path_);
   }
 
+  if (async_writer_ != nullptr) {
+    // The background thread flushes and syncs the file.
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(async_writer_->Flush(), "Failed to write ",
+                                    num_outstanding, " debug events to ",
+                                    file_path_);
+    num_outstanding_events_.fetch_sub(num_outstanding);
+    return OkStatus();
+  }
+
   {
     mutex_lock l(writer_mu_);
     TF_RETURN_WITH_CONTEXT_IF_ERROR(record_writer_->Flush(), "Failed to flush ",
@@ -108,6 +127,14 @@ Status SingleDebugEventFileWriter::Flush() {
 
 Status SingleDebugEventFileWriter::Close() {
   Status status = Flush();
+  if (async_writer_ != nullptr) {
+    if (async_writer_->num_dropped() > 0) {
+      LOG(WARNING) << "Dropped " << async_writer_->num_dropped()
+                   << " debug events written to " << file_path_
+                   << " while its queue was full.";
+    }
+    async_writer_.reset();
+  }
   if (writable_file_ != nullptr) {
     Status close_status = writable_file_->Close();
     if (!close_status.ok()) {
@@ -130,12 +157,21 @@ DebugEventsWriter::~DebugEventsWriter() { Close().IgnoreError(); }
 DebugEventsWriter* DebugEventsWriter::GetDebugEventsWriter(
     const string& dump_root, const string& tfdbg_run_id,
     int64_t circular_buffer_size) {
+  return GetDebugEventsWriter(dump_root, tfdbg_run_id, circular_buffer_size,
+                              AsyncRecordWriter::Options());
+}
+
+// static
+DebugEventsWriter* DebugEventsWriter::GetDebugEventsWriter(
+    const string& dump_root, const string& tfdbg_run_id,
+    int64_t circular_buffer_size,
+    const AsyncRecordWriter::Options& async_options) {
   mutex_lock l(DebugEventsWriter::factory_mu_);
   std::unordered_map<string, std::unique_ptr<DebugEventsWriter>>* writer_pool =
       DebugEventsWriter::GetDebugEventsWriterMap();
   if (writer_pool->find(dump_root) == writer_pool->end()) {
-    std::unique_ptr<DebugEventsWriter> writer(
-        new DebugEventsWriter(dump_root, tfdbg_run_id, circular_buffer_size));
+    std::unique_ptr<DebugEventsWriter> writer(new DebugEventsWriter(
+        dump_root, tfdbg_run_id, circular_buffer_size, async_options));
     writer_pool->insert(std::make_pair(dump_root, std::move(writer)));
   }
   return (*writer_pool)[dump_root].get();
@@ -479,15 +515,17 @@ DebugEventsWriter::GetDebugEventsWriterMap() {
   return writer_pool;
 }
 
-DebugEventsWriter::DebugEventsWriter(const string& dump_root,
-                                     const string& tfdbg_run_id,
-                                     int64_t circular_buffer_size)
+DebugEventsWriter::DebugEventsWriter(
+    const string& dump_root, const string& tfdbg_run_id,
+    int64_t circular_buffer_size,
+    const AsyncRecordWriter::Options& async_options)
     : env_(Env::Default()),
       dump_root_(dump_root),
       tfdbg_run_id_(tfdbg_run_id),
       is_initialized_(false),
       initialization_mu_(),
       circular_buffer_size_(circular_buffer_size),
+      async_options_(async_options),
       execution_buffer_(),
       execution_buffer_mu_(),
       graph_execution_trace_buffer_(),
@@ -501,7 +539,8 @@ Status DebugEventsWriter::InitNonMetadataFile(DebugEventFileType type) {
   const string filename = GetFileNameInternal(type);
   writer->reset();
 
-  *writer = std::make_unique<SingleDebugEventFileWriter>(filename);
+  *writer = std::make_unique<SingleDebugEventFileWriter>(filename,
+                                                         async_options_);
   if (*writer == nullptr) {
     return errors::Unknown("Could not create debug event file writer for ",
                            filename);
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/debug_event.pb.h"
+#include "tensorflow/core/util/async_record_writer.h"
 
 namespace tensorflow {
 namespace tfdbg {
@@ -49,7 +50,12 @@ enum DebugEventFileType {
 // TFRecord files, and hence utilizes multiple objects of this helper class.
 class SingleDebugEventFileWriter {
  public:
-  explicit SingleDebugEventFileWriter(const string& file_path);
+  // The events are written from a background thread if
+  // `async_options.capacity` is positive (see AsyncRecordWriter).
+  explicit SingleDebugEventFileWriter(
+      const string& file_path,
+      const AsyncRecordWriter::Options& async_options =
+          AsyncRecordWriter::Options());
 
   Status Init();
 
@@ -68,6 +74,10 @@ class SingleDebugEventFileWriter {
   std::unique_ptr<WritableFile> writable_file_;
   std::unique_ptr<io::RecordWriter> record_writer_ TF_PT_GUARDED_BY(writer_mu_);
   mutex writer_mu_;
+
+  const AsyncRecordWriter::Options async_options_;
+  // Writes to record_writer_ when the events are written asynchronously.
+  std::unique_ptr<AsyncRecordWriter> async_writer_;
 };
 
 // The DebugEvents writer class.
@@ -111,6 +121,14 @@ class DebugEventsWriter {
   static DebugEventsWriter* GetDebugEventsWriter(const string& dump_root,
                                                  const string& tfdbg_run_id,
                                                  int64_t circular_buffer_size);
+  // Same as above, but if `async_options.capacity` is positive, the events of
+  // the non-metadata files are written from background threads, so that the
+  // Write*() methods don't wait for file I/O (see AsyncRecordWriter). The
+  // options only apply when the writer of `dump_root` is created.
+  static DebugEventsWriter* GetDebugEventsWriter(
+      const string& dump_root, const string& tfdbg_run_id,
+      int64_t circular_buffer_size,
+      const AsyncRecordWriter::Options& async_options);
   // Look up existing events writer by dump_root.
   // If no DebugEventsWriter has been created at the dump_root, a non-OK
   // Status will be returned. Else an OK status will be returned, with
@@ -221,7 +239,8 @@ class DebugEventsWriter {
   static mutex factory_mu_;
 
   DebugEventsWriter(const string& dump_root, const string& tfdbg_run_id,
-                    int64_t circular_buffer_size);
+                    int64_t circular_buffer_size,
+                    const AsyncRecordWriter::Options& async_options);
 
   // Get the path prefix. The same for all files, which differ only in the
   // suffix.
@@ -247,6 +266,7 @@ class DebugEventsWriter {
   mutex initialization_mu_;
 
   const int64_t circular_buffer_size_;
+  const AsyncRecordWriter::Options async_options_;
   std::deque<string> execution_buffer_ TF_GUARDED_BY(execution_buffer_mu_);
   mutex execution_buffer_mu_;
   std::deque<string> graph_execution_trace_buffer_
@@ -38,6 +38,13 @@ EventsWriter::EventsWriter(const string& file_prefix)
       file_prefix_(file_prefix),
       num_outstanding_events_(0) {}
 
+EventsWriter::EventsWriter(const string& file_prefix,
+                           const AsyncRecordWriter::Options& async_options)
+    : env_(Env::Default()),
+      file_prefix_(file_prefix),
+      num_outstanding_events_(0),
+      async_options_(async_options) {}
+
 EventsWriter::~EventsWriter() {
   Close().IgnoreError();  // Autoclose in destructor.
 }
@@ -73,6 +80,7 @@ Status EventsWriter::InitIfNeeded() {
 
   // Reset recordio_writer (which has a reference to recordio_file_) so final
   // Flush() and Close() call have access to recordio_file_.
+  async_writer_.reset();
   recordio_writer_.reset();
 
   TF_RETURN_WITH_CONTEXT_IF_ERROR(
@@ -82,6 +90,10 @@ Status EventsWriter::InitIfNeeded() {
   if (recordio_writer_ == nullptr) {
     return errors::Unknown("Could not create record writer");
   }
+  if (async_options_.capacity > 0) {
+    async_writer_ = std::make_unique<AsyncRecordWriter>(
+        env_, recordio_file_.get(), recordio_writer_.get(), async_options_);
+  }
   num_outstanding_events_ = 0;
   VLOG(1) << "Successfully opened events file: " << filename_;
   {
@@ -114,6 +126,10 @@ void EventsWriter::WriteSerializedEvent(StringPiece event_str) {
     }
   }
   num_outstanding_events_++;
+  if (async_writer_ != nullptr) {
+    async_writer_->Write(string(event_str));
+    return;
+  }
   recordio_writer_->WriteRecord(event_str).IgnoreError();
 }
 
@@ -129,6 +145,16 @@ Status EventsWriter::Flush() {
   if (num_outstanding_events_ == 0) return OkStatus();
   CHECK(recordio_file_ != nullptr) << "Unexpected NULL file";
 
+  if (async_writer_ != nullptr) {
+    // The background thread flushes and syncs the file.
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(async_writer_->Flush(), "Failed to write ",
+                                    num_outstanding_events_, " events to ",
+                                    filename_);
+    VLOG(1) << "Wrote " << num_outstanding_events_ << " events to disk.";
+    num_outstanding_events_ = 0;
+    return OkStatus();
+  }
+
   TF_RETURN_WITH_CONTEXT_IF_ERROR(recordio_writer_->Flush(), "Failed to flush ",
                                   num_outstanding_events_, " events to ",
                                   filename_);
@@ -142,6 +168,14 @@ Status EventsWriter::Flush() {
 
 Status EventsWriter::Close() {
   Status status = Flush();
+  if (async_writer_ != nullptr) {
+    if (async_writer_->num_dropped() > 0) {
+      LOG(WARNING) << "Dropped " << async_writer_->num_dropped()
+                   << " events written to " << filename_
+                   << " while its queue was full.";
+    }
+    async_writer_.reset();
+  }
   if (recordio_file_ != nullptr) {
     Status close_status = recordio_file_->Close();
     if (!close_status.ok()) {
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/async_record_writer.h"
 #include "tensorflow/core/util/event.pb.h"
 
 namespace tensorflow {
@@ -47,6 +48,13 @@ class EventsWriter {
   // Note that it is not recommended to simultaneously have two
   // EventWriters writing to the same file_prefix.
   explicit EventsWriter(const std::string& file_prefix);
+#ifndef SWIG
+  // Writes the events from a background thread, if async_options.capacity is
+  // positive, so that WriteEvent() and WriteSerializedEvent() don't wait for
+  // file I/O. See AsyncRecordWriter.
+  EventsWriter(const std::string& file_prefix,
+               const AsyncRecordWriter::Options& async_options);
+#endif
   ~EventsWriter();
 
   // Sets the event file filename and opens file for writing.  If not called by
@@ -92,6 +100,11 @@ class EventsWriter {
   std::unique_ptr<WritableFile> recordio_file_;
   std::unique_ptr<io::RecordWriter> recordio_writer_;
   int num_outstanding_events_;
+#ifndef SWIG
+  const AsyncRecordWriter::Options async_options_;
+  // Writes to recordio_writer_ when the events are written asynchronously.
+  std::unique_ptr<AsyncRecordWriter> async_writer_;
+#endif
 #ifndef SWIG
   EventsWriter(const EventsWriter&) = delete;
   void operator=(const EventsWriter&) = delete;
@@ -193,6 +193,28 @@ TEST(EventWriter, NameClose) {
   TF_ASSERT_OK(env()->DeleteFile(filename));
 }
 
+TEST(EventWriter, AsyncWriteFlush) {
+  string file_prefix = GetDirName("/asyncwriteflush_test");
+  AsyncRecordWriter::Options async_options;
+  async_options.capacity = 4;
+  EventsWriter writer(file_prefix, async_options);
+  WriteFile(&writer);
+  TF_EXPECT_OK(writer.Flush());
+  string filename = writer.FileName();
+  VerifyFile(filename);
+}
+
+TEST(EventWriter, AsyncWriteDelete) {
+  string file_prefix = GetDirName("/asyncwritedelete_test");
+  AsyncRecordWriter::Options async_options;
+  async_options.capacity = 4;
+  EventsWriter* writer = new EventsWriter(file_prefix, async_options);
+  WriteFile(writer);
+  string filename = writer->FileName();
+  delete writer;
+  VerifyFile(filename);
+}
+
 TEST(EventWriter, FileDeletionBeforeWriting) {
   string file_prefix = GetDirName("/fdbw_test");
   EventsWriter writer(file_prefix);
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -170,6 +171,60 @@ class Feature {
     return true;
   }
 
+  // Sets `num_values` to the number of values in the list of type `dtype`,
+  // without parsing them.
+  bool CountValues(DataType dtype, size_t* num_values) {
+    *num_values = 0;
+    if (dtype == DT_STRING) {
+      int num_elements = 0;
+      if (!GetNumElementsInBytesList(&num_elements)) return false;
+      *num_values = num_elements;
+      return true;
+    }
+
+    protobuf::io::CodedInputStream stream(
+        reinterpret_cast<const uint8*>(serialized_.data()), serialized_.size());
+    EnableAliasing(&stream);
+    uint32 length;
+    if (!stream.ReadVarint32(&length)) return false;
+    auto limit = stream.PushLimit(length);
+    if (stream.ExpectAtEnd()) return true;
+
+    // Mirrors the sizes of the outputs of ParseFloatList and ParseInt64List.
+    constexpr int32_t kNumFloatBytes = 4;
+    const bool is_float = dtype == DT_FLOAT;
+    const uint8 peek_tag = PeekTag(&stream);
+    if (peek_tag == kDelimitedTag(1)) {                       // packed
+      if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
+      uint32 packed_length;
+      if (!stream.ReadVarint32(&packed_length)) return false;
+      if (is_float) {
+        *num_values = packed_length / kNumFloatBytes;
+        return true;
+      }
+      auto packed_limit = stream.PushLimit(packed_length);
+      while (!stream.ExpectAtEnd()) {
+        protobuf_uint64 n;
+        if (!stream.ReadVarint64(&n)) return false;
+        ++*num_values;
+      }
+      stream.PopLimit(packed_limit);
+    } else if (is_float && peek_tag == kFixed32Tag(1)) {  // non-packed
+      *num_values = stream.BytesUntilLimit() / (1 + kNumFloatBytes);
+    } else if (!is_float && peek_tag == kVarintTag(1)) {  // non-packed
+      while (!stream.ExpectAtEnd()) {
+        if (!stream.ExpectTag(kVarintTag(1))) return false;
+        protobuf_uint64 n;
+        if (!stream.ReadVarint64(&n)) return false;
+        ++*num_values;
+      }
+    } else {
+      return false;
+    }
+    stream.PopLimit(limit);
+    return true;
+  }
+
   // Helper methods
   tstring* construct_at_end(LimitedArraySlice<tstring>* bytes_list) {
     if (bytes_list->EndDistance() <= 0) {
@@ -558,6 +613,29 @@ struct SparseBuffer {
   std::vector<size_t> example_end_indices;
 };
 
+// The sparse and ragged features of a batch, when they are parsed in two
+// passes. The first pass records each feature of each example and counts its
+// values, so that the outputs can be allocated with their exact sizes, and the
+// second pass parses the values directly into them.
+struct SparseFeatureTable {
+  SparseFeatureTable(size_t num_examples, size_t num_features)
+      : num_features(num_features),
+        features(num_examples * num_features),
+        num_values(num_examples * num_features, 0),
+        value_offsets(num_examples * num_features, 0) {}
+
+  // Returns the position of feature i of example e in the vectors below. The
+  // ragged features are numbered after the sparse ones.
+  size_t Index(size_t e, size_t i) const { return e * num_features + i; }
+
+  const size_t num_features;
+  // The features, which are empty if they are missing from their example.
+  std::vector<parsed::Feature> features;
+  std::vector<size_t> num_values;
+  // The offsets of the values of the features in their output tensors.
+  std::vector<size_t> value_offsets;
+};
+
 struct SeededHasher {
   uint64 operator()(StringPiece s) const {
     return Hash64(s.data(), s.size(), seed);
@@ -595,7 +673,8 @@ Status FastParseSerializedExample(
     std::vector<SparseBuffer>* output_varlen_dense,
     std::vector<SparseBuffer>* output_sparse,
     std::vector<SparseBuffer>* output_ragged,
-    PerExampleFeatureStats* output_stats) {
+    PerExampleFeatureStats* output_stats,
+    SparseFeatureTable* sparse_feature_table = nullptr) {
   DCHECK(output_dense != nullptr);
   DCHECK(output_sparse != nullptr);
   DCHECK(output_ragged != nullptr);
@@ -820,7 +899,6 @@ Status FastParseSerializedExample(
       last_example[d] = example_index;
 
       // Handle sparse features.
-      SparseBuffer& out = is_ragged ? (*output_ragged)[d] : (*output_sparse)[d];
       DataType feature_dtype =
           is_ragged ? config.ragged[d].dtype : config.sparse[d].dtype;
       if (example_dtype != DT_INVALID && example_dtype != feature_dtype) {
@@ -830,6 +908,23 @@ Status FastParseSerializedExample(
                             ", Actual type: ", DataTypeString(example_dtype)));
       }
 
+      if (sparse_feature_table != nullptr) {
+        // Only count the values, which are parsed by the second pass.
+        size_t num_values = 0;
+        if (example_dtype != DT_INVALID &&
+            !feature.CountValues(feature_dtype, &num_values)) {
+          return parse_error();
+        }
+        const size_t index = sparse_feature_table->Index(
+            example_index, is_ragged ? config.sparse.size() + d : d);
+        sparse_feature_table->features[index] = feature;
+        sparse_feature_table->num_values[index] = num_values;
+        if (output_stats) output_stats->feature_values_count += num_values;
+        continue;
+      }
+
+      SparseBuffer& out = is_ragged ? (*output_ragged)[d] : (*output_sparse)[d];
+
       switch (feature_dtype) {
         case DT_INT64: {
           if (example_dtype != DT_INVALID) {
@@ -927,6 +1022,9 @@ Status FastParseSerializedExample(
     out.example_end_indices.push_back(prev_example_end_index);
   }
 
+  // Missing features have no values in a SparseFeatureTable.
+  if (sparse_feature_table != nullptr) return OkStatus();
+
   // Handle missing sparse features.
   for (size_t d = 0; d < config.sparse.size(); ++d) {
     if (sparse_feature_last_example[d] == example_index) continue;
@@ -1129,6 +1227,136 @@ void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
   }
 }
 
+// Parses the `num_values` values of `feature` into `values`, from `offset` on.
+bool ParseValuesInPlace(parsed::Feature* feature, size_t offset,
+                        size_t num_values, Tensor* values) {
+  switch (values->dtype()) {
+    case DT_INT64: {
+      LimitedArraySlice<int64_t> slice(values->flat<int64_t>().data() + offset,
+                                       num_values);
+      return feature->ParseInt64List(&slice) && slice.EndDistance() == 0;
+    }
+    case DT_FLOAT: {
+      LimitedArraySlice<float> slice(values->flat<float>().data() + offset,
+                                     num_values);
+      return feature->ParseFloatList(&slice) && slice.EndDistance() == 0;
+    }
+    case DT_STRING: {
+      LimitedArraySlice<tstring> slice(values->flat<tstring>().data() + offset,
+                                       num_values);
+      return feature->ParseBytesList(&slice) && slice.EndDistance() == 0;
+    }
+    default:
+      ReportUnexpectedDataType(values->dtype());
+  }
+  return false;
+}
+
+// The second pass of the two-pass parsing of sparse and ragged features:
+// allocates their outputs from the counts in `table`, then parses the values of
+// every minibatch directly into them.
+Status ParseSparseFeaturesInPlace(
+    const Config& config, gtl::ArraySlice<tstring> example_names,
+    size_t num_examples, size_t num_minibatches,
+    const std::function<size_t(size_t)>& first_example_of_minibatch,
+    thread::ThreadPool* thread_pool, SparseFeatureTable* table,
+    Result* result) {
+  const size_t num_sparse = config.sparse.size();
+  result->sparse_indices.resize(num_sparse);
+  result->sparse_values.resize(num_sparse);
+  result->sparse_shapes.resize(num_sparse);
+  result->ragged_values.resize(config.ragged.size());
+  result->ragged_splits.resize(config.ragged.size());
+
+  auto AllocateOutputs = [&](size_t i) {
+    const bool is_ragged = i >= num_sparse;
+    const size_t d = is_ragged ? i - num_sparse : i;
+    size_t total_num_values = 0;
+    size_t max_num_values = 0;
+    for (size_t e = 0; e < num_examples; ++e) {
+      const size_t index = table->Index(e, i);
+      table->value_offsets[index] = total_num_values;
+      total_num_values += table->num_values[index];
+      max_num_values = std::max(max_num_values, table->num_values[index]);
+    }
+    const int64_t total = total_num_values;
+
+    if (!is_ragged) {
+      result->sparse_indices[d] = Tensor(DT_INT64, TensorShape({total, 2}));
+      result->sparse_values[d] =
+          Tensor(config.sparse[d].dtype, TensorShape({total}));
+      result->sparse_shapes[d] = Tensor(DT_INT64, TensorShape({2}));
+      auto shape = result->sparse_shapes[d].vec<int64_t>();
+      shape(0) = num_examples;
+      shape(1) = max_num_values;
+      return;
+    }
+
+    result->ragged_values[d] =
+        Tensor(config.ragged[d].dtype, TensorShape({total}));
+    // The row splits are the offsets of the examples.
+    Tensor& row_splits = result->ragged_splits[d];
+    row_splits = Tensor(config.ragged[d].splits_dtype,
+                        TensorShape({static_cast<int64_t>(num_examples + 1)}));
+    if (config.ragged[d].splits_dtype == DT_INT64) {
+      auto splits = row_splits.vec<int64_t>();
+      for (size_t e = 0; e < num_examples; ++e) {
+        splits(e) = table->value_offsets[table->Index(e, i)];
+      }
+      splits(num_examples) = total;
+    } else {
+      auto splits = row_splits.vec<int32>();
+      for (size_t e = 0; e < num_examples; ++e) {
+        splits(e) = table->value_offsets[table->Index(e, i)];
+      }
+      splits(num_examples) = total;
+    }
+  };
+  ParallelFor(AllocateOutputs, table->num_features, thread_pool);
+
+  std::vector<Status> status_of_minibatch(num_minibatches);
+  auto ParseMiniBatch = [&](size_t minibatch) {
+    const size_t start = first_example_of_minibatch(minibatch);
+    const size_t end = first_example_of_minibatch(minibatch + 1);
+    for (size_t e = start; e < end; ++e) {
+      for (size_t i = 0; i < table->num_features; ++i) {
+        const size_t index = table->Index(e, i);
+        const size_t num_values = table->num_values[index];
+        if (num_values == 0) continue;
+        const bool is_ragged = i >= num_sparse;
+        const size_t d = is_ragged ? i - num_sparse : i;
+        const size_t offset = table->value_offsets[index];
+        Tensor* values = is_ragged ? &result->ragged_values[d]
+                                   : &result->sparse_values[d];
+        if (!ParseValuesInPlace(&table->features[index], offset, num_values,
+                                values)) {
+          status_of_minibatch[minibatch] = errors::InvalidArgument(
+              "Name: ",
+              (!example_names.empty() ? example_names[e] : "<unknown>"),
+              ", Key: ",
+              is_ragged ? config.ragged[d].feature_name
+                        : config.sparse[d].feature_name,
+              ", Index: ", e, ".  Can't parse serialized Example.");
+          return;
+        }
+        if (!is_ragged) {
+          auto indices = result->sparse_indices[d].matrix<int64_t>();
+          for (size_t j = 0; j < num_values; ++j) {
+            indices(offset + j, 0) = e;
+            indices(offset + j, 1) = j;
+          }
+        }
+      }
+    }
+  };
+  ParallelFor(ParseMiniBatch, num_minibatches, thread_pool);
+
+  for (Status& status : status_of_minibatch) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 Status FastParseExample(const Config& config,
@@ -1228,11 +1456,18 @@ Status FastParseExample(const Config& config,
   std::vector<std::vector<SparseBuffer>> sparse_buffers(num_minibatches);
   std::vector<std::vector<SparseBuffer>> varlen_dense_buffers(num_minibatches);
   std::vector<std::vector<SparseBuffer>> ragged_buffers(num_minibatches);
+  std::unique_ptr<SparseFeatureTable> sparse_feature_table;
+  if (config.parse_sparse_in_two_passes) {
+    sparse_feature_table = std::make_unique<SparseFeatureTable>(
+        serialized.size(), config.sparse.size() + config.ragged.size());
+  }
   std::vector<Status> status_of_minibatch(num_minibatches);
   auto ProcessMiniBatch = [&](size_t minibatch) {
-    sparse_buffers[minibatch].resize(config.sparse.size());
+    if (sparse_feature_table == nullptr) {
+      sparse_buffers[minibatch].resize(config.sparse.size());
+      ragged_buffers[minibatch].resize(config.ragged.size());
+    }
     varlen_dense_buffers[minibatch].resize(config.dense.size());
-    ragged_buffers[minibatch].resize(config.ragged.size());
     size_t start = first_example_of_minibatch(minibatch);
     size_t end = first_example_of_minibatch(minibatch + 1);
     for (size_t e = start; e < end; ++e) {
@@ -1245,7 +1480,7 @@ Status FastParseExample(const Config& config,
           (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
           config_index, hasher, &fixed_dense_values,
           &varlen_dense_buffers[minibatch], &sparse_buffers[minibatch],
-          &ragged_buffers[minibatch], stats);
+          &ragged_buffers[minibatch], stats, sparse_feature_table.get());
       if (!status_of_minibatch[minibatch].ok()) break;
     }
   };
@@ -1434,6 +1669,13 @@ Status FastParseExample(const Config& config,
     MergeDenseVarLenMinibatches(d);
   }
 
+  if (sparse_feature_table != nullptr) {
+    return ParseSparseFeaturesInPlace(
+        config, example_names, serialized.size(), num_minibatches,
+        first_example_of_minibatch, thread_pool, sparse_feature_table.get(),
+        result);
+  }
+
   for (size_t d = 0; d < config.sparse.size(); ++d) {
     MergeSparseMinibatches(d);
   }
@@ -96,6 +96,12 @@ struct FastParseExampleConfig {
   // If `true`, `Result::feature_stats` will contain one
   // `PerExampleFeatureStats` for each serialized example in the input.
   bool collect_feature_stats = false;
+
+  // If `true`, the values of sparse and ragged features are parsed in two
+  // passes. The first one only counts them, so that the second one can parse
+  // them directly into output tensors of the exact size, instead of buffering
+  // them per minibatch and copying the buffers into the outputs.
+  bool parse_sparse_in_two_passes = false;
 };
 
 // Statistics about the features in each example passed to
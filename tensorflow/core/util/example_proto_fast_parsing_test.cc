@@ -19,10 +19,15 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -327,6 +332,109 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+// Returns examples in which example i has i % 4 values of each feature, and
+// does not have `sparse_float` when i is odd.
+std::vector<tstring> ExamplesWithSparseFeatures(int num_examples) {
+  std::vector<tstring> serialized;
+  for (int i = 0; i < num_examples; ++i) {
+    Example example;
+    auto& features = *example.mutable_features()->mutable_feature();
+    for (int j = 0; j < i % 4; ++j) {
+      features[kSparseInt64Key].mutable_int64_list()->add_value(i * j);
+      if (i % 2 == 0) {
+        features[kSparseFloatKey].mutable_float_list()->add_value(i + j);
+      }
+      features[kSparseStringKey].mutable_bytes_list()->add_value(
+          strings::StrCat("value_", i, "_", j));
+      features["ragged_int64"].mutable_int64_list()->add_value(j);
+      features["varlen_int64"].mutable_int64_list()->add_value(-j);
+    }
+    serialized.push_back(example.SerializeAsString());
+  }
+  return serialized;
+}
+
+FastParseExampleConfig ConfigWithSparseFeatures() {
+  FastParseExampleConfig config;
+  AddSparseFeature(kSparseInt64Key, DT_INT64, &config);
+  AddSparseFeature(kSparseFloatKey, DT_FLOAT, &config);
+  AddSparseFeature(kSparseStringKey, DT_STRING, &config);
+  config.ragged.push_back({"ragged_int64", DT_INT64, DT_INT32});
+  AddDenseFeature("varlen_int64", DT_INT64, {-1}, true, 1, &config);
+  return config;
+}
+
+TEST(FastParse, SparseFeaturesInTwoPasses) {
+  const std::vector<tstring> serialized = ExamplesWithSparseFeatures(1000);
+  FastParseExampleConfig config = ConfigWithSparseFeatures();
+  config.collect_feature_stats = true;
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  Result expected;
+  TF_ASSERT_OK(
+      FastParseExample(config, serialized, {}, &thread_pool, &expected));
+
+  config.parse_sparse_in_two_passes = true;
+  const std::vector<thread::ThreadPool*> pools = {&thread_pool, nullptr};
+  for (thread::ThreadPool* pool : pools) {
+    Result result;
+    TF_ASSERT_OK(FastParseExample(config, serialized, {}, pool, &result));
+    ASSERT_EQ(result.sparse_values.size(), 3);
+    for (int d = 0; d < 3; ++d) {
+      test::ExpectTensorEqual<int64_t>(expected.sparse_indices[d],
+                                       result.sparse_indices[d]);
+      test::ExpectTensorEqual<int64_t>(expected.sparse_shapes[d],
+                                       result.sparse_shapes[d]);
+    }
+    test::ExpectTensorEqual<int64_t>(expected.sparse_values[0],
+                                     result.sparse_values[0]);
+    test::ExpectTensorEqual<float>(expected.sparse_values[1],
+                                   result.sparse_values[1]);
+    test::ExpectTensorEqual<tstring>(expected.sparse_values[2],
+                                     result.sparse_values[2]);
+    ASSERT_EQ(result.ragged_values.size(), 1);
+    test::ExpectTensorEqual<int64_t>(expected.ragged_values[0],
+                                     result.ragged_values[0]);
+    test::ExpectTensorEqual<int32>(expected.ragged_splits[0],
+                                   result.ragged_splits[0]);
+    test::ExpectTensorEqual<int64_t>(expected.dense_values[0],
+                                     result.dense_values[0]);
+    ASSERT_EQ(result.feature_stats.size(), serialized.size());
+    for (int i = 0; i < serialized.size(); ++i) {
+      EXPECT_EQ(result.feature_stats[i].feature_values_count,
+                expected.feature_stats[i].feature_values_count);
+    }
+  }
+}
+
+TEST(FastParse, SparseFeaturesInTwoPassesWithWrongType) {
+  Example example;
+  (*example.mutable_features()->mutable_feature())[kSparseInt64Key]
+      .mutable_float_list()
+      ->add_value(1);
+  FastParseExampleConfig config = ConfigWithSparseFeatures();
+  config.parse_sparse_in_two_passes = true;
+  Result result;
+  const std::vector<tstring> serialized = {example.SerializeAsString()};
+  Status status = FastParseExample(config, serialized, {}, nullptr, &result);
+  EXPECT_TRUE(absl::StrContains(status.message(), "Data types don't match"))
+      << status;
+}
+
+void BM_FastParseSparseFeatures(::testing::benchmark::State& state) {
+  const bool two_passes = state.range(0);
+  const std::vector<tstring> serialized = ExamplesWithSparseFeatures(4096);
+  FastParseExampleConfig config = ConfigWithSparseFeatures();
+  config.parse_sparse_in_two_passes = two_passes;
+  thread::ThreadPool thread_pool(Env::Default(), "bench", 8);
+  for (auto s : state) {
+    Result result;
+    TF_CHECK_OK(
+        FastParseExample(config, serialized, {}, &thread_pool, &result));
+  }
+  state.SetItemsProcessed(state.iterations() * serialized.size());
+}
+BENCHMARK(BM_FastParseSparseFeatures)->Arg(0)->Arg(1);
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
@@ -15,13 +15,19 @@ limitations under the License.
 #include "tensorflow/core/util/memmapped_file_system.h"
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "zlib.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/memmapped_file_system.pb.h"
 
 namespace tensorflow {
@@ -36,14 +42,28 @@ uint64 DecodeUint64LittleEndian(const uint8* buffer) {
   return result;
 }
 
+constexpr int64_t kDefaultBlockCacheBytes = 4 << 20;
+
+uint64 BlockCacheBytesFromEnv() {
+  int64_t bytes;
+  const Status status = ReadInt64FromEnvVar(
+      "TF_MEMMAPPED_BLOCK_CACHE_BYTES", kDefaultBlockCacheBytes, &bytes);
+  if (!status.ok()) {
+    LOG(WARNING) << status;
+  }
+  return std::max<int64_t>(bytes, 0);
+}
+
 }  // namespace
 
 namespace {
 
 class ReadOnlyMemoryRegionFromMemmapped : public ReadOnlyMemoryRegion {
  public:
-  ReadOnlyMemoryRegionFromMemmapped(const void* data, uint64 length)
-      : data_(data), length_(length) {}
+  // `owner`, if set, keeps `data` alive.
+  ReadOnlyMemoryRegionFromMemmapped(const void* data, uint64 length,
+                                    std::shared_ptr<const void> owner = nullptr)
+      : data_(data), length_(length), owner_(std::move(owner)) {}
   ~ReadOnlyMemoryRegionFromMemmapped() override = default;
   const void* data() override { return data_; }
   uint64 length() override { return length_; }
@@ -51,6 +71,7 @@ class ReadOnlyMemoryRegionFromMemmapped : public ReadOnlyMemoryRegion {
  private:
   const void* const data_;
   const uint64 length_;
+  const std::shared_ptr<const void> owner_;
   // intentionally copyable
 };
 
@@ -89,7 +110,80 @@ class RandomAccessFileFromMemmapped : public RandomAccessFile {
 
 }  // namespace
 
-MemmappedFileSystem::MemmappedFileSystem() = default;
+// The decompressed contents of a compressed region, aligned to be used by
+// ImmutableConst operator.
+class MemmappedFileSystem::DecompressedRegion {
+ public:
+  explicit DecompressedRegion(uint64 length)
+      : data_(port::AlignedMalloc(std::max<uint64>(length, 1),
+                                  Allocator::kAllocatorAlignment)),
+        length_(length) {}
+  ~DecompressedRegion() { port::AlignedFree(data_); }
+
+  char* data() const { return static_cast<char*>(data_); }
+  uint64 length() const { return length_; }
+
+ private:
+  void* const data_;
+  const uint64 length_;
+
+  DecompressedRegion(const DecompressedRegion&) = delete;
+  void operator=(const DecompressedRegion&) = delete;
+};
+
+class MemmappedFileSystem::CompressedRandomAccessFile
+    : public RandomAccessFile {
+ public:
+  CompressedRandomAccessFile(MemmappedFileSystem* file_system,
+                             const FileRegion* region)
+      : file_system_(file_system), region_(region) {}
+
+  ~CompressedRandomAccessFile() override = default;
+
+  Status Name(StringPiece* result) const override {
+    return errors::Unimplemented(
+        "CompressedRandomAccessFile does not support Name()");
+  }
+
+  Status Read(uint64 offset, size_t to_read, StringPiece* result,
+              char* scratch) const override {
+    *result = StringPiece(scratch, 0);
+    if (offset >= region_->length) {
+      return Status(absl::StatusCode::kOutOfRange, "Read after file end");
+    }
+    const uint64 region_left =
+        std::min(region_->length - offset, static_cast<uint64>(to_read));
+    const uint64 block_size = region_->block_size;
+    const uint64 end = offset + region_left;
+    for (uint64 pos = offset; pos < end;) {
+      const uint64 index = pos / block_size;
+      const uint64 begin = pos - index * block_size;
+      const uint64 n = std::min(block_size - begin, end - pos);
+      if (n == block_size) {
+        // Whole blocks are decompressed straight into the output, so that
+        // large reads don't churn the cache.
+        TF_RETURN_IF_ERROR(file_system_->DecompressBlock(
+            *region_, index, scratch + pos - offset));
+      } else {
+        std::shared_ptr<const string> block;
+        TF_RETURN_IF_ERROR(file_system_->GetBlock(*region_, index, &block));
+        memcpy(scratch + pos - offset, block->data() + begin, n);
+      }
+      pos += n;
+    }
+    *result = StringPiece(scratch, region_left);
+    return (region_left == to_read) ? OkStatus()
+                                    : Status(absl::StatusCode::kOutOfRange,
+                                             "Read less bytes than requested");
+  }
+
+ private:
+  MemmappedFileSystem* const file_system_;  // not owned
+  const FileRegion* const region_;
+};
+
+MemmappedFileSystem::MemmappedFileSystem()
+    : block_cache_bytes_(BlockCacheBytesFromEnv()) {}
 
 Status MemmappedFileSystem::FileExists(const string& fname,
                                        TransactionToken* token) {
@@ -113,6 +207,11 @@ Status MemmappedFileSystem::NewRandomAccessFile(
   if (dir_element == directory_.end()) {
     return errors::NotFound("Region ", filename, " is not found");
   }
+  if (dir_element->second.compressed()) {
+    *result = std::make_unique<CompressedRandomAccessFile>(
+        this, &dir_element->second);
+    return OkStatus();
+  }
   *result = std::make_unique<RandomAccessFileFromMemmapped>(
       GetMemoryWithOffset(dir_element->second.offset),
       dir_element->second.length);
@@ -129,6 +228,16 @@ Status MemmappedFileSystem::NewReadOnlyMemoryRegionFromFile(
   if (dir_element == directory_.end()) {
     return errors::NotFound("Region ", filename, " is not found");
   }
+  if (dir_element->second.compressed()) {
+    std::shared_ptr<DecompressedRegion> region;
+    TF_RETURN_IF_ERROR(
+        GetDecompressedRegion(filename, dir_element->second, &region));
+    const void* data = region->data();
+    const uint64 length = region->length();
+    *result = std::make_unique<ReadOnlyMemoryRegionFromMemmapped>(
+        data, length, std::move(region));
+    return OkStatus();
+  }
   *result = std::make_unique<ReadOnlyMemoryRegionFromMemmapped>(
       GetMemoryWithOffset(dir_element->second.offset),
       dir_element->second.length);
@@ -208,6 +317,92 @@ const void* MemmappedFileSystem::GetMemoryWithOffset(uint64 offset) const {
   return reinterpret_cast<const uint8*>(mapped_memory_->data()) + offset;
 }
 
+Status MemmappedFileSystem::DecompressBlock(const FileRegion& region,
+                                            uint64 index, char* output) const {
+  const uint64 begin = index == 0 ? 0 : region.block_ends[index - 1];
+  const uint64 end = region.block_ends[index];
+  const uint64 expected_length =
+      std::min(region.block_size, region.length - index * region.block_size);
+  uLongf output_length = expected_length;
+  const int result = uncompress(
+      reinterpret_cast<Bytef*>(output), &output_length,
+      static_cast<const Bytef*>(GetMemoryWithOffset(region.offset + begin)),
+      end - begin);
+  if (result != Z_OK || output_length != expected_length) {
+    return errors::DataLoss("Corrupted memmapped model file: block ", index,
+                            " of a compressed region can't be decompressed,"
+                            " zlib error ",
+                            result);
+  }
+  return OkStatus();
+}
+
+Status MemmappedFileSystem::GetBlock(const FileRegion& region, uint64 index,
+                                     std::shared_ptr<const string>* block) {
+  const BlockKey key(&region, index);
+  {
+    mutex_lock lock(mu_);
+    const auto it = block_cache_.find(key);
+    if (it != block_cache_.end()) {
+      block_lru_.splice(block_lru_.begin(), block_lru_, it->second);
+      *block = it->second->second;
+      return OkStatus();
+    }
+  }
+  auto data = std::make_shared<string>();
+  data->resize(
+      std::min(region.block_size, region.length - index * region.block_size));
+  TF_RETURN_IF_ERROR(DecompressBlock(region, index, &(*data)[0]));
+  *block = data;
+
+  mutex_lock lock(mu_);
+  if (data->size() > block_cache_bytes_ || block_cache_.count(key) > 0) {
+    return OkStatus();
+  }
+  block_lru_.emplace_front(key, std::move(data));
+  block_cache_[key] = block_lru_.begin();
+  block_cache_size_ += block_lru_.front().second->size();
+  while (block_cache_size_ > block_cache_bytes_) {
+    const auto& oldest = block_lru_.back();
+    block_cache_size_ -= oldest.second->size();
+    block_cache_.erase(oldest.first);
+    block_lru_.pop_back();
+  }
+  return OkStatus();
+}
+
+Status MemmappedFileSystem::GetDecompressedRegion(
+    const string& name, const FileRegion& region,
+    std::shared_ptr<DecompressedRegion>* result) {
+  {
+    mutex_lock lock(mu_);
+    const auto it = decompressed_regions_.find(name);
+    if (it != decompressed_regions_.end()) {
+      *result = it->second.lock();
+      if (*result) return OkStatus();
+    }
+  }
+  auto decompressed = std::make_shared<DecompressedRegion>(region.length);
+  if (decompressed->data() == nullptr) {
+    return errors::ResourceExhausted("Failed to allocate ", region.length,
+                                     " bytes to decompress region ", name);
+  }
+  for (uint64 i = 0; i < region.block_ends.size(); ++i) {
+    TF_RETURN_IF_ERROR(DecompressBlock(
+        region, i, decompressed->data() + i * region.block_size));
+  }
+
+  mutex_lock lock(mu_);
+  std::weak_ptr<DecompressedRegion>& shared = decompressed_regions_[name];
+  // Another thread may have decompressed the region meanwhile.
+  *result = shared.lock();
+  if (!*result) {
+    shared = decompressed;
+    *result = std::move(decompressed);
+  }
+  return OkStatus();
+}
+
 constexpr const char MemmappedFileSystem::kMemmappedPackagePrefix[];
 constexpr const char MemmappedFileSystem::kMemmappedPackageDefaultGraphDef[];
 
@@ -215,6 +410,13 @@ Status MemmappedFileSystem::InitializeFromFile(Env* env,
                                                const string& filename) {
   TF_RETURN_IF_ERROR(
       env->NewReadOnlyMemoryRegionFromFile(filename, &mapped_memory_));
+  {
+    mutex_lock lock(mu_);
+    block_lru_.clear();
+    block_cache_.clear();
+    block_cache_size_ = 0;
+    decompressed_regions_.clear();
+  }
   directory_.clear();
   if (mapped_memory_->length() <= sizeof(uint64)) {
     return errors::DataLoss("Corrupted memmapped model file: ", filename,
@@ -245,10 +447,27 @@ Status MemmappedFileSystem::InitializeFromFile(Env* env,
       return errors::DataLoss("Corrupted memmapped model file: ", filename,
                               " Invalid offset of internal component");
     }
-    if (!directory_
-             .insert(std::make_pair(
-                 element_iter->name(),
-                 FileRegion(element_iter->offset(), element_iter->length())))
+    FileRegion region(element_iter->offset(), element_iter->length());
+    if (element_iter->compressed_block_size() > 0) {
+      region.block_size = element_iter->compressed_block_size();
+      region.block_ends.assign(element_iter->compressed_block_end().begin(),
+                               element_iter->compressed_block_end().end());
+      const uint64 num_blocks =
+          (region.length + region.block_size - 1) / region.block_size;
+      bool blocks_valid = region.block_ends.size() == num_blocks;
+      uint64 prev_block_end = 0;
+      for (const uint64 block_end : region.block_ends) {
+        blocks_valid = blocks_valid && block_end > prev_block_end;
+        prev_block_end = block_end;
+      }
+      if (!blocks_valid ||
+          prev_block_end > prev_element_offset - region.offset) {
+        return errors::DataLoss("Corrupted memmapped model file: ", filename,
+                                " Invalid blocks of compressed component ",
+                                element_iter->name());
+      }
+    }
+    if (!directory_.insert(std::make_pair(element_iter->name(), region))
              .second) {
       return errors::DataLoss("Corrupted memmapped model file: ", filename,
                               " Duplicate name of internal component ",
@@ -16,12 +16,17 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_MEMMAPPED_FILE_SYSTEM_H_
 #define TENSORFLOW_CORE_UTIL_MEMMAPPED_FILE_SYSTEM_H_
 
+#include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -40,6 +45,13 @@ namespace tensorflow {
 // - at the offsets in the directory the file regions are stored. Tensor regions
 // are aligned such way that when the package mapped to RAM they have the right
 // offset to be used by ImmutableConst operator.
+// - a region may instead be stored as independently zlib-compressed blocks
+// (see MemmappedFileSystemWriter::SaveCompressedTensor). Random access reads
+// of such a region decompress only the blocks they touch, through a small
+// cache of decompressed blocks of TF_MEMMAPPED_BLOCK_CACHE_BYTES bytes
+// (default 4 MiB), and a memory region of it is decompressed once into an
+// aligned buffer that is shared while it is in use. Uncompressed regions are
+// still read in place.
 //
 // Region naming:
 // Region naming is up to the application, all of them starts from
@@ -104,20 +116,59 @@ class MemmappedFileSystem : public FileSystem {
   static bool IsWellFormedMemmappedPackageFilename(const string& filename);
 
  private:
+  class CompressedRandomAccessFile;
+  class DecompressedRegion;
+
   struct FileRegion {
     FileRegion(uint64 o, uint64 l) : offset(o), length(l) {}
 
     uint64 offset;  // Offset from the beginning of the file.
-    uint64 length;  // Length of the region.
+    uint64 length;  // Length of the region, uncompressed.
+    // For compressed regions, the uncompressed size of the blocks and the end
+    // of each compressed block relative to `offset`.
+    uint64 block_size = 0;
+    std::vector<uint64> block_ends;
+
+    bool compressed() const { return block_size > 0; }
   };
 
   using DirectoryType = std::unordered_map<string, FileRegion>;
 
   const void* GetMemoryWithOffset(uint64 offset) const;
 
+  // Decompresses block `index` of `region` into `output`, which must hold the
+  // uncompressed size of the block.
+  Status DecompressBlock(const FileRegion& region, uint64 index,
+                         char* output) const;
+
+  // Returns block `index` of `region`, decompressed, from the block cache.
+  Status GetBlock(const FileRegion& region, uint64 index,
+                  std::shared_ptr<const string>* block) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the decompressed contents of the compressed region `name`.
+  Status GetDecompressedRegion(const string& name, const FileRegion& region,
+                               std::shared_ptr<DecompressedRegion>* result)
+      TF_LOCKS_EXCLUDED(mu_);
+
   std::unique_ptr<ReadOnlyMemoryRegion> mapped_memory_;
   DirectoryType directory_;
 
+  using BlockKey = std::pair<const FileRegion*, uint64>;
+  using BlockList =
+      std::list<std::pair<BlockKey, std::shared_ptr<const string>>>;
+
+  // The maximum total size of the decompressed blocks in the cache.
+  const uint64 block_cache_bytes_;
+
+  mutex mu_;
+  // Decompressed blocks, most recently used first.
+  BlockList block_lru_ TF_GUARDED_BY(mu_);
+  std::map<BlockKey, BlockList::iterator> block_cache_ TF_GUARDED_BY(mu_);
+  uint64 block_cache_size_ TF_GUARDED_BY(mu_) = 0;
+  // Decompressed regions, while memory regions of them are alive.
+  std::unordered_map<string, std::weak_ptr<DecompressedRegion>>
+      decompressed_regions_ TF_GUARDED_BY(mu_);
+
   MemmappedFileSystem(const MemmappedFileSystem&) = delete;
   void operator=(const MemmappedFileSystem&) = delete;
 };
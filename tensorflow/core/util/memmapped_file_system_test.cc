@@ -116,6 +116,77 @@ TEST(MemmappedFileSystemTest, SimpleTest) {
             memmapped_env.FileExists("bla-bla-bla").code());
 }
 
+TEST(MemmappedFileSystemTest, CompressedTensor) {
+  // 1000 bytes don't divide the tensor, so the last block is shorter.
+  constexpr uint64 kBlockSize = 1000;
+  Tensor test_tensor(DT_FLOAT, TensorShape({10, 200}));
+  test::FillFn<float>(&test_tensor,
+                      [](int i) { return static_cast<float>(i % 7); });
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "memmapped_env_compressed_test");
+  {
+    MemmappedFileSystemWriter writer;
+    TF_ASSERT_OK(writer.InitializeToFile(Env::Default(), filename));
+    TF_ASSERT_OK(writer.SaveTensor(test_tensor, kTensor1FileName));
+    TF_ASSERT_OK(
+        writer.SaveCompressedTensor(test_tensor, kTensor2FileName, kBlockSize));
+    TF_ASSERT_OK(writer.FlushAndClose());
+  }
+  uint64 package_size = 0;
+  TF_ASSERT_OK(Env::Default()->GetFileSize(filename, &package_size));
+  EXPECT_LT(package_size, 2 * test_tensor.TotalBytes());
+
+  MemmappedEnv memmapped_env(Env::Default());
+  TF_ASSERT_OK(memmapped_env.InitializeFromFile(filename));
+  uint64 file_size = 0;
+  TF_ASSERT_OK(memmapped_env.GetFileSize(kTensor2FileName, &file_size));
+  EXPECT_EQ(test_tensor.TotalBytes(), file_size);
+
+  // Memory regions of the compressed tensor are aligned, and share their
+  // decompressed contents.
+  std::unique_ptr<ReadOnlyMemoryRegion> memory_region;
+  TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(kTensor2FileName,
+                                                             &memory_region));
+  ASSERT_EQ(test_tensor.TotalBytes(), memory_region->length());
+  EXPECT_EQ(test_tensor.tensor_data(),
+            StringPiece(static_cast<const char*>(memory_region->data()),
+                        memory_region->length()));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(memory_region->data()) %
+                   Allocator::kAllocatorAlignment);
+  std::unique_ptr<ReadOnlyMemoryRegion> other_memory_region;
+  TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(
+      kTensor2FileName, &other_memory_region));
+  EXPECT_EQ(memory_region->data(), other_memory_region->data());
+
+  // Random access reads decompress the blocks they touch.
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(memmapped_env.NewRandomAccessFile(kTensor2FileName, &file));
+  string scratch(3 * kBlockSize, '\0');
+  for (const uint64 offset : {uint64{0}, uint64{10}, kBlockSize - 1,
+                              2 * kBlockSize, 5 * kBlockSize + 77}) {
+    StringPiece result;
+    TF_ASSERT_OK(file->Read(offset, scratch.size(), &result, &scratch[0]));
+    EXPECT_EQ(test_tensor.tensor_data().substr(offset, scratch.size()),
+              result);
+  }
+  const uint64 tail_offset = test_tensor.TotalBytes() - 100;
+  StringPiece result;
+  EXPECT_EQ(error::OUT_OF_RANGE,
+            file->Read(tail_offset, scratch.size(), &result, &scratch[0])
+                .code());
+  EXPECT_EQ(test_tensor.tensor_data().substr(tail_offset), result);
+  EXPECT_EQ(
+      error::OUT_OF_RANGE,
+      file->Read(test_tensor.TotalBytes(), 1, &result, &scratch[0]).code());
+
+  // The uncompressed tensor is still read in place.
+  TF_ASSERT_OK(memmapped_env.NewReadOnlyMemoryRegionFromFile(kTensor1FileName,
+                                                             &memory_region));
+  EXPECT_EQ(test_tensor.tensor_data(),
+            StringPiece(static_cast<const char*>(memory_region->data()),
+                        memory_region->length()));
+}
+
 TEST(MemmappedFileSystemTest, NotInitialized) {
   MemmappedEnv memmapped_env(Env::Default());
   std::unique_ptr<ReadOnlyMemoryRegion> memory_region;
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include <algorithm>
 
+#include "zlib.h"
+
 namespace tensorflow {
 
 Status MemmappedFileSystemWriter::InitializeToFile(Env* env,
@@ -55,6 +57,54 @@ Status MemmappedFileSystemWriter::SaveTensor(const Tensor& tensor,
   return result;
 }
 
+Status MemmappedFileSystemWriter::SaveCompressedTensor(
+    const Tensor& tensor, const string& element_name, uint64 block_size) {
+  if (!output_file_) {
+    return errors::FailedPrecondition(
+        "MemmappedEnvWritter: saving tensor into not opened file");
+  }
+  if (!MemmappedFileSystem::IsWellFormedMemmappedPackageFilename(
+          element_name)) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: element_name is invalid: must have memmapped ",
+        "package prefix ", MemmappedFileSystem::kMemmappedPackagePrefix,
+        " and include [A-Za-z0-9_.]");
+  }
+  const auto tensor_data = tensor.tensor_data();
+  if (tensor_data.empty()) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: saving tensor with 0 size");
+  }
+  if (block_size == 0) {
+    return errors::InvalidArgument(
+        "MemmappedEnvWritter: compressed block size must be positive");
+  }
+  MemmappedFileSystemDirectoryElement* element =
+      AddToDirectoryElement(element_name, tensor_data.size());
+  element->set_compressed_block_size(block_size);
+  const uint64 region_offset = output_file_offset_;
+  string compressed;
+  for (uint64 pos = 0; pos < tensor_data.size(); pos += block_size) {
+    const uint64 length =
+        std::min<uint64>(block_size, tensor_data.size() - pos);
+    uLongf compressed_length = compressBound(length);
+    compressed.resize(compressed_length);
+    const int result = compress2(
+        reinterpret_cast<Bytef*>(&compressed[0]), &compressed_length,
+        reinterpret_cast<const Bytef*>(tensor_data.data() + pos), length,
+        Z_BEST_COMPRESSION);
+    if (result != Z_OK) {
+      return errors::Internal("MemmappedEnvWritter: zlib error ", result,
+                              " compressing tensor ", element_name);
+    }
+    TF_RETURN_IF_ERROR(output_file_->Append(
+        StringPiece(compressed.data(), compressed_length)));
+    output_file_offset_ += compressed_length;
+    element->add_compressed_block_end(output_file_offset_ - region_offset);
+  }
+  return OkStatus();
+}
+
 Status MemmappedFileSystemWriter::SaveProtobuf(
     const protobuf::MessageLite& message, const string& element_name) {
   if (!output_file_) {
@@ -124,13 +174,15 @@ Status MemmappedFileSystemWriter::AdjustAlignment(uint64 alignment) {
   return OkStatus();
 }
 
-void MemmappedFileSystemWriter::AddToDirectoryElement(const string& name,
-                                                      uint64 length) {
+MemmappedFileSystemDirectoryElement*
+MemmappedFileSystemWriter::AddToDirectoryElement(const string& name,
+                                                 uint64 length) {
   MemmappedFileSystemDirectoryElement* new_directory_element =
       directory_.add_element();
   new_directory_element->set_offset(output_file_offset_);
   new_directory_element->set_name(name);
   new_directory_element->set_length(length);
+  return new_directory_element;
 }
 
 }  // namespace tensorflow
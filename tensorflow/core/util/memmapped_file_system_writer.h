@@ -29,10 +29,17 @@ namespace tensorflow {
 // MemmappedFileSystem.
 class MemmappedFileSystemWriter {
  public:
+  static constexpr uint64 kDefaultCompressedBlockSize = 64 << 10;
+
   MemmappedFileSystemWriter() = default;
   ~MemmappedFileSystemWriter() = default;
   Status InitializeToFile(Env* env, const string& filename);
   Status SaveTensor(const Tensor& tensor, const string& element_name);
+  // Saves the tensor compressed, in independently compressed blocks of
+  // `block_size` bytes, so that the package is smaller. Reads of the tensor
+  // then decompress it, instead of using the memmapped memory in place.
+  Status SaveCompressedTensor(const Tensor& tensor, const string& element_name,
+                              uint64 block_size = kDefaultCompressedBlockSize);
   Status SaveProtobuf(const protobuf::MessageLite& message,
                       const string& element_name);
   // Writes out the directory of regions and closes the output file.
@@ -40,7 +47,8 @@ class MemmappedFileSystemWriter {
 
  private:
   Status AdjustAlignment(uint64 alignment);
-  void AddToDirectoryElement(const string& element_name, uint64 length);
+  MemmappedFileSystemDirectoryElement* AddToDirectoryElement(
+      const string& element_name, uint64 length);
   MemmappedFileSystemDirectory directory_;
   // The current offset in the file, to support alignment.
   uint64 output_file_offset_ = 0;
@@ -17,12 +17,20 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_PRESIZED_CUCKOO_MAP_H_
 
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <vector>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include "absl/base/prefetch.h"
+#include "absl/numeric/bits.h"
 #include "absl/numeric/int128.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -39,13 +47,17 @@ namespace tensorflow {
 // or delete functions (until some subsequent use of this table
 // requires them).
 //
-// Threads must synchronize their access to a PresizedCuckooMap.
+// Threads must synchronize their access to a PresizedCuckooMap, or use a
+// ConcurrentPresizedCuckooMap.
 //
 // The cuckoo hash table is 4-way associative (each "bucket" has 4
 // "slots" for key/value entries).  Uses breadth-first-search to find
 // a good cuckoo path with less data movement (see
 // http://www.cs.cmu.edu/~dga/papers/cuckoo-eurosys14.pdf )
 
+template <class value>
+class ConcurrentPresizedCuckooMap;
+
 template <class value>
 class PresizedCuckooMap {
  public:
@@ -83,14 +95,11 @@ class PresizedCuckooMap {
     int target_slot = kNoSpace;
 
     for (auto bucket : {b1, b2}) {
-      Bucket* bptr = &buckets_[bucket];
-      for (int slot = 0; slot < kSlotsPerBucket; slot++) {
-        if (bptr->keys[slot] == k) {  // Duplicates are not allowed.
-          return false;
-        } else if (target_slot == kNoSpace && bptr->keys[slot] == kUnusedSlot) {
-          target_bucket = bucket;
-          target_slot = slot;
-        }
+      if (FindSlot(k, bucket) != kNoSpace) {  // Duplicates are not allowed.
+        return false;
+      } else if (target_slot == kNoSpace) {
+        target_slot = SpaceAvailable(bucket);
+        target_bucket = bucket;
       }
     }
 
@@ -109,6 +118,26 @@ class PresizedCuckooMap {
            FindInBucket(k, fast_map_to_buckets(h2(tk)), out);
   }
 
+  // Looks up the n keys `keys[i]`, prefetching the buckets of the keys a few
+  // positions ahead while looking up the current one. Sets found[i], and
+  // out[i] if found[i]. Returns the number of keys found.
+  int64_t FindMany(const key_type* keys, int64_t n, value* out,
+                   bool* found) const {
+    for (int64_t i = 0; i < std::min<int64_t>(n, kFindManyPrefetchDistance);
+         ++i) {
+      PrefetchKey(keys[i]);
+    }
+    int64_t num_found = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      if (i + kFindManyPrefetchDistance < n) {
+        PrefetchKey(keys[i + kFindManyPrefetchDistance]);
+      }
+      found[i] = Find(keys[i], &out[i]);
+      num_found += found[i];
+    }
+    return num_found;
+  }
+
   // Prefetch memory associated with the key k into cache.
   void PrefetchKey(const key_type k) const {
     const uint64 tk = key_transform(k);
@@ -153,6 +182,10 @@ class PresizedCuckooMap {
   static constexpr int kNoSpace = -1;  // SpaceAvailable return
   static constexpr uint64 kUnusedSlot = ~(0ULL);
 
+  // How many keys ahead FindMany prefetches, to cover the memory latency of
+  // a bucket with the lookups of the keys in between.
+  static constexpr int64_t kFindManyPrefetchDistance = 8;
+
   // Buckets are organized with key_types clustered for access speed
   // and for compactness while remaining aligned.
   struct Bucket {
@@ -234,29 +267,44 @@ class PresizedCuckooMap {
     bptr->values[slot] = v;
   }
 
-  // For the associative cuckoo table, check all of the slots in
-  // the bucket to see if the key is present.
-  bool FindInBucket(key_type k, uint64 b, value* out) const {
+  // Returns either kNoSpace or the first slot of bucket b holding k. With
+  // AVX2, the 4 keys of the bucket are compared to k at once.
+  inline int FindSlot(key_type k, uint64 b) const {
     const Bucket& bref = buckets_[b];
+#if defined(__AVX2__)
+    static_assert(kSlotsPerBucket * sizeof(key_type) == sizeof(__m256i),
+                  "A bucket's keys must fill an AVX2 register");
+    const __m256i keys =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bref.keys));
+    const __m256i matches =
+        _mm256_cmpeq_epi64(keys, _mm256_set1_epi64x(static_cast<int64_t>(k)));
+    const uint32 mask = _mm256_movemask_pd(_mm256_castsi256_pd(matches));
+    return mask == 0 ? kNoSpace : absl::countr_zero(mask);
+#else
     for (int i = 0; i < kSlotsPerBucket; i++) {
       if (bref.keys[i] == k) {
-        *out = bref.values[i];
-        return true;
+        return i;
       }
     }
-    return false;
+    return kNoSpace;
+#endif
+  }
+
+  // For the associative cuckoo table, check all of the slots in
+  // the bucket to see if the key is present.
+  bool FindInBucket(key_type k, uint64 b, value* out) const {
+    const int slot = FindSlot(k, b);
+    if (slot == kNoSpace) {
+      return false;
+    }
+    *out = buckets_[b].values[slot];
+    return true;
   }
 
   //  returns either kNoSpace or the index of an
   //  available slot (0 <= slot < kSlotsPerBucket)
   inline int SpaceAvailable(uint64 bucket) const {
-    const Bucket& bref = buckets_[bucket];
-    for (int i = 0; i < kSlotsPerBucket; i++) {
-      if (bref.keys[i] == kUnusedSlot) {
-        return i;
-      }
-    }
-    return kNoSpace;
+    return FindSlot(kUnusedSlot, bucket);
   }
 
   inline void CopyItem(uint64 src_bucket, int src_slot, uint64 dst_bucket,
@@ -330,10 +378,142 @@ class PresizedCuckooMap {
   std::unique_ptr<CuckooPathQueue> cpq_;
   CuckooPathEntry visited_[kVisitedListSize];
 
+  friend class ConcurrentPresizedCuckooMap<value>;
+
   PresizedCuckooMap(const PresizedCuckooMap&) = delete;
   void operator=(const PresizedCuckooMap&) = delete;
 };
 
+// A PresizedCuckooMap which threads can insert into and look up concurrently.
+//
+// An insert which finds a free slot in one of the two buckets of its key only
+// locks these buckets, with spinlocks, so inserts of keys in different buckets
+// run in parallel. An insert which must move entries along a cuckoo path
+// takes the whole table exclusively, which is rare below the load factor.
+template <class value>
+class ConcurrentPresizedCuckooMap {
+ public:
+  typedef uint64 key_type;
+
+  explicit ConcurrentPresizedCuckooMap(uint64 num_entries)
+      : map_(num_entries),
+        bucket_locks_(new std::atomic<bool>[map_.num_buckets_]) {
+    for (uint64 i = 0; i < map_.num_buckets_; ++i) {
+      bucket_locks_[i].store(false, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns false if k is already in table or if the table
+  // is full; true otherwise.
+  bool InsertUnique(const key_type k, const value& v) {
+    const uint64 tk = map_.key_transform(k);
+    const uint64 b1 = map_.fast_map_to_buckets(tk);
+    const uint64 b2 = map_.fast_map_to_buckets(map_.h2(tk));
+    {
+      tf_shared_lock l(mu_);
+      BucketLocks locks(this, b1, b2);
+      if (map_.FindSlot(k, b1) != Map::kNoSpace ||
+          map_.FindSlot(k, b2) != Map::kNoSpace) {
+        return false;
+      }
+      for (auto bucket : {b1, b2}) {
+        const int slot = map_.SpaceAvailable(bucket);
+        if (slot != Map::kNoSpace) {
+          map_.InsertInternal(tk, v, bucket, slot);
+          return true;
+        }
+      }
+    }
+    mutex_lock l(mu_);
+    return map_.InsertUnique(k, v);
+  }
+
+  // Returns true if found.  Sets *out = value.
+  bool Find(const key_type k, value* out) const {
+    const uint64 tk = map_.key_transform(k);
+    tf_shared_lock l(mu_);
+    for (auto bucket : {map_.fast_map_to_buckets(tk),
+                        map_.fast_map_to_buckets(map_.h2(tk))}) {
+      BucketLocks locks(this, bucket, bucket);
+      if (map_.FindInBucket(k, bucket, out)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Same as PresizedCuckooMap::FindMany.
+  int64_t FindMany(const key_type* keys, int64_t n, value* out,
+                   bool* found) const {
+    constexpr int64_t kPrefetchDistance = Map::kFindManyPrefetchDistance;
+    for (int64_t i = 0; i < std::min<int64_t>(n, kPrefetchDistance); ++i) {
+      map_.PrefetchKey(keys[i]);
+    }
+    int64_t num_found = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      if (i + kPrefetchDistance < n) {
+        map_.PrefetchKey(keys[i + kPrefetchDistance]);
+      }
+      found[i] = Find(keys[i], &out[i]);
+      num_found += found[i];
+    }
+    return num_found;
+  }
+
+  int64_t MemoryUsed() const {
+    return sizeof(ConcurrentPresizedCuckooMap<value>) +
+           sizeof(typename Map::CuckooPathQueue) +
+           map_.num_buckets_ * sizeof(std::atomic<bool>);
+  }
+
+ private:
+  typedef PresizedCuckooMap<value> Map;
+
+  // Holds the spinlocks of buckets b1 and b2, which may be the same bucket,
+  // taken in bucket order to avoid deadlocks.
+  class BucketLocks {
+   public:
+    BucketLocks(const ConcurrentPresizedCuckooMap* map, uint64 b1, uint64 b2)
+        : map_(map), first_(std::min(b1, b2)), second_(std::max(b1, b2)) {
+      map_->LockBucket(first_);
+      if (second_ != first_) map_->LockBucket(second_);
+    }
+
+    ~BucketLocks() {
+      if (second_ != first_) map_->UnlockBucket(second_);
+      map_->UnlockBucket(first_);
+    }
+
+   private:
+    const ConcurrentPresizedCuckooMap* const map_;
+    const uint64 first_;
+    const uint64 second_;
+
+    BucketLocks(const BucketLocks&) = delete;
+    void operator=(const BucketLocks&) = delete;
+  };
+
+  void LockBucket(uint64 b) const {
+    while (bucket_locks_[b].exchange(true, std::memory_order_acquire)) {
+      while (bucket_locks_[b].load(std::memory_order_relaxed)) {
+      }
+    }
+  }
+
+  void UnlockBucket(uint64 b) const {
+    bucket_locks_[b].store(false, std::memory_order_release);
+  }
+
+  Map map_;
+  // Shared by the inserts which lock their buckets and by the lookups, and
+  // exclusive for the inserts which move entries across buckets.
+  mutable mutex mu_;
+  const std::unique_ptr<std::atomic<bool>[]> bucket_locks_;
+
+  ConcurrentPresizedCuckooMap(const ConcurrentPresizedCuckooMap&) = delete;
+  void operator=(const ConcurrentPresizedCuckooMap&) = delete;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_UTIL_PRESIZED_CUCKOO_MAP_H_
@@ -16,12 +16,15 @@ limitations under the License.
 #include "tensorflow/core/util/presized_cuckoo_map.h"
 
 #include <array>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace {
@@ -147,6 +150,55 @@ static void CalculateKeys(uint64 num, std::vector<uint64> *dst) {
   }
 }
 
+TEST(PresizedCuckooMapTest, FindMany) {
+  static constexpr int kTableSize = 1000;
+  std::vector<uint64> keys;
+  CalculateKeys(2 * kTableSize, &keys);
+  PresizedCuckooMap<int> pscm(kTableSize);
+  for (int i = 0; i < kTableSize; i++) {
+    ASSERT_TRUE(pscm.InsertUnique(keys[i], i));
+  }
+
+  std::vector<int> out(keys.size());
+  std::unique_ptr<bool[]> found(new bool[keys.size()]);
+  EXPECT_EQ(pscm.FindMany(keys.data(), keys.size(), out.data(), found.get()),
+            kTableSize);
+  for (int i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(found[i], i < kTableSize);
+    if (found[i]) EXPECT_EQ(out[i], i);
+  }
+}
+
+TEST(ConcurrentPresizedCuckooMapTest, ConcurrentInserts) {
+  static constexpr int kTableSize = 100000;
+  static constexpr int kNumThreads = 8;
+  std::vector<uint64> keys;
+  CalculateKeys(kTableSize, &keys);
+  ConcurrentPresizedCuckooMap<int> pscm(kTableSize);
+  std::atomic<int> num_inserted(0);
+  {
+    // Each key is inserted by two threads, and only one of them succeeds.
+    thread::ThreadPool pool(Env::Default(), "inserts", kNumThreads);
+    for (int t = 0; t < kNumThreads; t++) {
+      pool.Schedule([&, t]() {
+        for (int i = t / 2; i < kTableSize; i += kNumThreads / 2) {
+          num_inserted += pscm.InsertUnique(keys[i], i);
+        }
+      });
+    }
+  }
+  EXPECT_EQ(num_inserted, kTableSize);
+
+  std::vector<int> out(keys.size());
+  std::unique_ptr<bool[]> found(new bool[keys.size()]);
+  EXPECT_EQ(pscm.FindMany(keys.data(), keys.size(), out.data(), found.get()),
+            kTableSize);
+  for (int i = 0; i < kTableSize; i++) {
+    EXPECT_EQ(out[i], i);
+  }
+  EXPECT_FALSE(pscm.InsertUnique(keys[0], 0));
+}
+
 void BM_CuckooFill(::testing::benchmark::State &state) {
   const int arg = state.range(0);
 
@@ -189,5 +241,27 @@ void BM_CuckooRead(::testing::benchmark::State &state) {
 
 BENCHMARK(BM_CuckooRead)->Arg(1000)->Arg(10000000);
 
+void BM_CuckooFindMany(::testing::benchmark::State &state) {
+  const int arg = state.range(0);
+
+  uint64 table_size = arg;
+  std::vector<uint64> calculated_keys;
+  CalculateKeys(table_size, &calculated_keys);
+  PresizedCuckooMap<int> pscm(table_size);
+  for (uint64 i = 0; i < table_size; i++) {
+    pscm.InsertUnique(calculated_keys[i], i);
+  }
+
+  std::vector<int> out(table_size);
+  std::unique_ptr<bool[]> found(new bool[table_size]);
+  for (auto s : state) {
+    pscm.FindMany(calculated_keys.data(), table_size, out.data(), found.get());
+    tensorflow::testing::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations() * table_size);
+}
+
+BENCHMARK(BM_CuckooFindMany)->Arg(1000)->Arg(10000000);
+
 }  // namespace
 }  // namespace tensorflow
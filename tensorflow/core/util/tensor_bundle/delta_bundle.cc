@@ -0,0 +1,285 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/tstring.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kSourcesKey[] = "_DELTA_SOURCES";
+
+// The dtype, chunk size in elements and shape of a chunked tensor, as an
+// int64 vector.
+std::string SpecKey(absl::string_view key) {
+  return absl::StrCat(key, "/_DELTA_SPEC");
+}
+
+// The hash and source of each chunk of a chunked tensor, as an int64 matrix.
+std::string ChunksKey(absl::string_view key) {
+  return absl::StrCat(key, "/_DELTA_CHUNKS");
+}
+
+std::string ChunkKey(absl::string_view key, int64_t chunk) {
+  return absl::StrCat(key, "/_CHUNK_", chunk);
+}
+
+// Returns the end of the elements of chunk `chunk`.
+int64_t ChunkEnd(int64_t chunk, int64_t chunk_elements, int64_t num_elements) {
+  return std::min(num_elements, (chunk + 1) * chunk_elements);
+}
+
+}  // namespace
+
+DeltaBundleWriter::DeltaBundleWriter(Env* env, absl::string_view prefix,
+                                     absl::string_view base_prefix,
+                                     const Options& options)
+    : options_(options),
+      writer_(env, prefix, options.bundle_options),
+      sources_({std::string(prefix)}) {
+  status_ = writer_.status();
+  if (!status_.ok()) return;
+  if (options_.chunk_bytes <= 0) {
+    status_ = errors::InvalidArgument("chunk_bytes must be positive, got ",
+                                      options_.chunk_bytes);
+    return;
+  }
+  if (!base_prefix.empty()) {
+    base_ = std::make_unique<DeltaBundleReader>(env, base_prefix);
+    status_ = base_->status();
+    base_source_indices_.assign(base_->sources().size(), -1);
+  }
+}
+
+DeltaBundleWriter::~DeltaBundleWriter() = default;
+
+int DeltaBundleWriter::SourceIndex(int base_source) {
+  int& index = base_source_indices_[base_source];
+  if (index < 0) {
+    index = sources_.size();
+    sources_.push_back(base_->sources()[base_source]);
+  }
+  return index;
+}
+
+Status DeltaBundleWriter::Add(absl::string_view key, const Tensor& val) {
+  TF_RETURN_IF_ERROR(status_);
+  if (!DataTypeCanUseMemcpy(val.dtype()) || val.NumElements() == 0) {
+    bytes_written_ += val.TotalBytes();
+    return writer_.Add(key, val);
+  }
+
+  const int64_t num_elements = val.NumElements();
+  const int64_t chunk_elements = std::max<int64_t>(
+      1, options_.chunk_bytes / DataTypeSize(val.dtype()));
+  const int64_t num_chunks =
+      (num_elements + chunk_elements - 1) / chunk_elements;
+
+  // The chunks of the base are only compared if they split the same tensor
+  // the same way.
+  Tensor base_chunks;
+  bool has_base_chunks = false;
+  if (base_ != nullptr) {
+    DataType base_dtype;
+    TensorShape base_shape;
+    int64_t base_chunk_elements;
+    Status s = base_->LookupChunks(key, &base_dtype, &base_shape,
+                                   &base_chunk_elements, &base_chunks);
+    if (s.ok()) {
+      has_base_chunks = base_dtype == val.dtype() &&
+                        base_shape == val.shape() &&
+                        base_chunk_elements == chunk_elements;
+    } else if (!errors::IsNotFound(s)) {
+      return s;
+    }
+  }
+
+  Tensor flat;
+  TF_RETURN_IF_ERROR(
+      flat.BitcastFrom(val, val.dtype(), TensorShape({num_elements})));
+  Tensor chunks(DT_INT64, TensorShape({num_chunks, 2}));
+  auto chunks_matrix = chunks.matrix<int64_t>();
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    const Tensor chunk = flat.Slice(
+        i * chunk_elements, ChunkEnd(i, chunk_elements, num_elements));
+    const StringPiece data = chunk.tensor_data();
+    const int64_t hash = static_cast<int64_t>(Hash64(data.data(), data.size()));
+    chunks_matrix(i, 0) = hash;
+    if (has_base_chunks && base_chunks.matrix<int64_t>()(i, 0) == hash) {
+      chunks_matrix(i, 1) = SourceIndex(base_chunks.matrix<int64_t>()(i, 1));
+      bytes_reused_ += data.size();
+    } else {
+      TF_RETURN_IF_ERROR(writer_.Add(ChunkKey(key, i), chunk));
+      chunks_matrix(i, 1) = 0;
+      bytes_written_ += data.size();
+    }
+  }
+
+  Tensor spec(DT_INT64, TensorShape({2 + val.dims()}));
+  auto spec_vec = spec.vec<int64_t>();
+  spec_vec(0) = val.dtype();
+  spec_vec(1) = chunk_elements;
+  for (int d = 0; d < val.dims(); ++d) {
+    spec_vec(2 + d) = val.dim_size(d);
+  }
+  TF_RETURN_IF_ERROR(writer_.Add(SpecKey(key), spec));
+  return writer_.Add(ChunksKey(key), chunks);
+}
+
+Status DeltaBundleWriter::Finish() {
+  TF_RETURN_IF_ERROR(status_);
+  Tensor sources(DT_STRING, TensorShape({static_cast<int64_t>(
+                                sources_.size())}));
+  for (int i = 0; i < sources_.size(); ++i) {
+    sources.vec<tstring>()(i) = sources_[i];
+  }
+  TF_RETURN_IF_ERROR(writer_.Add(kSourcesKey, sources));
+  status_ = writer_.Finish();
+  return status_;
+}
+
+DeltaBundleReader::DeltaBundleReader(Env* env, absl::string_view prefix)
+    : env_(env), reader_(env, prefix) {
+  status_ = reader_.status();
+  if (!status_.ok()) return;
+  if (!reader_.Contains(kSourcesKey)) {
+    sources_.push_back(std::string(prefix));
+  } else {
+    Tensor sources;
+    status_ = reader_.Lookup(kSourcesKey, &sources);
+    if (!status_.ok()) return;
+    for (int64_t i = 0; i < sources.NumElements(); ++i) {
+      sources_.push_back(sources.flat<tstring>()(i));
+    }
+    if (sources_.empty()) {
+      status_ = errors::DataLoss("Delta bundle at ", prefix,
+                                 " lists no sources");
+      return;
+    }
+  }
+  source_readers_.resize(sources_.size());
+}
+
+DeltaBundleReader::~DeltaBundleReader() = default;
+
+Status DeltaBundleReader::LookupChunks(absl::string_view key, DataType* dtype,
+                                       TensorShape* shape,
+                                       int64_t* chunk_elements,
+                                       Tensor* chunks) {
+  const std::string spec_key = SpecKey(key);
+  if (!reader_.Contains(spec_key)) {
+    return errors::NotFound("Key ", key, " is not chunked");
+  }
+  Tensor spec;
+  TF_RETURN_IF_ERROR(reader_.Lookup(spec_key, &spec));
+  if (spec.dtype() != DT_INT64 || spec.dims() != 1 || spec.NumElements() < 2) {
+    return errors::DataLoss("Invalid chunk spec of ", key, ": ",
+                            spec.DebugString());
+  }
+  auto spec_vec = spec.vec<int64_t>();
+  *dtype = static_cast<DataType>(spec_vec(0));
+  *chunk_elements = spec_vec(1);
+  shape->Clear();
+  for (int64_t d = 2; d < spec.NumElements(); ++d) {
+    TF_RETURN_IF_ERROR(shape->AddDimWithStatus(spec_vec(d)));
+  }
+  if (!DataTypeCanUseMemcpy(*dtype) || *chunk_elements <= 0) {
+    return errors::DataLoss("Invalid chunk spec of ", key, ": ",
+                            spec.DebugString());
+  }
+
+  TF_RETURN_IF_ERROR(reader_.Lookup(ChunksKey(key), chunks));
+  const int64_t num_chunks =
+      (shape->num_elements() + *chunk_elements - 1) / *chunk_elements;
+  if (chunks->dtype() != DT_INT64 ||
+      chunks->shape() != TensorShape({num_chunks, 2})) {
+    return errors::DataLoss("Invalid chunk table of ", key, ": ",
+                            chunks->DebugString(), ", expected ", num_chunks,
+                            " chunks");
+  }
+  auto chunks_matrix = chunks->matrix<int64_t>();
+  for (int64_t i = 0; i < num_chunks; ++i) {
+    if (chunks_matrix(i, 1) < 0 || chunks_matrix(i, 1) >= sources_.size()) {
+      return errors::DataLoss("Chunk ", i, " of ", key,
+                              " refers to unknown source ",
+                              chunks_matrix(i, 1));
+    }
+  }
+  return OkStatus();
+}
+
+Status DeltaBundleReader::GetSourceReader(int64_t source,
+                                          BundleReader** reader) {
+  if (source == 0) {
+    *reader = &reader_;
+    return OkStatus();
+  }
+  if (source_readers_[source] == nullptr) {
+    auto source_reader =
+        std::make_unique<BundleReader>(env_, sources_[source]);
+    TF_RETURN_IF_ERROR(source_reader->status());
+    source_readers_[source] = std::move(source_reader);
+  }
+  *reader = source_readers_[source].get();
+  return OkStatus();
+}
+
+Status DeltaBundleReader::Lookup(absl::string_view key, Tensor* val) {
+  DataType dtype;
+  TensorShape shape;
+  int64_t chunk_elements;
+  Tensor chunks;
+  Status s = LookupChunks(key, &dtype, &shape, &chunk_elements, &chunks);
+  if (errors::IsNotFound(s)) {
+    *val = Tensor();
+    return reader_.Lookup(key, val);
+  }
+  TF_RETURN_IF_ERROR(s);
+
+  *val = Tensor(dtype, shape);
+  const int64_t num_elements = shape.num_elements();
+  Tensor flat;
+  TF_RETURN_IF_ERROR(
+      flat.BitcastFrom(*val, dtype, TensorShape({num_elements})));
+  auto chunks_matrix = chunks.matrix<int64_t>();
+  for (int64_t i = 0; i < chunks.dim_size(0); ++i) {
+    BundleReader* source;
+    TF_RETURN_IF_ERROR(GetSourceReader(chunks_matrix(i, 1), &source));
+    Tensor chunk = flat.Slice(i * chunk_elements,
+                              ChunkEnd(i, chunk_elements, num_elements));
+    char* dst = const_cast<char*>(chunk.tensor_data().data());
+    TF_RETURN_IF_ERROR(source->Lookup(ChunkKey(key, i), &chunk));
+    // Memory mapped readers replace the buffer of the chunk.
+    if (chunk.tensor_data().data() != dst) {
+      std::memcpy(dst, chunk.tensor_data().data(), chunk.TotalBytes());
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace tensorflow
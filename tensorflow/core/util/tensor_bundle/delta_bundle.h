@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Delta tensor bundles: bundles that only store the parts of their tensors
+// that changed since a base bundle, and reference the data of the base for the
+// rest.
+//
+// Each tensor of a POD type is split into chunks of about
+// `DeltaBundleWriter::Options::chunk_bytes` bytes, keyed by "<key>/_CHUNK_<i>",
+// along with a table of the 64-bit hash of each chunk and the index of the
+// bundle that stores it, among those listed under "_DELTA_SOURCES".  When the
+// base has a chunk of the same tensor, shape and chunk size with the same hash,
+// it is not written again and the table refers to the bundle of the base that
+// stores it.  The references are always to the bundle that holds the bytes, so
+// that reading a tensor opens each source once, however long the chain of
+// deltas is.  Other tensors are stored in full, as in a regular bundle.
+//
+//   DeltaBundleWriter writer(env, "/fs/ckpt-2", /*base_prefix=*/"/fs/ckpt-1");
+//   writer.Add("embedding", embedding);
+//   writer.Finish();
+//
+//   DeltaBundleReader reader(env, "/fs/ckpt-2");
+//   reader.Lookup("embedding", &tensor);
+//
+// A delta bundle is a regular tensor bundle otherwise, but needs the data
+// files of its sources: those must be kept as long as it is used.  Any bundle
+// can be read by a DeltaBundleReader, but tensors are only deduplicated
+// against delta bundles.
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+class DeltaBundleReader;
+
+// Builds a delta bundle against the bundle at `base_prefix`, or a delta bundle
+// without a base if `base_prefix` is empty.
+//
+// Not thread-safe.
+class DeltaBundleWriter {
+ public:
+  struct Options {
+    Options() {}
+    // The size of the chunks that are compared to the base.  Deltas are only
+    // taken against bases with the same chunk size.
+    int64_t chunk_bytes{1 << 20};
+
+    BundleWriter::Options bundle_options;
+  };
+
+  DeltaBundleWriter(Env* env, absl::string_view prefix,
+                    absl::string_view base_prefix,
+                    const Options& options = Options());
+  ~DeltaBundleWriter();
+
+  // Adds the tensor "val" under key "key".  Keys must be unique.
+  Status Add(absl::string_view key, const Tensor& val) TF_MUST_USE_RESULT;
+
+  // Finishes the writer and flushes.
+  Status Finish() TF_MUST_USE_RESULT;
+
+  Status status() const { return status_; }
+
+  // The number of tensor bytes written to this bundle, and referenced in the
+  // sources of the base, respectively.
+  int64_t bytes_written() const { return bytes_written_; }
+  int64_t bytes_reused() const { return bytes_reused_; }
+
+ private:
+  // Returns the index in `sources_` of the source `base_source` of the base.
+  int SourceIndex(int base_source);
+
+  const Options options_;
+  BundleWriter writer_;
+  std::unique_ptr<DeltaBundleReader> base_;
+  Status status_;
+
+  // The prefixes of the bundles that the chunks are stored in, this one first.
+  std::vector<std::string> sources_;
+  // The index in `sources_` of each source of the base, or -1.
+  std::vector<int> base_source_indices_;
+
+  int64_t bytes_written_ = 0;
+  int64_t bytes_reused_ = 0;
+
+  DeltaBundleWriter(const DeltaBundleWriter&) = delete;
+  void operator=(const DeltaBundleWriter&) = delete;
+};
+
+// Reads the tensors of a delta bundle, or of a regular bundle.
+//
+// Not thread-safe.
+class DeltaBundleReader {
+ public:
+  DeltaBundleReader(Env* env, absl::string_view prefix);
+  ~DeltaBundleReader();
+
+  // Is ok() iff the reader of the bundle could be created.
+  Status status() const { return status_; }
+
+  // Looks up the tensor keyed by "key", reading its chunks from the bundles
+  // they are stored in.  "val" is reallocated.
+  // REQUIRES: status().ok()
+  Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // The prefixes of the bundles that this one reads data from, itself first.
+  const std::vector<std::string>& sources() const { return sources_; }
+
+ private:
+  friend class DeltaBundleWriter;
+
+  // Looks up how the tensor keyed by "key" is chunked.  Returns NotFound if it
+  // is stored in full.
+  Status LookupChunks(absl::string_view key, DataType* dtype,
+                      TensorShape* shape, int64_t* chunk_elements,
+                      Tensor* chunks) TF_MUST_USE_RESULT;
+
+  // Returns the reader of the source `source`, opening it on first use.
+  Status GetSourceReader(int64_t source,
+                         BundleReader** reader) TF_MUST_USE_RESULT;
+
+  Env* const env_;  // Not owned.
+  BundleReader reader_;
+  Status status_;
+  std::vector<std::string> sources_;
+  // The readers of the sources other than this bundle, opened on demand.
+  std::vector<std::unique_ptr<BundleReader>> source_readers_;
+
+  DeltaBundleReader(const DeltaBundleReader&) = delete;
+  void operator=(const DeltaBundleReader&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return io::JoinPath(testing::TmpDir(), "delta_bundle_test", prefix);
+}
+
+// A [8, 4] float tensor, in chunks of two rows.
+Tensor Table(float offset) {
+  Tensor table(DT_FLOAT, TensorShape({8, 4}));
+  for (int i = 0; i < table.NumElements(); ++i) {
+    table.flat<float>()(i) = offset + i;
+  }
+  return table;
+}
+
+DeltaBundleWriter::Options ChunkOptions() {
+  DeltaBundleWriter::Options options;
+  options.chunk_bytes = 2 * 4 * sizeof(float);
+  return options;
+}
+
+void ExpectLookup(const string& prefix, const string& key,
+                  const Tensor& expected) {
+  DeltaBundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup(key, &val));
+  test::ExpectTensorEqual<float>(val, expected);
+}
+
+TEST(DeltaBundleTest, StoresOnlyChangedChunks) {
+  {
+    DeltaBundleWriter writer(Env::Default(), Prefix("base"), "",
+                             ChunkOptions());
+    TF_ASSERT_OK(writer.Add("table", Table(0)));
+    TF_ASSERT_OK(writer.Finish());
+    EXPECT_EQ(writer.bytes_written(), 8 * 4 * sizeof(float));
+    EXPECT_EQ(writer.bytes_reused(), 0);
+  }
+
+  // Only the third row changes.
+  Tensor updated = Table(0);
+  updated.matrix<float>()(2, 1) = -1;
+  {
+    DeltaBundleWriter writer(Env::Default(), Prefix("delta"), Prefix("base"),
+                             ChunkOptions());
+    TF_ASSERT_OK(writer.Add("table", updated));
+    TF_ASSERT_OK(writer.Finish());
+    EXPECT_EQ(writer.bytes_written(), 2 * 4 * sizeof(float));
+    EXPECT_EQ(writer.bytes_reused(), 6 * 4 * sizeof(float));
+  }
+
+  BundleReader bundle_reader(Env::Default(), Prefix("delta"));
+  TF_ASSERT_OK(bundle_reader.status());
+  EXPECT_FALSE(bundle_reader.Contains("table/_CHUNK_0"));
+  EXPECT_TRUE(bundle_reader.Contains("table/_CHUNK_1"));
+  EXPECT_FALSE(bundle_reader.Contains("table/_CHUNK_2"));
+
+  ExpectLookup(Prefix("base"), "table", Table(0));
+  ExpectLookup(Prefix("delta"), "table", updated);
+  DeltaBundleReader reader(Env::Default(), Prefix("delta"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(reader.sources(),
+            std::vector<std::string>({Prefix("delta"), Prefix("base")}));
+}
+
+TEST(DeltaBundleTest, ResolvesChains) {
+  Tensor table = Table(0);
+  string base = "";
+  for (int i = 0; i < 4; ++i) {
+    // Each step changes another chunk.
+    table.matrix<float>()(2 * i, 0) = 100 + i;
+    const string prefix = Prefix(absl::StrCat("chain-", i));
+    DeltaBundleWriter writer(Env::Default(), prefix, base, ChunkOptions());
+    TF_ASSERT_OK(writer.Add("table", table));
+    TF_ASSERT_OK(writer.Finish());
+    base = prefix;
+  }
+  ExpectLookup(base, "table", table);
+
+  // The last delta refers directly to the bundle that stores each chunk.
+  DeltaBundleReader reader(Env::Default(), base);
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(reader.sources().size(), 4);
+}
+
+TEST(DeltaBundleTest, RewritesChangedShapes) {
+  {
+    DeltaBundleWriter writer(Env::Default(), Prefix("shape-base"), "",
+                             ChunkOptions());
+    TF_ASSERT_OK(writer.Add("table", Table(0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor reshaped(DT_FLOAT, TensorShape({4, 8}));
+  CHECK(reshaped.CopyFrom(Table(0), reshaped.shape()));
+  DeltaBundleWriter writer(Env::Default(), Prefix("shape-delta"),
+                           Prefix("shape-base"), ChunkOptions());
+  TF_ASSERT_OK(writer.Add("table", reshaped));
+  TF_ASSERT_OK(writer.Finish());
+  EXPECT_EQ(writer.bytes_reused(), 0);
+  ExpectLookup(Prefix("shape-delta"), "table", reshaped);
+}
+
+TEST(DeltaBundleTest, StoresOtherTensorsInFull) {
+  Tensor strings = test::AsTensor<tstring>({"a", "b"});
+  {
+    DeltaBundleWriter writer(Env::Default(), Prefix("strings"), "",
+                             ChunkOptions());
+    TF_ASSERT_OK(writer.Add("strings", strings));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  DeltaBundleReader reader(Env::Default(), Prefix("strings"));
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("strings", &val));
+  test::ExpectTensorEqual<tstring>(val, strings);
+  EXPECT_TRUE(errors::IsNotFound(reader.Lookup("missing", &val)));
+}
+
+TEST(DeltaBundleTest, ReadsRegularBundles) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("regular"));
+    TF_ASSERT_OK(writer.Add("table", Table(0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  ExpectLookup(Prefix("regular"), "table", Table(0));
+
+  DeltaBundleWriter writer(Env::Default(), Prefix("regular-delta"),
+                           Prefix("regular"), ChunkOptions());
+  TF_ASSERT_OK(writer.Add("table", Table(0)));
+  TF_ASSERT_OK(writer.Finish());
+  EXPECT_EQ(writer.bytes_reused(), 0);
+  ExpectLookup(Prefix("regular-delta"), "table", Table(0));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,11 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -422,6 +424,48 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// A TensorBuffer pointing into a memory mapped data file.  Keeps the mapping
+// alive for as long as any tensor refers to it.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const void* data, size_t size)
+      : TensorBuffer(const_cast<void*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(static_cast<int64_t>(size_));
+    proto->set_allocator_name("BundleReaderMemoryMappedFile");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // The mapping is read-only, so the buffer must never be forwarded to an
+  // output and written in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+BundleReader::Options ReaderOptionsFromEnv(
+    bool enable_multi_threading_for_testing) {
+  BundleReader::Options options;
+  options.enable_multi_threading_for_testing =
+      enable_multi_threading_for_testing;
+  Status s = ReadBoolFromEnvVar("TF_BUNDLE_READER_USE_MMAP", false,
+                                &options.use_memory_mapped_files);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+  }
+  return options;
+}
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -770,6 +814,11 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 BundleReader::BundleReader(
     Env* env, StringPiece prefix,
     bool enable_multi_threading_for_testing /* = false */)
+    : BundleReader(env, prefix,
+                   ReaderOptionsFromEnv(enable_multi_threading_for_testing)) {}
+
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
       prefix_(prefix),
       metadata_(nullptr),
@@ -777,7 +826,9 @@ BundleReader::BundleReader(
       index_cache_(nullptr),
       iter_(nullptr),
       need_to_swap_bytes_(false),
-      enable_multi_threading_for_testing_(enable_multi_threading_for_testing) {
+      enable_multi_threading_for_testing_(
+          options.enable_multi_threading_for_testing),
+      use_memory_mapped_files_(options.use_memory_mapped_files) {
   const string filename = MetaFilename(prefix_);
   uint64 file_size;
   status_ = env_->GetFileSize(filename, &file_size);
@@ -798,7 +849,12 @@ BundleReader::BundleReader(
     o.block_cache = index_cache_;
   }
 
-  status_ = table::Table::Open(o, metadata_, file_size, &table_);
+  if (use_memory_mapped_files_ &&
+      env_->NewReadOnlyMemoryRegionFromFile(filename, &metadata_region_).ok()) {
+    status_ = table::Table::Open(o, metadata_region_.get(), &table_);
+  } else {
+    status_ = table::Table::Open(o, metadata_, file_size, &table_);
+  }
   if (!status_.ok()) return;
   iter_ = table_->NewIterator();
 
@@ -869,7 +925,95 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return OkStatus();
 }
 
+Status BundleReader::GetDataFile(int32_t shard_id,
+                                 io::InputBuffer** buffered_file) {
+  *buffered_file = data_[shard_id];
+  if (*buffered_file == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    *buffered_file = new io::InputBuffer(file.release(), kBufferSize);
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data_[shard_id] = *buffered_file;
+  }
+  return OkStatus();
+}
+
+const std::shared_ptr<ReadOnlyMemoryRegion>& BundleReader::GetMappedDataFile(
+    int32_t shard_id) {
+  auto it = mapped_data_.find(shard_id);
+  if (it == mapped_data_.end()) {
+    const string filename = DataFilename(prefix_, shard_id, num_shards_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!s.ok()) {
+      VLOG(1) << "Reading " << filename << " without memory mapping: " << s;
+      region.reset();
+    }
+    it = mapped_data_.emplace(shard_id, std::move(region)).first;
+  }
+  return it->second;
+}
+
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    Tensor* val, bool* mapped) {
+  *mapped = false;
+  if (!DataTypeCanUseMemcpy(entry.dtype()) || need_to_swap_bytes_ ||
+      entry.size() == 0 ||
+      (val->NumElements() != 0 && val->dtype() != entry.dtype())) {
+    return OkStatus();
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region =
+      GetMappedDataFile(entry.shard_id());
+  if (region == nullptr) {
+    return OkStatus();
+  }
+
+  if (entry.offset() < 0 || entry.size() > region->length() ||
+      static_cast<uint64>(entry.offset()) > region->length() - entry.size()) {
+    return errors::DataLoss("Tensor at offset ", entry.offset(), " of ",
+                            entry.size(), " bytes lies outside of shard ",
+                            entry.shard_id(), " of TensorBundle at ", prefix_);
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return OkStatus();
+  }
+  const TensorShape shape = val->NumElements() == 0
+                                ? TensorShape(entry.shape())
+                                : val->shape();
+  const int64_t expected_size =
+      shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != static_cast<uint64>(expected_size)) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+
+  core::RefCountPtr<TensorBuffer> buf(
+      new MappedTensorBuffer(region, data, entry.size()));
+  *val = Tensor(entry.dtype(), shape, std::move(buf));
+  *mapped = true;
+  return OkStatus();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  if (use_memory_mapped_files_) {
+    bool mapped = false;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &mapped));
+    if (mapped) {
+      return OkStatus();
+    }
+  }
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -899,15 +1043,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   }
 
   // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
   CHECK(buffered_file != nullptr);
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
@@ -1042,6 +1179,117 @@ Status BundleReader::ReadCurrent(Tensor* val) {
   }
 }
 
+Status BundleReader::ReadEntryBytes(const BundleEntryProto& entry,
+                                    int64_t offset, int64_t size, char* dst) {
+  std::vector<RandomAccessFile::ReadRequest> ranges(1);
+  ranges[0].offset = offset;
+  ranges[0].n = size;
+  ranges[0].scratch = dst;
+  return ReadEntryRanges(entry, &ranges);
+}
+
+Status BundleReader::ReadEntryRanges(
+    const BundleEntryProto& entry,
+    std::vector<RandomAccessFile::ReadRequest>* ranges) {
+  for (const RandomAccessFile::ReadRequest& range : *ranges) {
+    if (range.offset + range.n > entry.size()) {
+      return errors::InvalidArgument("Bytes [", range.offset, ", ",
+                                     range.offset + range.n,
+                                     ") lie outside of the ", entry.size(),
+                                     " bytes of the entry");
+    }
+  }
+  if (use_memory_mapped_files_) {
+    const std::shared_ptr<ReadOnlyMemoryRegion>& region =
+        GetMappedDataFile(entry.shard_id());
+    if (region != nullptr) {
+      if (entry.offset() < 0 || entry.size() > region->length() ||
+          static_cast<uint64>(entry.offset()) >
+              region->length() - entry.size()) {
+        return errors::DataLoss("Tensor at offset ", entry.offset(), " of ",
+                                entry.size(), " bytes lies outside of shard ",
+                                entry.shard_id(), " of TensorBundle at ",
+                                prefix_);
+      }
+      const char* data =
+          static_cast<const char*>(region->data()) + entry.offset();
+      for (const RandomAccessFile::ReadRequest& range : *ranges) {
+        memcpy(range.scratch, data + range.offset, range.n);
+      }
+      return OkStatus();
+    }
+  }
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+  // The ranges are read concurrently, if the file system allows it.
+  for (RandomAccessFile::ReadRequest& range : *ranges) {
+    range.offset += entry.offset();
+  }
+  TF_RETURN_IF_ERROR(buffered_file->file()->ReadV(ranges));
+  for (const RandomAccessFile::ReadRequest& range : *ranges) {
+    if (range.result.size() != range.n) {
+      return errors::DataLoss("Read ", range.result.size(), " of ", range.n,
+                              " bytes at offset ", range.offset, " of shard ",
+                              entry.shard_id(), " from TensorBundle at ",
+                              prefix_);
+    }
+    if (range.result.data() != range.scratch) {
+      memmove(range.scratch, range.result.data(), range.n);
+    }
+  }
+  return OkStatus();
+}
+
+Status BundleReader::LookupRows(StringPiece key,
+                                absl::Span<const int64_t> rows, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  TensorShape shape(entry.shape());
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      shape.dims() == 0) {
+    return errors::InvalidArgument(
+        "Rows can only be looked up in tensors of POD types with at least one "
+        "dimension that were saved in full; got key ",
+        key, " of type ", DataTypeString(entry.dtype()), " and shape ",
+        shape.DebugString(), " in ", entry.slices_size(), " slices");
+  }
+  const int64_t num_rows = shape.dim_size(0);
+  const int64_t row_bytes =
+      shape.num_elements() / std::max<int64_t>(num_rows, 1) *
+      DataTypeSize(entry.dtype());
+  if (entry.size() != static_cast<uint64>(num_rows * row_bytes)) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            num_rows * row_bytes);
+  }
+  for (const int64_t row : rows) {
+    if (row < 0 || row >= num_rows) {
+      return errors::InvalidArgument("Row ", row, " of ", key,
+                                     " is out of range [0, ", num_rows, ")");
+    }
+  }
+
+  shape.set_dim(0, rows.size());
+  *val = Tensor(entry.dtype(), shape);
+  char* backing_buffer = const_cast<char*>(val->tensor_data().data());
+  // Runs of consecutive rows are read at once.
+  std::vector<RandomAccessFile::ReadRequest> ranges;
+  for (size_t begin = 0, end; begin < rows.size(); begin = end) {
+    end = begin + 1;
+    while (end < rows.size() && rows[end] == rows[end - 1] + 1) ++end;
+    RandomAccessFile::ReadRequest& range = ranges.emplace_back();
+    range.offset = rows[begin] * row_bytes;
+    range.n = (end - begin) * row_bytes;
+    range.scratch = backing_buffer + begin * row_bytes;
+  }
+  TF_RETURN_IF_ERROR(ReadEntryRanges(entry, &ranges));
+  if (need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(ByteSwapTensor(val));
+  }
+  return OkStatus();
+}
+
 Status BundleReader::LookupTensorSlices(StringPiece key,
                                         std::vector<TensorSlice>* slices) {
   slices->clear();
@@ -1140,9 +1388,51 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
       return status_;
     }
 
-    Tensor stored_slice_tensor(stored_slice_entry.dtype(), stored_slice_shape);
-    status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
-    if (!status_.ok()) return status_;
+    // Only the rows of the stored slice, along the first dimension, that
+    // intersect "slice_spec" are read, so that restoring a part of a large
+    // tensor, e.g. into a different partitioning, reads and holds that part
+    // only.  The stored checksum covers the whole slice, so it is not
+    // validated then.
+    TensorSlice read_slice = stored_slice;
+    Tensor stored_slice_tensor;
+    const int64_t stored_rows =
+        stored_slice_shape.dims() > 0 ? stored_slice_shape.dim_size(0) : 0;
+    int64_t stored_begin = 0, begin_row = 0, end_row = stored_rows;
+    if (stored_rows > 0) {
+      const int64_t full_rows = full_shape.dim_size(0);
+      stored_begin = stored_slice.IsFullAt(0) ? 0 : stored_slice.start(0);
+      const int64_t spec_begin =
+          slice_spec.IsFullAt(0) ? 0 : slice_spec.start(0);
+      const int64_t spec_end =
+          slice_spec.IsFullAt(0) ? full_rows : slice_spec.end(0);
+      begin_row = std::max<int64_t>(spec_begin - stored_begin, 0);
+      end_row = std::min(spec_end - stored_begin, stored_rows);
+    }
+    if (DataTypeCanUseMemcpy(stored_slice_entry.dtype()) &&
+        stored_slice_entry.size() ==
+            stored_slice_shape.num_elements() *
+                DataTypeSize(stored_slice_entry.dtype()) &&
+        begin_row < end_row && end_row - begin_row < stored_rows) {
+      const int64_t row_bytes = stored_slice_entry.size() / stored_rows;
+      TensorShape read_shape = stored_slice_shape;
+      read_shape.set_dim(0, end_row - begin_row);
+      stored_slice_tensor = Tensor(stored_slice_entry.dtype(), read_shape);
+      status_ = ReadEntryBytes(
+          stored_slice_entry, begin_row * row_bytes,
+          (end_row - begin_row) * row_bytes,
+          const_cast<char*>(stored_slice_tensor.tensor_data().data()));
+      if (status_.ok() && need_to_swap_bytes_) {
+        status_ = ByteSwapTensor(&stored_slice_tensor);
+      }
+      if (!status_.ok()) return status_;
+      read_slice.set_start(0, stored_begin + begin_row);
+      read_slice.set_length(0, end_row - begin_row);
+    } else {
+      stored_slice_tensor =
+          Tensor(stored_slice_entry.dtype(), stored_slice_shape);
+      status_ = GetValue(stored_slice_entry, &stored_slice_tensor);
+      if (!status_.ok()) return status_;
+    }
 
     // Copies the intersection over.
     const DataType common_dtype = full_tensor_entry.dtype();
@@ -1150,7 +1440,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 #define HANDLE_COPY(T)                                                 \
   case DataTypeToEnum<T>::value:                                       \
     CHECK(CopyDataFromTensorSliceToTensorSlice(                        \
-        full_shape, stored_slice, slice_spec,                          \
+        full_shape, read_slice, slice_spec,                            \
         stored_slice_tensor.flat<T>().data(), val->flat<T>().data())); \
     break;
 
@@ -72,6 +72,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/function_ref.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
@@ -200,8 +201,29 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
+  struct Options {
+    Options() {}
+    // If true, tensors of POD types whose stored bytes are suitably aligned
+    // and need no byte swapping are backed directly by read-only memory
+    // mapped regions of the data files, instead of being copied into a newly
+    // allocated buffer.  Other tensors, and data files on file systems that
+    // don't support memory mapping, are read as usual.
+    //
+    // In this mode Lookup() and ReadCurrent() replace the buffer of "val"
+    // rather than fill it.  The mapped tensors never share their buffer with
+    // kernels that update in place, and may outlive the reader.  The metadata
+    // table is mapped too, so that its blocks are searched in place instead
+    // of being read and copied on each lookup.
+    bool use_memory_mapped_files{false};
+    bool enable_multi_threading_for_testing{false};
+  };
+
+  // Memory mapping is enabled when the environment variable
+  // TF_BUNDLE_READER_USE_MMAP is true.
   BundleReader(Env* const env, absl::string_view prefix,
                bool enable_multi_threading_for_testing = false);
+  BundleReader(Env* const env, absl::string_view prefix,
+               const Options& options);
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -278,6 +300,19 @@ class BundleReader {
                      const TensorSlice& slice_spec,
                      Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the rows "rows", along the first dimension, of the tensor keyed
+  // by "key", and stores them in that order into "val", which is reallocated
+  // with shape [rows.size(), ...].  Only the bytes of those rows are read, from
+  // the mapped data file when memory mapping is enabled, so that sparsely
+  // accessed tables can be served from the bundle without holding them whole
+  // in memory.
+  //
+  // Only tensors of POD types that were saved in full are supported.  The
+  // stored checksum covers the whole tensor, so it is not validated.
+  // REQUIRES: status().ok()
+  Status LookupRows(absl::string_view key, absl::Span<const int64_t> rows,
+                    Tensor* val) TF_MUST_USE_RESULT;
+
   // Seeks to the first position in the bundle whose key is no less than "key".
   // REQUIRES: status().ok()
   void Seek(absl::string_view key) { return iter_->Seek(key); }
@@ -309,6 +344,34 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Points "val" at the memory mapped bytes described by "entry" and sets
+  // "*mapped" to true if the entry can be served from a mapped data file.
+  // Leaves "val" untouched and "*mapped" false otherwise.
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
+  // Reads the "size" bytes at "offset" within the data described by "entry"
+  // into "dst", from the mapped data file when memory mapping is enabled.
+  Status ReadEntryBytes(const BundleEntryProto& entry, int64_t offset,
+                        int64_t size, char* dst) TF_MUST_USE_RESULT;
+
+  // Reads each of "ranges", with offsets within the data described by
+  // "entry", into its scratch buffer.  The ranges are read concurrently when
+  // they are read from the data file.
+  Status ReadEntryRanges(const BundleEntryProto& entry,
+                         std::vector<RandomAccessFile::ReadRequest>* ranges)
+      TF_MUST_USE_RESULT;
+
+  // Returns the buffered data file of shard "shard_id", opening it on first
+  // use.
+  Status GetDataFile(int32_t shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
+  // Returns the memory mapped data file of shard "shard_id", mapping it on
+  // first use, or null if it can't be mapped.
+  const std::shared_ptr<ReadOnlyMemoryRegion>& GetMappedDataFile(
+      int32_t shard_id);
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -322,11 +385,18 @@ class BundleReader {
 
   Status status_;
   RandomAccessFile* metadata_;  // Owned.
+  // The mapped metadata file, if "use_memory_mapped_files_" and it could be
+  // mapped.
+  std::unique_ptr<ReadOnlyMemoryRegion> metadata_region_;
   table::Table* table_;
   table::Cache* index_cache_;
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
+  // Memory mapped data files, shared with the tensors that point into them.
+  // A null region means the shard could not be mapped.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -343,6 +413,7 @@ class BundleReader {
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   bool enable_multi_threading_for_testing_ = false;
+  bool use_memory_mapped_files_ = false;
 
   BundleReader(const BundleReader&) = delete;
   void operator=(const BundleReader&) = delete;
@@ -1148,6 +1148,126 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, MemoryMappedFiles) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add("foo_000", Constant_100x100<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<int8>(1)));
+    TF_EXPECT_OK(writer.Add("foo_002", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options opts;
+  opts.use_memory_mapped_files = true;
+  Tensor mapped;
+  {
+    BundleReader reader(Env::Default(), Prefix("foo"), opts);
+    TF_ASSERT_OK(reader.status());
+    Expect<float>(&reader, "foo_000", Constant_100x100<float>(0));
+    Expect<int8>(&reader, "foo_001", Constant_2x3<int8>(1));
+    Expect<tstring>(&reader, "foo_002", Constant_2x3<tstring>("foo"));
+
+    // Both lookups are backed by the same mapped bytes.
+    Tensor other;
+    TF_ASSERT_OK(reader.Lookup("foo_000", &mapped));
+    TF_ASSERT_OK(reader.Lookup("foo_000", &other));
+    EXPECT_EQ(mapped.tensor_data().data(), other.tensor_data().data());
+  }
+  // The mapping outlives the reader, and is never forwarded for in place
+  // updates.
+  test::ExpectTensorEqual<float>(mapped, Constant_100x100<float>(0));
+  EXPECT_FALSE(mapped.RefCountIsOne());
+}
+
+TEST(TensorBundleTest, MemoryMappedFilesUnaligned) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("foo"));
+    TF_EXPECT_OK(writer.Add("foo_000", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<double>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader::Options opts;
+  opts.use_memory_mapped_files = true;
+  BundleReader reader(Env::Default(), Prefix("foo"), opts);
+  TF_ASSERT_OK(reader.status());
+  // foo_001 is not aligned in the data file and is read as usual.
+  Expect<bool>(&reader, "foo_000", Constant(true, TensorShape({1})));
+  Expect<double>(&reader, "foo_001", Constant_2x3<double>(1));
+}
+
+TEST(TensorBundleTest, LookupRows) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("foo"), opts);
+    TF_EXPECT_OK(writer.Add(
+        "foo_000", test::AsTensor<int32>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11},
+                                         TensorShape({4, 3}))));
+    TF_EXPECT_OK(writer.Add("foo_001", Constant_2x3<tstring>("foo")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (bool use_memory_mapped_files : {false, true}) {
+    BundleReader::Options opts;
+    opts.use_memory_mapped_files = use_memory_mapped_files;
+    BundleReader reader(Env::Default(), Prefix("foo"), opts);
+    TF_ASSERT_OK(reader.status());
+
+    Tensor rows;
+    TF_ASSERT_OK(reader.LookupRows("foo_000", {3, 1, 2, 1}, &rows));
+    test::ExpectTensorEqual<int32>(
+        rows, test::AsTensor<int32>({9, 10, 11, 3, 4, 5, 6, 7, 8, 3, 4, 5},
+                                    TensorShape({4, 3})));
+    TF_ASSERT_OK(reader.LookupRows("foo_000", {}, &rows));
+    EXPECT_EQ(rows.shape(), TensorShape({0, 3}));
+
+    EXPECT_TRUE(
+        errors::IsInvalidArgument(reader.LookupRows("foo_000", {4}, &rows)));
+    EXPECT_TRUE(
+        errors::IsInvalidArgument(reader.LookupRows("foo_001", {0}, &rows)));
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupRows("bar", {0}, &rows)));
+  }
+}
+
+TEST(TensorBundleTest, LookupSliceReadsIntersectingRows) {
+  // A [6, 4] tensor saved in full, and in two slices of three rows.
+  const TensorShape kFullShape({6, 4});
+  Tensor full(DT_INT32, kFullShape);
+  test::FillFn<int32>(&full, [](int offset) { return offset; });
+  {
+    BundleWriter writer(Env::Default(), Prefix("resharded"));
+    TF_ASSERT_OK(writer.Add("full", full));
+    TF_ASSERT_OK(writer.AddSlice("sliced", kFullShape,
+                                 TensorSlice::ParseOrDie("0,3:-"),
+                                 full.Slice(0, 3)));
+    TF_ASSERT_OK(writer.AddSlice("sliced", kFullShape,
+                                 TensorSlice::ParseOrDie("3,3:-"),
+                                 full.Slice(3, 6)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (bool use_memory_mapped_files : {false, true}) {
+    BundleReader::Options opts;
+    opts.use_memory_mapped_files = use_memory_mapped_files;
+    BundleReader reader(Env::Default(), Prefix("resharded"), opts);
+    TF_ASSERT_OK(reader.status());
+    for (const string key : {"full", "sliced"}) {
+      // Rows 2 to 4, "cutting" both stored slices.
+      Tensor val(DT_INT32, TensorShape({3, 4}));
+      TF_ASSERT_OK(
+          reader.LookupSlice(key, TensorSlice::ParseOrDie("2,3:-"), &val));
+      test::ExpectTensorEqual<int32>(val, full.Slice(2, 5));
+
+      // Rows 1 to 4 of columns 1 and 2.
+      Tensor block(DT_INT32, TensorShape({4, 2}));
+      TF_ASSERT_OK(
+          reader.LookupSlice(key, TensorSlice::ParseOrDie("1,4:1,2"), &block));
+      test::ExpectTensorEqual<int32>(
+          block, test::AsTensor<int32>({5, 6, 9, 10, 13, 14, 17, 18},
+                                       TensorShape({4, 2})));
+    }
+  }
+}
+
 class TensorBundleAlignmentTest : public ::testing::Test {
  protected:
   template <typename T>
@@ -16,10 +16,15 @@ limitations under the License.
 #include "tensorflow/core/util/work_sharder.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <utility>
 
+#include "absl/container/node_hash_map.h"
 #include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tsl/profiler/lib/traceme.h"
 #include "tsl/util/env_var.h"
 
@@ -43,8 +48,103 @@ bool UseEigenParallelFor() {
   return result;
 }
 
+bool UseAdaptiveSharding() {
+  static bool result = []() {
+    bool result = true;
+    if (auto status = tsl::ReadBoolFromEnvVar("TF_WORK_SHARDER_ADAPTIVE",
+                                              /*default_val=*/true, &result);
+        status.ok()) {
+      return result;
+    }
+    return true;
+  }();
+  return result;
+}
+
+// The moving averages of the measured costs per unit of the adaptive Shard()
+// calls, keyed by call site and by the bucket of their total.
+//
+// The averages are atomics in stable nodes, so that only the first call with
+// a key takes the lock exclusively, to insert it.
+class AdaptiveCosts {
+ public:
+  using Key = std::pair<const char*, int>;
+  // Negative until the first measure.
+  using Cost = std::atomic<double>;
+
+  static AdaptiveCosts* Global() {
+    static AdaptiveCosts* costs = new AdaptiveCosts();
+    return costs;
+  }
+
+  static Key MakeKey(const char* call_site, int64_t total) {
+    return {call_site, Log2Floor64(total)};
+  }
+
+  int64_t Get(const Key& key) {
+    tf_shared_lock l(mu_);
+    auto it = costs_.find(key);
+    return it == costs_.end() ? -1 : Get(it->second);
+  }
+
+  static int64_t Get(const Cost& cost) {
+    const double average = cost.load(std::memory_order_relaxed);
+    return average < 0 ? -1 : static_cast<int64_t>(average);
+  }
+
+  // Returns the average of `key`, inserting it if needed. Entries are never
+  // erased, so the average can be updated without the lock.
+  Cost* FindOrInsert(const Key& key) {
+    {
+      tf_shared_lock l(mu_);
+      auto it = costs_.find(key);
+      if (it != costs_.end()) {
+        return &it->second;
+      }
+    }
+    mutex_lock l(mu_);
+    return &costs_.try_emplace(key, -1.0).first->second;
+  }
+
+  // Folds a measure into the average, weighing older measures by 3/4 so that
+  // a cost which changes, e.g. with the inputs, is followed in a few calls.
+  static void Update(Cost* cost, double cost_per_unit) {
+    double average = cost->load(std::memory_order_relaxed);
+    while (!cost->compare_exchange_weak(
+        average,
+        average < 0 ? cost_per_unit : 0.75 * average + 0.25 * cost_per_unit,
+        std::memory_order_relaxed)) {
+    }
+  }
+
+ private:
+  static int Log2Floor64(int64_t n) {
+    int log = 0;
+    while (n >>= 1) ++log;
+    return log;
+  }
+
+  mutex mu_;
+  absl::node_hash_map<Key, Cost> costs_ TF_GUARDED_BY(mu_);
+};
+
+/* ABSL_CONST_INIT */ thread_local const char* adaptive_call_site = nullptr;
+
 }  // namespace
 
+ScopedAdaptiveSharding::ScopedAdaptiveSharding(const char* call_site)
+    : previous_(adaptive_call_site) {
+  adaptive_call_site = call_site;
+}
+
+ScopedAdaptiveSharding::~ScopedAdaptiveSharding() {
+  adaptive_call_site = previous_;
+}
+
+int64_t GetAdaptiveCostPerUnit(const char* call_site, int64_t total) {
+  return AdaptiveCosts::Global()->Get(AdaptiveCosts::MakeKey(call_site, total));
+}
+
 /* ABSL_CONST_INIT */ thread_local int per_thread_max_parallelism = 1000000;
 
 void SetPerThreadMaxParallelism(int max_parallelism) {
@@ -54,12 +154,11 @@ void SetPerThreadMaxParallelism(int max_parallelism) {
 
 int GetPerThreadMaxParallelism() { return per_thread_max_parallelism; }
 
-void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
-           int64_t cost_per_unit, std::function<void(int64_t, int64_t)> work) {
-  CHECK_GE(total, 0);
-  if (total == 0) {
-    return;
-  }
+namespace {
+
+void ShardInternal(int max_parallelism, thread::ThreadPool* workers,
+                   int64_t total, int64_t cost_per_unit,
+                   const std::function<void(int64_t, int64_t)>& work) {
   max_parallelism = std::min(max_parallelism, GetPerThreadMaxParallelism());
   if (max_parallelism <= 1) {
     // Just inline the whole work since we only have 1 thread (core).
@@ -83,6 +182,40 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
       max_parallelism);
 }
 
+}  // namespace
+
+void Shard(int max_parallelism, thread::ThreadPool* workers, int64_t total,
+           int64_t cost_per_unit, std::function<void(int64_t, int64_t)> work) {
+  CHECK_GE(total, 0);
+  if (total == 0) {
+    return;
+  }
+  const char* call_site = adaptive_call_site;
+  if (call_site == nullptr || !UseAdaptiveSharding()) {
+    ShardInternal(max_parallelism, workers, total, cost_per_unit, work);
+    return;
+  }
+
+  // Shards with the measured cost if any, and measures the time spent in the
+  // shards of this call. The shards nested in `work` aren't adaptive.
+  AdaptiveCosts::Cost* cost = AdaptiveCosts::Global()->FindOrInsert(
+      AdaptiveCosts::MakeKey(call_site, total));
+  const int64_t measured_cost_per_unit = AdaptiveCosts::Get(*cost);
+  if (measured_cost_per_unit >= 0) {
+    cost_per_unit = measured_cost_per_unit;
+  }
+  std::atomic<int64_t> work_nanos(0);
+  ShardInternal(max_parallelism, workers, total, cost_per_unit,
+                [&work, &work_nanos](int64_t start, int64_t limit) {
+                  ScopedAdaptiveSharding nested(nullptr);
+                  const uint64 start_nanos = Env::Default()->NowNanos();
+                  work(start, limit);
+                  work_nanos.fetch_add(Env::Default()->NowNanos() - start_nanos,
+                                       std::memory_order_relaxed);
+                });
+  AdaptiveCosts::Update(cost, static_cast<double>(work_nanos.load()) / total);
+}
+
 // DEPRECATED: Prefer threadpool->ParallelFor with SchedulingStrategy, which
 // allows you to specify the strategy for choosing shard sizes, including using
 // a fixed shard size.
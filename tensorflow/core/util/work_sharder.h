@@ -84,6 +84,32 @@ class ScopedPerThreadMaxParallelism {
   int previous_ = -1;
 };
 
+// Opts the Shard() calls made by the current thread into adaptive sharding
+// while in scope, e.g. around a kernel's Compute(), without changing the calls.
+//
+// The calls are keyed by "call_site", typically the op type, and by the
+// power of two bucket of their "total". Shard() measures the time the units
+// of work of each call actually take, in nanoseconds, and the following calls
+// with the same key use a moving average of these measures instead of their
+// "cost_per_unit" estimate, so that stale estimates don't over-shard cheap
+// work or under-shard expensive work. Setting TF_WORK_SHARDER_ADAPTIVE=false
+// disables it.
+//
+// "call_site" is compared by address, and must outlive the scope: use a
+// string literal or a static string.
+class ScopedAdaptiveSharding {
+ public:
+  explicit ScopedAdaptiveSharding(const char* call_site);
+  ~ScopedAdaptiveSharding();
+
+ private:
+  const char* previous_;
+};
+
+// Returns the cost per unit measured for the Shard() calls of "call_site"
+// with "total" units of work, or -1 if none was measured.
+int64_t GetAdaptiveCostPerUnit(const char* call_site, int64_t total);
+
 // Implementation details for Shard().
 class Sharder {
  public:
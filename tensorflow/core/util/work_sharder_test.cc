@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/test.h"
@@ -93,6 +94,60 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(Shard, AdaptiveCostPerUnit) {
+  static constexpr char kCallSite[] = "AdaptiveCostPerUnit";
+  thread::ThreadPool threads(Env::Default(), "test", 4);
+  const int64_t total = 1000;
+  EXPECT_EQ(GetAdaptiveCostPerUnit(kCallSite, total), -1);
+  // Each unit takes about 10us, 10000 times more than estimated.
+  auto work = [](int64_t start, int64_t limit) {
+    Env::Default()->SleepForMicroseconds(10 * (limit - start));
+  };
+  Shard(4, &threads, total, /*cost_per_unit=*/1, work);
+  // Not measured outside of a ScopedAdaptiveSharding.
+  EXPECT_EQ(GetAdaptiveCostPerUnit(kCallSite, total), -1);
+  {
+    ScopedAdaptiveSharding adaptive(kCallSite);
+    Shard(4, &threads, total, /*cost_per_unit=*/1, work);
+  }
+  EXPECT_GE(GetAdaptiveCostPerUnit(kCallSite, total), 10000);
+  // The measure is shared by the totals of the same power of two bucket.
+  EXPECT_EQ(GetAdaptiveCostPerUnit(kCallSite, 600),
+            GetAdaptiveCostPerUnit(kCallSite, total));
+  EXPECT_EQ(GetAdaptiveCostPerUnit(kCallSite, 100), -1);
+
+  // The shards are sized from the measured cost.
+  std::atomic<int64_t> num_shards(0);
+  {
+    ScopedAdaptiveSharding adaptive(kCallSite);
+    Shard(4, &threads, total, /*cost_per_unit=*/1,
+          [&num_shards](int64_t start, int64_t limit) { ++num_shards; });
+  }
+  EXPECT_GT(num_shards, 1);
+}
+
+TEST(Shard, AdaptiveCostPerUnitConcurrentCalls) {
+  static constexpr char kCallSite[] = "AdaptiveCostPerUnitConcurrentCalls";
+  const int64_t total = 100;
+  {
+    thread::ThreadPool callers(Env::Default(), "callers", 8);
+    for (int i = 0; i < 8; ++i) {
+      callers.Schedule([total]() {
+        // Each unit takes at least 1us.
+        auto work = [](int64_t start, int64_t limit) {
+          Env::Default()->SleepForMicroseconds(limit - start);
+        };
+        for (int j = 0; j < 10; ++j) {
+          ScopedAdaptiveSharding adaptive(kCallSite);
+          Shard(/*max_parallelism=*/1, /*workers=*/nullptr, total,
+                /*cost_per_unit=*/1, work);
+        }
+      });
+    }
+  }
+  EXPECT_GE(GetAdaptiveCostPerUnit(kCallSite, total), 1000);
+}
+
 void BM_Sharding(::testing::benchmark::State& state) {
   const int arg = state.range(0);
 
@@ -1708,8 +1708,8 @@ void DTensorDevice::ModuleToExecutionFunctions(
   {
     profiler::TraceMe activity([&] { return "DTensorDevice::RunMLIRPasses"; },
                                profiler::TraceMeLevel::kInfo);
-    RETURN_C_STATUS_IF_NOT_OK(pass_runner_.Run(*lowering_context.module),
-                              status);
+    RETURN_C_STATUS_IF_NOT_OK(
+        pass_runner_.RunOrLoadFromCache(*lowering_context.module), status);
   }
   // Converts MLIR to GraphDef and merges to the global Graph.
   absl::flat_hash_set<Node*> control_ret_nodes;
@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/dtensor/cc/dtensor_graph_to_mlir_pass.h"
 
 #include <memory>
+#include <string>
 #include <utility>
 
+#include "absl/strings/str_cat.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/Builders.h"  // from @llvm-project
 #include "mlir/IR/BuiltinAttributes.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
@@ -26,6 +29,7 @@ limitations under the License.
 #include "mlir/IR/SymbolTable.h"  // from @llvm-project
 #include "mlir/IR/Types.h"  // from @llvm-project
 #include "mlir/InitAllExtensions.h"  // from @llvm-project
+#include "mlir/Parser/Parser.h"  // from @llvm-project
 #include "mlir/Support/LogicalResult.h"  // from @llvm-project
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/mlir/tensorflow/dialect_registration.h"
@@ -41,7 +45,11 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/dtensor/cc/constants.h"
 #include "tensorflow/dtensor/cc/dtensor_utils.h"
@@ -155,4 +163,63 @@ Status DTensorMlirPassRunner::Run(mlir::ModuleOp module) {
   return OkStatus();
 }
 
+Status DTensorMlirPassRunner::RunOrLoadFromCache(mlir::ModuleOp module) {
+  const std::string cache_dir = dtensor::SpmdExpansionCacheDir();
+  if (cache_dir.empty()) return Run(module);
+
+  // The imported module already carries the function body, the layouts of
+  // the inputs, the default mesh and the devices, so its fingerprint together
+  // with the TensorFlow version identifies the result of the pipeline.
+  std::string input;
+  llvm::raw_string_ostream input_os(input);
+  module.print(input_os);
+  input_os.flush();
+  const Fprint128 key = FingerprintCat128(Fingerprint128(input),
+                                         Fingerprint128(TF_VERSION_STRING));
+  const std::string path = io::JoinPath(
+      cache_dir, absl::StrCat(absl::Hex(key.high64, absl::kZeroPad16),
+                              absl::Hex(key.low64, absl::kZeroPad16), ".mlir"));
+
+  Env* env = Env::Default();
+  std::string cached;
+  if (env->FileExists(path).ok() &&
+      ReadFileToString(env, path, &cached).ok()) {
+    context_.loadDialect<mlir::dtensor::DTensorDialect>();
+    mlir::OwningOpRef<mlir::ModuleOp> cached_module =
+        mlir::parseSourceString<mlir::ModuleOp>(cached, &context_);
+    if (cached_module) {
+      VLOG(1) << "Loaded the DTensor SPMD expansion from " << path;
+      module->setAttrs(cached_module.get()->getAttrDictionary());
+      module.getBody()->clear();
+      module.getBody()->getOperations().splice(
+          module.getBody()->end(), cached_module->getBody()->getOperations());
+      return OkStatus();
+    }
+    LOG(WARNING) << "Ignoring the unparsable DTensor SPMD expansion " << path;
+  }
+
+  TF_RETURN_IF_ERROR(Run(module));
+
+  // Writes to a temporary file first, so that concurrent processes never read
+  // a partially written module.
+  std::string output;
+  llvm::raw_string_ostream output_os(output);
+  module.print(output_os);
+  output_os.flush();
+  std::string tmp_path = path;
+  Status write_status = env->RecursivelyCreateDir(cache_dir);
+  if (write_status.ok() && !env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    write_status = errors::Internal("Failed to create a temporary file name.");
+  }
+  if (write_status.ok()) {
+    write_status = WriteStringToFile(env, tmp_path, output);
+  }
+  if (write_status.ok()) write_status = env->RenameFile(tmp_path, path);
+  if (!write_status.ok()) {
+    LOG(WARNING) << "Failed to persist the DTensor SPMD expansion to " << path
+                 << ": " << write_status;
+  }
+  return OkStatus();
+}
+
 }  // namespace tensorflow
@@ -44,6 +44,12 @@ class DTensorMlirPassRunner {
   // Transforms input MLIR module with DTensor Pass pipeline.
   Status Run(mlir::ModuleOp module);
 
+  // Like Run, but when DTENSOR_SPMD_EXPANSION_CACHE_DIR is set, replaces the
+  // content of `module` with the transformed module persisted by a previous
+  // run of the same input module, possibly in another process. Otherwise runs
+  // the pipeline and persists its result.
+  Status RunOrLoadFromCache(mlir::ModuleOp module);
+
  private:
   // N.B. op_registration_ must be initialized before context/pass-manager to
   // ensure DTensor operations are available during optimization passes.
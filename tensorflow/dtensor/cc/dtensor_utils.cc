@@ -147,6 +147,16 @@ bool EnableAllToAllForRelayout() {
   return is_enabled;
 }
 
+bool EnableEarlyStartAllGather() {
+  static bool is_enabled = [] {
+    bool ret = true;
+    TF_CHECK_OK(tsl::ReadBoolFromEnvVar("DTENSOR_EARLY_START_ALL_GATHER",
+                                        /*default_val=*/true, &ret));
+    return ret;
+  }();
+  return is_enabled;
+}
+
 int AllReduceCombineOptimizationGroupSize() {
   char* group_size_str =
       std::getenv("DTENSOR_ALLREDUCE_COMBINE_OPTIMIZATION_GROUP_SIZE");
@@ -182,5 +192,11 @@ bool EnableMultiDeviceMode() {
       "DTENSOR_ENABLE_MULTI_DEVICE_EXPANSION", false, &multi_device_mode);
   return status.ok() && multi_device_mode;
 }
+
+std::string SpmdExpansionCacheDir() {
+  char* cache_dir_str = std::getenv("DTENSOR_SPMD_EXPANSION_CACHE_DIR");
+  if (cache_dir_str) return cache_dir_str;
+  return "";
+}
 }  // namespace dtensor
 }  // namespace tensorflow
@@ -66,6 +66,12 @@ bool EnableReplicatedSpmdAsDefault(const std::string& op_name);
 // Returns whether to use all-to-all collective for relayout when possible.
 bool EnableAllToAllForRelayout();
 
+// Returns whether to emit the collectives of a DTensorAllGather right after
+// its input is computed rather than right before its first consumer, so that
+// the communication of a relayout overlaps with the independent computation
+// scheduled in between.
+bool EnableEarlyStartAllGather();
+
 // Returns the maximum number of AllReduce ops to merge into a group. This value
 // determines the AllReduce grouping in dtensor_allreduce_combine_optimization.
 // The input value should be in range of [0, INT_MAX]. It is advised to pick
@@ -86,6 +92,10 @@ int AllReduceCombineOptimizationTopologicalDistance();
 
 // Returns whether to perform multi-device expansion.
 bool EnableMultiDeviceMode();
+
+// Returns the directory where the results of the DTensor SPMD expansion are
+// persisted across processes, or an empty string if they are not.
+std::string SpmdExpansionCacheDir();
 }  // namespace dtensor
 }  // namespace tensorflow
 
@@ -29,3 +29,25 @@ func.func @lower_allgather_gpu_mesh(%arg0: tensor<i32>,
   }) {_mesh = "GPU|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/task:0/device:GPU:0,/job:localhost/task:0/device:GPU:1,/job:localhost/task:0/device:GPU:2,/job:localhost/task:0/device:GPU:3"} : () -> tensor<2x4xf32>
   func.return %0 : tensor<2x4xf32>
 }
+
+// Check that the all-gather is started before the independent computation
+// preceding its consumer.
+// CHECK-LABEL: func @lower_allgather_starts_early
+func.func @lower_allgather_starts_early(%arg0: tensor<i32>,
+           %arg1: tensor<2x2xf32> {tf._layout = "sharding_specs:x,y, mesh:GPU|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/task:0/device:GPU:0,/job:localhost/task:0/device:GPU:1,/job:localhost/task:0/device:GPU:2,/job:localhost/task:0/device:GPU:3"},
+           %arg2: tensor<2x4xf32> {tf._layout = "sharding_specs:x,unsharded, mesh:GPU|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/task:0/device:GPU:0,/job:localhost/task:0/device:GPU:1,/job:localhost/task:0/device:GPU:2,/job:localhost/task:0/device:GPU:3"}) -> tensor<2x4xf32> {
+  // CHECK:      "tf_device.cluster"
+  // CHECK:      %[[NEG:.*]] = "tf.Neg"(%arg1)
+  // CHECK:      "tf.Transpose"(%[[NEG]]
+  // CHECK:      "tf.CollectiveGatherV2"
+  // CHECK:      "tf.Exp"(%arg2)
+  // CHECK:      "tf.AddV2"
+  %0 = "tf_device.cluster"() ({
+    %1 = "tf.Neg"(%arg1) : (tensor<2x2xf32>) -> tensor<2x2xf32>
+    %2 = "tf.Exp"(%arg2) : (tensor<2x4xf32>) -> tensor<2x4xf32>
+    %3 = "tf.DTensorAllGather"(%1) {input_layout = #dtensor.layout<sharding_specs:x,y, mesh:GPU|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/task:0/device:GPU:0,/job:localhost/task:0/device:GPU:1,/job:localhost/task:0/device:GPU:2,/job:localhost/task:0/device:GPU:3>, output_layout = #dtensor.layout<sharding_specs:x,unsharded, mesh:GPU|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/task:0/device:GPU:0,/job:localhost/task:0/device:GPU:1,/job:localhost/task:0/device:GPU:2,/job:localhost/task:0/device:GPU:3>} : (tensor<2x2xf32>) -> tensor<2x4xf32>
+    %4 = "tf.AddV2"(%2, %3) : (tensor<2x4xf32>, tensor<2x4xf32>) -> tensor<2x4xf32>
+    tf_device.return %4 : tensor<2x4xf32>
+  }) {_mesh = "GPU|x=2,y=2|0,1,2,3|0,1,2,3|/job:localhost/task:0/device:GPU:0,/job:localhost/task:0/device:GPU:1,/job:localhost/task:0/device:GPU:2,/job:localhost/task:0/device:GPU:3"} : () -> tensor<2x4xf32>
+  func.return %0 : tensor<2x4xf32>
+}
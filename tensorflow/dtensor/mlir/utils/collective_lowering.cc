@@ -739,12 +739,32 @@ StatusOr<const mlir::DenseIntElementsAttr> GetGroupAssignment(
   return group_assignment;
 }
 
+// Sets the insertion point of `builder` to where the lowering of `all_gather`
+// starts: right after its input is defined in the block of `all_gather` when
+// EnableEarlyStartAllGather, and right after `all_gather` otherwise. The
+// lowered ops only depend on the input, constants and the device id argument,
+// so they dominate every consumer of `all_gather` either way.
+void SetAllGatherInsertionPoint(mlir::TF::DTensorAllGatherOp all_gather,
+                                mlir::OpBuilder& builder) {
+  if (!EnableEarlyStartAllGather()) {
+    builder.setInsertionPointAfter(all_gather);
+    return;
+  }
+  mlir::Block* block = all_gather->getBlock();
+  mlir::Operation* input_op = all_gather.getInput().getDefiningOp();
+  if (input_op != nullptr && input_op->getBlock() == block) {
+    builder.setInsertionPointAfter(input_op);
+  } else {
+    builder.setInsertionPointToStart(block);
+  }
+}
+
 mlir::LogicalResult LowerAllGatherOpToCollective(
     mlir::TF::DTensorAllGatherOp all_gather) {
   const Layout src_layout = all_gather.getInputLayout();
   const Layout tgt_layout = all_gather.getOutputLayout();
   mlir::OpBuilder builder(all_gather);
-  builder.setInsertionPointAfter(all_gather);
+  SetAllGatherInsertionPoint(all_gather, builder);
 
   const mlir::Location loc = DT_LOC(all_gather.getLoc());
 
@@ -887,7 +907,7 @@ mlir::LogicalResult LowerAllGatherOp(mlir::TF::DTensorAllGatherOp all_gather) {
       concat_dims.push_back(i);
 
   mlir::OpBuilder builder(all_gather);
-  builder.setInsertionPointAfter(all_gather);
+  SetAllGatherInsertionPoint(all_gather, builder);
 
   if (concat_dims.empty()) {
     mlir::TF::IdentityOp identity = builder.create<mlir::TF::IdentityOp>(
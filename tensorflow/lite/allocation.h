@@ -97,6 +97,24 @@ class MMAPAllocation : public Allocation {
 
   static bool IsSupported();
 
+  /// Paging hints for a range of the mapped memory.
+  enum class Advice {
+    /// The range will be read soon, its pages are read ahead.
+    kWillNeed,
+    /// The range won't be read again soon, its pages are released. They are
+    /// read again from the file if the range is accessed anyway.
+    kDontNeed,
+    /// The pages of the range stay resident until the allocation is destroyed.
+    kLock,
+  };
+
+  /// Applies `advice` to the pages holding the `bytes` bytes at `data`, which
+  /// must be within the mapped memory. `kDontNeed` only applies to the pages
+  /// holding nothing else. Returns false if the range isn't mapped by this
+  /// allocation or the system rejects the advice, e.g. because of the limit
+  /// of locked memory.
+  bool Advise(const void* data, size_t bytes, Advice advice) const;
+
  protected:
   // Data required for mmap.
   int mmap_fd_ = -1;  // mmap file descriptor
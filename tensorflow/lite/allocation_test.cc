@@ -52,6 +52,30 @@ TEST(MMAPAllocation, TestValidFile) {
   EXPECT_NE(allocation.base(), nullptr);
 }
 
+TEST(MMAPAllocation, TestAdvise) {
+  if (!MMAPAllocation::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation(
+      "tensorflow/lite/testdata/empty_model.bin", &error_reporter);
+  ASSERT_TRUE(allocation.valid());
+
+  const char* data = static_cast<const char*>(allocation.base());
+  const std::string contents(data, allocation.bytes());
+  EXPECT_TRUE(allocation.Advise(data, allocation.bytes(),
+                                MMAPAllocation::Advice::kWillNeed));
+  EXPECT_TRUE(allocation.Advise(data, allocation.bytes(),
+                                MMAPAllocation::Advice::kDontNeed));
+  // Released pages are read again from the file.
+  EXPECT_EQ(std::string(data, allocation.bytes()), contents);
+
+  const char* past_the_end = data + allocation.bytes();
+  EXPECT_FALSE(allocation.Advise(past_the_end, 1,
+                                 MMAPAllocation::Advice::kWillNeed));
+}
+
 #if defined(__linux__)
 TEST(MMAPAllocation, TestInvalidFileDescriptor) {
   if (!MMAPAllocation::IsSupported()) {
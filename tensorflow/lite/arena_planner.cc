@@ -37,7 +37,7 @@ constexpr int32_t kScalarTensorBytes = 4;
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_all_tensors, int tensor_alignment,
-                           int subgraph_index)
+                           int subgraph_index, int max_cached_plans)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment, subgraph_index),
@@ -45,7 +45,8 @@ ArenaPlanner::ArenaPlanner(TfLiteContext* context,
       persistent_arena_(kDefaultArenaAlignment, subgraph_index),
       preserve_all_tensors_(preserve_all_tensors),
       tensor_alignment_(tensor_alignment),
-      last_active_node_(kLastActiveNodeUndefined) {}
+      last_active_node_(kLastActiveNodeUndefined),
+      max_cached_plans_(max_cached_plans) {}
 
 ArenaPlanner::~ArenaPlanner() {
   arena_.ReleaseBuffer();
@@ -201,6 +202,7 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   const size_t num_tensors = graph_info_->num_tensors();
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  cached_plans_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(num_tensors, kNodeNotAssigned);
   dealloc_node_.assign(num_tensors, kNodeNotAssigned);
@@ -489,12 +491,15 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
   tensors_allocated->reserve(tensors_to_allocate.size());
   // Deallocate if the tensor was already allocated.
   TfLiteTensor* tensors = graph_info_->tensors();
+  bool all_allocs_reset = true;
   for (const auto& tensor_index : tensors_to_allocate) {
     TfLiteTensor& tensor = tensors[tensor_index];
     // Only arena allocated tensors are allocated here.
     if (tensor.allocation_type == kTfLiteArenaRw) {
       if (allocs_[tensor_index].size < tensor.bytes) {
         tensors_allocated->push_back(tensor_index);
+      } else if (allocs_[tensor_index].size > 0) {
+        all_allocs_reset = false;
       }
     } else if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
       tensors_allocated->push_back(tensor_index);
@@ -505,14 +510,21 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
+  // A plan of all the tensors of the nodes up to `last_node` only depends on
+  // their sizes, so it can be cached.
+  bool use_plan_cache = false;
   if (first_node < last_active_node_) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
+    use_plan_cache = max_cached_plans_ > 0 && first_node == 0 &&
+                     all_allocs_reset;
   } else {
     // NOMUTANTS -- This function has no impact on the results, it only makes
     // exection faster.
     arena_.PurgeActiveAllocs(first_node);
   }
+  const bool plan_restored =
+      use_plan_cache && RestoreCachedPlan(last_node, *tensors_allocated);
   CreateTensorAllocationVector(tensors_allocated);
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
@@ -536,7 +548,7 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
         continue;
       }
     }
-    if (tensor.allocation_type == kTfLiteArenaRw) {
+    if (tensor.allocation_type == kTfLiteArenaRw && !plan_restored) {
       TF_LITE_ENSURE_STATUS(
           arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
                           tensor_index, alloc_node_[tensor_index],
@@ -555,10 +567,76 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
   }
+  if (use_plan_cache && !plan_restored) {
+    CachePlan(last_node);
+  }
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::RestoreCachedPlan(
+    int last_node, const std::vector<int32_t>& tensors_allocated) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  auto fits = [&](const CachedPlan& plan) {
+    if (plan.last_node != last_node) return false;
+    for (int32_t tensor_index : tensors_allocated) {
+      const TfLiteTensor& tensor = tensors[tensor_index];
+      if (tensor.allocation_type != kTfLiteArenaRw) continue;
+      auto it = plan.actual_tensor_id.find(tensor_index);
+      if (it != plan.actual_tensor_id.end()) {
+        // The tensor must still be able to share the buffer of its root.
+        if (tensors[it->second].allocation_type != kTfLiteArenaRw ||
+            tensors[it->second].bytes != tensor.bytes) {
+          return false;
+        }
+        continue;
+      }
+      if (tensor_index >= static_cast<int32_t>(plan.allocs.size())) {
+        return false;
+      }
+      const ArenaAllocWithUsageInterval& alloc = plan.allocs[tensor_index];
+      if (alloc.tensor != tensor_index || alloc.size < tensor.bytes ||
+          alloc.first_node != alloc_node_[tensor_index] ||
+          alloc.last_node != dealloc_node_[tensor_index]) {
+        return false;
+      }
+    }
+    return true;
+  };
+  auto plan = std::find_if(cached_plans_.begin(), cached_plans_.end(), fits);
+  if (plan == cached_plans_.end()) {
+    return false;
+  }
+  cached_plans_.splice(cached_plans_.begin(), cached_plans_, plan);
+
+  actual_tensor_id_ = plan->actual_tensor_id;
+  std::vector<ArenaAllocWithUsageInterval> allocs;
+  allocs.reserve(tensors_allocated.size());
+  for (int32_t tensor_index : tensors_allocated) {
+    if (tensors[tensor_index].allocation_type == kTfLiteArenaRw &&
+        actual_tensor_id_.count(tensor_index) == 0) {
+      allocs_[tensor_index] = plan->allocs[tensor_index];
+      allocs.push_back(allocs_[tensor_index]);
+    }
+  }
+  arena_.RestoreAllocs(std::move(allocs));
+  return true;
+}
+
+void ArenaPlanner::CachePlan(int last_node) {
+  if (static_cast<int>(cached_plans_.size()) >= max_cached_plans_) {
+    cached_plans_.pop_back();
+  }
+  CachedPlan plan{last_node, allocs_, actual_tensor_id_};
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  for (int i = 0; i < static_cast<int>(plan.allocs.size()); ++i) {
+    if (tensors[i].allocation_type != kTfLiteArenaRw) {
+      plan.allocs[i].reset();
+    }
+  }
+  cached_plans_.push_front(std::move(plan));
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -45,6 +46,11 @@ constexpr const int kDefaultArenaAlignment = 64;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// Resizing the inputs of the graph requires planning all the tensors again.
+// When `max_cached_plans` is positive, the latest plans are kept and reused as
+// long as the tensors fit in them, e.g. when the input sizes take a few
+// distinct values, or are never larger than those of a first plan.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -53,7 +59,7 @@ class ArenaPlanner : public MemoryPlanner {
   // of inference.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_all_tensors, int tensor_alignment,
-               int subgraph_index = 0);
+               int subgraph_index = 0, int max_cached_plans = 0);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -120,6 +126,23 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Allocations of the kTfLiteArenaRw tensors of the nodes up to `last_node`.
+  struct CachedPlan {
+    int last_node;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+    std::unordered_map<int32_t, int32_t> actual_tensor_id;
+  };
+
+  // Looks for a cached plan of the nodes up to `last_node` in which
+  // `tensors_allocated` fit, and if there is one, allocates the kTfLiteArenaRw
+  // tensors as in the plan. Returns whether a plan was found.
+  bool RestoreCachedPlan(int last_node,
+                         const std::vector<int32_t>& tensors_allocated);
+
+  // Caches the current allocations of the nodes up to `last_node`.
+  void CachePlan(int last_node);
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -166,6 +189,11 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Number of plans kept in `cached_plans_`, from the most to the least
+  // recently used.
+  int max_cached_plans_;
+  std::list<CachedPlan> cached_plans_;
 };
 
 }  // namespace tflite
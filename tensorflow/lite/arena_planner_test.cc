@@ -208,12 +208,14 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false) {
+  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false,
+                int max_cached_plans = 0) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_ = std::make_unique<ArenaPlanner>(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_all_tensors, kTensorAlignment);
+        preserve_all_tensors, kTensorAlignment, /*subgraph_index=*/0,
+        max_cached_plans);
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -370,6 +372,42 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, CachedPlansAreReusedWhenTensorsFit) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph, /*preserve_all_tensors=*/false, /*max_cached_plans=*/1);
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  tensors[5].bytes = 100;
+  Execute(0, graph.nodes().size() - 1);
+  const std::ptrdiff_t large_offset = GetOffset(4);
+  EXPECT_EQ(large_offset, GetOffsetAfter(5));
+
+  // A smaller tensor fits in the cached plan, which is used again.
+  ResetAllocations();
+  tensors[5].bytes = 18;
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(4), large_offset);
+
+  // A larger tensor doesn't fit, so the tensors are planned again.
+  ResetAllocations();
+  tensors[5].bytes = 200;
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  EXPECT_GT(GetOffset(4), large_offset);
+
+  // The new plan replaced the first one.
+  ResetAllocations();
+  tensors[5].bytes = 18;
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_GT(GetOffset(4), large_offset);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -148,6 +148,25 @@ TfLiteExecutionTask* AsyncSignatureRunner::CreateTask() {
   return task;
 }
 
+TfLiteStatus AsyncSignatureRunner::SetInputFromOutput(
+    TfLiteExecutionTask* task, const char* input_name,
+    TfLiteBufferHandle handle, const TfLiteExecutionTask* producer_task,
+    const char* output_name) {
+  TfLiteSynchronization* sync =
+      producer_task->task->GetSynchronization(kTfLiteIoTypeOutput, output_name);
+  if (sync == nullptr) {
+    subgraph_->ReportError("Output %s of the producer task has no sync object",
+                           output_name);
+    return kTfLiteError;
+  }
+  if (task->task->SetBufferHandle(kTfLiteIoTypeInput, input_name, handle) !=
+      kTfLiteOk) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  return task->task->SetSynchronization(kTfLiteIoTypeInput, input_name, sync);
+}
+
 TfLiteStatus AsyncSignatureRunner::InvokeAsync(TfLiteExecutionTask* task) {
   return async_subgraph_->InvokeAsync(task);
 }
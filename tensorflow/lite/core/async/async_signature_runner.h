@@ -133,6 +133,27 @@ class AsyncSignatureRunner {
   // The task must be released by calling `Finish`.
   TfLiteExecutionTask* CreateTask();
 
+  // Binds the input `input_name` of `task` to the output `output_name` of
+  // `producer_task`, which may come from the AsyncSignatureRunner of another
+  // interpreter, so that delegated models can be chained without copying the
+  // tensor through CPU memory.
+  // `handle` is the handle returned by `RegisterBuffer` of this runner for the
+  // buffer (e.g. AHardwareBuffer) that is bound to the producer's output.
+  // `task` also shares the sync object of the producer's output, so that the
+  // backend of `task` waits for the sync fence signaled by the producer's
+  // backend instead of the application waiting on the CPU. Must be called
+  // after the producer's output sync object is set, e.g. with
+  // `TfLiteExecutionTaskSetSync`, and `InvokeAsync(task)` must be called after
+  // `InvokeAsync(producer_task)`.
+  // `task` and `producer_task` should not be nullptr.
+  // Returns kTfLiteError if a tensor name is not found or the producer output
+  // has no sync object.
+  TfLiteStatus SetInputFromOutput(TfLiteExecutionTask* task,
+                                  const char* input_name,
+                                  TfLiteBufferHandle handle,
+                                  const TfLiteExecutionTask* producer_task,
+                                  const char* output_name);
+
   // Schedules an asynchronous execution with I/O information
   // provided in `task`.
   // `task` should not be nullptr.
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/lite/core/async/c/task.h"
 #include "tensorflow/lite/core/async/c/types.h"
 #include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
 #include "tensorflow/lite/core/async/testing/mock_async_kernel.h"
 #include "tensorflow/lite/core/async/testing/test_backend.h"
 #include "tensorflow/lite/core/c/c_api_opaque.h"
@@ -168,6 +169,34 @@ TEST_F(AsyncSignatureRunnerTest, ReconcileTest) {
   delete attrs;
 }
 
+TEST_F(AsyncSignatureRunnerTest, SetInputFromOutputTest) {
+  EXPECT_CALL(*kernel_, Finish(::testing::_, ::testing::_)).Times(2);
+
+  signature_runner_ = interpreter_->GetAsyncSignatureRunner("serving_default");
+  auto* producer_task = signature_runner_->CreateTask();
+  auto* task = signature_runner_->CreateTask();
+  TfLiteSynchronization* sync = TfLiteSynchronizationCreate();
+
+  // The producer output has no sync object yet.
+  EXPECT_EQ(kTfLiteError, signature_runner_->SetInputFromOutput(
+                              task, "input", 24, producer_task, "output"));
+
+  TfLiteExecutionTaskSetBuffer(producer_task, kTfLiteIoTypeOutput, "output",
+                               12);
+  TfLiteExecutionTaskSetSync(producer_task, kTfLiteIoTypeOutput, "output",
+                             sync);
+  EXPECT_EQ(kTfLiteError, signature_runner_->SetInputFromOutput(
+                              task, "foo", 24, producer_task, "output"));
+  EXPECT_EQ(kTfLiteOk, signature_runner_->SetInputFromOutput(
+                           task, "input", 24, producer_task, "output"));
+  EXPECT_EQ(24, TfLiteExecutionTaskGetBufferByIndex(task, 0));
+  EXPECT_EQ(sync, TfLiteExecutionTaskGetSyncByIndex(task, 0));
+
+  EXPECT_EQ(kTfLiteOk, signature_runner_->Finish(task));
+  EXPECT_EQ(kTfLiteOk, signature_runner_->Finish(producer_task));
+  TfLiteSynchronizationDelete(sync);
+}
+
 class AsyncSignatureRunnerNoSignatureDefTest : public AsyncSignatureRunnerTest {
  public:
   void SetUp() override { InitInterpreter(); }
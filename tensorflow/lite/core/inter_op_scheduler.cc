@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_scheduler.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+namespace {
+
+thread_local TfLiteExternalContext* current_cpu_backend_context = nullptr;
+
+}  // namespace
+
+InterOpScheduler::InterOpScheduler(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    cpu_backend_contexts_.push_back(
+        std::make_unique<ExternalCpuBackendContext>());
+  }
+  for (auto& cpu_backend_context : cpu_backend_contexts_) {
+    workers_.emplace_back(
+        [this, context = cpu_backend_context.get()] { WorkerLoop(context); });
+  }
+}
+
+InterOpScheduler::~InterOpScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_changed_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+TfLiteStatus InterOpScheduler::Run(
+    const std::vector<std::vector<int>>& dependents,
+    const std::vector<int>& num_dependencies,
+    const std::function<TfLiteStatus(int)>& run_node) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  dependents_ = &dependents;
+  run_node_ = &run_node;
+  remaining_dependencies_ = num_dependencies;
+  num_pending_ = remaining_dependencies_.size();
+  for (int i = 0; i < num_pending_; ++i) {
+    if (remaining_dependencies_[i] == 0) {
+      ready_.push_back(i);
+    }
+  }
+  num_running_ = 0;
+  status_ = kTfLiteOk;
+  work_changed_.notify_all();
+
+  while (!Done()) {
+    if (ready_.empty()) {
+      work_changed_.wait(lock);
+    } else {
+      RunReadyNode(lock);
+    }
+  }
+  dependents_ = nullptr;
+  run_node_ = nullptr;
+  return status_;
+}
+
+TfLiteExternalContext* InterOpScheduler::CurrentCpuBackendContext() {
+  return current_cpu_backend_context;
+}
+
+void InterOpScheduler::WorkerLoop(
+    ExternalCpuBackendContext* cpu_backend_context) {
+  current_cpu_backend_context = cpu_backend_context;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_changed_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+    if (stopping_) {
+      return;
+    }
+    RunReadyNode(lock);
+  }
+}
+
+void InterOpScheduler::RunReadyNode(std::unique_lock<std::mutex>& lock) {
+  const int node = ready_.front();
+  ready_.pop_front();
+  ++num_running_;
+  const std::function<TfLiteStatus(int)>& run_node = *run_node_;
+  lock.unlock();
+  const TfLiteStatus status = run_node(node);
+  lock.lock();
+
+  --num_running_;
+  --num_pending_;
+  if (status != kTfLiteOk) {
+    if (status_ == kTfLiteOk) {
+      status_ = status;
+    }
+    ready_.clear();
+  } else if (status_ == kTfLiteOk) {
+    for (const int dependent : (*dependents_)[node]) {
+      if (--remaining_dependencies_[dependent] == 0) {
+        ready_.push_back(dependent);
+      }
+    }
+  }
+  work_changed_.notify_all();
+}
+
+}  // namespace tflite
@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_SCHEDULER_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_SCHEDULER_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// Runs the nodes of a dependency graph on a fixed set of threads, each node
+// once all the nodes it depends on have run.
+//
+// Each worker thread has its own CPU backend context, which kernels running on
+// that thread should use instead of the one of the interpreter, since the CPU
+// backend contexts are not thread-safe. See `CurrentCpuBackendContext`.
+//
+// WARNING: This is an experimental API and subject to change.
+class InterOpScheduler {
+ public:
+  // `num_threads` includes the thread calling `Run`, which runs nodes too.
+  explicit InterOpScheduler(int num_threads);
+  ~InterOpScheduler();
+
+  InterOpScheduler(const InterOpScheduler&) = delete;
+  InterOpScheduler& operator=(const InterOpScheduler&) = delete;
+
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls `run_node(i)` for each node `i` of the graph, whose nodes are
+  // 0..num_dependencies.size()-1. Node `i` waits for `num_dependencies[i]`
+  // nodes to run, namely the nodes `j` such that `dependents[j]` contains `i`.
+  // Once a node fails, no new node is started and the first failure is
+  // returned after the running nodes are done.
+  TfLiteStatus Run(const std::vector<std::vector<int>>& dependents,
+                   const std::vector<int>& num_dependencies,
+                   const std::function<TfLiteStatus(int)>& run_node);
+
+  // Returns the CPU backend context of the worker thread calling this, or
+  // nullptr if it's not called from a worker thread of any scheduler.
+  static TfLiteExternalContext* CurrentCpuBackendContext();
+
+ private:
+  void WorkerLoop(ExternalCpuBackendContext* cpu_backend_context);
+
+  // Pops and runs a ready node. `lock` holds `mutex_` and is held again on
+  // return, but not while the node runs.
+  void RunReadyNode(std::unique_lock<std::mutex>& lock);
+
+  // Whether the current graph has no more nodes to run, nor running nodes.
+  bool Done() const {
+    return num_pending_ == 0 || (status_ != kTfLiteOk && num_running_ == 0);
+  }
+
+  std::mutex mutex_;
+  std::condition_variable work_changed_;
+  bool stopping_ = false;
+
+  // State of the graph being run, guarded by `mutex_`.
+  const std::vector<std::vector<int>>* dependents_ = nullptr;
+  const std::function<TfLiteStatus(int)>* run_node_ = nullptr;
+  std::vector<int> remaining_dependencies_;
+  std::deque<int> ready_;
+  int num_pending_ = 0;
+  int num_running_ = 0;
+  TfLiteStatus status_ = kTfLiteOk;
+
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>> cpu_backend_contexts_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_SCHEDULER_H_
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/tensor_utils.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_scheduler.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -615,6 +616,14 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  // Kernels running on an inter-op thread use the CPU backend context of that
+  // thread, since the one of the interpreter may be in use concurrently.
+  if (type == kTfLiteCpuBackendContext) {
+    if (TfLiteExternalContext* context =
+            InterOpScheduler::CurrentCpuBackendContext()) {
+      return context;
+    }
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1523,7 +1532,7 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #else
     memory_planner_ = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
-        kDefaultTensorAlignment, subgraph_index_);
+        kDefaultTensorAlignment, subgraph_index_, MaxCachedArenaPlans());
 #endif
     memory_planner_->PlanAllocations();
   }
@@ -1602,6 +1611,17 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  if (AdviseModelPaging() && model_paging_execution_plan_ != execution_plan_) {
+    AdviseModelPagingForExecutionPlan();
+  }
+  if (NumInterOpThreads() > 1 && PrepareNodesForParallelInvoke()) {
+    status = InvokeNodesInParallel();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1723,6 +1743,201 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+bool Subgraph::PrepareNodesForParallelInvoke() {
+  if (has_dynamic_tensors_ || profiler_ ||
+      next_execution_plan_index_to_prepare_ <
+          static_cast<int>(execution_plan_.size())) {
+    return false;
+  }
+  std::vector<std::pair<const char*, size_t>> tensor_memory;
+  tensor_memory.reserve(tensors_.size());
+  for (const TfLiteTensor& tensor : tensors_) {
+    if (tensor.delegate != nullptr ||
+        tensor.allocation_type == kTfLiteDynamic) {
+      return false;
+    }
+    tensor_memory.emplace_back(tensor.data.raw_const, tensor.bytes);
+  }
+  if (execution_plan_ == inter_op_execution_plan_ &&
+      tensor_memory == inter_op_tensor_memory_) {
+    return inter_op_plan_is_runnable_;
+  }
+  inter_op_execution_plan_ = execution_plan_;
+  inter_op_tensor_memory_ = std::move(tensor_memory);
+
+  // The memory accessed by each node. Nodes can be reordered as long as none
+  // of them writes the memory accessed by the other one, which also covers
+  // the tensors sharing arena memory across their lifetimes.
+  struct MemoryAccess {
+    const char* begin;
+    const char* end;
+    bool is_write;
+  };
+  const int num_nodes = execution_plan_.size();
+  std::vector<std::vector<MemoryAccess>> accesses(num_nodes);
+  std::vector<bool> runs_alone(num_nodes);
+  inter_op_plan_is_runnable_ = true;
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[execution_plan_[i]].second;
+    // Delegate kernels and control flow ops may share state across nodes.
+    runs_alone[i] = node.delegate != nullptr ||
+                    registration.builtin_code == kTfLiteBuiltinIf ||
+                    registration.builtin_code == kTfLiteBuiltinWhile ||
+                    registration.builtin_code == kTfLiteBuiltinCallOnce ||
+                    registration.builtin_code == kTfLiteBuiltinStablehloWhile;
+    auto add_accesses = [&](const TfLiteIntArray* tensor_indices,
+                            bool is_write) {
+      if (tensor_indices == nullptr) return;
+      for (const int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        const TfLiteTensor& tensor = tensors_[tensor_index];
+        // Resources and variants refer to state outside of the tensor.
+        if (tensor.type == kTfLiteResource || tensor.type == kTfLiteVariant) {
+          runs_alone[i] = true;
+        }
+        if (tensor.bytes == 0) continue;
+        if (tensor.data.raw == nullptr) {
+          // Leave the error, or the exception of reshape, to the sequential
+          // Invoke.
+          inter_op_plan_is_runnable_ = false;
+          continue;
+        }
+        accesses[i].push_back({tensor.data.raw_const,
+                               tensor.data.raw_const + tensor.bytes,
+                               is_write || tensor.is_variable});
+      }
+    };
+    add_accesses(node.inputs, /*is_write=*/false);
+    add_accesses(node.outputs, /*is_write=*/true);
+    add_accesses(node.intermediates, /*is_write=*/true);
+    add_accesses(node.temporaries, /*is_write=*/true);
+  }
+
+  auto conflict = [&](int i, int j) {
+    if (runs_alone[i] || runs_alone[j]) return true;
+    for (const MemoryAccess& a : accesses[i]) {
+      for (const MemoryAccess& b : accesses[j]) {
+        if ((a.is_write || b.is_write) && a.begin < b.end && b.begin < a.end) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+  inter_op_dependents_.assign(num_nodes, {});
+  inter_op_num_dependencies_.assign(num_nodes, 0);
+  auto add_dependency = [this](int from, int to) {
+    inter_op_dependents_[from].push_back(to);
+    ++inter_op_num_dependencies_[to];
+  };
+  for (int j = 0; j < num_nodes; ++j) {
+    for (int i = 0; i < j; ++i) {
+      if (conflict(i, j)) add_dependency(i, j);
+    }
+  }
+  if (control_edges_ != nullptr) {
+    const int num_all_nodes = nodes_and_registration_.size();
+    std::vector<int> plan_index(num_all_nodes, -1);
+    for (int i = 0; i < num_nodes; ++i) {
+      plan_index[execution_plan_[i]] = i;
+    }
+    for (const ControlEdge& edge : *control_edges_) {
+      if (edge.first < 0 || edge.first >= num_all_nodes || edge.second < 0 ||
+          edge.second >= num_all_nodes) {
+        continue;
+      }
+      const int from = plan_index[edge.first];
+      const int to = plan_index[edge.second];
+      if (from >= 0 && to > from) add_dependency(from, to);
+    }
+  }
+  return inter_op_plan_is_runnable_;
+}
+
+TfLiteStatus Subgraph::InvokeNodesInParallel() {
+  if (!inter_op_scheduler_ ||
+      inter_op_scheduler_->num_threads() != NumInterOpThreads()) {
+    inter_op_scheduler_ =
+        std::make_unique<InterOpScheduler>(NumInterOpThreads());
+  }
+  EnsureTensorsVectorCapacity();
+  tensor_resized_since_op_invoke_ = false;
+  return inter_op_scheduler_->Run(
+      inter_op_dependents_, inter_op_num_dependencies_,
+      [this](int execution_plan_index) {
+        const int node_index = execution_plan_[execution_plan_index];
+        TfLiteNode& node = nodes_and_registration_[node_index].first;
+        const TfLiteRegistration& registration =
+            nodes_and_registration_[node_index].second;
+        if (IsCancelled()) {
+          ReportError("Client requested cancel during Invoke()");
+          return kTfLiteError;
+        }
+        if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+          // `Cancel` is called and cancellation flag is flipped.
+          ReportError("Client requested cancel during Invoke()");
+          return kTfLiteCancelled;
+        }
+        if (auto s = OpInvoke(registration, &node); s != kTfLiteOk) {
+          auto err = ReportOpError(&context_, node, registration, node_index,
+                                   "failed to invoke");
+          return s == kTfLiteCancelled ? s : err;
+        }
+        return kTfLiteOk;
+      });
+}
+
+void Subgraph::AdviseModelPagingForExecutionPlan() {
+  model_paging_execution_plan_ = execution_plan_;
+  if (allocation_ == nullptr ||
+      allocation_->type() != Allocation::Type::kMMap) {
+    return;
+  }
+  const MMAPAllocation* mmap_allocation =
+      static_cast<const MMAPAllocation*>(allocation_);
+
+  // Constant tensors read by CPU kernels, and by delegate kernels only.
+  std::vector<bool> read_by_cpu(tensors_.size());
+  std::vector<bool> read_by_delegate(tensors_.size());
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor ||
+          tensors_[tensor_index].allocation_type != kTfLiteMmapRo) {
+        continue;
+      }
+      if (node.delegate != nullptr) {
+        read_by_delegate[tensor_index] = true;
+      } else {
+        read_by_cpu[tensor_index] = true;
+      }
+    }
+  }
+
+  bool locked = true;
+  for (size_t i = 0; i < tensors_.size(); ++i) {
+    const TfLiteTensor& tensor = tensors_[i];
+    if (read_by_cpu[i]) {
+      mmap_allocation->Advise(tensor.data.raw_const, tensor.bytes,
+                              MMAPAllocation::Advice::kWillNeed);
+      if (LockHotModelWeights() && locked) {
+        locked = mmap_allocation->Advise(tensor.data.raw_const, tensor.bytes,
+                                         MMAPAllocation::Advice::kLock);
+        if (!locked) {
+          TFLITE_LOG_PROD(TFLITE_LOG_WARNING,
+                          "Failed to lock the weights of the model in memory, "
+                          "the remaining ones stay unlocked.");
+        }
+      }
+    } else if (read_by_delegate[i]) {
+      mmap_allocation->Advise(tensor.data.raw_const, tensor.bytes,
+                              MMAPAllocation::Advice::kDontNeed);
+    }
+  }
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
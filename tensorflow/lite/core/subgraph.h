@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/inter_op_scheduler.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
@@ -474,6 +475,33 @@ class Subgraph {
     return (options_ && options_->GetDisableDelegateClustering());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Number of memory plans kept by the arena planner for reuse after the inputs
+  // are resized.
+  int MaxCachedArenaPlans() const {
+    return options_ ? options_->GetMaxCachedArenaPlans() : 0;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads running independent nodes concurrently in Invoke.
+  int NumInterOpThreads() const {
+    return options_ ? options_->GetNumInterOpThreads() : 1;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // If true, the first Invoke gives paging hints for the constant tensors of a
+  // memory mapped model.
+  bool AdviseModelPaging() const {
+    return (options_ && options_->GetAdviseModelPaging());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // If true, the constant tensors read by the CPU kernels are locked in memory
+  // along with the paging hints.
+  bool LockHotModelWeights() const {
+    return (options_ && options_->GetLockHotModelWeights());
+  }
+
   // Retrieves the corresponding TfLiteContext of a subgraph given a subgraph
   // index and switches to the delegate context for this subgraph. If an invalid
   // subgraph index is given, returns kTfLiteError.
@@ -876,6 +904,18 @@ class Subgraph {
   // Ensures the memory required is planned and allocated.
   TfLiteStatus EnsureMemoryAllocations();
 
+  // Returns true if `InvokeNodesInParallel` can run the execution plan, and
+  // computes the dependencies between its nodes if they are out of date.
+  bool PrepareNodesForParallelInvoke();
+
+  // Runs the execution plan on `inter_op_scheduler_`, each node after the
+  // nodes it depends on.
+  TfLiteStatus InvokeNodesInParallel();
+
+  // Gives paging hints for the constant tensors of `allocation_` once per
+  // execution plan, see `InterpreterOptions::SetAdviseModelPaging`.
+  void AdviseModelPagingForExecutionPlan();
+
   // Enables cancellation of in flight invocation with `Cancel` call.
   // Should only be called by the interpreter when building the subgraph.
   // `flag` should be nullptr otherwise cancellation is disabled.
@@ -1046,6 +1086,25 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Runs the nodes in `InvokeNodesInParallel`, created on first use.
+  std::unique_ptr<InterOpScheduler> inter_op_scheduler_;
+
+  // The dependencies between the nodes of the execution plan, by index in the
+  // plan, for `InvokeNodesInParallel`. They are valid as long as the execution
+  // plan and the memory of the tensors match `inter_op_execution_plan_` and
+  // `inter_op_tensor_memory_`.
+  std::vector<std::vector<int>> inter_op_dependents_;
+  std::vector<int> inter_op_num_dependencies_;
+  std::vector<int> inter_op_execution_plan_;
+  std::vector<std::pair<const char*, size_t>> inter_op_tensor_memory_;
+  // False if a node of the plan lacks input data and needs the checks of the
+  // sequential Invoke.
+  bool inter_op_plan_is_runnable_ = false;
+
+  // The execution plan `AdviseModelPagingForExecutionPlan` last gave paging
+  // hints for.
+  std::vector<int> model_paging_execution_plan_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <numeric>
 #include <vector>
 
@@ -26,6 +29,7 @@ limitations under the License.
 #include <gtest/gtest.h>
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/util.h"
 
@@ -331,5 +335,79 @@ TEST_F(SubgraphResizeTensorTest,
   std::fill_n(tensor_.dims->data, tensor_.dims->size, 1);
 }
 
+
+// Counts the nodes of `RendezvousNegRegistration` that started to run.
+struct Rendezvous {
+  std::mutex mutex;
+  std::condition_variable arrived;
+  int num_arrived = 0;
+};
+
+Rendezvous* GetRendezvous() {
+  static Rendezvous* rendezvous = new Rendezvous();
+  return rendezvous;
+}
+
+// Negates its input once two nodes of this op are running, and fails if that
+// doesn't happen within a few seconds.
+TfLiteRegistration RendezvousNegRegistration() {
+  TfLiteRegistration registration{};
+  registration.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input.dims));
+  };
+  registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    Rendezvous& rendezvous = *GetRendezvous();
+    {
+      std::unique_lock<std::mutex> lock(rendezvous.mutex);
+      ++rendezvous.num_arrived;
+      rendezvous.arrived.notify_all();
+      if (!rendezvous.arrived.wait_for(lock, std::chrono::seconds(10), [&] {
+            return rendezvous.num_arrived >= 2;
+          })) {
+        return kTfLiteError;
+      }
+    }
+    const TfLiteTensor& input = context->tensors[node->inputs->data[0]];
+    TfLiteTensor& output = context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < input.bytes / sizeof(float); ++i) {
+      output.data.f[i] = -input.data.f[i];
+    }
+    return kTfLiteOk;
+  };
+  return registration;
+}
+
+TEST(InterOpParallelismTest, RunsIndependentNodesConcurrently) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetNumInterOpThreads(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(4);
+  subgraph.SetInputs({0, 1});
+  subgraph.SetOutputs({2, 3});
+  for (int i = 0; i < 4; ++i) {
+    subgraph.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                          TfLiteQuantization());
+  }
+  TfLiteRegistration neg_op = RendezvousNegRegistration();
+  subgraph.AddNodeWithParameters({0}, {2}, {}, nullptr, 0, nullptr, &neg_op);
+  subgraph.AddNodeWithParameters({1}, {3}, {}, nullptr, 0, nullptr, &neg_op);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+
+  subgraph.tensor(0)->data.f[0] = 1;
+  subgraph.tensor(0)->data.f[1] = 2;
+  subgraph.tensor(1)->data.f[0] = 3;
+  subgraph.tensor(1)->data.f[1] = 4;
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  EXPECT_EQ(subgraph.tensor(2)->data.f[0], -1);
+  EXPECT_EQ(subgraph.tensor(2)->data.f[1], -2);
+  EXPECT_EQ(subgraph.tensor(3)->data.f[0], -3);
+  EXPECT_EQ(subgraph.tensor(3)->data.f[1], -4);
+}
+
 }  // namespace
 }  // namespace tflite
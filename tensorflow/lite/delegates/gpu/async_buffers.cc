@@ -101,5 +101,13 @@ absl::Status AsyncBuffer::GetOpenGlBuffer(GLuint& buffer_ref) {
   return absl::OkStatus();
 }
 
+void AsyncBuffer::DeleteOpenGlBuffer() {
+  if (opengl_buffer_ != GL_INVALID_INDEX) {
+    glDeleteBuffers(1, &opengl_buffer_);
+    opengl_buffer_ = GL_INVALID_INDEX;
+  }
+  valid_ = false;
+}
+
 }  // namespace gpu
 }  // namespace tflite
@@ -50,6 +50,9 @@ class AsyncBuffer {
   }
   // Map the AHWB (from class constructor) to an SSBO id
   absl::Status GetOpenGlBuffer(GLuint& buffer_ref);
+  // Delete the SSBO, if any. Must be called with the EGL context that
+  // created it.
+  void DeleteOpenGlBuffer();
 };
 
 }  // namespace gpu
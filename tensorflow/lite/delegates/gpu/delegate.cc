@@ -25,7 +25,9 @@ limitations under the License.
 #endif
 
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
@@ -118,6 +120,12 @@ using delegates::Serialization;
 using delegates::SerializationParams;
 
 constexpr char kSerializedDataPrefix[] = "gpuv2_data_";
+constexpr char kSerializedProgramsPrefix[] = "gpuv2_programs_";
+// Namespace of the program cache entries of delegates without a model token.
+constexpr char kProgramCacheToken[] = "gpuv2_program_cache";
+// Upper bound of the programs cached in `serialization_dir` without a model
+// token, the least recently used entries are evicted past it.
+constexpr size_t kMaxProgramCacheSize = 64 << 20;
 
 #if defined(__ANDROID__)
 // Xeno API does not impose alignment or padding requirements.
@@ -183,11 +191,23 @@ class Delegate {
       serialization_ = std::make_unique<Serialization>(params);
       telemetry_settings_ =
           std::make_unique<TfLiteTelemetryGpuDelegateSettings>();
+    } else if (options_.experimental_flags &
+                   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION &&
+               options_.serialization_dir) {
+      // Without a model token only the compiled programs are cached, since
+      // the model heuristic key of an entry may collide across models.
+      SerializationParams params;
+      params.model_token = kProgramCacheToken;
+      params.cache_dir = options_.serialization_dir;
+      params.max_cache_size = kMaxProgramCacheSize;
+      params.checksum = true;
+      program_cache_ = std::make_unique<Serialization>(params);
     }
   }
 
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
+  Serialization* program_cache() { return program_cache_.get(); }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
   bool async() const { return async_; }
 
@@ -209,6 +229,8 @@ class Delegate {
   std::atomic<int> num_delegate_kernels_ = 0;
 
   std::unique_ptr<Serialization> serialization_;
+  // Caches the OpenCL program binaries when there is no model token.
+  std::unique_ptr<Serialization> program_cache_;
 
   std::unique_ptr<TfLiteTelemetryGpuDelegateSettings> telemetry_settings_;
 
@@ -478,11 +500,44 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
 
   if (!serialization) {
     // This path is faster when there is no serialization involved.
+    Serialization* program_cache = delegate_->program_cache();
+    const std::string programs_key =
+        std::string(kSerializedProgramsPrefix) +
+        delegates::StrFingerprint(&options, sizeof(options));
+    std::string cached_programs;
+    if (program_cache) {
+      auto entry = program_cache->GetEntryForKernel(programs_key, context,
+                                                    delegate_params);
+      if (entry.GetData(context, &cached_programs) != kTfLiteOk) {
+        cached_programs.clear();
+      }
+      // Programs that don't match the driver are recompiled, replacing them.
+      env_options.serialized_binary_cache = absl::Span<const uint8_t>(
+          reinterpret_cast<const uint8_t*>(cached_programs.data()),
+          cached_programs.size());
+    }
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
                                                 &properties));
     *graph_is_destroyed = true;
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
+    if (program_cache) {
+      const std::vector<uint8_t> programs =
+          cl_environment_->GetSerializedBinaryCache();
+      if (!programs.empty() &&
+          (programs.size() != cached_programs.size() ||
+           std::memcmp(programs.data(), cached_programs.data(),
+                       programs.size()) != 0)) {
+        auto entry = program_cache->GetEntryForKernel(programs_key, context,
+                                                      delegate_params);
+        if (entry.SetData(context,
+                          reinterpret_cast<const char*>(programs.data()),
+                          programs.size()) != kTfLiteOk) {
+          TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                          "Failed to cache the OpenCL programs.");
+        }
+      }
+    }
   } else {
     // If serialization data is found, initialize CL from it & return early.
     if (MaybeInitializeSerializedOpenCL(context, delegate_params, builder,
@@ -762,6 +817,12 @@ class DelegateAsyncKernel : public BackendAsyncKernelInterface {
   TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node,
                         TfLiteExecutionTask* task);
 
+  // Returns the SSBO mapped to the buffer `handle`, mapping it on first use.
+  absl::Status GetOpenGlBuffer(TfLiteBufferHandle handle,
+                               const TensorObjectDef& tensor_def,
+                               OpenGlBuffer& buffer)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(eval_mutex_);
+
   using UniquePtrAHardwareBuffer =
       std::unique_ptr<AHardwareBuffer, void (*)(AHardwareBuffer*)>;
   static UniquePtrAHardwareBuffer Acquire(AHardwareBuffer* ahwb) {
@@ -813,6 +874,18 @@ class DelegateAsyncKernel : public BackendAsyncKernelInterface {
   absl::flat_hash_map<TfLiteBufferHandle, UniquePtrAHardwareBuffer>
       buffer_by_handle_ ABSL_GUARDED_BY(eval_mutex_);
   std::vector<SyncType> output_sync_types_ ABSL_GUARDED_BY(eval_mutex_);
+
+  // The SSBOs mapped to the registered buffers, kept across evaluations so
+  // that buffers bound to every invocation (e.g. camera frames or the outputs
+  // of another model) are only imported once. They belong to the EGL context
+  // `async_buffers_context_`.
+  absl::flat_hash_map<TfLiteBufferHandle, AsyncBuffer> async_buffer_by_handle_
+      ABSL_GUARDED_BY(eval_mutex_);
+  EGLContext async_buffers_context_ ABSL_GUARDED_BY(eval_mutex_) =
+      EGL_NO_CONTEXT;
+  // Created by the first evaluation on a thread without a current EGL context.
+  std::unique_ptr<gl::EglEnvironment> egl_environment_
+      ABSL_GUARDED_BY(eval_mutex_);
 };
 
 absl::Status DelegateAsyncKernel::Init(TfLiteContext* context,
@@ -1111,6 +1184,14 @@ TfLiteStatus DelegateAsyncKernel::UnregisterBufferImpl(
   auto it = buffer_by_handle_.find(handle);
   TFLITE_RET_CHECK_STATUS(it != buffer_by_handle_.end(),
                           "UnregisterBuffer called with unknown handle");
+  if (auto async_it = async_buffer_by_handle_.find(handle);
+      async_it != async_buffer_by_handle_.end()) {
+    // Otherwise, the SSBO is released with its context.
+    if (eglGetCurrentContext() == async_buffers_context_) {
+      async_it->second.DeleteOpenGlBuffer();
+    }
+    async_buffer_by_handle_.erase(async_it);
+  }
   buffer_by_handle_.erase(it);
   return kTfLiteOk;
 }
@@ -1127,6 +1208,18 @@ TfLiteStatus DelegateAsyncKernel::Eval(TfLiteOpaqueContext* opaque_context,
   return EvalImpl(context, node, task);
 }
 
+absl::Status DelegateAsyncKernel::GetOpenGlBuffer(
+    TfLiteBufferHandle handle, const TensorObjectDef& tensor_def,
+    OpenGlBuffer& buffer) {
+  auto it = async_buffer_by_handle_.find(handle);
+  if (it == async_buffer_by_handle_.end()) {
+    AHardwareBuffer* ahwb = buffer_by_handle_.at(handle).get();
+    it = async_buffer_by_handle_.emplace(handle, AsyncBuffer(tensor_def, ahwb))
+             .first;
+  }
+  return it->second.GetOpenGlBuffer(buffer.id);
+}
+
 TfLiteStatus DelegateAsyncKernel::EvalImpl(TfLiteContext* context,
                                            TfLiteNode* node,
                                            TfLiteExecutionTask* task) {
@@ -1141,6 +1234,21 @@ TfLiteStatus DelegateAsyncKernel::EvalImpl(TfLiteContext* context,
   TFLITE_RET_CHECK_STATUS(TFLITE_AHWB_AVAILABLE(),
                           "calling tflite::gpu::DelegateAsyncKernel::Eval on "
                           "device without AHardwareBuffer support");
+  absl::MutexLock eval_lock(&eval_mutex_);
+
+  // Needed for cl inference. For gl it re-uses the existing context. The
+  // context must be current before waiting on the input fences, since the
+  // waits are queued on it rather than blocking the CPU.
+  if (eglGetCurrentContext() == EGL_NO_CONTEXT) {
+    TFLITE_RETURN_IF_ABSL_ERROR(
+        gl::EglEnvironment::NewEglEnvironment(&egl_environment_));
+  }
+  if (eglGetCurrentContext() != async_buffers_context_) {
+    // The SSBOs of another context can't be used in this one.
+    async_buffer_by_handle_.clear();
+    async_buffers_context_ = eglGetCurrentContext();
+  }
+
   auto FenceFd = [](TfLiteSynchronization* sync) {
     if (sync == nullptr) {
       return -1;
@@ -1170,20 +1278,13 @@ TfLiteStatus DelegateAsyncKernel::EvalImpl(TfLiteContext* context,
   const auto waitfor = WaitForAllFds(unique_input_cpu_sync_fds_vec);
   TFLITE_RET_CHECK_STATUS(waitfor.has_value(), "wait for input fds");
 
-  // Needed for cl inference. For gl it re-uses the existing context.
-  std::unique_ptr<gl::EglEnvironment> env;
-  TFLITE_RETURN_IF_ABSL_ERROR(gl::EglEnvironment::NewEglEnvironment(&env));
   for (int i = 0; i < core_.runner()->inputs().size(); i++) {
     TensorObjectDef tensor_def = core_.runner()->inputs()[i];
     TfLiteBufferHandle handle =
         TfLiteExecutionTaskGetBufferByIndex(task, core_.input_indices()[i]);
     TFLITE_RET_CHECK_STATUS(handle >= 0, "bad handle");
-
-    absl::MutexLock eval_lock(&eval_mutex_);
-    AHardwareBuffer* ahwb = buffer_by_handle_.at(handle).get();
-    AsyncBuffer async_buffer = AsyncBuffer(tensor_def, ahwb);
     OpenGlBuffer buffer;
-    TFLITE_RETURN_IF_ABSL_ERROR(async_buffer.GetOpenGlBuffer(buffer.id));
+    TFLITE_RETURN_IF_ABSL_ERROR(GetOpenGlBuffer(handle, tensor_def, buffer));
     TFLITE_RETURN_IF_ABSL_ERROR(
         core_.runner()->SetInputObject(i, std::move(buffer)));
   }
@@ -1192,18 +1293,14 @@ TfLiteStatus DelegateAsyncKernel::EvalImpl(TfLiteContext* context,
     TfLiteBufferHandle handle =
         TfLiteExecutionTaskGetBufferByIndex(task, core_.output_indices()[i]);
     TFLITE_RET_CHECK_STATUS(handle >= 0, "bad handle");
-    absl::MutexLock eval_lock(&eval_mutex_);
-    AHardwareBuffer* ahwb = buffer_by_handle_.at(handle).get();
-    AsyncBuffer async_buffer = AsyncBuffer(tensor_def, ahwb);
     OpenGlBuffer buffer;
-    TFLITE_RETURN_IF_ABSL_ERROR(async_buffer.GetOpenGlBuffer(buffer.id));
+    TFLITE_RETURN_IF_ABSL_ERROR(GetOpenGlBuffer(handle, tensor_def, buffer));
     TFLITE_RETURN_IF_ABSL_ERROR(
         core_.runner()->SetOutputObject(i, std::move(buffer)));
   }
   TFLITE_RETURN_IF_ABSL_ERROR(core_.runner()->Run());
   // Add sync objects
   for (size_t i = 0; i < node->outputs->size; ++i) {
-    absl::MutexLock eval_lock(&eval_mutex_);
     if (output_sync_types_[i] == SyncType::kNoSyncObj) continue;
     TfLiteSynchronization* sync =
         TfLiteExecutionTaskGetSyncByIndex(task, node->outputs->data[i]);
@@ -68,7 +68,9 @@ enum TfLiteGpuExperimentalFlags {
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
   // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // TfLiteGpuDelegateOptionsV2. Without a model_token, only the compiled
+  // OpenCL programs are cached in serialization_dir, which is bounded in size
+  // and doesn't fail ModifyGraphWithDelegate.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
 };
@@ -134,7 +136,8 @@ typedef struct {
   // StrFingerprint() in lite/delegates/serialization.h.
   //
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
-  // delegate will not try serialization.
+  // delegate will only cache the compiled OpenCL programs, if serialization
+  // is enabled.
   const char* model_token;
 
 #ifdef TFLITE_DEBUG_DELEGATE
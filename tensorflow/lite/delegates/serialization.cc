@@ -18,18 +18,19 @@ limitations under the License.
 #include <fstream>
 #include <iostream>
 #else
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/file.h>
+#include <sys/stat.h>
 #include <unistd.h>
-
-#include <cstring>
 #endif  // defined(_WIN32)
 
 #include <time.h>
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
@@ -70,6 +71,77 @@ inline std::string GetFilePath(const std::string& cache_dir,
   return JoinPath(cache_dir, file_name);
 }
 
+// Checks and removes the fingerprint appended to `data` by SetData.
+TfLiteStatus StripChecksum(TfLiteContext* context, const std::string& filepath,
+                           std::string* data) {
+  uint64_t checksum = 0;
+  if (data->size() < sizeof(checksum)) {
+    TF_LITE_KERNEL_LOG(context, "Serialized data at %s has no checksum",
+                       filepath.c_str());
+    return kTfLiteDelegateDataReadError;
+  }
+  const size_t size = data->size() - sizeof(checksum);
+  std::memcpy(&checksum, data->data() + size, sizeof(checksum));
+  if (checksum != ::util::Fingerprint64(data->data(), size)) {
+    TF_LITE_KERNEL_LOG(context, "Serialized data at %s is corrupted",
+                       filepath.c_str());
+    return kTfLiteDelegateDataReadError;
+  }
+  data->resize(size);
+  return kTfLiteOk;
+}
+
+#if !defined(_WIN32)
+// Removes the least recently used entries of `cache_dir`, except `filepath`,
+// until all the entries take at most `max_cache_size` bytes.
+void EvictEntries(const std::string& cache_dir, const std::string& filepath,
+                  size_t max_cache_size) {
+  DIR* dir = opendir(cache_dir.c_str());
+  if (dir == nullptr) return;
+  struct Entry {
+    std::string path;
+    size_t size;
+    time_t last_use;
+  };
+  std::vector<Entry> entries;
+  size_t total_size = 0;
+  while (const dirent* dir_entry = readdir(dir)) {
+    const std::string name = dir_entry->d_name;
+    constexpr char kSuffix[] = ".bin";
+    constexpr size_t kSuffixSize = sizeof(kSuffix) - 1;
+    if (name.size() <= kSuffixSize ||
+        name.compare(name.size() - kSuffixSize, kSuffixSize, kSuffix) != 0) {
+      continue;
+    }
+    std::string path = JoinPath(cache_dir, name);
+    struct stat file_stat;
+    if (stat(path.c_str(), &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+      continue;
+    }
+    total_size += file_stat.st_size;
+    if (path != filepath) {
+      entries.push_back({std::move(path),
+                         static_cast<size_t>(file_stat.st_size),
+                         file_stat.st_mtime});
+    }
+  }
+  closedir(dir);
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.last_use < b.last_use;
+            });
+  for (const Entry& entry : entries) {
+    if (total_size <= max_cache_size) break;
+    if (unlink(entry.path.c_str()) == 0) {
+      total_size -= entry.size;
+      TFLITE_LOG(TFLITE_LOG_INFO, "Evicted serialized data at %s",
+                 entry.path.c_str());
+    }
+  }
+}
+#endif  // !defined(_WIN32)
+
 }  // namespace
 
 std::string StrFingerprint(const void* data, const size_t num_bytes) {
@@ -79,14 +151,27 @@ std::string StrFingerprint(const void* data, const size_t num_bytes) {
 
 SerializationEntry::SerializationEntry(const std::string& cache_dir,
                                        const std::string& model_token,
-                                       const uint64_t fingerprint)
+                                       const uint64_t fingerprint,
+                                       size_t max_cache_size, bool checksum)
     : cache_dir_(cache_dir),
       model_token_(model_token),
-      fingerprint_(fingerprint) {}
+      fingerprint_(fingerprint),
+      max_cache_size_(max_cache_size),
+      checksum_(checksum) {}
 
 TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                                          const char* data,
-                                         const size_t size) const {
+                                         size_t size) const {
+  std::string data_with_checksum;
+  if (checksum_) {
+    const uint64_t checksum = ::util::Fingerprint64(data, size);
+    data_with_checksum.reserve(size + sizeof(checksum));
+    data_with_checksum.append(data, size);
+    data_with_checksum.append(reinterpret_cast<const char*>(&checksum),
+                              sizeof(checksum));
+    data = data_with_checksum.data();
+    size = data_with_checksum.size();
+  }
   auto filepath = GetFilePath(cache_dir_, model_token_, fingerprint_);
   // Temporary file to write data to.
   const std::string temp_filepath =
@@ -149,6 +234,9 @@ TfLiteStatus SerializationEntry::SetData(TfLiteContext* context,
                        filepath.c_str(), std::strerror(errno));
     return kTfLiteDelegateDataWriteError;
   }
+  if (max_cache_size_ > 0) {
+    EvictEntries(cache_dir_, filepath, max_cache_size_);
+  }
 #endif  // defined(_WIN32)
 
   TFLITE_LOG(TFLITE_LOG_INFO, "Wrote serialized data for model %s (%d B) to %s",
@@ -173,6 +261,9 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
     data->resize(cache_size);
     cache_stream.read(&(*data)[0], cache_size);
     cache_stream.close();
+    if (checksum_) {
+      TF_LITE_ENSURE_STATUS(StripChecksum(context, filepath, data));
+    }
   }
 #else   // !defined(_WIN32)
   // This method only works on unix/POSIX systems, but is more optimized & has
@@ -198,8 +289,12 @@ TfLiteStatus SerializationEntry::GetData(TfLiteContext* context,
     int bytes_read = read(fd, buffer, 512);
     if (bytes_read == 0) {
       // EOF
+      if (max_cache_size_ > 0) {
+        // Entries are evicted by least recent use.
+        futimens(fd, nullptr);
+      }
       close(fd);
-      return kTfLiteOk;
+      return checksum_ ? StripChecksum(context, filepath, data) : kTfLiteOk;
     } else if (bytes_read < 0) {
       close(fd);
       TF_LITE_KERNEL_LOG(context, "Error reading %s: %s", filepath.c_str(),
@@ -288,7 +383,8 @@ SerializationEntry Serialization::GetEntryImpl(
 
   // Get a fingerprint-specific lock that is passed to the SerializationKey, to
   // ensure noone else gets access to an equivalent SerializationKey.
-  return SerializationEntry(cache_dir_, model_token_, fingerprint);
+  return SerializationEntry(cache_dir_, model_token_, fingerprint,
+                            max_cache_size_, checksum_);
 }
 
 TfLiteStatus SaveDelegatedNodes(TfLiteContext* context,
@@ -109,13 +109,14 @@ class SerializationEntry {
   // NOTE: We use a temp file & rename it as file renaming is an atomic
   // operation in most systems.
   TfLiteStatus SetData(TfLiteContext* context, const char* data,
-                       const size_t size) const;
+                       size_t size) const;
 
   // Get `data` corresponding to this key, if available.
   //
   // Returns:
   //   kTfLiteOk if data is successfully stored
   //   kTfLiteDataError for data writing issues
+  //   kTfLiteDelegateDataReadError if the checksum of the data doesn't match
   //   kTfLiteError for unexpected error.
   TfLiteStatus GetData(TfLiteContext* context, std::string* data) const;
 
@@ -127,7 +128,8 @@ class SerializationEntry {
  protected:
   SerializationEntry(const std::string& cache_dir,
                      const std::string& model_token,
-                     const uint64_t fingerprint_64);
+                     const uint64_t fingerprint_64, size_t max_cache_size = 0,
+                     bool checksum = false);
 
   // Caching directory.
   const std::string cache_dir_;
@@ -135,6 +137,9 @@ class SerializationEntry {
   const std::string model_token_;
   // For most applications, 64-bit fingerprints are enough.
   const uint64_t fingerprint_ = 0;
+  // See SerializationParams.
+  const size_t max_cache_size_ = 0;
+  const bool checksum_ = false;
 };
 
 // Encapsulates all the data that clients can use to parametrize a Serialization
@@ -154,6 +159,15 @@ typedef struct SerializationParams {
   // On Android, `getCodeCacheDir()` is recommended.
   // Required.
   const char* cache_dir;
+  // If non-zero, SetData evicts the least recently read or written entries of
+  // `cache_dir` once all the entries take more than this many bytes. Only
+  // supported on POSIX systems.
+  // Optional.
+  size_t max_cache_size = 0;
+  // Whether SetData stores a fingerprint with the data, which GetData checks
+  // to detect entries that were corrupted on disk.
+  // Optional.
+  bool checksum = false;
 } SerializationParams;
 
 // Utility to enable caching abilities for delegates.
@@ -164,7 +178,10 @@ class Serialization {
  public:
   // Initialize a Serialization interface for applicable delegates.
   explicit Serialization(const SerializationParams& params)
-      : cache_dir_(params.cache_dir), model_token_(params.model_token) {}
+      : cache_dir_(params.cache_dir),
+        model_token_(params.model_token),
+        max_cache_size_(params.max_cache_size),
+        checksum_(params.checksum) {}
 
   // Generate a SerializationEntry that incorporates both `custom_key` &
   // `context` into its unique fingerprint.
@@ -199,6 +216,8 @@ class Serialization {
 
   const std::string cache_dir_;
   const std::string model_token_;
+  const size_t max_cache_size_;
+  const bool checksum_;
 };
 
 // Helper for delegates to save their delegation decisions (which nodes to
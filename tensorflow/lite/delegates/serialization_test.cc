@@ -14,7 +14,15 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/delegates/serialization.h"
 
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <utime.h>
+#endif  // !defined(_WIN32)
+
+#include <time.h>
+
 #include <cstdint>
+#include <fstream>
 #include <string>
 #include <vector>
 
@@ -367,6 +375,75 @@ TEST_F(SerializationTest, CachingDelegatedNodes) {
   TfLiteIntArrayFree(empty_nodes_array);
 }
 
+TEST_F(SerializationTest, ChecksumDetectsCorruptedData) {
+  std::string model_token = "checksum_model";
+  std::string test_dir = getSerializationDir();
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  serialization_params.checksum = true;
+  Serialization serialization(serialization_params);
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+
+  const std::string data = "some serialized data";
+  auto entry = serialization.GetEntryForDelegate("test", &context);
+  ASSERT_EQ(entry.SetData(&context, data.data(), data.size()), kTfLiteOk);
+  std::string read_back;
+  ASSERT_EQ(entry.GetData(&context, &read_back), kTfLiteOk);
+  EXPECT_EQ(read_back, data);
+
+  // Flip a byte of the stored data.
+  const std::string filepath = test_dir + "/" + model_token + "_" +
+                               std::to_string(entry.GetFingerprint()) + ".bin";
+  {
+    std::fstream file(filepath,
+                      std::ios::in | std::ios::out | std::ios::binary);
+    ASSERT_TRUE(file.good());
+    file.seekp(0);
+    file.put('S');
+  }
+  EXPECT_EQ(entry.GetData(&context, &read_back), kTfLiteDelegateDataReadError);
+}
+
+#if !defined(_WIN32)
+TEST_F(SerializationTest, EvictsLeastRecentlyUsedEntries) {
+  std::string model_token = "eviction_model";
+  std::string test_dir = getSerializationDir() + "/eviction";
+  mkdir(test_dir.c_str(), 0700);
+  const std::string data(100, 'a');
+  SerializationParams serialization_params = {model_token.c_str(),
+                                              test_dir.c_str()};
+  serialization_params.max_cache_size = 2 * data.size() + data.size() / 2;
+  Serialization serialization(serialization_params);
+  TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 30);
+
+  auto entry1 = serialization.GetEntryForDelegate("entry1", &context);
+  auto entry2 = serialization.GetEntryForDelegate("entry2", &context);
+  auto entry3 = serialization.GetEntryForDelegate("entry3", &context);
+  // Makes `entry` look like it was last used `age` seconds ago.
+  auto set_age = [&](const SerializationEntry& entry, int age) {
+    const std::string filepath = test_dir + "/" + model_token + "_" +
+                                 std::to_string(entry.GetFingerprint()) +
+                                 ".bin";
+    const time_t last_use = time(nullptr) - age;
+    struct utimbuf times = {last_use, last_use};
+    ASSERT_EQ(utime(filepath.c_str(), &times), 0);
+  };
+  ASSERT_EQ(entry1.SetData(&context, data.data(), data.size()), kTfLiteOk);
+  set_age(entry1, 100);
+  ASSERT_EQ(entry2.SetData(&context, data.data(), data.size()), kTfLiteOk);
+  set_age(entry2, 50);
+
+  // Reading entry1 makes entry2 the least recently used one.
+  std::string read_back;
+  ASSERT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+  ASSERT_EQ(entry3.SetData(&context, data.data(), data.size()), kTfLiteOk);
+
+  EXPECT_EQ(entry1.GetData(&context, &read_back), kTfLiteOk);
+  EXPECT_EQ(entry2.GetData(&context, &read_back), kTfLiteDelegateDataNotFound);
+  EXPECT_EQ(entry3.GetData(&context, &read_back), kTfLiteOk);
+}
+#endif  // !defined(_WIN32)
+
 }  // namespace
 }  // namespace delegates
 }  // namespace tflite
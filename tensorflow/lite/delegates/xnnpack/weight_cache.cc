@@ -0,0 +1,362 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xnnpack.h"  // from @XNNPACK
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/stderr_reporter.h"
+
+namespace tflite {
+namespace xnnpack {
+namespace {
+
+// Layout of the file: a FileHeader, `num_entries` FileEntry, then the packed
+// weights at the offsets of the entries.
+constexpr uint64_t kFileMagic = 0x48434143574e4e58;  // "XNNWCACH"
+constexpr uint32_t kFileFormatVersion = 1;
+constexpr size_t kAlignment = 64;
+
+// The XNNPACK sources the packing layout comes from.
+// LINT.IfChange(xnnpack_version)
+constexpr char kXNNPackVersion[] = "dcbfffb80fb4f6fcfcfb5b3723854ec8797fa546";
+// LINT.ThenChange(//tensorflow/workspace2.bzl)
+
+// Identifier of a missing bias.
+constexpr uint64_t kNoTensorIdentifier = (uint64_t{1} << 63) - 1;
+
+// Distance between the samples of static tensors in the fingerprint. Hashing
+// all the weights would take about as long as packing them.
+constexpr size_t kFingerprintSampleStride = 64 * 1024;
+
+struct FileHeader {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t reserved;
+  uint64_t fingerprint;
+  uint64_t num_entries;
+};
+
+struct FileEntry {
+  uint32_t seed;
+  uint32_t reserved;
+  uint64_t kernel_id;
+  uint64_t bias_id;
+  uint64_t offset;
+  uint64_t size;
+};
+
+size_t AlignUp(size_t value) {
+  return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+uint8_t* AlignUp(uint8_t* pointer) {
+  return pointer + (AlignUp(reinterpret_cast<uintptr_t>(pointer)) -
+                    reinterpret_cast<uintptr_t>(pointer));
+}
+
+// 64-bit FNV-1a.
+class Fingerprint {
+ public:
+  void Add(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      value_ = (value_ ^ bytes[i]) * 0x100000001b3;
+    }
+  }
+
+  template <typename T>
+  void AddValue(T value) {
+    Add(&value, sizeof(value));
+  }
+
+  uint64_t value() const { return value_; }
+
+ private:
+  uint64_t value_ = 0xcbf29ce484222325;
+};
+
+uint64_t ComputeFingerprint(const TfLiteContext& context,
+                            uint32_t delegate_flags) {
+  Fingerprint fingerprint;
+  fingerprint.AddValue(kFileFormatVersion);
+  fingerprint.Add(kXNNPackVersion, sizeof(kXNNPackVersion));
+  fingerprint.AddValue(delegate_flags);
+  fingerprint.AddValue(context.tensors_size);
+  for (size_t t = 0; t < context.tensors_size; ++t) {
+    const TfLiteTensor& tensor = context.tensors[t];
+    fingerprint.AddValue(tensor.type);
+    fingerprint.AddValue(tensor.bytes);
+    if (tensor.allocation_type != kTfLiteMmapRo ||
+        tensor.data.raw_const == nullptr) {
+      continue;
+    }
+    for (size_t offset = 0; offset < tensor.bytes;
+         offset += kFingerprintSampleStride) {
+      fingerprint.Add(tensor.data.raw_const + offset,
+                      std::min<size_t>(8, tensor.bytes - offset));
+    }
+    const size_t tail = std::min<size_t>(8, tensor.bytes);
+    fingerprint.Add(tensor.data.raw_const + tensor.bytes - tail, tail);
+  }
+  return fingerprint.value();
+}
+
+}  // namespace
+
+size_t MMapWeightCacheProvider::PackIdentifierHash::operator()(
+    const PackIdentifier& identifier) const {
+  size_t hash = std::hash<uint64_t>()(identifier.kernel_id);
+  hash = hash * 31 + std::hash<uint64_t>()(identifier.bias_id);
+  return hash * 31 + identifier.seed;
+}
+
+MMapWeightCacheProvider::MMapWeightCacheProvider(std::string file_path,
+                                                 uint32_t delegate_flags)
+    : file_path_(std::move(file_path)), delegate_flags_(delegate_flags) {
+  cache_provider_.context = this;
+  cache_provider_.look_up = LookUp;
+  cache_provider_.reserve_space = ReserveSpace;
+  cache_provider_.look_up_or_insert = LookUpOrInsert;
+  cache_provider_.is_finalized = IsFinalized;
+  cache_provider_.offset_to_addr = OffsetToAddr;
+  cache_provider_.delete_cache = DeleteCache;
+}
+
+MMapWeightCacheProvider::~MMapWeightCacheProvider() = default;
+
+void MMapWeightCacheProvider::StartSubgraph(const TfLiteContext* context) {
+  ++subgraph_ordinal_;
+  tensor_identifiers_.clear();
+  finalized_ = false;
+  if (subgraph_ordinal_ > 0) {
+    return;
+  }
+  fingerprint_ = ComputeFingerprint(*context, delegate_flags_);
+  if (Load(fingerprint_)) {
+    TFLITE_LOG_PROD(TFLITE_LOG_INFO,
+                    "Mapped %zu packed XNNPACK weights from %s.",
+                    packed_weights_.size(), file_path_.c_str());
+  }
+}
+
+void MMapWeightCacheProvider::MapTensorIdentifier(const void* data,
+                                                  int tensor_index) {
+  tensor_identifiers_[data] = (static_cast<uint64_t>(subgraph_ordinal_) << 32) |
+                              static_cast<uint32_t>(tensor_index);
+}
+
+uint64_t MMapWeightCacheProvider::GetIdentifier(const void* data) const {
+  if (data == nullptr) {
+    return kNoTensorIdentifier;
+  }
+  const auto it = tensor_identifiers_.find(data);
+  if (it != tensor_identifiers_.end()) {
+    return it->second;
+  }
+  return kTransientIdentifier | reinterpret_cast<uintptr_t>(data);
+}
+
+MMapWeightCacheProvider::PackIdentifier
+MMapWeightCacheProvider::GetPackIdentifier(
+    const xnn_weights_cache_look_up_key& key) const {
+  return {key.seed, GetIdentifier(key.kernel), GetIdentifier(key.bias)};
+}
+
+bool MMapWeightCacheProvider::Load(uint64_t fingerprint) {
+  if (!MMAPAllocation::IsSupported()) {
+    return false;
+  }
+  // MMAPAllocation reports missing files as errors, while a missing file is
+  // expected on the first run.
+  if (FILE* file = std::fopen(file_path_.c_str(), "rb")) {
+    std::fclose(file);
+  } else {
+    return false;
+  }
+  auto file = std::make_unique<MMAPAllocation>(file_path_.c_str(),
+                                               DefaultErrorReporter());
+  if (!file->valid() || file->bytes() < sizeof(FileHeader)) {
+    return false;
+  }
+  const uint8_t* base = static_cast<const uint8_t*>(file->base());
+  const size_t file_size = file->bytes();
+  FileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (header.magic != kFileMagic || header.version != kFileFormatVersion ||
+      header.fingerprint != fingerprint ||
+      header.num_entries >
+          (file_size - sizeof(FileHeader)) / sizeof(FileEntry)) {
+    return false;
+  }
+
+  std::vector<FileEntry> entries(header.num_entries);
+  std::memcpy(entries.data(), base + sizeof(FileHeader),
+              entries.size() * sizeof(FileEntry));
+  for (const FileEntry& entry : entries) {
+    if (entry.offset % kAlignment != 0 || entry.offset > file_size ||
+        entry.size > file_size - entry.offset) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Ignoring the corrupted XNNPACK weights cache %s.",
+                      file_path_.c_str());
+      return false;
+    }
+  }
+  for (const FileEntry& entry : entries) {
+    offsets_[{entry.seed, entry.kernel_id, entry.bias_id}] =
+        packed_weights_.size();
+    packed_weights_.push_back({base + entry.offset, entry.size});
+  }
+  file_ = std::move(file);
+  return true;
+}
+
+bool MMapWeightCacheProvider::Finalize() {
+  finalized_ = true;
+  if (!has_unsaved_weights_) {
+    return true;
+  }
+  std::vector<FileEntry> entries;
+  for (const auto& [identifier, offset] : offsets_) {
+    if (IsPersistent(identifier)) {
+      entries.push_back({identifier.seed, 0, identifier.kernel_id,
+                         identifier.bias_id, offset,
+                         packed_weights_[offset].size});
+    }
+  }
+  // Keep the packed weights in the order XNNPACK packed them.
+  std::sort(entries.begin(), entries.end(),
+            [](const FileEntry& a, const FileEntry& b) {
+              return a.offset < b.offset;
+            });
+  std::vector<const uint8_t*> data(entries.size());
+  size_t file_offset =
+      AlignUp(sizeof(FileHeader) + entries.size() * sizeof(FileEntry));
+  for (size_t i = 0; i < entries.size(); ++i) {
+    data[i] = packed_weights_[entries[i].offset].data;
+    entries[i].offset = file_offset;
+    file_offset = AlignUp(file_offset + entries[i].size);
+  }
+  const FileHeader header = {kFileMagic, kFileFormatVersion, 0, fingerprint_,
+                             entries.size()};
+
+  // Write a temporary file and rename it, so that concurrent processes never
+  // map a partial file.
+  const std::string temporary_path = file_path_ + ".tmp";
+  FILE* file = std::fopen(temporary_path.c_str(), "wb");
+  if (file == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Failed to open %s for writing.",
+                    temporary_path.c_str());
+    return false;
+  }
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(entries.data(), sizeof(FileEntry), entries.size(),
+                        file) == entries.size();
+  const std::vector<uint8_t> padding(kAlignment, 0);
+  size_t written = sizeof(header) + entries.size() * sizeof(FileEntry);
+  for (size_t i = 0; ok && i < entries.size(); ++i) {
+    const size_t padding_size = entries[i].offset - written;
+    ok = std::fwrite(padding.data(), 1, padding_size, file) == padding_size &&
+         std::fwrite(data[i], 1, entries[i].size, file) == entries[i].size;
+    written = entries[i].offset + entries[i].size;
+  }
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok || std::rename(temporary_path.c_str(), file_path_.c_str()) != 0) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Failed to write the XNNPACK weights cache %s.",
+                    file_path_.c_str());
+    std::remove(temporary_path.c_str());
+    return false;
+  }
+  has_unsaved_weights_ = false;
+  return true;
+}
+
+size_t MMapWeightCacheProvider::LookUp(
+    void* context, const xnn_weights_cache_look_up_key* cache_key) {
+  auto* self = static_cast<MMapWeightCacheProvider*>(context);
+  const auto it = self->offsets_.find(self->GetPackIdentifier(*cache_key));
+  return it != self->offsets_.end() ? it->second : XNN_CACHE_NOT_FOUND;
+}
+
+void* MMapWeightCacheProvider::ReserveSpace(void* context, size_t n) {
+  auto* self = static_cast<MMapWeightCacheProvider*>(context);
+  self->reserved_buffer_.reset(new uint8_t[n + kAlignment]);
+  self->reserved_space_ = AlignUp(self->reserved_buffer_.get());
+  return self->reserved_space_;
+}
+
+size_t MMapWeightCacheProvider::LookUpOrInsert(
+    void* context, const xnn_weights_cache_look_up_key* cache_key, void* ptr,
+    size_t size) {
+  auto* self = static_cast<MMapWeightCacheProvider*>(context);
+  PackIdentifier identifier = {};
+  if (cache_key != nullptr) {
+    identifier = self->GetPackIdentifier(*cache_key);
+    const auto it = self->offsets_.find(identifier);
+    if (it != self->offsets_.end()) {
+      return it->second;
+    }
+  }
+
+  uint8_t* data = static_cast<uint8_t*>(ptr);
+  if (data == self->reserved_space_ && self->reserved_buffer_ != nullptr) {
+    self->buffers_.push_back(std::move(self->reserved_buffer_));
+    self->reserved_space_ = nullptr;
+  } else {
+    self->buffers_.emplace_back(new uint8_t[size + kAlignment]);
+    data = AlignUp(self->buffers_.back().get());
+    std::memcpy(data, ptr, size);
+  }
+  const size_t offset = self->packed_weights_.size();
+  self->packed_weights_.push_back({data, size});
+  if (cache_key != nullptr) {
+    self->offsets_[identifier] = offset;
+    self->has_unsaved_weights_ |= IsPersistent(identifier);
+  }
+  return offset;
+}
+
+bool MMapWeightCacheProvider::IsFinalized(void* context) {
+  return static_cast<MMapWeightCacheProvider*>(context)->finalized_;
+}
+
+void* MMapWeightCacheProvider::OffsetToAddr(void* context, size_t offset) {
+  auto* self = static_cast<MMapWeightCacheProvider*>(context);
+  if (offset >= self->packed_weights_.size()) {
+    return nullptr;
+  }
+  return const_cast<uint8_t*>(self->packed_weights_[offset].data);
+}
+
+xnn_status MMapWeightCacheProvider::DeleteCache(void* context) {
+  // The delegate owns the provider.
+  return xnn_status_success;
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
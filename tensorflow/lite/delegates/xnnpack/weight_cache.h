@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xnnpack.h"  // from @XNNPACK
+#include "tensorflow/lite/allocation.h"
+#include "tensorflow/lite/core/c/common.h"
+
+namespace tflite {
+namespace xnnpack {
+
+// An XNNPACK weights cache which keeps the packed weights in a file, so that
+// later processes running the same model map them instead of packing them
+// again.
+//
+// The cache entries are keyed by the tensors holding the weights rather than
+// by their addresses, which change from one process to the next. The file
+// header holds a fingerprint of the file format, the XNNPACK version, the
+// delegate flags and the static tensors of the model, and a file with another
+// fingerprint is ignored and overwritten.
+//
+// The packed weights depend on the micro-kernels XNNPACK selects for the CPU,
+// so the file must not be shared between devices.
+class MMapWeightCacheProvider {
+ public:
+  MMapWeightCacheProvider(std::string file_path, uint32_t delegate_flags);
+  ~MMapWeightCacheProvider();
+
+  MMapWeightCacheProvider(const MMapWeightCacheProvider&) = delete;
+  MMapWeightCacheProvider& operator=(const MMapWeightCacheProvider&) = delete;
+
+  // Starts the delegation of a subgraph of the model, during which XNNPACK may
+  // pack weights. The first call maps the file if it matches the model.
+  void StartSubgraph(const TfLiteContext* context);
+
+  // Records that `data` holds the static tensor `tensor_index` of the current
+  // subgraph, for the weights XNNPACK packs from it.
+  void MapTensorIdentifier(const void* data, int tensor_index);
+
+  // Ends the delegation of a subgraph, after which XNNPACK runtimes using the
+  // cache can run. Writes the packed weights to the file, unless they all come
+  // from it already. Returns false if the file can't be written.
+  bool Finalize();
+
+  // Whether the packed weights were mapped from the file.
+  bool loaded_from_file() const { return file_ != nullptr; }
+
+  xnn_weights_cache_t GetCacheProvider() { return &cache_provider_; }
+
+ private:
+  // Identifies packed weights independently of the process. An identifier
+  // with the high bit set wraps an address which isn't a known tensor, and
+  // isn't written to the file.
+  struct PackIdentifier {
+    uint32_t seed;
+    uint64_t kernel_id;
+    uint64_t bias_id;
+
+    bool operator==(const PackIdentifier& other) const {
+      return seed == other.seed && kernel_id == other.kernel_id &&
+             bias_id == other.bias_id;
+    }
+  };
+
+  struct PackIdentifierHash {
+    size_t operator()(const PackIdentifier& identifier) const;
+  };
+
+  struct PackedWeights {
+    const uint8_t* data;
+    size_t size;
+  };
+
+  static constexpr uint64_t kTransientIdentifier = uint64_t{1} << 63;
+
+  uint64_t GetIdentifier(const void* data) const;
+  PackIdentifier GetPackIdentifier(
+      const xnn_weights_cache_look_up_key& key) const;
+  static bool IsPersistent(const PackIdentifier& identifier) {
+    return ((identifier.kernel_id | identifier.bias_id) &
+            kTransientIdentifier) == 0;
+  }
+
+  // Maps the file if its fingerprint is `fingerprint`.
+  bool Load(uint64_t fingerprint);
+
+  // The callbacks of `cache_provider_`. Offsets are indices in
+  // `packed_weights_`.
+  static size_t LookUp(void* context,
+                       const xnn_weights_cache_look_up_key* cache_key);
+  static void* ReserveSpace(void* context, size_t n);
+  static size_t LookUpOrInsert(void* context,
+                               const xnn_weights_cache_look_up_key* cache_key,
+                               void* ptr, size_t size);
+  static bool IsFinalized(void* context);
+  static void* OffsetToAddr(void* context, size_t offset);
+  static xnn_status DeleteCache(void* context);
+
+  const std::string file_path_;
+  const uint32_t delegate_flags_;
+  xnn_weights_cache_provider cache_provider_;
+
+  // Ordinal of the subgraph being delegated, and the identifiers of its static
+  // tensors by address.
+  int subgraph_ordinal_ = -1;
+  std::unordered_map<const void*, uint64_t> tensor_identifiers_;
+
+  std::unique_ptr<MMAPAllocation> file_;
+  uint64_t fingerprint_ = 0;
+  std::unordered_map<PackIdentifier, size_t, PackIdentifierHash> offsets_;
+  std::vector<PackedWeights> packed_weights_;
+  std::vector<std::unique_ptr<uint8_t[]>> buffers_;
+  // The space returned by the last `ReserveSpace`.
+  std::unique_ptr<uint8_t[]> reserved_buffer_;
+  uint8_t* reserved_space_ = nullptr;
+  // Whether weights which aren't in the file yet were packed.
+  bool has_unsaved_weights_ = false;
+  // Whether no subgraph is being delegated.
+  bool finalized_ = false;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_WEIGHT_CACHE_H_
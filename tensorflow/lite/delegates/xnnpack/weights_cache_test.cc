@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cstdio>
 #include <memory>  // For std::unique_ptr.
+#include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
@@ -244,5 +247,63 @@ INSTANTIATE_TEST_SUITE_P(WeightsCacheTest, WeightsCacheTest,
                          testing::Values(2, 4),
                          testing::PrintToStringParamName());
 
+// Delegates `model` to XNNPACK with `weight_cache_file_path`, then returns the
+// output of an invocation with all inputs set to 1.
+std::vector<float> InvokeWithWeightCacheFile(
+    const Model* model, const std::string& weight_cache_file_path) {
+  DummyOpResolver resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  EXPECT_EQ(kTfLiteOk, InterpreterBuilder(model, resolver)(&interpreter));
+  EXPECT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+
+  TfLiteXNNPackDelegateOptions delegate_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  delegate_options.weight_cache_file_path = weight_cache_file_path.c_str();
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      delegate(TfLiteXNNPackDelegateCreate(&delegate_options),
+               TfLiteXNNPackDelegateDelete);
+  EXPECT_EQ(kTfLiteOk, interpreter->ModifyGraphWithDelegate(delegate.get()));
+
+  TfLiteTensor* input = interpreter->input_tensor(0);
+  std::fill_n(input->data.f, input->bytes / sizeof(float), 1.0f);
+  EXPECT_EQ(kTfLiteOk, interpreter->Invoke());
+  const TfLiteTensor* output = interpreter->output_tensor(0);
+  return std::vector<float>(output->data.f,
+                            output->data.f + output->bytes / sizeof(float));
+}
+
+TEST(XNNPACK_WEIGHTS_CACHE, FileIsReusedByTheSameModel) {
+  const std::string path = testing::TempDir() + "/xnnpack_weight_cache_reuse";
+  std::remove(path.c_str());
+  std::vector<char> buffer = Conv2DTester().CreateTfLiteModel();
+  const Model* model = GetModel(buffer.data());
+
+  const std::vector<float> packed_output =
+      InvokeWithWeightCacheFile(model, path);
+  FILE* file = std::fopen(path.c_str(), "rb");
+  ASSERT_NE(file, nullptr);
+  std::fclose(file);
+
+  // Uses the weights packed by the first delegate.
+  EXPECT_EQ(InvokeWithWeightCacheFile(model, path), packed_output);
+  std::remove(path.c_str());
+}
+
+TEST(XNNPACK_WEIGHTS_CACHE, FileOfAnotherModelIsIgnored) {
+  const std::string path = testing::TempDir() + "/xnnpack_weight_cache_other";
+  std::remove(path.c_str());
+  std::vector<char> buffer1 = Conv2DTester().CreateTfLiteModel();
+  std::vector<char> buffer2 = Conv2DTester().CreateTfLiteModel();
+  const Model* model2 = GetModel(buffer2.data());
+
+  InvokeWithWeightCacheFile(GetModel(buffer1.data()), path);
+  // The second model has other random weights, and must not use the packed
+  // weights of the first one.
+  const std::vector<float> output = InvokeWithWeightCacheFile(model2, path);
+  std::remove(path.c_str());
+  EXPECT_EQ(InvokeWithWeightCacheFile(model2, path), output);
+  std::remove(path.c_str());
+}
+
 }  // namespace xnnpack
 }  // namespace tflite
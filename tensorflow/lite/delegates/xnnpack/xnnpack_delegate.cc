@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/delegates/xnnpack/quantization_util.h"
+#include "tensorflow/lite/delegates/xnnpack/weight_cache.h"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -500,6 +501,17 @@ class Delegate {
     options_ =
         options != nullptr ? *options : TfLiteXNNPackDelegateOptionsDefault();
     workspace_.reset(workspace);
+    if (options_.weight_cache_file_path != nullptr) {
+      if (options_.weights_cache != nullptr) {
+        TFLITE_LOG_PROD(tflite::TFLITE_LOG_WARNING,
+                        "Ignoring the XNNPACK weight cache file %s, since a "
+                        "weights cache is provided.",
+                        options_.weight_cache_file_path);
+      } else {
+        weight_cache_provider_ = std::make_unique<MMapWeightCacheProvider>(
+            options_.weight_cache_file_path, options_.flags);
+      }
+    }
   }
 
   TfLiteIntArray* PrepareOpsToDelegate(TfLiteContext* context);
@@ -573,13 +585,20 @@ class Delegate {
   }
 
   xnn_weights_cache_t weights_cache() const {
-    if (options_.weights_cache == nullptr) {
+    if (weight_cache_provider_ != nullptr) {
+      return weight_cache_provider_->GetCacheProvider();
+    } else if (options_.weights_cache == nullptr) {
       return nullptr;
     } else {
       return reinterpret_cast<xnn_weights_cache_t>(options_.weights_cache);
     }
   }
 
+  // The cache of packed weights backed by `weight_cache_file_path`, if any.
+  MMapWeightCacheProvider* weight_cache_provider() const {
+    return weight_cache_provider_.get();
+  }
+
   xnn_workspace_t workspace() const { return workspace_.get(); }
 
   TfLiteStatus AssociateVariableWithTensor(int local_id,
@@ -663,6 +682,7 @@ class Delegate {
 
   TfLiteXNNPackDelegateOptions options_;
   VariableHolder variable_holder_;
+  std::unique_ptr<MMapWeightCacheProvider> weight_cache_provider_;
 };
 
 class Subgraph {
@@ -930,6 +950,9 @@ class Subgraph {
           data = delegate.static_unpacked_data_.data() + it->second;
         }
       }
+      if (data != nullptr && delegate.weight_cache_provider() != nullptr) {
+        delegate.weight_cache_provider()->MapTensorIdentifier(data, t);
+      }
       if (inputs.count(t) != 0) {
         flags |= XNN_VALUE_FLAG_EXTERNAL_INPUT;
         if (data == nullptr) {
@@ -6406,6 +6429,9 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   static_unpack_nodes_.clear();
   static_sparse_weights_.clear();
   variable_holder_.ClearTensorIdToGlobalId();
+  if (weight_cache_provider_ != nullptr) {
+    weight_cache_provider_->StartSubgraph(context);
+  }
 
   TfLiteIntArray* execution_plan = nullptr;
   if (context->GetExecutionPlan(context, &execution_plan) != kTfLiteOk) {
@@ -6842,6 +6868,15 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   const TfLiteStatus status = context->ReplaceNodeSubsetsWithDelegateKernels(
       context, kSubgraphRegistration, ops_to_replace, delegate);
   TfLiteIntArrayFree(ops_to_replace);
+
+  // The weights of this subgraph are packed now. Failing to save them only
+  // costs packing them again in the next process.
+  MMapWeightCacheProvider* weight_cache_provider =
+      static_cast<::tflite::xnnpack::Delegate*>(delegate->data_)
+          ->weight_cache_provider();
+  if (status == kTfLiteOk && weight_cache_provider != nullptr) {
+    weight_cache_provider->Finalize();
+  }
   return status;
 }
 
@@ -66,6 +66,15 @@ typedef struct {
   bool handle_variable_ops;
   // Enable adaptive optimization for AVX CPUs.
   bool experimental_adaptive_avx_optimization;
+  // Path of a file keeping the packed weights across processes. The first
+  // process running a model packs the weights and writes them to the file,
+  // later processes map the file instead of packing the weights again. The
+  // file is only valid on the device which wrote it, and is rewritten when the
+  // model, the delegate flags or the XNNPACK version change. Ignored when
+  // `weights_cache` is set.
+  //
+  // WARNING: This is an experimental API and subject to change.
+  const char* weight_cache_file_path;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
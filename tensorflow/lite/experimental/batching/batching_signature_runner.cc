@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_signature_runner.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstring>
+#include <future>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+
+BatchingSignatureRunner::BatchingSignatureRunner(SignatureRunner* runner,
+                                                 const Options& options)
+    : runner_(runner), options_(options) {
+  for (const char* name : runner_->input_names()) {
+    const TfLiteIntArray* dims = runner_->input_tensor(name)->dims;
+    const int batch_size = dims->size > 0 ? dims->data[0] : 0;
+    if (batch_size > 0) {
+      example_dims_.emplace_back(dims->data + 1, dims->data + dims->size);
+      example_bytes_.push_back(runner_->input_tensor(name)->bytes / batch_size);
+    } else {
+      // Requests are rejected, there is no batch dimension to stack them on.
+      example_dims_.emplace_back();
+      example_bytes_.push_back(0);
+    }
+  }
+  batch_thread_ = std::thread([this] { BatchLoop(); });
+}
+
+BatchingSignatureRunner::~BatchingSignatureRunner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queue_changed_.notify_one();
+  batch_thread_.join();
+}
+
+std::future<TfLiteStatus> BatchingSignatureRunner::Run(Example inputs,
+                                                       Example* outputs) {
+  Request request{std::move(inputs), outputs, {},
+                  std::chrono::steady_clock::now()};
+  std::future<TfLiteStatus> status = request.status.get_future();
+  bool valid = request.inputs.size() == example_bytes_.size();
+  for (size_t i = 0; valid && i < example_bytes_.size(); ++i) {
+    valid = example_bytes_[i] > 0 &&
+            request.inputs[i].size() == example_bytes_[i];
+  }
+  if (!valid) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "The inputs of a request don't match the signature.");
+    request.status.set_value(kTfLiteError);
+    return status;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(request));
+  }
+  queue_changed_.notify_one();
+  return status;
+}
+
+void BatchingSignatureRunner::BatchLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queue_changed_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    // Wait for more requests, unless the batch is full or the oldest request
+    // has waited long enough.
+    const auto deadline = queue_.front().enqueue_time + options_.batch_timeout;
+    queue_changed_.wait_until(lock, deadline, [this] {
+      return stopping_ ||
+             static_cast<int>(queue_.size()) >= options_.max_batch_size;
+    });
+
+    const size_t batch_size =
+        std::min<size_t>(queue_.size(), std::max(options_.max_batch_size, 1));
+    std::vector<Request> batch;
+    batch.reserve(batch_size);
+    for (size_t i = 0; i < batch_size; ++i) {
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    lock.unlock();
+    RunBatch(batch);
+    lock.lock();
+  }
+}
+
+void BatchingSignatureRunner::RunBatch(std::vector<Request>& batch) {
+  const TfLiteStatus status = RunBatchImpl(batch);
+  for (Request& request : batch) {
+    request.status.set_value(status);
+  }
+}
+
+TfLiteStatus BatchingSignatureRunner::RunBatchImpl(
+    std::vector<Request>& batch) {
+  const int batch_size = batch.size();
+  const std::vector<const char*>& input_names = runner_->input_names();
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    std::vector<int> dims = {batch_size};
+    dims.insert(dims.end(), example_dims_[i].begin(), example_dims_[i].end());
+    TF_LITE_ENSURE_STATUS(runner_->ResizeInputTensor(input_names[i], dims));
+  }
+  TF_LITE_ENSURE_STATUS(runner_->AllocateTensors());
+
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    char* data = runner_->input_tensor(input_names[i])->data.raw;
+    for (const Request& request : batch) {
+      std::memcpy(data, request.inputs[i].data(), example_bytes_[i]);
+      data += example_bytes_[i];
+    }
+  }
+  TF_LITE_ENSURE_STATUS(runner_->Invoke());
+
+  const std::vector<const char*>& output_names = runner_->output_names();
+  for (Request& request : batch) {
+    request.outputs->resize(output_names.size());
+  }
+  for (size_t i = 0; i < output_names.size(); ++i) {
+    const TfLiteTensor* tensor = runner_->output_tensor(output_names[i]);
+    if (tensor->dims->size == 0 || tensor->dims->data[0] != batch_size) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Output %s doesn't have a batch dimension of size %d.",
+                      output_names[i], batch_size);
+      return kTfLiteError;
+    }
+    const size_t example_bytes = tensor->bytes / batch_size;
+    const char* data = tensor->data.raw_const;
+    for (Request& request : batch) {
+      (*request.outputs)[i].assign(data, data + example_bytes);
+      data += example_bytes;
+    }
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace tflite
@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+/// \file
+///
+/// Batches the concurrent requests to a SignatureRunner.
+///
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_SIGNATURE_RUNNER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_SIGNATURE_RUNNER_H_
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <deque>
+#include <future>  // NOLINT(build/c++11)
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/signature_runner.h"
+
+namespace tflite {
+
+/// Runs the requests of concurrent callers of a signature in batches, to make
+/// better use of the vector units than running each request alone.
+///
+/// Dimension 0 of every input and output of the signature is the batch
+/// dimension, and their types have a fixed size, i.e. are not strings. A
+/// request holds a single example, i.e. the data of each input without the
+/// batch dimension. Requests are queued until `max_batch_size` of them are
+/// waiting, or the oldest one has waited for `batch_timeout`. Their inputs are
+/// then stacked along the batch dimension, the signature is invoked once, and
+/// its outputs are split back between the requests.
+///
+/// The batch size changes from one batch to the next. Building the
+/// interpreter with `InterpreterOptions::SetMaxCachedArenaPlans` lets the
+/// memory plans of the batch sizes be reused instead of planned again.
+///
+/// WARNING: This is an experimental API and subject to change.
+class BatchingSignatureRunner {
+ public:
+  struct Options {
+    int max_batch_size = 8;
+    std::chrono::microseconds batch_timeout{1000};
+  };
+
+  /// The bytes of each input or output of the signature for one example, in
+  /// the order of `input_names()` or `output_names()`.
+  using Example = std::vector<std::vector<char>>;
+
+  /// Takes the exclusive use of `runner`, which must outlive this object. The
+  /// input tensors of `runner` must be allocated, so that the size of an
+  /// example is known.
+  BatchingSignatureRunner(SignatureRunner* runner, const Options& options);
+
+  /// Runs the requests that are still queued.
+  ~BatchingSignatureRunner();
+
+  BatchingSignatureRunner(const BatchingSignatureRunner&) = delete;
+  BatchingSignatureRunner& operator=(const BatchingSignatureRunner&) = delete;
+
+  /// Queues a request with the inputs of one example. Once the returned future
+  /// is ready with kTfLiteOk, `outputs` holds the outputs of the example. It
+  /// must stay valid until then.
+  std::future<TfLiteStatus> Run(Example inputs, Example* outputs);
+
+ private:
+  struct Request {
+    Example inputs;
+    Example* outputs;
+    std::promise<TfLiteStatus> status;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  // Runs the batches until the destructor is called and the queue is empty.
+  void BatchLoop();
+
+  // Runs `batch` at once and fulfills the promises of its requests.
+  void RunBatch(std::vector<Request>& batch);
+  TfLiteStatus RunBatchImpl(std::vector<Request>& batch);
+
+  SignatureRunner* const runner_;
+  const Options options_;
+  // The dimensions of an example and its size in bytes, for each input.
+  std::vector<std::vector<int>> example_dims_;
+  std::vector<size_t> example_bytes_;
+
+  std::mutex mutex_;
+  std::condition_variable queue_changed_;
+  std::deque<Request> queue_;
+  bool stopping_ = false;
+
+  std::thread batch_thread_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_SIGNATURE_RUNNER_H_
@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_signature_runner.h"
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstring>
+#include <future>  // NOLINT(build/c++11)
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/interpreter_options.h"
+
+namespace tflite {
+namespace {
+
+BatchingSignatureRunner::Example FloatExample(float value) {
+  std::vector<char> bytes(sizeof(float));
+  std::memcpy(bytes.data(), &value, sizeof(float));
+  return {bytes};
+}
+
+float FloatOf(const BatchingSignatureRunner::Example& example) {
+  float value;
+  std::memcpy(&value, example[0].data(), sizeof(float));
+  return value;
+}
+
+class BatchingSignatureRunnerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // The "add" signature adds 2 to a vector `x`.
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/multi_signatures.bin");
+    ASSERT_NE(model_, nullptr);
+    InterpreterOptions options;
+    options.SetMaxCachedArenaPlans(4);
+    InterpreterBuilder builder(*model_, resolver_, &options);
+    ASSERT_EQ(builder(&interpreter_), kTfLiteOk);
+    runner_ = interpreter_->GetSignatureRunner("add");
+    ASSERT_NE(runner_, nullptr);
+    ASSERT_EQ(runner_->ResizeInputTensor("x", {1}), kTfLiteOk);
+    ASSERT_EQ(runner_->AllocateTensors(), kTfLiteOk);
+  }
+
+  ops::builtin::BuiltinOpResolver resolver_;
+  std::unique_ptr<FlatBufferModel> model_;
+  std::unique_ptr<Interpreter> interpreter_;
+  SignatureRunner* runner_ = nullptr;
+};
+
+TEST_F(BatchingSignatureRunnerTest, SplitsTheOutputsOfABatch) {
+  BatchingSignatureRunner::Options options;
+  options.max_batch_size = 3;
+  options.batch_timeout = std::chrono::milliseconds(10);
+  BatchingSignatureRunner batching_runner(runner_, options);
+
+  constexpr int kNumRequests = 7;
+  std::vector<BatchingSignatureRunner::Example> outputs(kNumRequests);
+  std::vector<std::future<TfLiteStatus>> statuses;
+  for (int i = 0; i < kNumRequests; ++i) {
+    statuses.push_back(batching_runner.Run(FloatExample(i), &outputs[i]));
+  }
+  for (int i = 0; i < kNumRequests; ++i) {
+    ASSERT_EQ(statuses[i].get(), kTfLiteOk);
+    EXPECT_EQ(FloatOf(outputs[i]), i + 2);
+  }
+}
+
+TEST_F(BatchingSignatureRunnerTest, RejectsInputsOfTheWrongSize) {
+  BatchingSignatureRunner batching_runner(runner_, {});
+  BatchingSignatureRunner::Example outputs;
+  EXPECT_EQ(batching_runner.Run({std::vector<char>(3)}, &outputs).get(),
+            kTfLiteError);
+  EXPECT_EQ(batching_runner.Run({}, &outputs).get(), kTfLiteError);
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,105 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/interpreter_pool/interpreter_pool.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+
+std::unique_ptr<InterpreterPool> InterpreterPool::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options) {
+  if (options.num_interpreters < 1 ||
+      options.interpreters_per_cpu_backend_context < 1) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "InterpreterPool needs at least one interpreter per pool "
+                    "and per CPU backend context.");
+    return nullptr;
+  }
+
+  std::unique_ptr<InterpreterPool> pool(new InterpreterPool());
+  TfLiteXNNPackDelegateOptions xnnpack_options =
+      TfLiteXNNPackDelegateOptionsDefault();
+  if (options.use_xnnpack) {
+    pool->weights_cache_ = TfLiteXNNPackDelegateWeightsCacheCreate();
+    if (pool->weights_cache_ == nullptr) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Failed to create the XNNPACK weights cache.");
+      return nullptr;
+    }
+    xnnpack_options.num_threads = options.num_threads_per_interpreter;
+    xnnpack_options.weights_cache = pool->weights_cache_;
+  }
+
+  for (int i = 0; i < options.num_interpreters; ++i) {
+    if (i % options.interpreters_per_cpu_backend_context == 0) {
+      pool->cpu_backend_contexts_.push_back(
+          std::make_unique<ExternalCpuBackendContext>());
+    }
+    std::unique_ptr<Interpreter> interpreter;
+    InterpreterBuilder builder(model, op_resolver);
+    builder.SetNumThreads(options.num_threads_per_interpreter);
+    if (builder(&interpreter) != kTfLiteOk) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Failed to build interpreter %d.", i);
+      return nullptr;
+    }
+    interpreter->SetExternalContext(kTfLiteCpuBackendContext,
+                                    pool->cpu_backend_contexts_.back().get());
+    if (options.use_xnnpack) {
+      Interpreter::TfLiteDelegatePtr delegate(
+          TfLiteXNNPackDelegateCreate(&xnnpack_options),
+          TfLiteXNNPackDelegateDelete);
+      if (interpreter->ModifyGraphWithDelegate(std::move(delegate)) !=
+          kTfLiteOk) {
+        TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                        "Failed to apply XNNPACK to interpreter %d.", i);
+        return nullptr;
+      }
+    }
+    pool->interpreters_.push_back(std::move(interpreter));
+  }
+
+  // All the weights are packed now, the cache can release its spare memory.
+  if (options.use_xnnpack &&
+      !TfLiteXNNPackDelegateWeightsCacheFinalizeHard(pool->weights_cache_)) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Failed to finalize the XNNPACK weights cache.");
+    return nullptr;
+  }
+  for (int i = 0; i < pool->size(); ++i) {
+    if (pool->interpreter(i)->AllocateTensors() != kTfLiteOk) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Failed to allocate the tensors of interpreter %d.", i);
+      return nullptr;
+    }
+  }
+  return pool;
+}
+
+InterpreterPool::~InterpreterPool() {
+  // The interpreters own the delegates, which use the weights cache.
+  interpreters_.clear();
+  cpu_backend_contexts_.clear();
+  if (weights_cache_ != nullptr) {
+    TfLiteXNNPackDelegateWeightsCacheDelete(weights_cache_);
+  }
+}
+
+}  // namespace tflite
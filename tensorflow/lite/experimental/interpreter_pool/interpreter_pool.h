@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+/// \file
+///
+/// A pool of interpreters of the same model that share their read-only and
+/// scratch memory.
+///
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_INTERPRETER_POOL_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_INTERPRETER_POOL_INTERPRETER_POOL_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+#include "tensorflow/lite/op_resolver.h"
+
+namespace tflite {
+
+/// Builds several interpreters of one `FlatBufferModel`, e.g. one per serving
+/// thread, without multiplying the memory of the model:
+///
+/// * All the interpreters apply an XNNPACK delegate which uses a single
+///   weights cache, so that the static weights are packed only once.
+/// * Each group of `interpreters_per_cpu_backend_context` consecutive
+///   interpreters shares one CPU backend context, and with it the scratch
+///   memory and thread pool of the builtin kernels. The interpreters of a group
+///   must never be invoked concurrently, e.g. because they are only used by the
+///   same thread.
+///
+/// The op resolver should not apply XNNPACK by default, e.g.
+/// `ops::builtin::BuiltinOpResolverWithoutDefaultDelegates`, since the pool
+/// applies its own XNNPACK delegate.
+///
+/// WARNING: This is an experimental API and subject to change.
+class InterpreterPool {
+ public:
+  struct Options {
+    int num_interpreters = 1;
+    int num_threads_per_interpreter = 1;
+    int interpreters_per_cpu_backend_context = 1;
+    bool use_xnnpack = true;
+  };
+
+  /// Returns nullptr if any of the interpreters fails to be built or
+  /// delegated. `model` and `op_resolver` must outlive the pool.
+  static std::unique_ptr<InterpreterPool> Create(const FlatBufferModel& model,
+                                                 const OpResolver& op_resolver,
+                                                 const Options& options);
+
+  ~InterpreterPool();
+
+  int size() const { return interpreters_.size(); }
+
+  /// The interpreters have their tensors allocated and can be invoked as soon
+  /// as their inputs are set.
+  Interpreter* interpreter(int index) { return interpreters_[index].get(); }
+
+ private:
+  InterpreterPool() = default;
+
+  // Outlive the interpreters which use them.
+  TfLiteXNNPackDelegateWeightsCache* weights_cache_ = nullptr;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      cpu_backend_contexts_;
+  std::vector<std::unique_ptr<Interpreter>> interpreters_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_INTERPRETER_POOL_INTERPRETER_POOL_H_
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/interpreter_pool/interpreter_pool.h"
+
+#include <cstdint>
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+// Every output of the model is the sum of three of its four inputs.
+void InvokeMultiAdd(Interpreter* interpreter, float value) {
+  ASSERT_EQ(interpreter->inputs().size(), 4);
+  for (int input : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(input);
+    for (int64_t i = 0; i < NumElements(tensor); ++i) {
+      tensor->data.f[i] = value;
+    }
+  }
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  for (int output : interpreter->outputs()) {
+    const TfLiteTensor* tensor = interpreter->tensor(output);
+    for (int64_t i = 0; i < NumElements(tensor); ++i) {
+      EXPECT_EQ(tensor->data.f[i], 3 * value);
+    }
+  }
+}
+
+class InterpreterPoolTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(InterpreterPoolTest, InterpretersRunIndependently) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_NE(model, nullptr);
+
+  InterpreterPool::Options options;
+  options.num_interpreters = 4;
+  options.interpreters_per_cpu_backend_context = 2;
+  options.use_xnnpack = GetParam();
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates op_resolver;
+  std::unique_ptr<InterpreterPool> pool =
+      InterpreterPool::Create(*model, op_resolver, options);
+  ASSERT_NE(pool, nullptr);
+  ASSERT_EQ(pool->size(), 4);
+
+  for (int i = 0; i < pool->size(); ++i) {
+    InvokeMultiAdd(pool->interpreter(i), /*value=*/i + 1);
+  }
+  // Interpreters sharing a CPU backend context can run one after the other.
+  InvokeMultiAdd(pool->interpreter(1), /*value=*/5);
+  InvokeMultiAdd(pool->interpreter(0), /*value=*/6);
+}
+
+INSTANTIATE_TEST_SUITE_P(InterpreterPoolTest, InterpreterPoolTest,
+                         ::testing::Bool());
+
+TEST(InterpreterPoolCreateTest, NeedsAnInterpreter) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_NE(model, nullptr);
+
+  InterpreterPool::Options options;
+  options.num_interpreters = 0;
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates op_resolver;
+  EXPECT_EQ(InterpreterPool::Create(*model, op_resolver, options), nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
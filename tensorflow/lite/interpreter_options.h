@@ -29,7 +29,11 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_max_cached_arena_plans_(0),
+        experimental_num_inter_op_threads_(1),
+        experimental_advise_model_paging_(false),
+        experimental_lock_hot_model_weights_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +97,75 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  /// Keeps the memory plans of the last `value` input sizes, so that
+  /// `AllocateTensors` after `ResizeInputTensor` reuses a plan when the tensors
+  /// fit in it instead of planning them again. Allocating the tensors once for
+  /// the largest input sizes, e.g. the maximum sequence length, lets every
+  /// smaller size reuse that plan, and the arena is never reallocated.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetMaxCachedArenaPlans(int value) {
+    experimental_max_cached_arena_plans_ = value;
+  }
+
+  /// Returns the number of memory plans kept by each subgraph.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetMaxCachedArenaPlans() { return experimental_max_cached_arena_plans_; }
+
+  /// Runs independent nodes of each subgraph concurrently on `value` threads,
+  /// including the thread calling `Invoke`. Two nodes are independent if none
+  /// of them writes the memory the other one accesses, so tensors sharing arena
+  /// memory across their lifetimes order the nodes too.
+  ///
+  /// Subgraphs with dynamic tensors, delegate buffer handles or a profiler run
+  /// sequentially. Delegated nodes, control flow nodes and nodes using resource
+  /// or variant tensors run one at a time. The other kernels must not rely on
+  /// state shared across nodes other than the CPU backend context, which each
+  /// thread has its own copy of.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetNumInterOpThreads(int value) {
+    experimental_num_inter_op_threads_ = value;
+  }
+
+  /// Returns the number of threads running the nodes of each subgraph.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetNumInterOpThreads() { return experimental_num_inter_op_threads_; }
+
+  /// Gives paging hints for the constant tensors of a memory mapped model at
+  /// the first invocation, and again after the graph is delegated. The buffers
+  /// read by the CPU kernels are read ahead, and the buffers only read by
+  /// delegate kernels, which usually copy or pack them when they are prepared,
+  /// are released from the resident memory. They are read again from the model
+  /// file if a delegate uses them anyway.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetAdviseModelPaging(bool value = true) {
+    experimental_advise_model_paging_ = value;
+  }
+
+  /// Returns if the `experimental_advise_model_paging_` feature is enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetAdviseModelPaging() { return experimental_advise_model_paging_; }
+
+  /// Also locks the buffers read by the CPU kernels in memory, see
+  /// `SetAdviseModelPaging`, so that they are never paged out. Locking fails
+  /// with a warning when it exceeds the limit of locked memory of the process.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetLockHotModelWeights(bool value = true) {
+    experimental_lock_hot_model_weights_ = value;
+  }
+
+  /// Returns if the `experimental_lock_hot_model_weights_` feature is enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetLockHotModelWeights() { return experimental_lock_hot_model_weights_; }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  int experimental_max_cached_arena_plans_;
+  int experimental_num_inter_op_threads_;
+  bool experimental_advise_model_paging_;
+  bool experimental_lock_hot_model_weights_;
 };
 
 }  // namespace tflite
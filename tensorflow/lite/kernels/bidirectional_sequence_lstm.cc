@@ -1198,7 +1198,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context),
+          /*input_to_gate_weights=*/nullptr,
+          /*input_to_gate_weights_are_constant=*/false);
       TF_LITE_ENSURE_OK(context, fw_pass_status);
 
       TfLiteStatus bw_pass_status = lstm_eval::EvalFloat(
@@ -1224,7 +1226,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context),
+          /*input_to_gate_weights=*/nullptr,
+          /*input_to_gate_weights_are_constant=*/false);
       TF_LITE_ENSURE_OK(context, bw_pass_status);
       return kTfLiteOk;
     }
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/reference/reference_ops.h"
@@ -60,9 +61,10 @@ TfLiteStatus EvalImpl(TfLiteContext* context, TfLiteNode* node, int axis,
                                    all_inputs.data(), GetTensorShape(output), \
                                    GetTensorData<scalar>(output));            \
     } else {                                                                  \
-      optimized_ops::Concatenation(op_params, all_inputs.shapes(),            \
-                                   all_inputs.data(), GetTensorShape(output), \
-                                   GetTensorData<scalar>(output));            \
+      optimized_ops::Concatenation(                                           \
+          op_params, all_inputs.shapes(), all_inputs.data(),                  \
+          GetTensorShape(output), GetTensorData<scalar>(output),              \
+          CpuBackendContext::GetFromContext(context));                        \
     }                                                                         \
   }
 
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_THREADPOOL_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_THREADPOOL_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
@@ -55,6 +59,50 @@ void Execute(int tasks_count, TaskType* tasks,
 
 #endif
 
+template <typename Function>
+class ParallelForTask : public Task {
+ public:
+  ParallelForTask(const Function* function, int64_t begin, int64_t end)
+      : function_(function), begin_(begin), end_(end) {}
+
+  void Run() override { (*function_)(begin_, end_); }
+
+ private:
+  const Function* function_;
+  int64_t begin_;
+  int64_t end_;
+};
+
+// Calls `function(begin, end)` on disjoint ranges which cover [0, size), in
+// parallel on the threads of `cpu_backend_context`. Each range has at least
+// `min_size_per_task` elements, so that small sizes run on the calling thread
+// and don't pay for the synchronization of the thread pool.
+template <typename Function>
+void ParallelFor(int64_t size, int64_t min_size_per_task,
+                 const Function& function,
+                 CpuBackendContext* cpu_backend_context) {
+  if (size <= 0) {
+    return;
+  }
+  min_size_per_task = std::max<int64_t>(min_size_per_task, 1);
+  const int tasks_count = static_cast<int>(
+      std::min<int64_t>(cpu_backend_context->max_num_threads(),
+                        std::max<int64_t>(size / min_size_per_task, 1)));
+  if (tasks_count <= 1) {
+    function(0, size);
+    return;
+  }
+  std::vector<ParallelForTask<Function>> tasks;
+  tasks.reserve(tasks_count);
+  int64_t begin = 0;
+  for (int i = 0; i < tasks_count; ++i) {
+    const int64_t end = begin + (size - begin) / (tasks_count - i);
+    tasks.emplace_back(&function, begin, end);
+    begin = end;
+  }
+  Execute(tasks.size(), tasks.data(), cpu_backend_context);
+}
+
 }  // namespace cpu_backend_threadpool
 }  // namespace tflite
 
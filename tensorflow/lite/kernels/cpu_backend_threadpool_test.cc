@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 
+#include <cstdint>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -89,6 +90,38 @@ TEST(CpuBackendThreadpoolTest, TenThreadsSize1234567) {
   TestGenerateArrayOfIncrementingInts(10, 1234567);
 }
 
+TEST(CpuBackendThreadpoolTest, ParallelForCoversTheRange) {
+  CpuBackendContext context;
+  context.SetMaxNumThreads(4);
+  std::vector<int> buffer(1001);
+  cpu_backend_threadpool::ParallelFor(
+      buffer.size(), /*min_size_per_task=*/100,
+      [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          buffer[i] += i;
+        }
+      },
+      &context);
+  for (int i = 0; i < buffer.size(); i++) {
+    ASSERT_EQ(buffer[i], i);
+  }
+}
+
+TEST(CpuBackendThreadpoolTest, ParallelForRunsSmallSizesInOneRange) {
+  CpuBackendContext context;
+  context.SetMaxNumThreads(4);
+  int num_ranges = 0;
+  cpu_backend_threadpool::ParallelFor(
+      /*size=*/99, /*min_size_per_task=*/100,
+      [&](int64_t begin, int64_t end) {
+        ++num_ranges;
+        EXPECT_EQ(begin, 0);
+        EXPECT_EQ(end, 99);
+      },
+      &context);
+  EXPECT_EQ(num_ranges, 1);
+}
+
 }  // namespace
 
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/kernels/internal/types.h"
@@ -164,7 +165,8 @@ TfLiteStatus Gather(TfLiteContext* context, const TfLiteGatherParams& params,
       op_params, GetTensorShape(input), GetTensorData<InputT>(input),
       GetTensorShape(positions), GetTensorData<PositionsT>(positions),
       GetTensorShape(output), GetTensorData<InputT>(output),
-      (input->type == kTfLiteInt4));
+      (input->type == kTfLiteInt4),
+      CpuBackendContext::GetFromContext(context));
 }
 
 template <typename PositionT>
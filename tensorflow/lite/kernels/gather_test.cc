@@ -174,6 +174,31 @@ TEST_P(GatherOpTest, Test2DIndexWith2DResult) {
   EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 2}));
 }
 
+TEST(GatherOpMultithreadedTest, LargeInputOnSeveralThreads) {
+  constexpr int kRows = 64;
+  constexpr int kRowSize = 1024;
+  std::vector<float> input(kRows * kRowSize);
+  for (int i = 0; i < input.size(); ++i) {
+    input[i] = i;
+  }
+  std::vector<int32_t> positions(kRows);
+  for (int i = 0; i < kRows; ++i) {
+    positions[i] = kRows - 1 - i;
+  }
+  GatherOpModel<float, int32_t> m({TensorType_FLOAT32, {kRows, kRowSize}},
+                                  {TensorType_INT32, {kRows}},
+                                  /*constant_tensor=*/false, input, positions);
+  m.SetNumThreads(4);
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  std::vector<float> expected;
+  for (int i = 0; i < kRows; ++i) {
+    const float* row = input.data() + positions[i] * kRowSize;
+    expected.insert(expected.end(), row, row + kRowSize);
+  }
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(expected));
+}
+
 TEST_P(GatherOpTest, Duplicate) {
   bool constant_tensor = GetParam();
   GatherOpModel<float, int32_t> m({TensorType_FLOAT32, {1, 2, 2}},
@@ -20,6 +20,7 @@ limitations under the License.
 #include <sys/types.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
 #include <limits>
@@ -8337,6 +8338,132 @@ inline void AddN(const RuntimeShape& input_shape, const size_t num_inputs,
   }
 }
 
+// The memory-bound ops below copy at least this many bytes per task of the
+// thread pool. Smaller copies run on the calling thread.
+constexpr int64_t kMinCopyBytesPerTask = 64 * 1024;
+
+// Same as reference_ops::Gather, with the gathered slices split across the
+// threads of `cpu_backend_context`.
+template <typename T, typename CoordsT>
+inline TfLiteStatus Gather(const tflite::GatherParams& op_params,
+                           const RuntimeShape& input_shape, const T* input_data,
+                           const RuntimeShape& coords_shape,
+                           const CoordsT* coords_data,
+                           const RuntimeShape& output_shape, T* output_data,
+                           bool int4_input,
+                           CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Gather/Multithreaded");
+  int axis = op_params.axis;
+  if (axis < 0) {
+    axis += input_shape.DimensionsCount();
+  }
+  TFLITE_DCHECK_GE(axis, 0);
+  TFLITE_DCHECK_LT(axis, input_shape.DimensionsCount());
+
+  int batch_dims = op_params.batch_dims;
+  if (batch_dims < 0) {
+    batch_dims += coords_shape.DimensionsCount();
+  }
+  TFLITE_DCHECK_GE(batch_dims, 0);
+  TFLITE_DCHECK_LT(batch_dims, input_shape.DimensionsCount());
+  TFLITE_DCHECK_LE(batch_dims, coords_shape.DimensionsCount());
+  TFLITE_DCHECK_GE(axis, batch_dims);
+
+  const int64_t axis_size = input_shape.Dims(axis);
+  int64_t outer_size = 1;
+  for (int i = 0; i < axis; ++i) {
+    outer_size *= input_shape.Dims(i);
+  }
+  int64_t batch_outer_size = 1;
+  for (int i = batch_dims; i < axis; ++i) {
+    batch_outer_size *= input_shape.Dims(i);
+  }
+  int64_t inner_size = 1;
+  for (int i = axis + 1; i < input_shape.DimensionsCount(); ++i) {
+    inner_size *= input_shape.Dims(i);
+  }
+  if (int4_input) {
+    TFLITE_DCHECK_EQ(inner_size % 2, 0);
+    inner_size /= 2;
+  }
+  int64_t coord_size = 1;
+  for (int i = batch_dims; i < coords_shape.DimensionsCount(); ++i) {
+    coord_size *= coords_shape.Dims(i);
+  }
+
+  // Slice `s` of the output is slice `coords_data[...]` along the axis of the
+  // outer index `s / coord_size`, which belongs to the batch
+  // `s / coord_size / batch_outer_size`.
+  const int64_t flat_size = input_shape.FlatSize();
+  const int64_t num_slices = outer_size * coord_size;
+  const int64_t slice_bytes = sizeof(T) * inner_size;
+  std::atomic<bool> out_of_bounds(false);
+  cpu_backend_threadpool::ParallelFor(
+      num_slices, kMinCopyBytesPerTask / std::max<int64_t>(slice_bytes, 1),
+      [&](int64_t begin, int64_t end) {
+        for (int64_t s = begin; s < end; ++s) {
+          const int64_t outer = s / coord_size;
+          const int64_t batch = outer / batch_outer_size;
+          const int64_t from_pos =
+              (outer * axis_size +
+               coords_data[batch * coord_size + s % coord_size]) *
+              inner_size;
+          if (from_pos < 0 || from_pos + inner_size > flat_size) {
+            out_of_bounds = true;
+            return;
+          }
+          std::memcpy(output_data + s * inner_size, input_data + from_pos,
+                      slice_bytes);
+        }
+      },
+      cpu_backend_context);
+  return out_of_bounds ? kTfLiteError : kTfLiteOk;
+}
+
+// Same as reference_ops::Concatenation, with the outer dimensions split across
+// the threads of `cpu_backend_context`.
+template <typename Scalar>
+inline void Concatenation(const ConcatenationParams& params,
+                          const RuntimeShape* const* input_shapes,
+                          const Scalar* const* input_data,
+                          const RuntimeShape& output_shape,
+                          Scalar* output_data,
+                          CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("Concatenation/Multithreaded");
+  const int axis = params.axis;
+  const int inputs_count = params.inputs_count;
+  const int concat_dimensions = output_shape.DimensionsCount();
+  TFLITE_DCHECK_LT(axis, concat_dimensions);
+
+  int64_t outer_size = 1;
+  for (int i = 0; i < axis; ++i) {
+    outer_size *= output_shape.Dims(i);
+  }
+  int64_t base_inner_size = 1;
+  for (int i = axis + 1; i < concat_dimensions; ++i) {
+    base_inner_size *= output_shape.Dims(i);
+  }
+  const int64_t output_row_size = output_shape.Dims(axis) * base_inner_size;
+
+  cpu_backend_threadpool::ParallelFor(
+      outer_size,
+      kMinCopyBytesPerTask /
+          std::max<int64_t>(sizeof(Scalar) * output_row_size, 1),
+      [&](int64_t begin, int64_t end) {
+        Scalar* output_ptr = output_data + begin * output_row_size;
+        for (int64_t k = begin; k < end; ++k) {
+          for (int i = 0; i < inputs_count; ++i) {
+            const int64_t copy_size =
+                input_shapes[i]->Dims(axis) * base_inner_size;
+            std::memcpy(output_ptr, input_data[i] + k * copy_size,
+                        copy_size * sizeof(Scalar));
+            output_ptr += copy_size;
+          }
+        }
+      },
+      cpu_backend_context);
+}
+
 }  // namespace optimized_ops
 }  // namespace tflite
 
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
 namespace tflite {
@@ -286,6 +287,87 @@ void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
   }  // for batch
 }
 
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x4Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  constexpr int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      // The blocks of a row are contiguous in the matrix, two of them are
+      // multiplied at once with the vector blocks they apply to.
+      __m256 acc_32x8 = _mm256_setzero_ps();
+      int i = segments[row];
+      for (; i + 1 < segments[row + 1]; i += 2) {
+        const __m256 vector_f32x8 = _mm256_set_m128(
+            _mm_loadu_ps(vector_in_batch + indices[i + 1] * kBlockSize),
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize));
+        const __m256 matrix_f32x8 = _mm256_loadu_ps(matrix_ptr);
+        acc_32x8 =
+            _mm256_add_ps(acc_32x8, _mm256_mul_ps(vector_f32x8, matrix_f32x8));
+        matrix_ptr += 2 * kBlockSize;
+      }
+      __m128 acc_32x4 = _mm_add_ps(_mm256_extractf128_ps(acc_32x8, 0),
+                                   _mm256_extractf128_ps(acc_32x8, 1));
+      if (i < segments[row + 1]) {
+        const __m128 vector_f32x4 =
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize);
+        acc_32x4 = _mm_add_ps(
+            acc_32x4, _mm_mul_ps(vector_f32x4, _mm_loadu_ps(matrix_ptr)));
+        matrix_ptr += kBlockSize;
+      }
+      result[batch * m_rows + row] += ReduceFloat32x4(acc_32x4);
+    }
+  }
+}
+
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x16Impl(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  constexpr int kBlockSize = 16;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  // The vector values plus the input offset fit in 16 bits, and so do the
+  // pairwise sums of their products with the matrix values.
+  const __m256i input_offset_16x16 = _mm256_set1_epi16(input_offset);
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = matrix;
+    const int8_t* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      __m256i dotprod_32x8 = _mm256_setzero_si256();
+      for (int i = segments[row]; i < segments[row + 1]; ++i) {
+        const __m128i vector_8x16 = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(vector_in_batch +
+                                             indices[i] * kBlockSize));
+        const __m256i vector_16x16 = _mm256_add_epi16(
+            _mm256_cvtepi8_epi16(vector_8x16), input_offset_16x16);
+        const __m256i matrix_16x16 = _mm256_cvtepi8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(matrix_ptr)));
+        dotprod_32x8 = _mm256_add_epi32(
+            dotprod_32x8, _mm256_madd_epi16(vector_16x16, matrix_16x16));
+        matrix_ptr += kBlockSize;
+      }
+      int32_t dot_prod = ReduceInt32x4(
+          _mm_add_epi32(_mm256_extracti128_si256(dotprod_32x8, 0),
+                        _mm256_extracti128_si256(dotprod_32x8, 1)));
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      dot_prod = MultiplyByQuantizedMultiplier(dot_prod + bias_value,
+                                               output_multiplier, output_shift);
+      dot_prod += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              dot_prod, output_activation_min, output_activation_max));
+    }
+  }
+}
+
 #endif  // __AVX2__
 
 void SseMatrixBatchVectorMultiplyAccumulateImpl(
@@ -80,8 +80,13 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const float* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+#if defined(__AVX2__)
+  Avx2SparseMatrixBatchVectorMultiplyAccumulate1x4Impl(
+      matrix, segments, indices, m_rows, m_cols, vector, n_batch, result);
+#else
   NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate1x4, matrix,
                    segments, indices, m_rows, m_cols, vector, n_batch, result);
+#endif
 }
 
 void SparseMatrixBatchVectorMultiplyAccumulate1x16(
@@ -92,11 +97,18 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int32_t output_shift, const int32_t output_offset,
     const int32_t output_activation_min, const int32_t output_activation_max,
     int8_t* __restrict__ result) {
+#if defined(__AVX2__)
+  Avx2SparseMatrixBatchVectorMultiplyAccumulate1x16Impl(
+      matrix, segments, indices, m_rows, m_cols, vector, bias_vector, n_batch,
+      input_offset, output_multiplier, output_shift, output_offset,
+      output_activation_min, output_activation_max, result);
+#else
   NEON_OR_PORTABLE(SparseMatrixBatchVectorMultiplyAccumulate1x16, matrix,
                    segments, indices, m_rows, m_cols, vector, bias_vector,
                    n_batch, input_offset, output_multiplier, output_shift,
                    output_offset, output_activation_min, output_activation_max,
                    result);
+#endif
 }
 
 void SparseMatrixBatchVectorMultiplyAccumulate(
@@ -40,6 +40,22 @@ void Avx2MatrixBatchVectorMultiplyAccumulateImpl(
     float* __restrict__ result, const float* per_channel_scale,
     const int32_t* input_offset, int32_t* scratch, int32_t* row_sums,
     bool* compute_row_sums, CpuBackendContext* context);
+
+// Sparse matrix multiplication for float values with 1x4 blocks.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x4Impl(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
+// Sparse matrix multiplication for quantized values with 1x16 blocks.
+void Avx2SparseMatrixBatchVectorMultiplyAccumulate1x16Impl(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    const int32_t output_shift, const int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
 #endif  // defined(__AVX2__)
 
 #ifdef __SSSE3__
@@ -1554,6 +1554,91 @@ TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
               ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
 }
 
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x4Test) {
+  const int kRow = 3;
+  const int kCol = 20;
+  const int kBatch = 2;
+  // Blocks of 4 columns: {0, 2, 4} in the 1st row, none in the 2nd row and
+  // {1, 3} in the 3rd row, so rows have an odd and an even number of blocks.
+  const int32_t segments[] = {0, 3, 3, 5};
+  const int32_t indices[] = {0, 2, 4, 1, 3};
+  std::vector<float> matrix_values(5 * 4);
+  for (int i = 0; i < matrix_values.size(); ++i) {
+    matrix_values[i] = 0.5f * (i % 7) - 1.0f;
+  }
+  std::vector<float> vector(kBatch * kCol);
+  for (int i = 0; i < vector.size(); ++i) {
+    vector[i] = 0.25f * (i % 5) - 0.5f;
+  }
+
+  std::vector<float> expected(kRow * kBatch, 1.0f);
+  for (int batch = 0; batch < kBatch; ++batch) {
+    const float* block = matrix_values.data();
+    for (int row = 0; row < kRow; ++row) {
+      for (int i = segments[row]; i < segments[row + 1]; ++i) {
+        for (int c = 0; c < 4; ++c) {
+          expected[batch * kRow + row] +=
+              *block++ * vector[batch * kCol + indices[i] * 4 + c];
+        }
+      }
+    }
+  }
+
+  std::vector<float> output(kRow * kBatch, 1.0f);
+  SparseMatrixBatchVectorMultiplyAccumulate1x4(
+      matrix_values.data(), segments, indices, kRow, kCol, vector.data(),
+      kBatch, output.data());
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear(expected, 1e-5)));
+}
+
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x16Test) {
+  const int kRow = 3;
+  const int kCol = 64;
+  const int kBatch = 2;
+  const int32_t segments[] = {0, 2, 2, 5};
+  const int32_t indices[] = {0, 3, 0, 1, 2};
+  std::vector<int8_t> matrix_values(5 * 16);
+  for (int i = 0; i < matrix_values.size(); ++i) {
+    matrix_values[i] = static_cast<int8_t>((i * 37) % 256 - 128);
+  }
+  std::vector<int8_t> vector(kBatch * kCol);
+  for (int i = 0; i < vector.size(); ++i) {
+    vector[i] = static_cast<int8_t>((i * 53) % 256 - 128);
+  }
+  const int32_t bias[] = {1000, -2000, 3000};
+  const int32_t input_offset = 128;
+  const int32_t output_multiplier = 1 << 30;
+  const int32_t output_shift = -10;
+  const int32_t output_offset = -3;
+
+  std::vector<int8_t> expected(kRow * kBatch);
+  for (int batch = 0; batch < kBatch; ++batch) {
+    const int8_t* block = matrix_values.data();
+    for (int row = 0; row < kRow; ++row) {
+      int32_t dot_prod = bias[row];
+      for (int i = segments[row]; i < segments[row + 1]; ++i) {
+        for (int c = 0; c < 16; ++c) {
+          dot_prod += *block++ * (vector[batch * kCol + indices[i] * 16 + c] +
+                                  input_offset);
+        }
+      }
+      dot_prod = MultiplyByQuantizedMultiplier(dot_prod, output_multiplier,
+                                               output_shift) +
+                 output_offset;
+      expected[batch * kRow + row] =
+          static_cast<int8_t>(std::min(std::max(dot_prod, -128), 127));
+    }
+  }
+
+  std::vector<int8_t> output(kRow * kBatch);
+  SparseMatrixBatchVectorMultiplyAccumulate1x16(
+      matrix_values.data(), segments, indices, kRow, kCol, vector.data(), bias,
+      kBatch, input_offset, output_multiplier, output_shift, output_offset,
+      /*output_activation_min=*/-128, /*output_activation_max=*/127,
+      output.data());
+  EXPECT_THAT(output, ElementsAreArray(expected));
+}
+
 #ifdef __ANDROID__
 TEST(uKernels,
      SparseMatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
@@ -2330,4 +2415,74 @@ BENCHMARK(BM_DotprodFloatMultiply)
     ->Args({2048, 2048, 5})
     ->Args({2048, 2048, 8});
 
+// Multiplies a matrix with 1 in `sparsity` blocks of 1x4 values kept.
+void BM_SparseFloatMultiply1x4(benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  const int batch = state.range(2);
+  const int sparsity = state.range(3);
+  std::vector<int32_t> segments = {0};
+  std::vector<int32_t> indices;
+  for (int row = 0; row < rows; ++row) {
+    for (int block = row % sparsity; block < cols / 4; block += sparsity) {
+      indices.push_back(block);
+    }
+    segments.push_back(indices.size());
+  }
+  std::vector<float> matrix(indices.size() * 4, 1.0);
+  std::vector<float> vector(cols * batch, 0.3);
+  std::vector<float> output(rows * batch);
+  for (auto _ : state) {
+    std::fill(output.begin(), output.end(), 0.0);
+    tflite::tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x4(
+        matrix.data(), segments.data(), indices.data(), rows, cols,
+        vector.data(), batch, output.data());
+    testing::DoNotOptimize(output[0]);
+  }
+}
+
+BENCHMARK(BM_SparseFloatMultiply1x4)
+    ->Args({256, 256, 1, 2})
+    ->Args({1024, 1024, 1, 2})
+    ->Args({1024, 1024, 1, 4})
+    ->Args({1024, 1024, 4, 4})
+    ->Args({2048, 2048, 1, 4})
+    ->Args({2048, 2048, 8, 4});
+
+// Multiplies a matrix with 1 in `sparsity` blocks of 1x16 values kept.
+void BM_SparseInt8Multiply1x16(benchmark::State& state) {
+  const int rows = state.range(0);
+  const int cols = state.range(1);
+  const int batch = state.range(2);
+  const int sparsity = state.range(3);
+  std::vector<int32_t> segments = {0};
+  std::vector<int32_t> indices;
+  for (int row = 0; row < rows; ++row) {
+    for (int block = row % sparsity; block < cols / 16; block += sparsity) {
+      indices.push_back(block);
+    }
+    segments.push_back(indices.size());
+  }
+  std::vector<int8_t> matrix(indices.size() * 16, 3);
+  std::vector<int8_t> vector(cols * batch, -5);
+  std::vector<int8_t> output(rows * batch);
+  for (auto _ : state) {
+    tflite::tensor_utils::SparseMatrixBatchVectorMultiplyAccumulate1x16(
+        matrix.data(), segments.data(), indices.data(), rows, cols,
+        vector.data(), /*bias_vector=*/nullptr, batch, /*input_offset=*/1,
+        /*output_multiplier=*/1 << 30, /*output_shift=*/-4,
+        /*output_offset=*/0, /*output_activation_min=*/-128,
+        /*output_activation_max=*/127, output.data());
+    testing::DoNotOptimize(output[0]);
+  }
+}
+
+BENCHMARK(BM_SparseInt8Multiply1x16)
+    ->Args({256, 256, 1, 2})
+    ->Args({1024, 1024, 1, 2})
+    ->Args({1024, 1024, 1, 4})
+    ->Args({1024, 1024, 4, 4})
+    ->Args({2048, 2048, 1, 4})
+    ->Args({2048, 2048, 8, 4});
+
 #endif  // DOTPROD_BENCHMARKS
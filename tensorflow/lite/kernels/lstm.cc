@@ -1934,7 +1934,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           /*recurrent_to_forget_is_diag=*/false,
           /*recurrent_to_cell_is_diag=*/false,
           /*recurrent_to_output_is_diag=*/false,
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context),
+          /*input_to_gate_weights=*/nullptr,
+          /*input_to_gate_weights_are_constant=*/false);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
@@ -69,6 +69,29 @@ void MatrixBatchVectorMultiplyAccumulate(
   }
 }
 
+// Computes the products of the concatenated input weights of the gates with
+// `n_rows` consecutive input vectors, one row of 'n_gate_rows' per vector.
+void ProjectInputsFloat(const float* input_to_gate_weights,
+                        bool input_to_gate_weights_are_constant,
+                        const float* input, int n_rows, int n_input,
+                        int n_gate_rows, float* input_projection,
+                        CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("ProjectInputsFloat");
+  tflite::FullyConnectedParams float_fc_params;
+  float_fc_params.float_activation_min = std::numeric_limits<float>::lowest();
+  float_fc_params.float_activation_max = std::numeric_limits<float>::max();
+  float_fc_params.lhs_cacheable = input_to_gate_weights_are_constant;
+  float_fc_params.rhs_cacheable = false;
+
+  tflite::RuntimeShape weight_shape({n_gate_rows, n_input});
+  tflite::RuntimeShape input_shape({n_rows, n_input});
+  tflite::RuntimeShape output_shape({n_rows, n_gate_rows});
+  tflite::optimized_ops::FullyConnected(
+      float_fc_params, input_shape, input, weight_shape, input_to_gate_weights,
+      output_shape, nullptr, output_shape, input_projection,
+      cpu_backend_context);
+}
+
 void ComputeRowSums(
     int32_t* input_to_input_row_sums, int32_t* input_to_forget_row_sums,
     int32_t* input_to_cell_row_sums, int32_t* input_to_output_row_sums,
@@ -181,6 +204,8 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   cell_to_gate_weights      | n_cell               | y (peephole)
 //   gate_bias                 | n_cell               |
 //   layer_norm_coefficients   | n_cell               | y (layer norm)
+// Precomputed input_to_gate_weights * input, instead of computing it:
+//   input_projection          | n_cell               | y
 // Output vector:
 //   gate                      | n_cell               |
 // Scalar parameters:
@@ -189,8 +214,11 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//   input_projection_stride                    - distance between the batches
+//                                                of input_projection.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
+    const float* input_projection, const int input_projection_stride,
     const float* aux_input, const float* aux_input_to_gate_weights,
     const float* output_state, const float* recurrent_to_gate_weights,
     const float* cell_state, const float* cell_to_gate_weights,
@@ -210,10 +238,18 @@ inline void CalculateLstmGateFloat(
   } else {
     tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
   }
-  // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
+  // For each batch and cell: compute input_weight * input, or add it if it is
+  // precomputed. Skip if input is all zeros.
   float* accumulation_buffer = gate;
-  if (!is_input_all_zeros) {
+  if (input_projection != nullptr) {
+    for (int b = 0; b < n_batch; ++b) {
+      const float* projection = input_projection + b * input_projection_stride;
+      float* gate_batch = gate + b * n_cell;
+      for (int c = 0; c < n_cell; ++c) {
+        gate_batch[c] += projection[c];
+      }
+    }
+  } else if (!is_input_all_zeros) {
     MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
                                         accumulation_buffer, output, n_cell,
                                         n_input, n_batch, context);
@@ -863,6 +899,11 @@ void CalculateLstmOutputInteger8x8_8(
 //   cell_layer_norm_coefficients_ptr   - optional
 //   output_layer_norm_coefficients_ptr - optional
 //
+// Precomputed products of the input weights and the input, if not null, of
+// size 'n_batch * n_gates * n_cell' with the gates in the order input (unless
+// CIFG), forget, cell, output:
+//   input_projection_ptr              - optional
+//
 // The pointers to the cell and output state and the output are updated.
 //
 // The pointers input_ptr, aux_input_ptr, and output_ptr point to data aligned
@@ -877,7 +918,8 @@ void CalculateLstmOutputInteger8x8_8(
 // contiguous, and we manually loop over the batched outputs.
 // LINT.IfChange
 inline void LstmStepFloat(
-    const float* input_ptr, const float* input_to_input_weights_ptr,
+    const float* input_ptr, const float* input_projection_ptr,
+    const float* input_to_input_weights_ptr,
     const float* input_to_forget_weights_ptr,
     const float* input_to_cell_weights_ptr,
     const float* input_to_output_weights_ptr, const float* aux_input_ptr,
@@ -918,8 +960,27 @@ inline void LstmStepFloat(
   float* output_gate_scratch = scratch3;
   float* accumulation_scratch_buffer = scratch4;
 
+  // Precomputed input contributions to each gate.
+  const int n_gates = use_cifg ? 3 : 4;
+  const int input_projection_stride = n_gates * n_cell;
+  const float* input_gate_projection = nullptr;
+  const float* forget_gate_projection = nullptr;
+  const float* cell_gate_projection = nullptr;
+  const float* output_gate_projection = nullptr;
+  if (input_projection_ptr != nullptr) {
+    const float* gate_projection = input_projection_ptr;
+    if (!use_cifg) {
+      input_gate_projection = gate_projection;
+      gate_projection += n_cell;
+    }
+    forget_gate_projection = gate_projection;
+    cell_gate_projection = gate_projection + n_cell;
+    output_gate_projection = gate_projection + 2 * n_cell;
+  }
+
   // Check if inputs are all zeros so we can skip some computations.
   const bool is_input_all_zeros =
+      input_projection_ptr == nullptr &&
       tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
   const bool is_aux_input_all_zeros =
       (aux_input_ptr == nullptr ||
@@ -928,7 +989,8 @@ inline void LstmStepFloat(
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
     CalculateLstmGateFloat(
-        input_ptr, input_to_input_weights_ptr, aux_input_ptr,
+        input_ptr, input_to_input_weights_ptr, input_gate_projection,
+        input_projection_stride, aux_input_ptr,
         aux_input_to_input_weights_ptr, output_state_ptr,
         recurrent_to_input_weights_ptr,
 
@@ -941,7 +1003,8 @@ inline void LstmStepFloat(
   }
   // Calculate the forget gate.
   CalculateLstmGateFloat(
-      input_ptr, input_to_forget_weights_ptr, aux_input_ptr,
+      input_ptr, input_to_forget_weights_ptr, forget_gate_projection,
+      input_projection_stride, aux_input_ptr,
       aux_input_to_forget_weights_ptr, output_state_ptr,
       recurrent_to_forget_weights_ptr,
 
@@ -953,7 +1016,8 @@ inline void LstmStepFloat(
       recurrent_to_forget_is_diag, context);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(
-      input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
+      input_ptr, input_to_cell_weights_ptr, cell_gate_projection,
+      input_projection_stride, aux_input_ptr,
       aux_input_to_cell_weights_ptr, output_state_ptr,
       recurrent_to_cell_weights_ptr,
 
@@ -969,7 +1033,8 @@ inline void LstmStepFloat(
                       params->cell_clip);
   // Calculate output gate.
   CalculateLstmGateFloat(
-      input_ptr, input_to_output_weights_ptr, aux_input_ptr,
+      input_ptr, input_to_output_weights_ptr, output_gate_projection,
+      input_projection_stride, aux_input_ptr,
       aux_input_to_output_weights_ptr, output_state_ptr,
       recurrent_to_output_weights_ptr,
 
@@ -1819,7 +1884,8 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context) {
+    CpuBackendContext* context, const float* input_to_gate_weights,
+    bool input_to_gate_weights_are_constant) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
 
   int max_time, n_batch;
@@ -1864,6 +1930,23 @@ TfLiteStatus EvalFloat(
     accumulation_scratch_buffer = scratch_buffer_ptr + 4 * n_cell * n_batch;
   }
 
+  // The input projection follows the accumulation buffer and its 16 extra
+  // floats per batch.
+  const int n_gates = use_cifg ? 3 : 4;
+  const int n_gate_rows = n_gates * n_cell;
+  float* input_projection = nullptr;
+  if (input_to_gate_weights != nullptr) {
+    TF_LITE_ASSERT(forward_sequence && aux_input == nullptr);
+    const size_t input_projection_offset =
+        n_batch * ((n_gates + 1) * n_cell + 16);
+    TF_LITE_ASSERT((input_projection_offset +
+                    std::min(max_time, kInputProjectionSteps) * n_batch *
+                        n_gate_rows) *
+                       sizeof(float) <=
+                   scratch_buffer->bytes);
+    input_projection = scratch_buffer_ptr + input_projection_offset;
+  }
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1875,6 +1958,19 @@ TfLiteStatus EvalFloat(
       // backwards.
       const int t_rel = forward_sequence ? t : max_time - t - 1;
       const float* input_ptr = GetTensorData<float>(input) + t_rel * input_step;
+      const float* input_projection_ptr = nullptr;
+      if (input_projection != nullptr) {
+        const int projected_step = t % kInputProjectionSteps;
+        if (projected_step == 0) {
+          ProjectInputsFloat(
+              input_to_gate_weights, input_to_gate_weights_are_constant,
+              input_ptr,
+              std::min(kInputProjectionSteps, max_time - t) * n_batch, n_input,
+              n_gate_rows, input_projection, context);
+        }
+        input_projection_ptr =
+            input_projection + projected_step * n_batch * n_gate_rows;
+      }
       const float* aux_input_ptr = nullptr;
       if (aux_input) {
         aux_input_ptr = GetTensorData<float>(aux_input) + t_rel * input_step;
@@ -1883,7 +1979,8 @@ TfLiteStatus EvalFloat(
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
 
       LstmStepFloat(
-          input_ptr, GetTensorData<float>(input_to_input_weights),
+          input_ptr, input_projection_ptr,
+          GetTensorData<float>(input_to_input_weights),
           GetTensorData<float>(input_to_forget_weights),
           GetTensorData<float>(input_to_cell_weights),
           GetTensorData<float>(input_to_output_weights), aux_input_ptr,
@@ -1926,6 +2023,18 @@ TfLiteStatus EvalFloat(
         const int time_offset = b * max_time + t_rel;
         const float* input_ptr =
             GetTensorData<float>(input) + time_offset * input_step;
+        const float* input_projection_ptr = nullptr;
+        if (input_projection != nullptr) {
+          const int projected_step = t % kInputProjectionSteps;
+          if (projected_step == 0) {
+            ProjectInputsFloat(
+                input_to_gate_weights, input_to_gate_weights_are_constant,
+                input_ptr, std::min(kInputProjectionSteps, max_time - t),
+                n_input, n_gate_rows, input_projection, context);
+          }
+          input_projection_ptr =
+              input_projection + projected_step * n_gate_rows;
+        }
         const float* aux_input_ptr = nullptr;
         if (aux_input) {
           aux_input_ptr =
@@ -1946,7 +2055,8 @@ TfLiteStatus EvalFloat(
         float* output_gate_scratch_ptr = output_gate_scratch + b * n_cell;
 
         LstmStepFloat(
-            input_ptr, GetTensorData<float>(input_to_input_weights),
+            input_ptr, input_projection_ptr,
+            GetTensorData<float>(input_to_input_weights),
             GetTensorData<float>(input_to_forget_weights),
             GetTensorData<float>(input_to_cell_weights),
             GetTensorData<float>(input_to_output_weights), aux_input_ptr,
@@ -95,6 +95,19 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// Maximum number of time steps whose input contributions to the gates are
+// computed by one matrix multiplication in EvalFloat.
+constexpr int kInputProjectionSteps = 32;
+
+// If `input_to_gate_weights` is not null, it holds the input weights of the
+// gates concatenated in a '(n_gates * n_cell) * n_input' matrix, in the order
+// input (unless CIFG), forget, cell, output. EvalFloat then multiplies them
+// with the inputs of up to kInputProjectionSteps time steps at once, each step
+// only multiplies the recurrent weights, and ruy may cache the packed weights
+// if `input_to_gate_weights_are_constant`. The scratch buffer must hold
+// 'min(max_time, kInputProjectionSteps) * n_batch * n_gates * n_cell' more
+// floats after the gate and accumulation buffers. Requires a forward sequence
+// without auxiliary input.
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -124,7 +137,8 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* cell_state, TfLiteTensor* output,
     bool recurrent_to_input_is_diag, bool recurrent_to_forget_is_diag,
     bool recurrent_to_cell_is_diag, bool recurrent_to_output_is_diag,
-    CpuBackendContext* context);
+    CpuBackendContext* context, const float* input_to_gate_weights,
+    bool input_to_gate_weights_are_constant);
 
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <vector>
 
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -49,8 +50,33 @@ struct OpData {
   bool recurrent_to_output_is_diag = false;
 
   lstm_eval::IntegerLstmParameter integer_lstm_param;
+
+  // The input weights of the gates of a float LSTM, concatenated for
+  // lstm_eval::EvalFloat. Filled by Prepare if they are constant, by Eval
+  // otherwise.
+  std::vector<float> input_to_gate_weights;
+  bool input_to_gate_weights_are_constant = false;
 };
 
+// Concatenates the input weights of the gates in the order expected by
+// lstm_eval::EvalFloat, skipping the input gate of a CIFG LSTM.
+void ConcatenateInputToGateWeights(const TfLiteTensor* input_to_input_weights,
+                                   const TfLiteTensor* input_to_forget_weights,
+                                   const TfLiteTensor* input_to_cell_weights,
+                                   const TfLiteTensor* input_to_output_weights,
+                                   std::vector<float>* input_to_gate_weights) {
+  input_to_gate_weights->clear();
+  for (const TfLiteTensor* weights :
+       {input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+        input_to_output_weights}) {
+    if (weights != nullptr) {
+      const float* data = GetTensorData<float>(weights);
+      input_to_gate_weights->insert(input_to_gate_weights->end(), data,
+                                    data + NumElements(weights));
+    }
+  }
+}
+
 TfLiteStatus PopulateQuantizedLstmParams8x8_16(
     TfLiteContext* context, TfLiteNode* node,
     lstm_eval::IntegerLstmParameter* integer_lstm_param) {
@@ -1016,6 +1042,38 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     // accumulation buffer and an extra 16 bytes to avoid internal ruy copies.
     scratch_buffer_size->data[1] = n_cell * 5 + 16;
   }
+  if (input_to_output_weights->type == kTfLiteFloat32) {
+    // Reserving space for the input contributions to the gates of several
+    // time steps, see lstm_eval::EvalFloat.
+    const int max_time =
+        time_major ? input->dims->data[0] : input->dims->data[1];
+    const int n_gates = use_cifg ? 3 : 4;
+    scratch_buffer_size->data[1] +=
+        std::min(max_time, lstm_eval::kInputProjectionSteps) * n_gates *
+        n_cell;
+
+    const TfLiteTensor* input_to_forget_weights;
+    TF_LITE_ENSURE_OK(
+        context,
+        GetInputSafe(context, node, lstm::full::kInputToForgetWeightsTensor,
+                     &input_to_forget_weights));
+    const TfLiteTensor* input_to_cell_weights;
+    TF_LITE_ENSURE_OK(
+        context,
+        GetInputSafe(context, node, lstm::full::kInputToCellWeightsTensor,
+                     &input_to_cell_weights));
+    op_data->input_to_gate_weights_are_constant =
+        (use_cifg || IsConstantTensor(input_to_input_weights)) &&
+        IsConstantTensor(input_to_forget_weights) &&
+        IsConstantTensor(input_to_cell_weights) &&
+        IsConstantTensor(input_to_output_weights);
+    if (op_data->input_to_gate_weights_are_constant) {
+      ConcatenateInputToGateWeights(
+          input_to_input_weights, input_to_forget_weights,
+          input_to_cell_weights, input_to_output_weights,
+          &op_data->input_to_gate_weights);
+    }
+  }
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
@@ -1366,6 +1424,12 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
       TfLiteTensor* scratch_buffer;
       TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node, kScratchBuffer,
                                                   &scratch_buffer));
+      if (!op_data->input_to_gate_weights_are_constant) {
+        ConcatenateInputToGateWeights(
+            input_to_input_weights, input_to_forget_weights,
+            input_to_cell_weights, input_to_output_weights,
+            &op_data->input_to_gate_weights);
+      }
       return lstm_eval::EvalFloat(
           input, input_to_input_weights, input_to_forget_weights,
           input_to_cell_weights, input_to_output_weights,
@@ -1392,7 +1456,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           (recurrent_to_cell_weights->dims->size == 1),
           /*recurrent_to_output_is_diag=*/
           (recurrent_to_output_weights->dims->size == 1),
-          CpuBackendContext::GetFromContext(context));
+          CpuBackendContext::GetFromContext(context),
+          op_data->input_to_gate_weights.data(),
+          op_data->input_to_gate_weights_are_constant);
     }
     case kTfLiteUInt8:
     case kTfLiteInt8: {
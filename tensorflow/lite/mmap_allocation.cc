@@ -20,6 +20,7 @@ limitations under the License.
 #include <unistd.h>
 
 #include <cerrno>
+#include <cstdint>
 
 #include "tensorflow/lite/allocation.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -40,6 +41,15 @@ size_t GetFdSizeBytes(int fd) {
   return fd_stat.st_size;
 }
 
+size_t GetPageSize() {
+#ifdef __ANDROID__
+  static const size_t pagesize = getpagesize();
+#else
+  static const size_t pagesize = sysconf(_SC_PAGE_SIZE);
+#endif
+  return pagesize;
+}
+
 }  // namespace
 
 MMAPAllocation::MMAPAllocation(const char* filename,
@@ -81,12 +91,7 @@ MMAPAllocation::MMAPAllocation(ErrorReporter* error_reporter, int owned_fd,
     return;
   }
 
-#ifdef __ANDROID__
-  static int pagesize = getpagesize();
-#else
-  static int pagesize = sysconf(_SC_PAGE_SIZE);
-#endif
-
+  const size_t pagesize = GetPageSize();
   offset_in_buffer_ = offset % pagesize;
   offset_of_buffer_in_file_ = offset - offset_in_buffer_;
 
@@ -131,4 +136,41 @@ bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
 bool MMAPAllocation::IsSupported() { return true; }
 
+bool MMAPAllocation::Advise(const void* data, size_t bytes,
+                            Advice advice) const {
+  if (!valid()) {
+    return false;
+  }
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+  const uintptr_t end = begin + bytes;
+  const uintptr_t mapped_begin = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  if (begin < mapped_begin || end > mapped_begin + mmapped_buffer_size()) {
+    return false;
+  }
+
+  // `mmapped_buffer_` is page aligned, so are the rounded addresses.
+  const uintptr_t pagesize = GetPageSize();
+  uintptr_t page_begin = begin / pagesize * pagesize;
+  uintptr_t page_end = (end + pagesize - 1) / pagesize * pagesize;
+  if (advice == Advice::kDontNeed) {
+    // The pages at the ends may hold data which is still used.
+    page_begin = (begin + pagesize - 1) / pagesize * pagesize;
+    page_end = end / pagesize * pagesize;
+  }
+  if (page_begin >= page_end) {
+    return true;
+  }
+  void* const address = reinterpret_cast<void*>(page_begin);
+  const size_t length = page_end - page_begin;
+  switch (advice) {
+    case Advice::kWillNeed:
+      return madvise(address, length, MADV_WILLNEED) == 0;
+    case Advice::kDontNeed:
+      return madvise(address, length, MADV_DONTNEED) == 0;
+    case Advice::kLock:
+      return mlock(address, length) == 0;
+  }
+  return false;
+}
+
 }  // namespace tflite
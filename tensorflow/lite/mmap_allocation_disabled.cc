@@ -47,4 +47,9 @@ bool MMAPAllocation::valid() const { return false; }
 
 bool MMAPAllocation::IsSupported() { return false; }
 
+bool MMAPAllocation::Advise(const void* data, size_t bytes,
+                            Advice advice) const {
+  return false;
+}
+
 }  // namespace tflite
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/core/kernels/register.h"
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/string_type.h"
 #include "tensorflow/lite/util.h"
 
@@ -54,6 +56,37 @@ TEST(FloatModel, WithXnnpackDelegate) {
 #endif
 }
 
+TEST(FloatModel, WithXnnpackDelegateAndModelPagingAdvice) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_add.bin");
+  ASSERT_TRUE(model);
+
+  InterpreterOptions options;
+  options.SetAdviseModelPaging();
+  options.SetLockHotModelWeights();
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(InterpreterBuilder(*model, ops::builtin::BuiltinOpResolver(),
+                               &options)(&interpreter),
+            kTfLiteOk);
+  ASSERT_TRUE(interpreter);
+
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  for (int input : interpreter->inputs()) {
+    TfLiteTensor* tensor = interpreter->tensor(input);
+    std::fill_n(tensor->data.f, tensor->bytes / sizeof(float), 1.0f);
+  }
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const std::vector<float> output(
+      interpreter->typed_output_tensor<float>(0),
+      interpreter->typed_output_tensor<float>(0) +
+          interpreter->output_tensor(0)->bytes / sizeof(float));
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  EXPECT_EQ(std::vector<float>(
+                interpreter->typed_output_tensor<float>(0),
+                interpreter->typed_output_tensor<float>(0) + output.size()),
+            output);
+}
+
 TEST(FloatModel, DefaultXnnpackDelegateNotAllowed) {
   // Note: this graph will be fully delegated by the XNNPACK delegate.
   auto model = FlatBufferModel::BuildFromFile(
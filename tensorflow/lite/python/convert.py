@@ -588,6 +588,7 @@ def build_conversion_flags(
     use_buffer_offset=False,
     reduce_type_precision=False,
     qdq_conversion_mode=None,
+    fully_connected_weight_bits=None,
     **_
 ):
   """Builds protocol buffer describing a conversion of a model.
@@ -714,6 +715,9 @@ def build_conversion_flags(
       This could have side effects e.g. reduced flatbuffer size.
     qdq_conversion_mode: If set, assume input model is a quantized model
       represented with QDQ ops and convert to quantized kernels.
+    fully_connected_weight_bits: If set to 4, the fully connected weights that
+      the optimized 4-bit kernel handles are quantized to int4 in dynamic range
+      quantization, instead of int8.
 
   Returns:
     conversion_flags: protocol buffer describing the conversion process.
@@ -831,6 +835,8 @@ def build_conversion_flags(
     conversion_flags.reduce_type_precision = reduce_type_precision
   if qdq_conversion_mode is not None:
     conversion_flags.qdq_conversion_mode = qdq_conversion_mode
+  if fully_connected_weight_bits is not None:
+    conversion_flags.fully_connected_weight_bits = fully_connected_weight_bits
   return conversion_flags
 
 
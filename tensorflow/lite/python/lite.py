@@ -664,6 +664,7 @@ class TFLiteConverterBase:
     self._experimental_use_buffer_offset = False
     self._experimental_reduce_type_precision = False
     self._experimental_qdq_conversion_mode = None
+    self._experimental_fully_connected_weight_bits = None
 
     # Debug parameters
     self.mlir_dump_dir = None
@@ -818,6 +819,9 @@ class TFLiteConverterBase:
         "reduce_type_precision": self._experimental_reduce_type_precision,
         "use_stablehlo_quantizer": self.experimental_use_stablehlo_quantizer,
         "qdq_conversion_mode": self._experimental_qdq_conversion_mode,
+        "fully_connected_weight_bits": (
+            self._experimental_fully_connected_weight_bits
+        ),
     }
 
     if self.saved_model_dir:
@@ -22,6 +22,7 @@ limitations under the License.
 #include <cstring>
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -284,6 +285,15 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::RestoreAllocs(
+    std::vector<ArenaAllocWithUsageInterval> allocs) {
+  active_allocs_ = std::move(allocs);
+  std::sort(active_allocs_.begin(), active_allocs_.end());
+  for (const auto& alloc : active_allocs_) {
+    high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+  }
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
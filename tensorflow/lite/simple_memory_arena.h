@@ -142,6 +142,10 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedules the memory allocations `allocs`, whose offsets were calculated
+  // by a previous plan, instead of the current ones.
+  void RestoreAllocs(std::vector<ArenaAllocWithUsageInterval> allocs);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
@@ -15,11 +15,13 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTIRUN_STATS_RECORDER_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MULTIRUN_STATS_RECORDER_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
 namespace tflite {
 namespace benchmark {
@@ -42,17 +44,31 @@ class MultiRunStatsRecorder : public BenchmarkListener {
     auto& current = results_.back();
     current.completed = true;
     current.metrics = results;
+    current.cpu_frequency_khz = util::GetCpuFrequencyKhz(monitored_cpu_);
+    current.temperature = util::GetThermalZoneTemperature(0);
   }
 
+  // Sets the CPU whose frequency is recorded at the end of each run.
+  void SetMonitoredCpu(int cpu) { monitored_cpu_ = cpu; }
+
   virtual void OutputStats();
 
  protected:
+  // When every option completed at least two runs, outputs the mean inference
+  // time of each option with its confidence interval, and compares it with the
+  // fastest option.
+  void OutputComparison();
+
   struct EachRunResult {
     bool completed = false;
     std::unique_ptr<BenchmarkParams> params;
     BenchmarkResults metrics;
+    // Recorded at the end of the run, -1 if not available.
+    int64_t cpu_frequency_khz = -1;
+    int64_t temperature = -1;  // In millidegrees Celsius.
   };
   std::vector<EachRunResult> results_;
+  int monitored_cpu_ = 0;
 
   // Use this to order the runs by the average inference time in increasing
   // order (i.e. the fastest run ranks first.). If the run didn't complete,
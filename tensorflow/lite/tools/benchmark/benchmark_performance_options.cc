@@ -17,11 +17,13 @@ limitations under the License.
 
 #include <algorithm>
 #include <iomanip>
+#include <map>
 #include <memory>
 #include <random>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
@@ -120,6 +122,58 @@ void MultiRunStatsRecorder::OutputStats() {
       // OS process, therefore, the memory usage information of each run becomes
       // incorrect, hence no output here.
     }
+    if (run_stats.cpu_frequency_khz >= 0) {
+      stream << " cpu" << monitored_cpu_ << " freq (MHz): "
+             << run_stats.cpu_frequency_khz / 1000;
+    }
+    if (run_stats.temperature >= 0) {
+      stream << " temp (C): " << run_stats.temperature / 1000.0;
+    }
+    TFLITE_LOG(INFO) << stream.str();
+  }
+
+  OutputComparison();
+}
+
+void MultiRunStatsRecorder::OutputComparison() {
+  // The average inference time of each completed run, per performance option.
+  std::map<std::string, std::vector<double>> samples;
+  for (const auto& run_stats : results_) {
+    if (run_stats.completed) {
+      samples[PerfOptionName(*run_stats.params)].push_back(
+          run_stats.metrics.inference_time_us().avg());
+    }
+  }
+  std::vector<std::pair<std::string, util::SampleStats>> all_stats;
+  for (const auto& [name, option_samples] : samples) {
+    // A single run per option has no confidence interval to report.
+    if (option_samples.size() < 2) return;
+    all_stats.emplace_back(name, util::ComputeSampleStats(option_samples));
+  }
+  if (all_stats.empty()) return;
+  std::sort(all_stats.begin(), all_stats.end(),
+            [](const auto& a, const auto& b) {
+              return a.second.mean < b.second.mean;
+            });
+
+  TFLITE_LOG(INFO) << "\n=====Comparison of Interleaved Runs (mean inference "
+                      "time, 95% confidence)=====";
+  const std::string& fastest = all_stats.front().first;
+  const double fastest_mean = all_stats.front().second.mean;
+  for (const auto& [name, stats] : all_stats) {
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(1) << std::setw(26) << name
+           << ": " << stats.mean << " +/- " << stats.ci95
+           << " us (runs=" << stats.count << ")";
+    if (name != fastest) {
+      const util::MeanComparison comparison =
+          util::CompareMeans(samples[name], samples[fastest]);
+      stream << ", vs fastest: +"
+             << 100.0 * comparison.difference / fastest_mean << "% +/- "
+             << 100.0 * comparison.ci95 / fastest_mean << "% ("
+             << (comparison.significant ? "significant" : "not significant")
+             << ")";
+    }
     TFLITE_LOG(INFO) << stream.str();
   }
 }
@@ -148,6 +202,9 @@ BenchmarkParams BenchmarkPerformanceOptions::DefaultParams() {
                   BenchmarkParam::Create<float>(-1.0f));
   params.AddParam("random_shuffle_benchmark_runs",
                   BenchmarkParam::Create<bool>(true));
+  params.AddParam("perf_options_rounds", BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("pin_benchmark_cpus",
+                  BenchmarkParam::Create<std::string>(""));
   return params;
 }
 
@@ -166,6 +223,20 @@ std::vector<Flag> BenchmarkPerformanceOptions::GetFlags() {
           "random_shuffle_benchmark_runs", &params_,
           "Whether to perform all benchmark runs, each of which has different "
           "performance options, in a random order. It is enabled by default."),
+      CreateFlag<int32_t>(
+          "perf_options_rounds", &params_,
+          "The number of times each performance option is benchmarked. Each "
+          "round runs all the options once, interleaved with the others and "
+          "in a new random order if --random_shuffle_benchmark_runs is set, so "
+          "that thermal throttling and frequency drift affect all options "
+          "alike. With 2 rounds or more, the summary reports 95% confidence "
+          "intervals and whether each option differs significantly from the "
+          "fastest one."),
+      CreateFlag<std::string>(
+          "pin_benchmark_cpus", &params_,
+          "A comma-separated list of CPU ids to pin the benchmark and the "
+          "threads it creates to. The frequency of the first one is recorded "
+          "after each run. By default, threads aren't pinned."),
   };
 }
 
@@ -359,12 +430,21 @@ void BenchmarkPerformanceOptions::CreatePerformanceOptions() {
 TfLiteStatus BenchmarkPerformanceOptions::Run() {
   CreatePerformanceOptions();
 
-  if (params_.Get<bool>("random_shuffle_benchmark_runs")) {
-    std::random_device rd;
-    std::mt19937 generator(rd());
-    std::shuffle(all_run_params_.begin(), all_run_params_.end(), generator);
+  const std::string& pin_cpus = params_.Get<std::string>("pin_benchmark_cpus");
+  if (!pin_cpus.empty()) {
+    std::vector<int> cpus;
+    if (!util::SplitAndParse(pin_cpus, ',', &cpus) ||
+        !util::PinCurrentThreadToCpus(cpus)) {
+      TFLITE_LOG(ERROR) << "Cannot pin the benchmark to CPUs: '" << pin_cpus
+                        << "'.";
+      return kTfLiteError;
+    }
+    all_run_stats_->SetMonitoredCpu(cpus.front());
   }
 
+  std::random_device rd;
+  std::mt19937 generator(rd());
+
   // We need to clean *internally* created benchmark listeners, like the
   // profiling listener etc. in each Run() invoke because such listeners may be
   // reset and become invalid in the next Run(). As a result, we record the
@@ -372,25 +452,32 @@ TfLiteStatus BenchmarkPerformanceOptions::Run() {
   const int num_external_listeners = single_option_run_->NumListeners();
 
   // Now perform all runs, each with different performance-affecting parameters.
-  for (const auto& run_params : all_run_params_) {
-    // If the run_params is empty, then it means "none" is set for
-    // --perf_options_list.
-    if (!run_params.Empty()) {
-      // Reset all performance-related options before any runs.
-      ResetPerformanceOptions();
-      single_option_run_params_->Set(run_params);
+  const int rounds = std::max(params_.Get<int32_t>("perf_options_rounds"), 1);
+  for (int round = 0; round < rounds; ++round) {
+    if (params_.Get<bool>("random_shuffle_benchmark_runs")) {
+      std::shuffle(all_run_params_.begin(), all_run_params_.end(), generator);
     }
-    util::SleepForSeconds(params_.Get<float>("option_benchmark_run_delay"));
-
-    // Clear internally created listeners before each run but keep externally
-    // created ones.
-    single_option_run_->RemoveListeners(num_external_listeners);
-
-    all_run_stats_->MarkBenchmarkStart(*single_option_run_params_);
-    if (TfLiteStatus status = single_option_run_->Run(); status != kTfLiteOk) {
-      TFLITE_LOG(ERROR) << "Error while running a single-option run: "
-                        << status;
-      return status;
+    for (const auto& run_params : all_run_params_) {
+      // If the run_params is empty, then it means "none" is set for
+      // --perf_options_list.
+      if (!run_params.Empty()) {
+        // Reset all performance-related options before any runs.
+        ResetPerformanceOptions();
+        single_option_run_params_->Set(run_params);
+      }
+      util::SleepForSeconds(params_.Get<float>("option_benchmark_run_delay"));
+
+      // Clear internally created listeners before each run but keep externally
+      // created ones.
+      single_option_run_->RemoveListeners(num_external_listeners);
+
+      all_run_stats_->MarkBenchmarkStart(*single_option_run_params_);
+      if (TfLiteStatus status = single_option_run_->Run();
+          status != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Error while running a single-option run: "
+                          << status;
+        return status;
+      }
     }
   }
 
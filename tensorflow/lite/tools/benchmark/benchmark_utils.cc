@@ -15,6 +15,17 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sched.h>
+#endif
+
 #include "tensorflow/lite/profiling/time.h"
 
 namespace tflite {
@@ -32,6 +43,109 @@ void SleepForSeconds(double sleep_seconds) {
       static_cast<uint64_t>(sleep_seconds * 1e6));
 }
 
+namespace {
+
+int64_t ReadInt64File(const std::string& path) {
+  std::ifstream file(path);
+  int64_t value = -1;
+  if (!(file >> value)) {
+    return -1;
+  }
+  return value;
+}
+
+// Returns the critical value of Student's t-distribution with 'df' degrees of
+// freedom for a two-sided 95% confidence interval.
+double TCritical95(double df) {
+  static constexpr double kTable[] = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045};
+  constexpr int kTableSize = sizeof(kTable) / sizeof(kTable[0]);
+  if (df < kTableSize + 1) {
+    // Round the degrees of freedom down, which widens the interval.
+    return kTable[std::max(0, static_cast<int>(df) - 1)];
+  }
+  // Cornish-Fisher expansion around the normal distribution.
+  constexpr double z = 1.959964;
+  return z + (z * z * z + z) / (4 * df) +
+         (5 * std::pow(z, 5) + 16 * z * z * z + 3 * z) / (96 * df * df);
+}
+
+}  // namespace
+
+int64_t GetCpuFrequencyKhz(int cpu) {
+  return ReadInt64File("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                       "/cpufreq/scaling_cur_freq");
+}
+
+int64_t GetThermalZoneTemperature(int zone) {
+  return ReadInt64File("/sys/class/thermal/thermal_zone" +
+                       std::to_string(zone) + "/temp");
+}
+
+bool PinCurrentThreadToCpus(const std::vector<int>& cpus) {
+#if defined(__linux__) || defined(__ANDROID__)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (const int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &cpu_set);
+  }
+  return !cpus.empty() && sched_setaffinity(0, sizeof(cpu_set), &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
+SampleStats ComputeSampleStats(const std::vector<double>& samples) {
+  SampleStats stats;
+  stats.count = samples.size();
+  if (stats.count == 0) {
+    return stats;
+  }
+  for (const double sample : samples) {
+    stats.mean += sample;
+  }
+  stats.mean /= stats.count;
+  if (stats.count == 1) {
+    return stats;
+  }
+  double squares = 0.0;
+  for (const double sample : samples) {
+    squares += (sample - stats.mean) * (sample - stats.mean);
+  }
+  stats.stddev = std::sqrt(squares / (stats.count - 1));
+  stats.ci95 =
+      TCritical95(stats.count - 1) * stats.stddev / std::sqrt(stats.count);
+  return stats;
+}
+
+MeanComparison CompareMeans(const std::vector<double>& a,
+                            const std::vector<double>& b) {
+  const SampleStats stats_a = ComputeSampleStats(a);
+  const SampleStats stats_b = ComputeSampleStats(b);
+  MeanComparison comparison;
+  comparison.difference = stats_a.mean - stats_b.mean;
+  const double variance_a = stats_a.stddev * stats_a.stddev / stats_a.count;
+  const double variance_b = stats_b.stddev * stats_b.stddev / stats_b.count;
+  const double variance = variance_a + variance_b;
+  if (variance == 0.0) {
+    comparison.significant = comparison.difference != 0.0;
+    return comparison;
+  }
+  // Welch-Satterthwaite degrees of freedom.
+  const double df =
+      variance * variance /
+      (variance_a * variance_a / (stats_a.count - 1) +
+       variance_b * variance_b / (stats_b.count - 1));
+  comparison.ci95 = TCritical95(df) * std::sqrt(variance);
+  comparison.significant = std::abs(comparison.difference) > comparison.ci95;
+  return comparison;
+}
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
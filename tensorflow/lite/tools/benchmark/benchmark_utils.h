@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 
+#include <cstdint>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -45,6 +46,42 @@ bool SplitAndParse(const std::string& str, char delim, std::vector<T>* values) {
   return true;
 }
 
+// Returns the current frequency of 'cpu' in kHz, or -1 if it isn't exposed by
+// the OS, e.g. on platforms other than Linux and Android.
+int64_t GetCpuFrequencyKhz(int cpu);
+
+// Returns the temperature of the thermal zone 'zone' in millidegrees Celsius,
+// or -1 if it isn't exposed by the OS.
+int64_t GetThermalZoneTemperature(int zone);
+
+// Pins the calling thread, and the threads it creates afterwards, to 'cpus'.
+// Returns false if thread affinity isn't supported or couldn't be set.
+bool PinCurrentThreadToCpus(const std::vector<int>& cpus);
+
+// The mean of a set of samples, with its standard deviation and the half
+// width of its 95% confidence interval based on Student's t-distribution.
+struct SampleStats {
+  int count = 0;
+  double mean = 0.0;
+  double stddev = 0.0;
+  double ci95 = 0.0;
+};
+
+SampleStats ComputeSampleStats(const std::vector<double>& samples);
+
+// The difference between the means of two sets of samples, with the half width
+// of its 95% confidence interval, according to Welch's t-test. 'significant'
+// is true if the difference is significant at the 5% level. Both sets need at
+// least two samples.
+struct MeanComparison {
+  double difference = 0.0;
+  double ci95 = 0.0;
+  bool significant = false;
+};
+
+MeanComparison CompareMeans(const std::vector<double>& a,
+                            const std::vector<double>& b);
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
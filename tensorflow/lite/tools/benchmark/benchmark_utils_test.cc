@@ -75,6 +75,44 @@ TEST(BenchmarkHelpersTest, SplitAndParseInts) {
   EXPECT_EQ(2, results[1]);
 }
 
+TEST(BenchmarkHelpersTest, ComputeSampleStats) {
+  const util::SampleStats stats =
+      util::ComputeSampleStats({10.0, 12.0, 14.0, 16.0});
+
+  EXPECT_EQ(4, stats.count);
+  EXPECT_DOUBLE_EQ(13.0, stats.mean);
+  EXPECT_NEAR(2.582, stats.stddev, 1e-3);
+  // t(0.975, 3) * stddev / sqrt(4).
+  EXPECT_NEAR(3.182 * 2.582 / 2, stats.ci95, 1e-2);
+}
+
+TEST(BenchmarkHelpersTest, ComputeSampleStatsOfOneSample) {
+  const util::SampleStats stats = util::ComputeSampleStats({10.0});
+
+  EXPECT_EQ(1, stats.count);
+  EXPECT_DOUBLE_EQ(10.0, stats.mean);
+  EXPECT_DOUBLE_EQ(0.0, stats.ci95);
+}
+
+TEST(BenchmarkHelpersTest, CompareMeansSignificant) {
+  const util::MeanComparison comparison =
+      util::CompareMeans({100.0, 101.0, 99.0, 100.5, 99.5},
+                         {95.0, 96.0, 94.0, 95.5, 94.5});
+
+  EXPECT_DOUBLE_EQ(5.0, comparison.difference);
+  EXPECT_GT(comparison.ci95, 0.0);
+  EXPECT_LT(comparison.ci95, 5.0);
+  EXPECT_TRUE(comparison.significant);
+}
+
+TEST(BenchmarkHelpersTest, CompareMeansNotSignificant) {
+  const util::MeanComparison comparison = util::CompareMeans(
+      {100.0, 110.0, 90.0, 105.0, 95.0}, {101.0, 111.0, 91.0, 106.0, 96.0});
+
+  EXPECT_DOUBLE_EQ(-1.0, comparison.difference);
+  EXPECT_FALSE(comparison.significant);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
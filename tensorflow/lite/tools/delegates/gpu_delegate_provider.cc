@@ -160,12 +160,15 @@ TfLiteDelegatePtr GpuDelegateProvider::CreateTfLiteDelegate(
         params.Get<std::string>("delegate_serialize_dir");
     std::string serialize_token =
         params.Get<std::string>("delegate_serialize_token");
-    if (!serialize_dir.empty() && !serialize_token.empty()) {
+    if (!serialize_dir.empty()) {
+      // Without a token, only the compiled programs are cached.
       gpu_opts.experimental_flags =
           gpu_opts.experimental_flags |
           TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
       gpu_opts.serialization_dir = serialize_dir.c_str();
-      gpu_opts.model_token = serialize_token.c_str();
+      if (!serialize_token.empty()) {
+        gpu_opts.model_token = serialize_token.c_str();
+      }
     }
 
     delegate = evaluation::CreateGPUDelegate(&gpu_opts);
@@ -214,6 +214,7 @@ def TFE_ContextSetSoftDevicePlacement(arg0: object, arg1: bool) -> None: ...
 def TFE_ContextSetThreadLocalDevicePlacementPolicy(arg0: object, arg1: TFE_ContextDevicePlacementPolicy) -> None: ...
 def TFE_ContextSyncExecutors(arg0: object) -> None: ...
 def TFE_ContextUpdateServerDef(arg0: object, arg1: int, arg2: bytes) -> None: ...
+def TFE_DLPackConsumerStream(arg0: object, arg1: str) -> int: ...
 def TFE_DeleteConfigKeyValue(arg0: object, arg1: str) -> None: ...
 def TFE_DeleteContext(arg0: object) -> None: ...
 def TFE_DeleteContextOptions(arg0: TFE_ContextOptions) -> None: ...
@@ -350,7 +351,7 @@ def TFE_Py_VariableWatcherWatchedVariables(arg0: object) -> object: ...
 def TFE_ReportErrorToCluster(arg0: object, arg1: int, arg2: str) -> None: ...
 def TFE_ResetMemoryStats(arg0: object, arg1: str) -> None: ...
 def TFE_SetLogicalCpuDevices(arg0: object, arg1: int, arg2: str) -> None: ...
-def TFE_ToDlpackCapsule(arg0: object): ...
+def TFE_ToDlpackCapsule(arg0: object, arg1: int | None): ...
 def TFE_WaitAtBarrier(arg0: object, arg1: str, arg2: int) -> None: ...
 def TF_DeleteDeviceList(arg0: TF_DeviceList) -> None: ...
 def TF_DeviceListCount(arg0: TF_DeviceList) -> int: ...
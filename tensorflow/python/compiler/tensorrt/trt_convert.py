@@ -122,13 +122,15 @@ PROFILE_STRATEGY_RANGE = "Range"
 PROFILE_STRATEGY_OPTIMAL = "Optimal"
 PROFILE_STRATEGY_RANGE_OPTIMAL = "Range+Optimal"
 PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE = "ImplicitBatchModeCompatible"
+PROFILE_STRATEGY_CLUSTERED = "Clustered"
 
 
 def supported_profile_strategies():
   return [
       PROFILE_STRATEGY_RANGE, PROFILE_STRATEGY_OPTIMAL,
       PROFILE_STRATEGY_RANGE_OPTIMAL,
-      PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE
+      PROFILE_STRATEGY_IMPLICIT_BATCH_MODE_COMPATIBLE,
+      PROFILE_STRATEGY_CLUSTERED
   ]
 
 
@@ -1175,6 +1177,11 @@ class TrtGraphConverterV2(object):
        inputs with the same dimensions as the input it is created for. The GPU
        engine will be run with optimal performance with such inputs.
      * `Range+Optimal`: create the profiles for both `Range` and `Optimal`.
+     * `Clustered`: create a few profiles, each for a range of similar inputs
+       and optimized for the most frequent of them. The ranges minimize the
+       padding of the inputs, weighted by how often the input function
+       produced each of them, so the input function should follow the
+       distribution of the served inputs.
   """
 
   def _verify_profile_strategy(self, strategy):
@@ -29,21 +29,34 @@ def _cache(input_dataset, filename, name):  # pylint: disable=unused-private-nam
 class CacheDataset(dataset_ops.UnaryUnchangedStructureDataset):
   """A `Dataset` that caches elements of its input."""
 
-  def __init__(self, input_dataset, filename, name=None):
-    """See `Dataset.cache()` for details."""
+  def __init__(self, input_dataset, filename, name=None, hybrid=False):
+    """See `Dataset.cache()` for details.
+
+    Args:
+      input_dataset: The input dataset.
+      filename: A `tf.string` scalar, the name of a file to cache elements in,
+        or an empty string to cache elements in memory.
+      name: (Optional.) A name for the tf.data operation.
+      hybrid: (Optional.) If true and `filename` is not empty, also keep the
+        leading elements of the cache in memory for as long as they fit in the
+        RAM budget of the iterator.
+    """
     self._input_dataset = input_dataset
     self._filename = ops.convert_to_tensor(
         filename, dtype=dtypes.string, name="filename")
     self._name = name
+    self._hybrid = hybrid
     if tf2.enabled() and (context.executing_eagerly() or ops.inside_function()):
       variant_tensor = gen_dataset_ops.cache_dataset_v2(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
           cache=gen_dataset_ops.dummy_memory_cache(),
+          hybrid=self._hybrid,
           **self._common_args)
     else:
       variant_tensor = gen_dataset_ops.cache_dataset(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
+          hybrid=self._hybrid,
           **self._common_args)
     super().__init__(input_dataset, variant_tensor)
@@ -113,8 +113,15 @@ class _ParallelInterleaveDataset(dataset_ops.UnaryDataset):
                buffer_output_elements=dataset_ops.AUTOTUNE,
                prefetch_input_elements=dataset_ops.AUTOTUNE,
                deterministic=None,
-               name=None):
-    """See `Dataset.interleave()` for details."""
+               name=None,
+               read_ahead_bytes=0):
+    """See `Dataset.interleave()` for details.
+
+    If `read_ahead_bytes` is positive and the output is deterministic, each
+    element of the current cycle keeps fetching up to `read_ahead_bytes` bytes
+    beyond `buffer_output_elements`, so that a slow input only delays its own
+    slot of the cycle.
+    """
     self._input_dataset = input_dataset
     self._map_func = structured_function.StructuredFunctionWrapper(
         map_func, self._transformation_name(), dataset=input_dataset)
@@ -156,6 +163,7 @@ class _ParallelInterleaveDataset(dataset_ops.UnaryDataset):
         self._num_parallel_calls,
         f=self._map_func.function,
         deterministic=deterministic_string,
+        read_ahead_bytes=read_ahead_bytes,
         **self._common_args)
     super().__init__(input_dataset, variant_tensor)
 
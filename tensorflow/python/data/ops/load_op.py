@@ -128,7 +128,8 @@ def _load_distributed_snapshot(
       lambda chunk_file: _SnapshotChunkDataset(  # pylint:disable=g-long-lambda
           chunk_file,
           element_spec=_parse_element_spec(metadata.element_spec),
-          compression=metadata.compression))
+          compression=metadata.compression,
+          columnar=metadata.columnar_chunks))
   return reader_func(dataset)
 
 
@@ -188,12 +189,18 @@ class _LoadDataset(dataset_ops.DatasetSource):
 class _SnapshotChunkDataset(dataset_ops.DatasetSource):
   """A dataset for one chunk file from a tf.data distributed snapshot."""
 
-  def __init__(self, chunk_file: str, element_spec: Any, compression: str):
+  def __init__(
+      self,
+      chunk_file: str,
+      element_spec: Any,
+      compression: str,
+      columnar: bool = False):
     self._chunk_file = chunk_file
     self._element_spec = element_spec
     variant_tensor = ged_ops.snapshot_chunk_dataset(
         chunk_file,
         compression=compression,
+        columnar=columnar,
         **self._flat_structure)
     super().__init__(variant_tensor)
 
@@ -40,8 +40,14 @@ class _ShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
                buffer_size,
                seed=None,
                reshuffle_each_iteration=None,
-               name=None):
-    """See `Dataset.shuffle()` for details."""
+               name=None,
+               index_shuffle=False):
+    """See `Dataset.shuffle()` for details.
+
+    If `index_shuffle` is True, `input_dataset` must support random access.
+    Each epoch then reads the input elements in a random order of their
+    indices instead of buffering them, and `buffer_size` is ignored.
+    """
     self._input_dataset = input_dataset
     self._buffer_size = ops.convert_to_tensor(
         buffer_size, dtype=dtypes.int64, name="buffer_size")
@@ -60,6 +66,7 @@ class _ShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
           seed2=self._seed2,
           seed_generator=gen_dataset_ops.dummy_seed_generator(),
           reshuffle_each_iteration=self._reshuffle_each_iteration,
+          index_shuffle=index_shuffle,
           **self._common_args)
     else:
       variant_tensor = gen_dataset_ops.shuffle_dataset(
@@ -68,5 +75,6 @@ class _ShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
           seed=self._seed,
           seed2=self._seed2,
           reshuffle_each_iteration=self._reshuffle_each_iteration,
+          index_shuffle=index_shuffle,
           **self._common_args)
     super().__init__(input_dataset, variant_tensor)
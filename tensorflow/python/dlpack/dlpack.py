@@ -18,9 +18,15 @@ from tensorflow.python import pywrap_tfe
 from tensorflow.python.eager import context
 from tensorflow.python.util.tf_export import tf_export
 
+# DLPack device types whose consumers synchronize on a stream.
+_DLPACK_STREAM_DEVICE_TYPES = (
+    2,  # kDLCUDA
+    10,  # kDLROCM
+)
+
 
 @tf_export("experimental.dlpack.to_dlpack", v1=[])
-def to_dlpack(tf_tensor):
+def to_dlpack(tf_tensor, stream=None):
   """Returns the dlpack capsule representing the tensor.
 
   This operation ensures the underlying data memory is ready when returns.
@@ -31,14 +37,20 @@ def to_dlpack(tf_tensor):
     # dlcapsule represents the dlpack data structure
     ```
 
+  When `stream` is given, as in the `__dlpack__(stream=...)` protocol, the
+  host doesn't wait for the device. Instead the consumer stream waits on the
+  work that computes the tensor, and -1 skips the synchronization entirely.
+
   Args:
     tf_tensor: Tensorflow eager tensor, to be converted to dlpack capsule.
+    stream: Optional platform handle of the stream on which the consumer uses
+      the tensor, e.g. the `cudaStream_t` cast to an integer.
 
   Returns:
     A PyCapsule named as dltensor, which shares the underlying memory to other
      framework. This PyCapsule can be consumed only once.
   """
-  return pywrap_tfe.TFE_ToDlpackCapsule(tf_tensor)
+  return pywrap_tfe.TFE_ToDlpackCapsule(tf_tensor, stream)
 
 
 @tf_export("experimental.dlpack.from_dlpack", v1=[])
@@ -53,11 +65,26 @@ def from_dlpack(dlcapsule):
     # `a` uses the memory shared by dlpack
     ```
 
+  `dlcapsule` can also be an object implementing `__dlpack__` and
+  `__dlpack_device__`, e.g. a PyTorch or JAX array on a GPU. Its producer then
+  orders its work before the TensorFlow compute stream, without blocking the
+  host.
+
   Args:
-    dlcapsule: A PyCapsule named as dltensor
+    dlcapsule: A PyCapsule named as dltensor, or an object implementing the
+      `__dlpack__` protocol.
 
   Returns:
     A Tensorflow eager tensor
   """
   context.context().ensure_initialized()
+  if hasattr(dlcapsule, "__dlpack__"):
+    device_type, device_id = dlcapsule.__dlpack_device__()
+    if device_type in _DLPACK_STREAM_DEVICE_TYPES:
+      ctx_handle = context.context()._handle  # pylint: disable=protected-access
+      stream = pywrap_tfe.TFE_DLPackConsumerStream(
+          ctx_handle, "/device:GPU:%d" % device_id)
+      dlcapsule = dlcapsule.__dlpack__(stream=stream)
+    else:
+      dlcapsule = dlcapsule.__dlpack__()
   return pywrap_tfe.TFE_FromDlpackCapsule(dlcapsule, context.context()._handle)  # pylint: disable=protected-access
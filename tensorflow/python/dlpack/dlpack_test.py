@@ -94,6 +94,30 @@ class DLPackTest(parameterized.TestCase, test.TestCase):
                            ".*a DLPack tensor may be consumed at most once.*",
                            ConsumeDLPackTensor)
 
+  def testRoundTripOnStream(self):
+    np_array = np.random.randint(0, 10, (2, 3, 4))
+    tf_tensor = array_ops.identity(
+        constant_op.constant(np_array, dtype=dtypes.float32))
+    dlcapsule = dlpack.to_dlpack(tf_tensor, stream=-1)
+    self.assertAllClose(np_array, dlpack.from_dlpack(dlcapsule))
+
+  def testFromDLPackProducer(self):
+
+    class Producer:
+
+      def __init__(self, tf_tensor):
+        self.tf_tensor = tf_tensor
+
+      def __dlpack__(self, stream=None):
+        return dlpack.to_dlpack(self.tf_tensor, stream)
+
+      def __dlpack_device__(self):
+        return (1, 0)  # kDLCPU
+
+    np_array = np.random.randint(0, 10, (2, 3))
+    tf_tensor = constant_op.constant(np_array, dtype=dtypes.float32)
+    self.assertAllClose(np_array, dlpack.from_dlpack(Producer(tf_tensor)))
+
   def testDLPackFromWithoutContextInitialization(self):
     tf_tensor = constant_op.constant(1)
     dlcapsule = dlpack.to_dlpack(tf_tensor)
@@ -600,6 +600,18 @@ class ConcatOpTest(test.TestCase):
           cur_offset += params[p[i]].shape[concat_dim]
           self.assertAllEqual(result[tuple(index)], params[p[i]])
 
+  def testConcatLargeOutput(self):
+    # Outputs of at least 4 MiB are copied in stripes of the same size, which
+    # start and end in the middle of the rows of the inputs.
+    np.random.seed(11)
+    shapes = [((1, 700001), (1, 500003)), ((57, 20011), (57, 13)),
+              ((100003, 7), (100003, 5))]
+    for shape0, shape1 in shapes:
+      x0 = np.random.rand(*shape0).astype(np.float32)
+      x1 = np.random.rand(*shape1).astype(np.float32)
+      c = array_ops.concat([x0, x1], 1)
+      self.assertAllEqual(self.evaluate(c), np.concatenate([x0, x1], axis=1))
+
   def testConcatEmpty(self):
     with test_util.use_gpu():
       t1 = []
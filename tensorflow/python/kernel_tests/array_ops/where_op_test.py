@@ -162,6 +162,21 @@ class WhereOpTest(test.TestCase):
   def testRandomInt16(self):
     self._testRandom(np.int16)
 
+  def testLargeInput(self):
+    # Large enough for the CPU kernel to count and write the indices of the
+    # true values in parallel blocks, with runs of true and false values
+    # crossing the block boundaries.
+    x = np.random.rand(37, 211, 301) > 0.3
+    x[3:9] = True
+    x[20:30] = False
+    for dtype in [np.bool_, np.float32, np.int8]:
+      with self.subTest(dtype=dtype):
+        ans = self.evaluate(array_ops.where_v2(x.astype(dtype)))
+        self.assertAllEqual(ans, np.argwhere(x))
+    values = np.arange(x.size, dtype=np.float32).reshape(x.shape)
+    self.assertAllEqual(
+        self.evaluate(array_ops.boolean_mask(values, x)), values[x])
+
   @test_util.run_deprecated_v1
   def testThreeArgument(self):
     self._testThreeArgument()
@@ -273,6 +273,40 @@ class BincountOpTest(test_util.TensorFlowTestCase, parameterized.TestCase):
               gen_math_ops.dense_bincount(
                   input=inp, weights=np_weight, size=size, binary_output=True)))
 
+  @parameterized.parameters([{
+      "num_values": 100000,
+      "size": 100,
+  }, {
+      "num_values": 100000,
+      "size": 1 << 20,
+  }, {
+      "num_values": 10000,
+      "size": 1 << 20,
+  }])
+  def test_bincount_large(self, num_values, size):
+    # The sizes cover the histograms per thread, the bins partitioned between
+    # the threads, and the sort of sparse weighted values of the CPU kernel.
+    np.random.seed(42)
+    inp = np.random.randint(0, size + size // 4, (num_values,), dtype=np.int32)
+    np_weight = np.random.randint(-100, 100, (num_values,)).astype(np.float32)
+    in_range = inp[inp < size]
+    with test_util.use_gpu():
+      self.assertAllEqual(
+          np.bincount(in_range, minlength=size),
+          self.evaluate(
+              gen_math_ops.dense_bincount(input=inp, weights=[], size=size)))
+      self.assertAllEqual(
+          np.bincount(
+              in_range, weights=np_weight[inp < size], minlength=size),
+          self.evaluate(
+              gen_math_ops.dense_bincount(
+                  input=inp, weights=np_weight, size=size)))
+      self.assertAllEqual(
+          np.minimum(np.bincount(in_range, minlength=size), 1),
+          self.evaluate(
+              gen_math_ops.dense_bincount(
+                  input=inp, weights=[], size=size, binary_output=True)))
+
   def _test_bincount_col_count(self, num_rows, num_cols, size, dtype):
     np.random.seed(42)
     inp = np.random.randint(0, size, (num_rows, num_cols), dtype=dtype)
@@ -59,6 +59,18 @@ class BucketizationOpTest(test.TestCase):
       self.assertAllEqual(expected_out, self.evaluate(op))
 
   @test_util.run_deprecated_v1
+  def testLargeInputManyBoundaries(self):
+    # Enough boundaries to be searched in Eytzinger order, with repeated ones.
+    boundaries = np.sort(
+        np.random.randint(-1000, 1000, size=3000)).astype(np.float32)
+    values = np.random.uniform(-1100, 1100, size=100000).astype(np.float32)
+    values[:boundaries.size] = boundaries
+    op = math_ops._bucketize(
+        constant_op.constant(values), boundaries=boundaries.tolist())
+    expected_out = np.searchsorted(boundaries, values, side="right")
+    with self.session():
+      self.assertAllEqual(expected_out, self.evaluate(op))
+
   def testInvalidBoundariesOrder(self):
     op = math_ops._bucketize(
         constant_op.constant([-5, 0]), boundaries=[0, 8, 3, 11])
@@ -311,6 +311,18 @@ class SumReductionTest(BaseReductionTest):
           self.assertAllClose(sum_y, tf_out_sum_y)
           self.assertAllClose(sum_xz, tf_out_sum_xz)
 
+  @test_util.run_deprecated_v1
+  def testFloat32OuterAxisAccuracy(self):
+    # Large reductions of non-innermost axes are accumulated pairwise on the
+    # CPU, so that their error stays close to the one of a float64 sum.
+    np.random.seed(17)
+    for shape, axis in (((300001, 40), 0), ((3, 70001, 20), 1)):
+      arr = np.random.rand(*shape).astype(np.float32)
+      expected = np.sum(arr.astype(np.float64), axis=axis)
+      with self.session(graph=ops.Graph(), use_gpu=False):
+        out = self.evaluate(self._tf_reduce(arr, axis, False))
+      self.assertAllClose(expected, out, rtol=1e-6, atol=0)
+
   @test_util.run_deprecated_v1
   def testFloat32BFloat16(self):
     for dtype in [dtypes.float32, dtypes.bfloat16]:
@@ -954,6 +966,15 @@ class MaxReductionTest(test.TestCase):
                                      repeat=size):
           self._compareAll(np.array(arr, dtype=dtype), None)
 
+  @test_util.disable_xla("b/168718272")  # XLA handling of NaN is inconsistent
+  def testSpecialValuesOuterAxis(self):
+    for dtype in [np.float32, np.float64]:
+      arr = np.random.rand(1000, 3, 50).astype(dtype)
+      arr[500, 1, 7] = np.nan
+      arr[20, 2, 9] = np.inf
+      self._compareAll(arr, [1])
+      self._compareAll(arr.reshape([3000, 50]), [0])
+
   def testInt64Reduce3D(self):
     # Create a 3D array of int64s and reduce across all possible
     # dimensions
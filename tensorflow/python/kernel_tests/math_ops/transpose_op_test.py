@@ -434,6 +434,14 @@ class TransposeTest(test.TestCase):
     self._testBoth(
         np.arange(0, 1260).reshape([2, 3, 5, 7, 2, 3]).astype(np.int64))
 
+  def testHighRankLarge(self):
+    # Transposing the same shape twice reuses the cached plan.
+    x = np.arange(0, 3 * 2**10).reshape([3, 4, 2, 2, 2, 2, 2, 2, 4])
+    for dtype in [np.int8, np.int32, np.int64]:
+      for perm in [[8, 3, 0, 5, 1, 7, 2, 6, 4], [1, 0, 2, 3, 4, 5, 6, 8, 7]]:
+        for _ in range(2):
+          self._compareCpu(x.astype(dtype), perm)
+
   def testTranspose2DAuto(self):
     x_np = [[1, 2, 3], [4, 5, 6]]
     for use_gpu in [False, True]:
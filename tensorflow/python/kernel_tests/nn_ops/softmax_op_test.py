@@ -143,6 +143,16 @@ class SoftmaxTest(test.TestCase):
         data = np.random.rand(row, col)
         self._testAll(data.astype(np.float32))
 
+  def testLongRows(self):
+    # The CPU kernel reads the rows by blocks, whose maximum logits differ
+    # from the one of the row, including blocks of only -inf logits.
+    np.random.seed(3)
+    features = np.random.randn(5, 1000).astype(np.float32)
+    features += np.linspace(-30., 30., 1000, dtype=np.float32)
+    features[1, :300] = -np.inf
+    features[2, 700:] = -np.inf
+    self._testAll(features)
+
   def testHalf(self):
     self._testAll(
         np.array([[1., 1., 1., 1.], [1., 2., 3., 4.]]).astype(np.float16))
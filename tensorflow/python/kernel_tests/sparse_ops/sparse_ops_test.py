@@ -707,6 +707,26 @@ class SparseFillEmptyRowsTest(test_util.TensorFlowTestCase):
       self.assertAllEqual(output.dense_shape, [2, 5])
       self.assertAllEqual(empty_row_indicator_out, np.zeros(2).astype(np.bool_))
 
+  def testOrderedWithLeadingAndTrailingEmptyRows(self):
+    with test_util.use_gpu():
+      sp_input = sparse_tensor.SparseTensor(
+          indices=np.array([[2, 1], [2, 3], [4, 0]]),
+          values=np.array([1, 2, 3]),
+          dense_shape=np.array([6, 5]))
+      sp_output, empty_row_indicator = (
+          sparse_ops.sparse_fill_empty_rows(sp_input, -1))
+
+      output, empty_row_indicator_out = self.evaluate(
+          [sp_output, empty_row_indicator])
+
+      self.assertAllEqual(
+          output.indices,
+          [[0, 0], [1, 0], [2, 1], [2, 3], [3, 0], [4, 0], [5, 0]])
+      self.assertAllEqual(output.values, [-1, -1, 1, 2, -1, 3, -1])
+      self.assertAllEqual(output.dense_shape, [6, 5])
+      self.assertAllEqual(empty_row_indicator_out,
+                          np.array([1, 1, 0, 1, 0, 1]).astype(np.bool_))
+
   def testUnordered(self):
     with test_util.use_gpu():
       sp_input = sparse_tensor.SparseTensor(
@@ -138,6 +138,21 @@ class SparseReorderTest(test.TestCase, parameterized.TestCase):
         self.assertAllEqual(output_val.dense_shape,
                             expected_output_val.dense_shape)
 
+  def testLargeOutOfOrder(self):
+    # Large enough to be sorted by a radix sort of the linearized indices,
+    # with more than 8 bits of them so that it takes several passes.
+    dense_shape = [300, 7, 500]
+    num_entries = 50000
+    linear = np.random.choice(np.prod(dense_shape), num_entries, replace=False)
+    indices = np.stack(np.unravel_index(linear, dense_shape), axis=1)
+    values = np.arange(num_entries, dtype=np.float32)
+    order = np.argsort(linear)
+    sp_output = self.evaluate(
+        sparse_ops.sparse_reorder(
+            sparse_tensor.SparseTensor(indices, values, dense_shape)))
+    self.assertAllEqual(sp_output.indices, indices[order])
+    self.assertAllEqual(sp_output.values, values[order])
+
   @test_util.run_deprecated_v1
   def testGradients(self):
     with self.session():
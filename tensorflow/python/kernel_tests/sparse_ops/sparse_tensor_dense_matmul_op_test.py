@@ -238,6 +238,18 @@ class SparseTensorDenseMatMulTest(test.TestCase):
     self._testLarge(np.complex64)
     self._testLarge(np.complex128)
 
+  # Tests a wide and very sparse product, which is computed in parallel over
+  # the rows of the output.
+  def testWideSparse(self):
+    np.random.seed(127)  # Repeatable results
+    for np_dtype in [np.float32, np.complex64]:
+      x = _maybe_complex(np.random.rand(128, 20000).astype(np_dtype))
+      x[np.abs(x) < 0.99] = 0
+      y = _maybe_complex(np.random.randn(20000, 64).astype(np_dtype))
+
+      self._testMatmul(x, y, adjoint_a=False, adjoint_b=False)
+      self._testMatmul(x.transpose(), y, adjoint_a=True, adjoint_b=False)
+
   # Tests random sized matrices.
   def testFloatRandom(self):
     np.random.seed(127)  # Repeatable results
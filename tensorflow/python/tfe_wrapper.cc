@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <memory>
+#include <optional>
 
 // Must be included first
 // clang-format off
@@ -1824,7 +1825,8 @@ PYBIND11_MODULE(_pywrap_tfe, m) {
         py::return_value_policy::reference);
 
   // DLPack functions
-  m.def("TFE_ToDlpackCapsule", [](py::handle& o) {
+  m.def("TFE_ToDlpackCapsule", [](py::handle& o,
+                                  std::optional<intptr_t> stream) {
     PyObject* eager_tensor_pyobject_ptr = o.ptr();
     tensorflow::Safe_TF_StatusPtr status =
         tensorflow::make_safe(TF_NewStatus());
@@ -1836,7 +1838,11 @@ PYBIND11_MODULE(_pywrap_tfe, m) {
     }
 
     TFE_TensorHandle* thandle = EagerTensor_Handle(eager_tensor_pyobject_ptr);
-    void* dlm_ptr = tensorflow::TFE_HandleToDLPack(thandle, status.get());
+    void* dlm_ptr =
+        stream.has_value()
+            ? tensorflow::TFE_HandleToDLPackOnStream(thandle, *stream,
+                                                     status.get())
+            : tensorflow::TFE_HandleToDLPack(thandle, status.get());
     tensorflow::MaybeRaiseRegisteredFromTFStatus(status.get());
 
     py::capsule capsule(
@@ -1878,6 +1884,17 @@ PYBIND11_MODULE(_pywrap_tfe, m) {
     return tensorflow::PyoOrThrow(pyhandle);
   });
 
+  m.def("TFE_DLPackConsumerStream",
+        [](const py::handle& context, const char* device_name) {
+          tensorflow::Safe_TF_StatusPtr status =
+              tensorflow::make_safe(TF_NewStatus());
+          intptr_t stream = tensorflow::TFE_DLPackConsumerStream(
+              tensorflow::InputTFE_Context(context), device_name,
+              status.get());
+          tensorflow::MaybeRaiseRegisteredFromTFStatus(status.get());
+          return stream;
+        });
+
   m.def("TFE_Py_IsCustomDevice",
         [](const py::handle& context, const char* device_name) {
           return TFE_IsCustomDevice(tensorflow::InputTFE_Context(context),
@@ -347,6 +347,33 @@ class TrainingOpsTest(TensorFlowTestCase):
       self._testTypesForSparseAdagrad(x, y, lr, empty_grad, empty_indices,
                                       use_gpu)
 
+  @test_util.run_v1_only("SparseApplyAdagrad op returns a ref, so it is not "
+                         "supported in eager mode.")
+  def testSparseApplyAdagradDuplicateIndices(self):
+    # The updates of a duplicated index are applied one after the other, even
+    # though the rows are updated in parallel.
+    np.random.seed(127)
+    x = np.random.rand(100, 16)
+    y = np.random.rand(100, 16) + 1.0
+    lr = np.array(0.1)
+    indices = np.random.randint(0, 100, size=5000).astype(np.int64)
+    grad = np.random.randn(5000, 16)
+    expected_x = np.copy(x)
+    expected_y = np.copy(y)
+    for i, index in enumerate(indices):
+      expected_y[index] += grad[i] * grad[i]
+      expected_x[index] -= lr * grad[i] / np.sqrt(expected_y[index])
+
+    with self.session(use_gpu=False):
+      var = variable_v1.VariableV1(x)
+      accum = variable_v1.VariableV1(y)
+      self.evaluate(variables.global_variables_initializer())
+      self.evaluate(
+          gen_training_ops.sparse_apply_adagrad(var, accum, lr, grad,
+                                                constant_op.constant(indices)))
+      self.assertAllClose(expected_x, self.evaluate(var))
+      self.assertAllClose(expected_y, self.evaluate(accum))
+
   @test_util.run_v1_only("SparseApplyAdagrad op returns a ref, so it is not "
                          "supported in eager mode.")
   def testSparseApplyAdagradDim1(self):
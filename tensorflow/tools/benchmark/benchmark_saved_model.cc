@@ -0,0 +1,456 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary to benchmark a SavedModel end to end, across thread counts and
+// batch sizes, and to report the results as JSON for regression tracking.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/benchmark_saved_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "json/json.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/core/util/stat_summarizer.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace benchmark_saved_model {
+
+namespace {
+
+// Floating point inputs are uniform in [0, 1), so that the timings don't
+// depend on fast paths for zeros, and the other inputs are zeros, which are
+// valid indices and lengths.
+template <class T>
+T GeneratedValue(random::SimplePhilox* rng) {
+  return T();
+}
+
+template <>
+float GeneratedValue<float>(random::SimplePhilox* rng) {
+  return rng->RandFloat();
+}
+
+template <>
+double GeneratedValue<double>(random::SimplePhilox* rng) {
+  return rng->RandDouble();
+}
+
+template <class T>
+void FillTensor(random::SimplePhilox* rng, Tensor* tensor) {
+  auto flat = tensor->flat<T>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = GeneratedValue<T>(rng);
+  }
+}
+
+Status GenerateInput(const TensorInfo& info, int64_t batch_size,
+                     random::SimplePhilox* rng, Tensor* tensor) {
+  TensorShape shape;
+  if (info.tensor_shape().unknown_rank()) {
+    shape.AddDim(batch_size);
+  } else {
+    bool batch_dim_found = false;
+    for (const auto& dim : info.tensor_shape().dim()) {
+      if (dim.size() >= 0) {
+        TF_RETURN_IF_ERROR(shape.AddDimWithStatus(dim.size()));
+      } else if (!batch_dim_found) {
+        shape.AddDim(batch_size);
+        batch_dim_found = true;
+      } else {
+        shape.AddDim(1);
+      }
+    }
+  }
+  *tensor = Tensor(info.dtype(), shape);
+  switch (info.dtype()) {
+    case DT_FLOAT:
+      FillTensor<float>(rng, tensor);
+      break;
+    case DT_DOUBLE:
+      FillTensor<double>(rng, tensor);
+      break;
+    case DT_INT32:
+      FillTensor<int32>(rng, tensor);
+      break;
+    case DT_INT64:
+      FillTensor<int64_t>(rng, tensor);
+      break;
+    case DT_UINT8:
+      FillTensor<uint8>(rng, tensor);
+      break;
+    case DT_BOOL:
+      FillTensor<bool>(rng, tensor);
+      break;
+    case DT_STRING:
+      FillTensor<tstring>(rng, tensor);
+      break;
+    default:
+      return errors::Unimplemented("Can't generate inputs of type ",
+                                   DataTypeString(info.dtype()), " for ",
+                                   info.name(), "; use --input_bundle");
+  }
+  return OkStatus();
+}
+
+SessionOptions GetSessionOptions(Runtime runtime, int num_threads) {
+  SessionOptions options;
+  ConfigProto& config = options.config;
+  if (num_threads > 0) {
+    config.set_intra_op_parallelism_threads(num_threads);
+    config.set_inter_op_parallelism_threads(num_threads);
+  }
+  if (runtime == Runtime::kXlaAutoJit) {
+    config.mutable_graph_options()
+        ->mutable_optimizer_options()
+        ->set_global_jit_level(OptimizerOptions::ON_1);
+  }
+  return options;
+}
+
+// Benchmarks a batch of `inputs` on `bundle`.
+Status BenchmarkInputs(const BenchmarkOptions& options,
+                       const SavedModelBundle& bundle,
+                       const std::vector<std::pair<string, Tensor>>& inputs,
+                       const std::vector<string>& output_names,
+                       BenchmarkResult* result) {
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < options.warmup_runs; ++i) {
+    TF_RETURN_IF_ERROR(bundle.session->Run(inputs, output_names, {}, &outputs));
+  }
+
+  Allocator* allocator = cpu_allocator();
+  allocator->ClearStats();
+  std::vector<int64_t> latencies_us;
+  int64_t total_us = 0;
+  while (static_cast<int64_t>(latencies_us.size()) < options.num_runs &&
+         total_us < options.max_time_s * 1000000) {
+    const int64_t start_us = Env::Default()->NowMicros();
+    TF_RETURN_IF_ERROR(bundle.session->Run(inputs, output_names, {}, &outputs));
+    latencies_us.push_back(Env::Default()->NowMicros() - start_us);
+    total_us += latencies_us.back();
+  }
+  if (latencies_us.empty()) {
+    return errors::InvalidArgument("The timed phase didn't run the model");
+  }
+  if (absl::optional<AllocatorStats> stats = allocator->GetStats()) {
+    result->peak_memory_bytes = stats->peak_bytes_in_use;
+  }
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  result->num_runs = latencies_us.size();
+  result->min_us = latencies_us.front();
+  result->mean_us = total_us / result->num_runs;
+  result->p50_us = Percentile(latencies_us, 50);
+  result->p90_us = Percentile(latencies_us, 90);
+  result->p99_us = Percentile(latencies_us, 99);
+  result->max_us = latencies_us.back();
+  result->throughput =
+      total_us > 0 ? result->batch_size * result->num_runs * 1e6 / total_us
+                   : 0.0;
+
+  if (options.profile_runs > 0) {
+    RunOptions run_options;
+    run_options.set_trace_level(RunOptions::FULL_TRACE);
+    StatSummarizer stats((StatSummarizerOptions()));
+    for (int i = 0; i < options.profile_runs; ++i) {
+      RunMetadata run_metadata;
+      TF_RETURN_IF_ERROR(bundle.session->Run(run_options, inputs, output_names,
+                                             {}, &outputs, &run_metadata));
+      stats.ProcessStepStats(run_metadata.step_stats());
+    }
+    std::map<std::string, int64_t> count;
+    std::map<std::string, int64_t> memory;
+    std::map<std::string, int64_t> times_called;
+    int64_t accumulated_us = 0;
+    stats.ComputeStatsByType(&count, &result->op_type_us, &memory,
+                             &times_called, &accumulated_us);
+  }
+  return OkStatus();
+}
+
+Status ParseIntList(const string& name, const string& value,
+                    std::vector<int>* values) {
+  values->clear();
+  for (const string& item :
+       str_util::Split(value, ',', str_util::SkipEmpty())) {
+    int32_t parsed;
+    if (!strings::safe_strto32(item, &parsed) || parsed < 0) {
+      return errors::InvalidArgument("Invalid --", name, "=", value);
+    }
+    values->push_back(parsed);
+  }
+  if (values->empty()) {
+    return errors::InvalidArgument("--", name, " must not be empty");
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status ParseRuntime(StringPiece name, Runtime* runtime) {
+  if (name == "direct_session") {
+    *runtime = Runtime::kDirectSession;
+  } else if (name == "xla_auto_jit") {
+    *runtime = Runtime::kXlaAutoJit;
+  } else {
+    return errors::InvalidArgument(
+        "Unknown runtime ", name,
+        "; expected \"direct_session\" or \"xla_auto_jit\"");
+  }
+  return OkStatus();
+}
+
+std::string RuntimeName(Runtime runtime) {
+  switch (runtime) {
+    case Runtime::kDirectSession:
+      return "direct_session";
+    case Runtime::kXlaAutoJit:
+      return "xla_auto_jit";
+  }
+  return "unknown";
+}
+
+Status CreateInputs(const SignatureDef& signature, int64_t batch_size,
+                    const std::string& input_bundle,
+                    std::vector<std::pair<std::string, Tensor>>* inputs) {
+  // Sorts the inputs by key, so that the generated values are deterministic.
+  std::map<string, const TensorInfo*> infos;
+  for (const auto& input : signature.inputs()) {
+    if (input.second.encoding_case() != TensorInfo::kName) {
+      return errors::Unimplemented("Input ", input.first,
+                                   " is not a dense tensor");
+    }
+    infos[input.first] = &input.second;
+  }
+
+  inputs->clear();
+  if (!input_bundle.empty()) {
+    BundleReader reader(Env::Default(), input_bundle);
+    TF_RETURN_IF_ERROR(reader.status());
+    for (const auto& info : infos) {
+      Tensor tensor;
+      TF_RETURN_IF_ERROR(reader.Lookup(info.first, &tensor));
+      if (tensor.dtype() != info.second->dtype()) {
+        return errors::InvalidArgument(
+            "Input ", info.first, " of ", input_bundle, " has type ",
+            DataTypeString(tensor.dtype()), " instead of ",
+            DataTypeString(info.second->dtype()));
+      }
+      inputs->emplace_back(info.second->name(), std::move(tensor));
+    }
+    return OkStatus();
+  }
+
+  random::PhiloxRandom philox(/*seed=*/301);
+  random::SimplePhilox rng(&philox);
+  for (const auto& info : infos) {
+    Tensor tensor;
+    TF_RETURN_IF_ERROR(GenerateInput(*info.second, batch_size, &rng, &tensor));
+    inputs->emplace_back(info.second->name(), std::move(tensor));
+  }
+  return OkStatus();
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted_values,
+                   double percentile) {
+  if (sorted_values.empty()) return 0;
+  const int64_t rank = std::ceil(percentile / 100 * sorted_values.size());
+  const int64_t index = std::min<int64_t>(
+      std::max<int64_t>(rank - 1, 0), sorted_values.size() - 1);
+  return sorted_values[index];
+}
+
+Status BenchmarkSavedModel(const BenchmarkOptions& options,
+                           std::vector<BenchmarkResult>* results) {
+  EnableCPUAllocatorStats();
+  results->clear();
+  for (int num_threads : options.thread_counts) {
+    LOG(INFO) << "Loading " << options.export_dir << " with "
+              << RuntimeName(options.runtime) << " and " << num_threads
+              << " threads";
+    SavedModelBundle bundle;
+    TF_RETURN_IF_ERROR(LoadSavedModel(
+        GetSessionOptions(options.runtime, num_threads), RunOptions(),
+        options.export_dir, options.tags, &bundle));
+    auto signature = bundle.GetSignatures().find(options.signature_key);
+    if (signature == bundle.GetSignatures().end()) {
+      return errors::NotFound("No signature ", options.signature_key, " in ",
+                              options.export_dir);
+    }
+    std::vector<string> output_names;
+    for (const auto& output : signature->second.outputs()) {
+      output_names.push_back(output.second.name());
+    }
+
+    // A replayed batch has a fixed size.
+    const std::vector<int> batch_sizes =
+        options.input_bundle.empty() ? options.batch_sizes
+                                     : std::vector<int>({0});
+    for (int batch_size : batch_sizes) {
+      std::vector<std::pair<string, Tensor>> inputs;
+      TF_RETURN_IF_ERROR(CreateInputs(signature->second, batch_size,
+                                      options.input_bundle, &inputs));
+      BenchmarkResult result;
+      result.num_threads = num_threads;
+      result.batch_size = batch_size;
+      if (!options.input_bundle.empty()) {
+        result.batch_size = inputs.empty() || inputs[0].second.dims() == 0
+                                ? 1
+                                : inputs[0].second.dim_size(0);
+      }
+      TF_RETURN_IF_ERROR(
+          BenchmarkInputs(options, bundle, inputs, output_names, &result));
+      LOG(INFO) << "Threads " << num_threads << ", batch size "
+                << result.batch_size << ": p50 " << result.p50_us
+                << "us, p99 " << result.p99_us << "us, "
+                << result.throughput << " examples/s";
+      results->push_back(std::move(result));
+    }
+  }
+  return OkStatus();
+}
+
+std::string ResultsToJson(const BenchmarkOptions& options,
+                          const std::vector<BenchmarkResult>& results) {
+  Json::Value json = Json::objectValue;
+  json["export_dir"] = options.export_dir;
+  json["signature_key"] = options.signature_key;
+  json["runtime"] = RuntimeName(options.runtime);
+  json["results"] = Json::arrayValue;
+  for (const BenchmarkResult& result : results) {
+    Json::Value entry = Json::objectValue;
+    entry["num_threads"] = result.num_threads;
+    entry["batch_size"] = Json::Int64(result.batch_size);
+    entry["num_runs"] = Json::Int64(result.num_runs);
+    Json::Value latency = Json::objectValue;
+    latency["min"] = Json::Int64(result.min_us);
+    latency["mean"] = Json::Int64(result.mean_us);
+    latency["p50"] = Json::Int64(result.p50_us);
+    latency["p90"] = Json::Int64(result.p90_us);
+    latency["p99"] = Json::Int64(result.p99_us);
+    latency["max"] = Json::Int64(result.max_us);
+    entry["latency_us"] = latency;
+    entry["throughput"] = result.throughput;
+    entry["peak_memory_bytes"] = Json::Int64(result.peak_memory_bytes);
+    Json::Value op_types = Json::objectValue;
+    for (const auto& op_type : result.op_type_us) {
+      op_types[op_type.first] = Json::Int64(op_type.second);
+    }
+    entry["op_type_us"] = op_types;
+    json["results"].append(entry);
+  }
+  Json::StreamWriterBuilder json_factory;
+  return Json::writeString(json_factory, json);
+}
+
+int Main(int argc, char** argv) {
+  BenchmarkOptions options;
+  string tags = "serve";
+  string runtime = "direct_session";
+  string thread_counts = "0";
+  string batch_sizes = "1";
+  float max_time = options.max_time_s;
+  string output_json = "";
+
+  std::vector<Flag> flag_list = {
+      Flag("saved_model_dir", &options.export_dir, "SavedModel directory"),
+      Flag("tags", &tags, "comma-separated tags of the MetaGraphDef"),
+      Flag("signature_key", &options.signature_key, "signature to run"),
+      Flag("runtime", &runtime, "direct_session or xla_auto_jit"),
+      Flag("thread_counts", &thread_counts,
+           "comma-separated thread counts, 0 for the default"),
+      Flag("batch_sizes", &batch_sizes, "comma-separated batch sizes"),
+      Flag("input_bundle", &options.input_bundle,
+           "tensor bundle prefix of inputs to replay"),
+      Flag("warmup_runs", &options.warmup_runs, "untimed runs per benchmark"),
+      Flag("num_runs", &options.num_runs, "timed runs max per benchmark"),
+      Flag("max_time", &max_time, "timed seconds max per benchmark"),
+      Flag("profile_runs", &options.profile_runs,
+           "traced runs for the op type breakdown"),
+      Flag("output_json", &output_json,
+           "file to write the JSON results to, instead of stdout"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || options.export_dir.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  options.tags.clear();
+  for (const string& tag : str_util::Split(tags, ',', str_util::SkipEmpty())) {
+    options.tags.insert(tag);
+  }
+  options.max_time_s = max_time;
+  Status s = ParseRuntime(runtime, &options.runtime);
+  s.Update(
+      ParseIntList("thread_counts", thread_counts, &options.thread_counts));
+  s.Update(ParseIntList("batch_sizes", batch_sizes, &options.batch_sizes));
+  if (!s.ok()) {
+    LOG(ERROR) << s << "\n" << usage;
+    return -1;
+  }
+
+  std::vector<BenchmarkResult> results;
+  s = BenchmarkSavedModel(options, &results);
+  if (!s.ok()) {
+    LOG(ERROR) << "Benchmark failed: " << s;
+    return -1;
+  }
+  const std::string json = ResultsToJson(options, results);
+  if (output_json.empty()) {
+    std::cout << json << std::endl;
+  } else {
+    s = WriteStringToFile(Env::Default(), output_json, json);
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not write " << output_json << ": " << s;
+      return -1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace benchmark_saved_model
+}  // namespace tensorflow
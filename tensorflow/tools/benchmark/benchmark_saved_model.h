@@ -0,0 +1,117 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_SAVED_MODEL_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_SAVED_MODEL_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace benchmark_saved_model {
+
+// The runtime which executes the SavedModel.
+enum class Runtime {
+  // A DirectSession, as created by `LoadSavedModel`.
+  kDirectSession,
+  // A DirectSession which compiles clusters of the graph with XLA.
+  kXlaAutoJit,
+};
+
+// Parses "direct_session" or "xla_auto_jit".
+Status ParseRuntime(StringPiece name, Runtime* runtime);
+std::string RuntimeName(Runtime runtime);
+
+struct BenchmarkOptions {
+  std::string export_dir;
+  std::unordered_set<std::string> tags = {"serve"};
+  std::string signature_key = "serving_default";
+  Runtime runtime = Runtime::kDirectSession;
+  // The values of `intra_op_parallelism_threads` and
+  // `inter_op_parallelism_threads` to benchmark. 0 uses the defaults.
+  std::vector<int> thread_counts = {0};
+  // The sizes of the generated batches: the first unknown dimension of each
+  // input has this size, and the other unknown dimensions have size 1.
+  std::vector<int> batch_sizes = {1};
+  // If non-empty, the prefix of a tensor bundle (as written by the `Save` op)
+  // holding one tensor per signature input, keyed by its input key, which is
+  // fed instead of generated inputs. Its batch size is the size of the first
+  // dimension of its tensors, and `batch_sizes` is ignored.
+  std::string input_bundle;
+  int warmup_runs = 5;
+  // The timed phase stops after `num_runs` runs or `max_time_s` seconds,
+  // whichever comes first.
+  int num_runs = 100;
+  double max_time_s = 10.0;
+  // If > 0, the number of traced runs after the timed phase from which the
+  // time spent in each op type is computed.
+  int profile_runs = 0;
+};
+
+struct BenchmarkResult {
+  int num_threads = 0;
+  int64_t batch_size = 0;
+  int64_t num_runs = 0;
+  // Latencies of the timed runs, in microseconds.
+  int64_t min_us = 0;
+  int64_t mean_us = 0;
+  int64_t p50_us = 0;
+  int64_t p90_us = 0;
+  int64_t p99_us = 0;
+  int64_t max_us = 0;
+  // Examples per second over the timed phase.
+  double throughput = 0.0;
+  // The peak memory allocated on the CPU during the timed phase.
+  int64_t peak_memory_bytes = 0;
+  // The average time spent per run in each op type, from the profiled runs.
+  std::map<std::string, int64_t> op_type_us;
+};
+
+// Creates the inputs of `signature` for a batch of `batch_size` examples, or
+// reads them from `input_bundle` if not empty.
+Status CreateInputs(const SignatureDef& signature, int64_t batch_size,
+                    const std::string& input_bundle,
+                    std::vector<std::pair<std::string, Tensor>>* inputs);
+
+// Returns the `percentile` (in [0, 100]) of the sorted `values`, by the
+// nearest-rank method.
+int64_t Percentile(const std::vector<int64_t>& sorted_values,
+                   double percentile);
+
+// Loads the SavedModel once per thread count and benchmarks it for each batch
+// size.
+Status BenchmarkSavedModel(const BenchmarkOptions& options,
+                           std::vector<BenchmarkResult>* results);
+
+// Returns `results` as a JSON object, for regression tracking.
+std::string ResultsToJson(const BenchmarkOptions& options,
+                          const std::vector<BenchmarkResult>& results);
+
+// Handles all setup and argument parsing.
+int Main(int argc, char** argv);
+
+}  // namespace benchmark_saved_model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_BENCHMARK_SAVED_MODEL_H_
@@ -0,0 +1,122 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/benchmark_saved_model.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace benchmark_saved_model {
+namespace {
+
+constexpr char kTestDataSharded[] =
+    "cc/saved_model/testdata/half_plus_two/00000123";
+
+BenchmarkOptions TestOptions() {
+  BenchmarkOptions options;
+  options.export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  options.signature_key = "regress_x2_to_y3";
+  options.warmup_runs = 1;
+  options.num_runs = 10;
+  return options;
+}
+
+TEST(BenchmarkSavedModelTest, Percentile) {
+  const std::vector<int64_t> values = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  EXPECT_EQ(Percentile(values, 0), 1);
+  EXPECT_EQ(Percentile(values, 50), 5);
+  EXPECT_EQ(Percentile(values, 90), 9);
+  EXPECT_EQ(Percentile(values, 99), 10);
+  EXPECT_EQ(Percentile(values, 100), 10);
+  EXPECT_EQ(Percentile({}, 50), 0);
+}
+
+TEST(BenchmarkSavedModelTest, GeneratesInputsOfBatchSize) {
+  SignatureDef signature;
+  TensorInfo& info = (*signature.mutable_inputs())["x"];
+  info.set_name("x:0");
+  info.set_dtype(DT_FLOAT);
+  info.mutable_tensor_shape()->add_dim()->set_size(-1);
+  info.mutable_tensor_shape()->add_dim()->set_size(3);
+  info.mutable_tensor_shape()->add_dim()->set_size(-1);
+
+  std::vector<std::pair<std::string, Tensor>> inputs;
+  TF_ASSERT_OK(CreateInputs(signature, /*batch_size=*/8, /*input_bundle=*/"",
+                            &inputs));
+  ASSERT_EQ(inputs.size(), 1);
+  EXPECT_EQ(inputs[0].first, "x:0");
+  EXPECT_EQ(inputs[0].second.shape(), TensorShape({8, 3, 1}));
+}
+
+TEST(BenchmarkSavedModelTest, BenchmarksThreadCountsAndBatchSizes) {
+  BenchmarkOptions options = TestOptions();
+  options.thread_counts = {1, 2};
+  options.batch_sizes = {1, 16};
+  options.profile_runs = 2;
+  std::vector<BenchmarkResult> results;
+  TF_ASSERT_OK(BenchmarkSavedModel(options, &results));
+  ASSERT_EQ(results.size(), 4);
+  EXPECT_EQ(results[0].num_threads, 1);
+  EXPECT_EQ(results[0].batch_size, 1);
+  EXPECT_EQ(results[3].num_threads, 2);
+  EXPECT_EQ(results[3].batch_size, 16);
+  for (const BenchmarkResult& result : results) {
+    EXPECT_EQ(result.num_runs, 10);
+    EXPECT_LE(result.min_us, result.p50_us);
+    EXPECT_LE(result.p50_us, result.p99_us);
+    EXPECT_LE(result.p99_us, result.max_us);
+    EXPECT_GT(result.throughput, 0);
+    EXPECT_FALSE(result.op_type_us.empty());
+  }
+
+  const std::string json = ResultsToJson(options, results);
+  EXPECT_NE(json.find("\"p99\""), std::string::npos);
+  EXPECT_NE(json.find("\"regress_x2_to_y3\""), std::string::npos);
+}
+
+TEST(BenchmarkSavedModelTest, ReplaysInputBundle) {
+  const std::string prefix = io::JoinPath(testing::TmpDir(), "inputs");
+  BundleWriter writer(Env::Default(), prefix);
+  TF_ASSERT_OK(writer.Add(
+      "inputs", test::AsTensor<float>({1, 2, 3}, TensorShape({3, 1}))));
+  TF_ASSERT_OK(writer.Finish());
+
+  BenchmarkOptions options = TestOptions();
+  options.input_bundle = prefix;
+  std::vector<BenchmarkResult> results;
+  TF_ASSERT_OK(BenchmarkSavedModel(options, &results));
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].batch_size, 3);
+}
+
+TEST(BenchmarkSavedModelTest, MissingSignature) {
+  BenchmarkOptions options = TestOptions();
+  options.signature_key = "missing";
+  std::vector<BenchmarkResult> results;
+  EXPECT_TRUE(errors::IsNotFound(BenchmarkSavedModel(options, &results)));
+}
+
+}  // namespace
+}  // namespace benchmark_saved_model
+}  // namespace tensorflow
@@ -154,7 +154,10 @@ def _tf_repositories():
         strip_prefix = "XNNPACK-dcbfffb80fb4f6fcfcfb5b3723854ec8797fa546",
         urls = tf_mirror_urls("https://github.com/google/XNNPACK/archive/dcbfffb80fb4f6fcfcfb5b3723854ec8797fa546.zip"),
     )
-    # LINT.ThenChange(//tensorflow/lite/tools/cmake/modules/xnnpack.cmake)
+    # LINT.ThenChange(
+    #     //tensorflow/lite/tools/cmake/modules/xnnpack.cmake,
+    #     //tensorflow/lite/delegates/xnnpack/weight_cache.cc:xnnpack_version,
+    # )
 
     tf_http_archive(
         name = "FXdiv",
@@ -20,12 +20,17 @@ limitations under the License.
 #include <string>
 
 #include "tsl/distributed_runtime/call_options.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/status.h"
 #include "tsl/protobuf/coordination_service.pb.h"
 
 namespace tsl {
 using tensorflow::BarrierRequest;
 using tensorflow::BarrierResponse;
+using tensorflow::BatchGetKeyValueRequest;
+using tensorflow::BatchGetKeyValueResponse;
+using tensorflow::BatchInsertKeyValueRequest;
+using tensorflow::BatchInsertKeyValueResponse;
 using tensorflow::CancelBarrierRequest;
 using tensorflow::CancelBarrierResponse;
 using tensorflow::DeleteKeyValueRequest;
@@ -54,6 +59,8 @@ using tensorflow::TryGetKeyValueRequest;
 using tensorflow::TryGetKeyValueResponse;
 using tensorflow::WaitForAllTasksRequest;
 using tensorflow::WaitForAllTasksResponse;
+using tensorflow::WatchKeyValueRequest;
+using tensorflow::WatchKeyValueResponse;
 
 // Base class of client interface for communicating with coordination service.
 // Can be implemented by a variety of transports such as gRPC.
@@ -118,6 +125,28 @@ class CoordinationClient {
                                    DeleteKeyValueResponse* response,
                                    StatusCallback done) = 0;
 
+  // The batch and watch RPCs are optional: clients that do not implement them
+  // fail them with Unimplemented.
+  virtual void BatchInsertKeyValueAsync(
+      const BatchInsertKeyValueRequest* request,
+      BatchInsertKeyValueResponse* response, StatusCallback done) {
+    done(errors::Unimplemented("BatchInsertKeyValue is not supported."));
+  }
+
+  virtual void BatchGetKeyValueAsync(CallOptions* call_opts,
+                                     const BatchGetKeyValueRequest* request,
+                                     BatchGetKeyValueResponse* response,
+                                     StatusCallback done) {
+    done(errors::Unimplemented("BatchGetKeyValue is not supported."));
+  }
+
+  virtual void WatchKeyValueAsync(CallOptions* call_opts,
+                                  const WatchKeyValueRequest* request,
+                                  WatchKeyValueResponse* response,
+                                  StatusCallback done) {
+    done(errors::Unimplemented("WatchKeyValue is not supported."));
+  }
+
   virtual void BarrierAsync(const BarrierRequest* request,
                             BarrierResponse* response, StatusCallback done) = 0;
 
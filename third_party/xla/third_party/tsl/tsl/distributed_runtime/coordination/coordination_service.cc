@@ -16,16 +16,21 @@ limitations under the License.
 #include "tsl/distributed_runtime/coordination/coordination_service.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -128,6 +133,14 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
   std::vector<KeyValueEntry> GetKeyValueDir(
       absl::string_view directory_key) override;
   Status DeleteKeyValue(const std::string& key) override;
+  // Locks a variable set of shards, which thread safety analysis cannot
+  // follow.
+  Status InsertKeyValues(const std::vector<KeyValueEntry>& kvs) override
+      TF_NO_THREAD_SAFETY_ANALYSIS;
+  void GetKeyValuesAsync(const std::vector<std::string>& keys,
+                         StatusOrValuesCallback done) override;
+  void WatchKeyValueAsync(const std::string& key, int64_t generation,
+                          WatchKeyValueCallback done) override;
   void BarrierAsync(const std::string& barrier_id, absl::Duration timeout,
                     const CoordinatedTask& task,
                     const std::vector<CoordinatedTask>& participating_tasks,
@@ -253,11 +266,37 @@ class CoordinationServiceStandaloneImpl : public CoordinationServiceInterface {
       TF_GUARDED_BY(state_mu_);
   DeviceInfo cluster_devices_ TF_GUARDED_BY(state_mu_);
 
-  mutex kv_mu_;
-  // Ordered map to store config key-values
-  std::map<std::string, std::string> kv_store_ TF_GUARDED_BY(kv_mu_);
-  absl::flat_hash_map<std::string, std::vector<StatusOrValueCallback>> get_cb_
-      TF_GUARDED_BY(kv_mu_);
+  // The key-value store is sharded by key, so that the many tasks exchanging
+  // key-values at startup do not all contend on one lock. Directory reads and
+  // deletes visit every shard.
+  static constexpr int kNumKeyValueShards = 16;
+  struct KeyValueShard {
+    mutex mu;
+    // Ordered map to store config key-values
+    std::map<std::string, std::string> kv_store TF_GUARDED_BY(mu);
+    absl::flat_hash_map<std::string, std::vector<StatusOrValueCallback>> get_cb
+        TF_GUARDED_BY(mu);
+  };
+  static int KeyValueShardIndex(absl::string_view norm_key) {
+    return absl::HashOf(norm_key) % kNumKeyValueShards;
+  }
+  std::array<KeyValueShard, kNumKeyValueShards> kv_shards_;
+
+  // Records a change of `norm_key`, and of all keys under it if
+  // `is_directory`, and completes the watches it affects.
+  void NotifyKeyValueWatches(const std::string& norm_key, bool is_directory)
+      TF_LOCKS_EXCLUDED(watch_mu_);
+  // Returns the key-value of `norm_key` followed by the ones under it.
+  std::vector<KeyValueEntry> ReadWatchedKeyValues(const std::string& norm_key);
+
+  mutex watch_mu_;
+  int64_t kv_generation_ TF_GUARDED_BY(watch_mu_) = 0;
+  // Generation of the last change at or under each key.
+  std::map<std::string, int64_t, std::less<>> kv_change_generations_
+      TF_GUARDED_BY(watch_mu_);
+  // Pending WatchKeyValueAsync() callbacks by normalized key.
+  std::map<std::string, std::vector<WatchKeyValueCallback>, std::less<>>
+      kv_watches_ TF_GUARDED_BY(watch_mu_);
 
   mutex check_staleness_thread_shutdown_mu_;
   condition_variable check_staleness_thread_cv_;
@@ -486,9 +525,9 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
 }
 
 void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
-  {
-    mutex_lock l(kv_mu_);
-    for (const auto& [key, get_kv_callbacks] : get_cb_) {
+  for (KeyValueShard& shard : kv_shards_) {
+    mutex_lock l(shard.mu);
+    for (const auto& [key, get_kv_callbacks] : shard.get_cb) {
       for (const auto& get_kv_callback : get_kv_callbacks) {
         get_kv_callback(errors::Cancelled(
             absl::StrCat("Coordination service is shutting down. Cancelling "
@@ -496,7 +535,19 @@ void CoordinationServiceStandaloneImpl::Stop(bool shut_staleness_thread) {
                          key)));
       }
     }
-    get_cb_.clear();
+    shard.get_cb.clear();
+  }
+  {
+    mutex_lock l(watch_mu_);
+    for (const auto& [key, watch_callbacks] : kv_watches_) {
+      for (const auto& watch_callback : watch_callbacks) {
+        watch_callback(errors::Cancelled(
+            absl::StrCat("Coordination service is shutting down. Cancelling "
+                         "WatchKeyValue() for key: ",
+                         key)));
+      }
+    }
+    kv_watches_.clear();
   }
   {
     mutex_lock l(state_mu_);
@@ -908,18 +959,80 @@ Status CoordinationServiceStandaloneImpl::InsertKeyValue(
     const std::string& key, const std::string& value) {
   VLOG(3) << "InsertKeyValue(): " << key << ": " << value;
   const std::string& norm_key = NormalizeKey(key);
-  mutex_lock l(kv_mu_);
-  if (kv_store_.find(norm_key) != kv_store_.end()) {
-    return MakeCoordinationError(
-        errors::AlreadyExists("Config key ", key, " already exists."));
+  std::vector<StatusOrValueCallback> callbacks;
+  {
+    KeyValueShard& shard = kv_shards_[KeyValueShardIndex(norm_key)];
+    mutex_lock l(shard.mu);
+    if (shard.kv_store.find(norm_key) != shard.kv_store.end()) {
+      return MakeCoordinationError(
+          errors::AlreadyExists("Config key ", key, " already exists."));
+    }
+    shard.kv_store.emplace(norm_key, value);
+    auto iter = shard.get_cb.find(norm_key);
+    if (iter != shard.get_cb.end()) {
+      callbacks = std::move(iter->second);
+      shard.get_cb.erase(iter);
+    }
   }
-  kv_store_.emplace(norm_key, value);
-  auto iter = get_cb_.find(norm_key);
-  if (iter != get_cb_.end()) {
-    for (const auto& cb : iter->second) {
-      cb(value);
+  // The callbacks respond to RPCs, so run them outside of the lock.
+  for (const auto& cb : callbacks) {
+    cb(value);
+  }
+  NotifyKeyValueWatches(norm_key, /*is_directory=*/false);
+  return OkStatus();
+}
+
+Status CoordinationServiceStandaloneImpl::InsertKeyValues(
+    const std::vector<KeyValueEntry>& kvs) {
+  VLOG(3) << "InsertKeyValues(): " << kvs.size() << " key-values";
+  std::vector<std::string> norm_keys;
+  norm_keys.reserve(kvs.size());
+  absl::flat_hash_set<std::string_view> unique_keys;
+  std::set<int> shard_indices;
+  for (const KeyValueEntry& kv : kvs) {
+    norm_keys.push_back(NormalizeKey(kv.key()));
+    shard_indices.insert(KeyValueShardIndex(norm_keys.back()));
+  }
+  for (int i = 0; i < kvs.size(); ++i) {
+    if (!unique_keys.insert(norm_keys[i]).second) {
+      return MakeCoordinationError(errors::InvalidArgument(
+          "Config key ", kvs[i].key(), " is inserted more than once."));
     }
-    get_cb_.erase(iter);
+  }
+
+  std::vector<std::pair<std::vector<StatusOrValueCallback>, int>> callbacks;
+  {
+    // Lock the shards in a fixed order, so that concurrent batches cannot
+    // deadlock.
+    std::vector<mutex_lock> locks;
+    locks.reserve(shard_indices.size());
+    for (int index : shard_indices) {
+      locks.emplace_back(kv_shards_[index].mu);
+    }
+    for (int i = 0; i < kvs.size(); ++i) {
+      const KeyValueShard& shard = kv_shards_[KeyValueShardIndex(norm_keys[i])];
+      if (shard.kv_store.find(norm_keys[i]) != shard.kv_store.end()) {
+        return MakeCoordinationError(errors::AlreadyExists(
+            "Config key ", kvs[i].key(), " already exists."));
+      }
+    }
+    for (int i = 0; i < kvs.size(); ++i) {
+      KeyValueShard& shard = kv_shards_[KeyValueShardIndex(norm_keys[i])];
+      shard.kv_store.emplace(norm_keys[i], kvs[i].value());
+      auto iter = shard.get_cb.find(norm_keys[i]);
+      if (iter != shard.get_cb.end()) {
+        callbacks.emplace_back(std::move(iter->second), i);
+        shard.get_cb.erase(iter);
+      }
+    }
+  }
+  for (const auto& [key_callbacks, i] : callbacks) {
+    for (const auto& cb : key_callbacks) {
+      cb(kvs[i].value());
+    }
+  }
+  for (const std::string& norm_key : norm_keys) {
+    NotifyKeyValueWatches(norm_key, /*is_directory=*/false);
   }
   return OkStatus();
 }
@@ -928,27 +1041,73 @@ void CoordinationServiceStandaloneImpl::GetKeyValueAsync(
     const std::string& key, StatusOrValueCallback done) {
   VLOG(3) << "GetKeyValue(): " << key;
   const std::string& norm_key = NormalizeKey(key);
-  mutex_lock l(kv_mu_);
-  const auto& iter = kv_store_.find(norm_key);
-  if (iter != kv_store_.end()) {
-    done(iter->second);
+  std::string value;
+  {
+    KeyValueShard& shard = kv_shards_[KeyValueShardIndex(norm_key)];
+    mutex_lock l(shard.mu);
+    const auto& iter = shard.kv_store.find(norm_key);
+    if (iter == shard.kv_store.end()) {
+      shard.get_cb[norm_key].emplace_back(std::move(done));
+      return;
+    }
+    value = iter->second;
+  }
+  done(value);
+}
+
+void CoordinationServiceStandaloneImpl::GetKeyValuesAsync(
+    const std::vector<std::string>& keys, StatusOrValuesCallback done) {
+  VLOG(3) << "GetKeyValues(): " << keys.size() << " keys";
+  if (keys.empty()) {
+    done(std::vector<std::string>());
     return;
   }
-  auto cb_iter = get_cb_.find(norm_key);
-  if (cb_iter == get_cb_.end()) {
-    cb_iter =
-        get_cb_.emplace(norm_key, std::vector<StatusOrValueCallback>()).first;
+  struct GetKeyValuesState {
+    mutex mu;
+    std::vector<std::string> values TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+    int pending TF_GUARDED_BY(mu);
+    StatusOrValuesCallback done;
+  };
+  auto state = std::make_shared<GetKeyValuesState>();
+  {
+    mutex_lock l(state->mu);
+    state->values.resize(keys.size());
+    state->pending = keys.size();
+  }
+  state->done = std::move(done);
+  for (int i = 0; i < keys.size(); ++i) {
+    GetKeyValueAsync(keys[i], [state, i](const StatusOr<std::string>& value) {
+      std::vector<std::string> values;
+      Status status;
+      {
+        mutex_lock l(state->mu);
+        if (value.ok()) {
+          state->values[i] = *value;
+        } else {
+          state->status.Update(value.status());
+        }
+        if (--state->pending > 0) return;
+        values = std::move(state->values);
+        status = state->status;
+      }
+      if (status.ok()) {
+        state->done(std::move(values));
+      } else {
+        state->done(status);
+      }
+    });
   }
-  cb_iter->second.emplace_back(std::move(done));
 }
 
 StatusOr<std::string> CoordinationServiceStandaloneImpl::TryGetKeyValue(
     const std::string& key) {
   VLOG(3) << "TryGetKeyValue(): " << key;
   const std::string& norm_key = NormalizeKey(key);
-  mutex_lock l(kv_mu_);
-  const auto& iter = kv_store_.find(norm_key);
-  if (iter == kv_store_.end()) {
+  KeyValueShard& shard = kv_shards_[KeyValueShardIndex(norm_key)];
+  mutex_lock l(shard.mu);
+  const auto& iter = shard.kv_store.find(norm_key);
+  if (iter == shard.kv_store.end()) {
     return errors::NotFound("Config key ", key, " not found.");
   }
   return iter->second;
@@ -961,24 +1120,30 @@ std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
   const std::string norm_key = NormalizeKey(directory_key);
   const std::string dir = absl::StrCat(norm_key, "/");
 
-  mutex_lock l(kv_mu_);
-  // Find first key in ordered map that has the directory prefix.
-  auto begin = kv_store_.lower_bound(dir);
-  std::map<std::string, std::string>::iterator it;
-  // Iterate through key range that match directory prefix.
-  for (it = begin; it != kv_store_.end(); ++it) {
-    // Stop once the next key does not have the directory prefix. Since keys are
-    // ordered, none of the other keys would have a matching prefix.
-    if (std::mismatch(dir.begin(), dir.end(), it->first.begin()).first !=
-        dir.end()) {
-      break;
+  for (KeyValueShard& shard : kv_shards_) {
+    mutex_lock l(shard.mu);
+    // Find first key in ordered map that has the directory prefix.
+    auto begin = shard.kv_store.lower_bound(dir);
+    std::map<std::string, std::string>::iterator it;
+    // Iterate through key range that match directory prefix.
+    for (it = begin; it != shard.kv_store.end(); ++it) {
+      // Stop once the next key does not have the directory prefix. Since keys
+      // are ordered, none of the other keys would have a matching prefix.
+      if (std::mismatch(dir.begin(), dir.end(), it->first.begin()).first !=
+          dir.end()) {
+        break;
+      }
+      KeyValueEntry kv;
+      kv.set_key(it->first);
+      kv.set_value(it->second);
+      kvs_in_directory.push_back(kv);
     }
-    KeyValueEntry kv;
-    kv.set_key(it->first);
-    kv.set_value(it->second);
-    kvs_in_directory.push_back(kv);
   }
-
+  // Keep returning the key-values ordered by key.
+  std::sort(kvs_in_directory.begin(), kvs_in_directory.end(),
+            [](const KeyValueEntry& a, const KeyValueEntry& b) {
+              return a.key() < b.key();
+            });
   return kvs_in_directory;
 }
 
@@ -986,24 +1151,118 @@ Status CoordinationServiceStandaloneImpl::DeleteKeyValue(
     const std::string& key) {
   VLOG(3) << "DeleteKeyValue(): " << key;
   const std::string& norm_key = NormalizeKey(key);
-  mutex_lock l(kv_mu_);
   // Delete directory: find key range that match directory prefix
   const std::string& dir = strings::StrCat(norm_key, "/");
-  auto begin = kv_store_.lower_bound(dir);
-  std::map<std::string, std::string>::iterator end;
-  for (end = begin; end != kv_store_.end(); end++) {
-    if (std::mismatch(dir.begin(), dir.end(), end->first.begin()).first !=
-        dir.end())
-      break;
+  for (KeyValueShard& shard : kv_shards_) {
+    mutex_lock l(shard.mu);
+    auto begin = shard.kv_store.lower_bound(dir);
+    std::map<std::string, std::string>::iterator end;
+    for (end = begin; end != shard.kv_store.end(); end++) {
+      if (std::mismatch(dir.begin(), dir.end(), end->first.begin()).first !=
+          dir.end())
+        break;
+    }
+    shard.kv_store.erase(begin, end);
   }
-  kv_store_.erase(begin, end);
-  auto iter = kv_store_.find(norm_key);
-  if (iter != kv_store_.end()) {
-    kv_store_.erase(iter);
+  {
+    KeyValueShard& shard = kv_shards_[KeyValueShardIndex(norm_key)];
+    mutex_lock l(shard.mu);
+    auto iter = shard.kv_store.find(norm_key);
+    if (iter != shard.kv_store.end()) {
+      shard.kv_store.erase(iter);
+    }
   }
+  NotifyKeyValueWatches(norm_key, /*is_directory=*/true);
   return OkStatus();
 }
 
+void CoordinationServiceStandaloneImpl::WatchKeyValueAsync(
+    const std::string& key, int64_t generation, WatchKeyValueCallback done) {
+  VLOG(3) << "WatchKeyValue(): " << key << " after generation " << generation;
+  const std::string norm_key = NormalizeKey(key);
+  if (norm_key.empty()) {
+    done(MakeCoordinationError(
+        errors::InvalidArgument("Cannot watch an empty key.")));
+    return;
+  }
+  WatchedKeyValues result;
+  {
+    mutex_lock l(watch_mu_);
+    auto iter = kv_change_generations_.find(norm_key);
+    if (iter == kv_change_generations_.end() || iter->second <= generation) {
+      kv_watches_[norm_key].push_back(std::move(done));
+      return;
+    }
+    result.generation = kv_generation_;
+  }
+  // Changes after `result.generation` may already be visible here. They are
+  // returned again by the next watch, which is harmless.
+  result.kvs = ReadWatchedKeyValues(norm_key);
+  done(result);
+}
+
+void CoordinationServiceStandaloneImpl::NotifyKeyValueWatches(
+    const std::string& norm_key, bool is_directory) {
+  std::vector<std::pair<std::string, WatchKeyValueCallback>> triggered;
+  WatchedKeyValues result;
+  {
+    mutex_lock l(watch_mu_);
+    result.generation = ++kv_generation_;
+    // The key changed, and so did the directories that contain it.
+    absl::string_view path = norm_key;
+    while (!path.empty()) {
+      kv_change_generations_[std::string(path)] = result.generation;
+      auto iter = kv_watches_.find(path);
+      if (iter != kv_watches_.end()) {
+        for (auto& done : iter->second) {
+          triggered.emplace_back(iter->first, std::move(done));
+        }
+        kv_watches_.erase(iter);
+      }
+      const size_t pos = path.rfind('/');
+      path = pos == absl::string_view::npos ? "" : path.substr(0, pos);
+    }
+    if (is_directory) {
+      // Deleting a directory also changes every key under it.
+      const std::string dir = absl::StrCat(norm_key, "/");
+      for (auto iter = kv_change_generations_.lower_bound(dir);
+           iter != kv_change_generations_.end() &&
+           absl::StartsWith(iter->first, dir);
+           ++iter) {
+        iter->second = result.generation;
+      }
+      auto iter = kv_watches_.lower_bound(dir);
+      while (iter != kv_watches_.end() && absl::StartsWith(iter->first, dir)) {
+        for (auto& done : iter->second) {
+          triggered.emplace_back(iter->first, std::move(done));
+        }
+        iter = kv_watches_.erase(iter);
+      }
+    }
+  }
+  for (const auto& [key, done] : triggered) {
+    result.kvs = ReadWatchedKeyValues(key);
+    done(result);
+  }
+}
+
+std::vector<KeyValueEntry>
+CoordinationServiceStandaloneImpl::ReadWatchedKeyValues(
+    const std::string& norm_key) {
+  std::vector<KeyValueEntry> kvs;
+  StatusOr<std::string> value = TryGetKeyValue(norm_key);
+  if (value.ok()) {
+    KeyValueEntry kv;
+    kv.set_key(norm_key);
+    kv.set_value(*std::move(value));
+    kvs.push_back(std::move(kv));
+  }
+  std::vector<KeyValueEntry> kvs_in_directory = GetKeyValueDir(norm_key);
+  kvs.insert(kvs.end(), std::make_move_iterator(kvs_in_directory.begin()),
+             std::make_move_iterator(kvs_in_directory.end()));
+  return kvs;
+}
+
 void CoordinationServiceStandaloneImpl::SetTaskError(
     absl::string_view task_name, Status error) {
   cluster_state_[task_name]->SetError(error);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_COORDINATION_COORDINATION_SERVICE_H_
 #define TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_COORDINATION_COORDINATION_SERVICE_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
@@ -71,6 +72,17 @@ class CoordinationServiceInterface {
 
   using StatusOrValueCallback =
       std::function<void(const StatusOr<std::string>&)>;
+  using StatusOrValuesCallback =
+      std::function<void(const StatusOr<std::vector<std::string>>&)>;
+
+  // Key-values returned by WatchKeyValueAsync(), with the generation of the
+  // store at which they were read.
+  struct WatchedKeyValues {
+    int64_t generation = 0;
+    std::vector<tensorflow::KeyValueEntry> kvs;
+  };
+  using WatchKeyValueCallback =
+      std::function<void(const StatusOr<WatchedKeyValues>&)>;
 
   virtual ~CoordinationServiceInterface() = default;
 
@@ -182,6 +194,31 @@ class CoordinationServiceInterface {
   // up all key-values under the directory.
   virtual Status DeleteKeyValue(const std::string& key) = 0;
 
+  // Insert several configuration key-values at once. If one of the keys
+  // already exists, or appears more than once, no key-value is inserted.
+  // Possible service errors:
+  //   - InvalidArgument: duplicated key in `kvs`.
+  //   - AlreadyExists: key is already set.
+  virtual Status InsertKeyValues(
+      const std::vector<tensorflow::KeyValueEntry>& kvs) = 0;
+
+  // Get several configuration key-values at once. The `done` callback is
+  // invoked with the values, in the order of `keys`, when all of them are
+  // available.
+  virtual void GetKeyValuesAsync(const std::vector<std::string>& keys,
+                                 StatusOrValuesCallback done) = 0;
+
+  // Watch a key and the directory it names. The `done` callback is invoked
+  // with the current key-values at or under `key` once one of them was
+  // inserted or deleted after `generation`, immediately if that already
+  // happened. Pass the returned generation to the next call to wait for the
+  // next change; generation 0 waits for the first one.
+  // Possible service errors:
+  //   - InvalidArgument: empty key.
+  //   - Cancelled: the service is stopping.
+  virtual void WatchKeyValueAsync(const std::string& key, int64_t generation,
+                                  WatchKeyValueCallback done) = 0;
+
   // Blocks until all (or a subset of) tasks are at the barrier or the barrier
   // fails.
   //
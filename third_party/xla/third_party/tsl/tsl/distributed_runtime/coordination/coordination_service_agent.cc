@@ -28,6 +28,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -109,6 +110,9 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
                            StatusOrValueDirCallback done) override;
   Status InsertKeyValue(std::string_view key, std::string_view value) override;
   Status DeleteKeyValue(std::string_view key) override;
+  Status InsertKeyValues(const std::vector<KeyValueEntry>& kvs) override;
+  StatusOr<std::vector<std::string>> GetKeyValues(
+      const std::vector<std::string>& keys) override;
   Status UpdateKeyValue(std::string_view key, std::string_view value) override;
 
   Status StartWatchKey(std::string_view key,
@@ -135,6 +139,15 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   void StopHeartbeat();
 
  private:
+  struct KeyWatch {
+    std::string key;
+    ChangedKeyValuesCallback on_change;
+    CallOptions call_opts;
+  };
+  // Waits for the changes of `watch->key` after `generation`, and then for
+  // the next ones until the watch is stopped.
+  void WatchKeyValue(std::shared_ptr<KeyWatch> watch, int64_t generation);
+
   Env* env_ = nullptr;  // Not owned.
   const uint64_t incarnation_id_ = random::New64();
   CoordinatedTask task_;
@@ -157,6 +170,11 @@ class CoordinationServiceAgentImpl : public CoordinationServiceAgent {
   condition_variable heartbeat_thread_cv_;
   bool shutting_down_ TF_GUARDED_BY(heartbeat_thread_shutdown_mu_) = false;
   std::unique_ptr<Thread> heartbeat_thread_;
+  // Must outlive coordination client which may need to access them within
+  // WatchKeyValue() callbacks.
+  mutex watch_mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<KeyWatch>> watches_
+      TF_GUARDED_BY(watch_mu_);
   // Must outlive coordination client which may need to access it within
   // GetKeyValueAsync() callbacks.
   CancellationManager cancellation_manager_;
@@ -519,7 +537,7 @@ Status CoordinationServiceAgentImpl::Shutdown() {
     state_ = CoordinatedTaskState::TASKSTATE_DISCONNECTED;
   }
 
-  // Cancel all pending GetKeyValue() RPC calls.
+  // Cancel all pending GetKeyValue() and WatchKeyValue() RPC calls.
   cancellation_manager_.StartCancel();
   return status;
 }
@@ -723,6 +741,59 @@ Status CoordinationServiceAgentImpl::DeleteKeyValue(std::string_view key) {
   return OkStatus();
 }
 
+Status CoordinationServiceAgentImpl::InsertKeyValues(
+    const std::vector<KeyValueEntry>& kvs) {
+  BatchInsertKeyValueRequest request;
+  *request.mutable_kvs() = {kvs.begin(), kvs.end()};
+  VLOG(3) << "BatchInsertKeyValueRequest: " << kvs.size() << " key-values";
+  BatchInsertKeyValueResponse response;
+
+  Status status;
+  absl::Notification n;
+  leader_client_->BatchInsertKeyValueAsync(&request, &response, [&](Status s) {
+    status = s;
+    n.Notify();
+  });
+  n.WaitForNotification();
+  VLOG(3) << "BatchInsertKeyValueResponse: " << status;
+  return status;
+}
+
+StatusOr<std::vector<std::string>> CoordinationServiceAgentImpl::GetKeyValues(
+    const std::vector<std::string>& keys) {
+  BatchGetKeyValueRequest request;
+  *request.mutable_keys() = {keys.begin(), keys.end()};
+  VLOG(3) << "BatchGetKeyValueRequest: " << keys.size() << " keys";
+  BatchGetKeyValueResponse response;
+  CallOptions call_opts;
+
+  const CancellationToken token =
+      cancellation_manager_.get_cancellation_token();
+  const bool already_cancelled = !cancellation_manager_.RegisterCallback(
+      token, [&call_opts]() { call_opts.StartCancel(); });
+  if (already_cancelled) {
+    return absl::CancelledError("GetKeyValues() was cancelled.");
+  }
+  Status status;
+  absl::Notification n;
+  leader_client_->BatchGetKeyValueAsync(&call_opts, &request, &response,
+                                        [&](Status s) {
+                                          status = s;
+                                          n.Notify();
+                                        });
+  n.WaitForNotification();
+  cancellation_manager_.TryDeregisterCallback(token);
+  VLOG(3) << "BatchGetKeyValueResponse: " << status;
+  if (!status.ok()) return status;
+
+  std::vector<std::string> values;
+  values.reserve(response.kvs_size());
+  for (KeyValueEntry& kv : *response.mutable_kvs()) {
+    values.push_back(std::move(*kv.mutable_value()));
+  }
+  return values;
+}
+
 Status CoordinationServiceAgentImpl::UpdateKeyValue(std::string_view key,
                                                     std::string_view value) {
   return MakeCoordinationError(absl::UnimplementedError(
@@ -732,13 +803,74 @@ Status CoordinationServiceAgentImpl::UpdateKeyValue(std::string_view key,
 Status CoordinationServiceAgentImpl::StartWatchKey(
     std::string_view key,
     CoordinationServiceAgentImpl::ChangedKeyValuesCallback on_change) {
-  return MakeCoordinationError(absl::UnimplementedError(
-      "CoordinationServiceAgent::StartWatchKey is not implemented."));
+  auto watch = std::make_shared<KeyWatch>();
+  watch->key = std::string(key);
+  watch->on_change = std::move(on_change);
+  {
+    mutex_lock l(watch_mu_);
+    if (!watches_.emplace(watch->key, watch).second) {
+      return MakeCoordinationError(absl::AlreadyExistsError(
+          absl::StrCat("Key ", key, " is already watched.")));
+    }
+  }
+  WatchKeyValue(std::move(watch), /*generation=*/0);
+  return OkStatus();
 }
 
 Status CoordinationServiceAgentImpl::StopWatchKey(std::string_view key) {
-  return MakeCoordinationError(absl::UnimplementedError(
-      "CoordinationServiceAgent::StopWatchKey is not implemented."));
+  std::shared_ptr<KeyWatch> watch;
+  {
+    mutex_lock l(watch_mu_);
+    auto it = watches_.find(key);
+    if (it == watches_.end()) {
+      return MakeCoordinationError(absl::NotFoundError(
+          absl::StrCat("Key ", key, " is not watched.")));
+    }
+    watch = std::move(it->second);
+    watches_.erase(it);
+  }
+  watch->call_opts.StartCancel();
+  return OkStatus();
+}
+
+void CoordinationServiceAgentImpl::WatchKeyValue(
+    std::shared_ptr<KeyWatch> watch, int64_t generation) {
+  auto request = std::make_shared<WatchKeyValueRequest>();
+  request->set_key(watch->key);
+  request->set_generation(generation);
+  VLOG(3) << "WatchKeyValueRequest: " << request->DebugString();
+  auto response = std::make_shared<WatchKeyValueResponse>();
+
+  const CancellationToken token =
+      cancellation_manager_.get_cancellation_token();
+  const bool already_cancelled = !cancellation_manager_.RegisterCallback(
+      token, [watch]() { watch->call_opts.StartCancel(); });
+  if (already_cancelled) return;
+  leader_client_->WatchKeyValueAsync(
+      &watch->call_opts, request.get(), response.get(),
+      [this, watch, request, response, token](const Status& s) {
+        cancellation_manager_.TryDeregisterCallback(token);
+        watch->call_opts.ClearCancelCallback();
+        if (!s.ok()) {
+          VLOG(3) << "WatchKeyValueResponse: " << s;
+          mutex_lock l(watch_mu_);
+          auto it = watches_.find(watch->key);
+          if (it != watches_.end() && it->second == watch) {
+            LOG(WARNING) << "Stopped watching key " << watch->key << ": " << s;
+            watches_.erase(it);
+          }
+          return;
+        }
+        VLOG(3) << "WatchKeyValueResponse: " << response->DebugString();
+        std::map<std::string, std::string> kvs;
+        for (KeyValueEntry& kv : *response->mutable_kvs()) {
+          kvs.emplace(std::move(*kv.mutable_key()),
+                      std::move(*kv.mutable_value()));
+        }
+        if (ActivateWatch(watch->key, kvs).ok()) {
+          WatchKeyValue(watch, response->generation());
+        }
+      });
 }
 
 void CoordinationServiceAgentImpl::SetError(const Status& error) {
@@ -754,8 +886,18 @@ void CoordinationServiceAgentImpl::SetError(const Status& error) {
 
 Status CoordinationServiceAgentImpl::ActivateWatch(
     std::string_view key, const std::map<std::string, std::string>& kvs) {
-  return MakeCoordinationError(absl::UnimplementedError(
-      "CoordinationServiceAgent::ActivateWatch is not implemented."));
+  std::shared_ptr<KeyWatch> watch;
+  {
+    mutex_lock l(watch_mu_);
+    auto it = watches_.find(key);
+    if (it == watches_.end()) {
+      return MakeCoordinationError(absl::NotFoundError(
+          absl::StrCat("Key ", key, " is not watched.")));
+    }
+    watch = it->second;
+  }
+  watch->on_change(kvs);
+  return OkStatus();
 }
 
 Status CoordinationServiceAgentImpl::WaitAtBarrier(
@@ -196,6 +196,19 @@ class CoordinationServiceAgent {
   virtual Status InsertKeyValue(std::string_view key,
                                 std::string_view value) = 0;
 
+  // Insert several config key-values to the service in one RPC. Either all of
+  // them are inserted or none is.
+  //   - AlreadyExists: one of the keys is already set.
+  //   - InvalidArgument: one of the keys appears more than once.
+  virtual Status InsertKeyValues(
+      const std::vector<tensorflow::KeyValueEntry>& kvs) = 0;
+
+  // Get several config key-values from the service in one RPC, in the order
+  // of `keys`. This is a blocking call that waits until all of the keys are
+  // inserted.
+  virtual StatusOr<std::vector<std::string>> GetKeyValues(
+      const std::vector<std::string>& keys) = 0;
+
   // Delete config keys in the coordination service.
   virtual Status DeleteKeyValue(std::string_view key) = 0;
 
@@ -204,7 +217,11 @@ class CoordinationServiceAgent {
                                 std::string_view value) = 0;
 
   // Register a callback that will be invoked when the key or keys under the key
-  // directory are changed (inserted, deleted, or updated).
+  // directory are changed (inserted, deleted, or updated). The callback is
+  // invoked with all of the current key-values at or under the key, first once
+  // any of them is set. The service pushes the changes through a long-polling
+  // RPC, so there is no need to poll GetKeyValueDir().
+  //   - AlreadyExists: the key is already watched.
   virtual Status StartWatchKey(std::string_view key,
                                ChangedKeyValuesCallback on_change) = 0;
   virtual Status StopWatchKey(std::string_view key) = 0;
@@ -264,6 +264,66 @@ void CoordinationServiceRpcHandler::DeleteKeyValueAsync(
   done(service_->DeleteKeyValue(request->key()));
 }
 
+void CoordinationServiceRpcHandler::BatchInsertKeyValueAsync(
+    const BatchInsertKeyValueRequest* request,
+    BatchInsertKeyValueResponse* response, StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  done(service_->InsertKeyValues({request->kvs().begin(),
+                                  request->kvs().end()}));
+}
+
+void CoordinationServiceRpcHandler::BatchGetKeyValueAsync(
+    const BatchGetKeyValueRequest* request, BatchGetKeyValueResponse* response,
+    StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  service_->GetKeyValuesAsync(
+      {request->keys().begin(), request->keys().end()},
+      [request, response, done = std::move(done)](
+          const StatusOr<std::vector<std::string>>& status_or_values) {
+        if (status_or_values.ok()) {
+          for (int i = 0; i < request->keys_size(); ++i) {
+            KeyValueEntry* kv = response->add_kvs();
+            kv->set_key(request->keys(i));
+            kv->set_value(status_or_values.value()[i]);
+          }
+        }
+        done(status_or_values.status());
+      });
+}
+
+void CoordinationServiceRpcHandler::WatchKeyValueAsync(
+    const WatchKeyValueRequest* request, WatchKeyValueResponse* response,
+    StatusCallback done) {
+  tf_shared_lock l(mu_);
+  if (service_ == nullptr) {
+    done(MakeCoordinationError(
+        errors::Internal("Coordination service is not enabled.")));
+    return;
+  }
+  service_->WatchKeyValueAsync(
+      request->key(), request->generation(),
+      [response, done = std::move(done)](
+          const StatusOr<CoordinationServiceInterface::WatchedKeyValues>&
+              status_or_kvs) {
+        if (status_or_kvs.ok()) {
+          response->set_generation(status_or_kvs->generation);
+          *response->mutable_kvs() = {status_or_kvs->kvs.begin(),
+                                      status_or_kvs->kvs.end()};
+        }
+        done(status_or_kvs.status());
+      });
+}
+
 void CoordinationServiceRpcHandler::BarrierAsync(const BarrierRequest* request,
                                                  BarrierResponse* response,
                                                  StatusCallback done) {
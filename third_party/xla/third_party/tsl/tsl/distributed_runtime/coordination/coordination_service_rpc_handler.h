@@ -84,6 +84,18 @@ class CoordinationServiceRpcHandler {
                            tensorflow::DeleteKeyValueResponse* response,
                            StatusCallback done);
 
+  void BatchInsertKeyValueAsync(
+      const tensorflow::BatchInsertKeyValueRequest* request,
+      tensorflow::BatchInsertKeyValueResponse* response, StatusCallback done);
+
+  void BatchGetKeyValueAsync(const tensorflow::BatchGetKeyValueRequest* request,
+                             tensorflow::BatchGetKeyValueResponse* response,
+                             StatusCallback done);
+
+  void WatchKeyValueAsync(const tensorflow::WatchKeyValueRequest* request,
+                          tensorflow::WatchKeyValueResponse* response,
+                          StatusCallback done);
+
   void BarrierAsync(const tensorflow::BarrierRequest* request,
                     tensorflow::BarrierResponse* response, StatusCallback done);
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tsl/distributed_runtime/coordination/coordination_service.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -44,6 +46,7 @@ limitations under the License.
 
 namespace tsl {
 namespace {
+using ::testing::ElementsAre;
 using ::testing::EqualsProto;
 using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
@@ -644,6 +647,112 @@ TEST_F(CoordinateTwoTasksTest,
   EXPECT_THAT(result, IsEmpty());
 }
 
+TEST_F(CoordinateTwoTasksTest, GetKeyValueDir_ManyKeys_ReturnsSortedKeys) {
+  EnableCoordinationService();
+  // Enough keys to be spread over all of the store shards.
+  std::vector<std::string> keys;
+  for (int i = 99; i >= 0; --i) {
+    keys.push_back(absl::StrCat("dir/key", i));
+    TF_ASSERT_OK(coord_service_->InsertKeyValue(keys.back(), "value"));
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<KeyValueEntry> result = coord_service_->GetKeyValueDir("dir");
+
+  ASSERT_EQ(result.size(), keys.size());
+  for (int i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(result[i].key(), keys[i]);
+  }
+}
+
+TEST_F(CoordinateTwoTasksTest, InsertKeyValues_GetKeyValues) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->InsertKeyValues(
+      {CreateKv("key0", "value0"), CreateKv("/path/to/key1", "value1")}));
+
+  absl::Notification n;
+  StatusOr<std::vector<std::string>> ret;
+  coord_service_->GetKeyValuesAsync(
+      {"path/to/key1", "key2", "key0"},
+      [&](const StatusOr<std::vector<std::string>>& status_or_values) {
+        ret = status_or_values;
+        n.Notify();
+      });
+  // Waits for the key that is not inserted yet.
+  EXPECT_FALSE(n.HasBeenNotified());
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key2", "value2"));
+  n.WaitForNotification();
+
+  TF_ASSERT_OK(ret.status());
+  EXPECT_THAT(ret.value(), ElementsAre("value1", "value2", "value0"));
+}
+
+TEST_F(CoordinateTwoTasksTest, InsertKeyValues_IsAtomic) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("key1", "value1"));
+
+  EXPECT_TRUE(absl::IsAlreadyExists(coord_service_->InsertKeyValues(
+      {CreateKv("key0", "value0"), CreateKv("key1", "value1_new")})));
+  EXPECT_TRUE(absl::IsInvalidArgument(coord_service_->InsertKeyValues(
+      {CreateKv("key2", "value2"), CreateKv("/key2/", "value2_new")})));
+
+  EXPECT_TRUE(
+      absl::IsNotFound(coord_service_->TryGetKeyValue("key0").status()));
+  EXPECT_TRUE(
+      absl::IsNotFound(coord_service_->TryGetKeyValue("key2").status()));
+  EXPECT_EQ(coord_service_->TryGetKeyValue("key1").value(), "value1");
+}
+
+TEST_F(CoordinateTwoTasksTest, WatchKeyValue_ReturnsChanges) {
+  EnableCoordinationService();
+  using WatchedKeyValues = CoordinationServiceInterface::WatchedKeyValues;
+  auto watch = [&](absl::string_view key, int64_t generation) {
+    auto n = std::make_shared<absl::Notification>();
+    auto result = std::make_shared<StatusOr<WatchedKeyValues>>();
+    coord_service_->WatchKeyValueAsync(
+        std::string(key), generation,
+        [n, result](const StatusOr<WatchedKeyValues>& status_or_kvs) {
+          *result = status_or_kvs;
+          n->Notify();
+        });
+    return std::make_pair(n, result);
+  };
+
+  // Waits for the first change under the directory.
+  auto [n1, result1] = watch("dir", /*generation=*/0);
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("other_dir/key", "value"));
+  EXPECT_FALSE(n1->HasBeenNotified());
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("dir/sub_dir/key", "value0"));
+  n1->WaitForNotification();
+  TF_ASSERT_OK(result1->status());
+  EXPECT_THAT((*result1)->kvs,
+              ElementsAre(EqualsProto(CreateKv("dir/sub_dir/key", "value0"))));
+  const int64_t generation = (*result1)->generation;
+
+  // Changes made since the last watch are returned immediately.
+  TF_ASSERT_OK(coord_service_->InsertKeyValue("dir/key", "value1"));
+  auto [n2, result2] = watch("dir", generation);
+  n2->WaitForNotification();
+  TF_ASSERT_OK(result2->status());
+  EXPECT_THAT((*result2)->kvs,
+              ElementsAre(EqualsProto(CreateKv("dir/key", "value1")),
+                          EqualsProto(CreateKv("dir/sub_dir/key", "value0"))));
+
+  // Deleting a parent directory is a change of the watched key.
+  auto [n3, result3] = watch("dir/sub_dir/key", (*result2)->generation);
+  EXPECT_FALSE(n3->HasBeenNotified());
+  TF_ASSERT_OK(coord_service_->DeleteKeyValue("dir"));
+  n3->WaitForNotification();
+  TF_ASSERT_OK(result3->status());
+  EXPECT_THAT((*result3)->kvs, IsEmpty());
+
+  // Pending watches are cancelled when the service stops.
+  auto [n4, result4] = watch("dir", (*result3)->generation);
+  coord_service_.reset();
+  n4->WaitForNotification();
+  EXPECT_TRUE(absl::IsCancelled(result4->status()));
+}
+
 }  // namespace
 
 // Verify that coordination service can gather each task's device info and
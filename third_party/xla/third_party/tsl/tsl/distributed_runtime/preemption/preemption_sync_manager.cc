@@ -79,6 +79,8 @@ class PreemptionSyncManagerImpl : public PreemptionSyncManager {
   Status Initialize(CoordinationServiceAgent* agent,
                     std::unique_ptr<PreemptionNotifier> notifier) override;
   bool ReachedSyncPoint(int step_counter) override;
+  void AddSyncPointCallback(
+      std::function<void(int step_counter)> callback) override;
 
  private:
   // Determine the sync point upon receipt of preemption notice (death time).
@@ -94,6 +96,8 @@ class PreemptionSyncManagerImpl : public PreemptionSyncManager {
   int64_t preemption_sync_counter_ TF_GUARDED_BY(mu_) =
       kPreemptionSyncUnsetCounter;
   std::string current_call_counter_key_;
+  std::vector<std::function<void(int step_counter)>> sync_point_callbacks_
+      TF_GUARDED_BY(mu_);
 
   Env* env_;                         // Not owned;
   CoordinationServiceAgent* agent_;  // Not owned.
@@ -301,18 +305,32 @@ bool PreemptionSyncManagerImpl::ReachedSyncPoint(int step_counter) {
   // is ongoing , this method will be blocked until it acquires the lock. This
   // prevents updates to `call_counter_` while `preemption_sync_counter_` is
   // being computed, which ensures correctness of the preemption sync protocol.
-  mutex_lock l(mu_);
-  // Track current call.
-  call_counter_ = step_counter;
-  VLOG(3) << "Current call counter: " << call_counter_
-          << ", Preemption sync point: " << preemption_sync_counter_;
-
-  const bool reached_sync_point = preemption_sync_counter_ == call_counter_;
-  if (reached_sync_point) {
+  std::vector<std::function<void(int step_counter)>> callbacks;
+  {
+    mutex_lock l(mu_);
+    // Track current call.
+    call_counter_ = step_counter;
+    VLOG(3) << "Current call counter: " << call_counter_
+            << ", Preemption sync point: " << preemption_sync_counter_;
+
+    if (preemption_sync_counter_ != call_counter_) {
+      return false;
+    }
     // Record that this job reached the sync point.
     reached_sync_point_metric->GetCell()->Set(true);
+    callbacks = sync_point_callbacks_;
+  }
+  // The callbacks may be slow, so they run without holding `mu_`.
+  for (const auto& callback : callbacks) {
+    callback(step_counter);
   }
-  return reached_sync_point;
+  return true;
+}
+
+void PreemptionSyncManagerImpl::AddSyncPointCallback(
+    std::function<void(int step_counter)> callback) {
+  mutex_lock l(mu_);
+  sync_point_callbacks_.push_back(std::move(callback));
 }
 }  // namespace
 std::unique_ptr<PreemptionSyncManager> CreatePreemptionSyncManager() {
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_PREEMPTION_PREEMPTION_SYNC_MANAGER_H_
 #define TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_PREEMPTION_PREEMPTION_SYNC_MANAGER_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -56,6 +57,13 @@ class PreemptionSyncManager {
   // step to pause training and handle the preemption (e.g. save checkpoint and
   // exit, or wait for preempted task to restart, then resume training).
   virtual bool ReachedSyncPoint(int step_counter) = 0;
+
+  // Adds a callback which `ReachedSyncPoint()` calls with the step counter
+  // when the sync point is reached, before it returns, e.g. to save an
+  // emergency checkpoint. The callbacks are called in the order they were
+  // added, on the thread calling `ReachedSyncPoint()`.
+  virtual void AddSyncPointCallback(
+      std::function<void(int step_counter)> callback) = 0;
 };
 
 std::unique_ptr<PreemptionSyncManager> CreatePreemptionSyncManager();
@@ -17,6 +17,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "grpcpp/server.h"
 #include "grpcpp/server_builder.h"
@@ -211,6 +212,21 @@ TEST_F(PreemptionSyncManagerTest, Preemption_SingleSyncPoint) {
   EXPECT_FALSE(preempt_sync_mgr_->ReachedSyncPoint(step_counter++));
 }
 
+TEST_F(PreemptionSyncManagerTest, Preemption_CallsSyncPointCallbacks) {
+  std::vector<int> callback_steps;
+  preempt_sync_mgr_->AddSyncPointCallback(
+      [&callback_steps](int step_counter) {
+        callback_steps.push_back(step_counter);
+      });
+  int step_counter = 0;
+  EXPECT_FALSE(preempt_sync_mgr_->ReachedSyncPoint(step_counter++));
+  SendPreemptionNotice();
+
+  EXPECT_TRUE(preempt_sync_mgr_->ReachedSyncPoint(step_counter++));
+  EXPECT_FALSE(preempt_sync_mgr_->ReachedSyncPoint(step_counter++));
+  EXPECT_EQ(callback_steps, std::vector<int>({1}));
+}
+
 TEST_F(PreemptionSyncManagerTest, DelayedPreemption_NoSyncPointYet) {
   int step_counter = 0;
   // Simulate task doing work and making progress.
@@ -37,6 +37,10 @@ namespace tsl {
 namespace {
 using tensorflow::BarrierRequest;
 using tensorflow::BarrierResponse;
+using tensorflow::BatchGetKeyValueRequest;
+using tensorflow::BatchGetKeyValueResponse;
+using tensorflow::BatchInsertKeyValueRequest;
+using tensorflow::BatchInsertKeyValueResponse;
 using tensorflow::CancelBarrierRequest;
 using tensorflow::CancelBarrierResponse;
 using tensorflow::DeleteKeyValueRequest;
@@ -65,6 +69,8 @@ using tensorflow::TryGetKeyValueRequest;
 using tensorflow::TryGetKeyValueResponse;
 using tensorflow::WaitForAllTasksRequest;
 using tensorflow::WaitForAllTasksResponse;
+using tensorflow::WatchKeyValueRequest;
+using tensorflow::WatchKeyValueResponse;
 
 class GrpcCoordinationClientThread {
  public:
@@ -244,6 +250,38 @@ class GrpcCoordinationClient : public CoordinationClient {
         &target_);
   }
 
+  void BatchInsertKeyValueAsync(const BatchInsertKeyValueRequest* request,
+                                BatchInsertKeyValueResponse* response,
+                                StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/BatchInsertKeyValue",
+        *request, response, std::move(done), /*call_opts=*/nullptr,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
+  void BatchGetKeyValueAsync(CallOptions* call_opts,
+                             const BatchGetKeyValueRequest* request,
+                             BatchGetKeyValueResponse* response,
+                             StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/BatchGetKeyValue",
+        *request, response, std::move(done), call_opts,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
+  void WatchKeyValueAsync(CallOptions* call_opts,
+                          const WatchKeyValueRequest* request,
+                          WatchKeyValueResponse* response,
+                          StatusCallback done) override {
+    new RPCState<protobuf::Message>(
+        &stub_, cq_, "/tensorflow.CoordinationService/WatchKeyValue", *request,
+        response, std::move(done), call_opts,
+        /*threadpool=*/nullptr, /*max_retries=*/0, /*fail_fast=*/true,
+        &target_);
+  }
+
   void BarrierAsync(const BarrierRequest* request, BarrierResponse* response,
                     StatusCallback done) override {
     new RPCState<protobuf::Message>(
@@ -55,6 +55,9 @@ void GrpcCoordinationServiceImpl::HandleRPCsLoop() {
   ENQUEUE_REQUEST(TryGetKeyValue);
   ENQUEUE_REQUEST(GetKeyValueDir);
   ENQUEUE_REQUEST(DeleteKeyValue);
+  ENQUEUE_REQUEST(BatchInsertKeyValue);
+  ENQUEUE_REQUEST(BatchGetKeyValue);
+  ENQUEUE_REQUEST(WatchKeyValue);
   ENQUEUE_REQUEST(Barrier);
   ENQUEUE_REQUEST(CancelBarrier);
 #undef ENQUEUE_REQUEST
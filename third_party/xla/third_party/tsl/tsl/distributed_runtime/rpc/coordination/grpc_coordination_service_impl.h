@@ -94,6 +94,9 @@ class GrpcCoordinationServiceImpl : public AsyncServiceInterface {
   HANDLER(TryGetKeyValue);
   HANDLER(GetKeyValueDir);
   HANDLER(DeleteKeyValue);
+  HANDLER(BatchInsertKeyValue);
+  HANDLER(BatchGetKeyValue);
+  HANDLER(WatchKeyValue);
   HANDLER(Barrier);
   HANDLER(CancelBarrier);
 #undef HANDLER
@@ -61,6 +61,13 @@ struct AllocationAttributes {
   // a memory chunk whose freed_at_count is at this value or earlier may be
   // returned.
   std::function<uint64()>* freed_by_func = nullptr;  // Not owned.
+  // EXPERIMENTAL: If provided together with freed_by_func, then a memory chunk
+  // freed after that count may still be returned rather than failing the
+  // allocation, and *reused_pending_memory tells whether that happened. The
+  // caller must then order its use of the memory after the pending uses on the
+  // compute stream, e.g. by making its stream wait on the compute stream,
+  // instead of waiting for the host to observe their completion.
+  bool* reused_pending_memory = nullptr;  // Not owned.
 
   AllocationAttributes(const AllocationAttributes&) = delete;
   void operator=(const AllocationAttributes&) = delete;
@@ -407,6 +414,16 @@ class SubAllocator {
   // returned by this allocator.
   virtual bool SupportsCoalescing() const = 0;
 
+  // Returns the size of the pages that ReleasePages can give back, or 0 if
+  // this allocator cannot release part of an allocation.
+  virtual size_t ReleasablePageSize() const { return 0; }
+
+  // Gives back the memory backing [ptr, ptr + num_bytes), a range of whole
+  // pages within memory returned by Alloc, which must not be accessed anymore.
+  // The addresses stay reserved until the surrounding memory is freed with
+  // Free. Returns false if the memory could not be released.
+  virtual bool ReleasePages(void* ptr, size_t num_bytes) { return false; }
+
   // Returns the type of the memory allocated by this SubAllocator.
   virtual AllocatorMemoryType GetMemoryType() const {
     return AllocatorMemoryType::kUnknown;
@@ -39,6 +39,10 @@ namespace tsl {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+namespace {
+std::atomic<int64_t> next_thread_local_cache_id{0};
+}  // namespace
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -46,8 +50,15 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       coalesce_regions_(sub_allocator->SupportsCoalescing()),
       sub_allocator_(std::move(sub_allocator)),
       name_(name),
+      thread_local_cache_id_(next_thread_local_cache_id.fetch_add(1)),
+      num_thread_local_cache_size_classes_(
+          RoundedBytes(opts.thread_local_cache_max_chunk_bytes) /
+          kMinAllocationSize),
       free_chunks_list_(kInvalidChunkHandle),
       next_allocation_id_(1) {
+  if (opts.thread_local_cache_max_chunk_bytes > 0) {
+    cached_chunk_shards_.reset(new CachedChunkShard[kNumCachedChunkShards]);
+  }
   if (opts.allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -87,6 +98,13 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
 }
 
 BFCAllocator::~BFCAllocator() {
+  // Detach the thread-local caches; their chunks go away with the regions.
+  for (const auto& cache : ThreadLocalCaches()) {
+    mutex_lock l(cache->mu);
+    cache->allocator = nullptr;
+    cache->free_lists.clear();
+  }
+
   // Return memory back.
   VLOG(2) << "Number of regions allocated: "
           << region_manager_.regions().size();
@@ -242,8 +260,9 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   if (allocation_attr.freed_by_func != nullptr) {
     freed_by_count = (*allocation_attr.freed_by_func)();
   }
-  void* r =
-      AllocateRawInternal(unused_alignment, num_bytes, false, freed_by_count);
+  void* r = AllocateRawInternal(unused_alignment, num_bytes, false,
+                                freed_by_count,
+                                allocation_attr.reused_pending_memory);
   if (r != nullptr) {
     return r;
   } else {
@@ -254,7 +273,8 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
           if (allocation_attr.freed_by_func != nullptr) {
             freed_by_count = (*allocation_attr.freed_by_func)();
           }
-          return AllocateRawInternal(a, nb, v, freed_by_count);
+          return AllocateRawInternal(a, nb, v, freed_by_count,
+                                     allocation_attr.reused_pending_memory);
         },
         kMaxMillisToWait, unused_alignment, num_bytes);
     return r;
@@ -264,7 +284,20 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
-  void* result = [&] {
+  const bool use_thread_local_cache =
+      UseThreadLocalCache(num_bytes, allocation_attr);
+  if (use_thread_local_cache) {
+    void* result = AllocateFromThreadLocalCache(num_bytes);
+    if (result != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result
+              << " from thread-local cache";
+      return result;
+    }
+    // Allocate the whole size class, so that the chunk can serve any request
+    // of its class once it is cached.
+    num_bytes = RoundedBytes(num_bytes);
+  }
+  auto allocate = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
       // "important" alloc, we want to print a log, because the program may be
@@ -288,7 +321,8 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
         freed_by_count = (*allocation_attr.freed_by_func)();
       }
       void* res = AllocateRawInternal(unused_alignment, num_bytes,
-                                      dump_log_on_failure, freed_by_count);
+                                      dump_log_on_failure, freed_by_count,
+                                      allocation_attr.reused_pending_memory);
       if (res == nullptr) {
         int32 counter_value = log_counter.load(std::memory_order_relaxed);
         if (counter_value < kMaxFailureLogs) {
@@ -309,7 +343,17 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
       return AllocateRawInternalWithRetry(unused_alignment, num_bytes,
                                           allocation_attr);
     }
-  }();
+  };
+  void* result = allocate();
+  if (result == nullptr && opts_.thread_local_cache_max_chunk_bytes > 0) {
+    // Memory held by thread-local caches may be enough to satisfy the request
+    // once it is coalesced.
+    FlushThreadLocalCaches();
+    result = allocate();
+  }
+  if (use_thread_local_cache && result != nullptr) {
+    AddCachedChunk(result, num_bytes);
+  }
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
   VLOG(4) << "[mem-debug] AllocateRaw," << Name() << "," << num_bytes << ","
           << result << "," << tsl::CurrentStackTrace();
@@ -419,7 +463,11 @@ void BFCAllocator::DeallocateRegions(
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
-                                        uint64 freed_before) {
+                                        uint64 freed_before,
+                                        bool* reused_pending_memory) {
+  if (reused_pending_memory != nullptr) {
+    *reused_pending_memory = false;
+  }
   if (num_bytes == 0) {
     VLOG(2) << "tried to allocate 0 bytes";
     return nullptr;
@@ -466,6 +514,23 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  if ((freed_before > 0) && (reused_pending_memory != nullptr)) {
+    // The caller can wait for the pending uses of a chunk on the device, so
+    // rather than fail, hand out a chunk freed after the requested count.
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, 0);
+    if (ptr == nullptr && !timestamped_chunks_.empty() &&
+        MergeTimestampedChunks(rounded_bytes)) {
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, 0);
+    }
+    if (ptr != nullptr) {
+      *reused_pending_memory =
+          ChunkFromHandle(region_manager_.get_handle(ptr))->freed_at_count >
+          freed_before;
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
@@ -603,12 +668,18 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // Update stats.
         ++stats_.num_allocs;
         stats_.bytes_in_use += chunk->size;
-        if (stats_.bytes_in_use > stats_.peak_bytes_in_use) {
-          VLOG(2) << "New Peak memory usage of " << stats_.bytes_in_use
+        core_bytes_in_use_.store(stats_.bytes_in_use,
+                                 std::memory_order_relaxed);
+        // Chunks held by thread-local caches are free for the clients.
+        const int64_t bytes_in_use =
+            stats_.bytes_in_use -
+            thread_local_cache_bytes_.load(std::memory_order_relaxed);
+        if (bytes_in_use > stats_.peak_bytes_in_use) {
+          VLOG(2) << "New Peak memory usage of " << bytes_in_use
                   << " bytes for " << Name();
         }
         stats_.peak_bytes_in_use =
-            std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+            std::max(stats_.peak_bytes_in_use, bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
 
@@ -689,6 +760,10 @@ void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(4) << "[mem-debug] DeallocateRaw," << Name() << ","
           << (ptr ? RequestedSize(ptr) : 0) << "," << ptr << ","
           << tsl::CurrentStackTrace();
+  if (ptr != nullptr && opts_.thread_local_cache_max_chunk_bytes > 0 &&
+      DeallocateToThreadLocalCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -811,6 +886,7 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  core_bytes_in_use_.store(stats_.bytes_in_use, std::memory_order_relaxed);
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
@@ -1211,18 +1287,292 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 }
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
+  if (opts_.thread_local_cache_max_chunk_bytes == 0) {
+    mutex_lock l(lock_);
+    return stats_;
+  }
+  // The cache locks must not be taken while holding lock_.
+  const int64_t cache_num_allocs = ThreadLocalCacheNumAllocs();
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.num_allocs += cache_num_allocs;
+  stats.bytes_in_use -=
+      thread_local_cache_bytes_.load(std::memory_order_relaxed);
+  stats.peak_bytes_in_use = std::max(
+      stats.peak_bytes_in_use,
+      thread_local_cache_peak_bytes_in_use_.load(std::memory_order_relaxed));
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
+  if (opts_.thread_local_cache_max_chunk_bytes > 0) {
+    for (const auto& cache : ThreadLocalCaches()) {
+      mutex_lock l(cache->mu);
+      cache->num_allocs = 0;
+    }
+    mutex_lock l(thread_local_caches_mu_);
+    exited_thread_local_cache_num_allocs_ = 0;
+  }
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
-  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.peak_bytes_in_use =
+      stats_.bytes_in_use -
+      thread_local_cache_bytes_.load(std::memory_order_relaxed);
+  thread_local_cache_peak_bytes_in_use_.store(stats_.peak_bytes_in_use,
+                                              std::memory_order_relaxed);
   stats_.largest_alloc_size = 0;
   return true;
 }
 
+bool BFCAllocator::UseThreadLocalCache(
+    size_t num_bytes, const AllocationAttributes& allocation_attr) const {
+  return num_bytes > 0 &&
+         num_bytes <= opts_.thread_local_cache_max_chunk_bytes &&
+         allocation_attr.freed_by_func == nullptr &&
+         timing_counter_ == nullptr;
+}
+
+BFCAllocator::ThreadLocalCache* BFCAllocator::GetThreadLocalCache() {
+  // The caches of the calling thread, keyed by allocator id. They are returned
+  // to their allocators when the thread exits.
+  struct ThreadCaches {
+    ~ThreadCaches() {
+      for (auto& it : caches) {
+        ReleaseThreadLocalCache(it.second.get());
+      }
+    }
+    absl::flat_hash_map<int64_t, std::shared_ptr<ThreadLocalCache>> caches;
+  };
+  static thread_local ThreadCaches thread_caches;
+
+  auto it = thread_caches.caches.find(thread_local_cache_id_);
+  if (it != thread_caches.caches.end()) {
+    return it->second.get();
+  }
+  // Drop the caches of destroyed allocators before adding a new one.
+  for (auto dead = thread_caches.caches.begin();
+       dead != thread_caches.caches.end();) {
+    bool detached;
+    {
+      mutex_lock l(dead->second->mu);
+      detached = dead->second->allocator == nullptr;
+    }
+    if (detached) {
+      thread_caches.caches.erase(dead++);
+    } else {
+      ++dead;
+    }
+  }
+  auto cache = std::make_shared<ThreadLocalCache>(
+      this, num_thread_local_cache_size_classes_);
+  {
+    mutex_lock l(thread_local_caches_mu_);
+    thread_local_caches_.push_back(cache);
+  }
+  thread_caches.caches[thread_local_cache_id_] = cache;
+  return cache.get();
+}
+
+void* BFCAllocator::AllocateFromThreadLocalCache(size_t num_bytes) {
+  const int size_class = RoundedBytes(num_bytes) / kMinAllocationSize - 1;
+  ThreadLocalCache* cache = GetThreadLocalCache();
+  mutex_lock l(cache->mu);
+  auto& free_list = cache->free_lists[size_class];
+  if (free_list.empty()) {
+    return nullptr;
+  }
+  const auto [ptr, chunk_bytes] = free_list.back();
+  free_list.pop_back();
+  cache->cached_bytes -= chunk_bytes;
+  ++cache->num_allocs;
+  const int64_t cached_bytes =
+      thread_local_cache_bytes_.fetch_sub(chunk_bytes,
+                                          std::memory_order_relaxed) -
+      chunk_bytes;
+  UpdateThreadLocalCachePeak(
+      core_bytes_in_use_.load(std::memory_order_relaxed) - cached_bytes);
+  if (++cache->num_ops >= opts_.thread_local_cache_flush_interval) {
+    FlushThreadLocalCacheLocked(cache);
+  }
+  return ptr;
+}
+
+void BFCAllocator::AddCachedChunk(void* ptr, size_t rounded_bytes) {
+  CachedChunkInfo info;
+  info.size_class = rounded_bytes / kMinAllocationSize - 1;
+  info.chunk_bytes = AllocatedSize(ptr);
+  CachedChunkShard& shard = CachedChunkShardFor(ptr);
+  mutex_lock l(shard.mu);
+  shard.chunks.emplace(ptr, info);
+}
+
+bool BFCAllocator::DeallocateToThreadLocalCache(void* ptr) {
+  CachedChunkShard& shard = CachedChunkShardFor(ptr);
+  CachedChunkInfo info;
+  {
+    mutex_lock l(shard.mu);
+    auto it = shard.chunks.find(ptr);
+    if (it == shard.chunks.end()) {
+      return false;
+    }
+    info = it->second;
+    if (timing_counter_ != nullptr) {
+      // The freed_at_count of the chunk has to be recorded by the core.
+      shard.chunks.erase(it);
+      return false;
+    }
+  }
+  ThreadLocalCache* cache = GetThreadLocalCache();
+  mutex_lock l(cache->mu);
+  if (cache->cached_bytes + info.chunk_bytes >
+      opts_.thread_local_cache_bytes_per_thread) {
+    mutex_lock shard_lock(shard.mu);
+    shard.chunks.erase(ptr);
+    return false;
+  }
+  cache->free_lists[info.size_class].emplace_back(ptr, info.chunk_bytes);
+  cache->cached_bytes += info.chunk_bytes;
+  thread_local_cache_bytes_.fetch_add(info.chunk_bytes,
+                                      std::memory_order_relaxed);
+  if (++cache->num_ops >= opts_.thread_local_cache_flush_interval) {
+    FlushThreadLocalCacheLocked(cache);
+  }
+  return true;
+}
+
+void BFCAllocator::FlushThreadLocalCacheLocked(ThreadLocalCache* cache) {
+  cache->num_ops = 0;
+  if (cache->cached_bytes == 0) {
+    return;
+  }
+  for (auto& free_list : cache->free_lists) {
+    for (const auto& [ptr, chunk_bytes] : free_list) {
+      {
+        CachedChunkShard& shard = CachedChunkShardFor(ptr);
+        mutex_lock l(shard.mu);
+        shard.chunks.erase(ptr);
+      }
+      DeallocateRawInternal(ptr);
+      // Only subtract the cached bytes once the core no longer counts the
+      // chunk as in use, so that bytes_in_use never overshoots.
+      thread_local_cache_bytes_.fetch_sub(chunk_bytes,
+                                          std::memory_order_relaxed);
+    }
+    free_list.clear();
+  }
+  cache->cached_bytes = 0;
+  retry_helper_.NotifyDealloc();
+}
+
+size_t BFCAllocator::Defragment() {
+  const size_t page_size = sub_allocator_->ReleasablePageSize();
+  if (page_size == 0) {
+    return 0;
+  }
+  FlushThreadLocalCaches();
+
+  mutex_lock l(lock_);
+  std::vector<ChunkHandle> free_chunks;
+  for (BinNum b = 0; b < kNumBins; b++) {
+    const Bin::FreeChunkSet& bin_chunks = BinFromIndex(b)->free_chunks;
+    free_chunks.insert(free_chunks.end(), bin_chunks.begin(), bin_chunks.end());
+  }
+  size_t released_bytes = 0;
+  for (ChunkHandle h : free_chunks) {
+    const Chunk* c = ChunkFromHandle(h);
+    if (c->freed_at_count > 0) {
+      // The chunk may still be used by pending work.
+      continue;
+    }
+    const std::uintptr_t chunk_begin = reinterpret_cast<std::uintptr_t>(c->ptr);
+    const std::uintptr_t begin =
+        (chunk_begin + page_size - 1) / page_size * page_size;
+    const std::uintptr_t end = (chunk_begin + c->size) / page_size * page_size;
+    if (end <= begin ||
+        !sub_allocator_->ReleasePages(reinterpret_cast<void*>(begin),
+                                      end - begin)) {
+      continue;
+    }
+
+    // Split the released pages out of the chunk, leaving the unaligned ends
+    // free.
+    RemoveFreeChunkFromBin(h);
+    if (begin > chunk_begin) {
+      SplitChunk(h, begin - chunk_begin);
+      InsertFreeChunkIntoBin(h);
+      h = ChunkFromHandle(h)->next;
+      RemoveFreeChunkFromBin(h);
+    }
+    if (ChunkFromHandle(h)->size > end - begin) {
+      SplitChunk(h, end - begin);
+    }
+    Chunk* released = ChunkFromHandle(h);
+    released->allocation_id = kReleasedAllocationId;
+    released_bytes += released->size;
+  }
+
+  if (released_bytes > 0) {
+    *stats_.pool_bytes -= released_bytes;
+    VLOG(1) << "Released " << strings::HumanReadableNumBytes(released_bytes)
+            << " of free memory for " << Name() << ".";
+  }
+  return released_bytes;
+}
+
+void BFCAllocator::FlushThreadLocalCaches() {
+  for (const auto& cache : ThreadLocalCaches()) {
+    mutex_lock l(cache->mu);
+    if (cache->allocator == this) {
+      FlushThreadLocalCacheLocked(cache.get());
+    }
+  }
+}
+
+// static
+void BFCAllocator::ReleaseThreadLocalCache(ThreadLocalCache* cache) {
+  mutex_lock l(cache->mu);
+  BFCAllocator* allocator = cache->allocator;
+  if (allocator == nullptr) {
+    return;
+  }
+  allocator->FlushThreadLocalCacheLocked(cache);
+  cache->allocator = nullptr;
+  mutex_lock caches_lock(allocator->thread_local_caches_mu_);
+  allocator->exited_thread_local_cache_num_allocs_ += cache->num_allocs;
+  cache->num_allocs = 0;
+  auto& caches = allocator->thread_local_caches_;
+  auto it = std::find_if(caches.begin(), caches.end(),
+                         [cache](const auto& c) { return c.get() == cache; });
+  if (it != caches.end()) {
+    caches.erase(it);
+  }
+}
+
+std::vector<std::shared_ptr<BFCAllocator::ThreadLocalCache>>
+BFCAllocator::ThreadLocalCaches() {
+  mutex_lock l(thread_local_caches_mu_);
+  return thread_local_caches_;
+}
+
+int64_t BFCAllocator::ThreadLocalCacheNumAllocs() {
+  int64_t num_allocs = 0;
+  for (const auto& cache : ThreadLocalCaches()) {
+    mutex_lock l(cache->mu);
+    num_allocs += cache->num_allocs;
+  }
+  mutex_lock l(thread_local_caches_mu_);
+  return num_allocs + exited_thread_local_cache_num_allocs_;
+}
+
+void BFCAllocator::UpdateThreadLocalCachePeak(int64_t bytes_in_use) {
+  int64_t peak =
+      thread_local_cache_peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak &&
+         !thread_local_cache_peak_bytes_in_use_.compare_exchange_weak(
+             peak, bytes_in_use, std::memory_order_relaxed)) {
+  }
+}
+
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
 BFCAllocator::get_bin_debug_info() {
   std::array<BinDebugInfo, kNumBins> bin_infos;
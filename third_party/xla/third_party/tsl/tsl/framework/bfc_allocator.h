@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
@@ -68,6 +70,24 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, chunks of at most this many (rounded) bytes that are freed
+    // by a thread are kept in a cache private to that thread, and later
+    // allocations of the same size by that thread are served from the cache
+    // without taking the allocator lock. Chunks served by the cache report
+    // their rounded size as RequestedSize() and keep their AllocationId()
+    // across reuses. The cache is bypassed by allocations with a
+    // freed_by_func and while a timing counter is set.
+    size_t thread_local_cache_max_chunk_bytes = 0;
+
+    // The maximum number of bytes held by the cache of one thread. Chunks
+    // freed into a full cache are returned to the allocator.
+    size_t thread_local_cache_bytes_per_thread = 4 << 20;
+
+    // A thread returns all of its cached chunks to the allocator after this
+    // many operations on its cache, so that memory of size classes it no
+    // longer uses is not stranded.
+    int64_t thread_local_cache_flush_interval = 1 << 14;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -107,12 +127,27 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Returns the chunks held by the thread-local caches of all threads to the
+  // allocator. Allocations that fail also flush the caches before giving up.
+  void FlushThreadLocalCaches();
+
+  // Gives the whole pages inside the free chunks back to the sub-allocator, if
+  // it supports ReleasePages, so that their memory can back new regions
+  // instead of being stranded between live chunks. The released ranges are set
+  // aside and never handed out again. Returns the number of bytes released.
+  //
+  // Must only be called at a safe point, e.g. a step barrier with the device
+  // synchronized, where no pending work may still access the free chunks.
+  size_t Defragment();
+
  private:
   struct Bin;
+  struct ThreadLocalCache;
 
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
                             bool dump_log_on_failure,
-                            uint64 freed_before_count);
+                            uint64 freed_before_count,
+                            bool* reused_pending_memory);
 
   void* AllocateRawInternalWithRetry(
       size_t alignment, size_t num_bytes,
@@ -157,6 +192,8 @@ class BFCAllocator : public Allocator {
   typedef size_t ChunkHandle;
   static constexpr ChunkHandle kInvalidChunkHandle = SIZE_MAX;
 
+  static constexpr int64_t kReleasedAllocationId = -2;
+
   typedef int BinNum;
   static constexpr int kInvalidBinNum = -1;
   // The following means that the largest bin'd chunk size is 256 << 21 = 512MB.
@@ -188,7 +225,8 @@ class BFCAllocator : public Allocator {
     // allocation_id is set to -1 when the chunk is not in use. It is assigned a
     // value greater than zero before the chunk is returned from
     // AllocateRaw, and this value is unique among values assigned by
-    // the parent allocator.
+    // the parent allocator. kReleasedAllocationId marks a range whose memory
+    // was given back to the sub-allocator by Defragment().
     int64_t allocation_id = -1;
     void* ptr = nullptr;  // pointer to granted subbuffer.
 
@@ -518,6 +556,86 @@ class BFCAllocator : public Allocator {
   // size over total free memory, and returns a value within [0, 1].
   double GetFragmentation() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // The front end enabled by Options::thread_local_cache_max_chunk_bytes.
+  //
+  // A chunk handed out by the front end stays in use from the point of view of
+  // the allocator while it sits in a thread-local cache; the bytes of cached
+  // chunks are subtracted from the reported bytes_in_use.
+  struct ThreadLocalCache {
+    ThreadLocalCache(BFCAllocator* a, int num_size_classes)
+        : allocator(a), free_lists(num_size_classes) {}
+
+    // Locked by the owning thread on each operation, and by other threads only
+    // to flush the cache, so it is essentially uncontended.
+    mutex mu;
+    // The allocator owning the cached chunks, or nullptr once either the
+    // allocator or the owning thread is gone.
+    BFCAllocator* allocator TF_GUARDED_BY(mu);
+    // The cached chunks of each size class as (ptr, chunk size) pairs.
+    std::vector<std::vector<std::pair<void*, size_t>>> free_lists
+        TF_GUARDED_BY(mu);
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+    int64_t num_ops TF_GUARDED_BY(mu) = 0;
+    // The allocations served by this cache since the last ClearStats().
+    int64_t num_allocs TF_GUARDED_BY(mu) = 0;
+  };
+
+  // A chunk owned by the thread-local cache front end, either in use by a
+  // client or held by a cache.
+  struct CachedChunkInfo {
+    int size_class;
+    size_t chunk_bytes;
+  };
+
+  // Maps the chunks owned by the front end to their size class. It is sharded
+  // by address so that threads freeing different chunks rarely contend.
+  struct alignas(64) CachedChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, CachedChunkInfo> chunks TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumCachedChunkShards = 64;
+
+  bool UseThreadLocalCache(size_t num_bytes,
+                           const AllocationAttributes& allocation_attr) const;
+
+  // Returns the cache of the calling thread, creating it if needed.
+  ThreadLocalCache* GetThreadLocalCache();
+
+  // Pops a cached chunk for a request of 'num_bytes' bytes, or returns nullptr
+  // if the cache of the calling thread has none.
+  void* AllocateFromThreadLocalCache(size_t num_bytes);
+
+  // Records that the chunk at 'ptr', allocated from the core allocator for a
+  // request of 'rounded_bytes' bytes, is owned by the front end.
+  void AddCachedChunk(void* ptr, size_t rounded_bytes);
+
+  // Pushes the chunk at 'ptr' into the cache of the calling thread. Returns
+  // false if 'ptr' has to be freed by the core allocator instead.
+  bool DeallocateToThreadLocalCache(void* ptr);
+
+  // Returns all chunks of 'cache' to the core allocator.
+  void FlushThreadLocalCacheLocked(ThreadLocalCache* cache)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(cache->mu);
+
+  // Called when the thread owning 'cache' exits.
+  static void ReleaseThreadLocalCache(ThreadLocalCache* cache);
+
+  CachedChunkShard& CachedChunkShardFor(const void* ptr) {
+    return cached_chunk_shards_[(reinterpret_cast<std::uintptr_t>(ptr) >>
+                                 kMinAllocationBits) %
+                                kNumCachedChunkShards];
+  }
+
+  // Returns the thread-local caches registered with this allocator.
+  std::vector<std::shared_ptr<ThreadLocalCache>> ThreadLocalCaches();
+
+  // Returns the number of allocations served by the thread-local caches since
+  // the last ClearStats().
+  int64_t ThreadLocalCacheNumAllocs();
+
+  // Raises the peak reported by GetStats() to at least 'bytes_in_use'.
+  void UpdateThreadLocalCachePeak(int64_t bytes_in_use);
+
   // Information about a Bin that is useful for debugging.
   struct BinDebugInfo {
     size_t total_bytes_in_use = 0;
@@ -597,6 +715,25 @@ class BFCAllocator : public Allocator {
 
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // Distinguishes this allocator in the thread-local cache maps, since the
+  // address of a destroyed allocator may be reused.
+  const int64_t thread_local_cache_id_;
+  const int num_thread_local_cache_size_classes_;
+  std::unique_ptr<CachedChunkShard[]> cached_chunk_shards_;
+  mutex thread_local_caches_mu_;
+  std::vector<std::shared_ptr<ThreadLocalCache>> thread_local_caches_
+      TF_GUARDED_BY(thread_local_caches_mu_);
+  // Allocations served by the caches of threads that have exited.
+  int64_t exited_thread_local_cache_num_allocs_
+      TF_GUARDED_BY(thread_local_caches_mu_) = 0;
+  // The bytes of the chunks held by all thread-local caches.
+  std::atomic<int64_t> thread_local_cache_bytes_{0};
+  // Mirrors stats_.bytes_in_use, so that cache hits can update the peak
+  // without taking lock_.
+  std::atomic<int64_t> core_bytes_in_use_{0};
+  // The peak bytes in use observed by cache hits.
+  std::atomic<int64_t> thread_local_cache_peak_bytes_in_use_{0};
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
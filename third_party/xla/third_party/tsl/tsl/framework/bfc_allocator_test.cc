@@ -0,0 +1,332 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/framework/bfc_allocator.h"
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/framework/shared_counter.h"
+#include "tsl/platform/blocking_counter.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mem.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace {
+
+class HostSubAllocator : public SubAllocator {
+ public:
+  HostSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, Allocator::kAllocatorAlignment);
+  }
+
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+
+  bool SupportsCoalescing() const override { return false; }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+};
+
+// Hands out page-aligned memory whose pages can be released.
+class PagedSubAllocator : public HostSubAllocator {
+ public:
+  static constexpr size_t kPageSize = 4096;
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, kPageSize);
+  }
+
+  size_t ReleasablePageSize() const override { return kPageSize; }
+
+  bool ReleasePages(void* ptr, size_t num_bytes) override {
+    released_bytes_ += num_bytes;
+    return true;
+  }
+
+  size_t released_bytes() const { return released_bytes_; }
+
+ private:
+  size_t released_bytes_ = 0;
+};
+
+std::unique_ptr<BFCAllocator> NewAllocator(size_t memory_limit,
+                                           const BFCAllocator::Options& opts) {
+  return std::make_unique<BFCAllocator>(std::make_unique<HostSubAllocator>(),
+                                        memory_limit, "host_bfc", opts);
+}
+
+BFCAllocator::Options ThreadLocalCacheOptions() {
+  BFCAllocator::Options opts;
+  opts.thread_local_cache_max_chunk_bytes = 64 << 10;
+  opts.thread_local_cache_bytes_per_thread = 1 << 20;
+  return opts;
+}
+
+void CheckStats(Allocator* a, int64_t num_allocs, int64_t bytes_in_use,
+                int64_t peak_bytes_in_use) {
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, num_allocs);
+  EXPECT_EQ(stats->bytes_in_use, bytes_in_use);
+  EXPECT_EQ(stats->peak_bytes_in_use, peak_bytes_in_use);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheReusesChunks) {
+  auto a = NewAllocator(1 << 30, ThreadLocalCacheOptions());
+  void* p1 = a->AllocateRaw(1, 1000);
+  ASSERT_NE(p1, nullptr);
+  EXPECT_EQ(a->RequestedSize(p1), 1024);
+  CheckStats(a.get(), 1, 1024, 1024);
+
+  a->DeallocateRaw(p1);
+  CheckStats(a.get(), 1, 0, 1024);
+
+  // Any request of the same size class is served by the cached chunk.
+  void* p2 = a->AllocateRaw(1, 800);
+  EXPECT_EQ(p1, p2);
+  CheckStats(a.get(), 2, 1024, 1024);
+
+  void* p3 = a->AllocateRaw(1, 800);
+  EXPECT_NE(p2, p3);
+  CheckStats(a.get(), 3, 2048, 2048);
+
+  a->DeallocateRaw(p2);
+  a->DeallocateRaw(p3);
+  CheckStats(a.get(), 3, 0, 2048);
+
+  EXPECT_TRUE(a->ClearStats());
+  CheckStats(a.get(), 0, 0, 0);
+  a->FlushThreadLocalCaches();
+  CheckStats(a.get(), 0, 0, 0);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheIsBounded) {
+  BFCAllocator::Options opts = ThreadLocalCacheOptions();
+  opts.thread_local_cache_bytes_per_thread = 4096;
+  auto a = NewAllocator(1 << 30, opts);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    ptrs.push_back(a->AllocateRaw(1, 1024));
+  }
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  CheckStats(a.get(), 8, 0, 8192);
+
+  // Only the first four chunks fit in the cache, the next four allocations
+  // are served by the allocator.
+  std::vector<void*> reused;
+  for (int i = 0; i < 8; ++i) {
+    reused.push_back(a->AllocateRaw(1, 1024));
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(reused[i], ptrs[3 - i]);
+  }
+  CheckStats(a.get(), 16, 8192, 8192);
+  for (void* p : reused) {
+    a->DeallocateRaw(p);
+  }
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheFlushesPeriodically) {
+  BFCAllocator::Options opts = ThreadLocalCacheOptions();
+  opts.thread_local_cache_flush_interval = 2;
+  auto a = NewAllocator(1 << 30, opts);
+  void* p1 = a->AllocateRaw(1, 1024);
+  a->DeallocateRaw(p1);  // First cache operation.
+  void* p2 = a->AllocateRaw(1, 1024);  // Second operation, flushes.
+  EXPECT_EQ(p1, p2);
+  void* p3 = a->AllocateRaw(1, 2048);
+  a->DeallocateRaw(p3);  // First cache operation.
+  a->DeallocateRaw(p2);  // Second operation, returns p2 and p3.
+  CheckStats(a.get(), 3, 0, 3072);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheFlushedBeforeOutOfMemory) {
+  BFCAllocator::Options opts = ThreadLocalCacheOptions();
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  auto a = NewAllocator(1 << 20, opts);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    ptrs.push_back(a->AllocateRaw(1, 64 << 10));
+  }
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  // Needs the 512KiB held by the cache.
+  void* p = a->AllocateRaw(1, 768 << 10);
+  EXPECT_NE(p, nullptr);
+  CheckStats(a.get(), 9, 768 << 10, 768 << 10);
+  a->DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, ThreadLocalCacheStatsAcrossThreads) {
+  auto a = NewAllocator(1 << 30, ThreadLocalCacheOptions());
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIters = 1000;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&a]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < kNumIters; ++i) {
+          ptrs.push_back(a->AllocateRaw(1, 256 * (1 + i % 32)));
+          if (ptrs.size() == 4) {
+            for (void* p : ptrs) {
+              a->DeallocateRaw(p);
+            }
+            ptrs.clear();
+          }
+        }
+        for (void* p : ptrs) {
+          a->DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  // The worker threads have exited and returned their caches.
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, kNumThreads * kNumIters);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+  EXPECT_GT(stats->peak_bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, ReusesPendingMemoryWhenAllowed) {
+  constexpr size_t kBytes = 1 << 20;
+  BFCAllocator::Options opts;
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  auto a = NewAllocator(kBytes, opts);
+  SharedCounter counter;
+  a->SetTimingCounter(&counter);
+
+  // The region is freed at a later count than the caller can wait for.
+  std::function<uint64()> freed_by_func = [&counter]() {
+    return counter.get();
+  };
+  counter.next();
+  a->DeallocateRaw(a->AllocateRaw(1, kBytes));
+
+  AllocationAttributes pending_attr;
+  pending_attr.freed_by_func = &freed_by_func;
+  EXPECT_EQ(a->AllocateRaw(1, kBytes, pending_attr), nullptr);
+
+  bool reused_pending_memory = false;
+  pending_attr.reused_pending_memory = &reused_pending_memory;
+  void* p = a->AllocateRaw(1, kBytes, pending_attr);
+  EXPECT_NE(p, nullptr);
+  EXPECT_TRUE(reused_pending_memory);
+  a->DeallocateRaw(p);
+
+  // Memory freed before the count is safe without any wait.
+  counter.next();
+  p = a->AllocateRaw(1, kBytes, pending_attr);
+  EXPECT_NE(p, nullptr);
+  EXPECT_FALSE(reused_pending_memory);
+  a->DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, DefragmentReleasesFreeChunksBetweenLiveOnes) {
+  constexpr size_t kBytes = 256 << 10;
+  BFCAllocator::Options opts;
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  auto sub_allocator = std::make_unique<PagedSubAllocator>();
+  PagedSubAllocator* pages = sub_allocator.get();
+  BFCAllocator a(std::move(sub_allocator), 4 * kBytes, "paged_bfc", opts);
+
+  // Every other chunk is free, so that no two free chunks are contiguous.
+  void* live[2] = {a.AllocateRaw(1, kBytes), nullptr};
+  void* hole = a.AllocateRaw(1, kBytes);
+  live[1] = a.AllocateRaw(1, kBytes);
+  a.DeallocateRaw(hole);
+  EXPECT_EQ(a.AllocateRaw(1, 2 * kBytes), nullptr);
+
+  EXPECT_EQ(a.Defragment(), 2 * kBytes);
+  EXPECT_EQ(pages->released_bytes(), 2 * kBytes);
+  EXPECT_EQ(*a.GetStats()->pool_bytes, static_cast<int64_t>(2 * kBytes));
+  void* p = a.AllocateRaw(1, 2 * kBytes);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(*a.GetStats()->pool_bytes, static_cast<int64_t>(4 * kBytes));
+
+  // Released memory is never handed out again.
+  EXPECT_EQ(a.Defragment(), size_t{0});
+  a.DeallocateRaw(p);
+  for (void* ptr : live) {
+    a.DeallocateRaw(ptr);
+  }
+}
+
+static void BM_AllocationThreaded(::testing::benchmark::State& state) {
+  const int num_threads = state.range(0);
+  const bool use_thread_local_cache = state.range(1);
+  constexpr int kSubIters = 10000;
+  BFCAllocator::Options opts;
+  if (use_thread_local_cache) {
+    opts = ThreadLocalCacheOptions();
+  }
+  auto a = NewAllocator(1ull << 33, opts);
+  thread::ThreadPool pool(Env::Default(), "test", num_threads);
+
+  for (auto s : state) {
+    BlockingCounter done(num_threads);
+    for (int t = 0; t < num_threads; t++) {
+      pool.Schedule([&a, &done]() {
+        // Mostly small tensors, as seen by CPU inference, keeping a few of
+        // them alive at a time.
+        constexpr size_t kSizes[] = {256, 1024, 4096, 512, 16384, 65536};
+        void* live[4] = {};
+        for (int i = 0; i < kSubIters; i++) {
+          void*& p = live[i % 4];
+          if (p != nullptr) a->DeallocateRaw(p);
+          p = a->AllocateRaw(1, kSizes[i % std::size(kSizes)]);
+        }
+        for (void* p : live) {
+          a->DeallocateRaw(p);
+        }
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * kSubIters);
+}
+BENCHMARK(BM_AllocationThreaded)
+    ->ArgPair(1, 0)
+    ->ArgPair(1, 1)
+    ->ArgPair(16, 0)
+    ->ArgPair(16, 1)
+    ->ArgPair(64, 0)
+    ->ArgPair(64, 1);
+
+}  // namespace
+}  // namespace tsl
@@ -78,53 +78,28 @@ Status Footer::DecodeFrom(StringPiece* input) {
   return result;
 }
 
-Status ReadBlock(RandomAccessFile* file, const BlockHandle& handle,
-                 BlockContents* result) {
-  result->data = StringPiece();
-  result->cacheable = false;
-  result->heap_allocated = false;
-
-  // Read the block contents as well as the type/crc footer.
-  // See table_builder.cc for the code that built this structure.
-  size_t n = static_cast<size_t>(handle.size());
-
-  if (kBlockTrailerSize > std::numeric_limits<size_t>::max() - n) {
-    return errors::DataLoss("handle.size() too big");
-  }
-
-  char* buf = new char[n + kBlockTrailerSize];
-  StringPiece contents;
-  Status s = file->Read(handle.offset(), n + kBlockTrailerSize, &contents, buf);
-  if (!s.ok()) {
-    delete[] buf;
-    return s;
-  }
-  if (contents.size() != n + kBlockTrailerSize) {
-    delete[] buf;
-    return errors::DataLoss("truncated block read");
-  }
+namespace {
 
+// Verify the type/crc trailer of the "n" bytes of block contents at "data"
+// and decode them into *result.  "buf" is the heap buffer that holds "data"
+// and is then owned by the block, or nullptr if "data" outlives the block.
+Status DecodeBlock(const char* data, size_t n, char* buf, bool verify_checksum,
+                   BlockContents* result) {
   // Check the crc of the type and the block contents
-  const char* data = contents.data();  // Pointer to where Read put the data
-  // This checksum verification is optional.  We leave it on for now
-  const bool verify_checksum = true;
   if (verify_checksum) {
     const uint32 crc = crc32c::Unmask(core::DecodeFixed32(data + n + 1));
     const uint32 actual = crc32c::Value(data, n + 1);
     if (actual != crc) {
       delete[] buf;
-      s = errors::DataLoss("block checksum mismatch");
-      return s;
+      return errors::DataLoss("block checksum mismatch");
     }
   }
 
   switch (data[n]) {
     case kNoCompression:
-      if (data != buf) {
-        // File implementation gave us pointer to some other data.
-        // Use it directly under the assumption that it will be live
+      if (buf == nullptr) {
+        // Use the data directly under the assumption that it will be live
         // while the file is open.
-        delete[] buf;
         result->data = StringPiece(data, n);
         result->heap_allocated = false;
         result->cacheable = false;  // Do not double-cache
@@ -162,5 +137,60 @@ Status ReadBlock(RandomAccessFile* file, const BlockHandle& handle,
   return OkStatus();
 }
 
+}  // namespace
+
+Status ReadBlock(RandomAccessFile* file, const BlockHandle& handle,
+                 BlockContents* result) {
+  result->data = StringPiece();
+  result->cacheable = false;
+  result->heap_allocated = false;
+
+  // Read the block contents as well as the type/crc footer.
+  // See table_builder.cc for the code that built this structure.
+  size_t n = static_cast<size_t>(handle.size());
+
+  if (kBlockTrailerSize > std::numeric_limits<size_t>::max() - n) {
+    return errors::DataLoss("handle.size() too big");
+  }
+
+  char* buf = new char[n + kBlockTrailerSize];
+  StringPiece contents;
+  Status s = file->Read(handle.offset(), n + kBlockTrailerSize, &contents, buf);
+  if (!s.ok()) {
+    delete[] buf;
+    return s;
+  }
+  if (contents.size() != n + kBlockTrailerSize) {
+    delete[] buf;
+    return errors::DataLoss("truncated block read");
+  }
+
+  const char* data = contents.data();  // Pointer to where Read put the data
+  if (data != buf) {
+    // File implementation gave us pointer to some other data.
+    delete[] buf;
+    buf = nullptr;
+  }
+  // This checksum verification is optional.  We leave it on for now
+  const bool verify_checksum = true;
+  return DecodeBlock(data, n, buf, verify_checksum, result);
+}
+
+Status ReadBlock(StringPiece file_contents, const BlockHandle& handle,
+                 bool verify_checksum, BlockContents* result) {
+  result->data = StringPiece();
+  result->cacheable = false;
+  result->heap_allocated = false;
+
+  const uint64 n = handle.size();
+  if (handle.offset() > file_contents.size() ||
+      file_contents.size() - handle.offset() < kBlockTrailerSize ||
+      file_contents.size() - handle.offset() - kBlockTrailerSize < n) {
+    return errors::DataLoss("truncated block read");
+  }
+  return DecodeBlock(file_contents.data() + handle.offset(), n, nullptr,
+                     verify_checksum, result);
+}
+
 }  // namespace table
 }  // namespace tsl
@@ -102,6 +102,14 @@ struct BlockContents {
 extern Status ReadBlock(RandomAccessFile* file, const BlockHandle& handle,
                         BlockContents* result);
 
+// Read the block identified by "handle" from "file_contents", which holds
+// the whole file and outlives the block, e.g. as a memory-mapped region.
+// Uncompressed blocks point into "file_contents" rather than being copied.
+// The checksum of the block is only verified if "verify_checksum".  On
+// failure return non-OK.  On success fill *result and return OK.
+extern Status ReadBlock(StringPiece file_contents, const BlockHandle& handle,
+                        bool verify_checksum, BlockContents* result);
+
 // Implementation details follow.  Clients should ignore,
 
 inline BlockHandle::BlockHandle()
@@ -0,0 +1,162 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/read_ahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// The reads are I/O bound, so the pool is shared by all streams and sized for
+// the number of reads that storage can serve in parallel, not for the number
+// of cores.
+constexpr int kNumReadThreads = 16;
+
+thread::ThreadPool* ReadThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "read_ahead_input_stream", kNumReadThreads);
+  return pool;
+}
+
+size_t RoundUpToAlignment(size_t bytes) {
+  const size_t alignment = ReadAheadInputStream::kAlignment;
+  return std::max<size_t>(1, (bytes + alignment - 1) / alignment) * alignment;
+}
+
+}  // namespace
+
+ReadAheadInputStream::ReadAheadInputStream(RandomAccessFile* file,
+                                           size_t block_bytes, int num_blocks)
+    : file_(file),
+      block_bytes_(RoundUpToAlignment(block_bytes)),
+      num_blocks_(std::max(1, num_blocks)) {}
+
+ReadAheadInputStream::~ReadAheadInputStream() {
+  mutex_lock l(mu_);
+  mu_.Await(Condition(+[](int64_t* n) { return *n == 0; },
+                      &num_reads_in_flight_));
+}
+
+Status ReadAheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  mutex_lock l(mu_);
+  return ConsumeLocked(bytes_to_read, result);
+}
+
+Status ReadAheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes: ",
+                                   bytes_to_skip);
+  }
+  mutex_lock l(mu_);
+  if (pos_ + bytes_to_skip >= next_block_offset_) {
+    // None of the blocks being read ahead will be used.
+    blocks_.clear();
+    pos_ += bytes_to_skip;
+    return ConsumeLocked(0, nullptr);
+  }
+  return ConsumeLocked(bytes_to_skip, nullptr);
+}
+
+int64_t ReadAheadInputStream::Tell() const {
+  tf_shared_lock l(mu_);
+  return pos_;
+}
+
+Status ReadAheadInputStream::Reset() {
+  mutex_lock l(mu_);
+  blocks_.clear();
+  pos_ = 0;
+  return OkStatus();
+}
+
+Status ReadAheadInputStream::ConsumeLocked(int64_t bytes, tstring* result) {
+  const int64_t target = pos_ + bytes;
+  while (true) {
+    if (blocks_.empty()) {
+      RestartLocked();
+    }
+    std::shared_ptr<Block> block = blocks_.front();
+    mu_.Await(Condition(+[](Block* b) { return b->done; }, block.get()));
+    TF_RETURN_IF_ERROR(block->status);
+    const int64_t block_end = block->offset + block->data.size();
+    if (pos_ > block_end) {
+      // Only possible after skipping past the end of the file.
+      pos_ = block_end;
+      return errors::OutOfRange("reached end of file");
+    }
+    const int64_t n = std::min(target, block_end) - pos_;
+    if (result != nullptr) {
+      result->append(block->data.data() + (pos_ - block->offset), n);
+    }
+    pos_ += n;
+    if (pos_ == target) {
+      return OkStatus();
+    }
+    if (block->data.size() < block_bytes_) {
+      return errors::OutOfRange("reached end of file");
+    }
+    blocks_.pop_front();
+    ScheduleReadsLocked();
+  }
+}
+
+void ReadAheadInputStream::RestartLocked() {
+  blocks_.clear();
+  next_block_offset_ = pos_ - pos_ % block_bytes_;
+  ScheduleReadsLocked();
+}
+
+void ReadAheadInputStream::ScheduleReadsLocked() {
+  while (blocks_.size() < num_blocks_) {
+    auto block = std::make_shared<Block>(next_block_offset_);
+    next_block_offset_ += block_bytes_;
+    blocks_.push_back(block);
+    ++num_reads_in_flight_;
+    ReadThreadPool()->Schedule([this, block]() {
+      block->data.resize_uninitialized(block_bytes_);
+      char* buffer = &block->data[0];
+      StringPiece data;
+      Status s = file_->Read(block->offset, block_bytes_, &data, buffer);
+      if (data.data() != buffer) {
+        memmove(buffer, data.data(), data.size());
+      }
+      block->data.resize(data.size());
+      mutex_lock l(mu_);
+      // A short read means the block is at the end of the file.
+      block->status = errors::IsOutOfRange(s) ? OkStatus() : s;
+      block->done = true;
+      --num_reads_in_flight_;
+    });
+  }
+}
+
+}  // namespace io
+}  // namespace tsl
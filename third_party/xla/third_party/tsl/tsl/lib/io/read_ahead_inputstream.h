@@ -0,0 +1,102 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tsl {
+namespace io {
+
+// Reads a RandomAccessFile sequentially in large aligned blocks, issuing the
+// reads of the next blocks asynchronously on a shared thread pool while the
+// current block is consumed. This keeps several reads in flight, which is
+// needed to saturate fast local storage such as NVMe drives.
+//
+// Like BufferedInputStream, a single instance of ReadAheadInputStream is NOT
+// safe for concurrent use by multiple threads.
+class ReadAheadInputStream : public InputStreamInterface {
+ public:
+  // Reads are aligned to, and a multiple of, this many bytes.
+  static constexpr size_t kAlignment = 4096;
+
+  // Does not take ownership of `file`, which must outlive *this. `block_bytes`
+  // is rounded up to a multiple of `kAlignment`, and up to `num_blocks` blocks
+  // are read ahead of the current position.
+  ReadAheadInputStream(RandomAccessFile* file, size_t block_bytes,
+                       int num_blocks);
+
+  // Waits for the reads in flight to finish.
+  ~ReadAheadInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  // Skipping past the blocks which are being read ahead discards them and
+  // restarts reading at the new position.
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  struct Block {
+    explicit Block(int64_t offset) : offset(offset) {}
+
+    const int64_t offset;
+    // Shorter than `block_bytes_` if the block is at the end of the file.
+    tstring data;
+    Status status;
+    bool done = false;
+  };
+
+  // Advances the stream by `bytes`, appending the data to `result` unless it
+  // is nullptr.
+  Status ConsumeLocked(int64_t bytes, tstring* result)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Discards the blocks and restarts reading from the block containing `pos_`.
+  void RestartLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Schedules reads until `num_blocks_` blocks are buffered or in flight.
+  void ScheduleReadsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t block_bytes_;
+  const int num_blocks_;
+
+  // Waiters are woken up by the reads releasing `mu_`.
+  mutable mutex mu_;
+  int64_t pos_ TF_GUARDED_BY(mu_) = 0;
+  int64_t next_block_offset_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<std::shared_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  int64_t num_reads_in_flight_ TF_GUARDED_BY(mu_) = 0;
+
+  ReadAheadInputStream(const ReadAheadInputStream&) = delete;
+  void operator=(const ReadAheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READ_AHEAD_INPUTSTREAM_H_
@@ -0,0 +1,132 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/read_ahead_inputstream.h"
+
+#include <memory>
+#include <string>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+constexpr size_t kBlockBytes = ReadAheadInputStream::kAlignment;
+
+// Returns `size` bytes of test data.
+std::string Contents(size_t size) {
+  std::string contents(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    contents[i] = static_cast<char>('a' + i % 26);
+  }
+  return contents;
+}
+
+// Returns a temporary file holding `Contents(size)`.
+std::unique_ptr<RandomAccessFile> MakeFile(size_t size) {
+  Env* env = Env::Default();
+  std::string fname;
+  EXPECT_TRUE(env->LocalTempFilename(&fname));
+  TF_EXPECT_OK(WriteStringToFile(env, fname, Contents(size)));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(env->NewRandomAccessFile(fname, &file));
+  return file;
+}
+
+TEST(ReadAheadInputStream, ReadAcrossBlocks) {
+  const size_t file_size = 3 * kBlockBytes + 100;
+  std::unique_ptr<RandomAccessFile> file = MakeFile(file_size);
+  for (int num_blocks : {1, 2, 4}) {
+    for (int64_t read_size : {1, 7, 4096, 5000}) {
+      ReadAheadInputStream in(file.get(), kBlockBytes, num_blocks);
+      std::string expected = Contents(file_size);
+      std::string actual;
+      tstring read;
+      while (in.Tell() + read_size <= file_size) {
+        TF_ASSERT_OK(in.ReadNBytes(read_size, &read));
+        actual.append(read.data(), read.size());
+      }
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(read_size, &read)));
+      actual.append(read.data(), read.size());
+      EXPECT_EQ(actual, expected);
+      EXPECT_EQ(in.Tell(), file_size);
+    }
+  }
+}
+
+TEST(ReadAheadInputStream, RoundsUpBlockSize) {
+  std::unique_ptr<RandomAccessFile> file = MakeFile(10000);
+  ReadAheadInputStream in(file.get(), /*block_bytes=*/1, /*num_blocks=*/2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(10000, &read));
+  EXPECT_EQ(read, Contents(10000));
+}
+
+TEST(ReadAheadInputStream, SkipNBytes) {
+  const size_t file_size = 8 * kBlockBytes;
+  std::unique_ptr<RandomAccessFile> file = MakeFile(file_size);
+  const std::string contents = Contents(file_size);
+  ReadAheadInputStream in(file.get(), kBlockBytes, /*num_blocks=*/2);
+  tstring read;
+  // Within the blocks being read ahead.
+  TF_ASSERT_OK(in.SkipNBytes(10));
+  TF_ASSERT_OK(in.ReadNBytes(5, &read));
+  EXPECT_EQ(read, contents.substr(10, 5));
+  // Past the blocks being read ahead.
+  TF_ASSERT_OK(in.SkipNBytes(5 * kBlockBytes));
+  EXPECT_EQ(in.Tell(), 5 * kBlockBytes + 15);
+  TF_ASSERT_OK(in.ReadNBytes(kBlockBytes, &read));
+  EXPECT_EQ(read, contents.substr(5 * kBlockBytes + 15, kBlockBytes));
+  // To the end of the file.
+  TF_ASSERT_OK(in.SkipNBytes(file_size - in.Tell()));
+  EXPECT_EQ(in.Tell(), file_size);
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+}
+
+TEST(ReadAheadInputStream, SkipPastEndOfFile) {
+  std::unique_ptr<RandomAccessFile> file = MakeFile(100);
+  ReadAheadInputStream in(file.get(), kBlockBytes, /*num_blocks=*/2);
+  EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(101)));
+  EXPECT_EQ(in.Tell(), 100);
+}
+
+TEST(ReadAheadInputStream, Reset) {
+  const size_t file_size = 3 * kBlockBytes;
+  std::unique_ptr<RandomAccessFile> file = MakeFile(file_size);
+  ReadAheadInputStream in(file.get(), kBlockBytes, /*num_blocks=*/2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(2 * kBlockBytes + 1, &read));
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(in.Tell(), 0);
+  TF_ASSERT_OK(in.ReadNBytes(file_size, &read));
+  EXPECT_EQ(read, Contents(file_size));
+}
+
+TEST(ReadAheadInputStream, EmptyFile) {
+  std::unique_ptr<RandomAccessFile> file = MakeFile(0);
+  ReadAheadInputStream in(file.get(), kBlockBytes, /*num_blocks=*/2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(0, &read));
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+  EXPECT_TRUE(read.empty());
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
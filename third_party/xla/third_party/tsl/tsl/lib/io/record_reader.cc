@@ -17,10 +17,13 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+
 #include "tsl/lib/hash/crc32c.h"
 #include "tsl/lib/io/buffered_inputstream.h"
 #include "tsl/lib/io/compression.h"
 #include "tsl/lib/io/random_inputstream.h"
+#include "tsl/lib/io/read_ahead_inputstream.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/raw_coding.h"
@@ -56,12 +59,15 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
 
 RecordReader::RecordReader(RandomAccessFile* file,
                            const RecordReaderOptions& options)
-    : options_(options),
-      input_stream_(new RandomAccessInputStream(file)),
-      last_read_failed_(false) {
-  if (options.buffer_size > 0) {
-    input_stream_.reset(new BufferedInputStream(input_stream_.release(),
-                                                options.buffer_size, true));
+    : options_(options), last_read_failed_(false) {
+  if (options.buffer_size > 0 && options.num_read_ahead_blocks > 0) {
+    input_stream_.reset(new ReadAheadInputStream(
+        file, options.buffer_size, options.num_read_ahead_blocks));
+  } else if (options.buffer_size > 0) {
+    input_stream_.reset(new BufferedInputStream(
+        new RandomAccessInputStream(file), options.buffer_size, true));
+  } else {
+    input_stream_.reset(new RandomAccessInputStream(file));
   }
 #if defined(IS_SLIM_BUILD)
   if (options.compression_type != RecordReaderOptions::NONE) {
@@ -92,6 +98,9 @@ inline const char* GetChecksumErrorSuffix(uint64 offset) {
   }
   return "";
 }
+
+// The smallest buffer ReadRecords() reads into at once.
+constexpr size_t kMinBatchBytes = 256 << 10;
 }  // namespace
 
 // Read n+4 bytes from file, verify that checksum of first n bytes is
@@ -255,6 +264,100 @@ Status RecordReader::SkipRecords(uint64* offset, int num_to_skip,
   return OkStatus();
 }
 
+Status RecordReader::FillBatchBuffer(size_t n, bool* eof) {
+  tstring chunk;
+  Status s = input_stream_->ReadNBytes(n, &chunk);
+  if (!s.ok() && !errors::IsOutOfRange(s)) {
+    // The position of the stream is unknown, so start over next time.
+    last_read_failed_ = true;
+    batch_buffer_.clear();
+    return s;
+  }
+  batch_buffer_.append(chunk);
+  *eof = chunk.size() < n;
+  return OkStatus();
+}
+
+Status RecordReader::ReadRecords(uint64* offset, int max_records,
+                                 std::vector<StringPiece>* records) {
+  DCHECK_GT(max_records, 0);
+  records->clear();
+  // Keep the bytes past "*offset" that the last call read, if the stream is
+  // still where that call left it.
+  const uint64 batch_end = batch_offset_ + batch_buffer_.size();
+  if (*offset >= batch_offset_ && *offset <= batch_end &&
+      !last_read_failed_ &&
+      input_stream_->Tell() == static_cast<int64_t>(batch_end)) {
+    batch_buffer_.erase(0, *offset - batch_offset_);
+  } else {
+    batch_buffer_.clear();
+    TF_RETURN_IF_ERROR(PositionInputStream(*offset));
+  }
+  batch_offset_ = *offset;
+
+  const size_t batch_bytes =
+      std::max<size_t>(options_.buffer_size, kMinBatchBytes);
+  bool eof = false;
+  if (batch_buffer_.size() < batch_bytes) {
+    TF_RETURN_IF_ERROR(
+        FillBatchBuffer(batch_bytes - batch_buffer_.size(), &eof));
+  }
+
+  // Frame and checksum the records in place.  Any error is returned only
+  // once no records precede it, so that they are not lost.
+  size_t pos = 0;
+  while (records->size() < static_cast<size_t>(max_records)) {
+    const size_t available = batch_buffer_.size() - pos;
+    if (available < kHeaderSize) {
+      if (!records->empty()) break;
+      if (!eof) {
+        TF_RETURN_IF_ERROR(FillBatchBuffer(kHeaderSize - available, &eof));
+        continue;
+      }
+      if (available == 0) {
+        return errors::OutOfRange("eof", GetChecksumErrorSuffix(*offset));
+      }
+      return errors::DataLoss("truncated record at ", *offset,
+                              GetChecksumErrorSuffix(*offset));
+    }
+    const char* header = batch_buffer_.data() + pos;
+    if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+        crc32c::Value(header, sizeof(uint64))) {
+      if (!records->empty()) break;
+      return errors::DataLoss("corrupted record at ", *offset,
+                              GetChecksumErrorSuffix(*offset));
+    }
+    const uint64 length = core::DecodeFixed64(header);
+    if (length >= SIZE_MAX - kHeaderSize - kFooterSize) {
+      if (!records->empty()) break;
+      return errors::DataLoss("record size too large",
+                              GetChecksumErrorSuffix(*offset));
+    }
+    const size_t record_size = kHeaderSize + length + kFooterSize;
+    if (available < record_size) {
+      // Leave the record to the next call, which reads it in full.
+      if (!records->empty()) break;
+      if (!eof) {
+        TF_RETURN_IF_ERROR(FillBatchBuffer(record_size - available, &eof));
+        continue;
+      }
+      return errors::DataLoss("truncated record at ", *offset,
+                              GetChecksumErrorSuffix(*offset));
+    }
+    const char* data = header + kHeaderSize;
+    if (crc32c::Unmask(core::DecodeFixed32(data + length)) !=
+        crc32c::Value(data, length)) {
+      if (!records->empty()) break;
+      return errors::DataLoss("corrupted record at ", *offset + kHeaderSize,
+                              GetChecksumErrorSuffix(*offset + kHeaderSize));
+    }
+    records->emplace_back(data, length);
+    pos += record_size;
+    *offset += record_size;
+  }
+  return OkStatus();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
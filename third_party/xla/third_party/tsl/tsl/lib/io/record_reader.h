@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tsl/lib/io/inputstream_interface.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/stringpiece.h"
@@ -46,6 +48,11 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If non-zero, the file is read asynchronously in aligned blocks of
+  // buffer_size bytes, and up to this many blocks are read ahead of the
+  // current position. The same restrictions as for buffering apply.
+  int num_read_ahead_blocks = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -103,6 +110,21 @@ class RecordReader {
   // are actually skipped. It should be equal to num_to_skip on success.
   Status SkipRecords(uint64* offset, int num_to_skip, int* num_skipped);
 
+  // Read up to max_records records starting at "*offset" into *records and
+  // update *offset to point to the offset of the next record.
+  //
+  // The records are read in bulk into a buffer owned by this reader, of at
+  // least options.buffer_size bytes, and are framed and checksummed in
+  // place: *records points into that buffer, and is only valid until the next
+  // call on this reader.  Fewer than max_records records are returned when the
+  // buffer runs out; a record that does not fit is read in full on its own.
+  // An error found after some records is returned by the next call instead.
+  //
+  // Returns OK on success with at least one record, OUT_OF_RANGE for end of
+  // file, or something else for an error.
+  Status ReadRecords(uint64* offset, int max_records,
+                     std::vector<StringPiece>* records);
+
   // Return the metadata of the Record file.
   //
   // The current implementation scans the file to completion,
@@ -117,11 +139,19 @@ class RecordReader {
  private:
   Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
   Status PositionInputStream(uint64 offset);
+  // Append up to n bytes from the input stream to batch_buffer_, and set
+  // *eof if the stream ran out.
+  Status FillBatchBuffer(size_t n, bool* eof);
 
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
   bool last_read_failed_;
 
+  // The bytes last read by ReadRecords(), from batch_offset_ in the file up to
+  // the position of input_stream_.
+  tstring batch_buffer_;
+  uint64 batch_offset_ = 0;
+
   std::unique_ptr<Metadata> cached_metadata_;
 
   RecordReader(const RecordReader&) = delete;
@@ -155,6 +185,12 @@ class SequentialRecordReader {
     return underlying_.SkipRecords(&offset_, num_to_skip, num_skipped);
   }
 
+  // Read up to the next max_records records in the file into *records, which
+  // point into a buffer of the reader; see RecordReader::ReadRecords().
+  Status ReadRecords(int max_records, std::vector<StringPiece>* records) {
+    return underlying_.ReadRecords(&offset_, max_records, records);
+  }
+
   // Return the current offset in the file.
   uint64 TellOffset() { return offset_; }
 
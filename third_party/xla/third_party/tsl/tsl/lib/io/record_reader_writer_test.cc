@@ -121,6 +121,15 @@ TEST(RecordReaderWriterTest, TestZlibSyncFlush) {
   VerifyFlush(options);
 }
 
+TEST(RecordReaderWriterTest, TestZlibParallelFlush) {
+  io::RecordWriterOptions options;
+  options.compression_type = io::RecordWriterOptions::ZLIB_COMPRESSION;
+  options.zlib_options.input_buffer_size = 16;
+  options.zlib_options.num_compression_threads = 4;
+
+  VerifyFlush(options);
+}
+
 TEST(RecordReaderWriterTest, TestBasics) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_test";
@@ -233,6 +242,132 @@ TEST(RecordReaderWriterTest, TestSkipOutOfRange) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestReadAhead) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_read_ahead_test";
+  constexpr int kNumRecords = 1000;
+
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get(), io::RecordWriterOptions());
+    for (int i = 0; i < kNumRecords; ++i) {
+      TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record_", i)));
+    }
+    TF_CHECK_OK(writer.Flush());
+  }
+
+  {
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::RecordReaderOptions options;
+    options.buffer_size = 4096;
+    options.num_read_ahead_blocks = 2;
+    io::RecordReader reader(read_file.get(), options);
+    uint64 offset = 0;
+    int num_skipped;
+    tstring record;
+    TF_CHECK_OK(reader.SkipRecords(&offset, 10, &num_skipped));
+    EXPECT_EQ(10, num_skipped);
+    for (int i = 10; i < kNumRecords; ++i) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(strings::StrCat("record_", i), record);
+    }
+    EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecord(&offset, &record).code());
+  }
+}
+
+TEST(RecordReaderWriterTest, TestReadRecords) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_read_records_test";
+  constexpr int kNumRecords = 1000;
+  // Every 100th record is too large for one batch.
+  auto record_value = [](int i) {
+    return i % 100 == 50 ? string(300 << 10, 'a' + i % 26)
+                         : strings::StrCat("record_", i);
+  };
+
+  for (const string& compression_type : {"", "ZLIB"}) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+      io::RecordWriter writer(
+          file.get(),
+          io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+      for (int i = 0; i < kNumRecords; ++i) {
+        TF_EXPECT_OK(writer.WriteRecord(record_value(i)));
+      }
+      TF_CHECK_OK(writer.Flush());
+    }
+
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+    io::SequentialRecordReader reader(
+        read_file.get(),
+        io::RecordReaderOptions::CreateRecordReaderOptions(compression_type));
+    int num_skipped;
+    TF_CHECK_OK(reader.SkipRecords(10, &num_skipped));
+    std::vector<StringPiece> records;
+    int i = 10;
+    while (i < kNumRecords) {
+      TF_CHECK_OK(reader.ReadRecords(64, &records));
+      ASSERT_FALSE(records.empty());
+      EXPECT_LE(records.size(), 64);
+      for (StringPiece record : records) {
+        EXPECT_EQ(record_value(i), record);
+        ++i;
+      }
+    }
+    EXPECT_EQ(kNumRecords, i);
+    EXPECT_EQ(error::OUT_OF_RANGE, reader.ReadRecords(64, &records).code());
+  }
+}
+
+TEST(RecordReaderWriterTest, TestReadRecordsCorrupted) {
+  Env* env = Env::Default();
+  string fname =
+      testing::TmpDir() + "/record_reader_writer_read_records_corrupted_test";
+  string contents;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_EXPECT_OK(writer.WriteRecord("hij"));
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(file->Close());
+  }
+  TF_CHECK_OK(ReadFileToString(env, fname, &contents));
+  // Corrupt the data of the last record.
+  const size_t last_offset = contents.size() - io::RecordReader::kFooterSize -
+                             3 - io::RecordReader::kHeaderSize;
+  contents[contents.size() - io::RecordReader::kFooterSize - 1] ^= 1;
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader reader(read_file.get());
+  uint64 offset = 0;
+  std::vector<StringPiece> records;
+  // The records before the corrupted one are returned first.
+  TF_CHECK_OK(reader.ReadRecords(&offset, 10, &records));
+  EXPECT_EQ(std::vector<StringPiece>({"abc", "defg"}), records);
+  EXPECT_EQ(last_offset, offset);
+  Status s = reader.ReadRecords(&offset, 10, &records);
+  EXPECT_EQ(error::DATA_LOSS, s.code());
+  EXPECT_TRUE(records.empty());
+
+  // Truncating the file makes the last record truncated instead.
+  contents.resize(contents.size() - 1);
+  TF_CHECK_OK(WriteStringToFile(env, fname, contents));
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader truncated_reader(read_file.get());
+  s = truncated_reader.ReadRecords(&offset, 10, &records);
+  EXPECT_EQ(error::DATA_LOSS, s.code());
+  EXPECT_EQ(strings::StrCat("truncated record at ", last_offset), s.message());
+}
+
 TEST(RecordReaderWriterTest, TestMalformedInput) {
   Env* env = Env::Default();
   string fname =
@@ -65,7 +65,18 @@ RecordWriter::RecordWriter(WritableFile* dest,
     LOG(FATAL) << "Compression is unsupported on mobile platforms.";
   }
 #else
-  if (IsZlibCompressed(options)) {
+  if (IsZlibCompressed(options) &&
+      options.zlib_options.num_compression_threads > 0) {
+    ParallelZlibOutputBuffer* zlib_output_buffer = new ParallelZlibOutputBuffer(
+        dest, options.zlib_options.input_buffer_size,
+        options.zlib_options.num_compression_threads, options.zlib_options);
+    Status s = zlib_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize parallel Zlib outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zlib_output_buffer;
+  } else if (IsZlibCompressed(options)) {
     ZlibOutputBuffer* zlib_output_buffer = new ZlibOutputBuffer(
         dest, options.zlib_options.input_buffer_size,
         options.zlib_options.output_buffer_size, options.zlib_options);
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tsl/lib/io/table.h"
 
+#include <memory>
+#include <unordered_set>
+
 #include "tsl/lib/io/block.h"
 #include "tsl/lib/io/cache.h"
 #include "tsl/lib/io/format.h"
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tsl/platform/coding.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/mutex.h"
 
 namespace tsl {
 namespace table {
@@ -30,26 +34,78 @@ namespace table {
 struct Table::Rep {
   ~Rep() { delete index_block; }
 
+  // Reads the block identified by "handle" from the file or region.
+  Status ReadBlock(const BlockHandle& handle, BlockContents* contents);
+
   Options options;
   Status status;
-  RandomAccessFile* file;
+  RandomAccessFile* file = nullptr;
+  // The contents of the memory region the table is read from, if any.
+  bool mapped = false;
+  StringPiece mapped_contents;
   uint64 cache_id;
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
-  Block* index_block;
+  Block* index_block = nullptr;
+
+  // Offsets of the blocks of "mapped_contents" whose checksums were verified.
+  mutex mu;
+  std::unordered_set<uint64> verified_blocks TF_GUARDED_BY(mu);
 };
 
+Status Table::Rep::ReadBlock(const BlockHandle& handle,
+                             BlockContents* contents) {
+  if (!mapped) {
+    return table::ReadBlock(file, handle, contents);
+  }
+  bool verified;
+  {
+    mutex_lock l(mu);
+    verified = verified_blocks.count(handle.offset()) > 0;
+  }
+  Status s = table::ReadBlock(mapped_contents, handle,
+                              /*verify_checksum=*/!verified, contents);
+  if (s.ok() && !verified) {
+    mutex_lock l(mu);
+    verified_blocks.insert(handle.offset());
+  }
+  return s;
+}
+
 Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
                    Table** table) {
+  Rep* rep = new Table::Rep;
+  rep->options = options;
+  rep->file = file;
+  return Open(rep, size, table);
+}
+
+Status Table::Open(const Options& options, ReadOnlyMemoryRegion* region,
+                   Table** table) {
+  Rep* rep = new Table::Rep;
+  rep->options = options;
+  rep->mapped = true;
+  rep->mapped_contents = StringPiece(static_cast<const char*>(region->data()),
+                                     region->length());
+  return Open(rep, region->length(), table);
+}
+
+Status Table::Open(Rep* rep, uint64 size, Table** table) {
   *table = nullptr;
+  std::unique_ptr<Rep> rep_deleter(rep);
   if (size < Footer::kEncodedLength) {
     return errors::DataLoss("file is too short to be an sstable");
   }
 
   char footer_space[Footer::kEncodedLength];
   StringPiece footer_input;
-  Status s = file->Read(size - Footer::kEncodedLength, Footer::kEncodedLength,
+  Status s;
+  if (rep->mapped) {
+    footer_input = rep->mapped_contents.substr(size - Footer::kEncodedLength);
+  } else {
+    s = rep->file->Read(size - Footer::kEncodedLength, Footer::kEncodedLength,
                         &footer_input, footer_space);
+  }
   if (!s.ok()) return s;
 
   Footer footer;
@@ -58,24 +114,18 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
 
   // Read the index block
   BlockContents contents;
-  Block* index_block = nullptr;
   if (s.ok()) {
-    s = ReadBlock(file, footer.index_handle(), &contents);
+    s = rep->ReadBlock(footer.index_handle(), &contents);
   }
 
   if (s.ok()) {
     // We've successfully read the footer and the index block: we're
     // ready to serve requests.
-    index_block = new Block(contents);
-    Rep* rep = new Table::Rep;
-    rep->options = options;
-    rep->file = file;
     rep->metaindex_handle = footer.metaindex_handle();
-    rep->index_block = index_block;
-    rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
-    *table = new Table(rep);
-  } else {
-    if (index_block) delete index_block;
+    rep->index_block = new Block(contents);
+    rep->cache_id =
+        (rep->options.block_cache ? rep->options.block_cache->NewId() : 0);
+    *table = new Table(rep_deleter.release());
   }
 
   return s;
@@ -123,7 +173,7 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
       if (cache_handle != nullptr) {
         block = reinterpret_cast<Block*>(block_cache->Value(cache_handle));
       } else {
-        s = ReadBlock(table->rep_->file, handle, &contents);
+        s = table->rep_->ReadBlock(handle, &contents);
         if (s.ok()) {
           block = new Block(contents);
           cache_handle = block_cache->Insert(key, block, block->size(),
@@ -131,7 +181,7 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
         }
       }
     } else {
-      s = ReadBlock(table->rep_->file, handle, &contents);
+      s = table->rep_->ReadBlock(handle, &contents);
       if (s.ok()) {
         block = new Block(contents);
       }
@@ -23,6 +23,7 @@ limitations under the License.
 namespace tsl {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace table {
 
@@ -46,6 +47,14 @@ class Table {
   static Status Open(const Options& options, tsl::RandomAccessFile* file,
                      uint64 file_size, Table** table);
 
+  // Like above, but reads the table from all of "region", e.g. a memory
+  // mapped file.  Uncompressed blocks are used in place rather than copied,
+  // and their checksums are verified on first use only.  Does not take
+  // ownership of "*region", which must remain live for the duration of the
+  // returned table's lifetime.
+  static Status Open(const Options& options,
+                     tsl::ReadOnlyMemoryRegion* region, Table** table);
+
   ~Table();
 
   // Returns a new iterator over the table contents.
@@ -68,6 +77,10 @@ class Table {
   explicit Table(Rep* rep) { rep_ = rep; }
   static Iterator* BlockReader(void*, const StringPiece&);
 
+  // Reads the footer and index block of "*rep" and, on success, sets
+  // "*table" to a table that owns "rep".  Deletes "rep" on failure.
+  static Status Open(Rep* rep, uint64 file_size, Table** table);
+
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
   // that key is not present.
@@ -149,6 +149,20 @@ class StringSource : public RandomAccessFile {
   mutable uint64 bytes_read_;
 };
 
+// A memory region over a copy of a string, as if the string were a mapped
+// file.
+class StringRegion : public ReadOnlyMemoryRegion {
+ public:
+  explicit StringRegion(const StringPiece& contents)
+      : contents_(contents.data(), contents.size()) {}
+
+  const void* data() override { return contents_.data(); }
+  uint64 length() override { return contents_.size(); }
+
+ private:
+  string contents_;
+};
+
 typedef std::map<string, string, STLLessThan> KVMap;
 
 // Helper class for tests to unify the interface between
@@ -217,7 +231,9 @@ class BlockConstructor : public Constructor {
 
 class TableConstructor : public Constructor {
  public:
-  TableConstructor() : source_(nullptr), table_(nullptr) {}
+  // If "mapped", the table is opened from a memory region rather than a file.
+  explicit TableConstructor(bool mapped = false)
+      : mapped_(mapped), source_(nullptr), region_(nullptr), table_(nullptr) {}
   ~TableConstructor() override { Reset(); }
   Status FinishImpl(const Options& options, const KVMap& data) override {
     Reset();
@@ -236,6 +252,10 @@ class TableConstructor : public Constructor {
     // Open the table
     source_ = new StringSource(sink.contents());
     Options table_options;
+    if (mapped_) {
+      region_ = new StringRegion(sink.contents());
+      return Table::Open(table_options, region_, &table_);
+    }
     return Table::Open(table_options, source_, sink.contents().size(), &table_);
   }
 
@@ -251,15 +271,19 @@ class TableConstructor : public Constructor {
   void Reset() {
     delete table_;
     delete source_;
+    delete region_;
     table_ = nullptr;
     source_ = nullptr;
+    region_ = nullptr;
   }
 
+  const bool mapped_;
   StringSource* source_;
+  StringRegion* region_;
   Table* table_;
 };
 
-enum TestType { TABLE_TEST, BLOCK_TEST };
+enum TestType { TABLE_TEST, MAPPED_TABLE_TEST, BLOCK_TEST };
 
 struct TestArgs {
   TestType type;
@@ -267,8 +291,9 @@ struct TestArgs {
 };
 
 static const TestArgs kTestArgList[] = {
-    {TABLE_TEST, 16}, {TABLE_TEST, 1}, {TABLE_TEST, 1024},
-    {BLOCK_TEST, 16}, {BLOCK_TEST, 1}, {BLOCK_TEST, 1024},
+    {TABLE_TEST, 16},        {TABLE_TEST, 1},        {TABLE_TEST, 1024},
+    {MAPPED_TABLE_TEST, 16}, {MAPPED_TABLE_TEST, 1}, {MAPPED_TABLE_TEST, 1024},
+    {BLOCK_TEST, 16},        {BLOCK_TEST, 1},        {BLOCK_TEST, 1024},
 };
 static const int kNumTestArgs = sizeof(kTestArgList) / sizeof(kTestArgList[0]);
 
@@ -289,6 +314,9 @@ class Harness : public ::testing::Test {
       case TABLE_TEST:
         constructor_ = new TableConstructor();
         break;
+      case MAPPED_TABLE_TEST:
+        constructor_ = new TableConstructor(/*mapped=*/true);
+        break;
       case BLOCK_TEST:
         constructor_ = new BlockConstructor();
         break;
@@ -633,5 +661,51 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+TEST(TableTest, MappedTableReadsBlocksInPlace) {
+  TableConstructor c(/*mapped=*/true);
+  c.Add("k01", "firstvalue");
+  c.Add("k02", string(100000, 'x'));
+  c.Add("k03", "abc");
+  std::vector<string> keys;
+  KVMap kvmap;
+  Options options;
+  options.block_size = 1024;
+  options.compression = kNoCompression;
+  c.Finish(options, &keys, &kvmap);
+
+  Iterator* iter = c.NewIterator();
+  iter->Seek("k02");
+  ASSERT_TRUE(iter->Valid());
+  EXPECT_EQ(string(100000, 'x'), iter->value());
+  iter->Next();
+  ASSERT_TRUE(iter->Valid());
+  EXPECT_EQ("abc", iter->value());
+  delete iter;
+  // Nothing was read through the file.
+  EXPECT_EQ(0, c.BytesRead());
+}
+
+TEST(TableTest, MappedTableVerifiesChecksums) {
+  StringSink sink;
+  Options options;
+  options.compression = kNoCompression;
+  TableBuilder builder(options, &sink);
+  builder.Add("k01", "value");
+  TF_CHECK_OK(builder.Finish());
+  string contents(sink.contents());
+  // Corrupt the value in the data block, which comes first.
+  contents[contents.find("value")] = 'V';
+
+  StringRegion region(contents);
+  Table* table;
+  TF_CHECK_OK(Table::Open(options, &region, &table));
+  Iterator* iter = table->NewIterator();
+  iter->Seek("k01");
+  EXPECT_FALSE(iter->Valid());
+  EXPECT_TRUE(errors::IsDataLoss(iter->status()));
+  delete iter;
+  delete table;
+}
+
 }  // namespace table
 }  // namespace tsl
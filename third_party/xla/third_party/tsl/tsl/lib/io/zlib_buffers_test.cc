@@ -163,6 +163,58 @@ TEST(ZlibBuffers, MultipleWriteCallsWithFlush) {
   TestMultipleWrites(200, 200, 10, true);
 }
 
+void TestParallelCompression(CompressionOptions options, bool with_flush) {
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const string data = GenTestString(500);
+  for (int block_bytes : {100, 10000, 1 << 20}) {
+    for (int num_threads : {1, 4}) {
+      std::unique_ptr<WritableFile> file_writer;
+      TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+      ParallelZlibOutputBuffer out(file_writer.get(), block_bytes, num_threads,
+                                   options);
+      TF_ASSERT_OK(out.Init());
+      // Write the data in pieces which don't line up with the blocks.
+      for (size_t pos = 0; pos < data.size(); pos += 777) {
+        TF_ASSERT_OK(out.Append(StringPiece(data).substr(pos, 777)));
+        if (with_flush) {
+          TF_ASSERT_OK(out.Flush());
+        }
+      }
+      TF_ASSERT_OK(out.Close());
+      TF_ASSERT_OK(file_writer->Close());
+
+      std::unique_ptr<RandomAccessFile> file_reader;
+      TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+      std::unique_ptr<RandomAccessInputStream> input_stream(
+          new RandomAccessInputStream(file_reader.get()));
+      ZlibInputStream in(input_stream.get(), 1000, 1000, options);
+      tstring result;
+      TF_ASSERT_OK(in.ReadNBytes(data.size(), &result));
+      EXPECT_EQ(result, data);
+      // The stream ends, with a valid checksum, right after the data.
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+    }
+  }
+}
+
+TEST(ZlibBuffers, ParallelDefaultOptions) {
+  TestParallelCompression(CompressionOptions::DEFAULT(), false);
+}
+
+TEST(ZlibBuffers, ParallelRawDeflate) {
+  TestParallelCompression(CompressionOptions::RAW(), false);
+}
+
+TEST(ZlibBuffers, ParallelGzip) {
+  TestParallelCompression(CompressionOptions::GZIP(), false);
+}
+
+TEST(ZlibBuffers, ParallelWithFlush) {
+  TestParallelCompression(CompressionOptions::DEFAULT(), true);
+}
+
 TEST(ZlibInputStream, FailsToReadIfWindowBitsAreIncompatible) {
   Env* env = Env::Default();
   string fname;
@@ -117,6 +117,14 @@ class ZlibCompressionOptions {
   //
   // This option is ignored for `ZlibOutputBuffer`.
   bool soft_fail_on_error = false;  // NOLINT
+
+  // When this is greater than 0, RecordWriter compresses blocks of
+  // `input_buffer_size` bytes on this many threads, using
+  // ParallelZlibOutputBuffer. The output is read like that of a single
+  // ZlibOutputBuffer.
+  //
+  // This option is ignored for `ZlibInputStream` and `ZlibOutputBuffer`.
+  int32 num_compression_threads = 0;
 };
 
 inline ZlibCompressionOptions ZlibCompressionOptions::DEFAULT() {
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tsl/lib/io/zlib_outputbuffer.h"
 
+#include <algorithm>
+
 #include "tsl/platform/errors.h"
+#include "tsl/platform/coding.h"
 
 namespace tsl {
 namespace io {
@@ -242,5 +245,281 @@ Status ZlibOutputBuffer::Tell(int64_t* position) {
   return file_->Tell(position);
 }
 
+ParallelZlibOutputBuffer::ParallelZlibOutputBuffer(
+    WritableFile* file, int32_t block_bytes, int num_threads,
+    const ZlibCompressionOptions& zlib_options)
+    : file_(file),
+      block_bytes_(block_bytes),
+      num_threads_(num_threads),
+      zlib_options_(zlib_options),
+      current_(new Block) {}
+
+ParallelZlibOutputBuffer::~ParallelZlibOutputBuffer() {
+  if (!closed_) {
+    LOG(WARNING)
+        << "ParallelZlibOutputBuffer::Close() not called. Possible data loss";
+  }
+}
+
+Status ParallelZlibOutputBuffer::Init() {
+  if (block_bytes_ <= 0) {
+    return errors::InvalidArgument("block_bytes should be greater than 0");
+  }
+  if (num_threads_ <= 0) {
+    return errors::InvalidArgument("num_threads should be greater than 0");
+  }
+  const int window_bits = zlib_options_.window_bits;
+  if (window_bits >= -15 && window_bits <= -8) {
+    wrapper_ = Wrapper::kRaw;
+    raw_window_bits_ = -window_bits;
+  } else if (window_bits >= 8 && window_bits <= 15) {
+    wrapper_ = Wrapper::kZlib;
+    raw_window_bits_ = window_bits;
+    check_ = adler32(0, Z_NULL, 0);
+  } else if (window_bits >= 16 + 8 && window_bits <= 16 + 15) {
+    wrapper_ = Wrapper::kGzip;
+    raw_window_bits_ = window_bits - 16;
+    check_ = crc32(0, Z_NULL, 0);
+  } else {
+    return errors::InvalidArgument("Unsupported window_bits ", window_bits);
+  }
+  // zlib raises a window of 256 bytes to 512 bytes when deflating.
+  raw_window_bits_ = std::max(raw_window_bits_, 9);
+  thread_pool_ = std::make_unique<thread::ThreadPool>(
+      Env::Default(), "zlib_compression", num_threads_);
+  return OkStatus();
+}
+
+Status ParallelZlibOutputBuffer::Append(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Append() called after Close()");
+  }
+  TF_RETURN_IF_ERROR(status_);
+  while (!data.empty()) {
+    const size_t bytes_to_copy =
+        std::min(data.size(), block_bytes_ - current_->input.size());
+    current_->input.append(data.data(), bytes_to_copy);
+    data.remove_prefix(bytes_to_copy);
+    if (current_->input.size() == block_bytes_) {
+      CompressCurrentBlock(/*last=*/false);
+      TF_RETURN_IF_ERROR(WriteBlocks(2 * num_threads_));
+    }
+  }
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ParallelZlibOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+void ParallelZlibOutputBuffer::CompressCurrentBlock(bool last) {
+  std::shared_ptr<Block> block(current_.release());
+  block->dictionary.swap(history_);
+  const size_t window_bytes = size_t{1} << raw_window_bits_;
+  const string& input = block->input;
+  if (input.size() >= window_bytes) {
+    history_.assign(input, input.size() - window_bytes, window_bytes);
+  } else {
+    // Keep the end of the block before too, up to a window in all.
+    const string& dictionary = block->dictionary;
+    const size_t keep_bytes = window_bytes - input.size();
+    history_ = dictionary.size() > keep_bytes
+                   ? dictionary.substr(dictionary.size() - keep_bytes)
+                   : dictionary;
+    history_.append(input);
+  }
+  current_.reset(new Block);
+  if (!last) {
+    current_->input.reserve(block_bytes_);
+  }
+  pending_.push_back(block);
+  thread_pool_->Schedule([this, block, last]() {
+    Status s = Deflate(last, block.get());
+    mutex_lock l(mu_);
+    block->status = s;
+    block->done = true;
+    block_done_.notify_all();
+  });
+}
+
+Status ParallelZlibOutputBuffer::Deflate(bool last, Block* block) const {
+  const string& input = block->input;
+  if (wrapper_ == Wrapper::kZlib) {
+    block->check = adler32(adler32(0, Z_NULL, 0),
+                           reinterpret_cast<const Bytef*>(input.data()),
+                           input.size());
+  } else if (wrapper_ == Wrapper::kGzip) {
+    block->check =
+        crc32(crc32(0, Z_NULL, 0),
+              reinterpret_cast<const Bytef*>(input.data()), input.size());
+  }
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(z_stream));
+  int error = deflateInit2(&stream, zlib_options_.compression_level,
+                           zlib_options_.compression_method, -raw_window_bits_,
+                           zlib_options_.mem_level,
+                           zlib_options_.compression_strategy);
+  if (error != Z_OK) {
+    return errors::InvalidArgument("deflateInit failed with status", error);
+  }
+  if (!block->dictionary.empty()) {
+    deflateSetDictionary(
+        &stream, reinterpret_cast<const Bytef*>(block->dictionary.data()),
+        block->dictionary.size());
+  }
+  // Leave room for the flush marker past the bound.
+  string& output = block->output;
+  output.resize(deflateBound(&stream, input.size()) + 16);
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  stream.avail_in = input.size();
+  stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+  stream.avail_out = output.size();
+  const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+  while (true) {
+    error = deflate(&stream, flush);
+    if (error != Z_OK && error != Z_BUF_ERROR && error != Z_STREAM_END) break;
+    if (last ? error == Z_STREAM_END
+             : stream.avail_in == 0 && stream.avail_out > 0) {
+      error = Z_OK;
+      break;
+    }
+    // Out of room, so grow the output.
+    const size_t used = output.size() - stream.avail_out;
+    output.resize(2 * output.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[used]);
+    stream.avail_out = output.size() - used;
+  }
+  output.resize(output.size() - stream.avail_out);
+  string error_string;
+  if (error != Z_OK) {
+    error_string = strings::StrCat("deflate() failed with error ", error);
+    if (stream.msg != nullptr) {
+      strings::StrAppend(&error_string, ": ", stream.msg);
+    }
+  }
+  deflateEnd(&stream);
+  if (!error_string.empty()) {
+    return errors::DataLoss(error_string);
+  }
+  return OkStatus();
+}
+
+Status ParallelZlibOutputBuffer::WriteBlocks(size_t max_pending) {
+  TF_RETURN_IF_ERROR(status_);
+  while (!pending_.empty()) {
+    std::shared_ptr<Block> block = pending_.front();
+    {
+      mutex_lock l(mu_);
+      if (!block->done && pending_.size() <= max_pending) break;
+      while (!block->done) {
+        block_done_.wait(l);
+      }
+    }
+    pending_.pop_front();
+    status_ = block->status;
+    if (status_.ok() && !header_written_) {
+      status_ = file_->Append(Header());
+      header_written_ = true;
+    }
+    if (status_.ok()) {
+      status_ = file_->Append(block->output);
+    }
+    TF_RETURN_IF_ERROR(status_);
+    if (wrapper_ == Wrapper::kZlib) {
+      check_ = adler32_combine(check_, block->check, block->input.size());
+    } else if (wrapper_ == Wrapper::kGzip) {
+      check_ = crc32_combine(check_, block->check, block->input.size());
+    }
+    total_in_ += block->input.size();
+  }
+  return OkStatus();
+}
+
+string ParallelZlibOutputBuffer::Header() const {
+  if (wrapper_ == Wrapper::kZlib) {
+    // The header of RFC 1950, with the compression level as zlib reports it.
+    const uint8 cmf = Z_DEFLATED | ((raw_window_bits_ - 8) << 4);
+    const int level = zlib_options_.compression_level == Z_DEFAULT_COMPRESSION
+                          ? 6
+                          : zlib_options_.compression_level;
+    uint8 level_flags;
+    if (zlib_options_.compression_strategy >= Z_HUFFMAN_ONLY || level < 2) {
+      level_flags = 0;
+    } else if (level < 6) {
+      level_flags = 1;
+    } else if (level == 6) {
+      level_flags = 2;
+    } else {
+      level_flags = 3;
+    }
+    uint8 flg = level_flags << 6;
+    flg += 31 - (cmf * 256 + flg) % 31;
+    return string({static_cast<char>(cmf), static_cast<char>(flg)});
+  } else if (wrapper_ == Wrapper::kGzip) {
+    // The header of RFC 1952 that deflate() writes by default: no file name,
+    // modification time or extra fields, and an unknown operating system.
+    return string("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+  }
+  return "";
+}
+
+string ParallelZlibOutputBuffer::Trailer() const {
+  if (wrapper_ == Wrapper::kZlib) {
+    // The adler32 checksum, most significant byte first.
+    const uint32 check = check_;
+    return string({static_cast<char>(check >> 24),
+                   static_cast<char>(check >> 16),
+                   static_cast<char>(check >> 8), static_cast<char>(check)});
+  } else if (wrapper_ == Wrapper::kGzip) {
+    // The crc32 checksum and the input size modulo 2^32, least significant
+    // byte first.
+    char trailer[2 * sizeof(uint32)];
+    core::EncodeFixed32(trailer, check_);
+    core::EncodeFixed32(trailer + sizeof(uint32), total_in_);
+    return string(trailer, sizeof(trailer));
+  }
+  return "";
+}
+
+Status ParallelZlibOutputBuffer::Flush() {
+  if (closed_) {
+    return errors::FailedPrecondition("Flush() called after Close()");
+  }
+  TF_RETURN_IF_ERROR(status_);
+  if (!current_->input.empty()) {
+    CompressCurrentBlock(/*last=*/false);
+  }
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  return file_->Flush();
+}
+
+Status ParallelZlibOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ParallelZlibOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ParallelZlibOutputBuffer::Close() {
+  if (closed_) return OkStatus();
+  TF_RETURN_IF_ERROR(status_);
+  CompressCurrentBlock(/*last=*/true);
+  TF_RETURN_IF_ERROR(WriteBlocks(0));
+  closed_ = true;
+  return file_->Append(Trailer());
+}
+
+Status ParallelZlibOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
 }  // namespace io
 }  // namespace tsl
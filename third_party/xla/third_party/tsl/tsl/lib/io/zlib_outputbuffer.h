@@ -18,14 +18,18 @@ limitations under the License.
 
 #include <zlib.h>
 
+#include <deque>
+#include <memory>
 #include <string>
 
 #include "tsl/lib/io/zlib_compression_options.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/macros.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -153,6 +157,129 @@ class ZlibOutputBuffer : public WritableFile {
   void operator=(const ZlibOutputBuffer&) = delete;
 };
 
+// Provides support for writing compressed output to file like
+// ZlibOutputBuffer, but compresses blocks of the input on a pool of threads.
+//
+// The input is cut into blocks of `block_bytes`, each of which is deflated on
+// its own into raw deflate data that ends on a byte boundary (as with
+// Z_SYNC_FLUSH). The blocks are written to file in order, after a zlib or gzip
+// header and followed by the checksum of the whole input, as selected by
+// `zlib_options.window_bits`. The output is thus a single deflate stream that
+// ZlibInputStream reads like the output of ZlibOutputBuffer. Each block is
+// primed with the end of the block before it as its dictionary, so matches
+// across blocks are kept.
+//
+// A given instance of a ParallelZlibOutputBuffer is NOT safe for concurrent
+// use by multiple threads.
+class ParallelZlibOutputBuffer : public WritableFile {
+ public:
+  // Create a ParallelZlibOutputBuffer for `file` that compresses blocks of
+  // `block_bytes` on `num_threads` threads. Does not take ownership of `file`.
+  ParallelZlibOutputBuffer(WritableFile* file, int32_t block_bytes,
+                           int num_threads,
+                           const ZlibCompressionOptions& zlib_options);
+
+  ~ParallelZlibOutputBuffer() override;
+
+  // Checks the options. This call is required before any other operation on
+  // the buffer.
+  Status Init();
+
+  // Adds `data` to the current block, which is handed to the pool once full.
+  //
+  // At most 2 * `num_threads` blocks are compressed or waiting to be written
+  // at any time; beyond that, Append() waits for the oldest one.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses the current block and writes all blocks to file.
+  Status Flush() override;
+
+  // Compresses the current block as the last one and writes all blocks and
+  // the trailer to file. This must be called before the destructor to avoid
+  // any data loss.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Compresses the current block, writes all blocks to file and syncs it.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64_t* position) override;
+
+ private:
+  struct Block {
+    string input;
+    // The input preceding `input`, up to a window of it.
+    string dictionary;
+    string output;
+    // The adler32 (zlib) or crc32 (gzip) checksum of `input`.
+    uLong check = 0;
+    Status status;
+    // Whether the block is compressed; guarded by `mu_`.
+    bool done = false;
+  };
+
+  // The wrapper around the deflate data, as selected by window_bits.
+  enum class Wrapper { kRaw, kZlib, kGzip };
+
+  // Hands the current block to the pool, compressed as the end of the deflate
+  // stream if `last`.
+  void CompressCurrentBlock(bool last);
+
+  // Deflates `block->input` into `block->output`.
+  Status Deflate(bool last, Block* block) const;
+
+  // Writes the compressed blocks to file, in order, until at most
+  // `max_pending` blocks remain. Returns (and keeps) the first error.
+  Status WriteBlocks(size_t max_pending);
+
+  // Returns the zlib or gzip header.
+  string Header() const;
+
+  // Returns the zlib or gzip trailer, for the blocks written so far.
+  string Trailer() const;
+
+  WritableFile* file_;  // Not owned
+  const size_t block_bytes_;
+  const int num_threads_;
+  ZlibCompressionOptions const zlib_options_;
+  Wrapper wrapper_ = Wrapper::kZlib;
+  // The window_bits of the raw deflate data of each block.
+  int raw_window_bits_ = MAX_WBITS;
+
+  Status status_;
+  bool header_written_ = false;
+  bool closed_ = false;
+  // The checksum and size of the input of the blocks written so far.
+  uLong check_ = 0;
+  uint64 total_in_ = 0;
+
+  std::unique_ptr<Block> current_;
+  // The last window of the input of the block handed to the pool last.
+  string history_;
+  // The blocks handed to the pool, in order.
+  std::deque<std::shared_ptr<Block>> pending_;
+
+  mutex mu_;
+  condition_variable block_done_;
+
+  // Declared last, so that its threads are joined before the rest is freed.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  ParallelZlibOutputBuffer(const ParallelZlibOutputBuffer&) = delete;
+  void operator=(const ParallelZlibOutputBuffer&) = delete;
+};
+
 }  // namespace io
 }  // namespace tsl
 
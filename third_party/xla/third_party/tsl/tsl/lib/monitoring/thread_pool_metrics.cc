@@ -0,0 +1,145 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Exports the statistics of the thread pools created with
+// ThreadPool::Options::collect_stats as metrics, labeled by pool name. The
+// statistics of the pools which share a name are summed. Linking this library
+// registers the metrics.
+
+#include <array>
+#include <cfloat>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "tsl/lib/monitoring/collection_registry.h"
+#include "tsl/lib/monitoring/metric_def.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/protobuf/histogram.pb.h"
+
+namespace tsl {
+namespace monitoring {
+namespace {
+
+using thread::ThreadPool;
+
+template <MetricKind kind, typename Value>
+using PoolMetricDef = MetricDef<kind, Value, /*NumLabels=*/1>;
+
+// Returns the summed statistics of the pools, by name.
+std::map<std::string, ThreadPool::Stats> CollectPoolStats() {
+  std::map<std::string, ThreadPool::Stats> pool_stats;
+  ThreadPool::ForEachPoolStats(
+      [&pool_stats](const std::string& name, const ThreadPool::Stats& stats) {
+        ThreadPool::Stats& sum = pool_stats[name];
+        sum.tasks_scheduled += stats.tasks_scheduled;
+        sum.tasks_executed += stats.tasks_executed;
+        sum.queue_length += stats.queue_length;
+        sum.stealable_tasks += stats.stealable_tasks;
+        sum.stolen_tasks += stats.stolen_tasks;
+        for (int i = 0; i < ThreadPool::kNumLatencyBuckets; ++i) {
+          sum.wakeup_latency_us[i] += stats.wakeup_latency_us[i];
+        }
+        sum.total_wakeup_latency_us += stats.total_wakeup_latency_us;
+      });
+  return pool_stats;
+}
+
+HistogramProto WakeupLatencyHistogram(const ThreadPool::Stats& stats) {
+  HistogramProto histogram;
+  for (int i = 0; i < ThreadPool::kNumLatencyBuckets; ++i) {
+    histogram.add_bucket_limit(i + 1 < ThreadPool::kNumLatencyBuckets
+                                   ? static_cast<double>(int64_t{1} << i)
+                                   : DBL_MAX);
+    histogram.add_bucket(stats.wakeup_latency_us[i]);
+    histogram.set_num(histogram.num() + stats.wakeup_latency_us[i]);
+  }
+  histogram.set_sum(stats.total_wakeup_latency_us);
+  return histogram;
+}
+
+// Registers an int64 metric whose value for each pool is "value".
+template <MetricKind kind>
+class PoolInt64Metric {
+ public:
+  PoolInt64Metric(
+      const char* name, const char* description,
+      std::function<int64_t(const ThreadPool::Stats& stats)> value)
+      : metric_def_(name, description, "pool"),
+        registration_handle_(CollectionRegistry::Default()->Register(
+            &metric_def_, [this, value](MetricCollectorGetter getter) {
+              auto collector = getter.Get(&metric_def_);
+              for (const auto& pool : CollectPoolStats()) {
+                collector.CollectValue({pool.first}, value(pool.second));
+              }
+            })) {}
+
+ private:
+  const PoolMetricDef<kind, int64_t> metric_def_;
+  const std::unique_ptr<CollectionRegistry::RegistrationHandle>
+      registration_handle_;
+};
+
+class WakeupLatencyMetric {
+ public:
+  WakeupLatencyMetric()
+      : metric_def_("/tensorflow/core/thread_pool/wakeup_latency_us",
+                    "The time between the scheduling and the start of the "
+                    "tasks of a thread pool, in microseconds.",
+                    "pool"),
+        registration_handle_(CollectionRegistry::Default()->Register(
+            &metric_def_, [this](MetricCollectorGetter getter) {
+              auto collector = getter.Get(&metric_def_);
+              for (const auto& pool : CollectPoolStats()) {
+                collector.CollectValue({pool.first},
+                                       WakeupLatencyHistogram(pool.second));
+              }
+            })) {}
+
+ private:
+  const PoolMetricDef<MetricKind::kCumulative, HistogramProto> metric_def_;
+  const std::unique_ptr<CollectionRegistry::RegistrationHandle>
+      registration_handle_;
+};
+
+// The metrics are never unregistered.
+const bool kRegistered = []() {
+  new PoolInt64Metric<MetricKind::kGauge>(
+      "/tensorflow/core/thread_pool/queue_length",
+      "The number of tasks of a thread pool which haven't started yet.",
+      [](const ThreadPool::Stats& stats) { return stats.queue_length; });
+  new PoolInt64Metric<MetricKind::kCumulative>(
+      "/tensorflow/core/thread_pool/tasks_executed",
+      "The number of tasks a thread pool ran.",
+      [](const ThreadPool::Stats& stats) { return stats.tasks_executed; });
+  new PoolInt64Metric<MetricKind::kCumulative>(
+      "/tensorflow/core/thread_pool/stealable_tasks",
+      "The number of tasks scheduled by the threads of a thread pool into "
+      "their own queue, which the other threads can steal.",
+      [](const ThreadPool::Stats& stats) { return stats.stealable_tasks; });
+  new PoolInt64Metric<MetricKind::kCumulative>(
+      "/tensorflow/core/thread_pool/stolen_tasks",
+      "The number of stealable tasks of a thread pool which another thread "
+      "ran.",
+      [](const ThreadPool::Stats& stats) { return stats.stolen_tasks; });
+  new WakeupLatencyMetric();
+  return true;
+}();
+
+}  // namespace
+}  // namespace monitoring
+}  // namespace tsl
@@ -69,6 +69,36 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that Fill returns the same samples as calling the
+// generator, including when the counter carries into its higher words.
+TEST(PhiloxRandomTest, FillMatchTest) {
+  constexpr int count = 1000;
+
+  PhiloxRandom::ResultType counter;
+  counter[0] = 0xFFFFFF00u;
+  counter[1] = 0xFFFFFFFFu;
+  counter[2] = 0xFFFFFFFFu;
+  counter[3] = 7;
+  const uint64 test_seed = GetTestSeed();
+  PhiloxRandom::Key key;
+  key[0] = static_cast<uint32>(test_seed);
+  key[1] = static_cast<uint32>(test_seed >> 32);
+
+  PhiloxRandom gen1(counter, key);
+  std::vector<PhiloxRandom::ResultType> v1(count);
+  gen1.Fill(v1.data(), count);
+
+  PhiloxRandom gen2(counter, key);
+  for (int i = 0; i < count; ++i) {
+    const PhiloxRandom::ResultType v2 = gen2();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(v1[i][j], v2[j]);
+    }
+  }
+  // Both generators must continue from the same counter.
+  EXPECT_EQ(gen1()[0], gen2()[0]);
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
@@ -0,0 +1,313 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/file_statistics.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/path.h"
+
+namespace tsl {
+
+namespace {
+
+constexpr char kBlockSuffix[] = ".blk";
+constexpr char kTemporarySuffix[] = ".tmp";
+
+// Temporary files older than this were left behind by writers that died, and
+// are removed when the cache is trimmed.
+constexpr int64_t kTemporaryFileMaxAgeNsec = 3600LL * 1000 * 1000 * 1000;
+
+}  // namespace
+
+DiskFileBlockCache::DiskFileBlockCache(size_t block_size, size_t max_bytes,
+                                       const string& cache_dir,
+                                       BlockFetcher block_fetcher, Env* env)
+    : block_size_(block_size),
+      max_bytes_(max_bytes),
+      cache_dir_(cache_dir),
+      block_fetcher_(block_fetcher),
+      env_(env) {
+  if (IsCacheEnabled()) {
+    Status status = env_->RecursivelyCreateDir(cache_dir_);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to create the block cache directory "
+                   << cache_dir_ << ": " << status;
+    }
+    Trim();
+  }
+  VLOG(1) << "Disk file block cache in " << cache_dir_ << " is "
+          << (IsCacheEnabled() ? "enabled" : "disabled");
+}
+
+string DiskFileBlockCache::FilePathPrefix(const string& filename) const {
+  const Fprint128 fingerprint = Fingerprint128(filename);
+  return io::JoinPath(
+      cache_dir_, absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                               absl::Hex(fingerprint.low64, absl::kZeroPad16),
+                               "-"));
+}
+
+string DiskFileBlockCache::BlockPath(const string& filename,
+                                     int64_t file_signature,
+                                     size_t offset) const {
+  return absl::StrCat(FilePathPrefix(filename), file_signature, "-", offset,
+                      kBlockSuffix);
+}
+
+Status DiskFileBlockCache::ReadBlockFile(const string& path,
+                                         std::vector<char>* data) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(path, &file));
+  data->resize(block_size_);
+  StringPiece result;
+  Status status = file->Read(0, block_size_, &result, data->data());
+  // Blocks at the end of a file are shorter.
+  if (!status.ok() && !errors::IsOutOfRange(status)) return status;
+  if (result.data() != data->data()) {
+    memmove(data->data(), result.data(), result.size());
+  }
+  data->resize(result.size());
+  return OkStatus();
+}
+
+void DiskFileBlockCache::WriteBlockFile(const string& path,
+                                        const std::vector<char>& data) {
+  // Renaming the complete block into place keeps readers in other processes
+  // from seeing part of it.
+  string temporary_path = absl::StrCat(path, ".");
+  if (!env_->CreateUniqueFileName(&temporary_path, kTemporarySuffix)) {
+    LOG(WARNING) << "Failed to create a unique temporary name for " << path;
+    return;
+  }
+  Status status = [&]() -> Status {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(temporary_path, &file));
+    TF_RETURN_IF_ERROR(file->Append(StringPiece(data.data(), data.size())));
+    TF_RETURN_IF_ERROR(file->Close());
+    return env_->RenameFile(temporary_path, path);
+  }();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write cached block " << path << ": " << status;
+    env_->DeleteFile(temporary_path).IgnoreError();
+    return;
+  }
+  bool trim;
+  {
+    mutex_lock lock(mu_);
+    cache_size_ += data.size();
+    trim = cache_size_ > max_bytes_ && !trimming_;
+  }
+  if (trim) Trim();
+}
+
+Status DiskFileBlockCache::LoadBlock(const string& filename,
+                                     int64_t file_signature, size_t offset,
+                                     std::vector<char>* data) {
+  const string path = BlockPath(filename, file_signature, offset);
+  Status status = ReadBlockFile(path, data);
+  if (status.ok()) {
+    if (cache_stats_ != nullptr) {
+      cache_stats_->RecordCacheHitBlockSize(data->size());
+    }
+    return OkStatus();
+  }
+  if (!errors::IsNotFound(status)) {
+    LOG(WARNING) << "Failed to read cached block " << path << ": " << status;
+  }
+
+  data->clear();
+  data->resize(block_size_, 0);
+  size_t bytes_transferred;
+  TF_RETURN_IF_ERROR(block_fetcher_(filename, offset, block_size_,
+                                    data->data(), &bytes_transferred));
+  if (cache_stats_ != nullptr) {
+    cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
+  }
+  data->resize(bytes_transferred);
+  WriteBlockFile(path, *data);
+  return OkStatus();
+}
+
+Status DiskFileBlockCache::Read(const string& filename, size_t offset,
+                                size_t n, char* buffer,
+                                size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  if (n == 0) {
+    return OkStatus();
+  }
+  int64_t file_signature;
+  bool has_file_signature = false;
+  {
+    mutex_lock lock(mu_);
+    auto it = file_signature_map_.find(filename);
+    if (it != file_signature_map_.end()) {
+      file_signature = it->second;
+      has_file_signature = true;
+    }
+  }
+  if (!IsCacheEnabled() || n > max_bytes_ || !has_file_signature) {
+    // The cache is effectively disabled, or could serve stale blocks, so we
+    // pass the read through to the fetcher without breaking it up into blocks.
+    return block_fetcher_(filename, offset, n, buffer, bytes_transferred);
+  }
+  // Calculate the block-aligned start and end of the read.
+  size_t start = block_size_ * (offset / block_size_);
+  size_t finish = block_size_ * ((offset + n) / block_size_);
+  if (finish < offset + n) {
+    finish += block_size_;
+  }
+  size_t total_bytes_transferred = 0;
+  std::vector<char> data;
+  // Now iterate through the blocks, reading them one at a time.
+  for (size_t pos = start; pos < finish; pos += block_size_) {
+    TF_RETURN_IF_ERROR(LoadBlock(filename, file_signature, pos, &data));
+    // Copy the relevant portion of the block into the result buffer.
+    if (offset >= pos + data.size()) {
+      // The requested offset is at or beyond the end of the file.
+      *bytes_transferred = total_bytes_transferred;
+      return errors::OutOfRange("EOF at offset ", offset, " in file ", filename,
+                                " at position ", pos, " with data size ",
+                                data.size());
+    }
+    const size_t begin = offset > pos ? offset - pos : 0;
+    const size_t end = std::min(data.size(), offset + n - pos);
+    if (begin < end) {
+      memcpy(&buffer[total_bytes_transferred], &data[begin], end - begin);
+      total_bytes_transferred += end - begin;
+    }
+    if (data.size() < block_size_) {
+      // The block was a partial block and thus signals EOF at its upper bound.
+      break;
+    }
+  }
+  *bytes_transferred = total_bytes_transferred;
+  return OkStatus();
+}
+
+bool DiskFileBlockCache::ValidateAndUpdateFileSignature(
+    const string& filename, int64_t file_signature) {
+  int64_t old_file_signature;
+  {
+    mutex_lock lock(mu_);
+    auto it = file_signature_map_.find(filename);
+    if (it == file_signature_map_.end()) {
+      file_signature_map_[filename] = file_signature;
+      return true;
+    }
+    if (it->second == file_signature) {
+      return true;
+    }
+    old_file_signature = it->second;
+    it->second = file_signature;
+  }
+  // Remove the blocks of the old contents of the file.
+  if (IsCacheEnabled()) {
+    RemoveBlockFiles(
+        absl::StrCat(FilePathPrefix(filename), old_file_signature, "-"));
+  }
+  return false;
+}
+
+void DiskFileBlockCache::RemoveBlockFiles(const string& path_prefix) {
+  std::vector<string> children;
+  if (!env_->GetChildren(cache_dir_, &children).ok()) return;
+  for (const string& child : children) {
+    const string path = io::JoinPath(cache_dir_, child);
+    if (absl::StartsWith(path, path_prefix) &&
+        absl::EndsWith(child, kBlockSuffix)) {
+      // Files may be removed by other processes too.
+      env_->DeleteFile(path).IgnoreError();
+    }
+  }
+}
+
+void DiskFileBlockCache::RemoveFile(const string& filename) {
+  if (IsCacheEnabled()) {
+    RemoveBlockFiles(FilePathPrefix(filename));
+  }
+}
+
+void DiskFileBlockCache::Flush() {
+  if (IsCacheEnabled()) {
+    RemoveBlockFiles(io::JoinPath(cache_dir_, ""));
+  }
+  mutex_lock lock(mu_);
+  cache_size_ = 0;
+}
+
+size_t DiskFileBlockCache::CacheSize() const {
+  mutex_lock lock(mu_);
+  return cache_size_;
+}
+
+void DiskFileBlockCache::Trim() {
+  {
+    mutex_lock lock(mu_);
+    if (trimming_) return;
+    trimming_ = true;
+  }
+  struct BlockFile {
+    int64_t mtime_nsec;
+    string path;
+    size_t size;
+  };
+  std::vector<BlockFile> block_files;
+  size_t total_bytes = 0;
+  std::vector<string> children;
+  if (env_->GetChildren(cache_dir_, &children).ok()) {
+    const int64_t now_nsec = env_->NowNanos();
+    for (const string& child : children) {
+      const string path = io::JoinPath(cache_dir_, child);
+      FileStatistics stat;
+      if (!env_->Stat(path, &stat).ok() || stat.is_directory) continue;
+      if (absl::EndsWith(child, kBlockSuffix)) {
+        block_files.push_back({stat.mtime_nsec, path,
+                               static_cast<size_t>(stat.length)});
+        total_bytes += stat.length;
+      } else if (absl::EndsWith(child, kTemporarySuffix) &&
+                 now_nsec - stat.mtime_nsec > kTemporaryFileMaxAgeNsec) {
+        env_->DeleteFile(path).IgnoreError();
+      }
+    }
+  }
+  if (total_bytes > max_bytes_) {
+    // Remove down to 7/8 of the maximum size, so that the directory is not
+    // listed again on each new block.
+    const size_t target_bytes = max_bytes_ - max_bytes_ / 8;
+    std::sort(block_files.begin(), block_files.end(),
+              [](const BlockFile& a, const BlockFile& b) {
+                return a.mtime_nsec < b.mtime_nsec;
+              });
+    for (const BlockFile& block_file : block_files) {
+      if (total_bytes <= target_bytes) break;
+      env_->DeleteFile(block_file.path).IgnoreError();
+      total_bytes -= block_file.size;
+    }
+  }
+  mutex_lock lock(mu_);
+  cache_size_ = total_bytes;
+  trimming_ = false;
+}
+
+}  // namespace tsl
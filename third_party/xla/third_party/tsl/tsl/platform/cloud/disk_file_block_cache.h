@@ -0,0 +1,141 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+#define TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tsl/platform/cloud/file_block_cache.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+
+/// \brief A block cache of file contents that persists its blocks in a local
+/// directory (e.g. on an SSD), keyed by {filename, file signature, offset}.
+///
+/// Each block is a file in `cache_dir`, which is written under a temporary
+/// name and renamed into place, so that a block is either absent or complete.
+/// The directory can therefore be shared by the processes of a host, and by
+/// processes that restart: a block fetched by one of them is served to all.
+///
+/// Blocks are keyed by the signature of their file (e.g. the generation of a
+/// GCS object), as passed to ValidateAndUpdateFileSignature, so they don't go
+/// stale; reads of files whose signature is unknown bypass the cache.  When the
+/// blocks in the directory grow past `max_bytes`, the blocks that were written
+/// first are removed, by whichever process notices.
+class DiskFileBlockCache : public FileBlockCache {
+ public:
+  DiskFileBlockCache(size_t block_size, size_t max_bytes,
+                     const string& cache_dir, BlockFetcher block_fetcher,
+                     Env* env = Env::Default());
+
+  /// Read `n` bytes from `filename` starting at `offset` into `out`, with the
+  /// same results as RamFileBlockCache::Read.
+  Status Read(const string& filename, size_t offset, size_t n, char* buffer,
+              size_t* bytes_transferred) override;
+
+  // Validate the given file signature with the existing file signature in the
+  // cache. Returns true if the signature doesn't change or the file doesn't
+  // exist before. If the signature changes, update the existing signature with
+  // the new one and remove the blocks of the old one from the cache.
+  bool ValidateAndUpdateFileSignature(const string& filename,
+                                      int64_t file_signature) override
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove all cached blocks for `filename`.
+  void RemoveFile(const string& filename) override;
+
+  /// Remove all cached data.
+  void Flush() override TF_LOCKS_EXCLUDED(mu_);
+
+  /// Accessors for cache parameters.
+  size_t block_size() const override { return block_size_; }
+  size_t max_bytes() const override { return max_bytes_; }
+  uint64 max_staleness() const override { return 0; }
+  const string& cache_dir() const { return cache_dir_; }
+
+  /// The size (in bytes) of the blocks in the cache directory, as last listed
+  /// by this process plus the blocks it wrote since.
+  size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns true if the cache is enabled. If false, the BlockFetcher callback
+  // is always executed during Read.
+  bool IsCacheEnabled() const override {
+    return block_size_ > 0 && max_bytes_ > 0 && !cache_dir_.empty();
+  }
+
+ private:
+  /// Returns the path of the blocks of `filename`, before their signature.
+  string FilePathPrefix(const string& filename) const;
+
+  /// Returns the path of the block at `offset` of `filename`.
+  string BlockPath(const string& filename, int64_t file_signature,
+                   size_t offset) const;
+
+  /// Read the block at `offset` of `filename` into `data`, from the cache
+  /// directory or else from the fetcher.
+  Status LoadBlock(const string& filename, int64_t file_signature,
+                   size_t offset, std::vector<char>* data);
+
+  /// Read the block file at `path` into `data`.
+  Status ReadBlockFile(const string& path, std::vector<char>* data);
+
+  /// Write the block file at `path`.  Failures are logged: the block is
+  /// fetched again next time.
+  void WriteBlockFile(const string& path, const std::vector<char>& data)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove the block files whose path starts with `path_prefix`.
+  void RemoveBlockFiles(const string& path_prefix);
+
+  /// Remove the oldest blocks until the directory is below its maximum size,
+  /// and update cache_size_.
+  void Trim() TF_LOCKS_EXCLUDED(mu_);
+
+  /// The size of the blocks stored in the cache, as well as the size of the
+  /// reads from the underlying filesystem.
+  const size_t block_size_;
+  /// The maximum number of bytes (sum of block sizes) allowed in the cache.
+  const size_t max_bytes_;
+  /// The directory of the block files.
+  const string cache_dir_;
+  /// The callback to read a block from the underlying filesystem.
+  const BlockFetcher block_fetcher_;
+  /// The Env of the cache directory.
+  Env* const env_;  // not owned
+
+  /// Guards the file signatures and cached byte count.
+  mutable mutex mu_;
+
+  /// The combined number of bytes in all of the cached blocks.
+  size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
+
+  /// Whether a thread is trimming the cache.
+  bool trimming_ TF_GUARDED_BY(mu_) = false;
+
+  // A filename->file_signature map.
+  std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_CLOUD_DISK_FILE_BLOCK_CACHE_H_
@@ -0,0 +1,175 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/cloud/disk_file_block_cache.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+constexpr size_t kBlockSize = 16;
+// The contents of every file, of two full blocks and a partial one.
+constexpr size_t kFileSize = 2 * kBlockSize + 4;
+
+Status ReadCache(DiskFileBlockCache* cache, const string& filename,
+                 size_t offset, size_t n, std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status =
+      cache->Read(filename, offset, n, out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
+class DiskFileBlockCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    cache_dir_ = io::JoinPath(
+        testing::TmpDir(),
+        ::testing::UnitTest::GetInstance()->current_test_info()->name());
+  }
+
+  DiskFileBlockCache::BlockFetcher Fetcher() {
+    return [this](const string& filename, size_t offset, size_t n,
+                  char* buffer, size_t* bytes_transferred) {
+      fetches_.push_back(offset);
+      *bytes_transferred =
+          offset < kFileSize ? std::min(n, kFileSize - offset) : 0;
+      for (size_t i = 0; i < *bytes_transferred; ++i) {
+        buffer[i] = 'a' + (offset + i) % 26;
+      }
+      return OkStatus();
+    };
+  }
+
+  int NumBlockFiles() {
+    std::vector<string> children;
+    TF_CHECK_OK(Env::Default()->GetChildren(cache_dir_, &children));
+    int num_block_files = 0;
+    for (const string& child : children) {
+      if (absl::EndsWith(child, ".blk")) ++num_block_files;
+    }
+    return num_block_files;
+  }
+
+  string cache_dir_;
+  std::vector<size_t> fetches_;
+};
+
+TEST_F(DiskFileBlockCacheTest, IsCacheEnabled) {
+  EXPECT_FALSE(
+      DiskFileBlockCache(0, 64, cache_dir_, Fetcher()).IsCacheEnabled());
+  EXPECT_FALSE(
+      DiskFileBlockCache(16, 0, cache_dir_, Fetcher()).IsCacheEnabled());
+  EXPECT_FALSE(DiskFileBlockCache(16, 64, "", Fetcher()).IsCacheEnabled());
+  EXPECT_TRUE(
+      DiskFileBlockCache(16, 64, cache_dir_, Fetcher()).IsCacheEnabled());
+}
+
+TEST_F(DiskFileBlockCacheTest, SharesBlocksAcrossCaches) {
+  std::vector<char> out;
+  {
+    DiskFileBlockCache cache(kBlockSize, 64 * kBlockSize, cache_dir_,
+                             Fetcher());
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 4, kBlockSize, &out));
+    EXPECT_EQ(string(out.begin(), out.end()), "efghijklmnopqrst");
+    EXPECT_EQ(fetches_, std::vector<size_t>({0, kBlockSize}));
+    EXPECT_EQ(cache.CacheSize(), 2 * kBlockSize);
+  }
+  // Another cache on the same directory, e.g. of a restarted process, reads
+  // the same blocks without fetching them.
+  DiskFileBlockCache cache(kBlockSize, 64 * kBlockSize, cache_dir_, Fetcher());
+  EXPECT_EQ(cache.CacheSize(), 2 * kBlockSize);
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, kFileSize, &out));
+  EXPECT_EQ(out.size(), kFileSize);
+  EXPECT_EQ(string(out.begin(), out.begin() + 4), "abcd");
+  EXPECT_EQ(fetches_, std::vector<size_t>({0, kBlockSize, 2 * kBlockSize}));
+
+  // The partial block at the end of the file is cached too.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 2 * kBlockSize, kBlockSize, &out));
+  EXPECT_EQ(out.size(), 4);
+  EXPECT_TRUE(errors::IsOutOfRange(
+      ReadCache(&cache, "a", kFileSize + 1, kBlockSize, &out)));
+  EXPECT_EQ(fetches_, std::vector<size_t>({0, kBlockSize, 2 * kBlockSize}));
+}
+
+TEST_F(DiskFileBlockCacheTest, KeysBlocksBySignature) {
+  DiskFileBlockCache cache(kBlockSize, 64 * kBlockSize, cache_dir_, Fetcher());
+  std::vector<char> out;
+  // Files without a signature are not cached.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 2, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 2, &out));
+  EXPECT_EQ(fetches_, std::vector<size_t>({4, 4}));
+  EXPECT_EQ(NumBlockFiles(), 0);
+
+  fetches_.clear();
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 2, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 2, &out));
+  EXPECT_EQ(fetches_, std::vector<size_t>({0}));
+  EXPECT_EQ(NumBlockFiles(), 1);
+
+  // New contents of the file replace the blocks of the old ones.
+  EXPECT_FALSE(cache.ValidateAndUpdateFileSignature("a", 2));
+  EXPECT_EQ(NumBlockFiles(), 0);
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 2, &out));
+  EXPECT_EQ(fetches_, std::vector<size_t>({0, 0}));
+  EXPECT_EQ(NumBlockFiles(), 1);
+}
+
+TEST_F(DiskFileBlockCacheTest, RemoveFileAndFlush) {
+  DiskFileBlockCache cache(kBlockSize, 64 * kBlockSize, cache_dir_, Fetcher());
+  std::vector<char> out;
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("a", 1));
+  EXPECT_TRUE(cache.ValidateAndUpdateFileSignature("b", 1));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, kFileSize, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "b", 0, kFileSize, &out));
+  EXPECT_EQ(NumBlockFiles(), 6);
+  cache.RemoveFile("a");
+  EXPECT_EQ(NumBlockFiles(), 3);
+  cache.Flush();
+  EXPECT_EQ(NumBlockFiles(), 0);
+  EXPECT_EQ(cache.CacheSize(), 0);
+}
+
+TEST_F(DiskFileBlockCacheTest, Trim) {
+  DiskFileBlockCache cache(kBlockSize, 4 * kBlockSize, cache_dir_, Fetcher());
+  std::vector<char> out;
+  for (int i = 0; i < 4; ++i) {
+    const string filename = absl::StrCat("file-", i);
+    EXPECT_TRUE(cache.ValidateAndUpdateFileSignature(filename, 1));
+    TF_EXPECT_OK(ReadCache(&cache, filename, 0, 2 * kBlockSize, &out));
+    EXPECT_LE(cache.CacheSize(), 4 * kBlockSize);
+  }
+  EXPECT_LE(NumBlockFiles(), 4);
+}
+
+}  // namespace
+}  // namespace tsl
@@ -42,6 +42,7 @@ limitations under the License.
 #include "absl/base/macros.h"
 #include "json/json.h"
 #include "tsl/platform/cloud/curl_http_request.h"
+#include "tsl/platform/cloud/disk_file_block_cache.h"
 #include "tsl/platform/cloud/file_block_cache.h"
 #include "tsl/platform/cloud/google_auth_provider.h"
 #include "tsl/platform/cloud/ram_file_block_cache.h"
@@ -849,12 +850,20 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+  if (GetEnvVar(kMaxReadAheadBlocks, strings::safe_strtou64, &value)) {
+    max_read_ahead_blocks_ = value;
+  }
+  StringPiece disk_cache_dir;
+  if (GetEnvVar(kDiskCacheDir, StringPieceIdentity, &disk_cache_dir)) {
+    disk_cache_dir_ = string(disk_cache_dir);
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "max read-ahead blocks = " << max_read_ahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -1078,13 +1087,21 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
-  std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
-      block_size, max_bytes, max_staleness,
-      [this](const string& filename, size_t offset, size_t n, char* buffer,
-             size_t* bytes_transferred) {
-        return LoadBufferFromGCS(filename, offset, n, buffer,
-                                 bytes_transferred);
-      }));
+  auto fetcher = [this](const string& filename, size_t offset, size_t n,
+                        char* buffer, size_t* bytes_transferred) {
+    return LoadBufferFromGCS(filename, offset, n, buffer, bytes_transferred);
+  };
+  std::unique_ptr<FileBlockCache> file_block_cache;
+  if (!disk_cache_dir_.empty()) {
+    // Blocks on disk are keyed by the generation of their object, so they
+    // don't go stale.
+    file_block_cache = std::make_unique<DiskFileBlockCache>(
+        block_size, max_bytes, disk_cache_dir_, fetcher);
+  } else {
+    file_block_cache = std::make_unique<RamFileBlockCache>(
+        block_size, max_bytes, max_staleness, fetcher, Env::Default(),
+        max_read_ahead_blocks_);
+  }
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -1691,10 +1708,29 @@ Status GcsFileSystem::GetMatchingPaths(const string& pattern,
           return errors::InvalidArgument(
               "A GCS pattern doesn't have a bucket name: ", pattern);
         }
+        // Only the children of `dir` that start with the rest of the fixed
+        // prefix can match. If the pattern has no further levels, only the
+        // immediate children can match, so we let GCS group the objects of
+        // subfolders into their folder instead of listing them all.
+        StringPiece name_prefix(fixed_prefix);
+        if (!absl::ConsumePrefix(&name_prefix, dir)) {
+          name_prefix = "";
+        }
+        absl::ConsumePrefix(&name_prefix, "/");
+        const bool recursively =
+            pattern.find('/', fixed_prefix.size()) != string::npos;
         std::vector<string> all_files;
-        TF_RETURN_IF_ERROR(GetChildrenBounded(
-            dir, UINT64_MAX, &all_files, true /* recursively */,
+        TF_RETURN_IF_ERROR(GetChildrenWithPrefix(
+            dir, string(name_prefix), UINT64_MAX, &all_files, recursively,
             false /* include_self_directory_marker */));
+        if (!recursively) {
+          // Subfolders are listed with a trailing `/`.
+          for (string& file : all_files) {
+            if (str_util::EndsWith(file, "/")) file.pop_back();
+          }
+          all_files.erase(std::remove(all_files.begin(), all_files.end(), ""),
+                          all_files.end());
+        }
 
         const auto& files_and_folders = AddAllSubpaths(all_files);
 
@@ -1727,6 +1763,14 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
                                          std::vector<string>* result,
                                          bool recursive,
                                          bool include_self_directory_marker) {
+  return GetChildrenWithPrefix(dirname, "", max_results, result, recursive,
+                               include_self_directory_marker);
+}
+
+Status GcsFileSystem::GetChildrenWithPrefix(
+    const string& dirname, const string& name_prefix, uint64 max_results,
+    std::vector<string>* result, bool recursive,
+    bool include_self_directory_marker) {
   if (!result) {
     return errors::InvalidArgument("'result' cannot be null");
   }
@@ -1750,9 +1794,10 @@ Status GcsFileSystem::GetChildrenBounded(const string& dirname,
                             "?fields=items%2Fname%2Cprefixes%2CnextPageToken");
       uri = strings::StrCat(uri, "&delimiter=%2F");
     }
-    if (!object_prefix.empty()) {
-      uri = strings::StrCat(uri,
-                            "&prefix=", request->EscapeString(object_prefix));
+    if (!object_prefix.empty() || !name_prefix.empty()) {
+      uri = strings::StrCat(
+          uri, "&prefix=",
+          request->EscapeString(strings::StrCat(object_prefix, name_prefix)));
     }
     if (!nextPageToken.empty()) {
       uri = strings::StrCat(
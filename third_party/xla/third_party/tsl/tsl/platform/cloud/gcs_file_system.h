@@ -62,6 +62,16 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that enables reading ahead of sequential reads, and
+// sets the maximum number of blocks fetched ahead at once. Read-ahead needs the
+// block cache, and its blocks in flight take at most half of the cache.
+constexpr char kMaxReadAheadBlocks[] = "GCS_READ_CACHE_MAX_READ_AHEAD_BLOCKS";
+constexpr size_t kDefaultMaxReadAheadBlocks = 0;
+// The environment variable that sets a local directory, e.g. on an SSD, that
+// keeps the blocks of the cache instead of RAM. The directory is shared with
+// the other processes that use it. GCS_READ_CACHE_MAX_SIZE_MB then bounds the
+// size of the directory.
+constexpr char kDiskCacheDir[] = "GCS_READ_CACHE_DISK_DIR";
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -394,6 +404,16 @@ class GcsFileSystem : public FileSystem {
                             std::vector<string>* result, bool recursively,
                             bool include_self_directory_marker);
 
+  /// \brief Like GetChildrenBounded, but only lists the children whose names,
+  /// relative to 'dir', start with 'name_prefix'.
+  ///
+  /// The prefix is passed on to GCS, so that the other children are not
+  /// listed at all.
+  Status GetChildrenWithPrefix(const string& dir, const string& name_prefix,
+                               uint64 max_results, std::vector<string>* result,
+                               bool recursively,
+                               bool include_self_directory_marker);
+
   /// Retrieves file statistics assuming fname points to a GCS object. The data
   /// may be read from cache or from GCS directly.
   Status StatForObject(const string& fname, const string& bucket,
@@ -415,6 +435,13 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of blocks that the block cache fetches ahead of
+  // sequential reads.
+  size_t max_read_ahead_blocks_ = kDefaultMaxReadAheadBlocks;
+
+  // The directory of the blocks of the block cache, if they are kept on disk.
+  string disk_cache_dir_;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -1924,7 +1924,8 @@ TEST(GcsFileSystemTest, GetChildren_Pagination) {
 TEST(GcsFileSystemTest, GetMatchingPaths_NoWildcard) {
   std::vector<HttpRequest*> requests({new FakeHttpRequest(
       "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-      "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+      "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F"
+      "&prefix=path%2Fsubpath%2Ffile2.txt\n"
       "Auth Token: fake_token\n"
       "Timeouts: 5 1 10\n",
       "{\"items\": [ "
@@ -2007,7 +2008,8 @@ TEST(GcsFileSystemTest, GetMatchingPaths_FolderAndWildcard_Matches) {
 TEST(GcsFileSystemTest, GetMatchingPaths_SelfDirectoryMarker) {
   std::vector<HttpRequest*> requests({new FakeHttpRequest(
       "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-      "fields=items%2Fname%2CnextPageToken&prefix=path%2F\n"
+      "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F"
+      "&prefix=path%2F\n"
       "Auth Token: fake_token\n"
       "Timeouts: 5 1 10\n",
       "{\"items\": [ "
@@ -2032,12 +2034,13 @@ TEST(GcsFileSystemTest, GetMatchingPaths_SelfDirectoryMarker) {
 TEST(GcsFileSystemTest, GetMatchingPaths_SlashInObjectName) {
   std::vector<HttpRequest*> requests({new FakeHttpRequest(
       "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-      "fields=items%2Fname%2CnextPageToken&prefix=path%2F\n"
+      "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F"
+      "&prefix=path%2F\n"
       "Auth Token: fake_token\n"
       "Timeouts: 5 1 10\n",
       "{\"items\": [ "
-      "  { \"name\": \"path/\" },"
-      "  { \"name\": \"path//foo.txt\" }]}")});
+      "  { \"name\": \"path/\" }"
+      "  ], \"prefixes\": [\"path//\"]}")});
   GcsFileSystem fs(
       std::unique_ptr<AuthProvider>(new FakeAuthProvider),
       std::unique_ptr<HttpRequest::Factory>(
@@ -2106,6 +2109,36 @@ TEST(GcsFileSystemTest, GetMatchingPaths_FolderAndWildcard_NoMatches) {
   EXPECT_EQ(std::vector<string>(), result);
 }
 
+TEST(GcsFileSystemTest, GetMatchingPaths_FilePrefixAndWildcard) {
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
+      "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F"
+      "&prefix=path%2Ffile\n"
+      "Auth Token: fake_token\n"
+      "Timeouts: 5 1 10\n",
+      "{\"items\": [ "
+      "  { \"name\": \"path/file1.txt\" },"
+      "  { \"name\": \"path/file3.txt\" }],"
+      "\"prefixes\": [\"path/files/\"]}")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+
+  std::vector<string> result;
+  TF_EXPECT_OK(fs.GetMatchingPaths("gs://bucket/path/file*", nullptr, &result));
+  EXPECT_EQ(std::vector<string>({"gs://bucket/path/file1.txt",
+                                 "gs://bucket/path/file3.txt",
+                                 "gs://bucket/path/files"}),
+            result);
+}
+
 TEST(GcsFileSystemTest, GetMatchingPaths_OnlyWildcard) {
   std::vector<HttpRequest*> requests;
   GcsFileSystem fs(
@@ -2128,7 +2161,8 @@ TEST(GcsFileSystemTest, GetMatchingPaths_Cache) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
            "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+           "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F"
+           "&prefix=path%2Fsubpath%2Ffile2.txt\n"
            "Auth Token: fake_token\n"
            "Timeouts: 5 1 10\n",
            "{\"items\": [ "
@@ -2173,14 +2207,16 @@ TEST(GcsFileSystemTest, GetMatchingPaths_Cache_Flush) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
            "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+           "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F"
+           "&prefix=path%2Fsubpath%2Ffile2.txt\n"
            "Auth Token: fake_token\n"
            "Timeouts: 5 1 10\n",
            "{\"items\": [ "
            "  { \"name\": \"path/subpath/file2.txt\" }]}"),
        new FakeHttpRequest(
            "Uri: https://www.googleapis.com/storage/v1/b/bucket/o?"
-           "fields=items%2Fname%2CnextPageToken&prefix=path%2Fsubpath%2F\n"
+           "fields=items%2Fname%2Cprefixes%2CnextPageToken&delimiter=%2F"
+           "&prefix=path%2Fsubpath%2Ffile2.txt\n"
            "Auth Token: fake_token\n"
            "Timeouts: 5 1 10\n",
            "{\"items\": [ "
@@ -15,14 +15,24 @@ limitations under the License.
 
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "tsl/platform/env.h"
 
 namespace tsl {
 
+namespace {
+
+// The maximum number of files whose read-ahead state is kept.
+constexpr size_t kMaxReadAheadFiles = 1024;
+
+}  // namespace
+
 bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
   if (block->state != FetchState::FINISHED) {
@@ -33,21 +43,28 @@ bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
 }
 
 std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
-    const Key& key) {
+    const Key& key, bool* read_ahead) {
   mutex_lock lock(mu_);
+  *read_ahead = false;
   auto entry = block_map_.find(key);
   if (entry != block_map_.end()) {
     if (BlockNotStale(entry->second)) {
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
       }
+      *read_ahead = entry->second->read_ahead;
+      entry->second->read_ahead = false;
       return entry->second;
     } else {
       // Remove the stale block and continue.
       RemoveFile_Locked(key.first);
     }
   }
+  return AddBlock_Locked(key);
+}
 
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::AddBlock_Locked(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -88,8 +105,12 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
   if (block->data.size() < block_size_) {
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
     auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
+    // Blocks that were read ahead, and not read since, may lie past the end of
+    // the file.
+    while (fcmp != block_map_.begin() && key < (--fcmp)->first) {
+      if (!fcmp->second->read_ahead) {
+        return errors::Internal("Block cache contents are inconsistent.");
+      }
     }
   }
 
@@ -185,13 +206,23 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     finish += block_size_;
   }
   size_t total_bytes_transferred = 0;
+  size_t ready_blocks = 0;
+  bool stalled = false;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
     Key key = std::make_pair(filename, pos);
     // Look up the block, fetching and inserting it if necessary, and update the
     // LRU iterator for the key and block.
-    std::shared_ptr<Block> block = Lookup(key);
+    bool read_ahead;
+    std::shared_ptr<Block> block = Lookup(key, &read_ahead);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
+    if (read_ahead_pool_ != nullptr) {
+      if (!IsFetched(block)) {
+        stalled = true;
+      } else if (read_ahead) {
+        ++ready_blocks;
+      }
+    }
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
@@ -222,13 +253,102 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     }
     if (data.size() < block_size_) {
       // The block was a partial block and thus signals EOF at its upper bound.
-      break;
+      if (read_ahead_pool_ != nullptr) {
+        mutex_lock lock(mu_);
+        read_ahead_states_.erase(filename);
+      }
+      *bytes_transferred = total_bytes_transferred;
+      return OkStatus();
     }
   }
   *bytes_transferred = total_bytes_transferred;
+  if (read_ahead_pool_ != nullptr) {
+    ReadAhead(filename, offset, n, ready_blocks, stalled);
+  }
   return OkStatus();
 }
 
+bool RamFileBlockCache::IsFetched(const std::shared_ptr<Block>& block) {
+  mutex_lock l(block->mu);
+  return block->state == FetchState::FINISHED;
+}
+
+void RamFileBlockCache::ReadAhead(const string& filename, size_t offset,
+                                  size_t n, size_t ready_blocks, bool stalled) {
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> fetches;
+  {
+    mutex_lock lock(mu_);
+    // Files that are not read to the end leave their state behind, so the
+    // states are dropped once there are many of them.
+    if (read_ahead_states_.size() >= kMaxReadAheadFiles &&
+        read_ahead_states_.find(filename) == read_ahead_states_.end()) {
+      read_ahead_states_.clear();
+    }
+    ReadAheadState& state = read_ahead_states_[filename];
+    const bool sequential = offset == state.next_offset;
+    state.next_offset = offset + n;
+    if (!sequential) {
+      state.window = 0;
+      state.ready_blocks = 0;
+      state.done = false;
+      return;
+    }
+    if (state.window == 0) {
+      state.window = 1;
+    } else if (stalled) {
+      // The reader caught up with the fetches: keep more in flight.
+      state.window = std::min(2 * state.window, max_read_ahead_blocks_);
+      state.ready_blocks = 0;
+    } else if ((state.ready_blocks += ready_blocks) >= 2 * state.window) {
+      // The fetches stay well ahead of the reader: try with fewer.
+      state.window = std::max<size_t>(1, state.window - 1);
+      state.ready_blocks = 0;
+    }
+    if (state.done) return;
+
+    // The first block that starts at or after the end of the read.
+    const size_t first =
+        block_size_ * ((offset + n + block_size_ - 1) / block_size_);
+    for (size_t i = 0; i < state.window; ++i) {
+      if (num_read_ahead_fetches_ >= max_read_ahead_blocks_) break;
+      Key key = std::make_pair(filename, first + i * block_size_);
+      if (block_map_.find(key) != block_map_.end()) continue;
+      std::shared_ptr<Block> block = AddBlock_Locked(key);
+      block->read_ahead = true;
+      ++num_read_ahead_fetches_;
+      fetches.emplace_back(std::move(key), std::move(block));
+    }
+  }
+  for (auto& fetch : fetches) {
+    read_ahead_pool_->Schedule([this, fetch = std::move(fetch)]() {
+      FetchAhead(fetch.first, fetch.second);
+    });
+  }
+}
+
+void RamFileBlockCache::FetchAhead(const Key& key,
+                                   const std::shared_ptr<Block>& block) {
+  const Status status = MaybeFetch(key, block);
+  mutex_lock lock(mu_);
+  --num_read_ahead_fetches_;
+  if (!status.ok() || block->data.size() < block_size_) {
+    // Stop reading ahead at the end of the file, and on errors, which the
+    // reader will get from its own fetch.
+    auto state = read_ahead_states_.find(key.first);
+    if (state != read_ahead_states_.end()) {
+      state->second.done = true;
+    }
+    // Drop the block if it is past the end of the file or failed, unless it
+    // has been read since.
+    auto entry = block_map_.find(key);
+    if (entry != block_map_.end() && entry->second == block &&
+        block->read_ahead && (!status.ok() || block->data.empty())) {
+      RemoveBlock(entry);
+    }
+  }
+  Trim();
+}
+
 bool RamFileBlockCache::ValidateAndUpdateFileSignature(const string& filename,
                                                        int64_t file_signature) {
   mutex_lock lock(mu_);
@@ -273,6 +393,7 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  read_ahead_states_.clear();
   cache_size_ = 0;
 }
 
@@ -282,6 +403,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  read_ahead_states_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
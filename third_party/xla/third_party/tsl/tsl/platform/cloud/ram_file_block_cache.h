@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -38,6 +40,14 @@ namespace tsl {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// If `max_read_ahead_blocks` is positive, the cache detects sequential reads
+/// of a file and fetches the blocks that follow them in the background, with up
+/// to `max_read_ahead_blocks` fetches in flight.  The number of blocks read
+/// ahead of each file starts at one, doubles whenever the reader has to wait
+/// for a block, and shrinks while the fetches stay ahead of the reader.  It is
+/// bounded so that the blocks in flight take at most half of `max_bytes`, and
+/// the blocks read ahead are subject to the LRU limits like any other.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -51,21 +61,33 @@ class RamFileBlockCache : public FileBlockCache {
       BlockFetcher;
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_read_ahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_read_ahead_blocks_(
+            IsCacheEnabled()
+                ? std::min(max_read_ahead_blocks, max_bytes / (2 * block_size))
+                : 0) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (max_read_ahead_blocks_ > 0) {
+      read_ahead_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_read_ahead_FBC", max_read_ahead_blocks_);
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying read_ahead_pool_ will block until the fetches in flight are
+    // done.
+    read_ahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -109,6 +131,7 @@ class RamFileBlockCache : public FileBlockCache {
   size_t block_size() const override { return block_size_; }
   size_t max_bytes() const override { return max_bytes_; }
   uint64 max_staleness() const override { return max_staleness_; }
+  size_t max_read_ahead_blocks() const { return max_read_ahead_blocks_; }
 
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
@@ -131,6 +154,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched ahead of readers at once.
+  const size_t max_read_ahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -175,6 +200,8 @@ class RamFileBlockCache : public FileBlockCache {
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block was read ahead and has not been read since.
+    bool read_ahead = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -188,14 +215,47 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The read-ahead state of a file.
+  struct ReadAheadState {
+    /// The offset at which a sequential read would continue.
+    size_t next_offset = 0;
+    /// The number of blocks to keep fetched ahead of the reader.
+    size_t window = 0;
+    /// The number of blocks read ahead that were ready when the reader got to
+    /// them, since the window last changed.
+    size_t ready_blocks = 0;
+    /// Whether a block read ahead reached the end of the file (or failed).
+    bool done = false;
+  };
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() TF_LOCKS_EXCLUDED(mu_);
 
   bool BlockNotStale(const std::shared_ptr<Block>& block)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
-  /// Look up a Key in the block cache.
-  std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
+  /// Look up a Key in the block cache. Sets `*read_ahead` to whether the block
+  /// was read ahead and not read since.
+  std::shared_ptr<Block> Lookup(const Key& key, bool* read_ahead)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Insert a new empty block for `key`.
+  std::shared_ptr<Block> AddBlock_Locked(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Returns true if the contents of the block have been fetched.
+  bool IsFetched(const std::shared_ptr<Block>& block);
+
+  /// Update the read-ahead window of `filename` after a read of `n` bytes at
+  /// `offset`, and schedule the fetches of the blocks that follow it.
+  /// `ready_blocks` is the number of blocks read ahead that were ready, and
+  /// `stalled` whether any block had to be fetched or waited for.
+  void ReadAhead(const string& filename, size_t offset, size_t n,
+                 size_t ready_blocks, bool stalled) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Fetch a block read ahead, on read_ahead_pool_.
+  void FetchAhead(const Key& key, const std::shared_ptr<Block>& block)
+      TF_LOCKS_EXCLUDED(mu_);
 
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
@@ -221,6 +281,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads that fetch blocks ahead of readers, if read-ahead is enabled.
+  std::unique_ptr<thread::ThreadPool> read_ahead_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -243,6 +306,12 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The read-ahead state of the files being read.
+  std::map<string, ReadAheadState> read_ahead_states_ TF_GUARDED_BY(mu_);
+
+  /// The number of blocks being read ahead.
+  size_t num_read_ahead_fetches_ TF_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace tsl
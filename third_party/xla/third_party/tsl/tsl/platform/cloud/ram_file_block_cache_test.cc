@@ -16,11 +16,13 @@ limitations under the License.
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
 #include <cstring>
+#include <map>
 
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/cloud/now_seconds_env.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/notification.h"
 #include "tsl/platform/test.h"
 
@@ -566,5 +568,70 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, ReadAhead) {
+  // A file of eight full blocks and a partial one.
+  const size_t block_size = 16;
+  const size_t file_size = 8 * block_size + 4;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      fetches[offset]++;
+    }
+    *bytes_transferred = offset < file_size ? std::min(n, file_size - offset)
+                                            : 0;
+    memset(buffer, 'x', *bytes_transferred);
+    return OkStatus();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), /*max_read_ahead_blocks=*/4);
+    EXPECT_EQ(cache.max_read_ahead_blocks(), 4);
+    // Sequential reads go through the whole file, past the blocks that were
+    // read ahead of them, whether or not they are fetched yet.
+    std::vector<char> out;
+    size_t total = 0;
+    do {
+      TF_EXPECT_OK(ReadCache(&cache, "a", total, block_size / 2, &out));
+      total += out.size();
+    } while (out.size() == block_size / 2);
+    EXPECT_EQ(total, file_size);
+  }
+  // Each block of the file was fetched once; the cache waits for the fetches
+  // in flight when it is destroyed.
+  for (size_t offset = 0; offset < file_size; offset += block_size) {
+    EXPECT_EQ(fetches[offset], 1) << "at offset = " << offset;
+  }
+
+  fetches.clear();
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), /*max_read_ahead_blocks=*/4);
+    // Random reads are not read ahead of.
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "a", 5 * block_size, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 2 * block_size, block_size, &out));
+  }
+  EXPECT_EQ(fetches, (std::map<size_t, int>{{2 * block_size, 1},
+                                            {5 * block_size, 1}}));
+}
+
+TEST(RamFileBlockCacheTest, ReadAheadIsBoundedByCacheSize) {
+  auto fetcher = [](const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred) {
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  EXPECT_EQ(RamFileBlockCache(16, 64, 0, fetcher, Env::Default(), 4)
+                .max_read_ahead_blocks(),
+            2);
+  EXPECT_EQ(RamFileBlockCache(16, 0, 0, fetcher, Env::Default(), 4)
+                .max_read_ahead_blocks(),
+            0);
+}
+
 }  // namespace
 }  // namespace tsl
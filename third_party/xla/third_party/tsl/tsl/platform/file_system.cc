@@ -31,15 +31,32 @@ limitations under the License.
 #endif  // defined(PLATFORM_POSIX) || defined(IS_MOBILE_PLATFORM) || \
         // defined(PLATFORM_GOOGLE)
 
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/platform.h"
 #include "tsl/platform/scanner.h"
 #include "tsl/platform/str_util.h"
 #include "tsl/platform/strcat.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tsl {
 
+namespace {
+
+// The number of threads of the pool on which RandomAccessFile::ReadAsync()
+// runs reads by default.  Reads mostly wait on I/O, so there are more of them
+// than cores.
+constexpr int kNumAsyncReadThreads = 32;
+
+thread::ThreadPool* AsyncReadThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "random_access_file_read", kNumAsyncReadThreads);
+  return pool;
+}
+
+}  // namespace
+
 bool FileSystem::Match(const string& filename, const string& pattern) {
 #if defined(PLATFORM_POSIX) || defined(IS_MOBILE_PLATFORM) || \
     defined(PLATFORM_GOOGLE)
@@ -492,4 +509,37 @@ std::string FileSystem::DecodeTransaction(const TransactionToken* token) {
   return "No Transaction";
 }
 
+void RandomAccessFile::ReadAsync(
+    uint64 offset, size_t n, char* scratch,
+    std::function<void(const Status&, StringPiece)> done) const {
+  AsyncReadThreadPool()->Schedule(
+      [this, offset, n, scratch, done = std::move(done)]() {
+        StringPiece result;
+        const Status status = Read(offset, n, &result, scratch);
+        done(status, result);
+      });
+}
+
+Status RandomAccessFile::ReadV(std::vector<ReadRequest>* requests) const {
+  if (requests->empty()) return OkStatus();
+  // The last read runs on the calling thread, which would wait otherwise.
+  BlockingCounter counter(requests->size() - 1);
+  for (size_t i = 0; i + 1 < requests->size(); ++i) {
+    ReadRequest& request = (*requests)[i];
+    ReadAsync(request.offset, request.n, request.scratch,
+              [&request, &counter](const Status& status, StringPiece result) {
+                request.status = status;
+                request.result = result;
+                counter.DecrementCount();
+              });
+  }
+  ReadRequest& last = requests->back();
+  last.status = Read(last.offset, last.n, &last.result, last.scratch);
+  counter.Wait();
+  for (const ReadRequest& request : *requests) {
+    TF_RETURN_IF_ERROR(request.status);
+  }
+  return OkStatus();
+}
+
 }  // namespace tsl
@@ -771,6 +771,41 @@ class RandomAccessFile {
   virtual tsl::Status Read(uint64 offset, size_t n, StringPiece* result,
                            char* scratch) const = 0;
 
+  /// \brief Reads up to `n` bytes from the file starting at `offset`
+  /// asynchronously, and calls `done` with the status and result of the read,
+  /// as returned and set by `Read()`.
+  ///
+  /// `scratch[0..n-1]` and the file must stay live until `done` is called.
+  /// `done` may be called on any thread, including the calling one before
+  /// `ReadAsync()` returns.
+  ///
+  /// The default implementation calls `Read()` on a pool of threads that is
+  /// shared by all files of the process, so that concurrent readers don't each
+  /// need their own.
+  virtual void ReadAsync(
+      uint64 offset, size_t n, char* scratch,
+      std::function<void(const tsl::Status&, StringPiece)> done) const;
+
+  /// \brief A read of `ReadV()`.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+    /// Set as by `Read()`.
+    StringPiece result;
+    tsl::Status status;
+  };
+
+  /// \brief Performs the reads of `requests`, which may run concurrently, and
+  /// sets the `result` and `status` of each.
+  ///
+  /// Returns OK if all reads returned OK, and the status of the first read
+  /// that did not otherwise.
+  ///
+  /// The default implementation issues the reads with `ReadAsync()` and waits
+  /// for them.
+  virtual tsl::Status ReadV(std::vector<ReadRequest>* requests) const;
+
 #if defined(TF_CORD_SUPPORT)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
   virtual tsl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const {
@@ -15,15 +15,14 @@ limitations under the License.
 
 #include "tsl/platform/file_system_helper.h"
 
-#include <deque>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tsl/platform/cpu_info.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/file_system.h"
-#include "tsl/platform/mutex.h"
 #include "tsl/platform/path.h"
 #include "tsl/platform/platform.h"
 #include "tsl/platform/status.h"
@@ -40,6 +39,7 @@ const int kNumThreads = port::NumSchedulableCPUs();
 // Run a function in parallel using a ThreadPool, but skip the ThreadPool
 // on the iOS platform due to its problems with more than a few threads.
 void ForEach(int first, int last, const std::function<void(int)>& f) {
+  if (first >= last) return;
 #if TARGET_OS_IPHONE
   for (int i = first; i < last; i++) {
     f(i);
@@ -167,11 +167,13 @@ Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
   // more patterns to match. So, we add to the queue only those children that
   // are also directories, paired with `ix+1`.
   // If there are no more entries in `dirs`, we return all children as part of
-  // the answer.
+  // the answer, without checking whether they are directories.
   // Since we can get into a combinatorial explosion issue (e.g., pattern
-  // `/*/*/*`), we process the queue in parallel. Each parallel processing takes
-  // elements from `expand_queue` and adds them to `next_expand_queue`, after
-  // which we swap these two queues (similar to double buffering algorithms).
+  // `/*/*/*`), and since listing directories and `IsDirectory` are expensive
+  // on some filesystems, each level is processed in two parallel passes: one
+  // lists and matches the children of all the directories in `expand_queue`,
+  // and one checks which of the matches are directories to expand next. Only
+  // one pass runs at a time, so at most `kNumThreads` calls are in flight.
   // PRECONDITION: `IsGlobbingPattern(dirs[0]) == false`
   // PRECONDITION: `matching_index > 0`
   // INVARIANT: If `{d, ix}` is in queue, then `d` and `dirs[ix]` are at the
@@ -180,28 +182,18 @@ Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
   // INVARIANT: If `{d, _}` is in queue, then `d` is a real directory.
   // INVARIANT: If `{_, ix}` is in queue, then `ix < dirs.size() - 1`.
   // INVARIANT: If `{_, ix}` is in queue, `IsGlobbingPattern(dirs[ix + 1])`.
-  std::deque<std::pair<string, int>> expand_queue;
-  std::deque<std::pair<string, int>> next_expand_queue;
+  std::vector<std::pair<string, int>> expand_queue;
   expand_queue.emplace_back(dirs[matching_index - 1], matching_index - 1);
 
-  // Adding to `result` or `new_expand_queue` need to be protected by mutexes
-  // since there are multiple threads writing to these.
-  mutex result_mutex;
-  mutex queue_mutex;
-
   while (!expand_queue.empty()) {
-    next_expand_queue.clear();
-
-    // The work item for every item in `expand_queue`.
-    // pattern, we process them in parallel.
-    auto handle_level = [&fs, &results, &dirs, &expand_queue,
-                         &next_expand_queue, &result_mutex,
-                         &queue_mutex](int i) {
+    // The children of every item in `expand_queue` that match the pattern of
+    // the next level.
+    std::vector<std::vector<std::string>> matches(expand_queue.size());
+    auto handle_level = [&fs, &dirs, &expand_queue, &matches](int i) {
       // See invariants above, all of these are valid accesses.
-      const auto& queue_item = expand_queue.at(i);
+      const auto& queue_item = expand_queue[i];
       const std::string& parent = queue_item.first;
-      const int index = queue_item.second + 1;
-      const std::string& match_pattern = dirs[index];
+      const std::string& match_pattern = dirs[queue_item.second + 1];
 
       // Get all children of `parent`. If this fails, return early.
       std::vector<std::string> children;
@@ -209,58 +201,40 @@ Status GetMatchingPaths(FileSystem* fs, Env* env, const string& pattern,
       if (s.code() == absl::StatusCode::kPermissionDenied) {
         return;
       }
-
-      // Also return early if we don't have any children
-      if (children.empty()) {
-        return;
-      }
-
-      // Since we can get extremely many children here and on some filesystems
-      // `IsDirectory` is expensive, we process the children in parallel.
-      // We also check that children match the pattern in parallel, for speedup.
-      // We store the status of the match and `IsDirectory` in
-      // `children_status` array, one element for each children.
-      std::vector<Status> children_status(children.size());
-      auto handle_children = [&fs, &match_pattern, &parent, &children,
-                              &children_status](int j) {
-        const std::string path = io::JoinPath(parent, children[j]);
-        if (!fs->Match(path, match_pattern)) {
-          children_status[j] =
-              Status(absl::StatusCode::kCancelled, "Operation not needed");
-        } else {
-          children_status[j] = fs->IsDirectory(path);
-        }
-      };
-      ForEach(0, children.size(), handle_children);
-
-      // At this point, pairing `children` with `children_status` will tell us
-      // if a children:
-      //   * does not match the pattern
-      //   * matches the pattern and is a directory
-      //   * matches the pattern and is not a directory
-      // We fully ignore the first case.
-      // If we matched the last pattern (`index == dirs.size() - 1`) then all
-      // remaining children get added to the result.
-      // Otherwise, only the directories get added to the next queue.
-      for (size_t j = 0; j < children.size(); j++) {
-        if (children_status[j].code() == absl::StatusCode::kCancelled) {
-          continue;
-        }
-
-        const std::string path = io::JoinPath(parent, children[j]);
-        if (index == dirs.size() - 1) {
-          mutex_lock l(result_mutex);
-          results->emplace_back(path);
-        } else if (children_status[j].ok()) {
-          mutex_lock l(queue_mutex);
-          next_expand_queue.emplace_back(path, index);
+      for (const std::string& child : children) {
+        std::string path = io::JoinPath(parent, child);
+        if (fs->Match(path, match_pattern)) {
+          matches[i].push_back(std::move(path));
         }
       }
     };
     ForEach(0, expand_queue.size(), handle_level);
 
-    // After evaluating one level, swap the "buffers"
-    std::swap(expand_queue, next_expand_queue);
+    // If we matched the last pattern then all matches get added to the
+    // result. Otherwise, only the directories get added to the next queue.
+    std::vector<std::pair<string, int>> candidates;
+    for (size_t i = 0; i < expand_queue.size(); i++) {
+      const int index = expand_queue[i].second + 1;
+      for (std::string& path : matches[i]) {
+        if (index == dirs.size() - 1) {
+          results->push_back(std::move(path));
+        } else {
+          candidates.emplace_back(std::move(path), index);
+        }
+      }
+    }
+    std::vector<Status> candidates_status(candidates.size());
+    ForEach(0, candidates.size(),
+            [&fs, &candidates, &candidates_status](int j) {
+              candidates_status[j] = fs->IsDirectory(candidates[j].first);
+            });
+
+    expand_queue.clear();
+    for (size_t j = 0; j < candidates.size(); j++) {
+      if (candidates_status[j].ok()) {
+        expand_queue.push_back(std::move(candidates[j]));
+      }
+    }
   }
 
   return OkStatus();
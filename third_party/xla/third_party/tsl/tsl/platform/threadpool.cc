@@ -17,6 +17,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <atomic>
+#include <set>
+
 #include "absl/types/optional.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tsl/platform/blocking_counter.h"
@@ -40,12 +43,101 @@ namespace tsl {
 
 namespace thread {
 
+// Collects the ThreadPool::Stats of a pool from the tasks it schedules and
+// runs. Thread-safe.
+class ThreadPoolStatsCollector {
+ public:
+  // Must be called before the pool schedules tasks.
+  void set_pool(const Eigen::ThreadPoolInterface* pool) { pool_ = pool; }
+
+  int CurrentThreadId() const { return pool_->CurrentThreadId(); }
+
+  // Called on the scheduling thread, whose id in the pool is
+  // "scheduling_thread", or -1 outside of the pool.
+  void OnSchedule(int scheduling_thread) {
+    tasks_scheduled_.fetch_add(1, std::memory_order_relaxed);
+    if (scheduling_thread >= 0) {
+      stealable_tasks_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Called on the running thread when a task scheduled "wait_nanos" ago by
+  // "scheduling_thread" starts.
+  void OnStart(int scheduling_thread, uint64 wait_nanos) {
+    tasks_started_.fetch_add(1, std::memory_order_relaxed);
+    if (scheduling_thread >= 0 && scheduling_thread != CurrentThreadId()) {
+      stolen_tasks_.fetch_add(1, std::memory_order_relaxed);
+    }
+    const uint64 wait_us = wait_nanos / 1000;
+    int bucket = 0;
+    while (bucket < ThreadPool::kNumLatencyBuckets - 1 &&
+           (wait_us >> bucket) != 0) {
+      ++bucket;
+    }
+    wakeup_latency_us_[bucket].fetch_add(1, std::memory_order_relaxed);
+    total_wakeup_latency_us_.fetch_add(wait_us, std::memory_order_relaxed);
+  }
+
+  void OnDone() { tasks_executed_.fetch_add(1, std::memory_order_relaxed); }
+
+  ThreadPool::Stats GetStats() const {
+    ThreadPool::Stats stats;
+    stats.tasks_scheduled = tasks_scheduled_.load(std::memory_order_relaxed);
+    stats.tasks_executed = tasks_executed_.load(std::memory_order_relaxed);
+    // The counters aren't read atomically together, so that tasks scheduled
+    // and started between the reads may be seen as started only.
+    const int64_t tasks_started =
+        tasks_started_.load(std::memory_order_relaxed);
+    stats.queue_length =
+        std::max<int64_t>(0, stats.tasks_scheduled - tasks_started);
+    stats.stealable_tasks = stealable_tasks_.load(std::memory_order_relaxed);
+    stats.stolen_tasks = stolen_tasks_.load(std::memory_order_relaxed);
+    for (int i = 0; i < ThreadPool::kNumLatencyBuckets; ++i) {
+      stats.wakeup_latency_us[i] =
+          wakeup_latency_us_[i].load(std::memory_order_relaxed);
+    }
+    stats.total_wakeup_latency_us =
+        total_wakeup_latency_us_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+ private:
+  const Eigen::ThreadPoolInterface* pool_ = nullptr;
+  std::atomic<int64_t> tasks_scheduled_{0};
+  std::atomic<int64_t> tasks_started_{0};
+  std::atomic<int64_t> tasks_executed_{0};
+  std::atomic<int64_t> stealable_tasks_{0};
+  std::atomic<int64_t> stolen_tasks_{0};
+  std::array<std::atomic<int64_t>, ThreadPool::kNumLatencyBuckets>
+      wakeup_latency_us_ = {};
+  std::atomic<int64_t> total_wakeup_latency_us_{0};
+};
+
+namespace {
+
+// The live pools which collect statistics.
+mutex* StatsPoolsMutex() {
+  static mutex* mu = new mutex();
+  return mu;
+}
+
+std::set<const ThreadPool*>* StatsPools() TF_EXCLUSIVE_LOCKS_REQUIRED(
+    *StatsPoolsMutex()) {
+  static std::set<const ThreadPool*>* pools = new std::set<const ThreadPool*>();
+  return pools;
+}
+
+}  // namespace
+
 struct EigenEnvironment {
   typedef Thread EnvThread;
   struct TaskImpl {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // Only set if stats_collector_ is not null.
+    uint64 schedule_nanos;
+    int scheduling_thread;
   };
   struct Task {
     std::unique_ptr<TaskImpl> f;
@@ -54,10 +146,15 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  ThreadPoolStatsCollector* const stats_collector_;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name,
+                   ThreadPoolStatsCollector* stats_collector = nullptr)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        stats_collector_(stats_collector) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
@@ -78,20 +175,39 @@ struct EigenEnvironment {
       id = tracing::GetUniqueArg();
       tracing::RecordEvent(tracing::EventCategory::kScheduleClosure, id);
     }
+    uint64 schedule_nanos = 0;
+    int scheduling_thread = -1;
+    if (stats_collector_ != nullptr) {
+      schedule_nanos = env_->NowNanos();
+      scheduling_thread = stats_collector_->CurrentThreadId();
+      stats_collector_->OnSchedule(scheduling_thread);
+    }
     return Task{
         std::unique_ptr<TaskImpl>(new TaskImpl{
             std::move(f),
             Context(ContextKind::kThread),
             id,
+            schedule_nanos,
+            scheduling_thread,
         }),
     };
   }
 
   void ExecuteTask(const Task& t) {
+    if (stats_collector_ != nullptr) {
+      const uint64 now_nanos = env_->NowNanos();
+      stats_collector_->OnStart(
+          t.f->scheduling_thread,
+          now_nanos > t.f->schedule_nanos ? now_nanos - t.f->schedule_nanos
+                                          : 0);
+    }
     WithContext wc(t.f->context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                  t.f->trace_id);
     t.f->f();
+    if (stats_collector_ != nullptr) {
+      stats_collector_->OnDone();
+    }
   }
 };
 
@@ -104,7 +220,18 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
 
 ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                        const string& name, int num_threads,
-                       bool low_latency_hint, Eigen::Allocator* allocator) {
+                       bool low_latency_hint, Eigen::Allocator* allocator)
+    : ThreadPool(env, thread_options, name, num_threads, [&]() {
+        Options options;
+        options.low_latency_hint = low_latency_hint;
+        options.allocator = allocator;
+        return options;
+      }()) {}
+
+ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
+                       const string& name, int num_threads,
+                       const Options& options)
+    : name_(name) {
   CHECK_GE(num_threads, 1);
 
 #ifdef TENSORFLOW_THREADSCALING_EXPERIMENTAL
@@ -113,12 +240,24 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
   if (num_threads < 1) num_threads = 1;
 #endif  // TENSORFLOW_THREADSCALING_EXPERIMENTAL
 
+  if (options.collect_stats) {
+    stats_collector_ = std::make_unique<ThreadPoolStatsCollector>();
+  }
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
-      num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      num_threads, options.low_latency_hint,
+      EigenEnvironment(env, thread_options, "tf_" + name,
+                       stats_collector_.get())));
   underlying_threadpool_ = eigen_threadpool_.get();
-  threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
-                                                       num_threads, allocator));
+  threadpool_device_.reset(new Eigen::ThreadPoolDevice(
+      underlying_threadpool_, num_threads, options.allocator));
+  if (!options.steal_partitions.empty()) {
+    eigen_threadpool_->SetStealPartitions(options.steal_partitions);
+  }
+  if (stats_collector_ != nullptr) {
+    stats_collector_->set_pool(eigen_threadpool_.get());
+    mutex_lock l(*StatsPoolsMutex());
+    StatsPools()->insert(this);
+  }
 }
 
 ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
@@ -127,7 +266,12 @@ ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
       underlying_threadpool_, underlying_threadpool_->NumThreads(), nullptr));
 }
 
-ThreadPool::~ThreadPool() {}
+ThreadPool::~ThreadPool() {
+  if (stats_collector_ != nullptr) {
+    mutex_lock l(*StatsPoolsMutex());
+    StatsPools()->erase(this);
+  }
+}
 
 void ThreadPool::Schedule(std::function<void()> fn) {
   CHECK(fn != nullptr);
@@ -284,5 +428,19 @@ Eigen::ThreadPoolInterface* ThreadPool::AsEigenThreadPool() const {
   DCHECK(underlying_threadpool_ != nullptr);
   return underlying_threadpool_;
 }
+
+absl::optional<ThreadPool::Stats> ThreadPool::GetStats() const {
+  if (stats_collector_ == nullptr) return absl::nullopt;
+  return stats_collector_->GetStats();
+}
+
+void ThreadPool::ForEachPoolStats(
+    const std::function<void(const std::string& name, const Stats& stats)>&
+        fn) {
+  mutex_lock l(*StatsPoolsMutex());
+  for (const ThreadPool* pool : *StatsPools()) {
+    fn(pool->name(), pool->stats_collector_->GetStats());
+  }
+}
 }  // namespace thread
 }  // namespace tsl
@@ -16,8 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_THREADPOOL_H_
 #define TENSORFLOW_TSL_PLATFORM_THREADPOOL_H_
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "tsl/platform/env.h"
@@ -38,6 +42,7 @@ namespace tsl {
 namespace thread {
 
 struct EigenEnvironment;
+class ThreadPoolStatsCollector;
 
 class ThreadPool {
  public:
@@ -99,6 +104,56 @@ class ThreadPool {
     absl::optional<int64_t> block_size_;
   };
 
+  // Per-pool tuning of the underlying Eigen pool.
+  struct Options {
+    // If true, idle threads spin wait for new work for a while before parking
+    // on a condition variable, trading CPU usage for lower wake-up latency.
+    // If false, they park as soon as they find no work. Eigen spins
+    // 5000 / num_threads iterations, which can't be tuned per pool.
+    bool low_latency_hint = true;
+
+    // If not empty, the [start, limit) ranges of threads which each thread
+    // steals work from, as in SetStealPartitions(). Must hold one range per
+    // thread.
+    std::vector<std::pair<unsigned, unsigned>> steal_partitions;
+
+    // If true, the pool collects the Stats below and exports them with the
+    // other pools of the process, at the cost of two clock reads per task.
+    bool collect_stats = false;
+
+    Eigen::Allocator* allocator = nullptr;
+  };
+
+  // The number of buckets of Stats::wakeup_latency_us.
+  static constexpr int kNumLatencyBuckets = 24;
+
+  // Statistics of a pool created with Options::collect_stats.
+  struct Stats {
+    int64_t tasks_scheduled = 0;
+    int64_t tasks_executed = 0;
+    // The tasks scheduled which haven't started yet.
+    int64_t queue_length = 0;
+    // The tasks scheduled by a thread of the pool, which go into its own
+    // queue, i.e. the tasks that other threads can steal, and those of them
+    // that another thread ran.
+    int64_t stealable_tasks = 0;
+    int64_t stolen_tasks = 0;
+    // The histogram of the time between the scheduling and the start of the
+    // tasks, in microseconds: bucket 0 counts the tasks which waited less than
+    // 1us, bucket i the tasks which waited in [2^(i-1), 2^i) us, and the last
+    // bucket the longer waits.
+    std::array<int64_t, kNumLatencyBuckets> wakeup_latency_us = {};
+    int64_t total_wakeup_latency_us = 0;
+  };
+
+  // Constructs a pool that contains "num_threads" threads with specified
+  // "name", tuned by "options". env->StartThread() is used to create
+  // individual threads with the given ThreadOptions.
+  //
+  // REQUIRES: num_threads > 0
+  ThreadPool(Env* env, const ThreadOptions& thread_options,
+             const std::string& name, int num_threads, const Options& options);
+
   // Constructs a pool that contains "num_threads" threads with specified
   // "name". env->StartThread() is used to create individual threads with the
   // given ThreadOptions. If "low_latency_hint" is true the thread pool
@@ -216,6 +271,20 @@ class ThreadPool {
   // pointer points to, and should not attempt to delete.
   Eigen::ThreadPoolInterface* AsEigenThreadPool() const;
 
+  // Returns the name of the pool.
+  const std::string& name() const { return name_; }
+
+  // Returns the statistics of the pool, if created with
+  // Options::collect_stats.
+  absl::optional<Stats> GetStats() const;
+
+  // Calls "fn" with the name and the statistics of each live pool created with
+  // Options::collect_stats, e.g. to export them as metrics. "fn" must not
+  // create or destroy pools.
+  static void ForEachPoolStats(
+      const std::function<void(const std::string& name, const Stats& stats)>&
+          fn);
+
  private:
   // Divides the work represented by the range [0, total) into k shards.
   // Calls fn(i*block_size, (i+1)*block_size) from the ith shard (0 <= i < k).
@@ -228,6 +297,10 @@ class ThreadPool {
       const int64_t total, const int64_t block_size,
       const std::function<void(int64_t, int64_t)>& fn);
 
+  std::string name_;
+  // Set if created with Options::collect_stats. Destroyed after the threads of
+  // the pool, which update it.
+  std::unique_ptr<ThreadPoolStatsCollector> stats_collector_;
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
@@ -0,0 +1,252 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/backends/cpu/op_stats_recorder.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/numeric/bits.h"
+#include "absl/strings/string_view.h"
+#include "tsl/platform/macros.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace profiler {
+namespace internal {
+
+#ifdef _WIN32
+#define DECL_DLL_EXPORT __declspec(dllexport)
+#else
+#define DECL_DLL_EXPORT
+#endif
+// DLL imported variables cannot be initialized on Windows. This file is
+// included only on DLL exports.
+DECL_DLL_EXPORT std::atomic<int> g_op_stats_active(0);
+
+}  // namespace internal
+
+namespace {
+
+// How many slots Record() probes for an op before dropping it.
+constexpr int kMaxProbes = 16;
+
+// Adds to a counter only its owner thread writes, so that it needs no
+// read-modify-write instruction.
+inline void Increment(std::atomic<uint64>* counter, uint64 value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+}
+
+void MergeInto(const OpStatsRecorder::Totals& from,
+               OpStatsRecorder::Totals* to) {
+  for (const auto& name_and_stats : from.ops) {
+    const OpStatsRecorder::OpStats& stats = name_and_stats.second;
+    OpStatsRecorder::OpStats& total = to->ops[name_and_stats.first];
+    if (total.name.empty()) {
+      total.name = stats.name;
+      total.type = stats.type;
+    }
+    total.count += stats.count;
+    total.total_ns += stats.total_ns;
+    for (int i = 0; i < OpStatsRecorder::kNumBuckets; ++i) {
+      total.buckets[i] += stats.buckets[i];
+    }
+  }
+  to->num_dropped += from.num_dropped;
+}
+
+}  // namespace
+
+// A fixed-size open-addressing table of the ops run by one thread.
+//
+// Only the owner thread writes the table. A slot is claimed the first time
+// the thread runs an op, and its name is immutable from then on, so the
+// control thread can read published slots concurrently. When recording
+// starts again, the owner thread zeroes the counters on its next Record(),
+// and the control thread ignores the table until then.
+class OpStatsRecorder::ThreadLocalTable {
+ public:
+  void Record(uint64 generation, absl::string_view name,
+              absl::string_view type, uint64 duration_ns) {
+    // Ignores a generation loaded before the latest Start(), which is older
+    // than the one of the table.
+    if (TF_PREDICT_FALSE(generation_.load(std::memory_order_relaxed) <
+                         generation)) {
+      Reset(generation);
+    }
+    Slot* slot = FindOrInsert(name, type);
+    if (TF_PREDICT_FALSE(slot == nullptr)) {
+      Increment(&num_dropped_, 1);
+      return;
+    }
+    Increment(&slot->count, 1);
+    Increment(&slot->total_ns, duration_ns);
+    Increment(&slot->buckets[BucketOf(duration_ns)], 1);
+  }
+
+  // Adds the counters of the table to `totals` if they were recorded since
+  // recording last started at `generation`.
+  void AddTo(uint64 generation, Totals* totals) const {
+    if (generation_.load(std::memory_order_acquire) != generation) return;
+    Totals table_totals;
+    for (const Slot& slot : slots_) {
+      if (!slot.published.load(std::memory_order_acquire)) continue;
+      OpStats& stats = table_totals.ops[slot.name];
+      stats.name = slot.name;
+      stats.type = slot.type;
+      stats.count = slot.count.load(std::memory_order_relaxed);
+      stats.total_ns = slot.total_ns.load(std::memory_order_relaxed);
+      for (int i = 0; i < kNumBuckets; ++i) {
+        stats.buckets[i] = slot.buckets[i].load(std::memory_order_relaxed);
+      }
+    }
+    table_totals.num_dropped = num_dropped_.load(std::memory_order_relaxed);
+    MergeInto(table_totals, totals);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<bool> published{false};
+    std::string name;
+    std::string type;
+    std::atomic<uint64> count{0};
+    std::atomic<uint64> total_ns{0};
+    std::array<std::atomic<uint64>, kNumBuckets> buckets = {};
+  };
+
+  Slot* FindOrInsert(absl::string_view name, absl::string_view type) {
+    size_t index = absl::Hash<absl::string_view>()(name);
+    for (int probe = 0; probe < kMaxProbes; ++probe, ++index) {
+      Slot& slot = slots_[index % kMaxOpsPerThread];
+      if (!slot.published.load(std::memory_order_relaxed)) {
+        slot.name = std::string(name);
+        slot.type = std::string(type);
+        // Publishes the name after writing it.
+        slot.published.store(true, std::memory_order_release);
+        return &slot;
+      }
+      if (slot.name == name) return &slot;
+    }
+    return nullptr;
+  }
+
+  void Reset(uint64 generation) {
+    for (Slot& slot : slots_) {
+      if (!slot.published.load(std::memory_order_relaxed)) continue;
+      slot.count.store(0, std::memory_order_relaxed);
+      slot.total_ns.store(0, std::memory_order_relaxed);
+      for (auto& bucket : slot.buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+    num_dropped_.store(0, std::memory_order_relaxed);
+    // Publishes the zeroed counters.
+    generation_.store(generation, std::memory_order_release);
+  }
+
+  std::array<Slot, kMaxOpsPerThread> slots_;
+  std::atomic<uint64> num_dropped_{0};
+  // The generation the counters were recorded in.
+  std::atomic<uint64> generation_{0};
+};
+
+// An instance of this wrapper is allocated in thread_local storage. It creates
+// the ThreadLocalTable of the thread the first time the thread records an op,
+// and unregisters it when the thread is destroyed.
+class OpStatsRecorder::ThreadLocalTableWrapper {
+ public:
+  ThreadLocalTableWrapper() : table_(std::make_unique<ThreadLocalTable>()) {
+    OpStatsRecorder::Get()->RegisterThread(table_.get());
+  }
+
+  ~ThreadLocalTableWrapper() {
+    OpStatsRecorder::Get()->UnregisterThread(table_.get());
+  }
+
+  ThreadLocalTable* table() { return table_.get(); }
+
+ private:
+  std::unique_ptr<ThreadLocalTable> table_;
+};
+
+/*static*/ OpStatsRecorder* OpStatsRecorder::Get() {
+  static OpStatsRecorder* singleton = new OpStatsRecorder;
+  return singleton;
+}
+
+/*static*/ int OpStatsRecorder::BucketOf(uint64 duration_ns) {
+  if (duration_ns == 0) return 0;
+  return std::min<int>(absl::bit_width(duration_ns) - 1, kNumBuckets - 1);
+}
+
+/*static*/ void OpStatsRecorder::Record(absl::string_view name,
+                                        absl::string_view type,
+                                        uint64 duration_ns) {
+  static thread_local ThreadLocalTableWrapper thread_local_table;
+  thread_local_table.table()->Record(
+      Get()->generation_.load(std::memory_order_acquire), name, type,
+      duration_ns);
+}
+
+void OpStatsRecorder::RegisterThread(ThreadLocalTable* table) {
+  mutex_lock lock(mutex_);
+  threads_.push_back(table);
+}
+
+void OpStatsRecorder::UnregisterThread(ThreadLocalTable* table) {
+  mutex_lock lock(mutex_);
+  // Keeps what the thread counted.
+  table->AddTo(generation_.load(std::memory_order_relaxed), &retired_);
+  threads_.erase(std::remove(threads_.begin(), threads_.end(), table),
+                 threads_.end());
+}
+
+bool OpStatsRecorder::StartRecording() {
+  mutex_lock lock(mutex_);
+  if (internal::g_op_stats_active.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  // The tables are zeroed by their threads before they record again.
+  generation_.fetch_add(1, std::memory_order_release);
+  retired_ = Totals();
+  internal::g_op_stats_active.store(1, std::memory_order_release);
+  return true;
+}
+
+void OpStatsRecorder::StopRecording() {
+  mutex_lock lock(mutex_);
+  internal::g_op_stats_active.store(0, std::memory_order_release);
+}
+
+OpStatsRecorder::Totals OpStatsRecorder::CollectTotals() {
+  mutex_lock lock(mutex_);
+  // Start() holds mutex_ too, so the generation doesn't change meanwhile, and
+  // tables being zeroed for it are still of an older one.
+  const uint64 generation = generation_.load(std::memory_order_relaxed);
+  Totals totals;
+  MergeInto(retired_, &totals);
+  for (const ThreadLocalTable* table : threads_) {
+    table->AddTo(generation, &totals);
+  }
+  return totals;
+}
+
+}  // namespace profiler
+}  // namespace tsl
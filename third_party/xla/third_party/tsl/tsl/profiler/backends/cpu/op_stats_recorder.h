@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_OP_STATS_RECORDER_H_
+#define TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_OP_STATS_RECORDER_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tsl/platform/macros.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace profiler {
+namespace internal {
+
+// Whether op stats are recorded.
+// Static atomic so OpStatsRecorder::Active can be fast and non-blocking.
+TF_EXPORT extern std::atomic<int> g_op_stats_active;
+
+}  // namespace internal
+
+// OpStatsRecorder is a singleton repository of aggregated op latencies, cheap
+// enough to leave on in production.
+//
+// Each thread aggregates the ops it runs into a fixed-size table of counters,
+// which only that thread writes, so Record() neither locks nor allocates
+// (except for the name of an op the first time the thread runs it). Ops that
+// don't fit into the table of a thread are counted as dropped.
+//
+// Collect() sums the tables of all threads, including those that exited, into
+// totals since Start(). Callers that export periodically subtract the totals
+// of their previous collection to get deltas.
+class OpStatsRecorder {
+ public:
+  // The latencies of an op are counted in buckets of powers of two
+  // nanoseconds: bucket i counts latencies in [2^i, 2^(i+1)) ns, and the last
+  // bucket also counts the longer ones.
+  static constexpr int kNumBuckets = 32;
+  // The number of distinct ops each thread aggregates.
+  static constexpr int kMaxOpsPerThread = 256;
+
+  struct OpStats {
+    std::string name;
+    std::string type;
+    uint64 count = 0;
+    uint64 total_ns = 0;
+    std::array<uint64, kNumBuckets> buckets = {};
+  };
+  struct Totals {
+    // By op name.
+    absl::flat_hash_map<std::string, OpStats> ops;
+    // The number of op executions that didn't fit into a table.
+    uint64 num_dropped = 0;
+  };
+
+  // Starts recording op stats, after clearing the totals. Returns false if
+  // recording was already started.
+  static bool Start() { return Get()->StartRecording(); }
+
+  // Stops recording op stats.
+  static void Stop() { Get()->StopRecording(); }
+
+  // Returns whether op stats are recorded. Racy, but cheap!
+  static inline bool Active() {
+    return internal::g_op_stats_active.load(std::memory_order_acquire) != 0;
+  }
+
+  // Records that op `name` of type `type` took `duration_ns`. Non-blocking.
+  static void Record(absl::string_view name, absl::string_view type,
+                     uint64 duration_ns);
+
+  // Returns the totals since Start().
+  static Totals Collect() { return Get()->CollectTotals(); }
+
+  // Returns the bucket of `duration_ns`.
+  static int BucketOf(uint64 duration_ns);
+
+ private:
+  class ThreadLocalTable;
+  class ThreadLocalTableWrapper;
+
+  // Returns singleton.
+  static OpStatsRecorder* Get();
+
+  OpStatsRecorder() = default;
+
+  OpStatsRecorder(const OpStatsRecorder&) = delete;
+  void operator=(const OpStatsRecorder&) = delete;
+
+  void RegisterThread(ThreadLocalTable* table);
+  void UnregisterThread(ThreadLocalTable* table);
+
+  bool StartRecording();
+  void StopRecording();
+  Totals CollectTotals();
+
+  mutex mutex_;
+  // The tables of the live threads. A ThreadLocalTable is owned by the
+  // ThreadLocalTableWrapper in thread_local storage, which unregisters it
+  // before destroying it.
+  std::vector<ThreadLocalTable*> threads_ TF_GUARDED_BY(mutex_);
+  // What the tables of the exited threads counted.
+  Totals retired_ TF_GUARDED_BY(mutex_);
+  // Incremented by Start(), so that threads clear their tables lazily.
+  std::atomic<uint64> generation_{0};
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_OP_STATS_RECORDER_H_
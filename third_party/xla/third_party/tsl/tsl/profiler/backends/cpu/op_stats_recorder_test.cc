@@ -0,0 +1,99 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/backends/cpu/op_stats_recorder.h"
+
+#include <memory>
+
+#include "absl/strings/str_cat.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+TEST(OpStatsRecorderTest, BucketOf) {
+  EXPECT_EQ(OpStatsRecorder::BucketOf(0), 0);
+  EXPECT_EQ(OpStatsRecorder::BucketOf(1), 0);
+  EXPECT_EQ(OpStatsRecorder::BucketOf(2), 1);
+  EXPECT_EQ(OpStatsRecorder::BucketOf(1023), 9);
+  EXPECT_EQ(OpStatsRecorder::BucketOf(1024), 10);
+  EXPECT_EQ(OpStatsRecorder::BucketOf(~uint64{0}),
+            OpStatsRecorder::kNumBuckets - 1);
+}
+
+TEST(OpStatsRecorderTest, AggregatesAcrossThreads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumRecords = 1000;
+  ASSERT_TRUE(OpStatsRecorder::Start());
+  EXPECT_TRUE(OpStatsRecorder::Active());
+  EXPECT_FALSE(OpStatsRecorder::Start());
+  {
+    // The threads of the pool exit before the totals are collected.
+    thread::ThreadPool pool(Env::Default(), "op_stats", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([]() {
+        for (int i = 0; i < kNumRecords; ++i) {
+          OpStatsRecorder::Record("matmul", "MatMul", 1500);
+          OpStatsRecorder::Record("add", "AddV2", 100);
+        }
+      });
+    }
+  }
+  OpStatsRecorder::Record("add", "AddV2", 100);
+
+  OpStatsRecorder::Totals totals = OpStatsRecorder::Collect();
+  ASSERT_EQ(totals.ops.size(), 2);
+  const OpStatsRecorder::OpStats& matmul = totals.ops["matmul"];
+  EXPECT_EQ(matmul.type, "MatMul");
+  EXPECT_EQ(matmul.count, kNumThreads * kNumRecords);
+  EXPECT_EQ(matmul.total_ns, kNumThreads * kNumRecords * 1500);
+  EXPECT_EQ(matmul.buckets[OpStatsRecorder::BucketOf(1500)],
+            kNumThreads * kNumRecords);
+  EXPECT_EQ(totals.ops["add"].count, kNumThreads * kNumRecords + 1);
+  EXPECT_EQ(totals.num_dropped, 0);
+  OpStatsRecorder::Stop();
+  EXPECT_FALSE(OpStatsRecorder::Active());
+
+  // Starting again clears the totals.
+  ASSERT_TRUE(OpStatsRecorder::Start());
+  OpStatsRecorder::Record("add", "AddV2", 100);
+  totals = OpStatsRecorder::Collect();
+  ASSERT_EQ(totals.ops.size(), 1);
+  EXPECT_EQ(totals.ops["add"].count, 1);
+  OpStatsRecorder::Stop();
+}
+
+TEST(OpStatsRecorderTest, DropsWhenTableIsFull) {
+  constexpr int kNumOps = 2 * OpStatsRecorder::kMaxOpsPerThread;
+  ASSERT_TRUE(OpStatsRecorder::Start());
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "op_stats", []() {
+        for (int i = 0; i < kNumOps; ++i) {
+          OpStatsRecorder::Record(absl::StrCat("op", i), "NoOp", 1);
+        }
+      }));
+  thread.reset();
+  OpStatsRecorder::Totals totals = OpStatsRecorder::Collect();
+  EXPECT_LE(totals.ops.size(), OpStatsRecorder::kMaxOpsPerThread);
+  EXPECT_EQ(totals.ops.size() + totals.num_dropped, kNumOps);
+  OpStatsRecorder::Stop();
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
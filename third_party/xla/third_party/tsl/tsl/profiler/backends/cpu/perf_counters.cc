@@ -0,0 +1,193 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/backends/cpu/perf_counters.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace tsl {
+namespace profiler {
+namespace internal {
+
+#ifdef _WIN32
+#define DECL_DLL_EXPORT __declspec(dllexport)
+#else
+#define DECL_DLL_EXPORT
+#endif
+// DLL imported variables cannot be initialized on Windows. This file is
+// included only on DLL exports.
+DECL_DLL_EXPORT std::atomic<int> g_perf_counters_active(0);
+
+}  // namespace internal
+
+namespace {
+
+constexpr absl::string_view kAllOps = "*";
+
+struct Config {
+  mutex mu;
+  bool all_ops TF_GUARDED_BY(mu) = false;
+  absl::flat_hash_set<std::string> op_types TF_GUARDED_BY(mu);
+};
+
+Config& GetConfig() {
+  static Config* config = new Config;
+  return *config;
+}
+
+#if defined(__linux__)
+
+// The counters of one thread, read as a group so that they cover the same
+// interval.
+class ThreadCounters {
+ public:
+  ThreadCounters() {
+    const int leader_fd = Open(PERF_COUNT_HW_CPU_CYCLES, /*group_fd=*/-1);
+    if (leader_fd < 0) {
+      VLOG(1) << "Hardware performance counters are unavailable: "
+              << std::strerror(errno);
+      return;
+    }
+    fds_.push_back(leader_fd);
+    for (const uint64 config :
+         {PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES}) {
+      const int fd = Open(config, leader_fd);
+      if (fd < 0) {
+        VLOG(1) << "Hardware performance counters are unavailable: "
+                << std::strerror(errno);
+        Close();
+        return;
+      }
+      fds_.push_back(fd);
+    }
+    ioctl(leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  ~ThreadCounters() { Close(); }
+
+  bool Read(PerfCounters::Values* values) const {
+    if (fds_.empty()) return false;
+    // The layout of PERF_FORMAT_GROUP.
+    struct {
+      uint64 nr;
+      uint64 values[kNumCounters];
+    } data;
+    if (read(fds_[0], &data, sizeof(data)) !=
+            static_cast<ssize_t>(sizeof(data)) ||
+        data.nr != kNumCounters) {
+      return false;
+    }
+    values->cycles = data.values[0];
+    values->instructions = data.values[1];
+    values->llc_misses = data.values[2];
+    return true;
+  }
+
+ private:
+  static constexpr int kNumCounters = 3;
+
+  // Opens a user-space counter of the calling thread on any CPU.
+  static int Open(uint64 config, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    // The group starts when the leader is enabled.
+    attr.disabled = group_fd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                   group_fd, PERF_FLAG_FD_CLOEXEC);
+  }
+
+  void Close() {
+    for (const int fd : fds_) close(fd);
+    fds_.clear();
+  }
+
+  std::vector<int> fds_;
+};
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+/*static*/ bool PerfCounters::Start(const std::vector<std::string>& op_types) {
+  Config& config = GetConfig();
+  mutex_lock lock(config.mu);
+  if (internal::g_perf_counters_active.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  config.all_ops =
+      std::find(op_types.begin(), op_types.end(), kAllOps) != op_types.end();
+  config.op_types = absl::flat_hash_set<std::string>(op_types.begin(),
+                                                     op_types.end());
+  internal::g_perf_counters_active.store(1, std::memory_order_release);
+  return true;
+}
+
+/*static*/ void PerfCounters::Stop() {
+  Config& config = GetConfig();
+  mutex_lock lock(config.mu);
+  internal::g_perf_counters_active.store(0, std::memory_order_release);
+}
+
+/*static*/ bool PerfCounters::IsCounted(absl::string_view op_type) {
+  Config& config = GetConfig();
+  tf_shared_lock lock(config.mu);
+  return config.all_ops || config.op_types.contains(op_type);
+}
+
+/*static*/ bool PerfCounters::Read(Values* values) {
+#if defined(__linux__)
+  static thread_local ThreadCounters thread_counters;
+  return thread_counters.Read(values);
+#else
+  return false;
+#endif
+}
+
+/*static*/ PerfCounters::Values PerfCounters::Delta(const Values& end,
+                                                    const Values& start) {
+  Values delta;
+  delta.cycles = end.cycles - start.cycles;
+  delta.instructions = end.instructions - start.instructions;
+  delta.llc_misses = end.llc_misses - start.llc_misses;
+  return delta;
+}
+
+}  // namespace profiler
+}  // namespace tsl
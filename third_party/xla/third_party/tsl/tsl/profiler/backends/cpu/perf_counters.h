@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+#define TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tsl/platform/macros.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace profiler {
+namespace internal {
+
+// Whether hardware performance counters are collected.
+// Static atomic so PerfCounters::Active can be fast and non-blocking.
+TF_EXPORT extern std::atomic<int> g_perf_counters_active;
+
+}  // namespace internal
+
+// PerfCounters reads the hardware performance counters of the calling thread,
+// so that the host tracer can attach their deltas to the TraceMe events of
+// configured ops.
+//
+// On Linux, each thread opens a group of perf events (perf_event_open(2)) the
+// first time it reads them, counting in user space only. Where perf events
+// aren't available (e.g. other platforms, or a restrictive
+// perf_event_paranoid), Read() fails and no counters are attached.
+class PerfCounters {
+ public:
+  struct Values {
+    uint64 cycles = 0;
+    uint64 instructions = 0;
+    // Misses of the last-level cache, i.e. cache lines read from memory.
+    uint64 llc_misses = 0;
+  };
+
+  // Starts collecting the counters of the ops of types `op_types`, or of all
+  // ops if it contains "*". Returns false if collection was already started.
+  static bool Start(const std::vector<std::string>& op_types);
+
+  // Stops collecting counters.
+  static void Stop();
+
+  // Returns whether counters are collected. Racy, but cheap!
+  static inline bool Active() {
+    return internal::g_perf_counters_active.load(std::memory_order_acquire) !=
+           0;
+  }
+
+  // Returns whether the counters of ops of type `op_type` are collected.
+  static bool IsCounted(absl::string_view op_type);
+
+  // Reads the counters of the calling thread. Returns false if they are not
+  // available.
+  static bool Read(Values* values);
+
+  // Returns `end` minus `start`.
+  static Values Delta(const Values& end, const Values& start);
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
@@ -0,0 +1,54 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/backends/cpu/perf_counters.h"
+
+#include "tsl/platform/test.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+TEST(PerfCountersTest, CountsConfiguredOps) {
+  ASSERT_TRUE(PerfCounters::Start({"MatMul", "Conv2D"}));
+  EXPECT_TRUE(PerfCounters::Active());
+  EXPECT_FALSE(PerfCounters::Start({"*"}));
+  EXPECT_TRUE(PerfCounters::IsCounted("MatMul"));
+  EXPECT_FALSE(PerfCounters::IsCounted("AddV2"));
+  PerfCounters::Stop();
+  EXPECT_FALSE(PerfCounters::Active());
+
+  ASSERT_TRUE(PerfCounters::Start({"*"}));
+  EXPECT_TRUE(PerfCounters::IsCounted("AddV2"));
+  PerfCounters::Stop();
+}
+
+TEST(PerfCountersTest, ReadsThreadCounters) {
+  PerfCounters::Values start;
+  if (!PerfCounters::Read(&start)) {
+    GTEST_SKIP() << "Hardware performance counters are unavailable";
+  }
+  volatile uint64 sum = 0;
+  for (int i = 0; i < 1000000; ++i) sum += i;
+  PerfCounters::Values end;
+  ASSERT_TRUE(PerfCounters::Read(&end));
+  PerfCounters::Values delta = PerfCounters::Delta(end, start);
+  EXPECT_GT(delta.instructions, 1000000);
+  EXPECT_GT(delta.cycles, 0);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
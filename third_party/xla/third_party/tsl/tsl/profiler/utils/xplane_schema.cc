@@ -283,6 +283,9 @@ const StatTypeMap& GetStatTypeMap() {
       {"EdgeTPU Model information", kEdgeTpuModelInfo},
       {"EdgeTPU Model Profile information", kEdgeTpuModelProfileInfo},
       {"EdgeTPU MLIR", kEdgeTpuMlir},
+      {"cpu_cycles", kCpuCycles},
+      {"cpu_instructions", kCpuInstructions},
+      {"llc_misses", kLlcMisses},
       // Device capability related.
       {"clock_rate", kDevCapClockRateKHz},
       {"core_count", kDevCapCoreCount},
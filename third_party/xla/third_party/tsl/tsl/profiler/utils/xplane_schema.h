@@ -313,7 +313,11 @@ enum StatType {
   kEdgeTpuModelInfo,
   kEdgeTpuModelProfileInfo,
   kEdgeTpuMlir,
-  kLastStatType = kEdgeTpuMlir,
+  // Hardware performance counters of a host op.
+  kCpuCycles,
+  kCpuInstructions,
+  kLlcMisses,
+  kLastStatType = kLlcMisses,
 };
 
 enum MegaScaleStatType : uint8_t {
@@ -20,9 +20,11 @@ limitations under the License.
 #include <vector>
 
 #include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/types.h"
 #include "tsl/profiler/backends/cpu/host_tracer_utils.h"
+#include "tsl/profiler/backends/cpu/perf_counters.h"
 #include "tsl/profiler/backends/cpu/traceme_recorder.h"
 #include "tsl/profiler/lib/profiler_interface.h"
 #include "tsl/profiler/protobuf/xplane.pb.h"
@@ -39,7 +41,8 @@ namespace {
 // Thread-safety: This class is go/thread-compatible.
 class HostTracer : public tsl::profiler::ProfilerInterface {
  public:
-  explicit HostTracer(int host_trace_level);
+  HostTracer(int host_trace_level,
+             std::vector<std::string> cpu_counter_op_types);
   ~HostTracer() override;
 
   tsl::Status Start() override;  // TENSORFLOW_STATUS_OK
@@ -53,9 +56,15 @@ class HostTracer : public tsl::profiler::ProfilerInterface {
   // Level of host tracing.
   const int host_trace_level_;
 
+  // Types of the ops to collect hardware performance counters for.
+  const std::vector<std::string> cpu_counter_op_types_;
+
   // True if currently recording.
   bool recording_ = false;
 
+  // True if currently collecting hardware performance counters.
+  bool counting_ = false;
+
   // Timestamp at the start of tracing.
   uint64_t start_timestamp_ns_ = 0;
 
@@ -63,8 +72,10 @@ class HostTracer : public tsl::profiler::ProfilerInterface {
   tsl::profiler::TraceMeRecorder::Events events_;
 };
 
-HostTracer::HostTracer(int host_trace_level)
-    : host_trace_level_(host_trace_level) {}
+HostTracer::HostTracer(int host_trace_level,
+                       std::vector<std::string> cpu_counter_op_types)
+    : host_trace_level_(host_trace_level),
+      cpu_counter_op_types_(std::move(cpu_counter_op_types)) {}
 
 HostTracer::~HostTracer() { Stop().IgnoreError(); }  // NOLINT
 
@@ -81,6 +92,14 @@ tsl::Status HostTracer::Start() {  // TENSORFLOW_STATUS_OK
   if (!recording_) {
     return tsl::errors::Internal("Failed to start TraceMeRecorder");
   }
+  if (!cpu_counter_op_types_.empty()) {
+    // Another session may be collecting counters for its own ops; this one
+    // traces without them then.
+    counting_ = tsl::profiler::PerfCounters::Start(cpu_counter_op_types_);
+    if (!counting_) {
+      LOG(WARNING) << "Hardware performance counters are already collected";
+    }
+  }
   return tsl::OkStatus();
 }
 
@@ -88,6 +107,10 @@ tsl::Status HostTracer::Stop() {  // TENSORFLOW_STATUS_OK
   if (!recording_) {
     return tsl::errors::Internal("TraceMeRecorder not started");
   }
+  if (counting_) {
+    tsl::profiler::PerfCounters::Stop();
+    counting_ = false;
+  }
   events_ = tsl::profiler::TraceMeRecorder::Stop();
   recording_ = false;
   return tsl::OkStatus();
@@ -115,7 +138,8 @@ tsl::Status HostTracer::CollectData(  // TENSORFLOW_STATUS_OK
 std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
     const HostTracerOptions& options) {
   if (options.trace_level == 0) return nullptr;
-  return std::make_unique<HostTracer>(options.trace_level);
+  return std::make_unique<HostTracer>(options.trace_level,
+                                      options.cpu_counter_op_types);
 }
 
 }  // namespace profiler
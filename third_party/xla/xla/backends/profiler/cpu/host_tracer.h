@@ -16,6 +16,8 @@ limitations under the License.
 #define XLA_BACKENDS_PROFILER_CPU_HOST_TRACER_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "tsl/profiler/lib/profiler_interface.h"
 
@@ -32,6 +34,10 @@ struct HostTracerOptions {
   // - Level 3 enables tracing of all level 2 TraceMe(s) and more verbose
   //           (low-level) program execution details (cheap TF ops, etc).
   int trace_level = 2;
+
+  // Types of the TF ops to collect hardware performance counters for, or "*"
+  // for all ops. See PerfCounters.
+  std::vector<std::string> cpu_counter_op_types;
 };
 
 std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
@@ -26,6 +26,9 @@ std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
     const tensorflow::ProfileOptions& profile_options) {
   HostTracerOptions options;
   options.trace_level = profile_options.host_tracer_level();
+  options.cpu_counter_op_types.assign(
+      profile_options.cpu_counter_op_types().begin(),
+      profile_options.cpu_counter_op_types().end());
   return CreateHostTracer(options);
 }
 
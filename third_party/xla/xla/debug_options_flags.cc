@@ -1182,6 +1182,26 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
           &DebugOptions::set_xla_cpu_enable_experimental_deallocation),
       debug_options->xla_cpu_enable_experimental_deallocation(),
       "Enable experimental deallocation."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(&DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      debug_options->xla_cpu_parallel_codegen_split_count(),
+      "Number of modules to split the LLVM IR into, to optimize and compile "
+      "them in parallel. Uses the thread pool of the compile options, if any. "
+      "Values <= 1 disable splitting."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_memory_budget_bytes",
+      int64_setter_for(&DebugOptions::set_xla_cpu_memory_budget_bytes),
+      debug_options->xla_cpu_memory_budget_bytes(),
+      "If positive, schedule instructions for the least peak memory and "
+      "rematerialize long-lived buffers to keep the peak memory of "
+      "temporaries under this many bytes."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_enable_concurrent_fusions",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_concurrent_fusions),
+      debug_options->xla_cpu_enable_concurrent_fusions(),
+      "Run independent loop fusions of the entry computation concurrently on "
+      "the intra-op thread pool."));
   flag_list->push_back(
       tsl::Flag("xla_gpu_enable_latency_hiding_scheduler",
                 bool_setter_for(
@@ -1307,6 +1327,15 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "unless the name ends with .txt or .textproto. It will be loaded at most "
       "once per process. This only works on CUDA. In tests, the TEST_WORKSPACE "
       "prefix can be used to load files from their data dependencies."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_per_fusion_autotune_cache_dir",
+      string_setter_for(
+          &DebugOptions::set_xla_gpu_per_fusion_autotune_cache_dir),
+      debug_options->xla_gpu_per_fusion_autotune_cache_dir(),
+      "Directory of a cache of autotune results, one file per fusion, which "
+      "is looked up before autotuning and extended after. The results are "
+      "keyed by the device, the versions of the driver and the libraries, and "
+      "the HLO. This only works on CUDA."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_auto_spmd_partitioning_memory_budget_gb",
       int32_setter_for(
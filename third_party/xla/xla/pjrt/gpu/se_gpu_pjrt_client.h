@@ -184,10 +184,6 @@ class StreamExecutorGpuClient : public xla::PjRtStreamExecutorClient {
 
   absl::string_view platform_version() const override;
 
-  StatusOr<std::unique_ptr<PjRtClient::AsyncHostToDeviceTransferManager>>
-  CreateBuffersForAsyncHostToDevice(absl::Span<const Shape> shapes,
-                                    PjRtDevice* device) override;
-
   PjRtFuture<Status> CopyRawSubBufferToHost(PjRtBuffer* buffer, void* dst,
                                             int64_t offset,
                                             int64_t transfer_size) override;
@@ -0,0 +1,291 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/host_to_device_transfer_queue.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/event_pool.h"
+#include "xla/pjrt/local_device_state.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/pjrt/pjrt_stream_executor_client.h"
+#include "xla/pjrt/tracked_device_buffer.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/util.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/platform/casts.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace xla {
+
+struct HostToDeviceTransferQueue::Batch {
+  std::vector<const void*> data;
+  std::vector<std::shared_ptr<TrackedDeviceBuffer>> device_buffers;
+  std::vector<std::shared_ptr<BufferSequencingEvent>> definition_events;
+  PjRtFuture<Status>::Promise host_buffers_done;
+  // The buffers before this one have their definition events set.
+  int next_undefined_buffer = 0;
+  // The streams of the earlier pieces of the buffer split across chunks, if
+  // any.
+  absl::InlinedVector<se::Stream*, 4> split_buffer_streams;
+};
+
+struct HostToDeviceTransferQueue::Chunk {
+  explicit Chunk(char* data) : data(data) {}
+
+  struct Copy {
+    se::DeviceMemoryBase dst;
+    int64_t offset;
+  };
+
+  char* const data;
+  int64_t used = 0;
+  std::vector<Copy> copies;
+  // Keeps the destinations of `copies` alive until they have completed.
+  std::vector<std::shared_ptr<TrackedDeviceBuffer>> device_buffers;
+  // The buffers [batch.next_undefined_buffer, buffers_end) have their last
+  // piece in this chunk.
+  int buffers_end = 0;
+  // Whether this chunk holds a piece of buffer `buffers_end`, which continues
+  // in the next chunk.
+  bool splits_buffer = false;
+};
+
+StatusOr<std::unique_ptr<HostToDeviceTransferQueue>>
+HostToDeviceTransferQueue::Create(PjRtDevice* device, Options options) {
+  if (options.chunk_bytes <= 0 || options.num_chunks <= 0) {
+    return InvalidArgument(
+        "HostToDeviceTransferQueue needs a positive chunk size and number of "
+        "chunks, got %d and %d.",
+        options.chunk_bytes, options.num_chunks);
+  }
+  auto* se_device = tensorflow::down_cast<PjRtStreamExecutorDevice*>(device);
+  TF_ASSIGN_OR_RETURN(LocalDeviceState * local_device,
+                      se_device->GetLocalDeviceState());
+  tsl::Allocator* host_memory_allocator =
+      tensorflow::down_cast<PjRtStreamExecutorClient*>(se_device->client())
+          ->host_memory_allocator();
+  std::vector<char*> chunks;
+  chunks.reserve(options.num_chunks);
+  for (int i = 0; i < options.num_chunks; ++i) {
+    void* ptr = host_memory_allocator->AllocateRaw(
+        tsl::Allocator::kAllocatorAlignment, options.chunk_bytes);
+    if (ptr == nullptr) {
+      for (char* chunk : chunks) {
+        host_memory_allocator->DeallocateRaw(chunk);
+      }
+      return ResourceExhausted(
+          "Failed to allocate %d staging chunks of %d bytes.",
+          options.num_chunks, options.chunk_bytes);
+    }
+    chunks.push_back(static_cast<char*>(ptr));
+  }
+  return absl::WrapUnique(new HostToDeviceTransferQueue(
+      se_device, local_device, options, std::move(chunks)));
+}
+
+HostToDeviceTransferQueue::HostToDeviceTransferQueue(
+    PjRtStreamExecutorDevice* device, LocalDeviceState* local_device,
+    Options options, std::vector<char*> chunks)
+    : device_(device),
+      local_device_(local_device),
+      client_(
+          tensorflow::down_cast<PjRtStreamExecutorClient*>(device->client())),
+      options_(options),
+      free_chunks_(std::move(chunks)) {}
+
+HostToDeviceTransferQueue::~HostToDeviceTransferQueue() {
+  auto transfers_finished = [this]() {
+    mu_.AssertHeld();
+    return batches_in_flight_ == 0 &&
+           free_chunks_.size() == options_.num_chunks;
+  };
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(&transfers_finished));
+  for (char* chunk : free_chunks_) {
+    client_->host_memory_allocator()->DeallocateRaw(chunk);
+  }
+}
+
+StatusOr<HostToDeviceTransferQueue::Transfer>
+HostToDeviceTransferQueue::Enqueue(absl::Span<const HostBuffer> host_buffers) {
+  tsl::profiler::TraceMe traceme("HostToDeviceTransferQueue::Enqueue");
+  for (const HostBuffer& host_buffer : host_buffers) {
+    if (host_buffer.shape.IsTuple()) {
+      return Unimplemented(
+          "Batched host to device transfer of tuples not implemented.");
+    }
+  }
+  auto batch = std::make_shared<Batch>();
+  Transfer transfer;
+  for (const HostBuffer& host_buffer : host_buffers) {
+    batch->definition_events.push_back(
+        std::make_shared<BufferSequencingEvent>(client_->thread_pool()));
+    StatusOr<std::unique_ptr<PjRtBuffer>> buffer =
+        client_->CreateUninitializedBuffer(host_buffer.shape, device_,
+                                           batch->definition_events.back());
+    if (!buffer.ok()) {
+      for (const auto& definition_event : batch->definition_events) {
+        definition_event->SetDefinedStatus(buffer.status());
+      }
+      return buffer.status();
+    }
+    // The hold only fishes out the TrackedDeviceBuffer, which the batch keeps
+    // alive until its copies have completed.
+    auto hold = tensorflow::down_cast<PjRtStreamExecutorBuffer*>(buffer->get())
+                    ->GetBufferWithUsageHold();
+    DCHECK_EQ(hold.buffer()->device_memory().size(), 1);
+    batch->device_buffers.push_back(hold.buffer());
+    batch->data.push_back(host_buffer.data);
+    transfer.buffers.push_back(*std::move(buffer));
+  }
+  batch->host_buffers_done = PjRtFuture<Status>::CreatePromise();
+  transfer.host_buffers_done = PjRtFuture<Status>(batch->host_buffers_done);
+  {
+    absl::MutexLock lock(&mu_);
+    ++batches_in_flight_;
+  }
+  client_->thread_pool()->Schedule([this, batch]() { Pack(*batch); });
+  return transfer;
+}
+
+void HostToDeviceTransferQueue::Pack(Batch& batch) {
+  tsl::profiler::TraceMe traceme("HostToDeviceTransferQueue::Pack");
+  Status status;
+  auto chunk = std::make_unique<Chunk>(AcquireChunk());
+  for (int i = 0; i < batch.data.size() && status.ok(); ++i) {
+    se::DeviceMemoryBase& memory = batch.device_buffers[i]->device_memory()[0];
+    const char* data = static_cast<const char*>(batch.data[i]);
+    const int64_t buffer_size = memory.size();
+    int64_t offset = 0;
+    while (offset < buffer_size) {
+      if (chunk->used == options_.chunk_bytes) {
+        chunk->buffers_end = i;
+        chunk->splits_buffer = offset > 0;
+        status = Flush(batch, std::move(chunk));
+        if (!status.ok()) break;
+        chunk = std::make_unique<Chunk>(AcquireChunk());
+      }
+      const int64_t size =
+          std::min(buffer_size - offset, options_.chunk_bytes - chunk->used);
+      std::memcpy(chunk->data + chunk->used, data + offset, size);
+      chunk->copies.push_back({memory.GetByteSlice(offset, size), chunk->used});
+      if (chunk->device_buffers.empty() ||
+          chunk->device_buffers.back() != batch.device_buffers[i]) {
+        chunk->device_buffers.push_back(batch.device_buffers[i]);
+      }
+      chunk->used += size;
+      offset += size;
+    }
+  }
+  if (status.ok()) {
+    chunk->buffers_end = batch.data.size();
+    status = Flush(batch, std::move(chunk));
+  } else if (chunk != nullptr) {
+    ReleaseChunk(chunk->data);
+  }
+  if (!status.ok()) {
+    for (int i = batch.next_undefined_buffer; i < batch.data.size(); ++i) {
+      batch.definition_events[i]->SetDefinedStatus(status);
+    }
+  }
+  batch.host_buffers_done.Set(status);
+  absl::MutexLock lock(&mu_);
+  --batches_in_flight_;
+}
+
+Status HostToDeviceTransferQueue::Flush(Batch& batch,
+                                        std::unique_ptr<Chunk> chunk) {
+  if (chunk->copies.empty() &&
+      batch.next_undefined_buffer == chunk->buffers_end) {
+    ReleaseChunk(chunk->data);
+    return OkStatus();
+  }
+  se::Stream* stream = local_device_->GetHostToDeviceStream();
+  if (local_device_->allocation_model() ==
+      LocalDeviceState::kComputeSynchronized) {
+    // The buffers may only be written once the compute stream has finished
+    // the work enqueued before their allocation.
+    stream->ThenWaitFor(local_device_->compute_stream());
+  }
+  for (Chunk::Copy& copy : chunk->copies) {
+    stream->ThenMemcpy(&copy.dst, chunk->data + copy.offset, copy.dst.size());
+  }
+  if (batch.next_undefined_buffer < chunk->buffers_end) {
+    // The first buffer completed by this chunk may have earlier pieces on
+    // other streams.
+    for (se::Stream* split_stream : batch.split_buffer_streams) {
+      if (split_stream != stream) {
+        stream->ThenWaitFor(split_stream);
+      }
+    }
+    batch.split_buffer_streams.clear();
+  }
+  Status status;
+  for (; batch.next_undefined_buffer < chunk->buffers_end;
+       ++batch.next_undefined_buffer) {
+    auto event = local_device_->event_pool().AllocateEvent(stream->parent());
+    if (!event.ok()) {
+      status = event.status();
+      break;
+    }
+    local_device_->event_pool().ThenRecordEvent(stream, event.value());
+    batch.definition_events[batch.next_undefined_buffer]->SetSequencingEvent(
+        *std::move(event), stream);
+  }
+  if (chunk->splits_buffer) {
+    batch.split_buffer_streams.push_back(stream);
+  }
+  local_device_->ThenExecuteCallback(
+      stream, [this, data = chunk->data,
+               device_buffers = std::move(chunk->device_buffers)]() {
+        ReleaseChunk(data);
+      });
+  return status;
+}
+
+char* HostToDeviceTransferQueue::AcquireChunk() {
+  auto chunk_free = [this]() {
+    mu_.AssertHeld();
+    return !free_chunks_.empty();
+  };
+  absl::MutexLock lock(&mu_);
+  mu_.Await(absl::Condition(&chunk_free));
+  char* data = free_chunks_.back();
+  free_chunks_.pop_back();
+  return data;
+}
+
+void HostToDeviceTransferQueue::ReleaseChunk(char* data) {
+  absl::MutexLock lock(&mu_);
+  free_chunks_.push_back(data);
+}
+
+}  // namespace xla
@@ -0,0 +1,121 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_PJRT_HOST_TO_DEVICE_TRANSFER_QUEUE_H_
+#define XLA_PJRT_HOST_TO_DEVICE_TRANSFER_QUEUE_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_future.h"
+#include "xla/pjrt/pjrt_stream_executor_client.h"
+#include "xla/shape.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+
+namespace xla {
+
+// Transfers batches of host buffers to a device of a PjRtStreamExecutorClient,
+// e.g. the inputs of a training step.
+//
+// The host buffers of a batch are packed into staging chunks, which are
+// allocated once on the client's host memory allocator, i.e. in pinned memory
+// on GPU. Each chunk is copied to the device with one memcpy per buffer piece
+// on the next of the device's host to device streams (see
+// LocalDeviceState::StreamOptions::num_host_to_device_streams), while the next
+// chunk is packed, so that up to `Options::num_chunks` copies are in flight.
+//
+// Example:
+//   TF_ASSIGN_OR_RETURN(auto queue,
+//                       HostToDeviceTransferQueue::Create(device, {}));
+//   TF_ASSIGN_OR_RETURN(auto transfer, queue->Enqueue(host_buffers));
+//   // transfer.buffers may be passed to Execute() right away.
+//   transfer.host_buffers_done.OnReady([](Status s) { /* free them */ });
+class HostToDeviceTransferQueue {
+ public:
+  struct Options {
+    // The size of each staging chunk. Host buffers larger than a chunk are
+    // split across several of them.
+    int64_t chunk_bytes = 4 << 20;
+    // The number of staging chunks.
+    int num_chunks = 4;
+  };
+
+  // A host buffer holding the data of a device buffer of `shape`, already in
+  // the on-device layout, i.e. `data` has the on-device size of `shape`
+  // bytes (see PjRtClient::AsyncHostToDeviceTransferManager::buffer_size()).
+  struct HostBuffer {
+    const void* data;
+    Shape shape;
+  };
+
+  struct Transfer {
+    // The device buffers, which are defined once their copies have completed.
+    std::vector<std::unique_ptr<PjRtBuffer>> buffers;
+    // Becomes ready once all the data of the host buffers has been copied to
+    // the staging chunks, after which the host buffers may be freed.
+    PjRtFuture<Status> host_buffers_done;
+  };
+
+  static StatusOr<std::unique_ptr<HostToDeviceTransferQueue>> Create(
+      PjRtDevice* device, Options options);
+
+  HostToDeviceTransferQueue(const HostToDeviceTransferQueue&) = delete;
+  HostToDeviceTransferQueue& operator=(const HostToDeviceTransferQueue&) =
+      delete;
+  // Waits for the transfers in flight, then frees the staging chunks.
+  ~HostToDeviceTransferQueue();
+
+  // Creates a device buffer for each of `host_buffers` and starts their
+  // transfers, whose host side runs on the client's thread pool. The host
+  // buffers must stay alive until `Transfer::host_buffers_done` is ready.
+  StatusOr<Transfer> Enqueue(absl::Span<const HostBuffer> host_buffers);
+
+ private:
+  struct Batch;
+  struct Chunk;
+
+  HostToDeviceTransferQueue(PjRtStreamExecutorDevice* device,
+                            LocalDeviceState* local_device, Options options,
+                            std::vector<char*> chunks);
+
+  // Packs the host buffers of `batch` into chunks and enqueues their copies.
+  void Pack(Batch& batch);
+  // Enqueues the copies of `chunk` on the next host to device stream, and
+  // returns the chunk to the free list once they have completed.
+  Status Flush(Batch& batch, std::unique_ptr<Chunk> chunk);
+  // Blocks until a staging chunk is free.
+  char* AcquireChunk();
+  void ReleaseChunk(char* data);
+
+  PjRtStreamExecutorDevice* const device_;
+  LocalDeviceState* const local_device_;
+  PjRtStreamExecutorClient* const client_;
+  const Options options_;
+
+  absl::Mutex mu_;
+  std::vector<char*> free_chunks_ ABSL_GUARDED_BY(mu_);
+  // The batches which are being packed.
+  int batches_in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace xla
+
+#endif  // XLA_PJRT_HOST_TO_DEVICE_TRANSFER_QUEUE_H_
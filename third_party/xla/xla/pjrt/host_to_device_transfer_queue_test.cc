@@ -0,0 +1,111 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/pjrt/host_to_device_transfer_queue.h"
+
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "xla/client/client_library.h"
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/pjrt/local_device_state.h"
+#include "xla/pjrt/pjrt_stream_executor_client.h"
+#include "xla/service/platform_util.h"
+#include "xla/shape_util.h"
+#include "xla/test.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla {
+namespace {
+
+StatusOr<std::unique_ptr<PjRtStreamExecutorClient>> GetClient() {
+  LocalClient* local_client = xla::ClientLibrary::LocalClientOrDie();
+  TF_ASSIGN_OR_RETURN(se::Platform * platform,
+                      PlatformUtil::GetPlatform("Host"));
+  se::StreamExecutorConfig config;
+  config.ordinal = 0;
+  TF_ASSIGN_OR_RETURN(se::StreamExecutor * executor,
+                      platform->GetExecutor(config));
+  LocalDeviceState::StreamOptions stream_options;
+  stream_options.num_host_to_device_streams = 2;
+  auto device_state = std::make_unique<LocalDeviceState>(
+      executor, local_client, LocalDeviceState::kSynchronous,
+      /*max_inflight_computations=*/32,
+      /*allow_event_reuse=*/false, /*use_callback_stream=*/false,
+      /*device_ordinal=*/-1, stream_options);
+  auto device = std::make_unique<PjRtStreamExecutorDevice>(
+      0, std::move(device_state), "cpu");
+  std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> devices;
+  devices.emplace_back(std::move(device));
+  return std::make_unique<PjRtStreamExecutorClient>(
+      "cpu", local_client, std::move(devices), /*process_index=*/0,
+      /*allocator=*/nullptr, /*host_memory_allocator=*/nullptr,
+      /*should_stage_host_to_device_transfers=*/false,
+      /*gpu_run_options=*/nullptr);
+}
+
+std::vector<float> Iota(int64_t size, float start) {
+  std::vector<float> data(size);
+  std::iota(data.begin(), data.end(), start);
+  return data;
+}
+
+TEST(HostToDeviceTransferQueueTest, TransfersBuffersSplitAcrossChunks) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  PjRtDevice* device = client->addressable_devices()[0];
+  HostToDeviceTransferQueue::Options options;
+  // Small enough that the buffers are both packed together and split.
+  options.chunk_bytes = 64;
+  options.num_chunks = 2;
+  TF_ASSERT_OK_AND_ASSIGN(auto queue,
+                          HostToDeviceTransferQueue::Create(device, options));
+
+  const std::vector<std::vector<float>> host_data = {
+      Iota(3, 0), Iota(40, 100), Iota(0, 0), Iota(5, 200), Iota(16, 300)};
+  std::vector<HostToDeviceTransferQueue::HostBuffer> host_buffers;
+  for (const std::vector<float>& data : host_data) {
+    host_buffers.push_back(
+        {data.data(), ShapeUtil::MakeShape(
+                          F32, {static_cast<int64_t>(data.size())})});
+  }
+  TF_ASSERT_OK_AND_ASSIGN(auto transfer, queue->Enqueue(host_buffers));
+  TF_ASSERT_OK(transfer.host_buffers_done.Await());
+
+  ASSERT_EQ(transfer.buffers.size(), host_data.size());
+  for (int i = 0; i < host_data.size(); ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                            transfer.buffers[i]->ToLiteralSync());
+    EXPECT_EQ(*literal, LiteralUtil::CreateR1<float>(host_data[i]));
+  }
+}
+
+TEST(HostToDeviceTransferQueueTest, RejectsTuples) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto queue, HostToDeviceTransferQueue::Create(
+                      client->addressable_devices()[0], /*options=*/{}));
+  float data = 0;
+  std::vector<HostToDeviceTransferQueue::HostBuffer> host_buffers = {
+      {&data, ShapeUtil::MakeTupleShape({ShapeUtil::MakeShape(F32, {})})}};
+  EXPECT_FALSE(queue->Enqueue(host_buffers).ok());
+}
+
+}  // namespace
+}  // namespace xla
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include <gmock/gmock.h>
 #include "absl/functional/any_invocable.h"
+#include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/client/client_library.h"
 #include "xla/client/xla_builder.h"
@@ -161,5 +162,30 @@ TEST(PjRtStreamExecutorClientTest, DonateWithControlDependency) {
   TF_ASSERT_OK(literal_comparison::Equal(literal, *result_literal));
 }
 
+TEST(PjRtStreamExecutorClientTest, AsyncHostToDeviceTransfer) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  Shape shape = ShapeUtil::MakeShape(F32, {4});
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto transfer_manager,
+      client->CreateBuffersForAsyncHostToDevice(
+          {shape, shape}, client->addressable_devices()[0]));
+  auto first = LiteralUtil::CreateR1<float>({1, 2, 3, 4});
+  auto second = LiteralUtil::CreateR1<float>({5, 6, 7, 8});
+  TF_ASSERT_OK(transfer_manager->TransferLiteralToBuffer(0, first, []() {}));
+  const std::vector<float> raw_data = {5, 6, 7, 8};
+  TF_ASSERT_OK(transfer_manager->TransferRawDataToBuffer(
+      1,
+      absl::string_view(reinterpret_cast<const char*>(raw_data.data()),
+                        raw_data.size() * sizeof(float)),
+      []() {}));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto first_literal,
+                          transfer_manager->RetrieveBuffer(0)->ToLiteralSync());
+  EXPECT_EQ(*first_literal, first);
+  TF_ASSERT_OK_AND_ASSIGN(auto second_literal,
+                          transfer_manager->RetrieveBuffer(1)->ToLiteralSync());
+  EXPECT_EQ(*second_literal, second);
+}
+
 }  // namespace
 }  // namespace xla
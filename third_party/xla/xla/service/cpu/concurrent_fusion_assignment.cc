@@ -0,0 +1,145 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/concurrent_fusion_assignment.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/statusor.h"
+#include "xla/util.h"
+#include "tsl/platform/logging.h"  // IWYU pragma: keep
+#include "tsl/platform/status.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Outlines each of 'fusions' of 'computation' into its own computation, and
+// the calls to them into a computation whose root tuple is marked to run them
+// concurrently.
+void OutlineConcurrentFusions(HloModule* module, HloComputation* computation,
+                              absl::Span<HloInstruction* const> fusions,
+                              const std::string& name) {
+  std::vector<HloInstruction*> calls;
+  std::vector<std::vector<HloInstruction*>> users;
+  for (HloInstruction* fusion : fusions) {
+    calls.push_back(module->OutlineExpressionFromComputation(
+        {fusion}, absl::StrCat("concurrent_", fusion->name()), computation));
+    users.push_back(calls.back()->users());
+  }
+
+  // Gather the results of the calls in a tuple, so that the calls and the
+  // tuple have a single output to outline.
+  HloInstruction* tuple =
+      computation->AddInstruction(HloInstruction::CreateTuple(calls));
+  for (int64_t i = 0; i < calls.size(); ++i) {
+    HloInstruction* gte = computation->AddInstruction(
+        HloInstruction::CreateGetTupleElement(tuple, i));
+    for (HloInstruction* user : users[i]) {
+      TF_CHECK_OK(calls[i]->ReplaceUseWith(user, gte));
+    }
+    if (computation->root_instruction() == calls[i]) {
+      computation->set_root_instruction(gte);
+    }
+  }
+
+  std::vector<HloInstruction*> instructions_to_outline(calls);
+  instructions_to_outline.push_back(tuple);
+  HloInstruction* group = module->OutlineExpressionFromComputation(
+      instructions_to_outline, name, computation);
+
+  BackendConfig backend_config;
+  backend_config.set_concurrent_calls(true);
+  HloInstruction* root = group->to_apply()->root_instruction();
+  TF_CHECK_OK(root->set_backend_config(backend_config));
+  VLOG(2) << "Assigned " << fusions.size()
+          << " concurrent fusions to: " << group->name();
+}
+
+}  // namespace
+
+bool ConcurrentFusionAssigner::IsCandidate(
+    const HloInstruction* instruction) const {
+  // Loop fusions run without temporaries or calls into the runtime, which
+  // could block on the thread pool they are running on.
+  return instruction->opcode() == HloOpcode::kFusion &&
+         instruction->fusion_kind() == HloInstruction::FusionKind::kLoop &&
+         instruction->shape().IsArray() &&
+         instruction->control_predecessors().empty() &&
+         instruction->control_successors().empty() &&
+         shape_size_function_(instruction->shape()) >= min_fusion_bytes_;
+}
+
+StatusOr<bool> ConcurrentFusionAssigner::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  if (max_parallelism_ <= 1) {
+    return false;
+  }
+  XLA_VLOG_LINES(2, "ConcurrentFusionAssigner ENTRY");
+  XLA_VLOG_LINES(3, module->ToString());
+  HloComputation* computation = module->entry_computation();
+
+  // The instructions at the same longest distance from the parameters don't
+  // depend on each other.
+  absl::flat_hash_map<const HloInstruction*, int64_t> levels;
+  std::map<int64_t, std::vector<HloInstruction*>> candidates_by_level;
+  for (HloInstruction* instruction : computation->MakeInstructionPostOrder()) {
+    int64_t level = 0;
+    for (const HloInstruction* operand : instruction->operands()) {
+      level = std::max(level, levels[operand] + 1);
+    }
+    for (const HloInstruction* predecessor :
+         instruction->control_predecessors()) {
+      level = std::max(level, levels[predecessor] + 1);
+    }
+    levels[instruction] = level;
+    if (IsCandidate(instruction)) {
+      candidates_by_level[level].push_back(instruction);
+    }
+  }
+
+  int64_t num_groups = 0;
+  for (const auto& [level, candidates] : candidates_by_level) {
+    for (int64_t begin = 0; begin + 1 < candidates.size();
+         begin += max_parallelism_) {
+      OutlineConcurrentFusions(
+          module, computation,
+          absl::MakeConstSpan(candidates).subspan(begin, max_parallelism_),
+          absl::StrCat("concurrent_fusions.", num_groups++));
+    }
+  }
+
+  XLA_VLOG_LINES(2, "ConcurrentFusionAssigner EXIT");
+  XLA_VLOG_LINES(3, module->ToString());
+  return num_groups > 0;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,77 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_CONCURRENT_FUSION_ASSIGNMENT_H_
+#define XLA_SERVICE_CPU_CONCURRENT_FUSION_ASSIGNMENT_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/hlo_cost_analysis.h"
+#include "xla/service/hlo_pass_interface.h"
+#include "xla/statusor.h"
+
+namespace xla {
+namespace cpu {
+
+// ConcurrentFusionAssigner groups the loop fusions of the entry computation
+// that are at the same dependency level, i.e. the same longest distance from
+// the parameters, and so are independent of each other. Each fusion of a
+// group is outlined into its own embedded computation, and the calls to them
+// are outlined together into a computation whose root tuple gathers their
+// results. That computation is invoked from a kCall instruction that is
+// lowered in codegen to a runtime call running the fusions concurrently on
+// the intra-op thread pool.
+//
+// As the results of a group and the operands of its fusions are all live
+// until its tuple, buffer assignment keeps their buffers disjoint.
+//
+// Fusions smaller than 'min_fusion_bytes' aren't worth the dispatch, and
+// groups have at most 'max_parallelism' fusions.
+class ConcurrentFusionAssigner : public HloModulePass {
+ public:
+  ConcurrentFusionAssigner(int64_t max_parallelism,
+                           const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                           int64_t min_fusion_bytes = 16 * 1024)
+      : max_parallelism_(max_parallelism),
+        shape_size_function_(shape_size),
+        min_fusion_bytes_(min_fusion_bytes) {}
+  ~ConcurrentFusionAssigner() override = default;
+
+  absl::string_view name() const override {
+    return "cpu-concurrent-fusion-assigner";
+  }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  // Returns true if 'instruction' may run concurrently with the other
+  // fusions of its level.
+  bool IsCandidate(const HloInstruction* instruction) const;
+
+  int64_t max_parallelism_;
+  HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+  int64_t min_fusion_bytes_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_CPU_CONCURRENT_FUSION_ASSIGNMENT_H_
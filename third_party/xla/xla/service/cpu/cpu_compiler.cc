@@ -44,10 +44,15 @@ limitations under the License.
 #include "absl/types/span.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/IR/Constant.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
@@ -56,6 +61,7 @@ limitations under the License.
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
@@ -64,6 +70,7 @@ limitations under the License.
 #include "llvm/TargetParser/Host.h"
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/TargetParser/X86TargetParser.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Conversion/AffineToStandard/AffineToStandard.h"  // from @llvm-project
 #include "mlir/Conversion/ReconcileUnrealizedCasts/ReconcileUnrealizedCasts.h"  // from @llvm-project
 #include "mlir/Dialect/Affine/IR/AffineOps.h"  // from @llvm-project
@@ -138,6 +145,7 @@ limitations under the License.
 #include "xla/service/copy_insertion.h"
 #include "xla/service/cpu/buffer_info_util.h"
 #include "xla/service/cpu/compiler_functor.h"
+#include "xla/service/cpu/concurrent_fusion_assignment.h"
 #include "xla/service/cpu/conv_canonicalization.h"
 #include "xla/service/cpu/cpu_executable.h"
 #include "xla/service/cpu/cpu_instruction_fusion.h"
@@ -181,6 +189,7 @@ limitations under the License.
 #include "xla/service/hlo_pass_fix.h"
 #include "xla/service/hlo_pass_pipeline.h"
 #include "xla/service/hlo_profile_printer_data.pb.h"
+#include "xla/service/hlo_rematerialization.h"
 #include "xla/service/hlo_verifier.h"
 #include "xla/service/indexed_array_analysis.h"
 #include "xla/service/layout_assignment.h"
@@ -235,6 +244,7 @@ limitations under the License.
 #include "tsl/platform/cpu_info.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"  // IWYU pragma: keep
+#include "tsl/platform/numbers.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
 
@@ -339,6 +349,7 @@ ModuleComputationsTransitivelyContainCustomCall(const HloModule& module) {
 
 namespace cpu {
 using BufferInfo = cpu_function_runtime::BufferInfo;
+using ::tsl::strings::HumanReadableNumBytes;
 
 CpuAotCompilationOptions::CpuAotCompilationOptions(
     std::string triple, std::string cpu_name, std::string features,
@@ -984,6 +995,13 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+    // Run the remaining independent loop fusions concurrently. This runs after
+    // ParallelTaskAssigner so that the concurrent fusions don't fork and join
+    // on the thread pool they are running on.
+    if (module->config().debug_options().xla_cpu_enable_concurrent_fusions()) {
+      pipeline.AddPass<ConcurrentFusionAssigner>(max_parallelism,
+                                                 ShapeSizeBytesFunction());
+    }
   }
   // Copy insertion should be performed immediately before IR emission to
   // avoid inserting unnecessary copies (later pass adds an instruction which
@@ -1134,15 +1152,63 @@ StatusOr<std::unique_ptr<HloModule>> CpuCompiler::RunHloPasses(
   return std::move(module);
 }
 
+StatusOr<HloSchedule> CpuCompiler::CreateHloSchedule(HloModule* module) {
+  // Using this sequence enables tighter buffer liveness analysis and reduced
+  // memory usage (as compared to using DependencyHloOrdering).
+  const int64_t memory_budget =
+      module->config().debug_options().xla_cpu_memory_budget_bytes();
+  if (memory_budget <= 0) {
+    return ScheduleModule(
+        module, BufferSizeBytesFunction(),
+        ComputationSchedulerToModuleScheduler(DFSMemoryScheduler));
+  }
+
+  // Under a budget, pick whichever of the list, DFS and post-order schedulers
+  // has the least peak memory.
+  int64_t peak_memory = 0;
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      ScheduleModule(module, BufferSizeBytesFunction(), DefaultModuleScheduler,
+                     /*execution_threads=*/{}, &peak_memory));
+  if (peak_memory <= memory_budget) {
+    VLOG(1) << "Peak memory of " << module->name() << ": "
+            << HumanReadableNumBytes(peak_memory) << ", within the budget of "
+            << HumanReadableNumBytes(memory_budget);
+    return std::move(schedule);
+  }
+
+  // Then split the live ranges of the buffers that are live across the peak
+  // by recomputing them right before their later uses.
+  TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
+  HloCostAnalysis cost_analysis(ShapeSizeBytesFunction());
+  HloRematerialization::Options options(
+      cost_analysis,
+      HloRematerialization::RematerializationModeConfig(
+          /*recompute=*/true, /*compress=*/false, /*host_offload=*/false),
+      /*memory_limit_bytes=*/memory_budget, /*block_size_limit=*/1,
+      /*block_rematerialization_factor=*/1, /*min_remat_size=*/0,
+      /*compact_shape_function=*/nullptr,
+      /*host_memory_offload_config=*/std::nullopt);
+  HloRematerialization::RematerializationSizes sizes;
+  TF_RETURN_IF_ERROR(HloRematerialization(options, sizes).Run(module).status());
+  if (sizes.after_bytes > memory_budget) {
+    LOG(WARNING) << "Can't fit the peak memory of " << module->name()
+                 << " into the budget of "
+                 << HumanReadableNumBytes(memory_budget) << ", lowest: "
+                 << HumanReadableNumBytes(sizes.after_bytes);
+  } else {
+    VLOG(1) << "Rematerialization reduced the peak memory of "
+            << module->name() << " from "
+            << HumanReadableNumBytes(sizes.before_bytes) << " to "
+            << HumanReadableNumBytes(sizes.after_bytes);
+  }
+  return module->schedule();
+}
+
 StatusOr<std::unique_ptr<BufferAssignment>> CpuCompiler::AssignBuffers(
     HloModule* module, const se::StreamExecutor* /*stream_exec*/) {
   // Select an order for emitting the HLO instructions for each computation.
-  // Using this sequence enables tighter buffer liveness analysis and reduced
-  // memory usage (as compared to using DependencyHloOrdering).
-  TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                      ScheduleModule(module, BufferSizeBytesFunction(),
-                                     ComputationSchedulerToModuleScheduler(
-                                         DFSMemoryScheduler)));
+  TF_ASSIGN_OR_RETURN(HloSchedule schedule, CreateHloSchedule(module));
   TF_RETURN_IF_ERROR(module->set_schedule(std::move(schedule)));
 
   // Run buffer allocation on the HLO graph.
@@ -1365,10 +1431,70 @@ std::vector<ComputationToEmit> SubcomputationEmissionOrder(
   return postorder;
 }
 
+std::unique_ptr<llvm::Module> CopyToContext(const llvm::Module& module,
+                                            llvm::LLVMContext& context) {
+  llvm::SmallString<0> bitcode;
+  llvm::raw_svector_ostream bitcode_ostream(bitcode);
+  llvm::WriteBitcodeToFile(module, bitcode_ostream);
+
+  llvm::Expected<std::unique_ptr<llvm::Module>> new_module =
+      llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()),
+                                "split_module"),
+          context);
+  CHECK(new_module) << "Failed to parse bitcode "
+                    << llvm::toString(new_module.takeError());
+
+  return std::move(new_module.get());
+}
+
+// Splits `llvm_module` into up to `num_modules` modules, each in its own
+// context so that they can be compiled concurrently. The computations are
+// externalized so that they can be called across modules, and the constant
+// globals are copied into every module that uses them so that they can still
+// be constant-folded.
+std::vector<llvm::orc::ThreadSafeModule> SplitModuleForParallelCodegen(
+    llvm::Module& llvm_module, int num_modules) {
+  int num_functions = 0;
+  for (llvm::Function& func : llvm_module.functions()) {
+    if (!func.isDeclaration()) num_functions++;
+  }
+
+  absl::flat_hash_map<std::string, llvm::Constant*> const_initializer_map;
+  for (llvm::GlobalVariable& gv : llvm_module.globals()) {
+    if (gv.hasName() && gv.isConstant() && gv.hasInitializer()) {
+      const_initializer_map[gv.getName().str()] = gv.getInitializer();
+    }
+  }
+
+  std::vector<llvm::orc::ThreadSafeModule> modules;
+  llvm::SplitModule(
+      llvm_module,
+      std::max<unsigned>(1, std::min<unsigned>(num_modules, num_functions)),
+      [&](std::unique_ptr<llvm::Module> module) {
+        for (llvm::GlobalVariable& gv : module->globals()) {
+          auto it = const_initializer_map.find(gv.getName().str());
+          if (gv.hasName() && gv.isConstant() && !gv.hasInitializer() &&
+              it != const_initializer_map.end()) {
+            gv.setInitializer(it->second);
+            gv.setLinkage(llvm::GlobalValue::InternalLinkage);
+          }
+        }
+        auto context = std::make_unique<llvm::LLVMContext>();
+        std::unique_ptr<llvm::Module> new_module =
+            CopyToContext(*module, *context);
+        modules.emplace_back(std::move(new_module), std::move(context));
+      },
+      /*PreserveLocals=*/false);
+  return modules;
+}
+
 }  // namespace
 
 StatusOr<std::unique_ptr<CpuExecutable>>
-CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
+CpuCompiler::CompileLegacyCpuExecutable(
+    std::unique_ptr<HloModule> module,
+    tsl::thread::ThreadPool* default_thread_pool) {
   ModuleHook pre_optimization_ir_hook;
   ModuleHook post_optimization_ir_hook;
   std::tie(pre_optimization_ir_hook, post_optimization_ir_hook) =
@@ -1421,12 +1547,8 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
       module->config().debug_options().xla_embed_ir_in_executable();
 
   // Select an order for emitting the HLO instructions for each
-  // computation. Using this sequence enables tighter buffer liveness analysis
-  // and reduced memory usage (as compared to using DependencyHloOrdering).
-  TF_ASSIGN_OR_RETURN(HloSchedule schedule,
-                      ScheduleModule(module.get(), BufferSizeBytesFunction(),
-                                     ComputationSchedulerToModuleScheduler(
-                                         DFSMemoryScheduler)));
+  // computation.
+  TF_ASSIGN_OR_RETURN(HloSchedule schedule, CreateHloSchedule(module.get()));
 
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
@@ -1498,10 +1620,31 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
 
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
-  // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  // JIT compile the LLVM IR module to in-memory machine code, optionally split
+  // into modules that are optimized and compiled in parallel.
+  const int split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  MaybeOwningThreadPool thread_pool =
+      split_count > 1 ? MaybeOwningThreadPool::GetOrCreate(
+                            /*parallelism=*/0,
+                            /*default_thread_pool=*/default_thread_pool,
+                            /*default_parallelism=*/split_count)
+                      : MaybeOwningThreadPool(nullptr);
+  if (thread_pool) {
+    std::vector<llvm::orc::ThreadSafeModule> thread_safe_modules =
+        SplitModuleForParallelCodegen(*llvm_module, split_count);
+    VLOG(1) << "Compiling " << thread_safe_modules.size()
+            << " LLVM modules in parallel";
+    if (llvm::Error error = (*jit)->AddModules(std::move(thread_safe_modules),
+                                               thread_pool.get())) {
+      return Internal("Compiling LLVM modules failed: %s",
+                      llvm::toString(std::move(error)));
+    }
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   TF_ASSIGN_OR_RETURN(
       auto cpu_executable,
@@ -1554,13 +1697,9 @@ StatusOr<std::unique_ptr<CpuExecutable>>
 CpuCompiler::CompileXlaRuntimeCpuExecutable(
     std::unique_ptr<HloModule> hlo_module) {
   // Select an order for emitting the HLO instructions for each
-  // computation. Using this sequence enables tighter buffer liveness analysis
-  // and reduced memory usage (as compared to using DependencyHloOrdering).
-  TF_ASSIGN_OR_RETURN(
-      HloSchedule schedule,
-      ScheduleModule(
-          hlo_module.get(), BufferSizeBytesFunction(),
-          ComputationSchedulerToModuleScheduler(DFSMemoryScheduler)));
+  // computation.
+  TF_ASSIGN_OR_RETURN(HloSchedule schedule,
+                      CreateHloSchedule(hlo_module.get()));
 
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
@@ -1626,17 +1765,31 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
   absl::call_once(llvm_command_line_options_initialized,
                   &InitializeLLVMCommandLineOptions, module->config());
 
+  const int64_t memory_budget =
+      module->config().debug_options().xla_cpu_memory_budget_bytes();
   std::unique_ptr<CpuExecutable> cpu_executable;
   if (module->config().debug_options().xla_cpu_use_xla_runtime()) {
     TF_ASSIGN_OR_RETURN(cpu_executable,
                         CompileXlaRuntimeCpuExecutable(std::move(module)));
   } else {
     TF_ASSIGN_OR_RETURN(cpu_executable,
-                        CompileLegacyCpuExecutable(std::move(module)));
+                        CompileLegacyCpuExecutable(std::move(module),
+                                                   options.thread_pool));
   }
 
-  cpu_executable->set_debug_info(
-      cpu_executable->buffer_assignment().GetStats().ToString());
+  std::string debug_info =
+      cpu_executable->buffer_assignment().GetStats().ToString();
+  if (memory_budget > 0) {
+    // The temporaries are a single allocation, so their size is the peak.
+    const int64_t peak_memory = cpu_executable->buffer_assignment()
+                                    .GetStats()
+                                    .preallocated_temp_allocation_bytes;
+    absl::StrAppendFormat(
+        &debug_info, "                    memory budget: %10s (%s)\n",
+        HumanReadableNumBytes(memory_budget),
+        peak_memory <= memory_budget ? "met" : "exceeded");
+  }
+  cpu_executable->set_debug_info(std::move(debug_info));
   VLOG(1) << "Compilation finished";
   return std::unique_ptr<Executable>(std::move(cpu_executable));
 }
@@ -26,6 +26,7 @@ limitations under the License.
 #include "xla/cpu_function_runtime.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/hlo/ir/hlo_module_group.h"
+#include "xla/hlo/ir/hlo_schedule.h"
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/compiler.h"
 #include "xla/service/cpu/executable.pb.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "xla/statusor.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "xla/util.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -232,8 +234,17 @@ class CpuCompiler : public LLVMCompiler {
       HloModule* module, bool is_aot_compile,
       LLVMTargetMachineFeatures* target_machine_features, bool is_mlir_compile);
 
+  // Splits the LLVM IR across the threads of `default_thread_pool`, if not
+  // null, when --xla_cpu_parallel_codegen_split_count asks for it.
   StatusOr<std::unique_ptr<CpuExecutable>> CompileLegacyCpuExecutable(
-      std::unique_ptr<HloModule> module);
+      std::unique_ptr<HloModule> module,
+      tsl::thread::ThreadPool* default_thread_pool);
+
+  // Returns the order in which to emit the HLO instructions of each
+  // computation of `module`. Under --xla_cpu_memory_budget_bytes, this picks
+  // the schedule with the least peak memory and may rematerialize instructions
+  // of `module` to fit it into the budget.
+  StatusOr<HloSchedule> CreateHloSchedule(HloModule* module);
 
   CpuCompiler(const CpuCompiler&) = delete;
   CpuCompiler& operator=(const CpuCompiler&) = delete;
@@ -2362,6 +2362,44 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
     if (ComputationTransitivelyContainsCustomCall(computation)) {
       EmitEarlyReturnIfErrorStatus();
     }
+  } else if (backend_config_or.ok() && backend_config_or->concurrent_calls() &&
+             absl::c_all_of(computation->root_instruction()->operands(),
+                            [](const HloInstruction* operand) {
+                              return operand->opcode() == HloOpcode::kCall;
+                            })) {
+    // The root tuple of this computation gathers the results of independent
+    // calls, which the parallel calls runtime runs concurrently in place of
+    // the computation. Their buffers are disjoint, as they are all live until
+    // the tuple.
+    HloInstruction* root = computation->root_instruction();
+    std::vector<llvm::Function*> functions;
+    llvm::SmallVector<llvm::Value*> base_ptrs;
+    for (const HloInstruction* operand : root->operands()) {
+      functions.push_back(FindOrDie(
+          emitted_functions_,
+          ComputationToEmit{operand->to_apply(), allow_reassociation_}));
+      TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice slice,
+                          assignment_.GetUniqueTopLevelSlice(operand));
+      base_ptrs.push_back(EmitBufferPointer(slice, operand->shape()));
+    }
+
+    TF_RETURN_IF_ERROR(EmitCallToParallelCalls(
+        GetArrayFunctionCallArguments(
+            {}, &b_, computation->name(),
+            /*return_value_buffer=*/
+            llvm::Constant::getNullValue(b_.getPtrTy()),
+            /*exec_run_options_arg=*/GetExecutableRunOptionsArgument(),
+            /*buffer_table_arg=*/GetBufferTableArgument(),
+            /*status_arg=*/GetStatusArgument(),
+            /*profile_counters_arg=*/GetProfileCountersArgument()),
+        functions, &b_, computation->name()));
+
+    if (ComputationTransitivelyContainsCustomCall(computation)) {
+      EmitEarlyReturnIfErrorStatus();
+    }
+
+    // Build the tuple the computation would have returned.
+    llvm_ir::EmitTuple(GetIrArrayFor(call), base_ptrs, &b_);
   } else {
     EmitGlobalCall(*computation, computation->name());
   }
@@ -332,5 +332,59 @@ Status EmitCallToParallelForkJoin(
   return OkStatus();
 }
 
+// Emits a call to a runtime function which dispatches concurrent calls to
+// 'functions' (and joins threads before returning).
+Status EmitCallToParallelCalls(const std::vector<llvm::Value*>& arguments,
+                               absl::Span<llvm::Function* const> functions,
+                               llvm::IRBuilder<>* b, absl::string_view name) {
+  llvm::Module* module = b->GetInsertBlock()->getModule();
+
+  // Build ParallelCalls function type.
+  std::vector<llvm::Type*> compute_function_params =
+      GetComputeFunctionParams(module, /*num_dynamic_loop_bounds=*/0);
+  // Number of compute functions.
+  compute_function_params.push_back(b->getInt32Ty());
+  // Array of compute function pointers.
+  compute_function_params.push_back(
+      llvm::PointerType::get(module->getContext(), 0));
+
+  llvm::FunctionType* parallel_calls_type = llvm::FunctionType::get(
+      /*Result=*/llvm::Type::getVoidTy(module->getContext()),
+      /*Params=*/compute_function_params,
+      /*isVarArg=*/false);
+
+  llvm::Function* parallel_calls_func = llvm::dyn_cast<llvm::Function>(
+      module
+          ->getOrInsertFunction(runtime::kParallelCallsSymbolName,
+                                parallel_calls_type)
+          .getCallee());
+  parallel_calls_func->setCallingConv(llvm::CallingConv::C);
+  parallel_calls_func->setDoesNotThrow();
+
+  // Create global variable out of the function pointers in 'functions'.
+  std::vector<llvm::Constant*> function_ptrs(functions.begin(),
+                                             functions.end());
+  llvm::ArrayType* functions_array_type = llvm::ArrayType::get(
+      llvm::PointerType::get(module->getContext(), 0), functions.size());
+  llvm::GlobalVariable* global_functions_array = new llvm::GlobalVariable(
+      /*M=*/*module,
+      /*Ty=*/functions_array_type,
+      /*isConstant=*/true,
+      /*Linkage=*/llvm::GlobalValue::PrivateLinkage,
+      /*Initializer=*/
+      llvm::ConstantArray::get(functions_array_type, function_ptrs),
+      /*Name=*/absl::StrCat(name, "_parallel_calls"));
+
+  std::vector<llvm::Value*> parallel_calls_arguments(arguments);
+  // Add argument specifying the number of compute functions.
+  parallel_calls_arguments.push_back(b->getInt32(functions.size()));
+  // Add argument for the compute function pointers.
+  parallel_calls_arguments.push_back(global_functions_array);
+  // Emit call to parallel calls.
+  b->CreateCall(parallel_calls_func, parallel_calls_arguments);
+
+  return OkStatus();
+}
+
 }  // namespace cpu
 }  // namespace xla
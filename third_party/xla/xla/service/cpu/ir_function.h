@@ -150,6 +150,13 @@ Status EmitCallToParallelForkJoin(
     absl::Span<const int64_t> dimension_partition_counts, llvm::IRBuilder<>* b,
     llvm::Function* parallel_function, absl::string_view name);
 
+// Emits a call to a runtime function which runs 'functions', compute functions
+// of independent global computations, concurrently (and joins threads before
+// returning).
+Status EmitCallToParallelCalls(const std::vector<llvm::Value*>& arguments,
+                               absl::Span<llvm::Function* const> functions,
+                               llvm::IRBuilder<>* b, absl::string_view name);
+
 }  // namespace cpu
 }  // namespace xla
 
@@ -28,6 +28,44 @@ limitations under the License.
 
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
+using CallFunctionType = void (*)(void*, const void*, const void**, void**,
+                                  void*, uint64_t*);
+
+namespace {
+
+// Sets 'status' to a failure joining the error messages of 'statuses', if
+// any, each prefixed with '<kind> <index>'.
+void SetFailureFromStatuses(absl::string_view kind,
+                            std::vector<XlaCustomCallStatus>& statuses,
+                            void* status) {
+  // Collect all error messages (if any).
+  std::vector<std::pair<int32_t, absl::string_view>> error_messages;
+  for (int32_t i = 0; i < static_cast<int32_t>(statuses.size()); ++i) {
+    std::optional<absl::string_view> msg =
+        xla::CustomCallStatusGetMessage(&statuses[i]);
+    if (msg) {
+      error_messages.emplace_back(i, *msg);
+    }
+  }
+
+  if (!error_messages.empty()) {
+    // Join all error messages into a single string to serve as the message for
+    // the returned status.
+    std::string error_message = absl::StrJoin(
+        error_messages, "\n",
+        [kind](std::string* out, std::pair<int32_t, absl::string_view> p) {
+          int32_t idx = p.first;
+          absl::string_view msg = p.second;
+          absl::StrAppend(out,
+                          absl::StrFormat("%s %d error: %s", kind, idx, msg));
+        });
+    XlaCustomCallStatusSetFailure(
+        reinterpret_cast<XlaCustomCallStatus*>(status), error_message.data(),
+        error_message.length());
+  }
+}
+
+}  // namespace
 
 // Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
 // Calls 'function_ptr' for first partition inline.
@@ -102,30 +140,56 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   VLOG(3) << "ParallelForkJoin partition 0 done.";
   bc.Wait();
 
-  // Collect all error messages (if any).
-  std::vector<std::pair<int32_t, absl::string_view>> error_messages;
-  for (int32_t i = 0; i < num_partitions; ++i) {
-    std::optional<absl::string_view> msg =
-        xla::CustomCallStatusGetMessage(&statuses[i]);
-    if (msg) {
-      error_messages.emplace_back(i, *msg);
+  SetFailureFromStatuses("Partition", statuses, status);
+  VLOG(2) << "ParallelForkJoin EXIT";
+}
+
+// Dispatches calls to 'functions[1]' ... 'functions[num_functions - 1]' in
+// parallel, and calls 'functions[0]' inline.
+// Uses blocking counter to synchronize threads after parallel calls complete.
+//
+// The functions are the compute functions of independent computations, which
+// read and write disjoint buffers of 'buffer_table'. They run one after the
+// other if there is no intra-op thread pool.
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelCalls(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** buffer_table, void* status, uint64_t* prof_counters,
+    int32_t num_functions, void** functions) {
+  VLOG(2) << "ParallelCalls ENTRY"
+          << " num_functions: " << num_functions;
+  CHECK_EQ(params, nullptr);
+  CHECK_GT(num_functions, 1);
+  CHECK_NE(functions, nullptr);
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  CHECK_NE(run_options, nullptr);
+
+  std::vector<XlaCustomCallStatus> statuses(num_functions);
+  auto call = [&](int32_t i) {
+    reinterpret_cast<CallFunctionType>(functions[i])(
+        result_ptr, run_options_ptr, nullptr, buffer_table, &statuses[i],
+        prof_counters);
+    VLOG(3) << "ParallelCalls function " << i << " done.";
+  };
+
+  if (run_options->intra_op_thread_pool() == nullptr) {
+    for (int32_t i = 0; i < num_functions; ++i) call(i);
+  } else {
+    // Dispatch 'num_functions - 1' compute functions to run in parallel.
+    tsl::BlockingCounter bc(num_functions - 1);
+    for (int32_t i = 1; i < num_functions; ++i) {
+      run_options->intra_op_thread_pool()->enqueueNoNotification(
+          [i, &call, &bc]() {
+            call(i);
+            bc.DecrementCount();
+          });
     }
-  }
 
-  if (!error_messages.empty()) {
-    // Join all error messages into a single string to serve as the message for
-    // the returned status.
-    std::string error_message = absl::StrJoin(
-        error_messages, "\n",
-        [](std::string* out, std::pair<int32_t, absl::string_view> p) {
-          int32_t idx = p.first;
-          absl::string_view msg = p.second;
-          absl::StrAppend(out,
-                          absl::StrFormat("Partition %d error: %s", idx, msg));
-        });
-    XlaCustomCallStatusSetFailure(
-        reinterpret_cast<XlaCustomCallStatus*>(status), error_message.data(),
-        error_message.length());
+    // Call first compute function inline.
+    call(0);
+    bc.Wait();
   }
-  VLOG(2) << "ParallelForkJoin EXIT";
+
+  SetFailureFromStatuses("Function", statuses, status);
+  VLOG(2) << "ParallelCalls EXIT";
 }
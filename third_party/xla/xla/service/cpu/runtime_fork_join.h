@@ -28,6 +28,14 @@ extern void __xla_cpu_runtime_ParallelForkJoin(
     int32_t num_partitions, int64_t* partitions, int32_t num_partitioned_dims,
     void* function_ptr);
 
+// Runs the 'num_functions' compute functions of 'functions' concurrently and
+// joins threads before returning. See comments in runtime_fork_join.cc for
+// details.
+extern void __xla_cpu_runtime_ParallelCalls(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** buffer_table, void* status, uint64_t* prof_counters,
+    int32_t num_functions, void** functions);
+
 }  // extern "C"
 
 #endif  // XLA_SERVICE_CPU_RUNTIME_FORK_JOIN_H_
@@ -22,10 +22,13 @@ limitations under the License.
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <string>
 #include <system_error>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
@@ -35,6 +38,7 @@ limitations under the License.
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/Alignment.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/Memory.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Process.h"
@@ -63,6 +67,7 @@ limitations under the License.
 #include "xla/service/custom_call_target_registry.h"
 #include "xla/types.h"
 #include "xla/util.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/logging.h"
 
 #if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
@@ -317,6 +322,15 @@ SimpleOrcJIT::SimpleOrcJIT(
     : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       target_triple_(target_machine_->getTargetTriple()),
       data_layout_(target_machine_->createDataLayout()),
+      target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      disable_slp_vectorizer_(disable_slp_vectorizer),
+      fast_math_flags_(fast_math_flags),
+      pre_optimization_hook_(std::move(pre_optimization_hook)),
+      post_optimization_hook_(std::move(post_optimization_hook)),
+      post_codegen_hook_(std::move(post_codegen_hook)),
       target_process_control_(std::move(target_process_control)),
       execution_session_(std::move(execution_session)),
       object_layer_(*execution_session_,
@@ -324,14 +338,8 @@ SimpleOrcJIT::SimpleOrcJIT(
                       return std::make_unique<ContiguousSectionMemoryManager>(
                           orc_jit_memory_mapper::GetInstance());
                     }),
-      compile_layer_(
-          *execution_session_, object_layer_,
-          std::make_unique<CompilerFunctor>(
-              target_machine_.get(), static_cast<int>(opt_level),
-              optimize_for_size, disable_expensive_passes,
-              disable_slp_vectorizer, fast_math_flags,
-              std::move(pre_optimization_hook),
-              std::move(post_optimization_hook), std::move(post_codegen_hook))),
+      compile_layer_(*execution_session_, object_layer_,
+                     CreateCompiler(target_machine_.get())),
       main_jit_dylib_(&execution_session_->createBareJITDylib("<main>")),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()),
@@ -455,6 +463,64 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddModules(
+    std::vector<llvm::orc::ThreadSafeModule> modules,
+    tsl::thread::ThreadPool* thread_pool) {
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> obj_files(modules.size());
+  std::vector<std::string> errors(modules.size());
+  tsl::BlockingCounter counter(modules.size());
+  for (int i = 0; i < modules.size(); ++i) {
+    thread_pool->Schedule([&, i] {
+      // Target machines aren't thread-safe.
+      std::unique_ptr<llvm::TargetMachine> target_machine =
+          InferTargetMachineForJIT(target_options_, opt_level_);
+      std::unique_ptr<CompilerFunctor> compiler =
+          CreateCompiler(target_machine.get());
+      modules[i].withModuleDo([&](llvm::Module& module) {
+        llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> obj_file =
+            (*compiler)(module);
+        if (obj_file) {
+          obj_files[i] = std::move(*obj_file);
+        } else {
+          errors[i] = llvm::toString(obj_file.takeError());
+        }
+      });
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (int i = 0; i < modules.size(); ++i) {
+    if (obj_files[i] == nullptr) {
+      return llvm::make_error<llvm::StringError>(
+          errors[i], llvm::inconvertibleErrorCode());
+    }
+    if (llvm::Error error = AddObjFile(std::move(obj_files[i]))) {
+      return error;
+    }
+  }
+  return llvm::Error::success();
+}
+
+std::unique_ptr<CompilerFunctor> SimpleOrcJIT::CreateCompiler(
+    llvm::TargetMachine* target_machine) {
+  return std::make_unique<CompilerFunctor>(
+      target_machine, static_cast<int>(opt_level_), optimize_for_size_,
+      disable_expensive_passes_, disable_slp_vectorizer_, fast_math_flags_,
+      [this](const llvm::Module& module) {
+        absl::MutexLock lock(&hooks_mu_);
+        if (pre_optimization_hook_) pre_optimization_hook_(module);
+      },
+      [this](const llvm::Module& module) {
+        absl::MutexLock lock(&hooks_mu_);
+        if (post_optimization_hook_) post_optimization_hook_(module);
+      },
+      [this](const llvm::object::ObjectFile& obj_file) {
+        absl::MutexLock lock(&hooks_mu_);
+        if (post_codegen_hook_) post_codegen_hook_(obj_file);
+      });
+}
+
 void SimpleOrcJIT::DoneCompiling() {
   // The target machine takes a non-trivial amount of memory, so once we are
   // done compiling throw it away.
@@ -527,6 +593,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulC128);
   REGISTER_CPU_RUNTIME_SYMBOL(EigenSingleThreadedMatMulS32);
   REGISTER_CPU_RUNTIME_SYMBOL(ParallelForkJoin);
+  REGISTER_CPU_RUNTIME_SYMBOL(ParallelCalls);
   REGISTER_CPU_RUNTIME_SYMBOL(PrintfToStderr);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseInfeedBufferAfterDequeue);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseOutfeedBufferAfterPopulation);
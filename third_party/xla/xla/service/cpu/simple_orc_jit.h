@@ -20,7 +20,9 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
 #include "llvm/ExecutionEngine/JITEventListener.h"
 #include "llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "llvm/TargetParser/Triple.h"
 #include "xla/service/cpu/compiler_functor.h"
 #include "xla/types.h"
+#include "tsl/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -42,7 +45,8 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
+// Supports JIT-ing multiple modules. The symbols of a module are resolved
+// against the other modules when it's linked.
 // Implements eager compilation - the module is lowered to binary as soon as
 // it's added to the JIT.
 class SimpleOrcJIT : public llvm::JITEventListener {
@@ -86,6 +90,12 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   llvm::Error AddObjFile(std::unique_ptr<llvm::MemoryBuffer> obj_file);
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Optimizes and compiles `modules` to machine code on `thread_pool`, each
+  // with its own target machine, and adds them to the JIT. The hooks are called
+  // for every module, one module at a time.
+  llvm::Error AddModules(std::vector<llvm::orc::ThreadSafeModule> modules,
+                         tsl::thread::ThreadPool* thread_pool);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -109,6 +119,10 @@ class SimpleOrcJIT : public llvm::JITEventListener {
  private:
   llvm::orc::ExecutorSymbolDef ResolveRuntimeSymbol(llvm::StringRef name);
 
+  // Creates a compiler for `target_machine` that calls the hooks of this JIT.
+  std::unique_ptr<CompilerFunctor> CreateCompiler(
+      llvm::TargetMachine* target_machine);
+
   void notifyObjectLoaded(
       llvm::JITEventListener::ObjectKey key,
       const llvm::object::ObjectFile& object,
@@ -118,6 +132,21 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::Triple target_triple_;
   const llvm::DataLayout data_layout_;
+
+  // The options of the compilers created by CreateCompiler().
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOptLevel opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const bool disable_slp_vectorizer_;
+  const llvm::FastMathFlags fast_math_flags_;
+
+  absl::Mutex hooks_mu_;
+  LLVMCompiler::ModuleHook pre_optimization_hook_ ABSL_GUARDED_BY(hooks_mu_);
+  LLVMCompiler::ModuleHook post_optimization_hook_ ABSL_GUARDED_BY(hooks_mu_);
+  absl::AnyInvocable<void(const llvm::object::ObjectFile&)> post_codegen_hook_
+      ABSL_GUARDED_BY(hooks_mu_);
+
   std::unique_ptr<llvm::orc::ExecutorProcessControl> target_process_control_;
   std::unique_ptr<llvm::orc::ExecutionSession> execution_session_;
   ObjLayerT object_layer_;
@@ -0,0 +1,129 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "xla/array2d.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/literal_util.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/concurrent_fusion_assignment.h"
+#include "xla/service/cpu/tests/cpu_codegen_test.h"
+#include "xla/shape_util.h"
+#include "xla/tests/literal_test_util.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Three independent loop fusions of the parameters.
+constexpr char kHloText[] = R"(
+HloModule module
+
+fused_add {
+  p0 = f32[128,128] parameter(0)
+  p1 = f32[128,128] parameter(1)
+  ROOT add = f32[128,128] add(p0, p1)
+}
+
+fused_multiply {
+  p0 = f32[128,128] parameter(0)
+  p1 = f32[128,128] parameter(1)
+  ROOT multiply = f32[128,128] multiply(p0, p1)
+}
+
+fused_subtract {
+  p0 = f32[128,128] parameter(0)
+  p1 = f32[128,128] parameter(1)
+  ROOT subtract = f32[128,128] subtract(p0, p1)
+}
+
+ENTRY entry {
+  a = f32[128,128] parameter(0)
+  b = f32[128,128] parameter(1)
+  f0 = f32[128,128] fusion(a, b), kind=kLoop, calls=fused_add
+  f1 = f32[128,128] fusion(a, b), kind=kLoop, calls=fused_multiply
+  f2 = f32[128,128] fusion(a, b), kind=kLoop, calls=fused_subtract
+  ROOT out = (f32[128,128], f32[128,128], f32[128,128]) tuple(f0, f1, f2)
+}
+)";
+
+class CpuConcurrentFusionsTest : public CpuCodegenTest {
+ protected:
+  static int64_t ShapeSizeBytes(const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+  }
+};
+
+TEST_F(CpuConcurrentFusionsTest, OutlinesIndependentFusionsTogether) {
+  auto module = ParseAndReturnVerifiedModule(kHloText).value();
+  EXPECT_TRUE(RunHloPass(ConcurrentFusionAssigner(/*max_parallelism=*/2,
+                                                  ShapeSizeBytes),
+                         module.get())
+                  .value());
+
+  // The first two fusions make a group; the third is left alone.
+  HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_EQ(root->operand(0)->opcode(), HloOpcode::kGetTupleElement);
+  ASSERT_EQ(root->operand(1)->opcode(), HloOpcode::kGetTupleElement);
+  EXPECT_EQ(root->operand(2)->opcode(), HloOpcode::kFusion);
+
+  const HloInstruction* group = root->operand(0)->operand(0);
+  EXPECT_EQ(group, root->operand(1)->operand(0));
+  ASSERT_EQ(group->opcode(), HloOpcode::kCall);
+  const HloInstruction* tuple = group->to_apply()->root_instruction();
+  EXPECT_TRUE(tuple->backend_config<BackendConfig>()->concurrent_calls());
+  ASSERT_EQ(tuple->operand_count(), 2);
+  for (const HloInstruction* call : tuple->operands()) {
+    ASSERT_EQ(call->opcode(), HloOpcode::kCall);
+    EXPECT_EQ(call->to_apply()->root_instruction()->opcode(),
+              HloOpcode::kFusion);
+  }
+}
+
+TEST_F(CpuConcurrentFusionsTest, SmallFusionsAreLeftAlone) {
+  auto module = ParseAndReturnVerifiedModule(kHloText).value();
+  EXPECT_FALSE(RunHloPass(ConcurrentFusionAssigner(
+                              /*max_parallelism=*/4, ShapeSizeBytes,
+                              /*min_fusion_bytes=*/1 << 20),
+                          module.get())
+                   .value());
+}
+
+TEST_F(CpuConcurrentFusionsTest, ConcurrentFusionsComputeTheSameResult) {
+  auto module = ParseAndReturnVerifiedModule(kHloText).value();
+  DebugOptions debug_options = module->config().debug_options();
+  debug_options.set_xla_cpu_enable_concurrent_fusions(true);
+  module->mutable_config().set_debug_options(debug_options);
+
+  Literal a = LiteralUtil::CreateFromArray(Array2D<float>(128, 128, 2.0f));
+  Literal b = LiteralUtil::CreateFromArray(Array2D<float>(128, 128, 3.0f));
+  Literal result = ExecuteAndTransfer(std::move(module), {&a, &b});
+
+  Literal add = LiteralUtil::CreateFromArray(Array2D<float>(128, 128, 5.0f));
+  Literal multiply =
+      LiteralUtil::CreateFromArray(Array2D<float>(128, 128, 6.0f));
+  Literal subtract =
+      LiteralUtil::CreateFromArray(Array2D<float>(128, 128, -1.0f));
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::MakeTupleFromSlices({add, multiply, subtract}), result));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,100 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "xla/array2d.h"
+#include "xla/literal_util.h"
+#include "xla/service/cpu/cpu_executable.h"
+#include "xla/service/cpu/tests/cpu_codegen_test.h"
+#include "xla/tests/literal_test_util.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// The broadcast is live until the end of the computation, so recomputing it
+// next to its last use shortens its live range.
+constexpr char kHloText[] = R"(
+HloModule module
+
+ENTRY entry {
+  p0 = f32[] parameter(0)
+  p1 = f32[256,256] parameter(1)
+  b = f32[256,256] broadcast(p0), dimensions={}
+  x = f32[256,256] add(p1, b)
+  y = f32[256,256] multiply(x, x)
+  z = f32[256,256] exponential(y)
+  w = f32[256,256] multiply(z, z)
+  ROOT out = f32[256,256] add(w, b)
+}
+)";
+
+class CpuMemoryBudgetTest : public CpuCodegenTest {
+ protected:
+  // Returns the size of the temporaries of kHloText compiled under
+  // `memory_budget`, and its compilation stats.
+  std::pair<int64_t, std::string> CompileWithBudget(int64_t memory_budget) {
+    auto module = ParseAndReturnVerifiedModule(kHloText).value();
+    DebugOptions debug_options = module->config().debug_options();
+    debug_options.set_xla_cpu_memory_budget_bytes(memory_budget);
+    module->mutable_config().set_debug_options(debug_options);
+    // Without fusion, the intermediate results of kHloText are temporaries.
+    std::unique_ptr<Executable> executable =
+        CompileToExecutable(std::move(module),
+                            /*run_optimization_passes=*/false)
+            .value();
+    auto* cpu_executable = static_cast<CpuExecutable*>(executable.get());
+    return {cpu_executable->buffer_assignment()
+                .GetStats()
+                .preallocated_temp_allocation_bytes,
+            executable->debug_info()};
+  }
+};
+
+TEST_F(CpuMemoryBudgetTest, ReportsBudgetAndDoesNotIncreasePeakMemory) {
+  auto [default_temp_bytes, default_stats] = CompileWithBudget(0);
+  EXPECT_FALSE(absl::StrContains(default_stats, "memory budget"));
+
+  // A budget too small to meet makes the compiler do its best.
+  auto [budget_temp_bytes, budget_stats] = CompileWithBudget(1);
+  EXPECT_TRUE(absl::StrContains(budget_stats, "memory budget"));
+  EXPECT_TRUE(absl::StrContains(budget_stats, "(exceeded)"));
+  EXPECT_LE(budget_temp_bytes, default_temp_bytes);
+}
+
+TEST_F(CpuMemoryBudgetTest, RematerializedModuleComputesTheSameResult) {
+  auto module = ParseAndReturnVerifiedModule(kHloText).value();
+  DebugOptions debug_options = module->config().debug_options();
+  debug_options.set_xla_cpu_memory_budget_bytes(1);
+  module->mutable_config().set_debug_options(debug_options);
+
+  Literal p0 = LiteralUtil::CreateR0<float>(0.5f);
+  Literal p1 = LiteralUtil::CreateFromArray(Array2D<float>(256, 256, -0.5f));
+  Literal result = ExecuteAndTransfer(std::move(module), {&p0, &p1});
+
+  // x = 0 so exp(y) = 1, w = 1 and out = 1.5.
+  Literal expected =
+      LiteralUtil::CreateFromArray(Array2D<float>(256, 256, 1.5f));
+  EXPECT_TRUE(LiteralTestUtil::Equal(expected, result));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,77 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+
+#include "xla/literal_util.h"
+#include "xla/service/cpu/cpu_compiler.h"
+#include "xla/service/cpu/tests/cpu_codegen_test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuParallelCodegenTest : public CpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuParallelCodegenTest, SplitsModuleWithSharedConstants) {
+  const std::string hlo_text = R"(
+HloModule module
+
+f1 {
+  f1.p0 = f32[4] parameter(0)
+  f1.c = f32[4] constant({1, 2, 3, 4})
+  ROOT f1.sum = f32[4] add(f1.p0, f1.c)
+}
+
+f2 {
+  f2.p0 = f32[4] parameter(0)
+  f2.c = f32[4] constant({1, 2, 3, 4})
+  ROOT f2.mul = f32[4] multiply(f2.p0, f2.c)
+}
+
+f3 {
+  f3.p0 = f32[4] parameter(0)
+  f3.p1 = f32[4] parameter(1)
+  ROOT f3.sub = f32[4] subtract(f3.p0, f3.p1)
+}
+
+ENTRY entry {
+  p0 = f32[4] parameter(0)
+  sum = f32[4] fusion(p0), kind=kLoop, calls=f1
+  mul = f32[4] fusion(sum), kind=kLoop, calls=f2
+  ROOT sub = f32[4] fusion(mul, p0), kind=kLoop, calls=f3
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  Literal arg = LiteralUtil::CreateR1<float>({1, 1, 1, 1});
+
+  // Compile and execute the computation.
+  auto result = ExecuteAndTransfer(std::move(module), {&arg});
+
+  // Check the output correctness.
+  LiteralTestUtil::ExpectR1Equal<float>({1, 5, 11, 19}, result);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
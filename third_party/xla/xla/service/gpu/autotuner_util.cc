@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
@@ -45,12 +47,16 @@ limitations under the License.
 #include "xla/status.h"
 #include "xla/status_macros.h"
 #include "xla/statusor.h"
+#include "xla/stream_executor/blas.h"
+#include "xla/stream_executor/device_description.h"
 #include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/dnn.h"
 #include "xla/stream_executor/gpu/redzone_allocator.h"
 #include "xla/stream_executor/stream.h"
 #include "xla/util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/path.h"
 #include "tsl/platform/protobuf.h"  // IWYU pragma: keep
@@ -65,6 +71,114 @@ static absl::Mutex autotune_cache_mu(absl::kConstInit);
 static auto& autotune_cache ABSL_GUARDED_BY(autotune_cache_mu) =
     *new AutotuneCacheMap();
 
+namespace {
+
+// Bump this version whenever you change the structure of the results.
+// LINT.IfChange(version)
+constexpr int kVersion = 2;
+// LINT.ThenChange()
+
+bool IsTextProtoPath(absl::string_view file_path) {
+  return absl::EndsWith(file_path, ".txt") ||
+         absl::EndsWith(file_path, ".textproto") ||
+         absl::EndsWith(file_path, ".prototxt");
+}
+
+// Returns the versions of the driver and the libraries that the autotune
+// results on the device of `config` depend on.
+std::string GetToolkitVersions(const AutotuneConfig& config) {
+  se::StreamExecutor* executor = config.GetExecutor();
+  const se::DeviceDescription& description = executor->GetDeviceDescription();
+  std::string versions =
+      absl::StrCat("driver=", description.driver_version(),
+                   ";runtime=", description.runtime_version());
+  if (se::dnn::DnnSupport* dnn = executor->AsDnn()) {
+    absl::StatusOr<se::dnn::VersionInfo> version = dnn->GetVersion();
+    if (version.ok()) {
+      absl::StrAppend(&versions, ";dnn=", version->major_version(), ".",
+                      version->minor_version(), ".", version->patch());
+    }
+  }
+  if (se::blas::BlasSupport* blas = executor->AsBlas()) {
+    std::string version;
+    if (blas->GetVersion(&version).ok()) {
+      absl::StrAppend(&versions, ";blas=", version);
+    }
+  }
+  return versions;
+}
+
+// Returns the path of the result of `key` in the per-fusion cache directory
+// of `config`. Upgrading the driver or a library changes the path, so the
+// results of older versions are never found.
+std::string GetPerFusionCachePath(const AutotuneCacheKey& key,
+                                  const AutotuneConfig& config) {
+  tsl::Fprint128 fingerprint = tsl::Fingerprint128(
+      absl::StrCat(key.ToString(), GetToolkitVersions(config)));
+  return tsl::io::JoinPath(
+      config.autotune_cache_dir(),
+      absl::StrFormat("%016x%016x.textproto", fingerprint.high64,
+                      fingerprint.low64));
+}
+
+bool UsesPerFusionCache(const AutotuneConfig& config) {
+  return !config.autotune_cache_dir().empty() && !config.IsDeviceless();
+}
+
+// Returns the result of `key` in the per-fusion cache directory of `config`,
+// if there is a valid one.
+absl::StatusOr<std::optional<AutotuneResult>> TryFindInPerFusionCache(
+    const AutotuneCacheKey& key, const AutotuneConfig& config) {
+  std::string path = GetPerFusionCachePath(key, config);
+  tsl::Env* env = tsl::Env::Default();
+  if (!env->FileExists(path).ok()) {
+    return std::nullopt;
+  }
+  std::string results_str;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(env, path, &results_str));
+  AutotuneResults results;
+  if (!tsl::protobuf::TextFormat::ParseFromString(results_str, &results) ||
+      results.version() != kVersion || results.results_size() != 1 ||
+      results.results(0).device() != key.GetModelStr() ||
+      results.results(0).hlo() != key.GetHlo()) {
+    // It is overwritten once the key is autotuned again.
+    LOG(WARNING) << "Ignoring invalid autotune result: " << path;
+    return std::nullopt;
+  }
+  VLOG(1) << "Autotune per-fusion cache hit: " << path;
+  return results.results(0).result();
+}
+
+absl::Status AddResultToPerFusionCache(const AutotuneCacheKey& key,
+                                       const AutotuneResult& result,
+                                       const AutotuneConfig& config) {
+  AutotuneResults results;
+  results.set_version(kVersion);
+  auto& entry = *results.add_results();
+  entry.set_device(std::string(key.GetModelStr()));
+  entry.set_hlo(std::string(key.GetHlo()));
+  *entry.mutable_result() = result;
+  std::string results_str;
+  if (!tsl::protobuf::TextFormat::PrintToString(results, &results_str)) {
+    return InternalError("Failed to serialize autotune result.");
+  }
+
+  // Write to a temporary file first, so that concurrent readers never see a
+  // partial result.
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(config.autotune_cache_dir()));
+  std::string path = GetPerFusionCachePath(key, config);
+  std::string temp_path = path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return InternalError("Failed to create a temporary file name for: %s",
+                         path);
+  }
+  TF_RETURN_IF_ERROR(tsl::WriteStringToFile(env, temp_path, results_str));
+  return env->RenameFile(temp_path, path);
+}
+
+}  // anonymous namespace
+
 /*static*/ absl::Status AutotunerUtil::SerializeAutotuneResults(
     AutotuneResults* results) {
   absl::MutexLock lock(&autotune_cache_mu);
@@ -157,6 +271,23 @@ static AutotuneResult* TryFindInCache(const AutotuneCacheKey& key) {
   return TryFindInCache(key) != nullptr;
 }
 
+/*static*/ absl::StatusOr<bool> AutotunerUtil::IsInCache(
+    const AutotuneCacheKey& key, const AutotuneConfig& config) {
+  if (IsInCache(key)) {
+    return true;
+  }
+  if (!UsesPerFusionCache(config)) {
+    return false;
+  }
+  TF_ASSIGN_OR_RETURN(std::optional<AutotuneResult> result,
+                      TryFindInPerFusionCache(key, config));
+  if (!result.has_value()) {
+    return false;
+  }
+  AddResult(key, *std::move(result));
+  return true;
+}
+
 /*static*/ bool AutotunerUtil::AddResult(const AutotuneCacheKey& key,
                                          AutotuneResult result) {
   absl::MutexLock lock(&autotune_cache_mu);
@@ -164,6 +295,15 @@ static AutotuneResult* TryFindInCache(const AutotuneCacheKey& key) {
   return inserted;
 }
 
+/*static*/ absl::StatusOr<bool> AutotunerUtil::AddResult(
+    const AutotuneCacheKey& key, AutotuneResult result,
+    const AutotuneConfig& config) {
+  if (UsesPerFusionCache(config)) {
+    TF_RETURN_IF_ERROR(AddResultToPerFusionCache(key, result, config));
+  }
+  return AddResult(key, std::move(result));
+}
+
 /*static*/ absl::StatusOr<AutotuneResult> AutotunerUtil::Autotune(
     const HloInstruction* instr, const AutotuneConfig& config,
     const AutotuneNoCacheFn& autotune_fn) {
@@ -171,29 +311,27 @@ static AutotuneResult* TryFindInCache(const AutotuneCacheKey& key) {
   if (AutotuneResult* res = TryFindInCache(key)) {
     return *res;
   }
+  if (UsesPerFusionCache(config)) {
+    TF_ASSIGN_OR_RETURN(std::optional<AutotuneResult> res,
+                        TryFindInPerFusionCache(key, config));
+    if (res.has_value()) {
+      absl::MutexLock lock(&autotune_cache_mu);
+      auto [it, inserted] = autotune_cache.emplace(key, *std::move(res));
+      return it->second;
+    }
+  }
 
   TF_ASSIGN_OR_RETURN(AutotuneResult autotune_result, autotune_fn());
+  if (UsesPerFusionCache(config)) {
+    TF_RETURN_IF_ERROR(
+        AddResultToPerFusionCache(key, autotune_result, config));
+  }
 
   absl::MutexLock lock(&autotune_cache_mu);
   auto [it, inserted] = autotune_cache.emplace(key, autotune_result);
   return it->second;
 }
 
-namespace {
-
-// Bump this version whenever you change the structure of the results.
-// LINT.IfChange(version)
-constexpr int kVersion = 2;
-// LINT.ThenChange()
-
-bool IsTextProtoPath(absl::string_view file_path) {
-  return absl::EndsWith(file_path, ".txt") ||
-         absl::EndsWith(file_path, ".textproto") ||
-         absl::EndsWith(file_path, ".prototxt");
-}
-
-}  // anonymous namespace
-
 /*static*/ absl::Status AutotunerUtil::LoadAutotuneResults(
     absl::string_view data, bool as_textproto) {
   AutotuneResults results;
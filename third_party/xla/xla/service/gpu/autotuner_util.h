@@ -106,7 +106,9 @@ class AutotuneConfig {
         should_crash_on_check_failure_(
             debug_options.xla_gpu_crash_on_verification_failures()),
         exhaustive_tiling_search_(
-            debug_options.xla_gpu_exhaustive_tiling_search()) {}
+            debug_options.xla_gpu_exhaustive_tiling_search()),
+        autotune_cache_dir_(
+            debug_options.xla_gpu_per_fusion_autotune_cache_dir()) {}
 
   absl::string_view GetModelStr() const {
     if (auto deviceless_config = std::get_if<DevicelessConfig>(&config_)) {
@@ -146,11 +148,14 @@ class AutotuneConfig {
 
   bool ExhaustiveTilingSearch() const { return exhaustive_tiling_search_; }
 
+  const std::string& autotune_cache_dir() const { return autotune_cache_dir_; }
+
  private:
   std::variant<DeviceConfig, DevicelessConfig> config_;
   int32_t autotune_level_;
   bool should_crash_on_check_failure_;
   bool exhaustive_tiling_search_;
+  std::string autotune_cache_dir_;
 };
 
 using AutotuneNoCacheFn = std::function<absl::StatusOr<AutotuneResult>()>;
@@ -177,6 +182,13 @@ struct AutotunerUtil {
   // Normally, we don't have to use this low level method.
   static bool IsInCache(const AutotuneCacheKey& key);
 
+  // Checks if the key is in the autotune cache, or in the per-fusion cache
+  // directory of `config`, from which it is then loaded.
+  //
+  // Normally, we don't have to use this low level method.
+  static absl::StatusOr<bool> IsInCache(const AutotuneCacheKey& key,
+                                        const AutotuneConfig& config);
+
   // Adds the result to the autotune cache.
   //
   // Returns true if the entry is inserted.
@@ -184,6 +196,16 @@ struct AutotunerUtil {
   // Normally, we don't have to use this low level method.
   static bool AddResult(const AutotuneCacheKey& key, AutotuneResult result);
 
+  // Adds the result to the autotune cache, and to the per-fusion cache
+  // directory of `config`, if any.
+  //
+  // Returns true if the entry is inserted.
+  //
+  // Normally, we don't have to use this low level method.
+  static absl::StatusOr<bool> AddResult(const AutotuneCacheKey& key,
+                                        AutotuneResult result,
+                                        const AutotuneConfig& config);
+
   // Creates a RedzoneAllocator from a given config. If `force_stream` is
   // provided, than it is used for checking redzones.
   static absl::StatusOr<se::RedzoneAllocator> CreateRedzoneAllocator(
@@ -16,15 +16,19 @@ limitations under the License.
 #include "xla/service/gpu/autotuner_util.h"
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/strings/string_view.h"
 #include "xla/autotune_results.pb.h"
 #include "xla/tests/hlo_test_base.h"
+#include "xla/xla.pb.h"
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"   // IWYU pragma: keep
+#include "tsl/platform/path.h"
 #include "tsl/platform/protobuf.h"  // IWYU pragma: keep
 
 namespace xla {
@@ -33,6 +37,7 @@ namespace {
 
 using ::testing::IsEmpty;
 using ::testing::Not;
+using ::testing::UnorderedElementsAreArray;
 using ::testing::TempDir;
 
 class AutotunerUtilTest : public HloTestBase {
@@ -123,6 +128,38 @@ TEST_F(AutotunerUtilTest, LoadAutotuneResultsFromFile_Protobuf) {
   TF_EXPECT_OK(AutotunerUtil::LoadAutotuneResultsFromFile(kFilePath));
 }
 
+TEST_F(AutotunerUtilTest, PerFusionCacheIsWrittenAndReused) {
+  std::string cache_dir = GetUniqueTempFilePath("_autotune_cache");
+  auto compile = [&]() -> std::vector<std::string> {
+    AutotunerUtil::ClearAutotuneResults();
+    auto module = ParseAndReturnVerifiedModule(kHloText).value();
+    DebugOptions debug_options = module->config().debug_options();
+    debug_options.set_xla_gpu_per_fusion_autotune_cache_dir(cache_dir);
+    module->mutable_config().set_debug_options(debug_options);
+    TF_EXPECT_OK(GetOptimizedModule(std::move(module)).status());
+    std::vector<std::string> files;
+    TF_EXPECT_OK(tsl::Env::Default()->GetChildren(cache_dir, &files));
+    return files;
+  };
+
+  std::vector<std::string> files = compile();
+  ASSERT_THAT(files, Not(IsEmpty()));
+  std::string file_path = tsl::io::JoinPath(cache_dir, files[0]);
+  AutotuneResults results;
+  EXPECT_TRUE(tsl::protobuf::TextFormat::ParseFromString(
+      ExpectToReadNonEmptyFile(file_path), &results));
+  EXPECT_EQ(results.results_size(), 1);
+
+  // The results found in the cache aren't autotuned or written again.
+  EXPECT_THAT(compile(), UnorderedElementsAreArray(files));
+
+  // An invalid result is ignored and overwritten.
+  TF_ASSERT_OK(tsl::WriteStringToFile(tsl::Env::Default(), file_path, "?"));
+  EXPECT_THAT(compile(), UnorderedElementsAreArray(files));
+  EXPECT_TRUE(tsl::protobuf::TextFormat::ParseFromString(
+      ExpectToReadNonEmptyFile(file_path), &results));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
@@ -221,7 +221,9 @@ class GemmConfigSetCollector : public ConstDfsHloVisitorWithDefault {
     }
 
     AutotuneCacheKey key = AutotunerUtil::GetKey(hlo, config_);
-    if (AutotunerUtil::IsInCache(key) || handled_fusions_.contains(key)) {
+    TF_ASSIGN_OR_RETURN(bool is_in_cache,
+                        AutotunerUtil::IsInCache(key, config_));
+    if (is_in_cache || handled_fusions_.contains(key)) {
       return absl::OkStatus();
     }
 
@@ -914,7 +916,10 @@ absl::Status Autotune(
     }
 
     const AutotuneCacheKey key = AutotunerUtil::GetKey(fusion, config);
-    if (!AutotunerUtil::AddResult(key, std::move(result))) {
+    TF_ASSIGN_OR_RETURN(bool inserted,
+                        AutotunerUtil::AddResult(key, std::move(result),
+                                                 config));
+    if (!inserted) {
       // In the context of model server, concurrent autotuning is expected and
       // insertion of identical autotuning keys is accepted.
       LOG(WARNING) << "AutotunerUtil::AddResult already existed: "